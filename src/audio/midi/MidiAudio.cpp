@@ -3,7 +3,6 @@
 
 #include "precomp.h"
 #include "MidiAudio.hpp"
-#include "../terminal/parser/stateMachine.hpp"
 
 namespace
 {
@@ -52,74 +51,120 @@ namespace
     };
 }
 
-using namespace std::chrono_literals;
-
 MidiAudio::~MidiAudio() noexcept
 {
-    try
-    {
-#pragma warning(suppress : 26447)
-        // We acquire the lock here so the class isn't destroyed while in use.
-        // If this throws, we'll catch it, so the C26447 warning is bogus.
-        _inUseMutex.lock();
-    }
-    catch (...)
+    Shutdown();
+    if (_thread.joinable())
     {
-        // If the lock fails, we'll just have to live with the consequences.
+        try
+        {
+            // The thread exits as soon as it notices the shutdown, even in the middle of a note.
+            _thread.join();
+        }
+        catch (...)
+        {
+            // If the join fails, we'll just have to live with the consequences.
+        }
     }
 }
 
 void MidiAudio::Initialize()
 {
-    _shutdownFuture = _shutdownPromise.get_future();
-}
-
-void MidiAudio::Shutdown()
-{
-    // Once the shutdown promise is set, any note that is playing will stop
-    // immediately, and the Unlock call will exit the thread ASAP.
-    _shutdownPromise.set_value();
+    _thread = std::thread{ &MidiAudio::_playbackLoop, this };
 }
 
-void MidiAudio::Lock()
+void MidiAudio::Shutdown() noexcept
+try
 {
-    _inUseMutex.lock();
+    {
+        const std::lock_guard lock{ _mutex };
+        _shutdown = true;
+        _notes.clear();
+    }
+    // Any note that is playing will stop immediately.
+    _notesChanged.notify_all();
 }
+CATCH_LOG()
 
-void MidiAudio::Unlock()
+// Routine Description:
+// - Queues up a single MIDI note and returns immediately. The notes are played
+//   one after the other: A note starts once the one queued before it has ended,
+//   or right away if nothing is playing.
+// Arguments:
+// - noteNumber - The MIDI note number to be played (0 - 127).
+// - velocity - The force with which the note should be played (0 - 127).
+//   A velocity of 0 is a rest.
+// - duration - How long the note should be sustained.
+void MidiAudio::PlayNote(const int noteNumber, const int velocity, const std::chrono::microseconds duration) noexcept
+try
 {
-    // We need to check the shutdown status before releasing the mutex,
-    // because after that the class could be destroyed.
-    const auto shutdownStatus = _shutdownFuture.wait_for(0s);
-    _inUseMutex.unlock();
-    // If the wait didn't timeout, that means the shutdown promise was set,
-    // so we need to exit the thread ASAP by throwing an exception.
-    if (shutdownStatus != std::future_status::timeout)
+    const auto now = Clock::now();
     {
-        throw Microsoft::Console::VirtualTerminal::StateMachine::ShutdownException{};
+        const std::lock_guard lock{ _mutex };
+        if (_shutdown || _notes.size() >= MaxQueuedNotes)
+        {
+            return;
+        }
+
+        const auto start = std::max(now, _lastNoteEnd);
+        _lastNoteEnd = start + duration;
+        _notes.emplace_back(Note{ noteNumber, velocity, start, _lastNoteEnd });
     }
+    _notesChanged.notify_one();
 }
+CATCH_LOG()
 
-void MidiAudio::PlayNote(const int noteNumber, const int velocity, const std::chrono::microseconds duration) noexcept
+// Routine Description:
+// - The body of the playback thread. It waits for notes to be queued up and
+//   plays them at the time they were scheduled for, until Shutdown() is called.
+void MidiAudio::_playbackLoop() noexcept
 try
 {
     // The MidiOut is a local static because we can only have one instance,
     // and we only want to construct it when it's actually needed.
     static MidiOut midiOut;
 
-    if (velocity)
+    const auto isShutdown = [this]() noexcept { return _shutdown; };
+    std::unique_lock lock{ _mutex };
+
+    for (;;)
     {
-        midiOut.OutputMessage(MidiOut::NOTE_ON, noteNumber, velocity);
-    }
+        _notesChanged.wait(lock, [this]() noexcept { return _shutdown || !_notes.empty(); });
+        if (_shutdown)
+        {
+            return;
+        }
 
-    // By waiting on the shutdown future with the duration of the note, we'll
-    // either be paused for the appropriate amount of time, or we'll break out
-    // of the wait early if we've been shutdown.
-    _shutdownFuture.wait_for(duration);
+        const auto note = _notes.front();
+        _notes.pop_front();
 
-    if (velocity)
-    {
-        midiOut.OutputMessage(MidiOut::NOTE_OFF, noteNumber, velocity);
+        // Waiting on the condition variable means that we're either paused until
+        // the note is due, or we break out of the wait early if we've been shutdown.
+        if (_notesChanged.wait_until(lock, note.start, isShutdown))
+        {
+            return;
+        }
+
+        if (note.velocity)
+        {
+            lock.unlock();
+            midiOut.OutputMessage(MidiOut::NOTE_ON, note.noteNumber, note.velocity);
+            lock.lock();
+        }
+
+        const auto stopped = _notesChanged.wait_until(lock, note.end, isShutdown);
+
+        if (note.velocity)
+        {
+            lock.unlock();
+            midiOut.OutputMessage(MidiOut::NOTE_OFF, note.noteNumber, note.velocity);
+            lock.lock();
+        }
+
+        if (stopped)
+        {
+            return;
+        }
     }
 }
 CATCH_LOG()
@@ -6,13 +6,16 @@ Module Name:
 - MidiAudio.hpp
 
 Abstract:
-  This modules provide basic MIDI support with blocking sound output.
+  This modules provide basic MIDI support. The notes are queued up and played
+  by a thread of their own, so that the caller doesn't block while they play.
   */
 
 #pragma once
 
-#include <future>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <thread>
 
 class MidiAudio
 {
@@ -24,13 +27,30 @@ public:
     MidiAudio& operator=(MidiAudio&&) = delete;
     ~MidiAudio() noexcept;
     void Initialize();
-    void Shutdown();
-    void Lock();
-    void Unlock();
+    void Shutdown() noexcept;
     void PlayNote(const int noteNumber, const int velocity, const std::chrono::microseconds duration) noexcept;
 
 private:
-    std::promise<void> _shutdownPromise;
-    std::future<void> _shutdownFuture;
-    std::mutex _inUseMutex;
+    using Clock = std::chrono::steady_clock;
+
+    struct Note
+    {
+        int noteNumber;
+        int velocity;
+        Clock::time_point start;
+        Clock::time_point end;
+    };
+
+    // A program that plays notes faster than we can play them shouldn't make us
+    // use an ever growing amount of memory. Notes beyond this limit are dropped.
+    static constexpr size_t MaxQueuedNotes = 1024;
+
+    void _playbackLoop() noexcept;
+
+    std::mutex _mutex;
+    std::condition_variable _notesChanged;
+    std::deque<Note> _notes;
+    Clock::time_point _lastNoteEnd;
+    bool _shutdown = false;
+    std::thread _thread;
 };
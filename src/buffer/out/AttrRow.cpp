@@ -9,10 +9,67 @@
 // Arguments:
 // - cchRowWidth - the length of the default text attribute
 // - attr - the default text attribute
+// - table - the attribute table of the text buffer this row belongs to
 // Return Value:
 // - constructed object
-ATTR_ROW::ATTR_ROW(const til::CoordType width, const TextAttribute attr) :
-    _data(gsl::narrow_cast<uint16_t>(width), attr) {}
+ATTR_ROW::ATTR_ROW(const til::CoordType width, const TextAttribute attr, TextAttributeTable* const table) :
+    _data(gsl::narrow_cast<uint16_t>(width), FAIL_FAST_IF_NULL(table)->Intern(attr)),
+    _table{ table }
+{
+    if (attr.IsHyperlink())
+    {
+        _table->AddHyperlinkReference(attr.GetHyperlinkId());
+        _hasHyperlinks = true;
+    }
+}
+
+// Routine Description:
+// - Copies another row of the same text buffer. The copy holds its own
+//   references to the hyperlinks of the row.
+// Arguments:
+// - other - the row to copy
+// Return Value:
+// - constructed object
+ATTR_ROW::ATTR_ROW(const ATTR_ROW& other) :
+    _data{ other._data },
+    _table{ other._table },
+    _hasHyperlinks{ other._hasHyperlinks }
+{
+    if (_hasHyperlinks)
+    {
+        hyperlink_ids ids;
+        _CollectHyperlinks(ids);
+        for (const auto id : ids)
+        {
+            _table->AddHyperlinkReference(id);
+        }
+    }
+}
+
+// Routine Description:
+// - Copies the attributes of another row into this one. If the other row
+//   belongs to a different text buffer, its attributes are interned into ours.
+// Arguments:
+// - other - the row to copy the attributes of
+// Return Value:
+// - this row
+ATTR_ROW& ATTR_ROW::operator=(const ATTR_ROW& other)
+{
+    if (this != &other)
+    {
+        _WriteTrackingHyperlinks(other._hasHyperlinks, [&]() {
+            if (_table == other._table)
+            {
+                _data = other._data;
+            }
+            else
+            {
+                _data = other.Reintern(*_table);
+            }
+        });
+    }
+    return *this;
+}
 
 // Routine Description:
 // - Sets all properties of the ATTR_ROW to default values
@@ -20,7 +77,9 @@ ATTR_ROW::ATTR_ROW(const til::CoordType width, const TextAttribute attr) :
 // - attr - The default text attributes to use on text in this row.
 void ATTR_ROW::Reset(const TextAttribute attr)
 {
-    _data.replace(0, _data.size(), attr);
+    _WriteTrackingHyperlinks(attr.IsHyperlink(), [&]() {
+        _data.replace(0, _data.size(), _table->Intern(attr));
+    });
 }
 
 // Routine Description:
@@ -34,7 +93,10 @@ void ATTR_ROW::Reset(const TextAttribute attr)
 // - <none>, throws exceptions on failures.
 void ATTR_ROW::Resize(const til::CoordType newWidth)
 {
-    _data.resize_trailing_extent(gsl::narrow<uint16_t>(newWidth));
+    // Cutting the row off may remove runs, but extending it never adds any.
+    _WriteTrackingHyperlinks(false, [&]() {
+        _data.resize_trailing_extent(gsl::narrow<uint16_t>(newWidth));
+    });
 }
 
 // Routine Description:
@@ -47,7 +109,7 @@ void ATTR_ROW::Resize(const til::CoordType newWidth)
 // - will throw on error
 TextAttribute ATTR_ROW::GetAttrByColumn(const til::CoordType column) const
 {
-    return _data.at(gsl::narrow<uint16_t>(column));
+    return _table->Get(_data.at(gsl::narrow<uint16_t>(column)));
 }
 
 // Routine Description:
@@ -57,16 +119,42 @@ TextAttribute ATTR_ROW::GetAttrByColumn(const til::CoordType column) const
 std::vector<uint16_t> ATTR_ROW::GetHyperlinks() const
 {
     std::vector<uint16_t> ids;
-    for (const auto& run : _data.runs())
+    if (_hasHyperlinks)
     {
-        if (run.value.IsHyperlink())
+        for (const auto& run : _data.runs())
         {
-            ids.emplace_back(run.value.GetHyperlinkId());
+            const auto& attr = _table->Get(run.value);
+            if (attr.IsHyperlink())
+            {
+                ids.emplace_back(attr.GetHyperlinkId());
+            }
         }
     }
     return ids;
 }
 
+// Routine Description:
+// - Gives access to the runs of attribute ids this row consists of, from left
+//   to right. This allows callers to process each run once, instead of looking
+//   at the attributes column by column. Use GetAttrById to resolve the ids.
+// Return value:
+// - The runs of this row.
+const ATTR_ROW::rle_vector::container& ATTR_ROW::GetRuns() const noexcept
+{
+    return _data.runs();
+}
+
+// Routine Description:
+// - Resolves an attribute id returned by GetRuns.
+// Arguments:
+// - id - The id of a run of this row.
+// Return value:
+// - The attribute stored under the id.
+const TextAttribute& ATTR_ROW::GetAttrById(const TextAttributeTable::id_type id) const noexcept
+{
+    return _table->Get(id);
+}
+
 // Routine Description:
 // - Sets the attributes (colors) of all character positions from the given position through the end of the row.
 // Arguments:
@@ -76,7 +164,9 @@ std::vector<uint16_t> ATTR_ROW::GetHyperlinks() const
 // - <none>
 bool ATTR_ROW::SetAttrToEnd(const til::CoordType beginIndex, const TextAttribute attr)
 {
-    _data.replace(gsl::narrow<uint16_t>(beginIndex), _data.size(), attr);
+    _WriteTrackingHyperlinks(attr.IsHyperlink(), [&]() {
+        _data.replace(gsl::narrow<uint16_t>(beginIndex), _data.size(), _table->Intern(attr));
+    });
     return true;
 }
 
@@ -90,7 +180,9 @@ bool ATTR_ROW::SetAttrToEnd(const til::CoordType beginIndex, const TextAttribute
 // - <none>
 void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAttribute& replaceWith)
 {
-    _data.replace_values(toBeReplacedAttr, replaceWith);
+    _WriteTrackingHyperlinks(replaceWith.IsHyperlink(), [&]() {
+        _data.replace_values(_table->Intern(toBeReplacedAttr), _table->Intern(replaceWith));
+    });
 }
 
 // Routine Description:
@@ -105,30 +197,166 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
 // - <none>
 void ATTR_ROW::Replace(const til::CoordType beginIndex, const til::CoordType endIndex, const TextAttribute& newAttr)
 {
-    _data.replace(gsl::narrow<uint16_t>(beginIndex), gsl::narrow<uint16_t>(endIndex), newAttr);
+    _WriteTrackingHyperlinks(newAttr.IsHyperlink(), [&]() {
+        _data.replace(gsl::narrow<uint16_t>(beginIndex), gsl::narrow<uint16_t>(endIndex), _table->Intern(newAttr));
+    });
+}
+
+// Routine Description:
+// - Same as Replace(), but for a sequence of consecutive runs starting at beginIndex.
+// - Writing text with many attribute changes would otherwise need one call to
+//   Replace() per change, each of which may have to shift all of the following runs.
+//   This splices all of them into the row in a single pass instead.
+// Arguments:
+// - beginIndex: The column the first of the runs starts at.
+// - newRuns: The runs to merge into this row. Together they mustn't extend past the end of the row.
+// Return Value:
+// - <none>
+void ATTR_ROW::ReplaceRuns(const til::CoordType beginIndex, const gsl::span<const attr_run> newRuns)
+{
+    boost::container::small_vector<rle_vector::rle_type, 16> interned;
+    interned.reserve(newRuns.size());
+
+    auto endIndex = gsl::narrow<uint16_t>(beginIndex);
+    auto writesHyperlinks = false;
+    for (const auto& run : newRuns)
+    {
+        interned.emplace_back(_table->Intern(run.value), run.length);
+        endIndex = gsl::narrow<uint16_t>(endIndex + run.length);
+        writesHyperlinks |= run.value.IsHyperlink();
+    }
+
+    _WriteTrackingHyperlinks(writesHyperlinks, [&]() {
+        _data.replace(gsl::narrow<uint16_t>(beginIndex), endIndex, interned);
+    });
+}
+
+// Routine Description:
+// - Returns the runs of this row, with each attribute interned into the given table.
+// - Together with Rebind() this allows the owning text buffer to move its rows over to
+//   a new table, without modifying any of them until all of the runs were translated.
+// Arguments:
+// - table - the table to intern the attributes of this row into
+// Return Value:
+// - the translated runs
+ATTR_ROW::rle_vector ATTR_ROW::Reintern(TextAttributeTable& table) const
+{
+    auto runs = _data.runs();
+    for (auto& run : runs)
+    {
+        run.value = table.Intern(_table->Get(run.value));
+    }
+    return rle_vector{ std::move(runs) };
+}
+
+// Routine Description:
+// - Replaces the runs of this row with ones that were translated by Reintern().
+// Arguments:
+// - data - the runs returned by Reintern()
+// - table - the table that was passed to Reintern()
+void ATTR_ROW::Rebind(rle_vector&& data, TextAttributeTable* const table) noexcept
+{
+    _data = std::move(data);
+    _table = table;
+}
+
+// Routine Description:
+// - Drops the references this row holds to hyperlinks, for rows that are about to
+//   be destroyed. Rows don't do this on destruction, because the buffer destroys
+//   them together with the table at which point the counts don't matter anymore.
+void ATTR_ROW::ReleaseHyperlinks() noexcept
+{
+    if (_hasHyperlinks)
+    {
+        for (const auto& run : _data.runs())
+        {
+            const auto& attr = _table->Get(run.value);
+            if (attr.IsHyperlink())
+            {
+                _table->ReleaseHyperlinkReference(attr.GetHyperlinkId());
+            }
+        }
+        _hasHyperlinks = false;
+    }
+}
+
+// Routine Description:
+// - Appends the hyperlink ID of every run that refers to one, once per run.
+// Arguments:
+// - ids - receives the IDs
+void ATTR_ROW::_CollectHyperlinks(hyperlink_ids& ids) const
+{
+    for (const auto& run : _data.runs())
+    {
+        const auto& attr = _table->Get(run.value);
+        if (attr.IsHyperlink())
+        {
+            ids.emplace_back(attr.GetHyperlinkId());
+        }
+    }
+}
+
+// Routine Description:
+// - Runs the given write and updates the hyperlink references this row holds in
+//   the table to match. Reference counts are kept per run, and as runs get merged
+//   and split by writes, it's simplest to compare the hyperlinks before and after.
+// - Rows without hyperlinks that don't get any written are the common case. They
+//   skip the comparison, so that the print path doesn't pay for it.
+// Arguments:
+// - writesHyperlinks - whether the written attributes include a hyperlink
+// - write - the modification of _data
+template<typename Write>
+void ATTR_ROW::_WriteTrackingHyperlinks(const bool writesHyperlinks, Write&& write)
+{
+    if (!_hasHyperlinks && !writesHyperlinks)
+    {
+        write();
+        return;
+    }
+
+    hyperlink_ids before;
+    _CollectHyperlinks(before);
+
+    write();
+
+    hyperlink_ids after;
+    _CollectHyperlinks(after);
+    for (const auto id : after)
+    {
+        _table->AddHyperlinkReference(id);
+    }
+    for (const auto id : before)
+    {
+        _table->ReleaseHyperlinkReference(id);
+    }
+    _hasHyperlinks = !after.empty();
 }
 
 ATTR_ROW::const_iterator ATTR_ROW::begin() const noexcept
 {
-    return _data.begin();
+    return { _data.begin(), _table };
 }
 
 ATTR_ROW::const_iterator ATTR_ROW::end() const noexcept
 {
-    return _data.end();
+    return { _data.end(), _table };
 }
 
 ATTR_ROW::const_iterator ATTR_ROW::cbegin() const noexcept
 {
-    return _data.cbegin();
+    return { _data.cbegin(), _table };
 }
 
 ATTR_ROW::const_iterator ATTR_ROW::cend() const noexcept
 {
-    return _data.cend();
+    return { _data.cend(), _table };
 }
 
 bool operator==(const ATTR_ROW& a, const ATTR_ROW& b) noexcept
 {
-    return a._data == b._data;
+    if (a._table == b._table)
+    {
+        return a._data == b._data;
+    }
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
 }
@@ -22,20 +22,111 @@ Revision History:
 
 #include "til/rle.h"
 #include "TextAttribute.hpp"
+#include "TextAttributeTable.hpp"
 
 class ATTR_ROW final
 {
-    using rle_vector = til::small_rle<TextAttribute, uint16_t, 1>;
-
 public:
-    using const_iterator = rle_vector::const_iterator;
-
-    ATTR_ROW(til::CoordType width, TextAttribute attr);
+    // The runs only store indices into the TextAttributeTable of the buffer.
+    using rle_vector = til::small_rle<TextAttributeTable::id_type, uint16_t, 1>;
+    // A run of attributes as it's passed to ReplaceRuns(), before it's interned.
+    using attr_run = til::rle_pair<TextAttribute, uint16_t>;
+
+    // Iterates over the attributes of the row, resolving the stored indices.
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = TextAttribute;
+        using pointer = const TextAttribute*;
+        using reference = const TextAttribute&;
+        using difference_type = rle_vector::const_iterator::difference_type;
+
+        const_iterator(rle_vector::const_iterator it, const TextAttributeTable* table) noexcept :
+            _it{ it },
+            _table{ table }
+        {
+        }
+
+        [[nodiscard]] reference operator*() const noexcept
+        {
+            return _table->Get(*_it);
+        }
+
+        [[nodiscard]] pointer operator->() const noexcept
+        {
+            return &operator*();
+        }
+
+        // The index the attribute is stored at. Two iterators over the same
+        // buffer point to equal attributes if and only if their ids are equal.
+        [[nodiscard]] TextAttributeTable::id_type id() const noexcept
+        {
+            return *_it;
+        }
+
+        const_iterator& operator++() noexcept
+        {
+            ++_it;
+            return *this;
+        }
+
+        const_iterator& operator--() noexcept
+        {
+            --_it;
+            return *this;
+        }
+
+        const_iterator& operator+=(const difference_type offset) noexcept
+        {
+            _it += offset;
+            return *this;
+        }
+
+        const_iterator& operator-=(const difference_type offset) noexcept
+        {
+            _it -= offset;
+            return *this;
+        }
+
+        [[nodiscard]] const_iterator operator+(const difference_type offset) const noexcept
+        {
+            return { _it + offset, _table };
+        }
+
+        [[nodiscard]] const_iterator operator-(const difference_type offset) const noexcept
+        {
+            return { _it - offset, _table };
+        }
+
+        [[nodiscard]] difference_type operator-(const const_iterator& right) const noexcept
+        {
+            return _it - right._it;
+        }
+
+        [[nodiscard]] reference operator[](const difference_type offset) const noexcept
+        {
+            return *operator+(offset);
+        }
+
+        [[nodiscard]] bool operator==(const const_iterator& right) const noexcept { return _it == right._it; }
+        [[nodiscard]] bool operator!=(const const_iterator& right) const noexcept { return _it != right._it; }
+        [[nodiscard]] bool operator<(const const_iterator& right) const noexcept { return _it < right._it; }
+        [[nodiscard]] bool operator>(const const_iterator& right) const noexcept { return _it > right._it; }
+        [[nodiscard]] bool operator<=(const const_iterator& right) const noexcept { return _it <= right._it; }
+        [[nodiscard]] bool operator>=(const const_iterator& right) const noexcept { return _it >= right._it; }
+
+    private:
+        rle_vector::const_iterator _it;
+        const TextAttributeTable* _table;
+    };
+
+    ATTR_ROW(til::CoordType width, TextAttribute attr, TextAttributeTable* const table);
 
     ~ATTR_ROW() = default;
 
-    ATTR_ROW(const ATTR_ROW&) = default;
-    ATTR_ROW& operator=(const ATTR_ROW&) = default;
+    ATTR_ROW(const ATTR_ROW& other);
+    ATTR_ROW& operator=(const ATTR_ROW& other);
     ATTR_ROW(ATTR_ROW&&)
     noexcept = default;
     ATTR_ROW& operator=(ATTR_ROW&&) noexcept = default;
@@ -43,10 +134,18 @@ public:
     TextAttribute GetAttrByColumn(til::CoordType column) const;
     std::vector<uint16_t> GetHyperlinks() const;
 
+    const rle_vector::container& GetRuns() const noexcept;
+    const TextAttribute& GetAttrById(const TextAttributeTable::id_type id) const noexcept;
+
     bool SetAttrToEnd(til::CoordType beginIndex, TextAttribute attr);
     void ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAttribute& replaceWith);
     void Resize(til::CoordType newWidth);
     void Replace(til::CoordType beginIndex, til::CoordType endIndex, const TextAttribute& newAttr);
+    void ReplaceRuns(til::CoordType beginIndex, gsl::span<const attr_run> newRuns);
+
+    rle_vector Reintern(TextAttributeTable& table) const;
+    void Rebind(rle_vector&& data, TextAttributeTable* const table) noexcept;
+    void ReleaseHyperlinks() noexcept;
 
     const_iterator begin() const noexcept;
     const_iterator end() const noexcept;
@@ -58,9 +157,17 @@ public:
     friend class ROW;
 
 private:
+    using hyperlink_ids = boost::container::small_vector<uint16_t, 4>;
+
     void Reset(const TextAttribute attr);
+    void _CollectHyperlinks(hyperlink_ids& ids) const;
+    template<typename Write>
+    void _WriteTrackingHyperlinks(const bool writesHyperlinks, Write&& write);
 
     rle_vector _data;
+    TextAttributeTable* _table; // non ownership pointer
+    // Whether any run refers to a hyperlink, and thus holds references in the table.
+    bool _hasHyperlinks = false;
 
 #ifdef UNIT_TESTING
     friend class CommonState;
@@ -0,0 +1,411 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "BufferSnapshot.hpp"
+
+#include "textBuffer.hpp"
+
+static_assert(std::is_trivially_copyable_v<TextAttribute>, "TextAttributes are stored in snapshots by copying their bytes");
+
+// The error for snapshots that are truncated, corrupt or were written by another version.
+static constexpr HRESULT InvalidSnapshot = __HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+static constexpr uint8_t WrapForcedFlag = 0x1;
+static constexpr uint8_t DoubleBytePaddedFlag = 0x2;
+
+// Reads the values of a snapshot one after another, starting at the given
+// offset. The data isn't necessarily aligned, and so values are copied.
+class BufferSnapshot::Reader
+{
+public:
+    Reader(const gsl::span<const std::byte> data, const uint64_t offset) :
+        _data{ data },
+        _offset{ offset }
+    {
+        THROW_HR_IF(InvalidSnapshot, offset > data.size());
+    }
+
+    template<typename T>
+    T Read()
+    {
+        T value;
+        memcpy(&value, Take(1, sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    std::wstring ReadString()
+    {
+        const auto length = Read<uint32_t>();
+        const auto bytes = Take(length, sizeof(wchar_t));
+        std::wstring text(length, L'\0');
+        memcpy(text.data(), bytes.data(), bytes.size());
+        return text;
+    }
+
+    gsl::span<const std::byte> Take(const uint64_t count, const size_t size)
+    {
+        const auto bytes = count * size;
+        THROW_HR_IF(InvalidSnapshot, bytes > _data.size() - _offset);
+        const auto result = _data.subspan(gsl::narrow_cast<size_t>(_offset), gsl::narrow_cast<size_t>(bytes));
+        _offset += bytes;
+        return result;
+    }
+
+private:
+    gsl::span<const std::byte> _data;
+    uint64_t _offset;
+};
+
+template<typename T>
+static void appendBytes(std::vector<std::byte>& data, const T* const items, const size_t count)
+{
+    const auto bytes = reinterpret_cast<const std::byte*>(items);
+    data.insert(data.end(), bytes, bytes + count * sizeof(T));
+}
+
+template<typename T>
+static void appendValue(std::vector<std::byte>& data, const T& value)
+{
+    appendBytes(data, &value, 1);
+}
+
+static constexpr DbcsAttribute::Attribute dbcsAttributeOf(const DbcsAttribute& attribute) noexcept
+{
+    if (attribute.IsLeading())
+    {
+        return DbcsAttribute::Attribute::Leading;
+    }
+    if (attribute.IsTrailing())
+    {
+        return DbcsAttribute::Attribute::Trailing;
+    }
+    return DbcsAttribute::Attribute::Single;
+}
+
+static void appendString(std::vector<std::byte>& data, const std::wstring_view text)
+{
+    appendValue(data, gsl::narrow<uint32_t>(text.size()));
+    appendBytes(data, text.data(), text.size());
+}
+
+// Routine Description:
+// - Serializes the contents of a buffer: its rows, the hyperlinks referred to
+//   by their attributes, the cursor position and the current attributes.
+// Arguments:
+// - buffer - the buffer to serialize
+// Return Value:
+// - the snapshot, which can be passed to the BufferSnapshot constructor
+std::vector<std::byte> BufferSnapshot::Create(const TextBuffer& buffer)
+{
+    const auto size = buffer.GetSize().Dimensions();
+
+    // Every distinct attribute of the buffer is stored once, in the order
+    // they're first used, and the runs of the rows refer to them by index.
+    std::vector<TextAttribute> attributes;
+    std::vector<uint32_t> attributeIndices;
+
+    // The rows are serialized first, because we only know which
+    // attributes are in use once all of them were visited.
+    std::vector<std::byte> rows;
+    std::vector<uint64_t> rowOffsets;
+    rowOffsets.reserve(size.height);
+
+    for (til::CoordType y = 0; y < size.height; y++)
+    {
+        const auto& row = buffer.GetRowByOffset(y);
+        const auto& charRow = row.GetCharRow();
+        const auto& attrRow = row.GetAttrRow();
+        const auto cells = gsl::make_span(charRow.begin(), charRow.end());
+
+        // Trailing blanks aren't stored, which is what most of a typical scrollback consists of.
+        auto cellCount = cells.size();
+        while (cellCount > 0 && cells[cellCount - 1].IsSpace() && cells[cellCount - 1].DbcsAttr().IsSingle())
+        {
+            cellCount--;
+        }
+
+        uint8_t flags = 0;
+        WI_SetFlagIf(flags, WrapForcedFlag, row.WasWrapForced());
+        WI_SetFlagIf(flags, DoubleBytePaddedFlag, row.WasDoubleBytePadded());
+
+        const auto& runs = attrRow.GetRuns();
+        const auto glyphCount = std::count_if(cells.begin(), cells.begin() + cellCount, [](const CharRowCell& cell) noexcept {
+            return cell.DbcsAttr().IsGlyphStored();
+        });
+
+        rowOffsets.emplace_back(rows.size());
+        appendValue(rows, RowHeader{ gsl::narrow_cast<uint32_t>(cellCount), gsl::narrow<uint32_t>(runs.size()), gsl::narrow_cast<uint32_t>(glyphCount), static_cast<uint8_t>(row.GetLineRendition()), flags, 0 });
+
+        for (size_t x = 0; x < cellCount; x++)
+        {
+            appendValue(rows, cells[x].Char());
+        }
+        // The DBCS attributes are padded to an even length, to keep the following values aligned where possible.
+        for (size_t x = 0; x < (cellCount + 1) / 2 * 2; x++)
+        {
+            appendValue(rows, x < cellCount ? dbcsAttributeOf(cells[x].DbcsAttr()) : DbcsAttribute::Attribute::Single);
+        }
+
+        for (const auto& run : runs)
+        {
+            if (run.value >= attributeIndices.size())
+            {
+                attributeIndices.resize(run.value + size_t{ 1 }, UINT32_MAX);
+            }
+            auto& index = til::at(attributeIndices, run.value);
+            if (index == UINT32_MAX)
+            {
+                index = gsl::narrow_cast<uint32_t>(attributes.size());
+                attributes.emplace_back(attrRow.GetAttrById(run.value));
+            }
+            appendValue(rows, Run{ index, run.length });
+        }
+
+        for (size_t x = 0; x < cellCount; x++)
+        {
+            if (cells[x].DbcsAttr().IsGlyphStored())
+            {
+                appendValue(rows, gsl::narrow_cast<int32_t>(x));
+                appendString(rows, charRow.GlyphAt(gsl::narrow_cast<til::CoordType>(x)));
+            }
+        }
+    }
+
+    std::vector<std::byte> data;
+    data.reserve(sizeof(Header) + (attributes.size() + 1) * sizeof(TextAttribute) + rowOffsets.size() * sizeof(uint64_t) + rows.size());
+
+    Header header{};
+    header.magic = Magic;
+    header.version = Version;
+    header.width = size.width;
+    header.height = size.height;
+    header.cursorX = buffer.GetCursor().GetPosition().x;
+    header.cursorY = buffer.GetCursor().GetPosition().y;
+    header.attributeCount = gsl::narrow<uint32_t>(attributes.size());
+    header.hyperlinkCount = gsl::narrow<uint32_t>(buffer._hyperlinkMap.size());
+    header.customIdCount = gsl::narrow<uint32_t>(buffer._hyperlinkCustomIdMap.size());
+    header.currentHyperlinkId = buffer._currentHyperlinkId;
+    header.hyperlinkIdsWrapped = buffer._hyperlinkIdsWrapped;
+    appendValue(data, header);
+
+    appendValue(data, buffer.GetCurrentAttributes());
+    appendBytes(data, attributes.data(), attributes.size());
+
+    header.hyperlinkOffset = data.size();
+    for (const auto& hyperlink : buffer._hyperlinkMap)
+    {
+        appendValue(data, hyperlink.first);
+        appendString(data, hyperlink.second);
+    }
+    for (const auto& customId : buffer._hyperlinkCustomIdMap)
+    {
+        appendValue(data, customId.second);
+        appendString(data, customId.first);
+    }
+
+    header.rowTableOffset = data.size();
+    const auto rowsOffset = header.rowTableOffset + rowOffsets.size() * sizeof(uint64_t);
+    for (const auto offset : rowOffsets)
+    {
+        appendValue(data, rowsOffset + offset);
+    }
+    data.insert(data.end(), rows.begin(), rows.end());
+
+    // The offsets are only known now that everything before them was written.
+    memcpy(data.data(), &header, sizeof(header));
+    return data;
+}
+
+// Routine Description:
+// - Writes the snapshot of a buffer to a file, which can be loaded with FromFile().
+// Arguments:
+// - buffer - the buffer to serialize
+// - path - the file to write to, which is replaced if it exists
+void BufferSnapshot::SaveToFile(const TextBuffer& buffer, const std::wstring& path)
+{
+    const auto data = Create(buffer);
+
+    const wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    THROW_LAST_ERROR_IF(!file);
+
+    DWORD written = 0;
+    THROW_IF_WIN32_BOOL_FALSE(WriteFile(file.get(), data.data(), gsl::narrow<DWORD>(data.size()), &written, nullptr));
+    THROW_HR_IF(E_FAIL, written != data.size());
+}
+
+// Routine Description:
+// - Wraps the given snapshot, without copying it. It validates the header
+//   and the table of rows, but the rows themselves are only decoded once
+//   they get restored, at which point they're validated as well.
+// Arguments:
+// - data - the snapshot, as returned by Create(). It must outlive this object.
+BufferSnapshot::BufferSnapshot(const gsl::span<const std::byte> data) :
+    _data{ data },
+    _header{},
+    _currentAttributes{}
+{
+    Reader reader{ data, 0 };
+    _header = reader.Read<Header>();
+    THROW_HR_IF(InvalidSnapshot, _header.magic != Magic || _header.version != Version);
+    THROW_HR_IF(InvalidSnapshot, _header.width <= 0 || _header.width > SHRT_MAX || _header.height <= 0 || _header.height > SHRT_MAX);
+
+    _currentAttributes = reader.Read<TextAttribute>();
+    const auto attributes = reader.Take(_header.attributeCount, sizeof(TextAttribute));
+    _attributes.resize(_header.attributeCount);
+    memcpy(_attributes.data(), attributes.data(), attributes.size());
+
+    Reader rowTable{ data, _header.rowTableOffset };
+    for (til::CoordType y = 0; y < _header.height; y++)
+    {
+        THROW_HR_IF(InvalidSnapshot, rowTable.Read<uint64_t>() > data.size() - sizeof(RowHeader));
+    }
+}
+
+// Routine Description:
+// - Maps a snapshot written by SaveToFile() into memory. Only the header and the
+//   table of rows are read, and each row is paged in once it's restored.
+// Arguments:
+// - path - the file to read
+// Return Value:
+// - the snapshot, which holds a view of the file until it's destroyed
+BufferSnapshot BufferSnapshot::FromFile(const std::wstring& path)
+{
+    const wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    THROW_LAST_ERROR_IF(!file);
+
+    LARGE_INTEGER size{};
+    THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &size));
+    THROW_HR_IF(InvalidSnapshot, size.QuadPart < static_cast<LONGLONG>(sizeof(Header)));
+
+    const wil::unique_handle mapping{ CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr) };
+    THROW_LAST_ERROR_IF(!mapping);
+
+    // The view keeps the mapping alive on its own.
+    wil::unique_mapview_ptr<std::byte> view{ static_cast<std::byte*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0)) };
+    THROW_LAST_ERROR_IF(!view);
+
+    BufferSnapshot snapshot{ { view.get(), gsl::narrow<size_t>(size.QuadPart) } };
+    snapshot._view = std::move(view);
+    return snapshot;
+}
+
+til::size BufferSnapshot::GetSize() const noexcept
+{
+    return { _header.width, _header.height };
+}
+
+// Routine Description:
+// - Restores the entire snapshot into a buffer.
+// Arguments:
+// - buffer - a buffer of the snapshot's size, usually a newly created one
+void BufferSnapshot::Restore(TextBuffer& buffer) const
+{
+    RestoreProperties(buffer);
+    RestoreRows(buffer, 0, _header.height);
+}
+
+// Routine Description:
+// - Restores everything but the rows: the hyperlinks, the cursor position and
+//   the current attributes. This must happen before any rows are restored,
+//   so that the hyperlinks the rows refer to exist once they're shown.
+// Arguments:
+// - buffer - a buffer of the snapshot's size, usually a newly created one
+void BufferSnapshot::RestoreProperties(TextBuffer& buffer) const
+{
+    THROW_HR_IF(E_INVALIDARG, buffer.GetSize().Dimensions() != GetSize());
+
+    decltype(buffer._hyperlinkMap) hyperlinks;
+    decltype(buffer._hyperlinkCustomIdMap) customIds;
+    Reader reader{ _data, _header.hyperlinkOffset };
+    for (uint32_t i = 0; i < _header.hyperlinkCount; i++)
+    {
+        const auto id = reader.Read<uint16_t>();
+        hyperlinks.insert_or_assign(id, reader.ReadString());
+    }
+    for (uint32_t i = 0; i < _header.customIdCount; i++)
+    {
+        const auto id = reader.Read<uint16_t>();
+        customIds.insert_or_assign(reader.ReadString(), id);
+    }
+
+    buffer._hyperlinkMap = std::move(hyperlinks);
+    buffer._hyperlinkCustomIdMap = std::move(customIds);
+    buffer._currentHyperlinkId = _header.currentHyperlinkId ? _header.currentHyperlinkId : 1;
+    buffer._hyperlinkIdsWrapped = _header.hyperlinkIdsWrapped != 0;
+    buffer._recycledHyperlinkIds.clear();
+
+    buffer.SetCurrentAttributes(_currentAttributes);
+    til::point cursorPosition{ _header.cursorX, _header.cursorY };
+    buffer.GetSize().Clamp(cursorPosition);
+    buffer.GetCursor().SetPosition(cursorPosition);
+}
+
+// Routine Description:
+// - Restores a range of rows. Restoring a session can thus restore the rows
+//   of the viewport right away and those of the scrollback later on.
+// Arguments:
+// - buffer - the buffer to restore the rows of, which RestoreProperties() was called for
+// - firstRow - the first row to restore, counted from the top of the buffer
+// - lastRow - the row past the last one to restore
+void BufferSnapshot::RestoreRows(TextBuffer& buffer, const til::CoordType firstRow, const til::CoordType lastRow) const
+{
+    THROW_HR_IF(E_INVALIDARG, buffer.GetSize().Dimensions() != GetSize());
+    THROW_HR_IF(E_INVALIDARG, firstRow < 0 || lastRow > _header.height || firstRow > lastRow);
+
+    for (auto y = firstRow; y < lastRow; y++)
+    {
+        _RestoreRow(buffer, y);
+    }
+}
+
+void BufferSnapshot::_RestoreRow(TextBuffer& buffer, const til::CoordType y) const
+{
+    Reader rowTable{ _data, _header.rowTableOffset + gsl::narrow_cast<uint64_t>(y) * sizeof(uint64_t) };
+    Reader reader{ _data, rowTable.Read<uint64_t>() };
+
+    const auto header = reader.Read<RowHeader>();
+    THROW_HR_IF(InvalidSnapshot, header.cellCount > gsl::narrow_cast<uint32_t>(_header.width));
+    THROW_HR_IF(InvalidSnapshot, header.lineRendition > static_cast<uint8_t>(LineRendition::DoubleHeightBottom));
+
+    const auto chars = reader.Take(header.cellCount, sizeof(wchar_t));
+    const auto dbcsAttributes = reader.Take((header.cellCount + 1) / 2 * 2, sizeof(DbcsAttribute::Attribute));
+
+    auto& row = buffer.GetRowByOffset(y);
+    row.Reset(buffer.GetCurrentAttributes());
+
+    auto& charRow = row.GetCharRow();
+    auto cell = charRow.begin();
+    for (size_t x = 0; x < header.cellCount; x++, ++cell)
+    {
+        wchar_t ch;
+        memcpy(&ch, chars.data() + x * sizeof(wchar_t), sizeof(wchar_t));
+        const auto attribute = static_cast<DbcsAttribute::Attribute>(dbcsAttributes[x]);
+        THROW_HR_IF(InvalidSnapshot, attribute != DbcsAttribute::Attribute::Single && attribute != DbcsAttribute::Attribute::Leading && attribute != DbcsAttribute::Attribute::Trailing);
+        *cell = CharRowCell{ ch, DbcsAttribute{ attribute } };
+    }
+
+    boost::container::small_vector<ATTR_ROW::attr_run, 16> runs;
+    runs.reserve(header.runCount);
+    uint32_t columns = 0;
+    for (uint32_t i = 0; i < header.runCount; i++)
+    {
+        const auto run = reader.Read<Run>();
+        THROW_HR_IF(InvalidSnapshot, run.attribute >= _attributes.size() || run.length > gsl::narrow_cast<uint32_t>(_header.width) - columns);
+        columns += run.length;
+        runs.emplace_back(til::at(_attributes, run.attribute), gsl::narrow_cast<uint16_t>(run.length));
+    }
+    row.GetAttrRow().ReplaceRuns(0, { runs.data(), runs.size() });
+
+    for (uint32_t i = 0; i < header.glyphCount; i++)
+    {
+        const auto column = reader.Read<int32_t>();
+        const auto glyph = reader.ReadString();
+        THROW_HR_IF(InvalidSnapshot, column < 0 || column >= gsl::narrow_cast<int32_t>(header.cellCount) || glyph.empty());
+        charRow.GlyphAt(column) = glyph;
+    }
+
+    row.SetLineRendition(static_cast<LineRendition>(header.lineRendition));
+    row.SetWrapForced(WI_IsFlagSet(header.flags, WrapForcedFlag));
+    row.SetDoubleBytePadded(WI_IsFlagSet(header.flags, DoubleBytePaddedFlag));
+}
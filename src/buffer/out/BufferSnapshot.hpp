@@ -0,0 +1,95 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- BufferSnapshot.hpp
+
+Abstract:
+- A compact binary copy of the contents of a TextBuffer, used to restore a
+  buffer without replaying its contents as VT (restoring a session, or moving
+  a tab to another window).
+- The rows are stored as their text, trimmed of trailing blanks, plus their
+  attribute runs, which refer to a table of the buffer's distinct attributes.
+  Glyphs that don't fit into a single cell and the hyperlinks are stored too.
+- The format is read in place, so that a snapshot can be memory mapped from
+  a file: Loading one only validates its header and entire row table, and the
+  rows themselves are decoded once they're restored. Since every row can
+  be found through the row table, callers can restore the rows they need to
+  show first and the rest of the scrollback later.
+- Snapshots are only meant to be read by the same build that wrote them,
+  and ImageSlices are not included.
+--*/
+
+#pragma once
+
+#include "TextAttribute.hpp"
+
+class TextBuffer;
+
+class BufferSnapshot final
+{
+public:
+    static std::vector<std::byte> Create(const TextBuffer& buffer);
+    static void SaveToFile(const TextBuffer& buffer, const std::wstring& path);
+
+    explicit BufferSnapshot(const gsl::span<const std::byte> data);
+    static BufferSnapshot FromFile(const std::wstring& path);
+
+    til::size GetSize() const noexcept;
+
+    void Restore(TextBuffer& buffer) const;
+    void RestoreProperties(TextBuffer& buffer) const;
+    void RestoreRows(TextBuffer& buffer, const til::CoordType firstRow, const til::CoordType lastRow) const;
+
+private:
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        int32_t width;
+        int32_t height;
+        int32_t cursorX;
+        int32_t cursorY;
+        uint32_t attributeCount;
+        uint32_t hyperlinkCount;
+        uint32_t customIdCount;
+        uint16_t currentHyperlinkId;
+        uint8_t hyperlinkIdsWrapped;
+        uint8_t reserved;
+        uint64_t hyperlinkOffset;
+        uint64_t rowTableOffset;
+    };
+
+    struct RowHeader
+    {
+        // The number of cells stored, all others are blanks.
+        uint32_t cellCount;
+        uint32_t runCount;
+        uint32_t glyphCount;
+        uint8_t lineRendition;
+        uint8_t flags;
+        uint16_t reserved;
+    };
+
+    struct Run
+    {
+        uint32_t attribute;
+        uint32_t length;
+    };
+
+    class Reader;
+
+    static constexpr uint32_t Magic = 0x53425457; // "WTBS"
+    // Version 2: TextAttribute shrunk from 14 to 12 bytes.
+    static constexpr uint32_t Version = 2;
+
+    void _RestoreRow(TextBuffer& buffer, const til::CoordType row) const;
+
+    gsl::span<const std::byte> _data;
+    Header _header;
+    TextAttribute _currentAttributes;
+    std::vector<TextAttribute> _attributes;
+    // Only set if the snapshot was mapped from a file, for which _data is a view of it.
+    wil::unique_mapview_ptr<std::byte> _view;
+};
@@ -10,19 +10,16 @@
 // Routine Description:
 // - constructor
 // Arguments:
+// - buffer - the rowWidth cells of the parent TextBuffer's arena this row will use
 // - rowWidth - the size (in wchar_t) of the char and attribute rows
-// - pParent - the parent ROW
 // Return Value:
 // - instantiated object
-// Note: will through if unable to allocate char/attribute buffers
-#pragma warning(push)
-#pragma warning(disable : 26447) // small_vector's constructor says it can throw but it should not given how we use it.  This suppresses this error for the AuditMode build.
-CharRow::CharRow(til::CoordType rowWidth, ROW* const pParent) noexcept :
-    _data(rowWidth, value_type()),
-    _pParent{ FAIL_FAST_IF_NULL(pParent) }
+CharRow::CharRow(value_type* const buffer, til::CoordType rowWidth) noexcept :
+    _data{ buffer },
+    _size{ rowWidth },
+    _unicodeStorage{}
 {
 }
-#pragma warning(pop)
 
 // Routine Description:
 // - gets the size of the row, in glyph cells
@@ -32,7 +29,7 @@ CharRow::CharRow(til::CoordType rowWidth, ROW* const pParent) noexcept :
 // - the size of the row
 til::CoordType CharRow::size() const noexcept
 {
-    return gsl::narrow_cast<til::CoordType>(_data.size());
+    return _size;
 }
 
 // Routine Description:
@@ -43,49 +40,83 @@ til::CoordType CharRow::size() const noexcept
 // - <none>
 void CharRow::Reset() noexcept
 {
-    for (auto& cell : _data)
+    for (auto& cell : *this)
     {
         cell.Reset();
     }
+    _unicodeStorage.Clear();
 }
 
 // Routine Description:
 // - resizes the width of the CharRowBase
+// - The existing cells are copied into the given buffer, which is expected to be
+//   freshly initialized to default (space) cells, and the row is rebound to it.
+// - If the buffer is the one the row already uses, the row is resized in place.
+//   The slice it was given must then be large enough for the new width. Cells
+//   it grows into are reset, since they may hold what was there before a shrink.
+// - Glyphs stored for columns beyond the new width are dropped.
 // Arguments:
+// - buffer - the newSize cells this row will use from now on
 // - newSize - the new width of the character and attributes rows
 // Return Value:
-// - S_OK on success, otherwise relevant error code
-[[nodiscard]] HRESULT CharRow::Resize(const til::CoordType newSize) noexcept
+// - <none>
+void CharRow::Resize(value_type* const buffer, const til::CoordType newSize) noexcept
 {
-    try
+    if (buffer != _data)
     {
-        const value_type insertVals;
-        _data.resize(newSize, insertVals);
+        std::copy_n(_data, std::min(_size, newSize), buffer);
     }
-    CATCH_RETURN();
-
-    return S_OK;
+    else if (newSize > _size)
+    {
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+        std::fill(_data + _size, _data + newSize, value_type{});
+    }
+    _data = buffer;
+    _size = newSize;
+    _unicodeStorage.Truncate(newSize);
 }
 
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
 typename CharRow::iterator CharRow::begin() noexcept
 {
-    return _data.begin();
+    return _data;
 }
 
 typename CharRow::const_iterator CharRow::cbegin() const noexcept
 {
-    return _data.cbegin();
+    return _data;
 }
 
 typename CharRow::iterator CharRow::end() noexcept
 {
-    return _data.end();
+    return _data + _size;
 }
 
 typename CharRow::const_iterator CharRow::cend() const noexcept
 {
-    return _data.cend();
+    return _data + _size;
+}
+
+// Routine Description:
+// - bounds checked access to the cell at the given column
+// Arguments:
+// - column - the column to get the cell for
+// Return Value:
+// - the cell
+// Note: will throw exception if column is out of bounds
+CharRow::value_type& CharRow::_at(const til::CoordType column)
+{
+    THROW_HR_IF(E_INVALIDARG, column < 0 || column >= _size);
+    return _data[column];
+}
+
+const CharRow::value_type& CharRow::_at(const til::CoordType column) const
+{
+    THROW_HR_IF(E_INVALIDARG, column < 0 || column >= _size);
+    return _data[column];
 }
+#pragma warning(pop)
 
 // Routine Description:
 // - Inspects the current internal string to find the left edge of it
@@ -95,12 +126,12 @@ typename CharRow::const_iterator CharRow::cend() const noexcept
 // - The calculated left boundary of the internal string.
 til::CoordType CharRow::MeasureLeft() const noexcept
 {
-    auto it = _data.cbegin();
-    while (it != _data.cend() && it->IsSpace())
+    auto it = cbegin();
+    while (it != cend() && it->IsSpace())
     {
         ++it;
     }
-    return gsl::narrow_cast<til::CoordType>(it - _data.cbegin());
+    return gsl::narrow_cast<til::CoordType>(it - cbegin());
 }
 
 // Routine Description:
@@ -111,17 +142,75 @@ til::CoordType CharRow::MeasureLeft() const noexcept
 // - The calculated right boundary of the internal string.
 til::CoordType CharRow::MeasureRight() const
 {
-    auto it = _data.crbegin();
-    while (it != _data.crend() && it->IsSpace())
+    const_reverse_iterator it{ cend() };
+    const const_reverse_iterator rend{ cbegin() };
+    while (it != rend && it->IsSpace())
     {
         ++it;
     }
-    return gsl::narrow_cast<til::CoordType>(_data.crend() - it);
+    return gsl::narrow_cast<til::CoordType>(rend - it);
 }
 
 void CharRow::ClearCell(const til::CoordType column)
 {
-    _data.at(column).Reset();
+    _at(column).Reset();
+    _unicodeStorage.Erase(column);
+}
+
+// Routine Description:
+// - overwrites the cells starting at column with the given characters,
+//   each of which has to be a narrow glyph that fits into a single cell.
+// - This is the bulk equivalent of assigning every character to its GlyphAt()
+//   and resetting its DbcsAttrAt() to single.
+// Arguments:
+// - column - the first column to write to
+// - chars - the characters to write, one per cell
+// Note: will throw exception if the characters don't fit into the row
+void CharRow::WriteNarrowGlyphs(const til::CoordType column, const std::wstring_view chars)
+{
+    const auto count = gsl::narrow<til::CoordType>(chars.size());
+    THROW_HR_IF(E_INVALIDARG, column < 0 || count > _size - column);
+
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    std::transform(chars.begin(), chars.end(), _data + column, [](const wchar_t wch) noexcept {
+        return value_type{ wch, DbcsAttribute{} };
+    });
+    _unicodeStorage.Erase(column, column + count);
+}
+
+// Routine Description:
+// - overwrites the cells starting at column with the characters of the given
+//   CHAR_INFOs, none of which may be flagged as a leading or trailing byte.
+// Arguments:
+// - column - the first column to write to
+// - charInfos - the characters to write, one per cell
+// Note: will throw exception if the characters don't fit into the row
+void CharRow::WriteNarrowGlyphs(const til::CoordType column, const gsl::span<const CHAR_INFO> charInfos)
+{
+    const auto count = gsl::narrow<til::CoordType>(charInfos.size());
+    THROW_HR_IF(E_INVALIDARG, column < 0 || count > _size - column);
+
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    std::transform(charInfos.begin(), charInfos.end(), _data + column, [](const CHAR_INFO& charInfo) noexcept {
+        return value_type{ charInfo.Char.UnicodeChar, DbcsAttribute{} };
+    });
+    _unicodeStorage.Erase(column, column + count);
+}
+
+// Routine Description:
+// - overwrites count cells starting at column with the same narrow character.
+// Arguments:
+// - column - the first column to write to
+// - count - the number of cells to write
+// - wch - the character to write into every cell
+// Note: will throw exception if the cells don't fit into the row
+void CharRow::FillNarrowGlyph(const til::CoordType column, const til::CoordType count, const wchar_t wch)
+{
+    THROW_HR_IF(E_INVALIDARG, column < 0 || count < 0 || count > _size - column);
+
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    std::fill_n(_data + column, count, value_type{ wch, DbcsAttribute{} });
+    _unicodeStorage.Erase(column, column + count);
 }
 
 // Routine Description:
@@ -132,7 +221,7 @@ void CharRow::ClearCell(const til::CoordType column)
 // - True if there is valid text in this row. False otherwise.
 bool CharRow::ContainsText() const noexcept
 {
-    for (const auto& cell : _data)
+    for (const auto& cell : *this)
     {
         if (!cell.IsSpace())
         {
@@ -151,7 +240,7 @@ bool CharRow::ContainsText() const noexcept
 // Note: will throw exception if column is out of bounds
 const DbcsAttribute& CharRow::DbcsAttrAt(const til::CoordType column) const
 {
-    return _data.at(column).DbcsAttr();
+    return _at(column).DbcsAttr();
 }
 
 // Routine Description:
@@ -163,7 +252,7 @@ const DbcsAttribute& CharRow::DbcsAttrAt(const til::CoordType column) const
 // Note: will throw exception if column is out of bounds
 DbcsAttribute& CharRow::DbcsAttrAt(const til::CoordType column)
 {
-    return _data.at(column).DbcsAttr();
+    return _at(column).DbcsAttr();
 }
 
 // Routine Description:
@@ -175,7 +264,7 @@ DbcsAttribute& CharRow::DbcsAttrAt(const til::CoordType column)
 // Note: will throw exception if column is out of bounds
 void CharRow::ClearGlyph(const til::CoordType column)
 {
-    _data.at(column).EraseChars();
+    _at(column).EraseChars();
 }
 
 // Routine Description:
@@ -187,7 +276,7 @@ void CharRow::ClearGlyph(const til::CoordType column)
 // - Note: will throw exception if column is out of bounds
 const CharRow::reference CharRow::GlyphAt(const til::CoordType column) const
 {
-    THROW_HR_IF(E_INVALIDARG, column < 0 || column >= gsl::narrow_cast<til::CoordType>(_data.size()));
+    THROW_HR_IF(E_INVALIDARG, column < 0 || column >= _size);
     return { const_cast<CharRow&>(*this), column };
 }
 
@@ -200,16 +289,16 @@ const CharRow::reference CharRow::GlyphAt(const til::CoordType column) const
 // - Note: will throw exception if column is out of bounds
 CharRow::reference CharRow::GlyphAt(const til::CoordType column)
 {
-    THROW_HR_IF(E_INVALIDARG, column < 0 || column >= gsl::narrow_cast<til::CoordType>(_data.size()));
+    THROW_HR_IF(E_INVALIDARG, column < 0 || column >= _size);
     return { *this, column };
 }
 
 std::wstring CharRow::GetText() const
 {
     std::wstring wstr;
-    wstr.reserve(_data.size());
+    wstr.reserve(_size);
 
-    for (til::CoordType i = 0; i < gsl::narrow_cast<til::CoordType>(_data.size()); ++i)
+    for (til::CoordType i = 0; i < _size; ++i)
     {
         const auto glyph = GlyphAt(i);
         if (!DbcsAttrAt(i).IsTrailing())
@@ -233,7 +322,7 @@ std::wstring CharRow::GetText() const
 // - the delimiter class for the given char
 const DelimiterClass CharRow::DelimiterClassAt(const til::CoordType column, const std::wstring_view wordDelimiters) const
 {
-    THROW_HR_IF(E_INVALIDARG, column < 0 || column >= gsl::narrow_cast<til::CoordType>(_data.size()));
+    THROW_HR_IF(E_INVALIDARG, column < 0 || column >= _size);
 
     const auto glyph = *GlyphAt(column).begin();
     if (glyph <= UNICODE_SPACE)
@@ -252,30 +341,10 @@ const DelimiterClass CharRow::DelimiterClassAt(const til::CoordType column, cons
 
 UnicodeStorage& CharRow::GetUnicodeStorage() noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    return _unicodeStorage;
 }
 
 const UnicodeStorage& CharRow::GetUnicodeStorage() const noexcept
 {
-    return _pParent->GetUnicodeStorage();
-}
-
-// Routine Description:
-// - calculates the key used by the given column of the char row to store glyph data in UnicodeStorage
-// Arguments:
-// - column - the column to generate the key for
-// Return Value:
-// - the til::point key for data access from UnicodeStorage for the column
-til::point CharRow::GetStorageKey(const til::CoordType column) const noexcept
-{
-    return { column, _pParent->GetId() };
-}
-
-// Routine Description:
-// - Updates the pointer to the parent row (which might change if we shuffle the rows around)
-// Arguments:
-// - pParent - Pointer to the parent row
-void CharRow::UpdateParent(ROW* const pParent)
-{
-    _pParent = FAIL_FAST_IF_NULL(pParent);
+    return _unicodeStorage;
 }
@@ -49,15 +49,15 @@ class CharRow final
 public:
     using glyph_type = typename wchar_t;
     using value_type = typename CharRowCell;
-    using iterator = typename boost::container::small_vector_base<value_type>::iterator;
-    using const_iterator = typename boost::container::small_vector_base<value_type>::const_iterator;
-    using const_reverse_iterator = typename boost::container::small_vector_base<value_type>::const_reverse_iterator;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
     using reference = typename CharRowCellReference;
 
-    CharRow(til::CoordType rowWidth, ROW* const pParent) noexcept;
+    CharRow(value_type* const buffer, til::CoordType rowWidth) noexcept;
 
     til::CoordType size() const noexcept;
-    [[nodiscard]] HRESULT Resize(const til::CoordType newSize) noexcept;
+    void Resize(value_type* const buffer, const til::CoordType newSize) noexcept;
     til::CoordType MeasureLeft() const noexcept;
     til::CoordType MeasureRight() const;
     bool ContainsText() const noexcept;
@@ -82,9 +82,6 @@ public:
 
     UnicodeStorage& GetUnicodeStorage() noexcept;
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
-    til::point GetStorageKey(const til::CoordType column) const noexcept;
-
-    void UpdateParent(ROW* const pParent);
 
     friend CharRowCellReference;
     friend class ROW;
@@ -92,14 +89,22 @@ public:
 private:
     void Reset() noexcept;
     void ClearCell(const til::CoordType column);
+    void WriteNarrowGlyphs(const til::CoordType column, const std::wstring_view chars);
+    void WriteNarrowGlyphs(const til::CoordType column, const gsl::span<const CHAR_INFO> charInfos);
+    void FillNarrowGlyph(const til::CoordType column, const til::CoordType count, const wchar_t wch);
     std::wstring GetText() const;
 
+    value_type& _at(const til::CoordType column);
+    const value_type& _at(const til::CoordType column) const;
+
 protected:
-    // storage for glyph data and dbcs attributes
-    boost::container::small_vector<value_type, 120> _data;
+    // storage for glyph data and dbcs attributes. The cells aren't owned by
+    // the CharRow, but are a slice of the arena held by the parent TextBuffer.
+    value_type* _data;
+    til::CoordType _size;
 
-    // ROW that this CharRow belongs to
-    ROW* _pParent;
+    // the glyphs of this row that don't fit into a single CharRowCell
+    UnicodeStorage _unicodeStorage;
 };
 
 template<typename InputIt1, typename InputIt2>
@@ -15,13 +15,15 @@ void CharRowCellReference::operator=(const std::wstring_view chars)
     if (chars.size() == 1)
     {
         _cellData().Char() = chars.front();
-        _cellData().DbcsAttr().SetGlyphStored(false);
+        if (_cellData().DbcsAttr().IsGlyphStored())
+        {
+            _parent.GetUnicodeStorage().Erase(_index);
+            _cellData().DbcsAttr().SetGlyphStored(false);
+        }
     }
     else
     {
-        auto& storage = _parent.GetUnicodeStorage();
-        const auto key = _parent.GetStorageKey(_index);
-        storage.StoreGlyph(key, { chars.cbegin(), chars.cend() });
+        _parent.GetUnicodeStorage().StoreGlyph(_index, { chars.cbegin(), chars.cend() });
         _cellData().DbcsAttr().SetGlyphStored(true);
     }
 }
@@ -41,7 +43,7 @@ CharRowCellReference::operator std::wstring_view() const
 // - ref to the CharRowCell
 CharRowCell& CharRowCellReference::_cellData()
 {
-    return _parent._data.at(_index);
+    return _parent._at(_index);
 }
 
 // Routine Description:
@@ -50,7 +52,7 @@ CharRowCell& CharRowCellReference::_cellData()
 // - ref to the CharRowCell
 const CharRowCell& CharRowCellReference::_cellData() const
 {
-    return _parent._data.at(_index);
+    return _parent._at(_index);
 }
 
 // Routine Description:
@@ -61,7 +63,7 @@ std::wstring_view CharRowCellReference::_glyphData() const
 {
     if (_cellData().DbcsAttr().IsGlyphStored())
     {
-        const auto& text = _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index));
+        const auto& text = _parent.GetUnicodeStorage().GetText(_index);
 
         return { text.data(), text.size() };
     }
@@ -79,7 +81,7 @@ CharRowCellReference::const_iterator CharRowCellReference::begin() const
 {
     if (_cellData().DbcsAttr().IsGlyphStored())
     {
-        return _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index)).data();
+        return _parent.GetUnicodeStorage().GetText(_index).data();
     }
     else
     {
@@ -98,7 +100,7 @@ CharRowCellReference::const_iterator CharRowCellReference::end() const
 {
     if (_cellData().DbcsAttr().IsGlyphStored())
     {
-        const auto& chars = _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index));
+        const auto& chars = _parent.GetUnicodeStorage().GetText(_index);
         return chars.data() + chars.size();
     }
     else
@@ -125,7 +127,7 @@ bool operator==(const CharRowCellReference& ref, const std::vector<wchar_t>& gly
     }
     else
     {
-        const auto& chars = ref._parent.GetUnicodeStorage().GetText(ref._parent.GetStorageKey(ref._index));
+        const auto& chars = ref._parent.GetUnicodeStorage().GetText(ref._index);
         return chars == glyph;
     }
 }
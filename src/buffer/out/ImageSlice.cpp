@@ -0,0 +1,143 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "ImageSlice.hpp"
+
+// IDs are never reused, so that a renderer can't mistake a new slice for one it has cached.
+static std::atomic<uint64_t> s_nextId{ 1 };
+
+// Blends a premultiplied BGRA pixel over another one ("source over").
+static constexpr uint32_t blendPremultiplied(const uint32_t below, const uint32_t above) noexcept
+{
+    const auto inverseAlpha = 255 - (above >> 24);
+    if (inverseAlpha == 0)
+    {
+        return above;
+    }
+
+    uint32_t result = 0;
+    for (auto shift = 0; shift < 32; shift += 8)
+    {
+        const auto b = (below >> shift) & 0xff;
+        const auto a = (above >> shift) & 0xff;
+        result |= (a + (b * inverseAlpha + 127) / 255) << shift;
+    }
+    return result;
+}
+
+// Routine Description:
+// - constructs a fully transparent slice.
+// Arguments:
+// - cellSize - the size of a cell in pixels
+// - columnBegin - the first column of the row that the slice covers
+// - columnEnd - the column past the last one that the slice covers
+ImageSlice::ImageSlice(const til::size cellSize, const til::CoordType columnBegin, const til::CoordType columnEnd) :
+    _id{ s_nextId.fetch_add(1, std::memory_order_relaxed) },
+    _cellSize{ cellSize },
+    _columnBegin{ columnBegin },
+    _columnEnd{ columnEnd }
+{
+    THROW_HR_IF(E_INVALIDARG, cellSize.width <= 0 || cellSize.height <= 0);
+    THROW_HR_IF(E_INVALIDARG, columnBegin < 0 || columnEnd <= columnBegin);
+    _pixels.resize(gsl::narrow_cast<size_t>(PixelWidth()) * gsl::narrow_cast<size_t>(cellSize.height));
+}
+
+til::CoordType ImageSlice::PixelWidth() const noexcept
+{
+    return (_columnEnd - _columnBegin) * _cellSize.width;
+}
+
+gsl::span<const uint32_t> ImageSlice::PixelRow(const til::CoordType y) const
+{
+    const auto width = gsl::narrow_cast<size_t>(PixelWidth());
+    return gsl::span<const uint32_t>{ _pixels }.subspan(gsl::narrow<size_t>(y) * width, width);
+}
+
+gsl::span<uint32_t> ImageSlice::MutablePixelRow(const til::CoordType y)
+{
+    const auto width = gsl::narrow_cast<size_t>(PixelWidth());
+    return gsl::span<uint32_t>{ _pixels }.subspan(gsl::narrow<size_t>(y) * width, width);
+}
+
+// Routine Description:
+// - Combines the slice of a row with a new one drawn on top of it, which is
+//   what happens when an image is drawn over (or next to) an existing one.
+// Arguments:
+// - below - the slice the row currently has, if any
+// - above - the slice being added to the row
+// Return Value:
+// - a new slice covering the columns of both
+ImageSlice::Pointer ImageSlice::Merge(const Pointer& below, const Pointer& above)
+{
+    if (!below || below->_cellSize != above->_cellSize)
+    {
+        return above;
+    }
+
+    const auto columnBegin = std::min(below->_columnBegin, above->_columnBegin);
+    const auto columnEnd = std::max(below->_columnEnd, above->_columnEnd);
+    auto merged = std::make_shared<ImageSlice>(above->_cellSize, columnBegin, columnEnd);
+
+    for (const auto& source : { below, above })
+    {
+        const auto offset = gsl::narrow_cast<size_t>((source->_columnBegin - columnBegin) * source->_cellSize.width);
+        for (til::CoordType y = 0; y < source->_cellSize.height; y++)
+        {
+            const auto sourceRow = source->PixelRow(y);
+            const auto targetRow = merged->MutablePixelRow(y).subspan(offset, sourceRow.size());
+            std::transform(targetRow.begin(), targetRow.end(), sourceRow.begin(), targetRow.begin(), blendPremultiplied);
+        }
+    }
+
+    return merged;
+}
+
+// Routine Description:
+// - Removes the pixels of the given columns from a slice, because they were
+//   overwritten with text. If the columns are at either end of the slice,
+//   the slice shrinks accordingly, otherwise they're made transparent.
+// Arguments:
+// - slice - the slice of the row
+// - columnBegin - the first column to erase
+// - columnEnd - the column past the last one to erase
+// Return Value:
+// - the slice itself if it doesn't cover any of the columns, nullptr if nothing of it remains, or a new slice
+ImageSlice::Pointer ImageSlice::EraseColumns(const Pointer& slice, til::CoordType columnBegin, til::CoordType columnEnd)
+{
+    columnBegin = std::max(columnBegin, slice->_columnBegin);
+    columnEnd = std::min(columnEnd, slice->_columnEnd);
+    if (columnBegin >= columnEnd)
+    {
+        return slice;
+    }
+
+    const auto remainingBegin = columnBegin == slice->_columnBegin ? columnEnd : slice->_columnBegin;
+    const auto remainingEnd = columnEnd == slice->_columnEnd ? columnBegin : slice->_columnEnd;
+    if (remainingBegin >= remainingEnd)
+    {
+        return nullptr;
+    }
+
+    auto result = std::make_shared<ImageSlice>(slice->_cellSize, remainingBegin, remainingEnd);
+    const auto cellWidth = slice->_cellSize.width;
+    const auto offset = gsl::narrow_cast<size_t>((remainingBegin - slice->_columnBegin) * cellWidth);
+    const auto width = gsl::narrow_cast<size_t>(result->PixelWidth());
+
+    for (til::CoordType y = 0; y < slice->_cellSize.height; y++)
+    {
+        const auto sourceRow = slice->PixelRow(y).subspan(offset, width);
+        const auto targetRow = result->MutablePixelRow(y);
+        std::copy(sourceRow.begin(), sourceRow.end(), targetRow.begin());
+
+        // The erased columns are in the middle of the slice.
+        if (columnBegin > remainingBegin && columnEnd < remainingEnd)
+        {
+            const auto erased = targetRow.subspan(gsl::narrow_cast<size_t>((columnBegin - remainingBegin) * cellWidth),
+                                                  gsl::narrow_cast<size_t>((columnEnd - columnBegin) * cellWidth));
+            std::fill(erased.begin(), erased.end(), 0u);
+        }
+    }
+
+    return result;
+}
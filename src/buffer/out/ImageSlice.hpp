@@ -0,0 +1,51 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ImageSlice.hpp
+
+Abstract:
+- holds the part of an inline image (like a sixel image) that covers a single
+  row of a text buffer. Each ROW refers to at most one slice, which is why
+  images scroll, and eventually get discarded, together with their rows.
+- Slices are immutable once they were attached to a row and shared between
+  the buffer and the renderers. Changing the image of a row means creating
+  a new slice, which gets a new ID. The renderers use the ID to cache the
+  slice's pixels, for instance as textures in their glyph atlas.
+- The pixels are stored in premultiplied BGRA, for one row of cells of the
+  given cell size, starting at the pixel column of the first cell. The cell
+  size is a virtual one, independent of the font, so renderers scale it.
+--*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+class ImageSlice final
+{
+public:
+    using Pointer = std::shared_ptr<const ImageSlice>;
+
+    ImageSlice(const til::size cellSize, const til::CoordType columnBegin, const til::CoordType columnEnd);
+
+    uint64_t GetId() const noexcept { return _id; }
+    til::size CellSize() const noexcept { return _cellSize; }
+    til::CoordType ColumnBegin() const noexcept { return _columnBegin; }
+    til::CoordType ColumnEnd() const noexcept { return _columnEnd; }
+    til::CoordType PixelWidth() const noexcept;
+
+    gsl::span<const uint32_t> PixelRow(const til::CoordType y) const;
+    gsl::span<uint32_t> MutablePixelRow(const til::CoordType y);
+
+    static Pointer Merge(const Pointer& below, const Pointer& above);
+    static Pointer EraseColumns(const Pointer& slice, const til::CoordType columnBegin, const til::CoordType columnEnd);
+
+private:
+    uint64_t _id;
+    til::size _cellSize;
+    til::CoordType _columnBegin;
+    til::CoordType _columnEnd;
+    std::vector<uint32_t> _pixels;
+};
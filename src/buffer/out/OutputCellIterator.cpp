@@ -296,6 +296,135 @@ OutputCellIterator& OutputCellIterator::operator++()
     return (*this);
 }
 
+// Routine Description:
+// - Returns the run of printable ASCII text that starts at the current position.
+// - Printable ASCII characters are never wide and never part of a surrogate pair,
+//   so every one of them occupies exactly one cell. Callers can write the run
+//   in bulk with the current TextAttr and TextAttrBehavior and then call
+//   SkipAsciiRun, instead of walking over it cell by cell.
+// Arguments:
+// - maxLength - The maximum number of cells the caller can consume.
+// Return Value:
+// - The run, or an empty view if the iterator doesn't iterate over text or
+//   the text at the current position isn't printable ASCII.
+std::wstring_view OutputCellIterator::GetAsciiRun(const size_t maxLength) const noexcept
+{
+    if (_mode != Mode::Loose && _mode != Mode::LooseTextOnly)
+    {
+        return {};
+    }
+
+    // If the current view is the trailing half of a wide glyph, we're not at a character boundary.
+    if (_currentView.DbcsAttr().IsTrailing())
+    {
+        return {};
+    }
+
+    const auto text = std::get_if<std::wstring_view>(&_run);
+    if (!text || _pos >= text->size())
+    {
+        return {};
+    }
+
+    const auto remaining = text->substr(_pos, maxLength);
+    return remaining.substr(0, CountPrintableAscii(remaining));
+}
+
+// Routine Description:
+// - Advances the iterator over a run previously returned by GetAsciiRun.
+// Arguments:
+// - length - The number of characters (and therefore cells) consumed.
+void OutputCellIterator::SkipAsciiRun(const size_t length)
+{
+    _pos += length;
+    _distance += length;
+
+    if (operator bool())
+    {
+        const auto remaining = std::get<std::wstring_view>(_run).substr(_pos);
+        _currentView = _mode == Mode::Loose ? s_GenerateView(remaining, _attr) : s_GenerateView(remaining);
+    }
+}
+
+// Routine Description:
+// - Returns how many cells can be filled with the current view at once, like
+//   GetAsciiRun does for text. They're then skipped with SkipFillRun.
+// Arguments:
+// - maxLength - The maximum number of cells the caller can consume.
+// Return Value:
+// - The number of cells, or 0 if the iterator isn't a fill or if it fills
+//   with something that doesn't fit into a single cell.
+size_t OutputCellIterator::GetFillRun(const size_t maxLength) const noexcept
+{
+    if (_mode != Mode::Fill || !_currentView.DbcsAttr().IsSingle() || _currentView.Chars().size() > 1)
+    {
+        return 0;
+    }
+
+    if (_fillLimit > 0)
+    {
+        return _pos < _fillLimit ? std::min(maxLength, _fillLimit - _pos) : 0;
+    }
+    return maxLength;
+}
+
+// Routine Description:
+// - Advances the iterator over cells previously returned by GetFillRun.
+// Arguments:
+// - length - The number of cells filled.
+void OutputCellIterator::SkipFillRun(const size_t length) noexcept
+{
+    _distance += length;
+    if (_fillLimit > 0)
+    {
+        _pos += length;
+    }
+}
+
+// Routine Description:
+// - Returns the CHAR_INFOs that start at the current position and don't
+//   carry a leading or trailing byte flag. Each of them then fills exactly one
+//   cell, so they can be written all at once and skipped with SkipCharInfoRun.
+// Arguments:
+// - maxLength - The maximum number of cells the caller can consume.
+// Return Value:
+// - The run, or an empty span if the iterator doesn't iterate over CHAR_INFOs
+//   or the current one is half of a wide glyph.
+gsl::span<const CHAR_INFO> OutputCellIterator::GetCharInfoRun(const size_t maxLength) const noexcept
+{
+    if (_mode != Mode::CharInfo)
+    {
+        return {};
+    }
+
+    const auto charInfos = std::get_if<gsl::span<const CHAR_INFO>>(&_run);
+    if (!charInfos || _pos >= charInfos->size())
+    {
+        return {};
+    }
+
+    const auto remaining = charInfos->subspan(_pos, std::min(maxLength, charInfos->size() - _pos));
+    const auto end = std::find_if(remaining.begin(), remaining.end(), [](const CHAR_INFO& charInfo) noexcept {
+        return WI_IsAnyFlagSet(charInfo.Attributes, COMMON_LVB_SBCSDBCS);
+    });
+    return remaining.first(gsl::narrow_cast<size_t>(end - remaining.begin()));
+}
+
+// Routine Description:
+// - Advances the iterator over a run previously returned by GetCharInfoRun.
+// Arguments:
+// - length - The number of CHAR_INFOs (and therefore cells) consumed.
+void OutputCellIterator::SkipCharInfoRun(const size_t length)
+{
+    _pos += length;
+    _distance += length;
+
+    if (operator bool())
+    {
+        _currentView = s_GenerateView(til::at(std::get<gsl::span<const CHAR_INFO>>(_run), _pos));
+    }
+}
+
 // Routine Description:
 // - Advances the iterator one position over the underlying data source.
 // Return Value:
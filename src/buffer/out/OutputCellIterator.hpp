@@ -55,6 +55,15 @@ public:
     OutputCellIterator& operator++();
     OutputCellIterator operator++(int);
 
+    std::wstring_view GetAsciiRun(const size_t maxLength) const noexcept;
+    void SkipAsciiRun(const size_t length);
+
+    size_t GetFillRun(const size_t maxLength) const noexcept;
+    void SkipFillRun(const size_t length) noexcept;
+
+    gsl::span<const CHAR_INFO> GetCharInfoRun(const size_t maxLength) const noexcept;
+    void SkipCharInfoRun(const size_t length);
+
     const OutputCellView& operator*() const noexcept;
     const OutputCellView* operator->() const noexcept;
 
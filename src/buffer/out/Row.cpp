@@ -10,24 +10,86 @@
 // Routine Description:
 // - constructor
 // Arguments:
-// - rowId - the row index in the text buffer
+// - charBuffer - the rowWidth cells of the text buffer's arena reserved for this row
 // - rowWidth - the width of the row, cell elements
 // - fillAttribute - the default text attribute
 // - pParent - the text buffer that this row belongs to
 // Return Value:
 // - constructed object
-ROW::ROW(const til::CoordType rowId, const til::CoordType rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent) :
-    _id{ rowId },
+ROW::ROW(CharRowCell* const charBuffer, const til::CoordType rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent) :
     _rowWidth{ rowWidth },
-    _charRow{ rowWidth, this },
-    _attrRow{ rowWidth, fillAttribute },
+    _charRow{ charBuffer, rowWidth },
+    _attrRow{ rowWidth, fillAttribute, &FAIL_FAST_IF_NULL(pParent)->GetAttributeTable() },
     _lineRendition{ LineRendition::SingleWidth },
     _wrapForced{ false },
     _doubleBytePadded{ false },
-    _pParent{ pParent }
+    _pParent{ pParent },
+    _revision{ pParent->_NextRevision() }
 {
 }
 
+// Routine Description:
+// - Records that the contents of this row have been modified, by giving it
+//   the next revision of the parent text buffer. See TextBuffer::GetRevision.
+// - Every method that can mutate the row has to call this, including the
+//   accessors giving out non-const references to the CharRow and ATTR_ROW.
+void ROW::MarkChanged() noexcept
+{
+    _revision = _pParent->_NextRevision();
+}
+
+void ROW::SetWrapForced(const bool wrap) noexcept
+{
+    _wrapForced = wrap;
+    MarkChanged();
+}
+
+void ROW::SetDoubleBytePadded(const bool doubleBytePadded) noexcept
+{
+    _doubleBytePadded = doubleBytePadded;
+    MarkChanged();
+}
+
+CharRow& ROW::GetCharRow() noexcept
+{
+    MarkChanged();
+    return _charRow;
+}
+
+ATTR_ROW& ROW::GetAttrRow() noexcept
+{
+    MarkChanged();
+    return _attrRow;
+}
+
+// Routine Description:
+// - Returns the column after the last non-space character of the row, like
+//   CharRow::MeasureRight(). The result is kept until the row is modified,
+//   so that rows that didn't change since don't need to be scanned again.
+til::CoordType ROW::MeasureRight() const
+{
+    const std::lock_guard guard{ _pParent->_measureCacheLock };
+    return _MeasureRightLocked();
+}
+
+// Routine Description:
+// - MeasureRight() for callers that already hold TextBuffer::_measureCacheLock.
+til::CoordType ROW::_MeasureRightLocked() const
+{
+    if (_measuredRevision != _revision)
+    {
+        _measuredRight = _charRow.MeasureRight();
+        _measuredRevision = _revision;
+    }
+    return _measuredRight;
+}
+
+void ROW::SetLineRendition(const LineRendition lineRendition) noexcept
+{
+    _lineRendition = lineRendition;
+    MarkChanged();
+}
+
 // Routine Description:
 // - Sets all properties of the ROW to default values
 // Arguments:
@@ -39,7 +101,12 @@ bool ROW::Reset(const TextAttribute Attr)
     _lineRendition = LineRendition::SingleWidth;
     _wrapForced = false;
     _doubleBytePadded = false;
+    _imageSlice.reset();
     _charRow.Reset();
+    MarkChanged();
+    // A blank row doesn't need to be measured.
+    _measuredRight = 0;
+    _measuredRevision = _revision;
     try
     {
         _attrRow.Reset(Attr);
@@ -54,21 +121,30 @@ bool ROW::Reset(const TextAttribute Attr)
 
 // Routine Description:
 // - resizes ROW to new width
+// - The glyphs are always moved over into charBuffer, even if resizing the
+//   attributes fails, so that the row never points into a released arena.
 // Arguments:
+// - charBuffer - the width cells of the text buffer's new arena for this row
 // - width - the new width, in cells
 // Return Value:
 // - S_OK if successful, otherwise relevant error
-[[nodiscard]] HRESULT ROW::Resize(const til::CoordType width)
+[[nodiscard]] HRESULT ROW::Resize(CharRowCell* const charBuffer, const til::CoordType width) noexcept
 {
-    RETURN_IF_FAILED(_charRow.Resize(width));
+    _charRow.Resize(charBuffer, width);
+    _rowWidth = width;
+    MarkChanged();
+
     try
     {
         _attrRow.Resize(width);
+
+        if (_imageSlice)
+        {
+            _imageSlice = ImageSlice::EraseColumns(_imageSlice, width, _imageSlice->ColumnEnd());
+        }
     }
     CATCH_RETURN();
 
-    _rowWidth = width;
-
     return S_OK;
 }
 
@@ -82,16 +158,30 @@ void ROW::ClearColumn(const til::CoordType column)
 {
     THROW_HR_IF(E_INVALIDARG, column >= _charRow.size());
     _charRow.ClearCell(column);
+    MarkChanged();
+}
+
+// Routine Description:
+// - Replaces the image slice of the row. See ImageSlice.
+// Arguments:
+// - imageSlice - the new slice, or nullptr to remove the row's image
+// Return Value:
+// - <none>
+void ROW::SetImageSlice(ImageSlice::Pointer imageSlice) noexcept
+{
+    _imageSlice = std::move(imageSlice);
+    MarkChanged();
 }
 
 UnicodeStorage& ROW::GetUnicodeStorage() noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    MarkChanged();
+    return _charRow.GetUnicodeStorage();
 }
 
 const UnicodeStorage& ROW::GetUnicodeStorage() const noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    return _charRow.GetUnicodeStorage();
 }
 
 // Routine Description:
@@ -111,13 +201,118 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType i
     // If we're given a right-side column limit, use it. Otherwise, the write limit is the final column index available in the char row.
     const auto finalColumnInRow = limitRight.value_or(_charRow.size() - 1);
 
+    MarkChanged();
+
     auto currentColor = it->TextAttr();
     uint16_t colorUses = 0;
     auto colorStarts = gsl::narrow_cast<uint16_t>(index);
     auto currentIndex = colorStarts;
 
+    // The color runs are collected and committed into the attr row all at once at the end,
+    // because every single ATTR_ROW::Replace() may have to shift all of the row's runs.
+    boost::container::small_vector<ATTR_ROW::attr_run, 8> colorRuns;
+    const auto commitColor = [&]() {
+        if (currentIndex != colorStarts)
+        {
+            colorRuns.emplace_back(currentColor, gsl::narrow_cast<uint16_t>(currentIndex - colorStarts));
+        }
+    };
+    // Counts the next count cells, starting at currentIndex, towards the color run of attr.
+    const auto extendColor = [&](const TextAttribute& attr, const uint16_t count) {
+        if (currentColor == attr)
+        {
+            colorUses += count;
+        }
+        else
+        {
+            commitColor();
+            currentColor = attr;
+            colorUses = count;
+            colorStarts = currentIndex;
+        }
+    };
+
     while (it && currentIndex <= finalColumnInRow)
     {
+        // Printable ASCII is by far the most common kind of text. Every character
+        // of it is a narrow glyph that fits into a single cell, so we can skip all
+        // of the DBCS handling below and copy entire runs of it at once.
+        if (const auto run = it.GetAsciiRun(gsl::narrow_cast<size_t>(finalColumnInRow) - currentIndex + 1); !run.empty())
+        {
+            const auto runLength = gsl::narrow_cast<uint16_t>(run.size());
+
+            if (it->TextAttrBehavior() != TextAttributeBehavior::Current)
+            {
+                extendColor(it->TextAttr(), runLength);
+            }
+
+            _charRow.WriteNarrowGlyphs(currentIndex, run);
+            currentIndex += runLength;
+            it.SkipAsciiRun(run.size());
+
+            if (wrap.has_value() && currentIndex > finalColumnInRow)
+            {
+                SetWrapForced(*wrap);
+            }
+            continue;
+        }
+
+        // Fills (of spaces while erasing, most of the time) repeat the same view
+        // over and over, so the entire part of them that's on this row is one
+        // color run and one std::fill_n.
+        if (const auto fillLength = it.GetFillRun(gsl::narrow_cast<size_t>(finalColumnInRow) - currentIndex + 1); fillLength != 0)
+        {
+            const auto runLength = gsl::narrow_cast<uint16_t>(fillLength);
+            const auto behavior = it->TextAttrBehavior();
+
+            if (behavior != TextAttributeBehavior::Current)
+            {
+                extendColor(it->TextAttr(), runLength);
+            }
+
+            if (behavior != TextAttributeBehavior::StoredOnly)
+            {
+                _charRow.FillNarrowGlyph(currentIndex, runLength, til::at(it->Chars(), 0));
+            }
+            currentIndex += runLength;
+            it.SkipFillRun(fillLength);
+
+            if (behavior != TextAttributeBehavior::StoredOnly && wrap.has_value() && currentIndex > finalColumnInRow)
+            {
+                SetWrapForced(*wrap);
+            }
+            continue;
+        }
+
+        // CHAR_INFOs (from WriteConsoleOutput and friends) are already aligned to
+        // cells. As long as they aren't halves of wide glyphs, their characters
+        // are copied all at once, and only changes of their legacy attributes
+        // need to be turned into TextAttributes.
+        if (const auto charInfos = it.GetCharInfoRun(gsl::narrow_cast<size_t>(finalColumnInRow) - currentIndex + 1); !charInfos.empty())
+        {
+            _charRow.WriteNarrowGlyphs(currentIndex, charInfos);
+
+            for (auto runBegin = charInfos.begin(); runBegin != charInfos.end();)
+            {
+                const auto legacyAttr = runBegin->Attributes;
+                const auto runEnd = std::find_if(runBegin, charInfos.end(), [&](const CHAR_INFO& charInfo) noexcept {
+                    return charInfo.Attributes != legacyAttr;
+                });
+                const auto runLength = gsl::narrow_cast<uint16_t>(runEnd - runBegin);
+
+                extendColor(TextAttribute{ legacyAttr }, runLength);
+                currentIndex += runLength;
+                runBegin = runEnd;
+            }
+            it.SkipCharInfoRun(charInfos.size());
+
+            if (wrap.has_value() && currentIndex > finalColumnInRow)
+            {
+                SetWrapForced(*wrap);
+            }
+            continue;
+        }
+
         // Fill the color if the behavior isn't set to keeping the current color.
         if (it->TextAttrBehavior() != TextAttributeBehavior::Current)
         {
@@ -131,7 +326,7 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType i
             {
                 // Otherwise, commit this color into the run and save off the new one.
                 // Now commit the new color runs into the attr row.
-                _attrRow.Replace(colorStarts, currentIndex, currentColor);
+                commitColor();
                 currentColor = it->TextAttr();
                 colorUses = 1;
                 colorStarts = currentIndex;
@@ -188,10 +383,20 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType i
         ++currentIndex;
     }
 
-    // Now commit the final color into the attr row
+    // Now commit the final color and all of the runs into the attr row
     if (colorUses)
     {
-        _attrRow.Replace(colorStarts, currentIndex, currentColor);
+        commitColor();
+    }
+    if (!colorRuns.empty())
+    {
+        _attrRow.ReplaceRuns(index, colorRuns);
+    }
+
+    // Text replaces the parts of an image it's written over.
+    if (_imageSlice)
+    {
+        _imageSlice = ImageSlice::EraseColumns(_imageSlice, index, currentIndex);
     }
 
     return it;
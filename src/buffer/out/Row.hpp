@@ -21,6 +21,7 @@ Revision History:
 #pragma once
 
 #include "AttrRow.hpp"
+#include "ImageSlice.hpp"
 #include "LineRendition.hpp"
 #include "OutputCell.hpp"
 #include "OutputCellIterator.hpp"
@@ -28,66 +29,84 @@ Revision History:
 #include "UnicodeStorage.hpp"
 
 class TextBuffer;
+class RowSnapshot;
 
 class ROW final
 {
 public:
-    ROW(const til::CoordType rowId, const til::CoordType rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent);
+    ROW(CharRowCell* const charBuffer, const til::CoordType rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent);
 
     til::CoordType size() const noexcept { return _rowWidth; }
 
-    void SetWrapForced(const bool wrap) noexcept { _wrapForced = wrap; }
+    void SetWrapForced(const bool wrap) noexcept;
     bool WasWrapForced() const noexcept { return _wrapForced; }
 
-    void SetDoubleBytePadded(const bool doubleBytePadded) noexcept { _doubleBytePadded = doubleBytePadded; }
+    void SetDoubleBytePadded(const bool doubleBytePadded) noexcept;
     bool WasDoubleBytePadded() const noexcept { return _doubleBytePadded; }
 
     const CharRow& GetCharRow() const noexcept { return _charRow; }
-    CharRow& GetCharRow() noexcept { return _charRow; }
+    CharRow& GetCharRow() noexcept;
 
     const ATTR_ROW& GetAttrRow() const noexcept { return _attrRow; }
-    ATTR_ROW& GetAttrRow() noexcept { return _attrRow; }
+    ATTR_ROW& GetAttrRow() noexcept;
 
     LineRendition GetLineRendition() const noexcept { return _lineRendition; }
-    void SetLineRendition(const LineRendition lineRendition) noexcept { _lineRendition = lineRendition; }
+    void SetLineRendition(const LineRendition lineRendition) noexcept;
 
-    til::CoordType GetId() const noexcept { return _id; }
-    void SetId(const til::CoordType id) noexcept { _id = id; }
+    uint64_t GetRevision() const noexcept { return _revision; }
+    void MarkChanged() noexcept;
 
     bool Reset(const TextAttribute Attr);
-    [[nodiscard]] HRESULT Resize(const til::CoordType width);
+    [[nodiscard]] HRESULT Resize(CharRowCell* const charBuffer, const til::CoordType width) noexcept;
 
     void ClearColumn(const til::CoordType column);
     std::wstring GetText() const { return _charRow.GetText(); }
+    til::CoordType MeasureRight() const;
 
     UnicodeStorage& GetUnicodeStorage() noexcept;
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
 
+    const ImageSlice::Pointer& GetImageSlice() const noexcept { return _imageSlice; }
+    void SetImageSlice(ImageSlice::Pointer imageSlice) noexcept;
+
     OutputCellIterator WriteCells(OutputCellIterator it, const til::CoordType index, const std::optional<bool> wrap = std::nullopt, std::optional<til::CoordType> limitRight = std::nullopt);
 
+    friend class TextBuffer;
+
 #ifdef UNIT_TESTING
     friend constexpr bool operator==(const ROW& a, const ROW& b) noexcept;
     friend class RowTests;
 #endif
 
 private:
+    til::CoordType _MeasureRightLocked() const;
+
     CharRow _charRow;
     ATTR_ROW _attrRow;
     LineRendition _lineRendition;
-    til::CoordType _id;
     til::CoordType _rowWidth;
     // Occurs when the user runs out of text in a given row and we're forced to wrap the cursor to the next line
     bool _wrapForced;
     // Occurs when the user runs out of text to support a double byte character and we're forced to the next line
     bool _doubleBytePadded;
     TextBuffer* _pParent; // non ownership pointer
+    // The part of an inline image drawn over this row, if any. See ImageSlice.
+    ImageSlice::Pointer _imageSlice;
+    // The last snapshot of this row, for as long as anyone still holds on to it. It's
+    // only valid if its revision matches _revision. See TextBuffer::SnapshotRows.
+    mutable std::weak_ptr<const RowSnapshot> _snapshot;
+    // The revision of the parent's change counter at which this row was last modified.
+    uint64_t _revision;
+    // The result of the last MeasureRight(), valid while _measuredRevision matches _revision.
+    // Guarded by TextBuffer::_measureCacheLock, since readers may measure rows concurrently.
+    mutable til::CoordType _measuredRight{ 0 };
+    mutable uint64_t _measuredRevision{ 0 };
 };
 
 #ifdef UNIT_TESTING
 constexpr bool operator==(const ROW& a, const ROW& b) noexcept
 {
     // comparison is only used in the tests; this should suffice.
-    return (a._pParent == b._pParent &&
-            a._id == b._id);
+    return &a == &b;
 }
 #endif
@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "RowSnapshot.hpp"
+
+#include "Row.hpp"
+
+// Routine Description:
+// - Copies the contents of a row. The caller must hold the console lock.
+// Arguments:
+// - row - the row to copy
+RowSnapshot::RowSnapshot(const ROW& row) :
+    _revision{ row.GetRevision() },
+    _width{ row.size() },
+    _lineRendition{ row.GetLineRendition() },
+    _wrapForced{ row.WasWrapForced() }
+{
+    const auto& charRow = row.GetCharRow();
+    _text.reserve(gsl::narrow_cast<size_t>(_width));
+    _offsets.reserve(gsl::narrow_cast<size_t>(_width) + 1);
+    for (til::CoordType x = 0; x < _width; ++x)
+    {
+        _offsets.emplace_back(_text.size());
+        if (!charRow.DbcsAttrAt(x).IsTrailing())
+        {
+            _text.append(charRow.GlyphAt(x));
+        }
+    }
+    _offsets.emplace_back(_text.size());
+
+    const auto& attrRow = row.GetAttrRow();
+    const auto& runs = attrRow.GetRuns();
+    _attributes.reserve(runs.size());
+    for (const auto& run : runs)
+    {
+        _attributes.emplace_back(attrRow.GetAttrById(run.value), run.length);
+    }
+}
+
+// Routine Description:
+// - Returns the text of the given columns. Columns outside of the row are clamped.
+// Arguments:
+// - beginColumn - the first column
+// - endColumn - the column past the last one
+// Return Value:
+// - the text of the columns
+std::wstring_view RowSnapshot::GetText(til::CoordType beginColumn, til::CoordType endColumn) const noexcept
+{
+    beginColumn = std::clamp(beginColumn, 0, _width);
+    endColumn = std::clamp(endColumn, beginColumn, _width);
+    const auto begin = til::at(_offsets, gsl::narrow_cast<size_t>(beginColumn));
+    const auto end = til::at(_offsets, gsl::narrow_cast<size_t>(endColumn));
+    return std::wstring_view{ _text }.substr(begin, end - begin);
+}
+
+// Routine Description:
+// - Returns the column that the given offset into GetText() belongs to,
+//   which is how consumers map matches in the text back to the buffer.
+// Arguments:
+// - offset - the offset into the text, up to and including its length
+// Return Value:
+// - the column, or the width of the row for offsets at or past the end of the text
+til::CoordType RowSnapshot::GetColumnAtTextOffset(const size_t offset) const noexcept
+{
+    if (offset >= _text.size())
+    {
+        return _width;
+    }
+    // The last column that starts at or before the offset.
+    const auto it = std::upper_bound(_offsets.begin(), _offsets.end() - 1, offset);
+    return gsl::narrow_cast<til::CoordType>(it - _offsets.begin()) - 1;
+}
+
+// Routine Description:
+// - Returns the attribute of the given column.
+// Arguments:
+// - column - the column, which is clamped to the row
+// Return Value:
+// - the attribute
+const TextAttribute& RowSnapshot::GetAttrByColumn(const til::CoordType column) const noexcept
+{
+    auto remaining = std::clamp(column, 0, _width - 1);
+    for (const auto& run : _attributes)
+    {
+        if (remaining < run.length)
+        {
+            return run.value;
+        }
+        remaining -= run.length;
+    }
+    return _attributes.back().value;
+}
@@ -0,0 +1,54 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- RowSnapshot.hpp
+
+Abstract:
+- An immutable copy of the contents of a ROW: its text, attributes and wrap
+  and line rendition state. Snapshots are reference counted and can be used
+  without holding the console lock, from any thread.
+- A ROW remembers the last snapshot taken of it for as long as anyone holds
+  on to it. Until the row is modified, taking another snapshot returns the
+  same one. A row is thus only copied again after it was written to, and
+  consumers that snapshot the same rows over and over (search, pattern
+  detection, UIA) only pay for the rows that changed in between.
+--*/
+
+#pragma once
+
+#include "AttrRow.hpp"
+#include "LineRendition.hpp"
+
+class ROW;
+
+class RowSnapshot final
+{
+public:
+    explicit RowSnapshot(const ROW& row);
+
+    til::CoordType size() const noexcept { return _width; }
+    uint64_t GetRevision() const noexcept { return _revision; }
+    bool WasWrapForced() const noexcept { return _wrapForced; }
+    LineRendition GetLineRendition() const noexcept { return _lineRendition; }
+
+    std::wstring_view GetText() const noexcept { return _text; }
+    std::wstring_view GetText(til::CoordType beginColumn, til::CoordType endColumn) const noexcept;
+    til::CoordType GetColumnAtTextOffset(const size_t offset) const noexcept;
+
+    const std::vector<ATTR_ROW::attr_run>& GetAttributeRuns() const noexcept { return _attributes; }
+    const TextAttribute& GetAttrByColumn(const til::CoordType column) const noexcept;
+
+private:
+    // The text of the row, without the trailing halves of wide glyphs.
+    std::wstring _text;
+    // The offset into _text at which each column starts,
+    // plus the length of the text for the end of the row.
+    std::vector<size_t> _offsets;
+    std::vector<ATTR_ROW::attr_run> _attributes;
+    uint64_t _revision;
+    til::CoordType _width;
+    LineRendition _lineRendition;
+    bool _wrapForced;
+};
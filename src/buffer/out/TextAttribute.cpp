@@ -7,7 +7,7 @@
 
 // Keeping TextColor compact helps us keeping TextAttribute compact,
 // which in turn ensures that our buffer memory usage is low.
-static_assert(sizeof(TextAttribute) == 14);
+static_assert(sizeof(TextAttribute) == 12);
 static_assert(alignof(TextAttribute) == 2);
 // Ensure that we can memcpy() and memmove() the struct for performance.
 static_assert(std::is_trivially_copyable_v<TextAttribute>);
@@ -116,7 +116,7 @@ WORD TextAttribute::GetLegacyAttributes() const noexcept
 {
     const auto fgIndex = _foreground.GetLegacyIndex(s_legacyDefaultForeground);
     const auto bgIndex = _background.GetLegacyIndex(s_legacyDefaultBackground);
-    const WORD metaAttrs = _wAttrLegacy & META_ATTRS;
+    const auto metaAttrs = _GetMetaAttrs();
     const auto brighten = IsIntense() && _foreground.CanBeBrightened();
     return fgIndex | (bgIndex << 4) | metaAttrs | (brighten ? FOREGROUND_INTENSITY : 0);
 }
@@ -219,42 +219,49 @@ void TextAttribute::SetHyperlinkId(uint16_t id) noexcept
 
 bool TextAttribute::IsLeadingByte() const noexcept
 {
-    return WI_IsFlagSet(_wAttrLegacy, COMMON_LVB_LEADING_BYTE);
+    return WI_IsFlagSet(_GetMetaAttrs(), COMMON_LVB_LEADING_BYTE);
 }
 
 bool TextAttribute::IsTrailingByte() const noexcept
 {
-    return WI_IsFlagSet(_wAttrLegacy, COMMON_LVB_LEADING_BYTE);
+    return WI_IsFlagSet(_GetMetaAttrs(), COMMON_LVB_LEADING_BYTE);
 }
 
 bool TextAttribute::IsTopHorizontalDisplayed() const noexcept
 {
-    return WI_IsFlagSet(_wAttrLegacy, COMMON_LVB_GRID_HORIZONTAL);
+    return WI_IsFlagSet(_GetMetaAttrs(), COMMON_LVB_GRID_HORIZONTAL);
 }
 
 bool TextAttribute::IsBottomHorizontalDisplayed() const noexcept
 {
-    return WI_IsFlagSet(_wAttrLegacy, COMMON_LVB_UNDERSCORE);
+    return WI_IsFlagSet(_GetMetaAttrs(), COMMON_LVB_UNDERSCORE);
 }
 
 bool TextAttribute::IsLeftVerticalDisplayed() const noexcept
 {
-    return WI_IsFlagSet(_wAttrLegacy, COMMON_LVB_GRID_LVERTICAL);
+    return WI_IsFlagSet(_GetMetaAttrs(), COMMON_LVB_GRID_LVERTICAL);
 }
 
 bool TextAttribute::IsRightVerticalDisplayed() const noexcept
 {
-    return WI_IsFlagSet(_wAttrLegacy, COMMON_LVB_GRID_RVERTICAL);
+    return WI_IsFlagSet(_GetMetaAttrs(), COMMON_LVB_GRID_RVERTICAL);
+}
+
+void TextAttribute::_SetMetaAttr(const WORD flag, const bool isSet) noexcept
+{
+    auto metaAttrs = _GetMetaAttrs();
+    WI_UpdateFlag(metaAttrs, flag, isSet);
+    _metaAttrs = _PackMetaAttrs(metaAttrs);
 }
 
 void TextAttribute::SetLeftVerticalDisplayed(const bool isDisplayed) noexcept
 {
-    WI_UpdateFlag(_wAttrLegacy, COMMON_LVB_GRID_LVERTICAL, isDisplayed);
+    _SetMetaAttr(COMMON_LVB_GRID_LVERTICAL, isDisplayed);
 }
 
 void TextAttribute::SetRightVerticalDisplayed(const bool isDisplayed) noexcept
 {
-    WI_UpdateFlag(_wAttrLegacy, COMMON_LVB_GRID_RVERTICAL, isDisplayed);
+    _SetMetaAttr(COMMON_LVB_GRID_RVERTICAL, isDisplayed);
 }
 
 bool TextAttribute::IsIntense() const noexcept
@@ -299,12 +306,12 @@ bool TextAttribute::IsDoublyUnderlined() const noexcept
 
 bool TextAttribute::IsOverlined() const noexcept
 {
-    return WI_IsFlagSet(_wAttrLegacy, COMMON_LVB_GRID_HORIZONTAL);
+    return WI_IsFlagSet(_GetMetaAttrs(), COMMON_LVB_GRID_HORIZONTAL);
 }
 
 bool TextAttribute::IsReverseVideo() const noexcept
 {
-    return WI_IsFlagSet(_wAttrLegacy, COMMON_LVB_REVERSE_VIDEO);
+    return WI_IsFlagSet(_GetMetaAttrs(), COMMON_LVB_REVERSE_VIDEO);
 }
 
 void TextAttribute::SetIntense(bool isIntense) noexcept
@@ -349,12 +356,12 @@ void TextAttribute::SetDoublyUnderlined(bool isDoublyUnderlined) noexcept
 
 void TextAttribute::SetOverlined(bool isOverlined) noexcept
 {
-    WI_UpdateFlag(_wAttrLegacy, COMMON_LVB_GRID_HORIZONTAL, isOverlined);
+    _SetMetaAttr(COMMON_LVB_GRID_HORIZONTAL, isOverlined);
 }
 
 void TextAttribute::SetReverseVideo(bool isReversed) noexcept
 {
-    WI_UpdateFlag(_wAttrLegacy, COMMON_LVB_REVERSE_VIDEO, isReversed);
+    _SetMetaAttr(COMMON_LVB_REVERSE_VIDEO, isReversed);
 }
 
 ExtendedAttributes TextAttribute::GetExtendedAttributes() const noexcept
@@ -366,7 +373,7 @@ ExtendedAttributes TextAttribute::GetExtendedAttributes() const noexcept
 // - swaps foreground and background color
 void TextAttribute::Invert() noexcept
 {
-    WI_ToggleFlag(_wAttrLegacy, COMMON_LVB_REVERSE_VIDEO);
+    _SetMetaAttr(COMMON_LVB_REVERSE_VIDEO, !IsReverseVideo());
 }
 
 void TextAttribute::SetDefaultForeground() noexcept
@@ -384,7 +391,7 @@ void TextAttribute::SetDefaultBackground() noexcept
 void TextAttribute::SetDefaultMetaAttrs() noexcept
 {
     _extendedAttrs = ExtendedAttributes::Normal;
-    _wAttrLegacy = 0;
+    _metaAttrs = 0;
 }
 
 // Method Description:
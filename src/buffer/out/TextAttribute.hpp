@@ -31,32 +31,31 @@ class TextAttribute final
 {
 public:
     constexpr TextAttribute() noexcept :
-        _wAttrLegacy{ 0 },
+        _hyperlinkId{ 0 },
         _foreground{},
         _background{},
-        _extendedAttrs{ ExtendedAttributes::Normal },
-        _hyperlinkId{ 0 }
+        _metaAttrs{ 0 },
+        _extendedAttrs{ ExtendedAttributes::Normal }
     {
     }
 
+    // If we're given lead/trailing byte information with the legacy color, it's stripped.
     explicit constexpr TextAttribute(const WORD wLegacyAttr) noexcept :
-        _wAttrLegacy{ gsl::narrow_cast<WORD>(wLegacyAttr & META_ATTRS) },
+        _hyperlinkId{ 0 },
         _foreground{ gsl::at(s_legacyForegroundColorMap, wLegacyAttr & FG_ATTRS) },
         _background{ gsl::at(s_legacyBackgroundColorMap, (wLegacyAttr & BG_ATTRS) >> 4) },
-        _extendedAttrs{ ExtendedAttributes::Normal },
-        _hyperlinkId{ 0 }
+        _metaAttrs{ _PackMetaAttrs(gsl::narrow_cast<WORD>(wLegacyAttr & ~COMMON_LVB_SBCSDBCS)) },
+        _extendedAttrs{ ExtendedAttributes::Normal }
     {
-        // If we're given lead/trailing byte information with the legacy color, strip it.
-        WI_ClearAllFlags(_wAttrLegacy, COMMON_LVB_SBCSDBCS);
     }
 
     constexpr TextAttribute(const COLORREF rgbForeground,
                             const COLORREF rgbBackground) noexcept :
-        _wAttrLegacy{ 0 },
+        _hyperlinkId{ 0 },
         _foreground{ rgbForeground },
         _background{ rgbBackground },
-        _extendedAttrs{ ExtendedAttributes::Normal },
-        _hyperlinkId{ 0 }
+        _metaAttrs{ 0 },
+        _extendedAttrs{ ExtendedAttributes::Normal }
     {
     }
 
@@ -150,7 +149,7 @@ public:
                // hyperlinks have a visual representation
                !IsHyperlink() &&
                // all other attributes do not have a visual representation
-               (_wAttrLegacy & META_ATTRS) == (other._wAttrLegacy & META_ATTRS) &&
+               _metaAttrs == other._metaAttrs &&
                ((checkForeground && _foreground == other._foreground) ||
                 (!checkForeground && _background == other._background)) &&
                _extendedAttrs == other._extendedAttrs &&
@@ -159,18 +158,34 @@ public:
 
     constexpr bool IsAnyGridLineEnabled() const noexcept
     {
-        return WI_IsAnyFlagSet(_wAttrLegacy, COMMON_LVB_GRID_HORIZONTAL | COMMON_LVB_GRID_LVERTICAL | COMMON_LVB_GRID_RVERTICAL | COMMON_LVB_UNDERSCORE);
+        return WI_IsAnyFlagSet(_GetMetaAttrs(), COMMON_LVB_GRID_HORIZONTAL | COMMON_LVB_GRID_LVERTICAL | COMMON_LVB_GRID_RVERTICAL | COMMON_LVB_UNDERSCORE);
     }
 
 private:
     static std::array<TextColor, 16> s_legacyForegroundColorMap;
     static std::array<TextColor, 16> s_legacyBackgroundColorMap;
 
-    uint16_t _wAttrLegacy; // sizeof: 2, alignof: 2
+    // The COMMON_LVB_* flags all live in the upper byte of a legacy
+    // attribute, so that byte is all we need to store of them.
+    static constexpr uint8_t _PackMetaAttrs(const WORD wLegacyAttr) noexcept
+    {
+        return gsl::narrow_cast<uint8_t>((wLegacyAttr & META_ATTRS) >> 8);
+    }
+
+    constexpr WORD _GetMetaAttrs() const noexcept
+    {
+        return gsl::narrow_cast<WORD>(_metaAttrs << 8);
+    }
+
+    void _SetMetaAttr(const WORD flag, const bool isSet) noexcept;
+
+    // The members are laid out without any padding, so that all 12 bytes can be
+    // compared with memcmp() (which the compiler turns into a 8 and a 4 byte compare).
     uint16_t _hyperlinkId; // sizeof: 2, alignof: 2
     TextColor _foreground; // sizeof: 4, alignof: 1
     TextColor _background; // sizeof: 4, alignof: 1
-    ExtendedAttributes _extendedAttrs; // sizeof: 2, alignof: 2
+    uint8_t _metaAttrs; // sizeof: 1, alignof: 1
+    ExtendedAttributes _extendedAttrs; // sizeof: 1, alignof: 1
 
 #ifdef UNIT_TESTING
     friend class TextBufferTests;
@@ -207,7 +222,7 @@ namespace WEX
                     VerifyOutputTraits<TextColor>::ToString(attr._foreground).GetBuffer(),
                     VerifyOutputTraits<TextColor>::ToString(attr._background).GetBuffer(),
                     attr.IsIntense(),
-                    attr._wAttrLegacy,
+                    attr._GetMetaAttrs(),
                     static_cast<DWORD>(attr._extendedAttrs));
             }
         };
@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "TextAttributeTable.hpp"
+
+// The number of attributes a table grows by at least before it's worth compacting.
+// Compacting re-interns every row of the buffer, so it mustn't happen too often.
+static constexpr size_t MinCompactionGrowth = 48 * 1024;
+
+TextAttributeTable::TextAttributeTable() :
+    _compactionThreshold{ MinCompactionGrowth }
+{
+    _attributes.emplace_back();
+    _ids.try_emplace(TextAttribute{}, DefaultId);
+}
+
+// Routine Description:
+// - Returns the index of the given attribute in the table, adding it if necessary.
+// Arguments:
+// - attr - the attribute to look up
+// Return Value:
+// - the index of the attribute
+TextAttributeTable::id_type TextAttributeTable::Intern(const TextAttribute& attr)
+{
+    if (const auto it = _ids.find(attr); it != _ids.end())
+    {
+        return it->second;
+    }
+
+    // The allocations fail long before id_type is exhausted. If it were,
+    // this throws instead of silently handing out a wrong attribute.
+    const auto id = gsl::narrow<id_type>(_attributes.size());
+    _attributes.emplace_back(attr);
+    _ids.try_emplace(attr, id);
+    return id;
+}
+
+// Routine Description:
+// - Returns the attribute stored at the given index.
+// Arguments:
+// - id - an index previously returned by Intern()
+// Return Value:
+// - the attribute
+const TextAttribute& TextAttributeTable::Get(const id_type id) const noexcept
+{
+    return til::at(_attributes, id);
+}
+
+size_t TextAttributeTable::Size() const noexcept
+{
+    return _attributes.size();
+}
+
+// Routine Description:
+// - Returns the number of bytes the table allocated on the heap.
+size_t TextAttributeTable::GetMemoryUsage() const noexcept
+{
+    return sizeof(*this) + _attributes.capacity() * sizeof(TextAttribute) + _ids.allocated_bytes() + _hyperlinkReferences.capacity() * sizeof(uint32_t);
+}
+
+// Routine Description:
+// - Returns true if the table grew enough since it was created (or compacted) that
+//   the owner should replace it with a new one that only contains the attributes
+//   that are still in use.
+bool TextAttributeTable::NeedsCompaction() const noexcept
+{
+    return _attributes.size() >= _compactionThreshold;
+}
+
+// Routine Description:
+// - Adjusts the threshold for NeedsCompaction() after the table was compacted.
+//   The threshold is relative to the attributes that are still in use: The table needs
+//   to grow by as much as it holds right now (and at least by MinCompactionGrowth)
+//   before it's compacted again. No matter how many attributes stay in use, the cost
+//   of compacting is thus amortized over as many newly interned attributes.
+// Arguments:
+// - liveAttributes - the number of attributes in the compacted table
+void TextAttributeTable::SetCompactionThreshold(const size_t liveAttributes) noexcept
+{
+    _compactionThreshold = liveAttributes + std::max(liveAttributes, MinCompactionGrowth);
+}
+
+// Routine Description:
+// - Records that another run of attributes refers to the given hyperlink.
+// Arguments:
+// - hyperlinkId - the ID of the hyperlink
+void TextAttributeTable::AddHyperlinkReference(const uint16_t hyperlinkId)
+{
+    if (hyperlinkId >= _hyperlinkReferences.size())
+    {
+        _hyperlinkReferences.resize(size_t{ hyperlinkId } + 1);
+    }
+    ++til::at(_hyperlinkReferences, hyperlinkId);
+}
+
+// Routine Description:
+// - Records that a run of attributes that referred to the given hyperlink was overwritten.
+// Arguments:
+// - hyperlinkId - the ID of the hyperlink
+void TextAttributeTable::ReleaseHyperlinkReference(const uint16_t hyperlinkId) noexcept
+{
+    if (hyperlinkId < _hyperlinkReferences.size())
+    {
+        auto& references = til::at(_hyperlinkReferences, hyperlinkId);
+        if (references > 0)
+        {
+            --references;
+        }
+    }
+}
+
+// Routine Description:
+// - Returns the number of runs of attributes that refer to the given hyperlink.
+// Arguments:
+// - hyperlinkId - the ID of the hyperlink
+// Return Value:
+// - the number of references. If it's 0, no row of the buffer shows the hyperlink anymore.
+size_t TextAttributeTable::GetHyperlinkReferences(const uint16_t hyperlinkId) const noexcept
+{
+    return hyperlinkId < _hyperlinkReferences.size() ? til::at(_hyperlinkReferences, hyperlinkId) : 0;
+}
+
+// Routine Description:
+// - Moves the hyperlink reference counts of another table into this one. This is
+//   used when the owning buffer replaces its table with a compacted copy of it.
+// Arguments:
+// - other - the table whose rows now refer to this one
+void TextAttributeTable::TakeHyperlinkReferences(TextAttributeTable& other) noexcept
+{
+    _hyperlinkReferences = std::move(other._hyperlinkReferences);
+}
+
+size_t TextAttributeTable::hasher::operator()(const TextAttribute& attr) const noexcept
+{
+    // TextAttribute's operator== is a memcmp(), so its hash can be one as well.
+    return til::hash_bytes(&attr, sizeof(attr));
+}
@@ -0,0 +1,68 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- TextAttributeTable.hpp
+
+Abstract:
+- interns the TextAttributes used by the rows of a text buffer, so that the
+  attribute runs of each ATTR_ROW only need to store a 32-bit index into it.
+- A run is then 8 bytes large (index, length and padding) instead of the 14
+  bytes it takes with a whole TextAttribute. 16-bit indices would bring it down
+  to 4 bytes, but a buffer can hold more than 65536 different attributes at once
+  (e.g. a 24-bit color gradient in a large scrollback), and running out of
+  indices would mean showing those cells with the wrong colors.
+- The table never runs out of indices, so interning is lossless. It only grows,
+  though, which is why the owning buffer replaces it with a compacted copy once
+  it has doubled in size since the last compaction (see NeedsCompaction()).
+  Compacting re-interns every row, so hosts only do it between writes, not
+  while text is being written (see TextBuffer::CompactAttributeTable()).
+- It also counts how many runs of the buffer's rows refer to each hyperlink ID.
+  The rows update the counts as they're written, which lets the buffer tell
+  whether a hyperlink is still in use without searching all of its rows.
+--*/
+
+#pragma once
+
+#include <vector>
+
+#include <til/flat_hash_map.h>
+
+#include "TextAttribute.hpp"
+
+class TextAttributeTable final
+{
+public:
+    using id_type = uint32_t;
+
+    // The table always holds the default attribute at this index.
+    static constexpr id_type DefaultId = 0;
+
+    TextAttributeTable();
+
+    id_type Intern(const TextAttribute& attr);
+    const TextAttribute& Get(const id_type id) const noexcept;
+
+    size_t Size() const noexcept;
+    size_t GetMemoryUsage() const noexcept;
+    bool NeedsCompaction() const noexcept;
+    void SetCompactionThreshold(const size_t liveAttributes) noexcept;
+
+    void AddHyperlinkReference(const uint16_t hyperlinkId);
+    void ReleaseHyperlinkReference(const uint16_t hyperlinkId) noexcept;
+    size_t GetHyperlinkReferences(const uint16_t hyperlinkId) const noexcept;
+    void TakeHyperlinkReferences(TextAttributeTable& other) noexcept;
+
+private:
+    struct hasher
+    {
+        size_t operator()(const TextAttribute& attr) const noexcept;
+    };
+
+    std::vector<TextAttribute> _attributes;
+    til::flat_hash_map<TextAttribute, id_type, hasher> _ids;
+    size_t _compactionThreshold;
+    // Indexed by hyperlink ID. It only grows up to the largest ID in use.
+    std::vector<uint32_t> _hyperlinkReferences;
+};
@@ -5,94 +5,120 @@
 #include "UnicodeStorage.hpp"
 
 UnicodeStorage::UnicodeStorage() noexcept :
-    _map{}
+    _glyphs{}
 {
 }
 
 // Routine Description:
 // - fetches the text associated with key
 // Arguments:
-// - key - the key into the storage
+// - key - the column of the glyph
 // Return Value:
-// - the glyph data associated with key
+// - the glyph data associated with key. The reference is only valid until the next glyph is stored.
 // Note: will throw exception if key is not stored yet
 const UnicodeStorage::mapped_type& UnicodeStorage::GetText(const key_type key) const
 {
-    return _map.at(key);
+    const auto it = _find(key);
+    THROW_HR_IF(E_INVALIDARG, it == _glyphs.cend() || it->first != key);
+    return it->second;
 }
 
 // Routine Description:
 // - stores glyph data associated with key.
 // Arguments:
-// - key - the key into the storage
+// - key - the column of the glyph
 // - glyph - the glyph data to store
 void UnicodeStorage::StoreGlyph(const key_type key, const mapped_type& glyph)
 {
-    _map.insert_or_assign(key, glyph);
+    const auto it = _find(key);
+    if (it != _glyphs.end() && it->first == key)
+    {
+        it->second.assign(glyph.cbegin(), glyph.cend());
+    }
+    else
+    {
+        _glyphs.emplace(it, key, glyph);
+    }
 }
 
 // Routine Description:
 // - erases key and its associated data from the storage
 // Arguments:
-// - key - the key to remove
+// - key - the column to remove
 void UnicodeStorage::Erase(const key_type key) noexcept
 {
-    _map.erase(key);
+    const auto it = _find(key);
+    if (it != _glyphs.end() && it->first == key)
+    {
+        _glyphs.erase(it);
+    }
 }
 
 // Routine Description:
-// - Remaps all of the stored items to new coordinate positions
-//   based on a bulk rearrangement of row IDs and potential row width resize.
+// - erases all glyphs stored for the columns [begin, end)
 // Arguments:
-// - rowMap - A map of the old row IDs to the new row IDs.
-// - width - The width of the new row. Remove any items that are beyond the row width.
-//         - Use nullopt if we're not resizing the width of the row, just renumbering the rows.
-void UnicodeStorage::Remap(const std::unordered_map<til::CoordType, til::CoordType>& rowMap, const std::optional<til::CoordType> width)
+// - begin - the first column to remove
+// - end - the column after the last one to remove
+void UnicodeStorage::Erase(const key_type begin, const key_type end) noexcept
 {
-    // Make a temporary map to hold all the new row positioning
-    std::unordered_map<key_type, mapped_type> newMap;
-
-    // Walk through every stored item.
-    for (const auto& pair : _map)
-    {
-        // Extract the old coordinate position
-        const auto oldCoord = pair.first;
-
-        // Only try to short-circuit based on width if we were told it changed
-        // by being given a new width value.
-        if (width.has_value())
-        {
-            // Get the column ID
-            const auto oldColId = oldCoord.X;
-
-            // If the column index is at/beyond the row width, don't bother copying it to the new map.
-            if (oldColId >= width.value())
-            {
-                continue;
-            }
-        }
-
-        // Get the row ID from the position as that's what we need to remap
-        const auto oldRowId = oldCoord.Y;
+    _glyphs.erase(_find(begin), _find(end));
+}
 
-        // Use the mapping given to convert the old row ID to the new row ID
-        const auto mapIter = rowMap.find(oldRowId);
+// Routine Description:
+// - erases all glyphs that are stored at or beyond the given column.
+// Arguments:
+// - width - The new width of the row.
+void UnicodeStorage::Truncate(const key_type width) noexcept
+{
+    _glyphs.erase(_find(width), _glyphs.end());
+}
 
-        // If there's no mapping to a new row, don't bother copying it to the new map. The row is gone.
-        if (mapIter == rowMap.end())
-        {
-            continue;
-        }
+// Routine Description:
+// - erases all glyphs from the storage
+void UnicodeStorage::Clear() noexcept
+{
+    _glyphs.clear();
+}
 
-        const auto newRowId = mapIter->second;
+bool UnicodeStorage::empty() const noexcept
+{
+    return _glyphs.empty();
+}
 
-        // Generate a new coordinate with the same X as the old one, but a new Y value.
-        const auto newCoord = til::point{ oldCoord.X, newRowId };
+size_t UnicodeStorage::size() const noexcept
+{
+    return _glyphs.size();
+}
 
-        // Put the adjusted coordinate into the map with the original value.
-        newMap.emplace(newCoord, pair.second);
+// Routine Description:
+// - Returns the number of bytes this storage allocated on the heap, for
+//   the glyph list as well as the characters of each glyph.
+size_t UnicodeStorage::GetMemoryUsage() const noexcept
+{
+    auto bytes = _glyphs.capacity() * sizeof(value_type);
+    for (const auto& glyph : _glyphs)
+    {
+        bytes += glyph.second.capacity() * sizeof(wchar_t);
     }
+    return bytes;
+}
+
+// Routine Description:
+// - finds the first glyph that is stored at or beyond the given column
+// Arguments:
+// - key - the column to look for
+// Return Value:
+// - iterator to the glyph, or the position it would have to be inserted at
+std::vector<UnicodeStorage::value_type>::iterator UnicodeStorage::_find(const key_type key) noexcept
+{
+    return std::lower_bound(_glyphs.begin(), _glyphs.end(), key, [](const value_type& glyph, const key_type column) noexcept {
+        return glyph.first < column;
+    });
+}
 
-    // Swap into the stored map, free the temporary when we exit.
-    _map.swap(newMap);
+std::vector<UnicodeStorage::value_type>::const_iterator UnicodeStorage::_find(const key_type key) const noexcept
+{
+    return std::lower_bound(_glyphs.cbegin(), _glyphs.cend(), key, [](const value_type& glyph, const key_type column) noexcept {
+        return glyph.first < column;
+    });
 }
@@ -7,6 +7,8 @@ Module Name:
 
 Abstract:
 - dynamic storage location for glyphs that can't normally fit in the output buffer
+- Every CharRow owns one of these for its own columns. Since the glyphs travel
+  together with their row, rotating or renumbering rows doesn't touch them.
 
 Author(s):
 - Austin Diviness (AustDi) 02-May-2018
@@ -14,36 +16,12 @@ Author(s):
 
 #pragma once
 
-#include <unordered_map>
 #include <vector>
 
-#include <til/bit.h>
-#include <til/hash.h>
-
-// std::unordered_map needs help to know how to hash a til::point
-namespace std
-{
-    template<>
-    struct hash<til::point>
-    {
-        // Routine Description:
-        // - hashes a coord. coord will be hashed by storing the x and y values consecutively in the lower
-        // bits of a size_t.
-        // Arguments:
-        // - coord - the coord to hash
-        // Return Value:
-        // - the hashed coord
-        constexpr size_t operator()(const til::point coord) const noexcept
-        {
-            return til::hash(til::bit_cast<uint64_t>(coord));
-        }
-    };
-}
-
 class UnicodeStorage final
 {
 public:
-    using key_type = typename til::point;
+    using key_type = typename til::CoordType;
     using mapped_type = typename std::vector<wchar_t>;
 
     UnicodeStorage() noexcept;
@@ -53,11 +31,28 @@ public:
     void StoreGlyph(const key_type key, const mapped_type& glyph);
 
     void Erase(const key_type key) noexcept;
+    void Erase(const key_type begin, const key_type end) noexcept;
+
+    void Truncate(const key_type width) noexcept;
 
-    void Remap(const std::unordered_map<til::CoordType, til::CoordType>& rowMap, const std::optional<til::CoordType> width);
+    void Clear() noexcept;
+
+    bool empty() const noexcept;
+    size_t size() const noexcept;
+    size_t GetMemoryUsage() const noexcept;
 
 private:
-    std::unordered_map<key_type, mapped_type> _map;
+    using value_type = std::pair<key_type, mapped_type>;
+
+    std::vector<value_type>::iterator _find(const key_type key) noexcept;
+    std::vector<value_type>::const_iterator _find(const key_type key) const noexcept;
+
+    // sorted by column. A row has only a handful of these if any, which makes
+    // a flat vector faster than any kind of hash map. Storing a glyph may
+    // reallocate this vector, which invalidates the references that GetText
+    // returned. The glyphs each keep their own vector though, which is moved
+    // along, so pointers into the text of one stay valid while others are stored.
+    std::vector<value_type> _glyphs;
 
 #ifdef UNIT_TESTING
     friend class UnicodeStorageTests;
@@ -22,7 +22,7 @@ Cursor::Cursor(const ULONG ulSize, TextBuffer& parentBuffer) noexcept :
     _fIsConversionArea(false),
     _fIsPopupShown(false),
     _fDelayedEolWrap(false),
-    _fDeferCursorRedraw(false),
+    _cDeferCursorRedraw(0),
     _fHaveDeferredCursorRedraw(false),
     _ulSize(ulSize),
     _cursorType(CursorType::Legacy)
@@ -96,8 +96,20 @@ void Cursor::SetIsVisible(const bool fIsVisible) noexcept
 
 void Cursor::SetIsOn(const bool fIsOn) noexcept
 {
+    // The blink timers call this twice a second even if nothing changed (for instance after
+    // a cursor move turned the cursor back on). Only the cursor cell needs to be repainted
+    // and only if it actually changes, which it can't while the cursor is hidden.
+    if (_fIsOn == fIsOn)
+    {
+        return;
+    }
+
     _fIsOn = fIsOn;
-    _RedrawCursorAlways();
+
+    if (_fIsVisible && !_fIsPopupShown && !_fIsConversionArea)
+    {
+        _RedrawCursorAlways();
+    }
 }
 
 void Cursor::SetBlinkingAllowed(const bool fBlinkingAllowed) noexcept
@@ -161,9 +173,15 @@ void Cursor::_RedrawCursor() noexcept
     // (Conversion areas have cursors to mark the insertion point internally, but the user's actual cursor is the one on the primary screen buffer.)
     if (IsOn() && !IsConversionArea())
     {
-        if (_fDeferCursorRedraw)
+        if (_cDeferCursorRedraw)
         {
-            _fHaveDeferredCursorRedraw = true;
+            // Remember where the cursor was drawn last, because that
+            // spot needs to be redrawn as well once we're done.
+            if (!_fHaveDeferredCursorRedraw)
+            {
+                _fHaveDeferredCursorRedraw = true;
+                _coordDeferredRedraw = _cPosition;
+            }
         }
         else
         {
@@ -273,8 +291,9 @@ void Cursor::CopyProperties(const Cursor& OtherCursor) noexcept
     //_fDelayedEolWrap              = OtherCursor._fDelayedEolWrap;
     //_coordDelayedAt               = OtherCursor._coordDelayedAt;
 
-    _fDeferCursorRedraw = OtherCursor._fDeferCursorRedraw;
+    _cDeferCursorRedraw = OtherCursor._cDeferCursorRedraw;
     _fHaveDeferredCursorRedraw = OtherCursor._fHaveDeferredCursorRedraw;
+    _coordDeferredRedraw = OtherCursor._coordDeferredRedraw;
 
     // Size will be handled separately in the resize operation.
     //_ulSize                       = OtherCursor._ulSize;
@@ -303,24 +322,50 @@ bool Cursor::IsDelayedEOLWrap() const noexcept
     return _fDelayedEolWrap;
 }
 
+// Routine Description:
+// - Defers redrawing the cursor until the matching call to EndDeferDrawing.
+//   Calls can be nested, in which case only the outermost EndDeferDrawing redraws.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
 void Cursor::StartDeferDrawing() noexcept
 {
-    _fDeferCursorRedraw = true;
+    _cDeferCursorRedraw++;
 }
 
 bool Cursor::IsDeferDrawing() noexcept
 {
-    return _fDeferCursorRedraw;
+    return _cDeferCursorRedraw != 0;
 }
 
+// Routine Description:
+// - Ends deferring the cursor redraws. If any redraws were requested in the meantime,
+//   this redraws both the position the cursor had back then and the current one.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
 void Cursor::EndDeferDrawing() noexcept
 {
+    if (_cDeferCursorRedraw == 0 || --_cDeferCursorRedraw != 0)
+    {
+        return;
+    }
+
     if (_fHaveDeferredCursorRedraw)
     {
+        _fHaveDeferredCursorRedraw = false;
+        if (_coordDeferredRedraw != _cPosition)
+        {
+            try
+            {
+                _parentBuffer.TriggerRedrawCursor(_coordDeferredRedraw);
+            }
+            CATCH_LOG();
+        }
         _RedrawCursorAlways();
     }
-
-    _fDeferCursorRedraw = FALSE;
 }
 
 const CursorType Cursor::GetType() const noexcept
@@ -104,8 +104,9 @@ private:
     bool _fDelayedEolWrap; // don't wrap at EOL till the next char comes in.
     til::point _coordDelayedAt; // coordinate the EOL wrap was delayed at.
 
-    bool _fDeferCursorRedraw; // whether we should defer redrawing the cursor or not
+    ULONG _cDeferCursorRedraw; // how many callers are deferring the redraws of the cursor (they can be nested)
     bool _fHaveDeferredCursorRedraw; // have we been asked to redraw the cursor while it was being deferred?
+    til::point _coordDeferredRedraw; // where the cursor was when the first redraw got deferred
 
     ULONG _ulSize;
 
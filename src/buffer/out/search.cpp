@@ -93,6 +93,227 @@ bool Search::FindNext()
     return false;
 }
 
+// Routine Description
+// - Picks the match out of the given ones that FindNext() would have located,
+//   without searching the buffer again. Once it returns a match, you can
+//   perform actions like .Select() or .Color() on it.
+// Arguments:
+// - matches - All matches of the search term, sorted by their start, as returned by FindAll().
+// Return Value:
+// - The index of the match or nullopt if there are no matches.
+std::optional<size_t> Search::FindNext(const std::vector<Match>& matches)
+{
+    if (matches.empty())
+    {
+        return std::nullopt;
+    }
+
+    auto it = matches.begin();
+
+    if (_direction == Direction::Forward)
+    {
+        // The first match at or after the anchor, wrapping around to the first one.
+        it = std::lower_bound(matches.begin(), matches.end(), _coordAnchor, [](const Match& match, const til::point anchor) {
+            return match.first < anchor;
+        });
+        if (it == matches.end())
+        {
+            it = matches.begin();
+        }
+    }
+    else
+    {
+        // The last match at or before the anchor, wrapping around to the last one.
+        it = std::upper_bound(matches.begin(), matches.end(), _coordAnchor, [](const til::point anchor, const Match& match) {
+            return anchor < match.first;
+        });
+        if (it == matches.begin())
+        {
+            it = matches.end();
+        }
+        --it;
+    }
+
+    _coordSelStart = it->first;
+    _coordSelEnd = it->second;
+    return gsl::narrow_cast<size_t>(it - matches.begin());
+}
+
+// Routine Description
+// - Locates all instances of the search term within the screen buffer.
+// Arguments:
+// - <none> - Uses internal state from constructor
+// Return Value:
+// - All matches, sorted by their start.
+std::vector<Search::Match> Search::FindAll() const
+{
+    std::vector<Match> matches;
+    FindAll(0, _uiaData.GetTextBufferEndPosition().Y + 1, matches);
+    return matches;
+}
+
+// Routine Description
+// - Locates the instances of the search term that begin in the given rows, or
+//   at the end of the row right above them and continue in the first one.
+//   Consecutive calls for adjacent ranges of rows therefore find every match once,
+//   which allows searching a large buffer in chunks.
+// - Instead of comparing the needle cell by cell at every position like FindNext(),
+//   this copies the text of one row at a time into a string and scans it with
+//   find(), which is a lot faster on large buffers.
+// Arguments:
+// - beginRow - The first row to search.
+// - endRow - The row after the last one to search.
+// - matches - The matches are appended to it, sorted by their start.
+void Search::FindAll(const til::CoordType beginRow, const til::CoordType endRow, std::vector<Match>& matches) const
+{
+    const auto& textBuffer = _uiaData.GetTextBuffer();
+    const auto width = textBuffer.GetSize().Width();
+    _FindAll(beginRow, endRow, matches, [&](const til::CoordType y, auto&& appendCell) {
+        const auto& charRow = textBuffer.GetRowByOffset(y).GetCharRow();
+        for (til::CoordType x = 0; x < width; ++x)
+        {
+            appendCell(x, charRow.GlyphAt(x));
+        }
+    });
+}
+
+// Routine Description
+// - Like FindAll above, but searches a snapshot of the rows instead of the buffer.
+//   This doesn't access the buffer and can be called without holding the console lock.
+// Arguments:
+// - snapshot - The rows to search. It must contain the rows [beginRow - 1, endRow),
+//   or [beginRow, endRow) if beginRow is the first row of the buffer.
+// - beginRow - The first row to search.
+// - endRow - The row after the last one to search.
+// - matches - The matches are appended to it, sorted by their start.
+void Search::FindAll(const TextBuffer::RowsSnapshot& snapshot, const til::CoordType beginRow, const til::CoordType endRow, std::vector<Match>& matches) const
+{
+    _FindAll(beginRow, endRow, matches, [&](const til::CoordType y, auto&& appendCell) {
+        const auto& row = *til::at(snapshot.rows, gsl::narrow_cast<size_t>(y - snapshot.firstRow));
+        // Snapshots skip the trailing halves of wide glyphs, which thus have no text.
+        // Just like in the buffer, they get a copy of their leading half.
+        std::wstring_view glyph;
+        for (til::CoordType x = 0; x < row.size(); ++x)
+        {
+            if (const auto text = row.GetText(x, x + 1); !text.empty())
+            {
+                glyph = text;
+            }
+            appendCell(x, glyph);
+        }
+    });
+}
+
+// Routine Description
+// - The implementation of FindAll.
+// Arguments:
+// - beginRow - The first row to search.
+// - endRow - The row after the last one to search.
+// - matches - The matches are appended to it, sorted by their start.
+// - forEachCell - Called with a row and a function, which it calls with
+//   the column and text of every cell of the row.
+template<typename ForEachCell>
+void Search::_FindAll(const til::CoordType beginRow, const til::CoordType endRow, std::vector<Match>& matches, ForEachCell&& forEachCell) const
+{
+    const auto needleCells = _needle.size();
+    if (needleCells == 0 || beginRow >= endRow)
+    {
+        return;
+    }
+
+    const auto needle = _GetNeedleText();
+
+    // The haystack holds the text of the current row, preceded by the last
+    // needleCells - 1 cells of the previous row, so that we also find matches
+    // that continue on the next row. cellOffsets[i] is the offset of the text
+    // of the cell at cellPositions[i] in the haystack. Every cell has its own
+    // copy of its text, even the trailing half of a wide glyph, just like the
+    // needle we got from s_CreateNeedleFromString.
+    std::wstring haystack;
+    std::vector<size_t> cellOffsets;
+    std::vector<til::point> cellPositions;
+
+    // The row above beginRow is only needed for its last cells.
+    for (auto y = std::max(0, beginRow - 1); y < endRow; ++y)
+    {
+        const auto carry = std::min(cellPositions.size(), needleCells - 1);
+        const auto dropped = cellPositions.size() - carry;
+        if (dropped != 0)
+        {
+            const auto droppedLength = cellOffsets.at(dropped);
+            haystack.erase(0, droppedLength);
+            cellOffsets.erase(cellOffsets.begin(), cellOffsets.begin() + dropped);
+            cellPositions.erase(cellPositions.begin(), cellPositions.begin() + dropped);
+            for (auto& offset : cellOffsets)
+            {
+                offset -= droppedLength;
+            }
+        }
+
+        forEachCell(y, [&](const til::CoordType x, const auto& glyph) {
+            cellOffsets.emplace_back(haystack.size());
+            cellPositions.emplace_back(x, y);
+            for (const auto wch : glyph)
+            {
+                haystack.push_back(_ApplySensitivity(wch));
+            }
+        });
+
+        if (y < beginRow)
+        {
+            continue;
+        }
+
+        // The offset of the end of the last cell, so that cellOffsets[i + needleCells] always exists.
+        cellOffsets.emplace_back(haystack.size());
+
+        // A match that begins in the carried over cells wasn't found in the previous
+        // row yet, because those cells are too few to hold the entire needle.
+        for (auto pos = haystack.find(needle); pos != std::wstring::npos; pos = haystack.find(needle, pos + 1))
+        {
+            // The text only counts as a match if it starts and ends at a cell
+            // boundary and therefore spans exactly as many cells as the needle.
+            const auto cell = std::lower_bound(cellOffsets.begin(), cellOffsets.end(), pos);
+            if (*cell != pos)
+            {
+                continue;
+            }
+
+            const auto index = gsl::narrow_cast<size_t>(cell - cellOffsets.begin());
+            if (index + needleCells >= cellOffsets.size() || cellOffsets.at(index + needleCells) != pos + needle.size())
+            {
+                continue;
+            }
+
+            matches.emplace_back(cellPositions.at(index), cellPositions.at(index + needleCells - 1));
+        }
+
+        cellOffsets.pop_back();
+    }
+}
+
+// Routine Description
+// - Removes all matches that aren't instances of our search term.
+// - This is useful if the previous search term is a prefix of ours and the
+//   buffer hasn't changed since: Our matches must be among the previous ones,
+//   and testing those is faster than searching the entire buffer again.
+// Arguments:
+// - matches - The matches of the previous search. Updated to hold our matches.
+void Search::RefineMatches(std::vector<Match>& matches) const
+{
+    const auto end = std::remove_if(matches.begin(), matches.end(), [&](Match& match) {
+        til::point start;
+        til::point last;
+        if (!_FindNeedleInHaystackAt(match.first, start, last))
+        {
+            return true;
+        }
+        match.second = last;
+        return false;
+    });
+    matches.erase(end, matches.end());
+}
+
 // Routine Description:
 // - Takes the found word and selects it in the screen buffer
 void Search::Select() const
@@ -124,7 +345,7 @@ void Search::Color(const TextAttribute attr) const
 // been called and returned true.
 // Return Value:
 // - pair containing [start, end] coord positions of text found by search
-std::pair<til::point, til::point> Search::GetFoundLocation() const noexcept
+Search::Match Search::GetFoundLocation() const noexcept
 {
     return { _coordSelStart, _coordSelEnd };
 }
@@ -194,12 +415,12 @@ bool Search::_FindNeedleInHaystackAt(const til::point pos, til::point& start, ti
 
     auto bufferPos = pos;
 
-    for (const auto& needleCell : _needle)
+    for (size_t cell = 0; cell < _needle.size(); ++cell)
     {
         // Haystack is the buffer. Needle is the string we were given.
         const auto hayIter = _uiaData.GetTextBuffer().GetTextDataAt(bufferPos);
         const auto hayChars = *hayIter;
-        const auto needleChars = std::wstring_view(needleCell.data(), needleCell.size());
+        const auto needleChars = _needle.at(cell);
 
         // If we didn't match at any point of the needle, return false.
         if (!_CompareChars(hayChars, needleChars))
@@ -330,17 +551,38 @@ void Search::_UpdateNextPosition()
 // - wstr - String that will be our search term
 // Return Value:
 // - Structured text data for comparison to screen buffer text data.
-std::vector<std::vector<wchar_t>> Search::s_CreateNeedleFromString(const std::wstring& wstr)
+Search::Needle Search::s_CreateNeedleFromString(const std::wstring& wstr)
 {
-    const auto charData = Utf16Parser::Parse(wstr);
-    std::vector<std::vector<wchar_t>> cells;
-    for (const auto chars : charData)
+    Needle needle;
+    // Every UTF-16 code unit results in at most 2 cells (a wide glyph).
+    needle.text.reserve(wstr.size() * 2);
+    needle.offsets.reserve(wstr.size() * 2 + 1);
+    for (const auto glyph : Utf16Parser::Glyphs{ wstr })
     {
-        if (IsGlyphFullWidth(std::wstring_view{ chars.data(), chars.size() }))
+        // Wide glyphs occupy two cells, each of which holds a copy of the glyph.
+        const auto cells = IsGlyphFullWidth(glyph) ? 2 : 1;
+        for (auto i = 0; i < cells; ++i)
         {
-            cells.emplace_back(chars);
+            needle.offsets.emplace_back(needle.text.size());
+            needle.text.append(glyph);
         }
-        cells.emplace_back(chars);
     }
-    return cells;
+    needle.offsets.emplace_back(needle.text.size());
+    return needle;
+}
+
+// Routine Description:
+// - Concatenates the text of all cells of our needle, with the case
+//   sensitivity applied, so that it can be compared to the text of a row.
+// Return Value:
+// - The text of the needle.
+std::wstring Search::_GetNeedleText() const
+{
+    std::wstring text;
+    text.reserve(_needle.text.size());
+    for (const auto wch : _needle.text)
+    {
+        text.push_back(_ApplySensitivity(wch));
+    }
+    return text;
 }
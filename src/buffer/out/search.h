@@ -40,6 +40,9 @@ public:
         CaseSensitive
     };
 
+    // The first and the last (inclusive) cell of a match, in buffer coordinates.
+    using Match = std::pair<til::point, til::point>;
+
     Search(Microsoft::Console::Types::IUiaData& uiaData,
            const std::wstring& str,
            const Direction dir,
@@ -52,12 +55,19 @@ public:
            const til::point anchor);
 
     bool FindNext();
+    std::optional<size_t> FindNext(const std::vector<Match>& matches);
+    std::vector<Match> FindAll() const;
+    void FindAll(const til::CoordType beginRow, const til::CoordType endRow, std::vector<Match>& matches) const;
+    void FindAll(const TextBuffer::RowsSnapshot& snapshot, const til::CoordType beginRow, const til::CoordType endRow, std::vector<Match>& matches) const;
+    void RefineMatches(std::vector<Match>& matches) const;
     void Select() const;
     void Color(const TextAttribute attr) const;
 
-    std::pair<til::point, til::point> GetFoundLocation() const noexcept;
+    Match GetFoundLocation() const noexcept;
 
 private:
+    template<typename ForEachCell>
+    void _FindAll(const til::CoordType beginRow, const til::CoordType endRow, std::vector<Match>& matches, ForEachCell&& forEachCell) const;
     wchar_t _ApplySensitivity(const wchar_t wch) const noexcept;
     bool _FindNeedleInHaystackAt(const til::point pos, til::point& start, til::point& end) const;
     bool _CompareChars(const std::wstring_view one, const std::wstring_view two) const noexcept;
@@ -68,7 +78,27 @@ private:
 
     static til::point s_GetInitialAnchor(const Microsoft::Console::Types::IUiaData& uiaData, const Direction dir);
 
-    static std::vector<std::vector<wchar_t>> s_CreateNeedleFromString(const std::wstring& wstr);
+    // The text of all cells of the needle back to back, with the offset at which the text
+    // of each cell begins, plus the length of the text. Compared to a vector per cell,
+    // this takes two allocations per search instead of one per character.
+    struct Needle
+    {
+        std::wstring text;
+        std::vector<size_t> offsets;
+
+        size_t size() const noexcept
+        {
+            return offsets.empty() ? 0 : offsets.size() - 1;
+        }
+
+        std::wstring_view at(const size_t cell) const
+        {
+            return std::wstring_view{ text }.substr(offsets.at(cell), offsets.at(cell + 1) - offsets.at(cell));
+        }
+    };
+
+    static Needle s_CreateNeedleFromString(const std::wstring& wstr);
+    std::wstring _GetNeedleText() const;
 
     bool _reachedEnd = false;
     til::point _coordNext;
@@ -76,7 +106,7 @@ private:
     til::point _coordSelEnd;
 
     const til::point _coordAnchor;
-    const std::vector<std::vector<wchar_t>> _needle;
+    const Needle _needle;
     const Direction _direction;
     const Sensitivity _sensitivity;
     Microsoft::Console::Types::IUiaData& _uiaData;
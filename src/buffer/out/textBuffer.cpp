@@ -6,10 +6,11 @@
 #include "textBuffer.hpp"
 #include "CharRow.hpp"
 
+#include <future>
+
 #include "../renderer/base/renderer.hpp"
 #include "../types/inc/utils.hpp"
 #include "../types/inc/convert.hpp"
-#include "../../types/inc/Utf16Parser.hpp"
 #include "../../types/inc/GlyphWidth.hpp"
 
 #pragma hdrstop
@@ -19,6 +20,184 @@ using namespace Microsoft::Console::Types;
 
 using PointTree = interval_tree::IntervalTree<til::point, size_t>;
 
+// Applications like vim or less switch to the alternate screen buffer and back
+// all the time, which creates and destroys a viewport-sized TextBuffer each time.
+// The arenas of a few recently destroyed buffers are kept around, so that a
+// buffer of the same size can reuse one instead of allocating a new one.
+// Arenas above the size limit, like those of the main buffer with its
+// scrollback, are always freed right away.
+static constexpr size_t MaxPooledCharArenas = 2;
+static constexpr size_t MaxPooledCharArenaCells = 256 * 1024;
+
+namespace
+{
+    struct CharArenaPool
+    {
+        std::mutex lock;
+        std::vector<std::pair<size_t, std::unique_ptr<CharRowCell[]>>> arenas;
+    };
+
+    // The pool is intentionally leaked: TextBuffers that are destroyed during static
+    // destruction (like those of global console state) still release their arenas into it.
+    CharArenaPool& s_GetCharArenaPool() noexcept
+    {
+        static const auto pool = new CharArenaPool{};
+        return *pool;
+    }
+
+    // Returns the longest string that every match of the given (ECMAScript) regex
+    // contains, or an empty string if there's none we can be sure of. Only the top
+    // level of the regex is considered: Groups, classes, escapes that aren't plain
+    // characters and optional characters all end a literal, and alternatives at the
+    // top level mean that there's none at all. For linkPattern this returns "://".
+    std::wstring s_GetRequiredLiteral(const std::wstring_view pattern)
+    {
+        const auto isAsciiAlnum = [](const wchar_t ch) noexcept {
+            return (ch >= L'0' && ch <= L'9') || (ch >= L'A' && ch <= L'Z') || (ch >= L'a' && ch <= L'z');
+        };
+
+        std::wstring best;
+        std::wstring run;
+        // Whether the last character of the run can still be made optional by a quantifier.
+        auto lastIsLiteral = false;
+        const auto endRun = [&]() {
+            if (run.size() > best.size())
+            {
+                best = run;
+            }
+            run.clear();
+            lastIsLiteral = false;
+        };
+
+        // Returns the index of the `]` that ends the class starting at `i`.
+        const auto skipClass = [&](size_t i) {
+            for (++i; i < pattern.size() && pattern[i] != L']'; ++i)
+            {
+                if (pattern[i] == L'\\')
+                {
+                    ++i;
+                }
+            }
+            return i;
+        };
+
+        for (size_t i = 0; i < pattern.size(); ++i)
+        {
+            const auto ch = pattern[i];
+            switch (ch)
+            {
+            case L'|':
+                return {};
+            case L'\\':
+                if (i + 1 >= pattern.size())
+                {
+                    return {};
+                }
+                if (!isAsciiAlnum(pattern[i + 1]))
+                {
+                    run.push_back(pattern[++i]);
+                    lastIsLiteral = true;
+                    break;
+                }
+                // \b, \d, \x41, \1 and friends aren't plain characters. Their
+                // arguments must be skipped, so they aren't taken for literals.
+                endRun();
+                switch (pattern[++i])
+                {
+                case L'x':
+                    i += 2;
+                    break;
+                case L'u':
+                    i += 4;
+                    break;
+                case L'c':
+                    i += 1;
+                    break;
+                default:
+                    while (i + 1 < pattern.size() && pattern[i] >= L'0' && pattern[i] <= L'9' && pattern[i + 1] >= L'0' && pattern[i + 1] <= L'9')
+                    {
+                        ++i;
+                    }
+                    break;
+                }
+                break;
+            case L'[':
+                endRun();
+                i = skipClass(i);
+                break;
+            case L'(':
+            {
+                endRun();
+                size_t depth = 1;
+                for (++i; i < pattern.size() && depth != 0; ++i)
+                {
+                    switch (pattern[i])
+                    {
+                    case L'\\':
+                        ++i;
+                        break;
+                    case L'[':
+                        i = skipClass(i);
+                        break;
+                    case L'(':
+                        ++depth;
+                        break;
+                    case L')':
+                        --depth;
+                        break;
+                    default:
+                        break;
+                    }
+                }
+                if (depth != 0)
+                {
+                    return {};
+                }
+                // The loop went one past the `)`.
+                --i;
+                break;
+            }
+            case L'*':
+            case L'?':
+            case L'{':
+                // The character before these may not be there at all.
+                if (lastIsLiteral)
+                {
+                    run.pop_back();
+                }
+                endRun();
+                if (ch == L'{')
+                {
+                    i = pattern.find(L'}', i);
+                    if (i == std::wstring_view::npos)
+                    {
+                        return {};
+                    }
+                }
+                break;
+            case L'+':
+                // The character before this is there, but it may be followed by copies of itself.
+                endRun();
+                break;
+            case L'.':
+            case L'^':
+            case L'$':
+            case L')':
+            case L']':
+                endRun();
+                break;
+            default:
+                run.push_back(ch);
+                lastIsLiteral = true;
+                break;
+            }
+        }
+
+        endRun();
+        return best;
+    }
+}
+
 // Routine Description:
 // - Creates a new instance of TextBuffer
 // Arguments:
@@ -38,24 +217,116 @@ TextBuffer::TextBuffer(const til::size screenBufferSize,
     _firstRow{ 0 },
     _currentAttributes{ defaultAttributes },
     _cursor{ cursorSize, *this },
+    _charArena{ _AllocateCharArena(screenBufferSize) },
+    _charArenaSize{ screenBufferSize },
+    _attributeTable{ std::make_unique<TextAttributeTable>() },
     _storage{},
-    _unicodeStorage{},
     _isActiveBuffer{ isActiveBuffer },
     _renderer{ renderer },
     _size{},
     _currentHyperlinkId{ 1 },
-    _currentPatternId{ 0 }
+    _currentPatternId{ 0 },
+    _revision{ 0 },
+    _shiftRevision{ 0 }
 {
     // initialize ROWs
     _storage.reserve(gsl::narrow<size_t>(screenBufferSize.Y));
     for (til::CoordType i = 0; i < screenBufferSize.Y; ++i)
     {
-        _storage.emplace_back(i, screenBufferSize.X, _currentAttributes, this);
+        _storage.emplace_back(_GetArenaRow(_charArena.get(), i, screenBufferSize.X), screenBufferSize.X, _currentAttributes, this);
     }
 
     _UpdateSize();
 }
 
+TextBuffer::~TextBuffer()
+{
+    // The rows only view their slices of the arena, so it doesn't matter that they're destroyed after it.
+    _ReleaseCharArena(std::move(_charArena), _GetArenaCells(_charArenaSize));
+}
+
+// Routine Description:
+// - Allocates the contiguous glyph storage for a buffer of the given size.
+//   Every ROW gets a width-sized slice of it instead of its own heap allocation.
+// - Reuses a pooled arena of the same size if there's one, see _ReleaseCharArena.
+// Arguments:
+// - size - The X by Y dimensions of the buffer
+// Return Value:
+// - The arena, initialized to default (space) cells.
+std::unique_ptr<CharRowCell[]> TextBuffer::_AllocateCharArena(const til::size size)
+{
+    const auto cells = gsl::narrow<size_t>(size.X) * gsl::narrow<size_t>(size.Y);
+
+    std::unique_ptr<CharRowCell[]> arena;
+    if (cells <= MaxPooledCharArenaCells)
+    {
+        auto& pool = s_GetCharArenaPool();
+        const std::lock_guard guard{ pool.lock };
+        const auto it = std::find_if(pool.arenas.rbegin(), pool.arenas.rend(), [&](const auto& entry) noexcept {
+            return entry.first == cells;
+        });
+        if (it != pool.arenas.rend())
+        {
+            arena = std::move(it->second);
+            pool.arenas.erase(std::next(it).base());
+        }
+    }
+
+    if (arena)
+    {
+        std::fill_n(arena.get(), cells, CharRowCell{});
+        return arena;
+    }
+
+    return std::make_unique<CharRowCell[]>(cells);
+}
+
+// Routine Description:
+// - Releases an arena returned by _AllocateCharArena. Small arenas are kept
+//   in a pool for reuse, with the most recently released one being reused first.
+// Arguments:
+// - arena - The arena to release
+// - cells - The number of cells in the arena
+void TextBuffer::_ReleaseCharArena(std::unique_ptr<CharRowCell[]>&& arena, const size_t cells) noexcept
+{
+    if (!arena || cells > MaxPooledCharArenaCells)
+    {
+        arena.reset();
+        return;
+    }
+
+    try
+    {
+        auto& pool = s_GetCharArenaPool();
+        const std::lock_guard guard{ pool.lock };
+        if (pool.arenas.size() >= MaxPooledCharArenas)
+        {
+            pool.arenas.erase(pool.arenas.begin());
+        }
+        pool.arenas.emplace_back(cells, std::move(arena));
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Returns the slice of the given arena reserved for the row at the given storage index.
+// Arguments:
+// - arena - The arena returned by _AllocateCharArena
+// - index - The index of the row within the arena
+// - width - The width of each row in the arena
+// Return Value:
+// - Pointer to the first of the width cells of that row.
+CharRowCell* TextBuffer::_GetArenaRow(CharRowCell* const arena, const til::CoordType index, const til::CoordType width) noexcept
+{
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    return arena + gsl::narrow_cast<size_t>(index) * gsl::narrow_cast<size_t>(width);
+}
+
+size_t TextBuffer::_GetArenaCells(const til::size size) noexcept
+{
+    return gsl::narrow_cast<size_t>(size.X) * gsl::narrow_cast<size_t>(size.Y);
+}
+
 // Routine Description:
 // - Copies properties from another text buffer into this one.
 // - This is primarily to copy properties that would otherwise not be specified during CreateInstance
@@ -88,9 +359,7 @@ til::CoordType TextBuffer::TotalRowCount() const noexcept
 // - const reference to the requested row. Asserts if out of bounds.
 const ROW& TextBuffer::GetRowByOffset(const til::CoordType index) const noexcept
 {
-    // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
-    const auto offsetIndex = gsl::narrow_cast<size_t>(_firstRow + index) % _storage.size();
-    return til::at(_storage, offsetIndex);
+    return til::at(_storage, _GetStorageIndex(index));
 }
 
 // Routine Description:
@@ -102,9 +371,27 @@ const ROW& TextBuffer::GetRowByOffset(const til::CoordType index) const noexcept
 // - reference to the requested row. Asserts if out of bounds.
 ROW& TextBuffer::GetRowByOffset(const til::CoordType index) noexcept
 {
-    // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
-    const auto offsetIndex = gsl::narrow_cast<size_t>(_firstRow + index) % _storage.size();
-    return til::at(_storage, offsetIndex);
+    return til::at(_storage, _GetStorageIndex(index));
+}
+
+// Routine Description:
+// - Turns an offset from the first row into the index of the row within _storage.
+// - Rows are stored circularly, so the offset is added to the first row and
+//   wrapped around the end of the storage. _firstRow is always within the
+//   storage, so for offsets within the buffer that's a single subtraction,
+//   instead of the division of a modulo in every row access.
+size_t TextBuffer::_GetStorageIndex(const til::CoordType index) const noexcept
+{
+    const auto size = _storage.size();
+    auto offsetIndex = gsl::narrow_cast<size_t>(_firstRow + index);
+    offsetIndex -= offsetIndex >= size ? size : 0;
+    // Offsets past the end of the buffer can only come from callers that
+    // rely on them wrapping around, which the modulo used to take care of.
+    if (offsetIndex >= size)
+    {
+        offsetIndex %= size;
+    }
+    return offsetIndex;
 }
 
 // Routine Description:
@@ -497,22 +784,24 @@ bool TextBuffer::IncrementCursor()
     // Cursor position is stored as logical array indices (starts at 0) for the window
     // Buffer Size is specified as the "length" of the array. It would say 80 for valid values of 0-79.
     // So subtract 1 from buffer size in each direction to find the index of the final column in the buffer
-    const auto iFinalColumnIndex = GetLineWidth(GetCursor().GetPosition().Y) - 1;
-
-    // Move the cursor one position to the right
-    GetCursor().IncrementXPosition(1);
+    auto& cursor = GetCursor();
+    const auto position = cursor.GetPosition();
+    const auto iFinalColumnIndex = GetLineWidth(position.Y) - 1;
 
-    auto fSuccess = true;
-    // If we've passed the final valid column...
-    if (GetCursor().GetPosition().X > iFinalColumnIndex)
+    // If we're about to pass the final valid column...
+    if (position.X >= iFinalColumnIndex)
     {
         // Then mark that we've been forced to wrap
         _SetWrapOnCurrentRow();
 
-        // Then move the cursor to a new line
-        fSuccess = NewlineCursor();
+        // Then move the cursor to a new line. The cursor isn't moved to the
+        // right beforehand, so that it's only redrawn at its old and new position.
+        return NewlineCursor();
     }
-    return fSuccess;
+
+    // Move the cursor one position to the right
+    cursor.SetXPosition(position.X + 1);
+    return true;
 }
 
 //Routine Description:
@@ -523,27 +812,23 @@ bool TextBuffer::IncrementCursor()
 // - true if we successfully moved the cursor.
 bool TextBuffer::NewlineCursor()
 {
-    auto fSuccess = false;
+    auto& cursor = GetCursor();
     const auto iFinalRowIndex = GetSize().BottomInclusive();
+    const auto newY = cursor.GetPosition().Y + 1;
 
-    // Reset the cursor position to 0 and move down one line
-    GetCursor().SetXPosition(0);
-    GetCursor().IncrementYPosition(1);
+    // Reset the cursor position to 0 and move down one line, but stay on
+    // the final logical/offset row of the buffer if we'd pass it.
+    // The position is updated all at once, so that the cursor is only
+    // redrawn at its old and its new position.
+    cursor.SetPosition({ 0, std::min(newY, iFinalRowIndex) });
 
     // If we've passed the final valid row...
-    if (GetCursor().GetPosition().Y > iFinalRowIndex)
+    if (newY > iFinalRowIndex)
     {
-        // Stay on the final logical/offset row of the buffer.
-        GetCursor().SetYPosition(iFinalRowIndex);
-
         // Instead increment the circular buffer to move us into the "oldest" row of the backing buffer
-        fSuccess = IncrementCircularBuffer();
-    }
-    else
-    {
-        fSuccess = true;
+        return IncrementCircularBuffer();
     }
-    return fSuccess;
+    return true;
 }
 
 //Routine Description:
@@ -561,8 +846,8 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
         _renderer.TriggerFlush(true);
     }
 
-    // Prune hyperlinks to delete obsolete references
-    _PruneHyperlinks();
+    // Remember the hyperlinks of the old first row, which might not be used anywhere else.
+    const auto hyperlinks = _storage.at(_firstRow).GetAttrRow().GetHyperlinks();
 
     // Second, clean out the old "first row" as it will become the "last row" of the buffer after the circle is performed.
     auto fillAttributes = _currentAttributes;
@@ -573,6 +858,10 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
         fillAttributes.SetStandardErase();
     }
     const auto fSuccess = _storage.at(_firstRow).Reset(fillAttributes);
+
+    // Prune hyperlinks to delete obsolete references
+    _PruneHyperlinks(hyperlinks);
+
     if (fSuccess)
     {
         // Now proceed to increment.
@@ -584,6 +873,9 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
         {
             _firstRow = 0;
         }
+
+        // Every row now has a different offset.
+        _shiftRevision = _NextRevision();
     }
     return fSuccess;
 }
@@ -604,13 +896,26 @@ til::point TextBuffer::GetLastNonSpaceCharacter(std::optional<const Microsoft::C
 {
     const auto viewport = viewOptional.has_value() ? viewOptional.value() : GetSize();
 
+    // Readers may hold the console lock concurrently,
+    // but only one of them may fill the cache at a time.
+    const std::lock_guard guard{ _measureCacheLock };
+
+    // UIA asks for this on every navigation. As long as no row changed since
+    // the last call, not even the row revisions need to be looked at again.
+    if (_lastNonSpaceCache && _lastNonSpaceCache->revision == _revision && _lastNonSpaceCache->viewport == viewport)
+    {
+        return _lastNonSpaceCache->position;
+    }
+
     til::point coordEndOfText;
     // Search the given viewport by starting at the bottom.
     coordEndOfText.Y = viewport.BottomInclusive();
 
     const auto& currRow = GetRowByOffset(coordEndOfText.Y);
     // The X position of the end of the valid text is the Right draw boundary (which is one beyond the final valid character)
-    coordEndOfText.X = currRow.GetCharRow().MeasureRight() - 1;
+    // Rows remember their measurement until they're modified, so mostly
+    // empty buffers are skipped over without looking at their cells.
+    coordEndOfText.X = currRow._MeasureRightLocked() - 1;
 
     // If the X coordinate turns out to be -1, the row was empty, we need to search backwards for the real end of text.
     const auto viewportTop = viewport.Top();
@@ -621,7 +926,7 @@ til::point TextBuffer::GetLastNonSpaceCharacter(std::optional<const Microsoft::C
         const auto& backupRow = GetRowByOffset(coordEndOfText.Y);
         // We need to back up to the previous row if this line is empty, AND there are more rows
 
-        coordEndOfText.X = backupRow.GetCharRow().MeasureRight() - 1;
+        coordEndOfText.X = backupRow._MeasureRightLocked() - 1;
         fDoBackUp = (coordEndOfText.X < 0 && coordEndOfText.Y > viewportTop);
     }
 
@@ -629,6 +934,7 @@ til::point TextBuffer::GetLastNonSpaceCharacter(std::optional<const Microsoft::C
     coordEndOfText.Y = std::max(coordEndOfText.Y, 0);
     coordEndOfText.X = std::max(coordEndOfText.X, 0);
 
+    _lastNonSpaceCache = { _revision, viewport, coordEndOfText };
     return coordEndOfText;
 }
 
@@ -681,7 +987,11 @@ void TextBuffer::_UpdateSize()
 
 void TextBuffer::_SetFirstRowIndex(const til::CoordType FirstRowIndex) noexcept
 {
-    _firstRow = FirstRowIndex;
+    if (_firstRow != FirstRowIndex)
+    {
+        _firstRow = FirstRowIndex;
+        _shiftRevision = _NextRevision();
+    }
 }
 
 void TextBuffer::ScrollRows(const til::CoordType firstRow, const til::CoordType size, const til::CoordType delta)
@@ -692,17 +1002,22 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, const til::CoordType
         return;
     }
 
-    // OK. We're about to play games by moving rows around within the deque to
-    // scroll a massive region in a faster way than copying things.
-    // To make this easier, first correct the circular buffer to have the first row be 0 again.
-    if (_firstRow != 0)
-    {
-        // Rotate the buffer to put the first row at the front.
-        std::rotate(_storage.begin(), _storage.begin() + _firstRow, _storage.end());
-
-        // The first row is now at the top.
-        _firstRow = 0;
-    }
+    // OK. We're about to play games by moving rows around within the circular buffer to
+    // scroll a massive region in a faster way than copying things. The rotation is done
+    // with three reversals of rows addressed by their offset, which works on the circular
+    // buffer in place. This way only the rows of the region are touched, instead of
+    // rotating the entire storage to put the first row at the front beforehand.
+    const auto reverse = [&](til::CoordType first, til::CoordType last) {
+        for (--last; first < last; ++first, --last)
+        {
+            std::swap(GetRowByOffset(first), GetRowByOffset(last));
+        }
+    };
+    const auto rotate = [&](til::CoordType first, til::CoordType middle, til::CoordType last) {
+        reverse(first, middle);
+        reverse(middle, last);
+        reverse(first, last);
+    };
 
     // Rotate just the subsection specified
     if (delta < 0)
@@ -740,7 +1055,7 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, const til::CoordType
         // | 10
         // | 11
         // - end
-        std::rotate(_storage.begin() + firstRow + delta, _storage.begin() + firstRow, _storage.begin() + firstRow + size);
+        rotate(firstRow + delta, firstRow, firstRow + size);
     }
     else
     {
@@ -777,12 +1092,98 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, const til::CoordType
         // | 10
         // | 11
         // - end
-        std::rotate(_storage.begin() + firstRow, _storage.begin() + firstRow + size, _storage.begin() + firstRow + size + delta);
+        rotate(firstRow, firstRow + size, firstRow + size + delta);
+    }
+
+    // All the rows that ended up at a different offset count as changed.
+    const auto firstChanged = std::min(firstRow, firstRow + delta);
+    const auto lastChanged = std::max(firstRow + size, firstRow + size + delta);
+    for (auto i = firstChanged; i < lastChanged; ++i)
+    {
+        GetRowByOffset(i).MarkChanged();
+    }
+}
+
+// Routine Description:
+// - Copies a rectangular area of the buffer to another position, one row span at a time.
+// - Every span is read in full before it's written, and the rows are walked away from
+//   the target, so the source and the target may overlap.
+// Arguments:
+// - source - The area to copy (exclusive). Must be within the buffer.
+// - target - The top left corner of the area to copy to. The copy is clipped to the buffer.
+// Return Value:
+// - <none>
+void TextBuffer::CopyRect(const til::rect& source, const til::point target)
+{
+    const auto height = source.height();
+    if (source.width() <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    std::vector<OutputCell> cells;
+    cells.reserve(gsl::narrow_cast<size_t>(source.width()));
+
+    const auto copyingDown = target.Y > source.top;
+    for (til::CoordType i = 0; i < height; ++i)
+    {
+        const auto offset = copyingDown ? height - 1 - i : i;
+        const auto sourceRow = source.top + offset;
+
+        cells.clear();
+        const auto limit = Viewport::FromExclusive({ source.left, sourceRow, source.right, sourceRow + 1 });
+        for (auto it = GetCellDataAt({ source.left, sourceRow }, limit); it; ++it)
+        {
+            cells.emplace_back(*it);
+        }
+        WriteLine(OutputCellIterator{ cells }, { target.X, target.Y + offset });
+    }
+}
+
+// Routine Description:
+// - Changes the attributes of a rectangular area of the buffer, leaving its text as is.
+// - The change is applied to every run of attributes within the row spans of the area
+//   instead of every cell, so its cost depends on the number of runs, not the width.
+// Arguments:
+// - area - The area to change (exclusive). Must be within the buffer.
+// - change - Modifies the attributes of a run in place.
+// Return Value:
+// - <none>
+void TextBuffer::ChangeAttributes(const til::rect& area, const std::function<void(TextAttribute&)>& change)
+{
+    if (area.left >= area.right || area.top >= area.bottom)
+    {
+        return;
+    }
+
+    std::vector<ATTR_ROW::attr_run> changedRuns;
+    for (auto row = area.top; row < area.bottom; ++row)
+    {
+        auto& attrRow = GetRowByOffset(row).GetAttrRow();
+
+        changedRuns.clear();
+        til::CoordType runStart = 0;
+        for (const auto& run : attrRow.GetRuns())
+        {
+            const auto runEnd = runStart + run.length;
+            const auto spanStart = std::max(runStart, area.left);
+            const auto spanEnd = std::min(runEnd, area.right);
+            if (spanStart < spanEnd)
+            {
+                auto attr = attrRow.GetAttrById(run.value);
+                change(attr);
+                changedRuns.emplace_back(attr, gsl::narrow_cast<uint16_t>(spanEnd - spanStart));
+            }
+            if (runEnd >= area.right)
+            {
+                break;
+            }
+            runStart = runEnd;
+        }
+        attrRow.ReplaceRuns(area.left, changedRuns);
     }
 
-    // Renumber the IDs now that we've rearranged where the rows sit within the buffer.
-    // Refreshing should also delegate to the UnicodeStorage to re-key all the stored unicode sequences (where applicable).
-    _RefreshRowIDs(std::nullopt);
+    TriggerRedraw(Viewport::FromExclusive(area));
 }
 
 Cursor& TextBuffer::GetCursor() noexcept
@@ -840,6 +1241,35 @@ void TextBuffer::ResetLineRenditionRange(const til::CoordType startRow, const ti
     }
 }
 
+// Routine Description:
+// - Resets the rows in the given range to empty ones, filled with spaces in the
+//   given attributes, with their line rendition and wrap flags reset as well.
+// - This is a lot cheaper than writing blank cells into the rows, because it
+//   doesn't need to go through an OutputCellIterator for every single cell.
+//   It's what makes clearing a large scrollback fast.
+// Arguments:
+// - startRow - The first row to reset (inclusive).
+// - endRow - The last row to reset (exclusive).
+// - attributes - The attributes to fill the rows with.
+// Return Value:
+// - <none>
+void TextBuffer::ResetRows(const til::CoordType startRow, const til::CoordType endRow, const TextAttribute& attributes)
+{
+    const auto firstRow = std::max(startRow, 0);
+    const auto lastRow = std::min(endRow, TotalRowCount());
+    if (firstRow >= lastRow)
+    {
+        return;
+    }
+
+    for (auto row = firstRow; row < lastRow; row++)
+    {
+        GetRowByOffset(row).Reset(attributes);
+    }
+
+    TriggerRedraw(Viewport::FromExclusive({ 0, firstRow, GetSize().Width(), lastRow }));
+}
+
 LineRendition TextBuffer::GetLineRendition(const til::CoordType row) const noexcept
 {
     return GetRowByOffset(row).GetLineRendition();
@@ -913,30 +1343,48 @@ void TextBuffer::Reset()
         const auto TopRowIndex = (GetFirstRowIndex() + TopRow) % currentSize.Y;
 
         // rotate rows until the top row is at index 0
-        for (auto i = 0; i < TopRowIndex; i++)
-        {
-            _storage.emplace_back(std::move(_storage.front()));
-            _storage.erase(_storage.begin());
-        }
+        std::rotate(_storage.begin(), _storage.begin() + TopRowIndex, _storage.end());
 
         _SetFirstRowIndex(0);
 
         // realloc in the Y direction
         // remove rows if we're shrinking
-        while (_storage.size() > static_cast<size_t>(newSize.Y))
+        if (_storage.size() > static_cast<size_t>(newSize.Y))
         {
-            _storage.pop_back();
+            for (auto it = _storage.begin() + newSize.Y; it != _storage.end(); ++it)
+            {
+                it->_attrRow.ReleaseHyperlinks();
+            }
+            _storage.erase(_storage.begin() + newSize.Y, _storage.end());
         }
-        // add rows if we're growing
-        while (_storage.size() < static_cast<size_t>(newSize.Y))
+
+        if (!_TryResizeInPlace(newSize, attributes))
         {
-            _storage.emplace_back(gsl::narrow_cast<til::CoordType>(_storage.size()), newSize.X, attributes, this);
-        }
+            // Realloc in the X direction by moving every remaining row into its slice of a new arena.
+            // ROW::Resize always rebinds the glyphs before it touches the attributes,
+            // so we visit every row even if one of them fails, before releasing the old arena.
+            auto arena = _AllocateCharArena(newSize);
+            auto hr = S_OK;
+            til::CoordType i = 0;
+            for (auto& row : _storage)
+            {
+                const auto rowHr = row.Resize(_GetArenaRow(arena.get(), i++, newSize.X), newSize.X);
+                if (SUCCEEDED(hr))
+                {
+                    hr = rowHr;
+                }
+            }
+            _ReleaseCharArena(std::exchange(_charArena, std::move(arena)), _GetArenaCells(_charArenaSize));
+            _charArenaSize = newSize;
+            THROW_IF_FAILED(hr);
 
-        // Now that we've tampered with the row placement, refresh all the row IDs.
-        // Also take advantage of the row ID refresh loop to resize the rows in the X dimension
-        // and cleanup the UnicodeStorage characters that might fall outside the resized buffer.
-        _RefreshRowIDs(newSize.X);
+            // add rows if we're growing
+            while (_storage.size() < static_cast<size_t>(newSize.Y))
+            {
+                const auto index = gsl::narrow_cast<til::CoordType>(_storage.size());
+                _storage.emplace_back(_GetArenaRow(_charArena.get(), index, newSize.X), newSize.X, attributes, this);
+            }
+        }
 
         // Update the cached size value
         _UpdateSize();
@@ -946,113 +1394,337 @@ void TextBuffer::Reset()
     return S_OK;
 }
 
-const UnicodeStorage& TextBuffer::GetUnicodeStorage() const noexcept
+// Routine Description:
+// - Helper for ResizeTraditional. Resizes the rows within the slices of the arena they
+//   already have, if the arena is large enough for the new size. New rows are given
+//   the slices that aren't used by any row. This way, repeatedly resizing a buffer
+//   back and forth (like when dragging the window of an alt buffer) doesn't
+//   allocate and copy the entire buffer every time.
+// - The rows beyond the new height must already have been removed.
+// Arguments:
+// - newSize - The new size of the buffer.
+// - attributes - The attributes to fill new rows with.
+// Return Value:
+// - true if the buffer was resized, false if it needs a new arena.
+bool TextBuffer::_TryResizeInPlace(const til::size newSize, const TextAttribute& attributes)
 {
-    return _unicodeStorage;
-}
+    // Don't keep holding on to an arena that's become much larger than what
+    // we need, after the buffer shrunk considerably.
+    const auto arenaCells = _GetArenaCells(_charArenaSize);
+    if (newSize.X <= 0 || newSize.Y <= 0 || newSize.X > _charArenaSize.X || newSize.Y > _charArenaSize.Y || _GetArenaCells(newSize) < arenaCells / 4)
+    {
+        return false;
+    }
 
-UnicodeStorage& TextBuffer::GetUnicodeStorage() noexcept
-{
-    return _unicodeStorage;
-}
+    std::vector<bool> usedSlices(gsl::narrow_cast<size_t>(_charArenaSize.Y));
+    for (auto& row : _storage)
+    {
+        const auto offset = row._charRow.begin() - _charArena.get();
+        usedSlices.at(gsl::narrow_cast<size_t>(offset / _charArenaSize.X)) = true;
+        THROW_IF_FAILED(row.Resize(row._charRow.begin(), newSize.X));
+    }
 
-void TextBuffer::SetAsActiveBuffer(const bool isActiveBuffer) noexcept
-{
-    _isActiveBuffer = isActiveBuffer;
-}
+    til::CoordType slice = 0;
+    while (_storage.size() < static_cast<size_t>(newSize.Y))
+    {
+        while (usedSlices.at(gsl::narrow_cast<size_t>(slice)))
+        {
+            ++slice;
+        }
 
-bool TextBuffer::IsActiveBuffer() const noexcept
-{
-    return _isActiveBuffer;
+        // The slice may still contain the glyphs of a row that was removed.
+        const auto cells = _GetArenaRow(_charArena.get(), slice++, _charArenaSize.X);
+        std::fill_n(cells, newSize.X, CharRowCell{});
+
+        const auto id = gsl::narrow_cast<til::CoordType>(_storage.size());
+        _storage.emplace_back(id, cells, newSize.X, attributes, this);
+    }
+
+    return true;
 }
 
-Microsoft::Console::Render::Renderer& TextBuffer::GetRenderer() noexcept
+// Routine Description:
+// - Returns the current revision of the buffer's contents. Every modification
+//   of a row assigns it a new, higher revision. Callers can remember the value
+//   and ask which rows have been modified since then, in order to only process
+//   those again instead of rescanning the entire buffer.
+// Return Value:
+// - The revision of the most recent modification.
+uint64_t TextBuffer::GetRevision() const noexcept
 {
-    return _renderer;
+    return _revision;
 }
 
-void TextBuffer::TriggerRedraw(const Viewport& viewport)
+// Routine Description:
+// - Checks whether any of the given rows has been modified since the given revision.
+// - Rows count as modified if they've been moved to a different offset, for
+//   instance because the circular buffer was incremented.
+// Arguments:
+// - revision - A value previously returned by GetRevision.
+// - firstRow - The offset of the first row to check.
+// - lastRow - The offset of the last row to check, inclusive.
+// Return Value:
+// - true if any of the rows in [firstRow, lastRow] have changed.
+bool TextBuffer::HasChangedSince(const uint64_t revision, const til::CoordType firstRow, const til::CoordType lastRow) const noexcept
 {
-    if (_isActiveBuffer)
+    if (revision < _shiftRevision)
     {
-        _renderer.TriggerRedraw(viewport);
+        return true;
     }
-}
 
-void TextBuffer::TriggerRedrawCursor(const til::point position)
-{
-    if (_isActiveBuffer)
+    const auto first = std::max(firstRow, 0);
+    const auto last = std::min(lastRow, TotalRowCount() - 1);
+    for (auto i = first; i <= last; ++i)
     {
-        _renderer.TriggerRedrawCursor(&position);
+        if (GetRowByOffset(i).GetRevision() > revision)
+        {
+            return true;
+        }
     }
+    return false;
 }
 
-void TextBuffer::TriggerRedrawAll()
+// Routine Description:
+// - Returns the offsets of all rows that have been modified since the given revision.
+//   See HasChangedSince.
+// Arguments:
+// - revision - A value previously returned by GetRevision.
+// Return Value:
+// - The row offsets in ascending order.
+std::vector<til::CoordType> TextBuffer::GetRowsChangedSince(const uint64_t revision) const
 {
-    if (_isActiveBuffer)
+    std::vector<til::CoordType> rows;
+    const auto height = TotalRowCount();
+    const auto all = revision < _shiftRevision;
+    for (til::CoordType i = 0; i < height; ++i)
     {
-        _renderer.TriggerRedrawAll();
+        if (all || GetRowByOffset(i).GetRevision() > revision)
+        {
+            rows.emplace_back(i);
+        }
     }
+    return rows;
 }
 
-void TextBuffer::TriggerScroll()
+// Routine Description:
+// - Returns the text of the given columns of a row. The trailing halves of wide
+//   glyphs are skipped, just like GetText does.
+// - The returned view is only valid as long as the buffer isn't modified.
+//   Callers need to hold the console lock, at least for reading, while they use it.
+// Arguments:
+// - row - The offset of the row.
+// - beginColumn - The first column to return.
+// - endColumn - The column after the last one to return.
+// Return Value:
+// - The text of the columns [beginColumn, endColumn).
+std::wstring_view TextBuffer::GetRowText(const til::CoordType row, til::CoordType beginColumn, til::CoordType endColumn) const
 {
-    if (_isActiveBuffer)
+    return GetRowSnapshot(row)->GetText(beginColumn, endColumn);
+}
+
+// Routine Description:
+// - Returns a snapshot of a row, like SnapshotRows does.
+// - UIA clients tend to ask for the text of the same rows over and over again,
+//   one range at a time. That's why the snapshot of each row is kept around
+//   until the row gets modified. SnapshotRows shares them as well.
+// Arguments:
+// - row - The offset of the row.
+// Return Value:
+// - The snapshot of the row.
+std::shared_ptr<const RowSnapshot> TextBuffer::GetRowSnapshot(const til::CoordType row) const
+{
+    const auto& rowData = GetRowByOffset(row);
+
+    // Readers may hold the console lock concurrently,
+    // but only one of them may fill the cache at a time.
+    const std::lock_guard guard{ _rowTextCacheLock };
+
+    const auto height = gsl::narrow_cast<size_t>(TotalRowCount());
+    if (_rowTextCache.size() != height)
     {
-        _renderer.TriggerScroll();
+        _rowTextCache.clear();
+        _rowTextCache.resize(height);
+    }
+
+    auto& entry = til::at(_rowTextCache, gsl::narrow_cast<size_t>(row));
+    if (HasChangedSince(entry.revision, row, row))
+    {
+        {
+            const std::lock_guard snapshotGuard{ _rowSnapshotLock };
+            entry.snapshot = _SnapshotRowLocked(rowData);
+        }
+        entry.revision = GetRevision();
     }
+
+    return entry.snapshot;
 }
 
-void TextBuffer::TriggerScroll(const til::point delta)
+// Routine Description:
+// - Takes snapshots of the given rows. Rows that weren't modified since they
+//   were last snapshotted (and that snapshot is still in use) aren't copied
+//   again, which makes repeated snapshots of mostly unchanged rows cheap.
+// - The caller must hold the console lock, but only while this runs.
+// Arguments:
+// - firstRow - the offset of the first row
+// - lastRow - the offset of the last row
+// Return Value:
+// - the snapshots of the rows
+TextBuffer::RowsSnapshot TextBuffer::SnapshotRows(const til::CoordType firstRow, const til::CoordType lastRow) const
 {
-    if (_isActiveBuffer)
+    RowsSnapshot snapshot;
+    snapshot.firstRow = std::clamp(firstRow, 0, TotalRowCount());
+    snapshot.revision = GetRevision();
+
+    const auto endRow = std::clamp(lastRow + 1, snapshot.firstRow, TotalRowCount());
+    snapshot.rows.reserve(gsl::narrow_cast<size_t>(endRow - snapshot.firstRow));
+
+    const std::lock_guard guard{ _rowSnapshotLock };
+    for (auto y = snapshot.firstRow; y < endRow; ++y)
     {
-        _renderer.TriggerScroll(&delta);
+        snapshot.rows.emplace_back(_SnapshotRowLocked(GetRowByOffset(y)));
     }
+
+    return snapshot;
 }
 
-void TextBuffer::TriggerNewTextNotification(const std::wstring_view newText)
+// Routine Description:
+// - Returns the last snapshot of the given row if it's still in use and the row
+//   didn't change since, or a new one otherwise. _rowSnapshotLock must be held.
+// Arguments:
+// - row - the row to take a snapshot of
+// Return Value:
+// - the snapshot of the row
+std::shared_ptr<const RowSnapshot> TextBuffer::_SnapshotRowLocked(const ROW& row) const
 {
-    if (_isActiveBuffer)
+    auto snapshot = row._snapshot.lock();
+    if (!snapshot || snapshot->GetRevision() != row.GetRevision())
     {
-        _renderer.TriggerNewTextNotification(newText);
+        snapshot = std::make_shared<const RowSnapshot>(row);
+        row._snapshot = snapshot;
     }
+    return snapshot;
+}
+
+// Routine Description:
+// - Returns the next revision for a row that got modified. See GetRevision.
+uint64_t TextBuffer::_NextRevision() noexcept
+{
+    return ++_revision;
+}
+
+const TextAttributeTable& TextBuffer::GetAttributeTable() const noexcept
+{
+    return *_attributeTable;
+}
+
+TextAttributeTable& TextBuffer::GetAttributeTable() noexcept
+{
+    return *_attributeTable;
 }
 
 // Routine Description:
-// - Method to help refresh all the Row IDs after manipulating the row
-//   by shuffling pointers around.
-// - This will also update parent pointers that are stored in depth within the buffer
-//   (e.g. it will update CharRow parents pointing at Rows that might have been moved around)
-// - Optionally takes a new row width if we're resizing to perform a resize operation and cleanup
-//   any high unicode (UnicodeStorage) runs while we're already looping through the rows.
+// - Replaces the attribute table with a new one that only holds the attributes
+//   that are still in use, once the current one is getting full.
+// - Compacting re-interns the runs of every row, which is why it isn't done
+//   while writing. Hosts call this once they're done with a batch of output.
+// - Must only be called when no ATTR_ROW is in the middle of being modified.
 // Arguments:
-// - newRowWidth - Optional new value for the row width.
-void TextBuffer::_RefreshRowIDs(std::optional<til::CoordType> newRowWidth)
+// - <none>
+// Return Value:
+// - <none>
+void TextBuffer::CompactAttributeTable() noexcept
 {
-    std::unordered_map<til::CoordType, til::CoordType> rowMap;
-    til::CoordType i = 0;
-    for (auto& it : _storage)
+    if (!_attributeTable->NeedsCompaction())
     {
-        // Build a map so we can update Unicode Storage
-        rowMap.emplace(it.GetId(), i);
-
-        // Update the IDs
-        it.SetId(i++);
+        return;
+    }
 
-        // Also update the char row parent pointers as they can get shuffled up in the rotates.
-        it.GetCharRow().UpdateParent(&it);
+    try
+    {
+        // First translate all rows and only then replace their runs,
+        // so that they all remain consistent if we run out of memory.
+        auto table = std::make_unique<TextAttributeTable>();
+        std::vector<ATTR_ROW::rle_vector> runs;
+        runs.reserve(_storage.size());
+        for (const auto& row : _storage)
+        {
+            runs.emplace_back(row.GetAttrRow().Reintern(*table));
+        }
 
-        // Resize the rows in the X dimension if we have a new width
-        if (newRowWidth.has_value())
+        for (size_t i = 0; i < _storage.size(); ++i)
         {
-            // Realloc in the X direction
-            THROW_IF_FAILED(it.Resize(newRowWidth.value()));
+            // Rebinding doesn't change what the row looks like, so this doesn't mark it as changed.
+            til::at(_storage, i)._attrRow.Rebind(std::move(til::at(runs, i)), table.get());
         }
+
+        table->SetCompactionThreshold(table->Size());
+        table->TakeHyperlinkReferences(*_attributeTable);
+        _attributeTable = std::move(table);
     }
+    CATCH_LOG();
+}
+
+void TextBuffer::SetAsActiveBuffer(const bool isActiveBuffer) noexcept
+{
+    _isActiveBuffer = isActiveBuffer;
+}
+
+bool TextBuffer::IsActiveBuffer() const noexcept
+{
+    return _isActiveBuffer;
+}
+
+Microsoft::Console::Render::Renderer& TextBuffer::GetRenderer() noexcept
+{
+    return _renderer;
+}
+
+void TextBuffer::TriggerRedraw(const Viewport& viewport)
+{
+    if (_isActiveBuffer)
+    {
+        _renderer.TriggerRedraw(viewport);
+    }
+}
+
+void TextBuffer::TriggerRedrawCursor(const til::point position)
+{
+    if (_isActiveBuffer)
+    {
+        _renderer.TriggerRedrawCursor(&position);
+    }
+}
 
-    // Give the new mapping to Unicode Storage
-    _unicodeStorage.Remap(rowMap, newRowWidth);
+void TextBuffer::TriggerRedrawAll()
+{
+    if (_isActiveBuffer)
+    {
+        _renderer.TriggerRedrawAll();
+    }
+}
+
+void TextBuffer::TriggerScroll()
+{
+    if (_isActiveBuffer)
+    {
+        _renderer.TriggerScroll();
+    }
+}
+
+void TextBuffer::TriggerScroll(const til::point delta)
+{
+    if (_isActiveBuffer)
+    {
+        _renderer.TriggerScroll(&delta);
+    }
+}
+
+void TextBuffer::TriggerNewTextNotification(const std::wstring_view newText)
+{
+    if (_isActiveBuffer)
+    {
+        _renderer.TriggerNewTextNotification(newText);
+    }
 }
 
 // Routine Description:
@@ -1077,27 +1749,120 @@ ROW& TextBuffer::_GetFirstRow() noexcept
 // - will throw exception if called with the first row of the text buffer
 ROW& TextBuffer::_GetPrevRowNoWrap(const ROW& Row)
 {
-    auto prevRowIndex = Row.GetId() - 1;
+    // A row's index within _storage follows from its address.
+    const auto rowIndex = gsl::narrow_cast<til::CoordType>(&Row - _storage.data());
+    THROW_HR_IF(E_FAIL, rowIndex < 0 || rowIndex >= TotalRowCount());
+
+    auto prevRowIndex = rowIndex - 1;
     if (prevRowIndex < 0)
     {
         prevRowIndex = TotalRowCount() - 1;
     }
 
-    THROW_HR_IF(E_FAIL, Row.GetId() == _firstRow);
+    THROW_HR_IF(E_FAIL, rowIndex == _firstRow);
     return _storage.at(prevRowIndex);
 }
 
+// Method Description:
+// - get the delimiter classes of all cells of a row
+// - The classes of a row are computed once and kept until the row changes, or
+//   until we're called with different word delimiters. The delimiters are
+//   turned into a bitmap beforehand, so that classifying a cell doesn't need
+//   to search the delimiter string.
+// Arguments:
+// - row: the offset of the row
+// - wordDelimiters: the delimiters defined as a part of the DelimiterClass::DelimiterChar
+// Return Value:
+// - the delimiter class of each column of the row
+TextBuffer::RowDelimiterClasses TextBuffer::_GetRowDelimiterClasses(const til::CoordType row, const std::wstring_view wordDelimiters) const
+{
+    const auto& rowData = GetRowByOffset(row);
+
+    // Readers may hold the console lock concurrently,
+    // but only one of them may fill the cache at a time.
+    const std::lock_guard guard{ _delimiterClassCacheLock };
+
+    if (!_delimiterClassCache || _delimiterClassCache->wordDelimiters != wordDelimiters)
+    {
+        auto cache = std::make_unique<DelimiterClassCache>();
+        cache->wordDelimiters = wordDelimiters;
+        for (const auto wch : wordDelimiters)
+        {
+            cache->isDelimiter.set(wch);
+        }
+        _delimiterClassCache = std::move(cache);
+    }
+
+    auto& cache = *_delimiterClassCache;
+    const auto height = gsl::narrow_cast<size_t>(TotalRowCount());
+    if (cache.rows.size() != height)
+    {
+        cache.rows.clear();
+        cache.rows.resize(height);
+    }
+
+    auto& entry = til::at(cache.rows, gsl::narrow_cast<size_t>(row));
+    if (!entry.classes || HasChangedSince(entry.revision, row, row))
+    {
+        const auto& charRow = rowData.GetCharRow();
+        const auto width = rowData.size();
+
+        auto classes = std::make_shared<std::vector<DelimiterClass>>();
+        classes->reserve(gsl::narrow_cast<size_t>(width));
+        for (til::CoordType x = 0; x < width; ++x)
+        {
+            const auto glyph = *charRow.GlyphAt(x).begin();
+            if (glyph <= UNICODE_SPACE)
+            {
+                classes->emplace_back(DelimiterClass::ControlChar);
+            }
+            else if (cache.isDelimiter.test(glyph))
+            {
+                classes->emplace_back(DelimiterClass::DelimiterChar);
+            }
+            else
+            {
+                classes->emplace_back(DelimiterClass::RegularChar);
+            }
+        }
+
+        entry.classes = std::move(classes);
+        entry.revision = GetRevision();
+    }
+
+    return entry.classes;
+}
+
 // Method Description:
 // - get delimiter class for buffer cell position
 // - used for double click selection and uia word navigation
 // Arguments:
 // - pos: the buffer cell under observation
 // - wordDelimiters: the delimiters defined as a part of the DelimiterClass::DelimiterChar
+// - lookup: the row that was looked up last. Successive calls for the same row
+//   don't need to go through _GetRowDelimiterClasses again.
 // Return Value:
 // - the delimiter class for the given char
-DelimiterClass TextBuffer::_GetDelimiterClassAt(const til::point pos, const std::wstring_view wordDelimiters) const
+DelimiterClass TextBuffer::_GetDelimiterClassAt(const til::point pos, const std::wstring_view wordDelimiters, DelimiterClassLookup& lookup) const
+{
+    if (!lookup.classes || lookup.row != pos.Y)
+    {
+        lookup.classes = _GetRowDelimiterClasses(pos.Y, wordDelimiters);
+        lookup.row = pos.Y;
+    }
+    return lookup.classes->at(gsl::narrow_cast<size_t>(pos.X));
+}
+
+// Method Description:
+// - get the double byte attribute of a buffer cell. Unlike GetCellDataAt(), this
+//   doesn't construct an iterator and is meant for the glyph navigation helpers.
+// Arguments:
+// - pos: the buffer cell under observation
+// Return Value:
+// - the double byte attribute of the cell
+const DbcsAttribute& TextBuffer::_GetDbcsAttrAt(const til::point pos) const
 {
-    return GetRowByOffset(pos.Y).GetCharRow().DelimiterClassAt(pos.X, wordDelimiters);
+    return GetRowByOffset(pos.Y).GetCharRow().DbcsAttrAt(pos.X);
 }
 
 // Method Description:
@@ -1166,9 +1931,10 @@ til::point TextBuffer::_GetWordStartForAccessibility(const til::point target, co
     auto result = target;
     const auto bufferSize = GetSize();
     auto stayAtOrigin = false;
+    DelimiterClassLookup lookup;
 
     // ignore left boundary. Continue until readable text found
-    while (_GetDelimiterClassAt(result, wordDelimiters) != DelimiterClass::RegularChar)
+    while (_GetDelimiterClassAt(result, wordDelimiters, lookup) != DelimiterClass::RegularChar)
     {
         if (!bufferSize.DecrementInBounds(result))
         {
@@ -1180,7 +1946,7 @@ til::point TextBuffer::_GetWordStartForAccessibility(const til::point target, co
     }
 
     // make sure we expand to the left boundary or the beginning of the word
-    while (_GetDelimiterClassAt(result, wordDelimiters) == DelimiterClass::RegularChar)
+    while (_GetDelimiterClassAt(result, wordDelimiters, lookup) == DelimiterClass::RegularChar)
     {
         if (!bufferSize.DecrementInBounds(result))
         {
@@ -1191,7 +1957,7 @@ til::point TextBuffer::_GetWordStartForAccessibility(const til::point target, co
     }
 
     // move off of delimiter and onto word start
-    if (!stayAtOrigin && _GetDelimiterClassAt(result, wordDelimiters) != DelimiterClass::RegularChar)
+    if (!stayAtOrigin && _GetDelimiterClassAt(result, wordDelimiters, lookup) != DelimiterClass::RegularChar)
     {
         bufferSize.IncrementInBounds(result);
     }
@@ -1208,24 +1974,18 @@ til::point TextBuffer::_GetWordStartForAccessibility(const til::point target, co
 // - The til::point for the first character on the current word or delimiter run (stopped by the left margin)
 til::point TextBuffer::_GetWordStartForSelection(const til::point target, const std::wstring_view wordDelimiters) const
 {
-    auto result = target;
-    const auto bufferSize = GetSize();
-
-    const auto initialDelimiter = _GetDelimiterClassAt(result, wordDelimiters);
+    const auto classes = _GetRowDelimiterClasses(target.Y, wordDelimiters);
+    const auto rowBegin = classes->begin() + GetSize().Left();
+    const auto it = classes->begin() + target.X;
+    const auto initialDelimiter = classes->at(gsl::narrow_cast<size_t>(target.X));
 
     // expand left until we hit the left boundary or a different delimiter class
-    while (result.X > bufferSize.Left() && (_GetDelimiterClassAt(result, wordDelimiters) == initialDelimiter))
-    {
-        bufferSize.DecrementInBounds(result);
-    }
-
-    if (_GetDelimiterClassAt(result, wordDelimiters) != initialDelimiter)
-    {
-        // move off of delimiter
-        bufferSize.IncrementInBounds(result);
-    }
+    const auto other = std::find_if(std::make_reverse_iterator(it), std::make_reverse_iterator(rowBegin), [=](const auto delimiterClass) {
+        return delimiterClass != initialDelimiter;
+    });
 
-    return result;
+    // other.base() is the cell after the one of a different class (or the left boundary)
+    return { gsl::narrow_cast<til::CoordType>(other.base() - classes->begin()), target.Y };
 }
 
 // Method Description:
@@ -1293,25 +2053,24 @@ til::point TextBuffer::_GetWordEndForAccessibility(const til::point target, cons
     }
     else
     {
-        auto iter{ GetCellDataAt(result, bufferSize) };
-        while (iter && iter.Pos() != limit && _GetDelimiterClassAt(iter.Pos(), wordDelimiters) == DelimiterClass::RegularChar)
+        DelimiterClassLookup lookup;
+        auto pastEnd = false;
+        while (!pastEnd && result != limit && _GetDelimiterClassAt(result, wordDelimiters, lookup) == DelimiterClass::RegularChar)
         {
             // Iterate through readable text
-            ++iter;
+            pastEnd = !bufferSize.IncrementInBounds(result);
         }
 
-        while (iter && iter.Pos() != limit && _GetDelimiterClassAt(iter.Pos(), wordDelimiters) != DelimiterClass::RegularChar)
+        while (!pastEnd && result != limit && _GetDelimiterClassAt(result, wordDelimiters, lookup) != DelimiterClass::RegularChar)
         {
             // expand to the beginning of the NEXT word
-            ++iter;
+            pastEnd = !bufferSize.IncrementInBounds(result);
         }
 
-        result = iter.Pos();
-
         // Special case: we tried to move one past the end of the buffer,
-        // but iter prevented that (because that pos doesn't exist).
+        // but that pos doesn't exist and we stayed on the last cell.
         // Manually increment onto the EndExclusive point.
-        if (!iter)
+        if (pastEnd)
         {
             bufferSize.IncrementInBounds(result, true);
         }
@@ -1337,66 +2096,40 @@ til::point TextBuffer::_GetWordEndForSelection(const til::point target, const st
         return target;
     }
 
-    auto result = target;
-    const auto initialDelimiter = _GetDelimiterClassAt(result, wordDelimiters);
+    const auto classes = _GetRowDelimiterClasses(target.Y, wordDelimiters);
+    const auto rowEnd = classes->begin() + bufferSize.RightExclusive();
+    const auto it = classes->begin() + target.X;
+    const auto initialDelimiter = classes->at(gsl::narrow_cast<size_t>(target.X));
 
     // expand right until we hit the right boundary or a different delimiter class
-    while (result.X < bufferSize.RightInclusive() && (_GetDelimiterClassAt(result, wordDelimiters) == initialDelimiter))
-    {
-        bufferSize.IncrementInBounds(result);
-    }
-
-    if (_GetDelimiterClassAt(result, wordDelimiters) != initialDelimiter)
-    {
-        // move off of delimiter
-        bufferSize.DecrementInBounds(result);
-    }
+    const auto other = std::find_if(it, rowEnd, [=](const auto delimiterClass) {
+        return delimiterClass != initialDelimiter;
+    });
 
-    return result;
+    // move off of delimiter (or the right boundary) onto the last cell of the word
+    return { gsl::narrow_cast<til::CoordType>(other - classes->begin()) - 1, target.Y };
 }
 
-void TextBuffer::_PruneHyperlinks()
+// Routine Description:
+// - Removes the hyperlinks of a row that was just erased from our maps, unless
+//   they're still referenced by another row or by the current attributes.
+// - The rows keep a reference count of each hyperlink ID in the attribute table,
+//   so this doesn't need to search the rest of the buffer for other references.
+// Arguments:
+// - candidates - the hyperlink IDs the erased row referred to
+void TextBuffer::_PruneHyperlinks(const std::vector<uint16_t>& candidates)
 {
-    // Check the old first row for hyperlink references
-    // If there are any, search the entire buffer for the same reference
-    // If the buffer does not contain the same reference, we can remove that hyperlink from our map
-    // This way, obsolete hyperlink references are cleared from our hyperlink map instead of hanging around
-    // Get all the hyperlink references in the row we're erasing
-    const auto hyperlinks = _storage.at(_firstRow).GetAttrRow().GetHyperlinks();
-
-    if (!hyperlinks.empty())
+    for (const auto id : candidates)
     {
-        // Move to unordered set so we can use hashed lookup of IDs instead of linear search.
-        // Only make it an unordered set now because set always heap allocates but vector
-        // doesn't when the set is empty (saving an allocation in the common case of no links.)
-        std::unordered_set<uint16_t> firstRowRefs{ hyperlinks.cbegin(), hyperlinks.cend() };
-
-        const auto total = TotalRowCount();
-        // Loop through all the rows in the buffer except the first row -
-        // we have found all hyperlink references in the first row and put them in refs,
-        // now we need to search the rest of the buffer (i.e. all the rows except the first)
-        // to see if those references are anywhere else
-        for (til::CoordType i = 1; i < total; ++i)
+        if (_attributeTable->GetHyperlinkReferences(id) != 0 || (_currentAttributes.IsHyperlink() && _currentAttributes.GetHyperlinkId() == id))
         {
-            const auto nextRowRefs = GetRowByOffset(i).GetAttrRow().GetHyperlinks();
-            for (auto id : nextRowRefs)
-            {
-                if (firstRowRefs.find(id) != firstRowRefs.end())
-                {
-                    firstRowRefs.erase(id);
-                }
-            }
-            if (firstRowRefs.empty())
-            {
-                // No more hyperlink references left to search for, terminate early
-                break;
-            }
+            continue;
         }
-
-        // Now delete obsolete references from our map
-        for (auto hyperlinkReference : firstRowRefs)
+        // A row may refer to the same hyperlink more than once.
+        if (_hyperlinkMap.contains(id))
         {
-            RemoveHyperlinkFromMap(hyperlinkReference);
+            RemoveHyperlinkFromMap(id);
+            _recycledHyperlinkIds.push_back(id);
         }
     }
 }
@@ -1472,7 +2205,7 @@ til::point TextBuffer::GetGlyphStart(const til::point pos, std::optional<til::po
     }
 
     // limit is exclusive, so we need to move back to be within valid bounds
-    if (resultPos != limit && GetCellDataAt(resultPos)->DbcsAttr().IsTrailing())
+    if (resultPos != limit && _GetDbcsAttrAt(resultPos).IsTrailing())
     {
         bufferSize.DecrementInBounds(resultPos, true);
     }
@@ -1499,7 +2232,7 @@ til::point TextBuffer::GetGlyphEnd(const til::point pos, bool accessibilityMode,
         resultPos = limit;
     }
 
-    if (resultPos != limit && GetCellDataAt(resultPos)->DbcsAttr().IsLeading())
+    if (resultPos != limit && _GetDbcsAttrAt(resultPos).IsLeading())
     {
         bufferSize.IncrementInBounds(resultPos, true);
     }
@@ -1579,7 +2312,7 @@ bool TextBuffer::MoveToPreviousGlyph(til::point& pos, std::optional<til::point>
 
     // try to move. If we can't, we're done.
     const auto success = bufferSize.DecrementInBounds(resultPos, true);
-    if (resultPos != bufferSize.EndExclusive() && GetCellDataAt(resultPos)->DbcsAttr().IsLeading())
+    if (resultPos != bufferSize.EndExclusive() && _GetDbcsAttrAt(resultPos).IsLeading())
     {
         bufferSize.DecrementInBounds(resultPos, true);
     }
@@ -1823,186 +2556,343 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
 }
 
 // Routine Description:
-// - Generates a CF_HTML compliant structure based on the passed in text and color data
+// - Converts the text and per-character colors returned by GetText
+//   into runs of identical colors. See TextAndColorRuns.
 // Arguments:
-// - rows - the text and color data we will format & encapsulate
-// - backgroundColor - default background color for characters, also used in padding
-// - fontHeightPoints - the unscaled font height
-// - fontFaceName - the name of the font used
+// - rows - the text and color data returned by GetText
 // Return Value:
-// - string containing the generated HTML
-std::string TextBuffer::GenHTML(const TextAndColor& rows,
-                                const int fontHeightPoints,
-                                const std::wstring_view fontFaceName,
-                                const COLORREF backgroundColor)
+// - The same text and colors, as runs.
+TextBuffer::TextAndColorRuns TextBuffer::TextAndColorRuns::FromTextAndColor(const TextAndColor& rows)
 {
-    try
-    {
-        std::ostringstream htmlBuilder;
-
-        // First we have to add some standard
-        // HTML boiler plate required for CF_HTML
-        // as part of the HTML Clipboard format
-        const std::string htmlHeader =
-            "<!DOCTYPE><HTML><HEAD></HEAD><BODY>";
-        htmlBuilder << htmlHeader;
+    TextAndColorRuns result;
+    result.rowEnds.reserve(rows.text.size());
 
-        htmlBuilder << "<!--StartFragment -->";
+    for (size_t row = 0; row < rows.text.size(); ++row)
+    {
+        const std::wstring_view text{ rows.text.at(row) };
+        const auto& fgAttr = rows.FgAttr.at(row);
+        const auto& bkAttr = rows.BkAttr.at(row);
+        const auto rowBegin = result.text.size();
 
-        // apply global style in div element
+        for (size_t col = 0; col < text.size(); ++col)
         {
-            htmlBuilder << "<DIV STYLE=\"";
-            htmlBuilder << "display:inline-block;";
-            htmlBuilder << "white-space:pre;";
+            result.Append(text.substr(col, 1), fgAttr.at(col), bkAttr.at(col), rowBegin);
+        }
+
+        result.rowEnds.emplace_back(result.text.size());
+    }
 
-            htmlBuilder << "background-color:";
-            htmlBuilder << Utils::ColorToHexString(backgroundColor);
-            htmlBuilder << ";";
+    return result;
+}
 
-            htmlBuilder << "font-family:";
-            htmlBuilder << "'";
-            htmlBuilder << ConvertToA(CP_UTF8, fontFaceName);
-            htmlBuilder << "',";
-            // even with different font, add monospace as fallback
-            htmlBuilder << "monospace;";
+// Routine Description:
+// - Appends text in the given colors to the current row. It extends the last
+//   run if it has the same colors, unless that run belongs to a previous row.
+// Arguments:
+// - chars - the text to append
+// - fg - the foreground color of the text
+// - bg - the background color of the text
+// - rowBegin - the offset into text at which the current row begins
+void TextBuffer::TextAndColorRuns::Append(const std::wstring_view chars, const COLORREF fg, const COLORREF bg, const size_t rowBegin)
+{
+    if (chars.empty())
+    {
+        return;
+    }
 
-            htmlBuilder << "font-size:";
-            htmlBuilder << fontHeightPoints;
-            htmlBuilder << "pt;";
+    if (text.size() > rowBegin && runs.back().fg == fg && runs.back().bg == bg)
+    {
+        runs.back().length += chars.size();
+    }
+    else
+    {
+        runs.push_back({ chars.size(), fg, bg });
+    }
+    text.append(chars);
+}
 
-            // note: MS Word doesn't support padding (in this way at least)
-            htmlBuilder << "padding:";
-            htmlBuilder << 4; // todo: customizable padding
-            htmlBuilder << "px;";
+// Routine Description:
+// - Retrieves the text and colors of the selected region, like GetText does.
+// - Instead of visiting each cell, this copies the glyphs of each ATTR_ROW run in
+//   one go and only maps its attribute to colors once. Runs of identical colors
+//   are stored as such instead of storing the colors of each character.
+// Arguments:
+// - includeCRLF - inject CRLF pairs to the end of each line
+// - trimTrailingWhitespace - remove the trailing whitespace at the end of each line
+// - textRects - the rectangular regions from which the data will be extracted from the buffer (i.e.: selection rects)
+// - GetAttributeColors - function used to map TextAttribute to RGB COLORREFs
+// - formatWrappedRows - if set we will apply formatting (CRLF inclusion and whitespace trimming) on wrapped rows
+// Return Value:
+// - The text and colors of the selected region of the text buffer.
+TextBuffer::TextAndColorRuns TextBuffer::GetTextAndColorRuns(const bool includeCRLF,
+                                                             const bool trimTrailingWhitespace,
+                                                             const std::vector<til::inclusive_rect>& selectionRects,
+                                                             const std::function<std::pair<COLORREF, COLORREF>(const TextAttribute&)>& GetAttributeColors,
+                                                             const bool formatWrappedRows) const
+{
+    TextAndColorRuns data;
+    data.rowEnds.reserve(selectionRects.size());
 
-            htmlBuilder << "\">";
-        }
+    std::wstring glyphs;
+    for (size_t i = 0; i < selectionRects.size(); i++)
+    {
+        const auto& rect = til::at(selectionRects, i);
+        const auto& row = GetRowByOffset(rect.Top);
+        const auto& charRow = row.GetCharRow();
+        const auto& attrRow = row.GetAttrRow();
+        const auto left = std::max(rect.Left, 0);
+        const auto right = std::min(rect.Right + 1, row.size());
+        const auto rowBegin = data.text.size();
 
-        // copy text and info color from buffer
-        auto hasWrittenAnyText = false;
-        std::optional<COLORREF> fgColor = std::nullopt;
-        std::optional<COLORREF> bkColor = std::nullopt;
-        for (size_t row = 0; row < rows.text.size(); row++)
+        til::CoordType runBegin = 0;
+        for (const auto& run : attrRow.GetRuns())
         {
-            size_t startOffset = 0;
+            const auto runEnd = runBegin + gsl::narrow_cast<til::CoordType>(run.length);
+            const auto begin = std::max(runBegin, left);
+            const auto end = std::min(runEnd, right);
+            runBegin = runEnd;
 
-            if (row != 0)
+            if (begin >= end)
             {
-                htmlBuilder << "<BR>";
+                if (runEnd >= right)
+                {
+                    break;
+                }
+                continue;
             }
 
-            for (size_t col = 0; col < rows.text.at(row).length(); col++)
+            // copy char data into the string buffer, skipping trailing bytes
+            glyphs.clear();
+            for (auto x = begin; x < end; ++x)
             {
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col >= startOffset)
+                if (!charRow.DbcsAttrAt(x).IsTrailing())
+                {
+                    for (const auto wch : charRow.GlyphAt(x))
                     {
-                        const auto unescapedText = ConvertToA(CP_UTF8, std::wstring_view(rows.text.at(row)).substr(startOffset, col - startOffset + includeCurrent));
-                        for (const auto c : unescapedText)
-                        {
-                            switch (c)
-                            {
-                            case '<':
-                                htmlBuilder << "&lt;";
-                                break;
-                            case '>':
-                                htmlBuilder << "&gt;";
-                                break;
-                            case '&':
-                                htmlBuilder << "&amp;";
-                                break;
-                            default:
-                                htmlBuilder << c;
-                            }
-                        }
-
-                        startOffset = col;
+                        glyphs.push_back(wch);
                     }
-                };
-
-                if (rows.text.at(row).at(col) == '\r' || rows.text.at(row).at(col) == '\n')
-                {
-                    // do not include \r nor \n as they don't have color attributes
-                    // and are not HTML friendly. For line break use '<BR>' instead.
-                    writeAccumulatedChars(false);
-                    break;
                 }
+            }
 
-                auto colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr.at(row).at(col) != fgColor.value())
+            if (!glyphs.empty())
+            {
+                const auto [fg, bg] = GetAttributeColors(attrRow.GetAttrById(run.value));
+                data.Append(glyphs, fg, bg, rowBegin);
+            }
+        }
+
+        // We apply formatting to rows if the row was NOT wrapped or formatting of wrapped rows is allowed
+        const auto shouldFormatRow = formatWrappedRows || !row.WasWrapForced();
+
+        if (trimTrailingWhitespace && shouldFormatRow)
+        {
+            // remove the spaces at the end (aka trim the trailing whitespace)
+            while (data.text.size() > rowBegin && data.text.back() == UNICODE_SPACE)
+            {
+                data.text.pop_back();
+                if (--data.runs.back().length == 0)
                 {
-                    fgColor = rows.FgAttr.at(row).at(col);
-                    colorChanged = true;
+                    data.runs.pop_back();
                 }
+            }
+        }
+
+        // apply CR/LF to the end of the final string, unless we're the last line.
+        // a.k.a if we're earlier than the bottom, then apply CR/LF.
+        if (includeCRLF && i < selectionRects.size() - 1 && shouldFormatRow)
+        {
+            // can't see CR/LF so just use black FG & BK
+            static constexpr wchar_t crlf[]{ UNICODE_CARRIAGERETURN, UNICODE_LINEFEED };
+            const auto Blackness = RGB(0x00, 0x00, 0x00);
+            data.Append({ &crlf[0], std::size(crlf) }, Blackness, Blackness, rowBegin);
+        }
+
+        data.rowEnds.emplace_back(data.text.size());
+    }
+
+    return data;
+}
+
+// Routine Description:
+// - Calls onRow for each row and onRun for each run of identical colors in the row.
+//   The text passed to onRun stops at the CR/LF of the row, as it doesn't have
+//   any color attributes and both HTML and RTF have their own line breaks.
+// Arguments:
+// - rows - the text and color data to enumerate
+// - onRow - called as onRow(row) at the beginning of each row
+// - onRun - called as onRun(text, run) for each non-empty run
+template<typename RowFunc, typename RunFunc>
+void TextBuffer::_ForEachRunOfRows(const TextAndColorRuns& rows, RowFunc&& onRow, RunFunc&& onRun)
+{
+    const std::wstring_view text{ rows.text };
+    auto run = rows.runs.begin();
+    size_t offset = 0;
+
+    for (size_t row = 0; row < rows.rowEnds.size(); ++row)
+    {
+        onRow(row);
+
+        auto lineBreak = false;
+        const auto rowEnd = til::at(rows.rowEnds, row);
+        for (; offset < rowEnd && run != rows.runs.end(); offset += run->length, ++run)
+        {
+            if (lineBreak)
+            {
+                continue;
+            }
+
+            auto runText = text.substr(offset, run->length);
+            if (const auto pos = runText.find_first_of(L"\r\n"); pos != std::wstring_view::npos)
+            {
+                runText = runText.substr(0, pos);
+                lineBreak = true;
+            }
+
+            if (!runText.empty())
+            {
+                onRun(runText, *run);
+            }
+        }
+    }
+}
+
+// Routine Description:
+// - Generates a CF_HTML compliant structure based on the passed in text and color data
+// Arguments:
+// - rows - the text and color data we will format & encapsulate
+// - backgroundColor - default background color for characters, also used in padding
+// - fontHeightPoints - the unscaled font height
+// - fontFaceName - the name of the font used
+// Return Value:
+// - string containing the generated HTML
+std::string TextBuffer::GenHTML(const TextAndColor& rows,
+                                const int fontHeightPoints,
+                                const std::wstring_view fontFaceName,
+                                const COLORREF backgroundColor)
+{
+    try
+    {
+        return GenHTML(TextAndColorRuns::FromTextAndColor(rows), fontHeightPoints, fontFaceName, backgroundColor);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return {};
+    }
+}
+
+// Routine Description:
+// - Generates a CF_HTML compliant structure based on the passed in text and color runs.
+//   The HTML is written run by run into a single string, which also holds the
+//   clipboard header, so that it never needs to be copied around.
+// Arguments:
+// - rows - the text and color data we will format & encapsulate
+// - backgroundColor - default background color for characters, also used in padding
+// - fontHeightPoints - the unscaled font height
+// - fontFaceName - the name of the font used
+// Return Value:
+// - string containing the generated HTML
+std::string TextBuffer::GenHTML(const TextAndColorRuns& rows,
+                                const int fontHeightPoints,
+                                const std::wstring_view fontFaceName,
+                                const COLORREF backgroundColor)
+{
+    try
+    {
+        // once filled with values, there will be exactly 157 bytes in the clipboard header
+        constexpr size_t ClipboardHeaderSize = 157;
+
+        // First we have to add some standard
+        // HTML boiler plate required for CF_HTML
+        // as part of the HTML Clipboard format
+        constexpr std::string_view HtmlHeader = "<!DOCTYPE><HTML><HEAD></HEAD><BODY>";
+        constexpr std::string_view HtmlFooter = "</BODY></HTML>";
+
+        // The clipboard header holds the offsets of the parts of the HTML, which we only
+        // know once we're done. Leave space for it now and fill it in at the end.
+        std::string html(ClipboardHeaderSize, ' ');
+        html.reserve(ClipboardHeaderSize + rows.text.size() + rows.runs.size() * 64 + 512);
+        html.append(HtmlHeader);
+        html.append("<!--StartFragment -->");
+
+        // apply global style in div element
+        // - even with different font, add monospace as fallback
+        // - note: MS Word doesn't support padding (in this way at least)
+        fmt::format_to(std::back_inserter(html),
+                       FMT_COMPILE("<DIV STYLE=\"display:inline-block;white-space:pre;background-color:{};font-family:'{}',monospace;font-size:{}pt;padding:{}px;\">"),
+                       Utils::ColorToHexString(backgroundColor),
+                       ConvertToA(CP_UTF8, fontFaceName),
+                       fontHeightPoints,
+                       4); // todo: customizable padding
 
-                if (!bkColor.has_value() || rows.BkAttr.at(row).at(col) != bkColor.value())
+        // copy text and info color from buffer
+        auto hasWrittenAnyText = false;
+        std::optional<COLORREF> fgColor = std::nullopt;
+        std::optional<COLORREF> bkColor = std::nullopt;
+        _ForEachRunOfRows(
+            rows,
+            [&](const size_t row) {
+                // For line break use '<BR>' instead of CR/LF.
+                if (row != 0)
                 {
-                    bkColor = rows.BkAttr.at(row).at(col);
-                    colorChanged = true;
+                    html.append("<BR>");
                 }
-
-                if (colorChanged)
+            },
+            [&](const std::wstring_view text, const TextAndColorRuns::Run& run) {
+                if (fgColor != run.fg || bkColor != run.bg)
                 {
-                    writeAccumulatedChars(false);
+                    fgColor = run.fg;
+                    bkColor = run.bg;
 
                     if (hasWrittenAnyText)
                     {
-                        htmlBuilder << "</SPAN>";
+                        html.append("</SPAN>");
                     }
 
-                    htmlBuilder << "<SPAN STYLE=\"";
-                    htmlBuilder << "color:";
-                    htmlBuilder << Utils::ColorToHexString(fgColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "background-color:";
-                    htmlBuilder << Utils::ColorToHexString(bkColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "\">";
+                    fmt::format_to(std::back_inserter(html),
+                                   FMT_COMPILE("<SPAN STYLE=\"color:{};background-color:{};\">"),
+                                   Utils::ColorToHexString(run.fg),
+                                   Utils::ColorToHexString(run.bg));
                 }
 
                 hasWrittenAnyText = true;
-
-                // if this is the last character in the row, flush the whole row
-                if (col == rows.text.at(row).length() - 1)
-                {
-                    writeAccumulatedChars(true);
-                }
-            }
-        }
+                _AppendHTMLText(html, text);
+            });
 
         if (hasWrittenAnyText)
         {
             // last opened span wasn't closed in loop above, so close it now
-            htmlBuilder << "</SPAN>";
+            html.append("</SPAN>");
         }
 
-        htmlBuilder << "</DIV>";
-
-        htmlBuilder << "<!--EndFragment -->";
-
-        constexpr std::string_view HtmlFooter = "</BODY></HTML>";
-        htmlBuilder << HtmlFooter;
-
-        // once filled with values, there will be exactly 157 bytes in the clipboard header
-        constexpr size_t ClipboardHeaderSize = 157;
+        html.append("</DIV>");
+        html.append("<!--EndFragment -->");
+        html.append(HtmlFooter);
 
         // these values are byte offsets from start of clipboard
         const auto htmlStartPos = ClipboardHeaderSize;
-        const auto htmlEndPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlBuilder.tellp());
-        const auto fragStartPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlHeader.length());
-        const auto fragEndPos = htmlEndPos - HtmlFooter.length();
+        const auto htmlEndPos = html.size();
+        const auto fragStartPos = ClipboardHeaderSize + HtmlHeader.size();
+        const auto fragEndPos = htmlEndPos - HtmlFooter.size();
 
         // header required by HTML 0.9 format
-        std::ostringstream clipHeaderBuilder;
-        clipHeaderBuilder << "Version:0.9\r\n";
-        clipHeaderBuilder << std::setfill('0');
-        clipHeaderBuilder << "StartHTML:" << std::setw(10) << htmlStartPos << "\r\n";
-        clipHeaderBuilder << "EndHTML:" << std::setw(10) << htmlEndPos << "\r\n";
-        clipHeaderBuilder << "StartFragment:" << std::setw(10) << fragStartPos << "\r\n";
-        clipHeaderBuilder << "EndFragment:" << std::setw(10) << fragEndPos << "\r\n";
-        clipHeaderBuilder << "StartSelection:" << std::setw(10) << fragStartPos << "\r\n";
-        clipHeaderBuilder << "EndSelection:" << std::setw(10) << fragEndPos << "\r\n";
-
-        return clipHeaderBuilder.str() + htmlBuilder.str();
+        const auto clipHeader = fmt::format(FMT_COMPILE("Version:0.9\r\n"
+                                                        "StartHTML:{:010}\r\n"
+                                                        "EndHTML:{:010}\r\n"
+                                                        "StartFragment:{:010}\r\n"
+                                                        "EndFragment:{:010}\r\n"
+                                                        "StartSelection:{:010}\r\n"
+                                                        "EndSelection:{:010}\r\n"),
+                                            htmlStartPos,
+                                            htmlEndPos,
+                                            fragStartPos,
+                                            fragEndPos,
+                                            fragStartPos,
+                                            fragEndPos);
+        THROW_HR_IF(E_UNEXPECTED, clipHeader.size() != ClipboardHeaderSize);
+        html.replace(0, ClipboardHeaderSize, clipHeader);
+
+        return html;
     }
     catch (...)
     {
@@ -2019,29 +2909,35 @@ std::string TextBuffer::GenHTML(const TextAndColor& rows,
 // - backgroundColor - default background color for characters, also used in padding
 // - fontHeightPoints - the unscaled font height
 // - fontFaceName - the name of the font used
-// - htmlTitle - value used in title tag of html header. Used to name the application
 // Return Value:
 // - string containing the generated RTF
 std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoints, const std::wstring_view fontFaceName, const COLORREF backgroundColor)
 {
     try
     {
-        std::ostringstream rtfBuilder;
-
-        // start rtf
-        rtfBuilder << "{";
-
-        // Standard RTF header.
-        // This is similar to the header generated by WordPad.
-        // \ansi - specifies that the ANSI char set is used in the current doc
-        // \ansicpg1252 - represents the ANSI code page which is used to perform the Unicode to ANSI conversion when writing RTF text
-        // \deff0 - specifies that the default font for the document is the one at index 0 in the font table
-        // \nouicompat - ?
-        rtfBuilder << "\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat";
-
-        // font table
-        rtfBuilder << "{\\fonttbl{\\f0\\fmodern\\fcharset0 " << ConvertToA(CP_UTF8, fontFaceName) << ";}}";
+        return GenRTF(TextAndColorRuns::FromTextAndColor(rows), fontHeightPoints, fontFaceName, backgroundColor);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return {};
+    }
+}
 
+// Routine Description:
+// - Generates an RTF document based on the passed in text and color runs.
+//   RTF 1.5 Spec: https://www.biblioscape.com/rtf15_spec.htm
+// Arguments:
+// - rows - the text and color data we will format & encapsulate
+// - backgroundColor - default background color for characters, also used in padding
+// - fontHeightPoints - the unscaled font height
+// - fontFaceName - the name of the font used
+// Return Value:
+// - string containing the generated RTF
+std::string TextBuffer::GenRTF(const TextAndColorRuns& rows, const int fontHeightPoints, const std::wstring_view fontFaceName, const COLORREF backgroundColor)
+{
+    try
+    {
         // map to keep track of colors:
         // keys are colors represented by COLORREF
         // values are indices of the corresponding colors in the color table
@@ -2049,212 +2945,416 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
         auto nextColorIndex = 1; // leave 0 for the default color and start from 1.
 
         // RTF color table
-        std::ostringstream colorTableBuilder;
-        colorTableBuilder << "{\\colortbl ;";
-        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(backgroundColor))
-                          << "\\green" << static_cast<int>(GetGValue(backgroundColor))
-                          << "\\blue" << static_cast<int>(GetBValue(backgroundColor))
-                          << ";";
-        colorMap[backgroundColor] = nextColorIndex++;
+        std::string colorTable{ "{\\colortbl ;" };
+        const auto getColorIndex = [&](const COLORREF color) {
+            const auto [it, inserted] = colorMap.emplace(color, nextColorIndex);
+            if (inserted)
+            {
+                // color not present in the map, so add it
+                fmt::format_to(std::back_inserter(colorTable),
+                               FMT_COMPILE("\\red{}\\green{}\\blue{};"),
+                               GetRValue(color),
+                               GetGValue(color),
+                               GetBValue(color));
+                ++nextColorIndex;
+            }
+            return it->second;
+        };
+        getColorIndex(backgroundColor);
 
         // content
-        std::ostringstream contentBuilder;
-        contentBuilder << "\\viewkind4\\uc4";
+        // The color table precedes the content, but is only complete once the
+        // content is, so the content is written into a string of its own.
+        std::string content;
+        content.reserve(rows.text.size() + rows.runs.size() * 24 + 64);
+        content.append("\\viewkind4\\uc4");
 
         // paragraph styles
         // \fs specifies font size in half-points i.e. \fs20 results in a font size
         // of 10 pts. That's why, font size is multiplied by 2 here.
-        contentBuilder << "\\pard\\slmult1\\f0\\fs" << std::to_string(2 * fontHeightPoints)
-                       << "\\highlight1"
-                       << " ";
+        fmt::format_to(std::back_inserter(content), FMT_COMPILE("\\pard\\slmult1\\f0\\fs{}\\highlight1 "), 2 * fontHeightPoints);
 
         std::optional<COLORREF> fgColor = std::nullopt;
         std::optional<COLORREF> bkColor = std::nullopt;
-        for (size_t row = 0; row < rows.text.size(); ++row)
+        _ForEachRunOfRows(
+            rows,
+            [&](const size_t row) {
+                // For line break use \line instead of CR/LF.
+                if (row != 0)
+                {
+                    content.append("\\line "); // new line
+                }
+            },
+            [&](const std::wstring_view text, const TextAndColorRuns::Run& run) {
+                if (fgColor != run.fg || bkColor != run.bg)
+                {
+                    fgColor = run.fg;
+                    bkColor = run.bg;
+
+                    const auto bkColorIndex = getColorIndex(run.bg);
+                    const auto fgColorIndex = getColorIndex(run.fg);
+                    fmt::format_to(std::back_inserter(content), FMT_COMPILE("\\highlight{}\\cf{} "), bkColorIndex, fgColorIndex);
+                }
+
+                _AppendRTFText(content, text);
+            });
+
+        // end colortbl
+        colorTable.push_back('}');
+
+        // Standard RTF header.
+        // This is similar to the header generated by WordPad.
+        // \ansi - specifies that the ANSI char set is used in the current doc
+        // \ansicpg1252 - represents the ANSI code page which is used to perform the Unicode to ANSI conversion when writing RTF text
+        // \deff0 - specifies that the default font for the document is the one at index 0 in the font table
+        // \nouicompat - ?
+        const auto fontTable = fmt::format(FMT_COMPILE("{{\\fonttbl{{\\f0\\fmodern\\fcharset0 {};}}}}"), ConvertToA(CP_UTF8, fontFaceName));
+        constexpr std::string_view rtfHeader = "{\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat";
+
+        std::string rtf;
+        rtf.reserve(rtfHeader.size() + fontTable.size() + colorTable.size() + content.size() + 1);
+        rtf.append(rtfHeader);
+        rtf.append(fontTable);
+        rtf.append(colorTable);
+        rtf.append(content);
+
+        // end rtf
+        rtf.push_back('}');
+        return rtf;
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return {};
+    }
+}
+
+void TextBuffer::_AppendHTMLText(std::string& content, const std::wstring_view text)
+{
+    const auto unescapedText = ConvertToA(CP_UTF8, text);
+    for (const auto c : unescapedText)
+    {
+        switch (c)
         {
-            size_t startOffset = 0;
+        case '<':
+            content.append("&lt;");
+            break;
+        case '>':
+            content.append("&gt;");
+            break;
+        case '&':
+            content.append("&amp;");
+            break;
+        default:
+            content.push_back(c);
+        }
+    }
+}
 
-            if (row != 0)
+void TextBuffer::_AppendRTFText(std::string& content, const std::wstring_view text)
+{
+    for (const auto codeUnit : text)
+    {
+        if (codeUnit <= 127)
+        {
+            switch (codeUnit)
             {
-                contentBuilder << "\\line "; // new line
+            case L'\\':
+            case L'{':
+            case L'}':
+                content.push_back('\\');
+                content.push_back(gsl::narrow<char>(codeUnit));
+                break;
+            default:
+                content.push_back(gsl::narrow<char>(codeUnit));
             }
+        }
+        else
+        {
+            // Windows uses unsigned wchar_t - RTF uses signed ones.
+            fmt::format_to(std::back_inserter(content), FMT_COMPILE("\\u{}?"), til::bit_cast<int16_t>(codeUnit));
+        }
+    }
+}
 
-            for (size_t col = 0; col < rows.text.at(row).length(); ++col)
-            {
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col >= startOffset)
-                    {
-                        const auto text = std::wstring_view{ rows.text.at(row) }.substr(startOffset, col - startOffset + includeCurrent);
-                        _AppendRTFText(contentBuilder, text);
+// Function Description:
+// - Reflow the contents from the old buffer into the new buffer. The new buffer
+//   can have different dimensions than the old buffer. If it does, then this
+//   function will attempt to maintain the logical contents of the old buffer,
+//   by continuing wrapped lines onto the next line in the new buffer.
+// Arguments:
+// - oldBuffer - the text buffer to copy the contents FROM
+// - newBuffer - the text buffer to copy the contents TO
+// - lastCharacterViewport - Optional. If the caller knows that the last
+//   nonspace character is in a particular Viewport, the caller can provide this
+//   parameter as an optimization, as opposed to searching the entire buffer.
+// - positionInfo - Optional. The caller can provide a pair of rows in this
+//   parameter and we'll calculate the position of the _end_ of those rows in
+//   the new buffer. The rows's new value is placed back into this parameter.
+// Return Value:
+// - S_OK if we successfully copied the contents to the new buffer, otherwise an appropriate HRESULT.
+HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
+                           TextBuffer& newBuffer,
+                           const std::optional<Viewport> lastCharacterViewport,
+                           std::optional<std::reference_wrapper<PositionInformation>> positionInfo)
+{
+    const auto& oldCursor = oldBuffer.GetCursor();
+    auto& newCursor = newBuffer.GetCursor();
 
-                        startOffset = col;
-                    }
-                };
+    // We need to save the old cursor position so that we can
+    // place the new cursor back on the equivalent character in
+    // the new buffer.
+    const auto cOldCursorPos = oldCursor.GetPosition();
+    const auto cOldLastChar = oldBuffer.GetLastNonSpaceCharacter(lastCharacterViewport);
 
-                if (rows.text.at(row).at(col) == '\r' || rows.text.at(row).at(col) == '\n')
-                {
-                    // do not include \r nor \n as they don't have color attributes.
-                    // For line break use \line instead.
-                    writeAccumulatedChars(false);
-                    break;
-                }
+    const auto cOldRowsTotal = cOldLastChar.Y + 1;
 
-                auto colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr.at(row).at(col) != fgColor.value())
-                {
-                    fgColor = rows.FgAttr.at(row).at(col);
-                    colorChanged = true;
-                }
+    // Rows whose reflowed contents would just scroll off the top of the new
+    // buffer again don't need to be reflowed at all, as long as that doesn't
+    // change where the cursor and the requested positions are reported.
+    auto cFirstReportedRow = std::min(cOldCursorPos.Y, cOldLastChar.Y);
+    if (positionInfo.has_value())
+    {
+        const auto& oldPositions = positionInfo.value().get();
+        cFirstReportedRow = std::min({ cFirstReportedRow, oldPositions.mutableViewportTop, oldPositions.visibleViewportTop });
+    }
+    const auto cOldFirstRow = _GetReflowFirstRetainedRow(oldBuffer, cOldLastChar.Y, cFirstReportedRow, newBuffer.GetSize().Dimensions());
 
-                if (!bkColor.has_value() || rows.BkAttr.at(row).at(col) != bkColor.value())
-                {
-                    bkColor = rows.BkAttr.at(row).at(col);
-                    colorChanged = true;
-                }
+    ReflowParameters parameters{ cOldRowsTotal - 1, cOldCursorPos };
+    if (positionInfo.has_value())
+    {
+        parameters.oldPositions = positionInfo.value().get();
+    }
 
-                if (colorChanged)
-                {
-                    writeAccumulatedChars(false);
+    // Long buffers are split up into chunks of whole logical lines, which are
+    // reflowed concurrently. Whatever is left over is reflowed right here.
+    ReflowProgress progress;
+    til::CoordType nextRow = cOldFirstRow;
+    auto hr = _ReflowRowsInParallel(oldBuffer, newBuffer, cOldFirstRow, cOldRowsTotal, parameters, progress, nextRow);
+    if (SUCCEEDED(hr))
+    {
+        hr = _ReflowRows(oldBuffer, newBuffer, nextRow, cOldRowsTotal, parameters, progress);
+    }
 
-                    auto bkColorIndex = 0;
-                    if (colorMap.find(bkColor.value()) != colorMap.end())
-                    {
-                        // color already exists in the map, just retrieve the index
-                        bkColorIndex = colorMap[bkColor.value()];
-                    }
-                    else
-                    {
-                        // color not present in the map, so add it
-                        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(bkColor.value()))
-                                          << "\\green" << static_cast<int>(GetGValue(bkColor.value()))
-                                          << "\\blue" << static_cast<int>(GetBValue(bkColor.value()))
-                                          << ";";
-                        colorMap[bkColor.value()] = nextColorIndex;
-                        bkColorIndex = nextColorIndex++;
-                    }
+    if (positionInfo.has_value())
+    {
+        if (progress.mutableViewportTop)
+        {
+            positionInfo.value().get().mutableViewportTop = *progress.mutableViewportTop;
+        }
+        if (progress.visibleViewportTop)
+        {
+            positionInfo.value().get().visibleViewportTop = *progress.visibleViewportTop;
+        }
+    }
 
-                    auto fgColorIndex = 0;
-                    if (colorMap.find(fgColor.value()) != colorMap.end())
-                    {
-                        // color already exists in the map, just retrieve the index
-                        fgColorIndex = colorMap[fgColor.value()];
-                    }
-                    else
-                    {
-                        // color not present in the map, so add it
-                        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(fgColor.value()))
-                                          << "\\green" << static_cast<int>(GetGValue(fgColor.value()))
-                                          << "\\blue" << static_cast<int>(GetBValue(fgColor.value()))
-                                          << ";";
-                        colorMap[fgColor.value()] = nextColorIndex;
-                        fgColorIndex = nextColorIndex++;
-                    }
+    // Finish copying buffer attributes to remaining rows below the last
+    // printable character. This is to fix the `color 2f` scenario, where you
+    // change the buffer colors then resize and everything below the last
+    // printable char gets reset. See GH #12567
+    auto iOldRow = cOldRowsTotal;
+    auto newRowY = newCursor.GetPosition().Y + 1;
+    const auto newHeight = newBuffer.GetSize().Height();
+    const auto oldHeight = oldBuffer.GetSize().Height();
+    for (;
+         iOldRow < oldHeight && newRowY < newHeight;
+         iOldRow++)
+    {
+        const auto& row = oldBuffer.GetRowByOffset(iOldRow);
 
-                    contentBuilder << "\\highlight" << bkColorIndex
-                                   << "\\cf" << fgColorIndex
-                                   << " ";
+        // Optimization: Since all these rows are below the last printable char,
+        // we can reasonably assume that they are filled with just spaces.
+        // That's convenient, we can just copy the attr row from the old buffer
+        // into the new one, and resize the row to match. We'll rely on the
+        // behavior of ATTR_ROW::Resize to trim down when narrower, or extend
+        // the last attr when wider.
+        auto& newRow = newBuffer.GetRowByOffset(newRowY);
+        const auto newWidth = newBuffer.GetLineWidth(newRowY);
+        newRow.GetAttrRow() = row.GetAttrRow();
+        newRow.GetAttrRow().Resize(newWidth);
+
+        newRowY++;
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        // Finish copying remaining parameters from the old text buffer to the new one
+        newBuffer.CopyProperties(oldBuffer);
+        newBuffer.CopyHyperlinkMaps(oldBuffer);
+        newBuffer.CopyPatterns(oldBuffer);
+
+        // If we found where to put the cursor while placing characters into the buffer,
+        //   just put the cursor there. Otherwise we have to advance manually.
+        if (progress.newCursorPos)
+        {
+            newCursor.SetPosition(*progress.newCursorPos);
+        }
+        else
+        {
+            // Advance the cursor to the same offset as before
+            // get the number of newlines and spaces between the old end of text and the old cursor,
+            //   then advance that many newlines and chars
+            auto iNewlines = cOldCursorPos.Y - cOldLastChar.Y;
+            const auto iIncrements = cOldCursorPos.X - cOldLastChar.X;
+            const auto cNewLastChar = newBuffer.GetLastNonSpaceCharacter();
+
+            // If the last row of the new buffer wrapped, there's going to be one less newline needed,
+            //   because the cursor is already on the next line
+            if (newBuffer.GetRowByOffset(cNewLastChar.Y).WasWrapForced())
+            {
+                iNewlines = std::max(iNewlines - 1, 0);
+            }
+            else
+            {
+                // if this buffer didn't wrap, but the old one DID, then the d(columns) of the
+                //   old buffer will be one more than in this buffer, so new need one LESS.
+                if (oldBuffer.GetRowByOffset(cOldLastChar.Y).WasWrapForced())
+                {
+                    iNewlines = std::max(iNewlines - 1, 0);
                 }
+            }
 
-                // if this is the last character in the row, flush the whole row
-                if (col == rows.text.at(row).length() - 1)
+            for (auto r = 0; r < iNewlines; r++)
+            {
+                if (!newBuffer.NewlineCursor())
+                {
+                    hr = E_OUTOFMEMORY;
+                    break;
+                }
+            }
+            if (SUCCEEDED(hr))
+            {
+                for (auto c = 0; c < iIncrements - 1; c++)
                 {
-                    writeAccumulatedChars(true);
+                    if (!newBuffer.IncrementCursor())
+                    {
+                        hr = E_OUTOFMEMORY;
+                        break;
+                    }
                 }
             }
         }
+    }
 
-        // end colortbl
-        colorTableBuilder << "}";
-
-        // add color table to the final RTF
-        rtfBuilder << colorTableBuilder.str();
+    if (SUCCEEDED(hr))
+    {
+        // Save old cursor size before we delete it
+        const auto ulSize = oldCursor.GetSize();
 
-        // add the text content to the final RTF
-        rtfBuilder << contentBuilder.str();
+        // Set size back to real size as it will be taking over the rendering duties.
+        newCursor.SetSize(ulSize);
+    }
 
-        // end rtf
-        rtfBuilder << "}";
+    return hr;
+}
 
-        return rtfBuilder.str();
-    }
-    catch (...)
+// Function Description:
+// - Helper for Reflow. Finds the first row of the old buffer that needs to be
+//   reflowed. This is a narrow optimization: it only skips the scrollback that
+//   would scroll off the top of the new buffer anyway, which happens when the
+//   buffer is full and gets narrower. Everything that remains is still reflowed
+//   right away.
+// - The positions Reflow reports are where the new buffer's cursor was when it
+//   passed them. Once the new buffer is full, that's always its last row. We
+//   start at a logical line (a run of rows that get joined together while
+//   reflowing) that leaves at least newSize.Y - 1 rows above firstReportedRow,
+//   so that every position is found at that last row, just like it would be if
+//   all rows were reflowed. This also ensures that the new buffer is filled.
+// - The height of each logical line is estimated as its length divided by the
+//   new width, which never exceeds the real height after reflowing (wide glyph
+//   padding and double width lines can only make it taller). As such we might
+//   start a bit too early, but never too late and thus never lose any rows.
+// Arguments:
+// - oldBuffer - the text buffer that's about to be reflowed
+// - lastRow - the last row of oldBuffer that will be reflowed
+// - firstReportedRow - the first row of oldBuffer whose new position is reported
+// - newSize - the dimensions of the buffer we're reflowing into
+// Return Value:
+// - The row of oldBuffer to start reflowing at.
+til::CoordType TextBuffer::_GetReflowFirstRetainedRow(const TextBuffer& oldBuffer, const til::CoordType lastRow, const til::CoordType firstReportedRow, const til::size newSize)
+{
+    if (newSize.X <= 0 || newSize.Y <= 0)
     {
-        LOG_HR(wil::ResultFromCaughtException());
-        return {};
+        return 0;
     }
-}
 
-void TextBuffer::_AppendRTFText(std::ostringstream& contentBuilder, const std::wstring_view& text)
-{
-    for (const auto codeUnit : text)
+    // Reflow only inserts a newline after a row that wasn't wrapped and that
+    // doesn't extend all the way to the right edge. Any other row is joined
+    // with the next one into the same logical line.
+    const auto continuesOnNextRow = [&](const til::CoordType y) {
+        const auto& row = oldBuffer.GetRowByOffset(y);
+        return row.WasWrapForced() || row.MeasureRight() >= oldBuffer.GetLineWidth(y);
+    };
+
+    // The number of new rows above the logical line that contains firstReportedRow.
+    til::CoordType rowsAboveReported = 0;
+    auto isAboveReported = false;
+    int64_t lineCells = 0;
+    for (auto y = lastRow; y >= 0; --y)
     {
-        if (codeUnit <= 127)
+        const auto& row = oldBuffer.GetRowByOffset(y);
+        if (row.WasWrapForced())
         {
-            switch (codeUnit)
-            {
-            case L'\\':
-            case L'{':
-            case L'}':
-                contentBuilder << "\\" << gsl::narrow<char>(codeUnit);
-                break;
-            default:
-                contentBuilder << gsl::narrow<char>(codeUnit);
-            }
+            lineCells += oldBuffer.GetLineWidth(y) - (row.WasDoubleBytePadded() ? 1 : 0);
         }
         else
         {
-            // Windows uses unsigned wchar_t - RTF uses signed ones.
-            contentBuilder << "\\u" << std::to_string(til::bit_cast<int16_t>(codeUnit)) << "?";
+            lineCells += row.MeasureRight();
+        }
+
+        // When the previous row doesn't continue into this one, y is the start of a logical line.
+        if (y == 0 || !continuesOnNextRow(y - 1))
+        {
+            if (isAboveReported)
+            {
+                rowsAboveReported += gsl::narrow_cast<til::CoordType>(std::max<int64_t>(1, (lineCells + newSize.X - 1) / newSize.X));
+                if (rowsAboveReported >= newSize.Y - 1)
+                {
+                    return y;
+                }
+            }
+            isAboveReported |= y <= firstReportedRow;
+            lineCells = 0;
         }
     }
+    return 0;
 }
 
 // Function Description:
-// - Reflow the contents from the old buffer into the new buffer. The new buffer
-//   can have different dimensions than the old buffer. If it does, then this
-//   function will attempt to maintain the logical contents of the old buffer,
-//   by continuing wrapped lines onto the next line in the new buffer.
+// - Helper for Reflow. Reprints the rows [beginRow, endRow) of the old buffer
+//   at the cursor of the new buffer.
+// - Whatever it finds out about the positions given in parameters is put into
+//   progress, unless progress already knows about it from previous rows.
 // Arguments:
 // - oldBuffer - the text buffer to copy the contents FROM
 // - newBuffer - the text buffer to copy the contents TO
-// - lastCharacterViewport - Optional. If the caller knows that the last
-//   nonspace character is in a particular Viewport, the caller can provide this
-//   parameter as an optimization, as opposed to searching the entire buffer.
-// - positionInfo - Optional. The caller can provide a pair of rows in this
-//   parameter and we'll calculate the position of the _end_ of those rows in
-//   the new buffer. The rows's new value is placed back into this parameter.
+// - beginRow - the first row of oldBuffer to reflow
+// - endRow - the row after the last one of oldBuffer to reflow
+// - parameters - what the caller is looking for in the old buffer
+// - progress - what was found so far
+// - rights - Optional. The MeasureRight() of every row in [beginRow, endRow), if the caller
+//   measured them already. Without them, every row is measured here. That takes the
+//   old buffer's _measureCacheLock, which concurrent callers would contend on.
 // Return Value:
-// - S_OK if we successfully copied the contents to the new buffer, otherwise an appropriate HRESULT.
-HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
-                           TextBuffer& newBuffer,
-                           const std::optional<Viewport> lastCharacterViewport,
-                           std::optional<std::reference_wrapper<PositionInformation>> positionInfo)
+// - S_OK if we successfully copied the rows to the new buffer, otherwise an appropriate HRESULT.
+HRESULT TextBuffer::_ReflowRows(const TextBuffer& oldBuffer,
+                                TextBuffer& newBuffer,
+                                const til::CoordType beginRow,
+                                const til::CoordType endRow,
+                                const ReflowParameters& parameters,
+                                ReflowProgress& progress,
+                                const gsl::span<const til::CoordType> rights)
 {
-    const auto& oldCursor = oldBuffer.GetCursor();
     auto& newCursor = newBuffer.GetCursor();
-
-    // We need to save the old cursor position so that we can
-    // place the new cursor back on the equivalent character in
-    // the new buffer.
-    const auto cOldCursorPos = oldCursor.GetPosition();
-    const auto cOldLastChar = oldBuffer.GetLastNonSpaceCharacter(lastCharacterViewport);
-
-    const auto cOldRowsTotal = cOldLastChar.Y + 1;
-
-    til::point cNewCursorPos;
-    auto fFoundCursorPos = false;
-    auto foundOldMutable = false;
-    auto foundOldVisible = false;
+    const auto cOldCursorPos = parameters.oldCursorPos;
     auto hr = S_OK;
-    // Loop through all the rows of the old buffer and reprint them into the new buffer
-    til::CoordType iOldRow = 0;
-    for (; iOldRow < cOldRowsTotal; iOldRow++)
+
+    for (auto iOldRow = beginRow; iOldRow < endRow; iOldRow++)
     {
         // Fetch the row and its "right" which is the last printable character.
         const auto& row = oldBuffer.GetRowByOffset(iOldRow);
         const auto cOldColsTotal = oldBuffer.GetLineWidth(iOldRow);
-        const auto& charRow = row.GetCharRow();
-        auto iRight = charRow.MeasureRight();
+        auto iRight = rights.empty() ? row.MeasureRight() : til::at(rights, gsl::narrow_cast<size_t>(iOldRow - beginRow));
 
         // If we're starting a new row, try and preserve the line rendition
         // from the row in the original buffer.
@@ -2292,14 +3392,16 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
         // Loop through every character in the current row (up to
         // the "right" boundary, which is one past the final valid
         // character)
+        // The attributes are walked with an iterator alongside the columns,
+        // instead of searching the runs for every single column.
         til::CoordType iOldCol = 0;
         const auto copyRight = iRight;
-        for (; iOldCol < copyRight; iOldCol++)
+        auto attrIt = row.GetAttrRow().cbegin();
+        for (; iOldCol < copyRight; iOldCol++, ++attrIt)
         {
             if (iOldCol == cOldCursorPos.X && iOldRow == cOldCursorPos.Y)
             {
-                cNewCursorPos = newCursor.GetPosition();
-                fFoundCursorPos = true;
+                progress.newCursorPos = newCursor.GetPosition();
             }
 
             try
@@ -2307,9 +3409,8 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
                 // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
                 const auto glyph = row.GetCharRow().GlyphAt(iOldCol);
                 const auto dbcsAttr = row.GetCharRow().DbcsAttrAt(iOldCol);
-                const auto textAttr = row.GetAttrRow().GetAttrByColumn(iOldCol);
 
-                if (!newBuffer.InsertCharacter(glyph, dbcsAttr, textAttr))
+                if (!newBuffer.InsertCharacter(glyph, dbcsAttr, *attrIt))
                 {
                     hr = E_OUTOFMEMORY;
                     break;
@@ -2363,24 +3464,16 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
         // If we found the old row that the caller was interested in, set the
         // out value of that parameter to the cursor's current Y position (the
         // new location of the _end_ of that row in the buffer).
-        if (positionInfo.has_value())
+        if (const auto& oldPositions = parameters.oldPositions)
         {
-            if (!foundOldMutable)
+            if (!progress.mutableViewportTop && iOldRow >= oldPositions->mutableViewportTop)
             {
-                if (iOldRow >= positionInfo.value().get().mutableViewportTop)
-                {
-                    positionInfo.value().get().mutableViewportTop = newCursor.GetPosition().Y;
-                    foundOldMutable = true;
-                }
+                progress.mutableViewportTop = newCursor.GetPosition().Y;
             }
 
-            if (!foundOldVisible)
+            if (!progress.visibleViewportTop && iOldRow >= oldPositions->visibleViewportTop)
             {
-                if (iOldRow >= positionInfo.value().get().visibleViewportTop)
-                {
-                    positionInfo.value().get().visibleViewportTop = newCursor.GetPosition().Y;
-                    foundOldVisible = true;
-                }
+                progress.visibleViewportTop = newCursor.GetPosition().Y;
             }
         }
 
@@ -2393,16 +3486,15 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
             // only because we ran out of space.
             if (iRight < cOldColsTotal && !row.WasWrapForced())
             {
-                if (!fFoundCursorPos && (iRight == cOldCursorPos.X && iOldRow == cOldCursorPos.Y))
+                if (!progress.newCursorPos && (iRight == cOldCursorPos.X && iOldRow == cOldCursorPos.Y))
                 {
-                    cNewCursorPos = newCursor.GetPosition();
-                    fFoundCursorPos = true;
+                    progress.newCursorPos = newCursor.GetPosition();
                 }
                 // Only do this if it's not the final line in the buffer.
                 // On the final line, we want the cursor to sit
                 // where it is done printing for the cursor
                 // adjustment to follow.
-                if (iOldRow < cOldRowsTotal - 1)
+                if (iOldRow < parameters.lastRow)
                 {
                     hr = newBuffer.NewlineCursor() ? hr : E_OUTOFMEMORY;
                 }
@@ -2445,103 +3537,209 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
         }
     }
 
-    // Finish copying buffer attributes to remaining rows below the last
-    // printable character. This is to fix the `color 2f` scenario, where you
-    // change the buffer colors then resize and everything below the last
-    // printable char gets reset. See GH #12567
-    auto newRowY = newCursor.GetPosition().Y + 1;
-    const auto newHeight = newBuffer.GetSize().Height();
-    const auto oldHeight = oldBuffer.GetSize().Height();
-    for (;
-         iOldRow < oldHeight && newRowY < newHeight;
-         iOldRow++)
+
+    return hr;
+}
+
+// Function Description:
+// - Helper for Reflow. Splits the rows [beginRow, endRow) of the old buffer
+//   into chunks of whole logical lines and reflows each of them on its own
+//   thread into a scratch buffer. Since every chunk ends with a hard line
+//   break, its rows end up the same no matter where they're put, and the
+//   scratch rows are copied to the cursor of the new buffer one chunk after
+//   the other.
+// - The final logical line is never part of a chunk, because reflowing it
+//   depends on where the cursor is left afterwards. The caller is expected to
+//   reflow the rows [nextRow, endRow) itself.
+// Arguments:
+// - oldBuffer - the text buffer to copy the contents FROM
+// - newBuffer - the text buffer to copy the contents TO
+// - beginRow - the first row of oldBuffer to reflow
+// - endRow - the row after the last one of oldBuffer to reflow
+// - parameters - what the caller is looking for in the old buffer
+// - progress - what was found so far
+// - nextRow - receives the first row that wasn't reflowed yet
+// Return Value:
+// - S_OK if we successfully copied the chunks to the new buffer, otherwise an appropriate HRESULT.
+HRESULT TextBuffer::_ReflowRowsInParallel(const TextBuffer& oldBuffer,
+                                          TextBuffer& newBuffer,
+                                          const til::CoordType beginRow,
+                                          const til::CoordType endRow,
+                                          const ReflowParameters& parameters,
+                                          ReflowProgress& progress,
+                                          til::CoordType& nextRow)
+{
+    nextRow = beginRow;
+
+    // Threads are only worth it if each of them gets a couple thousand rows.
+    static constexpr til::CoordType minRowsPerChunk = 4096;
+    const auto rows = endRow - beginRow;
+    const auto threads = std::min<til::CoordType>(gsl::narrow_cast<til::CoordType>(std::thread::hardware_concurrency()), rows / minRowsPerChunk);
+    if (threads < 2)
     {
-        const auto& row = oldBuffer.GetRowByOffset(iOldRow);
+        return S_OK;
+    }
 
-        // Optimization: Since all these rows are below the last printable char,
-        // we can reasonably assume that they are filled with just spaces.
-        // That's convenient, we can just copy the attr row from the old buffer
-        // into the new one, and resize the row to match. We'll rely on the
-        // behavior of ATTR_ROW::Resize to trim down when narrower, or extend
-        // the last attr when wider.
-        auto& newRow = newBuffer.GetRowByOffset(newRowY);
-        const auto newWidth = newBuffer.GetLineWidth(newRowY);
-        newRow.GetAttrRow() = row.GetAttrRow();
-        newRow.GetAttrRow().Resize(newWidth);
+    struct Chunk
+    {
+        til::CoordType beginRow;
+        til::CoordType endRow;
+        // An upper bound of how many rows the chunk takes up in the new buffer, plus some room.
+        til::CoordType height;
+    };
+    std::vector<Chunk> chunks;
+
+    // Reflow only inserts a newline after a row that wasn't wrapped and that
+    // doesn't extend all the way to the right edge, which is where chunks may
+    // be cut. This walks every row and records its right edge, which the threads
+    // below are handed, so that they don't need to measure (and lock) anything.
+    std::vector<til::CoordType> rights;
+    try
+    {
+        rights.resize(gsl::narrow_cast<size_t>(rows));
+    }
+    CATCH_RETURN();
+    const auto newWidth = newBuffer.GetSize().Width();
+    const auto rowsPerChunk = rows / threads;
+    auto chunkBegin = beginRow;
+    til::CoordType chunkHeight = 2;
+    int64_t lineCells = 0;
+    auto lineIsDoubleWidth = false;
+    for (auto y = beginRow; y < endRow; ++y)
+    {
+        const auto& row = oldBuffer.GetRowByOffset(y);
+        const auto right = row.MeasureRight();
+        til::at(rights, gsl::narrow_cast<size_t>(y - beginRow)) = right;
+        lineIsDoubleWidth |= row.GetLineRendition() != LineRendition::SingleWidth;
+        if (row.WasWrapForced())
+        {
+            lineCells += oldBuffer.GetLineWidth(y) - (row.WasDoubleBytePadded() ? 1 : 0);
+            continue;
+        }
 
-        newRowY++;
+        lineCells += right;
+        if (right >= oldBuffer.GetLineWidth(y))
+        {
+            continue;
+        }
+
+        // Wide glyphs that don't fit at the end of a row waste a column, hence the - 1.
+        const auto width = std::max<int64_t>((lineIsDoubleWidth ? newWidth / 2 : newWidth) - 1, 1);
+        chunkHeight += gsl::narrow_cast<til::CoordType>((lineCells + width - 1) / width + 1);
+        lineCells = 0;
+        lineIsDoubleWidth = false;
+
+        if (y + 1 - chunkBegin >= rowsPerChunk && y + 1 < endRow)
+        {
+            chunks.push_back({ chunkBegin, y + 1, chunkHeight });
+            chunkBegin = y + 1;
+            chunkHeight = 2;
+        }
     }
 
-    if (SUCCEEDED(hr))
+    if (chunks.size() < 2)
     {
-        // Finish copying remaining parameters from the old text buffer to the new one
-        newBuffer.CopyProperties(oldBuffer);
-        newBuffer.CopyHyperlinkMaps(oldBuffer);
-        newBuffer.CopyPatterns(oldBuffer);
+        return S_OK;
+    }
 
-        // If we found where to put the cursor while placing characters into the buffer,
-        //   just put the cursor there. Otherwise we have to advance manually.
-        if (fFoundCursorPos)
+    auto& renderer = newBuffer._renderer;
+    const auto attributes = newBuffer.GetCurrentAttributes();
+    const auto cursorSize = newBuffer.GetCursor().GetSize();
+
+    struct ChunkResult
+    {
+        std::unique_ptr<TextBuffer> buffer;
+        ReflowProgress progress;
+        HRESULT hr;
+    };
+    const auto chunkRights = [&](const Chunk& chunk) {
+        return gsl::span<const til::CoordType>{ rights }.subspan(gsl::narrow_cast<size_t>(chunk.beginRow - beginRow), gsl::narrow_cast<size_t>(chunk.endRow - chunk.beginRow));
+    };
+    std::vector<std::future<ChunkResult>> futures;
+    futures.reserve(chunks.size());
+    try
+    {
+        for (const auto& chunk : chunks)
         {
-            newCursor.SetPosition(cNewCursorPos);
+            futures.emplace_back(std::async(std::launch::async, [&, chunk]() {
+                ChunkResult result;
+                result.buffer = std::make_unique<TextBuffer>(til::size{ newWidth, chunk.height }, attributes, cursorSize, false, renderer);
+                result.hr = _ReflowRows(oldBuffer, *result.buffer, chunk.beginRow, chunk.endRow, parameters, result.progress, chunkRights(chunk));
+                return result;
+            }));
         }
-        else
+    }
+    CATCH_RETURN();
+
+    // The futures wait for their threads when they're destroyed,
+    // so it's fine to return early from here on out.
+    auto& newCursor = newBuffer.GetCursor();
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        const auto& chunk = til::at(chunks, i);
+        ChunkResult result;
+        try
         {
-            // Advance the cursor to the same offset as before
-            // get the number of newlines and spaces between the old end of text and the old cursor,
-            //   then advance that many newlines and chars
-            auto iNewlines = cOldCursorPos.Y - cOldLastChar.Y;
-            const auto iIncrements = cOldCursorPos.X - cOldLastChar.X;
-            const auto cNewLastChar = newBuffer.GetLastNonSpaceCharacter();
+            result = til::at(futures, i).get();
+        }
+        CATCH_RETURN();
+        RETURN_IF_FAILED(result.hr);
 
-            // If the last row of the new buffer wrapped, there's going to be one less newline needed,
-            //   because the cursor is already on the next line
-            if (newBuffer.GetRowByOffset(cNewLastChar.Y).WasWrapForced())
-            {
-                iNewlines = std::max(iNewlines - 1, 0);
-            }
-            else
+        const auto& scratch = *result.buffer;
+        const auto scratchRows = scratch.GetCursor().GetPosition().Y;
+
+        // If the estimate was off after all, the scratch buffer circled
+        // and lost rows. Reflow the chunk the slow way instead.
+        if (scratchRows >= chunk.height - 1)
+        {
+            RETURN_IF_FAILED(_ReflowRows(oldBuffer, newBuffer, chunk.beginRow, chunk.endRow, parameters, progress, chunkRights(chunk)));
+            continue;
+        }
+
+        for (til::CoordType y = 0; y < scratchRows; ++y)
+        {
+            const auto targetY = newCursor.GetPosition().Y;
+            _CopyReflowedRow(scratch.GetRowByOffset(y), newBuffer.GetRowByOffset(targetY));
+
+            if (!progress.newCursorPos && result.progress.newCursorPos && result.progress.newCursorPos->Y == y)
             {
-                // if this buffer didn't wrap, but the old one DID, then the d(columns) of the
-                //   old buffer will be one more than in this buffer, so new need one LESS.
-                if (oldBuffer.GetRowByOffset(cOldLastChar.Y).WasWrapForced())
-                {
-                    iNewlines = std::max(iNewlines - 1, 0);
-                }
+                progress.newCursorPos = til::point{ result.progress.newCursorPos->X, targetY };
             }
-
-            for (auto r = 0; r < iNewlines; r++)
+            if (!progress.mutableViewportTop && result.progress.mutableViewportTop == y)
             {
-                if (!newBuffer.NewlineCursor())
-                {
-                    hr = E_OUTOFMEMORY;
-                    break;
-                }
+                progress.mutableViewportTop = targetY;
             }
-            if (SUCCEEDED(hr))
+            if (!progress.visibleViewportTop && result.progress.visibleViewportTop == y)
             {
-                for (auto c = 0; c < iIncrements - 1; c++)
-                {
-                    if (!newBuffer.IncrementCursor())
-                    {
-                        hr = E_OUTOFMEMORY;
-                        break;
-                    }
-                }
+                progress.visibleViewportTop = targetY;
             }
+
+            RETURN_HR_IF(E_OUTOFMEMORY, !newBuffer.NewlineCursor());
         }
     }
 
-    if (SUCCEEDED(hr))
-    {
-        // Save old cursor size before we delete it
-        const auto ulSize = oldCursor.GetSize();
-
-        // Set size back to real size as it will be taking over the rendering duties.
-        newCursor.SetSize(ulSize);
-    }
+    nextRow = chunks.back().endRow;
+    return S_OK;
+}
 
-    return hr;
+// Function Description:
+// - Helper for Reflow. Copies a row of a scratch buffer into a row of the
+//   new buffer, which must have the same width.
+// Arguments:
+// - source - the row to copy the contents FROM
+// - target - the row to copy the contents TO
+void TextBuffer::_CopyReflowedRow(const ROW& source, ROW& target)
+{
+    const auto& sourceChars = source.GetCharRow();
+    auto& targetChars = target.GetCharRow();
+    std::copy(sourceChars.begin(), sourceChars.end(), targetChars.begin());
+    targetChars.GetUnicodeStorage() = sourceChars.GetUnicodeStorage();
+
+    // The scratch buffer has its own attribute table, which the assignment translates from.
+    target.GetAttrRow() = source.GetAttrRow();
+    target.SetWrapForced(source.WasWrapForced());
+    target.SetDoubleBytePadded(source.WasDoubleBytePadded());
+    target.SetLineRendition(source.GetLineRendition());
 }
 
 // Method Description:
@@ -2572,31 +3770,47 @@ std::wstring TextBuffer::GetHyperlinkUriFromId(uint16_t id) const
 // - The internal hyperlink ID
 uint16_t TextBuffer::GetHyperlinkId(std::wstring_view uri, std::wstring_view id)
 {
-    uint16_t numericId = 0;
     if (id.empty())
     {
-        // no custom id specified, return our internal count
-        numericId = _currentHyperlinkId;
-        ++_currentHyperlinkId;
+        // no custom id specified, return a new internal id
+        return _NextHyperlinkId();
     }
-    else
+
+    // assign a new internal id if the custom id does not already exist
+    std::wstring newId{ id };
+    // hash the URL and add it to the custom ID - GH#7698
+    newId += L"%" + std::to_wstring(til::hash(uri));
+    if (const auto it = _hyperlinkCustomIdMap.find(newId); it != _hyperlinkCustomIdMap.end())
     {
-        // assign _currentHyperlinkId if the custom id does not already exist
-        std::wstring newId{ id };
-        // hash the URL and add it to the custom ID - GH#7698
-        newId += L"%" + std::to_wstring(til::hash(uri));
-        const auto result = _hyperlinkCustomIdMap.emplace(newId, _currentHyperlinkId);
-        if (result.second)
-        {
-            // the custom id did not already exist
-            ++_currentHyperlinkId;
-        }
-        numericId = (*(result.first)).second;
+        return it->second;
+    }
+    const auto numericId = _NextHyperlinkId();
+    _hyperlinkCustomIdMap.try_emplace(std::move(newId), numericId);
+    return numericId;
+}
+
+// Method description:
+// - Returns the next unused internal hyperlink ID. Once all 16-bit IDs were handed
+//   out once, the IDs of hyperlinks that were pruned are reused, oldest first. Only
+//   if there are none the IDs wrap around, as they always did before pruning existed.
+// Return value:
+// - The internal hyperlink ID, which is never 0
+uint16_t TextBuffer::_NextHyperlinkId()
+{
+    if (_hyperlinkIdsWrapped && !_recycledHyperlinkIds.empty())
+    {
+        const auto recycled = _recycledHyperlinkIds.front();
+        _recycledHyperlinkIds.pop_front();
+        return recycled;
     }
+
+    const auto numericId = _currentHyperlinkId;
+    ++_currentHyperlinkId;
     // _currentHyperlinkId could overflow, make sure its not 0
     if (_currentHyperlinkId == 0)
     {
         ++_currentHyperlinkId;
+        _hyperlinkIdsWrapped = true;
     }
     return numericId;
 }
@@ -2609,11 +3823,11 @@ uint16_t TextBuffer::GetHyperlinkId(std::wstring_view uri, std::wstring_view id)
 void TextBuffer::RemoveHyperlinkFromMap(uint16_t id) noexcept
 {
     _hyperlinkMap.erase(id);
-    for (const auto& customIdPair : _hyperlinkCustomIdMap)
+    for (auto it = _hyperlinkCustomIdMap.begin(); it != _hyperlinkCustomIdMap.end(); ++it)
     {
-        if (customIdPair.second == id)
+        if (it->second == id)
         {
-            _hyperlinkCustomIdMap.erase(customIdPair.first);
+            _hyperlinkCustomIdMap.erase(it);
             break;
         }
     }
@@ -2628,7 +3842,7 @@ void TextBuffer::RemoveHyperlinkFromMap(uint16_t id) noexcept
 // - The custom ID if there was one, empty string otherwise
 std::wstring TextBuffer::GetCustomIdFromId(uint16_t id) const
 {
-    for (auto customIdPair : _hyperlinkCustomIdMap)
+    for (const auto& customIdPair : _hyperlinkCustomIdMap)
     {
         if (customIdPair.second == id)
         {
@@ -2648,27 +3862,74 @@ void TextBuffer::CopyHyperlinkMaps(const TextBuffer& other)
     _hyperlinkMap = other._hyperlinkMap;
     _hyperlinkCustomIdMap = other._hyperlinkCustomIdMap;
     _currentHyperlinkId = other._currentHyperlinkId;
+    _recycledHyperlinkIds = other._recycledHyperlinkIds;
+    _hyperlinkIdsWrapped = other._hyperlinkIdsWrapped;
+}
+
+// Method Description:
+// - Adds up the memory held by this buffer. It walks all rows
+//   and should thus only be used for diagnostics.
+// Return Value:
+// - The bytes allocated on the heap for the buffer's contents.
+TextBuffer::MemoryUsage TextBuffer::GetMemoryUsage() const noexcept
+{
+    MemoryUsage usage;
+    usage.cells = _GetArenaCells(_charArenaSize) * sizeof(CharRowCell) + _storage.capacity() * sizeof(ROW);
+    for (const auto& row : _storage)
+    {
+        // The runs of a row are stored inline, as long as there's just 1 of them.
+        const auto& runs = row.GetAttrRow().GetRuns();
+        if (runs.capacity() > 1)
+        {
+            usage.cells += runs.capacity() * sizeof(runs[0]);
+        }
+        usage.unicodeStorage += row.GetCharRow().GetUnicodeStorage().GetMemoryUsage();
+    }
+    if (_attributeTable)
+    {
+        usage.attributes = _attributeTable->GetMemoryUsage();
+    }
+
+    // Strings up to the length of the small string buffer don't allocate.
+    const auto stringBytes = [](const std::wstring& str) noexcept -> size_t {
+        return str.capacity() > std::wstring{}.capacity() ? (str.capacity() + 1) * sizeof(wchar_t) : 0;
+    };
+    usage.hyperlinks = _hyperlinkMap.allocated_bytes() + _hyperlinkCustomIdMap.allocated_bytes();
+    for (const auto& [id, uri] : _hyperlinkMap)
+    {
+        usage.hyperlinks += stringBytes(uri);
+    }
+    for (const auto& [customId, id] : _hyperlinkCustomIdMap)
+    {
+        usage.hyperlinks += stringBytes(customId);
+    }
+    return usage;
 }
 
 // Method Description:
 // - Adds a regex pattern we should search for
 // - The searching does not happen here, we only search when asked to by TerminalCore
+// - The pattern is compiled right away, so that searches don't need to do it every time,
+//   and the string its matches must contain is extracted for FindPatterns to look for first.
 // Arguments:
 // - The regex pattern
 // Return value:
 // - An ID that the caller should associate with the given pattern
 const size_t TextBuffer::AddPatternRecognizer(const std::wstring_view regexString)
 {
-    ++_currentPatternId;
-    _idsAndPatterns.emplace(std::make_pair(_currentPatternId, regexString));
-    return _currentPatternId;
+    // Existing snapshots may still be using the current recognizers,
+    // so they're replaced with a copy instead of being modified.
+    auto patterns = _patterns ? std::make_shared<PatternRecognizers>(*_patterns) : std::make_shared<PatternRecognizers>();
+    patterns->push_back({ _currentPatternId + 1, std::wregex{ regexString.begin(), regexString.end() }, s_GetRequiredLiteral(regexString) });
+    _patterns = std::move(patterns);
+    return ++_currentPatternId;
 }
 
 // Method Description:
 // - Clears the patterns we know of and resets the pattern ID counter
 void TextBuffer::ClearPatternRecognizers() noexcept
 {
-    _idsAndPatterns.clear();
+    _patterns.reset();
     _currentPatternId = 0;
 }
 
@@ -2678,10 +3939,18 @@ void TextBuffer::ClearPatternRecognizers() noexcept
 // - The other buffer
 void TextBuffer::CopyPatterns(const TextBuffer& OtherBuffer)
 {
-    _idsAndPatterns = OtherBuffer._idsAndPatterns;
+    _patterns = OtherBuffer._patterns;
     _currentPatternId = OtherBuffer._currentPatternId;
 }
 
+// Method Description:
+// - Returns the compiled pattern recognizers. The pointer changes whenever a
+//   pattern is added or the patterns are cleared.
+std::shared_ptr<const TextBuffer::PatternRecognizers> TextBuffer::GetPatternRecognizers() const noexcept
+{
+    return _patterns;
+}
+
 // Method Description:
 // - Finds patterns within the requested region of the text buffer
 // Arguments:
@@ -2691,63 +3960,154 @@ void TextBuffer::CopyPatterns(const TextBuffer& OtherBuffer)
 // - An interval tree containing the patterns found
 PointTree TextBuffer::GetPatterns(const til::CoordType firstRow, const til::CoordType lastRow) const
 {
-    PointTree::interval_vector intervals;
+    return FindPatterns(SnapshotPatternText(firstRow, lastRow), nullptr);
+}
+
+// Method Description:
+// - Takes a snapshot of the requested region of the text buffer, for FindPatterns.
+// Arguments:
+// - The firstRow to start searching from
+// - The lastRow to search
+// Return value:
+// - The text of the given rows along with the patterns to search for
+TextBuffer::PatternSnapshot TextBuffer::SnapshotPatternText(const til::CoordType firstRow, const til::CoordType lastRow) const
+{
+    PatternSnapshot snapshot;
+    snapshot.patterns = _patterns;
+    snapshot.width = GetRowByOffset(0).size();
 
-    std::wstring concatAll;
-    const auto rowSize = GetRowByOffset(0).size();
-    concatAll.reserve(gsl::narrow_cast<size_t>(rowSize) * gsl::narrow_cast<size_t>(lastRow - firstRow + 1));
+    if (!_patterns)
+    {
+        return snapshot;
+    }
+
+    snapshot.rows = SnapshotRows(firstRow, lastRow);
+    return snapshot;
+}
 
-    // to deal with text that spans multiple lines, we will first concatenate
-    // all the text into one string and find the patterns in that string
-    for (til::CoordType i = firstRow; i <= lastRow; ++i)
+// Method Description:
+// - Finds the patterns in a snapshot of the buffer. This doesn't access the
+//   buffer anymore and can be called without holding the console lock.
+// Arguments:
+// - snapshot - The text and patterns returned by SnapshotPatternText
+// - cache - If given, the matches of lines that were searched by the previous call
+//   are reused, and the matches of this call are stored in it for the next one.
+// Return value:
+// - An interval tree containing the patterns found
+PointTree TextBuffer::FindPatterns(const PatternSnapshot& snapshot, PatternCache* const cache)
+{
+    PointTree::interval_vector intervals;
+    if (!snapshot.patterns || snapshot.width <= 0)
     {
-        auto& row = GetRowByOffset(i);
-        concatAll += row.GetText();
+        if (cache)
+        {
+            *cache = {};
+        }
+        return PointTree{ std::move(intervals) };
     }
 
-    // for each pattern we know of, iterate through the string
-    for (const auto& idAndPattern : _idsAndPatterns)
+    // to deal with text that spans multiple lines, rows that were wrapped
+    // are concatenated with the next one and searched as a single string
+    std::vector<std::wstring> lines;
+    // The offset of the first row of each line, relative to the first row of the snapshot.
+    std::vector<til::CoordType> lineRows;
+    auto startNewLine = true;
+    for (size_t i = 0; i < snapshot.rows.rows.size(); ++i)
     {
-        std::wregex regexObj{ idAndPattern.second };
+        const auto& row = *til::at(snapshot.rows.rows, i);
+        if (startNewLine)
+        {
+            lines.emplace_back();
+            lineRows.emplace_back(gsl::narrow_cast<til::CoordType>(i));
+        }
+        lines.back() += row.GetText();
+        startNewLine = !row.WasWrapForced();
+    }
+
+    PatternCache newCache;
+    newCache.patterns = snapshot.patterns;
+    const auto canReuse = cache && cache->patterns == snapshot.patterns;
 
-        // search through the run with our regex object
-        auto words_begin = std::wsregex_iterator(concatAll.begin(), concatAll.end(), regexObj);
-        auto words_end = std::wsregex_iterator();
+    std::vector<PatternMatch> matches;
+    for (size_t lineIndex = 0; lineIndex < lines.size(); ++lineIndex)
+    {
+        const auto& line = til::at(lines, lineIndex);
+        const auto& lineRow = til::at(lineRows, lineIndex);
 
-        til::CoordType lenUpToThis = 0;
-        for (auto i = words_begin; i != words_end; ++i)
+        matches.clear();
+        auto reused = false;
+        if (canReuse)
         {
-            // record the locations -
-            // when we find a match, the prefix is text that is between this
-            // match and the previous match, so we use the size of the prefix
-            // along with the size of the match to determine the locations
-            til::CoordType prefixSize = 0;
-            for (const auto parsedGlyph : Utf16Parser::Parse(i->prefix().str()))
+            if (const auto it = cache->matches.find(line); it != cache->matches.end())
             {
-                const std::wstring_view glyph{ parsedGlyph.data(), parsedGlyph.size() };
-                prefixSize += IsGlyphFullWidth(glyph) ? 2 : 1;
+                matches = it->second;
+                reused = true;
             }
-            const auto start = lenUpToThis + prefixSize;
-            til::CoordType matchSize = 0;
-            for (const auto parsedGlyph : Utf16Parser::Parse(i->str()))
+        }
+
+        if (!reused)
+        {
+            // for each pattern we know of, iterate through the string
+            const std::wstring_view lineView{ line };
+            for (const auto& [id, regexObj, literal] : *snapshot.patterns)
             {
-                const std::wstring_view glyph{ parsedGlyph.data(), parsedGlyph.size() };
-                matchSize += IsGlyphFullWidth(glyph) ? 2 : 1;
-            }
-            const auto end = start + matchSize;
-            lenUpToThis = end;
+                // Most lines don't contain anything that looks like a URL, and finding
+                // that out by searching for "://" is a lot cheaper than running the regex.
+                if (!literal.empty() && lineView.find(literal) == std::wstring_view::npos)
+                {
+                    continue;
+                }
+
+                size_t prefixStart = 0;
+                til::CoordType lenUpToThis = 0;
 
-            const til::point startCoord{ start % rowSize, start / rowSize };
-            const til::point endCoord{ end % rowSize, end / rowSize };
+                // search through the run with our regex object
+                const auto words_end = std::wsregex_iterator();
+                for (auto i = std::wsregex_iterator(line.begin(), line.end(), regexObj); i != words_end; ++i)
+                {
+                    // record the locations -
+                    // when we find a match, the prefix is text that is between this
+                    // match and the previous match, so we use the size of the prefix
+                    // along with the size of the match to determine the locations
+                    const auto matchStart = gsl::narrow_cast<size_t>(i->position());
+                    const auto matchLength = gsl::narrow_cast<size_t>(i->length());
+                    const auto prefixSize = gsl::narrow<til::CoordType>(GetGlyphColumnCount(lineView.substr(prefixStart, matchStart - prefixStart)));
+                    const auto start = lenUpToThis + prefixSize;
+                    const auto matchSize = gsl::narrow<til::CoordType>(GetGlyphColumnCount(lineView.substr(matchStart, matchLength)));
+                    const auto end = start + matchSize;
+                    lenUpToThis = end;
+                    prefixStart = matchStart + matchLength;
+
+                    matches.push_back({ start, end, id });
+                }
+            }
+        }
 
+        for (const auto& match : matches)
+        {
             // store the intervals
             // NOTE: these intervals are relative to the VIEWPORT not the buffer
             // Keeping these relative to the viewport for now because its the renderer
             // that actually uses these locations and the renderer works relative to
             // the viewport
-            intervals.push_back(PointTree::interval(startCoord, endCoord, idAndPattern.first));
+            const til::point startCoord{ match.start % snapshot.width, lineRow + match.start / snapshot.width };
+            const til::point endCoord{ match.end % snapshot.width, lineRow + match.end / snapshot.width };
+            intervals.push_back(PointTree::interval(startCoord, endCoord, match.id));
+        }
+
+        if (cache)
+        {
+            newCache.matches.insert_or_assign(line, matches);
         }
     }
+
+    if (cache)
+    {
+        // Only the lines of this snapshot are kept, so the cache can't outgrow the viewport.
+        newCache.rows = snapshot.rows;
+        *cache = std::move(newCache);
+    }
+
     PointTree result(std::move(intervals));
     return result;
 }
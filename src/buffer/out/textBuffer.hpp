@@ -23,8 +23,8 @@ ScreenBuffer data structure overview:
 each screen buffer has an array of ROW structures.  each ROW structure
 contains the data for one row of text.  the data stored for one row of
 text is a character array and an attribute array.  the character array
-is allocated the full length of the row from the heap, regardless of the
-non-space length. we also maintain the non-space length.  the character
+is the full length of the row, regardless of the non-space length, and the
+arrays of all rows are packed into a single allocation owned by the buffer. we also maintain the non-space length.  the character
 array is initialized to spaces.  the attribute
 array is run length encoded (i.e 5 BLUE, 3 RED). if there is only one
 attribute for the whole row (the normal case), it is stored in the ATTR_ROW
@@ -49,11 +49,15 @@ filling in the last row, and updating the screen.
 
 #pragma once
 
+#include <bitset>
+#include <deque>
 #include <vector>
 
 #include "cursor.h"
 #include "Row.hpp"
 #include "TextAttribute.hpp"
+#include "TextAttributeTable.hpp"
+#include "RowSnapshot.hpp"
 #include "UnicodeStorage.hpp"
 #include "../types/inc/Viewport.hpp"
 
@@ -74,6 +78,7 @@ public:
                const bool isActiveBuffer,
                Microsoft::Console::Render::Renderer& renderer);
     TextBuffer(const TextBuffer& a) = delete;
+    ~TextBuffer();
 
     // Used for duplicating properties to another text buffer
     void CopyProperties(const TextBuffer& OtherBuffer) noexcept;
@@ -119,6 +124,8 @@ public:
     const Microsoft::Console::Types::Viewport GetSize() const noexcept;
 
     void ScrollRows(const til::CoordType firstRow, const til::CoordType size, const til::CoordType delta);
+    void CopyRect(const til::rect& source, const til::point target);
+    void ChangeAttributes(const til::rect& area, const std::function<void(TextAttribute&)>& change);
 
     til::CoordType TotalRowCount() const noexcept;
 
@@ -128,6 +135,7 @@ public:
 
     void SetCurrentLineRendition(const LineRendition lineRendition);
     void ResetLineRenditionRange(const til::CoordType startRow, const til::CoordType endRow) noexcept;
+    void ResetRows(const til::CoordType startRow, const til::CoordType endRow, const TextAttribute& attributes);
     LineRendition GetLineRendition(const til::CoordType row) const noexcept;
     bool IsDoubleWidthLine(const til::CoordType row) const noexcept;
 
@@ -140,8 +148,28 @@ public:
 
     [[nodiscard]] HRESULT ResizeTraditional(const til::size newSize) noexcept;
 
-    const UnicodeStorage& GetUnicodeStorage() const noexcept;
-    UnicodeStorage& GetUnicodeStorage() noexcept;
+    uint64_t GetRevision() const noexcept;
+    bool HasChangedSince(const uint64_t revision, const til::CoordType firstRow, const til::CoordType lastRow) const noexcept;
+    std::vector<til::CoordType> GetRowsChangedSince(const uint64_t revision) const;
+
+    std::wstring_view GetRowText(const til::CoordType row, til::CoordType beginColumn, til::CoordType endColumn) const;
+    std::shared_ptr<const RowSnapshot> GetRowSnapshot(const til::CoordType row) const;
+
+    // A consistent copy of a range of rows, which can be used
+    // without holding the console lock. See RowSnapshot.
+    struct RowsSnapshot
+    {
+        std::vector<std::shared_ptr<const RowSnapshot>> rows;
+        // The offset of the first row of the snapshot.
+        til::CoordType firstRow = 0;
+        // The value of GetRevision() when the snapshot was taken.
+        uint64_t revision = 0;
+    };
+    RowsSnapshot SnapshotRows(const til::CoordType firstRow, const til::CoordType lastRow) const;
+
+    const TextAttributeTable& GetAttributeTable() const noexcept;
+    TextAttributeTable& GetAttributeTable() noexcept;
+    void CompactAttributeTable() noexcept;
 
     void SetAsActiveBuffer(const bool isActiveBuffer) noexcept;
     bool IsActiveBuffer() const noexcept;
@@ -174,6 +202,23 @@ public:
     std::wstring GetCustomIdFromId(uint16_t id) const;
     void CopyHyperlinkMaps(const TextBuffer& OtherBuffer);
 
+    // The memory held by the buffer, in bytes, by what it's used for.
+    struct MemoryUsage
+    {
+        // The char arena, the ROWs and any attribute runs that didn't fit into a ROW.
+        size_t cells = 0;
+        size_t attributes = 0;
+        // The glyphs that didn't fit into a single CharRowCell.
+        size_t unicodeStorage = 0;
+        size_t hyperlinks = 0;
+
+        constexpr size_t Total() const noexcept
+        {
+            return cells + attributes + unicodeStorage + hyperlinks;
+        }
+    };
+    MemoryUsage GetMemoryUsage() const noexcept;
+
     class TextAndColor
     {
     public:
@@ -182,22 +227,62 @@ public:
         std::vector<std::vector<COLORREF>> BkAttr;
     };
 
+    // Like TextAndColor, but the colors are stored once per run of identical colors
+    // instead of once per character, and the text of all rows is stored together.
+    // This keeps copying large selections from using several times the memory of the text.
+    class TextAndColorRuns
+    {
+    public:
+        struct Run
+        {
+            size_t length;
+            COLORREF fg;
+            COLORREF bg;
+        };
+
+        // The text of all rows, including the CR/LFs between them.
+        std::wstring text;
+        // The offset into text at which each row ends.
+        std::vector<size_t> rowEnds;
+        // The colors of text from start to end. A run never spans multiple rows.
+        std::vector<Run> runs;
+
+        static TextAndColorRuns FromTextAndColor(const TextAndColor& rows);
+        void Append(const std::wstring_view chars, const COLORREF fg, const COLORREF bg, const size_t rowBegin);
+    };
+
     const TextAndColor GetText(const bool includeCRLF,
                                const bool trimTrailingWhitespace,
                                const std::vector<til::inclusive_rect>& textRects,
                                std::function<std::pair<COLORREF, COLORREF>(const TextAttribute&)> GetAttributeColors = nullptr,
                                const bool formatWrappedRows = false) const;
 
+    TextAndColorRuns GetTextAndColorRuns(const bool includeCRLF,
+                                         const bool trimTrailingWhitespace,
+                                         const std::vector<til::inclusive_rect>& textRects,
+                                         const std::function<std::pair<COLORREF, COLORREF>(const TextAttribute&)>& GetAttributeColors,
+                                         const bool formatWrappedRows = false) const;
+
     static std::string GenHTML(const TextAndColor& rows,
                                const int fontHeightPoints,
                                const std::wstring_view fontFaceName,
                                const COLORREF backgroundColor);
 
+    static std::string GenHTML(const TextAndColorRuns& rows,
+                               const int fontHeightPoints,
+                               const std::wstring_view fontFaceName,
+                               const COLORREF backgroundColor);
+
     static std::string GenRTF(const TextAndColor& rows,
                               const int fontHeightPoints,
                               const std::wstring_view fontFaceName,
                               const COLORREF backgroundColor);
 
+    static std::string GenRTF(const TextAndColorRuns& rows,
+                              const int fontHeightPoints,
+                              const std::wstring_view fontFaceName,
+                              const COLORREF backgroundColor);
+
     struct PositionInformation
     {
         til::CoordType mutableViewportTop{ 0 };
@@ -209,14 +294,66 @@ public:
                           const std::optional<Microsoft::Console::Types::Viewport> lastCharacterViewport,
                           std::optional<std::reference_wrapper<PositionInformation>> positionInfo);
 
+    // The compiled pattern recognizers of a buffer. They're immutable once
+    // created, so that snapshots can share them with other threads.
+    struct PatternRecognizer
+    {
+        size_t id;
+        std::wregex regex;
+        // A string that every match contains, if there is one. Lines without
+        // it are skipped without running the (comparatively slow) regex.
+        std::wstring literal;
+    };
+    using PatternRecognizers = std::vector<PatternRecognizer>;
+
+    // A snapshot of a range of rows, so that FindPatterns
+    // can run without holding the console lock.
+    struct PatternSnapshot
+    {
+        std::shared_ptr<const PatternRecognizers> patterns;
+        RowsSnapshot rows;
+        til::CoordType width = 0;
+    };
+
+    struct PatternMatch
+    {
+        // The columns of the match, counted from the start of its line.
+        til::CoordType start;
+        til::CoordType end;
+        size_t id;
+    };
+
+    // The matches of the lines that FindPatterns searched most recently, keyed by their text.
+    // Lines that didn't change (or just scrolled) since then don't need to be searched again.
+    struct PatternCache
+    {
+        std::shared_ptr<const PatternRecognizers> patterns;
+        til::flat_hash_map<std::wstring, std::vector<PatternMatch>> matches;
+        // Keeps the rows of the previous snapshot alive, so that the
+        // next one can share those that didn't change. See SnapshotRows.
+        RowsSnapshot rows;
+    };
+
     const size_t AddPatternRecognizer(const std::wstring_view regexString);
     void ClearPatternRecognizers() noexcept;
     void CopyPatterns(const TextBuffer& OtherBuffer);
     interval_tree::IntervalTree<til::point, size_t> GetPatterns(const til::CoordType firstRow, const til::CoordType lastRow) const;
+    std::shared_ptr<const PatternRecognizers> GetPatternRecognizers() const noexcept;
+    PatternSnapshot SnapshotPatternText(const til::CoordType firstRow, const til::CoordType lastRow) const;
+    static interval_tree::IntervalTree<til::point, size_t> FindPatterns(const PatternSnapshot& snapshot, PatternCache* const cache);
 
 private:
     void _UpdateSize();
     Microsoft::Console::Types::Viewport _size;
+
+    // The glyph cells of all rows, packed into a single allocation.
+    // Each ROW's CharRow views its own slice of it, which contains
+    // _charArenaSize.X cells and is at least as large as the row.
+    std::unique_ptr<CharRowCell[]> _charArena;
+    til::size _charArenaSize;
+    // The attributes referenced by the runs of all rows. CompactAttributeTable()
+    // replaces it once it gets full, which is why it isn't held directly.
+    std::unique_ptr<TextAttributeTable> _attributeTable;
     std::vector<ROW> _storage;
     Cursor _cursor;
 
@@ -224,17 +361,25 @@ private:
 
     TextAttribute _currentAttributes;
 
-    // storage location for glyphs that can't fit into the buffer normally
-    UnicodeStorage _unicodeStorage;
-
     bool _isActiveBuffer;
     Microsoft::Console::Render::Renderer& _renderer;
 
-    std::unordered_map<uint16_t, std::wstring> _hyperlinkMap;
-    std::unordered_map<std::wstring, uint16_t> _hyperlinkCustomIdMap;
+    til::flat_hash_map<uint16_t, std::wstring> _hyperlinkMap;
+    til::flat_hash_map<std::wstring, uint16_t> _hyperlinkCustomIdMap;
     uint16_t _currentHyperlinkId;
-
-    void _RefreshRowIDs(std::optional<til::CoordType> newRowWidth);
+    // IDs whose hyperlinks were pruned, oldest first. They're only handed out again
+    // once _currentHyperlinkId wrapped around, which keeps them unused for as long as
+    // possible, in case something outside of the rows still remembers them.
+    std::deque<uint16_t> _recycledHyperlinkIds;
+    bool _hyperlinkIdsWrapped = false;
+
+    static std::unique_ptr<CharRowCell[]> _AllocateCharArena(const til::size size);
+    static void _ReleaseCharArena(std::unique_ptr<CharRowCell[]>&& arena, const size_t cells) noexcept;
+    static CharRowCell* _GetArenaRow(CharRowCell* const arena, const til::CoordType index, const til::CoordType width) noexcept;
+    static size_t _GetArenaCells(const til::size size) noexcept;
+    bool _TryResizeInPlace(const til::size newSize, const TextAttribute& attributes);
+    uint64_t _NextRevision() noexcept;
+    std::shared_ptr<const RowSnapshot> _SnapshotRowLocked(const ROW& row) const;
 
     void _SetFirstRowIndex(const til::CoordType FirstRowIndex) noexcept;
 
@@ -249,22 +394,110 @@ private:
 
     ROW& _GetFirstRow() noexcept;
     ROW& _GetPrevRowNoWrap(const ROW& row);
+    size_t _GetStorageIndex(const til::CoordType index) const noexcept;
 
     void _ExpandTextRow(til::inclusive_rect& selectionRow) const;
 
-    DelimiterClass _GetDelimiterClassAt(const til::point pos, const std::wstring_view wordDelimiters) const;
+    // The delimiter classes of the cells of a row, as returned by _GetRowDelimiterClasses.
+    using RowDelimiterClasses = std::shared_ptr<const std::vector<DelimiterClass>>;
+    // Remembers the classes of the row that was looked up last by _GetDelimiterClassAt.
+    struct DelimiterClassLookup
+    {
+        til::CoordType row = -1;
+        RowDelimiterClasses classes;
+    };
+    RowDelimiterClasses _GetRowDelimiterClasses(const til::CoordType row, const std::wstring_view wordDelimiters) const;
+    DelimiterClass _GetDelimiterClassAt(const til::point pos, const std::wstring_view wordDelimiters, DelimiterClassLookup& lookup) const;
+    const DbcsAttribute& _GetDbcsAttrAt(const til::point pos) const;
     til::point _GetWordStartForAccessibility(const til::point target, const std::wstring_view wordDelimiters) const;
     til::point _GetWordStartForSelection(const til::point target, const std::wstring_view wordDelimiters) const;
     til::point _GetWordEndForAccessibility(const til::point target, const std::wstring_view wordDelimiters, const til::point limit) const;
     til::point _GetWordEndForSelection(const til::point target, const std::wstring_view wordDelimiters) const;
 
-    void _PruneHyperlinks();
+    void _PruneHyperlinks(const std::vector<uint16_t>& candidates);
+    uint16_t _NextHyperlinkId();
+
+    static til::CoordType _GetReflowFirstRetainedRow(const TextBuffer& oldBuffer, const til::CoordType lastRow, const til::CoordType firstReportedRow, const til::size newSize);
+
+    // What a Reflow found out about the positions of the old buffer in the new one.
+    struct ReflowProgress
+    {
+        std::optional<til::point> newCursorPos;
+        std::optional<til::CoordType> mutableViewportTop;
+        std::optional<til::CoordType> visibleViewportTop;
+    };
+    // The parameters of a Reflow that don't change from one old row to the next.
+    struct ReflowParameters
+    {
+        // The final row of the old buffer that's reflowed. The hard line break at its end is dropped.
+        til::CoordType lastRow;
+        til::point oldCursorPos;
+        std::optional<PositionInformation> oldPositions;
+    };
+    static HRESULT _ReflowRows(const TextBuffer& oldBuffer, TextBuffer& newBuffer, const til::CoordType beginRow, const til::CoordType endRow, const ReflowParameters& parameters, ReflowProgress& progress, const gsl::span<const til::CoordType> rights = {});
+    static HRESULT _ReflowRowsInParallel(const TextBuffer& oldBuffer, TextBuffer& newBuffer, const til::CoordType beginRow, const til::CoordType endRow, const ReflowParameters& parameters, ReflowProgress& progress, til::CoordType& nextRow);
+    static void _CopyReflowedRow(const ROW& source, ROW& target);
 
-    static void _AppendRTFText(std::ostringstream& contentBuilder, const std::wstring_view& text);
+    template<typename RowFunc, typename RunFunc>
+    static void _ForEachRunOfRows(const TextAndColorRuns& rows, RowFunc&& onRow, RunFunc&& onRun);
+    static void _AppendHTMLText(std::string& content, const std::wstring_view text);
+    static void _AppendRTFText(std::string& content, const std::wstring_view text);
 
-    std::unordered_map<size_t, std::wstring> _idsAndPatterns;
+    std::shared_ptr<const PatternRecognizers> _patterns;
     size_t _currentPatternId;
 
+    // The most recent revision given to a modified row, see GetRevision.
+    uint64_t _revision;
+    // The revision at which the offsets of all rows last changed.
+    uint64_t _shiftRevision;
+
+    // The result of the last GetLastNonSpaceCharacter() call, which
+    // stays valid until any row is modified and _revision changes.
+    // Like the MeasureRight() result of every ROW, it's guarded by _measureCacheLock.
+    struct LastNonSpaceCache
+    {
+        uint64_t revision;
+        Microsoft::Console::Types::Viewport viewport;
+        til::point position;
+    };
+    mutable std::mutex _measureCacheLock;
+    mutable std::optional<LastNonSpaceCache> _lastNonSpaceCache;
+
+    // The snapshots of the rows returned by GetRowSnapshot. Entries are indexed
+    // by row offset and are only valid if their row hasn't changed since.
+    struct RowTextCacheEntry
+    {
+        std::shared_ptr<const RowSnapshot> snapshot;
+        // Every row has a revision of at least 1, so 0 means "never filled".
+        uint64_t revision = 0;
+    };
+    mutable std::mutex _rowTextCacheLock;
+    mutable std::vector<RowTextCacheEntry> _rowTextCache;
+
+    // Guards the ROW::_snapshot of all rows, since readers may take snapshots concurrently.
+    mutable std::mutex _rowSnapshotLock;
+
+    // The delimiter classes of the rows that word navigation looked at, for the
+    // word delimiters it was most recently called with. Like _rowTextCache,
+    // entries are indexed by row offset and only valid until their row changes.
+    struct DelimiterClassCache
+    {
+        std::wstring wordDelimiters;
+        // Whether a UTF-16 code unit is one of wordDelimiters.
+        std::bitset<0x10000> isDelimiter;
+        struct Entry
+        {
+            RowDelimiterClasses classes;
+            uint64_t revision = 0;
+        };
+        std::vector<Entry> rows;
+    };
+    mutable std::mutex _delimiterClassCacheLock;
+    mutable std::unique_ptr<DelimiterClassCache> _delimiterClassCache;
+
+    friend class ROW;
+    friend class BufferSnapshot;
+
 #ifdef UNIT_TESTING
     friend class TextBufferTests;
     friend class UiaTextRangeTests;
@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "textBufferRowRuns.hpp"
+#include "textBuffer.hpp"
+
+// Routine Description:
+// - Splits the columns [origin.X, endColumn) of the row at origin.Y into runs of glyphs.
+// Arguments:
+// - buffer - The buffer to read from.
+// - origin - The row and the first column to read.
+// - endColumn - The column after the last one to read. It's clamped to the width of the row.
+void TextBufferRowRuns::Load(const TextBuffer& buffer, const til::point origin, const til::CoordType endColumn)
+{
+    _glyphs.clear();
+    _pendingRuns.clear();
+    _runs.clear();
+
+    if (origin.Y < 0 || origin.Y >= buffer.TotalRowCount())
+    {
+        return;
+    }
+
+    const auto& row = buffer.GetRowByOffset(origin.Y);
+    const auto& charRow = row.GetCharRow();
+    const auto& attrRow = row.GetAttrRow();
+    const auto end = std::min(endColumn, row.size());
+
+    auto x = std::max(origin.X, 0);
+    til::CoordType runStart = 0;
+    for (const auto& run : attrRow.GetRuns())
+    {
+        const auto runEnd = runStart + gsl::narrow_cast<til::CoordType>(run.length);
+        const auto stop = std::min(runEnd, end);
+        runStart = runEnd;
+
+        // The trailing half of a wide glyph at the end of the previous
+        // run may have taken up the entirety of this one already.
+        if (x >= stop)
+        {
+            if (x >= end)
+            {
+                break;
+            }
+            continue;
+        }
+
+        const auto firstGlyph = _glyphs.size();
+        while (x < stop)
+        {
+            const auto dbcsAttr = charRow.DbcsAttrAt(x);
+            const auto columns = dbcsAttr.IsLeading() ? 2 : 1;
+            _glyphs.push_back({ charRow.GlyphAt(x), x, columns, dbcsAttr.IsTrailing() });
+            x += columns;
+        }
+        _pendingRuns.push_back({ &attrRow.GetAttrById(run.value), firstGlyph, _glyphs.size() - firstGlyph });
+    }
+
+    // _glyphs doesn't grow anymore, so the runs can point into it now.
+    _runs.reserve(_pendingRuns.size());
+    for (const auto& pending : _pendingRuns)
+    {
+        _runs.push_back({ pending.attr, gsl::span<const Glyph>{ _glyphs }.subspan(pending.firstGlyph, pending.glyphCount) });
+    }
+}
+
+gsl::span<const TextBufferRowRuns::Run> TextBufferRowRuns::Runs() const noexcept
+{
+    return _runs;
+}
@@ -0,0 +1,61 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- textBufferRowRuns.hpp
+
+Abstract:
+- Splits a part of a row into its glyphs, grouped into runs of the same
+  attributes. Unlike TextBufferCellIterator it doesn't build a view of every
+  cell: The attributes are taken from the row's runs, and the glyphs are
+  views right into the row's storage.
+- A wide glyph always belongs to the run of its leading half. If the part of
+  the row starts with a trailing half, that half is a glyph of its own, which
+  is marked as such.
+- The glyphs are only valid for as long as the buffer isn't modified.
+  Instances are meant to be reused, so that Load() doesn't need to allocate.
+--*/
+
+#pragma once
+
+#include "TextAttribute.hpp"
+
+class TextBuffer;
+
+class TextBufferRowRuns final
+{
+public:
+    struct Glyph
+    {
+        std::wstring_view text;
+        til::CoordType column;
+        // 2 for the leading half of a wide glyph, even if the
+        // trailing half is past the end of the loaded columns.
+        til::CoordType columns;
+        // Whether this is the trailing half of a wide glyph, without its leading half.
+        bool trailingHalf;
+    };
+
+    struct Run
+    {
+        const TextAttribute* attr;
+        gsl::span<const Glyph> glyphs;
+    };
+
+    void Load(const TextBuffer& buffer, const til::point origin, const til::CoordType endColumn);
+
+    gsl::span<const Run> Runs() const noexcept;
+
+private:
+    struct PendingRun
+    {
+        const TextAttribute* attr;
+        size_t firstGlyph;
+        size_t glyphCount;
+    };
+
+    std::vector<Glyph> _glyphs;
+    std::vector<PendingRun> _pendingRuns;
+    std::vector<Run> _runs;
+};
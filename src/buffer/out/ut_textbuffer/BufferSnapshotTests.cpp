@@ -0,0 +1,150 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../BufferSnapshot.hpp"
+#include "../textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class BufferSnapshotTests
+{
+    TEST_CLASS(BufferSnapshotTests);
+
+    static DummyRenderer renderer;
+
+    static std::unique_ptr<TextBuffer> _createBuffer(const til::size size)
+    {
+        return std::make_unique<TextBuffer>(size, TextAttribute{ 0x7 }, 0, false, renderer);
+    }
+
+    // Fills a buffer with a bit of everything a snapshot stores.
+    static std::unique_ptr<TextBuffer> _createTestBuffer()
+    {
+        auto buffer = _createBuffer({ 20, 5 });
+
+        buffer->Write(OutputCellIterator{ L"Hello" }, { 0, 0 });
+
+        TextAttribute red{ 0x7 };
+        red.SetForeground(RGB(255, 0, 0));
+        buffer->Write(OutputCellIterator{ L"red", red }, { 2, 1 });
+        buffer->GetRowByOffset(1).SetWrapForced(true);
+
+        buffer->Write(OutputCellIterator{ L"\U0001F600x" }, { 0, 2 });
+
+        TextAttribute link{ 0x7 };
+        const auto id = buffer->GetHyperlinkId(L"https://example.com", L"abc");
+        buffer->AddHyperlinkToMap(L"https://example.com", id);
+        link.SetHyperlinkId(id);
+        buffer->Write(OutputCellIterator{ L"link", link }, { 0, 3 });
+        buffer->GetRowByOffset(3).SetLineRendition(LineRendition::DoubleWidth);
+
+        buffer->GetCursor().SetPosition({ 3, 4 });
+        return buffer;
+    }
+
+    TEST_METHOD(RestoresEverything)
+    {
+        const auto source = _createTestBuffer();
+        const auto data = BufferSnapshot::Create(*source);
+        const BufferSnapshot snapshot{ data };
+        VERIFY_ARE_EQUAL(20, snapshot.GetSize().width);
+        VERIFY_ARE_EQUAL(5, snapshot.GetSize().height);
+
+        const auto target = _createBuffer(snapshot.GetSize());
+        snapshot.Restore(*target);
+
+        for (til::CoordType y = 0; y < 5; y++)
+        {
+            const auto& sourceRow = source->GetRowByOffset(y);
+            const auto& targetRow = target->GetRowByOffset(y);
+            VERIFY_ARE_EQUAL(sourceRow.GetText(), targetRow.GetText());
+            VERIFY_ARE_EQUAL(sourceRow.WasWrapForced(), targetRow.WasWrapForced());
+            VERIFY_ARE_EQUAL(static_cast<int>(sourceRow.GetLineRendition()), static_cast<int>(targetRow.GetLineRendition()));
+            for (til::CoordType x = 0; x < 20; x++)
+            {
+                VERIFY_ARE_EQUAL(sourceRow.GetAttrRow().GetAttrByColumn(x), targetRow.GetAttrRow().GetAttrByColumn(x));
+                VERIFY_ARE_EQUAL(std::wstring_view{ sourceRow.GetCharRow().GlyphAt(x) }, std::wstring_view{ targetRow.GetCharRow().GlyphAt(x) });
+                VERIFY_IS_TRUE(sourceRow.GetCharRow().DbcsAttrAt(x) == targetRow.GetCharRow().DbcsAttrAt(x));
+            }
+        }
+
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\U0001F600" }, std::wstring_view{ target->GetRowByOffset(2).GetCharRow().GlyphAt(0) });
+
+        const auto id = target->GetRowByOffset(3).GetAttrRow().GetAttrByColumn(0).GetHyperlinkId();
+        VERIFY_ARE_EQUAL(L"https://example.com", target->GetHyperlinkUriFromId(id));
+        VERIFY_ARE_EQUAL(source->GetCustomIdFromId(id), target->GetCustomIdFromId(id));
+        VERIFY_ARE_EQUAL(size_t{ 1 }, target->GetAttributeTable().GetHyperlinkReferences(id));
+        VERIFY_ARE_EQUAL(id, target->GetHyperlinkId(L"https://example.com", L"abc"));
+
+        VERIFY_ARE_EQUAL(til::point(3, 4), target->GetCursor().GetPosition());
+    }
+
+    TEST_METHOD(RestoresRangesOfRows)
+    {
+        const auto source = _createTestBuffer();
+        const auto data = BufferSnapshot::Create(*source);
+        const BufferSnapshot snapshot{ data };
+
+        const auto target = _createBuffer(snapshot.GetSize());
+        snapshot.RestoreProperties(*target);
+        snapshot.RestoreRows(*target, 1, 3);
+
+        VERIFY_ARE_EQUAL(std::wstring(20, L' '), target->GetRowByOffset(0).GetText());
+        VERIFY_ARE_EQUAL(source->GetRowByOffset(1).GetText(), target->GetRowByOffset(1).GetText());
+        VERIFY_ARE_EQUAL(source->GetRowByOffset(2).GetText(), target->GetRowByOffset(2).GetText());
+        VERIFY_ARE_EQUAL(std::wstring(20, L' '), target->GetRowByOffset(3).GetText());
+
+        snapshot.RestoreRows(*target, 0, 5);
+        VERIFY_ARE_EQUAL(source->GetRowByOffset(0).GetText(), target->GetRowByOffset(0).GetText());
+        VERIFY_ARE_EQUAL(source->GetRowByOffset(3).GetText(), target->GetRowByOffset(3).GetText());
+
+        VERIFY_THROWS(snapshot.RestoreRows(*target, 4, 6), std::exception);
+    }
+
+    TEST_METHOD(TrimsBlankCells)
+    {
+        const auto source = _createBuffer({ 120, 1000 });
+        const auto data = BufferSnapshot::Create(*source);
+
+        // A blank row only needs its header, one run of attributes and its offset.
+        Log::Comment(String().Format(L"%zu bytes for 1000 blank rows", data.size()));
+        VERIFY_IS_LESS_THAN(data.size(), size_t{ 1000 * 40 });
+    }
+
+    TEST_METHOD(RejectsInvalidSnapshots)
+    {
+        const auto source = _createTestBuffer();
+        auto data = BufferSnapshot::Create(*source);
+
+        Log::Comment(L"A snapshot can only be restored into a buffer of the same size.");
+        {
+            const BufferSnapshot snapshot{ data };
+            const auto target = _createBuffer({ 21, 5 });
+            VERIFY_THROWS(snapshot.Restore(*target), std::exception);
+        }
+
+        Log::Comment(L"Truncated snapshots are rejected once the missing data is needed.");
+        {
+            const auto truncated = gsl::span<const std::byte>{ data }.first(data.size() - 4);
+            const BufferSnapshot snapshot{ truncated };
+            const auto target = _createBuffer(snapshot.GetSize());
+            VERIFY_THROWS(snapshot.RestoreRows(*target, 4, 5), std::exception);
+            VERIFY_THROWS(BufferSnapshot{ gsl::span<const std::byte>{ data }.first(16) }, std::exception);
+        }
+
+        Log::Comment(L"Snapshots of other formats are rejected.");
+        {
+            data[0] = std::byte{ 0 };
+            VERIFY_THROWS(BufferSnapshot{ data }, std::exception);
+        }
+    }
+};
+
+DummyRenderer BufferSnapshotTests::renderer{};
@@ -851,6 +851,84 @@ class ReflowTests
             _compareTextBufferAgainstTestBuffer(*textBuffer, testBuffer);
         }
     }
+
+    TEST_METHOD(TestReflowLongBufferRoundTrip)
+    {
+        // Enough rows for Reflow to split the buffer into chunks that are reflowed on multiple threads.
+        static constexpr til::CoordType rows = 20000;
+        static constexpr til::CoordType width = 20;
+
+        TextBuffer original{ { width, rows }, TextAttribute{ 0x7 }, 0, false, renderer };
+        for (til::CoordType y = 0; y < rows; ++y)
+        {
+            // Every 10th row is wrapped and thus joined with the next one into one logical line.
+            const auto wrap = y % 10 == 0 && y + 1 < rows;
+            const std::wstring text(wrap ? width : y % (width - 1) + 1, gsl::narrow_cast<wchar_t>(L'a' + y % 26));
+            original.WriteLine(OutputCellIterator{ text }, { 0, y }, wrap);
+        }
+        original.GetCursor().SetPosition({ 0, rows - 1 });
+
+        auto narrow{ _textBufferByReflowingTextBuffer(original, { 7, rows * 4 }) };
+        auto roundTrip{ _textBufferByReflowingTextBuffer(*narrow, { width, rows }) };
+
+        VERIFY_ARE_EQUAL(original.GetCursor().GetPosition(), roundTrip->GetCursor().GetPosition());
+        for (til::CoordType y = 0; y < rows; ++y)
+        {
+            const auto& expected = original.GetRowByOffset(y);
+            const auto& actual = roundTrip->GetRowByOffset(y);
+            if (expected.GetText() != actual.GetText() || expected.WasWrapForced() != actual.WasWrapForced())
+            {
+                VERIFY_FAIL(NoThrowString().Format(L"Row %d differs after the round trip", y));
+            }
+        }
+    }
+
+    TEST_METHOD(TestReflowSkipsRowsThatScrollOut)
+    {
+        static constexpr til::CoordType rows = 400;
+        static constexpr til::CoordType width = 20;
+
+        TextBuffer original{ { width, rows }, TextAttribute{ 0x7 }, 0, false, renderer };
+        for (til::CoordType y = 0; y < rows; ++y)
+        {
+            const auto wrap = y % 10 == 0 && y + 1 < rows;
+            const std::wstring text(wrap ? width : y % (width - 1) + 1, gsl::narrow_cast<wchar_t>(L'a' + y % 26));
+            original.WriteLine(OutputCellIterator{ text }, { 0, y }, wrap);
+        }
+        original.GetCursor().SetPosition({ 0, rows - 1 });
+
+        // Reflowing into a buffer of the same height but a smaller width makes
+        // the top rows scroll out. Reflow doesn't need to reflow them, but the
+        // result must be the same as if it did: the bottom of a buffer that's
+        // tall enough for all rows, with the positions reported at the last row
+        // once the buffer is full.
+        const auto reflow = [&](const til::CoordType height, TextBuffer::PositionInformation& positions) {
+            auto buffer = std::make_unique<TextBuffer>(til::size{ 7, height }, TextAttribute{ 0x7 }, 0, false, renderer);
+            positions = { rows - 30, rows - 100 };
+            VERIFY_SUCCEEDED(TextBuffer::Reflow(original, *buffer, std::nullopt, { positions }));
+            return buffer;
+        };
+        TextBuffer::PositionInformation expectedPositions;
+        TextBuffer::PositionInformation actualPositions;
+        const auto expected{ reflow(rows * 4, expectedPositions) };
+        const auto actual{ reflow(rows, actualPositions) };
+
+        const auto expectedCursor = expected->GetCursor().GetPosition();
+        const auto scrolledOut = expectedCursor.Y - (rows - 1);
+        VERIFY_IS_GREATER_THAN(scrolledOut, 0);
+        VERIFY_ARE_EQUAL(til::point(expectedCursor.X, rows - 1), actual->GetCursor().GetPosition());
+        VERIFY_ARE_EQUAL(std::min(expectedPositions.mutableViewportTop, rows - 1), actualPositions.mutableViewportTop);
+        VERIFY_ARE_EQUAL(std::min(expectedPositions.visibleViewportTop, rows - 1), actualPositions.visibleViewportTop);
+        for (til::CoordType y = 0; y < rows; ++y)
+        {
+            const auto& expectedRow = expected->GetRowByOffset(y + scrolledOut);
+            const auto& actualRow = actual->GetRowByOffset(y);
+            if (expectedRow.GetText() != actualRow.GetText() || expectedRow.WasWrapForced() != actualRow.WasWrapForced())
+            {
+                VERIFY_FAIL(NoThrowString().Format(L"Row %d differs from the full reflow", y));
+            }
+        }
+    }
 };
 
 DummyRenderer ReflowTests::renderer{};
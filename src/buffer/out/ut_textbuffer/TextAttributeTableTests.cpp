@@ -0,0 +1,170 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../AttrRow.hpp"
+#include "../TextAttributeTable.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class TextAttributeTableTests
+{
+    TEST_CLASS(TextAttributeTableTests);
+
+    TEST_METHOD(InternsEqualAttributesOnce)
+    {
+        TextAttributeTable table;
+        VERIFY_ARE_EQUAL(size_t{ 1 }, table.Size());
+        VERIFY_ARE_EQUAL(TextAttributeTable::DefaultId, table.Intern(TextAttribute{}));
+
+        TextAttribute red{ RGB(255, 0, 0), RGB(0, 0, 0) };
+        TextAttribute blue{ RGB(0, 0, 255), RGB(0, 0, 0) };
+
+        const auto redId = table.Intern(red);
+        const auto blueId = table.Intern(blue);
+        VERIFY_ARE_NOT_EQUAL(redId, blueId);
+        VERIFY_ARE_EQUAL(redId, table.Intern(red));
+        VERIFY_ARE_EQUAL(size_t{ 3 }, table.Size());
+
+        VERIFY_ARE_EQUAL(red, table.Get(redId));
+        VERIFY_ARE_EQUAL(blue, table.Get(blueId));
+    }
+
+    TEST_METHOD(CopiesRowsAcrossTables)
+    {
+        TextAttributeTable tableA;
+        TextAttributeTable tableB;
+
+        TextAttribute red{ RGB(255, 0, 0), RGB(0, 0, 0) };
+        TextAttribute blue{ RGB(0, 0, 255), RGB(0, 0, 0) };
+
+        // Intern blue first into B, so that the ids differ between the two tables.
+        tableB.Intern(blue);
+
+        ATTR_ROW rowA{ 10, TextAttribute{}, &tableA };
+        rowA.Replace(2, 5, red);
+        rowA.Replace(5, 7, blue);
+
+        ATTR_ROW rowB{ 10, TextAttribute{}, &tableB };
+        rowB = rowA;
+
+        VERIFY_IS_TRUE(rowA == rowB);
+        for (til::CoordType i = 0; i < 10; ++i)
+        {
+            VERIFY_ARE_EQUAL(rowA.GetAttrByColumn(i), rowB.GetAttrByColumn(i));
+        }
+        VERIFY_ARE_EQUAL(red, rowB.GetAttrByColumn(3));
+        VERIFY_ARE_EQUAL(blue, rowB.GetAttrByColumn(6));
+    }
+
+    TEST_METHOD(HoldsMoreThan16BitsOfAttributes)
+    {
+        TextAttributeTable table;
+
+        // More attributes than a 16-bit index could refer to. None of them may be lost.
+        static constexpr size_t count = 70000;
+        std::vector<TextAttributeTable::id_type> ids;
+        ids.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            ids.emplace_back(table.Intern(TextAttribute{ gsl::narrow_cast<COLORREF>(i + 1), RGB(0, 0, 0) }));
+        }
+
+        VERIFY_ARE_EQUAL(count + 1, table.Size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            VERIFY_ARE_EQUAL(TextAttribute(gsl::narrow_cast<COLORREF>(i + 1), RGB(0, 0, 0)), table.Get(til::at(ids, i)));
+        }
+
+        Log::Comment(L"Once compacted, the table must grow by as much as is still live before it's compacted again.");
+        VERIFY_IS_TRUE(table.NeedsCompaction());
+        table.SetCompactionThreshold(table.Size());
+        VERIFY_IS_FALSE(table.NeedsCompaction());
+
+        for (size_t i = 0; table.Size() < 2 * (count + 1) - 1; ++i)
+        {
+            table.Intern(TextAttribute{ RGB(0, 0, 0), gsl::narrow_cast<COLORREF>(i + 1) });
+        }
+        VERIFY_IS_FALSE(table.NeedsCompaction());
+        table.Intern(TextAttribute{ RGB(0, 0, 0), RGB(255, 255, 255) });
+        VERIFY_IS_TRUE(table.NeedsCompaction());
+    }
+
+    TEST_METHOD(ReplaceRunsMatchesReplace)
+    {
+        TextAttributeTable table;
+
+        TextAttribute red{ RGB(255, 0, 0), RGB(0, 0, 0) };
+        TextAttribute blue{ RGB(0, 0, 255), RGB(0, 0, 0) };
+
+        ATTR_ROW expected{ 10, TextAttribute{}, &table };
+        expected.Replace(0, 4, blue);
+        expected.Replace(4, 9, red);
+        expected.Replace(1, 2, red);
+        expected.Replace(2, 3, blue);
+        expected.Replace(3, 5, TextAttribute{});
+
+        ATTR_ROW actual{ 10, TextAttribute{}, &table };
+        actual.Replace(0, 4, blue);
+        actual.Replace(4, 9, red);
+        const std::array<ATTR_ROW::attr_run, 3> runs{ {
+            { red, uint16_t{ 1 } },
+            { blue, uint16_t{ 1 } },
+            { TextAttribute{}, uint16_t{ 2 } },
+        } };
+        actual.ReplaceRuns(1, runs);
+
+        VERIFY_IS_TRUE(expected == actual);
+        VERIFY_ARE_EQUAL(expected.GetRuns().size(), actual.GetRuns().size());
+        for (til::CoordType i = 0; i < 10; ++i)
+        {
+            VERIFY_ARE_EQUAL(expected.GetAttrByColumn(i), actual.GetAttrByColumn(i));
+        }
+    }
+
+    TEST_METHOD(RowWritesCountHyperlinkReferences)
+    {
+        TextAttributeTable table;
+
+        TextAttribute link1;
+        link1.SetHyperlinkId(1);
+        TextAttribute link2;
+        link2.SetHyperlinkId(2);
+        auto redLink1 = link1;
+        redLink1.SetForeground(RGB(255, 0, 0));
+
+        ATTR_ROW row{ 10, TextAttribute{}, &table };
+        row.Replace(0, 2, link1);
+        row.Replace(4, 6, link2);
+        VERIFY_ARE_EQUAL(size_t{ 1 }, table.GetHyperlinkReferences(1));
+        VERIFY_ARE_EQUAL(size_t{ 1 }, table.GetHyperlinkReferences(2));
+
+        // Runs are counted, not rows.
+        row.Replace(2, 3, redLink1);
+        VERIFY_ARE_EQUAL(size_t{ 2 }, table.GetHyperlinkReferences(1));
+
+        ATTR_ROW copy{ row };
+        VERIFY_ARE_EQUAL(size_t{ 4 }, table.GetHyperlinkReferences(1));
+        VERIFY_ARE_EQUAL(size_t{ 2 }, table.GetHyperlinkReferences(2));
+
+        // Overwriting a hyperlink with plain text, or cutting it off, drops its references.
+        row.Replace(0, 3, TextAttribute{});
+        copy.Resize(4);
+        VERIFY_ARE_EQUAL(size_t{ 2 }, table.GetHyperlinkReferences(1));
+        VERIFY_ARE_EQUAL(size_t{ 1 }, table.GetHyperlinkReferences(2));
+
+        row = copy;
+        VERIFY_ARE_EQUAL(size_t{ 4 }, table.GetHyperlinkReferences(1));
+        VERIFY_ARE_EQUAL(size_t{ 0 }, table.GetHyperlinkReferences(2));
+
+        row.SetAttrToEnd(0, TextAttribute{});
+        copy.ReleaseHyperlinks();
+        VERIFY_ARE_EQUAL(size_t{ 0 }, table.GetHyperlinkReferences(1));
+        VERIFY_IS_TRUE(row.GetHyperlinks().empty());
+    }
+};
@@ -25,6 +25,7 @@ class TextAttributeTests
     TEST_METHOD(TestReverseDefaultColors);
     TEST_METHOD(TestRoundtripDefaultColors);
     TEST_METHOD(TestIntenseAsBright);
+    TEST_METHOD(TestResolvedColorsFollowSettings);
 
     RenderSettings _renderSettings;
     const COLORREF _defaultFg = RGB(1, 2, 3);
@@ -75,7 +76,7 @@ void TextAttributeTests::TestRoundtripMetaBits()
         auto attr = TextAttribute(expectedLegacy);
         VERIFY_IS_TRUE(attr.IsLegacy());
         VERIFY_ARE_EQUAL(expectedLegacy, attr.GetLegacyAttributes());
-        VERIFY_ARE_EQUAL(flag, attr._wAttrLegacy);
+        VERIFY_ARE_EQUAL(flag, attr._GetMetaAttrs());
     }
 }
 
@@ -325,3 +326,38 @@ void TextAttributeTests::TestIntenseAsBright()
     // Restore the default IntenseIsBright mode.
     _renderSettings.SetRenderMode(RenderSettings::Mode::IntenseIsBright, true);
 }
+
+void TextAttributeTests::TestResolvedColorsFollowSettings()
+{
+    RenderSettings renderSettings;
+    renderSettings.SetColorAlias(ColorAlias::DefaultForeground, _defaultFgIndex, _defaultFg);
+    renderSettings.SetColorAlias(ColorAlias::DefaultBackground, _defaultBgIndex, _defaultBg);
+    const auto red = RGB(255, 0, 0);
+    const auto green = RGB(0, 255, 0);
+
+    TextAttribute attr{};
+    attr.SetIndexedForeground(TextColor::DARK_RED);
+    renderSettings.SetColorTableEntry(TextColor::DARK_RED, red);
+    VERIFY_ARE_EQUAL(std::make_pair(red, _defaultBg), renderSettings.GetAttributeColors(attr));
+
+    Log::Comment(L"The resolved colors are updated when the color table changes");
+    renderSettings.SetColorTableEntry(TextColor::DARK_RED, green);
+    VERIFY_ARE_EQUAL(std::make_pair(green, _defaultBg), renderSettings.GetAttributeColors(attr));
+
+    Log::Comment(L"The resolved colors are updated when a color alias changes");
+    renderSettings.SetColorAliasIndex(ColorAlias::DefaultBackground, TextColor::DARK_RED);
+    VERIFY_ARE_EQUAL(std::make_pair(green, green), renderSettings.GetAttributeColors(attr));
+    renderSettings.SetColorAliasIndex(ColorAlias::DefaultBackground, _defaultBgIndex);
+
+    Log::Comment(L"The resolved colors are updated when a render mode changes");
+    renderSettings.SetRenderMode(RenderSettings::Mode::ScreenReversed, true);
+    VERIFY_ARE_EQUAL(std::make_pair(_defaultBg, green), renderSettings.GetAttributeColors(attr));
+    renderSettings.SetRenderMode(RenderSettings::Mode::ScreenReversed, false);
+    VERIFY_ARE_EQUAL(std::make_pair(green, _defaultBg), renderSettings.GetAttributeColors(attr));
+
+    Log::Comment(L"Attributes that only differ in their rendition are resolved separately");
+    auto faint = attr;
+    faint.SetFaint(true);
+    VERIFY_ARE_EQUAL(std::make_pair(RGB(0, 127, 0), _defaultBg), renderSettings.GetAttributeColors(faint));
+    VERIFY_ARE_EQUAL(std::make_pair(green, _defaultBg), renderSettings.GetAttributeColors(attr));
+}
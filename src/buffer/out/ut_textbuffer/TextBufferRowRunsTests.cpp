@@ -0,0 +1,87 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../textBuffer.hpp"
+#include "../textBufferRowRuns.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class TextBufferRowRunsTests
+{
+    TEST_CLASS(TextBufferRowRunsTests);
+
+    static DummyRenderer renderer;
+
+    TEST_METHOD(GroupsGlyphsByAttributes)
+    {
+        TextBuffer buffer{ { 10, 2 }, TextAttribute{ 0x7 }, 0, false, renderer };
+        const TextAttribute red{ FOREGROUND_RED };
+        const TextAttribute green{ FOREGROUND_GREEN };
+
+        // "ab" in red, followed by a wide glyph and a "c" in green.
+        buffer.Write({ L"ab", red }, { 0, 0 }, false);
+        buffer.Write({ L"\x3042" L"c", green }, { 2, 0 }, false);
+
+        TextBufferRowRuns rowRuns;
+        rowRuns.Load(buffer, { 0, 0 }, 10);
+
+        const auto runs = rowRuns.Runs();
+        VERIFY_ARE_EQUAL(3u, runs.size());
+
+        VERIFY_ARE_EQUAL(red, *runs[0].attr);
+        VERIFY_ARE_EQUAL(2u, runs[0].glyphs.size());
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"b" }, runs[0].glyphs[1].text);
+        VERIFY_ARE_EQUAL(1, runs[0].glyphs[1].column);
+
+        VERIFY_ARE_EQUAL(green, *runs[1].attr);
+        VERIFY_ARE_EQUAL(2u, runs[1].glyphs.size());
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\x3042" }, runs[1].glyphs[0].text);
+        VERIFY_ARE_EQUAL(2, runs[1].glyphs[0].column);
+        VERIFY_ARE_EQUAL(2, runs[1].glyphs[0].columns);
+        VERIFY_IS_FALSE(runs[1].glyphs[0].trailingHalf);
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"c" }, runs[1].glyphs[1].text);
+        VERIFY_ARE_EQUAL(4, runs[1].glyphs[1].column);
+
+        // The rest of the row is still blank.
+        VERIFY_ARE_EQUAL(TextAttribute{ 0x7 }, *runs[2].attr);
+        VERIFY_ARE_EQUAL(5u, runs[2].glyphs.size());
+    }
+
+    TEST_METHOD(StartsWithTrailingHalf)
+    {
+        TextBuffer buffer{ { 10, 2 }, TextAttribute{ 0x7 }, 0, false, renderer };
+        buffer.Write({ L"a\x3042" L"b" }, { 0, 0 }, false);
+
+        TextBufferRowRuns rowRuns;
+        rowRuns.Load(buffer, { 2, 0 }, 4);
+
+        const auto runs = rowRuns.Runs();
+        VERIFY_ARE_EQUAL(1u, runs.size());
+        VERIFY_ARE_EQUAL(2u, runs[0].glyphs.size());
+        VERIFY_ARE_EQUAL(2, runs[0].glyphs[0].column);
+        VERIFY_ARE_EQUAL(1, runs[0].glyphs[0].columns);
+        VERIFY_IS_TRUE(runs[0].glyphs[0].trailingHalf);
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"b" }, runs[0].glyphs[1].text);
+    }
+
+    TEST_METHOD(OutOfRangeRowIsEmpty)
+    {
+        TextBuffer buffer{ { 10, 2 }, TextAttribute{ 0x7 }, 0, false, renderer };
+
+        TextBufferRowRuns rowRuns;
+        rowRuns.Load(buffer, { 0, 0 }, 10);
+        VERIFY_ARE_EQUAL(1u, rowRuns.Runs().size());
+
+        rowRuns.Load(buffer, { 0, 2 }, 10);
+        VERIFY_ARE_EQUAL(0u, rowRuns.Runs().size());
+    }
+};
+
+DummyRenderer TextBufferRowRunsTests::renderer{};
@@ -18,17 +18,16 @@ class UnicodeStorageTests
     TEST_METHOD(CanOverwriteEmoji)
     {
         UnicodeStorage storage;
-        const til::point coord{ 1, 3 };
+        const til::CoordType column = 3;
         const std::vector<wchar_t> newMoon{ 0xD83C, 0xDF11 };
         const std::vector<wchar_t> fullMoon{ 0xD83C, 0xDF15 };
 
         // store initial glyph
-        storage.StoreGlyph(coord, newMoon);
+        storage.StoreGlyph(column, newMoon);
 
         // verify it was stored
-        auto findIt = storage._map.find(coord);
-        VERIFY_ARE_NOT_EQUAL(findIt, storage._map.end());
-        const auto& newMoonGlyph = findIt->second;
+        VERIFY_ARE_EQUAL(1u, storage.size());
+        const auto& newMoonGlyph = storage.GetText(column);
         VERIFY_ARE_EQUAL(newMoonGlyph.size(), newMoon.size());
         for (size_t i = 0; i < newMoon.size(); ++i)
         {
@@ -36,16 +35,53 @@ class UnicodeStorageTests
         }
 
         // overwrite it
-        storage.StoreGlyph(coord, fullMoon);
+        storage.StoreGlyph(column, fullMoon);
 
         // verify the glyph was overwritten
-        findIt = storage._map.find(coord);
-        VERIFY_ARE_NOT_EQUAL(findIt, storage._map.end());
-        const auto& fullMoonGlyph = findIt->second;
+        VERIFY_ARE_EQUAL(1u, storage.size());
+        const auto& fullMoonGlyph = storage.GetText(column);
         VERIFY_ARE_EQUAL(fullMoonGlyph.size(), fullMoon.size());
         for (size_t i = 0; i < fullMoon.size(); ++i)
         {
             VERIFY_ARE_EQUAL(fullMoonGlyph.at(i), fullMoon.at(i));
         }
     }
+
+    TEST_METHOD(TruncateDropsGlyphsBeyondWidth)
+    {
+        UnicodeStorage storage;
+        const std::vector<wchar_t> newMoon{ 0xD83C, 0xDF11 };
+        const std::vector<wchar_t> fullMoon{ 0xD83C, 0xDF15 };
+
+        // store them out of order, they must still be found by column
+        storage.StoreGlyph(10, fullMoon);
+        storage.StoreGlyph(2, newMoon);
+        VERIFY_ARE_EQUAL(2u, storage.size());
+        VERIFY_IS_TRUE(storage.GetText(2) == newMoon);
+        VERIFY_IS_TRUE(storage.GetText(10) == fullMoon);
+
+        // a row width of 10 ends right before the full moon
+        storage.Truncate(10);
+        VERIFY_ARE_EQUAL(1u, storage.size());
+        VERIFY_IS_TRUE(storage.GetText(2) == newMoon);
+        VERIFY_THROWS(storage.GetText(10), std::exception);
+
+        storage.Erase(2);
+        VERIFY_IS_TRUE(storage.empty());
+    }
+
+    TEST_METHOD(MemoryUsageCountsGlyphs)
+    {
+        UnicodeStorage storage;
+        VERIFY_ARE_EQUAL(0u, storage.GetMemoryUsage());
+
+        const std::vector<wchar_t> newMoon{ 0xD83C, 0xDF11 };
+        storage.StoreGlyph(2, newMoon);
+        const auto one = storage.GetMemoryUsage();
+        // at least the entry and its 2 characters
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(one, sizeof(std::pair<til::CoordType, std::vector<wchar_t>>) + 2 * sizeof(wchar_t));
+
+        storage.StoreGlyph(4, newMoon);
+        VERIFY_IS_GREATER_THAN(storage.GetMemoryUsage(), one);
+    }
 };
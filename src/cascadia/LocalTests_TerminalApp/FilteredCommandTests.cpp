@@ -26,6 +26,7 @@ namespace TerminalAppLocalTests
         TEST_METHOD(VerifyWeight);
         TEST_METHOD(VerifyCompare);
         TEST_METHOD(VerifyCompareIgnoreCase);
+        TEST_METHOD(VerifyExtendedFilter);
     };
 
     void FilteredCommandTests::VerifyHighlighting()
@@ -213,6 +214,36 @@ namespace TerminalAppLocalTests
         VERIFY_SUCCEEDED(result);
     }
 
+    void FilteredCommandTests::VerifyExtendedFilter()
+    {
+        auto result = RunOnUIThread([]() {
+            const auto paletteItem{ winrt::make<winrt::TerminalApp::implementation::CommandLinePaletteItem>(L"Split Pane") };
+            const auto filteredCommand = winrt::make_self<winrt::TerminalApp::implementation::FilteredCommand>(paletteItem);
+
+            Log::Comment(L"Extending a matching filter must update the match");
+            filteredCommand->UpdateFilter(L"s");
+            const auto weight = filteredCommand->Weight();
+            VERIFY_IS_GREATER_THAN(weight, 0);
+            filteredCommand->UpdateFilter(L"sp");
+            VERIFY_IS_GREATER_THAN(filteredCommand->Weight(), weight);
+            VERIFY_ARE_EQUAL(2u, filteredCommand->HighlightedName().Segments().Size());
+
+            Log::Comment(L"Extending a filter that doesn't match must not match either");
+            filteredCommand->UpdateFilter(L"spx");
+            VERIFY_ARE_EQUAL(0, filteredCommand->Weight());
+            filteredCommand->UpdateFilter(L"spxp");
+            VERIFY_ARE_EQUAL(0, filteredCommand->Weight());
+            VERIFY_ARE_EQUAL(1u, filteredCommand->HighlightedName().Segments().Size());
+            VERIFY_IS_FALSE(filteredCommand->HighlightedName().Segments().GetAt(0).IsHighlighted());
+
+            Log::Comment(L"Shrinking the filter must match again");
+            filteredCommand->UpdateFilter(L"SP");
+            VERIFY_IS_GREATER_THAN(filteredCommand->Weight(), 0);
+        });
+
+        VERIFY_SUCCEEDED(result);
+    }
+
     void FilteredCommandTests::VerifyCompareIgnoreCase()
     {
         auto result = RunOnUIThread([]() {
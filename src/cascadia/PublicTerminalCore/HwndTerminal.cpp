@@ -118,7 +118,7 @@ try
             {
                 try
                 {
-                    const auto bufferData = terminal->_terminal->RetrieveSelectedTextFromBuffer(false);
+                    const auto bufferData = terminal->_terminal->RetrieveSelectedTextAndColorRuns(false);
                     LOG_IF_FAILED(terminal->_CopyTextToSystemClipboard(bufferData, true));
                     TerminalClearSelection(terminal);
                 }
@@ -243,6 +243,14 @@ HRESULT HwndTerminal::Initialize()
     _terminal->SetWriteInputCallback([=](std::wstring_view input) noexcept { _WriteTextToConnection(input); });
     localPointerToThread->EnablePainting();
 
+    _outputBatchWork.reset(CreateThreadpoolWork(
+        [](PTP_CALLBACK_INSTANCE, PVOID context, PTP_WORK) noexcept {
+            static_cast<HwndTerminal*>(context)->_DrainOutputBatches();
+        },
+        this,
+        nullptr));
+    RETURN_LAST_ERROR_IF_NULL(_outputBatchWork);
+
     _multiClickTime = std::chrono::milliseconds{ GetDoubleClickTime() };
 
     return S_OK;
@@ -254,6 +262,16 @@ try
     // As a rule, detach resources from the Terminal before shutting them down.
     // This ensures that teardown is reentrant.
 
+    // Batches that haven't started yet are completed with E_ABORT. Destroying
+    // the work waits for the one in progress, which still needs the renderer.
+    wil::unique_threadpool_work outputBatchWork;
+    {
+        const std::lock_guard guard{ _outputBatchLock };
+        _outputBatchCanceled = true;
+        outputBatchWork = std::move(_outputBatchWork);
+    }
+    outputBatchWork.reset();
+
     // Shut down the renderer (and therefore the thread) before we implode
     if (auto localRenderEngine{ std::exchange(_renderEngine, nullptr) })
     {
@@ -378,6 +396,108 @@ void HwndTerminal::SendOutput(std::wstring_view data)
     _terminal->Write(data);
 }
 
+// Method Description:
+// - Writes UTF-8 output into the terminal, without requiring the caller to
+//   convert it to UTF-16 first.
+// Arguments:
+// - data: the output. A UTF-8 sequence may be split between two calls.
+// - plainText: if true, the output is known to contain no control sequences
+//   and is written into the buffer without going through the parser.
+// Return Value:
+// - S_OK, or an error if the output couldn't be converted.
+HRESULT HwndTerminal::SendOutputUtf8(std::string_view data, const bool plainText) noexcept
+try
+{
+    // The output is converted and written in slices. This bounds the size of
+    // the UTF-16 copy and gives the renderer a chance to paint in between.
+    static constexpr size_t sliceSize = 128 * 1024;
+
+    const std::lock_guard guard{ _utf8OutputLock };
+    while (!data.empty())
+    {
+        const auto slice = data.substr(0, sliceSize);
+        data = data.substr(slice.size());
+
+        RETURN_IF_FAILED(til::u8u16(slice, _utf8OutputBuffer, _utf8OutputState));
+        if (plainText)
+        {
+            _terminal->WritePlainText(_utf8OutputBuffer);
+        }
+        else
+        {
+            _terminal->Write(_utf8OutputBuffer);
+        }
+    }
+    return S_OK;
+}
+CATCH_RETURN();
+
+// Method Description:
+// - Queues UTF-8 output to be written into the terminal on a background
+//   thread. Batches are written in the order they were submitted.
+// Arguments:
+// - chunks: the output. The memory they point to must stay valid until the
+//   callback was invoked.
+// - plainText: see SendOutputUtf8.
+// - callback: invoked on the background thread once the batch was written,
+//   with the result of writing it.
+// Return Value:
+// - S_OK if the batch was queued, E_ABORT if the terminal is being destroyed.
+HRESULT HwndTerminal::SendOutputBatch(std::vector<TerminalOutputChunk> chunks, const bool plainText, std::function<void(HRESULT)> callback)
+{
+    const std::lock_guard guard{ _outputBatchLock };
+    RETURN_HR_IF(E_ABORT, _outputBatchCanceled || !_outputBatchWork);
+
+    _outputBatches.push_back({ std::move(chunks), plainText, std::move(callback) });
+    if (!std::exchange(_outputBatchDraining, true))
+    {
+        SubmitThreadpoolWork(_outputBatchWork.get());
+    }
+    return S_OK;
+}
+
+// Method Description:
+// - Writes the queued batches one after another, until the queue is empty.
+//   There's only ever one of these running, which keeps the batches in order.
+void HwndTerminal::_DrainOutputBatches() noexcept
+{
+    for (;;)
+    {
+        OutputBatch batch;
+        bool canceled;
+        {
+            const std::lock_guard guard{ _outputBatchLock };
+            if (_outputBatches.empty())
+            {
+                _outputBatchDraining = false;
+                return;
+            }
+            batch = std::move(_outputBatches.front());
+            _outputBatches.pop_front();
+            canceled = _outputBatchCanceled;
+        }
+
+        auto hr = canceled ? E_ABORT : S_OK;
+        for (const auto& chunk : batch.chunks)
+        {
+            if (FAILED(hr))
+            {
+                break;
+            }
+            hr = SendOutputUtf8({ chunk.Data, chunk.Length }, batch.plainText);
+        }
+
+        if (batch.callback)
+        {
+            try
+            {
+                batch.callback(hr);
+            }
+            CATCH_LOG();
+        }
+    }
+}
+
 HRESULT _stdcall CreateTerminal(HWND parentHwnd, _Out_ void** hwnd, _Out_ void** terminal)
 {
     // In order for UIA to hook up properly there needs to be a "static" window hosting the
@@ -426,6 +546,47 @@ void _stdcall TerminalSendOutput(void* terminal, LPCWSTR data)
     publicTerminal->SendOutput(data);
 }
 
+/// <summary>
+/// Writes UTF-8 output into the terminal.
+/// </summary>
+/// <param name="terminal">Terminal pointer.</param>
+/// <param name="data">The output. A UTF-8 sequence may be split between two calls.</param>
+/// <param name="length">The length of the output in bytes.</param>
+/// <param name="plainText">True if the output contains no control sequences other than CR and LF. It's then written without parsing it.</param>
+/// <returns>HRESULT of the attempted write.</returns>
+HRESULT _stdcall TerminalSendOutputUtf8(void* terminal, const char* data, size_t length, bool plainText)
+{
+    RETURN_HR_IF(E_INVALIDARG, !data && length);
+    const auto publicTerminal = static_cast<HwndTerminal*>(terminal);
+    return publicTerminal->SendOutputUtf8({ data, length }, plainText);
+}
+
+/// <summary>
+/// Queues UTF-8 output to be written into the terminal on a background thread.
+/// Batches are written in order, but asynchronously to TerminalSendOutput and TerminalSendOutputUtf8.
+/// </summary>
+/// <param name="terminal">Terminal pointer.</param>
+/// <param name="chunks">The output. The array is copied, but the memory the chunks point to must stay valid until the callback was invoked.</param>
+/// <param name="count">The number of chunks.</param>
+/// <param name="plainText">True if the output contains no control sequences other than CR and LF. It's then written without parsing it.</param>
+/// <param name="callback">Optional. Invoked on the background thread with the result, once the batch was written. It must neither call DestroyTerminal, nor wait for the thread that does.</param>
+/// <param name="context">Passed to the callback.</param>
+/// <returns>HRESULT of queueing the batch. The callback isn't invoked if this fails.</returns>
+HRESULT _stdcall TerminalSendOutputBatch(void* terminal, const TerminalOutputChunk* chunks, size_t count, bool plainText, void __stdcall callback(void*, HRESULT), void* context)
+try
+{
+    RETURN_HR_IF(E_INVALIDARG, !chunks && count);
+    const auto publicTerminal = static_cast<HwndTerminal*>(terminal);
+
+    std::function<void(HRESULT)> completion;
+    if (callback)
+    {
+        completion = [callback, context](HRESULT hr) { callback(context, hr); };
+    }
+    return publicTerminal->SendOutputBatch({ chunks, chunks + count }, plainText, std::move(completion));
+}
+CATCH_RETURN();
+
 /// <summary>
 /// Triggers a terminal resize using the new width and height in pixel.
 /// </summary>
@@ -846,16 +1007,10 @@ void __stdcall TerminalKillFocus(void* terminal)
 // Arguments:
 // - rows - Rows of text data to copy
 // - fAlsoCopyFormatting - true if the color and formatting should also be copied, false otherwise
-HRESULT HwndTerminal::_CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, const bool fAlsoCopyFormatting)
+HRESULT HwndTerminal::_CopyTextToSystemClipboard(const TextBuffer::TextAndColorRuns& rows, const bool fAlsoCopyFormatting)
 try
 {
-    std::wstring finalString;
-
-    // Concatenate strings into one giant string to put onto the clipboard.
-    for (const auto& str : rows.text)
-    {
-        finalString += str;
-    }
+    const auto& finalString = rows.text;
 
     // allocate the final clipboard data
     const auto cchNeeded = finalString.size() + 1;
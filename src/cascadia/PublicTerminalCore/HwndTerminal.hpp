@@ -23,9 +23,18 @@ typedef struct _TerminalTheme
     COLORREF ColorTable[16];
 } TerminalTheme, *LPTerminalTheme;
 
+// A span of UTF-8 output, as submitted with TerminalSendOutputBatch.
+typedef struct _TerminalOutputChunk
+{
+    const char* Data;
+    size_t Length;
+} TerminalOutputChunk, *LPTerminalOutputChunk;
+
 extern "C" {
 __declspec(dllexport) HRESULT _stdcall CreateTerminal(HWND parentHwnd, _Out_ void** hwnd, _Out_ void** terminal);
 __declspec(dllexport) void _stdcall TerminalSendOutput(void* terminal, LPCWSTR data);
+__declspec(dllexport) HRESULT _stdcall TerminalSendOutputUtf8(void* terminal, const char* data, size_t length, bool plainText);
+__declspec(dllexport) HRESULT _stdcall TerminalSendOutputBatch(void* terminal, const TerminalOutputChunk* chunks, size_t count, bool plainText, void __stdcall callback(void*, HRESULT), void* context);
 __declspec(dllexport) void _stdcall TerminalRegisterScrollCallback(void* terminal, void __stdcall callback(int, int, int));
 __declspec(dllexport) HRESULT _stdcall TerminalTriggerResize(_In_ void* terminal, _In_ til::CoordType width, _In_ til::CoordType height, _Out_ til::size* dimensions);
 __declspec(dllexport) HRESULT _stdcall TerminalTriggerResizeWithDimension(_In_ void* terminal, _In_ til::size dimensions, _Out_ til::size* dimensionsInPixels);
@@ -60,6 +69,8 @@ public:
     HRESULT Initialize();
     void Teardown() noexcept;
     void SendOutput(std::wstring_view data);
+    HRESULT SendOutputUtf8(std::string_view data, const bool plainText) noexcept;
+    HRESULT SendOutputBatch(std::vector<TerminalOutputChunk> chunks, const bool plainText, std::function<void(HRESULT)> callback);
     HRESULT Refresh(const til::size windowSize, _Out_ til::size* dimensions);
     void RegisterScrollCallback(std::function<void(int, int, int)> callback);
     void RegisterWriteCallback(const void _stdcall callback(wchar_t*));
@@ -78,6 +89,24 @@ private:
 
     std::unique_ptr<::Microsoft::Terminal::Core::Terminal> _terminal;
 
+    // A UTF-8 sequence may be split across calls, so all UTF-8 output shares
+    // one decoder state. The buffer is reused to avoid an allocation per call.
+    std::mutex _utf8OutputLock;
+    til::u8state _utf8OutputState;
+    std::wstring _utf8OutputBuffer;
+
+    struct OutputBatch
+    {
+        std::vector<TerminalOutputChunk> chunks;
+        bool plainText{ false };
+        std::function<void(HRESULT)> callback;
+    };
+    std::mutex _outputBatchLock;
+    std::deque<OutputBatch> _outputBatches;
+    wil::unique_threadpool_work _outputBatchWork;
+    bool _outputBatchDraining{ false };
+    bool _outputBatchCanceled{ false };
+
     std::unique_ptr<::Microsoft::Console::Render::Renderer> _renderer;
     std::unique_ptr<::Microsoft::Console::Render::DxEngine> _renderEngine;
 
@@ -109,7 +138,8 @@ private:
 
     void _UpdateFont(int newDpi);
     void _WriteTextToConnection(const std::wstring_view text) noexcept;
-    HRESULT _CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, const bool fAlsoCopyFormatting);
+    void _DrainOutputBatches() noexcept;
+    HRESULT _CopyTextToSystemClipboard(const TextBuffer::TextAndColorRuns& rows, const bool fAlsoCopyFormatting);
     HRESULT _CopyToSystemClipboard(std::string stringToCopy, LPCWSTR lpszFormat);
     void _PasteTextFromClipboard() noexcept;
     void _StringPaste(const wchar_t* const pData) noexcept;
@@ -100,11 +100,19 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
             peasant.HideNotificationIconRequested([this](auto&&, auto&&) { _HideNotificationIconRequestedHandlers(*this, nullptr); });
             peasant.QuitAllRequested({ this, &Monarch::_handleQuitAll });
 
+            const auto windowName = peasant.WindowName();
+
             {
                 std::unique_lock lock{ _peasantsMutex };
                 _peasants[newPeasantsId] = peasant;
             }
 
+            if (!windowName.empty())
+            {
+                std::unique_lock lock{ _peasantIdsByNameMutex };
+                _peasantIdsByName.insert_or_assign(std::wstring{ windowName }, newPeasantsId);
+            }
+
             TraceLoggingWrite(g_hRemotingProvider,
                               "Monarch_AddPeasant",
                               TraceLoggingUInt64(providedID, "providedID", "the provided ID for the peasant"),
@@ -306,8 +314,47 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
 
         uint64_t result = 0;
 
+        // Fast path: If we've seen a window with this name before, ask just
+        // that one window whether it still has that name. If it doesn't, or
+        // it died, fall back to asking all of them below.
+        uint64_t cachedId = 0;
+        {
+            std::unique_lock lock{ _peasantIdsByNameMutex };
+            if (const auto it = _peasantIdsByName.find(std::wstring{ name }); it != _peasantIdsByName.end())
+            {
+                cachedId = it->second;
+            }
+        }
+        if (cachedId != 0)
+        {
+            IPeasant cachedPeasant{ nullptr };
+            {
+                std::shared_lock lock{ _peasantsMutex };
+                if (const auto it = _peasants.find(cachedId); it != _peasants.end())
+                {
+                    cachedPeasant = it->second;
+                }
+            }
+
+            try
+            {
+                if (cachedPeasant && cachedPeasant.WindowName() == name)
+                {
+                    result = cachedId;
+                }
+            }
+            CATCH_LOG();
+        }
+
+        // The names we see while walking all peasants, for the cache.
+        std::vector<std::pair<std::wstring, uint64_t>> seenNames;
+
         const auto callback = [&](const auto& id, const auto& p) {
             auto otherName = p.WindowName();
+            if (!otherName.empty())
+            {
+                seenNames.emplace_back(otherName, id);
+            }
             if (otherName == name)
             {
                 result = id;
@@ -324,7 +371,18 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
                               TraceLoggingKeyword(TIL_KEYWORD_TRACE));
         };
 
-        _forEachPeasant(callback, onError);
+        if (result == 0)
+        {
+            _forEachPeasant(callback, onError);
+
+            std::unique_lock lock{ _peasantIdsByNameMutex };
+            // A name that the cache still associates with another window is stale.
+            _peasantIdsByName.erase(std::wstring{ name });
+            for (auto& [seenName, id] : seenNames)
+            {
+                _peasantIdsByName.insert_or_assign(std::move(seenName), id);
+            }
+        }
 
         TraceLoggingWrite(g_hRemotingProvider,
                           "Monarch_lookupPeasantIdForName",
@@ -85,6 +85,13 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         std::shared_mutex _peasantsMutex{};
         std::shared_mutex _mruPeasantsMutex{};
 
+        // A cache of the window names we've seen so far. It's only a hint, as
+        // peasants may rename themselves or die at any time, but it allows
+        // _lookupPeasantIdForName to ask a single peasant instead of all of them.
+        // Never lock this while calling into a peasant.
+        std::unordered_map<std::wstring, uint64_t> _peasantIdsByName;
+        std::mutex _peasantIdsByNameMutex{};
+
         winrt::Microsoft::Terminal::Remoting::IPeasant _getPeasant(uint64_t peasantID, bool clearMruPeasantOnFailure = true);
         uint64_t _getMostRecentPeasantID(bool limitToCurrentDesktop, const bool ignoreQuakeWindow);
         uint64_t _lookupPeasantIdForName(std::wstring_view name);
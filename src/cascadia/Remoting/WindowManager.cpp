@@ -317,6 +317,25 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         // Otherwise, we'll do _nothing_.
     }
 
+    // Method Description:
+    // - Asks the monarch to execute a commandline that wt.exe forwarded to us
+    //   in one of the existing windows. Only the monarch receives these.
+    // Arguments:
+    // - args: The commandline and working directory of the wt.exe process.
+    // Return Value:
+    // - true if an existing window executed the commandline. Otherwise a new
+    //   window is needed, and wt.exe will start a process for it.
+    bool WindowManager::ProposeForwardedCommandline(const Remoting::CommandlineArgs& args)
+    {
+        if (!_isKing || !_monarch)
+        {
+            return false;
+        }
+
+        const auto result = _monarch.ProposeCommandline(args);
+        return !result.ShouldCreateWindow();
+    }
+
     bool WindowManager::ShouldCreateWindow()
     {
         return _shouldCreateWindow;
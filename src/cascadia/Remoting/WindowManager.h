@@ -33,6 +33,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         ~WindowManager();
 
         void ProposeCommandline(const winrt::Microsoft::Terminal::Remoting::CommandlineArgs& args);
+        bool ProposeForwardedCommandline(const winrt::Microsoft::Terminal::Remoting::CommandlineArgs& args);
         bool ShouldCreateWindow();
 
         winrt::Microsoft::Terminal::Remoting::Peasant CurrentWindow();
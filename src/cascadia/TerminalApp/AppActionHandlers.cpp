@@ -5,6 +5,7 @@
 #include "App.h"
 
 #include "TerminalPage.h"
+#include "SessionRecordingConnection.h"
 #include "../WinRTUtils/inc/WtExeUtils.h"
 #include "../../types/inc/utils.hpp"
 #include "Utils.h"
@@ -250,6 +251,17 @@ namespace winrt::TerminalApp::implementation
         args.Handled(true);
     }
 
+    void TerminalPage::_HandleToggleBroadcastInput(const IInspectable& /*sender*/,
+                                                   const ActionEventArgs& args)
+    {
+        if (const auto activeTab{ _GetFocusedTabImpl() })
+        {
+            activeTab->ToggleBroadcastInput();
+        }
+
+        args.Handled(true);
+    }
+
     void TerminalPage::_HandleScrollUpPage(const IInspectable& /*sender*/,
                                            const ActionEventArgs& args)
     {
@@ -497,6 +509,123 @@ namespace winrt::TerminalApp::implementation
         args.Handled(res);
     }
 
+    void TerminalPage::_HandleToggleParserStatistics(const IInspectable& /*sender*/,
+                                                     const ActionEventArgs& args)
+    {
+        const auto res = _ApplyToActiveControls([](auto& control) {
+            control.ToggleParserStatistics();
+        });
+        args.Handled(res);
+    }
+
+    void TerminalPage::_HandleTogglePerformanceOverlay(const IInspectable& /*sender*/,
+                                                       const ActionEventArgs& args)
+    {
+        const auto res = _ApplyToActiveControls([](auto& control) {
+            control.TogglePerformanceOverlay();
+        });
+        args.Handled(res);
+    }
+
+    // Method Description:
+    // - Adds up the memory held by the terminals of each tab, by what it's used for,
+    //   and copies the result to the clipboard. Each tab is also logged as an event,
+    //   so that it can be correlated with the other events of a trace.
+    // - The settings model is shared by all tabs and XAML isn't ours to measure, so
+    //   these are only part of what the process reports as its private bytes.
+    void TerminalPage::_HandleReportMemoryUsage(const IInspectable& /*sender*/,
+                                                const ActionEventArgs& args)
+    {
+        const auto mebibytes = [](const uint64_t bytes) {
+            return bytes / 1048576.0;
+        };
+
+        std::wstring report;
+        uint64_t attributed = 0;
+        uint32_t tabIndex = 0;
+        for (const auto& tab : _tabs)
+        {
+            if (const auto terminalTab{ _GetTerminalTabImpl(tab) })
+            {
+                Control::MemoryUsage total{};
+                uint32_t panes = 0;
+                terminalTab->GetRootPane()->WalkTree([&](auto&& pane) {
+                    if (const auto control{ pane->GetTerminalControl() })
+                    {
+                        const auto usage = control.MemoryUsage();
+                        total.TextBuffer += usage.TextBuffer;
+                        total.Attributes += usage.Attributes;
+                        total.UnicodeStorage += usage.UnicodeStorage;
+                        total.Hyperlinks += usage.Hyperlinks;
+                        total.ScrollMarks += usage.ScrollMarks;
+                        total.Gpu += usage.Gpu;
+                        total.RendererCaches += usage.RendererCaches;
+                        ++panes;
+                    }
+                });
+
+                const auto title = tab.Title();
+                TraceLoggingWrite(
+                    g_hTerminalAppProvider,
+                    "MemoryUsage",
+                    TraceLoggingDescription("Event emitted for each tab when a memory usage report is requested"),
+                    TraceLoggingUInt32(tabIndex, "TabIndex"),
+                    TraceLoggingWideString(title.c_str(), "Title"),
+                    TraceLoggingUInt32(panes, "Panes"),
+                    TraceLoggingUInt64(total.TextBuffer, "TextBufferBytes"),
+                    TraceLoggingUInt64(total.Attributes, "AttributeBytes"),
+                    TraceLoggingUInt64(total.UnicodeStorage, "UnicodeStorageBytes"),
+                    TraceLoggingUInt64(total.Hyperlinks, "HyperlinkBytes"),
+                    TraceLoggingUInt64(total.ScrollMarks, "ScrollMarkBytes"),
+                    TraceLoggingUInt64(total.Gpu, "GpuBytes"),
+                    TraceLoggingUInt64(total.RendererCaches, "RendererCacheBytes"),
+                    TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                    TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+
+                const auto cpu = total.TextBuffer + total.Attributes + total.UnicodeStorage + total.Hyperlinks + total.ScrollMarks + total.RendererCaches;
+                attributed += cpu;
+                fmt::format_to(std::back_inserter(report),
+                               L"Tab {} \"{}\", {} pane(s): {:.1f} MiB\r\n"
+                               L"  buffer {:.1f} MiB, attributes {:.1f} MiB, unicode {:.1f} MiB, hyperlinks {:.1f} MiB, marks {:.1f} MiB\r\n"
+                               L"  renderer caches ~{:.1f} MiB, GPU ~{:.1f} MiB\r\n",
+                               tabIndex + 1,
+                               std::wstring_view{ title },
+                               panes,
+                               mebibytes(cpu),
+                               mebibytes(total.TextBuffer),
+                               mebibytes(total.Attributes),
+                               mebibytes(total.UnicodeStorage),
+                               mebibytes(total.Hyperlinks),
+                               mebibytes(total.ScrollMarks),
+                               mebibytes(total.RendererCaches),
+                               mebibytes(total.Gpu));
+            }
+            ++tabIndex;
+        }
+
+        PROCESS_MEMORY_COUNTERS_EX counters{};
+        counters.cb = sizeof(counters);
+        if (K32GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters)))
+        {
+            const uint64_t privateBytes = counters.PrivateUsage;
+            fmt::format_to(std::back_inserter(report),
+                           L"Process: {:.1f} MiB private, of which {:.1f} MiB aren't attributed to a tab (settings, XAML, heap overhead)\r\n",
+                           mebibytes(privateBytes),
+                           mebibytes(privateBytes > attributed ? privateBytes - attributed : 0));
+        }
+
+        try
+        {
+            DataPackage dataPack;
+            dataPack.RequestedOperation(DataPackageOperation::Copy);
+            dataPack.SetText(report);
+            Clipboard::SetContent(dataPack);
+            Clipboard::Flush();
+        }
+        CATCH_LOG();
+        args.Handled(true);
+    }
+
     void TerminalPage::_HandleToggleFocusMode(const IInspectable& /*sender*/,
                                               const ActionEventArgs& args)
     {
@@ -1112,4 +1241,26 @@ namespace winrt::TerminalApp::implementation
             args.Handled(handled);
         }
     }
+
+    void TerminalPage::_HandleReplaySession(const IInspectable& /*sender*/,
+                                            const ActionEventArgs& args)
+    {
+        if (args)
+        {
+            if (const auto& realArgs = args.ActionArgs().try_as<ReplaySessionArgs>())
+            {
+                try
+                {
+                    const auto connection = OpenSessionReplayConnection(std::wstring_view{ realArgs.Path() }, realArgs.RealTime());
+
+                    NewTerminalArgs newTerminalArgs;
+                    // The replay runs in this window, there's nothing to elevate.
+                    newTerminalArgs.Elevate(false);
+                    _CreateNewTabFromPane(_MakePane(newTerminalArgs, false, connection));
+                    args.Handled(true);
+                }
+                CATCH_LOG();
+            }
+        }
+    }
 }
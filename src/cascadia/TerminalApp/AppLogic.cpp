@@ -190,12 +190,26 @@ namespace winrt::TerminalApp::implementation
         _reloadSettings = std::make_shared<ThrottledFuncTrailing<>>(winrt::Windows::System::DispatcherQueue::GetForCurrentThread(), std::chrono::milliseconds(100), [weakSelf = get_weak()]() {
             if (auto self{ weakSelf.get() })
             {
-                self->_ReloadSettings();
+                // Most change notifications for the settings file don't change its contents.
+                // Skip those, as reloading re-parses everything and runs all profile generators.
+                const auto forced = self->_forceReloadSettings.exchange(false);
+                if (forced || !self->_settings || !self->_settings.IsUpToDate())
+                {
+                    self->_ReloadSettings();
+                }
             }
         });
 
-        _languageProfileNotifier = winrt::make_self<LanguageProfileNotifier>([this]() {
-            _reloadSettings->Run();
+        _idleTasks = std::make_shared<IdleTaskQueue>(winrt::Windows::System::DispatcherQueue::GetForCurrentThread());
+
+        // Creating the notifier loads the text services framework, but the
+        // keyboard layout is unlikely to change before the first frame.
+        _idleTasks->Post(IdleTaskPriority::Normal, [this]() {
+            _languageProfileNotifier = winrt::make_self<LanguageProfileNotifier>([this]() {
+                // The settings file didn't change, but the localized parts of the settings did.
+                _forceReloadSettings.store(true);
+                _reloadSettings->Run();
+            });
         });
     }
 
@@ -301,7 +315,18 @@ namespace winrt::TerminalApp::implementation
 
         _ApplyLanguageSettingChange();
         _RefreshThemeRoutine();
-        _ApplyStartupTaskStateChange();
+
+        _idleTasks->Post(IdleTaskPriority::Low, [this]() { _ApplyStartupTaskStateChange(); });
+        _idleTasks->Post(IdleTaskPriority::Low, [this]() { _root->ShowSetAsDefaultInfoBar(); });
+
+        // The idle tasks may only run once the first frame got composed.
+        _firstFrameRevoker = winrt::Windows::UI::Xaml::Media::CompositionTarget::Rendering(winrt::auto_revoke, [weakThis = get_weak()](auto&&, auto&&) {
+            if (auto self{ weakThis.get() })
+            {
+                self->_firstFrameRevoker.revoke();
+                self->_idleTasks->Start();
+            }
+        });
 
         auto args = winrt::make_self<SystemMenuChangeArgs>(RS_(L"SettingsMenuItem"), SystemMenuChangeAction::Add, SystemMenuItemHandler(this, &AppLogic::_OpenSettingsUI));
         _SystemMenuChangeRequestedHandlers(*this, *args);
@@ -497,6 +522,16 @@ namespace winrt::TerminalApp::implementation
     // - <unused>
     void AppLogic::_OnLoaded(const IInspectable& /*sender*/,
                              const RoutedEventArgs& /*eventArgs*/)
+    {
+        // Dialogs and warnings can wait until the first frame is on the screen.
+        // Querying the service manager for the keyboard service isn't free either.
+        _idleTasks->Post(IdleTaskPriority::High, [this]() { _ShowStartupWarnings(); });
+    }
+
+    // Method Description:
+    // - Warns the user about a disabled keyboard service, and displays the
+    //   errors and warnings we ran into while loading the settings.
+    void AppLogic::_ShowStartupWarnings()
     {
         if (_settings.GlobalSettings().InputServiceWarning())
         {
@@ -853,6 +888,11 @@ namespace winrt::TerminalApp::implementation
     {
         auto start = std::chrono::high_resolution_clock::now();
 
+        // The first frame can't be drawn before the system fonts have been enumerated.
+        // Let that happen in the background while we're busy parsing the settings.
+        // This is a no-op once the font collection has been built.
+        TermControl::PrefetchFonts();
+
         TraceLoggingWrite(
             g_hTerminalAppProvider,
             "SettingsLoadStarted",
@@ -891,7 +931,8 @@ namespace winrt::TerminalApp::implementation
         // Register for directory change notification.
         _RegisterSettingsChange();
 
-        Jumplist::UpdateJumplist(_settings);
+        _idleTasks->Cancel(_jumplistTask);
+        _jumplistTask = _idleTasks->Post(IdleTaskPriority::Low, [this]() { Jumplist::UpdateJumplist(_settings); });
     }
 
     // Method Description:
@@ -1056,6 +1097,9 @@ namespace winrt::TerminalApp::implementation
         _RefreshThemeRoutine();
         _ApplyStartupTaskStateChange();
 
+        // The settings may change before the first frame, in which case the
+        // jumplist doesn't need to be updated later on as well.
+        _idleTasks->Cancel(_jumplistTask);
         Jumplist::UpdateJumplist(_settings);
 
         _SettingsChangedHandlers(*this, nullptr);
@@ -1274,14 +1318,21 @@ namespace winrt::TerminalApp::implementation
     }
 
     // Method Description:
-    // - Triggers the setup of the listener for incoming console connections
-    //   from the operating system.
+    // - Triggers the setup of a listener for incoming console connections
+    //   from the operating system, which keeps running for as long as we do.
+    //   COM then hands them to us, instead of starting a new process for each.
+    // - Users who want a new window for everything keep getting one, and
+    //   handoffs never work elevated in the first place.
     // Arguments:
     // - <none>
     // Return Value:
     // - <none>
     void AppLogic::SetInboundListener()
     {
+        if (_isElevated || _settings.GlobalSettings().WindowingBehavior() == WindowingMode::UseNew)
+        {
+            return;
+        }
         _root->SetInboundListener(false);
     }
 
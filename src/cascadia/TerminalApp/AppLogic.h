@@ -8,6 +8,7 @@
 #include "SystemMenuChangeArgs.g.h"
 #include "Jumplist.h"
 #include "LanguageProfileNotifier.h"
+#include "IdleTaskQueue.h"
 #include "TerminalPage.h"
 
 #include <inc/cppwinrt_utils.h>
@@ -157,6 +158,7 @@ namespace winrt::TerminalApp::implementation
         ::TerminalApp::AppCommandlineArgs _settingsAppArgs;
 
         std::shared_ptr<ThrottledFuncTrailing<>> _reloadSettings;
+        std::atomic<bool> _forceReloadSettings{ false };
         til::throttled_func_trailing<> _reloadState;
 
         // These fields invoke _reloadSettings and must be destroyed before _reloadSettings.
@@ -164,6 +166,12 @@ namespace winrt::TerminalApp::implementation
         winrt::com_ptr<LanguageProfileNotifier> _languageProfileNotifier;
         wil::unique_folder_change_reader_nothrow _reader;
 
+        // Startup work that the first frame doesn't need waits in here until
+        // it's been rendered.
+        std::shared_ptr<IdleTaskQueue> _idleTasks;
+        IdleTaskQueue::TaskId _jumplistTask{ 0 };
+        winrt::Windows::UI::Xaml::Media::CompositionTarget::Rendering_revoker _firstFrameRevoker;
+
         static TerminalApp::FindTargetWindowResult _doFindTargetWindow(winrt::array_view<const hstring> args,
                                                                        const Microsoft::Terminal::Settings::Model::WindowingMode& windowingBehavior);
 
@@ -176,6 +184,7 @@ namespace winrt::TerminalApp::implementation
         fire_and_forget _ApplyStartupTaskStateChange();
 
         void _OnLoaded(const IInspectable& sender, const Windows::UI::Xaml::RoutedEventArgs& eventArgs);
+        void _ShowStartupWarnings();
 
         [[nodiscard]] HRESULT _TryLoadSettings() noexcept;
         void _RegisterSettingsChange();
@@ -26,6 +26,7 @@ namespace winrt::TerminalApp::implementation
         _Filter(L""),
         _Weight(0)
     {
+        _foldedName = _foldCase(_Item.Name());
         _HighlightedName = _computeHighlightedName();
 
         // Recompute the highlighted name if the item name changes
@@ -33,6 +34,7 @@ namespace winrt::TerminalApp::implementation
             auto filteredCommand{ weakThis.get() };
             if (filteredCommand && e.PropertyName() == L"Name")
             {
+                filteredCommand->_foldedName = _foldCase(filteredCommand->_Item.Name());
                 filteredCommand->HighlightedName(filteredCommand->_computeHighlightedName());
                 filteredCommand->Weight(filteredCommand->_computeWeight());
             }
@@ -45,12 +47,47 @@ namespace winrt::TerminalApp::implementation
         // that might result in triggering a notification event
         if (filter != _Filter)
         {
+            // Every match of a filter is also a match of all of its prefixes. So, if the
+            // previous filter didn't match the name, a filter that extends it won't either.
+            // This happens for most commands while typing, and we can skip them entirely,
+            // as unmatched names are never highlighted.
+            const auto stillUnmatched = !_Filter.empty() && _Weight == 0 && til::starts_with(std::wstring_view{ filter }, std::wstring_view{ _Filter });
+
             Filter(filter);
-            HighlightedName(_computeHighlightedName());
-            Weight(_computeWeight());
+
+            if (!stillUnmatched)
+            {
+                HighlightedName(_computeHighlightedName());
+                Weight(_computeWeight());
+            }
         }
     }
 
+    // Method Description:
+    // - Lowercases the given string for case-insensitive matching.
+    // - GH#9941: search should be locale-aware. Folding the name once and comparing
+    //   characters afterwards is a lot cheaper than calling lstrcmpi for every
+    //   combination of filter and name characters.
+    // Arguments:
+    // - str: The string to fold.
+    // Return Value:
+    // - The folded string. It has the same length as the given one, so that
+    //   offsets into it can be used as offsets into the original string.
+    std::wstring FilteredCommand::_foldCase(const std::wstring_view& str)
+    {
+        std::wstring folded{ str };
+        if (!folded.empty())
+        {
+            const auto length = gsl::narrow<int>(str.size());
+            if (LCMapStringEx(LOCALE_NAME_USER_DEFAULT, LCMAP_LOWERCASE | LCMAP_LINGUISTIC_CASING, str.data(), length, folded.data(), length, nullptr, nullptr, 0) != length)
+            {
+                LOG_LAST_ERROR();
+                folded = str;
+            }
+        }
+        return folded;
+    }
+
     // Method Description:
     // - Looks up the filter characters within the item name.
     // Iterating through the filter and the item name it tries to associate the next filter character
@@ -78,12 +115,13 @@ namespace winrt::TerminalApp::implementation
         uint32_t nextOffsetToReport = 0;
         uint32_t currentOffset = 0;
 
-        for (const auto searchChar : _Filter)
+        const auto foldedFilter = _foldCase(_Filter);
+
+        for (const auto searchChar : foldedFilter)
         {
-            const WCHAR searchCharAsString[] = { searchChar, L'\0' };
             while (true)
             {
-                if (currentOffset == commandName.size())
+                if (currentOffset >= std::min<size_t>(commandName.size(), _foldedName.size()))
                 {
                     // There are still unmatched filter characters but we finished scanning the name.
                     // In this case we return the entire item name as unmatched
@@ -93,10 +131,8 @@ namespace winrt::TerminalApp::implementation
                     return winrt::make<HighlightedText>(segments);
                 }
 
-                // GH#9941: search should be locale-aware as well
-                // We use the same comparison method as upon sorting to guarantee consistent behavior
-                const WCHAR currentCharAsString[] = { commandName[currentOffset], L'\0' };
-                auto isCurrentCharMatched = lstrcmpi(searchCharAsString, currentCharAsString) == 0;
+                // GH#9941: search should be locale-aware as well, which _foldCase() takes care of.
+                const auto isCurrentCharMatched = til::at(_foldedName, currentOffset) == searchChar;
                 if (isProcessingMatchedSegment != isCurrentCharMatched)
                 {
                     // We reached the end of the region (matched character came after a series of unmatched or vice versa).
@@ -30,8 +30,11 @@ namespace winrt::TerminalApp::implementation
         WINRT_OBSERVABLE_PROPERTY(int, Weight, _PropertyChangedHandlers);
 
     private:
+        static std::wstring _foldCase(const std::wstring_view& str);
         winrt::TerminalApp::HighlightedText _computeHighlightedName();
         int _computeWeight();
+        // The item name passed through _foldCase(), so that the filter can be matched against it character by character.
+        std::wstring _foldedName;
         Windows::UI::Xaml::Data::INotifyPropertyChanged::PropertyChanged_revoker _itemChangedRevoker;
 
         friend class TerminalAppLocalTests::FilteredCommandTests;
@@ -0,0 +1,102 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "IdleTaskQueue.h"
+
+using namespace winrt::Windows::System;
+
+namespace winrt::TerminalApp::implementation
+{
+    IdleTaskQueue::IdleTaskQueue(DispatcherQueue dispatcher) :
+        _dispatcher{ std::move(dispatcher) }
+    {
+    }
+
+    // Method Description:
+    // - Queues up a task, which runs once the queue is started and all tasks
+    //   of the same or higher priority that were posted before it are done.
+    // Return Value:
+    // - An ID that can be passed to Cancel() for as long as the task hasn't run.
+    IdleTaskQueue::TaskId IdleTaskQueue::Post(const IdleTaskPriority priority, std::function<void()> task)
+    {
+        const auto id = _nextId++;
+        til::at(_tasks, static_cast<size_t>(priority)).push_back({ id, std::move(task) });
+        _scheduleNext();
+        return id;
+    }
+
+    // Method Description:
+    // - Removes a task from the queue. Nothing happens if it already ran.
+    void IdleTaskQueue::Cancel(const TaskId id) noexcept
+    {
+        for (auto& tasks : _tasks)
+        {
+            const auto it = std::find_if(tasks.begin(), tasks.end(), [&](const auto& task) { return task.id == id; });
+            if (it != tasks.end())
+            {
+                tasks.erase(it);
+                return;
+            }
+        }
+    }
+
+    void IdleTaskQueue::CancelAll() noexcept
+    {
+        for (auto& tasks : _tasks)
+        {
+            tasks.clear();
+        }
+    }
+
+    // Method Description:
+    // - Lets the queued up tasks run. Call this once the first frame presented.
+    void IdleTaskQueue::Start()
+    {
+        _started = true;
+        _scheduleNext();
+    }
+
+    void IdleTaskQueue::_scheduleNext()
+    {
+        if (!_started || _scheduled)
+        {
+            return;
+        }
+        if (std::all_of(_tasks.begin(), _tasks.end(), [](const auto& tasks) { return tasks.empty(); }))
+        {
+            return;
+        }
+
+        // Only one task is run per dispatch, so that whatever the user does in
+        // the meantime doesn't need to wait for all of them to finish.
+        _scheduled = _dispatcher.TryEnqueue(DispatcherQueuePriority::Low, [weakThis = weak_from_this()]() {
+            if (const auto self{ weakThis.lock() })
+            {
+                self->_scheduled = false;
+                self->_runNext();
+                self->_scheduleNext();
+            }
+        });
+    }
+
+    void IdleTaskQueue::_runNext()
+    {
+        for (auto& tasks : _tasks)
+        {
+            if (!tasks.empty())
+            {
+                // Pop the task before running it, in case it posts or cancels tasks itself.
+                auto task = std::move(tasks.front());
+                tasks.pop_front();
+
+                try
+                {
+                    task.run();
+                }
+                CATCH_LOG();
+                return;
+            }
+        }
+    }
+}
@@ -0,0 +1,59 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- IdleTaskQueue.h
+
+Abstract:
+- A queue for the work that happens during startup, but which the first frame
+  doesn't need, like updating the jumplist or checking whether we're the
+  default terminal.
+- Tasks that are posted before Start() is called wait until then. Afterwards,
+  they're run one at a time, at the lowest priority of the dispatcher, so that
+  input and rendering always go first. Tasks of a higher IdleTaskPriority run
+  before those of a lower one, and tasks of the same priority in the order they
+  were posted in.
+- The queue may only be used on the thread of the dispatcher it was given.
+--*/
+
+#pragma once
+
+namespace winrt::TerminalApp::implementation
+{
+    enum class IdleTaskPriority : uint8_t
+    {
+        High,
+        Normal,
+        Low,
+    };
+
+    class IdleTaskQueue final : public std::enable_shared_from_this<IdleTaskQueue>
+    {
+    public:
+        using TaskId = uint64_t;
+
+        explicit IdleTaskQueue(winrt::Windows::System::DispatcherQueue dispatcher);
+
+        TaskId Post(const IdleTaskPriority priority, std::function<void()> task);
+        void Cancel(const TaskId id) noexcept;
+        void CancelAll() noexcept;
+        void Start();
+
+    private:
+        struct Task
+        {
+            TaskId id;
+            std::function<void()> run;
+        };
+
+        void _scheduleNext();
+        void _runNext();
+
+        winrt::Windows::System::DispatcherQueue _dispatcher{ nullptr };
+        std::array<std::deque<Task>, 3> _tasks;
+        TaskId _nextId{ 1 };
+        bool _started{ false };
+        bool _scheduled{ false };
+    };
+}
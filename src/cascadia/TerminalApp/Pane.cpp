@@ -44,6 +44,7 @@ Pane::Pane(const Profile& profile, const TermControl& control, const bool lastFo
 
     _connectionStateChangedToken = _control.ConnectionStateChanged({ this, &Pane::_ControlConnectionStateChangedHandler });
     _warningBellToken = _control.WarningBell({ this, &Pane::_ControlWarningBellHandler });
+    _fontSizeChangedToken = _control.FontSizeChanged({ this, &Pane::_ControlFontSizeChangedHandler });
 
     // On the first Pane's creation, lookup resources we'll use to theme the
     // Pane, including the brushed to use for the focused/unfocused border
@@ -1130,6 +1131,18 @@ void Pane::_ControlWarningBellHandler(const winrt::Windows::Foundation::IInspect
     }
 }
 
+// Event Description:
+// - Called when the font of our control changes. The control's minimum size
+//   and cell size depend on it, so drop our cached layout constraints.
+// - This is raised while the control's core holds its write lock, so we
+//   mustn't call back into the control here.
+// Arguments:
+// - <unused>
+void Pane::_ControlFontSizeChangedHandler(const int /*fontWidth*/, const int /*fontHeight*/, const bool /*isInitialChange*/)
+{
+    _layoutConstraints.reset();
+}
+
 // Event Description:
 // - Called when our control gains focus. We'll use this to trigger our GotFocus
 //   callback. The tab that's hosting us should have registered a callback which
@@ -1444,6 +1457,9 @@ void Pane::UpdateSettings(const TerminalSettingsCreateResult& settings, const Pr
     _profile = profile;
 
     _control.UpdateControlSettings(settings.DefaultSettings(), settings.UnfocusedSettings());
+
+    // The padding and the scrollbar visibility may have changed.
+    _layoutConstraints.reset();
 }
 
 // Method Description:
@@ -1573,10 +1589,12 @@ void Pane::_CloseChild(const bool closeFirst, const bool isDetaching)
         _connectionState = remainingChild->_connectionState;
         _profile = remainingChild->_profile;
         _id = remainingChild->Id();
+        _layoutConstraints = remainingChild->_layoutConstraints;
 
         // Add our new event handler before revoking the old one.
         _connectionStateChangedToken = _control.ConnectionStateChanged({ this, &Pane::_ControlConnectionStateChangedHandler });
         _warningBellToken = _control.WarningBell({ this, &Pane::_ControlWarningBellHandler });
+        _fontSizeChangedToken = _control.FontSizeChanged({ this, &Pane::_ControlFontSizeChangedHandler });
 
         // Revoke the old event handlers. Remove both the handlers for the panes
         // themselves closing, and remove their handlers for their controls
@@ -1592,6 +1610,7 @@ void Pane::_CloseChild(const bool closeFirst, const bool isDetaching)
                 {
                     p->_control.ConnectionStateChanged(p->_connectionStateChangedToken);
                     p->_control.WarningBell(p->_warningBellToken);
+                    p->_control.FontSizeChanged(p->_fontSizeChangedToken);
                 }
             });
         }
@@ -1600,6 +1619,7 @@ void Pane::_CloseChild(const bool closeFirst, const bool isDetaching)
         remainingChild->Closed(remainingChildClosedToken);
         remainingChild->_control.ConnectionStateChanged(remainingChild->_connectionStateChangedToken);
         remainingChild->_control.WarningBell(remainingChild->_warningBellToken);
+        remainingChild->_control.FontSizeChanged(remainingChild->_fontSizeChangedToken);
 
         // If we or either of our children was focused, we want to take that
         // focus from them.
@@ -1681,6 +1701,7 @@ void Pane::_CloseChild(const bool closeFirst, const bool isDetaching)
                 {
                     p->_control.ConnectionStateChanged(p->_connectionStateChangedToken);
                     p->_control.WarningBell(p->_warningBellToken);
+                    p->_control.FontSizeChanged(p->_fontSizeChangedToken);
                 }
             });
         }
@@ -2436,6 +2457,9 @@ std::pair<std::shared_ptr<Pane>, std::shared_ptr<Pane>> Pane::_Split(SplitDirect
         _connectionStateChangedToken.value = 0;
         _control.WarningBell(_warningBellToken);
         _warningBellToken.value = 0;
+        _control.FontSizeChanged(_fontSizeChangedToken);
+        _fontSizeChangedToken.value = 0;
+        _layoutConstraints.reset();
 
         // Remove our old GotFocus handler from the control. We don't want the
         // control telling us that it's now focused, we want it telling its new
@@ -2737,29 +2761,36 @@ Pane::SnapChildrenSizeResult Pane::_CalcSnappedChildrenSizes(const bool widthOrH
     // only just stop at various moments when the built sizes reaches it.  Eventually, this could
     // be optimized for simple cases like when both children are both leaves with the same character
     // size, but it doesn't seem to be beneficial.
+    //   The nodes are advanced in place and each step only touches the path from the root to
+    // the leaf that grows, so a step costs O(depth) no matter how many panes there are.
 
-    auto sizeTree = _CreateMinSizeTree(widthOrHeight);
-    auto lastSizeTree{ sizeTree };
+    std::vector<LayoutSizeNode> sizeTree;
+    _CreateMinSizeTree(widthOrHeight, sizeTree);
 
-    while (sizeTree.size < fullSize)
+    const auto& root = sizeTree.front();
+    const auto& first = sizeTree[1];
+    const auto& second = sizeTree[root.secondChild];
+    std::pair<float, float> lastSizes{ first.size, second.size };
+
+    while (root.size < fullSize)
     {
-        lastSizeTree = sizeTree;
-        _AdvanceSnappedDimension(widthOrHeight, sizeTree);
+        lastSizes = { first.size, second.size };
+        _AdvanceSnappedDimension(widthOrHeight, sizeTree, 0);
 
-        if (sizeTree.size == fullSize)
+        if (root.size == fullSize)
         {
             // If we just hit exactly the requested value, then just return the
             // current state of children.
-            return { { sizeTree.firstChild->size, sizeTree.secondChild->size },
-                     { sizeTree.firstChild->size, sizeTree.secondChild->size } };
+            return { { first.size, second.size },
+                     { first.size, second.size } };
         }
     }
 
-    // We exceeded the requested size in the loop above, so lastSizeTree will have
+    // We exceeded the requested size in the loop above, so lastSizes will have
     // the last good sizes (so that children fit in) and sizeTree has the next possible
     // snapped sizes. Return them as lower and higher snap possibilities.
-    return { { lastSizeTree.firstChild->size, lastSizeTree.secondChild->size },
-             { sizeTree.firstChild->size, sizeTree.secondChild->size } };
+    return { lastSizes,
+             { first.size, second.size } };
 }
 
 // Method Description:
@@ -2822,7 +2853,7 @@ Pane::SnapSizeResult Pane::_CalcSnappedDimension(const bool widthOrHeight, const
         }
         else
         {
-            const auto cellSize = _control.CharacterDimensions();
+            const auto cellSize = _GetLayoutConstraints().cellSize;
             const auto higher = lower + (widthOrHeight ? cellSize.Width : cellSize.Height);
             return { lower, higher };
         }
@@ -2862,112 +2893,43 @@ Pane::SnapSizeResult Pane::_CalcSnappedDimension(const bool widthOrHeight, const
 //   already snapped or minimum size.
 // Arguments:
 // - widthOrHeight: if true operates on width, otherwise on height.
-// - sizeNode: a layout size node that corresponds to this pane.
+// - sizeTree: the flat array of layout size nodes built by _CreateMinSizeTree.
+// - index: the index of the node in sizeTree that corresponds to this pane.
 // Return Value:
 // - <none>
-void Pane::_AdvanceSnappedDimension(const bool widthOrHeight, LayoutSizeNode& sizeNode) const
+void Pane::_AdvanceSnappedDimension(const bool widthOrHeight, std::vector<LayoutSizeNode>& sizeTree, const size_t index) const
 {
+    auto& sizeNode = sizeTree.at(index);
+
     if (_IsLeaf())
     {
-        // We're a leaf pane, so just add one more row or column (unless isMinimumSize
-        // is true, see below).
-
-        if (sizeNode.isMinimumSize)
-        {
-            // If the node is of its minimum size, this size might not be snapped (it might
-            // be, say, half a character, or fixed 10 pixels), so snap it upward. It might
-            // however be already snapped, so add 1 to make sure it really increases
-            // (not strictly necessary but to avoid surprises).
-            sizeNode.size = _CalcSnappedDimension(widthOrHeight, sizeNode.size + 1).higher;
-        }
-        else
-        {
-            const auto cellSize = _control.CharacterDimensions();
-            sizeNode.size += widthOrHeight ? cellSize.Width : cellSize.Height;
-        }
+        // We're a leaf pane, so just add one more row or column. nextSize was
+        // already snapped upward if we were of our minimum size, since that size
+        // might not be snapped (it might be, say, half a character, or fixed 10 pixels).
+        const auto cellSize = _GetLayoutConstraints().cellSize;
+        sizeNode.size = sizeNode.nextSize;
+        sizeNode.nextSize = sizeNode.size + (widthOrHeight ? cellSize.Width : cellSize.Height);
     }
     else
     {
         // We're a parent pane, so we have to advance dimension of our children panes. In
-        // fact, we advance only one child (chosen later) to keep the growth fine-grained.
+        // fact, we advance only one child to keep the growth fine-grained. To choose which
+        // one, we need to know their advanced sizes in advance (oh), which is what the
+        // cached nextSize of each child is for.
+        const auto firstIndex = index + 1;
+        const auto secondIndex = sizeNode.secondChild;
 
-        // To choose which child pane to advance, we actually need to know their advanced sizes
-        // in advance (oh), to see which one would 'fit' better. Often, this is already cached
-        // by the previous invocation of this function in nextFirstChild and nextSecondChild
-        // fields of given node. If not, we need to calculate them now.
-        if (sizeNode.nextFirstChild == nullptr)
-        {
-            sizeNode.nextFirstChild = std::make_unique<LayoutSizeNode>(*sizeNode.firstChild);
-            _firstChild->_AdvanceSnappedDimension(widthOrHeight, *sizeNode.nextFirstChild);
-        }
-        if (sizeNode.nextSecondChild == nullptr)
+        if (_ShouldAdvanceFirstChild(widthOrHeight, sizeTree.at(firstIndex), sizeTree.at(secondIndex)))
         {
-            sizeNode.nextSecondChild = std::make_unique<LayoutSizeNode>(*sizeNode.secondChild);
-            _secondChild->_AdvanceSnappedDimension(widthOrHeight, *sizeNode.nextSecondChild);
-        }
-
-        const auto nextFirstSize = sizeNode.nextFirstChild->size;
-        const auto nextSecondSize = sizeNode.nextSecondChild->size;
-
-        // Choose which child pane to advance.
-        bool advanceFirstOrSecond;
-        if (_splitState == (widthOrHeight ? SplitState::Horizontal : SplitState::Vertical))
-        {
-            // If we're growing along separator axis, choose the child that
-            // wants to be smaller than the other, so that the resulting size
-            // will be the smallest.
-            advanceFirstOrSecond = nextFirstSize < nextSecondSize;
+            _firstChild->_AdvanceSnappedDimension(widthOrHeight, sizeTree, firstIndex);
         }
         else
         {
-            // If we're growing perpendicularly to separator axis, choose a
-            // child so that their size ratio is closer to that we're trying
-            // to maintain (this is, the relative separator position is closer
-            // to the _desiredSplitPosition field).
-
-            const auto firstSize = sizeNode.firstChild->size;
-            const auto secondSize = sizeNode.secondChild->size;
-
-            // Because we rely on equality check, these calculations have to be
-            // immune to floating point errors. In common situation where both panes
-            // have the same character sizes and _desiredSplitPosition is 0.5 (or
-            // some simple fraction) both ratios will often be the same, and if so
-            // we always take the left child. It could be right as well, but it's
-            // important that it's consistent: that it would always go
-            // 1 -> 2 -> 1 -> 2 -> 1 -> 2 and not like 1 -> 1 -> 2 -> 2 -> 2 -> 1
-            // which would look silly to the user but which occur if there was
-            // a non-floating-point-safe math.
-            const auto deviation1 = nextFirstSize - (nextFirstSize + secondSize) * _desiredSplitPosition;
-            const auto deviation2 = -1 * (firstSize - (firstSize + nextSecondSize) * _desiredSplitPosition);
-            advanceFirstOrSecond = deviation1 <= deviation2;
-        }
-
-        // Here we advance one of our children. Because we already know the appropriate
-        // (advanced) size that given child would need to have, we simply assign that size
-        // to it. We then advance its 'next*' size (nextFirstChild or nextSecondChild) so
-        // the invariant holds (as it will likely be used by the next invocation of this
-        // function). The other child's next* size remains unchanged because its size
-        // haven't changed either.
-        if (advanceFirstOrSecond)
-        {
-            *sizeNode.firstChild = *sizeNode.nextFirstChild;
-            _firstChild->_AdvanceSnappedDimension(widthOrHeight, *sizeNode.nextFirstChild);
-        }
-        else
-        {
-            *sizeNode.secondChild = *sizeNode.nextSecondChild;
-            _secondChild->_AdvanceSnappedDimension(widthOrHeight, *sizeNode.nextSecondChild);
+            _secondChild->_AdvanceSnappedDimension(widthOrHeight, sizeTree, secondIndex);
         }
 
         // Since the size of one of our children has changed we need to update our size as well.
-        if (_splitState == (widthOrHeight ? SplitState::Horizontal : SplitState::Vertical))
-        {
-            sizeNode.size = std::max(sizeNode.firstChild->size, sizeNode.secondChild->size);
-        }
-        else
-        {
-            sizeNode.size = sizeNode.firstChild->size + sizeNode.secondChild->size;
-        }
+        _UpdateSizeNode(widthOrHeight, sizeTree, index);
     }
 
     // Because we have grown, we're certainly no longer of our
@@ -2975,6 +2937,88 @@ void Pane::_AdvanceSnappedDimension(const bool widthOrHeight, LayoutSizeNode& si
     sizeNode.isMinimumSize = false;
 }
 
+// Method Description:
+// - Recalculates the size and the next size of a parent node from the
+//   (already up to date) nodes of its children.
+// Arguments:
+// - widthOrHeight: if true operates on width, otherwise on height.
+// - sizeTree: the flat array of layout size nodes built by _CreateMinSizeTree.
+// - index: the index of the node in sizeTree that corresponds to this pane.
+// Return Value:
+// - <none>
+void Pane::_UpdateSizeNode(const bool widthOrHeight, std::vector<LayoutSizeNode>& sizeTree, const size_t index) const
+{
+    auto& sizeNode = sizeTree.at(index);
+    const auto& first = sizeTree.at(index + 1);
+    const auto& second = sizeTree.at(sizeNode.secondChild);
+
+    const auto alongSeparator = _splitState == (widthOrHeight ? SplitState::Horizontal : SplitState::Vertical);
+    const auto combine = [=](const float firstSize, const float secondSize) {
+        return alongSeparator ? std::max(firstSize, secondSize) : firstSize + secondSize;
+    };
+
+    sizeNode.size = combine(first.size, second.size);
+    sizeNode.nextSize = _ShouldAdvanceFirstChild(widthOrHeight, first, second) ?
+                            combine(first.nextSize, second.size) :
+                            combine(first.size, second.nextSize);
+}
+
+// Method Description:
+// - Chooses which of our children should grow in the next layout step.
+// Arguments:
+// - widthOrHeight: if true operates on width, otherwise on height.
+// - first: the layout size node of our first child.
+// - second: the layout size node of our second child.
+// Return Value:
+// - true if the first child should be advanced, false for the second one.
+bool Pane::_ShouldAdvanceFirstChild(const bool widthOrHeight, const LayoutSizeNode& first, const LayoutSizeNode& second) const noexcept
+{
+    if (_splitState == (widthOrHeight ? SplitState::Horizontal : SplitState::Vertical))
+    {
+        // If we're growing along separator axis, choose the child that
+        // wants to be smaller than the other, so that the resulting size
+        // will be the smallest.
+        return first.nextSize < second.nextSize;
+    }
+
+    // If we're growing perpendicularly to separator axis, choose a
+    // child so that their size ratio is closer to that we're trying
+    // to maintain (this is, the relative separator position is closer
+    // to the _desiredSplitPosition field).
+
+    // Because we rely on equality check, these calculations have to be
+    // immune to floating point errors. In common situation where both panes
+    // have the same character sizes and _desiredSplitPosition is 0.5 (or
+    // some simple fraction) both ratios will often be the same, and if so
+    // we always take the left child. It could be right as well, but it's
+    // important that it's consistent: that it would always go
+    // 1 -> 2 -> 1 -> 2 -> 1 -> 2 and not like 1 -> 1 -> 2 -> 2 -> 2 -> 1
+    // which would look silly to the user but which occur if there was
+    // a non-floating-point-safe math.
+    const auto deviation1 = first.nextSize - (first.nextSize + second.size) * _desiredSplitPosition;
+    const auto deviation2 = -1 * (first.size - (first.size + second.nextSize) * _desiredSplitPosition);
+    return deviation1 <= deviation2;
+}
+
+// Method Description:
+// - Returns the minimum size and the cell size of our control. These are
+//   cached, because querying them goes all the way to the control's core and
+//   its scrollbar, and the layout code needs them for every pane on every
+//   step. The cache is dropped when the font or the settings of the control
+//   change, see _ControlFontSizeChangedHandler and UpdateSettings.
+// Arguments:
+// - <none>
+// Return Value:
+// - The layout constraints of our control. Only valid for leaf panes.
+const Pane::LayoutConstraints& Pane::_GetLayoutConstraints() const
+{
+    if (!_layoutConstraints)
+    {
+        _layoutConstraints = LayoutConstraints{ _control.MinimumSize(), _control.CharacterDimensions() };
+    }
+    return *_layoutConstraints;
+}
+
 // Method Description:
 // - Get the absolute minimum size that this pane can be resized to and still
 //   have 1x1 character visible, in each of its children. If we're a leaf, we'll
@@ -2988,7 +3032,7 @@ Size Pane::_GetMinSize() const
 {
     if (_IsLeaf())
     {
-        auto controlSize = _control.MinimumSize();
+        auto controlSize = _GetLayoutConstraints().minimumSize;
         auto newWidth = controlSize.Width;
         auto newHeight = controlSize.Height;
 
@@ -3016,23 +3060,38 @@ Size Pane::_GetMinSize() const
 }
 
 // Method Description:
-// - Builds a tree of LayoutSizeNode that matches the tree of panes. Each node
-//   has minimum size that the corresponding pane can have.
+// - Builds a flat array of LayoutSizeNode that matches the tree of panes, in
+//   pre-order. Each node has minimum size that the corresponding pane can have.
+//   The minimum sizes are gathered bottom-up, so the whole tree is built in a
+//   single pass.
 // Arguments:
 // - widthOrHeight: if true operates on width, otherwise on height
+// - sizeTree: the array to append the nodes of this pane's subtree to
 // Return Value:
-// - Root node of built tree that matches this pane.
-Pane::LayoutSizeNode Pane::_CreateMinSizeTree(const bool widthOrHeight) const
+// - <none>
+void Pane::_CreateMinSizeTree(const bool widthOrHeight, std::vector<LayoutSizeNode>& sizeTree) const
 {
-    const auto size = _GetMinSize();
-    LayoutSizeNode node(widthOrHeight ? size.Width : size.Height);
-    if (!_IsLeaf())
+    const auto index = sizeTree.size();
+    sizeTree.emplace_back();
+
+    if (_IsLeaf())
     {
-        node.firstChild = std::make_unique<LayoutSizeNode>(_firstChild->_CreateMinSizeTree(widthOrHeight));
-        node.secondChild = std::make_unique<LayoutSizeNode>(_secondChild->_CreateMinSizeTree(widthOrHeight));
-    }
+        const auto minSize = _GetMinSize();
+        auto& node = sizeTree.back();
+        node.size = widthOrHeight ? minSize.Width : minSize.Height;
 
-    return node;
+        // Our minimum size might not be snapped, so the next size is snapped
+        // upward. It might however be already snapped, so add 1 to make sure
+        // it really increases (not strictly necessary but to avoid surprises).
+        node.nextSize = _CalcSnappedDimension(widthOrHeight, node.size + 1).higher;
+    }
+    else
+    {
+        _firstChild->_CreateMinSizeTree(widthOrHeight, sizeTree);
+        sizeTree.at(index).secondChild = sizeTree.size();
+        _secondChild->_CreateMinSizeTree(widthOrHeight, sizeTree);
+        _UpdateSizeNode(widthOrHeight, sizeTree, index);
+    }
 }
 
 // Method Description:
@@ -231,6 +231,7 @@ private:
     winrt::event_token _firstClosedToken{ 0 };
     winrt::event_token _secondClosedToken{ 0 };
     winrt::event_token _warningBellToken{ 0 };
+    winrt::event_token _fontSizeChangedToken{ 0 };
 
     winrt::Windows::UI::Xaml::UIElement::GotFocus_revoker _gotFocusRevoker;
     winrt::Windows::UI::Xaml::UIElement::LostFocus_revoker _lostFocusRevoker;
@@ -280,6 +281,7 @@ private:
     void _ControlConnectionStateChangedHandler(const winrt::Windows::Foundation::IInspectable& sender, const winrt::Windows::Foundation::IInspectable& /*args*/);
     void _ControlWarningBellHandler(const winrt::Windows::Foundation::IInspectable& sender,
                                     const winrt::Windows::Foundation::IInspectable& e);
+    void _ControlFontSizeChangedHandler(const int fontWidth, const int fontHeight, const bool isInitialChange);
     void _ControlGotFocusHandler(const winrt::Windows::Foundation::IInspectable& sender,
                                  const winrt::Windows::UI::Xaml::RoutedEventArgs& e);
     void _ControlLostFocusHandler(const winrt::Windows::Foundation::IInspectable& sender,
@@ -288,9 +290,12 @@ private:
     std::pair<float, float> _CalcChildrenSizes(const float fullSize) const;
     SnapChildrenSizeResult _CalcSnappedChildrenSizes(const bool widthOrHeight, const float fullSize) const;
     SnapSizeResult _CalcSnappedDimension(const bool widthOrHeight, const float dimension) const;
-    void _AdvanceSnappedDimension(const bool widthOrHeight, LayoutSizeNode& sizeNode) const;
+    void _AdvanceSnappedDimension(const bool widthOrHeight, std::vector<LayoutSizeNode>& sizeTree, const size_t index) const;
+    void _UpdateSizeNode(const bool widthOrHeight, std::vector<LayoutSizeNode>& sizeTree, const size_t index) const;
+    bool _ShouldAdvanceFirstChild(const bool widthOrHeight, const LayoutSizeNode& first, const LayoutSizeNode& second) const noexcept;
+    const LayoutConstraints& _GetLayoutConstraints() const;
     winrt::Windows::Foundation::Size _GetMinSize() const;
-    LayoutSizeNode _CreateMinSizeTree(const bool widthOrHeight) const;
+    void _CreateMinSizeTree(const bool widthOrHeight, std::vector<LayoutSizeNode>& sizeTree) const;
     float _ClampSplitPosition(const bool widthOrHeight, const float requestedValue, const float totalSize) const;
 
     SplitState _convertAutomaticOrDirectionalSplitState(const winrt::Microsoft::Terminal::Settings::Model::SplitDirection& splitType) const;
@@ -360,31 +365,31 @@ private:
         std::pair<float, float> higher;
     };
 
-    // Helper structure that builds a (roughly) binary tree corresponding
-    // to the pane tree. Used for laying out panes with snapped sizes.
+    // Helper structure used for laying out panes with snapped sizes. The nodes
+    // of a pane tree are stored in a flat array in pre-order: the first child of
+    // a parent node directly follows it and the second one is at secondChild.
     struct LayoutSizeNode
     {
-        float size;
-        bool isMinimumSize;
-        std::unique_ptr<LayoutSizeNode> firstChild;
-        std::unique_ptr<LayoutSizeNode> secondChild;
-
-        // These two fields hold next possible snapped values of firstChild and
-        // secondChild. Although that could be calculated from these fields themselves,
-        // it would be wasteful as we have to know these values more often than for
-        // simple increment. Hence we cache that here.
-        std::unique_ptr<LayoutSizeNode> nextFirstChild;
-        std::unique_ptr<LayoutSizeNode> nextSecondChild;
-
-        explicit LayoutSizeNode(const float minSize);
-        LayoutSizeNode(const LayoutSizeNode& other);
-
-        LayoutSizeNode& operator=(const LayoutSizeNode& other);
+        float size{ 0 };
+
+        // The size this node will have after the next call to
+        // _AdvanceSnappedDimension. Parents need to know it for both of their
+        // children to decide which one to advance, so we cache that here.
+        float nextSize{ 0 };
+        bool isMinimumSize{ true };
+        size_t secondChild{ 0 };
+    };
 
-    private:
-        void _AssignChildNode(std::unique_ptr<LayoutSizeNode>& nodeField, const LayoutSizeNode* const newNode);
+    struct LayoutConstraints
+    {
+        winrt::Windows::Foundation::Size minimumSize;
+        winrt::Windows::Foundation::Size cellSize;
     };
 
+    // The control's minimum size and cell size are needed for every step of
+    // the layout, so they're cached until the control's font or settings change.
+    mutable std::optional<LayoutConstraints> _layoutConstraints;
+
     friend struct winrt::TerminalApp::implementation::TerminalTab;
     friend class ::TerminalAppLocalTests::TabTests;
 };
@@ -0,0 +1,187 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "SessionRecordingConnection.h"
+
+using namespace ::winrt::Microsoft::Terminal::TerminalConnection;
+using namespace ::winrt::Windows::Foundation;
+using namespace ::Microsoft::Console;
+
+namespace winrt::Microsoft::TerminalApp::implementation
+{
+    SessionRecordingConnection::SessionRecordingConnection(ITerminalConnection wrappedConnection, const std::filesystem::path& path, const bool recordInput) :
+        _writer{ path },
+        _wrappedConnection{ std::move(wrappedConnection) },
+        _recordInput{ recordInput }
+    {
+        // The output is recorded from our own handler, which runs on the
+        // connection's output thread, next to the one of the control.
+        _outputRevoker = _wrappedConnection.TerminalOutput(winrt::auto_revoke, [this](const hstring& str) {
+            try
+            {
+                _writer.WriteOutput(str);
+            }
+            CATCH_LOG();
+        });
+    }
+
+    void SessionRecordingConnection::Start()
+    {
+        _wrappedConnection.Start();
+    }
+
+    void SessionRecordingConnection::WriteInput(const hstring& data)
+    {
+        if (_recordInput)
+        {
+            try
+            {
+                _writer.WriteInput(data);
+            }
+            CATCH_LOG();
+        }
+        _wrappedConnection.WriteInput(data);
+    }
+
+    void SessionRecordingConnection::Resize(uint32_t rows, uint32_t columns)
+    {
+        try
+        {
+            _writer.WriteResize(rows, columns);
+        }
+        CATCH_LOG();
+        _wrappedConnection.Resize(rows, columns);
+    }
+
+    void SessionRecordingConnection::Close()
+    {
+        _wrappedConnection.Close();
+        _outputRevoker.revoke();
+        LOG_IF_FAILED(wil::ResultFromException([&]() { _writer.Flush(); }));
+    }
+
+    ConnectionState SessionRecordingConnection::State() const noexcept
+    {
+        return _wrappedConnection.State();
+    }
+
+    winrt::event_token SessionRecordingConnection::TerminalOutput(const TerminalOutputHandler& handler)
+    {
+        return _wrappedConnection.TerminalOutput(handler);
+    }
+
+    void SessionRecordingConnection::TerminalOutput(const winrt::event_token& token) noexcept
+    {
+        _wrappedConnection.TerminalOutput(token);
+    }
+
+    winrt::event_token SessionRecordingConnection::StateChanged(const TypedEventHandler<ITerminalConnection, IInspectable>& handler)
+    {
+        return _wrappedConnection.StateChanged(handler);
+    }
+
+    void SessionRecordingConnection::StateChanged(const winrt::event_token& token) noexcept
+    {
+        _wrappedConnection.StateChanged(token);
+    }
+
+    SessionReplayConnection::SessionReplayConnection(const std::filesystem::path& path, const bool realTime) :
+        _reader{ path },
+        _realTime{ realTime }
+    {
+    }
+
+    winrt::fire_and_forget SessionReplayConnection::Start()
+    {
+        auto strongThis{ get_strong() };
+        co_await winrt::resume_background();
+
+        _setState(ConnectionState::Connected);
+
+        const auto start = std::chrono::steady_clock::now();
+        while (const auto record = _reader.Next())
+        {
+            if (record->type != SessionRecording::RecordType::Output)
+            {
+                continue;
+            }
+
+            if (_realTime)
+            {
+                const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(start + record->timestamp - std::chrono::steady_clock::now());
+                if (remaining.count() > 0 && _closeRequested.wait(gsl::narrow_cast<DWORD>(remaining.count())))
+                {
+                    break;
+                }
+            }
+            else if (_closeRequested.is_signaled())
+            {
+                break;
+            }
+
+            _TerminalOutputHandlers(winrt::hstring{ record->text });
+        }
+
+        _setState(ConnectionState::Closed);
+    }
+
+    void SessionReplayConnection::Close() noexcept
+    {
+        _closeRequested.SetEvent();
+    }
+
+    ConnectionState SessionReplayConnection::State() const noexcept
+    {
+        return _state.load();
+    }
+
+    void SessionReplayConnection::_setState(const ConnectionState state)
+    {
+        _state.store(state);
+        _StateChangedHandlers(*this, nullptr);
+    }
+}
+
+// Function Description:
+// - Wraps the given connection so that its session is recorded into a new
+//   file in the given directory. The file is named after the profile and the
+//   time the session was started.
+// Arguments:
+// - baseConnection: the connection to record.
+// - directory: the directory to create the recording in. Created if necessary.
+// - profileName: the name of the profile the connection was created for.
+// - recordInput: if true, the input written to the connection is recorded
+//   too. This includes anything the user types, passwords included.
+// Return Value:
+// - a connection to use in place of the given one.
+ITerminalConnection OpenSessionRecordingConnection(ITerminalConnection baseConnection, const std::filesystem::path& directory, const winrt::hstring& profileName, const bool recordInput)
+{
+    using namespace winrt::Microsoft::TerminalApp::implementation;
+    static std::atomic<uint32_t> sequence{ 0 };
+
+    std::wstring name{ profileName };
+    std::replace_if(
+        name.begin(), name.end(), [](const wchar_t ch) { return ch < L' ' || std::wstring_view{ L"<>:\"/\\|?*" }.find(ch) != std::wstring_view::npos; }, L'_');
+
+    SYSTEMTIME time;
+    GetLocalTime(&time);
+    const auto filename = fmt::format(L"{}-{:04}{:02}{:02}-{:02}{:02}{:02}-{}.wtrec", name, time.wYear, time.wMonth, time.wDay, time.wHour, time.wMinute, time.wSecond, sequence++);
+
+    std::filesystem::create_directories(directory);
+    return winrt::make<SessionRecordingConnection>(std::move(baseConnection), directory / filename, recordInput);
+}
+
+// Function Description:
+// - Opens a session recording for replaying it into a control.
+// Arguments:
+// - path: the recording to replay.
+// - realTime: if true, the output is replayed with the recorded timing,
+//   otherwise as fast as possible.
+// Return Value:
+// - the replaying connection.
+ITerminalConnection OpenSessionReplayConnection(const std::filesystem::path& path, const bool realTime)
+{
+    using namespace winrt::Microsoft::TerminalApp::implementation;
+    return winrt::make<SessionReplayConnection>(path, realTime);
+}
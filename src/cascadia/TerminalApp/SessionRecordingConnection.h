@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <winrt/Microsoft.Terminal.TerminalConnection.h>
+#include "../../inc/SessionRecording.hpp"
+
+namespace winrt::Microsoft::TerminalApp::implementation
+{
+    // Wraps a connection and writes everything it prints (and optionally,
+    // everything written to it) into a session recording.
+    class SessionRecordingConnection : public winrt::implements<SessionRecordingConnection, winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection>
+    {
+    public:
+        SessionRecordingConnection(Microsoft::Terminal::TerminalConnection::ITerminalConnection wrappedConnection, const std::filesystem::path& path, const bool recordInput);
+        void Initialize(const Windows::Foundation::Collections::ValueSet& /*settings*/){};
+        void Start();
+        void WriteInput(const hstring& data);
+        void Resize(uint32_t rows, uint32_t columns);
+        void Close();
+        winrt::Microsoft::Terminal::TerminalConnection::ConnectionState State() const noexcept;
+
+        winrt::event_token TerminalOutput(const winrt::Microsoft::Terminal::TerminalConnection::TerminalOutputHandler& handler);
+        void TerminalOutput(const winrt::event_token& token) noexcept;
+        winrt::event_token StateChanged(const Windows::Foundation::TypedEventHandler<winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection, Windows::Foundation::IInspectable>& handler);
+        void StateChanged(const winrt::event_token& token) noexcept;
+
+    private:
+        ::Microsoft::Console::SessionRecording::Writer _writer;
+        winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection _wrappedConnection;
+        winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection::TerminalOutput_revoker _outputRevoker;
+        bool _recordInput;
+    };
+
+    // A connection that prints the output of a session recording, either with
+    // the recorded timing or as fast as the control can process it.
+    class SessionReplayConnection : public winrt::implements<SessionReplayConnection, winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection>
+    {
+    public:
+        SessionReplayConnection(const std::filesystem::path& path, const bool realTime);
+        void Initialize(const Windows::Foundation::Collections::ValueSet& /*settings*/){};
+        winrt::fire_and_forget Start();
+        void WriteInput(const hstring& /*data*/) noexcept {};
+        void Resize(uint32_t /*rows*/, uint32_t /*columns*/) noexcept {};
+        void Close() noexcept;
+        winrt::Microsoft::Terminal::TerminalConnection::ConnectionState State() const noexcept;
+
+        WINRT_CALLBACK(TerminalOutput, winrt::Microsoft::Terminal::TerminalConnection::TerminalOutputHandler);
+
+        TYPED_EVENT(StateChanged, winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection, winrt::Windows::Foundation::IInspectable);
+
+    private:
+        void _setState(const winrt::Microsoft::Terminal::TerminalConnection::ConnectionState state);
+
+        ::Microsoft::Console::SessionRecording::Reader _reader;
+        wil::unique_event _closeRequested{ wil::EventOptions::ManualReset };
+        std::atomic<winrt::Microsoft::Terminal::TerminalConnection::ConnectionState> _state{ winrt::Microsoft::Terminal::TerminalConnection::ConnectionState::NotConnected };
+        bool _realTime;
+    };
+}
+
+winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection OpenSessionRecordingConnection(winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection baseConnection, const std::filesystem::path& directory, const winrt::hstring& profileName, const bool recordInput);
+winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection OpenSessionReplayConnection(const std::filesystem::path& path, const bool realTime);
@@ -901,6 +901,15 @@ namespace winrt::TerminalApp::implementation
             _tabContent.Children().Clear();
             _tabContent.Children().Append(tab.Content());
 
+            // Only the controls of the selected tab are painted, and their output comes first.
+            for (const auto& otherTab : _tabs)
+            {
+                if (const auto terminalTab{ _GetTerminalTabImpl(otherTab) })
+                {
+                    terminalTab->SetContentVisible(otherTab == tab);
+                }
+            }
+
             // GH#7409: If the tab switcher is open, then we _don't_ want to
             // automatically focus the new tab here. The tab switcher wants
             // to be able to "preview" the selected tab as the user tabs
@@ -17,6 +17,7 @@
 #include "../../types/inc/utils.hpp"
 #include "ColorHelper.h"
 #include "DebugTapConnection.h"
+#include "SessionRecordingConnection.h"
 #include "SettingsTab.h"
 #include "TabRowControl.h"
 
@@ -146,6 +147,11 @@ namespace winrt::TerminalApp::implementation
         // Upon settings update we reload the system settings for scrolling as well.
         // TODO: consider reloading this value periodically.
         _systemRowsToScroll = _ReadSystemRowsToScroll();
+
+        // Start (or stop) the pseudoconsoles that new tabs will be attached to.
+        const auto poolSize = _settings.GlobalSettings().PseudoConsolePoolSize();
+        TerminalConnection::ConptyConnection::SetPseudoConsolePoolSize(gsl::narrow_cast<uint32_t>(std::max(poolSize, 0)));
+        TerminalConnection::ConptyConnection::SetMultiplexedOutput(_settings.GlobalSettings().MultiplexedConptyOutput());
     }
 
     bool TerminalPage::IsElevated() const noexcept
@@ -173,6 +179,13 @@ namespace winrt::TerminalApp::implementation
 
     void TerminalPage::Create()
     {
+        TraceLoggingWrite(
+            g_hTerminalAppProvider,
+            "TerminalPageCreateStarted",
+            TraceLoggingDescription("Event emitted before the tab row and the page content are set up"),
+            TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+            TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+
         // Hookup the key bindings
         _HookupKeyBindings(_settings.ActionMap());
 
@@ -333,7 +346,15 @@ namespace winrt::TerminalApp::implementation
         }
         CATCH_LOG();
 
-        ShowSetAsDefaultInfoBar();
+        // ShowSetAsDefaultInfoBar() enumerates the installed terminals. The
+        // AppLogic calls it once the first frame has been rendered.
+
+        TraceLoggingWrite(
+            g_hTerminalAppProvider,
+            "TerminalPageCreateComplete",
+            TraceLoggingDescription("Event emitted after the tab row and the page content were set up"),
+            TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+            TraceLoggingKeyword(TIL_KEYWORD_TRACE));
     }
 
     // Method Description;
@@ -605,7 +626,7 @@ namespace winrt::TerminalApp::implementation
 
             try
             {
-                winrt::Microsoft::Terminal::TerminalConnection::ConptyConnection::StartInboundListener();
+                winrt::Microsoft::Terminal::TerminalConnection::ConptyConnection::StartInboundListener(_isPersistentInboundListener);
             }
             // If we failed to start the listener, it will throw.
             // We don't want to fail fast here because if a peasant has some trouble with
@@ -1096,8 +1117,18 @@ namespace winrt::TerminalApp::implementation
         auto connectionType = profile.ConnectionType();
         winrt::guid sessionGuid{};
 
-        if (connectionType == TerminalConnection::AzureConnection::ConnectionType() &&
-            TerminalConnection::AzureConnection::IsAzureConnectionAvailable())
+        if (const auto muxEndpoint = profile.MuxEndpoint(); !muxEndpoint.empty())
+        {
+            // The commandline is run by the multiplexer at the endpoint.
+            connection = TerminalConnection::MuxConnection();
+            connection.Initialize(TerminalConnection::MuxConnection::CreateSettings(muxEndpoint,
+                                                                                    settings.Commandline(),
+                                                                                    settings.InitialRows(),
+                                                                                    settings.InitialCols()));
+        }
+
+        else if (connectionType == TerminalConnection::AzureConnection::ConnectionType() &&
+                 TerminalConnection::AzureConnection::IsAzureConnectionAvailable())
         {
             // TODO GH#4661: Replace this with directly using the AzCon when our VT is better
             std::filesystem::path azBridgePath{ wil::GetModuleFileNameW<std::wstring>(nullptr) };
@@ -2552,6 +2583,16 @@ namespace winrt::TerminalApp::implementation
         {
             connection.Resize(controlSettings.DefaultSettings().InitialRows(), controlSettings.DefaultSettings().InitialCols());
         }
+        else if (const auto recordingDirectory = profile.RecordingDirectory(); !recordingDirectory.empty())
+        {
+            // Failing to record must never prevent the session from starting.
+            try
+            {
+                const std::filesystem::path directory{ wil::ExpandEnvironmentStringsW<std::wstring>(recordingDirectory.c_str()) };
+                connection = OpenSessionRecordingConnection(connection, directory, profile.Name(), profile.RecordInput());
+            }
+            CATCH_LOG();
+        }
 
         TerminalConnection::ITerminalConnection debugConnection{ nullptr };
         if (_settings.GlobalSettings().DebugFeaturesEnabled())
@@ -2843,6 +2884,8 @@ namespace winrt::TerminalApp::implementation
     // - Notifies this Terminal Page that it should start the incoming connection
     //   listener for command-line tools attempting to join this Terminal
     //   through the default application channel.
+    // - If we're doing it of our own accord, we keep listening after the first
+    //   connection, so that every following one opens a tab in this window.
     // Arguments:
     // - isEmbedding - True if COM started us to be a server. False if we're doing it of our own accord.
     // Return Value:
@@ -2850,7 +2893,10 @@ namespace winrt::TerminalApp::implementation
     void TerminalPage::SetInboundListener(bool isEmbedding)
     {
         _shouldStartInboundListener = true;
-        _isEmbeddingInboundListener = isEmbedding;
+        // Both may be requested before we're initialized: when COM started
+        // the process that then became the monarch.
+        _isEmbeddingInboundListener = _isEmbeddingInboundListener || isEmbedding;
+        _isPersistentInboundListener = _isPersistentInboundListener || !isEmbedding;
 
         // If the page has already passed the NotInitialized state,
         // then it is ready-enough for us to just start this immediately.
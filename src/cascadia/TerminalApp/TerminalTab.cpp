@@ -168,6 +168,29 @@ namespace winrt::TerminalApp::implementation
         }
     }
 
+    // Method Description:
+    // - Tells our controls whether our content is shown, which is only the case
+    //   while we're the selected tab. Hidden controls don't paint and their
+    //   output is written after that of all visible ones.
+    // Arguments:
+    // - visible: whether our content is shown in the window.
+    // Return Value:
+    // - <none>
+    void TerminalTab::SetContentVisible(const bool visible)
+    {
+        if (std::exchange(_contentVisible, visible) == visible)
+        {
+            return;
+        }
+
+        _rootPane->WalkTree([&](auto&& pane) {
+            if (const auto& control{ pane->GetTerminalControl() })
+            {
+                control.ContentVisibilityChanged(visible);
+            }
+        });
+    }
+
     // Method Description:
     // - Returns nullptr if no children of this tab were the last control to be
     //   focused, the active control of the current pane, or the last active child control
@@ -822,6 +845,7 @@ namespace winrt::TerminalApp::implementation
             control.SetTaskbarProgress(events.taskbarToken);
             control.ReadOnlyChanged(events.readOnlyToken);
             control.FocusFollowMouseRequested(events.focusToken);
+            control.InputSent(events.inputSentToken);
 
             _controlEvents.erase(paneId);
         }
@@ -840,6 +864,10 @@ namespace winrt::TerminalApp::implementation
     // - <none>
     void TerminalTab::_AttachEventHandlersToControl(const uint32_t paneId, const TermControl& control)
     {
+        // Controls that are split off or moved into a tab in the background are hidden as well,
+        // and those that are moved out of one into the selected tab are shown again.
+        control.ContentVisibilityChanged(_contentVisible);
+
         auto weakThis{ get_weak() };
         auto dispatcher = TabViewItem().Dispatcher();
         ControlEventTokens events{};
@@ -865,7 +893,12 @@ namespace winrt::TerminalApp::implementation
         });
 
         events.taskbarToken = control.SetTaskbarProgress([dispatcher, weakThis](auto&&, auto&&) -> winrt::fire_and_forget {
-            co_await wil::resume_foreground(dispatcher);
+            // The control raises this on the UI thread already, so there's
+            // usually no need to go through the dispatcher a second time.
+            if (!dispatcher.HasThreadAccess())
+            {
+                co_await wil::resume_foreground(dispatcher);
+            }
             // Check if Tab's lifetime has expired
             if (auto tab{ weakThis.get() })
             {
@@ -893,6 +926,13 @@ namespace winrt::TerminalApp::implementation
             }
         });
 
+        events.inputSentToken = control.InputSent([weakThis, paneId](auto&&, const winrt::Microsoft::Terminal::Control::InputSentEventArgs& args) {
+            if (const auto tab{ weakThis.get() })
+            {
+                tab->_BroadcastInput(paneId, args.Text());
+            }
+        });
+
         _controlEvents[paneId] = events;
     }
 
@@ -1725,6 +1765,108 @@ namespace winrt::TerminalApp::implementation
         });
     }
 
+    // Method Description:
+    // - Toggles broadcasting the input of the focused pane to all the other
+    //   panes in this tab.
+    void TerminalTab::ToggleBroadcastInput()
+    {
+        _broadcastInput = !_broadcastInput;
+        _tabStatus.IsInputBroadcastActive(_broadcastInput);
+    }
+
+    // Method Description:
+    // - Called whenever the user typed or pasted something into one of our
+    //   panes. If we're broadcasting, queues the already encoded input for all
+    //   the other panes. The key translation only happened once, in the pane
+    //   the input was sent to. That's fine, because ConPTY connections all use
+    //   win32-input-mode, whose encoding doesn't depend on the state of the
+    //   terminal.
+    // Arguments:
+    // - sourcePaneId: the ID of the pane the input was sent to.
+    // - text: the input as it was written to the source pane's connection.
+    // Return Value:
+    // - <none>
+    void TerminalTab::_BroadcastInput(const uint32_t sourcePaneId, const winrt::hstring& text)
+    {
+        if (!_broadcastInput || text.empty())
+        {
+            return;
+        }
+
+        std::vector<winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection> targets;
+        _rootPane->WalkTree([&](const auto& p) {
+            if (p->Id() == sourcePaneId)
+            {
+                return;
+            }
+            if (const auto& control{ p->GetTerminalControl() }; control && !control.ReadOnly())
+            {
+                if (auto connection{ control.Connection() })
+                {
+                    targets.emplace_back(std::move(connection));
+                }
+            }
+        });
+
+        if (targets.empty())
+        {
+            return;
+        }
+
+        {
+            const std::lock_guard guard{ _broadcastQueue->lock };
+            _broadcastQueue->pending.emplace_back(text, std::move(targets));
+            if (std::exchange(_broadcastQueue->draining, true))
+            {
+                // The drain that is already running will pick it up.
+                return;
+            }
+        }
+
+        _DrainBroadcastQueue(_broadcastQueue);
+    }
+
+    // Method Description:
+    // - Writes all the queued broadcast input to its target connections, on a
+    //   background thread. Only one drain runs at a time, which keeps the input
+    //   in order. The queue is shared, so that it outlives the tab if the tab
+    //   is closed while we're still writing.
+    // Arguments:
+    // - queue: the queue to drain.
+    // Return Value:
+    // - <none>
+    winrt::fire_and_forget TerminalTab::_DrainBroadcastQueue(const std::shared_ptr<BroadcastQueue> queue)
+    {
+        co_await winrt::resume_background();
+
+        decltype(queue->pending) batch;
+        for (;;)
+        {
+            {
+                const std::lock_guard guard{ queue->lock };
+                if (queue->pending.empty())
+                {
+                    queue->draining = false;
+                    co_return;
+                }
+                batch.swap(queue->pending);
+            }
+
+            for (const auto& [text, targets] : batch)
+            {
+                for (const auto& connection : targets)
+                {
+                    try
+                    {
+                        connection.WriteInput(text);
+                    }
+                    CATCH_LOG();
+                }
+            }
+            batch.clear();
+        }
+    }
+
     // Method Description:
     // - Calculates if the tab is read-only.
     // The tab is considered read-only if one of the panes is read-only.
@@ -30,6 +30,7 @@ namespace winrt::TerminalApp::implementation
         winrt::Microsoft::Terminal::Settings::Model::Profile GetFocusedProfile() const noexcept;
 
         void Focus(winrt::Windows::UI::Xaml::FocusState focusState) override;
+        void SetContentVisible(const bool visible);
 
         winrt::fire_and_forget Scroll(const int delta);
 
@@ -86,6 +87,7 @@ namespace winrt::TerminalApp::implementation
         int GetLeafPaneCount() const noexcept;
 
         void TogglePaneReadOnly();
+        void ToggleBroadcastInput();
         std::shared_ptr<Pane> GetActivePane() const;
         winrt::TerminalApp::TaskbarState GetCombinedTaskbarState() const;
 
@@ -125,9 +127,23 @@ namespace winrt::TerminalApp::implementation
             winrt::event_token taskbarToken;
             winrt::event_token readOnlyToken;
             winrt::event_token focusToken;
+            winrt::event_token inputSentToken;
         };
         std::unordered_map<uint32_t, ControlEventTokens> _controlEvents;
 
+        // While broadcasting, the input of the focused pane is written to the
+        // connections of all the other panes. This is done from a single
+        // background drain, so that the focused pane doesn't wait on the
+        // fan-out and the targets receive the input in order.
+        struct BroadcastQueue
+        {
+            std::mutex lock;
+            std::vector<std::pair<winrt::hstring, std::vector<winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection>>> pending;
+            bool draining{ false };
+        };
+        std::shared_ptr<BroadcastQueue> _broadcastQueue{ std::make_shared<BroadcastQueue>() };
+        bool _broadcastInput{ false };
+
         winrt::event_token _rootClosedToken{};
 
         std::vector<uint32_t> _mruPanes;
@@ -136,6 +152,7 @@ namespace winrt::TerminalApp::implementation
         bool _receivedKeyDown{ false };
         bool _iconHidden{ false };
         bool _changingActivePane{ false };
+        bool _contentVisible{ true };
 
         winrt::hstring _runtimeTabText{};
         bool _inRename{ false };
@@ -171,6 +188,9 @@ namespace winrt::TerminalApp::implementation
 
         void _RecalculateAndApplyReadOnly();
 
+        void _BroadcastInput(const uint32_t sourcePaneId, const winrt::hstring& text);
+        static winrt::fire_and_forget _DrainBroadcastQueue(const std::shared_ptr<BroadcastQueue> queue);
+
         void _UpdateProgressState();
 
         void _DuplicateTab();
@@ -75,6 +75,7 @@ TRACELOGGING_DECLARE_PROVIDER(g_hTerminalAppProvider);
 
 #include <msctf.h>
 #include <shellapi.h>
+#include <psapi.h>
 #include <shobjidl_core.h>
 
 #include <CLI11/CLI11.hpp>
@@ -11,17 +11,24 @@ using namespace Microsoft::WRL;
 static NewHandoffFunction _pfnHandoff = nullptr;
 // The registration ID of the class object for clean up later
 static DWORD g_cTerminalHandoffRegistration = 0;
+// Whether we keep listening after the first handoff
+static bool _persistent = false;
 // Mutex so we only do start/stop/establish one at a time.
 static std::shared_mutex _mtx;
 
 // Routine Description:
 // - Starts listening for TerminalHandoff requests by registering
 //   our class and interface with COM.
+// - A process that COM started to receive a single handoff only listens until
+//   it got it. A process that is already running can instead keep listening,
+//   so that COM hands every following session to it, rather than starting a
+//   new process for each of them.
 // Arguments:
 // - pfnHandoff - Function to callback when a handoff is received
+// - persistent - True to keep listening after the first handoff
 // Return Value:
 // - S_OK, E_NOT_VALID_STATE (start called when already started) or relevant COM registration error.
-HRESULT CTerminalHandoff::s_StartListening(NewHandoffFunction pfnHandoff)
+HRESULT CTerminalHandoff::s_StartListening(NewHandoffFunction pfnHandoff, const bool persistent)
 try
 {
     std::unique_lock lock{ _mtx };
@@ -35,9 +42,11 @@ try
     ComPtr<IUnknown> unk;
     RETURN_IF_FAILED(classFactory.As(&unk));
 
-    RETURN_IF_FAILED(CoRegisterClassObject(__uuidof(CTerminalHandoff), unk.Get(), CLSCTX_LOCAL_SERVER, REGCLS_SINGLEUSE, &g_cTerminalHandoffRegistration));
+    const auto flags = persistent ? REGCLS_MULTIPLEUSE : REGCLS_SINGLEUSE;
+    RETURN_IF_FAILED(CoRegisterClassObject(__uuidof(CTerminalHandoff), unk.Get(), CLSCTX_LOCAL_SERVER, flags, &g_cTerminalHandoffRegistration));
 
     _pfnHandoff = pfnHandoff;
+    _persistent = persistent;
 
     return S_OK;
 }
@@ -57,6 +66,7 @@ HRESULT CTerminalHandoff::s_StopListening()
     RETURN_HR_IF_NULL(E_NOT_VALID_STATE, _pfnHandoff);
 
     _pfnHandoff = nullptr;
+    _persistent = false;
 
     if (g_cTerminalHandoffRegistration)
     {
@@ -104,9 +114,12 @@ HRESULT CTerminalHandoff::EstablishPtyHandoff(HANDLE in, HANDLE out, HANDLE sign
         // Stash a local copy of _pfnHandoff before we stop listening.
         auto localPfnHandoff = _pfnHandoff;
 
-        // Because we are REGCLS_SINGLEUSE... we need to `CoRevokeClassObject` after we handle this ONE call.
+        // If we are REGCLS_SINGLEUSE... we need to `CoRevokeClassObject` after we handle this ONE call.
         // COM does not automatically clean that up for us. We must do it.
-        s_StopListening();
+        if (!_persistent)
+        {
+            s_StopListening();
+        }
 
         std::unique_lock lock{ _mtx };
 
@@ -41,7 +41,7 @@ struct __declspec(uuid(__CLSID_CTerminalHandoff))
 
 #pragma endregion
 
-    static HRESULT s_StartListening(NewHandoffFunction pfnHandoff);
+    static HRESULT s_StartListening(NewHandoffFunction pfnHandoff, const bool persistent);
     static HRESULT s_StopListening();
 };
 
@@ -37,6 +37,35 @@ static constexpr auto _errorFormat = L"{0} ({0:#010x})"sv;
 
 namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 {
+    // Function Description:
+    // - Creates a unidirectional pipe just like CreatePipe, except that the read side is opened for
+    //   overlapped I/O, which anonymous pipes don't support. This allows _OutputThread to keep
+    //   a read in flight while it's handing off the previous chunk of output.
+    // Arguments:
+    // - readSide: Receives the overlapped read side of the pipe.
+    // - writeSide: Receives the synchronous write side of the pipe.
+    // - bufferSize: The size of the pipe's buffer.
+    static HRESULT _CreateOverlappedPipe(wil::unique_hfile& readSide, wil::unique_hfile& writeSide, const DWORD bufferSize) noexcept
+    try
+    {
+        const auto name{ fmt::format(LR"(\\.\pipe\Local\ConptyOutput-{}-{})", GetCurrentProcessId(), Utils::GuidToString(Utils::CreateGuid())) };
+
+        readSide.reset(CreateNamedPipeW(name.c_str(),
+                                        PIPE_ACCESS_INBOUND | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+                                        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                        1,
+                                        0,
+                                        bufferSize,
+                                        0,
+                                        nullptr));
+        RETURN_LAST_ERROR_IF(!readSide);
+
+        writeSide.reset(CreateFileW(name.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+        RETURN_LAST_ERROR_IF(!writeSide);
+        return S_OK;
+    }
+    CATCH_RETURN()
+
     // Function Description:
     // - creates some basic anonymous pipes and passes them to CreatePseudoConsole
     // Arguments:
@@ -53,13 +82,148 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         wil::unique_hfile inPipeOurSide, inPipePseudoConsoleSide;
 
         RETURN_IF_WIN32_BOOL_FALSE(CreatePipe(&inPipePseudoConsoleSide, &inPipeOurSide, nullptr, 0));
-        RETURN_IF_WIN32_BOOL_FALSE(CreatePipe(&outPipeOurSide, &outPipePseudoConsoleSide, nullptr, 0));
+        RETURN_IF_FAILED(_CreateOverlappedPipe(outPipeOurSide, outPipePseudoConsoleSide, 128 * 1024));
         RETURN_IF_FAILED(ConptyCreatePseudoConsole(size, inPipePseudoConsoleSide.get(), outPipePseudoConsoleSide.get(), dwFlags, phPC));
         *phInput = inPipeOurSide.release();
         *phOutput = outPipeOurSide.release();
         return S_OK;
     }
 
+    // The pseudoconsoles in the pool are created with these flags and this size.
+    // A connection that asks for different flags can't use them.
+    static constexpr DWORD _pooledPseudoConsoleFlags{ PSEUDOCONSOLE_RESIZE_QUIRK | PSEUDOCONSOLE_WIN32_INPUT_MODE | PSEUDOCONSOLE_REPEAT_CHARACTER_MODE };
+    static constexpr til::size _pooledPseudoConsoleSize{ 120, 30 };
+    static constexpr uint32_t _maxPseudoConsolePoolSize{ 8 };
+
+    struct PooledPseudoConsole
+    {
+        wil::unique_hfile inPipe;
+        wil::unique_hfile outPipe;
+        wil::unique_static_pseudoconsole_handle hPC;
+    };
+
+    struct PseudoConsolePool
+    {
+        std::mutex mutex;
+        std::vector<PooledPseudoConsole> items;
+        uint32_t targetSize{ 0 };
+        bool refillQueued{ false };
+    };
+
+    // Function Description:
+    // - Returns the pool of headless conhosts that were started ahead of time,
+    //   so that new connections only have to launch their client.
+    // - The pool is intentionally leaked: closing a pseudoconsole waits for its
+    //   conhost to exit, which we must not do during DLL unload. The conhosts
+    //   exit on their own once our ends of their pipes are gone.
+    static PseudoConsolePool& _pseudoConsolePool()
+    {
+        static auto pool = new PseudoConsolePool{};
+        return *pool;
+    }
+
+    // Whether connections that are started from now on read their output through
+    // the shared output thread pool instead of a thread of their own.
+    static std::atomic<bool> _multiplexedOutput{ false };
+
+    // The output of all connections is handled by at most this many threads. Handing
+    // off a chunk can block while the terminal is busy, so it's more than one thread,
+    // so that a single busy pane doesn't hold up the output of all others.
+    static constexpr DWORD _maxMultiplexedOutputThreads{ 4 };
+
+    // Function Description:
+    // - Returns the callback environment of the thread pool that completes the
+    //   output reads of the connections with multiplexed output. Its threads are
+    //   woken up by the completion port the pool manages for the output pipes.
+    // - The pool is intentionally leaked, just like the pseudoconsole pool.
+    static PTP_CALLBACK_ENVIRON _multiplexedOutputEnvironment()
+    {
+        static const auto environment = []() {
+            const auto pool = CreateThreadpool(nullptr);
+            THROW_LAST_ERROR_IF_NULL(pool);
+            SetThreadpoolThreadMaximum(pool, _maxMultiplexedOutputThreads);
+            LOG_IF_WIN32_BOOL_FALSE(SetThreadpoolThreadMinimum(pool, 1));
+
+            const auto environment = new TP_CALLBACK_ENVIRON{};
+            InitializeThreadpoolEnvironment(environment);
+            SetThreadpoolCallbackPool(environment, pool);
+            return environment;
+        }();
+        return environment;
+    }
+
+    static void CALLBACK _RefillPseudoConsolePool(PTP_CALLBACK_INSTANCE /*instance*/, PVOID /*context*/) noexcept
+    try
+    {
+        auto& pool = _pseudoConsolePool();
+        std::unique_lock lock{ pool.mutex };
+
+        // Creating a pseudoconsole spawns a conhost, so we do it outside of the lock.
+        while (pool.items.size() < pool.targetSize)
+        {
+            lock.unlock();
+            PooledPseudoConsole item;
+            const auto hr = _CreatePseudoConsoleAndPipes(til::unwrap_coord_size(_pooledPseudoConsoleSize), _pooledPseudoConsoleFlags, &item.inPipe, &item.outPipe, &item.hPC);
+            lock.lock();
+
+            if (FAILED(hr))
+            {
+                LOG_HR(hr);
+                break;
+            }
+
+            pool.items.emplace_back(std::move(item));
+        }
+
+        // The pool might have been shrunk in the meantime. The excess pseudoconsoles
+        // are closed once we release the lock, because that waits for their conhosts to exit.
+        std::vector<PooledPseudoConsole> excess;
+        if (pool.items.size() > pool.targetSize)
+        {
+            const auto first = pool.items.begin() + pool.targetSize;
+            excess.insert(excess.end(), std::make_move_iterator(first), std::make_move_iterator(pool.items.end()));
+            pool.items.erase(first, pool.items.end());
+        }
+
+        pool.refillQueued = false;
+        lock.unlock();
+    }
+    CATCH_LOG()
+
+    // Function Description:
+    // - Queues _RefillPseudoConsolePool on the thread pool, unless the pool has the desired size already.
+    //   The caller must hold the pool's lock.
+    static void _QueuePseudoConsolePoolRefill(PseudoConsolePool& pool) noexcept
+    {
+        if (!pool.refillQueued && pool.items.size() != pool.targetSize)
+        {
+            pool.refillQueued = TrySubmitThreadpoolCallback(&_RefillPseudoConsolePool, nullptr, nullptr) != FALSE;
+            LOG_LAST_ERROR_IF(!pool.refillQueued);
+        }
+    }
+
+    // Function Description:
+    // - Takes the oldest pseudoconsole out of the pool, if there's one, and starts replacing it.
+    // Arguments:
+    // - item: Receives the pseudoconsole.
+    // Return Value:
+    // - true if we got a pseudoconsole from the pool.
+    static bool _TakePooledPseudoConsole(PooledPseudoConsole& item)
+    {
+        auto& pool = _pseudoConsolePool();
+        const std::lock_guard guard{ pool.mutex };
+
+        if (pool.items.empty())
+        {
+            return false;
+        }
+
+        item = std::move(pool.items.front());
+        pool.items.erase(pool.items.begin());
+        _QueuePseudoConsolePoolRefill(pool);
+        return true;
+    }
+
     // Function Description:
     // - launches the client application attached to the new pseudoconsole
     HRESULT ConptyConnection::_LaunchAttachedClient() noexcept
@@ -299,7 +463,18 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         // handoff from an already-started PTY process.
         if (!_inPipe)
         {
-            DWORD flags = PSEUDOCONSOLE_RESIZE_QUIRK | PSEUDOCONSOLE_WIN32_INPUT_MODE;
+            _overlappedOutput = true;
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+            TraceLoggingWrite(
+                g_hTerminalConnectionProvider,
+                "ConPtySpawnStarted",
+                TraceLoggingDescription("Event emitted before the pseudoconsole and its client are created"),
+                TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+
+            // We understand REP, so conpty can use it for runs of the same character.
+            DWORD flags = PSEUDOCONSOLE_RESIZE_QUIRK | PSEUDOCONSOLE_WIN32_INPUT_MODE | PSEUDOCONSOLE_REPEAT_CHARACTER_MODE;
 
             if constexpr (Feature_VtPassthroughMode::IsEnabled())
             {
@@ -309,7 +484,23 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 }
             }
 
-            THROW_IF_FAILED(_CreatePseudoConsoleAndPipes(til::unwrap_coord_size(dimensions), flags, &_inPipe, &_outPipe, &_hPC));
+            // If there's a pseudoconsole waiting for us in the pool, we only need to launch the client.
+            PooledPseudoConsole pooled;
+            if (flags == _pooledPseudoConsoleFlags && _TakePooledPseudoConsole(pooled))
+            {
+                _inPipe = std::move(pooled.inPipe);
+                _outPipe = std::move(pooled.outPipe);
+                _hPC = std::move(pooled.hPC);
+
+                if (dimensions != _pooledPseudoConsoleSize)
+                {
+                    THROW_IF_FAILED(ConptyResizePseudoConsole(_hPC.get(), til::unwrap_coord_size(dimensions)));
+                }
+            }
+            else
+            {
+                THROW_IF_FAILED(_CreatePseudoConsoleAndPipes(til::unwrap_coord_size(dimensions), flags, &_inPipe, &_outPipe, &_hPC));
+            }
 
             if (_initialParentHwnd != 0)
             {
@@ -323,6 +514,14 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
             }
 
             THROW_IF_FAILED(_LaunchAttachedClient());
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+            TraceLoggingWrite(
+                g_hTerminalConnectionProvider,
+                "ConPtySpawnComplete",
+                TraceLoggingDescription("Event emitted after the client was launched into the pseudoconsole"),
+                TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                TraceLoggingKeyword(TIL_KEYWORD_TRACE));
         }
         // But if it was an inbound handoff... attempt to synchronize the size of it with what our connection
         // window is expecting it to be on the first layout.
@@ -349,27 +548,14 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         _startTime = std::chrono::high_resolution_clock::now();
 
-        // Create our own output handling thread
-        // This must be done after the pipes are populated.
-        // Each connection needs to make sure to drain the output from its backing host.
-        _hOutputThread.reset(CreateThread(
-            nullptr,
-            0,
-            [](LPVOID lpParameter) noexcept {
-                const auto pInstance = static_cast<ConptyConnection*>(lpParameter);
-                if (pInstance)
-                {
-                    return pInstance->_OutputThread();
-                }
-                return gsl::narrow_cast<DWORD>(E_INVALIDARG);
-            },
-            this,
-            0,
-            nullptr));
-
-        THROW_LAST_ERROR_IF_NULL(_hOutputThread);
-
-        LOG_IF_FAILED(SetThreadDescription(_hOutputThread.get(), L"ConptyConnection Output Thread"));
+        if (_overlappedOutput && _multiplexedOutput.load(std::memory_order_relaxed))
+        {
+            _StartMultiplexedOutput();
+        }
+        else
+        {
+            _StartOutputThread();
+        }
 
         _clientExitWait.reset(CreateThreadpoolWait(
             [](PTP_CALLBACK_INSTANCE /*callbackInstance*/, PVOID context, PTP_WAIT /*wait*/, TP_WAIT_RESULT /*waitResult*/) noexcept {
@@ -450,10 +636,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         // Close the pseudoconsole and wait for all output to drain.
         _hPC.reset();
-        if (auto localOutputThreadHandle = std::move(_hOutputThread))
-        {
-            LOG_LAST_ERROR_IF(WAIT_FAILED == WaitForSingleObject(localOutputThreadHandle.get(), INFINITE));
-        }
+        _WaitForOutputReader();
 
         _indicateExitWithStatus(exitCode);
 
@@ -542,13 +725,9 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
             _inPipe.reset(); // break the pipes
             _outPipe.reset();
 
-            if (_hOutputThread)
-            {
-                // Tear down our output thread -- now that the output pipe was closed on the
-                // far side, we can run down our local reader.
-                LOG_LAST_ERROR_IF(WAIT_FAILED == WaitForSingleObject(_hOutputThread.get(), INFINITE));
-                _hOutputThread.reset();
-            }
+            // Tear down our output reader -- now that the output pipe was closed on the
+            // far side, we can run down our local reader.
+            _WaitForOutputReader();
 
             if (_piClient.hProcess)
             {
@@ -594,72 +773,447 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         return commandline.to_hstring();
     }
 
+    // Method Description:
+    // - Creates our own output handling thread.
+    //   This must be done after the pipes are populated.
+    //   Each connection needs to make sure to drain the output from its backing host.
+    void ConptyConnection::_StartOutputThread()
+    {
+        _hOutputThread.reset(CreateThread(
+            nullptr,
+            0,
+            [](LPVOID lpParameter) noexcept {
+                const auto pInstance = static_cast<ConptyConnection*>(lpParameter);
+                if (pInstance)
+                {
+                    return pInstance->_OutputThread();
+                }
+                return gsl::narrow_cast<DWORD>(E_INVALIDARG);
+            },
+            this,
+            0,
+            nullptr));
+
+        THROW_LAST_ERROR_IF_NULL(_hOutputThread);
+
+        LOG_IF_FAILED(SetThreadDescription(_hOutputThread.get(), L"ConptyConnection Output Thread"));
+    }
+
+    // Method Description:
+    // - Starts draining the output from our backing host with reads that are
+    //   completed by the shared output thread pool, instead of a thread of our own.
+    //   Only one read is in flight at a time and the next one is only started
+    //   after the previous chunk was handed off, so that the chunks stay in order.
+    // - The output pipe must have been opened for overlapped I/O.
+    void ConptyConnection::_StartMultiplexedOutput()
+    {
+        _outputDone.create(wil::EventOptions::ManualReset);
+        _outputIo.reset(CreateThreadpoolIo(
+            _outPipe.get(),
+            [](PTP_CALLBACK_INSTANCE /*callbackInstance*/, PVOID context, PVOID /*overlapped*/, ULONG ioResult, ULONG_PTR bytesTransferred, PTP_IO /*io*/) noexcept {
+                const auto pInstance = static_cast<ConptyConnection*>(context);
+                if (pInstance)
+                {
+                    pInstance->_MultiplexedReadCompleted(HRESULT_FROM_WIN32(ioResult), gsl::narrow_cast<DWORD>(bytesTransferred));
+                }
+            },
+            this,
+            _multiplexedOutputEnvironment()));
+        THROW_LAST_ERROR_IF_NULL(_outputIo);
+
+        // Keep us alive until the last read completed, just like the output thread does.
+        _outputOwner = get_strong();
+        _multiplexedReadSize = _minOutputReadSize;
+
+        if (const auto hr = _StartMultiplexedRead(); FAILED(hr))
+        {
+            _MultiplexedReadCompleted(hr, 0);
+        }
+    }
+
+    // Method Description:
+    // - Starts the next read of the multiplexed output. Its completion, even if
+    //   it completes right away, is delivered to _MultiplexedReadCompleted().
+    // Return Value:
+    // - S_OK if the read is in flight, otherwise the error of ReadFile().
+    HRESULT ConptyConnection::_StartMultiplexedRead() noexcept
+    try
+    {
+        auto& read = _multiplexedRead;
+        if (read.buffer.size() < _multiplexedReadSize)
+        {
+            read.buffer.resize(_multiplexedReadSize);
+        }
+        read.overlapped = {};
+
+        StartThreadpoolIo(_outputIo.get());
+        if (!ReadFile(_outPipe.get(), read.buffer.data(), gsl::narrow_cast<DWORD>(read.buffer.size()), nullptr, &read.overlapped))
+        {
+            const auto lastError = GetLastError();
+            if (lastError != ERROR_IO_PENDING)
+            {
+                // No completion is going to be queued for a read that failed outright.
+                CancelThreadpoolIo(_outputIo.get());
+                RETURN_HR_IF_EXPECTED(HRESULT_FROM_WIN32(lastError), true);
+            }
+        }
+        return S_OK;
+    }
+    CATCH_RETURN()
+
+    // Method Description:
+    // - Hands off the chunk the last multiplexed read produced and starts the
+    //   next read. Once the output is done, this signals _outputDone.
+    // Arguments:
+    // - hr: The result of the read.
+    // - bytesRead: The amount of bytes that were read.
+    void ConptyConnection::_MultiplexedReadCompleted(HRESULT hr, DWORD bytesRead) noexcept
+    {
+        while (true)
+        {
+            const auto tracing = TraceLoggingProviderEnabled(g_hTerminalConnectionProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE);
+            GUID activity{};
+            if (tracing)
+            {
+                EventActivityIdControl(EVENT_ACTIVITY_CTRL_CREATE_ID, &activity);
+            }
+
+            auto& read = _multiplexedRead;
+            auto keepReading = false;
+            try
+            {
+                DWORD exitCode{};
+                keepReading = _HandleOutputChunk(hr, { read.buffer.data(), SUCCEEDED(hr) ? bytesRead : 0 }, tracing, activity, exitCode);
+            }
+            CATCH_LOG();
+
+            if (!keepReading)
+            {
+                break;
+            }
+
+            if (bytesRead == read.buffer.size() && _multiplexedReadSize < _maxOutputReadSize)
+            {
+                _multiplexedReadSize *= 2;
+            }
+
+            hr = _StartMultiplexedRead();
+            if (SUCCEEDED(hr))
+            {
+                return;
+            }
+
+            // The read failed before it got going (for instance because the pipe broke),
+            // which is handled just like a read that failed later on.
+            bytesRead = 0;
+        }
+
+        _outputDone.SetEvent();
+
+        // This might be the last reference to us, so it must be released last.
+        const auto owner{ std::move(_outputOwner) };
+    }
+
+    // Method Description:
+    // - Waits for the output reader to drain the output pipe, no matter
+    //   whether it's the output thread or the multiplexed reads.
+    void ConptyConnection::_WaitForOutputReader() noexcept
+    {
+        if (auto localOutputThreadHandle = std::move(_hOutputThread))
+        {
+            LOG_LAST_ERROR_IF(WAIT_FAILED == WaitForSingleObject(localOutputThreadHandle.get(), INFINITE));
+        }
+        if (_outputDone)
+        {
+            LOG_LAST_ERROR_IF(WAIT_FAILED == WaitForSingleObject(_outputDone.get(), INFINITE));
+        }
+    }
+
+    // Method Description:
+    // - Starts reading up to `size` bytes of output into the given buffer.
+    //   If the output pipe wasn't opened for overlapped I/O (for instance if it
+    //   was handed off to us), this simply blocks until the read has completed.
+    // Arguments:
+    // - read: The buffer to read into. It must not have a read in flight.
+    // - size: The amount of bytes to read at most.
+    // Return Value:
+    // - S_OK if the read is in flight or has completed, otherwise the error of ReadFile().
+    HRESULT ConptyConnection::_StartOutputRead(OutputRead& read, const size_t size) noexcept
+    try
+    {
+        if (!read.event)
+        {
+            read.event.create(wil::EventOptions::ManualReset);
+        }
+        if (read.buffer.size() < size)
+        {
+            read.buffer.resize(size);
+        }
+
+        read.overlapped = {};
+        read.overlapped.hEvent = read.event.get();
+
+        if (!ReadFile(_outPipe.get(), read.buffer.data(), gsl::narrow_cast<DWORD>(read.buffer.size()), nullptr, &read.overlapped))
+        {
+            const auto lastError = GetLastError();
+            RETURN_HR_IF_EXPECTED(HRESULT_FROM_WIN32(lastError), lastError != ERROR_IO_PENDING);
+        }
+
+        read.inFlight = true;
+        return S_OK;
+    }
+    CATCH_RETURN()
+
+    // Method Description:
+    // - Waits for the read started by _StartOutputRead() to complete.
+    // Arguments:
+    // - read: The buffer with the read in flight.
+    // - bytesRead: Receives the amount of bytes that were read.
+    // Return Value:
+    // - S_OK if the read succeeded, otherwise the error it failed with.
+    HRESULT ConptyConnection::_FinishOutputRead(OutputRead& read, DWORD& bytesRead) noexcept
+    {
+        read.inFlight = false;
+        bytesRead = 0;
+        if (!GetOverlappedResult(_outPipe.get(), &read.overlapped, &bytesRead, TRUE))
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+        return S_OK;
+    }
+
+    // Method Description:
+    // - Cancels the given read if it's still in flight and waits for it to complete,
+    //   so that its buffer can be safely released.
+    void ConptyConnection::_CancelOutputRead(OutputRead& read) noexcept
+    {
+        if (read.inFlight)
+        {
+            CancelIoEx(_outPipe.get(), &read.overlapped);
+            DWORD bytesRead{};
+            std::ignore = _FinishOutputRead(read, bytesRead);
+        }
+    }
+
     DWORD ConptyConnection::_OutputThread()
     {
         // Keep us alive until the output thread terminates; the destructor
         // won't wait for us, and the known exit points _do_.
         auto strongThis{ get_strong() };
 
+        // If the output pipe was opened for overlapped I/O, we alternate between two buffers:
+        // the next read is already in flight while the previous chunk is converted and handed
+        // off to the terminal, which is often the slower part. Inbound connections come with a
+        // synchronous pipe instead, on which starting the next read would block until more
+        // output arrived, holding back the chunk we already have. Those are read one chunk at a
+        // time, into a single buffer. The buffers start out small, so that interactive applications get their
+        // output through immediately, but grow whenever a read fills them completely.
+        // That only happens under backpressure, in which case bigger reads result in
+        // fewer but larger writes to the terminal.
+        std::array<OutputRead, 2> reads;
+        auto readSize{ _minOutputReadSize };
+        size_t current{ 0 };
+
+        auto cancelReads = wil::scope_exit([&]() noexcept {
+            for (auto& read : reads)
+            {
+                _CancelOutputRead(read);
+            }
+        });
+
+        auto hr{ _StartOutputRead(til::at(reads, current), readSize) };
+
         // process the data of the output pipe in a loop
         while (true)
         {
+            auto& completed{ til::at(reads, current) };
             DWORD read{};
 
-            const auto readFail{ !ReadFile(_outPipe.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), &read, nullptr) };
-            if (readFail) // reading failed (we must check this first, because read will also be 0.)
+            // While tracing, every chunk gets its own activity ID. The control passes it on along
+            // with the chunk, so that the chunk can be followed through the whole output pipeline.
+            const auto tracing = TraceLoggingProviderEnabled(g_hTerminalConnectionProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE);
+            GUID activity{};
+            if (tracing)
             {
-                const auto lastError = GetLastError();
-                if (lastError != ERROR_BROKEN_PIPE && !_isStateAtOrBeyond(ConnectionState::Closing))
-                {
-                    // EXIT POINT
-                    _indicateExitWithStatus(HRESULT_FROM_WIN32(lastError)); // print a message
-                    _transitionToState(ConnectionState::Failed);
-                    return gsl::narrow_cast<DWORD>(HRESULT_FROM_WIN32(lastError));
-                }
-                // else we call convertUTF8ChunkToUTF16 with an empty string_view to convert possible remaining partials to U+FFFD
+                EventActivityIdControl(EVENT_ACTIVITY_CTRL_CREATE_SET_ID, &activity);
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+                TraceLoggingWrite(g_hTerminalConnectionProvider,
+                                  "ReadOutput",
+                                  TraceLoggingOpcode(WINEVENT_OPCODE_START),
+                                  TraceLoggingGuid(activity, "Chunk"),
+                                  TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                                  TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+            }
+
+            if (SUCCEEDED(hr))
+            {
+                hr = _FinishOutputRead(completed, read);
             }
 
-            const auto result{ til::u8u16(std::string_view{ _buffer.data(), read }, _u16Str, _u8State) };
-            if (FAILED(result))
+            if (tracing)
             {
-                if (_isStateAtOrBeyond(ConnectionState::Closing))
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+                TraceLoggingWrite(g_hTerminalConnectionProvider,
+                                  "ReadOutput",
+                                  TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+                                  TraceLoggingGuid(activity, "Chunk"),
+                                  TraceLoggingUInt32(read, "Bytes"),
+                                  TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                                  TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+            }
+
+            const auto readResult{ hr };
+            if (SUCCEEDED(hr))
+            {
+                if (read == completed.buffer.size() && readSize < _maxOutputReadSize)
                 {
-                    // This termination was expected.
-                    return 0;
+                    readSize *= 2;
                 }
 
-                // EXIT POINT
-                _indicateExitWithStatus(result); // print a message
-                _transitionToState(ConnectionState::Failed);
-                return gsl::narrow_cast<DWORD>(result);
+                if (_overlappedOutput)
+                {
+                    // Queue up the next read into the other buffer right away and only then hand off this chunk.
+                    current ^= 1;
+                    hr = _StartOutputRead(til::at(reads, current), readSize);
+
+                    // If the next read failed (for instance because the pipe broke), we still need to
+                    // process this chunk. The failure is handled once we get back to the next read.
+                }
             }
 
-            if (_u16Str.empty())
+            DWORD exitCode{};
+            if (!_HandleOutputChunk(readResult, { completed.buffer.data(), read }, tracing, activity, exitCode))
             {
-                return 0;
+                return exitCode;
             }
 
-            if (!_receivedFirstByte)
+            if (!_overlappedOutput && SUCCEEDED(hr))
             {
-                const auto now = std::chrono::high_resolution_clock::now();
-                const std::chrono::duration<double> delta = now - _startTime;
+                hr = _StartOutputRead(completed, readSize);
+            }
+        }
 
+        return 0;
+    }
+
+    // Method Description:
+    // - Converts a chunk of output and hands it off to the terminal. This is the part
+    //   of handling the output that's the same for the output thread and for the
+    //   multiplexed reads.
+    // Arguments:
+    // - readResult: The result of the read that produced the chunk.
+    // - chunk: The output that was read. It's empty if the read failed.
+    // - tracing: Whether the chunk is traced, see _OutputThread().
+    // - activity: The activity ID of the chunk, if it's traced.
+    // - exitCode: Receives the exit code of the reader if this returns false.
+    // Return Value:
+    // - true if the next chunk should be read, false if this was the last one.
+    bool ConptyConnection::_HandleOutputChunk(const HRESULT readResult, const std::string_view chunk, const bool tracing, const GUID& activity, DWORD& exitCode)
+    {
+        exitCode = 0;
+
+        if (FAILED(readResult)) // reading failed (we must check this first, because chunk will also be empty.)
+        {
+            if (readResult != HRESULT_FROM_WIN32(ERROR_BROKEN_PIPE) && !_isStateAtOrBeyond(ConnectionState::Closing))
+            {
+                // EXIT POINT
+                _indicateExitWithStatus(readResult); // print a message
+                _transitionToState(ConnectionState::Failed);
+                exitCode = gsl::narrow_cast<DWORD>(readResult);
+                return false;
+            }
+            // else we call convertUTF8ChunkToUTF16 with an empty string_view to convert possible remaining partials to U+FFFD
+        }
+
+        if (tracing)
+        {
 #pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
-                TraceLoggingWrite(g_hTerminalConnectionProvider,
-                                  "ReceivedFirstByte",
-                                  TraceLoggingDescription("An event emitted when the connection receives the first byte"),
-                                  TraceLoggingGuid(_guid, "SessionGuid", "The WT_SESSION's GUID"),
-                                  TraceLoggingFloat64(delta.count(), "Duration"),
-                                  TraceLoggingKeyword(MICROSOFT_KEYWORD_MEASURES),
-                                  TelemetryPrivacyDataTag(PDT_ProductAndServicePerformance));
-                _receivedFirstByte = true;
+            TraceLoggingWrite(g_hTerminalConnectionProvider,
+                              "ConvertOutput",
+                              TraceLoggingOpcode(WINEVENT_OPCODE_START),
+                              TraceLoggingGuid(activity, "Chunk"),
+                              TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                              TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+        }
+
+        const auto result{ til::u8u16(chunk, _u16Str, _u8State) };
+
+        if (tracing)
+        {
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+            TraceLoggingWrite(g_hTerminalConnectionProvider,
+                              "ConvertOutput",
+                              TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+                              TraceLoggingGuid(activity, "Chunk"),
+                              TraceLoggingUInt64(_u16Str.size(), "Length"),
+                              TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                              TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+        }
+
+        if (FAILED(result))
+        {
+            if (_isStateAtOrBeyond(ConnectionState::Closing))
+            {
+                // This termination was expected.
+                return false;
             }
 
-            // Pass the output to our registered event handlers
-            _TerminalOutputHandlers(_u16Str);
+            // EXIT POINT
+            _indicateExitWithStatus(result); // print a message
+            _transitionToState(ConnectionState::Failed);
+            exitCode = gsl::narrow_cast<DWORD>(result);
+            return false;
         }
 
-        return 0;
+        if (_u16Str.empty())
+        {
+            return false;
+        }
+
+        if (!_receivedFirstByte)
+        {
+            const auto now = std::chrono::high_resolution_clock::now();
+            const std::chrono::duration<double> delta = now - _startTime;
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+            TraceLoggingWrite(g_hTerminalConnectionProvider,
+                              "ReceivedFirstByte",
+                              TraceLoggingDescription("An event emitted when the connection receives the first byte"),
+                              TraceLoggingGuid(_guid, "SessionGuid", "The WT_SESSION's GUID"),
+                              TraceLoggingFloat64(delta.count(), "Duration"),
+                              TraceLoggingKeyword(MICROSOFT_KEYWORD_MEASURES),
+                              TelemetryPrivacyDataTag(PDT_ProductAndServicePerformance));
+            _receivedFirstByte = true;
+        }
+
+        if (tracing)
+        {
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+            TraceLoggingWrite(g_hTerminalConnectionProvider,
+                              "HandleOutput",
+                              TraceLoggingOpcode(WINEVENT_OPCODE_START),
+                              TraceLoggingGuid(activity, "Chunk"),
+                              TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                              TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+        }
+
+        // Pass the output to our registered event handlers
+        _TerminalOutputHandlers(_u16Str);
+
+        if (tracing)
+        {
+            // This spans the time the chunk spent waiting for space in the control's queue,
+            // or the whole write into the terminal, if the control doesn't have one.
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+            TraceLoggingWrite(g_hTerminalConnectionProvider,
+                              "HandleOutput",
+                              TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+                              TraceLoggingGuid(activity, "Chunk"),
+                              TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                              TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+        }
+
+        return true;
     }
 
     static winrt::event<NewConnectionHandler> _newConnectionHandlers;
@@ -676,9 +1230,37 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
     }
     CATCH_RETURN()
 
-    void ConptyConnection::StartInboundListener()
+    // Function Description:
+    // - Sets the number of headless conhosts that are kept started ahead of time.
+    //   Connections that are started afterwards take one of them (if they don't need
+    //   any special pseudoconsole flags), which saves the conhost startup when a tab opens.
+    // - Inbound connections (CTerminalHandoff) already come with a running conhost and don't use the pool.
+    // Arguments:
+    // - size: The number of pseudoconsoles to keep around. 0 disables the pool and closes its pseudoconsoles.
+    void ConptyConnection::SetPseudoConsolePoolSize(const uint32_t size)
+    {
+        auto& pool = _pseudoConsolePool();
+        const std::lock_guard guard{ pool.mutex };
+        pool.targetSize = std::min(size, _maxPseudoConsolePoolSize);
+        _QueuePseudoConsolePoolRefill(pool);
+    }
+
+    // Function Description:
+    // - Sets whether connections that are started from now on read their output
+    //   through a thread pool that's shared by all connections, instead of each
+    //   of them blocking a thread of its own on its output pipe.
+    // - Inbound connections (CTerminalHandoff) always use an output thread,
+    //   because their output pipe might not support overlapped I/O.
+    // Arguments:
+    // - enabled: Whether to multiplex the output reads.
+    void ConptyConnection::SetMultiplexedOutput(const bool enabled) noexcept
+    {
+        _multiplexedOutput.store(enabled, std::memory_order_relaxed);
+    }
+
+    void ConptyConnection::StartInboundListener(const bool persistent)
     {
-        THROW_IF_FAILED(CTerminalHandoff::s_StartListening(&ConptyConnection::NewHandoff));
+        THROW_IF_FAILED(CTerminalHandoff::s_StartListening(&ConptyConnection::NewHandoff, persistent));
     }
 
     void ConptyConnection::StopInboundListener()
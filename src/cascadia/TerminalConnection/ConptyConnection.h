@@ -43,9 +43,12 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         winrt::guid Guid() const noexcept;
         winrt::hstring Commandline() const;
 
-        static void StartInboundListener();
+        static void StartInboundListener(const bool persistent);
         static void StopInboundListener();
 
+        static void SetPseudoConsolePoolSize(const uint32_t size);
+        static void SetMultiplexedOutput(const bool enabled) noexcept;
+
         static winrt::event_token NewConnection(const NewConnectionHandler& handler);
         static void NewConnection(const winrt::event_token& token);
 
@@ -83,17 +86,48 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         wil::unique_hfile _inPipe; // The pipe for writing input to
         wil::unique_hfile _outPipe; // The pipe for reading output from
+        bool _overlappedOutput{ false }; // Whether _outPipe was opened for overlapped I/O by _CreateOverlappedPipe
         wil::unique_handle _hOutputThread;
+        // Used instead of _hOutputThread, if the output is multiplexed. See _StartMultiplexedOutput().
+        // The last completion may release the last reference to us, so this must not wait for it.
+        wil::unique_threadpool_io_nowait _outputIo;
+        wil::unique_event _outputDone;
+        winrt::com_ptr<ConptyConnection> _outputOwner;
         wil::unique_process_information _piClient;
         wil::unique_static_pseudoconsole_handle _hPC;
         wil::unique_threadpool_wait _clientExitWait;
 
         til::u8state _u8State{};
         std::wstring _u16Str{};
-        std::array<char, 4096> _buffer{};
         bool _passthroughMode{};
 
+        // One of the buffers the output thread alternates between. While the
+        // contents of one of them are handed off, the other one is being read into.
+        struct OutputRead
+        {
+            std::vector<char> buffer;
+            OVERLAPPED overlapped{};
+            wil::unique_event event;
+            bool inFlight{ false };
+        };
+
+        static constexpr size_t _minOutputReadSize{ 16 * 1024 };
+        static constexpr size_t _maxOutputReadSize{ 1024 * 1024 };
+
+        OutputRead _multiplexedRead;
+        size_t _multiplexedReadSize{ _minOutputReadSize };
+
+        void _StartOutputThread();
+        void _StartMultiplexedOutput();
+        HRESULT _StartMultiplexedRead() noexcept;
+        void _MultiplexedReadCompleted(HRESULT hr, DWORD bytesRead) noexcept;
+        void _WaitForOutputReader() noexcept;
+        bool _HandleOutputChunk(const HRESULT readResult, const std::string_view chunk, const bool tracing, const GUID& activity, DWORD& exitCode);
+
         DWORD _OutputThread();
+        HRESULT _StartOutputRead(OutputRead& read, const size_t size) noexcept;
+        HRESULT _FinishOutputRead(OutputRead& read, DWORD& bytesRead) noexcept;
+        void _CancelOutputRead(OutputRead& read) noexcept;
     };
 }
 
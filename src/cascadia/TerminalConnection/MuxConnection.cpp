@@ -0,0 +1,190 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "MuxConnection.h"
+
+#include <LibraryResources.h>
+
+#include "MuxConnection.g.cpp"
+
+using namespace ::Microsoft::Terminal::TerminalConnection;
+using namespace std::string_view_literals;
+
+static constexpr auto _errorFormat = L"{0} ({0:#010x})"sv;
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    MuxConnection::~MuxConnection()
+    {
+        // No state transitions here: nobody may observe us anymore.
+        if (_transport)
+        {
+            _transport->CloseChannel(_channel);
+        }
+    }
+
+    Windows::Foundation::Collections::ValueSet MuxConnection::CreateSettings(const winrt::hstring& endpoint,
+                                                                             const winrt::hstring& commandline,
+                                                                             uint32_t rows,
+                                                                             uint32_t columns)
+    {
+        Windows::Foundation::Collections::ValueSet vs{};
+
+        vs.Insert(L"endpoint", Windows::Foundation::PropertyValue::CreateString(endpoint));
+        vs.Insert(L"commandline", Windows::Foundation::PropertyValue::CreateString(commandline));
+        vs.Insert(L"initialRows", Windows::Foundation::PropertyValue::CreateUInt32(rows));
+        vs.Insert(L"initialCols", Windows::Foundation::PropertyValue::CreateUInt32(columns));
+
+        return vs;
+    }
+
+    void MuxConnection::Initialize(const Windows::Foundation::Collections::ValueSet& settings)
+    {
+        if (settings)
+        {
+            _endpoint = winrt::unbox_value_or<winrt::hstring>(settings.TryLookup(L"endpoint").try_as<Windows::Foundation::IPropertyValue>(), _endpoint);
+            _commandline = winrt::unbox_value_or<winrt::hstring>(settings.TryLookup(L"commandline").try_as<Windows::Foundation::IPropertyValue>(), _commandline);
+            _size.height = winrt::unbox_value_or<uint32_t>(settings.TryLookup(L"initialRows").try_as<Windows::Foundation::IPropertyValue>(), _size.height);
+            _size.width = winrt::unbox_value_or<uint32_t>(settings.TryLookup(L"initialCols").try_as<Windows::Foundation::IPropertyValue>(), _size.width);
+        }
+    }
+
+    // Method Description:
+    // - Opens the session. Connecting to the endpoint may take a while, when
+    //   there's no transport to it yet, so this happens in the background.
+    winrt::fire_and_forget MuxConnection::Start()
+    {
+        auto strongThis{ get_strong() };
+        _transitionToState(ConnectionState::Connecting);
+        co_await winrt::resume_background();
+
+        try
+        {
+            MuxTransport::ChannelCallbacks callbacks;
+            callbacks.output = [weakThis = get_weak()](std::string_view data) {
+                if (const auto self = weakThis.get())
+                {
+                    self->_OnOutput(data);
+                }
+            };
+            callbacks.closed = [weakThis = get_weak()]() {
+                if (const auto self = weakThis.get())
+                {
+                    self->_OnClosed();
+                }
+            };
+
+            til::size size;
+            {
+                const std::lock_guard guard{ _channelLock };
+                size = _size;
+            }
+            auto [transport, channel] = MuxTransport::OpenChannel(std::wstring{ _endpoint }, _commandline, size, std::move(callbacks));
+
+            {
+                const std::lock_guard guard{ _channelLock };
+                // Close() may have been called while we were connecting.
+                if (_isStateAtOrBeyond(ConnectionState::Closing))
+                {
+                    transport->CloseChannel(channel);
+                    co_return;
+                }
+                _transport = std::move(transport);
+                _channel = channel;
+                // So may Resize().
+                if (_size != size)
+                {
+                    _transport->Resize(_channel, _size);
+                }
+            }
+
+            _transitionToState(ConnectionState::Connected);
+        }
+        catch (...)
+        {
+            const auto hr = wil::ResultFromCaughtException();
+            LOG_HR(hr);
+
+            try
+            {
+                winrt::hstring failureText{ fmt::format(std::wstring_view{ RS_(L"MuxConnectionFailed") },
+                                                        fmt::format(_errorFormat, static_cast<unsigned int>(hr)),
+                                                        _endpoint) };
+                _TerminalOutputHandlers(failureText);
+            }
+            CATCH_LOG();
+
+            _transitionToState(ConnectionState::Failed);
+        }
+    }
+
+    void MuxConnection::WriteInput(const hstring& data)
+    {
+        const std::lock_guard guard{ _channelLock };
+        if (_transport)
+        {
+            _transport->Write(_channel, data);
+        }
+    }
+
+    void MuxConnection::Resize(uint32_t rows, uint32_t columns)
+    {
+        const std::lock_guard guard{ _channelLock };
+        _size = { gsl::narrow<til::CoordType>(columns), gsl::narrow<til::CoordType>(rows) };
+        if (_transport)
+        {
+            _transport->Resize(_channel, _size);
+        }
+    }
+
+    void MuxConnection::Close() noexcept
+    {
+        if (!_transitionToState(ConnectionState::Closing))
+        {
+            return;
+        }
+
+        std::shared_ptr<MuxTransport> transport;
+        {
+            const std::lock_guard guard{ _channelLock };
+            transport = std::exchange(_transport, nullptr);
+        }
+        if (transport)
+        {
+            transport->CloseChannel(_channel);
+        }
+
+        _transitionToState(ConnectionState::Closed);
+    }
+
+    void MuxConnection::_OnOutput(std::string_view data)
+    {
+        THROW_IF_FAILED(til::u8u16(data, _u16Str, _u8State));
+        if (!_u16Str.empty())
+        {
+            _TerminalOutputHandlers(winrt::hstring{ _u16Str });
+        }
+    }
+
+    // Method Description:
+    // - Called when the remote side ended the session, or the whole transport.
+    void MuxConnection::_OnClosed()
+    {
+        {
+            const std::lock_guard guard{ _channelLock };
+            _transport = nullptr;
+        }
+
+        if (_isStateOneOf(ConnectionState::Connected))
+        {
+            try
+            {
+                _TerminalOutputHandlers(L"\r\n");
+                _TerminalOutputHandlers(RS_(L"MuxSessionEnded"));
+            }
+            CATCH_LOG();
+            _transitionToState(ConnectionState::Closed);
+        }
+    }
+}
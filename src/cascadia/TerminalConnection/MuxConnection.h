@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "MuxConnection.g.h"
+#include "ConnectionStateHolder.h"
+#include "MuxTransport.h"
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    // A session in a multiplexer at a remote endpoint. Sessions to the same
+    // endpoint share a single MuxTransport, instead of each of them running
+    // its own client process behind a pseudoconsole.
+    struct MuxConnection : MuxConnectionT<MuxConnection>, ConnectionStateHolder<MuxConnection>
+    {
+        MuxConnection() = default;
+        ~MuxConnection();
+
+        static Windows::Foundation::Collections::ValueSet CreateSettings(const winrt::hstring& endpoint,
+                                                                         const winrt::hstring& commandline,
+                                                                         uint32_t rows,
+                                                                         uint32_t columns);
+
+        void Initialize(const Windows::Foundation::Collections::ValueSet& settings);
+
+        winrt::fire_and_forget Start();
+        void WriteInput(const hstring& data);
+        void Resize(uint32_t rows, uint32_t columns);
+        void Close() noexcept;
+
+        WINRT_CALLBACK(TerminalOutput, TerminalOutputHandler);
+
+    private:
+        void _OnOutput(std::string_view data);
+        void _OnClosed();
+
+        hstring _endpoint;
+        hstring _commandline;
+        til::size _size{ 80, 30 };
+
+        std::mutex _channelLock;
+        std::shared_ptr<::Microsoft::Terminal::TerminalConnection::MuxTransport> _transport;
+        uint32_t _channel{ 0 };
+
+        // Only used on the transport's reader thread.
+        til::u8state _u8State;
+        std::wstring _u16Str;
+    };
+}
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::factory_implementation
+{
+    BASIC_FACTORY(MuxConnection);
+}
@@ -0,0 +1,306 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "MuxTransport.h"
+
+#include <ws2tcpip.h>
+
+using namespace ::Microsoft::Terminal::TerminalConnection;
+
+// Frames larger than this are considered a protocol error. The remote side is
+// expected to split its output into much smaller frames than that.
+static constexpr uint32_t MaxFrameSize = 16 * 1024 * 1024;
+
+MuxTransport::MuxTransport(wil::unique_socket socket) noexcept :
+    _socket{ std::move(socket) }
+{
+}
+
+// Method Description:
+// - Opens a new session at the given endpoint. If there's a transport to the
+//   endpoint already, the session is opened over it. Otherwise a new one is
+//   connected first.
+// Arguments:
+// - endpoint: "host:port" of the multiplexer.
+// - commandline: what the multiplexer should run for this session.
+// - size: the initial size of the session.
+// - callbacks: receive the output of the session and its end.
+// Return Value:
+// - The transport and the channel of the new session in it.
+std::pair<std::shared_ptr<MuxTransport>, uint32_t> MuxTransport::OpenChannel(const std::wstring& endpoint, std::wstring_view commandline, const til::size size, ChannelCallbacks callbacks)
+{
+    static std::mutex registryLock;
+    static std::unordered_map<std::wstring, std::weak_ptr<MuxTransport>> registry;
+
+    const auto sharedCallbacks = std::make_shared<const ChannelCallbacks>(std::move(callbacks));
+
+    // The lock is held while connecting, so that several tabs that are opened
+    // at once to the same endpoint still end up with a single transport.
+    const std::lock_guard guard{ registryLock };
+    auto& entry = registry[endpoint];
+    if (auto transport = entry.lock())
+    {
+        if (const auto channel = transport->_OpenChannel(commandline, size, sharedCallbacks))
+        {
+            return { std::move(transport), *channel };
+        }
+        // Otherwise its last session just closed and it's shutting down.
+    }
+
+    auto transport = _Connect(endpoint);
+    entry = transport;
+    const auto channel = transport->_OpenChannel(commandline, size, sharedCallbacks);
+    THROW_HR_IF(E_ABORT, !channel);
+    return { std::move(transport), *channel };
+}
+
+std::shared_ptr<MuxTransport> MuxTransport::_Connect(const std::wstring& endpoint)
+{
+    static const auto startupError = []() {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data);
+    }();
+    THROW_IF_WIN32_ERROR(startupError);
+
+    const auto separator = endpoint.rfind(L':');
+    THROW_HR_IF(E_INVALIDARG, separator == std::wstring::npos || separator == 0);
+    auto host = endpoint.substr(0, separator);
+    const auto port = endpoint.substr(separator + 1);
+    // IPv6 addresses are written in brackets, as in "[::1]:22".
+    if (host.size() > 2 && host.front() == L'[' && host.back() == L']')
+    {
+        host = host.substr(1, host.size() - 2);
+    }
+
+    ADDRINFOW hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    ADDRINFOW* addresses = nullptr;
+    THROW_IF_WIN32_ERROR(GetAddrInfoW(host.c_str(), port.c_str(), &hints, &addresses));
+    const auto freeAddresses = wil::scope_exit([&]() noexcept { FreeAddrInfoW(addresses); });
+
+    auto error = WSAECONNREFUSED;
+    for (auto address = addresses; address; address = address->ai_next)
+    {
+        wil::unique_socket socket{ ::socket(address->ai_family, address->ai_socktype, address->ai_protocol) };
+        if (!socket || connect(socket.get(), address->ai_addr, gsl::narrow<int>(address->ai_addrlen)) == SOCKET_ERROR)
+        {
+            error = WSAGetLastError();
+            continue;
+        }
+
+        // Sessions are interactive: keystrokes must not wait for more data.
+        const BOOL noDelay = TRUE;
+        LOG_LAST_ERROR_IF(setsockopt(socket.get(), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay)) == SOCKET_ERROR);
+
+        auto transport = std::make_shared<MuxTransport>(std::move(socket));
+        // The reader thread keeps the transport alive until the stream ends.
+        std::thread{ [transport]() { transport->_ReadLoop(); } }.detach();
+        return transport;
+    }
+
+    THROW_WIN32(error);
+}
+
+std::optional<uint32_t> MuxTransport::_OpenChannel(std::wstring_view commandline, const til::size size, const std::shared_ptr<const ChannelCallbacks>& callbacks)
+{
+    uint32_t channel;
+    {
+        const std::lock_guard guard{ _lock };
+        if (_closed)
+        {
+            return std::nullopt;
+        }
+        channel = _nextChannel++;
+        _channels.emplace(channel, callbacks);
+    }
+
+    try
+    {
+        const MuxSize payload{ gsl::narrow<uint16_t>(size.height), gsl::narrow<uint16_t>(size.width) };
+        const auto utf8 = til::u16u8(commandline);
+        _Send(MuxFrameType::Open, channel, { { reinterpret_cast<const char*>(&payload), sizeof(payload) }, utf8 });
+    }
+    catch (...)
+    {
+        CloseChannel(channel);
+        throw;
+    }
+    return channel;
+}
+
+void MuxTransport::Write(const uint32_t channel, std::wstring_view text)
+{
+    const auto utf8 = til::u16u8(text);
+    _Send(MuxFrameType::Data, channel, { utf8 });
+}
+
+void MuxTransport::Resize(const uint32_t channel, const til::size size)
+{
+    const MuxSize payload{ gsl::narrow<uint16_t>(size.height), gsl::narrow<uint16_t>(size.width) };
+    _Send(MuxFrameType::Resize, channel, { { reinterpret_cast<const char*>(&payload), sizeof(payload) } });
+}
+
+// Method Description:
+// - Closes the given session. Once the last one is closed, the transport is
+//   shut down too.
+void MuxTransport::CloseChannel(const uint32_t channel) noexcept
+{
+    bool wasOpen;
+    bool lastChannel;
+    {
+        const std::lock_guard guard{ _lock };
+        wasOpen = _channels.erase(channel) != 0;
+        lastChannel = _channels.empty();
+        // Set here, together with the last channel being removed, so that
+        // OpenChannel can't add a new channel to a transport on its way out.
+        _closed |= lastChannel;
+    }
+
+    if (lastChannel)
+    {
+        _Shutdown();
+    }
+    else if (wasOpen)
+    {
+        try
+        {
+            _Send(MuxFrameType::Close, channel, {});
+        }
+        CATCH_LOG();
+    }
+}
+
+void MuxTransport::_Send(const MuxFrameType type, const uint32_t channel, std::initializer_list<std::string_view> payload)
+{
+    size_t payloadSize = 0;
+    for (const auto& part : payload)
+    {
+        payloadSize += part.size();
+    }
+
+    const MuxFrameHeader header{ gsl::narrow<uint32_t>(payloadSize), channel, type };
+    std::string frame;
+    frame.reserve(sizeof(header) + payloadSize);
+    frame.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& part : payload)
+    {
+        frame.append(part);
+    }
+
+    const std::lock_guard guard{ _sendLock };
+    std::string_view remaining{ frame };
+    while (!remaining.empty())
+    {
+        const auto sent = send(_socket.get(), remaining.data(), gsl::narrow_cast<int>(std::min<size_t>(remaining.size(), INT_MAX)), 0);
+        if (sent == SOCKET_ERROR)
+        {
+            THROW_WIN32(WSAGetLastError());
+        }
+        remaining = remaining.substr(sent);
+    }
+}
+
+// Method Description:
+// - Ends the stream. The reader thread then notices that the stream ended,
+//   closes any remaining sessions and releases the transport.
+void MuxTransport::_Shutdown() noexcept
+{
+    {
+        const std::lock_guard guard{ _lock };
+        _closed = true;
+    }
+    // This unblocks the reader thread. The socket itself is closed once the
+    // transport is destroyed, which happens after the reader thread exited.
+    shutdown(_socket.get(), SD_BOTH);
+}
+
+bool MuxTransport::_Receive(void* buffer, size_t size) noexcept
+{
+    auto data = static_cast<char*>(buffer);
+    while (size)
+    {
+        const auto received = recv(_socket.get(), data, gsl::narrow_cast<int>(std::min<size_t>(size, INT_MAX)), 0);
+        if (received <= 0)
+        {
+            return false;
+        }
+        data += received;
+        size -= received;
+    }
+    return true;
+}
+
+void MuxTransport::_ReadLoop() noexcept
+try
+{
+    std::string payload;
+    MuxFrameHeader header;
+    while (_Receive(&header, sizeof(header)) && header.size <= MaxFrameSize)
+    {
+        payload.resize(header.size);
+        if (!_Receive(payload.data(), payload.size()))
+        {
+            break;
+        }
+
+        std::shared_ptr<const ChannelCallbacks> callbacks;
+        auto lastChannel = false;
+        {
+            const std::lock_guard guard{ _lock };
+            if (const auto it = _channels.find(header.channel); it != _channels.end())
+            {
+                callbacks = it->second;
+                if (header.type == MuxFrameType::Close)
+                {
+                    _channels.erase(it);
+                    lastChannel = _channels.empty();
+                    _closed |= lastChannel;
+                }
+            }
+        }
+
+        if (!callbacks)
+        {
+            // The session was closed on our side already.
+            continue;
+        }
+
+        try
+        {
+            if (header.type == MuxFrameType::Data)
+            {
+                callbacks->output(payload);
+            }
+            else if (header.type == MuxFrameType::Close)
+            {
+                callbacks->closed();
+            }
+        }
+        CATCH_LOG();
+
+        if (lastChannel)
+        {
+            _Shutdown();
+        }
+    }
+
+    // The stream ended, on purpose or not. Whatever is still open is over.
+    decltype(_channels) channels;
+    {
+        const std::lock_guard guard{ _lock };
+        _closed = true;
+        channels.swap(_channels);
+    }
+    for (const auto& [channel, callbacks] : channels)
+    {
+        try
+        {
+            callbacks->closed();
+        }
+        CATCH_LOG();
+    }
+}
+CATCH_LOG();
@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+/*++
+Module Name:
+- MuxTransport.h
+
+Abstract:
+- A transport carries the sessions of several MuxConnections over a single
+  stream socket to a multiplexer on the remote side. All connections to the
+  same endpoint share one transport, so the stream only has to be set up (and
+  authenticated, by whatever sits at the endpoint) once, and opening another
+  session is a single round trip.
+- Every message is a MuxFrameHeader followed by its payload. Text is UTF-8.
+  The client sends Open, Data, Resize and Close frames; the remote side sends
+  Data and Close frames back.
+--*/
+
+#pragma once
+
+#include <winsock2.h>
+#include <wil/resource.h>
+
+namespace Microsoft::Terminal::TerminalConnection
+{
+    enum class MuxFrameType : uint8_t
+    {
+        // Payload: MuxSize, followed by the commandline to run.
+        Open = 0,
+        // Payload: the text.
+        Data = 1,
+        // Payload: MuxSize.
+        Resize = 2,
+        // No payload.
+        Close = 3,
+    };
+
+#pragma pack(push, 1)
+    struct MuxFrameHeader
+    {
+        uint32_t size;
+        uint32_t channel;
+        MuxFrameType type;
+    };
+
+    struct MuxSize
+    {
+        uint16_t rows;
+        uint16_t columns;
+    };
+#pragma pack(pop)
+
+    class MuxTransport : public std::enable_shared_from_this<MuxTransport>
+    {
+    public:
+        struct ChannelCallbacks
+        {
+            // Both are called on the transport's reader thread.
+            std::function<void(std::string_view)> output;
+            std::function<void()> closed;
+        };
+
+        static std::pair<std::shared_ptr<MuxTransport>, uint32_t> OpenChannel(const std::wstring& endpoint, std::wstring_view commandline, const til::size size, ChannelCallbacks callbacks);
+
+        explicit MuxTransport(wil::unique_socket socket) noexcept;
+
+        void Write(const uint32_t channel, std::wstring_view text);
+        void Resize(const uint32_t channel, const til::size size);
+        void CloseChannel(const uint32_t channel) noexcept;
+
+    private:
+        static std::shared_ptr<MuxTransport> _Connect(const std::wstring& endpoint);
+
+        std::optional<uint32_t> _OpenChannel(std::wstring_view commandline, const til::size size, const std::shared_ptr<const ChannelCallbacks>& callbacks);
+        void _Send(const MuxFrameType type, const uint32_t channel, std::initializer_list<std::string_view> payload);
+        void _Shutdown() noexcept;
+        void _ReadLoop() noexcept;
+        bool _Receive(void* buffer, size_t size) noexcept;
+
+        wil::unique_socket _socket;
+        std::mutex _sendLock;
+
+        // The reader thread copies the callbacks out, so that it doesn't hold
+        // the lock while the control processes the output.
+        std::mutex _lock;
+        std::unordered_map<uint32_t, std::shared_ptr<const ChannelCallbacks>> _channels;
+        uint32_t _nextChannel{ 1 };
+        bool _closed{ false };
+    };
+}
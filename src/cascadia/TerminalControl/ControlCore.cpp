@@ -29,12 +29,27 @@ using namespace winrt::Windows::ApplicationModel::DataTransfer;
 // The updates are throttled to limit power usage.
 constexpr const auto ScrollBarUpdateInterval = std::chrono::milliseconds(8);
 
+// The minimum delay between updates to the title and the taskbar progress.
+// Programs that print their progress into the title do so very frequently.
+constexpr const auto TabStatusUpdateInterval = std::chrono::milliseconds(8);
+
+// The minimum delay between mouse motion events sent to the connection while
+// the mouse is being tracked. Mice poll at up to 1000Hz, far more often than any
+// application can make use of, so the motion is coalesced to about once a frame.
+constexpr const auto MouseMotionInterval = std::chrono::milliseconds(8);
+
 // The minimum delay between updating the TSF input control.
 constexpr const auto TsfRedrawInterval = std::chrono::milliseconds(100);
 
 // The minimum delay between updating the locations of regex patterns
 constexpr const auto UpdatePatternLocationsInterval = std::chrono::milliseconds(500);
 
+// How long a window has to stay minimized before we release the GPU resources of its controls.
+constexpr const auto HibernationDelay = std::chrono::seconds(30);
+
+// The maximum time we wait for a frame that's in flight, before releasing the GPU resources.
+constexpr const DWORD HibernationPaintTimeoutMs = 100;
+
 namespace winrt::Microsoft::Terminal::Control::implementation
 {
     static winrt::Microsoft::Terminal::Core::OptionalColor OptionalFromColor(const til::color& c)
@@ -59,6 +74,45 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         return result;
     }
 
+    // Helper static function to compare two of the font feature or axes maps.
+    // Either of them may be null, which is treated like an empty map.
+    template<typename T>
+    static bool _MapsAreEqual(const Windows::Foundation::Collections::IMap<winrt::hstring, T>& lhs,
+                              const Windows::Foundation::Collections::IMap<winrt::hstring, T>& rhs)
+    {
+        const auto lhsSize = lhs ? lhs.Size() : 0;
+        const auto rhsSize = rhs ? rhs.Size() : 0;
+        if (lhsSize != rhsSize)
+        {
+            return false;
+        }
+        if (lhsSize == 0)
+        {
+            return true;
+        }
+
+        for (const auto& [key, value] : lhs)
+        {
+            const auto other = rhs.TryLookup(key);
+            if (!other || other.Value() != value)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Helper static function that returns true if any of the settings that
+    // go into resolving the font differ between the two given settings.
+    static bool _FontSettingsChanged(const ControlSettings& oldSettings, const ControlSettings& newSettings)
+    {
+        return oldSettings.FontFace() != newSettings.FontFace() ||
+               oldSettings.FontSize() != newSettings.FontSize() ||
+               oldSettings.FontWeight().Weight != newSettings.FontWeight().Weight ||
+               !_MapsAreEqual(oldSettings.FontFeatures(), newSettings.FontFeatures()) ||
+               !_MapsAreEqual(oldSettings.FontAxes(), newSettings.FontAxes());
+    }
+
     // Helper static function to ensure that all ambiguous-width glyphs are reported as narrow.
     // See microsoft/terminal#2066 for more info.
     static bool _IsGlyphWideForceNarrowFallback(const std::wstring_view /* glyph */)
@@ -87,6 +141,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     {
         _EnsureStaticInitialization();
 
+        // Controls are created on the UI thread they're running on.
+        // This tells the lock profiler who the thread's acquisitions belong to.
+        LockProfiler::SetThreadAcquirer(LockAcquirer::Ui);
+
         _settings = winrt::make_self<implementation::ControlSettings>(settings, unfocusedAppearance);
 
         _terminal = std::make_unique<::Microsoft::Terminal::Core::Terminal>();
@@ -96,8 +154,27 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _ConnectionStateChangedHandlers(*this, nullptr);
         });
 
-        // This event is explicitly revoked in the destructor: does not need weak_ref
-        _connectionOutputEventToken = _connection.TerminalOutput({ this, &ControlCore::_connectionOutputHandler });
+        // Only ConPTY produces output at a rate that's worth queueing up. Every other connection
+        // (and in particular the mock connection of our tests) has its output written synchronously.
+        if (_connection.try_as<TerminalConnection::ConptyConnection>())
+        {
+            auto [producer, consumer] = til::spsc::channel<OutputChunk>(_outputQueueCapacity);
+            _outputProducer.emplace(std::move(producer));
+            _outputConsumer.emplace(std::move(consumer));
+        }
+
+        // This event is explicitly revoked in Close(), but revoking it doesn't wait for a handler that's
+        // running already. The handler holds on to _outputHandlerState instead of us, and the destructor
+        // waits for it to return before it tears down anything the handler uses.
+        _outputHandlerState = std::make_shared<OutputHandlerState>();
+        _outputHandlerState->core = this;
+        _connectionOutputEventToken = _connection.TerminalOutput([state = _outputHandlerState](const hstring& hstr) {
+            const std::shared_lock lock{ state->lock };
+            if (state->core)
+            {
+                state->core->_connectionOutputHandler(hstr);
+            }
+        });
 
         _terminal->SetWriteInputCallback([this](std::wstring_view wstr) {
             _sendInputToConnection(wstr);
@@ -185,6 +262,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         //   need to hop across the process boundary every time text is output.
         //   We can throttle this to once every 8ms, which will get us out of
         //   the way of the main output & rendering threads.
+        // * _updateTitle, _updateTaskbarProgress: The tab's status. Same as
+        //   the scroll bar, only the latest value matters.
+        // All of these run through the same UiUpdateBatcher, so the updates
+        // of all the controls of a window are applied in a single callback.
         _tsfTryRedrawCanvas = std::make_shared<ThrottledFuncTrailing<>>(
             _dispatcher,
             TsfRedrawInterval,
@@ -215,6 +296,62 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                 }
             });
 
+        _updateTitle = std::make_shared<ThrottledFuncTrailing<winrt::hstring>>(
+            _dispatcher,
+            TabStatusUpdateInterval,
+            [weakThis = get_weak()](const auto& title) {
+                if (auto core{ weakThis.get() }; !core->_IsClosing())
+                {
+                    core->_TitleChangedHandlers(*core, winrt::make<TitleChangedEventArgs>(title));
+                }
+            });
+
+        _updateTaskbarProgress = std::make_shared<ThrottledFuncTrailing<>>(
+            _dispatcher,
+            TabStatusUpdateInterval,
+            [weakThis = get_weak()]() {
+                if (auto core{ weakThis.get() }; !core->_IsClosing())
+                {
+                    core->_TaskbarProgressChangedHandlers(*core, nullptr);
+                }
+            });
+
+        _sendMouseMotion = std::make_shared<ThrottledFuncTrailing<>>(
+            _dispatcher,
+            MouseMotionInterval,
+            [weakThis = get_weak()]() {
+                if (auto core{ weakThis.get() }; !core->_IsClosing())
+                {
+                    const std::lock_guard lock{ core->_pendingMouseMotionLock };
+                    core->_sendPendingMouseMotion();
+                }
+            });
+
+        // Predictive local echoes that the connection didn't confirm within
+        // PredictionTimeout are removed again. This re-arms itself for as
+        // long as there are predictions waiting for their echo.
+        _expirePredictions = std::make_shared<ThrottledFuncTrailing<>>(
+            _dispatcher,
+            PredictionTimeout,
+            [weakThis = get_weak()]() {
+                if (auto core{ weakThis.get() }; !core->_IsClosing())
+                {
+                    if (core->_terminal->ExpirePredictions())
+                    {
+                        core->_expirePredictions->Run();
+                    }
+                }
+            });
+
+        // Writing output relies on _updatePatternLocations, so the queue is only registered now.
+        // The connection isn't started before Initialize(), so no output can have arrived yet.
+        if (_outputConsumer)
+        {
+            _outputQueue = std::make_unique<OutputProcessingPool::Queue>([this]() {
+                return _processOutput();
+            });
+        }
+
         UpdateSettings(settings, unfocusedAppearance);
     }
 
@@ -228,6 +365,23 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
 
         _shutdownMidiAudio();
+
+        // Anything that's still queued up is of no interest anymore at this point.
+        // This wakes up a connection thread that's waiting for credits. One that's blocked on
+        // a full channel is woken up by the pool, which keeps draining (and discarding) it.
+        _discardOutput = true;
+        til::atomic_notify_all(_outputCredits);
+
+        // Wait for the handlers that are running right now. Later ones won't call us anymore.
+        if (_outputHandlerState)
+        {
+            const std::unique_lock lock{ _outputHandlerState->lock };
+            _outputHandlerState->core = nullptr;
+        }
+
+        // Destroying the pool's queue waits for a batch that's being written right now.
+        _outputQueue.reset();
+        _outputProducer.reset();
     }
 
     bool ControlCore::Initialize(const double actualWidth,
@@ -317,6 +471,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _renderEngine->SetPixelShaderPath(_settings->PixelShaderPath());
             _renderEngine->SetForceFullRepaintRendering(_settings->ForceFullRepaintRendering());
             _renderEngine->SetSoftwareRendering(_settings->SoftwareRendering());
+            _renderEngine->SetSmoothScrolling(_settings->SmoothScrolling());
 
             _updateAntiAliasingMode();
 
@@ -346,7 +501,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     // - <none>
     void ControlCore::EnablePainting()
     {
-        if (_initializedTerminal)
+        if (_initializedTerminal && !_paintingSuspended)
         {
             _renderer->EnablePainting();
         }
@@ -368,6 +523,14 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         else
         {
             _connection.WriteInput(wstr);
+
+            // Only what the user typed or pasted is of interest to listeners
+            // like broadcast input; mouse and focus reports are specific to
+            // this terminal.
+            if (_sendingUserInput && _InputSentHandlers)
+            {
+                _InputSentHandlers(*this, winrt::make<InputSentEventArgs>(winrt::hstring{ wstr }));
+            }
         }
     }
 
@@ -386,7 +549,18 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                     const WORD scanCode,
                                     const ::Microsoft::Terminal::Core::ControlKeyStates modifiers)
     {
-        return _terminal->SendCharEvent(ch, scanCode, modifiers);
+        if (_renderer)
+        {
+            _renderer->NotifyInput();
+        }
+        _sendingUserInput = true;
+        const auto resetUserInput = wil::scope_exit([&]() noexcept { _sendingUserInput = false; });
+        const auto handled = _terminal->SendCharEvent(ch, scanCode, modifiers);
+        if (_settings->PredictiveEcho())
+        {
+            _expirePredictions->Run();
+        }
+        return handled;
     }
 
     // Method Description:
@@ -450,14 +624,22 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             }
         }
 
+        if (keyDown && _renderer)
+        {
+            _renderer->NotifyInput();
+        }
+
+        if (!vkey)
+        {
+            return true;
+        }
+
         // If the terminal translated the key, mark the event as handled.
         // This will prevent the system from trying to get the character out
         // of it and sending us a CharacterReceived event.
-        return vkey ? _terminal->SendKeyEvent(vkey,
-                                              scanCode,
-                                              modifiers,
-                                              keyDown) :
-                      true;
+        _sendingUserInput = true;
+        const auto resetUserInput = wil::scope_exit([&]() noexcept { _sendingUserInput = false; });
+        return _terminal->SendKeyEvent(vkey, scanCode, modifiers, keyDown);
     }
 
     bool ControlCore::SendMouseEvent(const til::point viewportPos,
@@ -466,9 +648,37 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                      const short wheelDelta,
                                      const TerminalInput::MouseButtonState state)
     {
+        const std::lock_guard lock{ _pendingMouseMotionLock };
+
+        // While the mouse is tracked, only the latest motion is sent per MouseMotionInterval.
+        if (uiButton == WM_MOUSEMOVE && IsVtMouseModeEnabled())
+        {
+            _pendingMouseMotion = PendingMouseMotion{ viewportPos, states, state };
+            _sendMouseMotion->Run();
+            return true;
+        }
+
+        // Any pending motion happened before this event, and the application
+        // must receive the events in the order in which they happened.
+        _sendPendingMouseMotion();
         return _terminal->SendMouseEvent(viewportPos, uiButton, states, wheelDelta, state);
     }
 
+    // Method Description:
+    // - Sends the mouse motion that SendMouseEvent() coalesced, if there is any.
+    //   _pendingMouseMotionLock must be held.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::_sendPendingMouseMotion()
+    {
+        if (const auto motion = std::exchange(_pendingMouseMotion, std::nullopt))
+        {
+            _terminal->SendMouseEvent(motion->viewportPos, WM_MOUSEMOVE, motion->states, 0, motion->state);
+        }
+    }
+
     void ControlCore::UserScrollViewport(const int viewTop)
     {
         // Clear the regex pattern tree so the renderer does not try to render them while scrolling
@@ -560,8 +770,23 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     //   region to change, such as when new text enters the buffer or the viewport is scrolled
     void ControlCore::UpdatePatternLocations()
     {
+        // Only the text of the visible rows is copied under the lock. Searching
+        // it is comparatively slow and would otherwise stall the output thread.
+        const LockProfiler::ScopedAcquirer acquirer{ LockAcquirer::Patterns };
+        std::optional<::Microsoft::Terminal::Core::Terminal::PatternRequest> request;
+        {
+            auto lock = _terminal->LockForWriting();
+            request = _terminal->SnapshotPatternsUnderLock();
+        }
+        if (!request)
+        {
+            return;
+        }
+
+        auto tree = TextBuffer::FindPatterns(request->snapshot, &_patternCache);
+
         auto lock = _terminal->LockForWriting();
-        _terminal->UpdatePatternsUnderLock();
+        _terminal->ApplyPatternsUnderLock(request->source, std::move(tree));
     }
 
     // Method description:
@@ -598,7 +823,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             newInterval = _terminal->GetHyperlinkIntervalFromPosition(*terminalPosition);
         }
 
-        // If the hyperlink ID changed or the interval changed, trigger a redraw all
+        // If the hyperlink ID changed or the interval changed, trigger a redraw
         // (so this will happen both when we move onto a link and when we move off a link)
         if (newId != _lastHoveredId ||
             (newInterval != _lastHoveredInterval))
@@ -610,11 +835,28 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             {
                 auto lock = _terminal->LockForWriting();
 
+                if (newId != _lastHoveredId)
+                {
+                    // The cells of a hyperlink ID can be anywhere in the viewport.
+                    _renderer->TriggerRedrawAll();
+                }
+                else
+                {
+                    // Only a pattern match got (un)hovered, so only its cells need a redraw.
+                    if (_lastHoveredInterval)
+                    {
+                        _terminal->InvalidatePatternIntervalUnderLock(*_lastHoveredInterval);
+                    }
+                    if (newInterval)
+                    {
+                        _terminal->InvalidatePatternIntervalUnderLock(*newInterval);
+                    }
+                }
+
                 _lastHoveredId = newId;
                 _lastHoveredInterval = newInterval;
                 _renderEngine->UpdateHyperlinkHoveredId(newId);
                 _renderer->UpdateLastHoveredInterval(newInterval);
-                _renderer->TriggerRedrawAll();
             }
 
             _HoveredHyperlinkChangedHandlers(*this, nullptr);
@@ -638,6 +880,145 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         return {};
     }
 
+    // Method Description:
+    // - Formats the counters of the output parser for the diagnostics overlay.
+    winrt::hstring ControlCore::ParserStatisticsText() const
+    {
+        using Dispatch = ::Microsoft::Console::VirtualTerminal::ParserStatistics::Dispatch;
+
+        const auto stats = [&]() {
+            auto lock = _terminal->LockForReading();
+            return _terminal->GetParserStatistics();
+        }();
+
+        return winrt::hstring{ fmt::format(L"Characters processed: {}\n"
+                                           L"Print runs: {} (average length {:.1f})\n"
+                                           L"Dispatches: {} C0, {} ESC, {} CSI, {} OSC, {} DCS, {} SS3, {} VT52\n"
+                                           L"Estimated time: {:.1f} ms printing, {:.1f} ms dispatching",
+                                           stats.charactersProcessed,
+                                           stats.printRuns,
+                                           stats.AveragePrintRunLength(),
+                                           stats.Dispatches(Dispatch::Execute),
+                                           stats.Dispatches(Dispatch::Escape),
+                                           stats.Dispatches(Dispatch::Csi),
+                                           stats.Dispatches(Dispatch::Osc),
+                                           stats.Dispatches(Dispatch::Dcs),
+                                           stats.Dispatches(Dispatch::Ss3),
+                                           stats.Dispatches(Dispatch::Vt52),
+                                           stats.EstimatedPrintNanoseconds() / 1e6,
+                                           stats.EstimatedDispatchNanoseconds() / 1e6) };
+    }
+
+    // Method Description:
+    // - Formats the performance counters for the diagnostics overlay. The rates
+    //   are computed over the time since the previous call, so this is meant to
+    //   be called periodically.
+    winrt::hstring ControlCore::PerformanceStatisticsText()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const auto current = GetPerformanceStatistics();
+        const auto [lastTime, last] = std::exchange(_lastPerformanceSample, std::pair{ now, current }).value_or(std::pair{ now, current });
+
+        const auto seconds = std::chrono::duration<double>(now - lastTime).count();
+        const auto perSecond = [&](const double value) {
+            return seconds > 0 ? value / seconds : 0.0;
+        };
+
+        // The frame time percentiles, from the frames painted since the last sample.
+        // Each is reported as the upper end of the histogram's step it falls into.
+        const auto& histogram = current.frames.frameTimes;
+        std::array<uint32_t, std::tuple_size_v<std::decay_t<decltype(histogram)>>> frameTimes{};
+        uint64_t frames = 0;
+        for (size_t i = 0; i < frameTimes.size(); ++i)
+        {
+            til::at(frameTimes, i) = til::at(histogram, i) - til::at(last.frames.frameTimes, i);
+            frames += til::at(frameTimes, i);
+        }
+        const auto percentile = [&](const uint64_t permille) {
+            const auto rank = (frames * permille + 999) / 1000;
+            uint64_t count = 0;
+            for (size_t i = 0; i < frameTimes.size(); ++i)
+            {
+                count += til::at(frameTimes, i);
+                if (count >= rank && count != 0)
+                {
+                    return std::chrono::duration<double, std::milli>(::Microsoft::Console::Render::FrameStatistics::FrameTimeStep * (i + 1)).count();
+                }
+            }
+            return 0.0;
+        };
+
+        const auto presented = current.frames.presented - last.frames.presented;
+        const auto shapedLines = current.engine.shapedLines - last.engine.shapedLines;
+        const auto writtenCharacters = current.writes.characters - last.writes.characters;
+        const auto writing = std::chrono::duration<double>(current.writes.writing - last.writes.writing).count();
+        const auto lockWait = std::chrono::duration<double, std::milli>(current.writes.lockWait - last.writes.lockWait).count();
+        const auto occupancy = current.engine.tileCapacity ? 100.0 * current.engine.allocatedTiles / current.engine.tileCapacity : 0.0;
+
+        // Who waited for and held the terminal's lock how often and for how long.
+        std::wstring locks;
+        for (size_t i = 0; i < current.locks.size(); ++i)
+        {
+            const auto& counters = til::at(current.locks, i);
+            const auto& previous = til::at(last.locks, i);
+            const auto acquisitions = counters.acquisitions - previous.acquisitions;
+            if (acquisitions == 0)
+            {
+                continue;
+            }
+
+            const auto wait = std::chrono::duration<double, std::milli>(counters.wait - previous.wait).count();
+            const auto hold = std::chrono::duration<double, std::milli>(counters.hold - previous.hold).count();
+            fmt::format_to(std::back_inserter(locks),
+                           L"\n  {}: {:.0f}/s ({} contended), wait {:.2f} ms/s, hold {:.2f} ms/s, longest {:.2f} ms at {}",
+                           LockProfiler::AcquirerName(static_cast<LockAcquirer>(i)),
+                           perSecond(static_cast<double>(acquisitions)),
+                           counters.contended - previous.contended,
+                           perSecond(wait),
+                           perSecond(hold),
+                           std::chrono::duration<double, std::milli>(counters.longestHold).count(),
+                           LockProfiler::FormatSite(counters.longestHoldSite));
+        }
+
+        const auto memory = MemoryUsage();
+        const auto mebibytes = [](const uint64_t bytes) {
+            return bytes / 1048576.0;
+        };
+
+        return winrt::hstring{ fmt::format(L"FPS: {:.1f}, frame time p50 {:.2f} ms, p95 {:.2f} ms, p99 {:.2f} ms\n"
+                                           L"Shaped lines per frame: {:.1f}\n"
+                                           L"Atlas: {} glyphs, {:.0f}% of the tiles in use\n"
+                                           L"Connection: {:.2f} M characters/s\n"
+                                           L"Output: {:.0f} chunks/s in {:.0f} batches/s, {:.0f} wakeups/s\n"
+                                           L"Parser: {:.2f} M characters/s\n"
+                                           L"Terminal lock wait: {:.2f} ms/s\n"
+                                           L"Input to photon: {:.1f} ms\n"
+                                           L"Memory: buffer {:.1f} MiB, attributes {:.1f} MiB, unicode {:.1f} MiB, hyperlinks {:.1f} MiB\n"
+                                           L"Renderer memory: GPU ~{:.1f} MiB, caches ~{:.1f} MiB\n"
+                                           L"Terminal lock:{}",
+                                           perSecond(static_cast<double>(presented)),
+                                           percentile(500),
+                                           percentile(950),
+                                           percentile(990),
+                                           presented ? static_cast<double>(shapedLines) / presented : 0.0,
+                                           current.engine.glyphs,
+                                           occupancy,
+                                           perSecond((current.connectionCharacters - last.connectionCharacters) / 1e6),
+                                           perSecond(static_cast<double>(current.connectionChunks - last.connectionChunks)),
+                                           perSecond(static_cast<double>(current.outputBatches - last.outputBatches)),
+                                           perSecond(static_cast<double>(current.outputWakeups - last.outputWakeups)),
+                                           writing > 0 ? writtenCharacters / writing / 1e6 : 0.0,
+                                           perSecond(lockWait),
+                                           std::chrono::duration<double, std::milli>(current.frames.inputLatency).count(),
+                                           mebibytes(memory.TextBuffer),
+                                           mebibytes(memory.Attributes),
+                                           mebibytes(memory.UnicodeStorage),
+                                           mebibytes(memory.Hyperlinks),
+                                           mebibytes(memory.Gpu),
+                                           mebibytes(memory.RendererCaches),
+                                           locks) };
+    }
+
     Windows::Foundation::IReference<Core::Point> ControlCore::HoveredCell() const
     {
         return _lastHoveredCell.has_value() ? Windows::Foundation::IReference<Core::Point>{ _lastHoveredCell.value().to_core_point() } : nullptr;
@@ -648,7 +1029,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     // - INVARIANT: This method can only be called if the caller DOES NOT HAVE writing lock on the terminal.
     void ControlCore::UpdateSettings(const IControlSettings& settings, const IControlAppearance& newAppearance)
     {
-        _settings = winrt::make_self<implementation::ControlSettings>(settings, newAppearance);
+        const auto oldSettings = std::exchange(_settings, winrt::make_self<implementation::ControlSettings>(settings, newAppearance));
 
         auto lock = _terminal->LockForWriting();
 
@@ -663,7 +1044,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _runtimeUseAcrylic = true;
         }
 
-        const auto sizeChanged = _setFontSizeUnderLock(_settings->FontSize());
+        // Resolving the font and rebuilding the renderer's glyph cache is by far the most
+        // expensive part of a settings reload. Most reloads don't touch the font however,
+        // so skip it unless it changed. This also keeps the current font size of the control.
+        const auto fontChanged = !_initializedTerminal || !oldSettings || _FontSettingsChanged(*oldSettings, *_settings);
+        const auto sizeChanged = fontChanged && _setFontSizeUnderLock(_settings->FontSize());
 
         // Update the terminal core with its new Core settings
         _terminal->UpdateSettings(*_settings);
@@ -677,6 +1062,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         _renderEngine->SetForceFullRepaintRendering(_settings->ForceFullRepaintRendering());
         _renderEngine->SetSoftwareRendering(_settings->SoftwareRendering());
+        _renderEngine->SetSmoothScrolling(_settings->SmoothScrolling());
         // Inform the renderer of our opacity
         _renderEngine->EnableTransparentBackground(_isBackgroundTransparent());
 
@@ -873,6 +1259,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         const auto currentVP = _terminal->GetViewport();
 
         _terminal->ClearSelection();
+        _searchResultsStale = true;
 
         // Tell the dx engine that our window is now the new size.
         THROW_IF_FAILED(_renderEngine->SetWindowSize({ cx, cy }));
@@ -1013,50 +1400,65 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
 
         // extract text from buffer
-        // RetrieveSelectedTextFromBuffer will lock while it's reading
-        const auto bufferData = _terminal->RetrieveSelectedTextFromBuffer(singleLine);
+        // RetrieveSelectedTextAndColorRuns will lock while it's reading.
+        // This has to happen right away, as the selection is cleared below.
+        auto bufferData = _terminal->RetrieveSelectedTextAndColorRuns(singleLine);
+        const auto bgColor = _terminal->GetAttributeColors({}).second;
 
-        // convert text: vector<string> --> string
-        std::wstring textData;
-        for (const auto& text : bufferData.text)
+        if (!_settings->CopyOnSelect())
         {
-            textData += text;
+            _terminal->ClearSelection();
+            _updateSelection();
         }
 
-        const auto bgColor = _terminal->GetAttributeColors({}).second;
+        _copyToClipboardAsync(std::move(bufferData), bgColor, formats);
+        return true;
+    }
+
+    // Method Description:
+    // - Generates the HTML and RTF formats of the copied text on a background
+    //   thread and then raises the CopyToClipboard event. For selections of
+    //   several megabytes this takes long enough to noticeably block the UI.
+    // - The event is raised on the background thread. The handlers are
+    //   responsible for getting back to the UI thread for the clipboard.
+    // Arguments:
+    // - bufferData: the selected text and its colors
+    // - bgColor: the default background color
+    // - formats: the formats to generate, or null for all of them
+    // Return Value:
+    // - <none>
+    winrt::fire_and_forget ControlCore::_copyToClipboardAsync(TextBuffer::TextAndColorRuns bufferData,
+                                                              const COLORREF bgColor,
+                                                              const Windows::Foundation::IReference<CopyFormat> formats)
+    {
+        const auto fontHeight = _actualFont.GetUnscaledSize().Y;
+        const std::wstring fontFaceName{ _actualFont.GetFaceName() };
+        auto weakThis{ get_weak() };
+
+        co_await winrt::resume_background();
 
         // convert text to HTML format
         // GH#5347 - Don't provide a title for the generated HTML, as many
         // web applications will paste the title first, followed by the HTML
         // content, which is unexpected.
         const auto htmlData = formats == nullptr || WI_IsFlagSet(formats.Value(), CopyFormat::HTML) ?
-                                  TextBuffer::GenHTML(bufferData,
-                                                      _actualFont.GetUnscaledSize().Y,
-                                                      _actualFont.GetFaceName(),
-                                                      bgColor) :
+                                  TextBuffer::GenHTML(bufferData, fontHeight, fontFaceName, bgColor) :
                                   "";
 
         // convert to RTF format
         const auto rtfData = formats == nullptr || WI_IsFlagSet(formats.Value(), CopyFormat::RTF) ?
-                                 TextBuffer::GenRTF(bufferData,
-                                                    _actualFont.GetUnscaledSize().Y,
-                                                    _actualFont.GetFaceName(),
-                                                    bgColor) :
+                                 TextBuffer::GenRTF(bufferData, fontHeight, fontFaceName, bgColor) :
                                  "";
 
-        if (!_settings->CopyOnSelect())
+        if (const auto core{ weakThis.get() })
         {
-            _terminal->ClearSelection();
-            _updateSelection();
+            // send data up for clipboard
+            core->_CopyToClipboardHandlers(*core,
+                                           winrt::make<CopyToClipboardEventArgs>(winrt::hstring{ bufferData.text },
+                                                                                 winrt::to_hstring(htmlData),
+                                                                                 winrt::to_hstring(rtfData),
+                                                                                 formats));
         }
-
-        // send data up for clipboard
-        _CopyToClipboardHandlers(*this,
-                                 winrt::make<CopyToClipboardEventArgs>(winrt::hstring{ textData },
-                                                                       winrt::to_hstring(htmlData),
-                                                                       winrt::to_hstring(rtfData),
-                                                                       formats));
-        return true;
     }
 
     void ControlCore::SelectAll()
@@ -1098,7 +1500,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     //   before sending it over the terminal's connection.
     void ControlCore::PasteText(const winrt::hstring& hstr)
     {
-        _terminal->WritePastedText(hstr);
+        {
+            _sendingUserInput = true;
+            const auto resetUserInput = wil::scope_exit([&]() noexcept { _sendingUserInput = false; });
+            _terminal->WritePastedText(hstr);
+        }
         _terminal->ClearSelection();
         _updateSelection();
         _terminal->TrySnapOnInput();
@@ -1141,6 +1547,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         return _connection ? _connection.State() : TerminalConnection::ConnectionState::Closed;
     }
 
+    TerminalConnection::ITerminalConnection ControlCore::Connection() const
+    {
+        return _connection;
+    }
+
     hstring ControlCore::Title()
     {
         return hstring{ _terminal->GetConsoleTitle() };
@@ -1232,8 +1643,16 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     {
         // Since this can only ever be triggered by output from the connection,
         // then the Terminal already has the write lock when calling this
-        // callback.
-        _TitleChangedHandlers(*this, winrt::make<TitleChangedEventArgs>(winrt::hstring{ wstr }));
+        // callback. The listeners re-query Title(), so only the last title
+        // of a burst of changes needs to be raised.
+        if (!_inUnitTests)
+        {
+            _updateTitle->Run(winrt::hstring{ wstr });
+        }
+        else
+        {
+            _TitleChangedHandlers(*this, winrt::make<TitleChangedEventArgs>(winrt::hstring{ wstr }));
+        }
     }
 
     // Method Description:
@@ -1286,7 +1705,14 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
     void ControlCore::_terminalTaskbarProgressChanged()
     {
-        _TaskbarProgressChangedHandlers(*this, nullptr);
+        if (!_inUnitTests)
+        {
+            _updateTaskbarProgress->Run();
+        }
+        else
+        {
+            _TaskbarProgressChangedHandlers(*this, nullptr);
+        }
     }
 
     void ControlCore::_terminalShowWindowChanged(bool showOrHide)
@@ -1299,30 +1725,16 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     }
 
     // Method Description:
-    // - Plays a single MIDI note, blocking for the duration.
+    // - Plays a single MIDI note. The note is queued up and played by the
+    //   audio thread, so that the output isn't blocked while it plays.
     // Arguments:
     // - noteNumber - The MIDI note number to be played (0 - 127).
     // - velocity - The force with which the note should be played (0 - 127).
     // - duration - How long the note should be sustained (in microseconds).
     void ControlCore::_terminalPlayMidiNote(const int noteNumber, const int velocity, const std::chrono::microseconds duration)
     {
-        // We create the audio instance on demand, and lock it for the duration
-        // of the note output so it can't be destroyed while in use.
-        auto& midiAudio = _getMidiAudio();
-        midiAudio.Lock();
-
-        // We then unlock the terminal, so the UI doesn't hang while we're busy.
-        auto& terminalLock = _terminal->GetReadWriteLock();
-        terminalLock.unlock();
-
-        // This call will block for the duration, unless shutdown early.
-        midiAudio.PlayNote(noteNumber, velocity, duration);
-
-        // Once complete, we reacquire the terminal lock and unlock the audio.
-        // If the terminal has shutdown in the meantime, the Unlock call
-        // will throw an exception, forcing the thread to exit ASAP.
-        terminalLock.lock();
-        midiAudio.Unlock();
+        // We create the audio instance on demand.
+        _getMidiAudio().PlayNote(noteNumber, velocity, duration);
     }
 
     // Method Description:
@@ -1351,9 +1763,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     {
         if (_midiAudio)
         {
-            // We lock the terminal here to make sure the shutdown promise is
-            // set before the audio is unlocked in the thread that is playing.
-            auto lock = _terminal->LockForWriting();
+            // Any notes that are still queued up are dropped.
             _midiAudio->Shutdown();
         }
     }
@@ -1390,6 +1800,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     // Method Description:
     // - Search text in text buffer. This is triggered if the user click
     //   search button or press enter.
+    // - If the results of the previous search can be reused, the next match is
+    //   selected right away. Otherwise the buffer is searched by _searchAsync.
     // Arguments:
     // - text: the text to search
     // - goForward: boolean that represents if the current search direction is forward
@@ -1413,9 +1825,155 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                      Search::Sensitivity::CaseSensitive :
                                      Search::Sensitivity::CaseInsensitive;
 
-        ::Search search(*GetUiaData(), text.c_str(), direction, sensitivity);
-        auto lock = _terminal->LockForWriting();
-        const auto foundMatch{ search.FindNext() };
+        // Any search that's still running in the background is outdated now.
+        const auto generation = ++_searchGeneration;
+
+        {
+            auto lock = _terminal->LockForWriting();
+
+            if (!_searchResultsStale &&
+                caseSensitive == _searchCaseSensitive &&
+                til::starts_with(std::wstring_view{ text }, std::wstring_view{ _searchText }))
+            {
+                ::Search search(*GetUiaData(), text.c_str(), direction, sensitivity);
+                if (text.size() != _searchText.size())
+                {
+                    search.RefineMatches(_searchMatches);
+                }
+
+                _searchText = text;
+                _selectSearchMatch(search);
+                return;
+            }
+        }
+
+        _searchAsync(generation, text, direction, sensitivity);
+    }
+
+    // Method Description:
+    // - Searches the entire buffer on a background thread. The buffer is searched
+    //   in chunks of _searchChunkRows rows. The terminal lock is only held while
+    //   a chunk is copied with TextBuffer::SnapshotRows, and the copy is searched
+    //   after releasing it, so that neither the output nor the renderer are blocked
+    //   for long. After every chunk that had a match, we raise a FoundMatch
+    //   event with the partial results. The search ends early if another one
+    //   was started in the meantime.
+    // - Output that arrives while we're searching might modify the rows that
+    //   were already searched or shift them around. If it did, the search starts
+    //   over, up to _searchMaxRestarts times. After that, the buffer is searched
+    //   in one go under the final lock, so that the results are never out of date.
+    // Arguments:
+    // - generation: The value of _searchGeneration for this search.
+    // - text: the text to search
+    // - direction: the direction to select the next match in, once we're done
+    // - sensitivity: whether the search is case sensitive
+    // Return Value:
+    // - <none>
+    winrt::fire_and_forget ControlCore::_searchAsync(const uint64_t generation,
+                                                     const winrt::hstring text,
+                                                     const ::Search::Direction direction,
+                                                     const ::Search::Sensitivity sensitivity)
+    {
+        auto weakThis{ get_weak() };
+        co_await winrt::resume_background();
+
+        std::vector<::Search::Match> matches;
+        til::CoordType row = 0;
+        til::CoordType endRow = 0;
+        // The revision of the buffer the matches are valid for.
+        uint64_t revision = 0;
+        auto restarts = -1;
+
+        for (;;)
+        {
+            const auto core{ weakThis.get() };
+            if (!core || core->_searchGeneration != generation)
+            {
+                co_return;
+            }
+
+            const auto previousCount = matches.size();
+
+            TextBuffer::RowsSnapshot snapshot;
+            til::CoordType chunkEnd = 0;
+            {
+                auto lock = core->_terminal->LockForReading();
+                const auto& textBuffer = core->_terminal->GetTextBuffer();
+
+                // Matches can continue in the row after the last one that was searched.
+                if (restarts < 0 || (restarts < _searchMaxRestarts && textBuffer.HasChangedSince(revision, 0, row)))
+                {
+                    matches.clear();
+                    row = 0;
+                    endRow = core->_terminal->GetTextBufferEndPosition().Y + 1;
+                    revision = textBuffer.GetRevision();
+                    ++restarts;
+                }
+
+                // The lock is only held while the rows are copied. They're searched afterwards.
+                // The row above the chunk is included for the matches that continue from it.
+                chunkEnd = std::min(endRow, row + _searchChunkRows);
+                snapshot = textBuffer.SnapshotRows(row - 1, chunkEnd - 1);
+            }
+
+            // The anchor isn't needed for FindAll, and computing it would need the lock.
+            const ::Search search(*core->GetUiaData(), text.c_str(), direction, sensitivity, {});
+            search.FindAll(snapshot, row, chunkEnd, matches);
+            row = chunkEnd;
+
+            if (row >= endRow)
+            {
+                break;
+            }
+
+            if (matches.size() != previousCount)
+            {
+                auto partialResults = winrt::make_self<implementation::FoundResultsArgs>(true);
+                partialResults->TotalMatches(gsl::narrow_cast<uint32_t>(matches.size()));
+                partialResults->Complete(false);
+                core->_FoundMatchHandlers(*core, *partialResults);
+            }
+        }
+
+        if (const auto core{ weakThis.get() })
+        {
+            auto lock = core->_terminal->LockForWriting();
+            if (core->_searchGeneration != generation)
+            {
+                co_return;
+            }
+
+            // The anchor of the search is computed from the current selection.
+            ::Search search(*core->GetUiaData(), text.c_str(), direction, sensitivity);
+            // Rows below endRow count as well, in case output was appended to them.
+            const auto& textBuffer = core->_terminal->GetTextBuffer();
+            if (textBuffer.HasChangedSince(revision, 0, textBuffer.TotalRowCount() - 1))
+            {
+                matches.clear();
+                search.FindAll(0, core->_terminal->GetTextBufferEndPosition().Y + 1, matches);
+            }
+
+            // Output marks the results as stale while holding this lock, so they're up to date now.
+            core->_searchResultsStale = false;
+            core->_searchText = text;
+            core->_searchCaseSensitive = sensitivity == ::Search::Sensitivity::CaseSensitive;
+            core->_searchMatches = std::move(matches);
+            core->_selectSearchMatch(search);
+        }
+    }
+
+    // Method Description:
+    // - Selects the next match in _searchMatches and raises a FoundMatch event,
+    //   which the control will use to notify narrator if there were any results.
+    //   The terminal lock must be held.
+    // Arguments:
+    // - search: A search for _searchText, which determines the next match.
+    // Return Value:
+    // - <none>
+    void ControlCore::_selectSearchMatch(::Search& search)
+    {
+        const auto matchIndex{ search.FindNext(_searchMatches) };
+        const auto foundMatch{ matchIndex.has_value() };
         if (foundMatch)
         {
             _terminal->SetBlockSelection(false);
@@ -1427,9 +1985,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _UpdateSelectionMarkersHandlers(*this, winrt::make<implementation::UpdateSelectionMarkersEventArgs>(true));
         }
 
-        // Raise a FoundMatch event, which the control will use to notify
-        // narrator if there was any results in the buffer
         auto foundResults = winrt::make_self<implementation::FoundResultsArgs>(foundMatch);
+        foundResults->CurrentMatch(gsl::narrow_cast<uint32_t>(matchIndex.value_or(0)));
+        foundResults->TotalMatches(gsl::narrow_cast<uint32_t>(_searchMatches.size()));
         _FoundMatchHandlers(*this, *foundResults);
     }
 
@@ -1519,8 +2077,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
     void ControlCore::BlinkCursor()
     {
-        if (!_terminal->IsCursorBlinkingAllowed() &&
-            _terminal->IsCursorVisible())
+        // Like conhost's CursorBlinker, don't blink a cursor that was hidden via VT.
+        // Toggling it would take the write lock and wake up the renderer for nothing.
+        if (!_terminal->IsCursorBlinkingAllowed() ||
+            !_terminal->IsCursorVisible())
         {
             return;
         }
@@ -1656,11 +2216,276 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         auto noticeArgs = winrt::make<NoticeEventArgs>(NoticeLevel::Info, RS_(L"TermControlReadOnly"));
         _RaiseNoticeHandlers(*this, std::move(noticeArgs));
     }
+    // Method Description:
+    // - Queues up output of the connection for the output processing pool, if it's ConPTY's.
+    //   If the terminal can't keep up and the queue is full, this blocks the connection's
+    //   thread, which in turn stops it from reading any further output.
     void ControlCore::_connectionOutputHandler(const hstring& hstr)
     {
+        _connectionCharacters.fetch_add(hstr.size(), std::memory_order_relaxed);
+        _connectionChunks.fetch_add(1, std::memory_order_relaxed);
+
+        if (_outputProducer)
+        {
+            // The connection sets an activity ID for every chunk it reads while tracing.
+            GUID activity{};
+            if (TraceLoggingProviderEnabled(g_hTerminalControlProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
+            {
+                EventActivityIdControl(EVENT_ACTIVITY_CTRL_GET_ID, &activity);
+            }
+            if (!_acquireOutputCredits(hstr.size()))
+            {
+                return;
+            }
+            _outputProducer->emplace(OutputChunk{ hstr, activity });
+            _outputQueue->Schedule();
+        }
+        else
+        {
+            const LockProfiler::ScopedAcquirer acquirer{ LockAcquirer::Output };
+            _writeConnectionOutput(hstr);
+        }
+    }
+
+    // Method Description:
+    // - Blocks the connection's thread until the given number of characters
+    //   may be queued up. Since it only calls us from the thread that reads its
+    //   output, it stops reading in the meantime, and the application it's
+    //   connected to is throttled once the pipe is full.
+    // - A chunk that's larger than the limit is let through once the queue is empty.
+    // Arguments:
+    // - length: The length of the chunk that's about to be queued up.
+    // Return Value:
+    // - false if the output is discarded, because we're being destroyed.
+    //   The chunk mustn't be queued up then, and no credits were taken.
+    bool ControlCore::_acquireOutputCredits(const size_t length) noexcept
+    {
+        const auto needed = std::min(length, _outputCreditLimit);
+        auto credits = _outputCredits.load(std::memory_order_acquire);
+
+        // There's only one connection thread taking credits, so they can't
+        // have gone anywhere else once the wait succeeded.
+        while (credits < needed && !_discardOutput)
+        {
+            til::atomic_wait(_outputCredits, credits);
+            credits = _outputCredits.load(std::memory_order_acquire);
+        }
+
+        if (_discardOutput)
+        {
+            return false;
+        }
+
+        _outputCredits.fetch_sub(needed, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Method Description:
+    // - Returns the credits of written chunks to the connection's thread.
+    void ControlCore::_releaseOutputCredits(const size_t length) noexcept
+    {
+        if (length != 0)
+        {
+            _outputCredits.fetch_add(length, std::memory_order_release);
+            til::atomic_notify_one(_outputCredits);
+        }
+    }
+
+    // Method Description:
+    // - Run by the OutputProcessingPool whenever output has been queued up.
+    // - The output of visible controls is written one batch at a time, so that the
+    //   pool gets to the other panes in between. The output of hidden controls isn't
+    //   painted, so there's no renderer waiting for the terminal lock and nobody
+    //   waiting for the output either. It's written in slices of up to
+    //   _backgroundOutputSlice instead, unless the output of a visible pane comes in.
+    // Return Value:
+    // - true if there may be more output queued up.
+    bool ControlCore::_processOutput()
+    {
+        LockProfiler::SetThreadAcquirer(LockAcquirer::Output);
+
+        if (!_outputInBackground.load(std::memory_order_relaxed))
+        {
+            return _processOutputBatch();
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + _backgroundOutputSlice;
+        auto more = false;
+        do
+        {
+            more = _processOutputBatch();
+        } while (more &&
+                 std::chrono::steady_clock::now() < deadline &&
+                 !OutputProcessingPool::HasPendingWorkAbove(OutputProcessingPool::Priority::Hidden));
+        return more;
+    }
+
+    // Method Description:
+    // - Writes every chunk that's queued up by now into the terminal at once. It never
+    //   waits for more output to arrive and so doesn't add any latency, but a batch is
+    //   still limited to _outputBatchChunks chunks and _outputBatchLength characters, so
+    //   that a flood of output can't hold the terminal lock for too long and starve the
+    //   renderer, nor keep the pool from getting to the other panes.
+    // Return Value:
+    // - true if there may be more output queued up.
+    bool ControlCore::_processOutputBatch()
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        std::array<OutputChunk, _outputBatchChunks> chunks;
+        const auto [count, alive] = _outputConsumer->pop_n(til::spsc::block_never, chunks.begin(), chunks.size());
+
+        // The credits of all chunks are returned, even if writing them fails.
+        size_t credits = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            credits += std::min<size_t>(til::at(chunks, i).text.size(), _outputCreditLimit);
+        }
+        const auto releaseCredits = wil::scope_exit([&]() noexcept {
+            _releaseOutputCredits(credits);
+        });
+
+        size_t length = 0;
+        size_t largestChunk = 0;
+
+        if (count != 0)
+        {
+            // The batch continues the activity of its first chunk, so that the terminal's
+            // and the parser's events on this thread are attributed to the chunk as well.
+            // Outside of traces the activity ID is all zeroes and this clears it again.
+            auto activity = til::at(chunks, 0).activity;
+            EventActivityIdControl(EVENT_ACTIVITY_CTRL_SET_ID, &activity);
+            _outputBatches.fetch_add(1, std::memory_order_relaxed);
+
+            // Together with the event below this spans the time it took to
+            // write the batch, for regions of interest in WPA.
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+            TraceLoggingWrite(g_hTerminalControlProvider,
+                              "ConnectionOutputBatch",
+                              TraceLoggingOpcode(WINEVENT_OPCODE_START),
+                              TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto& [chunk, activity] = til::at(chunks, i);
+            length += chunk.size();
+            largestChunk = std::max<size_t>(largestChunk, chunk.size());
+
+            if (i != 0 && activity != GUID{})
+            {
+                // Links the activities of the other chunks to the batch.
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+                TraceLoggingWriteActivity(g_hTerminalControlProvider,
+                                          "OutputBatched",
+                                          nullptr,
+                                          &activity,
+                                          TraceLoggingGuid(activity, "Chunk"),
+                                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+            }
+
+            // The common case of a single chunk is written straight away without an extra copy.
+            if (count == 1)
+            {
+                _writeConnectionOutput(chunk);
+            }
+            else
+            {
+                _outputBatch.append(chunk);
+                if (_outputBatch.size() >= _outputBatchLength || i + 1 == count)
+                {
+                    _writeConnectionOutput(_outputBatch);
+                    _outputBatch.clear();
+                }
+            }
+
+            chunk = {};
+            activity = {};
+        }
+
+        if (count != 0)
+        {
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+            TraceLoggingWrite(g_hTerminalControlProvider,
+                              "ConnectionOutputBatch",
+                              TraceLoggingDescription("Event emitted when queued up connection output is written into the terminal"),
+                              TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+                              TraceLoggingUInt64(count, "QueueDepth", "The number of chunks that were queued up"),
+                              TraceLoggingUInt64(length, "Length", "The total number of characters in the chunks"),
+                              TraceLoggingUInt64(largestChunk, "LargestChunk", "The number of characters in the largest chunk"),
+                              TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        _outputTime.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+
+        return alive && count == chunks.size();
+    }
+
+    // Method Description:
+    // - Returns the statistics of the renderer, and the time the output processing
+    //   pool spent on this control's output so far. The latter stays 0 if output
+    //   is written directly, on the connection's thread.
+    ControlCore::PerformanceStatistics ControlCore::GetPerformanceStatistics()
+    {
+        PerformanceStatistics statistics;
+        if (_renderer)
+        {
+            statistics.frames = _renderer->GetFrameStatistics();
+        }
+        if (_renderEngine)
+        {
+            _renderEngine->GetStatistics(statistics.engine);
+        }
+        statistics.writes = _terminal->GetWriteStatistics();
+        statistics.locks = _terminal->GetLockStatistics();
+        statistics.connectionCharacters = _connectionCharacters.load(std::memory_order_relaxed);
+        statistics.connectionChunks = _connectionChunks.load(std::memory_order_relaxed);
+        statistics.outputBatches = _outputBatches.load(std::memory_order_relaxed);
+        if (_outputQueue)
+        {
+            statistics.outputWakeups = _outputQueue->Wakeups();
+        }
+        statistics.outputCpuTime = std::chrono::nanoseconds{ _outputTime.load(std::memory_order_relaxed) };
+        return statistics;
+    }
+
+    void ControlCore::_writeConnectionOutput(std::wstring_view text)
+    {
+        if (_discardOutput)
+        {
+            return;
+        }
+
         try
         {
-            _terminal->Write(hstr);
+            // This includes the time spent waiting for the terminal lock,
+            // which the parser's ProcessString events don't.
+            const auto tracing = TraceLoggingProviderEnabled(g_hTerminalControlProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE);
+            if (tracing)
+            {
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+                TraceLoggingWrite(g_hTerminalControlProvider,
+                                  "WriteOutput",
+                                  TraceLoggingOpcode(WINEVENT_OPCODE_START),
+                                  TraceLoggingUInt64(text.size(), "Length"),
+                                  TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                                  TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+            }
+
+            _terminal->Write(text);
+
+            if (tracing)
+            {
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+                TraceLoggingWrite(g_hTerminalControlProvider,
+                                  "WriteOutput",
+                                  TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+                                  TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                                  TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+            }
+            _searchResultsStale = true;
 
             // Start the throttled update of where our hyperlinks are.
             _updatePatternLocations->Run();
@@ -1689,6 +2514,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         if (clearType == Control::ClearBufferType::Scrollback || clearType == Control::ClearBufferType::All)
         {
             _terminal->EraseScrollback();
+            _searchResultsStale = true;
         }
 
         if (clearType == Control::ClearBufferType::Screen || clearType == Control::ClearBufferType::All)
@@ -1887,6 +2713,99 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                 conpty.ShowHide(showOrHide);
             }
         }
+
+        _windowVisible = showOrHide;
+        _updatePainting();
+        _updateOutputPriority();
+    }
+
+    // Method Description:
+    // - Called when the control was shown or hidden within its window, for
+    //   instance because the tab it belongs to was selected or deselected.
+    //   Hidden controls don't paint, and their output is written after
+    //   that of all visible controls.
+    // Arguments:
+    // - visible: true if the control is shown, false if it's hidden.
+    // Return Value:
+    // - <none>
+    void ControlCore::ContentVisibilityChanged(const bool visible)
+    {
+        _contentVisible = visible;
+        _updatePainting();
+        _updateOutputPriority();
+    }
+
+    // Method Description:
+    // - Controls don't paint while their window is minimized or they're hidden
+    //   within it. The buffer keeps receiving output in the meantime, and is
+    //   painted in full again once they're shown.
+    // - Controls that stay hidden for HibernationDelay additionally release the
+    //   device, swap chain and glyph atlas of their render engine.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::_updatePainting()
+    {
+        if (_windowVisible && _contentVisible)
+        {
+            if (_hibernationTimer)
+            {
+                _hibernationTimer.Stop();
+            }
+
+            // Controls that haven't been initialized yet start painting in EnablePainting().
+            if (std::exchange(_paintingSuspended, false) && _initializedTerminal)
+            {
+                auto lock = _terminal->LockForWriting();
+                _hibernated = false;
+                _renderer->EnablePainting();
+                _renderer->TriggerRedrawAll();
+            }
+            return;
+        }
+
+        if (std::exchange(_paintingSuspended, true))
+        {
+            return;
+        }
+
+        // Unlike hibernating, this doesn't wait for the frame that's in flight,
+        // so that switching tabs doesn't block the UI thread.
+        _renderer->DisablePainting();
+
+        if (!_initializedTerminal)
+        {
+            return;
+        }
+
+        if (!_hibernationTimer)
+        {
+            _hibernationTimer = _dispatcher.CreateTimer();
+            _hibernationTimer.Interval(HibernationDelay);
+            _hibernationTimer.IsRepeating(false);
+            _hibernationTimer.Tick([weakThis = get_weak()](auto&&, auto&&) {
+                if (auto core{ weakThis.get() }; core && !core->_IsClosing() && core->_paintingSuspended)
+                {
+                    core->_hibernate();
+                }
+            });
+        }
+        _hibernationTimer.Start();
+    }
+
+    void ControlCore::_hibernate()
+    {
+        // The frame that's in flight needs the terminal lock to finish,
+        // so we must not hold it while we wait for the render thread.
+        _renderer->WaitForPaintCompletionAndDisable(HibernationPaintTimeoutMs);
+
+        auto lock = _terminal->LockForWriting();
+        if (!_hibernated)
+        {
+            _renderEngine->ReleaseResources();
+            _hibernated = true;
+        }
     }
 
     // Method Description:
@@ -1902,12 +2821,40 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     void ControlCore::GotFocus()
     {
         _terminal->FocusChanged(true);
+        _focused = true;
+        _updateOutputPriority();
     }
 
     // See GotFocus.
     void ControlCore::LostFocus()
     {
         _terminal->FocusChanged(false);
+        _focused = false;
+        _updateOutputPriority();
+    }
+
+    // Method Description:
+    // - The output of the focused control is written before that of all others,
+    //   and the output of hidden controls (in minimized windows or unselected tabs)
+    //   comes last, in larger slices.
+    void ControlCore::_updateOutputPriority() noexcept
+    {
+        if (_outputQueue)
+        {
+            using Priority = OutputProcessingPool::Priority;
+            auto priority = Priority::Hidden;
+            if (_focused)
+            {
+                priority = Priority::Focused;
+            }
+            else if (_windowVisible && _contentVisible)
+            {
+                priority = Priority::Visible;
+            }
+
+            _outputQueue->SetPriority(priority);
+            _outputInBackground.store(priority == Priority::Hidden, std::memory_order_relaxed);
+        }
     }
 
     bool ControlCore::_isBackgroundTransparent()
@@ -1942,8 +2889,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
     Windows::Foundation::Collections::IVector<Control::ScrollMark> ControlCore::ScrollMarks() const
     {
-        auto internalMarks{ _terminal->GetScrollMarks() };
-        auto v = winrt::single_threaded_observable_vector<Control::ScrollMark>();
+        const auto internalMarks{ _terminal->GetScrollMarks() };
+        std::vector<Control::ScrollMark> v;
+        v.reserve(internalMarks.size());
         for (const auto& mark : internalMarks)
         {
             Control::ScrollMark m{};
@@ -1959,10 +2907,35 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             m.Start = mark.start.to_core_point();
             m.End = mark.end.to_core_point();
 
-            v.Append(m);
+            v.emplace_back(m);
         }
 
-        return v;
+        return winrt::single_threaded_observable_vector<Control::ScrollMark>(std::move(v));
+    }
+
+    // Method Description:
+    // - Adds up the memory held by the buffers, the marks and the renderer, for
+    //   diagnostics. This walks all rows of the buffers under the read lock.
+    Control::MemoryUsage ControlCore::MemoryUsage() const
+    {
+        Control::MemoryUsage usage{};
+        {
+            const auto lock = _terminal->LockForReading();
+            const auto terminal = _terminal->GetMemoryUsage();
+            usage.TextBuffer = terminal.mainBuffer.cells + terminal.altBuffer.cells;
+            usage.Attributes = terminal.mainBuffer.attributes + terminal.altBuffer.attributes;
+            usage.UnicodeStorage = terminal.mainBuffer.unicodeStorage + terminal.altBuffer.unicodeStorage;
+            usage.Hyperlinks = terminal.mainBuffer.hyperlinks + terminal.altBuffer.hyperlinks;
+            usage.ScrollMarks = terminal.scrollMarks;
+        }
+        if (_renderEngine)
+        {
+            ::Microsoft::Console::Render::EngineStatistics engine;
+            _renderEngine->GetStatistics(engine);
+            usage.Gpu = engine.gpuBytes;
+            usage.RendererCaches = engine.cacheBytes;
+        }
+        return usage;
     }
 
     void ControlCore::AddMark(const Control::ScrollMark& mark)
@@ -1994,70 +2967,36 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     void ControlCore::ScrollToMark(const Control::ScrollToMarkDirection& direction)
     {
         const auto currentOffset = ScrollOffset();
-        const auto& marks{ _terminal->GetScrollMarks() };
 
+        // The marks are sorted by their row, so each of these is a binary search.
         std::optional<DispatchTypes::ScrollMark> tgt;
 
         switch (direction)
         {
         case ScrollToMarkDirection::Last:
-        {
-            int highest = currentOffset;
-            for (const auto& mark : marks)
+            // The last mark overall, but only if it's below the viewport.
+            tgt = _terminal->GetScrollMarkBefore(std::numeric_limits<til::CoordType>::max());
+            if (tgt && tgt->start.y <= currentOffset)
             {
-                const auto newY = mark.start.y;
-                if (newY > highest)
-                {
-                    tgt = mark;
-                    highest = newY;
-                }
+                tgt.reset();
             }
             break;
-        }
         case ScrollToMarkDirection::First:
-        {
-            int lowest = currentOffset;
-            for (const auto& mark : marks)
+            // The first mark overall, but only if it's above the viewport.
+            tgt = _terminal->GetScrollMarkAfter(std::numeric_limits<til::CoordType>::min());
+            if (tgt && tgt->start.y >= currentOffset)
             {
-                const auto newY = mark.start.y;
-                if (newY < lowest)
-                {
-                    tgt = mark;
-                    lowest = newY;
-                }
+                tgt.reset();
             }
             break;
-        }
         case ScrollToMarkDirection::Next:
-        {
-            int minDistance = INT_MAX;
-            for (const auto& mark : marks)
-            {
-                const auto delta = mark.start.y - currentOffset;
-                if (delta > 0 && delta < minDistance)
-                {
-                    tgt = mark;
-                    minDistance = delta;
-                }
-            }
+            tgt = _terminal->GetScrollMarkAfter(currentOffset);
             break;
-        }
         case ScrollToMarkDirection::Previous:
         default:
-        {
-            int minDistance = INT_MAX;
-            for (const auto& mark : marks)
-            {
-                const auto delta = currentOffset - mark.start.y;
-                if (delta > 0 && delta < minDistance)
-                {
-                    tgt = mark;
-                    minDistance = delta;
-                }
-            }
+            tgt = _terminal->GetScrollMarkBefore(currentOffset);
             break;
         }
-        }
 
         const auto viewHeight = ViewHeight();
         const auto bufferSize = BufferHeight();
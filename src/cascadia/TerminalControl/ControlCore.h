@@ -21,8 +21,11 @@
 #include "../../renderer/base/Renderer.hpp"
 #include "../../cascadia/TerminalCore/Terminal.hpp"
 #include "../buffer/out/search.h"
+#include "OutputProcessingPool.h"
 
-#include <til/ticket_lock.h>
+#include <shared_mutex>
+#include <til/atomic.h>
+#include <til/spsc.h>
 
 namespace ControlUnitTests
 {
@@ -98,6 +101,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void ClearHoveredCell();
         winrt::hstring GetHyperlink(const Core::Point position) const;
         winrt::hstring HoveredUriText() const;
+        winrt::hstring ParserStatisticsText() const;
+        winrt::hstring PerformanceStatisticsText();
         Windows::Foundation::IReference<Core::Point> HoveredCell() const;
 
         ::Microsoft::Console::Types::IUiaData* GetUiaData() const;
@@ -113,6 +118,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         hstring WorkingDirectory() const;
 
         TerminalConnection::ConnectionState ConnectionState() const;
+        TerminalConnection::ITerminalConnection Connection() const;
 
         int ScrollOffset();
         int ViewHeight() const;
@@ -126,6 +132,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void ClearAllMarks();
         void ScrollToMark(const Control::ScrollToMarkDirection& direction);
 
+        Control::MemoryUsage MemoryUsage() const;
+
 #pragma endregion
 
 #pragma region ITerminalInput
@@ -176,6 +184,26 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         void AttachUiaEngine(::Microsoft::Console::Render::IRenderEngine* const pEngine);
 
+        // Used by benchmarks, which drive a ControlCore without a TermControl,
+        // and the performance overlay. All of it can be read without a lock.
+        struct PerformanceStatistics
+        {
+            ::Microsoft::Console::Render::FrameStatistics frames;
+            ::Microsoft::Console::Render::EngineStatistics engine;
+            ::Microsoft::Terminal::Core::Terminal::WriteStatistics writes;
+            ::Microsoft::Console::Types::LockProfiler::Statistics locks{};
+            // The characters received from the connection so far.
+            uint64_t connectionCharacters = 0;
+            // The number of chunks they arrived in, the number of batches they were written
+            // in, and how often handing a chunk to the output processing pool woke it up.
+            uint64_t connectionChunks = 0;
+            uint64_t outputBatches = 0;
+            uint64_t outputWakeups = 0;
+            // The time the output processing pool spent writing into the terminal.
+            std::chrono::nanoseconds outputCpuTime{};
+        };
+        PerformanceStatistics GetPerformanceStatistics();
+
         bool IsInReadOnlyMode() const;
         void ToggleReadOnlyMode();
 
@@ -186,6 +214,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void AdjustOpacity(const double opacity, const bool relative);
 
         void WindowVisibilityChanged(const bool showOrHide);
+        void ContentVisibilityChanged(const bool visible);
 
         uint64_t OwningHwnd();
         void OwningHwnd(uint64_t owner);
@@ -216,6 +245,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         TYPED_EVENT(FoundMatch,                IInspectable, Control::FoundResultsArgs);
         TYPED_EVENT(ShowWindowChanged,         IInspectable, Control::ShowWindowArgs);
         TYPED_EVENT(UpdateSelectionMarkers,    IInspectable, Control::UpdateSelectionMarkersEventArgs);
+        TYPED_EVENT(InputSent,                 IInspectable, Control::InputSentEventArgs);
         // clang-format on
 
     private:
@@ -224,8 +254,68 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         TerminalConnection::ITerminalConnection _connection{ nullptr };
         event_token _connectionOutputEventToken;
+        // Shared with the TerminalOutput handler. See the constructor.
+        struct OutputHandlerState
+        {
+            std::shared_mutex lock;
+            ControlCore* core{ nullptr };
+        };
+        std::shared_ptr<OutputHandlerState> _outputHandlerState;
         TerminalConnection::ITerminalConnection::StateChanged_revoker _connectionStateChangedRevoker;
 
+        // The output of the connection is queued up here and written into the terminal by
+        // the OutputProcessingPool, which drains everything that has been queued in the meantime
+        // in one go. This way a burst of small chunks only takes the terminal lock once.
+        static constexpr uint32_t _outputQueueCapacity{ 1024 };
+        static constexpr size_t _outputBatchChunks{ 64 };
+        static constexpr size_t _outputBatchLength{ 256 * 1024 };
+        // Hidden controls write batch after batch for up to this long. See _processOutput().
+        static constexpr auto _backgroundOutputSlice{ std::chrono::milliseconds(50) };
+        // The number of characters that may be queued up at once. The connection's thread
+        // is blocked until enough of them have been written to return their credits, which
+        // bounds the memory a runaway application can make us use, wherever its chunks are.
+        static constexpr size_t _outputCreditLimit{ 4 * 1024 * 1024 };
+        // The activity ID of the chunk is only set while tracing. It links the
+        // events of the pool's thread to those of the connection's thread.
+        struct OutputChunk
+        {
+            hstring text;
+            GUID activity{};
+        };
+        std::optional<til::spsc::producer<OutputChunk>> _outputProducer;
+        std::optional<til::spsc::consumer<OutputChunk>> _outputConsumer;
+        // Only used by _processOutput(), which the pool never runs twice at once.
+        std::wstring _outputBatch;
+        std::unique_ptr<OutputProcessingPool::Queue> _outputQueue;
+        std::atomic<int64_t> _outputTime{ 0 };
+        std::atomic<size_t> _outputCredits{ _outputCreditLimit };
+        // These decide the priority of _outputQueue and whether we paint. They're only used on the UI thread.
+        bool _focused{ false };
+        bool _windowVisible{ true };
+        bool _contentVisible{ true };
+        // Set if _outputQueue is Hidden. Read by _processOutput().
+        std::atomic<bool> _outputInBackground{ false };
+        std::atomic<bool> _discardOutput{ false };
+        std::atomic<uint64_t> _connectionCharacters{ 0 };
+        std::atomic<uint64_t> _connectionChunks{ 0 };
+        std::atomic<uint64_t> _outputBatches{ 0 };
+
+        // The sample PerformanceStatisticsText() computed its rates against.
+        std::optional<std::pair<std::chrono::steady_clock::time_point, PerformanceStatistics>> _lastPerformanceSample;
+
+        // The results of the last search. They're reused as long as the buffer doesn't
+        // change, which makes stepping through the matches cheap, and narrowed down if
+        // the search term is only extended. Any output or resize marks them as stale.
+        winrt::hstring _searchText;
+        bool _searchCaseSensitive{ false };
+        std::vector<::Search::Match> _searchMatches;
+        std::atomic<bool> _searchResultsStale{ true };
+        // Incremented by every search, so that a search running in the background can tell that it's outdated.
+        std::atomic<uint64_t> _searchGeneration{ 0 };
+        static constexpr til::CoordType _searchChunkRows{ 2048 };
+        // How often a background search starts over because of output, see _searchAsync.
+        static constexpr int _searchMaxRestarts{ 2 };
+
         winrt::com_ptr<ControlSettings> _settings{ nullptr };
 
         std::unique_ptr<::Microsoft::Terminal::Core::Terminal> _terminal{ nullptr };
@@ -250,6 +340,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         uint16_t _lastHoveredId{ 0 };
 
         bool _isReadOnly{ false };
+        // True while the input written to the connection is something the
+        // user typed or pasted, see InputSent.
+        bool _sendingUserInput{ false };
 
         std::optional<interval_tree::IntervalTree<til::point, size_t>::interval> _lastHoveredInterval{ std::nullopt };
 
@@ -264,14 +357,46 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         winrt::Windows::System::DispatcherQueue _dispatcher{ nullptr };
         std::shared_ptr<ThrottledFuncTrailing<>> _tsfTryRedrawCanvas;
         std::shared_ptr<ThrottledFuncTrailing<>> _updatePatternLocations;
+        // Only used by UpdatePatternLocations, which always runs on _dispatcher.
+        TextBuffer::PatternCache _patternCache;
         std::shared_ptr<ThrottledFuncTrailing<Control::ScrollPositionChangedArgs>> _updateScrollBar;
+        std::shared_ptr<ThrottledFuncTrailing<winrt::hstring>> _updateTitle;
+        std::shared_ptr<ThrottledFuncTrailing<>> _updateTaskbarProgress;
+        std::shared_ptr<ThrottledFuncTrailing<>> _expirePredictions;
+
+        // The latest mouse motion, which SendMouseEvent() coalesces while the mouse is tracked.
+        struct PendingMouseMotion
+        {
+            til::point viewportPos;
+            ::Microsoft::Terminal::Core::ControlKeyStates states;
+            ::Microsoft::Console::VirtualTerminal::TerminalInput::MouseButtonState state;
+        };
+        std::shared_ptr<ThrottledFuncTrailing<>> _sendMouseMotion;
+        std::optional<PendingMouseMotion> _pendingMouseMotion;
+        // Held while mouse events are sent, so that they're sent in order.
+        std::mutex _pendingMouseMotionLock;
+
+        // These are used by _updatePainting, on the UI thread.
+        // _hibernated is protected by the terminal lock.
+        winrt::Windows::System::DispatcherQueueTimer _hibernationTimer{ nullptr };
+        bool _paintingSuspended{ false };
+        bool _hibernated{ false };
 
         winrt::fire_and_forget _asyncCloseConnection();
+        winrt::fire_and_forget _copyToClipboardAsync(TextBuffer::TextAndColorRuns bufferData,
+                                                     const COLORREF bgColor,
+                                                     const Windows::Foundation::IReference<CopyFormat> formats);
 
         bool _setFontSizeUnderLock(int fontSize);
         void _updateFont(const bool initialUpdate = false);
         void _refreshSizeUnderLock();
         void _updateSelection();
+        void _sendPendingMouseMotion();
+        winrt::fire_and_forget _searchAsync(const uint64_t generation,
+                                            const winrt::hstring text,
+                                            const ::Search::Direction direction,
+                                            const ::Search::Sensitivity sensitivity);
+        void _selectSearchMatch(::Search& search);
 
         void _sendInputToConnection(std::wstring_view wstr);
 
@@ -304,7 +429,15 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         void _raiseReadOnlyWarning();
         void _updateAntiAliasingMode();
+        void _updatePainting();
+        void _hibernate();
         void _connectionOutputHandler(const hstring& hstr);
+        bool _acquireOutputCredits(const size_t length) noexcept;
+        void _releaseOutputCredits(const size_t length) noexcept;
+        bool _processOutput();
+        bool _processOutputBatch();
+        void _updateOutputPriority() noexcept;
+        void _writeConnectionOutput(std::wstring_view text);
         void _updateHoveredCell(const std::optional<til::point> terminalPosition);
         void _setOpacity(const double opacity);
 
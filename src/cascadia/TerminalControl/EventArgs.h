@@ -14,6 +14,7 @@
 #include "FoundResultsArgs.g.h"
 #include "ShowWindowArgs.g.h"
 #include "UpdateSelectionMarkersEventArgs.g.h"
+#include "InputSentEventArgs.g.h"
 
 namespace winrt::Microsoft::Terminal::Control::implementation
 {
@@ -146,6 +147,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
 
         WINRT_PROPERTY(bool, FoundMatch);
+        WINRT_PROPERTY(uint32_t, CurrentMatch, 0);
+        WINRT_PROPERTY(uint32_t, TotalMatches, 0);
+        WINRT_PROPERTY(bool, Complete, true);
     };
 
     struct ShowWindowArgs : public ShowWindowArgsT<ShowWindowArgs>
@@ -169,4 +173,15 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         WINRT_PROPERTY(bool, ClearMarkers, false);
     };
+
+    struct InputSentEventArgs : public InputSentEventArgsT<InputSentEventArgs>
+    {
+    public:
+        InputSentEventArgs(const winrt::hstring& text) :
+            _Text(text)
+        {
+        }
+
+        WINRT_PROPERTY(winrt::hstring, Text);
+    };
 }
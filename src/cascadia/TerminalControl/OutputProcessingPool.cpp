@@ -0,0 +1,208 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "OutputProcessingPool.h"
+
+namespace winrt::Microsoft::Terminal::Control::implementation
+{
+    OutputProcessingPool::Queue::Queue(std::function<bool()> run) :
+        _run{ std::move(run) }
+    {
+    }
+
+    // Method Description:
+    // - Unregisters the queue and waits for its work to finish, if it's running
+    //   right now. Afterwards, the pool won't touch anything the queue refers to.
+    OutputProcessingPool::Queue::~Queue()
+    {
+        auto& pool = _instance();
+        std::unique_lock lock{ pool._lock };
+
+        _closed = true;
+        if (_scheduled)
+        {
+            auto& pending = til::at(pool._pending, static_cast<size_t>(_priority));
+            pending.erase(std::find(pending.begin(), pending.end(), this));
+            _scheduled = false;
+        }
+
+        pool._queueIdle.wait(lock, [&]() noexcept { return !_running; });
+    }
+
+    // Method Description:
+    // - Makes sure that the queue's work runs (again) soon. If it's running
+    //   right now, it runs once more after it's done, since the new work may
+    //   have been added after the running part checked for it.
+    void OutputProcessingPool::Queue::Schedule() noexcept
+    try
+    {
+        if (_signaled.exchange(true, std::memory_order_acq_rel))
+        {
+            return;
+        }
+        _instance()._schedule(*this);
+    }
+    CATCH_LOG()
+
+    // Method Description:
+    // - Returns how often Schedule() had to hand the queue to the pool,
+    //   as opposed to finding it already scheduled.
+    uint64_t OutputProcessingPool::Queue::Wakeups() const noexcept
+    {
+        return _wakeups.load(std::memory_order_relaxed);
+    }
+
+    void OutputProcessingPool::Queue::SetPriority(const Priority priority) noexcept
+    {
+        auto& pool = _instance();
+        const std::scoped_lock lock{ pool._lock };
+
+        if (_priority == priority)
+        {
+            return;
+        }
+
+        if (_scheduled)
+        {
+            auto& pending = til::at(pool._pending, static_cast<size_t>(_priority));
+            pending.erase(std::find(pending.begin(), pending.end(), this));
+            til::at(pool._pending, static_cast<size_t>(priority)).push_back(this);
+        }
+        _priority = priority;
+    }
+
+    // Method Description:
+    // - Returns whether any queue of a higher priority than the given one waits
+    //   to run. Work that runs in larger slices can use this to yield
+    //   the thread early, instead of holding up more important output.
+    bool OutputProcessingPool::HasPendingWorkAbove(const Priority priority) noexcept
+    {
+        auto& pool = _instance();
+        const std::scoped_lock lock{ pool._lock };
+
+        for (size_t i = 0; i < static_cast<size_t>(priority); ++i)
+        {
+            if (!til::at(pool._pending, i).empty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Method Description:
+    // - The pool is intentionally leaked and its threads are detached:
+    //   Joining them in a static destructor would happen under the loader lock.
+    OutputProcessingPool& OutputProcessingPool::_instance()
+    {
+        static const auto pool = new OutputProcessingPool{};
+        return *pool;
+    }
+
+    void OutputProcessingPool::_schedule(Queue& queue)
+    {
+        const std::scoped_lock lock{ _lock };
+
+        queue._wakeups.fetch_add(1, std::memory_order_relaxed);
+
+        if (queue._closed || queue._scheduled)
+        {
+            return;
+        }
+        if (queue._running)
+        {
+            queue._rescheduled = true;
+            return;
+        }
+
+        queue._scheduled = true;
+        til::at(_pending, static_cast<size_t>(queue._priority)).push_back(&queue);
+
+        if (_idleThreads == 0 && _threads < _maxThreads)
+        {
+            std::thread{ [this]() { _worker(); } }.detach();
+            _threads++;
+        }
+        else
+        {
+            _workAvailable.notify_one();
+        }
+    }
+
+    void OutputProcessingPool::_worker()
+    {
+        LOG_IF_FAILED(SetThreadDescription(GetCurrentThread(), L"OutputProcessingPool Worker"));
+
+        // The output of hidden panes isn't painted, so nobody's waiting for it.
+        // It shouldn't take CPU time away from the UI, nor from the renderers.
+        auto background = false;
+
+        std::unique_lock lock{ _lock };
+
+        while (true)
+        {
+            Queue* queue = nullptr;
+            for (auto& pending : _pending)
+            {
+                if (!pending.empty())
+                {
+                    queue = pending.front();
+                    pending.pop_front();
+                    break;
+                }
+            }
+
+            if (!queue)
+            {
+                _idleThreads++;
+                _workAvailable.wait(lock);
+                _idleThreads--;
+                continue;
+            }
+
+            queue->_scheduled = false;
+            queue->_running = true;
+            const auto hidden = queue->_priority == Priority::Hidden;
+            lock.unlock();
+
+            if (hidden != background)
+            {
+                LOG_IF_WIN32_BOOL_FALSE(SetThreadPriority(GetCurrentThread(), hidden ? THREAD_PRIORITY_BELOW_NORMAL : THREAD_PRIORITY_NORMAL));
+                background = hidden;
+            }
+
+            // Work that's added from here on may not be seen by this run, so the next
+            // Schedule() has to take the slow path again. This is an exchange and not a
+            // store, so that it synchronizes with the Schedule() calls it clears and the
+            // run sees the work they were called for.
+            queue->_signaled.exchange(false, std::memory_order_acq_rel);
+
+            auto more = false;
+            try
+            {
+                more = queue->_run();
+            }
+            CATCH_LOG();
+
+            lock.lock();
+            queue->_running = false;
+
+            if (queue->_closed)
+            {
+                // The queue's destructor is waiting for us. It may be gone right after this.
+                _queueIdle.notify_all();
+                continue;
+            }
+
+            // Queues that aren't done yet go to the back of the line, so that all
+            // panes of the same priority make progress under a flood of output.
+            const auto rescheduled = std::exchange(queue->_rescheduled, false);
+            if (more || rescheduled)
+            {
+                queue->_scheduled = true;
+                til::at(_pending, static_cast<size_t>(queue->_priority)).push_back(queue);
+            }
+        }
+    }
+}
@@ -0,0 +1,90 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- OutputProcessingPool.h
+
+Abstract:
+- A process-wide pool of threads that writes the output of all connections
+  into their terminals. Without it, every pane would need a thread of its own,
+  and with dozens of busy panes the threads would outnumber the cores.
+- Every pane registers a Queue, whose work is only ever run on one thread at
+  a time, so that its output stays in order. Queues of focused panes run
+  before those of visible panes, which run before those of hidden ones.
+  Queues of the same priority take turns. Hidden queues run at a lower thread
+  priority, and may check HasPendingWorkAbove() to find out when to yield.
+- The pool only grows by a thread when there's work and no thread is idle,
+  and never beyond the number of cores.
+- Scheduling a queue that's already going to run is a single atomic
+  operation. Only the first output after the queue ran takes the pool's
+  lock and possibly wakes up a thread. Those wakeups are counted, so that
+  the cost of the handoffs can be compared to the number of chunks.
+--*/
+
+#pragma once
+
+#include <condition_variable>
+
+namespace winrt::Microsoft::Terminal::Control::implementation
+{
+    class OutputProcessingPool final
+    {
+    public:
+        enum class Priority : uint8_t
+        {
+            Focused,
+            Visible,
+            Hidden,
+        };
+
+        static bool HasPendingWorkAbove(const Priority priority) noexcept;
+
+        // The pane's handle to the pool. Run() processes a part of the pane's work
+        // and returns true if there's more left, in which case it's rescheduled.
+        // Schedule() must be called whenever new work has been added.
+        class Queue final
+        {
+        public:
+            explicit Queue(std::function<bool()> run);
+            ~Queue();
+
+            Queue(const Queue&) = delete;
+            Queue& operator=(const Queue&) = delete;
+
+            void Schedule() noexcept;
+            void SetPriority(const Priority priority) noexcept;
+            uint64_t Wakeups() const noexcept;
+
+        private:
+            friend class OutputProcessingPool;
+
+            std::function<bool()> _run;
+            // Set by Schedule() and cleared right before the work runs. While it's set,
+            // the upcoming run is guaranteed to see everything that was added until then.
+            std::atomic<bool> _signaled{ false };
+            std::atomic<uint64_t> _wakeups{ 0 };
+            Priority _priority{ Priority::Visible };
+            bool _scheduled{ false };
+            bool _running{ false };
+            bool _rescheduled{ false };
+            bool _closed{ false };
+        };
+
+    private:
+        static constexpr size_t _priorityCount{ 3 };
+
+        static OutputProcessingPool& _instance();
+
+        void _schedule(Queue& queue);
+        void _worker();
+
+        std::mutex _lock;
+        std::condition_variable _workAvailable;
+        std::condition_variable _queueIdle;
+        std::array<std::deque<Queue*>, _priorityCount> _pending;
+        size_t _maxThreads{ std::max<size_t>(1, std::thread::hardware_concurrency()) };
+        size_t _threads{ 0 };
+        size_t _idleThreads{ 0 };
+    };
+}
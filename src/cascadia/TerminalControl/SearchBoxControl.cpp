@@ -4,6 +4,7 @@
 #include "pch.h"
 #include "SearchBoxControl.h"
 #include "SearchBoxControl.g.cpp"
+#include <LibraryResources.h>
 
 using namespace winrt;
 using namespace winrt::Windows::UI::Xaml;
@@ -124,6 +125,48 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
     }
 
+    // Method Description:
+    // - Shows which of the matches of the last search is selected ("N of M").
+    // Arguments:
+    // - totalMatches: the number of matches in the buffer
+    // - currentMatch: the index of the selected match
+    // Return Value:
+    // - <none>
+    void SearchBoxControl::SetStatus(const uint32_t totalMatches, const uint32_t currentMatch)
+    {
+        if (totalMatches == 0)
+        {
+            StatusBox().Text(RS_(L"SearchBox_NoMatches"));
+        }
+        else
+        {
+            StatusBox().Text(fmt::format(std::wstring_view{ RS_(L"SearchBox_MatchIndexOfCount") }, currentMatch + 1, totalMatches));
+        }
+    }
+
+    // Method Description:
+    // - Shows how many matches were found so far, while a search is still running.
+    // Arguments:
+    // - matchesSoFar: the number of matches found so far
+    // Return Value:
+    // - <none>
+    void SearchBoxControl::SetPartialStatus(const uint32_t matchesSoFar)
+    {
+        StatusBox().Text(fmt::format(std::wstring_view{ RS_(L"SearchBox_PartialMatchCount") }, matchesSoFar));
+    }
+
+    // Method Description:
+    // - Handler for changes of the search term. The status of the previous
+    //   search doesn't apply to the new term, so it's cleared.
+    // Arguments:
+    // - <unused>
+    // Return Value:
+    // - <none>
+    void SearchBoxControl::TextBoxTextChanged(const winrt::Windows::Foundation::IInspectable& /*sender*/, const winrt::Windows::UI::Xaml::Controls::TextChangedEventArgs& /*e*/)
+    {
+        StatusBox().Text(L"");
+    }
+
     // Method Description:
     // - Check if the current focus is on any element within the
     //   search box
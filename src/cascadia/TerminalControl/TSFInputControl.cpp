@@ -26,7 +26,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _currentTextBlockHeight{ 0.0 },
         _currentTextBounds{ 0, 0, 0, 0 },
         _currentControlBounds{ 0, 0, 0, 0 },
-        _currentWindowBounds{ 0, 0, 0, 0 }
+        _currentWindowBounds{ 0, 0, 0, 0 },
+        _currentFontSize{ 0.0 },
+        _currentFontFace{},
+        _currentFontWeight{ 0 },
+        _currentMaxWidth{ -1.0 }
     {
         InitializeComponent();
 
@@ -203,15 +207,29 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         // Make sure to unscale the font size to correct for DPI! XAML needs
         // things in DIPs, and the fontSize is in pixels.
-        TextBlock().FontSize(unscaledFontSizePx);
-        TextBlock().FontFamily(Media::FontFamily(fontArgs->FontFace()));
-        TextBlock().FontWeight(fontArgs->FontWeight());
-
-        // TextBlock's actual dimensions right after initialization is 0w x 0h. So,
-        // if an IME is displayed before TextBlock has text (like showing the emoji picker
-        // using Win+.), it'll be placed higher than intended.
-        TextBlock().MinWidth(unscaledFontSizePx);
-        TextBlock().MinHeight(unscaledFontSizePx);
+        // The composition's layout is only invalidated if the font actually changed,
+        // because this is called whenever the cursor moves while composing.
+        if (_currentFontSize != unscaledFontSizePx)
+        {
+            _currentFontSize = unscaledFontSizePx;
+            TextBlock().FontSize(unscaledFontSizePx);
+
+            // TextBlock's actual dimensions right after initialization is 0w x 0h. So,
+            // if an IME is displayed before TextBlock has text (like showing the emoji picker
+            // using Win+.), it'll be placed higher than intended.
+            TextBlock().MinWidth(unscaledFontSizePx);
+            TextBlock().MinHeight(unscaledFontSizePx);
+        }
+        if (_currentFontFace != fontArgs->FontFace())
+        {
+            _currentFontFace = fontArgs->FontFace();
+            TextBlock().FontFamily(Media::FontFamily(_currentFontFace));
+        }
+        if (_currentFontWeight != fontArgs->FontWeight().Weight)
+        {
+            _currentFontWeight = fontArgs->FontWeight().Weight;
+            TextBlock().FontWeight(fontArgs->FontWeight());
+        }
         _currentTextBlockHeight = std::max(unscaledFontSizePx, _currentTextBlockHeight);
 
         const auto widthToTerminalEnd = _currentCanvasWidth - clientCursorInDips.x;
@@ -219,7 +237,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // negative number here will crash us in mysterious ways with a useless
         // stack trace
         const auto newMaxWidth = std::max<double>(0.0, widthToTerminalEnd);
-        TextBlock().MaxWidth(newMaxWidth);
+        if (_currentMaxWidth != newMaxWidth)
+        {
+            _currentMaxWidth = newMaxWidth;
+            TextBlock().MaxWidth(newMaxWidth);
+        }
 
         // Get window in screen coordinates, this is the entire window including
         // tabs. THIS IS IN DIPs
@@ -416,8 +438,15 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             else
             {
                 Canvas().Visibility(Visibility::Visible);
-                const auto text = _inputBuffer.substr(_activeTextStart);
-                TextBlock().Text(text);
+
+                // IMEs frequently send updates that only move the caret or change
+                // the formatting of the composition, and don't change its text.
+                // Those don't need another layout pass of the TextBlock.
+                const auto text = std::wstring_view{ _inputBuffer }.substr(_activeTextStart);
+                if (std::wstring_view{ TextBlock().Text() } != text)
+                {
+                    TextBlock().Text(winrt::hstring{ text });
+                }
             }
 
             // Notify the TSF that the update succeeded
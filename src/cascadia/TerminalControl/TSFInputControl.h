@@ -84,6 +84,13 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         winrt::Windows::Foundation::Rect _currentControlBounds;
         winrt::Windows::Foundation::Rect _currentTextBounds;
         winrt::Windows::Foundation::Rect _currentWindowBounds;
+
+        // The font properties last applied to the TextBlock. Setting them
+        // invalidates its layout, even if they didn't change.
+        double _currentFontSize;
+        winrt::hstring _currentFontFace;
+        uint16_t _currentFontWeight;
+        double _currentMaxWidth;
     };
 }
 namespace winrt::Microsoft::Terminal::Control::factory_implementation
@@ -9,8 +9,10 @@
 #include <LibraryResources.h>
 
 #include "TermControlAutomationPeer.h"
+#include "../../types/inc/AllocationTracker.hpp"
 #include "../../types/inc/GlyphWidth.hpp"
 #include "../../renderer/atlas/AtlasEngine.h"
+#include "../../renderer/base/FontCache.h"
 
 #include "TermControl.g.cpp"
 
@@ -61,6 +63,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     {
         InitializeComponent();
 
+        // The parser, the buffer and the renderer live in this module, and with them the
+        // allocation budgets of their hot paths. Debug builds assert the first time one
+        // is exceeded. Unlike this control, the ControlCore is also used by unit tests.
+        ::Microsoft::Console::Types::AllocationTracker::AssertOnOverBudget(true);
+
         _interactivity = winrt::make<implementation::ControlInteractivity>(settings, unfocusedAppearance, connection);
         _core = _interactivity.Core();
 
@@ -160,29 +167,63 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         if (_showMarksInScrollbar)
         {
             // Update scrollbar marks
-            ScrollBarCanvas().Children().Clear();
+            // The pips that are already on the canvas are moved into place instead of being
+            // recreated, and marks that would end up on the same pixel row as the previous
+            // pip of the same color don't get one of their own. With a mark on every prompt,
+            // that keeps the number of pips bounded by the height of the scrollbar.
+            auto children{ ScrollBarCanvas().Children() };
             const auto marks{ _core.ScrollMarks() };
             const auto fullHeight{ ScrollBarCanvas().ActualHeight() };
             const auto totalBufferRows{ update.newMaximum + update.newViewportSize };
 
+            uint32_t pips = 0;
+            auto previousTop = -1.0;
+            til::color previousColor;
             for (const auto m : marks)
             {
-                Windows::UI::Xaml::Shapes::Rectangle r;
-                Media::SolidColorBrush brush{};
                 // Sneaky: technically, a mark doesn't need to have a color set,
                 // it might want to just use the color from the palette for that
                 // kind of mark. Fortunately, ControlCore is kind enough to
                 // pre-evaluate that for us, and shove the real value into the
                 // Color member, regardless if the mark has a literal value set.
-                brush.Color(static_cast<til::color>(m.Color.Color));
-                r.Fill(brush);
-                r.Width(16.0f / 3.0f); // pip width - 1/3rd of the scrollbar width.
-                r.Height(2);
+                const auto color = static_cast<til::color>(m.Color.Color);
                 const auto markRow = m.Start.Y;
                 const auto fractionalHeight = markRow / totalBufferRows;
-                const auto relativePos = fractionalHeight * fullHeight;
-                ScrollBarCanvas().Children().Append(r);
+                const auto relativePos = std::floor(fractionalHeight * fullHeight);
+                if (pips != 0 && relativePos == previousTop && color == previousColor)
+                {
+                    continue;
+                }
+                previousTop = relativePos;
+                previousColor = color;
+
+                Windows::UI::Xaml::Shapes::Rectangle r{ nullptr };
+                if (pips < children.Size())
+                {
+                    r = children.GetAt(pips).as<Windows::UI::Xaml::Shapes::Rectangle>();
+                    const auto brush = r.Fill().as<Media::SolidColorBrush>();
+                    if (static_cast<til::color>(brush.Color()) != color)
+                    {
+                        brush.Color(color);
+                    }
+                }
+                else
+                {
+                    r = {};
+                    Media::SolidColorBrush brush{};
+                    brush.Color(color);
+                    r.Fill(brush);
+                    r.Width(16.0f / 3.0f); // pip width - 1/3rd of the scrollbar width.
+                    r.Height(2);
+                    children.Append(r);
+                }
                 Windows::UI::Xaml::Controls::Canvas::SetTop(r, relativePos);
+                pips++;
+            }
+
+            while (children.Size() > pips)
+            {
+                children.RemoveAtEnd();
             }
         }
     }
@@ -399,6 +440,76 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _core.ToggleShaderEffects();
     }
 
+    // Method Description:
+    // - Shows or hides the overlay with the counters of the output parser.
+    //   While it's visible, it's updated once a second.
+    void TermControl::ToggleParserStatistics()
+    {
+        if (_parserStatisticsTimer)
+        {
+            _parserStatisticsTimer->Stop();
+            _parserStatisticsTimer.reset();
+            ParserStatisticsOverlay().Visibility(Visibility::Collapsed);
+            return;
+        }
+
+        DispatcherTimer timer;
+        timer.Interval(std::chrono::seconds(1));
+        timer.Tick({ get_weak(), &TermControl::_ParserStatisticsTimerTick });
+        timer.Start();
+        _parserStatisticsTimer.emplace(std::move(timer));
+
+        ParserStatisticsOverlay().Visibility(Visibility::Visible);
+        _ParserStatisticsTimerTick(nullptr, nullptr);
+    }
+
+    void TermControl::_ParserStatisticsTimerTick(const Windows::Foundation::IInspectable& /* sender */,
+                                                 const Windows::Foundation::IInspectable& /* e */)
+    {
+        if (!_IsClosing())
+        {
+            ParserStatisticsText().Text(_core.ParserStatisticsText());
+        }
+    }
+
+    // Method Description:
+    // - Shows or hides the overlay with the live performance counters of the
+    //   renderer, the terminal and the connection. While it's visible, it's
+    //   updated twice a second, with the rates over the last interval.
+    void TermControl::TogglePerformanceOverlay()
+    {
+        if (_performanceTimer)
+        {
+            _performanceTimer->Stop();
+            _performanceTimer.reset();
+            LockProfiler::EnableProfiling(false);
+            PerformanceOverlay().Visibility(Visibility::Collapsed);
+            return;
+        }
+
+        // The profiler is shared by all controls, and stays enabled as long as any overlay is visible.
+        LockProfiler::EnableProfiling(true);
+
+        DispatcherTimer timer;
+        timer.Interval(std::chrono::milliseconds(500));
+        timer.Tick({ get_weak(), &TermControl::_PerformanceTimerTick });
+        timer.Start();
+        _performanceTimer.emplace(std::move(timer));
+
+        // This establishes the baseline for the first interval.
+        PerformanceText().Text(_core.PerformanceStatisticsText());
+        PerformanceOverlay().Visibility(Visibility::Visible);
+    }
+
+    void TermControl::_PerformanceTimerTick(const Windows::Foundation::IInspectable& /* sender */,
+                                            const Windows::Foundation::IInspectable& /* e */)
+    {
+        if (!_IsClosing())
+        {
+            PerformanceText().Text(_core.PerformanceStatisticsText());
+        }
+    }
+
     // Method Description:
     // - Style our UI elements based on the values in our settings, and set up
     //   other control-specific settings. This method will be called whenever
@@ -701,6 +812,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         return _core.ConnectionState();
     }
 
+    TerminalConnection::ITerminalConnection TermControl::Connection() const
+    {
+        return _core.Connection();
+    }
+
     winrt::fire_and_forget TermControl::RenderEngineSwapChainChanged(IInspectable /*sender*/, IInspectable /*args*/)
     {
         // This event is only registered during terminal initialization,
@@ -817,6 +933,21 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // prepared to handle that.
         _core.EnablePainting();
 
+        // Let startup traces know when the first frame that contains our swap
+        // chain gets composed. This only needs to happen once per control.
+        _firstFrameRevoker = Media::CompositionTarget::Rendering(winrt::auto_revoke, [weakThis = get_weak()](auto&&, auto&&) {
+            if (auto control{ weakThis.get() })
+            {
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+                TraceLoggingWrite(g_hTerminalControlProvider,
+                                  "TermControlFirstFrame",
+                                  TraceLoggingDescription("Event emitted when the first frame of a TermControl is composed"),
+                                  TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                                  TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+                control->_firstFrameRevoker.revoke();
+            }
+        });
+
         auto bufferHeight = _core.BufferHeight();
 
         ScrollBar().Maximum(bufferHeight - bufferHeight);
@@ -1938,6 +2069,16 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             // Disconnect the TSF input control so it doesn't receive EditContext events.
             TSFInputControl().Close();
             _autoScrollTimer.Stop();
+            if (_parserStatisticsTimer)
+            {
+                _parserStatisticsTimer->Stop();
+            }
+            if (_performanceTimer)
+            {
+                _performanceTimer->Stop();
+                _performanceTimer.reset();
+                LockProfiler::EnableProfiling(false);
+            }
 
             _core.Close();
         }
@@ -1984,6 +2125,15 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     //   caller knows what monitor the control is about to appear on.
     // Return Value:
     // - a size containing the requested dimensions in pixels.
+    // Function Description:
+    // - Starts enumerating the installed fonts in the background. The first
+    //   renderer needs them before it can even measure a cell, so callers should
+    //   call this as early as possible during startup.
+    void TermControl::PrefetchFonts()
+    {
+        ::Microsoft::Console::Render::FontCache::Prefetch();
+    }
+
     winrt::Windows::Foundation::Size TermControl::GetProposedDimensions(const IControlSettings& settings, const uint32_t dpi)
     {
         // If the settings have negative or zero row or column counts, ignore those counts.
@@ -2177,6 +2327,18 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _core.WindowVisibilityChanged(showOrHide);
     }
 
+    // Method Description:
+    // - Forwards whether the control is shown within its window down into the
+    //   control core, which stops painting while it's hidden.
+    // Arguments:
+    // - visible: true if the control is shown, false if it's hidden.
+    // Return Value:
+    // - <none>
+    void TermControl::ContentVisibilityChanged(const bool visible)
+    {
+        _core.ContentVisibilityChanged(visible);
+    }
+
     // Method Description:
     // - Create XAML Thickness object based on padding props provided.
     //   Used for controlling the TermControl XAML Grid container's Padding prop.
@@ -2992,17 +3154,39 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
     // Method Description:
     // - Called when the core raises a FoundMatch event. That's done in response
-    //   to us starting a search query with ControlCore::Search.
+    //   to us starting a search query with ControlCore::Search. The core might
+    //   raise it on a background thread and more than once, while the search
+    //   is still running (see FoundResultsArgs::Complete).
     // - The args will tell us if there were or were not any results for that
     //   particular search. We'll use that to control what to announce to
-    //   Narrator. When we have more elaborate search information to report, we
-    //   may want to report that here. (see GH #3920)
+    //   Narrator, and the search box shows which match of how many is selected.
     // Arguments:
     // - args: contains information about the results that were or were not found.
     // Return Value:
     // - <none>
-    void TermControl::_coreFoundMatch(const IInspectable& /*sender*/, const Control::FoundResultsArgs& args)
+    winrt::fire_and_forget TermControl::_coreFoundMatch(IInspectable /*sender*/, Control::FoundResultsArgs args)
     {
+        auto weakThis{ get_weak() };
+        co_await resume_foreground(Dispatcher());
+        if (!weakThis.get())
+        {
+            co_return;
+        }
+
+        if (!args.Complete())
+        {
+            if (_searchBox)
+            {
+                _searchBox->SetPartialStatus(args.TotalMatches());
+            }
+            co_return;
+        }
+
+        if (_searchBox)
+        {
+            _searchBox->SetStatus(args.TotalMatches(), args.CurrentMatch());
+        }
+
         if (auto automationPeer{ Automation::Peers::FrameworkElementAutomationPeer::FromElement(*this) })
         {
             automationPeer.RaiseNotificationEvent(
@@ -3036,4 +3220,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         return _core.ScrollMarks();
     }
 
+    Control::MemoryUsage TermControl::MemoryUsage() const
+    {
+        return _core.MemoryUsage();
+    }
+
 }
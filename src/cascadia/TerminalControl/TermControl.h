@@ -46,6 +46,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         float SnapDimensionToGrid(const bool widthOrHeight, const float dimension);
 
         void WindowVisibilityChanged(const bool showOrHide);
+        void ContentVisibilityChanged(const bool visible);
 
 #pragma region ICoreState
         const uint64_t TaskbarState() const noexcept;
@@ -56,6 +57,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         hstring WorkingDirectory() const;
 
         TerminalConnection::ConnectionState ConnectionState() const;
+        TerminalConnection::ITerminalConnection Connection() const;
 
         int ScrollOffset() const;
         int ViewHeight() const;
@@ -69,6 +71,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void OwningHwnd(uint64_t owner);
 
         Windows::Foundation::Collections::IVector<Control::ScrollMark> ScrollMarks() const;
+        Control::MemoryUsage MemoryUsage() const;
         void AddMark(const Control::ScrollMark& mark);
         void ClearMark();
         void ClearAllMarks();
@@ -86,6 +89,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void ClearBuffer(Control::ClearBufferType clearType);
 
         void ToggleShaderEffects();
+        void ToggleParserStatistics();
+        void TogglePerformanceOverlay();
 
         winrt::fire_and_forget RenderEngineSwapChainChanged(IInspectable sender, IInspectable args);
         void _AttachDxgiSwapChainToXaml(HANDLE swapChainHandle);
@@ -112,6 +117,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         static Windows::Foundation::Size GetProposedDimensions(const IControlSettings& settings, const uint32_t dpi);
         static Windows::Foundation::Size GetProposedDimensions(const IControlSettings& settings, const uint32_t dpi, const winrt::Windows::Foundation::Size& initialSizeInChars);
+        static void PrefetchFonts();
 
         void BellLightOn();
 
@@ -139,6 +145,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         PROJECTED_FORWARDED_TYPED_EVENT(SetTaskbarProgress,     IInspectable, IInspectable, _core, TaskbarProgressChanged);
         PROJECTED_FORWARDED_TYPED_EVENT(ConnectionStateChanged, IInspectable, IInspectable, _core, ConnectionStateChanged);
         PROJECTED_FORWARDED_TYPED_EVENT(ShowWindowChanged,      IInspectable, Control::ShowWindowArgs, _core, ShowWindowChanged);
+        PROJECTED_FORWARDED_TYPED_EVENT(InputSent,              IInspectable, Control::InputSentEventArgs, _core, InputSent);
 
         PROJECTED_FORWARDED_TYPED_EVENT(PasteFromClipboard, IInspectable, Control::PasteFromClipboardEventArgs, _interactivity, PasteFromClipboard);
 
@@ -200,8 +207,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         std::optional<Windows::UI::Xaml::DispatcherTimer> _cursorTimer;
         std::optional<Windows::UI::Xaml::DispatcherTimer> _blinkTimer;
+        std::optional<Windows::UI::Xaml::DispatcherTimer> _parserStatisticsTimer;
+        std::optional<Windows::UI::Xaml::DispatcherTimer> _performanceTimer;
 
         winrt::Windows::UI::Xaml::Controls::SwapChainPanel::LayoutUpdated_revoker _layoutUpdatedRevoker;
+        winrt::Windows::UI::Xaml::Media::CompositionTarget::Rendering_revoker _firstFrameRevoker;
         bool _showMarksInScrollbar{ false };
 
         inline bool _IsClosing() const noexcept
@@ -251,6 +261,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void _CursorTimerTick(const Windows::Foundation::IInspectable& sender, const Windows::Foundation::IInspectable& e);
         void _BlinkTimerTick(const Windows::Foundation::IInspectable& sender, const Windows::Foundation::IInspectable& e);
         void _BellLightOff(const Windows::Foundation::IInspectable& sender, const Windows::Foundation::IInspectable& e);
+        void _ParserStatisticsTimerTick(const Windows::Foundation::IInspectable& sender, const Windows::Foundation::IInspectable& e);
+        void _PerformanceTimerTick(const Windows::Foundation::IInspectable& sender, const Windows::Foundation::IInspectable& e);
 
         void _SetEndSelectionPointAtCursor(const Windows::Foundation::Point& cursorPosition);
 
@@ -295,7 +307,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         winrt::fire_and_forget _coreTransparencyChanged(IInspectable sender, Control::TransparencyChangedEventArgs args);
         void _coreRaisedNotice(const IInspectable& s, const Control::NoticeEventArgs& args);
         void _coreWarningBell(const IInspectable& sender, const IInspectable& args);
-        void _coreFoundMatch(const IInspectable& sender, const Control::FoundResultsArgs& args);
+        winrt::fire_and_forget _coreFoundMatch(IInspectable sender, Control::FoundResultsArgs args);
 
         til::point _toPosInDips(const Core::Point terminalCellPos);
         void _throttledUpdateScrollbar(const ScrollBarUpdate& update);
@@ -30,6 +30,18 @@ namespace XamlAutomation
 
 static constexpr wchar_t UNICODE_NEWLINE{ L'\n' };
 
+// The minimum delay between text changed events and new output notifications.
+// Fast output would otherwise flood screen readers with events,
+// each of which makes them query the buffer again.
+constexpr const auto UiaNotificationInterval = std::chrono::milliseconds(50);
+
+// The speech API is limited to 1000 characters per notification.
+static constexpr size_t SapiLimit{ 1000 };
+
+// Output that's queued up faster than it can be announced is dropped from the front.
+// Only the most recent output is worth reading out, and it bounds the size of each batch.
+static constexpr size_t MaxQueuedOutput{ 4 * SapiLimit };
+
 // Method Description:
 // - creates a copy of the provided text with all of the control characters removed
 // Arguments:
@@ -84,6 +96,27 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _contentAutomationPeer.CursorChanged([this](auto&&, auto&&) { SignalCursorChanged(); });
         _contentAutomationPeer.NewOutput([this](auto&&, hstring newOutput) { NotifyNewOutput(newOutput); });
         _contentAutomationPeer.ParentProvider(*this);
+
+        auto dispatcher = winrt::Windows::System::DispatcherQueue::GetForCurrentThread();
+        _raiseTextChanged = std::make_shared<ThrottledFuncTrailing<>>(
+            dispatcher,
+            UiaNotificationInterval,
+            [weakThis = get_weak()]() {
+                if (auto strongThis{ weakThis.get() })
+                {
+                    // The event that is raised when textual content is modified.
+                    strongThis->RaiseAutomationEvent(AutomationEvents::TextPatternOnTextChanged);
+                }
+            });
+        _raiseNewOutput = std::make_shared<ThrottledFuncTrailing<>>(
+            dispatcher,
+            UiaNotificationInterval,
+            [weakThis = get_weak()]() {
+                if (auto strongThis{ weakThis.get() })
+                {
+                    strongThis->_flushQueuedOutput();
+                }
+            });
     };
 
     // Method Description:
@@ -142,6 +175,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
     // Method Description:
     // - Signals the ui automation client that the terminal's output has changed and should be updated
+    // - Multiple signals within UiaNotificationInterval are coalesced into a single event.
     // Arguments:
     // - <none>
     // Return Value:
@@ -149,18 +183,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     void TermControlAutomationPeer::SignalTextChanged()
     {
         UiaTracing::Signal::TextChanged();
-        auto dispatcher{ Dispatcher() };
-        if (!dispatcher)
-        {
-            return;
-        }
-        dispatcher.RunAsync(Windows::UI::Core::CoreDispatcherPriority::Normal, [weakThis{ get_weak() }]() {
-            if (auto strongThis{ weakThis.get() })
-            {
-                // The event that is raised when textual content is modified.
-                strongThis->RaiseAutomationEvent(AutomationEvents::TextPatternOnTextChanged);
-            }
-        });
+        _raiseTextChanged->Run();
     }
 
     // Method Description:
@@ -223,29 +246,49 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return;
         }
 
-        auto dispatcher{ Dispatcher() };
-        if (!dispatcher)
         {
-            return;
+            const std::lock_guard guard{ _queuedOutputLock };
+            _queuedOutput.append(sanitized);
+            if (_queuedOutput.size() > MaxQueuedOutput)
+            {
+                _queuedOutput.erase(0, _queuedOutput.size() - MaxQueuedOutput);
+            }
         }
 
-        // IMPORTANT:
-        // [1] make sure the scope returns a copy of "sanitized" so that it isn't accidentally deleted
-        // [2] AutomationNotificationProcessing::All --> ensures it can be interrupted by keyboard events
-        // [3] Do not "RunAsync(...).get()". For whatever reason, this causes NVDA to just not receive "SignalTextChanged()"'s events.
-        dispatcher.RunAsync(Windows::UI::Core::CoreDispatcherPriority::Normal, [weakThis{ get_weak() }, sanitizedCopy{ hstring{ sanitized } }]() {
-            if (auto strongThis{ weakThis.get() })
+        // Do not wait for the notification to be raised on the UI thread.
+        // For whatever reason, this causes NVDA to just not receive "SignalTextChanged()"'s events.
+        _raiseNewOutput->Run();
+    }
+
+    // Method Description:
+    // - Announces the output that NotifyNewOutput queued up since the last call.
+    //   This is called on the UI thread, at most once every UiaNotificationInterval.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void TermControlAutomationPeer::_flushQueuedOutput()
+    {
+        std::wstring output;
+        {
+            const std::lock_guard guard{ _queuedOutputLock };
+            std::swap(output, _queuedOutput);
+        }
+
+        // Break up the output into chunks the speech API can handle, so it isn't cut off.
+        // AutomationNotificationProcessing::All --> ensures it can be interrupted by keyboard events
+        const std::wstring_view view{ output };
+        for (size_t offset = 0; offset < view.size(); offset += SapiLimit)
+        {
+            try
             {
-                try
-                {
-                    strongThis->RaiseNotificationEvent(AutomationNotificationKind::ActionCompleted,
-                                                       AutomationNotificationProcessing::All,
-                                                       sanitizedCopy,
-                                                       L"TerminalTextOutput");
-                }
-                CATCH_LOG();
+                RaiseNotificationEvent(AutomationNotificationKind::ActionCompleted,
+                                       AutomationNotificationProcessing::All,
+                                       hstring{ view.substr(offset, SapiLimit) },
+                                       L"TerminalTextOutput");
             }
-        });
+            CATCH_LOG();
+        }
     }
 
     hstring TermControlAutomationPeer::GetClassNameCore() const
@@ -81,5 +81,13 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         winrt::Microsoft::Terminal::Control::implementation::TermControl* _termControl;
         Control::InteractivityAutomationPeer _contentAutomationPeer;
         std::deque<wchar_t> _keyEvents;
+
+        // Output is collected in _queuedOutput and announced in batches by _raiseNewOutput.
+        std::shared_ptr<ThrottledFuncTrailing<>> _raiseTextChanged;
+        std::shared_ptr<ThrottledFuncTrailing<>> _raiseNewOutput;
+        std::mutex _queuedOutputLock;
+        std::wstring _queuedOutput;
+
+        void _flushQueuedOutput();
     };
 }
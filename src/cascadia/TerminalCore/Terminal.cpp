@@ -50,7 +50,8 @@ Terminal::Terminal() :
     _taskbarState{ 0 },
     _taskbarProgress{ 0 },
     _trimBlockSelection{ false },
-    _autoMarkPrompts{ false }
+    _autoMarkPrompts{ false },
+    _predictiveEcho{ false }
 {
     auto passAlongInput = [&](std::deque<std::unique_ptr<IInputEvent>>& inEventsToWrite) {
         if (!_pfnWriteInput)
@@ -123,6 +124,11 @@ void Terminal::UpdateSettings(ICoreSettings settings)
     _startingTitle = settings.StartingTitle();
     _trimBlockSelection = settings.TrimBlockSelection();
     _autoMarkPrompts = settings.AutoMarkPrompts();
+    _predictiveEcho = settings.PredictiveEcho();
+    if (!_predictiveEcho)
+    {
+        _ClearPredictions();
+    }
 
     _terminalInput->ForceDisableWin32InputMode(settings.ForceVTInput());
 
@@ -454,6 +460,7 @@ std::wstring_view Terminal::GetWorkingDirectory()
     _mutableViewport = Viewport::FromDimensions({ 0, proposedTop }, viewportSize);
 
     _mainBuffer.swap(newTextBuffer);
+    _patternSource.reset();
 
     // GH#3494: Maintain scrollbar position during resize
     // Make sure that we don't scroll past the mutableViewport at the bottom of the buffer
@@ -476,16 +483,55 @@ std::wstring_view Terminal::GetWorkingDirectory()
     return S_OK;
 }
 
-void Terminal::Write(std::wstring_view stringView)
+// Routine Description:
+// - Applies output to the buffer while holding the write lock. The cursor
+//   redraws and scroll events are deferred until all of it has been applied.
+// Arguments:
+// - length: the number of characters of the output, for GetWriteStatistics().
+// - write: a callable that applies the output to the active buffer.
+template<typename Func>
+void Terminal::_WriteOutput(const size_t length, Func&& write)
 {
+    const auto waitStart = std::chrono::steady_clock::now();
     auto lock = LockForWriting();
+    const auto writeStart = std::chrono::steady_clock::now();
 
-    auto& cursor = _activeBuffer().GetCursor();
-    const til::point cursorPosBefore{ cursor.GetPosition() };
+    const til::point cursorPosBefore{ _activeBuffer().GetCursor().GetPosition() };
 
-    _stateMachine->ProcessString(stringView);
+    {
+        // Full screen applications move the cursor around and scroll a lot while they redraw.
+        // Only the final state is of interest, so the cursor redraws and scroll events are
+        // deferred until the whole string has been processed.
+        const auto wasInAltBuffer = _inAltBuffer();
+        _activeBuffer().GetCursor().StartDeferDrawing();
+        _deferScrollEvents = true;
+        const auto endDefer = wil::scope_exit([&]() noexcept {
+            // The alt buffer might have been destroyed by the output we just processed.
+            if (const auto& buffer = wasInAltBuffer ? _altBuffer : _mainBuffer)
+            {
+                buffer->GetCursor().EndDeferDrawing();
+            }
+
+            _deferScrollEvents = false;
+            if (std::exchange(_hasDeferredScrollEvent, false))
+            {
+                _NotifyScrollEvent();
+            }
+        });
 
-    const til::point cursorPosAfter{ cursor.GetPosition() };
+        write();
+
+        // Compacting re-interns the runs of every row, so it's done once per write instead of once per line.
+        _mainBuffer->CompactAttributeTable();
+        if (_altBuffer)
+        {
+            _altBuffer->CompactAttributeTable();
+        }
+    }
+
+    _ReconcilePredictions();
+
+    const til::point cursorPosAfter{ _activeBuffer().GetCursor().GetPosition() };
 
     // Firing the CursorPositionChanged event is very expensive so we try not to
     // do that when the cursor does not need to be redrawn. We don't do this
@@ -495,6 +541,46 @@ void Terminal::Write(std::wstring_view stringView)
     {
         _NotifyTerminalCursorPositionChanged();
     }
+
+    const auto writeEnd = std::chrono::steady_clock::now();
+    _writtenCharacters.fetch_add(length, std::memory_order_relaxed);
+    _writeLockWaitNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(writeStart - waitStart).count(), std::memory_order_relaxed);
+    _writeNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(writeEnd - writeStart).count(), std::memory_order_relaxed);
+}
+
+void Terminal::Write(std::wstring_view stringView)
+{
+    _WriteOutput(stringView.size(), [&]() {
+        _stateMachine->ProcessString(stringView);
+    });
+}
+
+void Terminal::WritePlainText(std::wstring_view stringView)
+{
+    _WriteOutput(stringView.size(), [&]() {
+        while (!stringView.empty())
+        {
+            const auto end = stringView.find_first_of(L"\r\n");
+            if (const auto text = stringView.substr(0, end); !text.empty())
+            {
+                _WriteBuffer(text);
+            }
+            if (end == std::wstring_view::npos)
+            {
+                break;
+            }
+
+            if (stringView[end] == L'\n')
+            {
+                LineFeed(true);
+            }
+            else
+            {
+                _AdjustCursorPosition({ 0, _activeBuffer().GetCursor().GetPosition().Y });
+            }
+            stringView = stringView.substr(end + 1);
+        }
+    });
 }
 
 void Terminal::WritePastedText(std::wstring_view stringView)
@@ -773,6 +859,8 @@ bool Terminal::SendCharEvent(const wchar_t ch, const WORD scanCode, const Contro
         AddMark(mark);
     }
 
+    _PredictCharacter(ch, states);
+
     // Unfortunately, the UI doesn't give us both a character down and a
     // character up event, only a character received event. So fake sending both
     // to the terminal input translator. Unless it's in win32-input-mode, it'll
@@ -784,6 +872,158 @@ bool Terminal::SendCharEvent(const wchar_t ch, const WORD scanCode, const Contro
     return handledDown || handledUp;
 }
 
+// Method Description:
+// - Speculatively echoes a typed character at the cursor, so that typing over
+//   a connection with a high latency doesn't feel sluggish. The prediction is
+//   drawn as an (underlined) overlay until the output of the connection
+//   either confirms or contradicts it. See _ReconcilePredictions.
+// - Anything that isn't a plain printable character (Enter, Backspace, Ctrl+C, ...)
+//   may edit the line in ways we can't foresee and drops all predictions.
+// Arguments:
+// - ch: The character that was typed.
+// - states: The modifier key states at the time.
+void Terminal::_PredictCharacter(const wchar_t ch, const ControlKeyStates states)
+{
+    if (!_predictiveEcho)
+    {
+        return;
+    }
+
+    auto lock = LockForWriting();
+
+    const auto& buffer = _activeBuffer();
+    const auto& cursor = buffer.GetCursor();
+    const auto printable = ch >= L' ' && ch != L'\x7f' && !IS_HIGH_SURROGATE(ch) && !IS_LOW_SURROGATE(ch) && !IsGlyphFullWidth(ch);
+    const auto altered = states.IsAltPressed() && !states.IsAltGrPressed();
+
+    // Full screen applications draw the characters wherever they please.
+    if (!printable || altered || _inAltBuffer() || !cursor.IsVisible())
+    {
+        _ClearPredictions();
+        return;
+    }
+
+    if (_predictedText.empty())
+    {
+        _predictionOrigin = cursor.GetPosition();
+        _predictionDeadline = std::chrono::steady_clock::now() + PredictionTimeout;
+    }
+
+    const auto width = buffer.GetSize().Width();
+    if (!_predictionBuffer || _predictionBuffer->GetSize().Width() != width)
+    {
+        _predictionBuffer = std::make_unique<TextBuffer>(til::size{ width, 1 }, TextAttribute{}, 0, false, _mainBuffer->GetRenderer());
+    }
+
+    // Predictions don't wrap, since we can't know whether the line would
+    // be wrapped or scrolled or what the application does at the margin.
+    const auto column = _predictionOrigin.x + gsl::narrow_cast<til::CoordType>(_predictedText.size());
+    if (column >= width)
+    {
+        return;
+    }
+
+    auto attributes = buffer.GetCurrentAttributes();
+    attributes.SetUnderlined(true);
+    _predictionBuffer->WriteLine(OutputCellIterator{ ch, attributes, 1 }, { column, 0 });
+    _predictedText.push_back(ch);
+    _TriggerPredictionRedraw();
+}
+
+// Method Description:
+// - Compares the predicted characters with what the connection actually wrote.
+//   A prediction is confirmed once the cursor moved past its cell and the cell
+//   contains the predicted character. If the cell contains anything else, or
+//   the cursor went up above the predictions, all predictions are dropped.
+// - Must be called with the write lock held.
+void Terminal::_ReconcilePredictions()
+{
+    if (_predictedText.empty())
+    {
+        return;
+    }
+
+    const auto& buffer = _activeBuffer();
+    const auto cursor = buffer.GetCursor().GetPosition();
+    if (_inAltBuffer() || cursor.y < _predictionOrigin.y)
+    {
+        _ClearPredictions();
+        return;
+    }
+
+    size_t confirmed = 0;
+    for (; confirmed < _predictedText.size(); ++confirmed)
+    {
+        const til::point pos{ _predictionOrigin.x + gsl::narrow_cast<til::CoordType>(confirmed), _predictionOrigin.y };
+        // The output hasn't gotten this far yet.
+        if (cursor.y == pos.y && cursor.x <= pos.x)
+        {
+            break;
+        }
+        if (buffer.GetCellDataAt(pos)->Chars() != std::wstring_view{ &til::at(_predictedText, confirmed), 1 })
+        {
+            // Something else got echoed (or nothing at all, like at a password prompt).
+            _predictionsConfirmed = false;
+            _ClearPredictions();
+            return;
+        }
+    }
+
+    if (confirmed != 0)
+    {
+        _predictionsConfirmed = true;
+        _predictedText.erase(0, confirmed);
+        _predictionOrigin.x += gsl::narrow_cast<til::CoordType>(confirmed);
+        _predictionDeadline = std::chrono::steady_clock::now() + PredictionTimeout;
+        // The confirmed cells were redrawn by the output itself, but the cursor
+        // and the remaining predictions may have been hidden until now.
+        _TriggerPredictionRedraw();
+    }
+}
+
+// Method Description:
+// - Drops all predictions that the connection didn't confirm in time.
+//   Since it didn't echo them, further predictions stay hidden until it does.
+// Return Value:
+// - true if there are predictions left that are still waiting for their echo.
+bool Terminal::ExpirePredictions()
+{
+    auto lock = LockForWriting();
+
+    if (!_predictedText.empty() && std::chrono::steady_clock::now() >= _predictionDeadline)
+    {
+        _predictionsConfirmed = false;
+        _ClearPredictions();
+    }
+    return !_predictedText.empty();
+}
+
+void Terminal::_ClearPredictions()
+{
+    if (!_predictedText.empty())
+    {
+        _TriggerPredictionRedraw();
+        _predictedText.clear();
+    }
+}
+
+// Invalidates the predicted cells and the cell after them, where the cursor is drawn.
+void Terminal::_TriggerPredictionRedraw() const
+{
+    auto& buffer = _activeBuffer();
+    const auto count = gsl::narrow_cast<til::CoordType>(_predictedText.size()) + 1;
+    const auto width = std::min(count, buffer.GetSize().Width() - _predictionOrigin.x);
+    if (width > 0)
+    {
+        buffer.TriggerRedraw(Viewport::FromDimensions(_predictionOrigin, { width, 1 }));
+    }
+}
+
+bool Terminal::_HasVisiblePredictions() const noexcept
+{
+    return _predictionsConfirmed && !_predictedText.empty() && !_inAltBuffer();
+}
+
 // Method Description:
 // - Tell the terminal input that we gained or lost focus. If the client
 //   requested focus events, this will send a message to them.
@@ -812,6 +1052,44 @@ void Terminal::_InvalidatePatternTree(interval_tree::IntervalTree<til::point, si
     tree.visit_all(invalidate);
 }
 
+// Method Description:
+// - Invalidates the regions of the matches that are only in one of the two trees.
+//   A match that's in both at the same buffer position looks the same before
+//   and after, so when a single line changed, only the matches of that line
+//   are redrawn instead of every match in the viewport.
+// Arguments:
+// - oldTree - The previous interval tree
+// - oldTop - The buffer row that row 0 of the previous tree refers to
+// - newTree - The new interval tree
+// - newTop - The buffer row that row 0 of the new tree refers to
+void Terminal::_InvalidatePatternTreeChanges(const interval_tree::IntervalTree<til::point, size_t>& oldTree,
+                                             const til::CoordType oldTop,
+                                             const interval_tree::IntervalTree<til::point, size_t>& newTree,
+                                             const til::CoordType newTop)
+{
+    using Match = std::tuple<til::point, til::point, size_t>;
+    const auto collect = [](const PointTree& tree, const til::CoordType top) {
+        std::vector<Match> matches;
+        tree.visit_all([&](const PointTree::interval& interval) {
+            matches.emplace_back(til::point{ interval.start.x, interval.start.y + top },
+                                 til::point{ interval.stop.x, interval.stop.y + top },
+                                 interval.value);
+        });
+        std::sort(matches.begin(), matches.end());
+        return matches;
+    };
+
+    const auto oldMatches = collect(oldTree, oldTop);
+    const auto newMatches = collect(newTree, newTop);
+
+    std::vector<Match> changes;
+    std::set_symmetric_difference(oldMatches.begin(), oldMatches.end(), newMatches.begin(), newMatches.end(), std::back_inserter(changes));
+    for (const auto& [start, end, id] : changes)
+    {
+        _InvalidateFromCoords(start, end);
+    }
+}
+
 // Method Description:
 // - Given start and end coords, invalidates all the regions between them
 // Arguments:
@@ -953,19 +1231,16 @@ WORD Terminal::_TakeVirtualKeyFromLastKeyEvent(const WORD scanCode) noexcept
 }
 
 // Method Description:
-// - Acquire a read lock on the terminal.
+// - Acquire a read lock on the terminal. Any number of readers may hold it at
+//   the same time, but none of them may modify the terminal's state.
 // Return Value:
 // - a shared_lock which can be used to unlock the terminal. The shared_lock
 //      will release this lock when it's destructed.
-[[nodiscard]] std::unique_lock<til::ticket_lock> Terminal::LockForReading()
+// - The caller's return address is recorded as the site of the acquisition.
+[[nodiscard]] __declspec(noinline) std::shared_lock<ProfiledSharedMutex> Terminal::LockForReading()
 {
-#ifdef NDEBUG
-    return std::unique_lock{ _readWriteLock };
-#else
-    auto lock = std::unique_lock{ _readWriteLock };
-    _lastLocker = GetCurrentThreadId();
-    return lock;
-#endif
+    _readWriteLock.lock_shared(_ReturnAddress(), LockAcquirer::Other);
+    return std::shared_lock{ _readWriteLock, std::adopt_lock };
 }
 
 // Method Description:
@@ -973,26 +1248,33 @@ WORD Terminal::_TakeVirtualKeyFromLastKeyEvent(const WORD scanCode) noexcept
 // Return Value:
 // - a unique_lock which can be used to unlock the terminal. The unique_lock
 //      will release this lock when it's destructed.
-[[nodiscard]] std::unique_lock<til::ticket_lock> Terminal::LockForWriting()
+// - The caller's return address is recorded as the site of the acquisition.
+[[nodiscard]] __declspec(noinline) std::unique_lock<ProfiledSharedMutex> Terminal::LockForWriting()
 {
-#ifdef NDEBUG
-    return std::unique_lock{ _readWriteLock };
-#else
-    auto lock = std::unique_lock{ _readWriteLock };
+    _readWriteLock.lock(_ReturnAddress(), LockAcquirer::Other);
+#ifndef NDEBUG
     _lastLocker = GetCurrentThreadId();
-    return lock;
 #endif
+    return std::unique_lock{ _readWriteLock, std::adopt_lock };
 }
 
 // Method Description:
 // - Get a reference to the the terminal's read/write lock.
 // Return Value:
-// - a ticket_lock which can be used to manually lock or unlock the terminal.
-til::ticket_lock& Terminal::GetReadWriteLock() noexcept
+// - a shared mutex which can be used to manually lock or unlock the terminal.
+ProfiledSharedMutex& Terminal::GetReadWriteLock() noexcept
 {
     return _readWriteLock;
 }
 
+// Method Description:
+// - Returns who waited for and held the terminal's lock for how long, while
+//   lock profiling was enabled (see LockProfiler::EnableProfiling).
+LockProfiler::Statistics Terminal::GetLockStatistics() const noexcept
+{
+    return _readWriteLock.GetStatistics();
+}
+
 Viewport Terminal::_GetMutableViewport() const noexcept
 {
     // GH#3493: if we're in the alt buffer, then it's possible that the mutable
@@ -1059,11 +1341,14 @@ void Terminal::_WriteBuffer(const std::wstring_view& stringView)
     // We can not waste time displaying a cursor event when we know more text is coming right behind it.
     cursor.StartDeferDrawing();
 
+    // Moving the cursor within a row can't scroll the viewport or circle the
+    // buffer, so those moves are only tracked here and the cursor itself is
+    // only moved once we leave the row or run out of text.
+    auto proposedCursorPosition = cursor.GetPosition();
     for (size_t i = 0; i < stringView.size(); i++)
     {
         const auto wch = stringView.at(i);
-        const auto cursorPosBefore = cursor.GetPosition();
-        auto proposedCursorPosition = cursorPosBefore;
+        const auto cursorPosBefore = proposedCursorPosition;
 
         // TODO: MSFT 21006766
         // This is not great but I need it demoable. Fix by making a buffer stream writer.
@@ -1073,7 +1358,7 @@ void Terminal::_WriteBuffer(const std::wstring_view& stringView)
         const auto isSurrogate = wch >= 0xD800 && wch <= 0xDFFF;
         const auto view = stringView.substr(i, isSurrogate ? 2 : 1);
         const OutputCellIterator it{ view, _activeBuffer().GetCurrentAttributes() };
-        const auto end = _activeBuffer().Write(it);
+        const auto end = _activeBuffer().Write(it, proposedCursorPosition);
         const auto cellDistance = end.GetCellDistance(it);
         const auto inputDistance = end.GetInputDistance(it);
 
@@ -1109,6 +1394,16 @@ void Terminal::_WriteBuffer(const std::wstring_view& stringView)
             // here.
         }
 
+        if (proposedCursorPosition.Y != cursorPosBefore.Y)
+        {
+            // _AdjustCursorPosition might have circled the buffer, which moves the cursor up.
+            _AdjustCursorPosition(proposedCursorPosition);
+            proposedCursorPosition = cursor.GetPosition();
+        }
+    }
+
+    if (!stringView.empty())
+    {
         _AdjustCursorPosition(proposedCursorPosition);
     }
 
@@ -1167,6 +1462,7 @@ void Terminal::_AdjustCursorPosition(const til::point proposedPosition)
 
         // manually erase our pattern intervals since the locations have changed now
         _patternIntervalTree = {};
+        _patternSource.reset();
     }
 
     // Update Cursor Position
@@ -1221,16 +1517,14 @@ void Terminal::_AdjustCursorPosition(const til::point proposedPosition)
 
     if (rowsPushedOffTopOfBuffer != 0)
     {
-        if (_scrollMarks.size() > 0)
+        _ShiftScrollMarks(rowsPushedOffTopOfBuffer);
+        if (!_predictedText.empty())
         {
-            for (auto& mark : _scrollMarks)
+            _predictionOrigin.y -= rowsPushedOffTopOfBuffer;
+            if (_predictionOrigin.y < 0)
             {
-                mark.start.y -= rowsPushedOffTopOfBuffer;
+                _predictedText.clear();
             }
-            _scrollMarks.erase(std::remove_if(_scrollMarks.begin(),
-                                              _scrollMarks.end(),
-                                              [](const VirtualTerminal::DispatchTypes::ScrollMark& m) { return m.start.y < 0; }),
-                               _scrollMarks.end());
         }
         // We have to report the delta here because we might have circled the text buffer.
         // That didn't change the viewport and therefore the TriggerScroll(void)
@@ -1271,6 +1565,12 @@ int Terminal::GetScrollOffset() noexcept
 void Terminal::_NotifyScrollEvent() noexcept
 try
 {
+    if (_deferScrollEvents)
+    {
+        _hasDeferredScrollEvent = true;
+        return;
+    }
+
     if (_pfnScrollPositionChanged)
     {
         const auto visible = _GetVisibleViewport();
@@ -1372,17 +1672,118 @@ bool Terminal::IsCursorBlinkingAllowed() const noexcept
     return !_markMode && cursor.IsBlinkingAllowed();
 }
 
+// Method Description:
+// - Returns the counters of the output parser, for diagnostics.
+// - INVARIANT: this function can only be called if the caller has the reading lock on the terminal
+const ::Microsoft::Console::VirtualTerminal::ParserStatistics& Terminal::GetParserStatistics() const noexcept
+{
+    return _stateMachine->GetStatistics();
+}
+
+// Method Description:
+// - Adds up the memory held by both buffers and the scroll marks. The alt
+//   buffer only counts while it exists, i.e. while it's in use.
+// - INVARIANT: The caller must hold at least the read lock.
+Terminal::MemoryUsage Terminal::GetMemoryUsage() const noexcept
+{
+    MemoryUsage usage;
+    if (_mainBuffer)
+    {
+        usage.mainBuffer = _mainBuffer->GetMemoryUsage();
+    }
+    if (_altBuffer)
+    {
+        usage.altBuffer = _altBuffer->GetMemoryUsage();
+    }
+    // A deque allocates its elements in blocks, which this ignores the slack of.
+    usage.scrollMarks = _scrollMarks.size() * sizeof(decltype(_scrollMarks)::value_type);
+    return usage;
+}
+
+// Method Description:
+// - Returns how much output was written so far, how long the writers waited
+//   for the lock and how long they held it. This doesn't need the lock.
+Terminal::WriteStatistics Terminal::GetWriteStatistics() const noexcept
+{
+    WriteStatistics statistics;
+    statistics.characters = _writtenCharacters.load(std::memory_order_relaxed);
+    statistics.lockWait = std::chrono::nanoseconds{ _writeLockWaitNs.load(std::memory_order_relaxed) };
+    statistics.writing = std::chrono::nanoseconds{ _writeNs.load(std::memory_order_relaxed) };
+    return statistics;
+}
+
 // Method Description:
 // - Update our internal knowledge about where regex patterns are on the screen
-// - This is called by TerminalControl (through a throttled function) when the visible
-//   region changes (for example by text entering the buffer or scrolling)
+// - Unlike the SnapshotPatternsUnderLock/ApplyPatternsUnderLock pair that
+//   TerminalControl uses, this searches the patterns while holding the lock.
 // - INVARIANT: this function can only be called if the caller has the writing lock on the terminal
 void Terminal::UpdatePatternsUnderLock() noexcept
+try
 {
-    auto oldTree = _patternIntervalTree;
-    _patternIntervalTree = _activeBuffer().GetPatterns(_VisibleStartIndex(), _VisibleEndIndex());
-    _InvalidatePatternTree(oldTree);
-    _InvalidatePatternTree(_patternIntervalTree);
+    if (auto request = SnapshotPatternsUnderLock())
+    {
+        ApplyPatternsUnderLock(request->source, TextBuffer::FindPatterns(request->snapshot, &_patternCache));
+    }
+}
+CATCH_LOG()
+
+// Method Description:
+// - Copies the text of the visible rows, so that the patterns in them can be
+//   searched without holding the lock. This is called by TerminalControl
+//   (through a throttled function) when the visible region changes (for
+//   example by text entering the buffer or scrolling)
+// - INVARIANT: this function can only be called if the caller has the writing lock on the terminal
+// Return Value:
+// - The rows to pass to TextBuffer::FindPatterns, or nullopt if none of them changed
+//   since the patterns were last found.
+std::optional<Terminal::PatternRequest> Terminal::SnapshotPatternsUnderLock()
+{
+    const auto& buffer = _activeBuffer();
+    const auto start = _VisibleStartIndex();
+    const auto end = _VisibleEndIndex();
+    const auto patterns = buffer.GetPatternRecognizers();
+
+    // Skip rescanning the viewport if none of its rows changed.
+    if (_patternSource &&
+        _patternSource->buffer == &buffer &&
+        _patternSource->patterns == patterns &&
+        _patternSource->start == start &&
+        _patternSource->end == end &&
+        !buffer.HasChangedSince(_patternSource->revision, start, end))
+    {
+        return std::nullopt;
+    }
+
+    return PatternRequest{
+        PatternSource{ &buffer, patterns, buffer.GetRevision(), start, end },
+        buffer.SnapshotPatternText(start, end),
+    };
+}
+
+// Method Description:
+// - Stores the patterns that were found in the rows returned by SnapshotPatternsUnderLock.
+// - If the viewport moved or the patterns changed in the meantime, the tree is
+//   outdated and dropped. Whatever changed has scheduled another update already.
+// - INVARIANT: this function can only be called if the caller has the writing lock on the terminal
+// Arguments:
+// - source - The source of the PatternRequest the tree was computed from
+// - tree - The patterns found by TextBuffer::FindPatterns
+void Terminal::ApplyPatternsUnderLock(const PatternSource& source, interval_tree::IntervalTree<til::point, size_t> tree) noexcept
+{
+    const auto& buffer = _activeBuffer();
+    if (source.buffer != &buffer ||
+        source.patterns != buffer.GetPatternRecognizers() ||
+        source.start != _VisibleStartIndex() ||
+        source.end != _VisibleEndIndex())
+    {
+        return;
+    }
+
+    auto oldTree = std::move(_patternIntervalTree);
+    const auto oldTop = _patternSource ? _patternSource->start : source.start;
+    _patternIntervalTree = std::move(tree);
+    _patternSource = source;
+    _InvalidatePatternTreeChanges(oldTree, oldTop, _patternIntervalTree, source.start);
 }
 
 // Method Description:
@@ -1393,9 +1794,22 @@ void Terminal::ClearPatternTree() noexcept
 {
     auto oldTree = _patternIntervalTree;
     _patternIntervalTree = {};
+    _patternSource.reset();
     _InvalidatePatternTree(oldTree);
 }
 
+// Method Description:
+// - Invalidates the cells of a single match of the pattern tree, for instance
+//   when the mouse started or stopped hovering over it.
+// - INVARIANT: this function can only be called if the caller has the writing lock on the terminal
+// Arguments:
+// - interval - A match, as returned by GetHyperlinkIntervalFromPosition
+void Terminal::InvalidatePatternIntervalUnderLock(const PointTree::interval& interval)
+{
+    const auto vis = _VisibleStartIndex();
+    _InvalidateFromCoords({ interval.start.x, interval.start.y + vis }, { interval.stop.x, interval.stop.y + vis });
+}
+
 // Method Description:
 // - Returns the tab color
 // If the starting color exists, its value is preferred
@@ -1508,6 +1922,7 @@ void Terminal::_updateUrlDetection()
         // Add regex pattern recognizers to the buffer
         // For now, we only add the URI regex pattern
         _hyperlinkPatternId = _activeBuffer().AddPatternRecognizer(linkPattern);
+        _patternSource.reset();
         UpdatePatternsUnderLock();
     }
     else
@@ -1526,10 +1941,15 @@ void Terminal::AddMark(const Microsoft::Console::VirtualTerminal::DispatchTypes:
     }
 
     DispatchTypes::ScrollMark m = mark;
-    m.start = start;
-    m.end = end;
+    m.start = { start.x, start.y + _scrollMarksOrigin };
+    m.end = { end.x, end.y + _scrollMarksOrigin };
 
-    _scrollMarks.push_back(m);
+    // Marks are almost always added below all the others (at the next prompt),
+    // so this is usually the end. They're kept in the order they were added otherwise.
+    const auto it = std::upper_bound(_scrollMarks.begin(), _scrollMarks.end(), m, [](const auto& lhs, const auto& rhs) {
+        return lhs.start < rhs.start;
+    });
+    _scrollMarks.insert(it, m);
 
     // Tell the control that the scrollbar has somehow changed. Used as a
     // workaround to force the control to redraw any scrollbar marks
@@ -1551,6 +1971,9 @@ void Terminal::ClearMark()
         end = til::point{ GetSelectionEnd() };
     }
 
+    start.y += _scrollMarksOrigin;
+    end.y += _scrollMarksOrigin;
+
     _scrollMarks.erase(std::remove_if(_scrollMarks.begin(),
                                       _scrollMarks.end(),
                                       [&start, &end](const auto& m) {
@@ -1566,19 +1989,111 @@ void Terminal::ClearMark()
 void Terminal::ClearAllMarks()
 {
     _scrollMarks.clear();
+    _scrollMarksOrigin = 0;
     // Tell the control that the scrollbar has somehow changed. Used as a
     // workaround to force the control to redraw any scrollbar marks
     _NotifyScrollEvent();
 }
 
-const std::vector<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark>& Terminal::GetScrollMarks() const
+// Method Description:
+// - Returns all marks, sorted by their start, relative to the top of the buffer.
+std::vector<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark> Terminal::GetScrollMarks() const
 {
+    std::vector<DispatchTypes::ScrollMark> marks;
+
     // TODO: GH#11000 - when the marks are stored per-buffer, get rid of this.
     // We want to return _no_ marks when we're in the alt buffer, to effectively
-    // hide them. We need to return a reference, so we can't just ctor an empty
-    // list here just for when we're in the alt buffer.
-    static std::vector<DispatchTypes::ScrollMark> _altBufferMarks{};
-    return _inAltBuffer() ? _altBufferMarks : _scrollMarks;
+    // hide them.
+    if (!_inAltBuffer())
+    {
+        marks.reserve(_scrollMarks.size());
+        for (const auto& mark : _scrollMarks)
+        {
+            marks.emplace_back(_ToRelativeScrollMark(mark));
+        }
+    }
+
+    return marks;
+}
+
+// Method Description:
+// - Finds the closest mark that starts above the given row.
+// Arguments:
+// - row: a row relative to the top of the buffer
+// Return Value:
+// - The last mark with a start.y less than row, if any.
+std::optional<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark> Terminal::GetScrollMarkBefore(const til::CoordType row) const
+{
+    if (_inAltBuffer())
+    {
+        return std::nullopt;
+    }
+
+    const auto absoluteRow = static_cast<int64_t>(row) + _scrollMarksOrigin;
+    const auto it = std::partition_point(_scrollMarks.begin(), _scrollMarks.end(), [&](const auto& m) {
+        return m.start.y < absoluteRow;
+    });
+    if (it == _scrollMarks.begin())
+    {
+        return std::nullopt;
+    }
+    return _ToRelativeScrollMark(*std::prev(it));
+}
+
+// Method Description:
+// - Finds the closest mark that starts below the given row.
+// Arguments:
+// - row: a row relative to the top of the buffer
+// Return Value:
+// - The first mark with a start.y greater than row, if any.
+std::optional<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark> Terminal::GetScrollMarkAfter(const til::CoordType row) const
+{
+    if (_inAltBuffer())
+    {
+        return std::nullopt;
+    }
+
+    const auto absoluteRow = static_cast<int64_t>(row) + _scrollMarksOrigin;
+    const auto it = std::partition_point(_scrollMarks.begin(), _scrollMarks.end(), [&](const auto& m) {
+        return m.start.y <= absoluteRow;
+    });
+    if (it == _scrollMarks.end())
+    {
+        return std::nullopt;
+    }
+    return _ToRelativeScrollMark(*it);
+}
+
+DispatchTypes::ScrollMark Terminal::_ToRelativeScrollMark(DispatchTypes::ScrollMark mark) const noexcept
+{
+    mark.start.y -= _scrollMarksOrigin;
+    mark.end.y -= _scrollMarksOrigin;
+    return mark;
+}
+
+// Method Description:
+// - Moves all marks up by the given number of rows, after they were pushed off
+//   the top of the buffer, and removes the ones that fell off entirely.
+void Terminal::_ShiftScrollMarks(const til::CoordType rows)
+{
+    _scrollMarksOrigin += rows;
+
+    while (!_scrollMarks.empty() && _scrollMarks.front().start.y < _scrollMarksOrigin)
+    {
+        _scrollMarks.pop_front();
+    }
+
+    // Rebase the absolute rows every once in a while, long before they could overflow.
+    // Every remaining mark starts at or below the origin, so none of them turns negative.
+    if (_scrollMarksOrigin > std::numeric_limits<til::CoordType>::max() / 2)
+    {
+        for (auto& mark : _scrollMarks)
+        {
+            mark.start.y -= _scrollMarksOrigin;
+            mark.end.y -= _scrollMarksOrigin;
+        }
+        _scrollMarksOrigin = 0;
+    }
 }
 
 til::color Terminal::GetColorForMark(const Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark& mark) const
@@ -14,13 +14,14 @@
 
 #include "../../types/inc/Viewport.hpp"
 #include "../../types/inc/GlyphWidth.hpp"
+#include "../../types/inc/LockProfiler.hpp"
 #include "../../types/IUiaData.h"
 #include "../../cascadia/terminalcore/ITerminalInput.hpp"
 
-#include <til/ticket_lock.h>
-
 static constexpr std::wstring_view linkPattern{ LR"(\b(https?|ftp|file)://[-A-Za-z0-9+&@#/%?=~_|$!:,.;]*[A-Za-z0-9+&@#/%=~_|$])" };
 static constexpr size_t TaskbarMinProgress{ 10 };
+// How long a predictive echo waits for the connection to confirm it.
+static constexpr std::chrono::milliseconds PredictionTimeout{ 1000 };
 
 // You have to forward decl the ICoreSettings here, instead of including the header.
 // If you include the header, there will be compilation errors with other
@@ -87,12 +88,18 @@ public:
     // Write comes from the PTY and goes to our parser to be stored in the output buffer
     void Write(std::wstring_view stringView);
 
+    // WritePlainText is for hosts that know their output contains no control
+    // sequences. It skips the parser and only interprets \r and \n, the
+    // latter as a carriage return and line feed.
+    void WritePlainText(std::wstring_view stringView);
+
     // WritePastedText comes from our input and goes back to the PTY's input channel
     void WritePastedText(std::wstring_view stringView);
 
-    [[nodiscard]] std::unique_lock<til::ticket_lock> LockForReading();
-    [[nodiscard]] std::unique_lock<til::ticket_lock> LockForWriting();
-    til::ticket_lock& GetReadWriteLock() noexcept;
+    [[nodiscard]] std::shared_lock<Microsoft::Console::Types::ProfiledSharedMutex> LockForReading();
+    [[nodiscard]] std::unique_lock<Microsoft::Console::Types::ProfiledSharedMutex> LockForWriting();
+    Microsoft::Console::Types::ProfiledSharedMutex& GetReadWriteLock() noexcept;
+    Microsoft::Console::Types::LockProfiler::Statistics GetLockStatistics() const noexcept;
 
     til::CoordType GetBufferHeight() const noexcept;
 
@@ -102,11 +109,15 @@ public:
     RenderSettings& GetRenderSettings() noexcept { return _renderSettings; };
     const RenderSettings& GetRenderSettings() const noexcept { return _renderSettings; };
 
-    const std::vector<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark>& GetScrollMarks() const;
+    std::vector<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark> GetScrollMarks() const;
+    std::optional<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark> GetScrollMarkBefore(til::CoordType row) const;
+    std::optional<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark> GetScrollMarkAfter(til::CoordType row) const;
     void AddMark(const Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark& mark,
                  const til::point& start,
                  const til::point& end);
 
+    bool ExpirePredictions();
+
 #pragma region ITerminalApi
     // These methods are defined in TerminalApi.cpp
     void PrintString(const std::wstring_view string) override;
@@ -175,6 +186,8 @@ public:
 
     void LockConsole() noexcept override;
     void UnlockConsole() noexcept override;
+    void LockConsoleForReading() noexcept override;
+    void UnlockConsoleForReading() noexcept override;
 #pragma endregion
 
 #pragma region IRenderData
@@ -220,8 +233,50 @@ public:
     void SetCursorOn(const bool isOn);
     bool IsCursorBlinkingAllowed() const noexcept;
 
+    const ::Microsoft::Console::VirtualTerminal::ParserStatistics& GetParserStatistics() const noexcept;
+
+    // The counters of the output written so far. Unlike the parser's they
+    // may be read without holding the lock.
+    struct WriteStatistics
+    {
+        uint64_t characters = 0;
+        // The time spent waiting for the write lock, and then writing with it held.
+        std::chrono::nanoseconds lockWait{};
+        std::chrono::nanoseconds writing{};
+    };
+    WriteStatistics GetWriteStatistics() const noexcept;
+
+    // The memory held by the buffers and the marks, in bytes. The caller must hold the read lock.
+    struct MemoryUsage
+    {
+        TextBuffer::MemoryUsage mainBuffer;
+        TextBuffer::MemoryUsage altBuffer;
+        size_t scrollMarks = 0;
+    };
+    MemoryUsage GetMemoryUsage() const noexcept;
+
+    // The buffer contents a pattern interval tree was computed from. As long as none of the
+    // visible rows changed since then, the patterns don't need to be searched again.
+    struct PatternSource
+    {
+        const TextBuffer* buffer;
+        // Held on to, so that new patterns can't be mistaken for these ones if they reuse their address.
+        std::shared_ptr<const TextBuffer::PatternRecognizers> patterns;
+        uint64_t revision;
+        int start;
+        int end;
+    };
+    struct PatternRequest
+    {
+        PatternSource source;
+        TextBuffer::PatternSnapshot snapshot;
+    };
+
     void UpdatePatternsUnderLock() noexcept;
+    std::optional<PatternRequest> SnapshotPatternsUnderLock();
+    void ApplyPatternsUnderLock(const PatternSource& source, interval_tree::IntervalTree<til::point, size_t> tree) noexcept;
     void ClearPatternTree() noexcept;
+    void InvalidatePatternIntervalUnderLock(const interval_tree::IntervalTree<til::point, size_t>::interval& interval);
 
     const std::optional<til::color> GetTabColor() const noexcept;
 
@@ -266,6 +321,7 @@ public:
     til::point SelectionEndForRendering() const;
 
     const TextBuffer::TextAndColor RetrieveSelectedTextFromBuffer(bool trimTrailingWhitespace);
+    TextBuffer::TextAndColorRuns RetrieveSelectedTextAndColorRuns(bool singleLine);
 #pragma endregion
 
 private:
@@ -280,7 +336,11 @@ private:
     //
     // But we can abuse the fact that the surrounding members rarely change and are huge
     // (std::function is like 64 bytes) to create some natural padding without wasting space.
-    til::ticket_lock _readWriteLock;
+    //
+    // The renderer, UIA and the search worker only ever read the buffer, so they take
+    // this lock shared and don't have to queue up behind each other. Only the VT output
+    // and input paths take it exclusively. _lastLocker only tracks exclusive owners.
+    Microsoft::Console::Types::ProfiledSharedMutex _readWriteLock{ "Terminal" };
 #ifndef NDEBUG
     DWORD _lastLocker;
 #endif
@@ -293,6 +353,11 @@ private:
 
     RenderSettings _renderSettings;
     std::unique_ptr<::Microsoft::Console::VirtualTerminal::StateMachine> _stateMachine;
+
+    // See GetWriteStatistics().
+    std::atomic<uint64_t> _writtenCharacters{ 0 };
+    std::atomic<int64_t> _writeLockWaitNs{ 0 };
+    std::atomic<int64_t> _writeNs{ 0 };
     std::unique_ptr<::Microsoft::Console::VirtualTerminal::TerminalInput> _terminalInput;
 
     std::optional<std::wstring> _title;
@@ -307,6 +372,7 @@ private:
     bool _bracketedPasteMode;
     bool _trimBlockSelection;
     bool _autoMarkPrompts;
+    bool _predictiveEcho;
 
     size_t _taskbarState;
     size_t _taskbarProgress;
@@ -330,6 +396,20 @@ private:
         til::point pivot;
     };
     std::optional<SelectionAnchors> _selection;
+    // The rectangles of the selection as of the last _GetSelectionRects call.
+    // The renderer asks for them on every frame, but they rarely change.
+    struct SelectionSpans
+    {
+        const TextBuffer* buffer = nullptr;
+        til::size bufferSize;
+        bool blockSelection = false;
+        til::point start;
+        til::point end;
+        uint64_t revision = 0;
+        std::vector<til::inclusive_rect> rects;
+    };
+    mutable std::mutex _selectionSpansLock;
+    mutable SelectionSpans _selectionSpans;
     bool _blockSelection;
     std::wstring _wordDelimiters;
     SelectionExpansion _multiClickSelectionMode;
@@ -348,6 +428,9 @@ private:
     // _scrollOffset is the number of lines above the viewport that are currently visible
     // If _scrollOffset is 0, then the visible region of the buffer is the viewport.
     int _scrollOffset;
+    // While Write() is processing output, scroll events are only raised once at the end.
+    bool _deferScrollEvents{ false };
+    bool _hasDeferredScrollEvent{ false };
     // TODO this might not be the value we want to store.
     // We might want to store the height in the scrollback that's currently visible.
     // Think on this some more.
@@ -362,7 +445,15 @@ private:
     //      Either way, we should make this behavior controlled by a setting.
 
     interval_tree::IntervalTree<til::point, size_t> _patternIntervalTree;
+    // The buffer contents _patternIntervalTree was computed from.
+    std::optional<PatternSource> _patternSource;
+    // Only used by UpdatePatternsUnderLock. TerminalControl keeps its own.
+    TextBuffer::PatternCache _patternCache;
     void _InvalidatePatternTree(interval_tree::IntervalTree<til::point, size_t>& tree);
+    void _InvalidatePatternTreeChanges(const interval_tree::IntervalTree<til::point, size_t>& oldTree,
+                                       const til::CoordType oldTop,
+                                       const interval_tree::IntervalTree<til::point, size_t>& newTree,
+                                       const til::CoordType newTop);
     void _InvalidateFromCoords(const til::point start, const til::point end);
 
     // Since virtual keys are non-zero, you assume that this field is empty/invalid if it is.
@@ -373,7 +464,34 @@ private:
     };
     std::optional<KeyEventCodes> _lastKeyEventCodes;
 
-    std::vector<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark> _scrollMarks;
+    // The marks are sorted by their start and stored with absolute row numbers:
+    // The row in the buffer plus _scrollMarksOrigin, which counts the rows that
+    // were pushed off the top of the buffer. That way circling the buffer only
+    // needs to bump the origin and pop the marks that fell off from the front.
+    std::deque<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark> _scrollMarks;
+    til::CoordType _scrollMarksOrigin{ 0 };
+
+    Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark _ToRelativeScrollMark(Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark mark) const noexcept;
+    void _ShiftScrollMarks(til::CoordType rows);
+
+    // Predictive local echo: Printable characters are drawn into a one row
+    // overlay at the cursor as they're typed, and removed again once the
+    // output of the connection confirmed or contradicted them.
+    // _predictionOrigin is the position in the active buffer of the first
+    // unconfirmed prediction, which is _predictedText.front().
+    std::unique_ptr<TextBuffer> _predictionBuffer;
+    std::wstring _predictedText;
+    til::point _predictionOrigin;
+    std::chrono::steady_clock::time_point _predictionDeadline;
+    // Predictions are only shown after the connection echoed one of them.
+    // This keeps them hidden at password prompts and in raw mode applications.
+    bool _predictionsConfirmed{ false };
+
+    void _PredictCharacter(const wchar_t ch, const ControlKeyStates states);
+    void _ReconcilePredictions();
+    void _ClearPredictions();
+    void _TriggerPredictionRedraw() const;
+    bool _HasVisiblePredictions() const noexcept;
 
     static WORD _ScanCodeFromVirtualKey(const WORD vkey) noexcept;
     static WORD _VirtualKeyFromScanCode(const WORD scanCode) noexcept;
@@ -389,6 +507,8 @@ private:
     Microsoft::Console::Types::Viewport _GetMutableViewport() const noexcept;
     Microsoft::Console::Types::Viewport _GetVisibleViewport() const noexcept;
 
+    template<typename Func>
+    void _WriteOutput(const size_t length, Func&& write);
     void _WriteBuffer(const std::wstring_view& stringView);
 
     void _AdjustCursorPosition(const til::point proposedPosition);
@@ -404,6 +524,7 @@ private:
 #pragma region TextSelection
     // These methods are defined in TerminalSelection.cpp
     std::vector<til::inclusive_rect> _GetSelectionRects() const noexcept;
+    void _UpdateSelectionSpans(const TextBuffer& buffer, const til::point start, const til::point end) const;
     std::pair<til::point, til::point> _PivotSelection(const til::point targetPos, bool& targetStart) const;
     std::pair<til::point, til::point> _ExpandSelectionAnchors(std::pair<til::point, til::point> anchors) const;
     til::point _ConvertToBufferCell(const til::point viewportPos) const;
@@ -202,6 +202,7 @@ void Terminal::UseAlternateScreenBuffer()
 
     ClearSelection();
     _mainBuffer->ClearPatternRecognizers();
+    _patternSource.reset();
 
     // Create a new alt buffer
     _altBuffer = std::make_unique<TextBuffer>(_altBufferSize,
@@ -272,6 +273,7 @@ void Terminal::UseMainScreenBuffer()
     _mainBuffer->SetAsActiveBuffer(true);
     // destroy the alt buffer
     _altBuffer = nullptr;
+    _patternSource.reset();
 
     if (_deferredResize.has_value())
     {
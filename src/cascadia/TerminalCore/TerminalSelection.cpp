@@ -41,6 +41,8 @@ using namespace Microsoft::Terminal::Core;
 
 // Method Description:
 // - Helper to determine the selected region of the buffer. Used for rendering.
+// - The rectangles are kept in _selectionSpans and only recomputed if the
+//   selection or the selected rows changed since the last call.
 // Return Value:
 // - A vector of rectangles representing the regions to select, line by line. They are absolute coordinates relative to the buffer origin.
 std::vector<til::inclusive_rect> Terminal::_GetSelectionRects() const noexcept
@@ -54,12 +56,70 @@ std::vector<til::inclusive_rect> Terminal::_GetSelectionRects() const noexcept
 
     try
     {
-        return _activeBuffer().GetTextRects(_selection->start, _selection->end, _blockSelection, false);
+        const auto& buffer = _activeBuffer();
+        const auto [start, end] = buffer.GetSize().CompareInBounds(_selection->start, _selection->end) <= 0 ?
+                                      std::make_pair(_selection->start, _selection->end) :
+                                      std::make_pair(_selection->end, _selection->start);
+
+        // The renderer and the clipboard read the selection concurrently, while holding the read lock.
+        const std::lock_guard guard{ _selectionSpansLock };
+        _UpdateSelectionSpans(buffer, start, end);
+        return _selectionSpans.rects;
     }
     CATCH_LOG();
     return result;
 }
 
+// Method Description:
+// - Brings _selectionSpans up to date with the current selection.
+// - For a regular (non-block) selection, all rows but the first and the last
+//   one are selected entirely. When the selection is dragged, the rows that
+//   are between the first and last rows of both the old and the new selection
+//   stay the same and only the rows around them are recomputed.
+// - INVARIANT: _selectionSpansLock must be held
+// Arguments:
+// - buffer - The active buffer
+// - start - The start of the selection. It must not be after end.
+// - end - The end of the selection
+void Terminal::_UpdateSelectionSpans(const TextBuffer& buffer, const til::point start, const til::point end) const
+{
+    auto& spans = _selectionSpans;
+    const auto bufferSize = buffer.GetSize();
+    const auto sameBuffer = spans.buffer == &buffer &&
+                            spans.bufferSize == bufferSize.Dimensions() &&
+                            spans.blockSelection == _blockSelection &&
+                            !spans.rects.empty();
+
+    if (sameBuffer && spans.start == start && spans.end == end && !buffer.HasChangedSince(spans.revision, start.Y, end.Y))
+    {
+        return;
+    }
+
+    const auto reuseBegin = std::max(spans.start.Y, start.Y) + 1;
+    const auto reuseEnd = std::min(spans.end.Y, end.Y) - 1;
+    if (sameBuffer && !_blockSelection && reuseBegin <= reuseEnd && !buffer.HasChangedSince(spans.revision, reuseBegin, reuseEnd))
+    {
+        const auto reused = spans.rects.begin() + (reuseBegin - spans.start.Y);
+        auto rects = buffer.GetTextRects(start, { bufferSize.RightInclusive(), reuseBegin - 1 }, false, false);
+        rects.reserve(gsl::narrow_cast<size_t>(end.Y - start.Y + 1));
+        rects.insert(rects.end(), reused, reused + (reuseEnd - reuseBegin + 1));
+        const auto bottom = buffer.GetTextRects({ bufferSize.Left(), reuseEnd + 1 }, end, false, false);
+        rects.insert(rects.end(), bottom.begin(), bottom.end());
+        spans.rects = std::move(rects);
+    }
+    else
+    {
+        spans.rects = buffer.GetTextRects(start, end, _blockSelection, false);
+    }
+
+    spans.buffer = &buffer;
+    spans.bufferSize = bufferSize.Dimensions();
+    spans.blockSelection = _blockSelection;
+    spans.start = start;
+    spans.end = end;
+    spans.revision = buffer.GetRevision();
+}
+
 // Method Description:
 // - Get the current anchor position relative to the whole text buffer
 // Arguments:
@@ -608,6 +668,30 @@ const TextBuffer::TextAndColor Terminal::RetrieveSelectedTextFromBuffer(bool sin
     return _activeBuffer().GetText(includeCRLF, trimTrailingWhitespace, selectionRects, GetAttributeColors, formatWrappedRows);
 }
 
+// Method Description:
+// - Same as RetrieveSelectedTextFromBuffer, but returns the text as a single
+//   string with runs of identical colors, which is a lot cheaper for large
+//   selections and what GenHTML and GenRTF iterate over anyways.
+// Arguments:
+// - singleLine: collapse all of the text to one line
+// Return Value:
+// - the text and colors from the buffer. If extended to multiple lines, each line is separated by \r\n
+TextBuffer::TextAndColorRuns Terminal::RetrieveSelectedTextAndColorRuns(bool singleLine)
+{
+    auto lock = LockForReading();
+
+    const auto selectionRects = _GetSelectionRects();
+
+    const auto GetAttributeColors = [&](const auto& attr) {
+        return _renderSettings.GetAttributeColors(attr);
+    };
+
+    const auto includeCRLF = !singleLine || _blockSelection;
+    const auto trimTrailingWhitespace = !singleLine && (!_blockSelection || _trimBlockSelection);
+    const auto formatWrappedRows = _blockSelection;
+    return _activeBuffer().GetTextAndColorRuns(includeCRLF, trimTrailingWhitespace, selectionRects, GetAttributeColors, formatWrappedRows);
+}
+
 // Method Description:
 // - convert viewport position to the corresponding location on the buffer
 // Arguments:
@@ -39,6 +39,13 @@ void Terminal::SetFontInfo(const FontInfo& fontInfo)
 
 til::point Terminal::GetCursorPosition() const noexcept
 {
+    // The cursor is drawn after the predicted characters (if any).
+    if (_HasVisiblePredictions())
+    {
+        const auto x = _predictionOrigin.x + gsl::narrow_cast<til::CoordType>(_predictedText.size());
+        return { std::min(x, _activeBuffer().GetSize().RightInclusive()), _predictionOrigin.y };
+    }
+
     const auto& cursor = _activeBuffer().GetCursor();
     return cursor.GetPosition();
 }
@@ -78,7 +85,22 @@ bool Terminal::IsCursorDoubleWidth() const
 }
 
 const std::vector<RenderOverlay> Terminal::GetOverlays() const noexcept
+try
+{
+    if (!_HasVisiblePredictions())
+    {
+        return {};
+    }
+
+    // The overlay's buffer is a single row and the predictions are at
+    // the same columns in it as they are supposed to be in the viewport.
+    const til::point origin{ 0, _predictionOrigin.y - _VisibleStartIndex() };
+    const auto region = Viewport::FromDimensions({ _predictionOrigin.x, 0 }, { gsl::narrow_cast<til::CoordType>(_predictedText.size()), 1 });
+    return { RenderOverlay{ *_predictionBuffer, origin, region } };
+}
+catch (...)
 {
+    LOG_CAUGHT_EXCEPTION();
     return {};
 }
 
@@ -205,9 +227,10 @@ catch (...)
 //      operation.
 //   Callers should make sure to also call Terminal::UnlockConsole once
 //      they're done with any querying they need to do.
-void Terminal::LockConsole() noexcept
+// - The renderer declares its thread as such. Everyone else calling this is UIA.
+__declspec(noinline) void Terminal::LockConsole() noexcept
 {
-    _readWriteLock.lock();
+    _readWriteLock.lock(_ReturnAddress(), LockAcquirer::Uia);
 #ifndef NDEBUG
     _lastLocker = GetCurrentThreadId();
 #endif
@@ -220,6 +243,23 @@ void Terminal::UnlockConsole() noexcept
     _readWriteLock.unlock();
 }
 
+// Method Description:
+// - Lock the terminal for reading only. Unlike LockConsole, this doesn't
+//      block other readers like the renderer or UIA, only writers.
+//   Callers must not modify the terminal while holding this lock and should
+//      make sure to call Terminal::UnlockConsoleForReading once they're done.
+__declspec(noinline) void Terminal::LockConsoleForReading() noexcept
+{
+    _readWriteLock.lock_shared(_ReturnAddress(), LockAcquirer::Uia);
+}
+
+// Method Description:
+// - Unlocks the terminal after a call to Terminal::LockConsoleForReading.
+void Terminal::UnlockConsoleForReading() noexcept
+{
+    _readWriteLock.unlock_shared();
+}
+
 const bool Terminal::IsUiaDataInitialized() const noexcept
 {
     // GH#11135: Windows Terminal needs to create and return an automation peer
@@ -218,10 +218,13 @@ namespace winrt::Microsoft::Terminal::Settings::Editor::implementation
         if (Appearance())
         {
             const auto& colorSchemeMap{ Appearance().Schemes() };
+            std::vector<ColorScheme> schemes;
+            schemes.reserve(colorSchemeMap.Size());
             for (const auto& pair : colorSchemeMap)
             {
-                _ColorSchemeList.Append(pair.Value());
+                schemes.emplace_back(pair.Value());
             }
+            _ColorSchemeList.ReplaceAll(schemes);
 
             const auto& biAlignmentVal{ static_cast<int32_t>(Appearance().BackgroundImageAlignment()) };
             for (const auto& biButton : _BIAlignmentButtons)
@@ -206,11 +206,16 @@ namespace winrt::Microsoft::Terminal::Settings::Editor::implementation
     {
         // Surprisingly, though this is called every time we navigate to the page,
         // the list does not keep growing on each navigation.
+        // ReplaceAll() raises a single change notification for the whole list, instead
+        // of one per scheme that the ComboBox would otherwise react to one by one.
         const auto& colorSchemeMap{ _State.Settings().GlobalSettings().ColorSchemes() };
+        std::vector<Model::ColorScheme> schemes;
+        schemes.reserve(colorSchemeMap.Size());
         for (const auto& pair : colorSchemeMap)
         {
-            _ColorSchemeList.Append(pair.Value());
+            schemes.emplace_back(pair.Value());
         }
+        _ColorSchemeList.ReplaceAll(schemes);
     }
 
     // Function Description:
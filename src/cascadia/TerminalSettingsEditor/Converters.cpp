@@ -14,7 +14,25 @@ namespace winrt::Microsoft::Terminal::Settings::Editor::implementation
 
     winrt::Windows::UI::Xaml::Media::SolidColorBrush Converters::ColorToBrush(winrt::Windows::UI::Color color)
     {
-        return Windows::UI::Xaml::Media::SolidColorBrush(color);
+        // Every color scheme shown by the color schemes page creates 20 of these brushes, and
+        // again every time it's selected. Brushes may be shared between elements, so we hand
+        // out the same one for the same color. Brushes belong to the thread that created
+        // them, hence the cache is per thread. It's bounded, in case someone drags a color
+        // picker around for a long time.
+        static constexpr size_t maxCachedBrushes{ 1024 };
+        thread_local std::unordered_map<uint32_t, Windows::UI::Xaml::Media::SolidColorBrush> brushes;
+
+        const auto key{ til::color{ color }.abgr };
+        if (const auto it{ brushes.find(key) }; it != brushes.end())
+        {
+            return it->second;
+        }
+
+        if (brushes.size() >= maxCachedBrushes)
+        {
+            brushes.clear();
+        }
+        return brushes.emplace(key, Windows::UI::Xaml::Media::SolidColorBrush(color)).first->second;
     }
 
     winrt::Windows::UI::Text::FontWeight Converters::DoubleToFontWeight(double value)
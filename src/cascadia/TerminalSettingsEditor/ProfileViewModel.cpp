@@ -23,6 +23,7 @@ namespace winrt::Microsoft::Terminal::Settings::Editor::implementation
 {
     Windows::Foundation::Collections::IObservableVector<Editor::Font> ProfileViewModel::_MonospaceFontList{ nullptr };
     Windows::Foundation::Collections::IObservableVector<Editor::Font> ProfileViewModel::_FontList{ nullptr };
+    std::optional<ProfileViewModel::EnumSettings> ProfileViewModel::_EnumSettings;
 
     ProfileViewModel::ProfileViewModel(const Model::Profile& profile, const Model::CascadiaSettings& appSettings) :
         _profile{ profile },
@@ -31,9 +32,25 @@ namespace winrt::Microsoft::Terminal::Settings::Editor::implementation
         _appSettings{ appSettings },
         _unfocusedAppearanceViewModel{ nullptr }
     {
-        INITIALIZE_BINDABLE_ENUM_SETTING(AntiAliasingMode, TextAntialiasingMode, winrt::Microsoft::Terminal::Control::TextAntialiasingMode, L"Profile_AntialiasingMode", L"Content");
-        INITIALIZE_BINDABLE_ENUM_SETTING_REVERSE_ORDER(CloseOnExitMode, CloseOnExitMode, winrt::Microsoft::Terminal::Settings::Model::CloseOnExitMode, L"Profile_CloseOnExit", L"Content");
-        INITIALIZE_BINDABLE_ENUM_SETTING(ScrollState, ScrollbarState, winrt::Microsoft::Terminal::Control::ScrollbarState, L"Profile_ScrollbarVisibility", L"Content");
+        // Every profile offers the same choices, so only the first profile looks up
+        // their localized names. All the others (and there can be a lot of generated
+        // ones) share its entries, which are never modified.
+        if (_EnumSettings)
+        {
+            _AntiAliasingModeList = _EnumSettings->AntiAliasingModeList;
+            _AntiAliasingModeMap = _EnumSettings->AntiAliasingModeMap;
+            _CloseOnExitModeList = _EnumSettings->CloseOnExitModeList;
+            _CloseOnExitModeMap = _EnumSettings->CloseOnExitModeMap;
+            _ScrollStateList = _EnumSettings->ScrollStateList;
+            _ScrollStateMap = _EnumSettings->ScrollStateMap;
+        }
+        else
+        {
+            INITIALIZE_BINDABLE_ENUM_SETTING(AntiAliasingMode, TextAntialiasingMode, winrt::Microsoft::Terminal::Control::TextAntialiasingMode, L"Profile_AntialiasingMode", L"Content");
+            INITIALIZE_BINDABLE_ENUM_SETTING_REVERSE_ORDER(CloseOnExitMode, CloseOnExitMode, winrt::Microsoft::Terminal::Settings::Model::CloseOnExitMode, L"Profile_CloseOnExit", L"Content");
+            INITIALIZE_BINDABLE_ENUM_SETTING(ScrollState, ScrollbarState, winrt::Microsoft::Terminal::Control::ScrollbarState, L"Profile_ScrollbarVisibility", L"Content");
+            _EnumSettings = EnumSettings{ _AntiAliasingModeList, _AntiAliasingModeMap, _CloseOnExitModeList, _CloseOnExitModeMap, _ScrollStateList, _ScrollStateMap };
+        }
 
         // Add a property changed handler to our own property changed event.
         // This propagates changes from the settings model to anybody listening to our
@@ -125,6 +125,17 @@ namespace winrt::Microsoft::Terminal::Settings::Editor::implementation
         static Windows::Foundation::Collections::IObservableVector<Editor::Font> _MonospaceFontList;
         static Windows::Foundation::Collections::IObservableVector<Editor::Font> _FontList;
 
+        struct EnumSettings
+        {
+            Windows::Foundation::Collections::IObservableVector<Editor::EnumEntry> AntiAliasingModeList;
+            Windows::Foundation::Collections::IMap<Microsoft::Terminal::Control::TextAntialiasingMode, Editor::EnumEntry> AntiAliasingModeMap;
+            Windows::Foundation::Collections::IObservableVector<Editor::EnumEntry> CloseOnExitModeList;
+            Windows::Foundation::Collections::IMap<Microsoft::Terminal::Settings::Model::CloseOnExitMode, Editor::EnumEntry> CloseOnExitModeMap;
+            Windows::Foundation::Collections::IObservableVector<Editor::EnumEntry> ScrollStateList;
+            Windows::Foundation::Collections::IMap<Microsoft::Terminal::Control::ScrollbarState, Editor::EnumEntry> ScrollStateMap;
+        };
+        static std::optional<EnumSettings> _EnumSettings;
+
         static Editor::Font _GetFont(com_ptr<IDWriteLocalizedStrings> localizedFamilyNames);
 
         Model::CascadiaSettings _appSettings;
@@ -43,6 +43,7 @@
 #include "ClearBufferArgs.g.cpp"
 #include "MultipleActionsArgs.g.cpp"
 #include "AdjustOpacityArgs.g.cpp"
+#include "ReplaySessionArgs.g.cpp"
 
 #include <LibraryResources.h>
 #include <WtExeUtils.h>
@@ -786,6 +787,15 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         }
     }
 
+    winrt::hstring ReplaySessionArgs::GenerateName() const
+    {
+        // "Replay session {path}"
+        return winrt::hstring{
+            fmt::format(std::wstring_view(RS_(L"ReplaySessionCommandKey")),
+                        Path())
+        };
+    }
+
     winrt::hstring ClearBufferArgs::GenerateName() const
     {
         // "Clear Buffer"
@@ -45,6 +45,7 @@
 #include "ClearBufferArgs.g.h"
 #include "MultipleActionsArgs.g.h"
 #include "AdjustOpacityArgs.g.h"
+#include "ReplaySessionArgs.g.h"
 
 #include "JsonUtils.h"
 #include "HashUtils.h"
@@ -226,6 +227,11 @@ private:
 #define EXPORT_BUFFER_ARGS(X) \
     X(winrt::hstring, Path, "path", false, L"")
 
+////////////////////////////////////////////////////////////////////////////////
+#define REPLAY_SESSION_ARGS(X)                                 \
+    X(winrt::hstring, Path, "path", args->Path().empty(), L"") \
+    X(bool, RealTime, "realTime", false, true)
+
 ////////////////////////////////////////////////////////////////////////////////
 #define CLEAR_BUFFER_ARGS(X) \
     X(winrt::Microsoft::Terminal::Control::ClearBufferType, Clear, "clear", false, winrt::Microsoft::Terminal::Control::ClearBufferType::All)
@@ -658,6 +664,8 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
 
     ACTION_ARGS_STRUCT(ExportBufferArgs, EXPORT_BUFFER_ARGS);
 
+    ACTION_ARGS_STRUCT(ReplaySessionArgs, REPLAY_SESSION_ARGS);
+
     ACTION_ARGS_STRUCT(ClearBufferArgs, CLEAR_BUFFER_ARGS);
 
     struct MultipleActionsArgs : public MultipleActionsArgsT<MultipleActionsArgs>
@@ -747,4 +755,5 @@ namespace winrt::Microsoft::Terminal::Settings::Model::factory_implementation
     BASIC_FACTORY(ClearBufferArgs);
     BASIC_FACTORY(MultipleActionsArgs);
     BASIC_FACTORY(AdjustOpacityArgs);
+    BASIC_FACTORY(ReplaySessionArgs);
 }
@@ -23,79 +23,84 @@
 // each action. This is _NOT_ something that should be used when any individual
 // case should be customized.
 
-#define ALL_SHORTCUT_ACTIONS               \
-    ON_ALL_ACTIONS(CopyText)               \
-    ON_ALL_ACTIONS(PasteText)              \
-    ON_ALL_ACTIONS(OpenNewTabDropdown)     \
-    ON_ALL_ACTIONS(DuplicateTab)           \
-    ON_ALL_ACTIONS(NewTab)                 \
-    ON_ALL_ACTIONS(CloseWindow)            \
-    ON_ALL_ACTIONS(CloseTab)               \
-    ON_ALL_ACTIONS(ClosePane)              \
-    ON_ALL_ACTIONS(NextTab)                \
-    ON_ALL_ACTIONS(PrevTab)                \
-    ON_ALL_ACTIONS(SendInput)              \
-    ON_ALL_ACTIONS(SplitPane)              \
-    ON_ALL_ACTIONS(ToggleSplitOrientation) \
-    ON_ALL_ACTIONS(TogglePaneZoom)         \
-    ON_ALL_ACTIONS(SwitchToTab)            \
-    ON_ALL_ACTIONS(AdjustFontSize)         \
-    ON_ALL_ACTIONS(ResetFontSize)          \
-    ON_ALL_ACTIONS(ScrollUp)               \
-    ON_ALL_ACTIONS(ScrollDown)             \
-    ON_ALL_ACTIONS(ScrollUpPage)           \
-    ON_ALL_ACTIONS(ScrollDownPage)         \
-    ON_ALL_ACTIONS(ScrollToTop)            \
-    ON_ALL_ACTIONS(ScrollToBottom)         \
-    ON_ALL_ACTIONS(ScrollToMark)           \
-    ON_ALL_ACTIONS(AddMark)                \
-    ON_ALL_ACTIONS(ClearMark)              \
-    ON_ALL_ACTIONS(ClearAllMarks)          \
-    ON_ALL_ACTIONS(ResizePane)             \
-    ON_ALL_ACTIONS(MoveFocus)              \
-    ON_ALL_ACTIONS(MovePane)               \
-    ON_ALL_ACTIONS(SwapPane)               \
-    ON_ALL_ACTIONS(Find)                   \
-    ON_ALL_ACTIONS(ToggleShaderEffects)    \
-    ON_ALL_ACTIONS(ToggleFocusMode)        \
-    ON_ALL_ACTIONS(ToggleFullscreen)       \
-    ON_ALL_ACTIONS(ToggleAlwaysOnTop)      \
-    ON_ALL_ACTIONS(OpenSettings)           \
-    ON_ALL_ACTIONS(SetFocusMode)           \
-    ON_ALL_ACTIONS(SetFullScreen)          \
-    ON_ALL_ACTIONS(SetMaximized)           \
-    ON_ALL_ACTIONS(SetColorScheme)         \
-    ON_ALL_ACTIONS(SetTabColor)            \
-    ON_ALL_ACTIONS(OpenTabColorPicker)     \
-    ON_ALL_ACTIONS(RenameTab)              \
-    ON_ALL_ACTIONS(OpenTabRenamer)         \
-    ON_ALL_ACTIONS(ExecuteCommandline)     \
-    ON_ALL_ACTIONS(ToggleCommandPalette)   \
-    ON_ALL_ACTIONS(CloseOtherTabs)         \
-    ON_ALL_ACTIONS(CloseTabsAfter)         \
-    ON_ALL_ACTIONS(TabSearch)              \
-    ON_ALL_ACTIONS(MoveTab)                \
-    ON_ALL_ACTIONS(BreakIntoDebugger)      \
-    ON_ALL_ACTIONS(TogglePaneReadOnly)     \
-    ON_ALL_ACTIONS(FindMatch)              \
-    ON_ALL_ACTIONS(NewWindow)              \
-    ON_ALL_ACTIONS(IdentifyWindow)         \
-    ON_ALL_ACTIONS(IdentifyWindows)        \
-    ON_ALL_ACTIONS(RenameWindow)           \
-    ON_ALL_ACTIONS(OpenWindowRenamer)      \
-    ON_ALL_ACTIONS(GlobalSummon)           \
-    ON_ALL_ACTIONS(QuakeMode)              \
-    ON_ALL_ACTIONS(FocusPane)              \
-    ON_ALL_ACTIONS(OpenSystemMenu)         \
-    ON_ALL_ACTIONS(ExportBuffer)           \
-    ON_ALL_ACTIONS(ClearBuffer)            \
-    ON_ALL_ACTIONS(MultipleActions)        \
-    ON_ALL_ACTIONS(Quit)                   \
-    ON_ALL_ACTIONS(AdjustOpacity)          \
-    ON_ALL_ACTIONS(RestoreLastClosed)      \
-    ON_ALL_ACTIONS(SelectAll)              \
-    ON_ALL_ACTIONS(MarkMode)               \
-    ON_ALL_ACTIONS(ToggleBlockSelection)
+#define ALL_SHORTCUT_ACTIONS                 \
+    ON_ALL_ACTIONS(CopyText)                 \
+    ON_ALL_ACTIONS(PasteText)                \
+    ON_ALL_ACTIONS(OpenNewTabDropdown)       \
+    ON_ALL_ACTIONS(DuplicateTab)             \
+    ON_ALL_ACTIONS(NewTab)                   \
+    ON_ALL_ACTIONS(CloseWindow)              \
+    ON_ALL_ACTIONS(CloseTab)                 \
+    ON_ALL_ACTIONS(ClosePane)                \
+    ON_ALL_ACTIONS(NextTab)                  \
+    ON_ALL_ACTIONS(PrevTab)                  \
+    ON_ALL_ACTIONS(SendInput)                \
+    ON_ALL_ACTIONS(SplitPane)                \
+    ON_ALL_ACTIONS(ToggleSplitOrientation)   \
+    ON_ALL_ACTIONS(TogglePaneZoom)           \
+    ON_ALL_ACTIONS(SwitchToTab)              \
+    ON_ALL_ACTIONS(AdjustFontSize)           \
+    ON_ALL_ACTIONS(ResetFontSize)            \
+    ON_ALL_ACTIONS(ScrollUp)                 \
+    ON_ALL_ACTIONS(ScrollDown)               \
+    ON_ALL_ACTIONS(ScrollUpPage)             \
+    ON_ALL_ACTIONS(ScrollDownPage)           \
+    ON_ALL_ACTIONS(ScrollToTop)              \
+    ON_ALL_ACTIONS(ScrollToBottom)           \
+    ON_ALL_ACTIONS(ScrollToMark)             \
+    ON_ALL_ACTIONS(AddMark)                  \
+    ON_ALL_ACTIONS(ClearMark)                \
+    ON_ALL_ACTIONS(ClearAllMarks)            \
+    ON_ALL_ACTIONS(ResizePane)               \
+    ON_ALL_ACTIONS(MoveFocus)                \
+    ON_ALL_ACTIONS(MovePane)                 \
+    ON_ALL_ACTIONS(SwapPane)                 \
+    ON_ALL_ACTIONS(Find)                     \
+    ON_ALL_ACTIONS(ToggleShaderEffects)      \
+    ON_ALL_ACTIONS(ToggleParserStatistics)   \
+    ON_ALL_ACTIONS(TogglePerformanceOverlay) \
+    ON_ALL_ACTIONS(ReportMemoryUsage)        \
+    ON_ALL_ACTIONS(ToggleFocusMode)          \
+    ON_ALL_ACTIONS(ToggleFullscreen)         \
+    ON_ALL_ACTIONS(ToggleAlwaysOnTop)        \
+    ON_ALL_ACTIONS(OpenSettings)             \
+    ON_ALL_ACTIONS(SetFocusMode)             \
+    ON_ALL_ACTIONS(SetFullScreen)            \
+    ON_ALL_ACTIONS(SetMaximized)             \
+    ON_ALL_ACTIONS(SetColorScheme)           \
+    ON_ALL_ACTIONS(SetTabColor)              \
+    ON_ALL_ACTIONS(OpenTabColorPicker)       \
+    ON_ALL_ACTIONS(RenameTab)                \
+    ON_ALL_ACTIONS(OpenTabRenamer)           \
+    ON_ALL_ACTIONS(ExecuteCommandline)       \
+    ON_ALL_ACTIONS(ToggleCommandPalette)     \
+    ON_ALL_ACTIONS(CloseOtherTabs)           \
+    ON_ALL_ACTIONS(CloseTabsAfter)           \
+    ON_ALL_ACTIONS(TabSearch)                \
+    ON_ALL_ACTIONS(MoveTab)                  \
+    ON_ALL_ACTIONS(BreakIntoDebugger)        \
+    ON_ALL_ACTIONS(TogglePaneReadOnly)       \
+    ON_ALL_ACTIONS(ToggleBroadcastInput)     \
+    ON_ALL_ACTIONS(FindMatch)                \
+    ON_ALL_ACTIONS(NewWindow)                \
+    ON_ALL_ACTIONS(IdentifyWindow)           \
+    ON_ALL_ACTIONS(IdentifyWindows)          \
+    ON_ALL_ACTIONS(RenameWindow)             \
+    ON_ALL_ACTIONS(OpenWindowRenamer)        \
+    ON_ALL_ACTIONS(GlobalSummon)             \
+    ON_ALL_ACTIONS(QuakeMode)                \
+    ON_ALL_ACTIONS(FocusPane)                \
+    ON_ALL_ACTIONS(OpenSystemMenu)           \
+    ON_ALL_ACTIONS(ExportBuffer)             \
+    ON_ALL_ACTIONS(ClearBuffer)              \
+    ON_ALL_ACTIONS(MultipleActions)          \
+    ON_ALL_ACTIONS(Quit)                     \
+    ON_ALL_ACTIONS(AdjustOpacity)            \
+    ON_ALL_ACTIONS(RestoreLastClosed)        \
+    ON_ALL_ACTIONS(SelectAll)                \
+    ON_ALL_ACTIONS(MarkMode)                 \
+    ON_ALL_ACTIONS(ToggleBlockSelection)     \
+    ON_ALL_ACTIONS(ReplaySession)
 
 #define ALL_SHORTCUT_ACTIONS_WITH_ARGS             \
     ON_ALL_ACTIONS_WITH_ARGS(AdjustFontSize)       \
@@ -135,4 +140,5 @@
     ON_ALL_ACTIONS_WITH_ARGS(ExportBuffer)         \
     ON_ALL_ACTIONS_WITH_ARGS(ClearBuffer)          \
     ON_ALL_ACTIONS_WITH_ARGS(MultipleActions)      \
-    ON_ALL_ACTIONS_WITH_ARGS(AdjustOpacity)
+    ON_ALL_ACTIONS_WITH_ARGS(AdjustOpacity)        \
+    ON_ALL_ACTIONS_WITH_ARGS(ReplaySession)
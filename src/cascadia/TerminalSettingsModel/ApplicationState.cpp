@@ -150,6 +150,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         LOG_LAST_ERROR_IF(!DeleteFile(_sharedPath.c_str()));
         LOG_LAST_ERROR_IF(!DeleteFile(_elevatedPath.c_str()));
         *_state.lock() = {};
+        *_persisted.lock() = {};
     }
     CATCH_LOG()
 
@@ -165,6 +166,22 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
 
         // First get shared state out of `state.json`.
         const auto sharedData = _readSharedContents().value_or(std::string{});
+
+        const auto elevatedData = ::Microsoft::Console::Utils::IsElevated() ? _readLocalContents().value_or(std::string{}) : std::string{};
+
+        // If the files still contain what we last read or wrote, our state is
+        // at least as recent as theirs. This is usually the case when the
+        // file watcher notifies us about our own writes.
+        {
+            auto persisted = _persisted.lock();
+            if (!sharedData.empty() && persisted->shared == sharedData && persisted->elevated == elevatedData)
+            {
+                return;
+            }
+            persisted->shared = sharedData;
+            persisted->elevated = elevatedData;
+        }
+
         if (!sharedData.empty())
         {
             Json::Value root;
@@ -183,10 +200,10 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
                 FromJson(root, FileSource::Shared);
 
                 // Then, try and get anything in elevated-state
-                if (const auto localData{ _readLocalContents().value_or(std::string{}) }; !localData.empty())
+                if (!elevatedData.empty())
                 {
                     Json::Value root;
-                    if (!reader->parse(localData.data(), localData.data() + localData.size(), &root, &errs))
+                    if (!reader->parse(elevatedData.data(), elevatedData.data() + elevatedData.size(), &root, &errs))
                     {
                         throw winrt::hresult_error(WEB_E_INVALID_JSON_STRING, winrt::to_hstring(errs));
                     }
@@ -364,7 +381,13 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
     //   `state.json`
     void ApplicationState::_writeSharedContents(const std::string_view content) const
     {
+        if (_persisted.lock_shared()->shared == content)
+        {
+            return;
+        }
+
         WriteUTF8FileAtomic(_sharedPath, content);
+        _persisted.lock()->shared = content;
     }
 
     // Method Description:
@@ -385,11 +408,17 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
             // We're not worried about someone else doing that though, if they do
             // that with the wrong permissions, then we'll just ignore the file and
             // start over.
+            if (_persisted.lock_shared()->elevated == content)
+            {
+                return;
+            }
+
             WriteUTF8File(_elevatedPath, content, true);
+            _persisted.lock()->elevated = content;
         }
         else
         {
-            WriteUTF8FileAtomic(_sharedPath, content);
+            _writeSharedContents(content);
         }
     }
 
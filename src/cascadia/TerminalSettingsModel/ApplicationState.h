@@ -86,6 +86,15 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
 #undef MTSM_APPLICATION_STATE_GEN
         };
         til::shared_mutex<state_t> _state;
+        // The contents of state.json and elevated-state.json, as we last read or wrote them.
+        // Persisting state that didn't change, or reloading a file we just wrote ourselves,
+        // is skipped by comparing against these. Writes can be slow on redirected profile folders.
+        struct persisted_t
+        {
+            std::string shared;
+            std::string elevated;
+        };
+        til::shared_mutex<persisted_t> _persisted;
         std::filesystem::path _sharedPath;
         std::filesystem::path _elevatedPath;
         til::throttled_func_trailing<> _throttler;
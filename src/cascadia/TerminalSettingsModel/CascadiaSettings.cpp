@@ -113,6 +113,8 @@ Model::CascadiaSettings CascadiaSettings::Copy() const
     // defterm
     settings->_currentDefaultTerminal = _currentDefaultTerminal;
 
+    settings->_hash = _hash;
+
     return *settings;
 }
 
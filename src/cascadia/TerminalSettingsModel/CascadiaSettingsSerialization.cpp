@@ -6,7 +6,9 @@
 
 #include <LibraryResources.h>
 #include <fmt/chrono.h>
+#include <future>
 #include <shlobj.h>
+#include <til/hash.h>
 #include <til/latch.h>
 
 #include "AzureCloudShellGenerator.h"
@@ -136,12 +138,41 @@ SettingsLoader::SettingsLoader(const std::string_view& userJSON, const std::stri
 
 // Generate dynamic profiles and add them to the list of "inbox" profiles
 // (meaning profiles specified by the application rather by the user).
+// The generators are independent of each other and spend most of their time waiting
+// for the registry, the file system, wsl.exe or the VS setup COM server.
+// They're thus run concurrently, but their profiles are still added in a fixed order.
 void SettingsLoader::GenerateProfiles()
 {
-    _executeGenerator(PowershellCoreProfileGenerator{});
-    _executeGenerator(WslDistroGenerator{});
-    _executeGenerator(AzureCloudShellGenerator{});
-    _executeGenerator(VisualStudioGenerator{});
+    const PowershellCoreProfileGenerator powershellCoreGenerator;
+    const WslDistroGenerator wslDistroGenerator;
+    const AzureCloudShellGenerator azureCloudShellGenerator;
+    const VisualStudioGenerator visualStudioGenerator;
+    const std::array<const IDynamicProfileGenerator*, 4> generators{
+        &powershellCoreGenerator,
+        &wslDistroGenerator,
+        &azureCloudShellGenerator,
+        &visualStudioGenerator,
+    };
+
+    std::array<std::future<std::vector<winrt::com_ptr<Profile>>>, generators.size()> results;
+    for (size_t i = 0; i < generators.size(); ++i)
+    {
+        const auto generator = til::at(generators, i);
+        if (!_ignoredNamespaces.count(generator->GetNamespace()))
+        {
+            til::at(results, i) = std::async(std::launch::async, [generator]() {
+                return _executeGenerator(*generator);
+            });
+        }
+    }
+
+    for (size_t i = 0; i < generators.size(); ++i)
+    {
+        if (auto& result = til::at(results, i); result.valid())
+        {
+            _appendGeneratedProfiles(til::at(generators, i)->GetNamespace(), result.get());
+        }
+    }
 }
 
 // A new settings.json gets a special treatment:
@@ -198,21 +229,25 @@ void SettingsLoader::MergeInboxIntoUserSettings()
 // merge them. Unfortunately however the "updates" key in fragment profiles make this impossible:
 // The targeted profile might be one that got created as part of SettingsLoader::MergeInboxIntoUserSettings.
 // Additionally the GUID in "updates" will conflict with existing GUIDs in .inboxSettings.
+//
+// Reading and parsing the fragment files doesn't depend on anything else, so that happens concurrently.
+// Layering the fragments onto the user settings on the other hand must happen in a deterministic order.
+// That's why all fragments are parsed in the background while they're being searched for, and only
+// layered once the search is done, in the order in which they were found.
 void SettingsLoader::FindFragmentsAndMergeIntoUserSettings()
 {
-    ParsedSettings fragmentSettings;
+    std::vector<std::pair<winrt::hstring, std::future<Json::Value>>> fragments;
 
-    const auto parseAndLayerFragmentFiles = [&](const std::filesystem::path& path, const winrt::hstring& source) {
+    const auto parseFragmentFiles = [&](const std::filesystem::path& path, const winrt::hstring& source) {
         for (const auto& fragmentExt : std::filesystem::directory_iterator{ path })
         {
             if (fragmentExt.path().extension() == jsonExtension)
             {
-                try
-                {
-                    const auto content = ReadUTF8File(fragmentExt.path());
-                    _parseFragment(source, content, fragmentSettings);
-                }
-                CATCH_LOG();
+                auto json = std::async(std::launch::async, [path = fragmentExt.path()]() {
+                    const auto content = ReadUTF8File(path);
+                    return content.empty() ? Json::Value{ Json::ValueType::objectValue } : _parseJSON(content);
+                });
+                fragments.emplace_back(source, std::move(json));
             }
         }
     };
@@ -233,7 +268,7 @@ void SettingsLoader::FindFragmentsAndMergeIntoUserSettings()
 
                 if (!_ignoredNamespaces.count(std::wstring_view{ source }) && fragmentExtFolder.is_directory())
                 {
-                    parseAndLayerFragmentFiles(fragmentExtFolder.path(), winrt::hstring{ source });
+                    parseFragmentFiles(fragmentExtFolder.path(), winrt::hstring{ source });
                 }
             }
         }
@@ -258,37 +293,47 @@ void SettingsLoader::FindFragmentsAndMergeIntoUserSettings()
     }
     CATCH_LOG();
 
-    if (!extensions)
+    if (extensions)
     {
-        return;
-    }
-
-    for (const auto& ext : extensions)
-    {
-        const auto packageName = ext.Package().Id().FamilyName();
-        if (_ignoredNamespaces.count(std::wstring_view{ packageName }))
+        for (const auto& ext : extensions)
         {
-            continue;
-        }
+            const auto packageName = ext.Package().Id().FamilyName();
+            if (_ignoredNamespaces.count(std::wstring_view{ packageName }))
+            {
+                continue;
+            }
 
-        // Likewise, getting the public folder from an extension is an async operation.
-        auto foundFolder = extractValueFromTaskWithoutMainThreadAwait(ext.GetPublicFolderAsync());
-        if (!foundFolder)
-        {
-            continue;
+            // Likewise, getting the public folder from an extension is an async operation.
+            auto foundFolder = extractValueFromTaskWithoutMainThreadAwait(ext.GetPublicFolderAsync());
+            if (!foundFolder)
+            {
+                continue;
+            }
+
+            // the StorageFolder class has its own methods for obtaining the files within the folder
+            // however, all those methods are Async methods
+            // you may have noticed that we need to resort to clunky implementations for async operations
+            // (they are in extractValueFromTaskWithoutMainThreadAwait)
+            // so for now we will just take the folder path and access the files that way
+            const auto path = buildPath(foundFolder.Path(), FragmentsSubDirectory);
+
+            if (std::filesystem::is_directory(path))
+            {
+                parseFragmentFiles(path, packageName);
+            }
         }
+    }
 
-        // the StorageFolder class has its own methods for obtaining the files within the folder
-        // however, all those methods are Async methods
-        // you may have noticed that we need to resort to clunky implementations for async operations
-        // (they are in extractValueFromTaskWithoutMainThreadAwait)
-        // so for now we will just take the folder path and access the files that way
-        const auto path = buildPath(foundFolder.Path(), FragmentsSubDirectory);
+    // Now that all fragments have been found, layer them in the order in which they were found.
+    ParsedSettings fragmentSettings;
 
-        if (std::filesystem::is_directory(path))
+    for (auto& [source, json] : fragments)
+    {
+        try
         {
-            parseAndLayerFragmentFiles(path, packageName);
+            _parseFragment(source, _parseJson(json.get()), fragmentSettings);
         }
+        CATCH_LOG();
     }
 }
 
@@ -298,7 +343,7 @@ void SettingsLoader::FindFragmentsAndMergeIntoUserSettings()
 void SettingsLoader::MergeFragmentIntoUserSettings(const winrt::hstring& source, const std::string_view& content)
 {
     ParsedSettings fragmentSettings;
-    _parseFragment(source, content, fragmentSettings);
+    _parseFragment(source, _parseJson(content), fragmentSettings);
 }
 
 // Call this method before passing SettingsLoader to the CascadiaSettings constructor.
@@ -558,10 +603,8 @@ void SettingsLoader::_parse(const OriginTag origin, const winrt::hstring& source
 
 // Just like _parse, but is to be used for fragment files, which don't support anything but color
 // schemes and profiles. Additionally this function supports profiles which specify an "updates" key.
-void SettingsLoader::_parseFragment(const winrt::hstring& source, const std::string_view& content, ParsedSettings& settings)
+void SettingsLoader::_parseFragment(const winrt::hstring& source, const JsonSettings& json, ParsedSettings& settings)
 {
-    const auto json = _parseJson(content);
-
     settings.clear();
 
     {
@@ -627,7 +670,11 @@ void SettingsLoader::_parseFragment(const winrt::hstring& source, const std::str
 
 SettingsLoader::JsonSettings SettingsLoader::_parseJson(const std::string_view& content)
 {
-    auto root = content.empty() ? Json::Value{ Json::ValueType::objectValue } : _parseJSON(content);
+    return _parseJson(content.empty() ? Json::Value{ Json::ValueType::objectValue } : _parseJSON(content));
+}
+
+SettingsLoader::JsonSettings SettingsLoader::_parseJson(Json::Value&& root)
+{
     const auto& colorSchemes = _getJSONValue(root, SchemesKey);
     const auto& profilesObject = _getJSONValue(root, ProfilesKey);
     const auto& profileDefaults = _getJSONValue(profilesObject, DefaultSettingsKey);
@@ -721,35 +768,36 @@ void SettingsLoader::_addUserProfileParent(const winrt::com_ptr<implementation::
     }
 }
 
-// As the name implies it executes a generator.
-// Generated profiles are added to .inboxSettings. Used by GenerateProfiles().
-void SettingsLoader::_executeGenerator(const IDynamicProfileGenerator& generator)
+// As the name implies it executes a generator and returns the profiles it generated.
+// This runs on a background thread and must not touch the loader. Used by GenerateProfiles().
+std::vector<winrt::com_ptr<Profile>> SettingsLoader::_executeGenerator(const IDynamicProfileGenerator& generator)
 {
-    const auto generatorNamespace = generator.GetNamespace();
-    if (_ignoredNamespaces.count(generatorNamespace))
-    {
-        return;
-    }
-
-    const auto previousSize = inboxSettings.profiles.size();
+    std::vector<winrt::com_ptr<Profile>> profiles;
 
     try
     {
-        generator.GenerateProfiles(inboxSettings.profiles);
+        // The VS generator talks to a COM server. Enter the MTA for it, since
+        // we can't know whether this thread has been initialized for COM yet.
+        const auto coInit = wil::CoInitializeEx(COINIT_MULTITHREADED);
+        generator.GenerateProfiles(profiles);
     }
-    CATCH_LOG_MSG("Dynamic Profile Namespace: \"%.*s\"", gsl::narrow<int>(generatorNamespace.size()), generatorNamespace.data())
+    CATCH_LOG_MSG("Dynamic Profile Namespace: \"%.*s\"", gsl::narrow<int>(generator.GetNamespace().size()), generator.GetNamespace().data())
 
+    return profiles;
+}
+
+// Adds the profiles returned by _executeGenerator() to .inboxSettings. Used by GenerateProfiles().
+void SettingsLoader::_appendGeneratedProfiles(const std::wstring_view& generatorNamespace, std::vector<winrt::com_ptr<Profile>>&& profiles)
+{
     // If the generator produced some profiles we're going to give them default attributes.
     // By setting the Origin/Source/etc. here, we deduplicate some code and ensure they aren't missing accidentally.
-    if (inboxSettings.profiles.size() > previousSize)
-    {
-        const winrt::hstring source{ generatorNamespace };
+    const winrt::hstring source{ generatorNamespace };
 
-        for (const auto& profile : gsl::span(inboxSettings.profiles).subspan(previousSize))
-        {
-            profile->Origin(OriginTag::Generated);
-            profile->Source(source);
-        }
+    for (auto& profile : profiles)
+    {
+        profile->Origin(OriginTag::Generated);
+        profile->Source(source);
+        inboxSettings.profiles.emplace_back(std::move(profile));
     }
 }
 
@@ -834,6 +882,7 @@ try
 
     // If this throws, the app will catch it and use the default settings.
     const auto settings = winrt::make_self<CascadiaSettings>(std::move(loader));
+    settings->_hash = _calculateHash(settingsString);
 
     // If we created the file, or found new dynamic profiles, write the user
     // settings string back to the file.
@@ -1044,6 +1093,9 @@ void CascadiaSettings::WriteSettingsToDisk() const
 
     const auto styledString{ Json::writeString(wbuilder, ToJson()) };
     WriteUTF8FileAtomic(settingsPath, styledString);
+    // We're about to receive a change notification for the file we just wrote.
+    // Remember what we wrote, so that IsUpToDate() doesn't cause a needless reload.
+    _hash = _calculateHash(styledString);
 
     // Persists the default terminal choice
     // GH#10003 - Only do this if _currentDefaultTerminal was actually initialized.
@@ -1053,6 +1105,53 @@ void CascadiaSettings::WriteSettingsToDisk() const
     }
 }
 
+// Method Description:
+// - Checks whether the settings file on disk still has the contents these
+//   settings were loaded from, or that they last wrote to it.
+// - Reloading the settings means parsing all JSON and running every dynamic
+//   profile generator again. Watching the settings file is imprecise, as many
+//   editors touch or replace the file without changing its contents, and our
+//   own writes trigger a change notification as well. This allows callers to
+//   skip reloads in those cases, at the cost of one file read and hash.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the settings file is unchanged, false if it changed or can't be read.
+bool CascadiaSettings::IsUpToDate() const
+try
+{
+    if (_hash.empty())
+    {
+        return false;
+    }
+
+    const auto settingsString = ReadUTF8FileIfExists(_settingsPath()).value_or(std::string{});
+    return !settingsString.empty() && _calculateHash(settingsString) == _hash;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return false;
+}
+
+// Method Description:
+// - Hashes the contents of a settings file for IsUpToDate().
+// Arguments:
+// - content: The contents of the settings file.
+// Return Value:
+// - The hash, or an empty string if there's no content.
+winrt::hstring CascadiaSettings::_calculateHash(const std::string_view& content)
+{
+    if (content.empty())
+    {
+        return {};
+    }
+
+    til::hasher h;
+    h.write(content);
+    return winrt::hstring{ fmt::format(L"{:016x}", h.finalize()) };
+}
+
 // Method Description:
 // - Create a new serialized JsonObject from an instance of this class
 // Arguments:
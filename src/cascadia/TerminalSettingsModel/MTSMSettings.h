@@ -26,6 +26,7 @@ Author(s):
     X(bool, FocusFollowMouse, "focusFollowMouse", false)                                                                                                   \
     X(bool, ForceFullRepaintRendering, "experimental.rendering.forceFullRepaint", false)                                                                   \
     X(bool, SoftwareRendering, "experimental.rendering.software", false)                                                                                   \
+    X(bool, SmoothScrolling, "experimental.rendering.smoothScrolling", false)                                                                              \
     X(bool, UseBackgroundImageForWindow, "experimental.useBackgroundImageForWindow", false)                                                                \
     X(bool, ForceVTInput, "experimental.input.forceVT", false)                                                                                             \
     X(bool, TrimBlockSelection, "trimBlockSelection", true)                                                                                                \
@@ -58,7 +59,9 @@ Author(s):
     X(bool, AlwaysShowNotificationIcon, "alwaysShowNotificationIcon", false)                                                                               \
     X(winrt::Windows::Foundation::Collections::IVector<winrt::hstring>, DisabledProfileSources, "disabledProfileSources", nullptr)                         \
     X(bool, ShowAdminShield, "showAdminShield", true)                                                                                                      \
-    X(bool, TrimPaste, "trimPaste", true)
+    X(bool, TrimPaste, "trimPaste", true)                                                                                                                  \
+    X(int32_t, PseudoConsolePoolSize, "experimental.connection.pseudoConsolePoolSize", 0)                                                                  \
+    X(bool, MultiplexedConptyOutput, "experimental.connection.multiplexedOutput", false)
 
 #define MTSM_PROFILE_SETTINGS(X)                                                                                                                               \
     X(int32_t, HistorySize, "historySize", DEFAULT_HISTORY_SIZE)                                                                                               \
@@ -80,7 +83,11 @@ Author(s):
     X(bool, Elevate, "elevate", false)                                                                                                                         \
     X(bool, VtPassthrough, "experimental.connection.passthroughMode", false)                                                                                   \
     X(bool, AutoMarkPrompts, "experimental.autoMarkPrompts", false)                                                                                            \
-    X(bool, ShowMarks, "experimental.showMarksOnScrollbar", false)
+    X(bool, PredictiveEcho, "experimental.predictiveEcho", false)                                                                                              \
+    X(bool, ShowMarks, "experimental.showMarksOnScrollbar", false)                                                                                             \
+    X(hstring, RecordingDirectory, "experimental.connection.recordingDirectory", L"")                                                                          \
+    X(bool, RecordInput, "experimental.connection.recordInput", false)                                                                                         \
+    X(hstring, MuxEndpoint, "experimental.connection.muxEndpoint", L"")
 
 // Intentionally omitted Profile settings:
 // * Name
@@ -32,11 +32,14 @@ namespace ControlUnitTests
         TEST_METHOD(TestFreeAfterClose);
 
         TEST_METHOD(TestFontInitializedInCtor);
+        TEST_METHOD(TestUpdateSettingsKeepsUnchangedFont);
 
         TEST_METHOD(TestClearScrollback);
         TEST_METHOD(TestClearScreen);
         TEST_METHOD(TestClearAll);
 
+        TEST_METHOD(TestInputSentOnlyForUserInput);
+
         TEST_CLASS_SETUP(ModuleSetup)
         {
             winrt::init_apartment(winrt::apartment_type::single_threaded);
@@ -223,6 +226,29 @@ namespace ControlUnitTests
         VERIFY_ARE_EQUAL(L"Impact", std::wstring_view{ core->_actualFont.GetFaceName() });
     }
 
+    void ControlCoreTests::TestUpdateSettingsKeepsUnchangedFont()
+    {
+        auto [settings, conn] = _createSettingsAndConnection();
+        auto core = createCore(*settings, *conn);
+        VERIFY_IS_NOT_NULL(core);
+        _standardInit(core);
+
+        const auto initialSize = core->_desiredFont.GetEngineSize().Y;
+        core->AdjustFontSize(2);
+        const auto adjustedSize = core->_desiredFont.GetEngineSize().Y;
+        VERIFY_ARE_NOT_EQUAL(initialSize, adjustedSize);
+
+        Log::Comment(L"Reloading settings without font changes must not re-resolve the font.");
+        core->UpdateSettings(*settings, *settings);
+        VERIFY_ARE_EQUAL(adjustedSize, core->_desiredFont.GetEngineSize().Y);
+
+        Log::Comment(L"Changing the font face must reset the font, including its size.");
+        settings->FontFace(L"Impact");
+        core->UpdateSettings(*settings, *settings);
+        VERIFY_ARE_EQUAL(initialSize, core->_desiredFont.GetEngineSize().Y);
+        VERIFY_ARE_EQUAL(L"Impact", std::wstring_view{ core->_actualFont.GetFaceName() });
+    }
+
     void ControlCoreTests::TestClearScrollback()
     {
         auto [settings, conn] = _createSettingsAndConnection();
@@ -341,4 +367,31 @@ namespace ControlUnitTests
         // The ConptyRoundtripTests test the actual clearing of the contents.
     }
 
+    void ControlCoreTests::TestInputSentOnlyForUserInput()
+    {
+        auto [settings, conn] = _createSettingsAndConnection();
+        Log::Comment(L"Create ControlCore object");
+        auto core = createCore(*settings, *conn);
+        VERIFY_IS_NOT_NULL(core);
+        _standardInit(core);
+
+        std::wstring sent;
+        core->InputSent([&](auto&&, const Control::InputSentEventArgs& args) {
+            sent += args.Text();
+        });
+
+        Log::Comment(L"Typed characters are reported");
+        core->SendCharEvent(L'a', 0, {});
+        VERIFY_ARE_EQUAL(L"a", sent);
+
+        Log::Comment(L"Pasted text is reported");
+        sent.clear();
+        core->PasteText(L"bc");
+        VERIFY_ARE_EQUAL(L"bc", sent);
+
+        Log::Comment(L"Input sent programmatically isn't reported");
+        sent.clear();
+        core->SendInput(L"def");
+        VERIFY_ARE_EQUAL(L"", sent);
+    }
 }
@@ -0,0 +1,202 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "../TerminalControl/OutputProcessingPool.h"
+
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using winrt::Microsoft::Terminal::Control::implementation::OutputProcessingPool;
+
+namespace ControlUnitTests
+{
+    class OutputProcessingPoolTests
+    {
+        BEGIN_TEST_CLASS(OutputProcessingPoolTests)
+            TEST_CLASS_PROPERTY(L"TestTimeout", L"0:0:10") // 10s timeout
+        END_TEST_CLASS()
+
+        TEST_METHOD(RunsScheduledWork);
+        TEST_METHOD(RunsUntilDone);
+        TEST_METHOD(KeepsQueuesInOrder);
+        TEST_METHOD(CoalescesSchedules);
+        TEST_METHOD(RunsHiddenQueuesBelowNormalPriority);
+    };
+
+    void OutputProcessingPoolTests::RunsScheduledWork()
+    {
+        wil::slim_event_manual_reset ran;
+        OutputProcessingPool::Queue queue{ [&]() {
+            ran.SetEvent();
+            return false;
+        } };
+
+        Log::Comment(L"Nothing runs until the queue is scheduled.");
+        VERIFY_IS_FALSE(ran.wait(100));
+
+        queue.Schedule();
+        VERIFY_IS_TRUE(ran.wait(5000));
+    }
+
+    void OutputProcessingPoolTests::RunsUntilDone()
+    {
+        std::atomic<int> runs{ 0 };
+        wil::slim_event_manual_reset done;
+        OutputProcessingPool::Queue queue{ [&]() {
+            if (++runs == 10)
+            {
+                done.SetEvent();
+                return false;
+            }
+            return true;
+        } };
+
+        Log::Comment(L"A queue that has work left is rescheduled without being scheduled again.");
+        queue.Schedule();
+        VERIFY_IS_TRUE(done.wait(5000));
+
+        Log::Comment(L"Once it's done, it doesn't run again.");
+        Sleep(100);
+        VERIFY_ARE_EQUAL(10, runs.load());
+    }
+
+    void OutputProcessingPoolTests::CoalescesSchedules()
+    {
+        wil::slim_event_manual_reset started;
+        wil::slim_event_manual_reset proceed;
+        std::atomic<int> runs{ 0 };
+        OutputProcessingPool::Queue queue{ [&]() {
+            if (++runs == 1)
+            {
+                started.SetEvent();
+                proceed.wait();
+            }
+            return false;
+        } };
+
+        Log::Comment(L"Only the first schedule of a queue that's waiting to run wakes up the pool.");
+        queue.Schedule();
+        VERIFY_IS_TRUE(started.wait(5000));
+        queue.Schedule();
+        queue.Schedule();
+        queue.Schedule();
+        VERIFY_ARE_EQUAL(uint64_t{ 2 }, queue.Wakeups());
+
+        Log::Comment(L"The work that was added while the queue ran is picked up by one more run.");
+        proceed.SetEvent();
+        Sleep(100);
+        VERIFY_ARE_EQUAL(2, runs.load());
+
+        queue.Schedule();
+        Sleep(100);
+        VERIFY_ARE_EQUAL(3, runs.load());
+        VERIFY_ARE_EQUAL(uint64_t{ 3 }, queue.Wakeups());
+    }
+
+    void OutputProcessingPoolTests::RunsHiddenQueuesBelowNormalPriority()
+    {
+        std::atomic<int> threadPriority{ THREAD_PRIORITY_ERROR_RETURN };
+        wil::slim_event_auto_reset ran;
+        OutputProcessingPool::Queue queue{ [&]() {
+            threadPriority = GetThreadPriority(GetCurrentThread());
+            ran.SetEvent();
+            return false;
+        } };
+
+        Log::Comment(L"The output of hidden panes doesn't compete with that of the others.");
+        queue.SetPriority(OutputProcessingPool::Priority::Hidden);
+        queue.Schedule();
+        VERIFY_IS_TRUE(ran.wait(5000));
+        VERIFY_ARE_EQUAL(THREAD_PRIORITY_BELOW_NORMAL, threadPriority.load());
+
+        Log::Comment(L"Once the pane is shown again, its output is written at the normal priority.");
+        queue.SetPriority(OutputProcessingPool::Priority::Focused);
+        queue.Schedule();
+        VERIFY_IS_TRUE(ran.wait(5000));
+        VERIFY_ARE_EQUAL(THREAD_PRIORITY_NORMAL, threadPriority.load());
+
+        Log::Comment(L"Nothing is waiting to run, so there's no reason to yield.");
+        VERIFY_IS_FALSE(OutputProcessingPool::HasPendingWorkAbove(OutputProcessingPool::Priority::Hidden));
+    }
+
+    void OutputProcessingPoolTests::KeepsQueuesInOrder()
+    {
+        // Every queue has its own work, which must never be run concurrently,
+        // no matter how many threads the pool has.
+        static constexpr int itemCount = 1000;
+        static constexpr size_t queueCount = 8;
+
+        struct Work
+        {
+            std::mutex lock;
+            std::deque<int> pending;
+            std::vector<int> processed;
+            std::atomic<bool> running{ false };
+            std::atomic<bool> overlapped{ false };
+            std::unique_ptr<OutputProcessingPool::Queue> queue;
+        };
+        std::array<Work, queueCount> works;
+
+        for (auto& work : works)
+        {
+            work.queue = std::make_unique<OutputProcessingPool::Queue>([&work]() {
+                if (work.running.exchange(true))
+                {
+                    work.overlapped = true;
+                }
+
+                std::optional<int> item;
+                {
+                    const std::scoped_lock lock{ work.lock };
+                    if (!work.pending.empty())
+                    {
+                        item = work.pending.front();
+                        work.pending.pop_front();
+                    }
+                }
+                if (item)
+                {
+                    work.processed.push_back(*item);
+                }
+
+                work.running = false;
+                return item.has_value();
+            });
+        }
+
+        for (auto i = 0; i < itemCount; ++i)
+        {
+            for (auto& work : works)
+            {
+                {
+                    const std::scoped_lock lock{ work.lock };
+                    work.pending.push_back(i);
+                }
+                work.queue->Schedule();
+            }
+        }
+
+        for (auto& work : works)
+        {
+            for (auto tries = 0; tries < 500; ++tries)
+            {
+                {
+                    const std::scoped_lock lock{ work.lock };
+                    if (work.pending.empty())
+                    {
+                        break;
+                    }
+                }
+                Sleep(10);
+            }
+
+            // Waits for the last run to finish.
+            work.queue.reset();
+
+            VERIFY_IS_FALSE(work.overlapped.load());
+            VERIFY_ARE_EQUAL(static_cast<size_t>(itemCount), work.processed.size());
+            VERIFY_IS_TRUE(std::is_sorted(work.processed.begin(), work.processed.end()));
+        }
+    }
+}
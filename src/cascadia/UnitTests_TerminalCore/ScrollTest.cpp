@@ -104,6 +104,8 @@ class TerminalCoreUnitTests::ScrollTest final
     TEST_CLASS(ScrollTest);
 
     TEST_METHOD(TestNotifyScrolling);
+    TEST_METHOD(TestWriteCoalescesScrollNotifications);
+    TEST_METHOD(TestScrollMarksFollowCircling);
 
     TEST_METHOD_SETUP(MethodSetup)
     {
@@ -235,3 +237,78 @@ void ScrollTest::TestNotifyScrolling()
         }
     }
 }
+
+void ScrollTest::TestScrollMarksFollowCircling()
+{
+    using Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark;
+
+    const auto writeLines = [&](const til::CoordType count) {
+        std::wstring output;
+        for (til::CoordType i = 0; i < count; i++)
+        {
+            output.append(L"X\r\n");
+        }
+        _term->Write(output);
+    };
+
+    Log::Comment(L"Fill the buffer, so that every further line circles it");
+    writeLines(_term->_mainBuffer->GetSize().Height());
+
+    _term->AddMark(ScrollMark{}, { 0, 10 }, { 5, 10 });
+    _term->AddMark(ScrollMark{}, { 0, 20 }, { 5, 20 });
+
+    Log::Comment(L"The marks move up along with the text");
+    writeLines(3);
+    {
+        const auto marks = _term->GetScrollMarks();
+        VERIFY_ARE_EQUAL(size_t{ 2 }, marks.size());
+        VERIFY_ARE_EQUAL(7, marks[0].start.y);
+        VERIFY_ARE_EQUAL(7, marks[0].end.y);
+        VERIFY_ARE_EQUAL(17, marks[1].start.y);
+    }
+
+    VERIFY_ARE_EQUAL(7, _term->GetScrollMarkBefore(17).value().start.y);
+    VERIFY_ARE_EQUAL(17, _term->GetScrollMarkAfter(7).value().start.y);
+    VERIFY_IS_FALSE(_term->GetScrollMarkBefore(7).has_value());
+    VERIFY_IS_FALSE(_term->GetScrollMarkAfter(17).has_value());
+
+    Log::Comment(L"Marks that get pushed off the top of the buffer are removed");
+    writeLines(8);
+    {
+        const auto marks = _term->GetScrollMarks();
+        VERIFY_ARE_EQUAL(size_t{ 1 }, marks.size());
+        VERIFY_ARE_EQUAL(9, marks[0].start.y);
+    }
+}
+
+void ScrollTest::TestWriteCoalescesScrollNotifications()
+{
+    auto notifications = 0;
+    _term->SetScrollPositionChangedCallback([&](const int top, const int height, const int bottom) {
+        notifications++;
+        ScrollBarNotification tmp;
+        tmp.ViewportTop = top;
+        tmp.ViewportHeight = height;
+        tmp.BufferHeight = bottom;
+        *_scrollBarNotification = { tmp };
+    });
+
+    Log::Comment(L"Scrolling by 69 rows in a single write should notify only once, about the final position");
+    std::wstring output;
+    for (auto i = 0; i < 100; i++)
+    {
+        output.append(L"X\r\n");
+    }
+    _term->Write(output);
+
+    VERIFY_ARE_EQUAL(1, notifications);
+    VERIFY_IS_TRUE(_scrollBarNotification->has_value());
+    VERIFY_ARE_EQUAL(69, _scrollBarNotification->value().ViewportTop);
+    VERIFY_ARE_EQUAL(TerminalViewHeight, _scrollBarNotification->value().ViewportHeight);
+    VERIFY_ARE_EQUAL(69 + TerminalViewHeight, _scrollBarNotification->value().BufferHeight);
+
+    Log::Comment(L"A write that doesn't scroll doesn't notify at all");
+    notifications = 0;
+    _term->Write(L"\x1b[H\x1b[2;3HX");
+    VERIFY_ARE_EQUAL(0, notifications);
+}
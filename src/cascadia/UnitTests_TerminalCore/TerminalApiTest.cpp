@@ -41,6 +41,11 @@ namespace TerminalCoreUnitTests
 
         TEST_METHOD(SetTaskbarProgress);
         TEST_METHOD(SetWorkingDirectory);
+
+        TEST_METHOD(PredictiveEcho);
+
+        TEST_METHOD(WritePlainText);
+        TEST_METHOD(WriteStatistics);
     };
 };
 
@@ -468,3 +473,81 @@ void TerminalCoreUnitTests::TerminalApiTest::SetWorkingDirectory()
     stateMachine.ProcessString(L"\x1b]9;9;\"\"\"\"\x1b\\");
     VERIFY_ARE_EQUAL(term.GetWorkingDirectory(), L"\"\"");
 }
+
+void TerminalApiTest::PredictiveEcho()
+{
+    Terminal term;
+    DummyRenderer renderer{ &term };
+    term.Create({ 100, 100 }, 0, renderer);
+    term._predictiveEcho = true;
+
+    Log::Comment(L"Predictions are hidden until the connection echoed one of them");
+    term.SendCharEvent(L'a', 0, {});
+    VERIFY_ARE_EQUAL(term._predictedText, L"a");
+    VERIFY_IS_TRUE(term.GetOverlays().empty());
+    VERIFY_ARE_EQUAL((til::point{ 0, 0 }), term.GetCursorPosition());
+
+    term.Write(L"a");
+    VERIFY_IS_TRUE(term._predictedText.empty());
+    VERIFY_IS_TRUE(term._predictionsConfirmed);
+
+    Log::Comment(L"Once confirmed, predictions are shown with the cursor after them");
+    term.SendCharEvent(L'b', 0, {});
+    term.SendCharEvent(L'c', 0, {});
+    VERIFY_ARE_EQUAL(size_t{ 1 }, term.GetOverlays().size());
+    VERIFY_ARE_EQUAL((til::point{ 3, 0 }), term.GetCursorPosition());
+
+    Log::Comment(L"A partial echo only confirms the predictions it covers");
+    term.Write(L"b");
+    VERIFY_ARE_EQUAL(term._predictedText, L"c");
+    VERIFY_ARE_EQUAL((til::point{ 2, 0 }), term._predictionOrigin);
+
+    Log::Comment(L"A different echo drops the predictions and hides further ones");
+    term.Write(L"x");
+    VERIFY_IS_TRUE(term._predictedText.empty());
+    VERIFY_IS_FALSE(term._predictionsConfirmed);
+
+    Log::Comment(L"Control characters aren't predicted");
+    term._predictionsConfirmed = true;
+    term.SendCharEvent(L'd', 0, {});
+    term.SendCharEvent(L'\r', 0, {});
+    VERIFY_IS_TRUE(term._predictedText.empty());
+}
+
+void TerminalApiTest::WritePlainText()
+{
+    Terminal term;
+    DummyRenderer renderer{ &term };
+    term.Create({ 100, 100 }, 0, renderer);
+
+    Log::Comment(L"Only CR and LF are interpreted, the latter as a new line");
+    term.WritePlainText(L"abc\r\nxy\rz\nd[2J");
+
+    auto& tb = term.GetTextBuffer();
+    VERIFY_ARE_EQUAL(L"abc ", tb.GetRowByOffset(0).GetText().substr(0, 4));
+    VERIFY_ARE_EQUAL(L"zy ", tb.GetRowByOffset(1).GetText().substr(0, 3));
+    VERIFY_ARE_EQUAL(L"d[2J ", tb.GetRowByOffset(2).GetText().substr(0, 5));
+    VERIFY_ARE_EQUAL((til::point{ 4, 2 }), term.GetCursorPosition());
+
+    Log::Comment(L"A full row followed by a LF isn't marked as wrapped");
+    term.WritePlainText(L"\n" + std::wstring(100, L'e') + L"\n");
+    VERIFY_IS_FALSE(tb.GetRowByOffset(3).WasWrapForced());
+}
+
+void TerminalApiTest::WriteStatistics()
+{
+    Terminal term;
+    DummyRenderer renderer{ &term };
+    term.Create({ 100, 100 }, 0, renderer);
+
+    VERIFY_ARE_EQUAL(uint64_t{ 0 }, term.GetWriteStatistics().characters);
+
+    Log::Comment(L"Both kinds of output are counted, including the control sequences");
+    term.Write(L"abc\x1b[m");
+    term.WritePlainText(L"de");
+
+    const auto statistics = term.GetWriteStatistics();
+    VERIFY_ARE_EQUAL(uint64_t{ 8 }, statistics.characters);
+    VERIFY_IS_TRUE(statistics.lockWait.count() >= 0);
+    VERIFY_IS_TRUE(statistics.writing.count() >= 0);
+}
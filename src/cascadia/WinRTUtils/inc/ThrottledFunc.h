@@ -4,9 +4,12 @@
 #pragma once
 
 #include "til/throttled_func.h"
+#include "UiUpdateBatcher.h"
 
 // ThrottledFunc is a copy of til::throttled_func,
 // specialized for the use with a WinRT Dispatcher.
+// The invocations are run through the UiUpdateBatcher of the dispatcher,
+// so that the updates of all ThrottledFuncs of a window run together.
 template<bool leading, typename... Args>
 class ThrottledFunc : public std::enable_shared_from_this<ThrottledFunc<leading, Args...>>
 {
@@ -27,7 +30,8 @@ public:
         winrt::Windows::System::DispatcherQueue dispatcher,
         filetime_duration delay,
         function func) :
-        _dispatcher{ std::move(dispatcher) },
+        _windowLength{ til::details::throttled_func_window_length(delay) },
+        _batcher{ UiUpdateBatcher::GetForDispatcher(dispatcher) },
         _func{ std::move(func) },
         _timer{ _create_timer() }
     {
@@ -81,7 +85,7 @@ private:
     {
         if constexpr (leading)
         {
-            _dispatcher.TryEnqueue(winrt::Windows::System::DispatcherQueuePriority::Normal, [weakSelf = this->weak_from_this()]() {
+            _batcher->Post([weakSelf = this->weak_from_this()]() {
                 if (auto self{ weakSelf.lock() })
                 {
                     try
@@ -90,13 +94,13 @@ private:
                     }
                     CATCH_LOG();
 
-                    SetThreadpoolTimerEx(self->_timer.get(), &self->_delay, 0, 0);
+                    SetThreadpoolTimerEx(self->_timer.get(), &self->_delay, 0, self->_windowLength);
                 }
             });
         }
         else
         {
-            SetThreadpoolTimerEx(_timer.get(), &_delay, 0, 0);
+            SetThreadpoolTimerEx(_timer.get(), &_delay, 0, _windowLength);
         }
     }
 
@@ -108,7 +112,7 @@ private:
         }
         else
         {
-            _dispatcher.TryEnqueue(winrt::Windows::System::DispatcherQueuePriority::Normal, [weakSelf = this->weak_from_this()]() {
+            _batcher->Post([weakSelf = this->weak_from_this()]() {
                 if (auto self{ weakSelf.lock() })
                 {
                     try
@@ -129,7 +133,8 @@ private:
     }
 
     FILETIME _delay;
-    winrt::Windows::System::DispatcherQueue _dispatcher;
+    DWORD _windowLength;
+    std::shared_ptr<UiUpdateBatcher> _batcher;
     function _func;
 
     wil::unique_threadpool_timer _timer;
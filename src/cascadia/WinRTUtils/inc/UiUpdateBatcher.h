@@ -0,0 +1,139 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+// Heavy output in many controls produces a lot of small UI updates: scroll
+// bars, titles, taskbar progress and so on. UiUpdateBatcher collects all the
+// updates for one dispatcher and runs them together in a single dispatcher
+// callback, at most once per frame, instead of enqueueing each on its own.
+class UiUpdateBatcher : public std::enable_shared_from_this<UiUpdateBatcher>
+{
+public:
+    using filetime_duration = std::chrono::duration<int64_t, std::ratio<1, 10000000>>;
+
+    // The minimum delay between two batches.
+    static constexpr filetime_duration FrameInterval{ std::chrono::microseconds{ 16667 } };
+
+    // Returns the batcher of the given dispatcher. All users of a dispatcher
+    // share one batcher, for as long as any of them holds on to it.
+    static std::shared_ptr<UiUpdateBatcher> GetForDispatcher(const winrt::Windows::System::DispatcherQueue& dispatcher)
+    {
+        static wil::srwlock lock;
+        static std::vector<std::pair<winrt::Windows::System::DispatcherQueue, std::weak_ptr<UiUpdateBatcher>>> batchers;
+
+        const auto guard = lock.lock_exclusive();
+        batchers.erase(std::remove_if(batchers.begin(), batchers.end(), [](const auto& entry) { return entry.second.expired(); }), batchers.end());
+        for (const auto& [entryDispatcher, entryBatcher] : batchers)
+        {
+            if (entryDispatcher == dispatcher)
+            {
+                if (auto batcher = entryBatcher.lock())
+                {
+                    return batcher;
+                }
+            }
+        }
+
+        auto batcher = std::make_shared<UiUpdateBatcher>(dispatcher);
+        batchers.emplace_back(dispatcher, batcher);
+        return batcher;
+    }
+
+    explicit UiUpdateBatcher(winrt::Windows::System::DispatcherQueue dispatcher) :
+        _dispatcher{ std::move(dispatcher) },
+        _timer{ _create_timer() }
+    {
+    }
+
+    // UiUpdateBatcher uses its `this` pointer when creating _timer.
+    UiUpdateBatcher(const UiUpdateBatcher&) = delete;
+    UiUpdateBatcher& operator=(const UiUpdateBatcher&) = delete;
+    UiUpdateBatcher(UiUpdateBatcher&&) = delete;
+    UiUpdateBatcher& operator=(UiUpdateBatcher&&) = delete;
+
+    // Runs `func` on the dispatcher's thread, together with everything
+    // else that was posted until the next batch runs.
+    void Post(std::function<void()> func)
+    {
+        int64_t delay = 0;
+        {
+            const auto guard = _lock.lock_exclusive();
+            _pending.emplace_back(std::move(func));
+            if (std::exchange(_scheduled, true))
+            {
+                return;
+            }
+            delay = (_lastBatch + FrameInterval - std::chrono::steady_clock::now()).count();
+        }
+
+        if (delay <= 0)
+        {
+            _enqueue();
+        }
+        else
+        {
+            // Negative due times are relative to now.
+            const auto d = -delay;
+            FILETIME dueTime;
+            memcpy(&dueTime, &d, sizeof(d));
+            SetThreadpoolTimerEx(_timer.get(), &dueTime, 0, 0);
+        }
+    }
+
+private:
+    static void __stdcall _timer_callback(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context, PTP_TIMER /*timer*/) noexcept
+    {
+        static_cast<UiUpdateBatcher*>(context)->_enqueue();
+    }
+
+    void _enqueue()
+    {
+        _dispatcher.TryEnqueue(winrt::Windows::System::DispatcherQueuePriority::Normal, [weakSelf = weak_from_this()]() {
+            if (auto self{ weakSelf.lock() })
+            {
+                self->_run();
+            }
+        });
+    }
+
+    void _run()
+    {
+        {
+            const auto guard = _lock.lock_exclusive();
+            _running.swap(_pending);
+            _scheduled = false;
+            _lastBatch = std::chrono::steady_clock::now();
+        }
+
+        for (const auto& func : _running)
+        {
+            try
+            {
+                func();
+            }
+            CATCH_LOG();
+        }
+        // Keeps the capacity around for the next batch.
+        _running.clear();
+    }
+
+    inline wil::unique_threadpool_timer _create_timer()
+    {
+        wil::unique_threadpool_timer timer{ CreateThreadpoolTimer(&_timer_callback, this, nullptr) };
+        THROW_LAST_ERROR_IF(!timer);
+        return timer;
+    }
+
+    winrt::Windows::System::DispatcherQueue _dispatcher;
+
+    wil::srwlock _lock;
+    std::vector<std::function<void()>> _pending;
+    bool _scheduled{ false };
+    std::chrono::steady_clock::time_point _lastBatch{};
+
+    // Only used on the dispatcher's thread.
+    std::vector<std::function<void()>> _running;
+
+    wil::unique_threadpool_timer _timer;
+};
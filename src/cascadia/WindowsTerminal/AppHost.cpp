@@ -142,6 +142,10 @@ AppHost::~AppHost()
     // out the window, then close the app.
     _revokers = {};
 
+    // The server's thread calls into the window manager, stop it before
+    // anything goes away.
+    _launcherPipeServer.reset();
+
     _showHideWindowThrottler.reset();
 
     _window = nullptr;
@@ -935,6 +939,23 @@ void AppHost::_BecomeMonarch(const winrt::Windows::Foundation::IInspectable& /*s
 
     _setupGlobalHotkeys();
 
+    // Let wt.exe hand its commandline straight to us, instead of starting a
+    // WindowsTerminal.exe which would then propose it to us over COM.
+    if (!_launcherPipeServer)
+    {
+        try
+        {
+            _launcherPipeServer = std::make_unique<LauncherPipeServer>([windowManager = _windowManager](const auto& args) {
+                return windowManager.ProposeForwardedCommandline(args);
+            });
+        }
+        CATCH_LOG();
+    }
+
+    // Likewise, console sessions that are handed off to us by the OS can go
+    // straight to a tab of our window.
+    _listenForInboundConnections();
+
     if (_windowManager.DoesQuakeWindowExist() ||
         _window->IsQuakeWindow() ||
         (_logic.GetAlwaysShowNotificationIcon() || _logic.GetMinimizeToNotificationArea()))
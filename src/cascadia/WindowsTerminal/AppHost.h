@@ -4,6 +4,7 @@
 #include "pch.h"
 #include "NonClientIslandWindow.h"
 #include "NotificationIcon.h"
+#include "LauncherPipeServer.h"
 #include <ThrottledFunc.h>
 
 class AppHost
@@ -123,6 +124,7 @@ private:
     void _HideNotificationIconRequested(const winrt::Windows::Foundation::IInspectable& sender,
                                         const winrt::Windows::Foundation::IInspectable& args);
     std::unique_ptr<NotificationIcon> _notificationIcon;
+    std::unique_ptr<LauncherPipeServer> _launcherPipeServer;
     winrt::event_token _ReAddNotificationIconToken;
     winrt::event_token _NotificationIconPressedToken;
     winrt::event_token _ShowNotificationIconContextMenuToken;
@@ -306,6 +306,13 @@ LRESULT IslandWindow::_OnMoving(const WPARAM /*wParam*/, const LPARAM lParam)
 
 void IslandWindow::Initialize()
 {
+    TraceLoggingWrite(
+        g_hWindowsTerminalProvider,
+        "XamlIslandInitStarted",
+        TraceLoggingDescription("Event emitted before the DesktopWindowXamlSource is created"),
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+        TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+
     _source = DesktopWindowXamlSource{};
 
     auto interop = _source.as<IDesktopWindowXamlSourceNative>();
@@ -317,6 +324,13 @@ void IslandWindow::Initialize()
     _rootGrid = winrt::Windows::UI::Xaml::Controls::Grid();
     _source.Content(_rootGrid);
 
+    TraceLoggingWrite(
+        g_hWindowsTerminalProvider,
+        "XamlIslandInitComplete",
+        TraceLoggingDescription("Event emitted once the Xaml island is attached to the window"),
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+        TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+
     // initialize the taskbar object
     if (auto taskbar = wil::CoCreateInstanceNoThrow<ITaskbarList3>(CLSID_TaskbarList))
     {
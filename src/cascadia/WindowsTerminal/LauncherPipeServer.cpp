@@ -0,0 +1,164 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "LauncherPipeServer.h"
+#include "../inc/LauncherPipe.h"
+
+using namespace winrt::Microsoft::Terminal;
+
+LauncherPipeServer::LauncherPipeServer(Handler handler) :
+    _handler{ std::move(handler) }
+{
+    // FILE_FLAG_FIRST_PIPE_INSTANCE makes sure that nobody else is already
+    // listening to the commandlines meant for us. There's only ever a single
+    // instance, which is reused for every client.
+    _pipe.reset(CreateNamedPipeW(GetLauncherPipeName().c_str(),
+                                 PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+                                 PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                 1,
+                                 sizeof(LauncherPipeHandled),
+                                 LauncherPipeMaxMessageSize,
+                                 0,
+                                 nullptr));
+    THROW_LAST_ERROR_IF(!_pipe);
+
+    _thread = std::thread{ [this]() { _run(); } };
+}
+
+LauncherPipeServer::~LauncherPipeServer()
+{
+    _shutdown.SetEvent();
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+void LauncherPipeServer::_run() noexcept
+try
+{
+    LOG_IF_FAILED(SetThreadDescription(GetCurrentThread(), L"LauncherPipeServer"));
+
+    // The handler calls into the Monarch, just like the commandlines that
+    // are proposed over COM, which arrive on threads in the MTA as well.
+    winrt::init_apartment(winrt::apartment_type::multi_threaded);
+    const auto uninit = wil::scope_exit([]() noexcept { winrt::uninit_apartment(); });
+
+    while (!_shutdown.is_signaled())
+    {
+        OVERLAPPED overlapped{};
+        overlapped.hEvent = _ioComplete.get();
+        DWORD transferred{ 0 };
+
+        // ERROR_PIPE_CONNECTED means that the client connected before we got here.
+        const auto started = ConnectNamedPipe(_pipe.get(), &overlapped);
+        const auto connected = (!started && GetLastError() == ERROR_PIPE_CONNECTED) ||
+                               _complete(started, overlapped, INFINITE, transferred);
+        if (connected)
+        {
+            try
+            {
+                _serveClient();
+            }
+            CATCH_LOG();
+        }
+
+        DisconnectNamedPipe(_pipe.get());
+    }
+}
+CATCH_LOG()
+
+// Method Description:
+// - Waits for an I/O operation on the pipe to complete, unless we're shutting
+//   down or the client takes longer than the given timeout. In either case
+//   the operation is canceled, since the OVERLAPPED structure must outlive it.
+// - Call this right after starting the operation.
+// Arguments:
+// - started: What the function that started the operation returned.
+// Return Value:
+// - true if the operation succeeded.
+bool LauncherPipeServer::_complete(const BOOL started, OVERLAPPED& overlapped, const DWORD timeout, DWORD& transferred) noexcept
+{
+    if (!started && GetLastError() != ERROR_IO_PENDING)
+    {
+        return false;
+    }
+
+    const std::array<HANDLE, 2> events{ _shutdown.get(), overlapped.hEvent };
+    if (WaitForMultipleObjects(gsl::narrow_cast<DWORD>(events.size()), events.data(), FALSE, timeout) != WAIT_OBJECT_0 + 1)
+    {
+        CancelIoEx(_pipe.get(), &overlapped);
+    }
+    return GetOverlappedResult(_pipe.get(), &overlapped, &transferred, TRUE);
+}
+
+// Method Description:
+// - Reads the commandline of the connected client, asks the handler to
+//   execute it and tells the client whether that worked.
+// - Clients that go away or take too long are simply dropped.
+void LauncherPipeServer::_serveClient()
+{
+    // Messages that don't fit into the buffer fail with ERROR_MORE_DATA.
+    std::wstring message(LauncherPipeMaxMessageSize / sizeof(wchar_t), L'\0');
+    OVERLAPPED overlapped{};
+    overlapped.hEvent = _ioComplete.get();
+    DWORD transferred{ 0 };
+    if (!_complete(ReadFile(_pipe.get(), message.data(), LauncherPipeMaxMessageSize, nullptr, &overlapped), overlapped, _clientTimeout, transferred))
+    {
+        return;
+    }
+    message.resize(transferred / sizeof(wchar_t));
+
+    auto reply = uint8_t{ 0 };
+    try
+    {
+        if (_handler(_parseMessage(message)))
+        {
+            reply = LauncherPipeHandled;
+        }
+    }
+    CATCH_LOG();
+
+    overlapped = {};
+    overlapped.hEvent = _ioComplete.get();
+    if (!_complete(WriteFile(_pipe.get(), &reply, sizeof(reply), nullptr, &overlapped), overlapped, _clientTimeout, transferred))
+    {
+        return;
+    }
+
+    // Disconnecting discards whatever the client hasn't read yet.
+    // The read fails with ERROR_BROKEN_PIPE once the client hung up.
+    auto ignored = uint8_t{ 0 };
+    overlapped = {};
+    overlapped.hEvent = _ioComplete.get();
+    _complete(ReadFile(_pipe.get(), &ignored, sizeof(ignored), nullptr, &overlapped), overlapped, _clientTimeout, transferred);
+}
+
+// Method Description:
+// - Splits a message into its working directory and commandline, and the
+//   latter into its arguments, the same way we would've split our own
+//   commandline, had wt.exe started us.
+Remoting::CommandlineArgs LauncherPipeServer::_parseMessage(const std::wstring_view message) const
+{
+    const auto separator = message.find(L'\0');
+    THROW_HR_IF(E_INVALIDARG, separator == std::wstring_view::npos);
+
+    const std::wstring cwd{ message.substr(0, separator) };
+    const std::wstring commandline{ message.substr(separator + 1) };
+
+    std::vector<winrt::hstring> args;
+    auto argc = 0;
+    wil::unique_any<LPWSTR*, decltype(&::LocalFree), ::LocalFree> argv{ CommandLineToArgvW(commandline.c_str(), &argc) };
+    THROW_LAST_ERROR_IF(!argv);
+    for (auto& elem : wil::make_range(argv.get(), argc))
+    {
+        args.emplace_back(elem);
+    }
+    if (args.empty())
+    {
+        args.emplace_back(L"wt.exe");
+    }
+
+    return Remoting::CommandlineArgs{ { args }, { cwd } };
+}
@@ -0,0 +1,42 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- LauncherPipeServer.h
+
+Abstract:
+- The monarch's end of the pipe that wt.exe forwards its commandline over
+  (see LauncherPipe.h). It serves one client at a time on a thread of its
+  own, and hands each commandline to the given handler, which returns true
+  if an existing window executed it.
+--*/
+
+#pragma once
+
+class LauncherPipeServer final
+{
+public:
+    using Handler = std::function<bool(const winrt::Microsoft::Terminal::Remoting::CommandlineArgs&)>;
+
+    explicit LauncherPipeServer(Handler handler);
+    ~LauncherPipeServer();
+
+    LauncherPipeServer(const LauncherPipeServer&) = delete;
+    LauncherPipeServer& operator=(const LauncherPipeServer&) = delete;
+
+private:
+    // How long a client may take to send its commandline or to hang up.
+    static constexpr DWORD _clientTimeout{ 1000 };
+
+    void _run() noexcept;
+    bool _complete(const BOOL started, OVERLAPPED& overlapped, const DWORD timeout, DWORD& transferred) noexcept;
+    void _serveClient();
+    winrt::Microsoft::Terminal::Remoting::CommandlineArgs _parseMessage(const std::wstring_view message) const;
+
+    Handler _handler;
+    wil::unique_hfile _pipe;
+    wil::unique_event _shutdown{ wil::EventOptions::ManualReset };
+    wil::unique_event _ioComplete{ wil::EventOptions::ManualReset };
+    std::thread _thread;
+};
@@ -0,0 +1,125 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "WindowThread.h"
+
+static bool _messageIsF7Keypress(const MSG& message)
+{
+    return (message.message == WM_KEYDOWN || message.message == WM_SYSKEYDOWN) && message.wParam == VK_F7;
+}
+static bool _messageIsAltKeyup(const MSG& message)
+{
+    return (message.message == WM_KEYUP || message.message == WM_SYSKEYUP) && message.wParam == VK_MENU;
+}
+static bool _messageIsAltSpaceKeypress(const MSG& message)
+{
+    return message.message == WM_SYSKEYDOWN && message.wParam == VK_SPACE;
+}
+
+// Method Description:
+// - Creates the AppHost, which will create both the window and the Terminal
+//   App, and initializes its Xaml content. This must be called on the thread
+//   that will run the window's message pump, after it was initialized as a
+//   single-threaded apartment.
+// Arguments:
+// - <none>
+// Return Value:
+// - false if we were told not to create a window, because the commandline
+//   was handed to another window.
+bool WindowThread::CreateHost()
+{
+    // The AppHost MUST BE constructed before the Xaml manager as TermApp
+    // provides an implementation of Windows.UI.Xaml.Application.
+    TraceLoggingWrite(
+        g_hWindowsTerminalProvider,
+        "AppHostCreateStarted",
+        TraceLoggingDescription("Event emitted before the AppHost is constructed"),
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+        TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+    _host = std::make_unique<AppHost>();
+    TraceLoggingWrite(
+        g_hWindowsTerminalProvider,
+        "AppHostCreateComplete",
+        TraceLoggingDescription("Event emitted after the AppHost was constructed"),
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+        TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+    if (!_host->HasWindow())
+    {
+        return false;
+    }
+
+    // Initialize the xaml content. This must be called AFTER the
+    // WindowsXamlManager is initialized.
+    TraceLoggingWrite(
+        g_hWindowsTerminalProvider,
+        "AppHostInitializeStarted",
+        TraceLoggingDescription("Event emitted before the Xaml content is initialized"),
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+        TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+    _host->Initialize();
+    TraceLoggingWrite(
+        g_hWindowsTerminalProvider,
+        "AppHostInitializeComplete",
+        TraceLoggingDescription("Event emitted after the Xaml content was initialized"),
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+        TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+    return true;
+}
+
+// Method Description:
+// - Runs the message pump of this thread until WM_QUIT is posted to it.
+// Arguments:
+// - <none>
+// Return Value:
+// - the exit code of the thread
+int WindowThread::RunMessagePump()
+{
+    MSG message;
+
+    while (GetMessage(&message, nullptr, 0, 0))
+    {
+        // GH#638 (Pressing F7 brings up both the history AND a caret browsing message)
+        // The Xaml input stack doesn't allow an application to suppress the "caret browsing"
+        // dialog experience triggered when you press F7. Official recommendation from the Xaml
+        // team is to catch F7 before we hand it off.
+        // AppLogic contains an ad-hoc implementation of event bubbling for a runtime classes
+        // implementing a custom IF7Listener interface.
+        // If the recipient of IF7Listener::OnF7Pressed suggests that the F7 press has, in fact,
+        // been handled we can discard the message before we even translate it.
+        if (_messageIsF7Keypress(message))
+        {
+            if (_host->OnDirectKeyEvent(VK_F7, LOBYTE(HIWORD(message.lParam)), true))
+            {
+                // The application consumed the F7. Don't let Xaml get it.
+                continue;
+            }
+        }
+
+        // GH#6421 - System XAML will never send an Alt KeyUp event. So, similar
+        // to how we'll steal the F7 KeyDown above, we'll steal the Alt KeyUp
+        // here, and plumb it through.
+        if (_messageIsAltKeyup(message))
+        {
+            // Let's pass <Alt> to the application
+            if (_host->OnDirectKeyEvent(VK_MENU, LOBYTE(HIWORD(message.lParam)), false))
+            {
+                // The application consumed the Alt. Don't let Xaml get it.
+                continue;
+            }
+        }
+
+        // GH#7125 = System XAML will show a system dialog on Alt Space. We want to
+        // explicitly prevent that because we handle that ourselves. So similar to
+        // above, we steal the event and hand it off to the host.
+        if (_messageIsAltSpaceKeypress(message))
+        {
+            _host->OnDirectKeyEvent(VK_SPACE, LOBYTE(HIWORD(message.lParam)), true);
+            continue;
+        }
+
+        TranslateMessage(&message);
+        DispatchMessage(&message);
+    }
+    return 0;
+}
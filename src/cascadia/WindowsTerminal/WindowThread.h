@@ -0,0 +1,26 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+//
+// Module Name:
+// - WindowThread.h
+//
+// Abstract:
+// - Owns the AppHost of a single window and runs the message pump of the
+//   thread the window lives on. Today every process has only one of them,
+//   on its main thread, but keeping all per-window state in here is the
+//   first step towards hosting several windows on their own threads of a
+//   single process (see doc/specs/drafts/Single process windows.md).
+
+#pragma once
+#include "pch.h"
+#include "AppHost.h"
+
+class WindowThread
+{
+public:
+    bool CreateHost();
+    int RunMessagePump();
+
+private:
+    std::unique_ptr<AppHost> _host;
+};
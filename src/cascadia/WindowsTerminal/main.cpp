@@ -2,7 +2,7 @@
 // Licensed under the MIT license.
 
 #include "pch.h"
-#include "AppHost.h"
+#include "WindowThread.h"
 #include "resource.h"
 #include "../types/inc/User32Utils.hpp"
 #include <WilErrorReporting.h>
@@ -83,19 +83,6 @@ static void EnsureNativeArchitecture()
     }
 }
 
-static bool _messageIsF7Keypress(const MSG& message)
-{
-    return (message.message == WM_KEYDOWN || message.message == WM_SYSKEYDOWN) && message.wParam == VK_F7;
-}
-static bool _messageIsAltKeyup(const MSG& message)
-{
-    return (message.message == WM_KEYUP || message.message == WM_SYSKEYUP) && message.wParam == VK_MENU;
-}
-static bool _messageIsAltSpaceKeypress(const MSG& message)
-{
-    return message.message == WM_SYSKEYDOWN && message.wParam == VK_SPACE;
-}
-
 int __stdcall wWinMain(HINSTANCE, HINSTANCE, LPWSTR, int)
 {
     TraceLoggingRegister(g_hWindowsTerminalProvider);
@@ -134,10 +121,9 @@ int __stdcall wWinMain(HINSTANCE, HINSTANCE, LPWSTR, int)
     winrt::init_apartment(winrt::apartment_type::single_threaded);
 
     // Create the AppHost object, which will create both the window and the
-    // Terminal App. This MUST BE constructed before the Xaml manager as TermApp
-    // provides an implementation of Windows.UI.Xaml.Application.
-    AppHost host;
-    if (!host.HasWindow())
+    // Terminal App, and run the window's message pump on this thread.
+    WindowThread thread;
+    if (!thread.CreateHost())
     {
         // If we were told to not have a window, exit early. Make sure to use
         // ExitProcess to die here. If you try just `return 0`, then
@@ -146,55 +132,5 @@ int __stdcall wWinMain(HINSTANCE, HINSTANCE, LPWSTR, int)
         ExitProcess(0);
     }
 
-    // Initialize the xaml content. This must be called AFTER the
-    // WindowsXamlManager is initialized.
-    host.Initialize();
-
-    MSG message;
-
-    while (GetMessage(&message, nullptr, 0, 0))
-    {
-        // GH#638 (Pressing F7 brings up both the history AND a caret browsing message)
-        // The Xaml input stack doesn't allow an application to suppress the "caret browsing"
-        // dialog experience triggered when you press F7. Official recommendation from the Xaml
-        // team is to catch F7 before we hand it off.
-        // AppLogic contains an ad-hoc implementation of event bubbling for a runtime classes
-        // implementing a custom IF7Listener interface.
-        // If the recipient of IF7Listener::OnF7Pressed suggests that the F7 press has, in fact,
-        // been handled we can discard the message before we even translate it.
-        if (_messageIsF7Keypress(message))
-        {
-            if (host.OnDirectKeyEvent(VK_F7, LOBYTE(HIWORD(message.lParam)), true))
-            {
-                // The application consumed the F7. Don't let Xaml get it.
-                continue;
-            }
-        }
-
-        // GH#6421 - System XAML will never send an Alt KeyUp event. So, similar
-        // to how we'll steal the F7 KeyDown above, we'll steal the Alt KeyUp
-        // here, and plumb it through.
-        if (_messageIsAltKeyup(message))
-        {
-            // Let's pass <Alt> to the application
-            if (host.OnDirectKeyEvent(VK_MENU, LOBYTE(HIWORD(message.lParam)), false))
-            {
-                // The application consumed the Alt. Don't let Xaml get it.
-                continue;
-            }
-        }
-
-        // GH#7125 = System XAML will show a system dialog on Alt Space. We want to
-        // explicitly prevent that because we handle that ourselves. So similar to
-        // above, we steal the event and hand it off to the host.
-        if (_messageIsAltSpaceKeypress(message))
-        {
-            host.OnDirectKeyEvent(VK_SPACE, LOBYTE(HIWORD(message.lParam)), true);
-            continue;
-        }
-
-        TranslateMessage(&message);
-        DispatchMessage(&message);
-    }
-    return 0;
+    return thread.RunMessagePump();
 }
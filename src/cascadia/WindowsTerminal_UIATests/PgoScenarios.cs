@@ -0,0 +1,255 @@
+//----------------------------------------------------------------------------------------------------------------------
+// <copyright file="PgoScenarios.cs" company="Microsoft">
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+// </copyright>
+// <summary>Scripted workloads that train the PGO databases on the hot paths of real terminal sessions.</summary>
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace WindowsTerminal.UIA.Tests
+{
+    using System;
+    using System.IO;
+    using System.Text;
+    using OpenQA.Selenium;
+    using OpenQA.Selenium.Appium;
+    using WEX.Logging.Interop;
+    using WEX.TestExecution.Markup;
+
+    using WindowsTerminal.UIA.Tests.Common;
+    using WindowsTerminal.UIA.Tests.Elements;
+
+    // Unlike the SmokeTests, which replay the recorded content files, these generate
+    // their output in the shell, so that they don't depend on the test content package.
+    // Every scenario is run with @IsPGO=true by the PGO instrumentation pipeline.
+    [TestClass]
+    public class PgoScenarios
+    {
+        // The fragment extension that RunSettingsManyProfiles installs its profiles with.
+        private const string FragmentSource = "WindowsTerminal.UIA.Tests";
+
+        public TestContext TestContext { get; set; }
+
+        [TestMethod]
+        [TestProperty("IsPGO", "true")]
+        public void RunBulkColoredOutput()
+        {
+            using (TerminalApp app = new TerminalApp(TestContext))
+            {
+                var root = app.GetRoot();
+
+                // 20k long lines in 8 colors, written in one go, like a verbose build log.
+                RunCommand(root, "$e = [char]27; $line = 'x' * 150; 1..20000 | % { \"$e[3$($_ % 8)m$_ $e[1m$line$e[m\" } | Out-Default");
+                System.Threading.Thread.Sleep(25000);
+            }
+        }
+
+        [TestMethod]
+        [TestProperty("IsPGO", "true")]
+        public void RunTuiRedraws()
+        {
+            using (TerminalApp app = new TerminalApp(TestContext))
+            {
+                var root = app.GetRoot();
+
+                // A full screen application in the alternate buffer: every frame moves the cursor around
+                // with CUP, repaints a status bar in reverse video and scrolls a region with DECSTBM.
+                RunCommand(root, "$e = [char]27; $r = New-Object Random 1; $sb = New-Object Text.StringBuilder; " +
+                                 "[Console]::Write(\"$e[?1049h$e[?25l$e[2;$([Console]::WindowHeight - 1)r\"); " +
+                                 "foreach ($f in 1..1500) { [void]$sb.Clear(); " +
+                                 "foreach ($i in 1..40) { [void]$sb.Append(\"$e[$($r.Next(2, [Console]::WindowHeight));$($r.Next(1, [Console]::WindowWidth - 10))H$e[38;5;$($r.Next(256))m$($r.Next())\") }; " +
+                                 "[void]$sb.Append(\"$e[1;1H$e[7m frame $f $e[K$e[m$e[$([Console]::WindowHeight - 1);1H`n\"); " +
+                                 "[Console]::Write($sb.ToString()) }; " +
+                                 "[Console]::Write(\"$e[r$e[?25h$e[?1049l\")");
+                System.Threading.Thread.Sleep(25000);
+            }
+        }
+
+        [TestMethod]
+        [TestProperty("IsPGO", "true")]
+        public void RunResizeReflow()
+        {
+            using (TerminalApp app = new TerminalApp(TestContext))
+            {
+                var root = app.GetRoot();
+
+                // Scrollback full of lines that wrap, which every resize has to reflow.
+                FillScrollback(root);
+
+                for (int i = 0; i < 3; ++i)
+                {
+                    // Toggling full screen and changing the font size both change the size of the buffer in cells.
+                    root.SendKeys(Keys.F11);
+                    Globals.WaitForLongTimeout();
+                    root.SendKeys(Keys.F11);
+                    Globals.WaitForLongTimeout();
+
+                    root.SendKeys(Keys.LeftControl + "=");
+                    Globals.WaitForTimeout();
+                    root.SendKeys(Keys.LeftControl + "=");
+                    Globals.WaitForLongTimeout();
+                    root.SendKeys(Keys.LeftControl + "-");
+                    Globals.WaitForTimeout();
+                    root.SendKeys(Keys.LeftControl + "-");
+                    Globals.WaitForTimeout();
+                    root.SendKeys(Keys.LeftControl + "-");
+                    Globals.WaitForLongTimeout();
+                    root.SendKeys(Keys.LeftControl + "0");
+                    Globals.WaitForLongTimeout();
+                }
+            }
+        }
+
+        [TestMethod]
+        [TestProperty("IsPGO", "true")]
+        public void RunSearchScrollback()
+        {
+            using (TerminalApp app = new TerminalApp(TestContext))
+            {
+                var root = app.GetRoot();
+
+                FillScrollback(root);
+
+                // Open the search box and search the whole scrollback a few times, in both directions.
+                root.SendKeys(Keys.LeftControl + Keys.LeftShift + "F");
+                Globals.WaitForLongTimeout();
+                root.SendKeys("lorem 12");
+                Globals.WaitForLongTimeout();
+                for (int i = 0; i < 20; ++i)
+                {
+                    root.SendKeys(Keys.Enter);
+                    Globals.WaitForTimeout();
+                }
+                for (int i = 0; i < 20; ++i)
+                {
+                    root.SendKeys(Keys.LeftShift + Keys.Enter);
+                    Globals.WaitForTimeout();
+                }
+
+                // A term without any match has to visit every row.
+                root.SendKeys(Keys.LeftControl + "a");
+                root.SendKeys("no such text");
+                Globals.WaitForLongTimeout();
+                root.SendKeys(Keys.Enter);
+                Globals.WaitForLongTimeout();
+                root.SendKeys(Keys.Escape);
+                Globals.WaitForLongTimeout();
+            }
+        }
+
+        [TestMethod]
+        [TestProperty("IsPGO", "true")]
+        public void RunSettingsManyProfiles()
+        {
+            var fragmentDirectory = Path.Combine(Environment.GetFolderPath(Environment.SpecialFolder.LocalApplicationData), @"Microsoft\Windows Terminal\Fragments", FragmentSource);
+            Directory.CreateDirectory(fragmentDirectory);
+            var fragmentPath = Path.Combine(fragmentDirectory, "profiles.json");
+            File.WriteAllText(fragmentPath, BuildProfilesFragment(200), new UTF8Encoding(false));
+            Log.Comment($"Installed a fragment with many profiles at '{fragmentPath}'");
+
+            try
+            {
+                using (TerminalApp app = new TerminalApp(TestContext))
+                {
+                    var root = app.GetRoot();
+
+                    // Opens tabs with the first few profiles, which resolves all of their inherited settings.
+                    for (int i = 1; i <= 9; ++i)
+                    {
+                        root.SendKeys(Keys.LeftControl + Keys.LeftShift + i.ToString());
+                        Globals.WaitForTimeout();
+                    }
+                    Globals.WaitForLongTimeout();
+
+                    // The settings UI builds a page for every profile in its navigation view.
+                    root.SendKeys(Keys.LeftControl + ",");
+                    Globals.WaitForLongTimeout();
+                    Globals.WaitForLongTimeout();
+                }
+            }
+            finally
+            {
+                File.Delete(fragmentPath);
+                Directory.Delete(fragmentDirectory);
+            }
+        }
+
+        [TestMethod]
+        [TestProperty("IsPGO", "true")]
+        public void RunPanesWithOutput()
+        {
+            using (TerminalApp app = new TerminalApp(TestContext))
+            {
+                var root = app.GetRoot();
+
+                // Four panes that all print at the same time, which are then resized, zoomed and closed.
+                root.SendKeys(Keys.LeftAlt + Keys.LeftShift + "+");
+                Globals.WaitForLongTimeout();
+                root.SendKeys(Keys.LeftAlt + Keys.LeftShift + "-");
+                Globals.WaitForLongTimeout();
+                root.SendKeys(Keys.LeftAlt + Keys.Left);
+                Globals.WaitForTimeout();
+                root.SendKeys(Keys.LeftAlt + Keys.LeftShift + "-");
+                Globals.WaitForLongTimeout();
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    RunCommand(root, "1..5000 | % { \"pane output $_ \" * 4 }");
+                    root.SendKeys(Keys.LeftAlt + (i % 2 == 0 ? Keys.Up : Keys.Right));
+                    Globals.WaitForTimeout();
+                }
+                System.Threading.Thread.Sleep(10000);
+
+                for (int i = 0; i < 5; ++i)
+                {
+                    root.SendKeys(Keys.LeftAlt + Keys.LeftShift + Keys.Left);
+                    Globals.WaitForTimeout();
+                    root.SendKeys(Keys.LeftAlt + Keys.LeftShift + Keys.Down);
+                    Globals.WaitForTimeout();
+                }
+                Globals.WaitForLongTimeout();
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    root.SendKeys(Keys.LeftControl + Keys.LeftShift + "W");
+                    Globals.WaitForLongTimeout();
+                }
+            }
+        }
+
+        private static void RunCommand(AppiumWebElement root, string command)
+        {
+            root.SendKeys(command);
+            root.SendKeys(Keys.Enter);
+        }
+
+        private static void FillScrollback(AppiumWebElement root)
+        {
+            // 9000 lines (the default history size), of which every other one wraps.
+            RunCommand(root, "1..9000 | % { if ($_ % 2) { \"lorem $_ \" * 30 } else { \"lorem $_\" } } | Out-Default");
+            System.Threading.Thread.Sleep(20000);
+        }
+
+        private static string BuildProfilesFragment(int count)
+        {
+            var json = new StringBuilder();
+            json.Append("{ \"profiles\": [");
+            for (int i = 0; i < count; ++i)
+            {
+                // A mix of the settings that real profiles commonly change.
+                json.Append(i == 0 ? "\n" : ",\n");
+                json.Append($"  {{ \"name\": \"PGO profile {i}\", \"commandline\": \"cmd.exe /k echo {i}\", \"startingDirectory\": \"%USERPROFILE%\"");
+                json.Append($", \"colorScheme\": \"{(i % 3 == 0 ? "Campbell" : i % 3 == 1 ? "One Half Dark" : "PGO scheme")}\"");
+                json.Append($", \"font\": {{ \"face\": \"{(i % 2 == 0 ? "Cascadia Mono" : "Consolas")}\", \"size\": {10 + i % 6} }}");
+                json.Append($", \"opacity\": {60 + i % 40}, \"cursorShape\": \"{(i % 2 == 0 ? "bar" : "filledBox")}\", \"historySize\": {1000 * (1 + i % 10)}");
+                json.Append(" }");
+            }
+            json.Append("\n], \"schemes\": [\n");
+            json.Append("  { \"name\": \"PGO scheme\", \"foreground\": \"#CCCCCC\", \"background\": \"#0C0C0C\", \"cursorColor\": \"#FFFFFF\", \"selectionBackground\": \"#FFFFFF\", ");
+            json.Append("\"black\": \"#0C0C0C\", \"red\": \"#C50F1F\", \"green\": \"#13A10E\", \"yellow\": \"#C19C00\", \"blue\": \"#0037DA\", \"purple\": \"#881798\", \"cyan\": \"#3A96DD\", \"white\": \"#CCCCCC\", ");
+            json.Append("\"brightBlack\": \"#767676\", \"brightRed\": \"#E74856\", \"brightGreen\": \"#16C60C\", \"brightYellow\": \"#F9F1A5\", \"brightBlue\": \"#3B78FF\", \"brightPurple\": \"#B4009E\", \"brightCyan\": \"#61D6D6\", \"brightWhite\": \"#F2F2F2\" }\n");
+            json.Append("] }\n");
+            return json.ToString();
+        }
+    }
+}
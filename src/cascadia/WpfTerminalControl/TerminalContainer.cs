@@ -117,6 +117,21 @@ namespace Microsoft.Terminal.Wpf
             }
         }
 
+        /// <summary>
+        /// Writes UTF-8 output into the terminal, bypassing the connection.
+        /// </summary>
+        /// <param name="data">The buffer containing the output.</param>
+        /// <param name="offset">The offset of the output in the buffer.</param>
+        /// <param name="count">The length of the output in bytes.</param>
+        /// <param name="plainText">True if the output contains no control sequences other than CR and LF.</param>
+        internal void WriteUtf8(byte[] data, int offset, int count, bool plainText)
+        {
+            if (this.terminal != IntPtr.Zero && count > 0)
+            {
+                Marshal.ThrowExceptionForHR((int)NativeMethods.TerminalSendOutputUtf8(this.terminal, ref data[offset], (UIntPtr)count, plainText));
+            }
+        }
+
         /// <summary>
         /// Manually invoke a scroll of the terminal buffer.
         /// </summary>
@@ -101,6 +101,29 @@ namespace Microsoft.Terminal.Wpf
             }
         }
 
+        /// <summary>
+        /// Writes UTF-8 output into the terminal, without converting it to a string first.
+        /// A UTF-8 sequence may be split between two calls.
+        /// </summary>
+        /// <param name="data">The buffer containing the output.</param>
+        /// <param name="offset">The offset of the output in the buffer.</param>
+        /// <param name="count">The length of the output in bytes.</param>
+        /// <param name="plainText">True if the output contains no control sequences other than CR and LF. It's then written without parsing it, which is faster.</param>
+        public void WriteUtf8(byte[] data, int offset, int count, bool plainText = false)
+        {
+            if (data == null)
+            {
+                throw new ArgumentNullException(nameof(data));
+            }
+
+            if (offset < 0 || count < 0 || count > data.Length - offset)
+            {
+                throw new ArgumentOutOfRangeException(nameof(count));
+            }
+
+            this.termContainer.WriteUtf8(data, offset, count, plainText);
+        }
+
         /// <summary>
         /// Gets the selected text in the terminal, clearing the selection. Otherwise returns an empty string.
         /// </summary>
@@ -0,0 +1,51 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- LauncherPipe.h
+
+Abstract:
+- The protocol wt.exe uses to hand its commandline to a running monarch,
+  instead of starting a WindowsTerminal.exe that would load XAML and the
+  settings only to find out that the commandline is meant for a window that
+  already exists.
+- The client writes a single message: The working directory, a NUL and the
+  commandline, which starts with the name of the executable. The server
+  replies with a single byte, LauncherPipeHandled if the commandline was
+  executed by an existing window. Anything else (or no reply at all) means
+  that the client needs to start a new WindowsTerminal.exe after all.
+- The name of the pipe depends on the branding, the session and on whether
+  the process is elevated, so that wt.exe only ever finds the monarch it'd
+  have found over COM.
+--*/
+
+#pragma once
+
+#include <wil/token_helpers.h>
+
+inline constexpr uint8_t LauncherPipeHandled{ 1 };
+inline constexpr DWORD LauncherPipeMaxMessageSize{ 64 * 1024 };
+
+inline std::wstring GetLauncherPipeName()
+{
+#if defined(WT_BRANDING_RELEASE)
+    std::wstring name{ L"\\\\.\\pipe\\WindowsTerminal" };
+#elif defined(WT_BRANDING_PREVIEW)
+    std::wstring name{ L"\\\\.\\pipe\\WindowsTerminalPreview" };
+#else
+    std::wstring name{ L"\\\\.\\pipe\\WindowsTerminalDev" };
+#endif
+
+    DWORD sessionId{ 0 };
+    THROW_IF_WIN32_BOOL_FALSE(ProcessIdToSessionId(GetCurrentProcessId(), &sessionId));
+    const auto elevated = wil::get_token_information<TOKEN_ELEVATION>(GetCurrentProcessToken()).TokenIsElevated != 0;
+
+    name.append(L"-Launcher-");
+    name.append(std::to_wstring(sessionId));
+    if (elevated)
+    {
+        name.append(L"-Admin");
+    }
+    return name;
+}
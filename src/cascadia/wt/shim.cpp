@@ -7,6 +7,92 @@
 #include <wil/resource.h>
 #include <wil/win32_helpers.h>
 
+#include "../inc/LauncherPipe.h"
+
+// Function Description:
+// - Hands the commandline to a running monarch, if there is one. That's a lot
+//   faster than starting a WindowsTerminal.exe, which would load XAML and
+//   the settings only to propose the commandline to the monarch itself.
+// - Before anything is sent, the other end of the pipe must prove that it's
+//   the WindowsTerminal.exe next to us, running as the same user as we are.
+// Arguments:
+// - terminal: The path to WindowsTerminal.exe.
+// - cmdline: Our commandline, starting with our name.
+// Return Value:
+// - true if an existing window executed the commandline. Otherwise we still
+//   need to start a new WindowsTerminal.exe, even if the monarch is running.
+static bool forwardToMonarch(const std::filesystem::path& terminal, const std::wstring& cmdline)
+try
+{
+    // SECURITY_IDENTIFICATION keeps the server from impersonating us.
+    wil::unique_hfile pipe{ CreateFileW(GetLauncherPipeName().c_str(),
+                                        GENERIC_READ | GENERIC_WRITE,
+                                        0,
+                                        nullptr,
+                                        OPEN_EXISTING,
+                                        SECURITY_SQOS_PRESENT | SECURITY_IDENTIFICATION,
+                                        nullptr) };
+    if (!pipe)
+    {
+        return false;
+    }
+
+    ULONG serverPid{ 0 };
+    if (!GetNamedPipeServerProcessId(pipe.get(), &serverPid))
+    {
+        return false;
+    }
+    wil::unique_handle server{ OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, serverPid) };
+    wil::unique_handle serverToken;
+    if (!server || !OpenProcessToken(server.get(), TOKEN_QUERY, serverToken.addressof()))
+    {
+        return false;
+    }
+
+    const auto ourUser = wil::get_token_information<TOKEN_USER>(GetCurrentProcessToken());
+    const auto serverUser = wil::get_token_information<TOKEN_USER>(serverToken.get());
+    if (!EqualSid(ourUser->User.Sid, serverUser->User.Sid))
+    {
+        return false;
+    }
+
+    const auto serverPath = wil::QueryFullProcessImageNameW<std::wstring>(server.get());
+    if (CompareStringOrdinal(serverPath.c_str(), -1, terminal.c_str(), -1, TRUE) != CSTR_EQUAL)
+    {
+        return false;
+    }
+
+    DWORD mode{ PIPE_READMODE_MESSAGE };
+    if (!SetNamedPipeHandleState(pipe.get(), &mode, nullptr, nullptr))
+    {
+        return false;
+    }
+
+    auto message{ wil::GetCurrentDirectoryW<std::wstring>() };
+    message.push_back(L'\0');
+    message.append(cmdline);
+    const auto messageSize = message.size() * sizeof(wchar_t);
+    if (messageSize > LauncherPipeMaxMessageSize)
+    {
+        return false;
+    }
+
+    DWORD transferred{ 0 };
+    if (!WriteFile(pipe.get(), message.data(), static_cast<DWORD>(messageSize), &transferred, nullptr))
+    {
+        return false;
+    }
+
+    auto reply = uint8_t{ 0 };
+    return ReadFile(pipe.get(), &reply, sizeof(reply), &transferred, nullptr) &&
+           transferred == sizeof(reply) &&
+           reply == LauncherPipeHandled;
+}
+catch (...)
+{
+    return false;
+}
+
 #pragma warning(suppress : 26461) // we can't change the signature of wWinMain
 int __stdcall wWinMain(HINSTANCE, HINSTANCE, LPWSTR pCmdLine, int)
 {
@@ -25,6 +111,11 @@ int __stdcall wWinMain(HINSTANCE, HINSTANCE, LPWSTR pCmdLine, int)
         return 1;
     }
 
+    if (forwardToMonarch(module, cmdline))
+    {
+        return 0;
+    }
+
     // Get our startup info so it can be forwarded
     STARTUPINFOW si{};
     si.cb = sizeof(si);
@@ -25,6 +25,8 @@ const std::wstring_view ConsoleArguments::FEATURE_ARG = L"--feature";
 const std::wstring_view ConsoleArguments::FEATURE_PTY_ARG = L"pty";
 const std::wstring_view ConsoleArguments::COM_SERVER_ARG = L"-Embedding";
 const std::wstring_view ConsoleArguments::PASSTHROUGH_ARG = L"--passthrough";
+const std::wstring_view ConsoleArguments::FRAME_DIFF_MODE = L"--framediff";
+const std::wstring_view ConsoleArguments::REPEAT_CHARACTER_MODE = L"--repeatchar";
 // NOTE: Thinking about adding more commandline args that control conpty, for
 // the Terminal? Make sure you add them to the commandline in
 // ConsoleEstablishHandoff. We use that to initialize the ConsoleArguments for a
@@ -521,6 +523,18 @@ void ConsoleArguments::s_ConsumeArg(_Inout_ std::vector<std::wstring>& args, _In
             s_ConsumeArg(args, i);
             hr = S_OK;
         }
+        else if (arg == FRAME_DIFF_MODE)
+        {
+            _frameDiffMode = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
+        else if (arg == REPEAT_CHARACTER_MODE)
+        {
+            _repeatCharacterMode = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
         else if (arg == CLIENT_COMMANDLINE_ARG)
         {
             // Everything after this is the explicit commandline
@@ -681,6 +695,14 @@ bool ConsoleArguments::IsWin32InputModeEnabled() const
 {
     return _win32InputMode;
 }
+bool ConsoleArguments::IsFrameDiffModeEnabled() const
+{
+    return _frameDiffMode;
+}
+bool ConsoleArguments::IsRepeatCharacterModeEnabled() const
+{
+    return _repeatCharacterMode;
+}
 
 #ifdef UNIT_TESTING
 // Method Description:
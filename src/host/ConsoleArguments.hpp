@@ -56,6 +56,8 @@ public:
     bool GetInheritCursor() const;
     bool IsResizeQuirkEnabled() const;
     bool IsWin32InputModeEnabled() const;
+    bool IsFrameDiffModeEnabled() const;
+    bool IsRepeatCharacterModeEnabled() const;
 
 #ifdef UNIT_TESTING
     void EnableConptyModeForTests();
@@ -79,6 +81,8 @@ public:
     static const std::wstring_view FEATURE_PTY_ARG;
     static const std::wstring_view COM_SERVER_ARG;
     static const std::wstring_view PASSTHROUGH_ARG;
+    static const std::wstring_view FRAME_DIFF_MODE;
+    static const std::wstring_view REPEAT_CHARACTER_MODE;
 
 private:
 #ifdef UNIT_TESTING
@@ -145,6 +149,8 @@ private:
     bool _inheritCursor;
     bool _resizeQuirk{ false };
     bool _win32InputMode{ false };
+    bool _frameDiffMode{ false };
+    bool _repeatCharacterMode{ false };
 
     [[nodiscard]] HRESULT _GetClientCommandline(_Inout_ std::vector<std::wstring>& args,
                                                 const size_t index,
@@ -149,6 +149,7 @@ void PtySignalInputThread::CreatePseudoWindow()
         {
             ResizeWindowData resizeMsg = { 0 };
             _GetData(&resizeMsg, sizeof(resizeMsg));
+            _CoalescePendingResizes(resizeMsg);
 
             LockConsole();
             auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
@@ -214,6 +215,49 @@ void PtySignalInputThread::_DoResizeWindow(const ResizeWindowData& data)
     }
 }
 
+// Method Description:
+// - Dragging the terminal's window border sends a flood of resize signals. Each of them
+//   resizes the buffer and causes a repaint of the entire viewport, which the terminal
+//   then has to parse again, even though all but the last size are already outdated.
+// - This skips over any resize signals that are already waiting in the pipe
+//   behind the current one, so that only the latest size gets applied.
+// Arguments:
+// - data - The size of the current resize signal. Replaced with the latest pending size.
+// Return Value:
+// - <none>
+void PtySignalInputThread::_CoalescePendingResizes(ResizeWindowData& data)
+{
+#pragma pack(push, 1)
+    struct
+    {
+        PtySignal signalId;
+        ResizeWindowData data;
+    } next;
+#pragma pack(pop)
+    // This has to match the packet written by ResizePseudoConsole.
+    static_assert(sizeof(next) == 3 * sizeof(unsigned short));
+
+    for (;;)
+    {
+        DWORD dwRead = 0;
+        // If the handle isn't a pipe, or the next signal isn't a resize (or hasn't
+        // fully arrived yet), this leaves it alone for the main loop to process.
+        if (!PeekNamedPipe(_hFile.get(), &next, sizeof(next), &dwRead, nullptr, nullptr) ||
+            dwRead != sizeof(next) ||
+            next.signalId != PtySignal::ResizeWindow)
+        {
+            return;
+        }
+
+        if (!_GetData(&next, sizeof(next)))
+        {
+            return;
+        }
+
+        data = next.data;
+    }
+}
+
 void PtySignalInputThread::_DoClearBuffer()
 {
     auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -9,29 +9,31 @@
 using namespace Microsoft::Console::Interactivity;
 
 // When someone attempts to use the console APIs to do a "read back"
-// of the console buffer, we have to give them **something**.
-// These two structures are just some gaudy-colored replacement character
-// text to give them data but represent they've done something that cannot
-// be supported under VT passthrough mode.
+// of the console buffer, we answer it from our own buffer, which we only
+// keep as a shadow of what the terminal displays. Output is forwarded to the
+// terminal as-is and only written into the shadow buffer once a read back
+// actually needs it (see _SyncShadowBuffer). VT-native clients never read
+// anything back and thus never pay for parsing their output twice.
 // ----
-// They can't be supported because in passthrough we maintain no internal
-// buffer to answer these questions, and there is no VT sequence that lets
-// us query the final terminal's buffer state. Even if a VT sequence did exist
-// (and we personally believe it shouldn't), there's a possibility that it would
-// read a massive amount of data and cause severe perf issues as applications coded
-// to this old API are likely leaning on it heavily and asking for this data in a
-// loop via VT would be a nightmare of parsing and formatting and over-the-wire transmission.
-
-static constexpr CHAR_INFO s_readBackUnicode{
-    { UNICODE_REPLACEMENT },
-    FOREGROUND_INTENSITY | FOREGROUND_RED | BACKGROUND_GREEN
-};
+// There is no VT sequence that lets us query the final terminal's buffer
+// state. Even if a VT sequence did exist (and we personally believe it
+// shouldn't), there's a possibility that it would read a massive amount of
+// data and cause severe perf issues as applications coded to this old API are
+// likely leaning on it heavily and asking for this data in a loop via VT would
+// be a nightmare of parsing and formatting and over-the-wire transmission.
+// ----
+// The attribute-only writes below can't be represented in VT. This structure
+// is just some gaudy-colored replacement character text for them.
 
 static constexpr CHAR_INFO s_readBackAscii{
     { L'?' },
     FOREGROUND_INTENSITY | FOREGROUND_RED | BACKGROUND_GREEN
 };
 
+// The amount of pending output after which we sync the shadow buffer anyway,
+// so that it can't grow without bounds for clients that never read anything back.
+static constexpr size_t s_pendingOutputLimit = 64 * 1024;
+
 VtApiRoutines::VtApiRoutines() :
     m_inputCodepage(ServiceLocator::LocateGlobals().getConsoleInformation().CP),
     m_outputCodepage(ServiceLocator::LocateGlobals().getConsoleInformation().OutputCP),
@@ -99,10 +101,169 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
     // TODO GH#10001: we only need to do this in cooked read mode.
     if (waiter)
     {
-        m_listeningForDSR = true;
-        (void)m_pVtEngine->_ListenForDSR();
-        (void)m_pVtEngine->RequestCursor();
+        _ListenForCursor();
+    }
+}
+
+// Routine Description:
+// - Asks the terminal for its cursor position. The answer arrives as a
+//   SetConsoleCursorPosition call while m_listeningForDSR is set.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtApiRoutines::_ListenForCursor() noexcept
+{
+    // The answer must account for any cursor move we've been holding back.
+    _EmitPendingCursor();
+    m_listeningForDSR = true;
+    (void)m_pVtEngine->_ListenForDSR();
+    (void)m_pVtEngine->RequestCursor();
+}
+
+// Routine Description:
+// - Remembers a cursor move for the terminal. It isn't written until
+//   there's output that depends on it, so that a series of moves
+//   without anything in between only costs a single CUP sequence.
+// Arguments:
+// - position - The new cursor position.
+// Return Value:
+// - <none>
+void VtApiRoutines::_MoveCursor(const til::point position) noexcept
+{
+    m_pendingCursorPosition = position;
+    _QueueFlush();
+}
+
+// Routine Description:
+// - Writes the cursor move that _MoveCursor held back, if any.
+//   Must be called before anything is written at the cursor position.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtApiRoutines::_EmitPendingCursor() noexcept
+{
+    if (m_pendingCursorPosition)
+    {
+        (void)m_pVtEngine->_CursorPosition(*m_pendingCursorPosition);
+        m_pendingCursorPosition.reset();
+    }
+}
+
+// Routine Description:
+// - Writes the SGR sequences for the given legacy attributes,
+//   unless they're what we've set last.
+// Arguments:
+// - attributes - The foreground and background colors as a legacy attribute.
+// Return Value:
+// - <none>
+void VtApiRoutines::_SetAttributes(const WORD attributes) noexcept
+{
+    if (m_lastAttributes == attributes)
+    {
+        return;
+    }
+
+    (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(attributes), true);
+    (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(attributes >> 4), false);
+    m_lastAttributes = attributes;
+    _QueueFlush();
+}
+
+void VtApiRoutines::_QueueFlush() noexcept
+{
+    m_flushPending = true;
+}
+
+// Routine Description:
+// - Writes all the output that the preceding API calls produced to the terminal.
+//   The IO thread calls this whenever it's done with a batch of messages, that is,
+//   before it releases the console lock or waits for the client. This way a client
+//   calling the console APIs in a tight loop causes a single write to the pipe
+//   instead of one per call.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtApiRoutines::FlushBatchedOutput() noexcept
+{
+    if (m_flushPending)
+    {
+        _EmitPendingCursor();
+        (void)m_pVtEngine->_Flush();
+        m_flushPending = false;
+    }
+}
+
+// Routine Description:
+// - Remembers output that was forwarded to the terminal, so that the shadow
+//   buffer can be caught up with it later.
+// Arguments:
+// - text - The text that was written to the terminal.
+// Return Value:
+// - <none>
+void VtApiRoutines::_QueueShadowOutput(const std::wstring_view text) noexcept
+try
+{
+    m_pendingOutput.append(text);
+    if (m_pendingOutput.size() > s_pendingOutputLimit)
+    {
+        _SyncShadowBuffer();
+    }
+}
+CATCH_LOG()
+
+// Routine Description:
+// - Runs a change to the shadow buffer, without any of it reaching the
+//   terminal. It has already received the equivalent VT from us.
+// Arguments:
+// - update - A callable that modifies the buffer and returns an HRESULT.
+// Return Value:
+// - <none>
+template<typename T>
+void VtApiRoutines::_UpdateShadowBuffer(T&& update) noexcept
+try
+{
+    auto& vtIo = *ServiceLocator::LocateGlobals().getConsoleInformation().GetVtIo();
+    vtIo.BeginShadowBufferSync();
+    const auto endSync = wil::scope_exit([&]() { vtIo.EndShadowBufferSync(); });
+    LOG_IF_FAILED(update());
+}
+CATCH_LOG()
+
+// Routine Description:
+// - Catches up the shadow buffer with all the output that the terminal
+//   received since the last time. Called before anything reads the buffer.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtApiRoutines::_SyncShadowBuffer() noexcept
+{
+    if (m_pendingOutput.empty())
+    {
+        return;
     }
+
+    _UpdateShadowBuffer([&]() {
+        auto& screenInfo = ServiceLocator::LocateGlobals().getConsoleInformation().GetActiveOutputBuffer();
+
+        // The client's VT needs to be interpreted the same way the terminal did,
+        // regardless of the output mode we pretend to have.
+        const auto outputMode = screenInfo.OutputMode;
+        WI_SetFlag(screenInfo.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+        const auto restoreMode = wil::scope_exit([&]() { screenInfo.OutputMode = outputMode; });
+
+        // If output is suspended right now, the terminal still got the text. We
+        // don't want to wait for it, so the waiter is dropped.
+        size_t read = 0;
+        std::unique_ptr<IWaitRoutine> waiter;
+        const auto hr = m_pUsualRoutines->WriteConsoleWImpl(screenInfo, m_pendingOutput, read, false, waiter);
+        return hr == CONSOLE_STATUS_WAIT ? S_OK : hr;
+    });
+
+    m_pendingOutput.clear();
 }
 
 [[nodiscard]] HRESULT VtApiRoutines::PeekConsoleInputAImpl(IConsoleInputObject& context,
@@ -117,12 +278,12 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
 }
 
 [[nodiscard]] HRESULT VtApiRoutines::PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                                           std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                                           const size_t eventsToRead,
+                                                           gsl::span<INPUT_RECORD> outRecords,
+                                                           size_t& eventsRead,
                                                            INPUT_READ_HANDLE_DATA& readHandleState,
                                                            std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
-    const auto hr = m_pUsualRoutines->PeekConsoleInputWImpl(context, outEvents, eventsToRead, readHandleState, waiter);
+    const auto hr = m_pUsualRoutines->PeekConsoleInputWImpl(context, outRecords, eventsRead, readHandleState, waiter);
     _SynchronizeCursor(waiter);
     return hr;
 }
@@ -139,12 +300,12 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
 }
 
 [[nodiscard]] HRESULT VtApiRoutines::ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                                           std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                                           const size_t eventsToRead,
+                                                           gsl::span<INPUT_RECORD> outRecords,
+                                                           size_t& eventsRead,
                                                            INPUT_READ_HANDLE_DATA& readHandleState,
                                                            std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
-    const auto hr = m_pUsualRoutines->ReadConsoleInputWImpl(context, outEvents, eventsToRead, readHandleState, waiter);
+    const auto hr = m_pUsualRoutines->ReadConsoleInputWImpl(context, outRecords, eventsRead, readHandleState, waiter);
     _SynchronizeCursor(waiter);
     return hr;
 }
@@ -166,9 +327,7 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
     // TODO GH10001: we only need to do this in cooked read mode.
     if (clientHandle)
     {
-        m_listeningForDSR = true;
-        (void)m_pVtEngine->_ListenForDSR();
-        (void)m_pVtEngine->RequestCursor();
+        _ListenForCursor();
     }
     return hr;
 }
@@ -190,9 +349,7 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
     // TODO GH10001: we only need to do this in cooked read mode.
     if (clientHandle)
     {
-        m_listeningForDSR = true;
-        (void)m_pVtEngine->_ListenForDSR();
-        (void)m_pVtEngine->RequestCursor();
+        _ListenForCursor();
     }
     return hr;
 }
@@ -203,16 +360,32 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
                                                        bool requiresVtQuirk,
                                                        std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
+    _EmitPendingCursor();
+
+    // The client's output may change the attributes on its own.
+    if (buffer.find('\x1b') != std::string_view::npos)
+    {
+        m_lastAttributes.reset();
+    }
+
     if (CP_UTF8 == m_outputCodepage)
     {
         (void)m_pVtEngine->WriteTerminalUtf8(buffer);
+
+        std::wstring text;
+        if (SUCCEEDED(til::u8u16(buffer, text, m_pendingOutputState)))
+        {
+            _QueueShadowOutput(text);
+        }
     }
     else
     {
-        (void)m_pVtEngine->WriteTerminalW(ConvertToW(m_outputCodepage, buffer));
+        const auto text = ConvertToW(m_outputCodepage, buffer);
+        (void)m_pVtEngine->WriteTerminalW(text);
+        _QueueShadowOutput(text);
     }
 
-    (void)m_pVtEngine->_Flush();
+    _QueueFlush();
     read = buffer.size();
     return S_OK;
 }
@@ -223,8 +396,17 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
                                                        bool requiresVtQuirk,
                                                        std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
+    _EmitPendingCursor();
+
+    // The client's output may change the attributes on its own.
+    if (buffer.find(L'\x1b') != std::wstring_view::npos)
+    {
+        m_lastAttributes.reset();
+    }
+
     (void)m_pVtEngine->WriteTerminalW(buffer);
-    (void)m_pVtEngine->_Flush();
+    _QueueFlush();
+    _QueueShadowOutput(buffer);
     read = buffer.size();
     return S_OK;
 }
@@ -240,11 +422,15 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
                                                                     const til::point startingCoordinate,
                                                                     size_t& cellsModified) noexcept
 {
-    (void)m_pVtEngine->_CursorPosition(startingCoordinate);
-    (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(attribute), true);
-    (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(attribute >> 4), false);
+    _MoveCursor(startingCoordinate);
+    _EmitPendingCursor();
+    _SetAttributes(attribute);
     (void)m_pVtEngine->_WriteFill(lengthToWrite, s_readBackAscii.Char.AsciiChar);
-    (void)m_pVtEngine->_Flush();
+
+    _SyncShadowBuffer();
+    _UpdateShadowBuffer([&]() {
+        return m_pUsualRoutines->FillConsoleOutputAttributeImpl(OutContext, attribute, lengthToWrite, startingCoordinate, cellsModified);
+    });
     cellsModified = lengthToWrite;
     return S_OK;
 }
@@ -259,9 +445,14 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
     // we may as well skip a lot of conversion work and just write it out.
     if (m_outputCodepage == CP_UTF8 && character <= 0x7F)
     {
-        (void)m_pVtEngine->_CursorPosition(startingCoordinate);
+        _MoveCursor(startingCoordinate);
+        _EmitPendingCursor();
         (void)m_pVtEngine->_WriteFill(lengthToWrite, character);
-        (void)m_pVtEngine->_Flush();
+
+        _SyncShadowBuffer();
+        _UpdateShadowBuffer([&]() {
+            return m_pUsualRoutines->FillConsoleOutputCharacterAImpl(OutContext, character, lengthToWrite, startingCoordinate, cellsModified);
+        });
         cellsModified = lengthToWrite;
         return S_OK;
     }
@@ -279,7 +470,8 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
                                                                      size_t& cellsModified,
                                                                      const bool enablePowershellShim) noexcept
 {
-    (void)m_pVtEngine->_CursorPosition(startingCoordinate);
+    _MoveCursor(startingCoordinate);
+    _EmitPendingCursor();
     const std::wstring_view sv{ &character, 1 };
 
     // TODO GH10001: horrible. it'll WC2MB over and over...we should do that once then emit... and then rep...
@@ -289,7 +481,10 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
         (void)m_pVtEngine->WriteTerminalW(sv);
     }
 
-    (void)m_pVtEngine->_Flush();
+    _SyncShadowBuffer();
+    _UpdateShadowBuffer([&]() {
+        return m_pUsualRoutines->FillConsoleOutputCharacterWImpl(OutContext, character, lengthToWrite, startingCoordinate, cellsModified, enablePowershellShim);
+    });
     cellsModified = lengthToWrite;
     return S_OK;
 }
@@ -334,7 +529,7 @@ void VtApiRoutines::GetConsoleCursorInfoImpl(const SCREEN_INFORMATION& context,
                                                               const bool isVisible) noexcept
 {
     isVisible ? (void)m_pVtEngine->_ShowCursor() : (void)m_pVtEngine->_HideCursor();
-    (void)m_pVtEngine->_Flush();
+    _QueueFlush();
     return S_OK;
 }
 
@@ -342,7 +537,9 @@ void VtApiRoutines::GetConsoleCursorInfoImpl(const SCREEN_INFORMATION& context,
 void VtApiRoutines::GetConsoleScreenBufferInfoExImpl(const SCREEN_INFORMATION& context,
                                                      CONSOLE_SCREEN_BUFFER_INFOEX& data) noexcept
 {
-    // TODO GH10001: this is technically full of potentially incorrect data. do we care? should we store it in here with set?
+    // The cursor position is the part of this that clients actually rely on.
+    // TODO GH10001: the rest is technically full of potentially incorrect data. do we care? should we store it in here with set?
+    _SyncShadowBuffer();
     return m_pUsualRoutines->GetConsoleScreenBufferInfoExImpl(context, data);
 }
 
@@ -350,13 +547,12 @@ void VtApiRoutines::GetConsoleScreenBufferInfoExImpl(const SCREEN_INFORMATION& c
                                                                       const CONSOLE_SCREEN_BUFFER_INFOEX& data) noexcept
 {
     (void)m_pVtEngine->_ResizeWindow(data.srWindow.Right - data.srWindow.Left, data.srWindow.Bottom - data.srWindow.Top);
-    (void)m_pVtEngine->_CursorPosition(til::wrap_coord(data.dwCursorPosition));
-    (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(data.wAttributes), true);
-    (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(data.wAttributes >> 4), false);
+    _MoveCursor(til::wrap_coord(data.dwCursorPosition));
+    _SetAttributes(data.wAttributes);
     //color table?
     // popup attributes... hold internally?
     // TODO GH10001: popups are gonna erase the stuff behind them... deal with that somehow.
-    (void)m_pVtEngine->_Flush();
+    _QueueFlush();
     return S_OK;
 }
 
@@ -372,13 +568,15 @@ void VtApiRoutines::GetConsoleScreenBufferInfoExImpl(const SCREEN_INFORMATION& c
 {
     if (m_listeningForDSR)
     {
+        // The terminal's answer accounts for all the output so far. Make sure
+        // that catching up the shadow buffer later doesn't move the cursor again.
+        _SyncShadowBuffer();
         context.GetActiveBuffer().GetTextBuffer().GetCursor().SetPosition(position);
         m_pVtEngine->SetTerminalCursorTextPosition(position);
     }
     else
     {
-        (void)m_pVtEngine->_CursorPosition(position);
-        (void)m_pVtEngine->_Flush();
+        _MoveCursor(position);
     }
     return S_OK;
 }
@@ -416,9 +614,7 @@ void VtApiRoutines::GetLargestConsoleWindowSizeImpl(const SCREEN_INFORMATION& co
 [[nodiscard]] HRESULT VtApiRoutines::SetConsoleTextAttributeImpl(SCREEN_INFORMATION& context,
                                                                  const WORD attribute) noexcept
 {
-    (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(attribute), true);
-    (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(attribute >> 4), false);
-    (void)m_pVtEngine->_Flush();
+    _SetAttributes(attribute);
     return S_OK;
 }
 
@@ -427,7 +623,7 @@ void VtApiRoutines::GetLargestConsoleWindowSizeImpl(const SCREEN_INFORMATION& co
                                                               const til::inclusive_rect& windowRect) noexcept
 {
     (void)m_pVtEngine->_ResizeWindow(windowRect.Right - windowRect.Left + 1, windowRect.Bottom - windowRect.Top + 1);
-    (void)m_pVtEngine->_Flush();
+    _QueueFlush();
     return S_OK;
 }
 
@@ -436,9 +632,8 @@ void VtApiRoutines::GetLargestConsoleWindowSizeImpl(const SCREEN_INFORMATION& co
                                                                     gsl::span<WORD> buffer,
                                                                     size_t& written) noexcept
 {
-    std::fill_n(buffer.data(), buffer.size(), s_readBackUnicode.Attributes); // should be same as the ascii one.
-    written = buffer.size();
-    return S_OK;
+    _SyncShadowBuffer();
+    return m_pUsualRoutines->ReadConsoleOutputAttributeImpl(context, origin, buffer, written);
 }
 
 [[nodiscard]] HRESULT VtApiRoutines::ReadConsoleOutputCharacterAImpl(const SCREEN_INFORMATION& context,
@@ -446,9 +641,8 @@ void VtApiRoutines::GetLargestConsoleWindowSizeImpl(const SCREEN_INFORMATION& co
                                                                      gsl::span<char> buffer,
                                                                      size_t& written) noexcept
 {
-    std::fill_n(buffer.data(), buffer.size(), s_readBackAscii.Char.AsciiChar);
-    written = buffer.size();
-    return S_OK;
+    _SyncShadowBuffer();
+    return m_pUsualRoutines->ReadConsoleOutputCharacterAImpl(context, origin, buffer, written);
 }
 
 [[nodiscard]] HRESULT VtApiRoutines::ReadConsoleOutputCharacterWImpl(const SCREEN_INFORMATION& context,
@@ -456,9 +650,8 @@ void VtApiRoutines::GetLargestConsoleWindowSizeImpl(const SCREEN_INFORMATION& co
                                                                      gsl::span<wchar_t> buffer,
                                                                      size_t& written) noexcept
 {
-    std::fill_n(buffer.data(), buffer.size(), s_readBackUnicode.Char.UnicodeChar);
-    written = buffer.size();
-    return S_OK;
+    _SyncShadowBuffer();
+    return m_pUsualRoutines->ReadConsoleOutputCharacterWImpl(context, origin, buffer, written);
 }
 
 [[nodiscard]] HRESULT VtApiRoutines::WriteConsoleInputAImpl(InputBuffer& context,
@@ -505,14 +698,15 @@ extern HRESULT _ConvertCellsToWInplace(const UINT codepage,
 
     while (pos < buffer.size())
     {
-        (void)m_pVtEngine->_CursorPosition(cursor);
+        _MoveCursor(cursor);
+        _EmitPendingCursor();
 
         const auto subspan = buffer.subspan(pos, width);
 
         for (const auto& ci : subspan)
         {
-            (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(ci.Attributes), true);
-            (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(ci.Attributes >> 4), false);
+            // Runs of cells with the same attributes only get a single SGR.
+            _SetAttributes(ci.Attributes);
             (void)m_pVtEngine->WriteTerminalW(std::wstring_view{ &ci.Char.UnicodeChar, 1 });
         }
 
@@ -520,7 +714,10 @@ extern HRESULT _ConvertCellsToWInplace(const UINT codepage,
         pos += width;
     }
 
-    (void)m_pVtEngine->_Flush();
+    _SyncShadowBuffer();
+    _UpdateShadowBuffer([&]() {
+        return m_pUsualRoutines->WriteConsoleOutputWImpl(context, buffer, requestRectangle, writtenRectangle);
+    });
 
     //TODO GH10001: trim to buffer size?
     writtenRectangle = requestRectangle;
@@ -532,16 +729,19 @@ extern HRESULT _ConvertCellsToWInplace(const UINT codepage,
                                                                      const til::point target,
                                                                      size_t& used) noexcept
 {
-    (void)m_pVtEngine->_CursorPosition(target);
+    _MoveCursor(target);
+    _EmitPendingCursor();
 
     for (const auto& attr : attrs)
     {
-        (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(attr), true);
-        (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(attr >> 4), false);
+        _SetAttributes(attr);
         (void)m_pVtEngine->WriteTerminalUtf8(std::string_view{ &s_readBackAscii.Char.AsciiChar, 1 });
     }
 
-    (void)m_pVtEngine->_Flush();
+    _SyncShadowBuffer();
+    _UpdateShadowBuffer([&]() {
+        return m_pUsualRoutines->WriteConsoleOutputAttributeImpl(OutContext, attrs, target, used);
+    });
 
     used = attrs.size();
     return S_OK;
@@ -554,9 +754,14 @@ extern HRESULT _ConvertCellsToWInplace(const UINT codepage,
 {
     if (m_outputCodepage == CP_UTF8)
     {
-        (void)m_pVtEngine->_CursorPosition(target);
+        _MoveCursor(target);
+        _EmitPendingCursor();
         (void)m_pVtEngine->WriteTerminalUtf8(text);
-        (void)m_pVtEngine->_Flush();
+
+        _SyncShadowBuffer();
+        _UpdateShadowBuffer([&]() {
+            return m_pUsualRoutines->WriteConsoleOutputCharacterAImpl(OutContext, text, target, used);
+        });
         return S_OK;
     }
     else
@@ -570,9 +775,14 @@ extern HRESULT _ConvertCellsToWInplace(const UINT codepage,
                                                                       const til::point target,
                                                                       size_t& used) noexcept
 {
-    (void)m_pVtEngine->_CursorPosition(target);
+    _MoveCursor(target);
+    _EmitPendingCursor();
     (void)m_pVtEngine->WriteTerminalW(text);
-    (void)m_pVtEngine->_Flush();
+
+    _SyncShadowBuffer();
+    _UpdateShadowBuffer([&]() {
+        return m_pUsualRoutines->WriteConsoleOutputCharacterWImpl(OutContext, text, target, used);
+    });
     return S_OK;
 }
 
@@ -581,9 +791,8 @@ extern HRESULT _ConvertCellsToWInplace(const UINT codepage,
                                                             const Microsoft::Console::Types::Viewport& sourceRectangle,
                                                             Microsoft::Console::Types::Viewport& readRectangle) noexcept
 {
-    std::fill_n(buffer.data(), buffer.size(), s_readBackAscii);
-    // TODO GH10001: do we need to constrict readRectangle to within the known buffer size... probably.
-    return S_OK;
+    _SyncShadowBuffer();
+    return m_pUsualRoutines->ReadConsoleOutputAImpl(context, buffer, sourceRectangle, readRectangle);
 }
 
 [[nodiscard]] HRESULT VtApiRoutines::ReadConsoleOutputWImpl(const SCREEN_INFORMATION& context,
@@ -591,9 +800,8 @@ extern HRESULT _ConvertCellsToWInplace(const UINT codepage,
                                                             const Microsoft::Console::Types::Viewport& sourceRectangle,
                                                             Microsoft::Console::Types::Viewport& readRectangle) noexcept
 {
-    std::fill_n(buffer.data(), buffer.size(), s_readBackUnicode);
-    // TODO GH10001: do we need to constrict readRectangle to within the known buffer size... probably.
-    return S_OK;
+    _SyncShadowBuffer();
+    return m_pUsualRoutines->ReadConsoleOutputWImpl(context, buffer, sourceRectangle, readRectangle);
 }
 
 [[nodiscard]] HRESULT VtApiRoutines::GetConsoleTitleAImpl(gsl::span<char> title,
@@ -664,7 +872,7 @@ extern HRESULT _ConvertCellsToWInplace(const UINT codepage,
 [[nodiscard]] HRESULT VtApiRoutines::SetConsoleTitleWImpl(const std::wstring_view title) noexcept
 {
     (void)m_pVtEngine->UpdateTitle(title);
-    (void)m_pVtEngine->_Flush();
+    _QueueFlush();
     return S_OK;
 }
 
@@ -59,8 +59,8 @@ public:
                                                 std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
     [[nodiscard]] HRESULT PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                                std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                                const size_t eventsToRead,
+                                                gsl::span<INPUT_RECORD> outRecords,
+                                                size_t& eventsRead,
                                                 INPUT_READ_HANDLE_DATA& readHandleState,
                                                 std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
@@ -71,8 +71,8 @@ public:
                                                 std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
     [[nodiscard]] HRESULT ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                                std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                                const size_t eventsToRead,
+                                                gsl::span<INPUT_RECORD> outRecords,
+                                                size_t& eventsRead,
                                                 INPUT_READ_HANDLE_DATA& readHandleState,
                                                 std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
@@ -387,6 +387,31 @@ public:
     bool m_listeningForDSR;
     Microsoft::Console::Render::Xterm256Engine* m_pVtEngine;
 
+    void FlushBatchedOutput() noexcept;
+
 private:
     void _SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) noexcept;
+    void _ListenForCursor() noexcept;
+
+    void _MoveCursor(const til::point position) noexcept;
+    void _EmitPendingCursor() noexcept;
+    void _SetAttributes(const WORD attributes) noexcept;
+    void _QueueFlush() noexcept;
+
+    void _QueueShadowOutput(const std::wstring_view text) noexcept;
+    void _SyncShadowBuffer() noexcept;
+    template<typename T>
+    void _UpdateShadowBuffer(T&& update) noexcept;
+
+    // Output that was already forwarded to the terminal, but that hasn't been
+    // written into our own buffer yet. See _SyncShadowBuffer.
+    std::wstring m_pendingOutput;
+    til::u8state m_pendingOutputState;
+
+    // Output is only flushed to the terminal once per batch of messages,
+    // see FlushBatchedOutput. Until then, consecutive cursor moves collapse
+    // into the last one and attributes that are already set are skipped.
+    std::optional<til::point> m_pendingCursorPosition;
+    std::optional<WORD> m_lastAttributes;
+    bool m_flushPending{ false };
 };
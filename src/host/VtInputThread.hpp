@@ -42,6 +42,11 @@ namespace Microsoft::Console
         std::function<void(bool)> _pfnSetLookingForDSR;
 
         std::unique_ptr<Microsoft::Console::VirtualTerminal::StateMachine> _pInputStateMachine;
-        til::u8state _u8State;
+
+        // Pastes can be megabytes large. Reading them in big chunks means that
+        // they get parsed and written to the input buffer (and any pending
+        // cooked read gets woken up) once per chunk instead of every 256 bytes.
+        static constexpr size_t _readBufferSize = 64 * 1024;
+        std::unique_ptr<char[]> _readBuffer;
     };
 }
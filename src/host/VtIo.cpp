@@ -74,6 +74,8 @@ VtIo::VtIo() :
     _resizeQuirk = pArgs->IsResizeQuirkEnabled();
     _win32InputMode = pArgs->IsWin32InputModeEnabled();
     _passthroughMode = pArgs->IsPassthroughMode();
+    _frameDiffMode = pArgs->IsFrameDiffModeEnabled();
+    _repeatCharacterMode = pArgs->IsRepeatCharacterModeEnabled();
 
     // If we were already given VT handles, set up the VT IO engine to use those.
     if (pArgs->InConptyMode())
@@ -179,6 +181,7 @@ VtIo::VtIo() :
                         }
 
                         globals.api = vtapi;
+                        _pVtApiRoutines = vtapi;
                     }
                 }
 
@@ -217,6 +220,8 @@ VtIo::VtIo() :
             {
                 _pVtRenderEngine->SetTerminalOwner(this);
                 _pVtRenderEngine->SetResizeQuirk(_resizeQuirk);
+                _pVtRenderEngine->SetFrameDiffMode(_frameDiffMode);
+                _pVtRenderEngine->SetRepeatCharacterMode(_repeatCharacterMode);
             }
         }
     }
@@ -425,6 +430,12 @@ void VtIo::CloseInput()
 
 void VtIo::CloseOutput()
 {
+    // The VT renderer writes its frames outside of the console lock and might call us from there.
+    // SetTerminalConnection() below needs the lock, and it needs to be acquired before
+    // the _shutdownLock, just like when we're called from within a paint.
+    LockConsole();
+    auto unlock = wil::scope_exit([] { UnlockConsole(); });
+
     // This will release the lock when it goes out of scope
     std::lock_guard<std::mutex> lk(_shutdownLock);
 
@@ -553,3 +564,64 @@ bool VtIo::IsResizeQuirkEnabled() const
     }
     return S_OK;
 }
+
+// Method Description:
+// - In passthrough mode, the client's output goes straight to the terminal and
+//   only gets written into our buffer later, when a legacy API needs to read
+//   it back (see VtApiRoutines). While we're catching up our buffer like that,
+//   the terminal has already seen everything, so nothing may reach the
+//   terminal again: no repaints, no passed through sequences and no responses
+//   to queries the terminal already answered.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtIo::BeginShadowBufferSync()
+{
+    _syncingShadowBuffer = true;
+
+    auto& g = ServiceLocator::LocateGlobals();
+    g.getConsoleInformation().GetActiveOutputBuffer().SetTerminalConnection(nullptr);
+    if (_pVtRenderEngine)
+    {
+        _pVtRenderEngine->SuppressInvalidation(true);
+    }
+}
+
+// Method Description:
+// - Ends the scope started by BeginShadowBufferSync.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtIo::EndShadowBufferSync()
+{
+    auto& g = ServiceLocator::LocateGlobals();
+    if (_pVtRenderEngine)
+    {
+        _pVtRenderEngine->SuppressInvalidation(false);
+        g.getConsoleInformation().GetActiveOutputBuffer().SetTerminalConnection(_pVtRenderEngine.get());
+    }
+
+    _syncingShadowBuffer = false;
+}
+
+bool VtIo::IsSyncingShadowBuffer() const noexcept
+{
+    return _syncingShadowBuffer;
+}
+
+// Method Description:
+// - Called by the IO thread after it serviced a batch of messages. In passthrough mode,
+//   this writes the output that the API calls of the batch produced to the terminal.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtIo::FlushBatchedOutput() noexcept
+{
+    if (_pVtApiRoutines)
+    {
+        _pVtApiRoutines->FlushBatchedOutput();
+    }
+}
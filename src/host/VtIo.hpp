@@ -9,6 +9,7 @@
 #include "PtySignalInputThread.hpp"
 
 class ConsoleArguments;
+class VtApiRoutines;
 
 namespace Microsoft::Console::Render
 {
@@ -52,6 +53,12 @@ namespace Microsoft::Console::VirtualTerminal
 
         [[nodiscard]] HRESULT ManuallyClearScrollback() const noexcept;
 
+        void BeginShadowBufferSync();
+        void EndShadowBufferSync();
+        bool IsSyncingShadowBuffer() const noexcept;
+
+        void FlushBatchedOutput() noexcept;
+
         void CreatePseudoWindow();
 
     private:
@@ -71,10 +78,15 @@ namespace Microsoft::Console::VirtualTerminal
         bool _resizeQuirk{ false };
         bool _win32InputMode{ false };
         bool _passthroughMode{ false };
+        bool _frameDiffMode{ false };
+        bool _repeatCharacterMode{ false };
+        bool _syncingShadowBuffer{ false };
 
         std::unique_ptr<Microsoft::Console::Render::VtEngine> _pVtRenderEngine;
         std::unique_ptr<Microsoft::Console::VtInputThread> _pVtInputThread;
         std::unique_ptr<Microsoft::Console::PtySignalInputThread> _pPtySignalInputThread;
+        // Owned by the globals, as its api.
+        VtApiRoutines* _pVtApiRoutines{ nullptr };
 
         [[nodiscard]] HRESULT _Initialize(const HANDLE InHandle, const HANDLE OutHandle, const std::wstring& VtMode, _In_opt_ const HANDLE SignalHandle);
 
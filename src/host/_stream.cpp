@@ -28,6 +28,39 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
 // Used by WriteCharsLegacy.
 #define IS_GLYPH_CHAR(wch) (((wch) >= L' ') && ((wch) != 0x007F))
 
+// Routine Description:
+// - Returns the length of the run of characters at the start of the given string,
+//   that WriteCharsLegacy can write as is, because each of them occupies exactly one cell.
+//   That's any printable ASCII character and, if the output isn't processed, ASCII
+//   control characters as well. Unicode characters might be wide or need font fallback
+//   to be measured and are left to the per-character loop.
+// Arguments:
+// - text - the characters yet to be written.
+// - maxLength - the number of characters that fit into the rest of the row.
+// - fUnprocessed - whether ENABLE_PROCESSED_OUTPUT is clear.
+// Return Value:
+// - The number of characters of the run, at most maxLength.
+static size_t _FindSimpleRun(const std::wstring_view text, const size_t maxLength, const bool fUnprocessed) noexcept
+{
+    const auto limit = std::min(text.size(), maxLength);
+    size_t n = 0;
+    if (fUnprocessed)
+    {
+        while (n < limit && til::at(text, n) < 0x80)
+        {
+            ++n;
+        }
+    }
+    else
+    {
+        while (n < limit && til::at(text, n) >= L' ' && til::at(text, n) < 0x7F)
+        {
+            ++n;
+        }
+    }
+    return n;
+}
+
 // Routine Description:
 // - This routine updates the cursor position.  Its input is the non-special
 //   cased new location of the cursor.  For example, if the cursor were being
@@ -388,7 +421,31 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
         XPosition = cursor.GetPosition().X;
         til::CoordType i = 0;
         auto LocalBufPtr = LocalBuffer;
-        while (*pcb < BufferSize && i < LOCAL_BUFFER_SIZE && XPosition < coordScreenBufferSize.X)
+        const wchar_t* runStart = LocalBuffer;
+        auto collectChars = true;
+
+        // Most output consists of long runs of plain ASCII text, which don't need to be copied
+        // into LocalBuffer character by character: They're written straight from the given string
+        // and the cursor is wrapped and scrolled once per run. Everything else (control characters,
+        // wide glyphs, etc.) goes through the regular loop below.
+        {
+            const auto remaining = (BufferSize - *pcb) / sizeof(WCHAR);
+            const auto columns = gsl::narrow_cast<size_t>(std::max(0, coordScreenBufferSize.X - XPosition));
+            const auto run = _FindSimpleRun({ lpString, remaining }, columns, fUnprocessed);
+            if (run != 0)
+            {
+                runStart = lpString;
+                i = gsl::narrow_cast<til::CoordType>(run);
+                XPosition += i;
+                lpString += run;
+                pwchRealUnicode += run;
+                pwchBuffer += run;
+                *pcb += run * sizeof(WCHAR);
+                collectChars = false;
+            }
+        }
+
+        while (collectChars && *pcb < BufferSize && i < LOCAL_BUFFER_SIZE && XPosition < coordScreenBufferSize.X)
         {
 #pragma prefast(suppress : 26019, "Buffer is taken in multiples of 2. Validation is ok.")
             const auto Char = *lpString;
@@ -553,7 +610,7 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
             }
 
             // line was wrapped if we're writing up to the end of the current row
-            OutputCellIterator it(std::wstring_view(LocalBuffer, i), Attributes);
+            OutputCellIterator it(std::wstring_view(runStart, i), Attributes);
             const auto itEnd = screenInfo.Write(it);
 
             // Notify accessibility
@@ -1048,16 +1105,20 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
         restoreVtQuirk.release();
     }
 
-    const auto& textBuffer = screenInfo.GetTextBuffer();
-    return WriteChars(screenInfo,
-                      pwchBuffer,
-                      pwchBuffer,
-                      pwchBuffer,
-                      pcbBuffer,
-                      nullptr,
-                      textBuffer.GetCursor().GetPosition().X,
-                      WC_LIMIT_BACKSPACE,
-                      nullptr);
+    auto& textBuffer = screenInfo.GetTextBuffer();
+    const auto status = WriteChars(screenInfo,
+                                   pwchBuffer,
+                                   pwchBuffer,
+                                   pwchBuffer,
+                                   pcbBuffer,
+                                   nullptr,
+                                   textBuffer.GetCursor().GetPosition().X,
+                                   WC_LIMIT_BACKSPACE,
+                                   nullptr);
+
+    // The output might have switched to the alternate screen buffer.
+    screenInfo.GetActiveBuffer().GetTextBuffer().CompactAttributeTable();
+    return status;
 }
 
 // Routine Description:
@@ -1145,20 +1206,28 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
         const auto codepage{ consoleInfo.OutputCP };
         auto leadByteCaptured{ false };
         auto leadByteConsumed{ false };
-        std::wstring wstr{};
-        static til::u8state u8State{};
+        auto& wstr{ screenInfo.WriteConsoleBuffer };
+
+        // Don't hold on to the memory of an unusually large write forever.
+        static constexpr size_t maxRetainedCapacity{ 64 * 1024 };
+        const auto trimBuffer{ wil::scope_exit([&] {
+            if (wstr.capacity() > maxRetainedCapacity)
+            {
+                wstr = {};
+            }
+        }) };
 
         // Convert our input parameters to Unicode
         if (codepage == CP_UTF8)
         {
-            RETURN_IF_FAILED(til::u8u16(buffer, wstr, u8State));
+            RETURN_IF_FAILED(til::u8u16(buffer, wstr, screenInfo.WriteConsoleUtf8State));
             read = buffer.size();
         }
         else
         {
             // In case the codepage changes from UTF-8 to another,
             // we discard partials that might still be cached.
-            u8State.reset();
+            screenInfo.WriteConsoleUtf8State.reset();
 
             int mbPtrLength{};
             RETURN_IF_FAILED(SizeTToInt(buffer.size(), &mbPtrLength));
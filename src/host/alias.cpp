@@ -1142,54 +1142,54 @@ std::wstring Alias::s_MatchAndCopyAlias(const std::wstring& sourceText,
                                         const std::wstring& exeName,
                                         size_t& lineCount)
 {
-    // Copy source text into a local for manipulation.
-    auto sourceCopy = sourceText;
-
-    // Trim trailing \r\n off of sourceCopy if it has one.
-    s_TrimTrailingCrLf(sourceCopy);
-
-    // Trim leading spaces off of sourceCopy if it has any.
-    s_TrimLeadingSpaces(sourceCopy);
-
     // Check if we have an EXE in the list that matches the request first.
-    auto exeIter = g_aliasData.find(exeName);
-    if (exeIter == g_aliasData.end())
+    // This runs for every cooked read line and most EXEs have no aliases at all,
+    // so this is done before anything else touches the text.
+    const auto exeIter = g_aliasData.find(exeName);
+    if (exeIter == g_aliasData.end() || exeIter->second.empty())
     {
         // We found no data for this exe. Give back an empty string.
         return std::wstring();
     }
 
-    auto exeList = exeIter->second;
-    if (exeList.size() == 0)
-    {
-        // If there's no match, give back an empty string.
-        return std::wstring();
-    }
-
-    // Tokenize the text by spaces
-    const auto tokens = s_Tokenize(sourceCopy);
+    const auto& exeList = exeIter->second;
 
-    // If there are no tokens, return an empty string
-    if (tokens.size() == 0)
+    // Find the alias name without copying the text. It's the first space separated
+    // token after trimming the text the same way it's trimmed for the expansion below.
+    std::wstring_view sourceView{ sourceText };
+    if (const auto trailingCrLfPos = sourceView.find_last_of(UNICODE_CARRIAGERETURN); trailingCrLfPos != std::wstring_view::npos)
     {
-        return std::wstring();
+        sourceView = sourceView.substr(0, trailingCrLfPos);
     }
+    sourceView.remove_prefix(std::find_if(sourceView.begin(), sourceView.end(), [](wchar_t ch) { return !std::iswspace(ch); }) - sourceView.begin());
+    const auto alias = sourceView.substr(0, sourceView.find(L' '));
 
     // Find alias. If there isn't one, return an empty string
-    const auto alias = tokens.front();
-    const auto aliasIter = exeList.find(alias);
+    const auto aliasIter = exeList.find(std::wstring{ alias });
     if (aliasIter == exeList.end())
     {
         // We found no alias pair with this name. Give back an empty string.
         return std::wstring();
     }
 
-    const auto target = aliasIter->second;
+    const auto& target = aliasIter->second;
     if (target.size() == 0)
     {
         return std::wstring();
     }
 
+    // We have a hit. Only now copy the source text into a local for manipulation.
+    auto sourceCopy = sourceText;
+
+    // Trim trailing \r\n off of sourceCopy if it has one.
+    s_TrimTrailingCrLf(sourceCopy);
+
+    // Trim leading spaces off of sourceCopy if it has any.
+    s_TrimLeadingSpaces(sourceCopy);
+
+    // Tokenize the text by spaces
+    const auto tokens = s_Tokenize(sourceCopy);
+
     // Get the string of all parameters as a shorthand for $* later.
     const auto allParams = s_GetArgString(sourceCopy);
 
@@ -10,6 +10,7 @@
 
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../types/inc/convert.hpp"
+#include "../types/inc/LockProfiler.hpp"
 
 #include <til/ticket_lock.h>
 
@@ -58,6 +59,8 @@ CONSOLE_INFORMATION::CONSOLE_INFORMATION() :
 // the caller makes sure to properly call Unlock() once for each Lock().
 static thread_local ULONG recursionCount = 0;
 static til::ticket_lock lock;
+// Reports long waits for and long holds of the lock to the Microsoft.Windows.Console.Locks provider.
+static Microsoft::Console::Types::LockProfiler lockProfiler{ "Console" };
 
 bool CONSOLE_INFORMATION::IsConsoleLocked()
 {
@@ -65,14 +68,16 @@ bool CONSOLE_INFORMATION::IsConsoleLocked()
 }
 
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
-void CONSOLE_INFORMATION::LockConsole()
+__declspec(noinline) void CONSOLE_INFORMATION::LockConsole()
 {
     // See description of recursionCount a few lines above.
     const auto rc = ++recursionCount;
     FAIL_FAST_IF(rc == 0);
     if (rc == 1)
     {
+        const auto waitStart = lockProfiler.BeginWait();
         lock.lock();
+        lockProfiler.AcquiredExclusive(waitStart, _ReturnAddress());
     }
 }
 
@@ -84,6 +89,7 @@ void CONSOLE_INFORMATION::UnlockConsole()
     FAIL_FAST_IF(rc == ULONG_MAX);
     if (rc == 0)
     {
+        lockProfiler.ReleasingExclusive();
         lock.unlock();
     }
 }
@@ -398,11 +404,8 @@ void CONSOLE_INFORMATION::ShutdownMidiAudio()
 {
     if (_midiAudio)
     {
-        // We lock the console here to make sure the shutdown promise is
-        // set before the audio is unlocked in the thread that is playing.
-        LockConsole();
+        // Any notes that are still queued up are dropped.
         _midiAudio->Shutdown();
-        UnlockConsole();
     }
 }
 
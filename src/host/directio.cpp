@@ -249,6 +249,61 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     }
 }
 
+// Routine Description:
+// - This is the Unicode version of _DoGetConsoleInput. Since the records don't
+//   need to be converted, they're copied straight into the client's buffer.
+// Arguments:
+// - inputBuffer - Buffer to read from
+// - outRecords - The client's buffer to fill
+// - eventsRead - On output, the number of records copied into outRecords
+// - readHandleState - Input read handle data associated with this read operation
+// - IsPeek - If this is a peek operation (a.k.a. do not remove
+// characters from the input buffer while copying to client buffer.)
+// - waiter - If we have to wait (not enough data to fill client
+// buffer), this contains context that will allow the server to
+// restore this call later.
+// Return Value:
+// - STATUS_SUCCESS - If data was found and ready for return to the client.
+// - CONSOLE_STATUS_WAIT - If we didn't have enough data or needed to
+// block, this will be returned along with context in waiter.
+// - Or an out of memory/math/string error message in NTSTATUS format.
+[[nodiscard]] static NTSTATUS _DoGetConsoleInputW(InputBuffer& inputBuffer,
+                                                  const gsl::span<INPUT_RECORD> outRecords,
+                                                  size_t& eventsRead,
+                                                  INPUT_READ_HANDLE_DATA& readHandleState,
+                                                  const bool IsPeek,
+                                                  std::unique_ptr<IWaitRoutine>& waiter) noexcept
+{
+    try
+    {
+        waiter.reset();
+        eventsRead = 0;
+
+        if (outRecords.empty())
+        {
+            return STATUS_SUCCESS;
+        }
+
+        LockConsole();
+        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
+        const auto Status = inputBuffer.Read(outRecords, eventsRead, IsPeek, true);
+        if (CONSOLE_STATUS_WAIT == Status)
+        {
+            // There are no partial byte sequences in Unicode reads.
+            waiter = std::make_unique<DirectReadData>(&inputBuffer,
+                                                      &readHandleState,
+                                                      outRecords.size(),
+                                                      std::deque<std::unique_ptr<IInputEvent>>{});
+        }
+        return Status;
+    }
+    catch (...)
+    {
+        return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+    }
+}
+
 // Routine Description:
 // - Retrieves input records from the given input object and returns them to the client.
 // - The peek version will NOT remove records when it copies them out.
@@ -295,8 +350,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // - The W version accepts UCS-2 formatted characters (wide characters)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
-// - eventsToRead - The number of input events to read
+// - outRecords - The client's buffer the records are copied into
+// - eventsRead - On output, the number of records that were copied
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
 // handle. Primarily used to restore the "other piece" of partially
@@ -306,20 +361,19 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // buffer), this contains context that will allow the server to
 // restore this call later.
 [[nodiscard]] HRESULT ApiRoutines::PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                                         std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                                         const size_t eventsToRead,
+                                                         gsl::span<INPUT_RECORD> outRecords,
+                                                         size_t& eventsRead,
                                                          INPUT_READ_HANDLE_DATA& readHandleState,
                                                          std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
     try
     {
-        auto Status = _DoGetConsoleInput(context,
-                                         outEvents,
-                                         eventsToRead,
-                                         readHandleState,
-                                         true,
-                                         true,
-                                         waiter);
+        auto Status = _DoGetConsoleInputW(context,
+                                          outRecords,
+                                          eventsRead,
+                                          readHandleState,
+                                          true,
+                                          waiter);
         if (CONSOLE_STATUS_WAIT == Status)
         {
             return HRESULT_FROM_NT(Status);
@@ -375,8 +429,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // - The W version accepts UCS-2 formatted characters (wide characters)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
-// - eventsToRead - The number of input events to read
+// - outRecords - The client's buffer the records are copied into
+// - eventsRead - On output, the number of records that were copied
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
 // handle. Primarily used to restore the "other piece" of partially
@@ -386,20 +440,19 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // buffer), this contains context that will allow the server to
 // restore this call later.
 [[nodiscard]] HRESULT ApiRoutines::ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                                         std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                                         const size_t eventsToRead,
+                                                         gsl::span<INPUT_RECORD> outRecords,
+                                                         size_t& eventsRead,
                                                          INPUT_READ_HANDLE_DATA& readHandleState,
                                                          std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
     try
     {
-        auto Status = _DoGetConsoleInput(context,
-                                         outEvents,
-                                         eventsToRead,
-                                         readHandleState,
-                                         true,
-                                         false,
-                                         waiter);
+        auto Status = _DoGetConsoleInputW(context,
+                                          outRecords,
+                                          eventsRead,
+                                          readHandleState,
+                                          false,
+                                          waiter);
         if (CONSOLE_STATUS_WAIT == Status)
         {
             return HRESULT_FROM_NT(Status);
@@ -509,9 +562,26 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 
     try
     {
-        auto events = IInputEvent::Create(buffer);
+        // The input buffer stores records by value, so they can be handed over as is,
+        // as long as they are of a type that the rest of the console knows how to read.
+        const auto isKnownEventType = [](const INPUT_RECORD& record) noexcept {
+            switch (record.EventType)
+            {
+            case KEY_EVENT:
+            case MOUSE_EVENT:
+            case WINDOW_BUFFER_SIZE_EVENT:
+            case MENU_EVENT:
+            case FOCUS_EVENT:
+                return true;
+            default:
+                return false;
+            }
+        };
+        RETURN_HR_IF(E_INVALIDARG, !std::all_of(buffer.begin(), buffer.end(), isKnownEventType));
 
-        return _WriteConsoleInputWImplHelper(context, events, written, append);
+        written = append ? context.Write(buffer) : context.Prepend(buffer);
+
+        return S_OK;
     }
     CATCH_RETURN();
 }
@@ -742,7 +812,6 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 {
     try
     {
-        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
         const auto& storageBuffer = context.GetActiveBuffer();
         const auto storageSize = storageBuffer.GetBufferSize().Dimensions();
 
@@ -779,41 +848,44 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 
         // We will start reading the buffer at the point of the top left corner (origin) of the (potentially adjusted) request
         const auto sourcePoint = clippedRequestRectangle.Origin();
-
-        // Get an iterator to the beginning of the return buffer
-        // We might have to seek this forward or skip around if we clipped the request.
-        auto targetIter = targetBuffer.begin();
-        til::point targetPos;
-        const auto targetLimit = Viewport::FromDimensions(targetPoint, clippedRequestRectangle.Dimensions());
-
-        // Get an iterator to the beginning of the request inside the screen buffer
-        // This should walk exactly along every cell of the clipped request.
-        auto sourceIter = storageBuffer.GetCellDataAt(sourcePoint, clippedRequestRectangle);
-
-        // Walk through every cell of the target, advancing the buffer.
-        // Validate that we always still have a valid iterator to the backing store,
-        // that we always are writing inside the user's buffer (before the end)
-        // and we're always targeting the user's buffer inside its original bounds.
-        while (sourceIter && targetIter < targetBuffer.end())
+        const auto& textBuffer = storageBuffer.GetTextBuffer();
+        const auto clippedWidth = clippedRequestRectangle.Width();
+
+        // Copy the clipped request one row span at a time straight out of the CharRow and ATTR_ROW
+        // of each row. The attribute runs are walked alongside the columns, so that the legacy
+        // attributes only need to be computed once per run instead of once per cell.
+        // Cells of the user's buffer outside of the clipped request are left untouched.
+        for (til::CoordType y = 0; y < clippedRequestRectangle.Height(); ++y)
         {
-            // If the point we're trying to write is inside the limited buffer write zone...
-            if (targetLimit.IsInBounds(targetPos))
+            const auto targetOffset = gsl::narrow_cast<size_t>(targetPoint.Y + y) * targetSize.X + targetPoint.X;
+            if (targetOffset >= targetBuffer.size())
             {
-                // Copy the data into position...
-                *targetIter = gci.AsCharInfo(*sourceIter);
-                // ... and advance the read iterator.
-                sourceIter++;
+                break;
             }
 
-            // Always advance the write iterator, we might have skipped it due to clipping.
-            targetIter++;
+            const auto target = targetBuffer.subspan(targetOffset, std::min<size_t>(clippedWidth, targetBuffer.size() - targetOffset));
+            const auto& row = textBuffer.GetRowByOffset(sourcePoint.Y + y);
+            const auto& charRow = row.GetCharRow();
+            const auto& attrRow = row.GetAttrRow();
+
+            auto column = sourcePoint.X;
+            auto runEnd = 0;
+            WORD legacyAttributes = 0;
+            auto run = attrRow.GetRuns().begin();
 
-            // Increment the target
-            targetPos.X++;
-            if (targetPos.X >= targetSize.X)
+            for (auto& ci : target)
             {
-                targetPos.X = 0;
-                targetPos.Y++;
+                // Advance to the run containing the current column.
+                while (runEnd <= column)
+                {
+                    runEnd += run->length;
+                    legacyAttributes = attrRow.GetAttrById(run->value).GetLegacyAttributes();
+                    ++run;
+                }
+
+                ci.Char.UnicodeChar = Utf16ToUcs2(charRow.GlyphAt(column));
+                ci.Attributes = legacyAttributes | charRow.DbcsAttrAt(column).GeneratePublicApiAttributeFormat();
+                ++column;
             }
         }
 
@@ -963,6 +1035,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
             storageBuffer.Write(it, target);
         }
 
+        storageBuffer.GetTextBuffer().CompactAttributeTable();
+
         // Since we've managed to write part of the request, return the clamped part that we actually used.
         writtenRectangle = writeRectangle;
 
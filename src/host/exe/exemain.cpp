@@ -8,6 +8,7 @@
 #include "../server/Entrypoints.h"
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../inc/conint.h"
+#include "../types/inc/AllocationTracker.hpp"
 
 #if TIL_FEATURE_RECEIVEINCOMINGHANDOFF_ENABLED
 #include "CConsoleHandoff.h"
@@ -224,6 +225,9 @@ int CALLBACK wWinMain(
 
     ConsoleCheckDebug();
 
+    // Debug builds assert the first time a hot path exceeds its allocation budget.
+    Microsoft::Console::Types::AllocationTracker::AssertOnOverBudget(true);
+
     // Set up OutOfProc COM server stuff in case we become one.
     // WRL Module gets going right before winmain is called, so if we don't
     // set this up appropriately... other things using WRL that aren't us
@@ -13,6 +13,113 @@
 #include "../getset.h"
 #include <til/u8u16convert.h>
 
+// The slow input mode times how long the state machine and AdaptDispatch take
+// per byte of input, instead of writing it with WriteCharsLegacy, which doesn't
+// parse VT at all. It's enabled by setting CONHOST_FUZZ_SLOW_INPUTS to the
+// directory to save inputs with a pathological cost in. These are raw UTF-8
+// output, which vtbench takes as recordings, so they can be added to its corpus.
+// CONHOST_FUZZ_SLOW_NS_PER_BYTE overrides the threshold for saving an input.
+namespace
+{
+    struct SlowInputMode
+    {
+        std::filesystem::path directory;
+        double thresholdNsPerByte = 2000;
+        // Short inputs are mostly measuring the timer.
+        std::chrono::nanoseconds minimumDuration{ std::chrono::milliseconds{ 1 } };
+    };
+    std::optional<SlowInputMode> g_slowInputs;
+
+    // Without an inline counter per cost bucket, libFuzzer would only ever see
+    // the coverage of an input, and would throw away most of those that just
+    // take longer. Every power of 2 of nanoseconds per byte gets its own function
+    // here, so that an input that reaches a new one counts as new coverage.
+    constexpr size_t CostBuckets = 24;
+    std::array<uint64_t, CostBuckets> g_costBucketHits{};
+
+    template<size_t N>
+    __declspec(noinline) void CostBucket() noexcept
+    {
+        ++til::at(g_costBucketHits, N);
+    }
+
+    template<size_t... N>
+    constexpr std::array<void (*)() noexcept, sizeof...(N)> MakeCostBuckets(std::index_sequence<N...>) noexcept
+    {
+        return { &CostBucket<N>... };
+    }
+
+    void ReachCostBucket(const double nsPerByte) noexcept
+    {
+        static constexpr auto buckets = MakeCostBuckets(std::make_index_sequence<CostBuckets>{});
+        size_t bucket = 0;
+        for (auto cost = nsPerByte; cost >= 2 && bucket + 1 < CostBuckets; cost /= 2)
+        {
+            ++bucket;
+        }
+        til::at(buckets, bucket)();
+    }
+
+    std::wstring GetEnvironmentString(const wchar_t* name)
+    {
+        std::wstring value(GetEnvironmentVariableW(name, nullptr, 0), L'\0');
+        value.resize(GetEnvironmentVariableW(name, value.data(), gsl::narrow_cast<DWORD>(value.size())));
+        return value;
+    }
+
+    void InitializeSlowInputMode()
+    {
+        const auto directory = GetEnvironmentString(L"CONHOST_FUZZ_SLOW_INPUTS");
+        if (directory.empty())
+        {
+            return;
+        }
+
+        SlowInputMode mode;
+        mode.directory = directory;
+        std::filesystem::create_directories(mode.directory);
+        if (const auto threshold = GetEnvironmentString(L"CONHOST_FUZZ_SLOW_NS_PER_BYTE"); !threshold.empty())
+        {
+            mode.thresholdNsPerByte = std::max(1.0, _wtof(threshold.c_str()));
+        }
+        g_slowInputs = std::move(mode);
+    }
+
+    // Function Description:
+    // - Parses and dispatches the input with the state machine of the active
+    //   buffer, and saves it if it took longer than the threshold per byte.
+    void ProcessSlowInput(SCREEN_INFORMATION& screenInfo, const std::string_view input, const std::wstring_view u16String)
+    {
+        auto& stateMachine = screenInfo.GetStateMachine();
+        // Every input starts in the ground state, so that its cost doesn't
+        // depend on a sequence that the previous one didn't terminate.
+        stateMachine.ResetState();
+
+        const auto start = std::chrono::steady_clock::now();
+        stateMachine.ProcessString(u16String);
+        const auto duration = std::chrono::steady_clock::now() - start;
+
+        const auto nsPerByte = std::chrono::duration<double, std::nano>{ duration }.count() / std::max<size_t>(1, input.size());
+        ReachCostBucket(nsPerByte);
+        if (nsPerByte < g_slowInputs->thresholdNsPerByte || duration < g_slowInputs->minimumDuration)
+        {
+            return;
+        }
+
+        // Named after the contents, so that an input that's found again overwrites itself.
+        const auto name = fmt::format(L"slow-{:016x}.txt", til::hash_bytes(input.data(), input.size()));
+        const auto path = g_slowInputs->directory / name;
+        std::ofstream file{ path, std::ios::binary };
+        file.write(input.data(), gsl::narrow_cast<std::streamsize>(input.size()));
+        fwprintf(stderr,
+                 L"slow input: %zu bytes in %.3f ms, %.0f ns/byte, saved as %s\n",
+                 input.size(),
+                 std::chrono::duration<double, std::milli>{ duration }.count(),
+                 nsPerByte,
+                 path.c_str());
+    }
+}
+
 struct NullDeviceComm : public IDeviceComm
 {
     HRESULT SetServerInformation(CD_IO_SERVER_INFORMATION* const) const override
@@ -26,6 +133,10 @@ struct NullDeviceComm : public IDeviceComm
         SuspendThread(GetCurrentThread());
         return S_FALSE;
     }
+    HRESULT TryReadIo(PCONSOLE_API_MSG const, CONSOLE_API_MSG* const) const override
+    {
+        return S_FALSE;
+    }
     HRESULT CompleteIo(CD_IO_COMPLETE* const) const override
     {
         return S_FALSE;
@@ -82,7 +193,9 @@ struct NullDeviceComm : public IDeviceComm
 
     CONSOLE_API_CONNECTINFO fakeConnectInfo{};
     fakeConnectInfo.ConsoleInfo.SetShowWindow(SW_NORMAL);
-    fakeConnectInfo.ConsoleInfo.SetScreenBufferSize({ 80, 25 });
+    // Erasing and filling the buffer is only expensive if the buffer is large,
+    // which is why the slow input mode uses the history size of the Terminal.
+    fakeConnectInfo.ConsoleInfo.SetScreenBufferSize({ 80, g_slowInputs ? 9001 : 25 });
     fakeConnectInfo.ConsoleInfo.SetWindowSize({ 80, 25 });
     fakeConnectInfo.ConsoleInfo.SetStartupFlags(STARTF_USECOUNTCHARS);
     wcscpy_s(fakeConnectInfo.Title, fakeTitle.data());
@@ -108,6 +221,7 @@ extern "C" __declspec(dllexport) HRESULT RunConhost()
     // but for now we want to drive it like conhost
     ConsoleArguments args({}, nullptr, nullptr);
 
+    InitializeSlowInputMode();
     auto hr = args.ParseCommandline();
     if (SUCCEEDED(hr))
     {
@@ -136,6 +250,11 @@ extern "C" __declspec(dllexport) int LLVMFuzzerTestOneInput(const uint8_t* data,
     auto sizeInBytes{ u16String.size() * 2 };
     gci.LockConsole();
     auto u = wil::scope_exit([&]() { gci.UnlockConsole(); });
+    if (g_slowInputs)
+    {
+        ProcessSlowInput(gci.GetActiveOutputBuffer(), { reinterpret_cast<const char*>(data), size }, u16String);
+        return 0;
+    }
     (void)WriteCharsLegacy(gci.GetActiveOutputBuffer(),
                            u16String.data(),
                            u16String.data(),
@@ -27,6 +27,8 @@ class BufferTests
     TEST_METHOD(ScrollLargeBufferPerformance);
 
     TEST_METHOD(ChafaGifPerformance);
+
+    TEST_METHOD(ReadWriteConsoleOutputPerformance);
 };
 
 void BufferTests::TestSetConsoleActiveScreenBufferInvalid()
@@ -194,6 +196,50 @@ void BufferTests::ScrollLargeBufferPerformance()
     Log::Comment(String().Format(L"%d calls took %d ms. Avg %d ms per call", count, delta, delta / count));
 }
 
+void BufferTests::ReadWriteConsoleOutputPerformance()
+{
+    // Screen readers and legacy TUI frameworks transfer the entire viewport many times per second.
+
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const auto Out = GetStdHandle(STD_OUTPUT_HANDLE);
+
+    CONSOLE_SCREEN_BUFFER_INFO Info;
+    VERIFY_WIN32_BOOL_SUCCEEDED(GetConsoleScreenBufferInfo(Out, &Info));
+
+    const COORD size{ static_cast<SHORT>(Info.srWindow.Right - Info.srWindow.Left + 1), static_cast<SHORT>(Info.srWindow.Bottom - Info.srWindow.Top + 1) };
+    std::vector<CHAR_INFO> written(static_cast<size_t>(size.X) * size.Y);
+    for (size_t i = 0; i < written.size(); ++i)
+    {
+        // Alternate the colors every few cells, so that the rows consist of many attribute runs.
+        written[i].Char.UnicodeChar = static_cast<wchar_t>(L'!' + i % 64);
+        written[i].Attributes = static_cast<WORD>((i / 7) % 16);
+    }
+    std::vector<CHAR_INFO> read(written.size());
+
+    const auto count = 200;
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i != count; ++i)
+    {
+        auto region = Info.srWindow;
+        VERIFY_WIN32_BOOL_SUCCEEDED(WriteConsoleOutputW(Out, written.data(), size, {}, &region));
+        region = Info.srWindow;
+        VERIFY_WIN32_BOOL_SUCCEEDED(ReadConsoleOutputW(Out, read.data(), size, {}, &region));
+    }
+
+    const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+    Log::Comment(String().Format(L"%d round trips of %dx%d cells took %d ms. Avg %d ms per round trip", count, size.X, size.Y, delta, delta / count));
+
+    for (size_t i = 0; i < written.size(); ++i)
+    {
+        VERIFY_ARE_EQUAL(written[i].Char.UnicodeChar, read[i].Char.UnicodeChar);
+        VERIFY_ARE_EQUAL(written[i].Attributes, read[i].Attributes);
+    }
+}
+
 void BufferTests::ChafaGifPerformance()
 {
     BEGIN_TEST_METHOD_PROPERTIES()
@@ -119,6 +119,7 @@ void CommandHistory::_Reset()
             // find free record.  if all records are used, free the lru one.
             if ((SHORT)_commands.size() == _maxCommands)
             {
+                _IndexErase(0);
                 _commands.erase(_commands.cbegin());
                 // move LastDisplayed back one in order to stay synced with the
                 // command it referred to before erasing the lru one
@@ -134,6 +135,7 @@ void CommandHistory::_Reset()
             {
                 _commands.emplace_back(newCommand);
             }
+            _IndexInsert(gsl::narrow<SHORT>(_commands.size() - 1));
 
             if (LastDisplayed == -1 ||
                 _commands.at(LastDisplayed).size() != newCommand.size() ||
@@ -244,6 +246,7 @@ std::wstring_view CommandHistory::GetLastCommand() const
 void CommandHistory::Empty()
 {
     _commands.clear();
+    _sortedCommands.clear();
     LastDisplayed = -1;
     WI_SetFlag(Flags, CLE_RESET);
 }
@@ -285,6 +288,7 @@ void CommandHistory::Realloc(const size_t commands)
     {
         _commands.emplace_back(oldCommands[i]);
     }
+    _IndexRebuild();
 
     WI_SetFlag(Flags, CLE_RESET);
     LastDisplayed = gsl::narrow<SHORT>(_commands.size()) - 1;
@@ -387,6 +391,7 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
         if (!SameApp)
         {
             BestCandidate->_commands.clear();
+            BestCandidate->_sortedCommands.clear();
             BestCandidate->LastDisplayed = -1;
             BestCandidate->_appName = appName;
         }
@@ -469,6 +474,7 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
 
         if (iDel < iLast)
         {
+            _IndexErase(iDel);
             _commands.erase(_commands.cbegin() + iDel);
             if ((iDisp > iDel) && (iDisp <= iLast))
             {
@@ -478,6 +484,7 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
         }
         else if (iFirst <= iDel)
         {
+            _IndexErase(iDel);
             _commands.erase(_commands.cbegin() + iDel);
             if ((iDisp >= iFirst) && (iDisp < iDel))
             {
@@ -522,25 +529,97 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
         return true;
     }
 
-    try
+    const auto size = gsl::narrow<SHORT>(_commands.size());
+    if (indexFound < 0 || indexFound >= size)
+    {
+        return false;
+    }
+
+    // All commands starting with givenCommand follow each other in _sortedCommands, beginning
+    // with those that are equal to it. Out of these we want the one that the user would reach
+    // first when going back from indexFound (wrapping around to the last one after the first one).
+    const auto exactMatch = WI_IsFlagSet(options, MatchOptions::ExactMatch);
+    auto bestDistance = size;
+
+    for (auto it = _IndexRange(givenCommand).first; it != _sortedCommands.end(); ++it)
     {
-        for (size_t i = 0; i < _commands.size(); i++)
+        const auto& storedCommand = _commands[*it];
+        if (!til::starts_with(storedCommand, givenCommand) || (exactMatch && storedCommand.size() != givenCommand.size()))
         {
-            const auto& storedCommand = _commands.at(indexFound);
-            if ((WI_IsFlagClear(options, MatchOptions::ExactMatch) && (givenCommand.size() <= storedCommand.size())) || (givenCommand.size() == storedCommand.size()))
-            {
-                if (til::starts_with(storedCommand, givenCommand))
-                {
-                    return true;
-                }
-            }
+            break;
+        }
 
-            _Prev(indexFound);
+        const auto distance = gsl::narrow_cast<SHORT>((indexFound - *it + size) % size);
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
         }
     }
-    CATCH_LOG();
 
-    return false;
+    if (bestDistance == size)
+    {
+        return false;
+    }
+
+    indexFound = gsl::narrow_cast<SHORT>((indexFound - bestDistance + size) % size);
+    return true;
+}
+
+// Routine Description:
+// - Returns the range of _sortedCommands that refers to commands equal to the given one.
+//   The commands that merely start with it follow right after the range.
+std::pair<std::vector<SHORT>::iterator, std::vector<SHORT>::iterator> CommandHistory::_IndexRange(const std::wstring_view command)
+{
+    const auto first = std::lower_bound(_sortedCommands.begin(), _sortedCommands.end(), command, [&](const SHORT index, const std::wstring_view& value) {
+        return std::wstring_view{ _commands[index] } < value;
+    });
+    const auto last = std::upper_bound(first, _sortedCommands.end(), command, [&](const std::wstring_view& value, const SHORT index) {
+        return value < std::wstring_view{ _commands[index] };
+    });
+    return { first, last };
+}
+
+// Routine Description:
+// - Returns the position of the given index of _commands within _sortedCommands.
+std::vector<SHORT>::iterator CommandHistory::_IndexFind(const SHORT index)
+{
+    const auto [first, last] = _IndexRange(_commands.at(index));
+    const auto it = std::find(first, last, index);
+    FAIL_FAST_IF(it == last);
+    return it;
+}
+
+// Routine Description:
+// - Adds the command at the given index to _sortedCommands.
+//   It must be the last one, so that none of the other indices change.
+void CommandHistory::_IndexInsert(const SHORT index)
+{
+    const auto last = _IndexRange(_commands.at(index)).second;
+    _sortedCommands.insert(last, index);
+}
+
+// Routine Description:
+// - Removes the command at the given index from _sortedCommands. Must be called
+//   right before it's erased from _commands, which shifts all following commands.
+void CommandHistory::_IndexErase(const SHORT index)
+{
+    _sortedCommands.erase(_IndexFind(index));
+    for (auto& i : _sortedCommands)
+    {
+        if (i > index)
+        {
+            --i;
+        }
+    }
+}
+
+void CommandHistory::_IndexRebuild()
+{
+    _sortedCommands.resize(_commands.size());
+    std::iota(_sortedCommands.begin(), _sortedCommands.end(), SHORT{ 0 });
+    std::sort(_sortedCommands.begin(), _sortedCommands.end(), [&](const SHORT a, const SHORT b) {
+        return _commands[a] < _commands[b];
+    });
 }
 
 #ifdef UNIT_TESTING
@@ -557,6 +636,14 @@ void CommandHistory::s_ClearHistoryListStorage()
 // - indexB - index of one history item to swap
 void CommandHistory::Swap(const short indexA, const short indexB)
 {
+    if (indexA == indexB)
+    {
+        return;
+    }
+
+    // The sorted index stays sorted, because the commands keep their text.
+    // Only the indices they're referred to by need to be exchanged.
+    std::swap(*_IndexFind(indexA), *_IndexFind(indexB));
     std::swap(_commands.at(indexA), _commands.at(indexB));
 }
 
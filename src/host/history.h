@@ -83,7 +83,17 @@ private:
     void _Dec(SHORT& ind) const;
     void _Inc(SHORT& ind) const;
 
+    std::pair<std::vector<SHORT>::iterator, std::vector<SHORT>::iterator> _IndexRange(const std::wstring_view command);
+    std::vector<SHORT>::iterator _IndexFind(const SHORT index);
+    void _IndexInsert(const SHORT index);
+    void _IndexErase(const SHORT index);
+    void _IndexRebuild();
+
     std::vector<std::wstring> _commands;
+    // The indices of all _commands, sorted by the command text. All commands
+    // starting with a given prefix are therefore found in a single contiguous
+    // range, which FindMatchingCommand finds with a binary search.
+    std::vector<SHORT> _sortedCommands;
     SHORT _maxCommands;
 
     std::wstring _appName;
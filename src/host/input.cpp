@@ -116,6 +116,8 @@ void HandleGenericKeyEvent(_In_ KeyEvent keyEvent, const bool generateBreak)
         // check for ctrl-c, if in line input mode.
         if (keyEvent.GetVirtualKeyCode() == 'C' && IsInProcessedInputMode())
         {
+            // The input that was typed before the ctrl-c must be available to the readers it interrupts.
+            gci.pInputBuffer->FlushBatch();
             HandleCtrlEvent(CTRL_C_EVENT);
             if (gci.PopupCount == 0)
             {
@@ -162,11 +164,12 @@ void HandleGenericKeyEvent(_In_ KeyEvent keyEvent, const bool generateBreak)
         size_t EventsWritten = 0;
         try
         {
-            EventsWritten = gci.pInputBuffer->Write(std::make_unique<KeyEvent>(keyEvent));
+            auto record = keyEvent.ToInputRecord();
+            EventsWritten = gci.pInputBuffer->WriteBatched(gsl::make_span(&record, 1));
             if (EventsWritten && generateBreak)
             {
-                keyEvent.SetKeyDown(false);
-                EventsWritten = gci.pInputBuffer->Write(std::make_unique<KeyEvent>(keyEvent));
+                record.Event.KeyEvent.bKeyDown = FALSE;
+                EventsWritten = gci.pInputBuffer->WriteBatched(gsl::make_span(&record, 1));
             }
         }
         catch (...)
@@ -194,7 +197,7 @@ void HandleFocusEvent(const BOOL fSetFocus)
 
     try
     {
-        const auto EventsWritten = gci.pInputBuffer->Write(std::make_unique<FocusEvent>(!!fSetFocus));
+        const auto EventsWritten = gci.pInputBuffer->WriteFocusEvent(!!fSetFocus);
         FAIL_FAST_IF(EventsWritten != 1);
     }
     catch (...)
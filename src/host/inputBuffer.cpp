@@ -17,6 +17,60 @@ using Microsoft::Console::Interactivity::ServiceLocator;
 using Microsoft::Console::VirtualTerminal::TerminalInput;
 using namespace Microsoft::Console;
 
+// Routine Description:
+// - Appends a record to the end of the queue.
+// - If the allocation is full and at least half of it holds records that
+//   were already read, those are discarded first instead of growing it.
+// Arguments:
+// - record - The record to append
+// Return Value:
+// - <none>
+// Note:
+// - will throw on failure
+void InputRecordQueue::push_back(const INPUT_RECORD& record)
+{
+    if (_head != 0 && _records.size() == _records.capacity() && _head >= _records.size() / 2)
+    {
+        _records.erase(_records.begin(), _records.begin() + _head);
+        _head = 0;
+    }
+    _records.emplace_back(record);
+}
+
+// Routine Description:
+// - Removes records from the front of the queue.
+// Arguments:
+// - count - The number of records to remove. Must not exceed size().
+// Return Value:
+// - <none>
+void InputRecordQueue::pop_front(const size_t count) noexcept
+{
+    FAIL_FAST_IF(count > size());
+    _head += count;
+    if (empty())
+    {
+        clear();
+    }
+}
+
+// Routine Description:
+// - Removes all records from the queue, but keeps its allocation around.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void InputRecordQueue::clear() noexcept
+{
+    _records.clear();
+    _head = 0;
+}
+
+void InputRecordQueue::swap(InputRecordQueue& other) noexcept
+{
+    _records.swap(other._records);
+    std::swap(_head, other._head);
+}
+
 // Routine Description:
 // - This method creates an input buffer.
 // Arguments:
@@ -153,6 +207,7 @@ void InputBuffer::ReinitializeInputBuffer()
     ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
     InputMode = INPUT_BUFFER_DEFAULT_INPUT_MODE;
     _storage.clear();
+    _unreadSince.reset();
 }
 
 // Routine Description:
@@ -200,7 +255,9 @@ size_t InputBuffer::GetNumberOfReadyEvents() const noexcept
 // - The console lock must be held when calling this routine.
 void InputBuffer::Flush()
 {
+    _batch.clear();
     _storage.clear();
+    _unreadSince.reset();
     ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
 }
 
@@ -214,10 +271,9 @@ void InputBuffer::Flush()
 // - The console lock must be held when calling this routine.
 void InputBuffer::FlushAllButKeys()
 {
-    auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const std::unique_ptr<IInputEvent>& event) {
-        return event->EventType() != InputEventType::KeyEvent;
+    _storage.remove_if([](const INPUT_RECORD& record) {
+        return record.EventType != KEY_EVENT;
     });
-    _storage.erase(newEnd, _storage.end());
 }
 
 void InputBuffer::SetTerminalConnection(_In_ Render::VtEngine* const pTtyConnection)
@@ -276,10 +332,10 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
         }
 
         // read from buffer
-        std::deque<std::unique_ptr<IInputEvent>> events;
+        std::vector<INPUT_RECORD> records;
         size_t eventsRead;
         bool resetWaitEvent;
-        _ReadBuffer(events,
+        _ReadBuffer(records,
                     AmountToRead,
                     eventsRead,
                     Peek,
@@ -288,10 +344,9 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
                     Stream);
 
         // copy events to outEvents
-        while (!events.empty())
+        for (const auto& record : records)
         {
-            OutEvents.push_back(std::move(events.front()));
-            events.pop_front();
+            OutEvents.push_back(IInputEvent::Create(record));
         }
 
         if (resetWaitEvent)
@@ -351,10 +406,52 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
     return Status;
 }
 
+// Routine Description:
+// - This routine copies records from the input buffer straight into the given
+//   span, as a Unicode, non-stream Read() would, but without any intermediate containers.
+// Note:
+// - The console lock must be held when calling this routine.
+// Arguments:
+// - outRecords - where the read records are copied to. At most outRecords.size() are read.
+// - eventsRead - on output, the number of records copied into outRecords
+// - Peek - If true, copy events to outRecords but don't remove them from the input buffer.
+// - WaitForData - if true, wait until an event is input. if false, return immediately
+// Return Value:
+// - STATUS_SUCCESS if records were read into the client buffer and everything is OK.
+// - CONSOLE_STATUS_WAIT if there weren't any records to read (and waits are allowed)
+[[nodiscard]] NTSTATUS InputBuffer::Read(const gsl::span<INPUT_RECORD> outRecords,
+                                         size_t& eventsRead,
+                                         const bool Peek,
+                                         const bool WaitForData) noexcept
+{
+    eventsRead = 0;
+
+    if (_storage.empty())
+    {
+        return WaitForData ? CONSOLE_STATUS_WAIT : STATUS_SUCCESS;
+    }
+
+    const auto records = _storage.span().first(std::min(outRecords.size(), _storage.size()));
+    std::copy(records.begin(), records.end(), outRecords.begin());
+    eventsRead = records.size();
+
+    if (!Peek)
+    {
+        _storage.pop_front(eventsRead);
+        _RecordRead();
+    }
+
+    if (_storage.empty())
+    {
+        ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+    }
+    return STATUS_SUCCESS;
+}
+
 // Routine Description:
 // - This routine reads from a buffer. It does the buffer manipulation.
 // Arguments:
-// - outEvents - where read events are placed
+// - outRecords - where read records are placed
 // - readCount - amount of events to read
 // - eventsRead - where to store number of events read
 // - peek - if true , don't remove data from buffer, just copy it.
@@ -365,7 +462,7 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
 // - <none>
 // Note:
 // - The console lock must be held when calling this routine.
-void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+void InputBuffer::_ReadBuffer(_Out_ std::vector<INPUT_RECORD>& outRecords,
                               const size_t readCount,
                               _Out_ size_t& eventsRead,
                               const bool peek,
@@ -379,93 +476,58 @@ void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& ou
 
     resetWaitEvent = false;
 
-    std::deque<std::unique_ptr<IInputEvent>> readEvents;
+    const auto initialOutSize = outRecords.size();
     // we need another var to keep track of how many we've read
     // because dbcs records count for two when we aren't doing a
     // unicode read but the eventsRead count should return the number
     // of events actually put into outRecords.
     size_t virtualReadCount = 0;
+    // The number of records at the front of the storage that have been
+    // read completely. They're only removed once we're done (and not at
+    // all when peeking), so peeking never has to put anything back.
+    size_t consumedCount = 0;
 
-    while (!_storage.empty() && virtualReadCount < readCount)
+    while (consumedCount < _storage.size() && virtualReadCount < readCount)
     {
-        auto performNormalRead = true;
+        auto& record = _storage[consumedCount];
         // for stream reads we need to split any key events that have been coalesced
-        if (streamRead)
+        if (streamRead &&
+            record.EventType == KEY_EVENT &&
+            record.Event.KeyEvent.wRepeatCount > 1)
         {
-            if (_storage.front()->EventType() == InputEventType::KeyEvent)
+            // split the key event
+            auto& streamRecord = outRecords.emplace_back(record);
+            streamRecord.Event.KeyEvent.wRepeatCount = 1;
+            if (!peek)
             {
-                const auto pKeyEvent = static_cast<KeyEvent* const>(_storage.front().get());
-                if (pKeyEvent->GetRepeatCount() > 1)
-                {
-                    // split the key event
-                    auto streamKeyEvent = std::make_unique<KeyEvent>(*pKeyEvent);
-                    streamKeyEvent->SetRepeatCount(1);
-                    readEvents.push_back(std::move(streamKeyEvent));
-                    pKeyEvent->SetRepeatCount(pKeyEvent->GetRepeatCount() - 1);
-                    performNormalRead = false;
-                }
+                record.Event.KeyEvent.wRepeatCount--;
             }
         }
-
-        if (performNormalRead)
+        else
         {
-            readEvents.push_back(std::move(_storage.front()));
-            _storage.pop_front();
+            outRecords.emplace_back(record);
+            ++consumedCount;
         }
 
         ++virtualReadCount;
         if (!unicode)
         {
-            if (readEvents.back()->EventType() == InputEventType::KeyEvent)
+            const auto& readRecord = outRecords.back();
+            if (readRecord.EventType == KEY_EVENT &&
+                IsGlyphFullWidth(readRecord.Event.KeyEvent.uChar.UnicodeChar))
             {
-                const auto pKeyEvent = static_cast<const KeyEvent* const>(readEvents.back().get());
-                if (IsGlyphFullWidth(pKeyEvent->GetCharData()))
-                {
-                    ++virtualReadCount;
-                }
+                ++virtualReadCount;
             }
         }
     }
 
     // the amount of events that were actually read
-    eventsRead = readEvents.size();
+    eventsRead = outRecords.size() - initialOutSize;
 
-    // copy the events back if we were supposed to peek
-    if (peek)
+    if (!peek && eventsRead != 0)
     {
-        if (streamRead)
-        {
-            // we need to check and see if the event was split from a coalesced key event
-            // or if it was unrelated to the current front event in storage
-            if (!readEvents.empty() &&
-                !_storage.empty() &&
-                readEvents.back()->EventType() == InputEventType::KeyEvent &&
-                _storage.front()->EventType() == InputEventType::KeyEvent &&
-                _CanCoalesce(static_cast<const KeyEvent&>(*readEvents.back()),
-                             static_cast<const KeyEvent&>(*_storage.front())))
-            {
-                auto& keyEvent = static_cast<KeyEvent&>(*_storage.front());
-                keyEvent.SetRepeatCount(keyEvent.GetRepeatCount() + 1);
-            }
-            else
-            {
-                _storage.push_front(IInputEvent::Create(readEvents.back()->ToInputRecord()));
-            }
-        }
-        else
-        {
-            for (auto it = readEvents.crbegin(); it != readEvents.crend(); ++it)
-            {
-                _storage.push_front(IInputEvent::Create((*it)->ToInputRecord()));
-            }
-        }
-    }
-
-    // move events read to proper deque
-    while (!readEvents.empty())
-    {
-        outEvents.push_back(std::move(readEvents.front()));
-        readEvents.pop_front();
+        _storage.pop_front(consumedCount);
+        _RecordRead();
     }
 
     // signal if we emptied the buffer
@@ -479,19 +541,42 @@ void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& ou
 // -  Writes events to the beginning of the input buffer.
 // Arguments:
 // - inEvents - events to write to buffer.
-// - eventsWritten - The number of events written to the buffer on exit.
 // Return Value:
-// S_OK if successful.
+// - The number of events written to the buffer.
 // Note:
 // - The console lock must be held when calling this routine.
 size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+{
+    try
+    {
+        const auto inRecords = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Prepend(inRecords);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// -  Writes records to the beginning of the input buffer.
+// Arguments:
+// - inRecords - records to write to buffer.
+// Return Value:
+// - The number of events written to the buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Prepend(const gsl::span<const INPUT_RECORD> inRecords)
 {
     try
     {
         _vtInputShouldSuppress = true;
         auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+        std::vector<INPUT_RECORD> records{ inRecords.begin(), inRecords.end() };
+        _HandleConsoleSuspensionEvents(records);
+        if (records.empty())
         {
             return STATUS_SUCCESS;
         }
@@ -500,23 +585,23 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
         // this way to handle any coalescing that might occur.
 
         // get all of the existing records, "emptying" the buffer
-        std::deque<std::unique_ptr<IInputEvent>> existingStorage;
+        InputRecordQueue existingStorage;
         existingStorage.swap(_storage);
 
         // We will need this variable to pass to _WriteBuffer so it can attempt to determine wait status.
-        // However, because we swapped the storage out from under it with an empty deque, it will always
-        // return true after the first one (as it is filling the newly emptied backing deque.)
+        // However, because we swapped the storage out from under it with an empty queue, it will always
+        // return true after the first one (as it is filling the newly emptied backing queue.)
         // Then after the second one, because we've inserted some input, it will always say false.
         auto unusedWaitStatus = false;
 
         // write the prepend records
         size_t prependEventsWritten;
-        _WriteBuffer(inEvents, prependEventsWritten, unusedWaitStatus);
+        _WriteBuffer(records, prependEventsWritten, unusedWaitStatus);
         FAIL_FAST_IF(!(unusedWaitStatus));
 
         // write all previously existing records
         size_t existingEventsWritten;
-        _WriteBuffer(existingStorage, existingEventsWritten, unusedWaitStatus);
+        _WriteBuffer(existingStorage.span(), existingEventsWritten, unusedWaitStatus);
         FAIL_FAST_IF(!(!unusedWaitStatus));
 
         // We need to set the wait event if there were 0 events in the
@@ -556,9 +641,9 @@ size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
 {
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents;
-        inEvents.push_back(std::move(inEvent));
-        return Write(inEvents);
+        const auto inRecord = inEvent->ToInputRecord();
+        inEvent.reset();
+        return Write(gsl::make_span(&inRecord, 1));
     }
     catch (...)
     {
@@ -580,10 +665,38 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 {
     try
     {
+        const auto inRecords = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Write(inRecords);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Writes records to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// Arguments:
+// - inRecords - input records to store in the buffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Write(const gsl::span<const INPUT_RECORD> inRecords)
+{
+    try
+    {
+        // Batched input precedes anything that's written afterwards.
+        FlushBatch();
+
         _vtInputShouldSuppress = true;
         auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+        std::vector<INPUT_RECORD> records{ inRecords.begin(), inRecords.end() };
+        _HandleConsoleSuspensionEvents(records);
+        if (records.empty())
         {
             return 0;
         }
@@ -591,7 +704,8 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
         // Write to buffer.
         size_t EventsWritten;
         bool SetWaitEvent;
-        _WriteBuffer(inEvents, EventsWritten, SetWaitEvent);
+        _WriteBuffer(records, EventsWritten, SetWaitEvent);
+        _RecordWrite();
 
         if (SetWaitEvent)
         {
@@ -610,9 +724,117 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 }
 
 // Routine Description:
-// - Coalesces input events and transfers them to storage queue.
+// - Writes a focus event that was generated by the console itself to the
+// input buffer. Unlike focus events written through the API, these get
+// translated into VT sequences when the client asked for focus reporting.
 // Arguments:
-// - inRecords - The events to store.
+// - focused - true if the console gained focus, false if it lost it.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::WriteFocusEvent(const bool focused) noexcept
+{
+    try
+    {
+        if (IsInVirtualTerminalInputMode())
+        {
+            _vtInputShouldSuppress = true;
+            auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
+
+            const auto initiallyEmptyQueue = _storage.empty();
+            if (_termInput.HandleFocus(focused))
+            {
+                if (initiallyEmptyQueue && !_storage.empty())
+                {
+                    ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
+                }
+                _RecordWrite();
+                WakeUpReadersWaitingForData();
+                return 1;
+            }
+        }
+
+        INPUT_RECORD record{ FOCUS_EVENT };
+        record.Event.FocusEvent.bSetFocus = focused;
+        return Write(gsl::make_span(&record, 1));
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Starts collecting the input written with WriteBatched() instead of
+//   writing it right away. The console window does this while it drains
+//   its message queue, so that a burst of key messages (fast typing, or
+//   SendInput) is written with a single Write() and wakes up readers once.
+// Note:
+// - The console lock must be held when calling this routine.
+void InputBuffer::BeginBatch() noexcept
+{
+    _batching = true;
+}
+
+// Routine Description:
+// - Writes records to the input buffer, unless a batch was started, in which
+//   case they're appended to it and written once the batch ends.
+// Arguments:
+// - inRecords - input records to store in the buffer.
+// Return Value:
+// - The number of events that were written to input buffer or the batch.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::WriteBatched(const gsl::span<const INPUT_RECORD> inRecords)
+{
+    if (!_batching)
+    {
+        return Write(inRecords);
+    }
+
+    try
+    {
+        _batch.insert(_batch.end(), inRecords.begin(), inRecords.end());
+        return inRecords.size();
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Ends the batch started by BeginBatch() and writes the input collected in it.
+// Note:
+// - The console lock must be held when calling this routine.
+void InputBuffer::EndBatch()
+{
+    _batching = false;
+    FlushBatch();
+}
+
+// Routine Description:
+// - Writes the input collected in the current batch, if there's any. This
+//   happens before anything else is written, or before the console lock is
+//   released for a modal loop, so that the order of the input is preserved.
+// Note:
+// - The console lock must be held when calling this routine.
+void InputBuffer::FlushBatch()
+{
+    if (!_batch.empty())
+    {
+        const auto batch = std::exchange(_batch, {});
+        Write(batch);
+    }
+}
+
+// Routine Description:
+// - Coalesces input records and transfers them to storage queue.
+// Arguments:
+// - inRecords - The records to store.
 // - eventsWritten - The number of events written since this function
 // was called.
 // - setWaitEvent - on exit, true if buffer became non-empty.
@@ -621,76 +843,44 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw on failure
-void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
+void InputBuffer::_WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                                _Out_ size_t& eventsWritten,
                                _Out_ bool& setWaitEvent)
 {
     eventsWritten = 0;
     setWaitEvent = false;
     const auto initiallyEmptyQueue = _storage.empty();
-    const auto initialInEventsSize = inEvents.size();
     const auto vtInputMode = IsInVirtualTerminalInputMode();
 
-    while (!inEvents.empty())
+    for (const auto& inRecord : inRecords)
     {
-        // Pop the next event.
         // If we're in vt mode, try and handle it with the vt input module.
         // If it was handled, do nothing else for it.
-        // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
+        // If there was one record passed in, try coalescing it with the previous record currently in the buffer.
         // If it's not coalesced, append it to the buffer.
-        auto inEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (vtInputMode)
+        if (vtInputMode && _HandleKeyWithTerminalInput(inRecord))
         {
-            // GH#11682: TerminalInput::HandleKey can handle both KeyEvents and Focus events seamlessly
-            const auto handled = _termInput.HandleKey(inEvent.get());
-            if (handled)
-            {
-                eventsWritten++;
-                continue;
-            }
+            eventsWritten++;
+            continue;
         }
 
         // we only check for possible coalescing when storing one
         // record at a time because this is the original behavior of
         // the input buffer. Changing this behavior may break stuff
         // that was depending on it.
-        if (initialInEventsSize == 1 && !_storage.empty())
+        //
+        // this looks kinda weird but we don't want to coalesce a
+        // mouse event and then try to coalesce a key event right after.
+        if (inRecords.size() == 1 &&
+            !_storage.empty() &&
+            (_CoalesceMouseMovedEvents(inRecord) || _CoalesceRepeatedKeyPressEvents(inRecord)))
         {
-            // coalescing requires a deque of events, so push it back onto the front.
-            inEvents.push_front(std::move(inEvent));
-
-            auto coalesced = false;
-            // this looks kinda weird but we don't want to coalesce a
-            // mouse event and then try to coalesce a key event right after.
-            //
-            // we also pass the whole deque to the coalescing methods
-            // even though they only want one event because it should
-            // be their responsibility to maintain the correct state
-            // of the deque if they process any records in it.
-            if (_CoalesceMouseMovedEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            else if (_CoalesceRepeatedKeyPressEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            if (coalesced)
-            {
-                eventsWritten = 1;
-                return;
-            }
-            else
-            {
-                // We didn't coalesce the event. pull it from the queue again,
-                //  to keep the state consistent with the start of this block.
-                inEvent = std::move(inEvents.front());
-                inEvents.pop_front();
-            }
+            eventsWritten = 1;
+            return;
         }
-        // At this point, the event was neither coalesced, nor processed by VT.
-        _storage.push_back(std::move(inEvent));
+
+        // At this point, the record was neither coalesced, nor processed by VT.
+        _storage.push_back(inRecord);
         ++eventsWritten;
     }
     if (initiallyEmptyQueue && !_storage.empty())
@@ -700,67 +890,53 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
 }
 
 // Routine Description:
-// - Checks if the last saved event and the first event of inRecords are
-// both MOUSE_MOVED events. If they are, the last saved event is
-// updated with the new mouse position and the first event of inRecords is
-// dropped.
+// - Checks if the last saved record and inRecord are both MOUSE_MOVED
+// events. If they are, the last saved record is updated with the new
+// mouse position and inRecord should be dropped.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
-// true if events were coalesced, false if they were not.
+// true if the records were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord) noexcept
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::MouseEvent &&
-        pLastStoredEvent->EventType() == InputEventType::MouseEvent)
+    auto& lastStoredRecord = _storage.back();
+    if (inRecord.EventType == MOUSE_EVENT &&
+        lastStoredRecord.EventType == MOUSE_EVENT &&
+        inRecord.Event.MouseEvent.dwEventFlags == MOUSE_MOVED &&
+        lastStoredRecord.Event.MouseEvent.dwEventFlags == MOUSE_MOVED)
     {
-        const auto pInMouseEvent = static_cast<const MouseEvent* const>(pFirstInEvent);
-        const auto pLastMouseEvent = static_cast<const MouseEvent* const>(pLastStoredEvent);
-
-        if (pInMouseEvent->IsMouseMoveEvent() &&
-            pLastMouseEvent->IsMouseMoveEvent())
-        {
-            // update mouse moved position
-            const auto pMouseEvent = static_cast<MouseEvent* const>(_storage.back().release());
-            pMouseEvent->SetPosition(pInMouseEvent->GetPosition());
-            std::unique_ptr<IInputEvent> tempPtr(pMouseEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
-            return true;
-        }
+        // update mouse moved position
+        lastStoredRecord.Event.MouseEvent.dwMousePosition = inRecord.Event.MouseEvent.dwMousePosition;
+        return true;
     }
     return false;
 }
 
 // Routine Description:
-// - checks two KeyEvents to see if they're similar enough to be coalesced
+// - checks two key event records to see if they're similar enough to be coalesced
 // Arguments:
-// - a - the first KeyEvent
-// - b - the other KeyEvent
+// - a - the first key event record
+// - b - the other key event record
 // Return Value:
 // - true if the events could be coalesced, false otherwise
-bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept
+bool InputBuffer::_CanCoalesce(const KEY_EVENT_RECORD& a, const KEY_EVENT_RECORD& b) const noexcept
 {
-    if (WI_IsFlagSet(a.GetActiveModifierKeys(), NLS_IME_CONVERSION) &&
-        a.GetCharData() == b.GetCharData() &&
-        a.GetActiveModifierKeys() == b.GetActiveModifierKeys())
+    if (WI_IsFlagSet(a.dwControlKeyState, NLS_IME_CONVERSION) &&
+        a.uChar.UnicodeChar == b.uChar.UnicodeChar &&
+        a.dwControlKeyState == b.dwControlKeyState)
     {
         return true;
     }
     // other key events check
-    else if (a.GetVirtualScanCode() == b.GetVirtualScanCode() &&
-             a.GetCharData() == b.GetCharData() &&
-             a.GetActiveModifierKeys() == b.GetActiveModifierKeys())
+    else if (a.wVirtualScanCode == b.wVirtualScanCode &&
+             a.uChar.UnicodeChar == b.uChar.UnicodeChar &&
+             a.dwControlKeyState == b.dwControlKeyState)
     {
         return true;
     }
@@ -768,44 +944,35 @@ bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexc
 }
 
 // Routine Description::
-// - If the last input event saved and the first input event in inRecords
-// are both a keypress down event for the same key, update the repeat
-// count of the saved event and drop the first from inRecords.
+// - If the last input record saved and inRecord are both a keypress down
+// event for the same key, update the repeat count of the saved record and
+// inRecord should be dropped.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
-// true if events were coalesced, false if they were not.
+// true if the records were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord) noexcept
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::KeyEvent &&
-        pLastStoredEvent->EventType() == InputEventType::KeyEvent)
-    {
-        const auto pInKeyEvent = static_cast<const KeyEvent* const>(pFirstInEvent);
-        const auto pLastKeyEvent = static_cast<const KeyEvent* const>(pLastStoredEvent);
-
-        if (pInKeyEvent->IsKeyDown() &&
-            pLastKeyEvent->IsKeyDown() &&
-            !IsGlyphFullWidth(pInKeyEvent->GetCharData()) &&
-            _CanCoalesce(*pInKeyEvent, *pLastKeyEvent))
+    auto& lastStoredRecord = _storage.back();
+    if (inRecord.EventType == KEY_EVENT &&
+        lastStoredRecord.EventType == KEY_EVENT)
+    {
+        const auto& inKeyEvent = inRecord.Event.KeyEvent;
+        auto& lastKeyEvent = lastStoredRecord.Event.KeyEvent;
+
+        if (inKeyEvent.bKeyDown &&
+            lastKeyEvent.bKeyDown &&
+            !IsGlyphFullWidth(inKeyEvent.uChar.UnicodeChar) &&
+            _CanCoalesce(inKeyEvent, lastKeyEvent))
         {
             // increment repeat count
-            const auto pKeyEvent = static_cast<KeyEvent* const>(_storage.back().release());
-            WORD repeatCount = pKeyEvent->GetRepeatCount() + pInKeyEvent->GetRepeatCount();
-            pKeyEvent->SetRepeatCount(repeatCount);
-            std::unique_ptr<IInputEvent> tempPtr(pKeyEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
+            lastKeyEvent.wRepeatCount += inKeyEvent.wRepeatCount;
             return true;
         }
     }
@@ -815,42 +982,106 @@ bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique
 // Routine Description:
 // - Handles records that suspend/resume the console.
 // Arguments:
-// - records - records to check for pause/unpause events
+// - inRecords - records to check for pause/unpause events
 // Return Value:
 // - None
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw exception on error
-void InputBuffer::_HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+void InputBuffer::_HandleConsoleSuspensionEvents(_Inout_ std::vector<INPUT_RECORD>& inRecords)
 {
     auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
 
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
-    while (!inEvents.empty())
+    size_t keptCount = 0;
+    for (const auto& record : inRecords)
     {
-        auto currEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (currEvent->EventType() == InputEventType::KeyEvent)
+        if (record.EventType == KEY_EVENT && record.Event.KeyEvent.bKeyDown)
         {
-            const auto pKeyEvent = static_cast<const KeyEvent* const>(currEvent.get());
-            if (pKeyEvent->IsKeyDown())
+            if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
+                !IsSystemKey(record.Event.KeyEvent.wVirtualKeyCode))
             {
-                if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
-                    !IsSystemKey(pKeyEvent->GetVirtualKeyCode()))
-                {
-                    UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
-                    continue;
-                }
-                else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && pKeyEvent->IsPauseKey())
-                {
-                    WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
-                    continue;
-                }
+                UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
+                continue;
+            }
+            else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && record.Event.KeyEvent.wVirtualKeyCode == VK_PAUSE)
+            {
+                WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
+                continue;
             }
         }
-        outEvents.push_back(std::move(currEvent));
+        til::at(inRecords, keptCount++) = record;
+    }
+    inRecords.resize(keptCount);
+}
+
+// Routine Description:
+// - Passes a key event record to the vt input module.
+// Arguments:
+// - inRecord - The record to translate
+// Return Value:
+// - true if the vt input module handled the record, false if it should be stored as is.
+bool InputBuffer::_HandleKeyWithTerminalInput(const INPUT_RECORD& inRecord)
+{
+    // Focus events in the input buffer have always been written through the API.
+    // GH#13238 - Those are never translated, see WriteFocusEvent() instead.
+    if (inRecord.EventType != KEY_EVENT)
+    {
+        return false;
+    }
+
+    const KeyEvent keyEvent{ inRecord.Event.KeyEvent };
+    return _termInput.HandleKey(&keyEvent);
+}
+
+// Routine Description:
+// - Returns how long the input stayed in this buffer until it was read.
+// Note:
+// - The console lock must be held when calling this routine.
+const InputLatencyStatistics& InputBuffer::GetLatencyStatistics() const noexcept
+{
+    return _latency;
+}
+
+// Routine Description:
+// - Remembers when the buffer became non-empty, which is when the
+//   latency of the next read starts.
+void InputBuffer::_RecordWrite() noexcept
+{
+    if (!_unreadSince && !_storage.empty())
+    {
+        _unreadSince = std::chrono::steady_clock::now();
+    }
+}
+
+// Routine Description:
+// - Records the latency of a read that removed records from the buffer.
+//   If records remain, the next read is still measured from the same point
+//   in time, since we don't know when each of them was written. This
+//   overestimates the latency of clients that are behind on their input,
+//   which is what we want to see anyways.
+// - The statistics are traced every 256 reads.
+void InputBuffer::_RecordRead() noexcept
+{
+    if (!_unreadSince)
+    {
+        return;
+    }
+
+    const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - *_unreadSince);
+    const auto step = gsl::narrow_cast<size_t>(latency / InputLatencyStatistics::LatencyStep);
+    til::at(_latency.latencies, std::min(step, _latency.latencies.size() - 1))++;
+    _latency.longest = std::max(_latency.longest, latency);
+    _latency.reads++;
+
+    if (_storage.empty())
+    {
+        _unreadSince.reset();
+    }
+
+    if (_latency.reads % 256 == 0)
+    {
+        Tracing::s_TraceInputLatency(_latency);
     }
-    inEvents.swap(outEvents);
 }
 
 // Routine Description:
@@ -876,12 +1107,11 @@ void InputBuffer::_HandleTerminalInputCallback(std::deque<std::unique_ptr<IInput
     try
     {
         // add all input events to the storage queue
-        while (!inEvents.empty())
+        for (const auto& inEvent : inEvents)
         {
-            auto inEvent = std::move(inEvents.front());
-            inEvents.pop_front();
-            _storage.push_back(std::move(inEvent));
+            _storage.push_back(inEvent->ToInputRecord());
         }
+        inEvents.clear();
 
         if (!_vtInputShouldSuppress)
         {
@@ -33,6 +33,98 @@ namespace Microsoft::Console::Render
     class VtEngine;
 }
 
+// How long input stayed in the InputBuffer until a client read it. The time is
+// measured from the write that made the buffer non-empty, so for a client that
+// reads its input as it arrives this is the time a key press waited for it.
+struct InputLatencyStatistics
+{
+    // The number of reads that removed records from the buffer.
+    uint64_t reads = 0;
+    // A histogram of the latencies in steps of LatencyStep.
+    // The last entry counts all reads that took longer.
+    static constexpr std::chrono::microseconds LatencyStep{ 250 };
+    std::array<uint32_t, 128> latencies{};
+    std::chrono::microseconds longest{};
+
+    // Returns the upper end of the histogram step the given percentile (in permille) falls into.
+    std::chrono::microseconds Percentile(const uint64_t permille) const noexcept
+    {
+        const auto rank = (reads * permille + 999) / 1000;
+        uint64_t count = 0;
+        for (size_t i = 0; i < latencies.size(); ++i)
+        {
+            count += til::at(latencies, i);
+            if (count >= rank && count != 0)
+            {
+                return LatencyStep * (i + 1);
+            }
+        }
+        return {};
+    }
+};
+
+// A FIFO of INPUT_RECORDs that are stored by value in a single contiguous allocation.
+// Records are consumed by advancing the head index, so reading from the front
+// never moves the remaining records and the allocation is reused once drained.
+class InputRecordQueue
+{
+public:
+    bool empty() const noexcept
+    {
+        return _head == _records.size();
+    }
+
+    size_t size() const noexcept
+    {
+        return _records.size() - _head;
+    }
+
+    INPUT_RECORD& operator[](const size_t index) noexcept
+    {
+        return til::at(_records, _head + index);
+    }
+
+    const INPUT_RECORD& operator[](const size_t index) const noexcept
+    {
+        return til::at(_records, _head + index);
+    }
+
+    INPUT_RECORD& front() noexcept
+    {
+        return til::at(_records, _head);
+    }
+
+    INPUT_RECORD& back() noexcept
+    {
+        return _records.back();
+    }
+
+    gsl::span<const INPUT_RECORD> span() const noexcept
+    {
+        return gsl::make_span(_records).subspan(_head);
+    }
+
+    void push_back(const INPUT_RECORD& record);
+    void pop_front(const size_t count = 1) noexcept;
+    void clear() noexcept;
+    void swap(InputRecordQueue& other) noexcept;
+
+    template<typename Predicate>
+    void remove_if(Predicate&& predicate)
+    {
+        const auto newEnd = std::remove_if(_records.begin() + _head, _records.end(), std::forward<Predicate>(predicate));
+        _records.erase(newEnd, _records.end());
+        if (empty())
+        {
+            clear();
+        }
+    }
+
+private:
+    std::vector<INPUT_RECORD> _records;
+    size_t _head = 0;
+};
+
 class InputBuffer final : public ConsoleObjectHeader
 {
 public:
@@ -73,10 +165,25 @@ public:
                                 const bool Unicode,
                                 const bool Stream);
 
+    [[nodiscard]] NTSTATUS Read(const gsl::span<INPUT_RECORD> outRecords,
+                                size_t& eventsRead,
+                                const bool Peek,
+                                const bool WaitForData) noexcept;
+
     size_t Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t Prepend(const gsl::span<const INPUT_RECORD> inRecords);
 
     size_t Write(_Inout_ std::unique_ptr<IInputEvent> inEvent);
     size_t Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t Write(const gsl::span<const INPUT_RECORD> inRecords);
+    size_t WriteFocusEvent(const bool focused) noexcept;
+
+    void BeginBatch() noexcept;
+    size_t WriteBatched(const gsl::span<const INPUT_RECORD> inRecords);
+    void FlushBatch();
+    void EndBatch();
+
+    const InputLatencyStatistics& GetLatencyStatistics() const noexcept;
 
     bool IsInVirtualTerminalInputMode() const;
     Microsoft::Console::VirtualTerminal::TerminalInput& GetTerminalInput();
@@ -84,7 +191,7 @@ public:
     void PassThroughWin32MouseRequest(bool enable);
 
 private:
-    std::deque<std::unique_ptr<IInputEvent>> _storage;
+    InputRecordQueue _storage;
     std::unique_ptr<IInputEvent> _readPartialByteSequence;
     std::unique_ptr<IInputEvent> _writePartialByteSequence;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
@@ -96,7 +203,18 @@ private:
     // Otherwise, we should be calling them.
     bool _vtInputShouldSuppress{ false };
 
-    void _ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+    // Key input the console window received while it's draining its message
+    // queue. It's written in one go and readers are only woken up once.
+    std::vector<INPUT_RECORD> _batch;
+    bool _batching{ false };
+
+    std::optional<std::chrono::steady_clock::time_point> _unreadSince;
+    InputLatencyStatistics _latency;
+
+    void _RecordWrite() noexcept;
+    void _RecordRead() noexcept;
+
+    void _ReadBuffer(_Out_ std::vector<INPUT_RECORD>& outRecords,
                      const size_t readCount,
                      _Out_ size_t& eventsRead,
                      const bool peek,
@@ -104,14 +222,15 @@ private:
                      const bool unicode,
                      const bool streamRead);
 
-    void _WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inRecords,
+    void _WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                       _Out_ size_t& eventsWritten,
                       _Out_ bool& setWaitEvent);
 
-    bool _CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept;
-    bool _CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    bool _CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    void _HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    bool _CanCoalesce(const KEY_EVENT_RECORD& a, const KEY_EVENT_RECORD& b) const noexcept;
+    bool _CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord) noexcept;
+    bool _CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord) noexcept;
+    void _HandleConsoleSuspensionEvents(_Inout_ std::vector<INPUT_RECORD>& inRecords);
+    bool _HandleKeyWithTerminalInput(const INPUT_RECORD& inRecord);
 
     void _HandleTerminalInputCallback(_In_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
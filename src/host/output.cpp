@@ -283,6 +283,23 @@ static void _ScrollScreen(SCREEN_INFORMATION& screenInfo, const Viewport& source
     // Get the text buffer and send it commands.
     // It will figure out whether or not we're active and where the messages need to go.
     auto& textBuffer = screenInfo.GetTextBuffer();
+
+    // If entire rows were moved vertically and the area we were allowed to fill covers the
+    // whole viewport, the visible result is the same as scrolling the viewport by the delta
+    // and repainting the uncovered rows. That's exactly what TriggerScroll does, and it's
+    // a lot cheaper for the renderer than redrawing everything. The rows filled afterwards
+    // will be invalidated when they're written.
+    // The VT renderer turns scrolls into SU/SD sequences, which would push rows into the
+    // scrollback of the terminal, so this is only done if we aren't in ConPTY mode.
+    const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const auto viewport = screenInfo.GetViewport();
+    const auto fullRows = fill.Left() == 0 && fill.Width() == screenInfo.GetBufferSize().Width() && source.Left() == 0 && target.Left() == 0;
+    if (!gci.IsInVtIoMode() && fullRows && fill.Top() <= viewport.Top() && fill.BottomExclusive() >= viewport.BottomExclusive())
+    {
+        textBuffer.TriggerScroll({ 0, target.Top() - source.Top() });
+        return;
+    }
+
     // Redraw anything in the target area
     textBuffer.TriggerRedraw(target);
     // Also redraw anything that was filled.
@@ -66,6 +66,13 @@ void ConhostInternalGetSet::PrintString(const std::wstring_view string)
 // - <none>
 void ConhostInternalGetSet::ReturnResponse(const std::wstring_view response)
 {
+    // In passthrough mode the terminal has already answered this query. We
+    // only got here because we're catching up our own buffer afterwards.
+    if (ServiceLocator::LocateGlobals().getConsoleInformation().GetVtIo()->IsSyncingShadowBuffer())
+    {
+        return;
+    }
+
     std::deque<std::unique_ptr<IInputEvent>> inEvents;
 
     // generate a paired key down and key up event for every
@@ -364,31 +371,18 @@ void ConhostInternalGetSet::SetWorkingDirectory(const std::wstring_view /*uri*/)
 }
 
 // Routine Description:
-// - Plays a single MIDI note, blocking for the duration.
+// - Plays a single MIDI note. The note is queued up and played by the
+//   audio thread, so that the output isn't blocked while it plays.
 // Arguments:
 // - noteNumber - The MIDI note number to be played (0 - 127).
 // - velocity - The force with which the note should be played (0 - 127).
-// - duration - How long the note should be sustained (in milliseconds).
+// - duration - How long the note should be sustained (in microseconds).
 // Return value:
-// - true if successful. false otherwise.
+// - <none>
 void ConhostInternalGetSet::PlayMidiNote(const int noteNumber, const int velocity, const std::chrono::microseconds duration)
 {
-    // We create the audio instance on demand, and lock it for the duration
-    // of the note output so it can't be destroyed while in use.
-    auto& midiAudio = ServiceLocator::LocateGlobals().getConsoleInformation().GetMidiAudio();
-    midiAudio.Lock();
-
-    // We then unlock the console, so the UI doesn't hang while we're busy.
-    UnlockConsole();
-
-    // This call will block for the duration, unless shutdown early.
-    midiAudio.PlayNote(noteNumber, velocity, duration);
-
-    // Once complete, we reacquire the console lock and unlock the audio.
-    // If the console has shutdown in the meantime, the Unlock call
-    // will throw an exception, forcing the thread to exit ASAP.
-    LockConsole();
-    midiAudio.Unlock();
+    // We create the audio instance on demand.
+    ServiceLocator::LocateGlobals().getConsoleInformation().GetMidiAudio().PlayNote(noteNumber, velocity, duration);
 }
 
 // Routine Description:
@@ -98,6 +98,21 @@ void RenderData::UnlockConsole() noexcept
     ::UnlockConsole();
 }
 
+// Method Description:
+// - The console lock is recursive and exclusive, so readers simply take it
+//      like everyone else does.
+void RenderData::LockConsoleForReading() noexcept
+{
+    ::LockConsole();
+}
+
+// Method Description:
+// - Unlocks the console after a call to RenderData::LockConsoleForReading.
+void RenderData::UnlockConsoleForReading() noexcept
+{
+    ::UnlockConsole();
+}
+
 #pragma endregion
 
 #pragma region IRenderData
@@ -33,6 +33,8 @@ public:
 
     void LockConsole() noexcept override;
     void UnlockConsole() noexcept override;
+    void LockConsoleForReading() noexcept override;
+    void UnlockConsoleForReading() noexcept override;
 #pragma endregion
 
 #pragma region IRenderData
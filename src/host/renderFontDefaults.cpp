@@ -7,10 +7,7 @@
 
 #pragma hdrstop
 
-RenderFontDefaults::RenderFontDefaults()
-{
-    LOG_IF_NTSTATUS_FAILED(TrueTypeFontList::s_Initialize());
-}
+RenderFontDefaults::RenderFontDefaults() = default;
 
 RenderFontDefaults::~RenderFontDefaults()
 {
@@ -21,6 +18,12 @@ RenderFontDefaults::~RenderFontDefaults()
                                                                              std::wstring& outFaceName)
 try
 {
+    // Reading the font list from the registry is deferred until it's first needed,
+    // because a headless (PTY) console might never look up a font at all.
+    std::call_once(_initialized, [] {
+        LOG_IF_NTSTATUS_FAILED(TrueTypeFontList::s_Initialize());
+    });
+
     // GH#3123: Propagate font length changes up through Settings and propsheet
     wchar_t faceName[LF_FACESIZE]{ 0 };
     auto status = TrueTypeFontList::s_SearchByCodePage(codePage, faceName, ARRAYSIZE(faceName));
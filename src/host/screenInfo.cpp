@@ -2322,16 +2322,14 @@ void SCREEN_INFORMATION::SetViewport(const Viewport& newViewport,
     fillAttributes.SetStandardErase();
 
     // +1 on the y coord because we don't want to clear the attributes of the
-    // cursor row, the one we saved.
-    til::point fillPosition{ 0, _viewport.Top() + 1 };
-    auto fillLength = gsl::narrow<size_t>(_viewport.Height() * GetBufferSize().Width());
-    auto fillData = OutputCellIterator{ fillAttributes, fillLength };
-    Write(fillData, fillPosition, false);
+    // cursor row, the one we saved. Resetting the rows in bulk also resets
+    // their line rendition.
+    _textBuffer->ResetRows(_viewport.Top() + 1, _viewport.BottomExclusive(), fillAttributes);
 
     _textBuffer->TriggerRedrawAll();
 
-    // Also reset the line rendition for the erased rows.
-    _textBuffer->ResetLineRenditionRange(_viewport.Top(), _viewport.BottomExclusive());
+    // The cursor row keeps its contents, but not its line rendition.
+    _textBuffer->ResetLineRenditionRange(_viewport.Top(), _viewport.Top() + 1);
 
     return S_OK;
 }
@@ -171,6 +171,11 @@ private:
 public:
     SCREEN_INFORMATION* Next;
     BYTE WriteConsoleDbcsLeadByte[2];
+    // The partials of the UTF-8 decoder of WriteConsoleA are kept per screen buffer,
+    // just like the DBCS lead byte above, along with the buffer it decodes into.
+    // The buffer is reused across calls, so that UTF-8 writes don't allocate.
+    til::u8state WriteConsoleUtf8State;
+    std::wstring WriteConsoleBuffer;
     BYTE FillOutDbcsLeadChar;
 
     // non ownership pointer
@@ -46,6 +46,12 @@ try
 {
     auto& Globals = ServiceLocator::LocateGlobals();
 
+#if TIL_FEATURE_CONPTYONLYHOST_ENABLED
+    // This flavor doesn't contain the console window, the registry
+    // settings or the accessibility notifier. See features.xml.
+    RETURN_HR_IF(E_NOTIMPL, !args->InConptyMode());
+#endif
+
     if (!Globals.pDeviceComm)
     {
         // in rare circumstances (such as in the fuzzing harness), there will already be a device comm
@@ -57,13 +63,16 @@ try
     Globals.uiOEMCP = GetOEMCP();
     Globals.uiWindowsCP = GetACP();
 
+    // The TrueType font list is only read from the registry once a font is actually looked up.
     Globals.pFontDefaultList = new RenderFontDefaults();
 
     FontInfoBase::s_SetFontDefaultList(Globals.pFontDefaultList);
 
     // Check if this conhost is allowed to delegate its activities to another.
     // If so, look up the registered default console handler.
-    if (Globals.delegationPair.IsUndecided() && Microsoft::Console::Internal::DefaultApp::CheckDefaultAppPolicy())
+    // A headless (PTY) session never hands off (see _shouldAttemptHandoff),
+    // so it doesn't need to pay for the policy check and registry lookups either.
+    if (!args->IsHeadless() && Globals.delegationPair.IsUndecided() && Microsoft::Console::Internal::DefaultApp::CheckDefaultAppPolicy())
     {
         Globals.delegationPair = DelegationConfig::s_GetDelegationPair();
 
@@ -81,7 +90,7 @@ try
     // If we looked up the registered defterm pair, and it was left as the default (missing or {0}),
     // AND velocity is enabled for DxD, then we switch the delegation pair to Terminal and
     // mark that we should check that class for the marker interface later.
-    if (Globals.delegationPair.IsDefault() && Microsoft::Console::Internal::DefaultApp::CheckShouldTerminalBeDefault())
+    if (!args->IsHeadless() && Globals.delegationPair.IsDefault() && Microsoft::Console::Internal::DefaultApp::CheckShouldTerminalBeDefault())
     {
         Globals.delegationPair = DelegationConfig::TerminalDelegationPair;
         Globals.defaultTerminalMarkerCheckRequired = true;
@@ -93,10 +102,12 @@ try
     // for the terminal user interface, so we should set ourselves up to skip all
     // those notifications and the mathematical calculations required to send those events
     // for performance reasons.
+#if !TIL_FEATURE_CONPTYONLYHOST_ENABLED
     if (!args->InConptyMode())
     {
         RETURN_IF_FAILED(ServiceLocator::CreateAccessibilityNotifier());
     }
+#endif
 
     // Removed allocation of scroll buffer here.
     return S_OK;
@@ -165,6 +176,7 @@ static bool s_IsOnDesktop()
     // If we are, we don't want to load any user settings, because that could
     //      result in some strange rendering results in the end terminal.
     // Use the launch args because the VtIo hasn't been initialized yet.
+#if !TIL_FEATURE_CONPTYONLYHOST_ENABLED
     if (!launchArgs.InConptyMode())
     {
         // 3. Read the default registry values.
@@ -189,6 +201,7 @@ static bool s_IsOnDesktop()
         }
     }
     else
+#endif
     {
         // microsoft/terminal#1965 - Let's just always enable VT processing by
         // default for conpty clients. This prevents peculiar differences in
@@ -786,6 +799,29 @@ PWSTR TranslateConsoleTitle(_In_ PCWSTR pwszConsoleTitle, const BOOL fUnexpand,
     return p->WindowVisible && (s_IsOnDesktop() || !g.IsHeadless());
 }
 
+// Routine Description:
+// - Creates and starts the console input thread (the window message thread).
+// Arguments:
+// - thread - Receives the handle of the started thread.
+// Return Value:
+// - STATUS_SUCCESS or STATUS_NO_MEMORY if the thread couldn't be started.
+[[nodiscard]] static NTSTATUS s_StartConsoleInputThread(wil::unique_handle& thread)
+{
+    IConsoleInputThread* pNewThread = nullptr;
+    LOG_IF_FAILED(ServiceLocator::CreateConsoleInputThread(&pNewThread));
+
+    FAIL_FAST_IF_NULL(pNewThread);
+
+    thread.reset(pNewThread->Start());
+    if (!thread)
+    {
+        return STATUS_NO_MEMORY;
+    }
+
+    ServiceLocator::LocateGlobals().dwInputThreadId = pNewThread->GetThreadId();
+    return STATUS_SUCCESS;
+}
+
 [[nodiscard]] NTSTATUS ConsoleAllocateConsole(PCONSOLE_API_CONNECTINFO p)
 {
     // AllocConsole is outside our codebase, but we should be able to mostly track the call here.
@@ -795,6 +831,23 @@ PWSTR TranslateConsoleTitle(_In_ PCWSTR pwszConsoleTitle, const BOOL fUnexpand,
 
     auto& gci = g.getConsoleInformation();
 
+    const auto deservesVisibleWindow = ConsoleConnectionDeservesVisibleWindow(p);
+    wil::unique_handle inputThread;
+
+    // In headless mode the input thread only creates the pseudo window, which doesn't
+    // depend on the renderer or the screen buffer. We start it right away, so that
+    // the thread startup and its environment initialization run while we set up the
+    // buffers below. It'll block on the console lock (which we're holding) before it
+    // creates the window, and we'll wait for it once we're done here.
+    if (deservesVisibleWindow && g.IsHeadless())
+    {
+        const auto status = s_StartConsoleInputThread(inputThread);
+        if (!NT_SUCCESS(status))
+        {
+            return status;
+        }
+    }
+
     // No matter what, create a renderer.
     try
     {
@@ -834,24 +887,15 @@ PWSTR TranslateConsoleTitle(_In_ PCWSTR pwszConsoleTitle, const BOOL fUnexpand,
     // Allow the renderer to paint once the rest of the console is hooked up.
     g.pRender->EnablePainting();
 
-    if (NT_SUCCESS(Status) && ConsoleConnectionDeservesVisibleWindow(p))
+    if (NT_SUCCESS(Status) && deservesVisibleWindow)
     {
-        HANDLE Thread = nullptr;
-
-        IConsoleInputThread* pNewThread = nullptr;
-        LOG_IF_FAILED(ServiceLocator::CreateConsoleInputThread(&pNewThread));
-
-        FAIL_FAST_IF_NULL(pNewThread);
-
-        Thread = pNewThread->Start();
-        if (Thread == nullptr)
+        if (!inputThread)
         {
-            Status = STATUS_NO_MEMORY;
+            Status = s_StartConsoleInputThread(inputThread);
         }
-        else
-        {
-            ServiceLocator::LocateGlobals().dwInputThreadId = pNewThread->GetThreadId();
 
+        if (NT_SUCCESS(Status))
+        {
             // The ConsoleInputThread needs to lock the console so we must first unlock it ourselves.
             UnlockConsole();
             g.hConsoleInputInitEvent.wait();
@@ -860,7 +904,7 @@ PWSTR TranslateConsoleTitle(_In_ PCWSTR pwszConsoleTitle, const BOOL fUnexpand,
             // OK, we've been told that the input thread is done initializing under lock.
             // Cleanup the handles and events we used to maintain our virtual lock passing dance.
 
-            CloseHandle(Thread); // This doesn't stop the thread from running.
+            inputThread.reset(); // This doesn't stop the thread from running.
 
             if (!NT_SUCCESS(g.ntstatusConsoleInputInitStatus))
             {
@@ -926,6 +970,39 @@ PWSTR TranslateConsoleTitle(_In_ PCWSTR pwszConsoleTitle, const BOOL fUnexpand,
     return Status;
 }
 
+// Routine Description:
+// - Determines whether a message may be serviced while the IO thread holds on to the console lock
+//   for a batch of messages. This excludes connects, disconnects and handle operations, some of
+//   which hand the lock to other threads or tear down the session.
+// Arguments:
+// - message - The message received from the driver.
+// Return Value:
+// - true if the message is an API call or a raw read/write.
+static bool IsBatchableIoOperation(const CONSOLE_API_MSG& message) noexcept
+{
+    switch (message.Descriptor.Function)
+    {
+    case CONSOLE_IO_USER_DEFINED:
+    case CONSOLE_IO_RAW_WRITE:
+    case CONSOLE_IO_RAW_READ:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Routine Description:
+// - Writes out whatever output the messages of a batch left buffered up, before
+//   the IO thread releases the console lock and possibly waits for the client.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+static void FlushBatchedOutput() noexcept
+{
+    ServiceLocator::LocateGlobals().getConsoleInformation().GetVtIo()->FlushBatchedOutput();
+}
+
 // Routine Description:
 // - This routine is the main one in the console server IO thread.
 // - It reads IO requests submitted by clients through the driver, services and completes them in a loop.
@@ -979,7 +1056,62 @@ DWORD WINAPI ConsoleIoThread(LPVOID lpParameter)
             continue;
         }
         ReceiveMsg._pApiRoutines = globals.api;
-        IoSorter::ServiceIoOperation(&ReceiveMsg, &ReplyMsg);
+
+        // Applications calling WriteConsole in a tight loop queue up messages faster than we
+        // service them. ReadIo already sends the reply to the previous message along with
+        // fetching the next one, but each message still takes and releases the console lock.
+        // So, as long as the driver has further messages queued up, we keep the lock held and
+        // service them back to back. TryReadIo never waits, which ensures that we never block
+        // on the client while holding the lock. The batch size is limited, so that the render
+        // and input threads still get to take the lock regularly.
+        static constexpr auto maxBatchedMessages = 32;
+        auto locked = false;
+
+        for (auto batched = 1;; ++batched)
+        {
+            const auto batchable = IsBatchableIoOperation(ReceiveMsg);
+            if (batchable && !locked)
+            {
+                LockConsole();
+                locked = true;
+            }
+            else if (!batchable && locked)
+            {
+                FlushBatchedOutput();
+                UnlockConsole();
+                locked = false;
+            }
+
+            IoSorter::ServiceIoOperation(&ReceiveMsg, &ReplyMsg);
+
+            if (!locked || batched == maxBatchedMessages)
+            {
+                break;
+            }
+
+            if (ReplyMsg != nullptr)
+            {
+                LOG_IF_FAILED(ReplyMsg->ReleaseMessageBuffers());
+            }
+
+            // On S_FALSE the reply was sent, but no message is queued up yet:
+            // ReadIo will wait for it, once we released the lock.
+            // On failure, ReadIo will retry and deal with the error.
+            hr = globals.pDeviceComm->TryReadIo(ReplyMsg, &ReceiveMsg);
+            ReplyMsg = nullptr;
+            if (hr != S_OK)
+            {
+                break;
+            }
+
+            ReceiveMsg._pApiRoutines = globals.api;
+        }
+
+        if (locked)
+        {
+            FlushBatchedOutput();
+            UnlockConsole();
+        }
     }
 
     return 0;
@@ -3,6 +3,7 @@
 
 #include "precomp.h"
 #include "tracing.hpp"
+#include "inputBuffer.hpp"
 #include "../types/UiaTextRangeBase.hpp"
 #include "../types/ScreenInfoUiaProviderBase.h"
 
@@ -406,6 +407,21 @@ void Tracing::s_TraceInputRecord(const INPUT_RECORD& inputRecord)
     }
 }
 
+void Tracing::s_TraceInputLatency(const InputLatencyStatistics& statistics)
+{
+    TraceLoggingWrite(
+        g_hConhostV2EventTraceProvider,
+        "InputLatency",
+        TraceLoggingUInt64(statistics.reads, "Reads"),
+        TraceLoggingInt64(statistics.Percentile(500).count(), "P50Microseconds"),
+        TraceLoggingInt64(statistics.Percentile(950).count(), "P95Microseconds"),
+        TraceLoggingInt64(statistics.Percentile(990).count(), "P99Microseconds"),
+        TraceLoggingInt64(statistics.longest.count(), "LongestMicroseconds"),
+        TraceLoggingLevel(WINEVENT_LEVEL_INFO),
+        TraceLoggingKeyword(TIL_KEYWORD_TRACE),
+        TraceLoggingKeyword(TraceKeywords::Input));
+}
+
 void Tracing::s_TraceCookedRead(_In_ ConsoleProcessHandle* const pConsoleProcessHandle, _In_reads_(cchCookedBufferLength) const wchar_t* pwchCookedBuffer, _In_ ULONG cchCookedBufferLength)
 {
     if (TraceLoggingProviderEnabled(g_hConhostV2EventTraceProvider, 0, TraceKeywords::CookedRead))
@@ -35,6 +35,8 @@ Author(s):
 #define DBGOUTPUT(_params_)
 #endif
 
+struct InputLatencyStatistics;
+
 class Tracing
 {
 public:
@@ -61,6 +63,7 @@ public:
 
     static void s_TraceWindowMessage(const MSG& msg);
     static void s_TraceInputRecord(const INPUT_RECORD& inputRecord);
+    static void s_TraceInputLatency(const InputLatencyStatistics& statistics);
 
     static void s_TraceCookedRead(_In_ ConsoleProcessHandle* const pConsoleProcessHandle, _In_reads_(cchCookedBufferLength) const wchar_t* pwchCookedBuffer, _In_ ULONG cchCookedBufferLength);
     static void s_TraceConsoleAttachDetach(_In_ ConsoleProcessHandle* const pConsoleProcessHandle, _In_ bool bIsAttach);
@@ -367,6 +367,26 @@ class AliasTests
         VERIFY_ARE_EQUAL(dwLinesExpected, dwLines, L"Line count be updated to 1.");
     }
 
+    TEST_METHOD(TestMatchAndCopyWholeTokenOnly)
+    {
+        std::wstring exe(L"exe.exe");
+        std::wstring source(L"foo");
+        std::wstring target(L"bar $1");
+        Alias::s_TestAddAlias(exe, source, target);
+
+        size_t lineCount = 0;
+
+        // The alias has to match the whole first token, not just a prefix of it.
+        VERIFY_ARE_EQUAL(std::wstring{}, Alias::s_MatchAndCopyAlias(L"foobar one\r\n", exe, lineCount));
+        VERIFY_ARE_EQUAL(size_t{ 0 }, lineCount);
+
+        // The first token ends at the trailing CR even without any arguments.
+        VERIFY_ARE_EQUAL(std::wstring{ L"bar \r\n" }, Alias::s_MatchAndCopyAlias(L"  foo\r\n", exe, lineCount));
+        VERIFY_ARE_EQUAL(size_t{ 1 }, lineCount);
+
+        VERIFY_ARE_EQUAL(std::wstring{ L"bar one\r\n" }, Alias::s_MatchAndCopyAlias(L"foo one\r\n", exe, lineCount));
+    }
+
     TEST_METHOD(TrimTrailing)
     {
         BEGIN_TEST_METHOD_PROPERTIES()
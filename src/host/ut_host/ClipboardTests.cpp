@@ -333,4 +333,24 @@ class ClipboardTests
             VERIFY_ARE_EQUAL(expectedEvents[i], currentKeyEvent, NoThrowString().Format(L"i == %d", i));
         }
     }
+
+    TEST_METHOD(PastesLargeStringsInChunks)
+    {
+        auto& inputBuffer = *ServiceLocator::LocateGlobals().getConsoleInformation().pInputBuffer;
+        inputBuffer.Flush();
+
+        // The CRLF pair straddles the end of the first chunk and must still be collapsed into a single CR.
+        std::wstring wstr(Clipboard::PasteChunkSize - 1, L'a');
+        wstr.append(L"\r\n");
+        wstr.append(Clipboard::PasteChunkSize * 2, L'b');
+        wstr.push_back(L'\0');
+        wstr.append(L"ignored");
+
+        Clipboard::Instance().StringPaste(wstr.c_str(), wstr.size());
+
+        // Every character but the LF and the ones after the null is a key down and key up.
+        const auto expected = (Clipboard::PasteChunkSize - 1 + 1 + Clipboard::PasteChunkSize * 2) * 2;
+        VERIFY_ARE_EQUAL(expected, inputBuffer.GetNumberOfReadyEvents());
+        inputBuffer.Flush();
+    }
 };
@@ -25,7 +25,9 @@ static const std::vector<std::tuple<unsigned int, std::wstring, CodepointWidth>>
     { 0x30CA, L"\x30CA", CodepointWidth::Wide }, // U+30CA katakana na
     { 0x72D7, L"\x72D7", CodepointWidth::Wide }, // U+72D7
     { 0x1F47E, L"\xD83D\xDC7E", CodepointWidth::Wide }, // U+1F47E alien monster
-    { 0x1F51C, L"\xD83D\xDD1C", CodepointWidth::Wide } // U+1F51C SOON
+    { 0x1F51C, L"\xD83D\xDD1C", CodepointWidth::Wide }, // U+1F51C SOON
+    { 0x20000, L"\xD840\xDC00", CodepointWidth::Wide }, // U+20000 CJK unified ideograph
+    { 0xE0100, L"\xDB40\xDD00", CodepointWidth::Ambiguous } // U+E0100 variation selector-17
 };
 
 class CodepointWidthDetectorTests
@@ -62,6 +64,32 @@ class CodepointWidthDetectorTests
         }
     }
 
+    TEST_METHOD(CanGetColumnCount)
+    {
+        CodepointWidthDetector widthDetector;
+
+        // The column count of all of the test data concatenated must match the sum of its parts.
+        std::wstring text;
+        size_t expected = 0;
+        for (const auto& data : testData)
+        {
+            const auto& wstr = std::get<1>(data);
+            text += wstr;
+            expected += widthDetector.IsWide({ wstr.c_str(), wstr.size() }) ? 2 : 1;
+        }
+        VERIFY_ARE_EQUAL(expected, widthDetector.GetColumnCount(text));
+
+        // Long runs of ASCII are measured in chunks. Make sure the chunk boundaries don't matter.
+        VERIFY_ARE_EQUAL(20u, widthDetector.GetColumnCount(L"0123456789abcdefghij"));
+        VERIFY_ARE_EQUAL(22u, widthDetector.GetColumnCount(L"0123456789\x306Aabcdefghij"));
+        VERIFY_ARE_EQUAL(11u, widthDetector.GetColumnCount(L"0123456\xD83D\xDC7E89"));
+
+        // Unpaired surrogates are dropped.
+        VERIFY_ARE_EQUAL(2u, widthDetector.GetColumnCount(L"a\xD83Db"));
+        VERIFY_ARE_EQUAL(2u, widthDetector.GetColumnCount(L"a\xDC7Eb"));
+        VERIFY_ARE_EQUAL(0u, widthDetector.GetColumnCount({}));
+    }
+
     static bool FallbackMethod(const std::wstring_view glyph)
     {
         if (glyph.size() < 1)
@@ -91,7 +119,7 @@ class CodepointWidthDetectorTests
 
         // Cached item should match what we expect
         const auto it = widthDetector._fallbackCache.begin();
-        VERIFY_ARE_EQUAL(ambiguous, it->first);
+        VERIFY_ARE_EQUAL(0x414u, it->first);
         VERIFY_ARE_EQUAL(FallbackMethod(ambiguous), it->second);
 
         // Cache should empty when font changes.
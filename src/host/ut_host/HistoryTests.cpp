@@ -242,6 +242,38 @@ class HistoryTests
         VERIFY_ARE_EQUAL(2ul, history->GetNumberOfCommands());
     }
 
+    TEST_METHOD(FindMatchingCommandGoesBackFromStart)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        for (const auto& item : std::array{ L"dir", L"cd ..", L"dir /w", L"ping", L"dir /p /w", L"cd" })
+        {
+            VERIFY_SUCCEEDED(history->Add(item, false));
+        }
+
+        // The search starts at the given index and goes back from there, wrapping around.
+        SHORT index = -1;
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"dir", 5, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(4, index);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"dir", 3, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(2, index);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"cd", 1, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(5, index);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"dir", 1, index, CommandHistory::MatchOptions::JustLooking | CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_ARE_EQUAL(0, index);
+        VERIFY_IS_FALSE(history->FindMatchingCommand(L"git", 5, index, CommandHistory::MatchOptions::JustLooking));
+
+        // Reordering and removing commands must keep the search working.
+        history->Swap(0, 1);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"dir", 2, index, CommandHistory::MatchOptions::JustLooking | CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_ARE_EQUAL(1, index);
+        VERIFY_ARE_EQUAL(String(L"dir"), String(history->Remove(1).c_str()));
+        VERIFY_IS_FALSE(history->FindMatchingCommand(L"dir", 4, index, CommandHistory::MatchOptions::JustLooking | CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"dir", 0, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(3, index);
+    }
+
 private:
     const std::array<std::wstring, 5> _manyApps = {
         L"foo.exe",
@@ -78,7 +78,7 @@ class InputBufferTests
             INPUT_RECORD record;
             record.EventType = MENU_EVENT;
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back()->ToInputRecord());
+            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back());
         }
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
     }
@@ -98,7 +98,7 @@ class InputBufferTests
         // verify that the events are the same in storage
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i]->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i], record);
         }
     }
 
@@ -121,10 +121,9 @@ class InputBufferTests
         // check that they coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
         // check that the mouse position is being updated correctly
-        const IInputEvent* const pOutEvent = inputBuffer._storage.front().get();
-        const auto pMouseEvent = static_cast<const MouseEvent* const>(pOutEvent);
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().X, static_cast<SHORT>(RECORD_INSERT_COUNT));
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
+        const auto& outRecord = inputBuffer._storage.front();
+        VERIFY_ARE_EQUAL(outRecord.Event.MouseEvent.dwMousePosition.X, static_cast<SHORT>(RECORD_INSERT_COUNT));
+        VERIFY_ARE_EQUAL(outRecord.Event.MouseEvent.dwMousePosition.Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
 
         // add a key event and another mouse event to make sure that
         // an event between two mouse events stopped the coalescing.
@@ -162,10 +161,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), mouseRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), mouseRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), mouseRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], mouseRecords[i]);
         }
     }
 
@@ -221,10 +220,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), keyRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), keyRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), keyRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], keyRecords[i]);
         }
     }
 
@@ -239,7 +238,7 @@ class InputBufferTests
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(inputBuffer._storage.back()->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage.back(), record);
         }
 
         // The events shouldn't be coalesced
@@ -382,10 +381,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read one record, make sure ResetWaitEvent isn't set
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords;
         size_t eventsRead = 0;
         auto resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 1,
                                 eventsRead,
                                 false,
@@ -396,8 +395,8 @@ class InputBufferTests
         VERIFY_IS_FALSE(!!resetWaitEvent);
 
         // read the rest, resetWaitEvent should be set to true
-        outEvents.clear();
-        inputBuffer._ReadBuffer(outEvents,
+        outRecords.clear();
+        inputBuffer._ReadBuffer(outRecords,
                                 RECORD_INSERT_COUNT - 1,
                                 eventsRead,
                                 false,
@@ -431,10 +430,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read them out non-unicode style and compare
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords;
         size_t eventsRead = 0;
         auto resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 recordInsertCount,
                                 eventsRead,
                                 false,
@@ -444,10 +443,10 @@ class InputBufferTests
         // the dbcs record should have counted for two elements in
         // the array, making it so that we get less events read
         VERIFY_ARE_EQUAL(eventsRead, recordInsertCount - 1);
-        VERIFY_ARE_EQUAL(eventsRead, outEvents.size());
+        VERIFY_ARE_EQUAL(eventsRead, outRecords.size());
         for (size_t i = 0; i < eventsRead; ++i)
         {
-            VERIFY_ARE_EQUAL(outEvents[i]->ToInputRecord(), inRecords[i]);
+            VERIFY_ARE_EQUAL(outRecords[i], inRecords[i]);
         }
     }
 
@@ -589,22 +588,17 @@ class InputBufferTests
     {
         InputBuffer inputBuffer;
         auto record = MakeKeyEvent(true, 1, L'a', 0, L'a', 0);
-        auto inputEvent = IInputEvent::Create(record);
         size_t eventsWritten;
         auto waitEvent = false;
         inputBuffer.Flush();
         // write one event to an empty buffer
-        std::deque<std::unique_ptr<IInputEvent>> storage;
-        storage.push_back(std::move(inputEvent));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer(gsl::make_span(&record, 1), eventsWritten, waitEvent);
         VERIFY_IS_TRUE(waitEvent);
         // write another, it shouldn't signal this time
         auto record2 = MakeKeyEvent(true, 1, L'b', 0, L'b', 0);
-        auto inputEvent2 = IInputEvent::Create(record2);
         // write another event to a non-empty buffer
         waitEvent = false;
-        storage.push_back(std::move(inputEvent2));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer(gsl::make_span(&record2, 1), eventsWritten, waitEvent);
 
         VERIFY_IS_FALSE(waitEvent);
     }
@@ -625,7 +619,7 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount - 1);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount - 1);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
 
@@ -645,7 +639,122 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
+
+    TEST_METHOD(InterleavedReadsAndWritesKeepOrder)
+    {
+        Log::Comment(L"Records that were read make room for new ones, this must not reorder the buffer.");
+
+        InputBuffer inputBuffer;
+        WCHAR nextWrite = L'A';
+        WCHAR nextRead = L'A';
+        for (auto round = 0; round < 16; ++round)
+        {
+            std::deque<std::unique_ptr<IInputEvent>> inEvents;
+            for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i, ++nextWrite)
+            {
+                inEvents.push_back(IInputEvent::Create(MakeKeyEvent(TRUE, 1, nextWrite, 0, nextWrite, 0)));
+            }
+            VERIFY_ARE_EQUAL(inputBuffer.Write(inEvents), RECORD_INSERT_COUNT);
+
+            // read less than we wrote, so that the buffer keeps growing
+            std::deque<std::unique_ptr<IInputEvent>> outEvents;
+            VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outEvents, RECORD_INSERT_COUNT - 2, false, false, true, false));
+            VERIFY_ARE_EQUAL(outEvents.size(), RECORD_INSERT_COUNT - 2);
+            for (const auto& outEvent : outEvents)
+            {
+                VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvent).GetCharData(), nextRead);
+                ++nextRead;
+            }
+        }
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), static_cast<size_t>(nextWrite - nextRead));
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.uChar.UnicodeChar, nextRead);
+    }
+
+    TEST_METHOD(CanReadRecordsDirectly)
+    {
+        InputBuffer inputBuffer;
+        std::array<INPUT_RECORD, RECORD_INSERT_COUNT> records;
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            records[i] = MakeKeyEvent(TRUE, 1, static_cast<WCHAR>(L'A' + i), 0, static_cast<WCHAR>(L'A' + i), 0);
+        }
+        VERIFY_ARE_EQUAL(inputBuffer.Write(records), RECORD_INSERT_COUNT);
+
+        std::array<INPUT_RECORD, RECORD_INSERT_COUNT> outRecords{};
+        size_t eventsRead = 0;
+
+        Log::Comment(L"Peeking copies the records without removing them.");
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(gsl::make_span(outRecords).first(2), eventsRead, true, false));
+        VERIFY_ARE_EQUAL(eventsRead, 2u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
+        VERIFY_ARE_EQUAL(outRecords[1], records[1]);
+
+        Log::Comment(L"Reading removes them and never copies more than were available.");
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, false, false));
+        VERIFY_ARE_EQUAL(eventsRead, RECORD_INSERT_COUNT);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 0u);
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(outRecords[i], records[i]);
+        }
+
+        VERIFY_ARE_EQUAL(inputBuffer.Read(outRecords, eventsRead, false, true), static_cast<NTSTATUS>(CONSOLE_STATUS_WAIT));
+        VERIFY_ARE_EQUAL(eventsRead, 0u);
+    }
+
+    TEST_METHOD(MeasuresInputLatency)
+    {
+        InputBuffer inputBuffer;
+        const auto record = MakeKeyEvent(TRUE, 1, L'A', 0, L'A', 0);
+        VERIFY_ARE_EQUAL(inputBuffer.Write(gsl::make_span(&record, 1)), 1u);
+
+        Log::Comment(L"Peeking doesn't count as a read.");
+        std::array<INPUT_RECORD, 1> outRecords{};
+        size_t eventsRead = 0;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, true, false));
+        VERIFY_ARE_EQUAL(inputBuffer.GetLatencyStatistics().reads, 0u);
+
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, false, false));
+        VERIFY_ARE_EQUAL(inputBuffer.GetLatencyStatistics().reads, 1u);
+        VERIFY_IS_GREATER_THAN(inputBuffer.GetLatencyStatistics().Percentile(500).count(), 0);
+
+        Log::Comment(L"Reading an empty buffer doesn't either.");
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, false, false));
+        VERIFY_ARE_EQUAL(inputBuffer.GetLatencyStatistics().reads, 1u);
+    }
+
+    TEST_METHOD(BatchedWritesKeepOrder)
+    {
+        InputBuffer inputBuffer;
+        const auto a = MakeKeyEvent(TRUE, 1, L'A', 0, L'A', 0);
+        const auto b = MakeKeyEvent(TRUE, 1, L'B', 0, L'B', 0);
+        const auto c = MakeKeyEvent(TRUE, 1, L'C', 0, L'C', 0);
+
+        Log::Comment(L"Without a batch, input is written right away.");
+        VERIFY_ARE_EQUAL(inputBuffer.WriteBatched(gsl::make_span(&a, 1)), 1u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
+
+        Log::Comment(L"Batched input is only written once the batch ends, or before other input.");
+        inputBuffer.BeginBatch();
+        VERIFY_ARE_EQUAL(inputBuffer.WriteBatched(gsl::make_span(&b, 1)), 1u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
+        VERIFY_ARE_EQUAL(inputBuffer.Write(gsl::make_span(&c, 1)), 1u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 3u);
+        VERIFY_ARE_EQUAL(inputBuffer.WriteBatched(gsl::make_span(&a, 1)), 1u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 3u);
+        inputBuffer.EndBatch();
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 4u);
+
+        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outEvents, 4, false, false, true, false));
+        VERIFY_ARE_EQUAL(outEvents.size(), 4u);
+        const std::wstring expected{ L"ABCA" };
+        for (size_t i = 0; i < outEvents.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents[i]).GetCharData(), expected[i]);
+        }
+    }
 };
@@ -511,4 +511,128 @@ class OutputCellIteratorTests
         VERIFY_ARE_EQUAL(cellsExpected, it.GetCellDistance(original));
         VERIFY_ARE_EQUAL(inputExpected, it.GetInputDistance(original));
     }
+
+    TEST_METHOD(AsciiRun)
+    {
+        SetVerifyOutput settings(VerifyOutputSettings::LogOnlyFailures);
+
+        const std::wstring testText(L"QWER\x30a2TYUIOPASDF\x00e9GH\tJK");
+        const TextAttribute color(FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+
+        OutputCellIterator it(testText, color);
+        const auto original = it;
+
+        VERIFY_ARE_EQUAL(String(L"QWER"), String(it.GetAsciiRun(100).data(), 4));
+        VERIFY_ARE_EQUAL(2u, it.GetAsciiRun(2).size());
+        it.SkipAsciiRun(4);
+
+        // Neither half of the wide glyph is part of a run.
+        VERIFY_IS_TRUE(it->DbcsAttr().IsLeading());
+        VERIFY_IS_TRUE(it.GetAsciiRun(100).empty());
+        it++;
+        VERIFY_IS_TRUE(it->DbcsAttr().IsTrailing());
+        VERIFY_IS_TRUE(it.GetAsciiRun(100).empty());
+        it++;
+
+        // This run is long enough to be scanned in vectorized chunks.
+        const auto run = it.GetAsciiRun(100);
+        VERIFY_ARE_EQUAL(String(L"TYUIOPASDF"), String(run.data(), gsl::narrow<int>(run.size())));
+        it.SkipAsciiRun(run.size());
+
+        const OutputCellView expected({ &testText.at(15), 1 },
+                                      {},
+                                      color,
+                                      TextAttributeBehavior::Stored);
+        VERIFY_ARE_EQUAL(expected, *it);
+        VERIFY_IS_TRUE(it.GetAsciiRun(100).empty());
+        it++;
+
+        // Control characters aren't part of a run either.
+        VERIFY_ARE_EQUAL(2u, it.GetAsciiRun(100).size());
+        it.SkipAsciiRun(2);
+        VERIFY_IS_TRUE(it.GetAsciiRun(100).empty());
+        it++;
+        it.SkipAsciiRun(it.GetAsciiRun(100).size());
+
+        VERIFY_IS_FALSE(it);
+        VERIFY_ARE_EQUAL(gsl::narrow<til::CoordType>(testText.size() + 1), it.GetCellDistance(original));
+        VERIFY_ARE_EQUAL(gsl::narrow<til::CoordType>(testText.size()), it.GetInputDistance(original));
+
+        // Fills never produce runs.
+        const OutputCellIterator fill(L'Q', 5);
+        VERIFY_IS_TRUE(fill.GetAsciiRun(100).empty());
+    }
+
+    TEST_METHOD(FillRun)
+    {
+        SetVerifyOutput settings(VerifyOutputSettings::LogOnlyFailures);
+
+        OutputCellIterator it(L'Q', 5);
+        const auto original = it;
+
+        VERIFY_ARE_EQUAL(3u, it.GetFillRun(3));
+        VERIFY_ARE_EQUAL(5u, it.GetFillRun(100));
+        it.SkipFillRun(3);
+        VERIFY_ARE_EQUAL(2u, it.GetFillRun(100));
+        VERIFY_ARE_EQUAL(String(L"Q"), String(it->Chars().data(), 1));
+        it.SkipFillRun(2);
+        VERIFY_IS_FALSE(it);
+        VERIFY_ARE_EQUAL(0u, it.GetFillRun(100));
+        VERIFY_ARE_EQUAL(5, it.GetCellDistance(original));
+
+        // Unlimited fills are limited by the caller only.
+        const OutputCellIterator unlimited(TextAttribute{ FOREGROUND_RED });
+        VERIFY_ARE_EQUAL(100u, unlimited.GetFillRun(100));
+
+        // Wide glyphs have to go through the cells one by one.
+        const OutputCellIterator wide(L'\x30a2', 5);
+        VERIFY_ARE_EQUAL(0u, wide.GetFillRun(100));
+
+        // So does everything that isn't a fill.
+        const OutputCellIterator text(L"QQQQQ");
+        VERIFY_ARE_EQUAL(0u, text.GetFillRun(100));
+    }
+
+    TEST_METHOD(CharInfoRun)
+    {
+        SetVerifyOutput settings(VerifyOutputSettings::LogOnlyFailures);
+
+        std::vector<CHAR_INFO> charInfos(6);
+        for (auto& charInfo : charInfos)
+        {
+            charInfo.Char.UnicodeChar = L'Q';
+            charInfo.Attributes = FOREGROUND_GREEN;
+        }
+        charInfos.at(2).Char.UnicodeChar = L'\x30a2';
+        charInfos.at(2).Attributes |= COMMON_LVB_LEADING_BYTE;
+        charInfos.at(3).Char.UnicodeChar = L'\x30a2';
+        charInfos.at(3).Attributes |= COMMON_LVB_TRAILING_BYTE;
+        charInfos.at(5).Attributes = FOREGROUND_RED;
+
+        const gsl::span<const CHAR_INFO> view{ charInfos.data(), charInfos.size() };
+        OutputCellIterator it(view);
+        const auto original = it;
+
+        VERIFY_ARE_EQUAL(1u, it.GetCharInfoRun(1).size());
+        VERIFY_ARE_EQUAL(2u, it.GetCharInfoRun(100).size());
+        it.SkipCharInfoRun(2);
+
+        // Neither half of the wide glyph is part of a run.
+        VERIFY_IS_TRUE(it->DbcsAttr().IsLeading());
+        VERIFY_IS_TRUE(it.GetCharInfoRun(100).empty());
+        it++;
+        VERIFY_IS_TRUE(it->DbcsAttr().IsTrailing());
+        VERIFY_IS_TRUE(it.GetCharInfoRun(100).empty());
+        it++;
+
+        // Runs aren't split by colors.
+        const auto run = it.GetCharInfoRun(100);
+        VERIFY_ARE_EQUAL(2u, run.size());
+        VERIFY_ARE_EQUAL(&charInfos.at(4), run.data());
+        it.SkipCharInfoRun(run.size());
+
+        VERIFY_IS_FALSE(it);
+        VERIFY_ARE_EQUAL(6, it.GetCellDistance(original));
+        VERIFY_ARE_EQUAL(6, it.GetInputDistance(original));
+    }
 };
@@ -161,6 +161,7 @@ class ScreenBufferTests
 
     TEST_METHOD(BackspaceDefaultAttrs);
     TEST_METHOD(BackspaceDefaultAttrsWriteCharsLegacy);
+    TEST_METHOD(WriteCharsLegacyRunsWrapAndControlChars);
 
     TEST_METHOD(BackspaceDefaultAttrsInPrompt);
 
@@ -183,6 +184,8 @@ class ScreenBufferTests
     TEST_METHOD(ScrollOperations);
     TEST_METHOD(InsertChars);
     TEST_METHOD(DeleteChars);
+    TEST_METHOD(RectangularAreaOperations);
+    TEST_METHOD(SixelImages);
 
     TEST_METHOD(EraseScrollbackTests);
     TEST_METHOD(EraseTests);
@@ -2884,6 +2887,39 @@ void ScreenBufferTests::BackspaceDefaultAttrsWriteCharsLegacy()
     VERIFY_ARE_EQUAL(magenta, renderSettings.GetAttributeColors(attrB).second);
 }
 
+void ScreenBufferTests::WriteCharsLegacyRunsWrapAndControlChars()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+    const auto& tbi = si.GetTextBuffer();
+    auto& cursor = si.GetTextBuffer().GetCursor();
+    const auto width = si.GetBufferSize().Width();
+
+    WI_SetAllFlags(si.OutputMode, ENABLE_PROCESSED_OUTPUT | ENABLE_WRAP_AT_EOL_OUTPUT);
+    WI_ClearFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    cursor.SetPosition({ 0, 0 });
+
+    Log::Comment(L"Write a run of ASCII that's 5 columns longer than a row, followed by a tab and a newline.");
+    std::wstring str(width + 5, L'a');
+    str.append(L"\tb\r\nc\x7f\u3042d");
+    auto cb = str.size() * sizeof(wchar_t);
+    VERIFY_SUCCESS_NTSTATUS(WriteCharsLegacy(si, str.data(), str.data(), str.data(), &cb, nullptr, 0, 0, nullptr));
+    VERIFY_ARE_EQUAL(str.size() * sizeof(wchar_t), cb);
+
+    const auto row0 = tbi.GetRowByOffset(0).GetText();
+    const auto row1 = tbi.GetRowByOffset(1).GetText();
+    const auto row2 = tbi.GetRowByOffset(2).GetText();
+    VERIFY_ARE_EQUAL(std::wstring(width, L'a'), row0.substr(0, width));
+    VERIFY_ARE_EQUAL(L"aaaaa   b", row1.substr(0, 9));
+
+    Log::Comment(L"DEL and wide glyphs still go through the per-character path.");
+    VERIFY_ARE_EQUAL(L'c', row2.at(0));
+    VERIFY_ARE_NOT_EQUAL(L'd', row2.at(1));
+    // GetText() returns wide glyphs only once, which is why 'd' is in column 4, but at index 3.
+    VERIFY_ARE_EQUAL(L'd', row2.at(3));
+    VERIFY_ARE_EQUAL(til::point(5, 2), cursor.GetPosition());
+}
+
 void ScreenBufferTests::BackspaceDefaultAttrsInPrompt()
 {
     // Tests MSFT:19853701 - when you edit the prompt line at a bash prompt,
@@ -4126,6 +4162,117 @@ void ScreenBufferTests::DeleteChars()
                    L"A whole line of spaces was inserted from the right, erasing the line.");
 }
 
+void ScreenBufferTests::RectangularAreaOperations()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+    auto& stateMachine = si.GetStateMachine();
+    WI_SetFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    // Make sure we restore the change extent on exit so it can't break other tests.
+    auto resetExtent = wil::scope_exit([&] { stateMachine.ProcessString(L"\x1b[*x"); });
+
+    const auto top = si.GetViewport().Top();
+    const auto bufferAttr = TextAttribute{ FOREGROUND_BLUE | BACKGROUND_GREEN };
+    _FillLines(top, top + 5, L"ABCDEFGHIJ", bufferAttr);
+
+    Log::Comment(L"DECCRA copies an area, including its attributes.");
+    stateMachine.ProcessString(L"\x1b[1;1;2;3;1;3;5;1$v");
+    VERIFY_IS_TRUE(_ValidateLineContains(top + 2, L"ABCDABCHIJ", bufferAttr));
+    VERIFY_IS_TRUE(_ValidateLineContains(top + 3, L"ABCDABCHIJ", bufferAttr));
+
+    Log::Comment(L"DECCRA copies overlapping areas as if the source was read first.");
+    stateMachine.ProcessString(L"\x1b[1;1;1;9;1;1;2;1$v");
+    VERIFY_IS_TRUE(_ValidateLineContains(top, L"AABCDEFGHI", bufferAttr));
+
+    Log::Comment(L"DECFRA fills an area with a character in the current attributes.");
+    const auto fillAttr = TextAttribute{ FOREGROUND_RED | BACKGROUND_BLUE };
+    si.SetAttributes(fillAttr);
+    stateMachine.ProcessString(L"\x1b[42;5;2;5;4$x");
+    VERIFY_IS_TRUE(_ValidateLineContains({ 0, top + 4 }, L"A", bufferAttr));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 1, top + 4 }, L"***", fillAttr));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 4, top + 4 }, L"EFGHIJ", bufferAttr));
+
+    Log::Comment(L"DECERA erases an area with the current attributes.");
+    stateMachine.ProcessString(L"\x1b[4;1;4;2$z");
+    VERIFY_IS_TRUE(_ValidateLineContains({ 0, top + 3 }, L"  ", fillAttr));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 2, top + 3 }, L"CDABCHIJ", bufferAttr));
+
+    Log::Comment(L"DECSERA erases an area but keeps its attributes.");
+    stateMachine.ProcessString(L"\x1b[2;3;2;4${");
+    VERIFY_IS_TRUE(_ValidateLineContains(top + 1, L"AB  EFGHIJ", bufferAttr));
+
+    Log::Comment(L"DECCARA changes the attributes of a stream of characters by default.");
+    auto underlinedAttr = bufferAttr;
+    underlinedAttr.SetUnderlined(true);
+    stateMachine.ProcessString(L"\x1b[1;9;2;2;4$r");
+    VERIFY_IS_TRUE(_ValidateLineContains({ 0, top }, L"AABCDEFG", bufferAttr));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 8, top }, L"HI", underlinedAttr));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 0, top + 1 }, L"AB", underlinedAttr));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 2, top + 1 }, L"  EFGHIJ", bufferAttr));
+
+    Log::Comment(L"DECCARA changes the attributes of a rectangle after DECSACE 2.");
+    auto intenseBufferAttr = bufferAttr;
+    intenseBufferAttr.SetIntense(true);
+    auto intenseFillAttr = fillAttr;
+    intenseFillAttr.SetIntense(true);
+    stateMachine.ProcessString(L"\x1b[2*x\x1b[4;3;5;4;1$r");
+    VERIFY_IS_TRUE(_ValidateLineContains({ 0, top + 3 }, L"  ", fillAttr));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 2, top + 3 }, L"CD", intenseBufferAttr));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 4, top + 3 }, L"ABCHIJ", bufferAttr));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 2, top + 4 }, L"**", intenseFillAttr));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 4, top + 4 }, L"EFGHIJ", bufferAttr));
+}
+
+void ScreenBufferTests::SixelImages()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+    auto& stateMachine = si.GetStateMachine();
+    const auto& textBuffer = si.GetTextBuffer();
+    const auto& cursor = textBuffer.GetCursor();
+    WI_SetFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+
+    const auto top = si.GetViewport().Top();
+
+    // A red image of 20x60 pixels, which covers 2 columns and 3 rows.
+    std::wstring image = L"\x1bP0;1q\"1;1;20;60#1;2;100;0;0#1";
+    for (auto band = 0; band < 10; band++)
+    {
+        image += L"!20~-";
+    }
+    image += L"\x1b\\";
+
+    Log::Comment(L"The image is attached to the rows at the cursor position.");
+    stateMachine.ProcessString(L"\x1b[2;5H");
+    stateMachine.ProcessString(image);
+    for (auto row = top + 1; row < top + 4; row++)
+    {
+        const auto& slice = textBuffer.GetRowByOffset(row).GetImageSlice();
+        VERIFY_IS_NOT_NULL(slice);
+        VERIFY_ARE_EQUAL(4, slice->ColumnBegin());
+        VERIFY_ARE_EQUAL(6, slice->ColumnEnd());
+        VERIFY_ARE_EQUAL(0xffff0000u, slice->PixelRow(0)[0]);
+    }
+    VERIFY_IS_NULL(textBuffer.GetRowByOffset(top + 4).GetImageSlice());
+
+    Log::Comment(L"The cursor is moved to the line below the image.");
+    VERIFY_ARE_EQUAL(til::point(4, top + 4), cursor.GetPosition());
+
+    Log::Comment(L"Text written over the image replaces that part of it.");
+    stateMachine.ProcessString(L"\x1b[3;5HX");
+    const auto& slice = textBuffer.GetRowByOffset(top + 2).GetImageSlice();
+    VERIFY_IS_NOT_NULL(slice);
+    VERIFY_ARE_EQUAL(5, slice->ColumnBegin());
+    VERIFY_ARE_EQUAL(6, slice->ColumnEnd());
+
+    Log::Comment(L"Erasing the lines removes the image.");
+    stateMachine.ProcessString(L"\x1b[2;1H\x1b[2K\x1b[3;1H\x1b[2K\x1b[4;1H\x1b[2K");
+    for (auto row = top + 1; row < top + 4; row++)
+    {
+        VERIFY_IS_NULL(textBuffer.GetRowByOffset(row).GetImageSlice());
+    }
+}
+
 void ScreenBufferTests::EraseScrollbackTests()
 {
     auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -158,4 +158,133 @@ class SearchTests
         Search s(gci.renderData, L"\x304b", Search::Direction::Backward, Search::Sensitivity::CaseInsensitive);
         DoFoundChecks(s, coordStartExpected, -1);
     }
+
+    void DoFindAllChecks(const std::wstring& needle, const Search::Sensitivity sensitivity)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        // FindAll must agree with iterating through the buffer with FindNext.
+        std::vector<Search::Match> expected;
+        Search iterating(gci.renderData, needle, Search::Direction::Forward, sensitivity);
+        while (iterating.FindNext())
+        {
+            expected.emplace_back(iterating.GetFoundLocation());
+        }
+
+        Search s(gci.renderData, needle, Search::Direction::Forward, sensitivity);
+        const auto matches = s.FindAll();
+        VERIFY_ARE_EQUAL(expected.size(), matches.size());
+        for (size_t i = 0; i < matches.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(expected[i].first, matches[i].first);
+            VERIFY_ARE_EQUAL(expected[i].second, matches[i].second);
+        }
+
+        // Without a selection the forward anchor is the start of the buffer.
+        const auto index = s.FindNext(matches);
+        VERIFY_IS_TRUE(index.has_value());
+        VERIFY_ARE_EQUAL(0u, *index);
+        VERIFY_ARE_EQUAL(matches.front().first, s._coordSelStart);
+        VERIFY_ARE_EQUAL(matches.front().second, s._coordSelEnd);
+    }
+
+    TEST_METHOD(FindAllCaseSensitive)
+    {
+        DoFindAllChecks(L"AB", Search::Sensitivity::CaseSensitive);
+        DoFindAllChecks(L"\x304b", Search::Sensitivity::CaseSensitive);
+    }
+
+    TEST_METHOD(FindAllCaseInsensitive)
+    {
+        DoFindAllChecks(L"ab", Search::Sensitivity::CaseInsensitive);
+        DoFindAllChecks(L"\x304b", Search::Sensitivity::CaseInsensitive);
+    }
+
+    TEST_METHOD(FindAllBackwardPicksLastMatch)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        Search s(gci.renderData, L"AB", Search::Direction::Backward, Search::Sensitivity::CaseSensitive);
+        const auto matches = s.FindAll();
+        VERIFY_IS_FALSE(matches.empty());
+
+        const auto index = s.FindNext(matches);
+        VERIFY_IS_TRUE(index.has_value());
+        VERIFY_ARE_EQUAL(matches.size() - 1, *index);
+    }
+
+    TEST_METHOD(FindAllInChunksMatchesFindAll)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        // Every chunk is a single row, so that the matches which continue on
+        // the next row are found by the chunk of the next row.
+        for (const auto needle : { L"AB", L"\x304b" })
+        {
+            Search s(gci.renderData, needle, Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+            const auto expected = s.FindAll();
+
+            std::vector<Search::Match> matches;
+            const auto endRow = gci.renderData.GetTextBufferEndPosition().Y + 1;
+            for (til::CoordType row = 0; row < endRow; ++row)
+            {
+                s.FindAll(row, row + 1, matches);
+            }
+
+            VERIFY_ARE_EQUAL(expected.size(), matches.size());
+            for (size_t i = 0; i < matches.size(); ++i)
+            {
+                VERIFY_ARE_EQUAL(expected[i].first, matches[i].first);
+                VERIFY_ARE_EQUAL(expected[i].second, matches[i].second);
+            }
+        }
+    }
+
+    TEST_METHOD(FindAllInSnapshotsMatchesFindAll)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto& textBuffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+
+        // Snapshots leave out the trailing halves of wide glyphs,
+        // which must be found all the same.
+        for (const auto needle : { L"AB", L"\x304b" })
+        {
+            Search s(gci.renderData, needle, Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+            const auto expected = s.FindAll();
+
+            std::vector<Search::Match> matches;
+            const auto endRow = gci.renderData.GetTextBufferEndPosition().Y + 1;
+            for (til::CoordType row = 0; row < endRow; ++row)
+            {
+                s.FindAll(textBuffer.SnapshotRows(row - 1, row), row, row + 1, matches);
+            }
+
+            VERIFY_ARE_EQUAL(expected.size(), matches.size());
+            for (size_t i = 0; i < matches.size(); ++i)
+            {
+                VERIFY_ARE_EQUAL(expected[i].first, matches[i].first);
+                VERIFY_ARE_EQUAL(expected[i].second, matches[i].second);
+            }
+        }
+    }
+
+    TEST_METHOD(RefineMatchesNarrowsDownResults)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        Search prefix(gci.renderData, L"A", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        auto matches = prefix.FindAll();
+
+        Search s(gci.renderData, L"AB", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        const auto expected = s.FindAll();
+        VERIFY_IS_LESS_THAN_OR_EQUAL(expected.size(), matches.size());
+
+        s.RefineMatches(matches);
+        VERIFY_ARE_EQUAL(expected.size(), matches.size());
+        for (size_t i = 0; i < matches.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(expected[i].first, matches[i].first);
+            VERIFY_ARE_EQUAL(expected[i].second, matches[i].second);
+        }
+    }
 };
@@ -102,6 +102,7 @@ class TextBufferTests
     void TestLastNonSpace(const til::CoordType cursorPosY);
 
     TEST_METHOD(TestGetLastNonSpaceCharacter);
+    TEST_METHOD(GetLastNonSpaceCharacterFollowsChanges);
 
     TEST_METHOD(TestSetWrapOnCurrentRow);
 
@@ -144,20 +145,38 @@ class TextBufferTests
     TEST_METHOD(ResizeTraditionalHighUnicodeRowRemoval);
     TEST_METHOD(ResizeTraditionalHighUnicodeColumnRemoval);
 
+    TEST_METHOD(WriteAsciiOverHighUnicode);
+    TEST_METHOD(WriteFillsAndCharInfosInRuns);
+
+    TEST_METHOD(TracksChangedRows);
+    TEST_METHOD(ScrollRowsInCircledBuffer);
+    TEST_METHOD(CachesRowTextUntilRowChanges);
+    TEST_METHOD(SharesRowSnapshotsUntilRowChanges);
+
+    TEST_METHOD(ReusesCharArenas);
+    TEST_METHOD(ResizeTraditionalInPlace);
+
     TEST_METHOD(TestBurrito);
 
     TEST_METHOD(TestAppendRTFText);
 
     void WriteLinesToBuffer(const std::vector<std::wstring>& text, TextBuffer& buffer);
     TEST_METHOD(GetWordBoundaries);
+    TEST_METHOD(WordBoundariesFollowRowChangesAndDelimiters);
+    TEST_METHOD(ResetRowsClearsContentsAndRendition);
     TEST_METHOD(MoveByWord);
     TEST_METHOD(GetGlyphBoundaries);
 
     TEST_METHOD(GetTextRects);
     TEST_METHOD(GetText);
+    TEST_METHOD(GetTextAndColorRuns);
 
     TEST_METHOD(HyperlinkTrim);
     TEST_METHOD(NoHyperlinkTrim);
+    TEST_METHOD(HyperlinkIdsAreRecycled);
+
+    TEST_METHOD(FindPatternsReusesUnchangedLines);
+    TEST_METHOD(PatternsArePrefilteredByLiteral);
 };
 
 void TextBufferTests::TestBufferCreate()
@@ -191,7 +210,8 @@ void TextBufferTests::TestBufferRowByOffset()
     auto sId = csBufferHeight / 2 - 5;
 
     const auto& row = textBuffer.GetRowByOffset(sId);
-    VERIFY_ARE_EQUAL(row.GetId(), sId);
+    const auto storageIndex = (textBuffer.GetFirstRowIndex() + sId) % csBufferHeight;
+    VERIFY_ARE_EQUAL(&textBuffer._storage.at(gsl::narrow<size_t>(storageIndex)), &row);
 }
 
 void TextBufferTests::TestWrapFlag()
@@ -560,6 +580,37 @@ void TextBufferTests::TestGetLastNonSpaceCharacter()
     TestLastNonSpace(14);
 }
 
+// This tests that the measurements GetLastNonSpaceCharacter
+// keeps around are discarded whenever a row changes.
+void TextBufferTests::GetLastNonSpaceCharacterFollowsChanges()
+{
+    const til::size bufferSize{ 20, 50 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    VERIFY_ARE_EQUAL(til::point{}, _buffer->GetLastNonSpaceCharacter());
+
+    _buffer->Write(OutputCellIterator(L"abc"), { 2, 30 });
+    VERIFY_ARE_EQUAL((til::point{ 4, 30 }), _buffer->GetLastNonSpaceCharacter());
+    VERIFY_ARE_EQUAL((til::point{ 4, 30 }), _buffer->GetLastNonSpaceCharacter());
+
+    Log::Comment(L"Writing into a row above doesn't move the end of the text.");
+    _buffer->Write(OutputCellIterator(L"0123456789"), { 0, 10 });
+    VERIFY_ARE_EQUAL((til::point{ 4, 30 }), _buffer->GetLastNonSpaceCharacter());
+
+    Log::Comment(L"Clearing the last row moves it up to the next one with text.");
+    _buffer->GetRowByOffset(30).Reset(attr);
+    VERIFY_ARE_EQUAL((til::point{ 9, 10 }), _buffer->GetLastNonSpaceCharacter());
+
+    Log::Comment(L"Modifying a row through its CharRow counts as well.");
+    _buffer->GetRowByOffset(10).GetCharRow().ClearGlyph(9);
+    VERIFY_ARE_EQUAL((til::point{ 8, 10 }), _buffer->GetLastNonSpaceCharacter());
+
+    Log::Comment(L"Other viewports aren't answered from the last result.");
+    VERIFY_ARE_EQUAL(til::point{}, _buffer->GetLastNonSpaceCharacter(Viewport::FromDimensions({ 0, 0 }, { 20, 6 })));
+}
+
 void TextBufferTests::TestSetWrapOnCurrentRow()
 {
     auto& textBuffer = GetTbi();
@@ -1924,7 +1975,7 @@ void TextBufferTests::ScrollBufferRotationPreservesHighUnicode()
 }
 
 // This tests that rows removed from the buffer while resizing traditionally will also drop the high unicode
-// characters from the Unicode Storage buffer
+// characters from their Unicode Storage
 void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
 {
     // Set up a text buffer for us
@@ -1948,18 +1999,21 @@ void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_ARE_EQUAL(1u, _buffer->_storage[pos.Y].GetUnicodeStorage().size(), L"There should be one item in the row's storage.");
 
     // Perform resize to trim off the row of the buffer that included the emoji
     til::size trimmedBufferSize{ bufferSize.X, bufferSize.Y - 1 };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    for (const auto& row : _buffer->_storage)
+    {
+        VERIFY_IS_TRUE(row.GetUnicodeStorage().empty(), L"The storage of all remaining rows should be empty.");
+    }
 }
 
 // This tests that columns removed from the buffer while resizing traditionally will also drop the high unicode
-// characters from the Unicode Storage buffer
+// characters from their Unicode Storage
 void TextBufferTests::ResizeTraditionalHighUnicodeColumnRemoval()
 {
     // Set up a text buffer for us
@@ -1983,14 +2037,312 @@ void TextBufferTests::ResizeTraditionalHighUnicodeColumnRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_ARE_EQUAL(1u, _buffer->_storage[pos.Y].GetUnicodeStorage().size(), L"There should be one item in the row's storage.");
 
     // Perform resize to trim off the column of the buffer that included the emoji
     til::size trimmedBufferSize{ bufferSize.X - 1, bufferSize.Y };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    VERIFY_IS_TRUE(_buffer->_storage[pos.Y].GetUnicodeStorage().empty(), L"The row's storage should now be empty.");
+}
+
+// This tests that overwriting high unicode characters with a run of plain ASCII text
+// also drops them from the Unicode Storage of their row
+void TextBufferTests::WriteAsciiOverHighUnicode()
+{
+    // Set up a text buffer for us
+    const til::size bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    // Put an emoji into the middle of where we're going to write.
+    // This is the pile of poo emoji: 💩
+    const til::point pos{ 2, 0 };
+    _buffer->_storage[pos.Y].GetCharRow().GlyphAt(pos.X) = L"\xD83D\xDCA9";
+    VERIFY_ARE_EQUAL(1u, _buffer->_storage[pos.Y].GetUnicodeStorage().size(), L"There should be one item in the row's storage.");
+
+    const TextAttribute writeAttr{ FOREGROUND_GREEN };
+    const std::wstring_view text{ L"Hello, world!" };
+    const auto it = _buffer->Write(OutputCellIterator(text, writeAttr), { 0, pos.Y });
+    VERIFY_IS_FALSE(it);
+
+    auto& row = _buffer->_storage[pos.Y];
+    VERIFY_IS_TRUE(row.GetUnicodeStorage().empty(), L"The row's storage should now be empty.");
+    VERIFY_ARE_EQUAL(String(L"Hello, world!"), String(row.GetText().substr(0, text.size()).c_str()));
+
+    for (til::CoordType i = 0; i < gsl::narrow<til::CoordType>(text.size()); ++i)
+    {
+        VERIFY_IS_TRUE(row.GetCharRow().DbcsAttrAt(i).IsSingle());
+        VERIFY_ARE_EQUAL(writeAttr, row.GetAttrRow().GetAttrByColumn(i));
+    }
+    VERIFY_ARE_EQUAL(attr, row.GetAttrRow().GetAttrByColumn(gsl::narrow<til::CoordType>(text.size())));
+}
+
+// This tests that fills and CHAR_INFOs, which are written in bulk as long as they're
+// narrow, end up in the row just like they would cell by cell
+void TextBufferTests::WriteFillsAndCharInfosInRuns()
+{
+    const til::size bufferSize{ 10, 2 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+    auto& row = _buffer->_storage[0];
+
+    // Put an emoji where the fill goes, which it has to drop from the row's storage.
+    row.GetCharRow().GlyphAt(1) = L"\xD83D\xDCA9";
+
+    // A fill that's longer than the row stops at its end and sets its wrap flag.
+    const TextAttribute fillAttr{ FOREGROUND_RED };
+    const OutputCellIterator fill(L'x', fillAttr, 12);
+    auto it = _buffer->WriteLine(fill, { 0, 0 }, true);
+    VERIFY_IS_TRUE(it);
+    VERIFY_ARE_EQUAL(10, it.GetCellDistance(fill));
+    VERIFY_IS_TRUE(row.GetUnicodeStorage().empty());
+    VERIFY_IS_TRUE(row.WasWrapForced());
+    VERIFY_ARE_EQUAL(String(L"xxxxxxxxxx"), String(row.GetText().c_str()));
+    VERIFY_ARE_EQUAL(fillAttr, row.GetAttrRow().GetAttrByColumn(9));
+
+    // A fill of only a color leaves the text alone.
+    const TextAttribute colorAttr{ FOREGROUND_BLUE };
+    _buffer->Write(OutputCellIterator(colorAttr, 3), { 2, 0 }, false);
+    VERIFY_ARE_EQUAL(String(L"xxxxxxxxxx"), String(row.GetText().c_str()));
+    VERIFY_ARE_EQUAL(fillAttr, row.GetAttrRow().GetAttrByColumn(1));
+    VERIFY_ARE_EQUAL(colorAttr, row.GetAttrRow().GetAttrByColumn(2));
+    VERIFY_ARE_EQUAL(colorAttr, row.GetAttrRow().GetAttrByColumn(4));
+    VERIFY_ARE_EQUAL(fillAttr, row.GetAttrRow().GetAttrByColumn(5));
+
+    // CHAR_INFOs with different colors, interrupted by a wide glyph.
+    std::array<CHAR_INFO, 5> charInfos{};
+    charInfos[0].Char.UnicodeChar = L'a';
+    charInfos[0].Attributes = FOREGROUND_GREEN;
+    charInfos[1].Char.UnicodeChar = L'b';
+    charInfos[1].Attributes = FOREGROUND_GREEN | BACKGROUND_RED;
+    charInfos[2].Char.UnicodeChar = L'\x30a2';
+    charInfos[2].Attributes = FOREGROUND_GREEN | COMMON_LVB_LEADING_BYTE;
+    charInfos[3].Char.UnicodeChar = L'\x30a2';
+    charInfos[3].Attributes = FOREGROUND_GREEN | COMMON_LVB_TRAILING_BYTE;
+    charInfos[4].Char.UnicodeChar = L'c';
+    charInfos[4].Attributes = FOREGROUND_GREEN;
+    it = _buffer->Write(OutputCellIterator(gsl::make_span(charInfos)), { 0, 0 }, false);
+    VERIFY_IS_FALSE(it);
+
+    VERIFY_ARE_EQUAL(String(L"ab\x30a2" L"cxxxxx"), String(row.GetText().c_str()));
+    VERIFY_IS_TRUE(row.GetCharRow().DbcsAttrAt(1).IsSingle());
+    VERIFY_IS_TRUE(row.GetCharRow().DbcsAttrAt(2).IsLeading());
+    VERIFY_IS_TRUE(row.GetCharRow().DbcsAttrAt(3).IsTrailing());
+    VERIFY_IS_TRUE(row.GetCharRow().DbcsAttrAt(4).IsSingle());
+    VERIFY_ARE_EQUAL(TextAttribute{ FOREGROUND_GREEN }, row.GetAttrRow().GetAttrByColumn(0));
+    VERIFY_ARE_EQUAL((TextAttribute{ FOREGROUND_GREEN | BACKGROUND_RED }), row.GetAttrRow().GetAttrByColumn(1));
+    VERIFY_ARE_EQUAL(TextAttribute{ FOREGROUND_GREEN }, row.GetAttrRow().GetAttrByColumn(3));
+    VERIFY_ARE_EQUAL(TextAttribute{ FOREGROUND_GREEN }, row.GetAttrRow().GetAttrByColumn(4));
+    VERIFY_ARE_EQUAL(fillAttr, row.GetAttrRow().GetAttrByColumn(5));
+}
+
+void TextBufferTests::TracksChangedRows()
+{
+    const til::size bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    auto revision = _buffer->GetRevision();
+    VERIFY_IS_TRUE(_buffer->GetRowsChangedSince(revision).empty());
+    VERIFY_IS_FALSE(_buffer->HasChangedSince(revision, 0, bufferSize.Y - 1));
+
+    Log::Comment(L"Writing text only marks the rows it was written into.");
+    _buffer->Write(OutputCellIterator(L"Hello"), { 0, 3 });
+    _buffer->Write(OutputCellIterator(L"World"), { 0, 5 });
+    VERIFY_IS_TRUE((std::vector<til::CoordType>{ 3, 5 }) == _buffer->GetRowsChangedSince(revision));
+    VERIFY_IS_FALSE(_buffer->HasChangedSince(revision, 0, 2));
+    VERIFY_IS_TRUE(_buffer->HasChangedSince(revision, 0, 3));
+    VERIFY_IS_FALSE(_buffer->HasChangedSince(revision, 6, bufferSize.Y - 1));
+    VERIFY_IS_TRUE(_buffer->GetRevision() > revision);
+
+    Log::Comment(L"Reading doesn't mark anything.");
+    revision = _buffer->GetRevision();
+    const auto& constBuffer = *_buffer;
+    VERIFY_ARE_EQUAL(String(L"Hello"), String(constBuffer.GetRowByOffset(3).GetText().substr(0, 5).c_str()));
+    VERIFY_IS_TRUE(_buffer->GetRowsChangedSince(revision).empty());
+
+    Log::Comment(L"Scrolling rows marks every row that moved.");
+    _buffer->ScrollRows(3, 1, 2);
+    VERIFY_IS_TRUE((std::vector<til::CoordType>{ 3, 4, 5 }) == _buffer->GetRowsChangedSince(revision));
+
+    Log::Comment(L"Incrementing the circular buffer moves all rows.");
+    revision = _buffer->GetRevision();
+    VERIFY_IS_TRUE(_buffer->IncrementCircularBuffer());
+    VERIFY_ARE_EQUAL(gsl::narrow<size_t>(bufferSize.Y), _buffer->GetRowsChangedSince(revision).size());
+    VERIFY_IS_TRUE(_buffer->HasChangedSince(revision, 0, 0));
+}
+
+void TextBufferTests::ScrollRowsInCircledBuffer()
+{
+    const til::size bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    Log::Comment(L"Circle the buffer, so that the first row isn't stored at the front anymore.");
+    for (auto i = 0; i < 7; ++i)
+    {
+        VERIFY_IS_TRUE(_buffer->IncrementCircularBuffer());
+    }
+    for (til::CoordType y = 0; y < bufferSize.Y; ++y)
+    {
+        _buffer->Write(OutputCellIterator(std::wstring(1, static_cast<wchar_t>(L'0' + y))), { 0, y });
+    }
+
+    const auto rowsToString = [&]() {
+        std::wstring str;
+        for (til::CoordType y = 0; y < bufferSize.Y; ++y)
+        {
+            str.push_back(_buffer->GetRowByOffset(y).GetText().at(0));
+        }
+        return str;
+    };
+
+    Log::Comment(L"Move rows 5 to 7 up by 2 and down by 3 again. This wraps around the end of the storage.");
+    _buffer->ScrollRows(5, 3, -2);
+    VERIFY_ARE_EQUAL(String(L"0125673489"), String(rowsToString().c_str()));
+    _buffer->ScrollRows(3, 3, 3);
+    VERIFY_ARE_EQUAL(String(L"0123485679"), String(rowsToString().c_str()));
+
+    Log::Comment(L"The moved rows must still allow walking the buffer row by row.");
+    for (til::CoordType y = 1; y < bufferSize.Y; ++y)
+    {
+        const auto& row = _buffer->GetRowByOffset(y);
+        VERIFY_ARE_EQUAL(&_buffer->GetRowByOffset(y - 1), &_buffer->_GetPrevRowNoWrap(row));
+    }
+}
+
+void TextBufferTests::CachesRowTextUntilRowChanges()
+{
+    const til::size bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    _buffer->Write(OutputCellIterator(L"Hello"), { 0, 3 });
+    _buffer->Write(OutputCellIterator(L"World"), { 0, 5 });
+
+    const auto& constBuffer = *_buffer;
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"Hello" }, constBuffer.GetRowText(3, 0, 5));
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"ell" }, constBuffer.GetRowText(3, 1, 4));
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"World" }, constBuffer.GetRowText(5, 0, 5));
+    VERIFY_ARE_EQUAL(gsl::narrow<size_t>(bufferSize.X), constBuffer.GetRowText(3, 0, bufferSize.X).size());
+
+    Log::Comment(L"Columns outside of the row are clamped.");
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"Hello" }, constBuffer.GetRowText(3, -1, 5));
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"" }, constBuffer.GetRowText(3, 5, 2));
+
+    Log::Comment(L"Writing into a row replaces its cached text.");
+    _buffer->Write(OutputCellIterator(L"J"), { 0, 3 });
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"Jello" }, constBuffer.GetRowText(3, 0, 5));
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"World" }, constBuffer.GetRowText(5, 0, 5));
+
+    Log::Comment(L"Rows that moved return the text of their new offset.");
+    VERIFY_IS_TRUE(_buffer->IncrementCircularBuffer());
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"Jello" }, constBuffer.GetRowText(2, 0, 5));
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"World" }, constBuffer.GetRowText(4, 0, 5));
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"     " }, constBuffer.GetRowText(3, 0, 5));
+}
+
+void TextBufferTests::SharesRowSnapshotsUntilRowChanges()
+{
+    const til::size bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    TextAttribute red{ 0x7f };
+    red.SetForeground(RGB(255, 0, 0));
+    _buffer->Write(OutputCellIterator(L"Hello"), { 0, 3 });
+    _buffer->Write(OutputCellIterator(L"World", red), { 0, 4 });
+    _buffer->GetRowByOffset(3).SetWrapForced(true);
+
+    const auto first = _buffer->SnapshotRows(3, 4);
+    VERIFY_ARE_EQUAL(3, first.firstRow);
+    VERIFY_ARE_EQUAL(size_t{ 2 }, first.rows.size());
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"Hello" }, first.rows[0]->GetText(0, 5));
+    VERIFY_IS_TRUE(first.rows[0]->WasWrapForced());
+    VERIFY_ARE_EQUAL(red, first.rows[1]->GetAttrByColumn(4));
+    VERIFY_ARE_EQUAL(attr, first.rows[1]->GetAttrByColumn(5));
+    VERIFY_ARE_EQUAL(2, first.rows[1]->GetColumnAtTextOffset(2));
+
+    Log::Comment(L"Rows that didn't change share their snapshot.");
+    _buffer->Write(OutputCellIterator(L"J"), { 0, 3 });
+    const auto second = _buffer->SnapshotRows(3, 4);
+    VERIFY_IS_TRUE(first.rows[0] != second.rows[0]);
+    VERIFY_IS_TRUE(first.rows[1] == second.rows[1]);
+
+    Log::Comment(L"Snapshots are unaffected by changes to the buffer.");
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"Hello" }, first.rows[0]->GetText(0, 5));
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"Jello" }, second.rows[0]->GetText(0, 5));
+
+    Log::Comment(L"Ranges are clamped to the buffer.");
+    VERIFY_ARE_EQUAL(size_t{ 2 }, _buffer->SnapshotRows(8, 20).rows.size());
+}
+
+void TextBufferTests::ReusesCharArenas()
+{
+    // Use an odd size that no other test uses, so that we know which arena we get back.
+    const til::size bufferSize{ 77, 13 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+    _buffer->Write(OutputCellIterator(L"Hello, world!"), { 0, 0 });
+    const auto arena = _buffer->_charArena.get();
+    _buffer.reset();
+
+    Log::Comment(L"A buffer of the same size reuses the arena, cleared back to spaces.");
+    _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+    VERIFY_ARE_EQUAL(arena, _buffer->_charArena.get());
+    VERIFY_IS_FALSE(_buffer->GetRowByOffset(0).GetCharRow().ContainsText());
+
+    Log::Comment(L"A buffer of a different size doesn't.");
+    auto other = std::make_unique<TextBuffer>(til::size{ bufferSize.X + 1, bufferSize.Y }, attr, cursorSize, false, _renderer);
+    VERIFY_ARE_NOT_EQUAL(arena, other->_charArena.get());
+}
+
+void TextBufferTests::ResizeTraditionalInPlace()
+{
+    const til::size bufferSize{ 8, 6 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+    for (til::CoordType y = 0; y < bufferSize.Y; ++y)
+    {
+        buffer.Write(OutputCellIterator(L"ABCDEFGH"), { 0, y });
+    }
+    const auto arena = buffer._charArena.get();
+
+    Log::Comment(L"Shrinking keeps using the existing arena.");
+    VERIFY_SUCCEEDED(buffer.ResizeTraditional({ 5, 4 }));
+    VERIFY_ARE_EQUAL(arena, buffer._charArena.get());
+    VERIFY_ARE_EQUAL(4, buffer.TotalRowCount());
+    VERIFY_ARE_EQUAL(std::wstring{ L"ABCDE" }, buffer.GetRowByOffset(3).GetText());
+
+    Log::Comment(L"Growing back within the arena doesn't resurrect the cut off glyphs.");
+    VERIFY_SUCCEEDED(buffer.ResizeTraditional(bufferSize));
+    VERIFY_ARE_EQUAL(arena, buffer._charArena.get());
+    VERIFY_ARE_EQUAL(bufferSize.Y, buffer.TotalRowCount());
+    for (til::CoordType y = 0; y < 4; ++y)
+    {
+        VERIFY_ARE_EQUAL(std::wstring{ L"ABCDE   " }, buffer.GetRowByOffset(y).GetText());
+    }
+    for (til::CoordType y = 4; y < bufferSize.Y; ++y)
+    {
+        VERIFY_IS_FALSE(buffer.GetRowByOffset(y).GetCharRow().ContainsText());
+    }
+
+    Log::Comment(L"Growing beyond the arena allocates a new one.");
+    VERIFY_SUCCEEDED(buffer.ResizeTraditional({ bufferSize.X + 1, bufferSize.Y }));
+    VERIFY_ARE_NOT_EQUAL(arena, buffer._charArena.get());
+    VERIFY_ARE_EQUAL(std::wstring{ L"ABCDE    " }, buffer.GetRowByOffset(0).GetText());
 }
 
 void TextBufferTests::TestBurrito()
@@ -2017,31 +2369,31 @@ void TextBufferTests::TestBurrito()
 void TextBufferTests::TestAppendRTFText()
 {
     {
-        std::ostringstream contentStream;
+        std::string content;
         const auto ascii = L"This is some Ascii \\ {}";
-        TextBuffer::_AppendRTFText(contentStream, ascii);
-        VERIFY_ARE_EQUAL("This is some Ascii \\\\ \\{\\}", contentStream.str());
+        TextBuffer::_AppendRTFText(content, ascii);
+        VERIFY_ARE_EQUAL("This is some Ascii \\\\ \\{\\}", content);
     }
     {
-        std::ostringstream contentStream;
+        std::string content;
         // "Low code units: á é í ó ú ⮁ ⮂" in UTF-16
         const auto lowCodeUnits = L"Low code units: \x00E1 \x00E9 \x00ED \x00F3 \x00FA \x2B81 \x2B82";
-        TextBuffer::_AppendRTFText(contentStream, lowCodeUnits);
-        VERIFY_ARE_EQUAL("Low code units: \\u225? \\u233? \\u237? \\u243? \\u250? \\u11137? \\u11138?", contentStream.str());
+        TextBuffer::_AppendRTFText(content, lowCodeUnits);
+        VERIFY_ARE_EQUAL("Low code units: \\u225? \\u233? \\u237? \\u243? \\u250? \\u11137? \\u11138?", content);
     }
     {
-        std::ostringstream contentStream;
+        std::string content;
         // "High code units: ꞵ ꞷ" in UTF-16
         const auto highCodeUnits = L"High code units: \xA7B5 \xA7B7";
-        TextBuffer::_AppendRTFText(contentStream, highCodeUnits);
-        VERIFY_ARE_EQUAL("High code units: \\u-22603? \\u-22601?", contentStream.str());
+        TextBuffer::_AppendRTFText(content, highCodeUnits);
+        VERIFY_ARE_EQUAL("High code units: \\u-22603? \\u-22601?", content);
     }
     {
-        std::ostringstream contentStream;
+        std::string content;
         // "Surrogates: 🍦 👾 👀" in UTF-16
         const auto surrogates = L"Surrogates: \xD83C\xDF66 \xD83D\xDC7E \xD83D\xDC40";
-        TextBuffer::_AppendRTFText(contentStream, surrogates);
-        VERIFY_ARE_EQUAL("Surrogates: \\u-10180?\\u-8346? \\u-10179?\\u-9090? \\u-10179?\\u-9152?", contentStream.str());
+        TextBuffer::_AppendRTFText(content, surrogates);
+        VERIFY_ARE_EQUAL("Surrogates: \\u-10180?\\u-8346? \\u-10179?\\u-9090? \\u-10179?\\u-9152?", content);
     }
 }
 
@@ -2068,6 +2420,73 @@ void TextBufferTests::WriteLinesToBuffer(const std::vector<std::wstring>& text,
     }
 }
 
+void TextBufferTests::WordBoundariesFollowRowChangesAndDelimiters()
+{
+    const til::size bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    _buffer->Write(OutputCellIterator(L"foo-bar baz"), { 0, 2 });
+
+    const auto& constBuffer = *_buffer;
+    const std::wstring_view delimiters{ L" -" };
+    VERIFY_ARE_EQUAL(til::point(4, 2), constBuffer.GetWordStart({ 5, 2 }, delimiters));
+    VERIFY_ARE_EQUAL(til::point(6, 2), constBuffer.GetWordEnd({ 5, 2 }, delimiters));
+
+    Log::Comment(L"Other delimiters must not use the classes of the previous ones.");
+    const std::wstring_view spaceOnly{ L" " };
+    VERIFY_ARE_EQUAL(til::point(0, 2), constBuffer.GetWordStart({ 5, 2 }, spaceOnly));
+    VERIFY_ARE_EQUAL(til::point(6, 2), constBuffer.GetWordEnd({ 5, 2 }, spaceOnly));
+
+    Log::Comment(L"Writing into a row must update its classes.");
+    _buffer->Write(OutputCellIterator(L"x"), { 3, 2 });
+    VERIFY_ARE_EQUAL(til::point(0, 2), constBuffer.GetWordStart({ 5, 2 }, delimiters));
+
+    Log::Comment(L"Rows that moved must use the classes of their new offset.");
+    VERIFY_IS_TRUE(_buffer->IncrementCircularBuffer());
+    VERIFY_ARE_EQUAL(til::point(8, 1), constBuffer.GetWordStart({ 9, 1 }, delimiters));
+    VERIFY_ARE_EQUAL(til::point(0, 2), constBuffer.GetWordStart({ 5, 2 }, delimiters));
+    VERIFY_ARE_EQUAL(til::point(79, 2), constBuffer.GetWordEnd({ 5, 2 }, delimiters));
+}
+
+void TextBufferTests::ResetRowsClearsContentsAndRendition()
+{
+    const til::size bufferSize{ 20, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    for (til::CoordType row = 0; row < bufferSize.Y; row++)
+    {
+        _buffer->Write(OutputCellIterator(L"Hello", TextAttribute{ 0x1e }), { 0, row });
+        _buffer->GetRowByOffset(row).SetWrapForced(true);
+        _buffer->GetRowByOffset(row).SetLineRendition(LineRendition::DoubleWidth);
+    }
+
+    const TextAttribute eraseAttr{ 0x42 };
+    _buffer->ResetRows(3, 7, eraseAttr);
+
+    const auto& constBuffer = *_buffer;
+    for (til::CoordType row = 0; row < bufferSize.Y; row++)
+    {
+        const auto& bufferRow = constBuffer.GetRowByOffset(row);
+        const auto erased = row >= 3 && row < 7;
+        Log::Comment(NoThrowString().Format(L"Row %d", row));
+        VERIFY_ARE_EQUAL(!erased, bufferRow.WasWrapForced());
+        VERIFY_ARE_EQUAL(erased ? LineRendition::SingleWidth : LineRendition::DoubleWidth, bufferRow.GetLineRendition());
+        VERIFY_ARE_EQUAL(erased ? std::wstring(bufferSize.X, L' ') : std::wstring{ L"Hello" } + std::wstring(bufferSize.X - 5, L' '), bufferRow.GetText());
+        VERIFY_ARE_EQUAL(erased ? eraseAttr : TextAttribute{ 0x1e }, bufferRow.GetAttrRow().GetAttrByColumn(0));
+    }
+
+    Log::Comment(L"Ranges outside of the buffer must be clamped.");
+    _buffer->ResetRows(-5, 1, eraseAttr);
+    _buffer->ResetRows(9, 100, eraseAttr);
+    VERIFY_ARE_EQUAL(eraseAttr, constBuffer.GetRowByOffset(0).GetAttrRow().GetAttrByColumn(0));
+    VERIFY_ARE_EQUAL(eraseAttr, constBuffer.GetRowByOffset(9).GetAttrRow().GetAttrByColumn(0));
+    VERIFY_ARE_EQUAL(TextAttribute{ 0x1e }, constBuffer.GetRowByOffset(8).GetAttrRow().GetAttrByColumn(0));
+}
+
 void TextBufferTests::GetWordBoundaries()
 {
     til::size bufferSize{ 80, 9001 };
@@ -2626,6 +3045,43 @@ void TextBufferTests::GetText()
 
 // This tests that when we increment the circular buffer, obsolete hyperlink references
 // are removed from the hyperlink map
+void TextBufferTests::GetTextAndColorRuns()
+{
+    til::size bufferSize{ 10, 20 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    const std::vector<std::wstring> bufferText = { L"12345",
+                                                   L"  345",
+                                                   L"123  ",
+                                                   L"  3  " };
+    WriteLinesToBuffer(bufferText, *_buffer);
+
+    // Color the "3"s of the first two rows differently.
+    _buffer->GetRowByOffset(0).GetAttrRow().Replace(2, 3, TextAttribute{ 0x1f });
+    _buffer->GetRowByOffset(1).GetAttrRow().Replace(2, 3, TextAttribute{ 0x1f });
+
+    const auto GetAttributeColors = [](const TextAttribute& attr) {
+        return std::pair<COLORREF, COLORREF>{ attr.GetLegacyAttributes(), 0 };
+    };
+
+    const auto textRects = _buffer->GetTextRects({ 0, 0 }, { 4, 3 }, false, false);
+    const auto textData = _buffer->GetText(true, true, textRects, GetAttributeColors);
+    const auto runs = _buffer->GetTextAndColorRuns(true, true, textRects, GetAttributeColors);
+
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"12345\r\n  345\r\n123\r\n  3" }, std::wstring_view{ runs.text });
+    VERIFY_ARE_EQUAL(textData.text.size(), runs.rowEnds.size());
+
+    Log::Comment(L"Adjacent cells with the same colors must be merged into one run.");
+    // "12", "3", "45", "\r\n", "  ", "3", "45", "\r\n", "123", "\r\n", "  3"
+    VERIFY_ARE_EQUAL(11u, runs.runs.size());
+
+    Log::Comment(L"The runs must produce the same HTML and RTF as the per-character colors.");
+    VERIFY_ARE_EQUAL(TextBuffer::GenHTML(textData, 12, L"Consolas", 0), TextBuffer::GenHTML(runs, 12, L"Consolas", 0));
+    VERIFY_ARE_EQUAL(TextBuffer::GenRTF(textData, 12, L"Consolas", 0), TextBuffer::GenRTF(runs, 12, L"Consolas", 0));
+}
+
 void TextBufferTests::HyperlinkTrim()
 {
     // Set up a text buffer for us
@@ -2704,3 +3160,125 @@ void TextBufferTests::NoHyperlinkTrim()
     VERIFY_ARE_EQUAL(_buffer->GetHyperlinkUriFromId(id), url);
     VERIFY_ARE_EQUAL(_buffer->_hyperlinkCustomIdMap[finalCustomId], id);
 }
+
+// This tests that the IDs of pruned hyperlinks are handed out again
+// once the 16-bit ID space is exhausted, instead of IDs still in use.
+void TextBufferTests::HyperlinkIdsAreRecycled()
+{
+    const til::size bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    static constexpr std::wstring_view url{ L"test.url" };
+
+    // One hyperlink in the first row, which gets pruned, and one in the last row, which doesn't.
+    const auto prunedId = _buffer->GetHyperlinkId(url, {});
+    TextAttribute newAttr{ 0x7f };
+    newAttr.SetHyperlinkId(prunedId);
+    _buffer->GetRowByOffset(0).GetAttrRow().SetAttrToEnd(70, newAttr);
+    _buffer->AddHyperlinkToMap(url, prunedId);
+
+    const auto liveId = _buffer->GetHyperlinkId(url, {});
+    newAttr.SetHyperlinkId(liveId);
+    _buffer->GetRowByOffset(9).GetAttrRow().SetAttrToEnd(70, newAttr);
+    _buffer->AddHyperlinkToMap(url, liveId);
+
+    _buffer->IncrementCircularBuffer();
+    VERIFY_ARE_EQUAL(_buffer->_hyperlinkMap.find(prunedId), _buffer->_hyperlinkMap.end());
+    VERIFY_ARE_EQUAL(_buffer->GetHyperlinkUriFromId(liveId), url);
+
+    // The pruned ID isn't reused while there are fresh ones left.
+    for (auto id = _buffer->GetHyperlinkId(url, {}); id != UINT16_MAX; id = _buffer->GetHyperlinkId(url, {}))
+    {
+        VERIFY_ARE_NOT_EQUAL(prunedId, id);
+    }
+
+    VERIFY_ARE_EQUAL(prunedId, _buffer->GetHyperlinkId(url, {}));
+}
+
+// This tests that the literal every match must contain is extracted
+// correctly, and that lines with it are still searched.
+void TextBufferTests::PatternsArePrefilteredByLiteral()
+{
+    const til::size bufferSize{ 40, 4 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    const auto literalOf = [&](const std::wstring_view pattern) {
+        _buffer->ClearPatternRecognizers();
+        _buffer->AddPatternRecognizer(pattern);
+        return _buffer->GetPatternRecognizers()->back().literal;
+    };
+
+    VERIFY_ARE_EQUAL(L"://", literalOf(LR"(\b(https?|ftp|file)://[-A-Za-z0-9+&@#/%?=~_|$!:,.;]*[A-Za-z0-9+&@#/%=~_|$])"));
+    VERIFY_ARE_EQUAL(L"https://", literalOf(L"https://[^ ]+"));
+    Log::Comment(L"Optional characters aren't part of the literal.");
+    VERIFY_ARE_EQUAL(L"cd", literalOf(L"ab*cd"));
+    VERIFY_ARE_EQUAL(L"ef", literalOf(L"(a)[bc]d{2}ef"));
+    Log::Comment(L"Escaped characters are, but character class escapes aren't.");
+    VERIFY_ARE_EQUAL(L"x.com", literalOf(L"\\wx\\.com"));
+    Log::Comment(L"Top-level alternatives can match without any literal.");
+    VERIFY_ARE_EQUAL(L"", literalOf(L"abc|def"));
+
+    _buffer->Write(OutputCellIterator(L"abd"), { 0, 0 });
+    _buffer->Write(OutputCellIterator(L"xxabbbcd"), { 0, 1 });
+    _buffer->Write(OutputCellIterator(L"acd"), { 0, 2 });
+    literalOf(L"ab*cd");
+    size_t matches = 0;
+    _buffer->GetPatterns(0, bufferSize.Y - 1).visit_all([&](const auto&) { ++matches; });
+    VERIFY_ARE_EQUAL(2u, matches);
+}
+
+// This tests that FindPatterns gives the same results as GetPatterns, and
+// that lines it already searched are taken from the cache instead.
+void TextBufferTests::FindPatternsReusesUnchangedLines()
+{
+    const til::size bufferSize{ 40, 6 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    const auto patternId = _buffer->AddPatternRecognizer(L"https://[^ ]+");
+    _buffer->Write(OutputCellIterator(L"see https://example.com/a here"), { 0, 1 });
+    _buffer->Write(OutputCellIterator(L"https://example.com/b"), { 0, 4 });
+
+    using PointTree = interval_tree::IntervalTree<til::point, size_t>;
+    const auto flatten = [](const PointTree& tree) {
+        std::vector<std::tuple<til::point, til::point, size_t>> result;
+        tree.visit_all([&](const PointTree::interval& interval) {
+            result.emplace_back(interval.start, interval.stop, interval.value);
+        });
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+
+    TextBuffer::PatternCache cache;
+    const auto expected = flatten(_buffer->GetPatterns(0, bufferSize.Y - 1));
+    const auto actual = flatten(TextBuffer::FindPatterns(_buffer->SnapshotPatternText(0, bufferSize.Y - 1), &cache));
+    VERIFY_ARE_EQUAL(2u, expected.size());
+    VERIFY_IS_TRUE(expected == actual);
+    VERIFY_IS_TRUE((std::tuple{ til::point{ 4, 1 }, til::point{ 25, 1 }, patternId }) == expected[0]);
+
+    Log::Comment(L"The blank rows share a single cache entry.");
+    VERIFY_ARE_EQUAL(3u, cache.matches.size());
+
+    Log::Comment(L"After scrolling, the matches are moved along with their rows.");
+    _buffer->IncrementCircularBuffer();
+    const auto scrolled = flatten(TextBuffer::FindPatterns(_buffer->SnapshotPatternText(0, bufferSize.Y - 1), &cache));
+    VERIFY_IS_TRUE(flatten(_buffer->GetPatterns(0, bufferSize.Y - 1)) == scrolled);
+    VERIFY_IS_TRUE((std::tuple{ til::point{ 4, 0 }, til::point{ 25, 0 }, patternId }) == scrolled[0]);
+
+    Log::Comment(L"Lines that are in the cache aren't searched again.");
+    const auto line = _buffer->GetRowByOffset(0).GetText();
+    cache.matches.at(line) = { { 0, 3, patternId } };
+    const auto cached = flatten(TextBuffer::FindPatterns(_buffer->SnapshotPatternText(0, bufferSize.Y - 1), &cache));
+    VERIFY_IS_TRUE((std::tuple{ til::point{ 0, 0 }, til::point{ 3, 0 }, patternId }) == cached[0]);
+
+    Log::Comment(L"Adding a pattern invalidates the cache.");
+    _buffer->AddPatternRecognizer(L"example");
+    const auto repeated = flatten(TextBuffer::FindPatterns(_buffer->SnapshotPatternText(0, bufferSize.Y - 1), &cache));
+    VERIFY_ARE_EQUAL(4u, repeated.size());
+    VERIFY_IS_TRUE(flatten(_buffer->GetPatterns(0, bufferSize.Y - 1)) == repeated);
+}
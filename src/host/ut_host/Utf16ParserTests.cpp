@@ -86,6 +86,32 @@ class Utf16ParserTests
         }
     }
 
+    TEST_METHOD(GlyphsMatchParse)
+    {
+        std::wstring wstr{ SunglassesEmoji.at(1) }; // unpaired trailing surrogate
+        wstr += LatinChar.at(0);
+        wstr += SunglassesEmoji.at(0); // unpaired leading surrogate
+        wstr.append(SunglassesEmoji.begin(), SunglassesEmoji.end());
+        wstr += HiraganaChar.at(0);
+        wstr += SunglassesEmoji.at(0); // unpaired leading surrogate at the end
+
+        const std::vector<std::vector<wchar_t>> expected = { LatinChar, SunglassesEmoji, HiraganaChar };
+
+        std::vector<std::vector<wchar_t>> actual;
+        for (const auto glyph : Utf16Parser::Glyphs{ wstr })
+        {
+            // The glyphs must be views into the given string.
+            VERIFY_IS_TRUE(glyph.data() >= wstr.data() && glyph.data() + glyph.size() <= wstr.data() + wstr.size());
+            actual.emplace_back(glyph.begin(), glyph.end());
+        }
+
+        VERIFY_ARE_EQUAL(expected, actual);
+        VERIFY_ARE_EQUAL(expected, Utf16Parser::Parse(wstr));
+
+        const Utf16Parser::Glyphs empty{ std::wstring_view{} };
+        VERIFY_IS_TRUE(empty.begin() == empty.end());
+    }
+
     const std::wstring_view Replacement{ &UNICODE_REPLACEMENT, 1 };
 
     TEST_METHOD(ParseNextLeadOnly)
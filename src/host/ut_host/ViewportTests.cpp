@@ -699,6 +699,36 @@ class ViewportTests
         }
     }
 
+    TEST_METHOD(MoveInBoundsMatchesStepping)
+    {
+        // A viewport that isn't at the origin, with a starting point in it.
+        const auto v = Viewport::FromDimensions({ 3, 5 }, { 7, 4 });
+        const til::point start{ 6, 6 };
+
+        for (auto move = -30; move <= 30; ++move)
+        {
+            // Any move should end up at the same position as
+            // that many single steps, or fail without moving.
+            auto expected = start;
+            auto expectedResult = true;
+            for (auto i = 0; i < std::abs(move) && expectedResult; ++i)
+            {
+                expectedResult = move > 0 ? v.IncrementInBounds(expected) : v.DecrementInBounds(expected);
+            }
+            if (!expectedResult)
+            {
+                expected = start;
+            }
+
+            auto actual = start;
+            const auto actualResult = v.MoveInBounds(move, actual);
+
+            Log::Comment(String().Format(L"Move: %d", move));
+            VERIFY_ARE_EQUAL(expectedResult, actualResult);
+            VERIFY_ARE_EQUAL(expected, actual);
+        }
+    }
+
     TEST_METHOD(CompareInBounds)
     {
         til::inclusive_rect edges;
@@ -290,6 +290,14 @@ public:
     {
     }
 
+    void LockConsoleForReading() noexcept override
+    {
+    }
+
+    void UnlockConsoleForReading() noexcept override
+    {
+    }
+
     std::pair<COLORREF, COLORREF> GetAttributeColors(const TextAttribute& /*attr*/) const noexcept override
     {
         return std::make_pair(COLORREF{}, COLORREF{});
@@ -83,6 +83,9 @@ class Microsoft::Console::Render::VtRendererTest
 
     TEST_METHOD(TestCursorVisibility);
 
+    TEST_METHOD(TestFrameDiff);
+    TEST_METHOD(TestRepeatCharacter);
+
     void Test16Colors(VtEngine* engine);
 
     std::deque<std::string> qExpectedInput;
@@ -1563,6 +1566,163 @@ void VtRendererTest::TestCursorVisibility()
     VERIFY_IS_FALSE(engine->_needToDisableCursor);
 }
 
+void VtRendererTest::TestFrameDiff()
+{
+    auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+    engine->SetFrameDiffMode(true);
+    RenderSettings renderSettings;
+    RenderData renderData;
+
+    VerifyFirstPaint(*engine);
+
+    qExpectedInput.push_back("\x1b[m");
+    VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes({},
+                                                  renderSettings,
+                                                  &renderData,
+                                                  false,
+                                                  false));
+
+    const auto makeClusters = [](const std::wstring_view text) {
+        std::vector<Cluster> clusters;
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            clusters.emplace_back(text.substr(i, 1), 1);
+        }
+        return clusters;
+    };
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"The first time around, the whole line needs to be painted."));
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("hello world");
+
+        const auto clusters = makeClusters(L"hello world");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Painting the same line again shouldn't emit anything."));
+
+        const auto clusters = makeClusters(L"hello world");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Only the changed part of the line should be painted."));
+        qExpectedInput.push_back("\x1b[1;7H");
+        qExpectedInput.push_back("there");
+
+        const auto clusters = makeClusters(L"hello there");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Unchanged gaps are skipped, and repeated characters use REP."));
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("-");
+        qExpectedInput.push_back("\x1b[10C");
+        qExpectedInput.push_back("-");
+        qExpectedInput.push_back("\x1b[19b");
+
+        const auto clusters = makeClusters(L"-ello there--------------------");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"After a change in attributes, the line needs to be painted again."));
+        TextAttribute attrs{};
+        attrs.SetIndexedForeground(TextColor::DARK_RED);
+        qExpectedInput.push_back("\x1b[31m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(attrs,
+                                                      renderSettings,
+                                                      &renderData,
+                                                      false,
+                                                      false));
+
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("-ello");
+
+        const auto clusters = makeClusters(L"-ello");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+    });
+
+    VerifyExpectedInputsDrained();
+}
+
+void VtRendererTest::TestRepeatCharacter()
+{
+    auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+    RenderSettings renderSettings;
+    RenderData renderData;
+
+    VerifyFirstPaint(*engine);
+
+    qExpectedInput.push_back("\x1b[m");
+    VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes({},
+                                                  renderSettings,
+                                                  &renderData,
+                                                  false,
+                                                  false));
+
+    const auto makeClusters = [](const std::wstring_view text) {
+        std::vector<Cluster> clusters;
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            clusters.emplace_back(text.substr(i, 1), 1);
+        }
+        return clusters;
+    };
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Without the repeat character mode, runs are written as they are."));
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("a----------b");
+
+        const auto clusters = makeClusters(L"a----------b");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+    });
+
+    engine->SetRepeatCharacterMode(true);
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"With it, runs that are longer than REP are written with REP."));
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("a-");
+        qExpectedInput.push_back("\x1b[9b");
+        qExpectedInput.push_back("b---c");
+
+        const auto clusters = makeClusters(L"a----------b---c");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Box drawing characters take up more bytes, so shorter runs are worth it."));
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("\xe2\x94\x8c\xe2\x94\x80");
+        qExpectedInput.push_back("\x1b[2b");
+        qExpectedInput.push_back("\xe2\x94\x90");
+
+        const auto clusters = makeClusters(L"\u250c\u2500\u2500\u2500\u2510");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+    });
+
+    VerifyExpectedInputsDrained();
+}
+
 void VtRendererTest::FormattedString()
 {
     // This test works with a static cache variable that
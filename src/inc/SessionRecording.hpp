@@ -0,0 +1,244 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// A session recording contains everything a connection printed and, optionally,
+// everything that was written to it, together with the time it happened at.
+//
+// The file starts with a FileHeader, which is followed by records until the end
+// of the file. Each record is a RecordHeader and its payload, padded so that the
+// next RecordHeader is aligned to 8 bytes again. All values are little endian.
+// This allows a Reader to map the file into memory and walk it in place.
+//
+// The payload of Output and Input records is the UTF-16 text as it passed through
+// the connection. The payload of a Resize record is a ResizePayload.
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace Microsoft::Console::SessionRecording
+{
+    inline constexpr uint32_t Magic = 0x43455257; // "WREC"
+    inline constexpr uint32_t Version = 1;
+
+    enum class RecordType : uint16_t
+    {
+        Output = 0,
+        Input = 1,
+        Resize = 2,
+    };
+
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        // The time the recording was started at, as a FILETIME.
+        uint64_t startTime;
+    };
+
+    struct RecordHeader
+    {
+        // Microseconds since the start of the recording.
+        uint64_t timestamp;
+        RecordType type;
+        uint16_t reserved;
+        // The size of the payload in bytes, without the padding.
+        uint32_t size;
+    };
+
+    struct ResizePayload
+    {
+        uint32_t rows;
+        uint32_t columns;
+    };
+
+    static_assert(sizeof(FileHeader) == 16);
+    static_assert(sizeof(RecordHeader) == 16);
+
+    constexpr size_t AlignRecordSize(const size_t size) noexcept
+    {
+        return (size + 7) & ~size_t{ 7 };
+    }
+
+    // Appends records to a new recording. Output usually arrives on the
+    // connection's thread while input and resizes arrive on the UI thread,
+    // so all methods are thread-safe. Records are collected in memory and
+    // written out in larger blocks, but at least once a second.
+    class Writer
+    {
+    public:
+        explicit Writer(const std::filesystem::path& path) :
+            _start{ std::chrono::steady_clock::now() },
+            _lastFlush{ _start }
+        {
+            _file.reset(CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+            THROW_LAST_ERROR_IF(!_file);
+
+            FILETIME now;
+            GetSystemTimeAsFileTime(&now);
+            const FileHeader header{ Magic, Version, (static_cast<uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime };
+            _append(&header, sizeof(header));
+        }
+
+        ~Writer()
+        {
+            try
+            {
+                Flush();
+            }
+            CATCH_LOG();
+        }
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        void WriteOutput(const std::wstring_view text)
+        {
+            _write(RecordType::Output, text.data(), text.size() * sizeof(wchar_t));
+        }
+
+        void WriteInput(const std::wstring_view text)
+        {
+            _write(RecordType::Input, text.data(), text.size() * sizeof(wchar_t));
+        }
+
+        void WriteResize(const uint32_t rows, const uint32_t columns)
+        {
+            const ResizePayload payload{ rows, columns };
+            _write(RecordType::Resize, &payload, sizeof(payload));
+        }
+
+        void Flush()
+        {
+            const std::lock_guard guard{ _lock };
+            _flush();
+        }
+
+    private:
+        static constexpr size_t FlushThreshold = 64 * 1024;
+        static constexpr auto FlushInterval = std::chrono::seconds{ 1 };
+
+        void _write(const RecordType type, const void* data, const size_t size)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            const RecordHeader header{
+                gsl::narrow_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - _start).count()),
+                type,
+                0,
+                gsl::narrow<uint32_t>(size),
+            };
+            static constexpr uint64_t padding = 0;
+
+            const std::lock_guard guard{ _lock };
+            _append(&header, sizeof(header));
+            _append(data, size);
+            _append(&padding, AlignRecordSize(size) - size);
+
+            if (_buffer.size() >= FlushThreshold || now - _lastFlush >= FlushInterval)
+            {
+                _flush();
+                _lastFlush = now;
+            }
+        }
+
+        void _append(const void* data, const size_t size)
+        {
+            const auto bytes = static_cast<const uint8_t*>(data);
+            _buffer.insert(_buffer.end(), bytes, bytes + size);
+        }
+
+        void _flush()
+        {
+            if (_buffer.empty())
+            {
+                return;
+            }
+            DWORD written = 0;
+            THROW_IF_WIN32_BOOL_FALSE(WriteFile(_file.get(), _buffer.data(), gsl::narrow<DWORD>(_buffer.size()), &written, nullptr));
+            _buffer.clear();
+        }
+
+        std::mutex _lock;
+        wil::unique_hfile _file;
+        std::vector<uint8_t> _buffer;
+        std::chrono::steady_clock::time_point _start;
+        std::chrono::steady_clock::time_point _lastFlush;
+    };
+
+    // Maps a recording into memory and returns its records one by one. A
+    // recording whose last record was cut short (for instance when the
+    // Terminal crashed while recording) ends right before that record.
+    class Reader
+    {
+    public:
+        struct Record
+        {
+            RecordType type;
+            std::chrono::microseconds timestamp;
+            // Only valid for Output and Input records.
+            std::wstring_view text;
+            // Only valid for Resize records.
+            ResizePayload size;
+        };
+
+        explicit Reader(const std::filesystem::path& path)
+        {
+            wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+            THROW_LAST_ERROR_IF(!file);
+
+            LARGE_INTEGER fileSize;
+            THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &fileSize));
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_BAD_FORMAT), fileSize.QuadPart < static_cast<LONGLONG>(sizeof(FileHeader)));
+            _size = gsl::narrow<size_t>(fileSize.QuadPart);
+
+            const wil::unique_handle mapping{ CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr) };
+            THROW_LAST_ERROR_IF(!mapping);
+            _view.reset(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0));
+            THROW_LAST_ERROR_IF(!_view);
+
+            const auto& header = *static_cast<const FileHeader*>(_view.get());
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_BAD_FORMAT), header.magic != Magic || header.version != Version);
+            _offset = sizeof(FileHeader);
+        }
+
+        std::optional<Record> Next() noexcept
+        {
+            if (_size - _offset < sizeof(RecordHeader))
+            {
+                return std::nullopt;
+            }
+
+            const auto base = static_cast<const uint8_t*>(_view.get());
+            const auto& header = *reinterpret_cast<const RecordHeader*>(base + _offset);
+            const auto payloadOffset = _offset + sizeof(RecordHeader);
+            if (_size - payloadOffset < header.size)
+            {
+                return std::nullopt;
+            }
+
+            Record record{ header.type, std::chrono::microseconds{ header.timestamp }, {}, {} };
+            const auto payload = base + payloadOffset;
+            if (header.type == RecordType::Resize && header.size >= sizeof(ResizePayload))
+            {
+                record.size = *reinterpret_cast<const ResizePayload*>(payload);
+            }
+            else
+            {
+                record.text = { reinterpret_cast<const wchar_t*>(payload), header.size / sizeof(wchar_t) };
+            }
+
+            _offset = std::min(_size, payloadOffset + AlignRecordSize(header.size));
+            return record;
+        }
+
+    private:
+        wil::unique_mapview_ptr<void> _view;
+        size_t _size = 0;
+        size_t _offset = 0;
+    };
+}
@@ -26,6 +26,8 @@
 #define PSEUDOCONSOLE_RESIZE_QUIRK (2u)
 #define PSEUDOCONSOLE_WIN32_INPUT_MODE (4u)
 #define PSEUDOCONSOLE_PASSTHROUGH_MODE (8u)
+#define PSEUDOCONSOLE_FRAME_DIFF_MODE (16u)
+#define PSEUDOCONSOLE_REPEAT_CHARACTER_MODE (32u)
 
 CONPTY_EXPORT HRESULT WINAPI ConptyCreatePseudoConsole(COORD size, HANDLE hInput, HANDLE hOutput, DWORD dwFlags, HPCON* phPC);
 
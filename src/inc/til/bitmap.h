@@ -172,9 +172,14 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
                 _alloc{ allocator },
                 _sz(sz),
                 _rc(sz),
-                _bits(_sz.area(), fill ? std::numeric_limits<unsigned long long>::max() : 0, _alloc),
+                _bits(_sz.area(), 0, _alloc),
                 _runs{ _alloc }
             {
+                // The initial value passed to dynamic_bitset only initializes its first block.
+                if (fill)
+                {
+                    _bits.set();
+                }
             }
 
             bitmap(til::size sz, bool fill) :
@@ -276,6 +281,39 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
                 return _runs.value();
             }
 
+            // Returns the rectangles of consecutive rows that contain at least one set bit,
+            // each spanning the full width of the bitmap. This is meant for consumers that
+            // repaint entire rows anyway and is a lot cheaper to compute than runs(),
+            // because it only needs to find the first set bit of every dirty row.
+            std::vector<til::rect, run_allocator_type> dirty_rows() const
+            {
+                std::vector<til::rect, run_allocator_type> rows{ _alloc };
+
+                const auto width = static_cast<size_t>(_sz.width);
+                const auto end = _bits.size();
+
+                for (auto pos = _bits.find_first(); pos < end;)
+                {
+#pragma warning(suppress : 26472) // we can't depend on GSL here, so we use static_cast for explicit narrowing
+                    const auto y = static_cast<CoordType>(pos / width);
+
+                    if (!rows.empty() && rows.back().bottom == y)
+                    {
+                        rows.back().bottom++;
+                    }
+                    else
+                    {
+                        rows.emplace_back(0, y, _sz.width, y + 1);
+                    }
+
+                    // find_next() searches past the given position, so this
+                    // continues at the beginning of the next row.
+                    pos = _bits.find_next((pos / width + 1) * width - 1);
+                }
+
+                return rows;
+            }
+
             // optional fill the uncovered area with bits.
             void translate(const til::point delta, bool fill = false)
             {
@@ -286,67 +324,71 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
                     return;
                 }
 
-                // FUTURE: PERF: GH #4015: This could use in-place walk semantics instead of a temporary.
-                bitmap<allocator_type> other{ _sz, _alloc };
+                _runs.reset(); // reset cached runs on any non-const method
+
+                const auto width = static_cast<ptrdiff_t>(_sz.width);
+                const auto height = static_cast<ptrdiff_t>(_sz.height);
+                const auto absX = std::abs(static_cast<ptrdiff_t>(delta.x));
+                const auto absY = std::abs(static_cast<ptrdiff_t>(delta.y));
 
-                for (auto run : *this)
+                if (absX >= width || absY >= height)
                 {
-                    // Offset by the delta
-                    run += delta;
+                    if (fill)
+                    {
+                        set_all();
+                    }
+                    else
+                    {
+                        reset_all();
+                    }
+                    return;
+                }
 
-                    // Intersect with the bounds of our bitmap area
-                    // as part of it could have slid out of bounds.
-                    run &= _rc;
+                // Moving every cell by (x, y) is the same as shifting the entire bitset
+                // by y * width + x bits, which dynamic_bitset does a block at a time.
+                // The only difference is that the bits that were shifted across the
+                // left or right edge of a row end up in the neighboring row.
+#pragma warning(push)
+                // we can't depend on GSL here, so we use static_cast for explicit narrowing
+#pragma warning(disable : 26472)
+                const auto bitShift = delta.y * width + delta.x;
+                const auto newBits = static_cast<size_t>(std::abs(bitShift));
+                const auto columnsBegin = static_cast<size_t>(delta.x > 0 ? delta.x : 0);
+                const auto columnsCount = static_cast<size_t>(width - absX);
+                const auto rowStride = static_cast<size_t>(width);
+                const auto fillBits = static_cast<size_t>(absY * width);
+#pragma warning(pop)
+
+                if (bitShift > 0)
+                {
+                    _bits <<= newBits;
+                }
+                else
+                {
+                    _bits >>= newBits;
+                }
 
-                    // Set it into the new bitmap.
-                    other.set(run);
+                // Those wrapped bits all land in the columns that the translation
+                // uncovered, so we clear them by masking out exactly these columns.
+                dynamic_bitset<unsigned long long, allocator_type> columns(_bits.size(), 0, _alloc);
+                for (auto pos = columnsBegin; pos < columns.size(); pos += rowStride)
+                {
+                    columns.set(pos, columnsCount, true);
                 }
+                _bits &= columns;
 
-                // If we were asked to fill... find the uncovered region.
+                // If we were asked to fill, the uncovered region consists of those
+                // columns plus the rows the vertical part of the translation uncovered.
                 if (fill)
                 {
-                    // Original Rect of As.
-                    //
-                    // X <-- origin
-                    // A A A A
-                    // A A A A
-                    // A A A A
-                    // A A A A
-                    const auto originalRect = _rc;
-
-                    // If Delta = (2, 2)
-                    // Translated Rect of Bs.
-                    //
-                    // X <-- origin
-                    //
-                    //
-                    //     B B B B
-                    //     B B B B
-                    //     B B B B
-                    //     B B B B
-                    const auto translatedRect = _rc + delta;
-
-                    // Subtract the B from the A one to see what wasn't filled by the move.
-                    // C is the overlap of A and B:
-                    //
-                    // X <-- origin
-                    // A A A A                     1 1 1 1
-                    // A A A A                     1 1 1 1
-                    // A A C C B B     subtract    2 2
-                    // A A C C B B    --------->   2 2
-                    //     B B B B      A - B
-                    //     B B B B
-                    //
-                    // 1 and 2 are the spaces to fill that are "uncovered".
-                    const auto fillRects = originalRect - translatedRect;
-                    for (const auto& f : fillRects)
+                    columns.flip();
+                    _bits |= columns;
+
+                    if (fillBits != 0)
                     {
-                        other.set(f);
+                        _bits.set(delta.y > 0 ? 0 : _bits.size() - fillBits, fillBits, true);
                     }
                 }
-
-                // Swap us with the temporary one.
-                std::swap(other, *this);
             }
 
             void set(const til::point pt)
@@ -368,6 +410,17 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
                 }
             }
 
+            // Sets all bits that are set in the given bitmap of the same size.
+            // This is a lot cheaper than setting all of its runs individually.
+            bitmap& operator|=(const bitmap& other)
+            {
+                THROW_HR_IF(E_INVALIDARG, _sz != other._sz);
+                _runs.reset(); // reset cached runs on any non-const method
+
+                _bits |= other._bits;
+                return *this;
+            }
+
             void set_all() noexcept
             {
                 _runs.reset(); // reset cached runs on any non-const method
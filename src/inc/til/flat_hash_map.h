@@ -0,0 +1,381 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "hash.h"
+
+// flat_hash_map implements a std::unordered_map-like type with open addressing.
+// All entries live in a single power-of-2 sized array and collisions are resolved
+// by linear probing, which avoids the per-node allocations of std::unordered_map
+// and makes a lookup touch mostly a single cache line.
+//
+// Unlike std::unordered_map, any insertion or erasure invalidates all iterators,
+// pointers and references into the map. Don't use it for values that are referred to
+// by address (like the glyphs of AtlasEngine, whose addresses are kept by the atlas pages).
+// Erasure uses backward shifting instead of tombstones, so lookups never get slower
+// because of removed entries.
+
+namespace til // Terminal Implementation Library. Also: "Today I Learned"
+{
+    template<typename K, typename V, typename Hash = til::hash_functor, typename KeyEqual = std::equal_to<>>
+    class flat_hash_map
+    {
+        using slot_type = std::optional<std::pair<K, V>>;
+
+        template<bool Const>
+        class iterator_impl
+        {
+            using slot_pointer = std::conditional_t<Const, const slot_type*, slot_type*>;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::pair<K, V>;
+            using difference_type = ptrdiff_t;
+            using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+            using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+            iterator_impl() = default;
+
+            iterator_impl(slot_pointer it, slot_pointer end) noexcept :
+                _it{ it },
+                _end{ end }
+            {
+                _skip();
+            }
+
+            // Allows an iterator to be converted into a const_iterator.
+            template<bool C = Const, typename = std::enable_if_t<!C>>
+            operator iterator_impl<true>() const noexcept
+            {
+                return { _it, _end };
+            }
+
+            [[nodiscard]] reference operator*() const noexcept
+            {
+                return **_it;
+            }
+
+            [[nodiscard]] pointer operator->() const noexcept
+            {
+                return &**_it;
+            }
+
+            iterator_impl& operator++() noexcept
+            {
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+                ++_it;
+                _skip();
+                return *this;
+            }
+
+            iterator_impl operator++(int) noexcept
+            {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            [[nodiscard]] bool operator==(const iterator_impl& rhs) const noexcept
+            {
+                return _it == rhs._it;
+            }
+
+            [[nodiscard]] bool operator!=(const iterator_impl& rhs) const noexcept
+            {
+                return _it != rhs._it;
+            }
+
+        private:
+            friend class flat_hash_map;
+
+            void _skip() noexcept
+            {
+                while (_it != _end && !_it->has_value())
+                {
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+                    ++_it;
+                }
+            }
+
+            slot_pointer _it = nullptr;
+            slot_pointer _end = nullptr;
+        };
+
+    public:
+        using key_type = K;
+        using mapped_type = V;
+        using value_type = std::pair<K, V>;
+        using size_type = size_t;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+        using iterator = iterator_impl<false>;
+        using const_iterator = iterator_impl<true>;
+
+        flat_hash_map() = default;
+
+        [[nodiscard]] iterator begin() noexcept
+        {
+            return { _slots.data(), _slots.data() + _slots.size() };
+        }
+
+        [[nodiscard]] const_iterator begin() const noexcept
+        {
+            return { _slots.data(), _slots.data() + _slots.size() };
+        }
+
+        [[nodiscard]] iterator end() noexcept
+        {
+            const auto end = _slots.data() + _slots.size();
+            return { end, end };
+        }
+
+        [[nodiscard]] const_iterator end() const noexcept
+        {
+            const auto end = _slots.data() + _slots.size();
+            return { end, end };
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return _size == 0;
+        }
+
+        [[nodiscard]] size_type size() const noexcept
+        {
+            return _size;
+        }
+
+        // The size of the slot array. Memory owned by the keys and values isn't included.
+        [[nodiscard]] size_t allocated_bytes() const noexcept
+        {
+            return _slots.capacity() * sizeof(slot_type);
+        }
+
+        void clear() noexcept
+        {
+            _slots.clear();
+            _size = 0;
+        }
+
+        // Ensures that `count` entries fit into the map without rehashing.
+        void reserve(size_type count)
+        {
+            // The map is kept at most 3/4 full, since linear probing degrades quickly beyond that.
+            auto capacity = std::max<size_type>(_slots.size(), minCapacity);
+            while (capacity - capacity / 4 < count)
+            {
+                capacity *= 2;
+            }
+            if (capacity != _slots.size())
+            {
+                _rehash(capacity);
+            }
+        }
+
+        template<typename Q>
+        [[nodiscard]] iterator find(const Q& key) noexcept
+        {
+            const auto idx = _find(key);
+            return idx == npos ? end() : _iterator(idx);
+        }
+
+        template<typename Q>
+        [[nodiscard]] const_iterator find(const Q& key) const noexcept
+        {
+            const auto idx = _find(key);
+            return idx == npos ? end() : const_iterator{ _iterator(idx) };
+        }
+
+        template<typename Q>
+        [[nodiscard]] bool contains(const Q& key) const noexcept
+        {
+            return _find(key) != npos;
+        }
+
+        template<typename Q>
+        [[nodiscard]] V& at(const Q& key)
+        {
+            const auto idx = _find(key);
+            if (idx == npos)
+            {
+                throw std::out_of_range("key not found");
+            }
+            return _slots[idx]->second;
+        }
+
+        template<typename Q>
+        [[nodiscard]] const V& at(const Q& key) const
+        {
+            const auto idx = _find(key);
+            if (idx == npos)
+            {
+                throw std::out_of_range("key not found");
+            }
+            return _slots[idx]->second;
+        }
+
+        template<typename Q>
+        V& operator[](Q&& key)
+        {
+            return try_emplace(std::forward<Q>(key)).first->second;
+        }
+
+        // Like std::unordered_map::try_emplace: If the key already exists, args are left untouched.
+        template<typename Q, typename... Args>
+        std::pair<iterator, bool> try_emplace(Q&& key, Args&&... args)
+        {
+            reserve(_size + 1);
+
+            const auto mask = _slots.size() - 1;
+            for (auto idx = _hash(key) & mask;; idx = (idx + 1) & mask)
+            {
+                auto& slot = _slots[idx];
+                if (!slot)
+                {
+                    slot.emplace(std::piecewise_construct, std::forward_as_tuple(std::forward<Q>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+                    ++_size;
+                    return { _iterator(idx), true };
+                }
+                if (_equal(slot->first, key))
+                {
+                    return { _iterator(idx), false };
+                }
+            }
+        }
+
+        template<typename Q, typename M>
+        std::pair<iterator, bool> insert_or_assign(Q&& key, M&& value)
+        {
+            auto result = try_emplace(std::forward<Q>(key), std::forward<M>(value));
+            if (!result.second)
+            {
+                result.first->second = std::forward<M>(value);
+            }
+            return result;
+        }
+
+        template<typename Q>
+        size_type erase(const Q& key) noexcept
+        {
+            const auto idx = _find(key);
+            if (idx == npos)
+            {
+                return 0;
+            }
+            _erase(idx);
+            return 1;
+        }
+
+        // Removes the entry at the given position. Since this shifts
+        // the following entries back, the iterator is invalidated.
+        void erase(const_iterator it) noexcept
+        {
+            _erase(gsl::narrow_cast<size_type>(it._it - _slots.data()));
+        }
+
+        void erase(iterator it) noexcept
+        {
+            erase(const_iterator{ it });
+        }
+
+    private:
+        static constexpr size_type npos = std::numeric_limits<size_type>::max();
+        static constexpr size_type minCapacity = 8;
+
+        template<typename Q>
+        size_type _hash(const Q& key) const noexcept
+        {
+            return _hasher(key);
+        }
+
+        template<typename Q>
+        bool _equal(const K& lhs, const Q& rhs) const noexcept
+        {
+            return _keyEqual(lhs, rhs);
+        }
+
+        iterator _iterator(size_type idx) noexcept
+        {
+            return { _slots.data() + idx, _slots.data() + _slots.size() };
+        }
+
+        const_iterator _iterator(size_type idx) const noexcept
+        {
+            return { _slots.data() + idx, _slots.data() + _slots.size() };
+        }
+
+        template<typename Q>
+        size_type _find(const Q& key) const noexcept
+        {
+            if (_size == 0)
+            {
+                return npos;
+            }
+
+            // The map is never full, so there's always an empty slot to end the search at.
+            const auto mask = _slots.size() - 1;
+            for (auto idx = _hash(key) & mask;; idx = (idx + 1) & mask)
+            {
+                const auto& slot = _slots[idx];
+                if (!slot)
+                {
+                    return npos;
+                }
+                if (_equal(slot->first, key))
+                {
+                    return idx;
+                }
+            }
+        }
+
+        void _erase(size_type idx) noexcept
+        {
+            const auto mask = _slots.size() - 1;
+
+            // Backward shift deletion: Move the following entries of the same probe
+            // sequence into the hole, so that no entry is separated from its home
+            // slot by an empty one. The first empty slot ends the sequence.
+            for (auto next = (idx + 1) & mask; _slots[next]; next = (next + 1) & mask)
+            {
+                const auto home = _hash(_slots[next]->first) & mask;
+                // The entry at `next` may only move into the hole if the hole lies
+                // in between its home slot and `next` (wrapping around at the end).
+                if (((next - home) & mask) >= ((next - idx) & mask))
+                {
+                    _slots[idx] = std::move(_slots[next]);
+                    idx = next;
+                }
+            }
+
+            _slots[idx].reset();
+            --_size;
+        }
+
+        void _rehash(size_type capacity)
+        {
+            std::vector<slot_type> slots(capacity);
+            const auto mask = capacity - 1;
+
+            for (auto& slot : _slots)
+            {
+                if (slot)
+                {
+                    auto idx = _hash(slot->first) & mask;
+                    while (slots[idx])
+                    {
+                        idx = (idx + 1) & mask;
+                    }
+                    slots[idx] = std::move(slot);
+                }
+            }
+
+            _slots = std::move(slots);
+        }
+
+        std::vector<slot_type> _slots;
+        size_type _size = 0;
+        [[no_unique_address]] Hash _hasher;
+        [[no_unique_address]] KeyEqual _keyEqual;
+    };
+}
@@ -5,8 +5,131 @@
 
 #include "bit.h"
 
+#include <intrin.h>
+
 namespace til
 {
+    namespace details
+    {
+        // Computes the 128-bit product of a and b and returns the low half in a and the high half in b.
+        inline void wymum(uint64_t& a, uint64_t& b) noexcept
+        {
+#if defined(_M_X64)
+            a = _umul128(a, b, &b);
+#elif defined(_M_ARM64)
+            const auto lo = a * b;
+            b = __umulh(a, b);
+            a = lo;
+#else
+            const auto ha = a >> 32;
+            const auto hb = b >> 32;
+            const auto la = a & 0xffffffff;
+            const auto lb = b & 0xffffffff;
+            const auto rh = ha * hb;
+            const auto rm0 = ha * lb;
+            const auto rm1 = hb * la;
+            const auto rl = la * lb;
+            const auto t = rl + (rm0 << 32);
+            auto c = static_cast<uint64_t>(t < rl);
+            const auto lo = t + (rm1 << 32);
+            c += lo < t;
+            b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+            a = lo;
+#endif
+        }
+
+        inline uint64_t wymix(uint64_t a, uint64_t b) noexcept
+        {
+            wymum(a, b);
+            return a ^ b;
+        }
+
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+        inline uint64_t wyr8(const uint8_t* p) noexcept
+        {
+            uint64_t v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline uint64_t wyr4(const uint8_t* p) noexcept
+        {
+            uint32_t v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline uint64_t wyr3(const uint8_t* p, size_t k) noexcept
+        {
+            return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+        }
+#pragma warning(pop)
+    }
+
+    // Hashes the given bytes with wyhash (final version 4), which is public domain.
+    // Unlike the byte-wise FNV-1a of til::hasher it consumes 8 to 48 bytes per iteration,
+    // which makes it a lot faster for keys like glyph runs, strings and TextAttributes,
+    // while its distribution is good enough for open addressing with power-of-2 tables.
+#pragma warning(suppress : 26429) // Symbol 'data' is never tested for nullness, it can be marked as not_null (f.23).
+    inline size_t hash_bytes(const void* data, size_t len, uint64_t seed = 0) noexcept
+    {
+        static constexpr uint64_t secret[4]{ 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+        auto p = static_cast<const uint8_t*>(data);
+        seed ^= details::wymix(seed ^ secret[0], secret[1]);
+        uint64_t a = 0;
+        uint64_t b = 0;
+
+        if (len <= 16)
+        {
+            if (len >= 4)
+            {
+                const auto off = (len >> 3) << 2;
+                a = (details::wyr4(p) << 32) | details::wyr4(p + off);
+                b = (details::wyr4(p + len - 4) << 32) | details::wyr4(p + len - 4 - off);
+            }
+            else if (len > 0)
+            {
+                a = details::wyr3(p, len);
+            }
+        }
+        else
+        {
+            auto i = len;
+            if (i > 48)
+            {
+                auto see1 = seed;
+                auto see2 = seed;
+                do
+                {
+                    seed = details::wymix(details::wyr8(p) ^ secret[1], details::wyr8(p + 8) ^ seed);
+                    see1 = details::wymix(details::wyr8(p + 16) ^ secret[2], details::wyr8(p + 24) ^ see1);
+                    see2 = details::wymix(details::wyr8(p + 32) ^ secret[3], details::wyr8(p + 40) ^ see2);
+                    p += 48;
+                    i -= 48;
+                } while (i > 48);
+                seed ^= see1 ^ see2;
+            }
+            while (i > 16)
+            {
+                seed = details::wymix(details::wyr8(p) ^ secret[1], details::wyr8(p + 8) ^ seed);
+                i -= 16;
+                p += 16;
+            }
+            a = details::wyr8(p + i - 16);
+            b = details::wyr8(p + i - 8);
+        }
+#pragma warning(pop)
+
+        a ^= secret[1];
+        b ^= seed;
+        details::wymum(a, b);
+        return static_cast<size_t>(details::wymix(a ^ secret[0] ^ len, b ^ secret[1]));
+    }
+
     template<typename T>
     struct hash_trait;
 
@@ -126,6 +249,16 @@ namespace til
         }
     };
 
+    namespace details
+    {
+        template<typename T>
+        inline constexpr bool is_contiguous_string_v = false;
+        template<typename T, typename CharTraits, typename Allocator>
+        inline constexpr bool is_contiguous_string_v<std::basic_string<T, CharTraits, Allocator>> = true;
+        template<typename T, typename CharTraits>
+        inline constexpr bool is_contiguous_string_v<std::basic_string_view<T, CharTraits>> = true;
+    }
+
     template<typename T>
     constexpr size_t hash(const T& v) noexcept
     {
@@ -156,6 +289,10 @@ namespace til
             }
             return h;
         }
+        else if constexpr (details::is_contiguous_string_v<T>)
+        {
+            return hash_bytes(v.data(), v.size() * sizeof(typename T::value_type));
+        }
         else
         {
             hasher h;
@@ -163,4 +300,18 @@ namespace til
             return h.finalize();
         }
     }
+
+    // A transparent std::hash replacement based on til::hash().
+    // Strings and string views of the same text hash identically,
+    // so a container keyed by std::wstring can be searched with a std::wstring_view.
+    struct hash_functor
+    {
+        using is_transparent = void;
+
+        template<typename T>
+        constexpr size_t operator()(const T& v) const noexcept
+        {
+            return til::hash(v);
+        }
+    };
 }
@@ -31,15 +31,24 @@ namespace til::spsc
         struct block_initially_policy
         {
             using _spsc_policy = int;
+            static constexpr bool _block_initially = true;
             static constexpr bool _block_forever = false;
         };
 
         struct block_forever_policy
         {
             using _spsc_policy = int;
+            static constexpr bool _block_initially = true;
             static constexpr bool _block_forever = true;
         };
 
+        struct block_never_policy
+        {
+            using _spsc_policy = int;
+            static constexpr bool _block_initially = false;
+            static constexpr bool _block_forever = false;
+        };
+
         template<typename WaitPolicy>
         using enable_if_wait_policy_t = typename std::remove_reference_t<WaitPolicy>::_spsc_policy;
 
@@ -406,6 +415,9 @@ namespace til::spsc
     // Block until all items have been written into the sender / read from the receiver.
     inline constexpr details::block_forever_policy block_forever{};
 
+    // Don't block at all and only write / read as many items as possible right away.
+    inline constexpr details::block_never_policy block_never{};
+
     template<typename T>
     struct producer
     {
@@ -484,7 +496,7 @@ namespace til::spsc
 
             const auto data = _arc->data();
             auto remaining = static_cast<size_type>(count);
-            auto blocking = true;
+            auto blocking = std::remove_reference_t<WaitPolicy>::_block_initially;
             auto ok = true;
 
             while (remaining != 0)
@@ -587,7 +599,7 @@ namespace til::spsc
 
             const auto data = _arc->data();
             auto remaining = static_cast<size_type>(count);
-            auto blocking = true;
+            auto blocking = std::remove_reference_t<WaitPolicy>::_block_initially;
             auto ok = true;
 
             while (remaining != 0)
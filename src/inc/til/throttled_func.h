@@ -79,6 +79,18 @@ namespace til
         private:
             std::atomic<bool> _isPending;
         };
+
+        // Returns the tolerable delay for a threadpool timer with the given due time.
+        // The threadpool uses it to coalesce timers that expire around the same time,
+        // so that the dozens of throttled functions of a process (multiple per pane)
+        // share their wakeups instead of each waking up the CPU on its own.
+        // It's a tenth of the delay, which keeps short, latency sensitive delays exact.
+        inline DWORD throttled_func_window_length(const std::chrono::duration<int64_t, std::ratio<1, 10000000>> delay) noexcept
+        {
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(delay).count() / 10;
+#pragma warning(suppress : 26472) // we can't depend on GSL here, so we use static_cast for explicit narrowing
+            return static_cast<DWORD>(std::clamp<int64_t>(ms, 0, 1000));
+        }
     } // namespace details
 
     template<bool leading, typename... Args>
@@ -98,6 +110,7 @@ namespace til
         //
         // After `func` was invoked the state is reset and this cycle is repeated again.
         throttled_func(filetime_duration delay, function func) :
+            _windowLength{ details::throttled_func_window_length(delay) },
             _func{ std::move(func) },
             _timer{ _createTimer() }
         {
@@ -172,7 +185,7 @@ namespace til
                 _func();
             }
 
-            SetThreadpoolTimerEx(_timer.get(), &_delay, 0, 0);
+            SetThreadpoolTimerEx(_timer.get(), &_delay, 0, _windowLength);
         }
 
         void _trailing_edge()
@@ -195,6 +208,7 @@ namespace til
         }
 
         FILETIME _delay;
+        DWORD _windowLength;
         function _func;
         wil::unique_threadpool_timer _timer;
         details::throttled_func_storage<Args...> _storage;
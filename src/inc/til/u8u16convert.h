@@ -14,6 +14,9 @@ could overcome disadvantages of syscalls. Test results can be read up
 in PR #4093 and the test algorithms are available in src\tools\U8U16Test.
 Based on the results the decision was made to keep using the platform
 functions MultiByteToWideChar and WideCharToMultiByte.
+The exception are runs of ASCII characters, which make up most of the
+output of command line applications and which are widened and narrowed
+with SSE2 on x64. Only the text in between is passed to the platform functions.
 
 Author(s):
 - Steffen Illhardt (german-one), Leonard Hecker (lhecker) 2020-2021
@@ -47,6 +50,149 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
         }
     };
 
+    namespace details
+    {
+#pragma warning(push)
+#pragma warning(disable : 26429 26481 26490) // use not_null, pointer arithmetic, reinterpret_cast
+#if _M_AMD64
+        inline bool isAscii16x8(const char* in) noexcept
+        {
+            return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in))) == 0;
+        }
+
+        inline bool isAscii16x16(const wchar_t* in) noexcept
+        {
+            const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+            const auto hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 8));
+            const auto nonAscii = _mm_and_si128(_mm_or_si128(lo, hi), _mm_set1_epi16(static_cast<short>(0xff80)));
+            return _mm_movemask_epi8(_mm_cmpeq_epi16(nonAscii, _mm_setzero_si128())) == 0xffff;
+        }
+#endif
+
+        // Routine Description:
+        // - Converts complete UTF-8 characters to UTF-16, like MultiByteToWideChar.
+        //   Runs of ASCII characters are widened directly. Everything in between
+        //   is handed to MultiByteToWideChar, split only in front of ASCII
+        //   characters, which can't be part of a multi-byte sequence. The result
+        //   is thus identical, including the replacement of invalid sequences.
+        // Arguments:
+        // - in, len8 - UTF-8 string to be converted, len8 must be > 0
+        // - out, capa16 - buffer for the result, capa16 must be >= len8
+        // Return Value:
+        // - the number of code units written to out, or 0 if the conversion failed
+        inline int u8u16Bulk(const char* in, const int len8, wchar_t* out, const int capa16) noexcept
+        {
+#if _M_AMD64
+            const auto zero = _mm_setzero_si128();
+            int pos8{};
+            int pos16{};
+
+            while (pos8 < len8)
+            {
+                for (; pos8 + 16 <= len8 && isAscii16x8(in + pos8); pos8 += 16, pos16 += 16)
+                {
+                    const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos8));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + pos16), _mm_unpacklo_epi8(chars, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + pos16 + 8), _mm_unpackhi_epi8(chars, zero));
+                }
+                for (; pos8 < len8 && static_cast<uint8_t>(in[pos8]) < 0x80; ++pos8, ++pos16)
+                {
+                    out[pos16] = static_cast<wchar_t>(in[pos8]);
+                }
+                if (pos8 == len8)
+                {
+                    break;
+                }
+
+                // The non-ASCII text ends where the next 16 ASCII characters start.
+                auto end8 = pos8 + 1;
+                while (end8 + 16 <= len8 && !isAscii16x8(in + end8))
+                {
+                    end8 += 16;
+                }
+                if (end8 + 16 > len8)
+                {
+                    end8 = len8;
+                }
+
+                const auto convLen = MultiByteToWideChar(CP_UTF8, 0UL, in + pos8, end8 - pos8, out + pos16, capa16 - pos16);
+                if (!convLen)
+                {
+                    return 0;
+                }
+
+                pos8 = end8;
+                pos16 += convLen;
+            }
+
+            return pos16;
+#else
+            return MultiByteToWideChar(CP_UTF8, 0UL, in, len8, out, capa16);
+#endif
+        }
+
+        // Routine Description:
+        // - Converts complete UTF-16 characters to UTF-8, like WideCharToMultiByte.
+        //   Runs of ASCII characters are narrowed directly. Everything in between
+        //   is handed to WideCharToMultiByte, split only in front of ASCII
+        //   characters, so surrogate pairs always stay together.
+        // Arguments:
+        // - in, len16 - UTF-16 string to be converted, len16 must be > 0
+        // - out, capa8 - buffer for the result, capa8 must be >= 3 * len16
+        // Return Value:
+        // - the number of code units written to out, or 0 if the conversion failed
+        inline int u16u8Bulk(const wchar_t* in, const int len16, char* out, const int capa8) noexcept
+        {
+#if _M_AMD64
+            int pos16{};
+            int pos8{};
+
+            while (pos16 < len16)
+            {
+                for (; pos16 + 16 <= len16 && isAscii16x16(in + pos16); pos16 += 16, pos8 += 16)
+                {
+                    const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos16));
+                    const auto hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos16 + 8));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + pos8), _mm_packus_epi16(lo, hi));
+                }
+                for (; pos16 < len16 && in[pos16] < 0x80; ++pos16, ++pos8)
+                {
+                    out[pos8] = static_cast<char>(in[pos16]);
+                }
+                if (pos16 == len16)
+                {
+                    break;
+                }
+
+                // The non-ASCII text ends where the next 16 ASCII characters start.
+                auto end16 = pos16 + 1;
+                while (end16 + 16 <= len16 && !isAscii16x16(in + end16))
+                {
+                    end16 += 16;
+                }
+                if (end16 + 16 > len16)
+                {
+                    end16 = len16;
+                }
+
+                const auto convLen = WideCharToMultiByte(CP_UTF8, 0UL, in + pos16, end16 - pos16, out + pos8, capa8 - pos8, nullptr, nullptr);
+                if (!convLen)
+                {
+                    return 0;
+                }
+
+                pos16 = end16;
+                pos8 += convLen;
+            }
+
+            return pos8;
+#else
+            return WideCharToMultiByte(CP_UTF8, 0UL, in, len16, out, capa8, nullptr, nullptr);
+#endif
+        }
+#pragma warning(pop)
+    }
+
     // Routine Description:
     // - Takes a UTF-8 string and performs the conversion to UTF-16. NOTE: The function relies on getting complete UTF-8 characters at the string boundaries.
     // Arguments:
@@ -70,7 +216,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthRequired));
             out.resize(in.length()); // avoid to call MultiByteToWideChar twice only to get the required size
-            const int lengthOut = MultiByteToWideChar(CP_UTF8, 0ul, in.data(), lengthRequired, out.data(), lengthRequired);
+            const int lengthOut = details::u8u16Bulk(in.data(), lengthRequired, out.data(), lengthRequired);
             out.resize(gsl::narrow_cast<size_t>(lengthOut));
 
             return lengthOut == 0 ? E_UNEXPECTED : S_OK;
@@ -158,7 +304,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 
             if (len8)
             {
-                const auto convLen{ MultiByteToWideChar(CP_UTF8, 0UL, cursor8, len8, out.data() + len16, capa16) };
+                const auto convLen{ details::u8u16Bulk(cursor8, len8, out.data() + len16, capa16) };
                 RETURN_HR_IF(E_UNEXPECTED, !convLen);
 
                 len16 += convLen;
@@ -197,7 +343,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             // Thus, the worst ratio of UTF-16 code units to UTF-8 code units is 1 to 3.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthIn) || !base::CheckMul(lengthIn, 3).AssignIfValid(&lengthRequired));
             out.resize(gsl::narrow_cast<size_t>(lengthRequired)); // avoid to call WideCharToMultiByte twice only to get the required size
-            const int lengthOut = WideCharToMultiByte(CP_UTF8, 0ul, in.data(), lengthIn, out.data(), lengthRequired, nullptr, nullptr);
+            const int lengthOut = details::u16u8Bulk(in.data(), lengthIn, out.data(), lengthRequired);
             out.resize(gsl::narrow_cast<size_t>(lengthOut));
 
             return lengthOut == 0 ? E_UNEXPECTED : S_OK;
@@ -259,7 +405,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 
             if (len16)
             {
-                const auto convLen{ WideCharToMultiByte(CP_UTF8, 0UL, cursor16, len16, out.data() + len8, capa8, nullptr, nullptr) };
+                const auto convLen{ details::u16u8Bulk(cursor16, len16, out.data() + len8, capa8) };
                 RETURN_HR_IF(E_UNEXPECTED, !convLen);
 
                 len8 += convLen;
@@ -40,8 +40,59 @@ static CodepointWidth GetQuickCharWidthLegacyForNumpadEventSynthesis(const wchar
     return CodepointWidth::Invalid;
 }
 
+// Routine Description:
+// - appends a single key event record to records
+static void AppendKeyRecord(std::vector<INPUT_RECORD>& records,
+                            const bool keyDown,
+                            const WORD virtualKeyCode,
+                            const WORD virtualScanCode,
+                            const wchar_t wch,
+                            const DWORD controlKeyState)
+{
+    auto& record = records.emplace_back();
+    record.EventType = KEY_EVENT;
+    record.Event.KeyEvent.bKeyDown = keyDown;
+    record.Event.KeyEvent.wRepeatCount = 1;
+    record.Event.KeyEvent.wVirtualKeyCode = virtualKeyCode;
+    record.Event.KeyEvent.wVirtualScanCode = virtualScanCode;
+    record.Event.KeyEvent.uChar.UnicodeChar = wch;
+    record.Event.KeyEvent.dwControlKeyState = controlKeyState;
+}
+
+// Routine Description:
+// - converts key event records into KeyEvents
+static std::deque<std::unique_ptr<KeyEvent>> ToKeyEvents(const std::vector<INPUT_RECORD>& records)
+{
+    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    for (const auto& record : records)
+    {
+        keyEvents.push_back(std::make_unique<KeyEvent>(record.Event.KeyEvent));
+    }
+    return keyEvents;
+}
+
 std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToKeyEvents(const wchar_t wch,
                                                                                          const unsigned int codepage)
+{
+    std::vector<INPUT_RECORD> records;
+    CharToKeyRecords(wch, codepage, records);
+    return ToKeyEvents(records);
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of key event records as if it was typed,
+// either using the keyboard or, if the keyboard layout can't produce it, Alt + numpad
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage used for Alt + numpad input
+// - records - the records are appended to this vector
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::CharToKeyRecords(const wchar_t wch,
+                                                         const unsigned int codepage,
+                                                         std::vector<INPUT_RECORD>& records)
 {
     const short invalidKey = -1;
     auto keyState = VkKeyScanW(wch);
@@ -61,13 +112,66 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToK
                 // It wasn't alphanumeric or determined to be wide by the old algorithm
                 // if VkKeyScanW fails (char is not in kbd layout), we must
                 // emulate the key being input through the numpad
-                return SynthesizeNumpadEvents(wch, codepage);
+                SynthesizeNumpadRecords(wch, codepage, records);
+                return;
             }
         }
-        keyState = 0; // SynthesizeKeyboardEvents would rather get 0 than -1
+        keyState = 0; // SynthesizeKeyboardRecords would rather get 0 than -1
     }
 
-    return SynthesizeKeyboardEvents(wch, keyState);
+    SynthesizeKeyboardRecords(wch, keyState, records);
+}
+
+// Routine Description:
+// - converts a string into key event records as if it was typed, just like
+// calling CharToKeyRecords for each of its characters
+// - Pastes are mostly ASCII, and the keyboard layout can't change while this
+// runs, so the records are only synthesized once per ASCII character and
+// then copied. This saves the VkKeyScanW and MapVirtualKeyW calls for all
+// other occurrences.
+// Arguments:
+// - string - the string to convert
+// - codepage - the codepage used for Alt + numpad input
+// - records - the records are appended to this vector
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::StringToKeyRecords(const std::wstring_view string,
+                                                           const unsigned int codepage,
+                                                           std::vector<INPUT_RECORD>& records)
+{
+    struct CachedRecords
+    {
+        size_t offset = 0;
+        size_t count = 0;
+    };
+    std::array<CachedRecords, 128> cache{};
+
+    for (const auto wch : string)
+    {
+        if (wch >= cache.size())
+        {
+            CharToKeyRecords(wch, codepage, records);
+            continue;
+        }
+
+        auto& cached = til::at(cache, wch);
+        if (cached.count == 0)
+        {
+            cached.offset = records.size();
+            CharToKeyRecords(wch, codepage, records);
+            cached.count = records.size() - cached.offset;
+            continue;
+        }
+
+        for (size_t i = 0; i < cached.count; ++i)
+        {
+            // Copy the record first: push_back may reallocate the vector it refers to.
+            const auto record = til::at(records, cached.offset + i);
+            records.push_back(record);
+        }
+    }
 }
 
 // Routine Description:
@@ -80,79 +184,95 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToK
 // Note:
 // - will throw exception on error
 std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::SynthesizeKeyboardEvents(const wchar_t wch, const short keyState)
+{
+    std::vector<INPUT_RECORD> records;
+    SynthesizeKeyboardRecords(wch, keyState, records);
+    return ToKeyEvents(records);
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of key event records as if it was typed
+// using the keyboard
+// Arguments:
+// - wch - the wchar_t to convert
+// - keyState - the result of VkKeyScanW for wch
+// - records - the records are appended to this vector
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::SynthesizeKeyboardRecords(const wchar_t wch,
+                                                                  const short keyState,
+                                                                  std::vector<INPUT_RECORD>& records)
 {
     const auto modifierState = HIBYTE(keyState);
 
     auto altGrSet = false;
     auto shiftSet = false;
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
 
     // add modifier key event if necessary
     if (WI_AreAllFlagsSet(modifierState, VkKeyScanModState::CtrlAndAltPressed))
     {
         altGrSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED)));
+        AppendKeyRecord(records,
+                        true,
+                        static_cast<WORD>(VK_MENU),
+                        altScanCode,
+                        UNICODE_NULL,
+                        (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED));
     }
     else if (WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed))
     {
         shiftSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       SHIFT_PRESSED));
+        AppendKeyRecord(records,
+                        true,
+                        static_cast<WORD>(VK_SHIFT),
+                        leftShiftScanCode,
+                        UNICODE_NULL,
+                        SHIFT_PRESSED);
     }
 
     const auto vk = LOBYTE(keyState);
     const auto virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(vk, MAPVK_VK_TO_VSC));
-    KeyEvent keyEvent{ true, 1, LOBYTE(keyState), virtualScanCode, wch, 0 };
+    DWORD controlKeyState = 0;
 
     // add modifier flags if necessary
     if (WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed))
     {
-        keyEvent.ActivateModifierKey(ModifierKeyState::Shift);
+        WI_SetAllFlags(controlKeyState, ToConsoleControlKeyFlag(ModifierKeyState::Shift));
     }
     if (WI_IsFlagSet(modifierState, VkKeyScanModState::CtrlPressed))
     {
-        keyEvent.ActivateModifierKey(ModifierKeyState::LeftCtrl);
+        WI_SetAllFlags(controlKeyState, ToConsoleControlKeyFlag(ModifierKeyState::LeftCtrl));
     }
     if (WI_AreAllFlagsSet(modifierState, VkKeyScanModState::CtrlAndAltPressed))
     {
-        keyEvent.ActivateModifierKey(ModifierKeyState::RightAlt);
+        WI_SetAllFlags(controlKeyState, ToConsoleControlKeyFlag(ModifierKeyState::RightAlt));
     }
 
     // add key event down and up
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
-    keyEvent.SetKeyDown(false);
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    AppendKeyRecord(records, true, vk, virtualScanCode, wch, controlKeyState);
+    AppendKeyRecord(records, false, vk, virtualScanCode, wch, controlKeyState);
 
     // add modifier key up event
     if (altGrSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       ENHANCED_KEY));
+        AppendKeyRecord(records,
+                        false,
+                        static_cast<WORD>(VK_MENU),
+                        altScanCode,
+                        UNICODE_NULL,
+                        ENHANCED_KEY);
     }
     else if (shiftSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       0));
+        AppendKeyRecord(records,
+                        false,
+                        static_cast<WORD>(VK_SHIFT),
+                        leftShiftScanCode,
+                        UNICODE_NULL,
+                        0);
     }
-
-    return keyEvents;
 }
 
 // Routine Description:
@@ -167,15 +287,33 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::Synthes
 // - will throw exception on error
 std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage)
 {
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    std::vector<INPUT_RECORD> records;
+    SynthesizeNumpadRecords(wch, codepage, records);
+    return ToKeyEvents(records);
+}
 
+// Routine Description:
+// - converts a wchar_t into a series of key event records as if it was typed
+// using Alt + numpad
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage to convert wch to before typing it
+// - records - the records are appended to this vector
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::SynthesizeNumpadRecords(const wchar_t wch,
+                                                                const unsigned int codepage,
+                                                                std::vector<INPUT_RECORD>& records)
+{
     //alt keydown
-    keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   UNICODE_NULL,
-                                                   LEFT_ALT_PRESSED));
+    AppendKeyRecord(records,
+                    true,
+                    static_cast<WORD>(VK_MENU),
+                    altScanCode,
+                    UNICODE_NULL,
+                    LEFT_ALT_PRESSED);
 
     std::wstring wstr{ wch };
     const auto convertedChars = ConvertToA(codepage, wstr);
@@ -202,27 +340,16 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::Synthes
             const WORD virtualKey = ch - '0' + VK_NUMPAD0;
             const auto virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(virtualKey, MAPVK_VK_TO_VSC));
 
-            keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
-            keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
+            AppendKeyRecord(records, true, virtualKey, virtualScanCode, UNICODE_NULL, LEFT_ALT_PRESSED);
+            AppendKeyRecord(records, false, virtualKey, virtualScanCode, UNICODE_NULL, LEFT_ALT_PRESSED);
         }
     }
 
     // alt keyup
-    keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   wch,
-                                                   0));
-    return keyEvents;
+    AppendKeyRecord(records,
+                    false,
+                    static_cast<WORD>(VK_MENU),
+                    altScanCode,
+                    wch,
+                    0);
 }
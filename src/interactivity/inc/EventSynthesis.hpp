@@ -16,6 +16,8 @@ Author:
 #pragma once
 #include <deque>
 #include <memory>
+#include <string_view>
+#include <vector>
 #include "../../types/inc/IInputEvent.hpp"
 
 namespace Microsoft::Console::Interactivity
@@ -26,4 +28,14 @@ namespace Microsoft::Console::Interactivity
                                                                    const short keyState);
 
     std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage);
+
+    // These append INPUT_RECORDs instead, which is a lot cheaper for long strings.
+    void CharToKeyRecords(const wchar_t wch, const unsigned int codepage, std::vector<INPUT_RECORD>& records);
+    void StringToKeyRecords(const std::wstring_view string, const unsigned int codepage, std::vector<INPUT_RECORD>& records);
+
+    void SynthesizeKeyboardRecords(const wchar_t wch,
+                                   const short keyState,
+                                   std::vector<INPUT_RECORD>& records);
+
+    void SynthesizeNumpadRecords(const wchar_t wch, const unsigned int codepage, std::vector<INPUT_RECORD>& records);
 }
@@ -31,35 +31,58 @@ BgfxEngine::BgfxEngine(PVOID SharedViewBase, LONG DisplayHeight, LONG DisplayWid
 
     _fontSize.X = FontWidth > SHORT_MAX ? SHORT_MAX : gsl::narrow_cast<til::CoordType>(FontWidth);
     _fontSize.Y = FontHeight > SHORT_MAX ? SHORT_MAX : gsl::narrow_cast<til::CoordType>(FontHeight);
+
+    // The first frame has to fill the entire display.
+    _dirtyArea = _GetDisplayArea();
 }
 
-[[nodiscard]] HRESULT BgfxEngine::Invalidate(const til::rect* /*psrRegion*/) noexcept
+// Routine Description:
+// - Marks the given cells as dirty. Only the rows they cover are repainted
+//   at the next frame and copied in the shared view.
+[[nodiscard]] HRESULT BgfxEngine::Invalidate(const til::rect* psrRegion) noexcept
 {
+    RETURN_HR_IF_NULL(E_INVALIDARG, psrRegion);
+    _dirtyArea |= *psrRegion & _GetDisplayArea();
     return S_OK;
 }
 
-[[nodiscard]] HRESULT BgfxEngine::InvalidateCursor(const til::rect* /*psrRegion*/) noexcept
+[[nodiscard]] HRESULT BgfxEngine::InvalidateCursor(const til::rect* psrRegion) noexcept
 {
-    return S_OK;
+    return Invalidate(psrRegion);
 }
 
+// Routine Description:
+// - The system region is given in pixels, and the display has nothing but
+//   the text on it, so all of it is repainted.
 [[nodiscard]] HRESULT BgfxEngine::InvalidateSystem(const til::rect* /*prcDirtyClient*/) noexcept
 {
-    return S_OK;
+    return InvalidateAll();
 }
 
-[[nodiscard]] HRESULT BgfxEngine::InvalidateSelection(const std::vector<til::rect>& /*rectangles*/) noexcept
+[[nodiscard]] HRESULT BgfxEngine::InvalidateSelection(const std::vector<til::rect>& rectangles) noexcept
 {
+    for (const auto& rect : rectangles)
+    {
+        RETURN_IF_FAILED(Invalidate(&rect));
+    }
     return S_OK;
 }
 
-[[nodiscard]] HRESULT BgfxEngine::InvalidateScroll(const til::point* /*pcoordDelta*/) noexcept
+// Routine Description:
+// - The shared view can't be scrolled, so scrolling repaints the entire display.
+[[nodiscard]] HRESULT BgfxEngine::InvalidateScroll(const til::point* pcoordDelta) noexcept
 {
+    RETURN_HR_IF_NULL(E_INVALIDARG, pcoordDelta);
+    if (*pcoordDelta != til::point{})
+    {
+        return InvalidateAll();
+    }
     return S_OK;
 }
 
 [[nodiscard]] HRESULT BgfxEngine::InvalidateAll() noexcept
 {
+    _dirtyArea = _GetDisplayArea();
     return S_OK;
 }
 
@@ -69,19 +92,28 @@ BgfxEngine::BgfxEngine(PVOID SharedViewBase, LONG DisplayHeight, LONG DisplayWid
     return S_FALSE;
 }
 
+// Routine Description:
+// - Starts a frame, unless nothing was invalidated since the last one.
+// Return Value:
+// - S_FALSE if there's nothing to paint, otherwise S_OK.
 [[nodiscard]] HRESULT BgfxEngine::StartPaint() noexcept
 {
-    return S_OK;
+    return _dirtyArea.empty() ? S_FALSE : S_OK;
 }
 
+// Routine Description:
+// - Asks ConIoSrv to update the display with the new runs, and then makes them
+//   the old runs. Only the dirty rows were painted, so only they are copied:
+//   In all other rows the old and new runs are still the same.
 [[nodiscard]] HRESULT BgfxEngine::EndPaint() noexcept
 try
 {
+    const auto dirtyArea = std::exchange(_dirtyArea, til::rect{});
     const auto Status = ConIoSrvComm::GetConIoSrvComm()->RequestUpdateDisplay(0);
 
     if (NT_SUCCESS(Status))
     {
-        for (SIZE_T i = 0; i < _displayHeight; i++)
+        for (auto i = gsl::narrow_cast<SIZE_T>(dirtyArea.top); i < gsl::narrow_cast<SIZE_T>(dirtyArea.bottom); i++)
         {
             const auto OldRunBase = _sharedViewBase + (i * 2 * _runLength);
             const auto NewRunBase = OldRunBase + _runLength;
@@ -112,11 +144,11 @@ CATCH_RETURN()
 
 [[nodiscard]] HRESULT BgfxEngine::PaintBackground() noexcept
 {
-    for (SIZE_T i = 0; i < _displayHeight; i++)
+    for (auto i = gsl::narrow_cast<SIZE_T>(_dirtyArea.top); i < gsl::narrow_cast<SIZE_T>(_dirtyArea.bottom); i++)
     {
         const auto NewRun = reinterpret_cast<PCD_IO_CHARACTER>(_sharedViewBase + (i * 2 * _runLength) + _runLength);
 
-        for (SIZE_T j = 0; j < _displayWidth; j++)
+        for (auto j = gsl::narrow_cast<SIZE_T>(_dirtyArea.left); j < gsl::narrow_cast<SIZE_T>(_dirtyArea.right); j++)
         {
             NewRun[j].Character = L' ';
             NewRun[j].Attribute = 0;
@@ -217,15 +249,17 @@ CATCH_RETURN()
 
 [[nodiscard]] HRESULT BgfxEngine::GetDirtyArea(gsl::span<const til::rect>& area) noexcept
 {
-    _dirtyArea.bottom = gsl::narrow_cast<til::CoordType>(std::max(static_cast<SIZE_T>(0), _displayHeight));
-    _dirtyArea.right = gsl::narrow_cast<til::CoordType>(std::max(static_cast<SIZE_T>(0), _displayWidth));
-
     area = { &_dirtyArea,
              1 };
 
     return S_OK;
 }
 
+til::rect BgfxEngine::_GetDisplayArea() const noexcept
+{
+    return { 0, 0, gsl::narrow_cast<til::CoordType>(_displayWidth), gsl::narrow_cast<til::CoordType>(_displayHeight) };
+}
+
 [[nodiscard]] HRESULT BgfxEngine::GetFontSize(_Out_ til::size* pFontSize) noexcept
 {
     *pFontSize = _fontSize;
@@ -75,6 +75,8 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _DoUpdateTitle(_In_ const std::wstring_view newTitle) noexcept override;
 
     private:
+        til::rect _GetDisplayArea() const noexcept;
+
         std::byte* _sharedViewBase;
         SIZE_T _runLength;
 
@@ -91,6 +91,9 @@ Clipboard& Clipboard::Instance()
 
 // Routine Description:
 // - This routine pastes given Unicode string into the console window.
+// - The string isn't converted into key events all at once. It's converted
+//   and written to the input buffer in chunks by ContinuePaste(), so that
+//   large pastes don't have to hold millions of key events in memory.
 // Arguments:
 // - pData - Unicode string that is pasted to the console window
 // - cchData - Size of the Unicode String in characters
@@ -104,17 +107,71 @@ void Clipboard::StringPaste(_In_reads_(cchData) const wchar_t* const pData,
         return;
     }
 
+    try
+    {
+        // The paste ends at the first null character, if there is one.
+        _pendingPaste.append(pData, wcsnlen(pData, cchData));
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return;
+    }
+
+    ContinuePaste();
+}
+
+// Routine Description:
+// - Writes the next chunks of a pending paste to the input buffer.
+// - If the client doesn't read its input as fast as it's pasted, the paste
+//   is paused once the input buffer holds PasteBacklogLimit events, and a
+//   timer is started on the console window to continue it later.
+// - The console must be locked by the caller.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Clipboard::ContinuePaste()
+{
     auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    // Without a window there's no timer to continue the paste with, so it's written all at once.
+    const auto pWindow = ServiceLocator::LocateConsoleWindow();
+    const auto hwnd = pWindow ? pWindow->GetWindowHandle() : nullptr;
 
     try
     {
-        auto inEvents = TextToKeyEvents(pData, cchData);
-        gci.pInputBuffer->Write(inEvents);
+        while (_pendingPasteOffset < _pendingPaste.size())
+        {
+            if (hwnd && gci.pInputBuffer->GetNumberOfReadyEvents() >= PasteBacklogLimit)
+            {
+                LOG_LAST_ERROR_IF(!SetTimer(hwnd, PasteTimerId, PasteRetryInterval, nullptr));
+                return;
+            }
+
+            auto count = std::min(PasteChunkSize, _pendingPaste.size() - _pendingPasteOffset);
+            // TextToKeyEvents() collapses CRLF pairs into a single CR, so they mustn't be split between chunks.
+            if (_pendingPaste[_pendingPasteOffset + count - 1] == UNICODE_CARRIAGERETURN && _pendingPasteOffset + count < _pendingPaste.size())
+            {
+                count++;
+            }
+
+            auto inEvents = TextToKeyEvents(_pendingPaste.data() + _pendingPasteOffset, count);
+            _pendingPasteOffset += count;
+            gci.pInputBuffer->Write(inEvents);
+        }
     }
     catch (...)
     {
+        // The rest of the paste is dropped, rather than retrying the same chunk over and over.
         LOG_HR(wil::ResultFromCaughtException());
     }
+
+    _pendingPaste = {};
+    _pendingPasteOffset = 0;
+    if (hwnd)
+    {
+        KillTimer(hwnd, PasteTimerId);
+    }
 }
 
 #pragma endregion
@@ -224,10 +281,10 @@ void Clipboard::StoreSelectionToClipboard(const bool copyFormatting)
         includeCRLF = trimTrailingWhitespace = true;
     }
 
-    const auto text = buffer.GetText(includeCRLF,
-                                     trimTrailingWhitespace,
-                                     selectionRects,
-                                     GetAttributeColors);
+    const auto text = buffer.GetTextAndColorRuns(includeCRLF,
+                                                 trimTrailingWhitespace,
+                                                 selectionRects,
+                                                 GetAttributeColors);
 
     CopyTextToSystemClipboard(text, copyFormatting);
 }
@@ -237,15 +294,9 @@ void Clipboard::StoreSelectionToClipboard(const bool copyFormatting)
 // Arguments:
 // - rows - Rows of text data to copy
 // - fAlsoCopyFormatting - true if the color and formatting should also be copied, false otherwise
-void Clipboard::CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, const bool fAlsoCopyFormatting)
+void Clipboard::CopyTextToSystemClipboard(const TextBuffer::TextAndColorRuns& rows, const bool fAlsoCopyFormatting)
 {
-    std::wstring finalString;
-
-    // Concatenate strings into one giant string to put onto the clipboard.
-    for (const auto& str : rows.text)
-    {
-        finalString += str;
-    }
+    const auto& finalString = rows.text;
 
     // allocate the final clipboard data
     const auto cchNeeded = finalString.size() + 1;
@@ -33,18 +33,31 @@ namespace Microsoft::Console::Interactivity::Win32
         void StringPaste(_In_reads_(cchData) PCWCHAR pwchData,
                          const size_t cchData);
         void Paste();
+        void ContinuePaste();
+
+        // The timer that resumes a paste once the client has caught up on reading its input.
+        static constexpr UINT_PTR PasteTimerId = 0x7061; // 'pa'
 
     private:
+        // A paste is converted into key events in chunks of this many characters...
+        static constexpr size_t PasteChunkSize = 4096;
+        // ...and paused while the input buffer holds more than this many events.
+        static constexpr size_t PasteBacklogLimit = 64 * 1024;
+        static constexpr UINT PasteRetryInterval = 10; // ms
+
         std::deque<std::unique_ptr<IInputEvent>> TextToKeyEvents(_In_reads_(cchData) const wchar_t* const pData,
                                                                  const size_t cchData);
 
         void StoreSelectionToClipboard(_In_ const bool fAlsoCopyFormatting);
 
-        void CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, _In_ const bool copyFormatting);
+        void CopyTextToSystemClipboard(const TextBuffer::TextAndColorRuns& rows, _In_ const bool copyFormatting);
         void CopyToSystemClipboard(std::string stringToPlaceOnClip, LPCWSTR lpszFormat);
 
         bool FilterCharacterOnPaste(_Inout_ WCHAR* const pwch);
 
+        std::wstring _pendingPaste;
+        size_t _pendingPasteOffset = 0;
+
 #ifdef UNIT_TESTING
         friend class ClipboardTests;
 #endif
@@ -17,6 +17,41 @@
 
 using namespace Microsoft::Console::Interactivity;
 
+// Routine Description:
+// - Highlights the given search results, or removes the highlights if there
+//   are none. They're drawn over the buffer by the renderer, so that thousands
+//   of them don't need to be written into the buffer and restored afterwards.
+// - The console has to be locked.
+// Arguments:
+// - matches - The search results to highlight
+static void SetSearchHighlights(const std::vector<Search::Match>& matches)
+{
+    auto& g = ServiceLocator::LocateGlobals();
+    if (!g.pRender)
+    {
+        return;
+    }
+
+    try
+    {
+        const auto& textBuffer = g.getConsoleInformation().GetActiveOutputBuffer().GetTextBuffer();
+
+        std::vector<til::inclusive_rect> rects;
+        rects.reserve(matches.size());
+        for (const auto& [start, end] : matches)
+        {
+            const auto matchRects = textBuffer.GetTextRects(start, end, false, true);
+            rects.insert(rects.end(), matchRects.begin(), matchRects.end());
+        }
+
+        TextAttribute highlightAttr;
+        highlightAttr.SetIndexedBackground256(TextColor::DARK_YELLOW);
+        highlightAttr.SetIndexedForeground256(TextColor::DARK_BLACK);
+        g.pRender->SetSearchHighlights(std::move(rects), highlightAttr);
+    }
+    CATCH_LOG();
+}
+
 INT_PTR CALLBACK FindDialogProc(HWND hWnd, UINT Message, WPARAM wParam, LPARAM lParam)
 {
     auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -65,20 +100,28 @@ INT_PTR CALLBACK FindDialogProc(HWND hWnd, UINT Message, WPARAM wParam, LPARAM l
             {
                 Telemetry::Instance().LogFindDialogNextClicked(StringLength, (Reverse != 0), (IgnoreCase == 0));
                 search.Select();
+                // The other matches are highlighted, for as long as the dialog is open.
+                SetSearchHighlights(search.FindAll());
                 return TRUE;
             }
             else
             {
                 // The string wasn't found.
+                SetSearchHighlights({});
                 ScreenInfo.SendNotifyBeep();
             }
             break;
         }
         case IDCANCEL:
+        {
             Telemetry::Instance().FindDialogClosed();
+            LockConsole();
+            SetSearchHighlights({});
+            UnlockConsole();
             EndDialog(hWnd, 0);
             return TRUE;
         }
+        }
         break;
     }
     default:
@@ -92,6 +135,7 @@ void DoFind()
     auto& g = ServiceLocator::LocateGlobals();
     const auto pWindow = ServiceLocator::LocateConsoleWindow();
 
+    g.getConsoleInformation().pInputBuffer->FlushBatch();
     UnlockConsole();
     if (pWindow != nullptr)
     {
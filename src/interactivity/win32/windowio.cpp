@@ -33,6 +33,8 @@ using Microsoft::Console::Interactivity::ServiceLocator;
 // This magic flag is "documented" at https://msdn.microsoft.com/en-us/library/windows/desktop/ms646301(v=vs.85).aspx
 // "If the high-order bit is 1, the key is down; otherwise, it is up."
 static constexpr short KeyPressed{ gsl::narrow_cast<short>(0x8000) };
+// The number of queued key messages that are written to the input buffer as a single batch at most.
+static constexpr int MaxBatchedKeyMessages{ 256 };
 
 // ----------------------------
 // Helpers
@@ -170,6 +172,12 @@ void HandleKeyEvent(const HWND hWnd,
         // when nothing is happening, or the user has merely clicked on the title bar, and
         // this can incorrectly mark the session as being interactive.
         Telemetry::Instance().SetUserInteractive();
+
+        // The next frames are likely going to contain the echo of this key.
+        if (const auto pRender = ServiceLocator::LocateGlobals().pRender)
+        {
+            pRender->NotifyInput();
+        }
     }
 
     // Make sure we retrieve the key info first, or we could chew up
@@ -1018,6 +1026,48 @@ NTSTATUS InitWindowsSubsystem(_Out_ HHOOK* phhook)
 // (for a window)
 // ----------------------------
 
+// Routine Description:
+// - Translates a message of the console input thread and dispatches it to the window.
+static void TranslateAndDispatchMessage(MSG& msg)
+{
+    // --- START LOAD BEARING CODE ---
+    // TranslateMessageEx appears to be necessary for a few things (that we could in the future take care of ourselves...)
+    // 1. The normal TranslateMessage will return TRUE for all WM_KEYDOWN, WM_KEYUP, WM_SYSKEYDOWN, WM_SYSKEYUP
+    //    no matter what.
+    //    - This means that if there *is* a translation for the keydown, it will post a WM_CHAR to our queue and say TRUE.
+    //      ***HOWEVER*** it also means that if there is *NOT* a translation for the keydown, it will post nothing and still say TRUE.
+    //    - TRUE from TranslateMessage typically means "don't dispatch, it's already handled."
+    //    - *But* the console needs to dispatch a WM_KEYDOWN that wasn't translated into a WM_CHAR so the underlying console client can
+    //      receive it and decide what to do with it.
+    //    - Thus TranslateMessageEx was kludged in December 1990 to return FALSE for the case where it doesn't post a WM_CHAR so the
+    //      console can know this and handle it.
+    //    - Instead of using this kludge from many years ago... we could instead use the ToUnicode/ToUnicodeEx exports to translate
+    //      the WM_KEYDOWN to WM_CHAR ourselves and synchronously dispatch it with all context if necessary (or continue to dispatch the
+    //      WM_KEYDOWN if ToUnicode offers no translation. We would no longer need the private TranslateMessageEx (or even TranslateMessage at all).
+    // 2. TranslateMessage also performs translation of ALT+NUMPAD sequences on our behalf into their corresponding character input
+    //    - If we take out TranslateMessage entirely as stated in part 1, we would have to reimplement our own version of translating ALT+NUMPAD
+    //      sequences at this point inside the console.
+    //    - The Clipboard class (clipboard.cpp) already does the inverse of this to mock up keypad sequences for text strings pasted into the console
+    //      so they can be faithfully represented as a user "typing" into the client application. The vision would be we leverage the knowledge from
+    //      clipboard to build a transcoder capable of doing the reverse at this point so TranslateMessage would be completely unnecessary for us.
+    // Until that future point in time.... this is LOAD BEARING CODE and should not be hastily modified or removed!
+    if (!ServiceLocator::LocateConsoleControl<Microsoft::Console::Interactivity::Win32::ConsoleControl>()->TranslateMessageEx(&msg, TM_POSTCHARBREAKS))
+    {
+        DispatchMessageW(&msg);
+    }
+    // do this so that alt-tab works while journaling
+    else if (msg.message == WM_SYSKEYDOWN && msg.wParam == VK_TAB && WI_IsFlagSet(msg.lParam, WM_SYSKEYDOWN_ALT_PRESSED))
+    {
+        // alt is really down
+        DispatchMessageW(&msg);
+    }
+    else
+    {
+        StoreKeyInfo(&msg);
+    }
+    // -- END LOAD BEARING CODE
+}
+
 DWORD WINAPI ConsoleInputThreadProcWin32(LPVOID /*lpParameter*/)
 {
     InitEnvironmentVariables();
@@ -1026,12 +1076,14 @@ DWORD WINAPI ConsoleInputThreadProcWin32(LPVOID /*lpParameter*/)
     HHOOK hhook = nullptr;
     auto Status = STATUS_SUCCESS;
 
+#if !TIL_FEATURE_CONPTYONLYHOST_ENABLED
     if (!ServiceLocator::LocateGlobals().launchArgs.IsHeadless())
     {
         // If we're not headless, set up the main conhost window.
         Status = InitWindowsSubsystem(&hhook);
     }
     else
+#endif
     {
         // If we are headless (because we're a pseudo console), we
         // will still need a window handle in the win32 environment
@@ -1060,6 +1112,7 @@ DWORD WINAPI ConsoleInputThreadProcWin32(LPVOID /*lpParameter*/)
 
     ServiceLocator::LocateGlobals().hConsoleInputInitEvent.SetEvent();
 
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
     for (;;)
     {
         MSG msg;
@@ -1068,42 +1121,26 @@ DWORD WINAPI ConsoleInputThreadProcWin32(LPVOID /*lpParameter*/)
             break;
         }
 
-        // --- START LOAD BEARING CODE ---
-        // TranslateMessageEx appears to be necessary for a few things (that we could in the future take care of ourselves...)
-        // 1. The normal TranslateMessage will return TRUE for all WM_KEYDOWN, WM_KEYUP, WM_SYSKEYDOWN, WM_SYSKEYUP
-        //    no matter what.
-        //    - This means that if there *is* a translation for the keydown, it will post a WM_CHAR to our queue and say TRUE.
-        //      ***HOWEVER*** it also means that if there is *NOT* a translation for the keydown, it will post nothing and still say TRUE.
-        //    - TRUE from TranslateMessage typically means "don't dispatch, it's already handled."
-        //    - *But* the console needs to dispatch a WM_KEYDOWN that wasn't translated into a WM_CHAR so the underlying console client can
-        //      receive it and decide what to do with it.
-        //    - Thus TranslateMessageEx was kludged in December 1990 to return FALSE for the case where it doesn't post a WM_CHAR so the
-        //      console can know this and handle it.
-        //    - Instead of using this kludge from many years ago... we could instead use the ToUnicode/ToUnicodeEx exports to translate
-        //      the WM_KEYDOWN to WM_CHAR ourselves and synchronously dispatch it with all context if necessary (or continue to dispatch the
-        //      WM_KEYDOWN if ToUnicode offers no translation. We would no longer need the private TranslateMessageEx (or even TranslateMessage at all).
-        // 2. TranslateMessage also performs translation of ALT+NUMPAD sequences on our behalf into their corresponding character input
-        //    - If we take out TranslateMessage entirely as stated in part 1, we would have to reimplement our own version of translating ALT+NUMPAD
-        //      sequences at this point inside the console.
-        //    - The Clipboard class (clipboard.cpp) already does the inverse of this to mock up keypad sequences for text strings pasted into the console
-        //      so they can be faithfully represented as a user "typing" into the client application. The vision would be we leverage the knowledge from
-        //      clipboard to build a transcoder capable of doing the reverse at this point so TranslateMessage would be completely unnecessary for us.
-        // Until that future point in time.... this is LOAD BEARING CODE and should not be hastily modified or removed!
-        if (!ServiceLocator::LocateConsoleControl<Microsoft::Console::Interactivity::Win32::ConsoleControl>()->TranslateMessageEx(&msg, TM_POSTCHARBREAKS))
-        {
-            DispatchMessageW(&msg);
-        }
-        // do this so that alt-tab works while journaling
-        else if (msg.message == WM_SYSKEYDOWN && msg.wParam == VK_TAB && WI_IsFlagSet(msg.lParam, WM_SYSKEYDOWN_ALT_PRESSED))
-        {
-            // alt is really down
-            DispatchMessageW(&msg);
-        }
-        else
+        TranslateAndDispatchMessage(msg);
+
+        // Key messages tend to arrive in bursts (fast typing, or SendInput), and each
+        // of them would otherwise write on its own to the input buffer and wake up
+        // every reader. The rest of the burst is drained and written as one batch.
+        if (msg.message >= WM_KEYFIRST && msg.message <= WM_KEYLAST)
         {
-            StoreKeyInfo(&msg);
+            LockConsole();
+            gci.pInputBuffer->BeginBatch();
+            UnlockConsole();
+
+            for (auto i = 0; i < MaxBatchedKeyMessages && PeekMessageW(&msg, nullptr, WM_KEYFIRST, WM_KEYLAST, PM_REMOVE); i++)
+            {
+                TranslateAndDispatchMessage(msg);
+            }
+
+            LockConsole();
+            gci.pInputBuffer->EndBatch();
+            UnlockConsole();
         }
-        // -- END LOAD BEARING CODE
     }
 
     // Free all resources used by this thread
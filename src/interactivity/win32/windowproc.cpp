@@ -596,6 +596,15 @@ using namespace Microsoft::Console::Types;
         break;
     }
 
+    case WM_TIMER:
+    {
+        if (wParam == Clipboard::PasteTimerId)
+        {
+            Clipboard::Instance().ContinuePaste();
+        }
+        break;
+    }
+
     case WM_INITMENU:
     {
         HandleMenuEvent(WM_INITMENU);
@@ -754,6 +763,8 @@ using namespace Microsoft::Console::Types;
     {
         if (Unlock)
         {
+            // DefWindowProc may enter a modal loop (the system menu, for instance).
+            gci.pInputBuffer->FlushBatch();
             UnlockConsole();
             Unlock = FALSE;
         }
@@ -300,6 +300,16 @@ HRESULT AtlasEngine::Enable() noexcept
     return static_cast<float>(_api.dpi) / static_cast<float>(USER_DEFAULT_SCREEN_DPI);
 }
 
+void AtlasEngine::GetStatistics(EngineStatistics& statistics) const noexcept
+{
+    statistics.shapedLines = _statistics.shapedLines.load(std::memory_order_relaxed);
+    statistics.glyphs = _statistics.glyphs.load(std::memory_order_relaxed);
+    statistics.allocatedTiles = _statistics.allocatedTiles.load(std::memory_order_relaxed);
+    statistics.tileCapacity = _statistics.tileCapacity.load(std::memory_order_relaxed);
+    statistics.gpuBytes = _statistics.gpuBytes.load(std::memory_order_relaxed);
+    statistics.cacheBytes = _statistics.cacheBytes.load(std::memory_order_relaxed);
+}
+
 [[nodiscard]] HANDLE AtlasEngine::GetSwapChainHandle()
 {
     if (WI_IsFlagSet(_api.invalidations, ApiInvalidations::Device))
@@ -325,6 +335,17 @@ HRESULT AtlasEngine::Enable() noexcept
     return Types::Viewport::FromDimensions(viewInCharacters.Origin(), { viewInCharacters.Width() * _api.fontMetrics.cellSize.x, viewInCharacters.Height() * _api.fontMetrics.cellSize.y });
 }
 
+// Releases the device, the swap chain and all resources that depend on them, like the
+// glyph atlas. They're recreated just like after a lost device with the next frame.
+void AtlasEngine::ReleaseResources() noexcept
+try
+{
+    _releaseSwapChain();
+    _r = {};
+    WI_SetFlag(_api.invalidations, ApiInvalidations::Device);
+}
+CATCH_LOG()
+
 void AtlasEngine::SetAntialiasingMode(const D2D1_TEXT_ANTIALIAS_MODE antialiasingMode) noexcept
 {
     const auto mode = gsl::narrow_cast<u8>(antialiasingMode);
@@ -384,6 +405,16 @@ void AtlasEngine::SetSelectionBackground(const COLORREF color, const float alpha
     }
 }
 
+void AtlasEngine::SetSmoothScrolling(bool enable) noexcept
+{
+    if (_api.smoothScrolling != enable)
+    {
+        _api.smoothScrolling = enable;
+        // The _r.cells ring needs to be resized to hold the spare rows.
+        WI_SetFlag(_api.invalidations, ApiInvalidations::Size);
+    }
+}
+
 void AtlasEngine::SetSoftwareRendering(bool enable) noexcept
 {
 }
@@ -302,12 +302,22 @@ try
     }
 #endif
 
+    // If Present() evicted a page of the atlas, the rows that weren't painted during that frame
+    // might still refer to its tiles. Redraw everything to fix them up. See RequiresContinuousRedraw().
+    if (_r.atlasPageEvicted)
+    {
+        _r.atlasPageEvicted = false;
+        _api.invalidatedRows = invalidatedRowsAll;
+    }
+
     if (_api.invalidatedRows == invalidatedRowsAll)
     {
         // Skip all the partial updates, since we redraw everything anyways.
         _api.invalidatedCursorArea = invalidatedAreaNone;
         _api.invalidatedRows = { 0, _api.cellCount.y };
         _api.scrollOffset = 0;
+        // The spare rows of the ring aren't redrawn and might be stale now.
+        _r.smoothScrollPixels = 0;
     }
     else
     {
@@ -328,24 +338,41 @@ try
         }
 
         // Scroll the buffer by the given offset and mark the newly uncovered rows as "invalid".
+        // _r.cells and the cellBuffer are treated as a ring of rows: Instead of moving all
+        // cells around and uploading them again, we only rotate the row the viewport starts at.
+        // Only the newly uncovered rows are marked as invalid and thus get repainted and uploaded.
+        //
+        // With smooth scrolling the ring has cellCount.y spare rows, which the newly uncovered
+        // rows are rotated into. The rows that scrolled out of the viewport thus stay intact,
+        // right above or below it. The shader draws the rows shifted by _r.smoothScrollPixels,
+        // starting at the old position, and _advanceSmoothScroll() moves them into place.
         if (_api.scrollOffset != 0)
         {
             const auto nothingInvalid = _api.invalidatedRows.x == _api.invalidatedRows.y;
-            const auto offset = static_cast<ptrdiff_t>(_api.scrollOffset) * _api.cellCount.x;
-            const auto data = _r.cells.data();
-            auto count = _r.cells.size();
-#pragma warning(suppress : 26494) // Variable 'dst' is uninitialized. Always initialize an object (type.5).
-            Cell* dst;
-#pragma warning(suppress : 26494) // Variable 'src' is uninitialized. Always initialize an object (type.5).
-            Cell* src;
+            const auto rows = static_cast<int>(_r.cellRowCount);
+            auto offset = (static_cast<int>(_r.cellRowOffset) - _api.scrollOffset) % rows;
+            if (offset < 0)
+            {
+                offset += rows;
+            }
+            _r.cellRowOffset = gsl::narrow_cast<u16>(offset);
+            _r.presentScrollOffset = gsl::narrow_cast<i16>(clamp<int>(_r.presentScrollOffset + _api.scrollOffset, -_r.cellCount.y, _r.cellCount.y));
+            WI_SetFlag(_r.invalidations, RenderInvalidations::CellRowOffset);
+
+            if (_r.cellRowCount > _r.cellCount.y)
+            {
+                // Only the spare rows hold valid content past the edges of the viewport.
+                const auto limit = static_cast<f32>((_r.cellRowCount - _r.cellCount.y) * _r.cellSize.y);
+                if (_r.smoothScrollPixels == 0)
+                {
+                    _r.smoothScrollTime = std::chrono::steady_clock::now();
+                }
+                _r.smoothScrollPixels = clamp(_r.smoothScrollPixels - static_cast<f32>(_api.scrollOffset * _r.cellSize.y), -limit, limit);
+            }
 
             if (_api.scrollOffset < 0)
             {
                 // Scroll up (for instance when new text is being written at the end of the buffer).
-                dst = data;
-                src = data - offset;
-                count += offset;
-
                 const u16 endRow = _api.cellCount.y + _api.scrollOffset;
                 _api.invalidatedRows.x = nothingInvalid ? endRow : std::min<u16>(_api.invalidatedRows.x, endRow);
                 _api.invalidatedRows.y = _api.cellCount.y;
@@ -353,15 +380,9 @@ try
             else
             {
                 // Scroll down.
-                dst = data + offset;
-                src = data;
-                count -= offset;
-
                 _api.invalidatedRows.x = 0;
                 _api.invalidatedRows.y = nothingInvalid ? _api.scrollOffset : std::max<u16>(_api.invalidatedRows.y, _api.scrollOffset);
             }
-
-            memmove(dst, src, count * sizeof(Cell));
         }
     }
 
@@ -385,16 +406,40 @@ try
 {
     _flushBufferLine();
 
+    // Hand the frame over to Present(), which shapes the queued lines and applies the cell flags
+    // without the console lock being held. The inputs are all copies in ShapingJob and CellFlagUpdate.
+    // If the previous frame was never presented (for instance because Present() wasn't called after
+    // an error), its cells would get lost otherwise. It's rare enough that we can process it here.
+    if (_api.frameJobCount || !_api.frameCellFlagUpdates.empty() || !_api.frameImageJobs.empty())
+    {
+        _processFrame();
+    }
+    std::swap(_api.shapingJobs, _api.frameJobs);
+    std::swap(_api.shapingJobCount, _api.frameJobCount);
+    std::swap(_api.cellFlagUpdates, _api.frameCellFlagUpdates);
+    std::swap(_api.imageJobs, _api.frameImageJobs);
+
+    // All rows we've just painted need to be uploaded to the GPU and presented in Present().
+    if (_api.invalidatedRows.x < _api.invalidatedRows.y)
+    {
+        _markDirtyRect({ 0, _api.invalidatedRows.x, _r.cellCount.x, _api.invalidatedRows.y });
+    }
+
     _api.invalidatedCursorArea = invalidatedAreaNone;
     _api.invalidatedRows = invalidatedRowsNone;
     _api.scrollOffset = 0;
+
+    _r.frame++;
     return S_OK;
 }
 CATCH_RETURN()
 
 [[nodiscard]] bool AtlasEngine::RequiresContinuousRedraw() noexcept
 {
-    return continuousRedraw;
+    // See StartPaint(): After an atlas page was evicted we need another frame to redraw everything.
+    // This is called after Present() without the console lock being held and may thus only access _r.
+    // A smooth scroll is animated with a frame per refresh until it reached its final position.
+    return continuousRedraw || _r.atlasPageEvicted || _r.smoothScrollPixels != 0;
 }
 
 void AtlasEngine::WaitUntilCanRender() noexcept
@@ -434,13 +479,26 @@ void AtlasEngine::WaitUntilCanRender() noexcept
 
 [[nodiscard]] HRESULT AtlasEngine::ResetLineTransform() noexcept
 {
-    return S_OK;
+    return PrepareLineTransform(LineRendition::SingleWidth, 0, 0);
 }
 
+// Unlike the GDI and DirectX engines, we don't transform the drawing of a row. Instead, the line
+// rendition is a part of the AtlasKeyAttributes, which makes the glyphs of double width and double
+// height rows rasterize scaled up into tiles of their own (see _drawGlyph). These tiles are cached
+// like any other glyph and so are the rows' cells, since the attributes are part of their cache keys.
 [[nodiscard]] HRESULT AtlasEngine::PrepareLineTransform(const LineRendition lineRendition, const size_t targetRow, const size_t viewportLeft) noexcept
+try
 {
+    const auto rendition = static_cast<u16>(lineRendition);
+    if (_api.attributes.lineRendition != rendition)
+    {
+        // The pending line was painted with the previous rendition.
+        _flushBufferLine();
+        _api.attributes.lineRendition = rendition;
+    }
     return S_OK;
 }
+CATCH_RETURN()
 
 [[nodiscard]] HRESULT AtlasEngine::PaintBackground() noexcept
 {
@@ -450,7 +508,9 @@ void AtlasEngine::WaitUntilCanRender() noexcept
 [[nodiscard]] HRESULT AtlasEngine::PaintBufferLine(const gsl::span<const Cluster> clusters, const til::point coord, const bool fTrimLeft, const bool lineWrapped) noexcept
 try
 {
-    const auto x = gsl::narrow_cast<u16>(clamp<int>(coord.X, 0, _api.cellCount.x));
+    // The coordinates of double width rows are in buffer columns, each of which covers 2 cells.
+    const auto scale = _api.attributes.lineRendition != static_cast<u16>(LineRendition::SingleWidth) ? 1 : 0;
+    const auto x = gsl::narrow_cast<u16>(clamp<int>(coord.X << scale, 0, _api.cellCount.x));
     const auto y = gsl::narrow_cast<u16>(clamp<int>(coord.Y, 0, _api.cellCount.y));
 
     if (_api.lastPaintBufferLineCoord.y != y)
@@ -478,7 +538,7 @@ try
                 _api.bufferLineColumn.emplace_back(column);
             }
 
-            column += gsl::narrow_cast<u16>(cluster.GetColumns());
+            column = gsl::narrow_cast<u16>(std::min<int>(column + (cluster.GetColumns() << scale), _api.cellCount.x));
         }
 
         _api.bufferLineColumn.emplace_back(column);
@@ -508,12 +568,27 @@ try
 }
 CATCH_RETURN()
 
+[[nodiscard]] HRESULT AtlasEngine::PaintImageSlice(const ImageSlice::Pointer& imageSlice, const til::CoordType targetRow, const til::CoordType viewportLeft) noexcept
+try
+{
+    // The image is drawn over the glyphs of the row, which only exist once Present() shaped them.
+    _flushBufferLine();
+
+    if (targetRow >= 0 && targetRow < _api.cellCount.y)
+    {
+        _api.imageJobs.emplace_back(ImageJob{ imageSlice, gsl::narrow_cast<u16>(targetRow), viewportLeft });
+    }
+    return S_OK;
+}
+CATCH_RETURN()
+
 [[nodiscard]] HRESULT AtlasEngine::PaintSelection(const til::rect& rect) noexcept
 try
 {
     // Unfortunately there's no step after Renderer::_PaintBufferOutput that
     // would inform us that it's done with the last AtlasEngine::PaintBufferLine.
     // As such we got to call _flushBufferLine() here just to be sure.
+    // The selection is applied on top of the glyphs in Present(), after the line was queued up for shaping.
     _flushBufferLine();
 
     const u16r u16rect{
@@ -522,7 +597,7 @@ try
         rect.narrow_right<u16>(),
         rect.narrow_bottom<u16>(),
     };
-    _setCellFlags(u16rect, CellFlags::Selected, CellFlags::Selected);
+    _queueCellFlags(u16rect, CellFlags::Selected, CellFlags::Selected);
     return S_OK;
 }
 CATCH_RETURN()
@@ -533,6 +608,7 @@ try
     // Unfortunately there's no step after Renderer::_PaintBufferOutput that
     // would inform us that it's done with the last AtlasEngine::PaintBufferLine.
     // As such we got to call _flushBufferLine() here just to be sure.
+    // The cursor is applied on top of the glyphs in Present(), after the line was queued up for shaping.
     _flushBufferLine();
 
     {
@@ -551,7 +627,7 @@ try
     // Clear the previous cursor
     if (_api.invalidatedCursorArea.non_empty())
     {
-        _setCellFlags(_api.invalidatedCursorArea, CellFlags::Cursor, CellFlags::None);
+        _queueCellFlags(_api.invalidatedCursorArea, CellFlags::Cursor, CellFlags::None);
     }
 
     if (options.isOn)
@@ -563,7 +639,7 @@ try
         const auto y = gsl::narrow_cast<uint16_t>(clamp<int>(point.Y, 0, _r.cellCount.y - 1));
         const auto right = gsl::narrow_cast<uint16_t>(x + 1 + (options.fIsDoubleWidth & (options.cursorType != CursorType::VerticalBar)));
         const auto bottom = gsl::narrow_cast<uint16_t>(y + 1);
-        _setCellFlags({ x, y, right, bottom }, CellFlags::Cursor, CellFlags::Cursor);
+        _queueCellFlags({ x, y, right, bottom }, CellFlags::Cursor, CellFlags::Cursor);
     }
 
     return S_OK;
@@ -598,7 +674,7 @@ try
         }
 
         const u32x2 newColors{ gsl::narrow_cast<u32>(fg), gsl::narrow_cast<u32>(bg) };
-        const AtlasKeyAttributes attributes{ 0, textAttributes.IsIntense(), textAttributes.IsItalic(), 0 };
+        const AtlasKeyAttributes attributes{ 0, textAttributes.IsIntense(), textAttributes.IsItalic(), _api.attributes.lineRendition, 0 };
 
         if (_api.attributes != attributes)
         {
@@ -748,6 +824,16 @@ void AtlasEngine::_createResources()
     THROW_IF_FAILED(_r.device->CreateVertexShader(&shader_vs[0], sizeof(shader_vs), nullptr, _r.vertexShader.put()));
     THROW_IF_FAILED(_r.device->CreatePixelShader(&shader_ps[0], sizeof(shader_ps), nullptr, _r.pixelShader.put()));
 
+    // Present() limits the pixel shader to the parts of the back buffer that changed using scissor rects.
+    {
+        D3D11_RASTERIZER_DESC desc{};
+        desc.FillMode = D3D11_FILL_SOLID;
+        desc.CullMode = D3D11_CULL_NONE;
+        desc.DepthClipEnable = TRUE;
+        desc.ScissorEnable = TRUE;
+        THROW_IF_FAILED(_r.device->CreateRasterizerState(&desc, _r.rasterizerState.put()));
+    }
+
     WI_ClearFlag(_api.invalidations, ApiInvalidations::Device);
     WI_SetAllFlags(_api.invalidations, ApiInvalidations::SwapChain);
 }
@@ -786,9 +872,11 @@ void AtlasEngine::_createSwapChain()
         desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
         desc.BufferCount = 2; // TODO: 3?
         desc.Scaling = DXGI_SCALING_NONE;
-        desc.SwapEffect = _sr.isWindows10OrGreater ? DXGI_SWAP_EFFECT_FLIP_DISCARD : DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
+        // DXGI_SWAP_EFFECT_FLIP_DISCARD doesn't support IDXGISwapChain1::Present1 with dirty rects, which
+        // allow DWM and remote desktop to only update the parts of our window that changed. See _present().
+        desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
         // * HWND swap chains can't do alpha.
-        // * If our background is opaque we can enable "independent" flips by setting DXGI_SWAP_EFFECT_FLIP_DISCARD and DXGI_ALPHA_MODE_IGNORE.
+        // * If our background is opaque we can enable "independent" flips by using a flip model swap effect and DXGI_ALPHA_MODE_IGNORE.
         //   As our swap chain won't have to compose with DWM anymore it reduces the display latency dramatically.
         desc.AlphaMode = _api.hwnd || _api.backgroundOpaqueMixin ? DXGI_ALPHA_MODE_IGNORE : DXGI_ALPHA_MODE_PREMULTIPLIED;
         desc.Flags = supportsFrameLatencyWaitableObject ? DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT : 0;
@@ -861,6 +949,9 @@ void AtlasEngine::_recreateSizeDependentResources()
         THROW_IF_FAILED(_r.swapChain->ResizeBuffers(0, _api.sizeInPixel.x, _api.sizeInPixel.y, DXGI_FORMAT_UNKNOWN, DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT));
     }
 
+    // After ResizeBuffers() the back buffer doesn't contain the previous frame anymore.
+    _r.presentFull = true;
+
     // The RenderTargetView is later used with OMSetRenderTargets
     // to tell D3D where stuff is supposed to be rendered at.
     {
@@ -881,15 +972,11 @@ void AtlasEngine::_recreateSizeDependentResources()
         _r.deviceContext->RSSetViewports(1, &viewport);
     }
 
-    if (_api.cellCount != _r.cellCount)
+    if (const auto cellRowCount = _getCellRowCount(); _api.cellCount != _r.cellCount || cellRowCount != _r.cellRowCount)
     {
-        const auto totalCellCount = static_cast<size_t>(_api.cellCount.x) * static_cast<size_t>(_api.cellCount.y);
+        const auto totalCellCount = static_cast<size_t>(_api.cellCount.x) * static_cast<size_t>(cellRowCount);
         // Let's guess that every cell consists of a surrogate pair.
         const auto projectedTextSize = static_cast<size_t>(_api.cellCount.x) * 2;
-        // IDWriteTextAnalyzer::GetGlyphs says:
-        //   The recommended estimate for the per-glyph output buffers is (3 * textLength / 2 + 16).
-        // We already set the textLength to twice the cell count.
-        const auto projectedGlyphSize = 3 * projectedTextSize + 16;
 
         // This buffer is a bit larger than the others (multiple MB).
         // Prevent a memory usage spike, by first deallocating and then allocating.
@@ -899,6 +986,14 @@ void AtlasEngine::_recreateSizeDependentResources()
         // (40x on AMD Zen1-3, which have a rep movsb performance issue. MSFT:33358259.)
         _r.cells = Buffer<Cell, 32>{ totalCellCount };
         _r.cellCount = _api.cellCount;
+        _r.cellRowOffset = 0;
+        _r.cellRowCount = cellRowCount;
+        _r.smoothScrollPixels = 0;
+        _r.dirtyRows = invalidatedRowsAll;
+        _r.dirtyRects.clear();
+        _r.dirtyRects.reserve(dirtyRectsLimit);
+        _r.presentScrollOffset = 0;
+        _r.presentFull = true;
 
         // .clear() doesn't free the memory of these buffers.
         // This code allows them to shrink again.
@@ -906,20 +1001,22 @@ void AtlasEngine::_recreateSizeDependentResources()
         _api.bufferLine.reserve(projectedTextSize);
         _api.bufferLineColumn.reserve(projectedTextSize + 1);
         _api.bufferLineMetadata = Buffer<BufferLineMetadata>{ _api.cellCount.x };
-        _api.analysisResults = {};
-
-        _api.clusterMap = Buffer<u16>{ projectedTextSize };
-        _api.textProps = Buffer<DWRITE_SHAPING_TEXT_PROPERTIES>{ projectedTextSize };
-        _api.glyphIndices = Buffer<u16>{ projectedGlyphSize };
-        _api.glyphProps = Buffer<DWRITE_SHAPING_GLYPH_PROPERTIES>{ projectedGlyphSize };
-        _api.glyphAdvances = Buffer<f32>{ projectedGlyphSize };
-        _api.glyphOffsets = Buffer<DWRITE_GLYPH_OFFSET>{ projectedGlyphSize };
+        _api.shapingJobs = {};
+        _api.shapingJobCount = 0;
+        _api.frameJobs = {};
+        _api.frameJobCount = 0;
+        _api.cellFlagUpdates.clear();
+        _api.frameCellFlagUpdates.clear();
+        // These are sized by the cell count and will be recreated by _shapeBufferLines() as needed.
+        _api.shapingScratch = {};
 
         D3D11_BUFFER_DESC desc;
         desc.ByteWidth = gsl::narrow<u32>(totalCellCount * sizeof(Cell)); // totalCellCount can theoretically be UINT32_MAX!
-        desc.Usage = D3D11_USAGE_DYNAMIC;
+        // D3D11_USAGE_DEFAULT allows us to only update the rows that changed using UpdateSubresource().
+        // A D3D11_USAGE_DYNAMIC buffer would need to be mapped with D3D11_MAP_WRITE_DISCARD and uploaded in full.
+        desc.Usage = D3D11_USAGE_DEFAULT;
         desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        desc.CPUAccessFlags = 0;
         desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
         desc.StructureByteStride = sizeof(Cell);
         THROW_IF_FAILED(_r.device->CreateBuffer(&desc, nullptr, _r.cellBuffer.put()));
@@ -966,6 +1063,11 @@ void AtlasEngine::_recreateFontDependentResources()
         _r.cellSizeDIP.y = static_cast<float>(_api.fontMetrics.cellSize.y) / scaling;
         _r.cellSize = _api.fontMetrics.cellSize;
         _r.cellCount = _api.cellCount;
+        // Copies for _shapeBufferLine(), which runs in Present() outside of the console lock.
+        _r.fontName = _api.fontMetrics.fontName.get();
+        _r.fontFeatures = _api.fontFeatures;
+        _r.fontSizeInDIP = _api.fontMetrics.fontSizeInDIP;
+        _r.fontWeight = _api.fontMetrics.fontWeight;
         // x/yLimit are strictly smaller than dimensionLimit, which is smaller than a u16.
         _r.atlasSizeInPixelLimit = u16x2{ gsl::narrow_cast<u16>(xLimit), gsl::narrow_cast<u16>(yLimit) };
         _r.atlasSizeInPixel = { 0, 0 };
@@ -974,8 +1076,22 @@ void AtlasEngine::_recreateFontDependentResources()
         _r.atlasPosition.x = _api.fontMetrics.cellSize.x;
         _r.atlasPosition.y = 0;
 
+        const auto tileRows = yLimit / csy;
+        const auto pageRows = (tileRows + atlasPageCountTarget - 1) / atlasPageCountTarget;
+        _r.atlasPageRows = gsl::narrow_cast<u16>(pageRows);
+        _r.atlasPages = std::vector<AtlasPage>((tileRows + pageRows - 1) / pageRows);
+        _r.atlasFull = false;
+        _r.atlasPageEvicted = false;
+        _r.atlasStatistics = {};
+        _r.atlasStatistics.tileCapacity = gsl::narrow_cast<u32>(tileRows * (xLimit / csx));
+
         _r.glyphs = {};
         _r.glyphQueue = {};
+        _r.imageTiles = {};
+        _r.imageQueue = {};
+        _r.shapedLines = {};
+        _r.cachedLineMap = {};
+        _r.cachedLines = {};
         _r.glyphQueue.reserve(64);
     }
     // D3D specifically for UpdateDpi()
@@ -1090,7 +1206,70 @@ AtlasEngine::Cell* AtlasEngine::_getCell(u16 x, u16 y) noexcept
 {
     assert(x < _r.cellCount.x);
     assert(y < _r.cellCount.y);
-    return _r.cells.data() + static_cast<size_t>(_r.cellCount.x) * y + x;
+    return _r.cells.data() + static_cast<size_t>(_r.cellCount.x) * _getCellRow(y) + x;
+}
+
+// Maps a row of the viewport to the row of the _r.cells ring it's stored in. See StartPaint().
+u16 AtlasEngine::_getCellRow(u16 y) const noexcept
+{
+    auto row = static_cast<u32>(y) + _r.cellRowOffset;
+    if (row >= _r.cellRowCount)
+    {
+        row -= _r.cellRowCount;
+    }
+    return gsl::narrow_cast<u16>(row);
+}
+
+// The number of rows the _r.cells ring needs for _api.cellCount. With smooth scrolling
+// it holds another screen full of rows, so that a scroll by up to a page can be animated.
+AtlasEngine::u16 AtlasEngine::_getCellRowCount() const noexcept
+{
+    const auto rows = static_cast<u32>(_api.cellCount.y);
+    return gsl::narrow_cast<u16>(std::min<u32>(_api.smoothScrolling ? rows * 2 : rows, u16max));
+}
+
+// Moves the rows of a smooth scroll closer to their final position. The remaining
+// offset decays exponentially with the time since the last frame, which makes the
+// animation independent of the refresh rate and lets consecutive scrolls blend into
+// each other (for instance when flicking through a log with a touchpad).
+void AtlasEngine::_advanceSmoothScroll() noexcept
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto elapsed = std::chrono::duration<f32, std::milli>(now - _r.smoothScrollTime).count();
+    _r.smoothScrollTime = now;
+    _r.smoothScrollPixels *= std::exp2f(-elapsed / smoothScrollHalfLifeMs);
+
+    // Less than half a pixel isn't visible anymore.
+    if (std::fabsf(_r.smoothScrollPixels) < 0.5f)
+    {
+        _r.smoothScrollPixels = 0;
+    }
+}
+
+// Queues up a _setCellFlags() call for Present(), because the cells are only
+// filled with the glyphs of the current frame once Present() shaped them.
+void AtlasEngine::_queueCellFlags(u16r coords, CellFlags mask, CellFlags bits)
+{
+    _api.cellFlagUpdates.emplace_back(CellFlagUpdate{ coords, mask, bits });
+}
+
+// Marks the given cells as changed. Present() uploads their rows to the
+// cellBuffer and passes the rectangle to Present1() as a dirty rect.
+void AtlasEngine::_markDirtyRect(u16r rect) noexcept
+{
+    _r.dirtyRows.x = std::min(_r.dirtyRows.x, rect.top);
+    _r.dirtyRows.y = std::max(_r.dirtyRows.y, rect.bottom);
+
+    // dirtyRects has a capacity of dirtyRectsLimit, so this doesn't allocate.
+    if (_r.dirtyRects.size() < dirtyRectsLimit)
+    {
+#pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function '...' which may throw exceptions (f.6).
+        _r.dirtyRects.emplace_back(rect);
+    }
+    else
+    {
+        _r.presentFull = true;
+    }
 }
 
 void AtlasEngine::_setCellFlags(u16r coords, CellFlags mask, CellFlags bits) noexcept
@@ -1102,13 +1281,18 @@ void AtlasEngine::_setCellFlags(u16r coords, CellFlags mask, CellFlags bits) noe
 
     const auto filter = ~mask;
     const auto width = static_cast<size_t>(coords.right) - coords.left;
-    const auto height = static_cast<size_t>(coords.bottom) - coords.top;
-    const auto stride = static_cast<size_t>(_r.cellCount.x);
-    auto row = _r.cells.data() + static_cast<size_t>(_r.cellCount.x) * coords.top + coords.left;
-    const auto end = row + height * stride;
+    if (width == 0 || coords.top == coords.bottom)
+    {
+        return;
+    }
+
+    _markDirtyRect(coords);
 
-    for (; row != end; row += stride)
+    // The rows of _r.cells form a ring (see StartPaint()), which is
+    // why we can't simply advance the pointer by a row stride here.
+    for (auto y = coords.top; y < coords.bottom; ++y)
     {
+        const auto row = _getCell(coords.left, y);
         const auto dataEnd = row + width;
         for (auto data = row; data != dataEnd; ++data)
         {
@@ -1127,15 +1311,156 @@ AtlasEngine::u16x2 AtlasEngine::_allocateAtlasTile() noexcept
     {
         _r.atlasPosition.x = 0;
         _r.atlasPosition.y += _r.cellSize.y;
-        if (_r.atlasPosition.y >= _r.atlasSizeInPixelLimit.y)
+    }
+
+    return ret;
+}
+
+// Allocates cellCount consecutive tiles on a single atlas page,
+// switching to the next page first if the current one is too full.
+void AtlasEngine::_allocateAtlasTiles(u16x2* coords, u16 cellCount)
+{
+    if (_remainingAtlasPageTiles() < cellCount)
+    {
+        _nextAtlasPage();
+    }
+
+    for (u16 i = 0; i < cellCount; ++i)
+    {
+        coords[i] = _allocateAtlasTile();
+    }
+}
+
+u32 AtlasEngine::_remainingAtlasPageTiles() const noexcept
+{
+    const u32 posX = _r.atlasPosition.x;
+    const u32 posY = _r.atlasPosition.y;
+    const u32 limitY = _r.atlasSizeInPixelLimit.y;
+    if (posY >= limitY)
+    {
+        return 0;
+    }
+
+    const u32 pageHeight = static_cast<u32>(_r.atlasPageRows) * _r.cellSize.y;
+    const auto pageEnd = std::min((posY / pageHeight + 1) * pageHeight, limitY);
+    const u32 tilesPerRow = _r.atlasSizeInPixelLimit.x / _r.cellSize.x;
+    return (pageEnd - posY) / _r.cellSize.y * tilesPerRow - posX / _r.cellSize.x;
+}
+
+// Moves _r.atlasPosition to the start of the next page. Until the atlas was filled once that's simply
+// the page after the current one. Afterwards it's the least recently used page, which gets evicted.
+void AtlasEngine::_nextAtlasPage()
+{
+    const u32 pageHeight = static_cast<u32>(_r.atlasPageRows) * _r.cellSize.y;
+    const auto nextPageY = (_r.atlasPosition.y / pageHeight + 1) * pageHeight;
+
+    if (!_r.atlasFull && nextPageY < _r.atlasSizeInPixelLimit.y)
+    {
+        _r.atlasPosition = { 0, gsl::narrow_cast<u16>(nextPageY) };
+        return;
+    }
+
+    _r.atlasFull = true;
+
+    // Pages used during the current frame can't be evicted: Their glyphs might still be
+    // in the glyphQueue and the cells we've written during this frame refer to them.
+    auto victim = _r.atlasPages.size();
+    auto oldestFrame = _r.frame;
+    for (size_t i = 0; i < _r.atlasPages.size(); ++i)
+    {
+        if (_r.atlasPages[i].lastUsedFrame < oldestFrame)
         {
-            _r.atlasPosition.x = _r.cellSize.x;
-            _r.atlasPosition.y = 0;
-            showOOMWarning();
+            oldestFrame = _r.atlasPages[i].lastUsedFrame;
+            victim = i;
         }
     }
 
-    return ret;
+    if (victim == _r.atlasPages.size())
+    {
+        // The current frame alone needs more glyphs than the atlas can hold.
+        // All we can do is overwrite existing tiles like we did before pages existed.
+        _r.atlasStatistics.overflows++;
+        _r.atlasPosition = { _r.cellSize.x, 0 };
+        showOOMWarning();
+        return;
+    }
+
+    _evictAtlasPage(victim);
+
+    // The first Cell at {0, 0} is always our cursor texture.
+    _r.atlasPosition = {
+        victim == 0 ? _r.cellSize.x : u16{ 0 },
+        gsl::narrow_cast<u16>(victim * pageHeight),
+    };
+}
+
+void AtlasEngine::_evictAtlasPage(size_t index)
+{
+    auto& page = _r.atlasPages[index];
+
+    for (const auto key : page.glyphs)
+    {
+        // Erase by iterator, because erase(const key_type&) with a reference
+        // to the key of the element that is being erased is asking for trouble.
+        if (const auto it = _r.glyphs.find(*key); it != _r.glyphs.end())
+        {
+            _r.glyphs.erase(it);
+        }
+    }
+    for (const auto key : page.images)
+    {
+        _r.imageTiles.erase(key);
+    }
+
+    // Cached lines that refer to this page are invalid now.
+    const auto bit = u64{ 1 } << index;
+    for (auto it = _r.cachedLines.begin(); it != _r.cachedLines.end();)
+    {
+        if (it->atlasPages & bit)
+        {
+            _r.cachedLineMap.erase(it->key);
+            it = _r.cachedLines.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    auto& statistics = _r.atlasStatistics;
+    statistics.allocatedTiles -= page.tiles;
+    statistics.evictedPages++;
+    statistics.evictedGlyphs += gsl::narrow_cast<u32>(page.glyphs.size() + page.images.size());
+
+    if constexpr (debugAtlasOccupancy)
+    {
+        wchar_t buffer[256];
+        swprintf_s(buffer, L"AtlasEngine: evicted page %zu (%zu glyphs), %u/%u tiles allocated, %u pages evicted, %u overflows\n", index, page.glyphs.size(), statistics.allocatedTiles, statistics.tileCapacity, statistics.evictedPages, statistics.overflows);
+        OutputDebugStringW(&buffer[0]);
+    }
+
+    page.glyphs.clear();
+    page.images.clear();
+    page.tiles = 0;
+
+    // The parts of _r.cells that aren't repainted during this frame might still refer to this page.
+    _r.atlasPageEvicted = true;
+}
+
+size_t AtlasEngine::_getAtlasPageIndex(u16x2 coord) const noexcept
+{
+    const auto page = coord.y / (static_cast<size_t>(_r.atlasPageRows) * _r.cellSize.y);
+    return std::min(page, _r.atlasPages.size() - 1);
+}
+
+u64 AtlasEngine::_getAtlasPageMask(const Cell* cells, size_t count) const noexcept
+{
+    u64 mask = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        mask |= u64{ 1 } << _getAtlasPageIndex(cells[i].tileIndex);
+    }
+    return mask;
 }
 
 void AtlasEngine::_flushBufferLine()
@@ -1153,6 +1478,265 @@ void AtlasEngine::_flushBufferLine()
     // This would seriously blow us up otherwise.
     Expects(_api.bufferLineColumn.size() == _api.bufferLine.size() + 1);
 
+    const auto x1 = _api.bufferLineColumn.front();
+    const auto x2 = _api.bufferLineColumn.back();
+    Expects(x1 <= x2 && x2 <= _api.bufferLineMetadata.size());
+
+    // The line isn't shaped right away: _shapeBufferLines() shapes all lines of a frame at once,
+    // which allows it to skip lines it has seen before and to spread the others across threads.
+    // The job objects are reused between frames so that their vectors keep their capacity.
+    if (_api.shapingJobCount == _api.shapingJobs.size())
+    {
+        _api.shapingJobs.emplace_back();
+    }
+
+    auto& job = _api.shapingJobs[_api.shapingJobCount];
+    job.attributes = _api.attributes;
+    job.y = _api.lastPaintBufferLineCoord.y;
+    job.text.assign(_api.bufferLine.begin(), _api.bufferLine.end());
+    job.columns.assign(_api.bufferLineColumn.begin(), _api.bufferLineColumn.end());
+    job.metadata.assign(_api.bufferLineMetadata.data() + x1, _api.bufferLineMetadata.data() + x2);
+    job.glyphs.reset();
+    job.hr = S_OK;
+
+    // The shaping result only depends on the font attributes, the text and the column of each character.
+    job.cacheKey.clear();
+    job.cacheKey.push_back(til::bit_cast<wchar_t>(_api.attributes));
+    job.cacheKey.append(_api.bufferLine.data(), _api.bufferLine.size());
+    for (const auto column : _api.bufferLineColumn)
+    {
+        job.cacheKey.push_back(static_cast<wchar_t>(column));
+    }
+
+    // The finished cells additionally depend on the colors and flags of each cell.
+    static_assert(sizeof(BufferLineMetadata) % sizeof(wchar_t) == 0);
+    job.lineKey = job.cacheKey;
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+    job.lineKey.append(reinterpret_cast<const wchar_t*>(job.metadata.data()), job.metadata.size() * sizeof(BufferLineMetadata) / sizeof(wchar_t));
+
+    ++_api.shapingJobCount;
+}
+
+// Shapes all the segments queued up by _flushBufferLine() and writes the resulting glyphs into _r.cells.
+// Segments that were drawn recently are copied from _r.cachedLines as is, which turns scrolling through
+// previously seen content into a memcpy. Segments that were shaped recently are taken from _r.shapedLines.
+// The remaining ones are shaped by the render thread with the help of up to shapingMaxWorkers threadpool
+// workers. Afterwards the glyphs are emplaced into the atlas in the original order on the render thread,
+// because neither _r.glyphs nor the atlas allocator are thread-safe.
+// Turns the frame handed over by EndPaint() into cells. Called by Present() outside of the console lock.
+void AtlasEngine::_processFrame()
+{
+    _shapeBufferLines();
+
+    // Images replace the glyphs of their cells and the selection and cursor are drawn over them.
+    for (const auto& job : _api.frameImageJobs)
+    {
+        _emplaceImageSlice(job);
+    }
+    _api.frameImageJobs.clear();
+
+    for (const auto& update : _api.frameCellFlagUpdates)
+    {
+        _setCellFlags(update.coords, update.mask, update.bits);
+    }
+    _api.frameCellFlagUpdates.clear();
+
+    _statistics.glyphs.store(gsl::narrow_cast<u32>(_r.glyphs.size()), std::memory_order_relaxed);
+    _statistics.allocatedTiles.store(_r.atlasStatistics.allocatedTiles, std::memory_order_relaxed);
+    _statistics.tileCapacity.store(_r.atlasStatistics.tileCapacity, std::memory_order_relaxed);
+
+    // These are estimates from the sizes of the resources, because neither D3D nor the
+    // containers tell us what they actually allocated. All of our textures are BGRA.
+    {
+        static constexpr u64 bytesPerPixel = 4;
+        const auto pixels = [](const u16x2 size) noexcept {
+            return u64{ size.x } * size.y;
+        };
+        // The swap chain has 2 buffers, see _createSwapChain().
+        auto gpuBytes = 2 * pixels(_api.sizeInPixel) * bytesPerPixel;
+        gpuBytes += pixels(_r.atlasSizeInPixel) * bytesPerPixel;
+        gpuBytes += u64{ _r.cellSize.x } * _r.scratchpadCellWidth * _r.cellSize.y * bytesPerPixel;
+        gpuBytes += _r.cells.size() * sizeof(Cell);
+        _statistics.gpuBytes.store(gpuBytes, std::memory_order_relaxed);
+
+        u64 cacheBytes = _r.cells.size() * sizeof(Cell);
+        cacheBytes += _r.glyphs.size() * (sizeof(AtlasKey) + sizeof(AtlasValue));
+        cacheBytes += _r.imageTiles.size() * (sizeof(u64) + sizeof(u16x2));
+        cacheBytes += _r.shapedLines.allocated_bytes() + _r.shapedLines.size() * sizeof(ShapedGlyphs);
+        cacheBytes += _r.cachedLineMap.allocated_bytes() + _r.cachedLines.size() * sizeof(CachedLine);
+        _statistics.cacheBytes.store(cacheBytes, std::memory_order_relaxed);
+    }
+}
+
+void AtlasEngine::_shapeBufferLines()
+{
+    if (!_api.frameJobCount)
+    {
+        return;
+    }
+
+    const auto cleanup = wil::scope_exit([this]() noexcept {
+        _api.frameJobCount = 0;
+        _api.shapingMisses.clear();
+    });
+
+    for (size_t i = 0; i < _api.frameJobCount; ++i)
+    {
+        auto& job = _api.frameJobs[i];
+        job.cachedLine = nullptr;
+
+        if (const auto it = _r.cachedLineMap.find(job.lineKey); it != _r.cachedLineMap.end())
+        {
+            _r.cachedLines.splice(_r.cachedLines.begin(), _r.cachedLines, it->second);
+            job.cachedLine = &*it->second;
+
+            // Pages used during the current frame must not be evicted, see _nextAtlasPage().
+            for (size_t page = 0; page < _r.atlasPages.size(); ++page)
+            {
+                if (job.cachedLine->atlasPages & (u64{ 1 } << page))
+                {
+                    _r.atlasPages[page].lastUsedFrame = _r.frame;
+                }
+            }
+        }
+        else if (const auto shaped = _r.shapedLines.find(job.cacheKey); shaped != _r.shapedLines.end())
+        {
+            job.glyphs = shaped->second;
+        }
+        else
+        {
+            _api.shapingMisses.emplace_back(i);
+        }
+    }
+
+    if (!_api.shapingMisses.empty())
+    {
+        static const size_t hardwareConcurrency = std::max(1u, std::thread::hardware_concurrency());
+        const auto workers = std::min({ _api.shapingMisses.size() / shapingJobsPerWorker, shapingMaxWorkers, hardwareConcurrency - 1 });
+
+        while (_api.shapingScratch.size() <= workers)
+        {
+            _api.shapingScratch.emplace_back(_r.cellCount.x);
+        }
+
+        _api.shapingNextMiss.store(0, std::memory_order_relaxed);
+        _api.shapingNextScratch.store(0, std::memory_order_relaxed);
+
+        if (workers)
+        {
+            if (!_api.shapingWork)
+            {
+                _api.shapingWork.reset(CreateThreadpoolWork(_shapingWorkCallback, this, nullptr));
+                THROW_LAST_ERROR_IF(!_api.shapingWork);
+            }
+
+            for (size_t i = 0; i < workers; ++i)
+            {
+                SubmitThreadpoolWork(_api.shapingWork.get());
+            }
+        }
+
+        // The render thread would just be waiting otherwise.
+        _shapeMissedJobs();
+
+        if (workers)
+        {
+            WaitForThreadpoolWorkCallbacks(_api.shapingWork.get(), FALSE);
+        }
+    }
+
+    if (_r.shapedLines.size() + _api.shapingMisses.size() > shapedLinesLimit)
+    {
+        _r.shapedLines.clear();
+    }
+
+    for (const auto i : _api.shapingMisses)
+    {
+        const auto& job = _api.frameJobs[i];
+        THROW_IF_FAILED(job.hr);
+        _r.shapedLines.insert_or_assign(job.cacheKey, job.glyphs);
+    }
+    _statistics.shapedLines.fetch_add(_api.shapingMisses.size(), std::memory_order_relaxed);
+
+    // Entries of _r.cachedLines are only evicted after this loop, so that the
+    // cachedLine pointers of the jobs stay valid while we're iterating.
+    for (size_t i = 0; i < _api.frameJobCount; ++i)
+    {
+        const auto& job = _api.frameJobs[i];
+        const auto x1 = job.columns.front();
+        const auto x2 = job.columns.back();
+        const auto data = _getCell(x1, job.y);
+
+        if (job.cachedLine)
+        {
+            memcpy(data, job.cachedLine->cells.data(), job.cachedLine->cells.size() * sizeof(Cell));
+            continue;
+        }
+
+        for (const auto& glyph : *job.glyphs)
+        {
+            _emplaceGlyph(job, glyph);
+        }
+
+        auto it = _r.cachedLineMap.find(job.lineKey);
+        if (it == _r.cachedLineMap.end())
+        {
+            auto& line = _r.cachedLines.emplace_front(CachedLine{ job.lineKey, {} });
+            it = _r.cachedLineMap.try_emplace(line.key, _r.cachedLines.begin()).first;
+        }
+        else
+        {
+            _r.cachedLines.splice(_r.cachedLines.begin(), _r.cachedLines, it->second);
+        }
+        it->second->cells.assign(data, data + (x2 - x1));
+        it->second->atlasPages = _getAtlasPageMask(data, x2 - x1);
+    }
+
+    while (_r.cachedLines.size() > cachedLinesLimit)
+    {
+        _r.cachedLineMap.erase(_r.cachedLines.back().key);
+        _r.cachedLines.pop_back();
+    }
+}
+
+void CALLBACK AtlasEngine::_shapingWorkCallback(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context, PTP_WORK /*work*/) noexcept
+{
+    static_cast<AtlasEngine*>(context)->_shapeMissedJobs();
+}
+
+// Runs on the render thread and the threadpool workers started by _shapeBufferLines() at the same time.
+// Each of them grabs its own ShapingScratch and then shapes missed jobs until none are left.
+void AtlasEngine::_shapeMissedJobs() noexcept
+{
+    auto& scratch = _api.shapingScratch[_api.shapingNextScratch.fetch_add(1, std::memory_order_relaxed)];
+
+    for (;;)
+    {
+        const auto miss = _api.shapingNextMiss.fetch_add(1, std::memory_order_relaxed);
+        if (miss >= _api.shapingMisses.size())
+        {
+            break;
+        }
+
+        auto& job = _api.frameJobs[_api.shapingMisses[miss]];
+        try
+        {
+            auto glyphs = std::make_shared<ShapedGlyphs>();
+            _shapeBufferLine(job, scratch, *glyphs);
+            job.glyphs = std::move(glyphs);
+        }
+        catch (...)
+        {
+            job.hr = wil::ResultFromCaughtException();
+        }
+    }
+}
+
+// This function may be called by multiple threads at once and must not modify any member.
+// Everything it needs is in the given job and scratch buffers, DirectWrite's shared factory
+// objects in _sr are free-threaded and all other resources are only read.
+void AtlasEngine::_shapeBufferLine(const ShapingJob& job, ShapingScratch& scratch, ShapedGlyphs& glyphs) const
+{
     // NOTE:
     // This entire function is one huge hack to see if it works.
 
@@ -1160,7 +1744,7 @@ void AtlasEngine::_flushBufferLine()
     //
     // # What do we want?
     //
-    // Segment a line of text (_api.bufferLine) into unicode "clusters".
+    // Segment a line of text (job.text) into unicode "clusters".
     // Each cluster is one "whole" glyph with diacritics, ligatures, zero width joiners
     // and whatever else, that should be cached as a whole in our texture atlas.
     //
@@ -1186,10 +1770,10 @@ void AtlasEngine::_flushBufferLine()
     //
     // Font fallback with IDWriteFontFallback::MapCharacters is very slow.
 
-    const auto textFormat = _getTextFormat(_api.attributes.bold, _api.attributes.italic);
-    const auto& textFormatAxis = _getTextFormatAxis(_api.attributes.bold, _api.attributes.italic);
+    const auto textFormat = _getTextFormat(job.attributes.bold, job.attributes.italic);
+    const auto& textFormatAxis = _getTextFormatAxis(job.attributes.bold, job.attributes.italic);
 
-    TextAnalyzer atlasAnalyzer{ _api.bufferLine, _api.analysisResults };
+    TextAnalyzer atlasAnalyzer{ job.text, scratch.analysisResults };
 
     wil::com_ptr<IDWriteFontCollection> fontCollection;
     THROW_IF_FAILED(textFormat->GetFontCollection(fontCollection.addressof()));
@@ -1197,7 +1781,7 @@ void AtlasEngine::_flushBufferLine()
     wil::com_ptr<IDWriteFontFace> mappedFontFace;
 
 #pragma warning(suppress : 26494) // Variable 'mappedEnd' is uninitialized. Always initialize an object (type.5).
-    for (u32 idx = 0, mappedEnd; idx < _api.bufferLine.size(); idx = mappedEnd)
+    for (u32 idx = 0, mappedEnd; idx < job.text.size(); idx = mappedEnd)
     {
         if (_sr.systemFontFallback)
         {
@@ -1210,9 +1794,9 @@ void AtlasEngine::_flushBufferLine()
                 THROW_IF_FAILED(_sr.systemFontFallback.query<IDWriteFontFallback1>()->MapCharacters(
                     /* analysisSource */ &atlasAnalyzer,
                     /* textPosition */ idx,
-                    /* textLength */ gsl::narrow_cast<u32>(_api.bufferLine.size()) - idx,
+                    /* textLength */ gsl::narrow_cast<u32>(job.text.size()) - idx,
                     /* baseFontCollection */ fontCollection.get(),
-                    /* baseFamilyName */ _api.fontMetrics.fontName.get(),
+                    /* baseFamilyName */ _r.fontName.c_str(),
                     /* fontAxisValues */ textFormatAxis.data(),
                     /* fontAxisValueCount */ gsl::narrow_cast<u32>(textFormatAxis.size()),
                     /* mappedLength */ &mappedLength,
@@ -1222,16 +1806,16 @@ void AtlasEngine::_flushBufferLine()
             }
             else
             {
-                const auto baseWeight = _api.attributes.bold ? DWRITE_FONT_WEIGHT_BOLD : static_cast<DWRITE_FONT_WEIGHT>(_api.fontMetrics.fontWeight);
-                const auto baseStyle = _api.attributes.italic ? DWRITE_FONT_STYLE_ITALIC : DWRITE_FONT_STYLE_NORMAL;
+                const auto baseWeight = job.attributes.bold ? DWRITE_FONT_WEIGHT_BOLD : static_cast<DWRITE_FONT_WEIGHT>(_r.fontWeight);
+                const auto baseStyle = job.attributes.italic ? DWRITE_FONT_STYLE_ITALIC : DWRITE_FONT_STYLE_NORMAL;
                 wil::com_ptr<IDWriteFont> font;
 
                 THROW_IF_FAILED(_sr.systemFontFallback->MapCharacters(
                     /* analysisSource     */ &atlasAnalyzer,
                     /* textPosition       */ idx,
-                    /* textLength         */ gsl::narrow_cast<u32>(_api.bufferLine.size()) - idx,
+                    /* textLength         */ gsl::narrow_cast<u32>(job.text.size()) - idx,
                     /* baseFontCollection */ fontCollection.get(),
-                    /* baseFamilyName     */ _api.fontMetrics.fontName.get(),
+                    /* baseFamilyName     */ _r.fontName.c_str(),
                     /* baseWeight         */ baseWeight,
                     /* baseStyle          */ baseStyle,
                     /* baseStretch        */ DWRITE_FONT_STRETCH_NORMAL,
@@ -1252,20 +1836,20 @@ void AtlasEngine::_flushBufferLine()
             {
                 // Task: Replace all characters in this range with unicode replacement characters.
                 // Input (where "n" is a narrow and "ww" is a wide character):
-                //    _api.bufferLine       = "nwwnnw"
-                //    _api.bufferLineColumn = {0, 1, 1, 2, 3, 4, 4, 5}
+                //    job.text       = "nwwnnw"
+                //    job.columns = {0, 1, 1, 2, 3, 4, 4, 5}
                 //                             n  w  w  n  n  w  w
                 // Solution:
                 //   Iterate through bufferLineColumn until the value changes, because this indicates we passed over a
                 //   complete (narrow or wide) cell. To do so we'll use col1 (previous column) and col2 (next column).
-                //   Then we emit a replacement character by telling _emplaceGlyph that this range has no font face.
+                //   Then we emit a glyph without a font face for this range, which _emplaceGlyph draws as a replacement character.
                 auto pos1 = idx;
-                auto col1 = _api.bufferLineColumn[pos1];
+                auto col1 = job.columns[pos1];
                 for (auto pos2 = idx + 1; pos2 <= mappedEnd; ++pos2)
                 {
-                    if (const auto col2 = _api.bufferLineColumn[pos2]; col1 != col2)
+                    if (const auto col2 = job.columns[pos2]; col1 != col2)
                     {
-                        _emplaceGlyph(nullptr, pos1, pos2);
+                        glyphs.emplace_back(ShapedGlyph{ nullptr, pos1, pos2 });
                         pos1 = pos2;
                         col1 = col2;
                     }
@@ -1278,8 +1862,8 @@ void AtlasEngine::_flushBufferLine()
         {
             if (!mappedFontFace)
             {
-                const auto baseWeight = _api.attributes.bold ? DWRITE_FONT_WEIGHT_BOLD : static_cast<DWRITE_FONT_WEIGHT>(_api.fontMetrics.fontWeight);
-                const auto baseStyle = _api.attributes.italic ? DWRITE_FONT_STYLE_ITALIC : DWRITE_FONT_STYLE_NORMAL;
+                const auto baseWeight = job.attributes.bold ? DWRITE_FONT_WEIGHT_BOLD : static_cast<DWRITE_FONT_WEIGHT>(_r.fontWeight);
+                const auto baseStyle = job.attributes.italic ? DWRITE_FONT_STYLE_ITALIC : DWRITE_FONT_STYLE_NORMAL;
 
                 wil::com_ptr<IDWriteFontFamily> fontFamily;
                 THROW_IF_FAILED(fontCollection->GetFontFamily(0, fontFamily.addressof()));
@@ -1290,29 +1874,29 @@ void AtlasEngine::_flushBufferLine()
                 THROW_IF_FAILED(font->CreateFontFace(mappedFontFace.put()));
             }
 
-            mappedEnd = gsl::narrow_cast<u32>(_api.bufferLine.size());
+            mappedEnd = gsl::narrow_cast<u32>(job.text.size());
         }
 
         // We can reuse idx here, as it'll be reset to "idx = mappedEnd" in the outer loop anyways.
         for (u32 complexityLength = 0; idx < mappedEnd; idx += complexityLength)
         {
             BOOL isTextSimple;
-            THROW_IF_FAILED(_sr.textAnalyzer->GetTextComplexity(_api.bufferLine.data() + idx, mappedEnd - idx, mappedFontFace.get(), &isTextSimple, &complexityLength, _api.glyphIndices.data()));
+            THROW_IF_FAILED(_sr.textAnalyzer->GetTextComplexity(job.text.data() + idx, mappedEnd - idx, mappedFontFace.get(), &isTextSimple, &complexityLength, scratch.glyphIndices.data()));
 
             if (isTextSimple)
             {
                 for (size_t i = 0; i < complexityLength; ++i)
                 {
-                    _emplaceGlyph(mappedFontFace.get(), idx + i, idx + i + 1u);
+                    glyphs.emplace_back(ShapedGlyph{ mappedFontFace, gsl::narrow_cast<u32>(idx + i), gsl::narrow_cast<u32>(idx + i + 1) });
                 }
             }
             else
             {
-                _api.analysisResults.clear();
+                scratch.analysisResults.clear();
                 THROW_IF_FAILED(_sr.textAnalyzer->AnalyzeScript(&atlasAnalyzer, idx, complexityLength, &atlasAnalyzer));
                 //_sr.textAnalyzer->AnalyzeBidi(&atlasAnalyzer, idx, complexityLength, &atlasAnalyzer);
 
-                for (const auto& a : _api.analysisResults)
+                for (const auto& a : scratch.analysisResults)
                 {
                     DWRITE_SCRIPT_ANALYSIS scriptAnalysis{ a.script, static_cast<DWRITE_SCRIPT_SHAPES>(a.shapes) };
                     u32 actualGlyphCount = 0;
@@ -1328,25 +1912,25 @@ void AtlasEngine::_flushBufferLine()
 #pragma warning(pop)
                     u32 featureRanges = 0;
 
-                    if (!_api.fontFeatures.empty())
+                    if (!_r.fontFeatures.empty())
                     {
-                        feature.features = _api.fontFeatures.data();
-                        feature.featureCount = gsl::narrow_cast<u32>(_api.fontFeatures.size());
+                        feature.features = _r.fontFeatures.data();
+                        feature.featureCount = gsl::narrow_cast<u32>(_r.fontFeatures.size());
                         features = &feature;
                         featureRangeLengths = a.textLength;
                         featureRanges = 1;
                     }
 
-                    if (_api.clusterMap.size() < a.textLength)
+                    if (scratch.clusterMap.size() < a.textLength)
                     {
-                        _api.clusterMap = Buffer<u16>{ a.textLength };
-                        _api.textProps = Buffer<DWRITE_SHAPING_TEXT_PROPERTIES>{ a.textLength };
+                        scratch.clusterMap = Buffer<u16>{ a.textLength };
+                        scratch.textProps = Buffer<DWRITE_SHAPING_TEXT_PROPERTIES>{ a.textLength };
                     }
 
                     for (auto retry = 0;;)
                     {
                         const auto hr = _sr.textAnalyzer->GetGlyphs(
-                            /* textString          */ _api.bufferLine.data() + a.textPosition,
+                            /* textString          */ job.text.data() + a.textPosition,
                             /* textLength          */ a.textLength,
                             /* fontFace            */ mappedFontFace.get(),
                             /* isSideways          */ false,
@@ -1357,22 +1941,22 @@ void AtlasEngine::_flushBufferLine()
                             /* features            */ &features,
                             /* featureRangeLengths */ &featureRangeLengths,
                             /* featureRanges       */ featureRanges,
-                            /* maxGlyphCount       */ gsl::narrow_cast<u32>(_api.glyphProps.size()),
-                            /* clusterMap          */ _api.clusterMap.data(),
-                            /* textProps           */ _api.textProps.data(),
-                            /* glyphIndices        */ _api.glyphIndices.data(),
-                            /* glyphProps          */ _api.glyphProps.data(),
+                            /* maxGlyphCount       */ gsl::narrow_cast<u32>(scratch.glyphProps.size()),
+                            /* clusterMap          */ scratch.clusterMap.data(),
+                            /* textProps           */ scratch.textProps.data(),
+                            /* glyphIndices        */ scratch.glyphIndices.data(),
+                            /* glyphProps          */ scratch.glyphProps.data(),
                             /* actualGlyphCount    */ &actualGlyphCount);
 
                         if (hr == HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER) && ++retry < 8)
                         {
                             // Grow factor 1.5x.
-                            auto size = _api.glyphProps.size();
+                            auto size = scratch.glyphProps.size();
                             size = size + (size >> 1);
                             // Overflow check.
-                            Expects(size > _api.glyphProps.size());
-                            _api.glyphIndices = Buffer<u16>{ size };
-                            _api.glyphProps = Buffer<DWRITE_SHAPING_GLYPH_PROPERTIES>(size);
+                            Expects(size > scratch.glyphProps.size());
+                            scratch.glyphIndices = Buffer<u16>{ size };
+                            scratch.glyphProps = Buffer<DWRITE_SHAPING_GLYPH_PROPERTIES>(size);
                             continue;
                         }
 
@@ -1380,27 +1964,27 @@ void AtlasEngine::_flushBufferLine()
                         break;
                     }
 
-                    if (_api.glyphAdvances.size() < actualGlyphCount)
+                    if (scratch.glyphAdvances.size() < actualGlyphCount)
                     {
                         // Grow the buffer by at least 1.5x and at least of `actualGlyphCount` items.
                         // The 1.5x growth ensures we don't reallocate every time we need 1 more slot.
-                        auto size = _api.glyphAdvances.size();
+                        auto size = scratch.glyphAdvances.size();
                         size = size + (size >> 1);
                         size = std::max<size_t>(size, actualGlyphCount);
-                        _api.glyphAdvances = Buffer<f32>{ size };
-                        _api.glyphOffsets = Buffer<DWRITE_GLYPH_OFFSET>{ size };
+                        scratch.glyphAdvances = Buffer<f32>{ size };
+                        scratch.glyphOffsets = Buffer<DWRITE_GLYPH_OFFSET>{ size };
                     }
 
                     THROW_IF_FAILED(_sr.textAnalyzer->GetGlyphPlacements(
-                        /* textString          */ _api.bufferLine.data() + a.textPosition,
-                        /* clusterMap          */ _api.clusterMap.data(),
-                        /* textProps           */ _api.textProps.data(),
+                        /* textString          */ job.text.data() + a.textPosition,
+                        /* clusterMap          */ scratch.clusterMap.data(),
+                        /* textProps           */ scratch.textProps.data(),
                         /* textLength          */ a.textLength,
-                        /* glyphIndices        */ _api.glyphIndices.data(),
-                        /* glyphProps          */ _api.glyphProps.data(),
+                        /* glyphIndices        */ scratch.glyphIndices.data(),
+                        /* glyphProps          */ scratch.glyphProps.data(),
                         /* glyphCount          */ actualGlyphCount,
                         /* fontFace            */ mappedFontFace.get(),
-                        /* fontEmSize          */ _api.fontMetrics.fontSizeInDIP,
+                        /* fontEmSize          */ _r.fontSizeInDIP,
                         /* isSideways          */ false,
                         /* isRightToLeft       */ a.bidiLevel & 1,
                         /* scriptAnalysis      */ &scriptAnalysis,
@@ -1408,17 +1992,17 @@ void AtlasEngine::_flushBufferLine()
                         /* features            */ &features,
                         /* featureRangeLengths */ &featureRangeLengths,
                         /* featureRanges       */ featureRanges,
-                        /* glyphAdvances       */ _api.glyphAdvances.data(),
-                        /* glyphOffsets        */ _api.glyphOffsets.data()));
+                        /* glyphAdvances       */ scratch.glyphAdvances.data(),
+                        /* glyphOffsets        */ scratch.glyphOffsets.data()));
 
-                    _api.textProps[a.textLength - 1].canBreakShapingAfter = 1;
+                    scratch.textProps[a.textLength - 1].canBreakShapingAfter = 1;
 
                     size_t beg = 0;
                     for (size_t i = 0; i < a.textLength; ++i)
                     {
-                        if (_api.textProps[i].canBreakShapingAfter)
+                        if (scratch.textProps[i].canBreakShapingAfter)
                         {
-                            _emplaceGlyph(mappedFontFace.get(), a.textPosition + beg, a.textPosition + i + 1);
+                            glyphs.emplace_back(ShapedGlyph{ mappedFontFace, gsl::narrow_cast<u32>(a.textPosition + beg), gsl::narrow_cast<u32>(a.textPosition + i + 1) });
                             beg = i + 1;
                         }
                     }
@@ -1428,25 +2012,29 @@ void AtlasEngine::_flushBufferLine()
     }
 }
 
-void AtlasEngine::_emplaceGlyph(IDWriteFontFace* fontFace, size_t bufferPos1, size_t bufferPos2)
+void AtlasEngine::_emplaceGlyph(const ShapingJob& job, const ShapedGlyph& glyph)
 {
     static constexpr auto replacement = L'\uFFFD';
 
+    const auto fontFace = glyph.fontFace.get();
+    const size_t bufferPos1 = glyph.bufferPos1;
+    const size_t bufferPos2 = glyph.bufferPos2;
+
     // This would seriously blow us up otherwise.
-    Expects(bufferPos1 < bufferPos2 && bufferPos2 <= _api.bufferLine.size());
+    Expects(bufferPos1 < bufferPos2 && bufferPos2 <= job.text.size());
 
-    const auto chars = fontFace ? &_api.bufferLine[bufferPos1] : &replacement;
+    const auto chars = fontFace ? &job.text[bufferPos1] : &replacement;
     const auto charCount = fontFace ? bufferPos2 - bufferPos1 : 1;
 
-    // _flushBufferLine() ensures that bufferLineColumn.size() > bufferLine.size().
-    const auto x1 = _api.bufferLineColumn[bufferPos1];
-    const auto x2 = _api.bufferLineColumn[bufferPos2];
+    // _flushBufferLine() ensures that columns.size() > text.size().
+    const auto x1 = job.columns[bufferPos1];
+    const auto x2 = job.columns[bufferPos2];
 
-    Expects(x1 < x2 && x2 <= _api.cellCount.x);
+    Expects(x1 < x2 && x2 <= _r.cellCount.x);
 
     const u16 cellCount = x2 - x1;
 
-    auto attributes = _api.attributes;
+    auto attributes = job.attributes;
     attributes.cellCount = cellCount;
 
     const auto [it, inserted] = _r.glyphs.emplace(std::piecewise_construct, std::forward_as_tuple(attributes, gsl::narrow<u16>(charCount), chars), std::forward_as_tuple());
@@ -1482,10 +2070,12 @@ void AtlasEngine::_emplaceGlyph(IDWriteFontFace* fontFace, size_t bufferPos1, si
         }
 
         const auto coords = value.initialize(flags, cellCount);
-        for (u16 i = 0; i < cellCount; ++i)
-        {
-            coords[i] = _allocateAtlasTile();
-        }
+        _allocateAtlasTiles(coords, cellCount);
+
+        auto& page = _r.atlasPages[_getAtlasPageIndex(coords[0])];
+        page.glyphs.emplace_back(&key);
+        page.tiles += cellCount;
+        _r.atlasStatistics.allocatedTiles += cellCount;
 
         _r.glyphQueue.push_back(AtlasQueueItem{ &key, &value });
         _r.maxEncounteredCellCount = std::max(_r.maxEncounteredCellCount, cellCount);
@@ -1493,7 +2083,11 @@ void AtlasEngine::_emplaceGlyph(IDWriteFontFace* fontFace, size_t bufferPos1, si
 
     const auto valueData = value.data();
     const auto coords = &valueData->coords[0];
-    const auto data = _getCell(x1, _api.lastPaintBufferLineCoord.y);
+
+    // Pages used during the current frame must not be evicted, see _nextAtlasPage().
+    _r.atlasPages[_getAtlasPageIndex(coords[0])].lastUsedFrame = _r.frame;
+    const auto data = _getCell(x1, job.y);
+    const auto metadata = job.metadata.data() + (x1 - job.columns.front());
 
     for (u32 i = 0; i < cellCount; ++i)
     {
@@ -1501,7 +2095,45 @@ void AtlasEngine::_emplaceGlyph(IDWriteFontFace* fontFace, size_t bufferPos1, si
         // We should apply the column color and flags from each column (instead
         // of copying them from the x1) so that ligatures can appear in multiple
         // colors with different line styles.
-        data[i].flags = valueData->flags | _api.bufferLineMetadata[static_cast<size_t>(x1) + i].flags;
-        data[i].color = _api.bufferLineMetadata[static_cast<size_t>(x1) + i].colors;
+        data[i].flags = valueData->flags | metadata[i].flags;
+        data[i].color = metadata[i].colors;
+    }
+}
+
+// Points the cells of an image slice at the atlas tiles holding their pixels. Like glyphs,
+// the tiles are cached for as long as their atlas page isn't evicted, which means that an
+// image is only uploaded to the GPU once, no matter how often it's scrolled around.
+void AtlasEngine::_emplaceImageSlice(const ImageJob& job)
+{
+    const auto& slice = *job.slice;
+    const auto x1 = std::max(slice.ColumnBegin() - job.viewportLeft, 0);
+    const auto x2 = std::min(slice.ColumnEnd() - job.viewportLeft, static_cast<til::CoordType>(_r.cellCount.x));
+
+    for (auto x = x1; x < x2; ++x)
+    {
+        const auto column = x + job.viewportLeft;
+        const auto key = slice.GetId() << 16 | gsl::narrow_cast<u16>(column - slice.ColumnBegin());
+        const auto [it, inserted] = _r.imageTiles.emplace(key, u16x2{});
+        auto& tile = it->second;
+
+        if (inserted)
+        {
+            _allocateAtlasTiles(&tile, 1);
+
+            auto& page = _r.atlasPages[_getAtlasPageIndex(tile)];
+            page.images.emplace_back(key);
+            page.tiles++;
+            _r.atlasStatistics.allocatedTiles++;
+
+            _r.imageQueue.emplace_back(ImageQueueItem{ job.slice, column, tile });
+        }
+
+        // Pages used during the current frame must not be evicted, see _nextAtlasPage().
+        _r.atlasPages[_getAtlasPageIndex(tile)].lastUsedFrame = _r.frame;
+
+        // The cell keeps its colors, so that the background shows through transparent pixels.
+        const auto cell = _getCell(gsl::narrow_cast<u16>(x), job.y);
+        cell->tileIndex = tile;
+        cell->flags = CellFlags::ColoredGlyph;
     }
 }
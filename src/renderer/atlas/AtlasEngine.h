@@ -42,6 +42,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT PaintBackground() noexcept override;
         [[nodiscard]] HRESULT PaintBufferLine(gsl::span<const Cluster> clusters, til::point coord, bool fTrimLeft, bool lineWrapped) noexcept override;
         [[nodiscard]] HRESULT PaintBufferGridLines(GridLineSet lines, COLORREF color, size_t cchLine, til::point coordTarget) noexcept override;
+        [[nodiscard]] HRESULT PaintImageSlice(const ImageSlice::Pointer& imageSlice, til::CoordType targetRow, til::CoordType viewportLeft) noexcept override;
         [[nodiscard]] HRESULT PaintSelection(const til::rect& rect) noexcept override;
         [[nodiscard]] HRESULT PaintCursor(const CursorOptions& options) noexcept override;
         [[nodiscard]] HRESULT UpdateDrawingBrushes(const TextAttribute& textAttributes, const RenderSettings& renderSettings, gsl::not_null<IRenderData*> pData, bool usingSoftFont, bool isSettingDefaultBrushes) noexcept override;
@@ -59,10 +60,12 @@ namespace Microsoft::Console::Render
         HRESULT Enable() noexcept override;
         [[nodiscard]] bool GetRetroTerminalEffect() const noexcept override;
         [[nodiscard]] float GetScaling() const noexcept override;
+        void GetStatistics(EngineStatistics& statistics) const noexcept override;
         [[nodiscard]] HANDLE GetSwapChainHandle() override;
         [[nodiscard]] Types::Viewport GetViewportInCharacters(const Types::Viewport& viewInPixels) const noexcept override;
         [[nodiscard]] Types::Viewport GetViewportInPixels(const Types::Viewport& viewInCharacters) const noexcept override;
         // DxRenderer - setter
+        void ReleaseResources() noexcept override;
         void SetAntialiasingMode(D2D1_TEXT_ANTIALIAS_MODE antialiasingMode) noexcept override;
         void SetCallback(std::function<void()> pfn) noexcept override;
         void EnableTransparentBackground(const bool isTransparent) noexcept override;
@@ -71,6 +74,7 @@ namespace Microsoft::Console::Render
         void SetPixelShaderPath(std::wstring_view value) noexcept override;
         void SetRetroTerminalEffect(bool enable) noexcept override;
         void SetSelectionBackground(COLORREF color, float alpha = 0.5f) noexcept override;
+        void SetSmoothScrolling(bool enable) noexcept override;
         void SetSoftwareRendering(bool enable) noexcept override;
         void SetWarningCallback(std::function<void(HRESULT)> pfn) noexcept override;
         [[nodiscard]] HRESULT SetWindowSize(til::size pixels) noexcept override;
@@ -154,6 +158,8 @@ namespace Microsoft::Console::Render
 
         using i32 = int32_t;
 
+        using u64 = uint64_t;
+
         using f32 = float;
         using f32x2 = vec2<f32>;
         using f32x4 = vec4<f32>;
@@ -428,7 +434,10 @@ namespace Microsoft::Console::Render
             u16 inlined : 1;
             u16 bold : 1;
             u16 italic : 1;
-            u16 cellCount : 13;
+            // The LineRendition of the row the glyph is on. Glyphs of double width and double
+            // height rows are rasterized scaled up, which means they need tiles of their own.
+            u16 lineRendition : 2;
+            u16 cellCount : 11;
 
             ATLAS_POD_OPS(AtlasKeyAttributes)
         };
@@ -460,8 +469,7 @@ namespace Microsoft::Console::Render
             size_t hash() const noexcept
             {
                 const auto d = data();
-#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
-                return std::_Fnv1a_append_bytes(std::_FNV_offset_basis, reinterpret_cast<const u8*>(d), dataSize(d->charCount));
+                return til::hash_bytes(d, dataSize(d->charCount));
             }
 
             bool operator==(const AtlasKey& rhs) const noexcept
@@ -531,6 +539,37 @@ namespace Microsoft::Console::Render
             const AtlasValue* value;
         };
 
+        // A cell of an image slice that needs to be uploaded into its atlas tile, see _drawImageTile().
+        struct ImageQueueItem
+        {
+            ImageSlice::Pointer slice;
+            til::CoordType column = 0;
+            u16x2 tile;
+        };
+
+        // The atlas texture is split into pages, each of which is a band of
+        // atlasPageRows rows of tiles. Glyphs never straddle two pages, so that
+        // once the atlas is full the least recently used page can be evicted
+        // as a whole, instead of overwriting arbitrary tiles.
+        struct AtlasPage
+        {
+            std::vector<const AtlasKey*> glyphs; // the _r.glyphs entries with tiles on this page
+            std::vector<u64> images; // the _r.imageTiles entries with tiles on this page
+            u64 lastUsedFrame = 0;
+            u32 tiles = 0;
+        };
+
+        // Occupancy counters for sizing atlasSizeInPixelLimit,
+        // printed on every eviction if debugAtlasOccupancy is set.
+        struct AtlasStatistics
+        {
+            u32 allocatedTiles = 0; // tiles currently in use by glyphs, summed over all pages
+            u32 tileCapacity = 0; // the tiles the atlas can hold at its limit size
+            u32 evictedPages = 0;
+            u32 evictedGlyphs = 0;
+            u32 overflows = 0; // frames that needed more tiles than the atlas can hold
+        };
+
         struct CachedCursorOptions
         {
             u32 cursorColor = INVALID_COLOR;
@@ -546,6 +585,89 @@ namespace Microsoft::Console::Render
             CellFlags flags = CellFlags::None;
         };
 
+        // A glyph as determined by _shapeBufferLine(): The characters from
+        // bufferPos1 to bufferPos2 in ShapingJob::text drawn with fontFace.
+        // A null fontFace means that a replacement character is drawn instead.
+        struct ShapedGlyph
+        {
+            wil::com_ptr<IDWriteFontFace> fontFace;
+            u32 bufferPos1 = 0;
+            u32 bufferPos2 = 0;
+        };
+
+        using ShapedGlyphs = std::vector<ShapedGlyph>;
+
+        // The finished cells of a buffer line segment, see Resources::cachedLines.
+        struct CachedLine
+        {
+            std::wstring key; // ShapingJob::lineKey
+            std::vector<Cell> cells;
+            u64 atlasPages = 0; // a bitmask of the pages the cells' tiles are on
+        };
+
+        // A segment of a buffer line with uniform font attributes.
+        // These are queued up by _flushBufferLine() and processed by _shapeBufferLines().
+        struct ShapingJob
+        {
+            AtlasKeyAttributes attributes{};
+            u16 y = 0;
+            std::vector<wchar_t> text;
+            std::vector<u16> columns; // text.size() + 1 items, just like ApiState::bufferLineColumn
+            std::vector<BufferLineMetadata> metadata; // covers the cells from columns.front() to columns.back()
+            std::wstring cacheKey; // the attributes, text and columns, see Resources::shapedLines
+            std::wstring lineKey; // the cacheKey followed by the metadata, see Resources::cachedLines
+            const CachedLine* cachedLine = nullptr;
+            std::shared_ptr<const ShapedGlyphs> glyphs;
+            HRESULT hr = S_OK;
+        };
+
+        // An image slice painted over a row by PaintImageSlice(), queued up for Present().
+        // The slice is immutable, which is why it can be read without the console lock.
+        struct ImageJob
+        {
+            ImageSlice::Pointer slice;
+            u16 y = 0;
+            til::CoordType viewportLeft = 0;
+        };
+
+        // A _setCellFlags() call queued up by PaintSelection() and PaintCursor() for Present().
+        struct CellFlagUpdate
+        {
+            u16r coords;
+            CellFlags mask = CellFlags::None;
+            CellFlags bits = CellFlags::None;
+        };
+
+        // The scratch buffers for DirectWrite's text analysis. Every thread running
+        // _shapeBufferLine() concurrently needs to have its own instance.
+        struct ShapingScratch
+        {
+            explicit ShapingScratch(size_t cellCountX)
+            {
+                // Let's guess that every cell consists of a surrogate pair.
+                const auto projectedTextSize = cellCountX * 2;
+                // IDWriteTextAnalyzer::GetGlyphs says:
+                //   The recommended estimate for the per-glyph output buffers is (3 * textLength / 2 + 16).
+                // We already set the textLength to twice the cell count.
+                const auto projectedGlyphSize = 3 * projectedTextSize + 16;
+
+                clusterMap = Buffer<u16>{ projectedTextSize };
+                textProps = Buffer<DWRITE_SHAPING_TEXT_PROPERTIES>{ projectedTextSize };
+                glyphIndices = Buffer<u16>{ projectedGlyphSize };
+                glyphProps = Buffer<DWRITE_SHAPING_GLYPH_PROPERTIES>{ projectedGlyphSize };
+                glyphAdvances = Buffer<f32>{ projectedGlyphSize };
+                glyphOffsets = Buffer<DWRITE_GLYPH_OFFSET>{ projectedGlyphSize };
+            }
+
+            std::vector<TextAnalyzerResult> analysisResults;
+            Buffer<u16> clusterMap;
+            Buffer<DWRITE_SHAPING_TEXT_PROPERTIES> textProps;
+            Buffer<u16> glyphIndices;
+            Buffer<DWRITE_SHAPING_GLYPH_PROPERTIES> glyphProps;
+            Buffer<f32> glyphAdvances;
+            Buffer<DWRITE_GLYPH_OFFSET> glyphOffsets;
+        };
+
         // NOTE: D3D constant buffers sizes must be a multiple of 16 bytes.
         struct alignas(16) ConstBuffer
         {
@@ -568,6 +690,9 @@ namespace Microsoft::Console::Render
             alignas(sizeof(u32)) u32 cursorColor = 0;
             alignas(sizeof(u32)) u32 selectionColor = 0;
             alignas(sizeof(u32)) u32 useClearType = 0;
+            alignas(sizeof(u32)) u32 cellCountY = 0;
+            alignas(sizeof(u32)) u32 cellRowOffset = 0;
+            alignas(sizeof(i32)) i32 smoothScrollOffset = 0;
 #pragma warning(suppress : 4324) // 'ConstBuffer': structure was padded due to alignment specifier
         };
 
@@ -590,6 +715,7 @@ namespace Microsoft::Console::Render
             None = 0,
             Cursor = 1 << 0,
             ConstBuffer = 1 << 1,
+            CellRowOffset = 1 << 2, // only ConstBuffer::cellRowOffset changed, see StartPaint()
         };
         ATLAS_FLAG_OPS(RenderInvalidations, u8)
 
@@ -612,10 +738,27 @@ namespace Microsoft::Console::Render
         IDWriteTextFormat* _getTextFormat(bool bold, bool italic) const noexcept;
         const Buffer<DWRITE_FONT_AXIS_VALUE>& _getTextFormatAxis(bool bold, bool italic) const noexcept;
         Cell* _getCell(u16 x, u16 y) noexcept;
+        u16 _getCellRow(u16 y) const noexcept;
+        u16 _getCellRowCount() const noexcept;
+        void _advanceSmoothScroll() noexcept;
+        void _markDirtyRect(u16r rect) noexcept;
         void _setCellFlags(u16r coords, CellFlags mask, CellFlags bits) noexcept;
+        void _queueCellFlags(u16r coords, CellFlags mask, CellFlags bits);
         u16x2 _allocateAtlasTile() noexcept;
+        void _allocateAtlasTiles(u16x2* coords, u16 cellCount);
+        u32 _remainingAtlasPageTiles() const noexcept;
+        void _nextAtlasPage();
+        void _evictAtlasPage(size_t index);
+        size_t _getAtlasPageIndex(u16x2 coord) const noexcept;
+        u64 _getAtlasPageMask(const Cell* cells, size_t count) const noexcept;
         void _flushBufferLine();
-        void _emplaceGlyph(IDWriteFontFace* fontFace, size_t bufferPos1, size_t bufferPos2);
+        void _processFrame();
+        void _shapeBufferLines();
+        static void CALLBACK _shapingWorkCallback(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_WORK work) noexcept;
+        void _shapeMissedJobs() noexcept;
+        void _shapeBufferLine(const ShapingJob& job, ShapingScratch& scratch, ShapedGlyphs& glyphs) const;
+        void _emplaceGlyph(const ShapingJob& job, const ShapedGlyph& glyph);
+        void _emplaceImageSlice(const ImageJob& job);
 
         // AtlasEngine.api.cpp
         void _resolveAntialiasingMode() noexcept;
@@ -624,17 +767,38 @@ namespace Microsoft::Console::Render
 
         // AtlasEngine.r.cpp
         void _setShaderResources() const;
+        void _uploadCellRows(u16 row, u16 count) const noexcept;
+        void _present(bool full);
         void _updateConstantBuffer() const noexcept;
         void _adjustAtlasSize();
         void _reserveScratchpadSize(u16 minWidth);
         void _processGlyphQueue();
         void _drawGlyph(const AtlasQueueItem& item) const;
+        void _drawImageTile(const ImageQueueItem& item);
+        void _drawBlockElement(wchar_t ch) const;
         void _drawCursor();
         void _copyScratchpadTile(uint32_t scratchpadIndex, u16x2 target, uint32_t copyFlags = 0) const noexcept;
 
         static constexpr bool debugGlyphGenerationPerformance = false;
         static constexpr bool debugGeneralPerformance = false || debugGlyphGenerationPerformance;
         static constexpr bool continuousRedraw = false || debugGeneralPerformance;
+        static constexpr bool debugAtlasOccupancy = false;
+
+        // The atlas is split into (at most) this many pages. Must not exceed 64, see CachedLine::atlasPages.
+        static constexpr size_t atlasPageCountTarget = 16;
+
+        // Shaping only a few segments isn't worth the overhead of waking up worker threads.
+        static constexpr size_t shapingJobsPerWorker = 8;
+        static constexpr size_t shapingMaxWorkers = 7;
+        // Resources::shapedLines is cleared once it grows beyond this many entries.
+        static constexpr size_t shapedLinesLimit = 4096;
+        // The number of segments kept in Resources::cachedLines. That's a couple
+        // of screens full of text, enough to scroll back and forth through them.
+        static constexpr size_t cachedLinesLimit = 1024;
+        // Beyond this many dirty rects per frame we present the whole frame instead.
+        static constexpr size_t dirtyRectsLimit = 64;
+        // The time after which the remaining offset of a smooth scroll has halved.
+        static constexpr f32 smoothScrollHalfLifeMs = 20.0f;
 
         static constexpr u16 u16min = 0x0000;
         static constexpr u16 u16max = 0xffff;
@@ -669,6 +833,7 @@ namespace Microsoft::Console::Render
             wil::com_ptr<ID3D11RenderTargetView> renderTargetView;
             wil::com_ptr<ID3D11VertexShader> vertexShader;
             wil::com_ptr<ID3D11PixelShader> pixelShader;
+            wil::com_ptr<ID3D11RasterizerState> rasterizerState;
             wil::com_ptr<ID3D11Buffer> constantBuffer;
             wil::com_ptr<ID3D11Buffer> cellBuffer;
             wil::com_ptr<ID3D11ShaderResourceView> cellView;
@@ -687,6 +852,19 @@ namespace Microsoft::Console::Render
             f32x2 cellSizeDIP; // invalidated by ApiInvalidations::Font, caches _api.cellSize but in DIP
             u16x2 cellSize; // invalidated by ApiInvalidations::Font, caches _api.cellSize
             u16x2 cellCount; // invalidated by ApiInvalidations::Font|Size, caches _api.cellCount
+            std::wstring fontName; // invalidated by ApiInvalidations::Font, caches _api.fontMetrics.fontName
+            std::vector<DWRITE_FONT_FEATURE> fontFeatures; // invalidated by ApiInvalidations::Font, caches _api.fontFeatures
+            f32 fontSizeInDIP = 0; // invalidated by ApiInvalidations::Font, caches _api.fontMetrics.fontSizeInDIP
+            u16 fontWeight = 0; // invalidated by ApiInvalidations::Font, caches _api.fontMetrics.fontWeight
+            u16 cellRowOffset = 0; // the row of the _r.cells ring that holds the first row of the viewport
+            u16 cellRowCount = 0; // the rows in the _r.cells ring: cellCount.y plus the spare rows for smooth scrolling, see StartPaint()
+            f32 smoothScrollPixels = 0; // the remaining offset in pixels the viewport's rows are drawn shifted by, see _advanceSmoothScroll()
+            std::chrono::steady_clock::time_point smoothScrollTime; // when _advanceSmoothScroll() last ran
+            u16x2 dirtyRows = invalidatedRowsNone; // viewport rows that Present() needs to upload to the cellBuffer
+            std::vector<u16r> dirtyRects; // the cells that changed during this frame, passed to Present1() as dirty rects
+            i16 presentScrollOffset = 0; // the number of rows the viewport scrolled since the last Present()
+            bool presentFull = true; // set if the next Present() can't be a partial one, for instance after a resize
+            D3D11_RECT previousDrawRect{}; // the pixels that changed during the previous frame, see Present()
             u16 underlinePos = 0;
             u16 strikethroughPos = 0;
             u16 lineThickness = 0;
@@ -696,8 +874,26 @@ namespace Microsoft::Console::Render
             u16x2 atlasSizeInPixelLimit; // invalidated by ApiInvalidations::Font
             u16x2 atlasSizeInPixel; // invalidated by ApiInvalidations::Font
             u16x2 atlasPosition;
+            u16 atlasPageRows = 1; // invalidated by ApiInvalidations::Font
+            bool atlasFull = false; // set once all pages were filled and new tiles come from evicted pages
+            bool atlasPageEvicted = false; // cells outside of the current frame might refer to evicted tiles
+            u64 frame = 1; // incremented in EndPaint(), used for AtlasPage::lastUsedFrame
+            std::vector<AtlasPage> atlasPages; // invalidated by ApiInvalidations::Font
+            AtlasStatistics atlasStatistics;
             std::unordered_map<AtlasKey, AtlasValue, AtlasKeyHasher> glyphs;
             std::vector<AtlasQueueItem> glyphQueue;
+            // The atlas tiles of the cells of image slices, keyed by the slice's ID in the upper
+            // 48 bits and the cell's column relative to the slice's first one in the lower 16 bits.
+            std::unordered_map<u64, u16x2> imageTiles;
+            std::vector<ImageQueueItem> imageQueue;
+            std::vector<u32> imageScratchpad; // the pixels of a tile while it's scaled to the cell size
+            // The glyphs of recently shaped buffer line segments, keyed by ShapingJob::cacheKey.
+            til::flat_hash_map<std::wstring, std::shared_ptr<const ShapedGlyphs>> shapedLines;
+            // A LRU cache of the finished cells of recently drawn segments, most recently used first.
+            // The map is keyed by views of CachedLine::key. Both are invalidated like glyphs,
+            // because the cells refer to the atlas tiles of the current font.
+            std::list<CachedLine> cachedLines;
+            til::flat_hash_map<std::wstring_view, std::list<CachedLine>::iterator> cachedLineMap;
 
             f32 gamma = 0;
             f32 cleartypeEnhancedContrast = 0;
@@ -724,13 +920,22 @@ namespace Microsoft::Console::Render
             std::vector<wchar_t> bufferLine;
             std::vector<u16> bufferLineColumn;
             Buffer<BufferLineMetadata> bufferLineMetadata;
-            std::vector<TextAnalyzerResult> analysisResults;
-            Buffer<u16> clusterMap;
-            Buffer<DWRITE_SHAPING_TEXT_PROPERTIES> textProps;
-            Buffer<u16> glyphIndices;
-            Buffer<DWRITE_SHAPING_GLYPH_PROPERTIES> glyphProps;
-            Buffer<f32> glyphAdvances;
-            Buffer<DWRITE_GLYPH_OFFSET> glyphOffsets;
+            // _flushBufferLine() and _queueCellFlags()
+            std::vector<ShapingJob> shapingJobs; // only the first shapingJobCount are in use, the others are kept for their capacity
+            size_t shapingJobCount = 0;
+            std::vector<CellFlagUpdate> cellFlagUpdates;
+            std::vector<ImageJob> imageJobs;
+            // The frame handed over by EndPaint(). These members are only accessed by Present()
+            // through _processFrame() and may thus be used without holding the console lock.
+            std::vector<ShapingJob> frameJobs; // swapped with shapingJobs, see above
+            size_t frameJobCount = 0;
+            std::vector<CellFlagUpdate> frameCellFlagUpdates;
+            std::vector<ImageJob> frameImageJobs; // swapped with imageJobs
+            std::vector<size_t> shapingMisses; // indices into frameJobs that weren't found in _r.shapedLines
+            std::atomic<size_t> shapingNextMiss{ 0 };
+            std::atomic<size_t> shapingNextScratch{ 0 };
+            std::vector<ShapingScratch> shapingScratch; // one per worker plus one for the render thread
+            wil::unique_threadpool_work shapingWork;
             std::vector<DWRITE_FONT_FEATURE> fontFeatures; // changes are flagged as ApiInvalidations::Font|Size
             std::vector<DWRITE_FONT_AXIS_VALUE> fontAxisValues; // changes are flagged as ApiInvalidations::Font|Size
             FontMetrics fontMetrics; // changes are flagged as ApiInvalidations::Font|Size
@@ -749,6 +954,8 @@ namespace Microsoft::Console::Render
             // UpdateHyperlinkHoveredId()
             u16 hyperlinkHoveredId = 0;
             bool bufferLineWasHyperlinked = false;
+            // SetSmoothScrolling()
+            bool smoothScrolling = false; // changes are flagged as ApiInvalidations::Size
 
             // dirtyRect is a computed value based on invalidatedRows.
             til::rect dirtyRect;
@@ -768,6 +975,18 @@ namespace Microsoft::Console::Render
             ApiInvalidations invalidations = ApiInvalidations::Device;
         } _api;
 
+        // Copies of the counters in _r for GetStatistics(), which may be called on any thread.
+        // They're updated by _processFrame() and _shapeBufferLines().
+        struct PublishedStatistics
+        {
+            std::atomic<u64> shapedLines{ 0 };
+            std::atomic<u32> glyphs{ 0 };
+            std::atomic<u32> allocatedTiles{ 0 };
+            std::atomic<u32> tileCapacity{ 0 };
+            std::atomic<u64> gpuBytes{ 0 };
+            std::atomic<u64> cacheBytes{ 0 };
+        } _statistics;
+
 #undef ATLAS_POD_OPS
 #undef ATLAS_FLAG_OPS
     };
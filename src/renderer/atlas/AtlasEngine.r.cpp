@@ -30,10 +30,22 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT AtlasEngine::Present() noexcept
 try
 {
+    _processFrame();
     _adjustAtlasSize();
     _reserveScratchpadSize(_r.maxEncounteredCellCount);
     _processGlyphQueue();
 
+    // Every frame of a smooth scroll moves all pixels.
+    if (_r.smoothScrollPixels != 0)
+    {
+        _advanceSmoothScroll();
+        WI_SetFlag(_r.invalidations, RenderInvalidations::ConstBuffer);
+    }
+
+    // A new cursor texture or any change to the constant buffer, like a new background
+    // color, potentially affects every pixel and we can't use a partial presentation.
+    const auto presentFull = _r.presentFull || WI_IsAnyFlagSet(_r.invalidations, RenderInvalidations::Cursor | RenderInvalidations::ConstBuffer);
+
     if (WI_IsFlagSet(_r.invalidations, RenderInvalidations::Cursor))
     {
         _drawCursor();
@@ -41,24 +53,79 @@ try
     }
 
     // The values the constant buffer depends on are potentially updated after BeginPaint().
-    if (WI_IsFlagSet(_r.invalidations, RenderInvalidations::ConstBuffer))
+    if (WI_IsAnyFlagSet(_r.invalidations, RenderInvalidations::ConstBuffer | RenderInvalidations::CellRowOffset))
     {
         _updateConstantBuffer();
-        WI_ClearFlag(_r.invalidations, RenderInvalidations::ConstBuffer);
+        WI_ClearAllFlags(_r.invalidations, RenderInvalidations::ConstBuffer | RenderInvalidations::CellRowOffset);
     }
 
+    // Only upload the rows that changed since the last frame. The dirty rows are contiguous in
+    // the viewport, but since _r.cells is a ring of rows, they might wrap around its end.
+    if (_r.dirtyRows.x < _r.dirtyRows.y)
     {
-#pragma warning(suppress : 26494) // Variable 'mapped' is uninitialized. Always initialize an object (type.5).
-        D3D11_MAPPED_SUBRESOURCE mapped;
-        THROW_IF_FAILED(_r.deviceContext->Map(_r.cellBuffer.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
-        assert(mapped.RowPitch >= _r.cells.size() * sizeof(Cell));
-        memcpy(mapped.pData, _r.cells.data(), _r.cells.size() * sizeof(Cell));
-        _r.deviceContext->Unmap(_r.cellBuffer.get(), 0);
+        const auto top = _r.dirtyRows.x;
+        const auto bottom = std::min(_r.dirtyRows.y, _r.cellCount.y);
+
+        if (top < bottom)
+        {
+            const auto first = _getCellRow(top);
+            const auto count = bottom - top;
+            const auto countUntilEnd = std::min<u16>(count, _r.cellRowCount - first);
+
+            _uploadCellRows(first, countUntilEnd);
+            if (countUntilEnd < count)
+            {
+                _uploadCellRows(0, gsl::narrow_cast<u16>(count - countUntilEnd));
+            }
+        }
+
+        _r.dirtyRows = invalidatedRowsNone;
     }
 
     // After Present calls, the back buffer needs to explicitly be
     // re-bound to the D3D11 immediate context before it can be used again.
     _r.deviceContext->OMSetRenderTargets(1, _r.renderTargetView.addressof(), nullptr);
+
+    // With DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL and 2 buffers our back buffer still contains the
+    // frame before the previous one. Only the pixels that changed since then need to be drawn,
+    // which are the ones that changed during the previous frame and during this one.
+    // Scrolling moves all pixels and implies a full redraw, just like a full Present().
+    {
+        // Scissor rects are clipped to the viewport, which covers the entire back buffer.
+        auto dirtyRect = D3D11_RECT{ 0, 0, D3D11_VIEWPORT_BOUNDS_MAX, D3D11_VIEWPORT_BOUNDS_MAX };
+
+        if (!presentFull && !_r.dirtyRects.empty() && !_r.presentScrollOffset)
+        {
+            const auto csx = static_cast<LONG>(_r.cellSize.x);
+            const auto csy = static_cast<LONG>(_r.cellSize.y);
+            dirtyRect = { LONG_MAX, LONG_MAX, 0, 0 };
+            for (const auto& rect : _r.dirtyRects)
+            {
+                dirtyRect.left = std::min<LONG>(dirtyRect.left, rect.left * csx);
+                dirtyRect.top = std::min<LONG>(dirtyRect.top, rect.top * csy);
+                dirtyRect.right = std::max<LONG>(dirtyRect.right, rect.right * csx);
+                dirtyRect.bottom = std::max<LONG>(dirtyRect.bottom, rect.bottom * csy);
+            }
+        }
+
+        // An empty previousDrawRect means that nothing changed during the previous frame.
+        // (After a resize or device change it's stale, but then presentFull is set.)
+        const auto& prev = _r.previousDrawRect;
+        D3D11_RECT scissorRect{
+            std::min(dirtyRect.left, prev.left),
+            std::min(dirtyRect.top, prev.top),
+            std::max(dirtyRect.right, prev.right),
+            std::max(dirtyRect.bottom, prev.bottom),
+        };
+        if (prev.left >= prev.right || prev.top >= prev.bottom)
+        {
+            scissorRect = dirtyRect;
+        }
+
+        _r.deviceContext->RSSetScissorRects(1, &scissorRect);
+        _r.previousDrawRect = dirtyRect;
+    }
+
     _r.deviceContext->Draw(3, 0);
 
     // See documentation for IDXGISwapChain2::GetFrameLatencyWaitableObject method:
@@ -66,21 +133,10 @@ try
     // > Note that this requirement includes the first frame the app renders with the swap chain.
     assert(_r.frameLatencyWaitableObjectUsed);
 
-    // > IDXGISwapChain::Present: Partial Presentation (using a dirty rects or scroll) is not supported
-    // > for SwapChains created with DXGI_SWAP_EFFECT_DISCARD or DXGI_SWAP_EFFECT_FLIP_DISCARD.
-    // ---> No need to call IDXGISwapChain1::Present1.
-    //      TODO: Would IDXGISwapChain1::Present1 and its dirty rects have benefits for remote desktop?
-    THROW_IF_FAILED(_r.swapChain->Present(1, 0));
+    _present(presentFull);
 
-    // On some GPUs with tile based deferred rendering (TBDR) architectures, binding
-    // RenderTargets that already have contents in them (from previous rendering) incurs a
-    // cost for having to copy the RenderTarget contents back into tile memory for rendering.
-    //
-    // On Windows 10 with DXGI_SWAP_EFFECT_FLIP_DISCARD we get this for free.
-    if (!_sr.isWindows10OrGreater)
-    {
-        _r.deviceContext->DiscardView(_r.renderTargetView.get());
-    }
+    // NOTE: The back buffer must not be discarded with DiscardView() here,
+    // as the next frame only redraws the parts of it that changed.
 
     return S_OK;
 }
@@ -96,6 +152,7 @@ void AtlasEngine::_setShaderResources() const
 {
     _r.deviceContext->VSSetShader(_r.vertexShader.get(), nullptr, 0);
     _r.deviceContext->PSSetShader(_r.pixelShader.get(), nullptr, 0);
+    _r.deviceContext->RSSetState(_r.rasterizerState.get());
 
     // Our vertex shader uses a trick from Bill Bilodeau published in
     // "Vertex Shader Tricks" at GDC14 to draw a fullscreen triangle
@@ -111,6 +168,70 @@ void AtlasEngine::_setShaderResources() const
     _r.deviceContext->PSSetShaderResources(0, gsl::narrow_cast<UINT>(resources.size()), resources.data());
 }
 
+// Presents the frame. Unless the whole frame changed, DXGI (and in turn DWM and remote desktop) is told
+// which parts of it actually changed, so that for instance a blinking cursor doesn't recomposite the
+// whole window. Scrolling is passed as a scroll rect, as the shader shifted the existing rows.
+void AtlasEngine::_present(bool full)
+{
+    const auto cleanup = wil::scope_exit([this]() noexcept {
+        _r.dirtyRects.clear();
+        _r.presentScrollOffset = 0;
+        _r.presentFull = false;
+    });
+
+    if (full || (_r.dirtyRects.empty() && !_r.presentScrollOffset))
+    {
+        THROW_IF_FAILED(_r.swapChain->Present(1, 0));
+        return;
+    }
+
+    const auto csx = static_cast<LONG>(_r.cellSize.x);
+    const auto csy = static_cast<LONG>(_r.cellSize.y);
+    std::array<RECT, dirtyRectsLimit> dirtyRects;
+    const auto dirtyRectsCount = _r.dirtyRects.size();
+
+    for (size_t i = 0; i < dirtyRectsCount; ++i)
+    {
+        const auto& rect = til::at(_r.dirtyRects, i);
+        til::at(dirtyRects, i) = RECT{ rect.left * csx, rect.top * csy, rect.right * csx, rect.bottom * csy };
+    }
+
+    DXGI_PRESENT_PARAMETERS params{};
+    params.DirtyRectsCount = gsl::narrow_cast<UINT>(dirtyRectsCount);
+    params.pDirtyRects = dirtyRects.data();
+
+    // The scroll rect is the area of the cells after the scroll. Its contents are taken from
+    // the same area shifted up by the offset. The newly uncovered rows are in dirtyRects.
+    // The scroll rect will be empty if we scrolled >= 1 full screen size, which Present1 doesn't like.
+    const auto offset = _r.presentScrollOffset * csy;
+    RECT scrollRect{ 0, std::max<LONG>(0, offset), _r.cellCount.x * csx, _r.cellCount.y * csy + std::min<LONG>(0, offset) };
+    POINT scrollOffset{ 0, offset };
+    if (offset && scrollRect.top < scrollRect.bottom)
+    {
+        params.pScrollRect = &scrollRect;
+        params.pScrollOffset = &scrollOffset;
+    }
+
+    THROW_IF_FAILED(_r.swapChain->Present1(1, 0, &params));
+}
+
+// Uploads the rows [row, row + count) of the _r.cells ring to the same rows of the cellBuffer.
+void AtlasEngine::_uploadCellRows(u16 row, u16 count) const noexcept
+{
+    const auto rowSize = static_cast<u32>(_r.cellCount.x) * sizeof(Cell);
+    const auto src = _r.cells.data() + static_cast<size_t>(_r.cellCount.x) * row;
+
+    D3D11_BOX box;
+    box.left = row * rowSize;
+    box.top = 0;
+    box.front = 0;
+    box.right = (row + count) * rowSize;
+    box.bottom = 1;
+    box.back = 1;
+#pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function '...' which may throw exceptions (f.6).
+    _r.deviceContext->UpdateSubresource(_r.cellBuffer.get(), 0, &box, src, 0, 0);
+}
+
 void AtlasEngine::_updateConstantBuffer() const noexcept
 {
     const auto useClearType = _api.realizedAntialiasingMode == D2D1_TEXT_ANTIALIAS_MODE_CLEARTYPE;
@@ -133,13 +254,17 @@ void AtlasEngine::_updateConstantBuffer() const noexcept
     data.cursorColor = _r.cursorOptions.cursorColor;
     data.selectionColor = _r.selectionColor;
     data.useClearType = useClearType;
+    data.cellCountY = _r.cellRowCount;
+    data.cellRowOffset = _r.cellRowOffset;
+    data.smoothScrollOffset = std::lroundf(_r.smoothScrollPixels);
 #pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function '...' which may throw exceptions (f.6).
     _r.deviceContext->UpdateSubresource(_r.constantBuffer.get(), 0, nullptr, &data, 0, 0);
 }
 
 void AtlasEngine::_adjustAtlasSize()
 {
-    if (_r.atlasPosition.y < _r.atlasSizeInPixel.y && _r.atlasPosition.x < _r.atlasSizeInPixel.x)
+    // Once the atlas is full, _r.atlasPosition can sit right past its end (see _nextAtlasPage()).
+    if (_r.atlasSizeInPixel == _r.atlasSizeInPixelLimit || (_r.atlasPosition.y < _r.atlasSizeInPixel.y && _r.atlasPosition.x < _r.atlasSizeInPixel.x))
     {
         return;
     }
@@ -301,8 +426,13 @@ void AtlasEngine::_processGlyphQueue()
     {
         _drawGlyph(pair);
     }
+    for (const auto& item : _r.imageQueue)
+    {
+        _drawImageTile(item);
+    }
 
     _r.glyphQueue.clear();
+    _r.imageQueue.clear();
 }
 
 void AtlasEngine::_drawGlyph(const AtlasQueueItem& item) const
@@ -312,12 +442,32 @@ void AtlasEngine::_drawGlyph(const AtlasQueueItem& item) const
     const auto coords = &value->coords[0];
     const auto charsLength = key->charCount;
     const auto cells = static_cast<u32>(key->attributes.cellCount);
+    const auto lineRendition = static_cast<LineRendition>(key->attributes.lineRendition);
     const auto textFormat = _getTextFormat(key->attributes.bold, key->attributes.italic);
     const auto coloredGlyph = WI_IsFlagSet(value->flags, CellFlags::ColoredGlyph);
 
+    // Block elements are drawn procedurally. See _drawBlockElement.
+    if (charsLength == 1 && cells == 1 && lineRendition == LineRendition::SingleWidth && key->chars[0] >= 0x2580 && key->chars[0] <= 0x259F)
+    {
+        _r.d2dRenderTarget->BeginDraw();
+        _r.d2dRenderTarget->Clear();
+        _drawBlockElement(key->chars[0]);
+        THROW_IF_FAILED(_r.d2dRenderTarget->EndDraw());
+        _copyScratchpadTile(0, coords[0], D3D11_COPY_NO_OVERWRITE);
+        return;
+    }
+
     // See D2DFactory::DrawText
+    // The glyphs of double width rows cover 2 cells per column and are laid out
+    // at their regular size, but drawn scaled up. Double height rows scale them up
+    // vertically as well and either the top or the bottom half ends up in the tiles.
+    const auto scaleX = lineRendition == LineRendition::SingleWidth ? 1u : 2u;
+    const auto scaleY = lineRendition == LineRendition::DoubleHeightTop || lineRendition == LineRendition::DoubleHeightBottom ? 2.0f : 1.0f;
+    const auto offsetY = lineRendition == LineRendition::DoubleHeightBottom ? -_r.cellSizeDIP.y : 0.0f;
+    const auto layoutCells = std::max(1u, cells / scaleX);
+
     wil::com_ptr<IDWriteTextLayout> textLayout;
-    THROW_IF_FAILED(_sr.dwriteFactory->CreateTextLayout(&key->chars[0], charsLength, textFormat, cells * _r.cellSizeDIP.x, _r.cellSizeDIP.y, textLayout.addressof()));
+    THROW_IF_FAILED(_sr.dwriteFactory->CreateTextLayout(&key->chars[0], charsLength, textFormat, layoutCells * _r.cellSizeDIP.x, _r.cellSizeDIP.y, textLayout.addressof()));
     if (_r.typography)
     {
         textLayout->SetTypography(_r.typography.get(), { 0, charsLength });
@@ -343,7 +493,15 @@ void AtlasEngine::_drawGlyph(const AtlasQueueItem& item) const
     // now to reduce the surface that needs to be cleared, but this decreases
     // performance by 10% (tested using debugGlyphGenerationPerformance).
     _r.d2dRenderTarget->Clear();
+    if (lineRendition != LineRendition::SingleWidth)
+    {
+        _r.d2dRenderTarget->SetTransform(D2D1::Matrix3x2F{ static_cast<f32>(scaleX), 0, 0, scaleY, 0, offsetY });
+    }
     _r.d2dRenderTarget->DrawTextLayout({}, textLayout.get(), _r.brush.get(), options);
+    if (lineRendition != LineRendition::SingleWidth)
+    {
+        _r.d2dRenderTarget->SetTransform(D2D1::Matrix3x2F::Identity());
+    }
     THROW_IF_FAILED(_r.d2dRenderTarget->EndDraw());
 
     for (uint32_t i = 0; i < cells; ++i)
@@ -358,6 +516,142 @@ void AtlasEngine::_drawGlyph(const AtlasQueueItem& item) const
     }
 }
 
+// Routine Description:
+// - Uploads the pixels of a cell of an image slice into its atlas tile. The slice's cells
+//   have a virtual size, which is scaled to the actual cell size with a nearest neighbor
+//   filter. That keeps the edges of pixel art and plots crisp and is cheap enough that
+//   it doesn't need D2D, unlike glyphs, which is why the pixels are uploaded directly.
+void AtlasEngine::_drawImageTile(const ImageQueueItem& item)
+{
+    const auto& slice = *item.slice;
+    const auto sourceWidth = gsl::narrow_cast<u32>(slice.CellSize().width);
+    const auto sourceHeight = gsl::narrow_cast<u32>(slice.CellSize().height);
+    const auto sourceLeft = gsl::narrow_cast<u32>(item.column - slice.ColumnBegin()) * sourceWidth;
+    const u32 width = _r.cellSize.x;
+    const u32 height = _r.cellSize.y;
+
+    _r.imageScratchpad.resize(static_cast<size_t>(width) * height);
+
+    for (u32 y = 0; y < height; ++y)
+    {
+        // Sample the source pixel at the center of each target pixel.
+        const auto sourceRow = slice.PixelRow(gsl::narrow_cast<til::CoordType>((2 * y + 1) * sourceHeight / (2 * height)));
+        const auto targetRow = _r.imageScratchpad.data() + static_cast<size_t>(y) * width;
+        for (u32 x = 0; x < width; ++x)
+        {
+            targetRow[x] = sourceRow[sourceLeft + (2 * x + 1) * sourceWidth / (2 * width)];
+        }
+    }
+
+    D3D11_BOX box;
+    box.left = item.tile.x;
+    box.top = item.tile.y;
+    box.front = 0;
+    box.right = box.left + width;
+    box.bottom = box.top + height;
+    box.back = 1;
+    // See _drawGlyph() for why we're allowed to pass NO_OVERWRITE.
+    _r.deviceContext->UpdateSubresource1(_r.atlasBuffer.get(), 0, &box, _r.imageScratchpad.data(), width * sizeof(u32), 0, D3D11_COPY_NO_OVERWRITE);
+}
+
+// Routine Description:
+// - Block elements (U+2580-U+259F) are rectangles meant to seamlessly join with the
+//   ones in the neighboring cells. Rasterizing them via DirectWrite scales the font's
+//   design to the cell size and only rarely hits the pixel grid exactly, which results
+//   in gaps or overlaps between cells. This draws them on whole pixels instead.
+// - Must be called in between BeginDraw() and EndDraw().
+// Arguments:
+// - ch - A character in the range U+2580-U+259F.
+void AtlasEngine::_drawBlockElement(const wchar_t ch) const
+{
+    const auto w = static_cast<int>(_r.cellSize.x);
+    const auto h = static_cast<int>(_r.cellSize.y);
+    const auto halfW = (w + 1) / 2;
+    const auto halfH = (h + 1) / 2;
+    // Returns n/8th of the given length in whole pixels, at least 1px for n > 0.
+    const auto eighths = [](int length, int n) {
+        return n ? std::max(1, (length * n + 4) / 8) : 0;
+    };
+    const auto fill = [&](int left, int top, int right, int bottom) {
+        const auto scale = static_cast<float>(USER_DEFAULT_SCREEN_DPI) / static_cast<float>(_r.dpi);
+        const D2D1_RECT_F rect{
+            static_cast<float>(left) * scale,
+            static_cast<float>(top) * scale,
+            static_cast<float>(right) * scale,
+            static_cast<float>(bottom) * scale,
+        };
+        _r.d2dRenderTarget->FillRectangle(&rect, _r.brush.get());
+    };
+
+    switch (ch)
+    {
+    case 0x2580: // UPPER HALF BLOCK
+        fill(0, 0, w, halfH);
+        return;
+    case 0x2581: // LOWER ONE EIGHTH BLOCK
+    case 0x2582:
+    case 0x2583:
+    case 0x2584:
+    case 0x2585:
+    case 0x2586:
+    case 0x2587:
+    case 0x2588: // FULL BLOCK
+        // The lower half block must end exactly where the upper half block starts.
+        fill(0, ch == 0x2584 ? halfH : h - eighths(h, ch - 0x2580), w, h);
+        return;
+    case 0x2589: // LEFT SEVEN EIGHTHS BLOCK
+    case 0x258A:
+    case 0x258B:
+    case 0x258C:
+    case 0x258D:
+    case 0x258E:
+    case 0x258F: // LEFT ONE EIGHTH BLOCK
+        fill(0, 0, ch == 0x258C ? halfW : eighths(w, 0x2590 - ch), h);
+        return;
+    case 0x2590: // RIGHT HALF BLOCK
+        fill(halfW, 0, w, h);
+        return;
+    case 0x2591: // LIGHT SHADE
+    case 0x2592: // MEDIUM SHADE
+    case 0x2593: // DARK SHADE
+        // Drawing the actual dither pattern would result in moire effects
+        // when scrolling, so the shades are drawn as translucent blocks.
+        _r.brush->SetOpacity(static_cast<float>(ch - 0x2590) / 4.0f);
+        fill(0, 0, w, h);
+        _r.brush->SetOpacity(1.0f);
+        return;
+    case 0x2594: // UPPER ONE EIGHTH BLOCK
+        fill(0, 0, w, eighths(h, 1));
+        return;
+    case 0x2595: // RIGHT ONE EIGHTH BLOCK
+        fill(w - eighths(w, 1), 0, w, h);
+        return;
+    default:
+        break;
+    }
+
+    // The quadrants U+2596-U+259F as a bitmask of
+    // upper left (1), upper right (2), lower left (4) and lower right (8).
+    static constexpr u8 quadrants[]{ 4, 8, 1, 1 | 4 | 8, 1 | 8, 1 | 2 | 4, 1 | 2 | 8, 2, 2 | 4, 2 | 4 | 8 };
+    const auto mask = til::at(quadrants, ch - 0x2596);
+    if (mask & 1)
+    {
+        fill(0, 0, halfW, halfH);
+    }
+    if (mask & 2)
+    {
+        fill(halfW, 0, w, halfH);
+    }
+    if (mask & 4)
+    {
+        fill(0, halfH, halfW, h);
+    }
+    if (mask & 8)
+    {
+        fill(halfW, halfH, w, h);
+    }
+}
+
 void AtlasEngine::_drawCursor()
 {
     _reserveScratchpadSize(1);
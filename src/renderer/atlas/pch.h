@@ -7,7 +7,10 @@
 #define WIN32_LEAN_AND_MEAN
 
 #include <array>
+#include <chrono>
 #include <filesystem>
+#include <list>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <string_view>
@@ -50,3 +53,4 @@
 
 #include <til.h>
 #include <til/bit.h>
+#include <til/flat_hash_map.h>
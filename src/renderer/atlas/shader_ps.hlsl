@@ -49,6 +49,9 @@ cbuffer ConstBuffer : register(b0)
     uint cursorColor;
     uint selectionColor;
     uint useClearType;
+    uint cellCountY;
+    uint cellRowOffset;
+    int smoothScrollOffset;
 };
 StructuredBuffer<Cell> cells : register(t0);
 Texture2D<float4> glyphs : register(t1);
@@ -86,7 +89,19 @@ float4 main(float4 pos: SV_Position): SV_Target
     uint2 viewportPos = pos.xy - viewport.xy;
     uint2 cellIndex = viewportPos / cellSize;
     uint2 cellPos = viewportPos % cellSize;
-    Cell cell = cells[cellIndex.y * cellCountX + cellIndex.x];
+    // The rows of the cell buffer form a ring and cellRowOffset is the row the viewport starts at.
+    uint cellRow = cellIndex.y + cellRowOffset;
+    // During a smooth scroll the rows are drawn shifted by smoothScrollOffset pixels. The rows this
+    // uncovers are the ones that just scrolled out of the viewport, which the ring still holds.
+    [branch] if (smoothScrollOffset != 0)
+    {
+        // Shifted by a whole ring, so that the rows above the viewport don't result in negative numbers.
+        uint y = uint(int(viewportPos.y) - smoothScrollOffset + int(cellCountY * cellSize.y));
+        cellPos.y = y % cellSize.y;
+        cellRow = (y / cellSize.y + cellRowOffset) % cellCountY;
+    }
+    cellRow -= cellRow >= cellCountY ? cellCountY : 0;
+    Cell cell = cells[cellRow * cellCountX + cellIndex.x];
 
     // Layer 0:
     // The cell's background color
@@ -85,15 +85,58 @@ namespace Microsoft::Console::Render::FontCache
                 return systemFontCollection;
             }
         }
+
+        // Building the collection with the nearby fonts enumerates the entire system font set,
+        // which is too costly to be done for every new pane. All panes and windows of
+        // the process share the same collection instead, until GetFresh() replaces it.
+        struct SharedFontCollection
+        {
+            std::mutex lock;
+            wil::com_ptr<IDWriteFontCollection> collection;
+        };
+
+        inline SharedFontCollection& getSharedFontCollection()
+        {
+            static SharedFontCollection shared;
+            return shared;
+        }
     }
 
     inline wil::com_ptr<IDWriteFontCollection> GetCached()
     {
-        return details::getFontCollection(false);
+        auto& shared = details::getSharedFontCollection();
+        const std::lock_guard guard{ shared.lock };
+        if (!shared.collection)
+        {
+            shared.collection = details::getFontCollection(false);
+        }
+        return shared.collection;
+    }
+
+    // Builds the shared font collection on a thread pool thread, so that the first call
+    // to GetCached() doesn't have to. If that call happens while the collection is still
+    // being built, it simply waits for it to finish. This is meant to be called early
+    // during startup, so that the enumeration runs in parallel to other work.
+    inline void Prefetch() noexcept
+    {
+        LOG_IF_WIN32_BOOL_FALSE(TrySubmitThreadpoolCallback(
+            [](PTP_CALLBACK_INSTANCE, PVOID) noexcept {
+                try
+                {
+                    GetCached();
+                }
+                CATCH_LOG();
+            },
+            nullptr,
+            nullptr));
     }
 
     inline wil::com_ptr<IDWriteFontCollection> GetFresh()
     {
-        return details::getFontCollection(true);
+        auto collection = details::getFontCollection(true);
+        auto& shared = details::getSharedFontCollection();
+        const std::lock_guard guard{ shared.lock };
+        shared.collection = collection;
+        return collection;
     }
 }
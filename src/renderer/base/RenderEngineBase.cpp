@@ -59,6 +59,16 @@ HRESULT RenderEngineBase::PrepareLineTransform(const LineRendition /*lineRenditi
     return S_FALSE;
 }
 
+// Method Description:
+// - By default, engines don't support inline images and leave their cells as
+//   they are. Only the text of the rows they're drawn over gets painted.
+HRESULT RenderEngineBase::PaintImageSlice(const ImageSlice::Pointer& /*imageSlice*/,
+                                          const til::CoordType /*targetRow*/,
+                                          const til::CoordType /*viewportLeft*/) noexcept
+{
+    return S_FALSE;
+}
+
 // Method Description:
 // - By default, no one should need continuous redraw. It ruins performance
 //   in terms of CPU, memory, and battery life to just paint forever.
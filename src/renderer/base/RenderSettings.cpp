@@ -8,12 +8,69 @@
 #include "../../types/inc/ColorFix.hpp"
 #include "../../types/inc/colorTable.hpp"
 
+#include <til/hash.h>
+
 using namespace Microsoft::Console::Render;
 using Microsoft::Console::Utils::InitializeColorTable;
 
 static constexpr size_t AdjustedFgIndex{ 16 };
 static constexpr size_t AdjustedBgIndex{ 17 };
 
+// GetAttributeColors is called on every frame by the render thread, and by UIA
+// and search while they hold the console lock for reading, concurrently. Instead
+// of locking the caches, every thread has its own. They're small, and a thread
+// rarely asks more than one RenderSettings instance for colors.
+// The adjusted foreground colors are computed on first use. The indexed colors plus
+// the two defaults map directly into an 18x18 array, all other color pairs share a
+// small direct-mapped cache. The colors GetAttributeColors resolved for the attributes
+// that are in use are kept in another direct-mapped cache.
+struct RenderSettings::ColorCaches
+{
+    struct AdjustedColor
+    {
+        COLORREF color = 0;
+        uint64_t generation = 0;
+    };
+    struct AdjustedRgbColor
+    {
+        uint64_t key = 0;
+        COLORREF color = 0;
+        uint64_t generation = 0;
+    };
+    struct ResolvedColors
+    {
+        TextAttribute attr;
+        std::pair<COLORREF, COLORREF> colors;
+        uint64_t generation = 0;
+    };
+    std::array<std::array<AdjustedColor, 18>, 18> adjustedForegroundColors{};
+    std::array<AdjustedRgbColor, 256> adjustedRgbColors{};
+    std::array<ResolvedColors, 64> resolvedColors{};
+};
+
+// Routine Description:
+// - Returns a new cache generation. 0 is never returned, so that's what empty cache entries have.
+uint64_t RenderSettings::_nextCacheGeneration() noexcept
+{
+    static std::atomic<uint64_t> generation{ 0 };
+    return generation.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// Routine Description:
+// - Returns the color caches of the calling thread. They're allocated on first
+//   use, so that threads that never render don't pay for them.
+// Return Value:
+// - The caches, or nullptr if they couldn't be allocated, in which case nothing is cached.
+RenderSettings::ColorCaches* RenderSettings::_getColorCaches() noexcept
+{
+    static thread_local std::unique_ptr<ColorCaches> caches;
+    if (!caches)
+    {
+        caches.reset(new (std::nothrow) ColorCaches{});
+    }
+    return caches.get();
+}
+
 RenderSettings::RenderSettings() noexcept
 {
     InitializeColorTable(_colorTable);
@@ -38,6 +95,7 @@ RenderSettings::RenderSettings() noexcept
 void RenderSettings::SetRenderMode(const Mode mode, const bool enabled) noexcept
 {
     _renderMode.set(mode, enabled);
+    _resolvedColorsGeneration = _nextCacheGeneration();
     // If blinking is disabled, make sure blinking content is not faint.
     if (mode == Mode::BlinkAllowed && !enabled)
     {
@@ -68,38 +126,101 @@ const std::array<COLORREF, TextColor::TABLE_SIZE>& RenderSettings::GetColorTable
 void RenderSettings::ResetColorTable() noexcept
 {
     InitializeColorTable({ _colorTable.data(), 16 });
+    _adjustedColorsGeneration = _nextCacheGeneration();
+    _resolvedColorsGeneration = _nextCacheGeneration();
 }
 
 // Routine Description:
-// - Creates the adjusted color array, which contains the possible foreground colors,
-//   adjusted for perceivability
-// - The adjusted color array is 2-d, and effectively maps a background and foreground
-//   color pair to the adjusted foreground for that color pair
+// - Invalidates the adjusted colors, which map a background and foreground
+//   color pair to the foreground color adjusted for perceivability.
+// - They're recomputed lazily by GetAttributeColors, only for the color pairs
+//   that are actually in use. Since every change to the color table
+//   invalidates them anyway, calling this is only necessary for changes that
+//   bypass SetColorTableEntry and SetColorAliasIndex.
 void RenderSettings::MakeAdjustedColorArray() noexcept
 {
-    // The color table has 16 colors, but the adjusted color table needs to be 18
-    // to include the default background and default foreground colors
-    std::array<COLORREF, 18> colorTableWithDefaults;
-    std::copy_n(std::begin(_colorTable), 16, std::begin(colorTableWithDefaults));
-    colorTableWithDefaults[AdjustedFgIndex] = GetColorAlias(ColorAlias::DefaultForeground);
-    colorTableWithDefaults[AdjustedBgIndex] = GetColorAlias(ColorAlias::DefaultBackground);
-
-    for (auto fgIndex = 0; fgIndex < 18; ++fgIndex)
+    _adjustedColorsGeneration = _nextCacheGeneration();
+    _resolvedColorsGeneration = _nextCacheGeneration();
+}
+
+// Routine Description:
+// - Returns one of the 18 colors the adjusted color array is made of: the first 16
+//   entries of the color table, followed by the default foreground and background.
+COLORREF RenderSettings::_getAdjustedTableColor(const size_t index) const noexcept
+{
+    switch (index)
     {
-        const auto fg = til::at(colorTableWithDefaults, fgIndex);
-        for (auto bgIndex = 0; bgIndex < 18; ++bgIndex)
-        {
-            if (fgIndex == bgIndex)
-            {
-                _adjustedForegroundColors[bgIndex][fgIndex] = fg;
-            }
-            else
-            {
-                const auto bg = til::at(colorTableWithDefaults, bgIndex);
-                _adjustedForegroundColors[bgIndex][fgIndex] = ColorFix::GetPerceivableColor(fg, bg);
-            }
-        }
+    case AdjustedFgIndex:
+        return til::at(_colorTable, GetColorAliasIndex(ColorAlias::DefaultForeground));
+    case AdjustedBgIndex:
+        return til::at(_colorTable, GetColorAliasIndex(ColorAlias::DefaultBackground));
+    default:
+        return til::at(_colorTable, index);
+    }
+}
+
+// Routine Description:
+// - Returns the foreground color for the given pair of indices into the
+//   adjusted color array, adjusted for perceivability. It's computed on first use.
+// Arguments:
+// - fgIndex - The index of the foreground color.
+// - bgIndex - The index of the background color.
+// - caches - The caches of the calling thread, if any.
+// Return Value:
+// - The adjusted foreground color.
+COLORREF RenderSettings::_getAdjustedForegroundColor(const size_t fgIndex, const size_t bgIndex, ColorCaches* caches) const noexcept
+{
+    const auto compute = [&]() noexcept {
+        const auto fg = _getAdjustedTableColor(fgIndex);
+        return fgIndex == bgIndex ? fg : ColorFix::GetPerceivableColor(fg, _getAdjustedTableColor(bgIndex));
+    };
+    if (!caches)
+    {
+        return compute();
+    }
+
+    auto& entry = til::at(til::at(caches->adjustedForegroundColors, bgIndex), fgIndex);
+    if (entry.generation != _adjustedColorsGeneration)
+    {
+        entry.color = compute();
+        entry.generation = _adjustedColorsGeneration;
     }
+    return entry.color;
+}
+
+// Routine Description:
+// - Same as _getAdjustedForegroundColor, but for arbitrary colors, like the
+//   ones set via SGR 38/48. The results are kept in a direct-mapped cache, since
+//   the number of color pairs on screen is usually tiny, but not bounded.
+// Arguments:
+// - fg - The foreground color.
+// - bg - The background color.
+// - caches - The caches of the calling thread, if any.
+// Return Value:
+// - The adjusted foreground color.
+COLORREF RenderSettings::_getAdjustedRgbColor(const COLORREF fg, const COLORREF bg, ColorCaches* caches) const noexcept
+{
+    // Text that's explicitly drawn in its background color is meant to be invisible.
+    if (fg == bg)
+    {
+        return fg;
+    }
+    if (!caches)
+    {
+        return ColorFix::GetPerceivableColor(fg, bg);
+    }
+
+    const auto key = (uint64_t{ fg } << 32) | bg;
+    // Fibonacci hashing: the top 8 bits of the product are well distributed.
+    const auto slot = gsl::narrow_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 56);
+    auto& entry = til::at(caches->adjustedRgbColors, slot);
+    if (entry.generation != _adjustedColorsGeneration || entry.key != key)
+    {
+        entry.key = key;
+        entry.color = ColorFix::GetPerceivableColor(fg, bg);
+        entry.generation = _adjustedColorsGeneration;
+    }
+    return entry.color;
 }
 
 // Routine Description:
@@ -109,7 +230,13 @@ void RenderSettings::MakeAdjustedColorArray() noexcept
 // - color - The new COLORREF to use as that color table value.
 void RenderSettings::SetColorTableEntry(const size_t tableIndex, const COLORREF color)
 {
-    _colorTable.at(tableIndex) = color;
+    auto& entry = _colorTable.at(tableIndex);
+    if (entry != color)
+    {
+        entry = color;
+        _adjustedColorsGeneration = _nextCacheGeneration();
+        _resolvedColorsGeneration = _nextCacheGeneration();
+    }
 }
 
 // Routine Description:
@@ -156,6 +283,8 @@ void RenderSettings::SetColorAliasIndex(const ColorAlias alias, const size_t tab
     if (tableIndex < TextColor::TABLE_SIZE)
     {
         gsl::at(_colorAliasIndices, static_cast<size_t>(alias)) = tableIndex;
+        _adjustedColorsGeneration = _nextCacheGeneration();
+        _resolvedColorsGeneration = _nextCacheGeneration();
     }
 }
 
@@ -179,8 +308,40 @@ size_t RenderSettings::GetColorAliasIndex(const ColorAlias alias) const noexcept
 // - The color values of the attribute's foreground and background.
 std::pair<COLORREF, COLORREF> RenderSettings::GetAttributeColors(const TextAttribute& attr) const noexcept
 {
-    _blinkIsInUse = _blinkIsInUse || attr.IsBlinking();
+    if (attr.IsBlinking())
+    {
+        _blinkIsInUse.store(true, std::memory_order_relaxed);
+    }
 
+    const auto caches = _getColorCaches();
+    if (!caches)
+    {
+        return _resolveAttributeColors(attr, nullptr);
+    }
+
+    // A screen rarely uses more than a few dozen distinct attributes, but every
+    // run of them is resolved anew on every frame. TextAttribute's operator==
+    // is a memcmp(), so its hash can be one as well.
+    const auto slot = til::hash_bytes(&attr, sizeof(attr)) % caches->resolvedColors.size();
+    auto& entry = til::at(caches->resolvedColors, slot);
+    if (entry.generation != _resolvedColorsGeneration || entry.attr != attr)
+    {
+        entry.attr = attr;
+        entry.colors = _resolveAttributeColors(attr, caches);
+        entry.generation = _resolvedColorsGeneration;
+    }
+    return entry.colors;
+}
+
+// Routine Description:
+// - Resolves the colors of an attribute for GetAttributeColors, which caches them.
+// Arguments:
+// - attr - The TextAttribute to retrieve the colors for.
+// - caches - The caches of the calling thread, if any.
+// Return Value:
+// - The color values of the attribute's foreground and background.
+std::pair<COLORREF, COLORREF> RenderSettings::_resolveAttributeColors(const TextAttribute& attr, ColorCaches* caches) const noexcept
+{
     const auto fgTextColor = attr.GetForeground();
     const auto bgTextColor = attr.GetBackground();
 
@@ -191,11 +352,12 @@ std::pair<COLORREF, COLORREF> RenderSettings::GetAttributeColors(const TextAttri
     const auto dimFg = attr.IsFaint() || (_blinkShouldBeFaint && attr.IsBlinking());
     const auto swapFgAndBg = attr.IsReverseVideo() ^ GetRenderMode(Mode::ScreenReversed);
 
-    // We want to nudge the foreground color to make it more perceivable only for the
-    // default color pairs within the color table
-    if (Feature_AdjustIndistinguishableText::IsEnabled() &&
-        GetRenderMode(Mode::DistinguishableColors) &&
-        !dimFg &&
+    // We want to nudge the foreground color to make it more perceivable. The default
+    // color pairs within the color table are looked up in the adjusted color array.
+    const auto adjustColors = Feature_AdjustIndistinguishableText::IsEnabled() &&
+                              GetRenderMode(Mode::DistinguishableColors) &&
+                              !dimFg;
+    if (adjustColors &&
         (fgTextColor.IsDefault() || fgTextColor.IsLegacy()) &&
         (bgTextColor.IsDefault() || bgTextColor.IsLegacy()))
     {
@@ -210,13 +372,13 @@ std::pair<COLORREF, COLORREF> RenderSettings::GetAttributeColors(const TextAttri
 
         if (swapFgAndBg)
         {
-            const auto fg = _adjustedForegroundColors[fgIndex][bgIndex];
+            const auto fg = _getAdjustedForegroundColor(bgIndex, fgIndex, caches);
             const auto bg = fgTextColor.GetColor(_colorTable, defaultFgIndex);
             return { fg, bg };
         }
         else
         {
-            const auto fg = _adjustedForegroundColors[bgIndex][fgIndex];
+            const auto fg = _getAdjustedForegroundColor(fgIndex, bgIndex, caches);
             const auto bg = bgTextColor.GetColor(_colorTable, defaultBgIndex);
             return { fg, bg };
         }
@@ -238,6 +400,11 @@ std::pair<COLORREF, COLORREF> RenderSettings::GetAttributeColors(const TextAttri
         {
             fg = bg;
         }
+        else if (adjustColors)
+        {
+            // All other pairs (involving 256-color palette or RGB colors) go through the cache.
+            fg = _getAdjustedRgbColor(fg, bg, caches);
+        }
 
         return { fg, bg };
     }
@@ -282,14 +449,19 @@ try
         // have a blink cycle that loops through four phases...
         _blinkCycle = (_blinkCycle + 1) % 4;
         // ... and two of those four render the blink attributes as faint.
-        _blinkShouldBeFaint = _blinkCycle >= 2;
+        const auto blinkShouldBeFaint = _blinkCycle >= 2;
+        if (_blinkShouldBeFaint != blinkShouldBeFaint)
+        {
+            _blinkShouldBeFaint = blinkShouldBeFaint;
+            _resolvedColorsGeneration = _nextCacheGeneration();
+        }
         // Every two cycles (when the state changes), we need to trigger a
         // redraw, but only if there are actually blink attributes in use.
-        if (_blinkIsInUse && _blinkCycle % 2 == 0)
+        if (_blinkIsInUse.load(std::memory_order_relaxed) && _blinkCycle % 2 == 0)
         {
             // We reset the _blinkIsInUse flag before redrawing, so we can
             // get a fresh assessment of the current blink attribute usage.
-            _blinkIsInUse = false;
+            _blinkIsInUse.store(false, std::memory_order_relaxed);
             renderer.TriggerRedrawAll();
         }
     }
@@ -3,9 +3,16 @@
 
 #include "precomp.h"
 #include "renderer.hpp"
+#include "../../types/inc/AllocationTracker.hpp"
+
+#include <TraceLoggingProvider.h>
+#include <winmeta.h>
 
 #pragma hdrstop
 
+// Defined in thread.cpp.
+TRACELOGGING_DECLARE_PROVIDER(g_hRenderThreadProvider);
+
 using namespace Microsoft::Console::Render;
 using namespace Microsoft::Console::Types;
 
@@ -109,14 +116,21 @@ try
 {
     FAIL_FAST_IF_NULL(pEngine); // This is a programming error. Fail fast.
 
-    _pData->LockConsole();
+    // Painting only reads the buffer, so other readers like UIA or search can run alongside.
+    _pData->LockConsoleForReading();
     auto unlock = wil::scope_exit([&]() {
-        _pData->UnlockConsole();
+        _pData->UnlockConsoleForReading();
     });
 
     // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
     _CheckViewportAndScroll();
 
+    const auto engineIndex = std::find(_engines.begin(), _engines.end(), pEngine) - _engines.begin();
+    auto& paintedGeneration = til::at(_paintedContentGeneration, engineIndex);
+    const auto steady = paintedGeneration == _contentGeneration;
+    paintedGeneration = _contentGeneration;
+    const AllocationTracker::Scope allocations{ steady ? AllocationStage::SteadyFrame : AllocationStage::Frame };
+
     // Try to start painting a frame
     const auto hr = pEngine->StartPaint();
     RETURN_IF_FAILED(hr);
@@ -131,14 +145,6 @@ try
 
     auto endPaint = wil::scope_exit([&]() {
         LOG_IF_FAILED(pEngine->EndPaint());
-
-        // If the engine tells us it really wants to redraw immediately,
-        // tell the thread so it doesn't go to sleep and ticks again
-        // at the next opportunity.
-        if (pEngine->RequiresContinuousRedraw())
-        {
-            NotifyPaintFrame();
-        }
     });
 
     // A. Prep Colors
@@ -174,8 +180,44 @@ try
     // Force scope exit unlock to let go of global lock so other threads can run
     unlock.reset();
 
-    // Trigger out-of-lock presentation for renderers that can support it
-    RETURN_IF_FAILED(pEngine->Present());
+    // Trigger out-of-lock presentation for renderers that can support it.
+    // Engines should do as much of their work in here as possible, because
+    // everything up until EndPaint() blocks the threads that write to the buffer.
+    const auto tracing = TraceLoggingProviderEnabled(g_hRenderThreadProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE);
+    if (tracing)
+    {
+#pragma warning(suppress : 26477 26485 26494 26482 26446 26447) // We don't control TraceLoggingWrite
+        TraceLoggingWrite(g_hRenderThreadProvider,
+                          "Present",
+                          TraceLoggingOpcode(WINEVENT_OPCODE_START),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+    }
+
+    const auto presentResult = pEngine->Present();
+
+    if (tracing)
+    {
+#pragma warning(suppress : 26477 26485 26494 26482 26446 26447) // We don't control TraceLoggingWrite
+        TraceLoggingWrite(g_hRenderThreadProvider,
+                          "Present",
+                          TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+                          TraceLoggingHResult(presentResult, "Result"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+    }
+
+    RETURN_IF_FAILED(presentResult);
+    _presentedFrames.fetch_add(1, std::memory_order_relaxed);
+
+    // If the engine tells us it really wants to redraw immediately,
+    // tell the thread so it doesn't go to sleep and ticks again
+    // at the next opportunity. This is asked after Present(), because
+    // engines like AtlasEngine only know about it once they presented.
+    if (pEngine->RequiresContinuousRedraw())
+    {
+        NotifyPaintFrame();
+    }
 
     // As we leave the scope, EndPaint will be called (declared above)
     return S_OK;
@@ -192,6 +234,44 @@ void Renderer::NotifyPaintFrame() noexcept
     }
 }
 
+// Routine Description:
+// - Called when the user pressed a key. The next frames are painted with
+//   a low latency, up until the first one that changed the text (its echo).
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::NotifyInput() noexcept
+{
+    if (_pThread)
+    {
+        _pThread->NotifyInput();
+    }
+}
+
+// Routine Description:
+// - Called when an application begins or ends a synchronized update (mode 2026).
+//   While it's in progress, frames are held back so that only complete ones get
+//   painted. Invalidations keep accumulating in the engines in the meantime.
+// Arguments:
+// - enabled - true when the update begins, false when it ends.
+// Return Value:
+// - <none>
+void Renderer::SetSynchronizedOutput(const bool enabled) noexcept
+{
+    if (_pThread)
+    {
+        if (enabled)
+        {
+            _pThread->BeginSynchronizedOutput();
+        }
+        else
+        {
+            _pThread->EndSynchronizedOutput();
+        }
+    }
+}
+
 // Routine Description:
 // - Called when the system has requested we redraw a portion of the console.
 // Arguments:
@@ -200,6 +280,7 @@ void Renderer::NotifyPaintFrame() noexcept
 // - <none>
 void Renderer::TriggerSystemRedraw(const til::rect* const prcDirtyClient)
 {
+    ++_contentGeneration;
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->InvalidateSystem(prcDirtyClient));
@@ -234,11 +315,16 @@ void Renderer::TriggerRedraw(const Viewport& region)
     if (view.TrimToViewport(&srUpdateRegion))
     {
         view.ConvertToOrigin(&srUpdateRegion);
+        ++_contentGeneration;
         FOREACH_ENGINE(pEngine)
         {
             LOG_IF_FAILED(pEngine->Invalidate(&srUpdateRegion));
         }
 
+        if (_pThread)
+        {
+            _pThread->NotifyTextChanged();
+        }
         NotifyPaintFrame();
     }
 }
@@ -304,6 +390,7 @@ void Renderer::TriggerRedrawCursor(const til::point* const pcoord)
 // - <none>
 void Renderer::TriggerRedrawAll(const bool backgroundChanged, const bool frameChanged)
 {
+    ++_contentGeneration;
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->InvalidateAll());
@@ -370,19 +457,90 @@ void Renderer::TriggerSelection()
             sr &= viewport;
         }
 
-        FOREACH_ENGINE(pEngine)
+        // Only the rows whose selected columns changed need to be redrawn.
+        // While dragging a selection that's usually just the last row.
+        std::vector<til::rect> removed;
+        std::vector<til::rect> added;
+        _DiffSelectionRects(_previousSelection, rects, removed, added);
+
+        if (!removed.empty() || !added.empty())
         {
-            LOG_IF_FAILED(pEngine->InvalidateSelection(_previousSelection));
-            LOG_IF_FAILED(pEngine->InvalidateSelection(rects));
+            ++_contentGeneration;
+            FOREACH_ENGINE(pEngine)
+            {
+                LOG_IF_FAILED(pEngine->InvalidateSelection(removed));
+                LOG_IF_FAILED(pEngine->InvalidateSelection(added));
+            }
+
+            NotifyPaintFrame();
         }
 
         _previousSelection = std::move(rects);
-
-        NotifyPaintFrame();
     }
     CATCH_LOG();
 }
 
+// Routine Description:
+// - Compares the previous and the current selection rectangles row by row.
+// - The rectangles are expected to be one row high each, sorted from top to
+//   bottom, as returned by _GetSelectionRects. If they aren't, all of them
+//   are considered changed.
+// Arguments:
+// - previous - The previously selected rectangles
+// - current - The currently selected rectangles
+// - removed - Receives the previous rectangles of rows that changed
+// - added - Receives the current rectangles of rows that changed
+// Return Value:
+// - <none>
+void Renderer::_DiffSelectionRects(const std::vector<til::rect>& previous,
+                                   const std::vector<til::rect>& current,
+                                   std::vector<til::rect>& removed,
+                                   std::vector<til::rect>& added)
+{
+    const auto isRowList = [](const std::vector<til::rect>& rects) {
+        for (size_t i = 0; i < rects.size(); ++i)
+        {
+            const auto& rect = til::at(rects, i);
+            if (rect.height() > 1 || (i != 0 && rect.Top <= til::at(rects, i - 1).Top))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (!isRowList(previous) || !isRowList(current))
+    {
+        removed = previous;
+        added = current;
+        return;
+    }
+
+    auto prev = previous.begin();
+    auto curr = current.begin();
+    while (prev != previous.end() || curr != current.end())
+    {
+        if (curr == current.end() || (prev != previous.end() && prev->Top < curr->Top))
+        {
+            removed.emplace_back(*prev++);
+        }
+        else if (prev == previous.end() || curr->Top < prev->Top)
+        {
+            added.emplace_back(*curr++);
+        }
+        else
+        {
+            if (*prev != *curr)
+            {
+                removed.emplace_back(*prev);
+                added.emplace_back(*curr);
+            }
+            ++prev;
+            ++curr;
+        }
+    }
+}
+
 // Routine Description:
 // - Called when we want to check if the viewport has moved and scroll accordingly if so.
 // Arguments:
@@ -401,6 +559,7 @@ bool Renderer::_CheckViewportAndScroll()
 
     _viewport = Viewport::FromInclusive(srNewViewport);
     _forceUpdateViewport = false;
+    ++_contentGeneration;
 
     til::point coordDelta;
     coordDelta.X = srOldViewport.Left - srNewViewport.Left;
@@ -442,6 +601,7 @@ void Renderer::TriggerScroll()
 // - <none>
 void Renderer::TriggerScroll(const til::point* const pcoordDelta)
 {
+    ++_contentGeneration;
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->InvalidateScroll(pcoordDelta));
@@ -461,6 +621,7 @@ void Renderer::TriggerScroll(const til::point* const pcoordDelta)
 // - <none>
 void Renderer::TriggerFlush(const bool circling)
 {
+    ++_contentGeneration;
     const auto rects = _GetSelectionRects();
 
     FOREACH_ENGINE(pEngine)
@@ -525,6 +686,7 @@ HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
 // - <none>
 void Renderer::TriggerFontChange(const int iDpi, const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo)
 {
+    ++_contentGeneration;
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->UpdateDpi(iDpi));
@@ -555,7 +717,68 @@ void Renderer::UpdateSoftFont(const gsl::span<const uint16_t> bitPattern, const
     {
         LOG_IF_FAILED(pEngine->UpdateSoftFont(bitPattern, cellSize, centeringHint));
     }
-    TriggerRedrawAll();
+
+    // Applications that stream DECDLD updates usually only replace a few glyphs at a time.
+    // As long as the glyph geometry didn't change, only the cells that show one
+    // of the replaced glyphs need to be redrawn and not the entire viewport.
+    if (cellSize.cy && cellSize == _softFontCellSize && centeringHint == _softFontCenteringHint)
+    {
+        _InvalidateChangedSoftFontChars(bitPattern, cellSize.cy);
+    }
+    else
+    {
+        TriggerRedrawAll();
+    }
+
+    _softFontBitPattern.assign(bitPattern.begin(), bitPattern.end());
+    _softFontCellSize = cellSize;
+    _softFontCenteringHint = centeringHint;
+}
+
+// Routine Description:
+// - Compares the given soft font with the previous one and invalidates all
+//   rows in the viewport that contain a glyph whose bit pattern changed.
+// Arguments:
+// - bitPattern - The scanlines of all glyphs in the new soft font.
+// - scanlines - The number of scanlines per glyph, identical for both fonts.
+// Return Value:
+// - <none>
+void Renderer::_InvalidateChangedSoftFontChars(const gsl::span<const uint16_t> bitPattern, const size_t scanlines)
+{
+    const auto oldCharCount = _softFontBitPattern.size() / scanlines;
+    const auto newCharCount = bitPattern.size() / scanlines;
+    const auto charCount = std::max(oldCharCount, newCharCount);
+
+    std::vector<bool> changed(charCount);
+    auto anyChanged = false;
+    for (size_t i = 0; i < charCount; ++i)
+    {
+        // Glyphs that only exist in either of the fonts always count as changed.
+        changed[i] = i >= oldCharCount || i >= newCharCount ||
+                     !std::equal(bitPattern.begin() + i * scanlines,
+                                 bitPattern.begin() + (i + 1) * scanlines,
+                                 _softFontBitPattern.begin() + i * scanlines);
+        anyChanged |= changed[i];
+    }
+
+    if (!anyChanged)
+    {
+        return;
+    }
+
+    const auto& buffer = _pData->GetTextBuffer();
+    for (auto y = _viewport.Top(); y < _viewport.BottomExclusive(); ++y)
+    {
+        const auto text = buffer.GetRowByOffset(y).GetText();
+        const auto hasChangedChar = std::any_of(text.begin(), text.end(), [&](const wchar_t ch) {
+            const size_t index = ch - _firstSoftFontChar;
+            return ch >= _firstSoftFontChar && index < charCount && changed[index];
+        });
+        if (hasChangedChar)
+        {
+            TriggerRedraw(Viewport::FromDimensions({ _viewport.Left(), y }, { _viewport.Width(), 1 }));
+        }
+    }
 }
 
 // We initially tried to have a "_isSoftFontChar" member function, but MSVC
@@ -644,6 +867,21 @@ void Renderer::EnablePainting()
     }
 }
 
+// Routine Description:
+// - Resets an event in the render thread that precludes it from advancing, thus disabling rendering.
+// - Unlike WaitForPaintCompletionAndDisable, a paint operation that's underway is allowed to finish.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::DisablePainting()
+{
+    if (_pThread)
+    {
+        _pThread->DisablePainting();
+    }
+}
+
 // Routine Description:
 // - Waits for the current paint operation to complete, if any, up to the specified timeout.
 // - Resets an event in the render thread that precludes it from advancing, thus disabling rendering.
@@ -733,9 +971,6 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
             // of the backing buffer to fill in line 1 of the screen.
             const auto screenPosition = bufferLine.Origin() - til::point{ 0, view.Top() };
 
-            // Retrieve the cell information iterator limited to just this line we want to redraw.
-            auto it = buffer.GetCellDataAt(bufferLine.Origin(), bufferLine);
-
             // Calculate if two things are true:
             // 1. this row wrapped
             // 2. We're painting the last col of the row.
@@ -747,7 +982,13 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
             LOG_IF_FAILED(pEngine->PrepareLineTransform(lineRendition, screenPosition.Y, view.Left()));
 
             // Ask the helper to paint through this specific line.
-            _PaintBufferOutputHelper(pEngine, it, screenPosition, lineWrapped);
+            _PaintBufferOutputHelper(pEngine, buffer, bufferLine.Origin(), bufferLine.RightExclusive(), screenPosition, lineWrapped, _GetSearchHighlights(bufferLine.Origin().Y));
+
+            // Images are drawn over the text of the row they're attached to.
+            if (const auto& imageSlice = buffer.GetRowByOffset(bufferLine.Origin().Y).GetImageSlice())
+            {
+                LOG_IF_FAILED(pEngine->PaintImageSlice(imageSlice, screenPosition.Y, view.Left()));
+            }
         }
     }
 }
@@ -759,33 +1000,56 @@ static bool _IsAllSpaces(const std::wstring_view v)
 }
 
 void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                        TextBufferCellIterator it,
+                                        const TextBuffer& buffer,
+                                        const til::point origin,
+                                        const til::CoordType endColumn,
                                         const til::point target,
-                                        const bool lineWrapped)
+                                        const bool lineWrapped,
+                                        const gsl::span<const til::inclusive_rect> highlights)
 {
     auto globalInvert{ _renderSettings.GetRenderMode(RenderSettings::Mode::ScreenReversed) };
 
+    // The glyphs of the line come in runs of the same attributes, so that the
+    // attributes only need to be compared when a run starts, not for every cell.
+    _rowRuns.Load(buffer, origin, endColumn);
+    const auto runs = _rowRuns.Runs();
+
     // If we have valid data, let's figure out how to draw it.
-    if (it)
+    if (!runs.empty())
     {
-        // TODO: MSFT: 20961091 -  This is a perf issue. Instead of rebuilding this and allocing memory to hold the reinterpretation,
-        // we should have an iterator/view adapter for the rendering.
-        // That would probably also eliminate the RenderData needing to give us the entire TextBuffer as well...
-        // Retrieve the iterator for one line of information.
+        // The glyph that's up next: its run, and its index within that run.
+        size_t runIndex = 0;
+        size_t glyphIndex = 0;
+
+        // The first of the highlights that doesn't end left of the glyph that's up next.
+        // Highlighted glyphs are painted in _searchHighlightAttr instead of their run's attributes.
+        size_t highlightIndex = 0;
+        const auto glyphAttr = [&](const TextBufferRowRuns::Run& run, const TextBufferRowRuns::Glyph& glyph) -> const TextAttribute* {
+            while (highlightIndex < highlights.size() && til::at(highlights, highlightIndex).Right < glyph.column)
+            {
+                ++highlightIndex;
+            }
+            if (highlightIndex < highlights.size() && til::at(highlights, highlightIndex).Left <= glyph.column)
+            {
+                return &_searchHighlightAttr;
+            }
+            return run.attr;
+        };
+
         til::CoordType cols = 0;
 
         // Retrieve the first color.
-        auto color = it->TextAttr();
+        auto color = *glyphAttr(runs.front(), runs.front().glyphs.front());
         // Retrieve the first pattern id
         auto patternIds = _pData->GetPatternId(target);
         // Determine whether we're using a soft font.
-        auto usingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
+        auto usingSoftFont = s_IsSoftFontChar(runs.front().glyphs.front().text, _firstSoftFontChar, _lastSoftFontChar);
 
         // And hold the point where we should start drawing.
         auto screenPoint = target;
 
         // This outer loop will continue until we reach the end of the text we are trying to draw.
-        while (it)
+        while (runIndex < runs.size())
         {
             // Hold onto the current run color right here for the length of the outer loop.
             // We'll be changing the persistent one as we run through the inner loops to detect
@@ -793,9 +1057,6 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // when we go to draw gridlines for the length of the run.
             const auto currentRunColor = color;
 
-            // Hold onto the current pattern id as well
-            const auto currentPatternId = patternIds;
-
             // Update the drawing brushes with our color and font usage.
             THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, currentRunColor, usingSoftFont, false));
 
@@ -803,9 +1064,9 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             screenPoint.X += cols;
             cols = 0;
 
-            // Hold onto the start of this run iterator and the target location where we started
+            // Hold onto the first column of this run and the target location where we started
             // in case we need to do some special work to paint the line drawing characters.
-            const auto currentRunItStart = it;
+            const auto currentRunColumnStart = til::at(til::at(runs, runIndex).glyphs, glyphIndex).column;
             const auto currentRunTargetStart = screenPoint;
 
             // Ensure that our cluster vector is clear.
@@ -819,23 +1080,36 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // Run contains wide character (>1 columns)
             auto containsWideCharacter = false;
 
+            // Whether the attributes of the glyphs differ from the color of this run.
+            // The color doesn't change within this loop, so it's only compared when the attributes do.
+            const TextAttribute* comparedAttr = nullptr;
+            auto attrDiffers = false;
+
             // This inner loop will accumulate clusters until the color changes.
             // When the color changes, it will save the new color off and break.
             // We also accumulate clusters according to regex patterns
             do
             {
+                const auto& run = til::at(runs, runIndex);
+                const auto& glyph = til::at(run.glyphs, glyphIndex);
+                const auto attr = glyphAttr(run, glyph);
+                if (attr != comparedAttr)
+                {
+                    comparedAttr = attr;
+                    attrDiffers = color != *attr;
+                }
+
                 til::point thisPoint{ screenPoint.X + cols, screenPoint.Y };
                 const auto thisPointPatterns = _pData->GetPatternId(thisPoint);
-                const auto thisUsingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
+                const auto thisUsingSoftFont = s_IsSoftFontChar(glyph.text, _firstSoftFontChar, _lastSoftFontChar);
                 const auto changedPatternOrFont = patternIds != thisPointPatterns || usingSoftFont != thisUsingSoftFont;
-                if (color != it->TextAttr() || changedPatternOrFont)
+                if (attrDiffers || changedPatternOrFont)
                 {
-                    auto newAttr{ it->TextAttr() };
                     // foreground doesn't matter for runs of spaces (!)
                     // if we trick it . . . we call Paint far fewer times for cmatrix
-                    if (!_IsAllSpaces(it->Chars()) || !newAttr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert) || changedPatternOrFont)
+                    if (!_IsAllSpaces(glyph.text) || !attr->HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert) || changedPatternOrFont)
                     {
-                        color = newAttr;
+                        color = *attr;
                         patternIds = thisPointPatterns;
                         usingSoftFont = thisUsingSoftFont;
                         break; // vend this run
@@ -844,11 +1118,11 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
 
                 // Walk through the text data and turn it into rendering clusters.
                 // Keep the columnCount as we go to improve performance over digging it out of the vector at the end.
-                auto columnCount = it->Columns();
+                auto columnCount = glyph.columns;
 
                 // If we're on the first cluster to be added and it's marked as "trailing"
                 // (a.k.a. the right half of a two column character), then we need some special handling.
-                if (_clusterBuffer.empty() && it->DbcsAttr().IsTrailing())
+                if (_clusterBuffer.empty() && glyph.trailingHalf)
                 {
                     // Move left to the one so the whole character can be struck correctly.
                     --screenPoint.X;
@@ -864,11 +1138,15 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                 }
 
                 // Advance the cluster and column counts.
-                _clusterBuffer.emplace_back(it->Chars(), columnCount);
-                it += std::max(it->Columns(), 1); // prevent infinite loop for no visible columns
+                _clusterBuffer.emplace_back(glyph.text, columnCount);
                 cols += columnCount;
 
-            } while (it);
+                if (++glyphIndex == run.glyphs.size())
+                {
+                    ++runIndex;
+                    glyphIndex = 0;
+                }
+            } while (runIndex < runs.size());
 
             // Do the painting.
             THROW_IF_FAILED(pEngine->PaintBufferLine({ _clusterBuffer.data(), _clusterBuffer.size() }, screenPoint, trimLeft, lineWrapped));
@@ -882,21 +1160,19 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                 // attribute that could have contained different line information than the left half.
                 if (containsWideCharacter)
                 {
-                    // Start from the original position in this run.
-                    auto lineIt = currentRunItStart;
                     // Start from the original target in this run.
                     auto lineTarget = currentRunTargetStart;
 
-                    // We need to go through the iterators again to ensure we get the lines associated with each
+                    // We need to go through the attributes again to ensure we get the lines associated with each
                     // exact column. The code above will condense two-column characters into one, but it is possible
                     // (like with the IME) that the line drawing characters will vary from the left to right half
                     // of a wider character.
-                    // We could theoretically pre-pass for this in the loop above to be more efficient about walking
-                    // the iterator, but I fear it would make the code even more confusing than it already is.
-                    // Do that in the future if some WPR trace points you to this spot as super bad.
-                    for (til::CoordType colsPainted = 0; colsPainted < cols; ++colsPainted, ++lineIt, ++lineTarget.X)
+                    const auto& attrRow = buffer.GetRowByOffset(origin.Y).GetAttrRow();
+                    const auto lastColumn = buffer.GetRowByOffset(origin.Y).size() - 1;
+                    for (til::CoordType colsPainted = 0; colsPainted < cols; ++colsPainted, ++lineTarget.X)
                     {
-                        auto lines = lineIt->TextAttr();
+                        const auto column = std::min(currentRunColumnStart + colsPainted, lastColumn);
+                        const auto& lines = *(attrRow.cbegin() + column);
                         _PaintBufferOutputGridLineHelper(pEngine, lines, 1, lineTarget);
                     }
                 }
@@ -1137,9 +1413,9 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
                     const til::point target{ viewDirty.Left, iRow };
                     const auto source = target - overlay.origin;
 
-                    auto it = overlay.buffer.GetCellLineDataAt(source);
-
-                    _PaintBufferOutputHelper(&engine, it, target, false);
+                    // The overlay's buffer may be wider than its region (for instance
+                    // when only a part of a row is overlaid). Don't paint past the region.
+                    _PaintBufferOutputHelper(&engine, overlay.buffer, source, overlay.region.RightExclusive(), target, false, {});
                 }
             }
         }
@@ -1351,6 +1627,48 @@ void Renderer::UpdateLastHoveredInterval(const std::optional<PointTree::interval
     _hoveredInterval = newInterval;
 }
 
+// Method Description:
+// - Replaces the highlighted search results. Their cells are painted in attr
+//   instead of the attributes stored in the buffer, which isn't modified.
+// Arguments:
+// - rects - One rect per row and match, in buffer coordinates, as returned
+//   by TextBuffer::GetTextRects. Pass none to remove the highlights.
+// - attr - The attributes to paint the highlighted cells in.
+void Renderer::SetSearchHighlights(std::vector<til::inclusive_rect> rects, const TextAttribute& attr)
+{
+    // The rows are painted top to bottom and each of them left to right,
+    // so this is the order _GetSearchHighlights() and painting expect.
+    std::sort(rects.begin(), rects.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.Top, lhs.Left) < std::tie(rhs.Top, rhs.Left);
+    });
+
+    for (const auto& rect : _searchHighlights)
+    {
+        TriggerRedraw(Viewport::FromInclusive(rect));
+    }
+
+    _searchHighlights = std::move(rects);
+    _searchHighlightAttr = attr;
+
+    for (const auto& rect : _searchHighlights)
+    {
+        TriggerRedraw(Viewport::FromInclusive(rect));
+    }
+}
+
+// Routine Description:
+// - Returns the search highlights on the given row of the buffer, sorted from left to right.
+gsl::span<const til::inclusive_rect> Renderer::_GetSearchHighlights(const til::CoordType row) const noexcept
+{
+    const auto begin = std::lower_bound(_searchHighlights.begin(), _searchHighlights.end(), row, [](const auto& rect, const auto value) {
+        return rect.Top < value;
+    });
+    const auto end = std::upper_bound(begin, _searchHighlights.end(), row, [](const auto value, const auto& rect) {
+        return value < rect.Top;
+    });
+    return gsl::span<const til::inclusive_rect>{ _searchHighlights }.subspan(gsl::narrow_cast<size_t>(begin - _searchHighlights.begin()), gsl::narrow_cast<size_t>(end - begin));
+}
+
 // Method Description:
 // - Blocks until the engines are able to render without blocking.
 void Renderer::WaitUntilCanRender()
@@ -1360,3 +1678,17 @@ void Renderer::WaitUntilCanRender()
         pEngine->WaitUntilCanRender();
     }
 }
+
+// Method Description:
+// - Returns how many frames were presented so far, how many of them were late,
+//   and how much CPU time the render thread used for them.
+FrameStatistics Renderer::GetFrameStatistics() const noexcept
+{
+    FrameStatistics statistics;
+    if (_pThread)
+    {
+        _pThread->GetFrameStatistics(statistics);
+    }
+    statistics.presented = _presentedFrames.load(std::memory_order_relaxed);
+    return statistics;
+}
@@ -23,6 +23,7 @@ Author(s):
 
 #include "../../buffer/out/textBuffer.hpp"
 #include "../../buffer/out/CharRow.hpp"
+#include "../../buffer/out/textBufferRowRuns.hpp"
 
 // fwdecl unittest classes
 #ifdef UNIT_TESTING
@@ -48,6 +49,8 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT PaintFrame();
 
         void NotifyPaintFrame() noexcept;
+        void NotifyInput() noexcept;
+        void SetSynchronizedOutput(const bool enabled) noexcept;
         void TriggerSystemRedraw(const til::rect* const prcDirtyClient);
         void TriggerRedraw(const Microsoft::Console::Types::Viewport& region);
         void TriggerRedraw(const til::point* const pcoord);
@@ -79,8 +82,10 @@ namespace Microsoft::Console::Render
         bool IsGlyphWideByFont(const std::wstring_view glyph);
 
         void EnablePainting();
+        void DisablePainting();
         void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs);
         void WaitUntilCanRender();
+        FrameStatistics GetFrameStatistics() const noexcept;
 
         void AddRenderEngine(_In_ IRenderEngine* const pEngine);
 
@@ -90,6 +95,7 @@ namespace Microsoft::Console::Render
         void ResetErrorStateAndResume();
 
         void UpdateLastHoveredInterval(const std::optional<interval_tree::IntervalTree<til::point, size_t>::interval>& newInterval);
+        void SetSearchHighlights(std::vector<til::inclusive_rect> rects, const TextAttribute& attr);
 
     private:
         static IRenderEngine::GridLineSet s_GetGridlines(const TextAttribute& textAttribute) noexcept;
@@ -99,7 +105,8 @@ namespace Microsoft::Console::Render
         bool _CheckViewportAndScroll();
         [[nodiscard]] HRESULT _PaintBackground(_In_ IRenderEngine* const pEngine);
         void _PaintBufferOutput(_In_ IRenderEngine* const pEngine);
-        void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine, TextBufferCellIterator it, const til::point target, const bool lineWrapped);
+        void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine, const TextBuffer& buffer, const til::point origin, const til::CoordType endColumn, const til::point target, const bool lineWrapped, const gsl::span<const til::inclusive_rect> highlights);
+        gsl::span<const til::inclusive_rect> _GetSearchHighlights(const til::CoordType row) const noexcept;
         void _PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine, const TextAttribute textAttribute, const size_t cchLine, const til::point coordTarget);
         void _PaintSelection(_In_ IRenderEngine* const pEngine);
         void _PaintCursor(_In_ IRenderEngine* const pEngine);
@@ -109,9 +116,14 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _PerformScrolling(_In_ IRenderEngine* const pEngine);
         std::vector<til::rect> _GetSelectionRects() const;
         void _ScrollPreviousSelection(const til::point delta);
+        static void _DiffSelectionRects(const std::vector<til::rect>& previous,
+                                        const std::vector<til::rect>& current,
+                                        std::vector<til::rect>& removed,
+                                        std::vector<til::rect>& added);
         [[nodiscard]] HRESULT _PaintTitle(IRenderEngine* const pEngine);
         [[nodiscard]] std::optional<CursorOptions> _GetCursorInfo();
         [[nodiscard]] HRESULT _PrepareRenderInfo(_In_ IRenderEngine* const pEngine);
+        void _InvalidateChangedSoftFontChars(const gsl::span<const uint16_t> bitPattern, const size_t scanlines);
 
         const RenderSettings& _renderSettings;
         std::array<IRenderEngine*, 2> _engines{};
@@ -119,15 +131,29 @@ namespace Microsoft::Console::Render
         std::unique_ptr<RenderThread> _pThread;
         static constexpr size_t _firstSoftFontChar = 0xEF20;
         size_t _lastSoftFontChar = 0;
+        std::vector<uint16_t> _softFontBitPattern;
+        til::size _softFontCellSize;
+        size_t _softFontCenteringHint = 0;
         std::optional<interval_tree::IntervalTree<til::point, size_t>::interval> _hoveredInterval;
         Microsoft::Console::Types::Viewport _viewport;
         std::vector<Cluster> _clusterBuffer;
+        TextBufferRowRuns _rowRuns;
         std::vector<til::rect> _previousSelection;
+        // The search results to highlight, one rect per row and match, in buffer coordinates,
+        // sorted by their top and left. They're drawn over the buffer, but never written into it.
+        std::vector<til::inclusive_rect> _searchHighlights;
+        TextAttribute _searchHighlightAttr;
         std::function<void()> _pfnBackgroundColorChanged;
         std::function<void()> _pfnFrameColorChanged;
         std::function<void()> _pfnRendererEnteredErrorState;
         bool _destructing = false;
+        std::atomic<uint64_t> _presentedFrames{ 0 };
         bool _forceUpdateViewport = true;
+        // Incremented whenever something other than the cursor got invalidated. A frame that
+        // an engine paints at the same generation as its last one only blinks the cursor,
+        // which is the steady state the AllocationTracker expects to not allocate.
+        uint64_t _contentGeneration = 1;
+        std::array<uint64_t, 2> _paintedContentGeneration{};
 
 #ifdef UNIT_TESTING
         friend class ConptyOutputTests;
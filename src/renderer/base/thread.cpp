@@ -5,21 +5,55 @@
 #include "thread.hpp"
 
 #include "renderer.hpp"
+#include "../../types/inc/LockProfiler.hpp"
+
+#include <chrono>
+#include <TraceLoggingProvider.h>
+#include <winmeta.h>
 
 #pragma hdrstop
 
+#pragma warning(suppress : 26477) // We don't control tracelogging macros
+TRACELOGGING_DEFINE_PROVIDER(g_hRenderThreadProvider,
+                             "Microsoft.Windows.Terminal.Renderer",
+                             // {93d62bf4-821d-5bbd-228b-7ec39d39e9ea}
+                             (0x93d62bf4, 0x821d, 0x5bbd, 0x22, 0x8b, 0x7e, 0xc3, 0x9d, 0x39, 0xe9, 0xea), );
+
 using namespace Microsoft::Console::Render;
 
+// Frames painted within this window after a key press skip the throttling in
+// WaitUntilCanRender(), so that the echo of the key is presented immediately.
+// The first frame which contains changes to the text ends the window early.
+static constexpr auto lowLatencyWindow = std::chrono::milliseconds{ 100 };
+
+// Frames that take longer than this to paint are counted as late.
+static constexpr auto frameBudget = std::chrono::microseconds{ 16667 };
+// An application that began a synchronized update (DECSET 2026) and never ended it,
+// maybe because it crashed, mustn't freeze the screen. Other terminals use about the same.
+static constexpr auto synchronizedOutputTimeout = std::chrono::milliseconds{ 150 };
+
+static std::atomic<size_t> s_tracelogCount{ 0 };
+
+static int64_t s_Now() noexcept
+{
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
 RenderThread::RenderThread() :
     _pRenderer(nullptr),
     _hThread(nullptr),
     _hEvent(nullptr),
     _hPaintCompletedEvent(nullptr),
+    _hSynchronizedOutputEvent(nullptr),
     _fKeepRunning(true),
     _hPaintEnabledEvent(nullptr),
     _fNextFrameRequested(false),
     _fWaiting(false)
 {
+    if (s_tracelogCount.fetch_add(1) == 0)
+    {
+        TraceLoggingRegister(g_hRenderThreadProvider);
+    }
 }
 
 RenderThread::~RenderThread()
@@ -27,7 +61,8 @@ RenderThread::~RenderThread()
     if (_hThread)
     {
         _fKeepRunning = false; // stop loop after final run
-        EnablePainting(); // if we want to get the last frame out, we need to make sure it's enabled
+        SetEvent(_hPaintEnabledEvent); // if we want to get the last frame out, we need to make sure it's enabled
+        EndSynchronizedOutput(); // and that it isn't held back
         SignalObjectAndWait(_hEvent, _hThread, INFINITE, FALSE); // signal final paint and wait for thread to finish.
 
         CloseHandle(_hThread);
@@ -51,17 +86,30 @@ RenderThread::~RenderThread()
         CloseHandle(_hPaintCompletedEvent);
         _hPaintCompletedEvent = nullptr;
     }
+
+    if (_hSynchronizedOutputEvent)
+    {
+        CloseHandle(_hSynchronizedOutputEvent);
+        _hSynchronizedOutputEvent = nullptr;
+    }
+
+    if (s_tracelogCount.fetch_sub(1) == 1)
+    {
+        TraceLoggingUnregister(g_hRenderThreadProvider);
+    }
 }
 
 // Method Description:
-// - Create all of the Events we'll need, and the actual thread we'll be doing
-//      work on.
+// - Create all of the Events we'll need. The actual thread we'll be doing work
+//      on is only created once painting is enabled for the first time. Terminal
+//      controls that are never shown (for instance those in background tabs)
+//      thus don't hold on to an idle thread.
 // Arguments:
 // - pRendererParent: the Renderer that owns this thread, and which we should
 //      trigger frames for.
 // Return Value:
 // - S_OK if we succeeded, else an HRESULT corresponding to a failure to create
-//      an Event or Thread.
+//      an Event.
 [[nodiscard]] HRESULT RenderThread::Initialize(Renderer* const pRendererParent) noexcept
 {
     _pRenderer = pRendererParent;
@@ -122,35 +170,66 @@ RenderThread::~RenderThread()
 
     if (SUCCEEDED(hr))
     {
-        auto hThread = CreateThread(nullptr, // non-inheritable security attributes
-                                    0, // use default stack size
-                                    s_ThreadProc,
-                                    this,
-                                    0, // create immediately
-                                    nullptr // we don't need the thread ID
-        );
+        auto hSynchronizedOutputEvent = CreateEventW(nullptr,
+                                                     FALSE, // auto reset event
+                                                     FALSE, // initially unsignaled
+                                                     nullptr);
 
-        if (hThread == nullptr)
+        if (hSynchronizedOutputEvent == nullptr)
         {
             hr = HRESULT_FROM_WIN32(GetLastError());
         }
         else
         {
-            _hThread = hThread;
-
-            // SetThreadDescription only works on 1607 and higher. If we cannot find it,
-            // then it's no big deal. Just skip setting the description.
-            auto func = GetProcAddressByFunctionDeclaration(GetModuleHandleW(L"kernel32.dll"), SetThreadDescription);
-            if (func)
-            {
-                LOG_IF_FAILED(func(hThread, L"Rendering Output Thread"));
-            }
+            _hSynchronizedOutputEvent = hSynchronizedOutputEvent;
         }
     }
 
     return hr;
 }
 
+// Method Description:
+// - Creates the thread we'll be doing work on, unless that already happened.
+//   The events must have been created by Initialize() at this point.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if the thread is running, else an HRESULT corresponding to a failure
+//      to create the Thread.
+[[nodiscard]] HRESULT RenderThread::_StartThread() noexcept
+{
+    if (_fThreadStarted.exchange(true, std::memory_order_acq_rel))
+    {
+        return S_OK;
+    }
+
+    auto hThread = CreateThread(nullptr, // non-inheritable security attributes
+                                0, // use default stack size
+                                s_ThreadProc,
+                                this,
+                                0, // create immediately
+                                nullptr // we don't need the thread ID
+    );
+
+    if (hThread == nullptr)
+    {
+        _fThreadStarted.store(false, std::memory_order_release);
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    _hThread = hThread;
+
+    // SetThreadDescription only works on 1607 and higher. If we cannot find it,
+    // then it's no big deal. Just skip setting the description.
+    auto func = GetProcAddressByFunctionDeclaration(GetModuleHandleW(L"kernel32.dll"), SetThreadDescription);
+    if (func)
+    {
+        LOG_IF_FAILED(func(hThread, L"Rendering Output Thread"));
+    }
+
+    return S_OK;
+}
+
 DWORD WINAPI RenderThread::s_ThreadProc(_In_ LPVOID lpParameter)
 {
     const auto pContext = static_cast<RenderThread*>(lpParameter);
@@ -167,6 +246,8 @@ DWORD WINAPI RenderThread::s_ThreadProc(_In_ LPVOID lpParameter)
 
 DWORD WINAPI RenderThread::_ThreadProc()
 {
+    Microsoft::Console::Types::LockProfiler::SetThreadAcquirer(Microsoft::Console::Types::LockAcquirer::Render);
+
     while (_fKeepRunning)
     {
         WaitForSingleObject(_hPaintEnabledEvent, INFINITE);
@@ -208,10 +289,108 @@ DWORD WINAPI RenderThread::_ThreadProc()
             ResetEvent(_hEvent);
         }
 
+        // The frame isn't complete until the application ends its synchronized update.
+        // Everything that gets invalidated in the meantime is painted at once afterwards.
+        _WaitForSynchronizedOutput();
+
         ResetEvent(_hPaintCompletedEvent);
 
-        _pRenderer->WaitUntilCanRender();
+        // If the user recently pressed a key, this frame likely contains its echo.
+        // Such frames skip the engines' throttling to keep the typing latency low.
+        // The swap chain based engines will still block in Present() if their frame queue is full.
+        const auto inputTimestamp = _inputTimestamp.load(std::memory_order_acquire);
+        const auto inputAge = std::chrono::steady_clock::duration{ s_Now() - inputTimestamp };
+        const auto lowLatency = inputTimestamp != 0 && inputAge < lowLatencyWindow;
+        // Frames before the echo arrived only contain things like the cursor being turned
+        // on after the key press. The first one with new text is most likely the echo.
+        const auto echo = lowLatency && _textChangedSinceInput.exchange(false, std::memory_order_acq_rel);
+
+        if (inputTimestamp != 0 && !lowLatency)
+        {
+            // The key press is stale. Only reset it if no other key press happened in the meantime.
+            _textChangedSinceInput.store(false, std::memory_order_relaxed);
+            auto expected = inputTimestamp;
+            _inputTimestamp.compare_exchange_strong(expected, 0, std::memory_order_relaxed);
+        }
+
+        if (!lowLatency)
+        {
+            _pRenderer->WaitUntilCanRender();
+        }
+
+        // Any invalidation up until now is part of the frame we're about to paint,
+        // because PaintFrame() only collects them once it acquired the console lock.
+        // There's no need to paint another frame for the requests we got while waiting.
+        _fNextFrameRequested.store(false, std::memory_order_release);
+
+        const auto tracing = TraceLoggingProviderEnabled(g_hRenderThreadProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE);
+        if (tracing)
+        {
+            // Every frame is an activity of its own, which the Present() events inherit.
+            // It's related to the output that requested it, see _TraceNotifyPaint().
+            GUID related{};
+            {
+                const auto guard = _frameActivityLock.lock_exclusive();
+                related = std::exchange(_frameRelatedActivity, GUID{});
+            }
+            GUID frame{};
+            EventActivityIdControl(EVENT_ACTIVITY_CTRL_CREATE_SET_ID, &frame);
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446 26447) // We don't control TraceLoggingWrite
+            TraceLoggingWriteActivity(g_hRenderThreadProvider,
+                                      "PaintFrame",
+                                      nullptr,
+                                      related == GUID{} ? nullptr : &related,
+                                      TraceLoggingOpcode(WINEVENT_OPCODE_START),
+                                      TraceLoggingGuid(related, "Chunk"),
+                                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+        }
+
+        const auto paintStart = std::chrono::steady_clock::now();
         LOG_IF_FAILED(_pRenderer->PaintFrame());
+        const auto paintDuration = std::chrono::steady_clock::now() - paintStart;
+        if (paintDuration > frameBudget)
+        {
+            _lateFrames.fetch_add(1, std::memory_order_relaxed);
+        }
+        const auto step = gsl::narrow_cast<size_t>(paintDuration / FrameStatistics::FrameTimeStep);
+        til::at(_frameTimes, std::min(step, _frameTimes.size() - 1)).fetch_add(1, std::memory_order_relaxed);
+
+        if (tracing)
+        {
+#pragma warning(suppress : 26477 26485 26494 26482 26446 26447) // We don't control TraceLoggingWrite
+            TraceLoggingWrite(g_hRenderThreadProvider,
+                              "PaintFrame",
+                              TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+                              TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                              TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+        }
+
+        if (echo)
+        {
+            // The echo is on the screen now. If the key press causes a lot more output
+            // (for instance Enter after "cat"), the frames after this one are paced normally.
+            auto expected = inputTimestamp;
+            _inputTimestamp.compare_exchange_strong(expected, 0, std::memory_order_relaxed);
+        }
+
+        if (echo)
+        {
+            const auto latency = std::chrono::steady_clock::duration{ s_Now() - inputTimestamp };
+            const auto latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+            _inputLatencyUs.store(latencyUs, std::memory_order_relaxed);
+
+            if (TraceLoggingProviderEnabled(g_hRenderThreadProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
+            {
+#pragma warning(suppress : 26477 26485 26494 26482 26446 26447) // We don't control TraceLoggingWrite
+                TraceLoggingWrite(g_hRenderThreadProvider,
+                                  "InputToPresentLatency",
+                                  TraceLoggingInt64(latencyUs, "latencyUs"),
+                                  TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                                  TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+            }
+        }
 
         SetEvent(_hPaintCompletedEvent);
     }
@@ -219,8 +398,82 @@ DWORD WINAPI RenderThread::_ThreadProc()
     return S_OK;
 }
 
+// Method Description:
+// - Called when an application begins a synchronized update (DECSET 2026).
+//   Frames are held back until EndSynchronizedOutput() is called, or until
+//   synchronizedOutputTimeout passed, whichever happens first. Beginning
+//   another update while one is in progress extends the timeout.
+void RenderThread::BeginSynchronizedOutput() noexcept
+{
+    const auto timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(synchronizedOutputTimeout);
+    _synchronizedOutputDeadline.store(s_Now() + timeout.count(), std::memory_order_release);
+}
+
+// Method Description:
+// - Called when an application ends its synchronized update (DECRST 2026).
+//   The frame that was held back is painted right away.
+void RenderThread::EndSynchronizedOutput() noexcept
+{
+    if (_synchronizedOutputDeadline.exchange(0, std::memory_order_acq_rel) != 0)
+    {
+        if (_hSynchronizedOutputEvent)
+        {
+            SetEvent(_hSynchronizedOutputEvent);
+        }
+        NotifyPaint();
+    }
+}
+
+// Method Description:
+// - Blocks the render thread while a synchronized update is in progress.
+void RenderThread::_WaitForSynchronizedOutput() noexcept
+{
+    for (;;)
+    {
+        const auto deadline = _synchronizedOutputDeadline.load(std::memory_order_acquire);
+        const auto remaining = std::chrono::steady_clock::duration{ deadline - s_Now() };
+        if (deadline == 0 || remaining <= std::chrono::steady_clock::duration::zero())
+        {
+            return;
+        }
+
+        // Round up, so that we don't spin for the last fraction of a millisecond.
+        const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+        WaitForSingleObject(_hSynchronizedOutputEvent, gsl::narrow_cast<DWORD>(timeout));
+    }
+}
+
+// Method Description:
+// - Fills in the statistics that are tracked by the thread: the late frames,
+//   the frame times, the input latency and the CPU time used. Meant for
+//   benchmarks, which call this once the output they're measuring has been
+//   painted, and the performance overlay. All of it is read without a lock.
+void RenderThread::GetFrameStatistics(FrameStatistics& statistics) const noexcept
+{
+    statistics.late = _lateFrames.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < _frameTimes.size(); ++i)
+    {
+        til::at(statistics.frameTimes, i) = til::at(_frameTimes, i).load(std::memory_order_relaxed);
+    }
+    statistics.inputLatency = std::chrono::microseconds{ _inputLatencyUs.load(std::memory_order_relaxed) };
+    statistics.cpuTime = {};
+
+    FILETIME creation, exit, kernel, user;
+    if (_fThreadStarted.load(std::memory_order_acquire) && _hThread && GetThreadTimes(_hThread, &creation, &exit, &kernel, &user))
+    {
+        // FILETIMEs count in 100ns units.
+        const auto ticks = (uint64_t{ kernel.dwHighDateTime } << 32 | kernel.dwLowDateTime) + (uint64_t{ user.dwHighDateTime } << 32 | user.dwLowDateTime);
+        statistics.cpuTime = std::chrono::nanoseconds{ ticks * 100 };
+    }
+}
+
 void RenderThread::NotifyPaint() noexcept
 {
+    if (TraceLoggingProviderEnabled(g_hRenderThreadProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
+    {
+        _TraceNotifyPaint();
+    }
+
     if (_fWaiting.load(std::memory_order_acquire))
     {
         SetEvent(_hEvent);
@@ -231,8 +484,61 @@ void RenderThread::NotifyPaint() noexcept
     }
 }
 
+// Method Description:
+// - Logs the request for a frame. The event carries the activity ID of the calling
+//   thread, which is the one of the output being written, if any. The first such
+//   ID since the last frame is remembered, to relate the next frame to it.
+void RenderThread::_TraceNotifyPaint() noexcept
+{
+    GUID activity{};
+    EventActivityIdControl(EVENT_ACTIVITY_CTRL_GET_ID, &activity);
+    if (activity != GUID{})
+    {
+        const auto guard = _frameActivityLock.lock_exclusive();
+        if (_frameRelatedActivity == GUID{})
+        {
+            _frameRelatedActivity = activity;
+        }
+    }
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446 26447) // We don't control TraceLoggingWrite
+    TraceLoggingWrite(g_hRenderThreadProvider,
+                      "NotifyPaint",
+                      TraceLoggingGuid(activity, "Chunk"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+}
+
+// Method Description:
+// - Notifies us that the user pressed a key. Frames painted shortly afterwards
+//   will skip the throttling, until the first one that contains the key's echo.
+//   The time between the key press and the PaintFrame() of that frame is logged
+//   to ETW as the key-to-photon latency.
+// - This doesn't request a frame by itself. The echo will do that once it arrives.
+void RenderThread::NotifyInput() noexcept
+{
+    // Keep the timestamp of the first key press that hasn't been presented yet.
+    int64_t expected = 0;
+    _inputTimestamp.compare_exchange_strong(expected, s_Now(), std::memory_order_release, std::memory_order_relaxed);
+}
+
+// Method Description:
+// - Notifies us that the text in the viewport changed, which after a key
+//   press is most likely its echo. See NotifyInput().
+void RenderThread::NotifyTextChanged() noexcept
+{
+    // This is called for every write, so avoid dirtying the cache line if there's nothing to do.
+    if (_inputTimestamp.load(std::memory_order_relaxed) != 0 && !_textChangedSinceInput.load(std::memory_order_relaxed))
+    {
+        _textChangedSinceInput.store(true, std::memory_order_release);
+    }
+}
+
 void RenderThread::EnablePainting() noexcept
 {
+    // Frames requested until now are remembered in _fNextFrameRequested,
+    // so the thread will paint them as soon as it starts.
+    LOG_IF_FAILED(_StartThread());
     SetEvent(_hPaintEnabledEvent);
 }
 
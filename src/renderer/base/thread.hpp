@@ -18,6 +18,23 @@ namespace Microsoft::Console::Render
 {
     class Renderer;
 
+    struct FrameStatistics
+    {
+        // The number of frames that were presented.
+        uint64_t presented = 0;
+        // The number of frames that took longer to paint than a refresh at 60 Hz.
+        // Each of them made the screen miss at least one update.
+        uint64_t late = 0;
+        // The CPU time the render thread used so far.
+        std::chrono::nanoseconds cpuTime{};
+        // A histogram of the time it took to paint the frames, in steps of
+        // FrameTimeStep. The last entry counts all frames that took longer.
+        static constexpr std::chrono::microseconds FrameTimeStep{ 250 };
+        std::array<uint32_t, 128> frameTimes{};
+        // The time from the most recent key press until its echo was painted.
+        std::chrono::microseconds inputLatency{};
+    };
+
     class RenderThread
     {
     public:
@@ -27,24 +44,46 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT Initialize(Renderer* const pRendererParent) noexcept;
 
         void NotifyPaint() noexcept;
+        void NotifyInput() noexcept;
+        void NotifyTextChanged() noexcept;
+        void BeginSynchronizedOutput() noexcept;
+        void EndSynchronizedOutput() noexcept;
         void EnablePainting() noexcept;
         void DisablePainting() noexcept;
         void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) noexcept;
+        void GetFrameStatistics(FrameStatistics& statistics) const noexcept;
 
     private:
         static DWORD WINAPI s_ThreadProc(_In_ LPVOID lpParameter);
         DWORD WINAPI _ThreadProc();
+        [[nodiscard]] HRESULT _StartThread() noexcept;
+        void _TraceNotifyPaint() noexcept;
+        void _WaitForSynchronizedOutput() noexcept;
 
         HANDLE _hThread;
         HANDLE _hEvent;
 
         HANDLE _hPaintEnabledEvent;
         HANDLE _hPaintCompletedEvent;
+        HANDLE _hSynchronizedOutputEvent;
 
         Renderer* _pRenderer; // Non-ownership pointer
 
         bool _fKeepRunning;
+        std::atomic<bool> _fThreadStarted{ false };
         std::atomic<bool> _fNextFrameRequested;
         std::atomic<bool> _fWaiting;
+        std::atomic<int64_t> _inputTimestamp{ 0 }; // steady_clock ticks of the oldest unpresented key press
+        std::atomic<bool> _textChangedSinceInput{ false };
+        std::atomic<uint64_t> _lateFrames{ 0 };
+        std::array<std::atomic<uint32_t>, std::tuple_size_v<decltype(FrameStatistics::frameTimes)>> _frameTimes{};
+        std::atomic<int64_t> _inputLatencyUs{ 0 };
+        // steady_clock ticks until which frames are held back, or 0 if the output isn't synchronized.
+        std::atomic<int64_t> _synchronizedOutputDeadline{ 0 };
+
+        // While tracing, the activity ID of the first output that requested
+        // the next frame. The frame's events are related to it.
+        wil::srwlock _frameActivityLock;
+        GUID _frameRelatedActivity{};
     };
 }
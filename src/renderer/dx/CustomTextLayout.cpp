@@ -400,8 +400,10 @@ CATCH_RETURN()
             return S_OK;
         }
 
-        std::vector<DWRITE_SHAPING_TEXT_PROPERTIES> textProps(textLength);
-        std::vector<DWRITE_SHAPING_GLYPH_PROPERTIES> glyphProps(maxGlyphCount);
+        // These are only needed for the duration of the GetGlyphs/GetGlyphPlacements calls,
+        // but are kept around as members so that their capacity is reused across runs and lines.
+        _textProps.resize(textLength);
+        _glyphProps.resize(maxGlyphCount);
 
         // Get the features to apply to the font
         const auto& features = _fontRenderData->DefaultFontFeatures();
@@ -432,9 +434,9 @@ CATCH_RETURN()
                 1, // featureCount
                 maxGlyphCount, // maxGlyphCount
                 &_glyphClusters.at(textStart),
-                &textProps.at(0),
+                &_textProps.at(0),
                 &_glyphIndices.at(glyphStart),
-                &glyphProps.at(0),
+                &_glyphProps.at(0),
                 &actualGlyphCount);
             tries++;
 
@@ -444,7 +446,7 @@ CATCH_RETURN()
                 maxGlyphCount = _EstimateGlyphCount(maxGlyphCount);
                 const auto totalGlyphsArrayCount = glyphStart + maxGlyphCount;
 
-                glyphProps.resize(maxGlyphCount);
+                _glyphProps.resize(maxGlyphCount);
                 _glyphIndices.resize(totalGlyphsArrayCount);
             }
             else
@@ -466,10 +468,10 @@ CATCH_RETURN()
         hr = _fontRenderData->Analyzer()->GetGlyphPlacements(
             &_text.at(textStart),
             &_glyphClusters.at(textStart),
-            &textProps.at(0),
+            &_textProps.at(0),
             textLength,
             &_glyphIndices.at(glyphStart),
-            &glyphProps.at(0),
+            &_glyphProps.at(0),
             actualGlyphCount,
             run.fontFace.Get(),
             fontSize,
@@ -1423,6 +1425,13 @@ static constexpr bool _IsBoxDrawingCharacter(const wchar_t wch)
 [[nodiscard]] HRESULT STDMETHODCALLTYPE CustomTextLayout::_CorrectBoxDrawing() noexcept
 try
 {
+    // Most lines contain no box drawing characters at all,
+    // in which case there are no runs to split or reorder.
+    if (std::none_of(_text.cbegin(), _text.cend(), _IsBoxDrawingCharacter))
+    {
+        return S_OK;
+    }
+
     RETURN_IF_FAILED(_AnalyzeBoxDrawing(this, 0, gsl::narrow<UINT32>(_text.size())));
     _OrderRuns();
     return S_OK;
@@ -196,6 +196,10 @@ namespace Microsoft::Console::Render
 
         std::vector<float> _glyphAdvances;
 
+        // Scratch buffers for the complex shaping path in _ShapeGlyphRun.
+        std::vector<DWRITE_SHAPING_TEXT_PROPERTIES> _textProps;
+        std::vector<DWRITE_SHAPING_GLYPH_PROPERTIES> _glyphProps;
+
         struct ScaleCorrection
         {
             UINT32 textIndex;
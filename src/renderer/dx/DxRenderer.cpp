@@ -167,6 +167,18 @@ DxEngine::~DxEngine()
     return _EnableDisplayAccess(false);
 }
 
+// Routine Description:
+// - Releases the device resources, including the swap chain. They're
+//   recreated by the next StartPaint, as if the device had been lost.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void DxEngine::ReleaseResources() noexcept
+{
+    _ReleaseDeviceResources();
+}
+
 // Routine Description:
 // - Helper to enable/disable painting/display access/presentation in a unified
 //   manner between enable/disable functions.
@@ -315,6 +327,32 @@ std::string DxEngine::_LoadPixelShaderFile() const
     return std::string{};
 }
 
+// Routine Description:
+// - Checks whether a compiled shader actually reads the given constant buffer variable.
+// Arguments:
+// - blob - Compiled shader
+// - name - Name of the variable
+// Return Value:
+// - true if the variable exists and is referenced by the shader code.
+//   If the shader can't be reflected, true is returned to err on the safe side.
+static bool _ShaderUsesVariable(ID3DBlob* blob, const char* name) noexcept
+{
+    Microsoft::WRL::ComPtr<ID3D11ShaderReflection> reflection;
+    if (FAILED_LOG(D3DReflect(blob->GetBufferPointer(), blob->GetBufferSize(), IID_PPV_ARGS(&reflection))))
+    {
+        return true;
+    }
+
+    // GetVariableByName returns a dummy object whose GetDesc fails for unknown names.
+    D3D11_SHADER_VARIABLE_DESC desc{};
+    if (FAILED(reflection->GetVariableByName(name)->GetDesc(&desc)))
+    {
+        return false;
+    }
+
+    return WI_IsFlagSet(desc.uFlags, D3D_SVF_USED);
+}
+
 // Routine Description:
 // - Setup D3D objects for doing shader things for terminal effects.
 // Arguments:
@@ -398,6 +436,11 @@ HRESULT DxEngine::_SetupTerminalEffects()
         return exceptionHr;
     }
 
+    // Only shaders that read the Time constant are animated and need to be
+    // re-run on every frame. Everything else looks the same until the
+    // terminal contents change, so the render thread may go to sleep.
+    _pixelShaderUsesTime = _ShaderUsesVariable(pixelBlob.Get(), "Time");
+
     RETURN_IF_FAILED(_d3dDevice->CreateVertexShader(
         vertexBlob->GetBufferPointer(),
         vertexBlob->GetBufferSize(),
@@ -1388,7 +1431,12 @@ try
 
         if (SUCCEEDED(hr))
         {
-            if (_invalidScroll != til::point{ 0, 0 })
+            // Pass the dirty rectangles to Present1 on every frame and not just when scrolling.
+            // That way DWM (and remote desktop) only need to update the parts of the window that
+            // actually changed, for instance just the cell of a blinking cursor.
+            // If everything was invalidated, the area outside of the cells might have changed
+            // as well (for instance the background color), so we present the whole frame instead.
+            if (!_allInvalid && !_FullRepaintNeeded())
             {
                 // Copy `til::rects` into RECT map.
                 _presentDirty.assign(_invalidMap.begin(), _invalidMap.end());
@@ -1398,24 +1446,6 @@ try
                     return rc.scale_up(_fontRenderData->GlyphCell());
                 });
 
-                // Invalid scroll is in characters, convert it to pixels.
-                const auto scrollPixels = (_invalidScroll * _fontRenderData->GlyphCell());
-
-                // The scroll rect is the entire field of cells, but in pixels.
-                til::rect scrollArea{ _invalidMap.size() * _fontRenderData->GlyphCell() };
-
-                // Reduce the size of the rectangle by the scroll.
-                scrollArea.left = std::clamp(scrollArea.left + scrollPixels.x, scrollArea.left, scrollArea.right);
-                scrollArea.top = std::clamp(scrollArea.top + scrollPixels.y, scrollArea.top, scrollArea.bottom);
-                scrollArea.right = std::clamp(scrollArea.right + scrollPixels.x, scrollArea.left, scrollArea.right);
-                scrollArea.bottom = std::clamp(scrollArea.bottom + scrollPixels.y, scrollArea.top, scrollArea.bottom);
-
-                // Assign the area to the present storage
-                _presentScroll = scrollArea.to_win32_rect();
-
-                // Pass the offset.
-                _presentOffset = scrollPixels.to_win32_point();
-
                 // Now fill up the parameters structure from the member variables.
                 _presentParams.DirtyRectsCount = gsl::narrow<UINT>(_presentDirty.size());
 
@@ -1425,15 +1455,36 @@ try
 #pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
                 _presentParams.pDirtyRects = reinterpret_cast<RECT*>(_presentDirty.data());
 
-                _presentParams.pScrollOffset = &_presentOffset;
-                _presentParams.pScrollRect = &_presentScroll;
-
-                // The scroll rect will be empty if we scrolled >= 1 full screen size.
-                // Present1 doesn't like that. So clear it out. Everything will be dirty anyway.
-                if (IsRectEmpty(&_presentScroll))
+                if (_invalidScroll != til::point{ 0, 0 })
                 {
-                    _presentParams.pScrollRect = nullptr;
-                    _presentParams.pScrollOffset = nullptr;
+                    // Invalid scroll is in characters, convert it to pixels.
+                    const auto scrollPixels = (_invalidScroll * _fontRenderData->GlyphCell());
+
+                    // The scroll rect is the entire field of cells, but in pixels.
+                    til::rect scrollArea{ _invalidMap.size() * _fontRenderData->GlyphCell() };
+
+                    // Reduce the size of the rectangle by the scroll.
+                    scrollArea.left = std::clamp(scrollArea.left + scrollPixels.x, scrollArea.left, scrollArea.right);
+                    scrollArea.top = std::clamp(scrollArea.top + scrollPixels.y, scrollArea.top, scrollArea.bottom);
+                    scrollArea.right = std::clamp(scrollArea.right + scrollPixels.x, scrollArea.left, scrollArea.right);
+                    scrollArea.bottom = std::clamp(scrollArea.bottom + scrollPixels.y, scrollArea.top, scrollArea.bottom);
+
+                    // Assign the area to the present storage
+                    _presentScroll = scrollArea.to_win32_rect();
+
+                    // Pass the offset.
+                    _presentOffset = scrollPixels.to_win32_point();
+
+                    _presentParams.pScrollOffset = &_presentOffset;
+                    _presentParams.pScrollRect = &_presentScroll;
+
+                    // The scroll rect will be empty if we scrolled >= 1 full screen size.
+                    // Present1 doesn't like that. So clear it out. Everything will be dirty anyway.
+                    if (IsRectEmpty(&_presentScroll))
+                    {
+                        _presentParams.pScrollRect = nullptr;
+                        _presentParams.pScrollOffset = nullptr;
+                    }
                 }
             }
 
@@ -1489,17 +1540,15 @@ CATCH_RETURN()
 [[nodiscard]] bool DxEngine::RequiresContinuousRedraw() noexcept
 {
     // We're only going to request continuous redraw if someone is using
-    // a pixel shader from a path because we cannot tell if those are using the
-    // time parameter or not.
-    // And if they are using time, they probably need it to tick continuously.
-    //
-    // By contrast, the in-built retro effect does NOT need it,
-    // so let's not tick for it and save some amount of performance.
+    // a pixel shader that reads the time parameter, since those probably
+    // need it to tick continuously. Static shaders (including the in-built
+    // retro effect) only need to run again when the contents change.
+    // The frame rate of animated shaders is still capped by WaitUntilCanRender.
     //
     // Finally... if we're not using effects at all... let the render thread
     // go to sleep. It deserves it. That thread works hard. Also it sleeping
     // saves battery power and all sorts of related perf things.
-    return _terminalEffectsEnabled && !_pixelShaderPath.empty();
+    return _terminalEffectsEnabled && _pixelShaderLoaded && _pixelShaderUsesTime;
 }
 
 // Method Description:
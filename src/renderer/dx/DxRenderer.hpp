@@ -56,6 +56,8 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]] HRESULT SetWindowSize(const til::size pixels) noexcept override;
 
+        void ReleaseResources() noexcept override;
+
         void SetCallback(std::function<void()> pfn) noexcept override;
         void SetWarningCallback(std::function<void(const HRESULT)> pfn) noexcept override;
 
@@ -245,6 +247,7 @@ namespace Microsoft::Console::Render
         //  Allows user to load a pixel shader from a few presets or from a file path
         std::wstring _pixelShaderPath;
         bool _pixelShaderLoaded{ false };
+        bool _pixelShaderUsesTime{ false };
 
         std::chrono::steady_clock::time_point _shaderStartTime;
 
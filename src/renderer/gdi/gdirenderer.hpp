@@ -149,6 +149,28 @@ namespace Microsoft::Console::Render
         FontType _lastFontType;
         bool _fontHasWesternScript = false;
 
+        // The font and colors a run in _pPolyText is drawn with. They're only
+        // applied to the DC once the runs are flushed, grouped by these keys.
+        struct PolyTextState
+        {
+            COLORREF fg;
+            COLORREF bg;
+            FontType fontType;
+
+            bool operator==(const PolyTextState& rhs) const noexcept
+            {
+                return fg == rhs.fg && bg == rhs.bg && fontType == rhs.fontType;
+            }
+
+            bool operator<(const PolyTextState& rhs) const noexcept
+            {
+                return std::tie(fontType, fg, bg) < std::tie(rhs.fontType, rhs.fg, rhs.bg);
+            }
+        };
+        PolyTextState _nextPolyTextState{};
+        PolyTextState _polyTextStates[s_cPolyTextCache]{};
+        [[nodiscard]] HRESULT _ApplyPolyTextState(const PolyTextState& state) noexcept;
+
         XFORM _currentLineTransform;
         LineRendition _currentLineRendition;
 
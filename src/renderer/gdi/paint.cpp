@@ -81,6 +81,36 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
     // If we don't have any scrolling to do, return early.
     RETURN_HR_IF(S_OK, 0 == _szInvalidScroll.cx && 0 == _szInvalidScroll.cy);
 
+    // We have to limit the region that can be scrolled to not include the gutters.
+    // Gutters are defined as sub-character width pixels at the bottom or right of the screen.
+    const auto coordFontSize = _GetFontSize();
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), coordFontSize.X == 0 || coordFontSize.Y == 0);
+
+    til::size szGutter;
+    szGutter.cx = _szMemorySurface.cx % coordFontSize.X;
+    szGutter.cy = _szMemorySurface.cy % coordFontSize.Y;
+
+    RECT rcScrollLimit{};
+    RETURN_IF_FAILED(LongSub(_szMemorySurface.cx, szGutter.cx, &rcScrollLimit.right));
+    RETURN_IF_FAILED(LongSub(_szMemorySurface.cy, szGutter.cy, &rcScrollLimit.bottom));
+
+    // If the scroll distance exceeds the scrollable area or if the invalid area already covers
+    // all of it, nothing of the retained frame survives the scroll. Scrolling the window would
+    // then only move pixels that get overwritten right after, which is particularly costly
+    // in remote sessions. The whole frame gets repainted instead, which also paints over
+    // any inverted cursor, so the cursorInvertRects don't need to be cleaned up either.
+    if (std::abs(_szInvalidScroll.cx) >= rcScrollLimit.right ||
+        std::abs(_szInvalidScroll.cy) >= rcScrollLimit.bottom ||
+        (_fInvalidRectUsed && _rcInvalid.contains(til::rect{ rcScrollLimit })))
+    {
+        cursorInvertRects.clear();
+
+        const til::rect rcAll{ _szMemorySurface };
+        LOG_IF_FAILED(_InvalidCombine(&rcAll));
+        _psInvalidData.rcPaint = _rcInvalid.to_win32_rect();
+        return S_OK;
+    }
+
     // If we have an inverted cursor, we have to see if we have to clean it before we scroll to prevent
     // left behind cursor copies in the scrolled region.
     if (cursorInvertRects.size() > 0)
@@ -112,19 +142,6 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
         cursorInvertRects.clear();
     }
 
-    // We have to limit the region that can be scrolled to not include the gutters.
-    // Gutters are defined as sub-character width pixels at the bottom or right of the screen.
-    const auto coordFontSize = _GetFontSize();
-    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), coordFontSize.X == 0 || coordFontSize.Y == 0);
-
-    til::size szGutter;
-    szGutter.cx = _szMemorySurface.cx % coordFontSize.X;
-    szGutter.cy = _szMemorySurface.cy % coordFontSize.Y;
-
-    RECT rcScrollLimit{};
-    RETURN_IF_FAILED(LongSub(_szMemorySurface.cx, szGutter.cx, &rcScrollLimit.right));
-    RETURN_IF_FAILED(LongSub(_szMemorySurface.cy, szGutter.cy, &rcScrollLimit.bottom));
-
     // Scroll real window and memory buffer in-sync.
     LOG_LAST_ERROR_IF(!ScrollWindowEx(_hwndTargetWindow,
                                       _szInvalidScroll.cx,
@@ -306,7 +323,7 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
 
 // Routine Description:
 // - Draws one line of the buffer to the screen.
-// - This will now be cached in a PolyText buffer and flushed periodically instead of drawing every individual segment. Note this means that the PolyText buffer must be flushed before some operations (changing the brush color, drawing lines on top of the characters, inverting for cursor/selection, etc.)
+// - This will now be cached in a PolyText buffer and flushed periodically instead of drawing every individual segment. Note this means that the PolyText buffer must be flushed before some operations (changing the line transform, drawing lines on top of the characters, inverting for cursor/selection, etc.)
 // Arguments:
 // - clusters - text to be written and columns expected per cluster
 // - coord - character coordinate target to render within viewport
@@ -347,7 +364,7 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
         polyWidth.reserve(cchLine);
 
         // If we have a soft font, we only use the character's lower 7 bits.
-        const auto softFontCharMask = _lastFontType == FontType::Soft ? L'\x7F' : ~0;
+        const auto softFontCharMask = _nextPolyTextState.fontType == FontType::Soft ? L'\x7F' : ~0;
 
         // Sum up the total widths the entire line/run is expected to take while
         // copying the pixel widths into a structure to direct GDI how many pixels to use per character.
@@ -427,6 +444,7 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
             pPolyTextLine->rcl.left += coordFontSize.X;
         }
 
+        _polyTextStates[_cPolyText] = _nextPolyTextState;
         _cPolyText++;
 
         if (_cPolyText >= s_cPolyTextCache)
@@ -452,46 +470,79 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
 
     if (_cPolyText > 0)
     {
-        for (size_t i = 0; i != _cPolyText; ++i)
+        // Group the runs by their font and colors, so that the DC state only needs to be switched once
+        // per group and all simple runs of a group can be drawn with a single PolyTextOutW() call.
+        // Since every run is clipped to its own, non-overlapping rectangle, the draw order doesn't matter.
+        std::array<size_t, s_cPolyTextCache> order{};
+        std::iota(order.begin(), order.begin() + _cPolyText, size_t{ 0 });
+        std::stable_sort(order.begin(), order.begin() + _cPolyText, [&](const size_t a, const size_t b) noexcept {
+            return til::at(_polyTextStates, a) < til::at(_polyTextStates, b);
+        });
+
+        std::array<POLYTEXTW, s_cPolyTextCache> batch{};
+        size_t groupEnd = 0;
+
+        for (size_t i = 0; i != _cPolyText && SUCCEEDED(hr); i = groupEnd)
         {
-            const auto& t = _pPolyText[i];
-
-            // The following if/else replicates the essentials of how ExtTextOutW() without ETO_IGNORELANGUAGE works.
-            // See InternalTextOut().
-            //
-            // Unlike the original, we don't check for `GetTextCharacterExtra(hdc) != 0`,
-            // because we don't ever call SetTextCharacterExtra() anyways.
-            //
-            // GH#12294:
-            // Additionally we set ss.fOverrideDirection to TRUE, because we need to present RTL
-            // text in logical order in order to be compatible with applications like `vim -H`.
-            if (_fontHasWesternScript && ScriptIsComplex(t.lpstr, t.n, SIC_COMPLEX) == S_FALSE)
+            const auto& state = til::at(_polyTextStates, til::at(order, i));
+
+            groupEnd = i + 1;
+            while (groupEnd != _cPolyText && til::at(_polyTextStates, til::at(order, groupEnd)) == state)
             {
-                if (!ExtTextOutW(_hdcMemoryContext, t.x, t.y, t.uiFlags | ETO_IGNORELANGUAGE, &t.rcl, t.lpstr, t.n, t.pdx))
-                {
-                    hr = E_FAIL;
-                    break;
-                }
+                ++groupEnd;
             }
-            else
+
+            hr = _ApplyPolyTextState(state);
+            if (FAILED(hr))
             {
-                SCRIPT_STATE ss{};
-                ss.fOverrideDirection = TRUE;
+                break;
+            }
 
-                SCRIPT_STRING_ANALYSIS ssa;
-                hr = ScriptStringAnalyse(_hdcMemoryContext, t.lpstr, t.n, 0, -1, SSA_GLYPHS | SSA_FALLBACK, 0, nullptr, &ss, t.pdx, nullptr, nullptr, &ssa);
-                if (FAILED(hr))
+            size_t batchSize = 0;
+            for (auto j = i; j != groupEnd; ++j)
+            {
+                const auto& t = til::at(_pPolyText, til::at(order, j));
+
+                // The following if/else replicates the essentials of how ExtTextOutW() without ETO_IGNORELANGUAGE works.
+                // See InternalTextOut().
+                //
+                // Unlike the original, we don't check for `GetTextCharacterExtra(hdc) != 0`,
+                // because we don't ever call SetTextCharacterExtra() anyways.
+                //
+                // GH#12294:
+                // Additionally we set ss.fOverrideDirection to TRUE, because we need to present RTL
+                // text in logical order in order to be compatible with applications like `vim -H`.
+                if (_fontHasWesternScript && ScriptIsComplex(t.lpstr, t.n, SIC_COMPLEX) == S_FALSE)
                 {
-                    break;
+                    auto& b = til::at(batch, batchSize++);
+                    b = t;
+                    b.uiFlags |= ETO_IGNORELANGUAGE;
                 }
-
-                hr = ScriptStringOut(ssa, t.x, t.y, t.uiFlags, &t.rcl, 0, 0, FALSE);
-                std::ignore = ScriptStringFree(&ssa);
-                if (FAILED(hr))
+                else
                 {
-                    break;
+                    SCRIPT_STATE ss{};
+                    ss.fOverrideDirection = TRUE;
+
+                    SCRIPT_STRING_ANALYSIS ssa;
+                    hr = ScriptStringAnalyse(_hdcMemoryContext, t.lpstr, t.n, 0, -1, SSA_GLYPHS | SSA_FALLBACK, 0, nullptr, &ss, t.pdx, nullptr, nullptr, &ssa);
+                    if (FAILED(hr))
+                    {
+                        break;
+                    }
+
+                    hr = ScriptStringOut(ssa, t.x, t.y, t.uiFlags, &t.rcl, 0, 0, FALSE);
+                    std::ignore = ScriptStringFree(&ssa);
+                    if (FAILED(hr))
+                    {
+                        break;
+                    }
                 }
             }
+
+            if (SUCCEEDED(hr) && batchSize != 0 && !PolyTextOutW(_hdcMemoryContext, batch.data(), gsl::narrow_cast<int>(batchSize)))
+            {
+                hr = E_FAIL;
+            }
         }
 
         _polyStrings.clear();
@@ -269,24 +269,11 @@ GdiEngine::~GdiEngine()
                                                       const bool usingSoftFont,
                                                       const bool isSettingDefaultBrushes) noexcept
 {
-    RETURN_IF_FAILED(_FlushBufferLines());
-
     RETURN_HR_IF_NULL(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), _hdcMemoryContext);
 
     // Set the colors for painting text
     const auto [colorForeground, colorBackground] = renderSettings.GetAttributeColors(textAttributes);
 
-    if (colorForeground != _lastFg)
-    {
-        RETURN_HR_IF(E_FAIL, CLR_INVALID == SetTextColor(_hdcMemoryContext, colorForeground));
-        _lastFg = colorForeground;
-    }
-    if (colorBackground != _lastBg)
-    {
-        RETURN_HR_IF(E_FAIL, CLR_INVALID == SetBkColor(_hdcMemoryContext, colorBackground));
-        _lastBg = colorBackground;
-    }
-
     if (isSettingDefaultBrushes)
     {
         // Set the color for painting the extra DC background area
@@ -296,11 +283,41 @@ GdiEngine::~GdiEngine()
         RETURN_IF_FAILED(s_SetWindowLongWHelper(_hwndTargetWindow, GWL_CONSOLE_BKCOLOR, colorBackground));
     }
 
-    // If the font type has changed, select an appropriate font variant or soft font.
     const auto usingItalicFont = textAttributes.IsItalic();
     const auto fontType = usingSoftFont   ? FontType::Soft :
                           usingItalicFont ? FontType::Italic :
                                             FontType::Default;
+
+    // The text colors and the font aren't selected into the DC yet. Instead they're
+    // recorded for the following runs, so that _FlushBufferLines() can group the runs
+    // of an entire frame by them and switch the DC state only once per group.
+    _nextPolyTextState = { colorForeground, colorBackground, fontType };
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Selects the colors and the font variant (or soft font) of a group of
+//   cached runs into the DC, skipping anything that's already selected.
+// Arguments:
+// - state - The colors and font type recorded for the runs by UpdateDrawingBrushes.
+// Return Value:
+// - S_OK if set successfully or E_FAIL if GDI failed.
+[[nodiscard]] HRESULT GdiEngine::_ApplyPolyTextState(const PolyTextState& state) noexcept
+{
+    if (state.fg != _lastFg)
+    {
+        RETURN_HR_IF(E_FAIL, CLR_INVALID == SetTextColor(_hdcMemoryContext, state.fg));
+        _lastFg = state.fg;
+    }
+    if (state.bg != _lastBg)
+    {
+        RETURN_HR_IF(E_FAIL, CLR_INVALID == SetBkColor(_hdcMemoryContext, state.bg));
+        _lastBg = state.bg;
+    }
+
+    // If the font type has changed, select an appropriate font variant or soft font.
+    const auto fontType = state.fontType;
     if (fontType != _lastFontType)
     {
         switch (fontType)
@@ -447,6 +464,8 @@ GdiEngine::~GdiEngine()
     // If we previously called SelectFont(_hdcMemoryContext, _softFont), it will
     // still hold a reference to the _softFont object we're planning to overwrite.
     // --> First revert back to the standard _hfont, lest we have dangling pointers.
+    // Any cached runs might still be waiting to be drawn with the old soft font as well.
+    LOG_IF_FAILED(_FlushBufferLines());
     if (_lastFontType == FontType::Soft)
     {
         RETURN_HR_IF_NULL(E_FAIL, SelectFont(_hdcMemoryContext, _hfont));
@@ -21,6 +21,7 @@ Author(s):
 #include "FontInfoDesired.hpp"
 #include "IRenderData.hpp"
 #include "RenderSettings.hpp"
+#include "../../buffer/out/ImageSlice.hpp"
 #include "../../buffer/out/LineRendition.hpp"
 
 #pragma warning(push)
@@ -32,6 +33,21 @@ namespace Microsoft::Console::Render
         std::optional<CursorOptions> cursorInfo;
     };
 
+    // The counters of engines with a glyph atlas, for diagnostics.
+    struct EngineStatistics
+    {
+        // The buffer line segments that had to be shaped, because they weren't cached.
+        uint64_t shapedLines = 0;
+        // The glyphs in the atlas and the tiles they occupy out of all that fit into it.
+        uint32_t glyphs = 0;
+        uint32_t allocatedTiles = 0;
+        uint32_t tileCapacity = 0;
+        // Estimates of the memory held by the engine, in bytes: the swap chain, the atlas
+        // and the other textures and buffers on the GPU, and the caches on the CPU.
+        uint64_t gpuBytes = 0;
+        uint64_t cacheBytes = 0;
+    };
+
     class __declspec(novtable) IRenderEngine
     {
     public:
@@ -76,6 +92,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] virtual HRESULT PaintBackground() noexcept = 0;
         [[nodiscard]] virtual HRESULT PaintBufferLine(gsl::span<const Cluster> clusters, til::point coord, bool fTrimLeft, bool lineWrapped) noexcept = 0;
         [[nodiscard]] virtual HRESULT PaintBufferGridLines(GridLineSet lines, COLORREF color, size_t cchLine, til::point coordTarget) noexcept = 0;
+        [[nodiscard]] virtual HRESULT PaintImageSlice(const ImageSlice::Pointer& imageSlice, til::CoordType targetRow, til::CoordType viewportLeft) noexcept = 0;
         [[nodiscard]] virtual HRESULT PaintSelection(const til::rect& rect) noexcept = 0;
         [[nodiscard]] virtual HRESULT PaintCursor(const CursorOptions& options) noexcept = 0;
         [[nodiscard]] virtual HRESULT UpdateDrawingBrushes(const TextAttribute& textAttributes, const RenderSettings& renderSettings, gsl::not_null<IRenderData*> pData, bool usingSoftFont, bool isSettingDefaultBrushes) noexcept = 0;
@@ -96,6 +113,7 @@ namespace Microsoft::Console::Render
         virtual HRESULT Enable() noexcept { return S_OK; }
         virtual [[nodiscard]] bool GetRetroTerminalEffect() const noexcept { return false; }
         virtual [[nodiscard]] float GetScaling() const noexcept { return 1; }
+        virtual void GetStatistics(EngineStatistics& statistics) const noexcept {}
 #pragma warning(suppress : 26440) // Function '...' can be declared 'noexcept' (f.6).
         virtual [[nodiscard]] HANDLE GetSwapChainHandle()
         {
@@ -104,6 +122,7 @@ namespace Microsoft::Console::Render
         virtual [[nodiscard]] Types::Viewport GetViewportInCharacters(const Types::Viewport& viewInPixels) const noexcept { return Types::Viewport::Empty(); }
         virtual [[nodiscard]] Types::Viewport GetViewportInPixels(const Types::Viewport& viewInCharacters) const noexcept { return Types::Viewport::Empty(); }
         // DxRenderer - setter
+        virtual void ReleaseResources() noexcept {}
         virtual void SetAntialiasingMode(const D2D1_TEXT_ANTIALIAS_MODE antialiasingMode) noexcept {}
         virtual void SetCallback(std::function<void()> pfn) noexcept {}
         virtual void EnableTransparentBackground(const bool isTransparent) noexcept {}
@@ -112,6 +131,7 @@ namespace Microsoft::Console::Render
         virtual void SetPixelShaderPath(std::wstring_view value) noexcept {}
         virtual void SetRetroTerminalEffect(bool enable) noexcept {}
         virtual void SetSelectionBackground(const COLORREF color, const float alpha = 0.5f) noexcept {}
+        virtual void SetSmoothScrolling(bool enable) noexcept {}
         virtual void SetSoftwareRendering(bool enable) noexcept {}
         virtual void SetWarningCallback(std::function<void(HRESULT)> pfn) noexcept {}
         virtual [[nodiscard]] HRESULT SetWindowSize(const til::size pixels) noexcept { return E_NOTIMPL; }
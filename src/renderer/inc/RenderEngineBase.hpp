@@ -41,6 +41,10 @@ namespace Microsoft::Console::Render
                                                    const size_t targetRow,
                                                    const size_t viewportLeft) noexcept override;
 
+        [[nodiscard]] HRESULT PaintImageSlice(const ImageSlice::Pointer& imageSlice,
+                                              const til::CoordType targetRow,
+                                              const til::CoordType viewportLeft) noexcept override;
+
         [[nodiscard]] virtual bool RequiresContinuousRedraw() noexcept override;
 
         [[nodiscard]] HRESULT InvalidateFlush(_In_ const bool circled, _Out_ bool* const pForcePaint) noexcept override;
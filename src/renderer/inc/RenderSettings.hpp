@@ -44,12 +44,27 @@ namespace Microsoft::Console::Render
         void ToggleBlinkRendition(class Renderer& renderer) noexcept;
 
     private:
+        struct ColorCaches;
+
+        static uint64_t _nextCacheGeneration() noexcept;
+        static ColorCaches* _getColorCaches() noexcept;
+        std::pair<COLORREF, COLORREF> _resolveAttributeColors(const TextAttribute& attr, ColorCaches* caches) const noexcept;
+        COLORREF _getAdjustedTableColor(const size_t index) const noexcept;
+        COLORREF _getAdjustedForegroundColor(const size_t fgIndex, const size_t bgIndex, ColorCaches* caches) const noexcept;
+        COLORREF _getAdjustedRgbColor(const COLORREF fg, const COLORREF bg, ColorCaches* caches) const noexcept;
+
         til::enumset<Mode> _renderMode{ Mode::BlinkAllowed, Mode::IntenseIsBright };
         std::array<COLORREF, TextColor::TABLE_SIZE> _colorTable;
         std::array<size_t, static_cast<size_t>(ColorAlias::ENUM_COUNT)> _colorAliasIndices;
-        std::array<std::array<COLORREF, 18>, 18> _adjustedForegroundColors;
+        // The adjusted and resolved colors are cached per thread, see ColorCaches. An entry
+        // is only valid if its generation matches the one here. These are replaced on every
+        // change to the color table, and the resolved one on changes to the render modes too.
+        // They're unique across all instances, so that caches can be shared between them.
+        uint64_t _adjustedColorsGeneration = _nextCacheGeneration();
+        uint64_t _resolvedColorsGeneration = _nextCacheGeneration();
         size_t _blinkCycle = 0;
-        mutable bool _blinkIsInUse = false;
+        // GetAttributeColors is called by readers that may hold the console lock concurrently.
+        mutable std::atomic<bool> _blinkIsInUse{ false };
         bool _blinkShouldBeFaint = false;
     };
 }
@@ -10,6 +10,18 @@
 using namespace Microsoft::Console::Render;
 using namespace Microsoft::Console::Types;
 
+// The speech API is limited to 1000 characters at a time.
+static constexpr size_t sapiLimit{ 1000 };
+
+// The most text we'll queue up for a single frame. When the output is faster
+// than that, only its most recent part is worth being announced anyway.
+static constexpr size_t maxNewOutput{ 4 * sapiLimit };
+
+// By default we send at most 20 batches of events per second. Every batch makes
+// automation clients call back into us across processes, so with fast output
+// sending one per frame slows down the entire application instead.
+static constexpr unsigned int defaultMaxEventRate{ 20 };
+
 // Routine Description:
 // - Constructs a UIA engine for console text
 //   which primarily notifies automation clients of any activity
@@ -20,10 +32,36 @@ UiaEngine::UiaEngine(IUiaEventDispatcher* dispatcher) :
     _textBufferChanged{ false },
     _cursorChanged{ false },
     _isEnabled{ true },
-    _prevSelection{},
     _prevCursorRegion{},
+    _minEventInterval{},
+    _lastEventTime{},
     RenderEngineBase()
 {
+    SetMaxEventRate(defaultMaxEventRate);
+}
+
+// Routine Description:
+// - Sets the maximum number of event batches sent to automation clients per second.
+//   Events that happen in between are merged and sent with the next batch.
+// Arguments:
+// - eventsPerSecond - the maximum rate, or 0 to send the events of every frame
+// Return Value:
+// - <none>
+void UiaEngine::SetMaxEventRate(const unsigned int eventsPerSecond) noexcept
+{
+    using namespace std::chrono;
+    _minEventInterval = eventsPerSecond ? duration_cast<steady_clock::duration>(seconds(1)) / eventsPerSecond : steady_clock::duration::zero();
+}
+
+// Routine Description:
+// - Checks whether there are any events that haven't been sent yet.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the next Present() has something to send.
+bool UiaEngine::_hasPendingEvents() const noexcept
+{
+    return _selectionChanged || _textBufferChanged || _cursorChanged || !_queuedOutput.empty();
 }
 
 // Routine Description:
@@ -106,38 +144,12 @@ CATCH_RETURN();
 // - S_OK
 [[nodiscard]] HRESULT UiaEngine::InvalidateSelection(const std::vector<til::rect>& rectangles) noexcept
 {
-    // early exit: different number of rows
-    if (_prevSelection.size() != rectangles.size())
+    // The renderer only passes the rows whose selection changed,
+    // so any rectangle at all means that the selection changed.
+    if (!rectangles.empty())
     {
-        try
-        {
-            _selectionChanged = true;
-            _prevSelection = rectangles;
-        }
-        CATCH_LOG_RETURN_HR(E_FAIL);
-        return S_OK;
-    }
-
-    for (size_t i = 0; i < rectangles.size(); i++)
-    {
-        try
-        {
-            const auto prevRect = _prevSelection.at(i);
-            const auto newRect = rectangles.at(i);
-
-            // if any value is different, selection has changed
-            if (prevRect.Top != newRect.Top || prevRect.Right != newRect.Right || prevRect.Left != newRect.Left || prevRect.Bottom != newRect.Bottom)
-            {
-                _selectionChanged = true;
-                _prevSelection = rectangles;
-                return S_OK;
-            }
-        }
-        CATCH_LOG_RETURN_HR(E_FAIL);
+        _selectionChanged = true;
     }
-
-    // assume selection has not changed
-    _selectionChanged = false;
     return S_OK;
 }
 
@@ -175,6 +187,11 @@ try
     {
         _newOutput.append(newText);
         _newOutput.push_back(L'\n');
+
+        if (_newOutput.size() > maxNewOutput)
+        {
+            _newOutput.erase(0, _newOutput.size() - maxNewOutput);
+        }
     }
     return S_OK;
 }
@@ -205,7 +222,7 @@ CATCH_LOG_RETURN_HR(E_FAIL);
     RETURN_HR_IF(S_FALSE, !_isEnabled);
 
     // add more events here
-    const auto somethingToDo = _selectionChanged || _textBufferChanged || _cursorChanged || !_queuedOutput.empty();
+    const auto somethingToDo = _hasPendingEvents() || !_newOutput.empty();
 
     // If there's nothing to do, quick return
     RETURN_HR_IF(S_FALSE, !somethingToDo);
@@ -229,7 +246,24 @@ CATCH_LOG_RETURN_HR(E_FAIL);
     // so present can work on the copy while another
     // thread might start filling the next "frame"
     // worth of text data.
-    std::swap(_queuedOutput, _newOutput);
+    // Present() might have held back the previous output
+    // because of the rate limit, so it's appended to that.
+    if (_queuedOutput.empty())
+    {
+        std::swap(_queuedOutput, _newOutput);
+    }
+    else
+    {
+        try
+        {
+            _queuedOutput.append(_newOutput);
+            if (_queuedOutput.size() > maxNewOutput)
+            {
+                _queuedOutput.erase(0, _queuedOutput.size() - maxNewOutput);
+            }
+        }
+        CATCH_LOG();
+    }
     _newOutput.clear();
     return S_OK;
 }
@@ -241,6 +275,19 @@ void UiaEngine::WaitUntilCanRender() noexcept
 {
 }
 
+// Routine Description:
+// - Keeps the render thread ticking while Present() holds back events because
+//   of the rate limit. This guarantees that the last batch of events is sent
+//   even if nothing else happens afterwards.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if there are events waiting to be sent.
+[[nodiscard]] bool UiaEngine::RequiresContinuousRedraw() noexcept
+{
+    return _isEnabled && _hasPendingEvents();
+}
+
 // Routine Description:
 // - Used to perform longer running presentation steps outside the lock so the
 //      other threads can continue.
@@ -253,6 +300,17 @@ void UiaEngine::WaitUntilCanRender() noexcept
 {
     RETURN_HR_IF(S_FALSE, !_isEnabled);
 
+    _isPainting = false;
+
+    // Everything that happened until the next batch is due gets merged into it.
+    // The flags and the queued output are kept until then.
+    const auto now = std::chrono::steady_clock::now();
+    if (now - _lastEventTime < _minEventInterval)
+    {
+        return S_OK;
+    }
+    _lastEventTime = now;
+
     // Fire UIA Events here
     if (_selectionChanged)
     {
@@ -280,10 +338,8 @@ void UiaEngine::WaitUntilCanRender() noexcept
     }
     try
     {
-        // The speech API is limited to 1000 characters at a time.
         // Break up the output into 1000 character chunks to ensure
         // the output isn't cut off.
-        static constexpr size_t sapiLimit{ 1000 };
         const std::wstring_view output{ _queuedOutput };
         for (size_t offset = 0; offset < output.size(); offset += sapiLimit)
         {
@@ -295,7 +351,6 @@ void UiaEngine::WaitUntilCanRender() noexcept
     _selectionChanged = false;
     _textBufferChanged = false;
     _cursorChanged = false;
-    _isPainting = false;
     _queuedOutput.clear();
 
     return S_OK;
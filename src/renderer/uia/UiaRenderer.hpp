@@ -15,6 +15,8 @@ Author(s):
 
 #pragma once
 
+#include <chrono>
+
 #include "../../renderer/inc/RenderEngineBase.hpp"
 
 #include "../../types/IUiaEventDispatcher.h"
@@ -33,10 +35,15 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT Enable() noexcept override;
         [[nodiscard]] HRESULT Disable() noexcept;
 
+        // Limits how many batches of events per second are sent to automation clients.
+        // Events that come in faster are merged into the next batch. 0 disables the limit.
+        void SetMaxEventRate(const unsigned int eventsPerSecond) noexcept;
+
         // IRenderEngine Members
         [[nodiscard]] HRESULT StartPaint() noexcept override;
         [[nodiscard]] HRESULT EndPaint() noexcept override;
         void WaitUntilCanRender() noexcept override;
+        [[nodiscard]] bool RequiresContinuousRedraw() noexcept override;
         [[nodiscard]] HRESULT Present() noexcept override;
         [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept override;
         [[nodiscard]] HRESULT ScrollFrame() noexcept override;
@@ -75,7 +82,11 @@ namespace Microsoft::Console::Render
 
         Microsoft::Console::Types::IUiaEventDispatcher* _dispatcher;
 
-        std::vector<til::rect> _prevSelection;
         til::rect _prevCursorRegion;
+
+        std::chrono::steady_clock::duration _minEventInterval;
+        std::chrono::steady_clock::time_point _lastEventTime;
+
+        bool _hasPendingEvents() const noexcept;
     };
 }
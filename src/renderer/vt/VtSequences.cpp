@@ -97,6 +97,18 @@ using namespace Microsoft::Console::Render;
     return _WriteFormatted(FMT_COMPILE("\x1b[{}C"), chars);
 }
 
+// Method Description:
+// - Formats and writes a sequence to repeat the preceding graphic character a
+//      number of times.
+// Arguments:
+// - chars: a number of times to repeat the preceding character.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_RepeatCharacter(const til::CoordType chars) noexcept
+{
+    return _WriteFormatted(FMT_COMPILE("\x1b[{}b"), chars);
+}
+
 // Method Description:
 // - Formats and writes a sequence to erase the remainder of the line starting
 //      from the cursor position.
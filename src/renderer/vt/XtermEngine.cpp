@@ -64,6 +64,7 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         //      the screen on the first paint, just to make sure that the
         //      terminal's state is consistent with what we'll be rendering.
         RETURN_IF_FAILED(_ClearScreen());
+        _InvalidateShadow();
         _clearedAllThisFrame = true;
         _firstPaint = false;
     }
@@ -398,6 +399,8 @@ try
         RETURN_IF_FAILED(_InsertLine(absDy));
     }
 
+    _ScrollShadow(dy);
+
     // Restore our wrap state.
     _wrappedRow = oldWrappedRow;
     _delayedEolWrap = oldDelayedEolWrap;
@@ -473,6 +476,8 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT XtermEngine::InvalidateScroll(const til::point* const pcoordDelta) noexcept
 try
 {
+    RETURN_HR_IF(S_FALSE, _suppressInvalidation);
+
     const auto delta{ *pcoordDelta };
 
     if (delta != til::point{ 0, 0 })
@@ -523,6 +528,10 @@ CATCH_RETURN();
 // - S_OK or suitable HRESULT error from either conversion or writing pipe.
 [[nodiscard]] HRESULT XtermEngine::WriteTerminalW(const std::wstring_view wstr) noexcept
 {
+    // We don't know what the passed through string is going to do to the
+    // contents of the connected terminal.
+    _InvalidateShadow();
+
     RETURN_IF_FAILED(_fUseAsciiOnly ?
                          VtEngine::_WriteTerminalAscii(wstr) :
                          VtEngine::_WriteTerminalUtf8(wstr));
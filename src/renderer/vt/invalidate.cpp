@@ -49,6 +49,8 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT VtEngine::Invalidate(const til::rect* const psrRegion) noexcept
 try
 {
+    RETURN_HR_IF(S_FALSE, _suppressInvalidation);
+
     _trace.TraceInvalidate(*psrRegion);
     _invalidMap.set(*psrRegion);
     return S_OK;
@@ -63,6 +65,8 @@ CATCH_RETURN();
 // - S_OK
 [[nodiscard]] HRESULT VtEngine::InvalidateCursor(const til::rect* const psrRegion) noexcept
 {
+    RETURN_HR_IF(S_FALSE, _suppressInvalidation);
+
     // If we just inherited the cursor, we're going to get an InvalidateCursor
     //      for both where the old cursor was, and where the new cursor is
     //      (the inherited location). (See Cursor.cpp:Cursor::SetPosition)
@@ -90,6 +94,8 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::InvalidateAll() noexcept
 try
 {
+    RETURN_HR_IF(S_FALSE, _suppressInvalidation);
+
     _trace.TraceInvalidateAll(_lastViewport.ToOrigin().ToExclusive());
     _invalidMap.set_all();
     return S_OK;
@@ -107,7 +113,8 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::InvalidateFlush(_In_ const bool circled, _Out_ bool* const pForcePaint) noexcept
 {
     // If we're in the middle of a resize request, don't try to immediately start a frame.
-    if (_inResizeRequest)
+    // The same goes for when we're told to ignore all changes to the buffer.
+    if (_inResizeRequest || _suppressInvalidation)
     {
         *pForcePaint = false;
     }
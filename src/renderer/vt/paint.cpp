@@ -82,7 +82,19 @@ using namespace Microsoft::Console::Types;
         RETURN_IF_FAILED(_MoveCursor(_deferredCursorPos));
     }
 
-    RETURN_IF_FAILED(_Flush());
+    // The frame is written to the pipe in Present(), once the console lock has been
+    // released. Writing to the pipe blocks whenever the terminal falls behind.
+    // Swapping the buffers keeps their allocations around for the next frames.
+    const std::lock_guard guard{ _pipeLock };
+    if (_frameBuffer.empty())
+    {
+        _frameBuffer.swap(_buffer);
+    }
+    else
+    {
+        _frameBuffer.append(_buffer);
+        _buffer.clear();
+    }
 
     return S_OK;
 }
@@ -90,15 +102,52 @@ using namespace Microsoft::Console::Types;
 // Routine Description:
 // - Used to perform longer running presentation steps outside the lock so the
 //      other threads can continue.
-// - Not currently used by VtEngine.
+// - Writes the frame collected by EndPaint() to the pipe, in a single WriteFile.
 // Arguments:
 // - <none>
 // Return Value:
-// - S_FALSE since we do nothing.
+// - S_OK, S_FALSE if there was nothing to write, or a suitable HRESULT error from writing the pipe.
 [[nodiscard]] HRESULT VtEngine::Present() noexcept
+try
 {
-    return S_FALSE;
+    auto lock = std::unique_lock{ _pipeLock };
+
+    // The frame might've been written by a _Flush() in the meantime.
+    if (_frameBuffer.empty())
+    {
+        return S_FALSE;
+    }
+
+    const auto size = _frameBuffer.size();
+    size_t bucket = 0;
+    for (auto s = size >> 6; s != 0 && bucket != FRAME_SIZE_BUCKETS - 1; s >>= 1)
+    {
+        bucket++;
+    }
+    til::at(_frameSizeHistogram, bucket)++;
+    _trace.TraceFrameSize(size);
+
+#ifdef UNIT_TESTING
+    if (_hFile.get() == INVALID_HANDLE_VALUE)
+    {
+        _frameBuffer.clear();
+        return S_OK;
+    }
+#endif
+
+    const auto hr = _WriteToPipe(_frameBuffer);
+    lock.unlock();
+
+    // CloseOutput() acquires the console lock and must
+    // not be called while holding the _pipeLock.
+    if (FAILED(hr) && _terminalOwner)
+    {
+        _terminalOwner->CloseOutput();
+    }
+
+    return hr;
 }
+CATCH_RETURN()
 
 // Routine Description:
 // - Paints the background of the invalid area of the frame.
@@ -371,6 +420,7 @@ using namespace Microsoft::Console::Types;
 // Arguments:
 // - clusters - text and column widths to be written
 // - coord - character coordinate target to render within viewport
+// - lineWrapped - true if this run is the end of a line that wrapped.
 // Return Value:
 // - S_OK or suitable HRESULT error from writing pipe.
 [[nodiscard]] HRESULT VtEngine::_PaintUtf8BufferLine(const gsl::span<const Cluster> clusters,
@@ -382,6 +432,227 @@ using namespace Microsoft::Console::Types;
         return S_OK;
     }
 
+    if (_frameDiff)
+    {
+        return _PaintUtf8BufferLineDiff(clusters, coord, lineWrapped);
+    }
+
+    return _PaintUtf8Run(clusters, coord, lineWrapped);
+}
+
+// Routine Description:
+// - Frame-diff variant of _PaintUtf8BufferLine. Compares the run against our
+//      shadow copy of the connected terminal's contents and only paints the
+//      segments of it that actually changed. Unchanged gaps between two
+//      segments are skipped with a cursor movement, unless reprinting them is
+//      cheaper than that.
+// Arguments:
+// - clusters - text and column widths to be written
+// - coord - character coordinate target to render within viewport
+// - lineWrapped - true if this run is the end of a line that wrapped.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_PaintUtf8BufferLineDiff(const gsl::span<const Cluster> clusters,
+                                                         const til::point coord,
+                                                         const bool lineWrapped) noexcept
+try
+{
+    const auto size = _lastViewport.Dimensions();
+    if (_shadowSize != size)
+    {
+        _shadow.assign(size.area<size_t>(), ShadowCell{ shadowCellUnknown, {} });
+        _shadowSize = size;
+    }
+
+    if (coord.X < 0 || coord.Y < 0 || coord.Y >= size.height)
+    {
+        return _PaintUtf8Run(clusters, coord, lineWrapped);
+    }
+
+    // A cursor forward (ESC [ %d C) is at least 4 characters long. Skipping
+    // fewer unchanged columns than that isn't worth it.
+    static constexpr til::CoordType minSkipColumns = 5;
+
+    // GH#5291 - If the previous row wrapped, its last character is waiting for
+    // the first one of this row. Skipping it would manually break the line.
+    const auto continuesWrappedRow = coord.X == 0 && _wrappedRow.has_value() && _wrappedRow.value() == coord.Y - 1;
+    const auto offset = gsl::narrow_cast<size_t>(coord.Y) * gsl::narrow_cast<size_t>(size.width);
+
+    // The half-open range of clusters [segmentBegin, segmentEnd) that we are
+    // going to paint next, starting at column segmentX and ending at segmentEndX.
+    const auto npos = clusters.size();
+    auto segmentBegin = npos;
+    size_t segmentEnd = 0;
+    til::CoordType segmentX = 0;
+    til::CoordType segmentEndX = 0;
+
+    auto x = coord.X;
+    for (size_t i = 0; i < clusters.size(); ++i)
+    {
+        const auto& cluster = til::at(clusters, i);
+        const auto columns = cluster.GetColumns();
+
+        // GH#4415 - The last cell of a wrapped row always needs to be printed,
+        // so that the connected terminal wraps the line as well.
+        const auto mustPaint = (i == 0 && continuesWrappedRow) ||
+                               (i == clusters.size() - 1 && lineWrapped);
+
+        if (mustPaint || !_ShadowMatches(offset, x, cluster))
+        {
+            if (segmentBegin != npos && x - segmentEndX >= minSkipColumns)
+            {
+                const auto segment = clusters.subspan(segmentBegin, segmentEnd - segmentBegin);
+                RETURN_IF_FAILED(_PaintUtf8Run(segment, { segmentX, coord.Y }, false));
+                _UpdateShadow(segment, { segmentX, coord.Y });
+                segmentBegin = npos;
+            }
+
+            if (segmentBegin == npos)
+            {
+                segmentBegin = i;
+                segmentX = x;
+            }
+
+            segmentEnd = i + 1;
+            segmentEndX = x + columns;
+        }
+
+        x += columns;
+    }
+
+    if (segmentBegin != npos)
+    {
+        const auto segment = clusters.subspan(segmentBegin, segmentEnd - segmentBegin);
+        RETURN_IF_FAILED(_PaintUtf8Run(segment, { segmentX, coord.Y }, lineWrapped && segmentEnd == clusters.size()));
+        _UpdateShadow(segment, { segmentX, coord.Y });
+    }
+
+    return S_OK;
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Returns true if the connected terminal already displays the given cluster
+//      at the given position, using the current text attributes.
+// Arguments:
+// - offset - the index of the first cell of the row in _shadow
+// - x - the column of the cluster
+// - cluster - the text and column count to compare
+// Return Value:
+// - true if the cluster doesn't need to be painted.
+bool VtEngine::_ShadowMatches(const size_t offset, const til::CoordType x, const Cluster& cluster) const noexcept
+{
+    const auto text = cluster.GetText();
+    const auto columns = cluster.GetColumns();
+
+    if (text.size() != 1 || columns < 1 || columns > 2 || x + columns > _shadowSize.width)
+    {
+        return false;
+    }
+
+    const auto& cell = til::at(_shadow, offset + x);
+    if (cell.ch != text.front() || cell.attributes != _lastTextAttributes)
+    {
+        return false;
+    }
+
+    return columns == 1 || til::at(_shadow, offset + x + 1).ch == shadowCellTrailing;
+}
+
+// Routine Description:
+// - Records the cells we just painted in our shadow copy of the connected
+//      terminal's contents. Trailing spaces may have been erased with ECH/EL
+//      or skipped entirely instead of being printed, so they are recorded as
+//      unknown.
+// Arguments:
+// - clusters - the text and column widths that were painted
+// - coord - the position of the first cluster
+// Return Value:
+// - <none>
+void VtEngine::_UpdateShadow(const gsl::span<const Cluster> clusters, const til::point coord) noexcept
+{
+    const auto width = _shadowSize.width;
+    const auto offset = gsl::narrow_cast<size_t>(coord.Y) * gsl::narrow_cast<size_t>(width);
+
+    auto printed = clusters.size();
+    while (printed > 0 && til::at(clusters, printed - 1).GetText() == L" ")
+    {
+        --printed;
+    }
+
+    auto x = coord.X;
+    for (size_t i = 0; i < clusters.size() && x < width; ++i)
+    {
+        const auto& cluster = til::at(clusters, i);
+        const auto text = cluster.GetText();
+        const auto columns = cluster.GetColumns();
+        const auto known = i < printed && text.size() == 1 && text.front() < shadowCellTrailing && columns <= 2;
+
+        til::at(_shadow, offset + x) = { known ? text.front() : shadowCellUnknown, _lastTextAttributes };
+        for (til::CoordType c = 1; c < columns && x + c < width; ++c)
+        {
+            til::at(_shadow, offset + x + c) = { known ? shadowCellTrailing : shadowCellUnknown, _lastTextAttributes };
+        }
+
+        x += columns;
+    }
+}
+
+// Routine Description:
+// - Shifts our shadow copy of the connected terminal's contents after we
+//      scrolled it. The rows that were scrolled into view are unknown.
+// Arguments:
+// - dy - the number of rows the contents moved down. Negative if up.
+// Return Value:
+// - <none>
+void VtEngine::_ScrollShadow(const til::CoordType dy) noexcept
+{
+    if (_shadow.empty())
+    {
+        return;
+    }
+
+    const auto rows = std::min(std::abs(dy), _shadowSize.height);
+    const auto shift = gsl::narrow_cast<ptrdiff_t>(rows) * _shadowSize.width;
+
+    if (dy < 0)
+    {
+        std::move(_shadow.begin() + shift, _shadow.end(), _shadow.begin());
+        std::fill(_shadow.end() - shift, _shadow.end(), ShadowCell{ shadowCellUnknown, {} });
+    }
+    else
+    {
+        std::move_backward(_shadow.begin(), _shadow.end() - shift, _shadow.end());
+        std::fill(_shadow.begin(), _shadow.begin() + shift, ShadowCell{ shadowCellUnknown, {} });
+    }
+}
+
+// Routine Description:
+// - Forgets everything we know about the connected terminal's contents. Used
+//      whenever it changed in ways we can't follow, like clearing the screen,
+//      resizing, or text that we passed through without understanding it.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::_InvalidateShadow() noexcept
+{
+    std::fill(_shadow.begin(), _shadow.end(), ShadowCell{ shadowCellUnknown, {} });
+}
+
+// Routine Description:
+// - Paints a single run of text, together with any of the erase optimizations
+//      for the trailing spaces of the run. See _PaintUtf8BufferLine.
+// Arguments:
+// - clusters - text and column widths to be written
+// - coord - character coordinate target to render within viewport
+// - lineWrapped - true if this run is the end of a line that wrapped.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_PaintUtf8Run(const gsl::span<const Cluster> clusters,
+                                              const til::point coord,
+                                              const bool lineWrapped) noexcept
+{
     _bufferLine.clear();
     _bufferLine.reserve(clusters.size());
     til::CoordType totalWidth = 0;
@@ -479,7 +750,14 @@ using namespace Microsoft::Console::Types;
     RETURN_IF_FAILED(_MoveCursor(coord));
 
     // Write the actual text string
-    RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8({ _bufferLine.data(), cchActual }));
+    if (_frameDiff || _repeatCharacter)
+    {
+        RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8Repeated({ _bufferLine.data(), cchActual }));
+    }
+    else
+    {
+        RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8({ _bufferLine.data(), cchActual }));
+    }
 
     // GH#4415, GH#5181
     // If the renderer told us that this was a wrapped line, then mark
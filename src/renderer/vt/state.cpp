@@ -134,7 +134,11 @@ CATCH_RETURN();
     CATCH_RETURN();
 }
 
+// Method Description:
+// - Writes everything that has been buffered up to the pipe right away, including
+//   the last frame, if Present() hasn't gotten around to writing that one yet.
 [[nodiscard]] HRESULT VtEngine::_Flush() noexcept
+try
 {
 #ifdef UNIT_TESTING
     if (_hFile.get() == INVALID_HANDLE_VALUE)
@@ -144,29 +148,70 @@ CATCH_RETURN();
     }
 #endif
 
+    auto hr = S_OK;
+    {
+        const std::lock_guard guard{ _pipeLock };
+
+        if (_frameBuffer.empty())
+        {
+            hr = _WriteToPipe(_buffer);
+        }
+        else
+        {
+            _frameBuffer.append(_buffer);
+            _buffer.clear();
+            hr = _WriteToPipe(_frameBuffer);
+        }
+    }
+
+    // CloseOutput() acquires the console lock and must
+    // not be called while holding the _pipeLock.
+    if (FAILED(hr) && _terminalOwner)
+    {
+        _terminalOwner->CloseOutput();
+    }
+
+    return hr;
+}
+CATCH_RETURN()
+
+// Method Description:
+// - Writes the given buffer to the pipe and clears it. _pipeLock must be held.
+// Return Value:
+// - S_OK, or the error the pipe broke with. That error is only returned once,
+//   so that the caller tells the VtIo to close our output exactly once.
+[[nodiscard]] HRESULT VtEngine::_WriteToPipe(std::string& buffer) noexcept
+{
     if (!_pipeBroken)
     {
-        auto fSuccess = !!WriteFile(_hFile.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), nullptr, nullptr);
-        _buffer.clear();
+        auto fSuccess = !!WriteFile(_hFile.get(), buffer.data(), gsl::narrow_cast<DWORD>(buffer.size()), nullptr, nullptr);
         if (!fSuccess)
         {
             _exitResult = HRESULT_FROM_WIN32(GetLastError());
             _pipeBroken = true;
-            if (_terminalOwner)
-            {
-                _terminalOwner->CloseOutput();
-            }
+            buffer.clear();
             return _exitResult;
         }
     }
 
+    buffer.clear();
     return S_OK;
 }
 
+// Method Description:
+// - Returns how many frames of which size (in bytes) were written to the pipe so far.
+//   See FRAME_SIZE_BUCKETS for the size of the buckets.
+VtEngine::FrameSizeHistogram VtEngine::GetFrameSizeHistogram() const noexcept
+{
+    const std::lock_guard guard{ _pipeLock };
+    return _frameSizeHistogram;
+}
+
 // Method Description:
 // - Wrapper for _Write.
 [[nodiscard]] HRESULT VtEngine::WriteTerminalUtf8(const std::string_view str) noexcept
 {
+    _InvalidateShadow();
     return _Write(str);
 }
 
@@ -183,6 +228,52 @@ CATCH_RETURN();
     return _Write(_conversionBuffer);
 }
 
+// Method Description:
+// - Like _WriteTerminalUtf8, but writes runs of the same character as a
+//      single character followed by a REP sequence. The REP sequence is at
+//      most 5 characters long for less than 100 repetitions (ESC [ %d %d b),
+//      so we only use it if the repetitions would take up more bytes than that.
+// - Only printable ASCII and the box drawing, block and geometric shape
+//      characters are repeated. They are always a cluster of their own, unlike
+//      other characters which could be part of a cluster with combining marks.
+// Arguments:
+// - wstr - wstring of text to be written
+// Return Value:
+// - S_OK or suitable HRESULT error from either conversion or writing pipe.
+[[nodiscard]] HRESULT VtEngine::_WriteTerminalUtf8Repeated(const std::wstring_view wstr) noexcept
+{
+    size_t written = 0;
+    for (size_t i = 0; i < wstr.size();)
+    {
+        const auto wch = til::at(wstr, i);
+        auto end = i + 1;
+        while (end < wstr.size() && til::at(wstr, end) == wch)
+        {
+            ++end;
+        }
+
+        // Box drawing characters take up 3 bytes in UTF-8.
+        const auto isAscii = wch >= L' ' && wch <= L'~';
+        const auto isBoxDrawing = wch >= L'\u2500' && wch <= L'\u25ff';
+        const auto repeats = end - i - 1;
+        const auto repeatedBytes = repeats * (isAscii ? 1 : 3);
+        if ((isAscii || isBoxDrawing) && repeatedBytes > REPEAT_CHARACTER_STRING_LENGTH)
+        {
+            RETURN_IF_FAILED(_WriteTerminalUtf8(wstr.substr(written, i + 1 - written)));
+            RETURN_IF_FAILED(_RepeatCharacter(gsl::narrow_cast<til::CoordType>(repeats)));
+            written = end;
+        }
+
+        i = end;
+    }
+
+    if (written < wstr.size())
+    {
+        RETURN_IF_FAILED(_WriteTerminalUtf8(wstr.substr(written)));
+    }
+    return S_OK;
+}
+
 // Method Description:
 // - Writes a wstring to the tty, encoded as "utf-8" where characters that are
 //      outside the ASCII range are encoded as '?'
@@ -251,6 +342,9 @@ CATCH_RETURN();
 
     if (oldSize != newSize)
     {
+        // The terminal might reflow its contents, we can't know what it shows.
+        _InvalidateShadow();
+
         // Don't emit a resize event if we've requested it be suppressed
         if (!_suppressResizeRepaint)
         {
@@ -485,6 +579,49 @@ void VtEngine::SetPassthroughMode(const bool passthrough) noexcept
     _passthrough = passthrough;
 }
 
+// Method Description:
+// - Configure the renderer to diff every frame against a copy of what the
+//   connected terminal currently displays, and to only emit the cells that
+//   actually changed. This trades some memory for a lot less output, which
+//   matters most on slow links like SSH.
+// Arguments:
+// - frameDiff - True to turn on frame-diff mode. False otherwise.
+// Return Value:
+// - <none>
+void VtEngine::SetFrameDiffMode(const bool frameDiff) noexcept
+{
+    _frameDiff = frameDiff;
+    _shadow.clear();
+    _shadowSize = {};
+}
+
+// Method Description:
+// - Configure the renderer to write runs of the same character with REP
+//   (CSI n b). The connected terminal has to support REP, which we have no way
+//   to find out on our own, so it's up to the terminal to ask for this mode.
+//   Frame-diff mode always uses REP.
+// Arguments:
+// - repeatCharacter - True to write runs with REP. False otherwise.
+// Return Value:
+// - <none>
+void VtEngine::SetRepeatCharacterMode(const bool repeatCharacter) noexcept
+{
+    _repeatCharacter = repeatCharacter;
+}
+
+// Method Description:
+// - Makes us ignore all invalidations until called again with false. In
+//   passthrough mode, this is used while the buffer gets updated with output
+//   that the terminal has already received, so that we don't paint it twice.
+// Arguments:
+// - suppress - True to ignore invalidations. False otherwise.
+// Return Value:
+// - <none>
+void VtEngine::SuppressInvalidation(const bool suppress) noexcept
+{
+    _suppressInvalidation = suppress;
+}
+
 void VtEngine::SetLookingForDSRCallback(std::function<void(bool)> pfnLooking) noexcept
 {
     _pfnSetLookingForDSR = pfnLooking;
@@ -531,6 +668,7 @@ HRESULT VtEngine::RequestWin32Input() noexcept
 
 HRESULT VtEngine::SwitchScreenBuffer(const bool useAltBuffer) noexcept
 {
+    _InvalidateShadow();
     RETURN_IF_FAILED(_SwitchScreenBuffer(useAltBuffer));
     RETURN_IF_FAILED(_Flush());
     return S_OK;
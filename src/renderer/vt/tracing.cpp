@@ -229,6 +229,19 @@ void RenderTracing::TraceEndPaint() const
 #endif UNIT_TESTING
 }
 
+void RenderTracing::TraceFrameSize(const size_t bytes) const
+{
+#ifndef UNIT_TESTING
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TraceFrameSize",
+                      TraceLoggingUInt64(bytes, "Bytes"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+#else
+    UNREFERENCED_PARAMETER(bytes);
+#endif UNIT_TESTING
+}
+
 void RenderTracing::TraceLastText(const til::point lastTextPos) const
 {
 #ifndef UNIT_TESTING
@@ -46,5 +46,6 @@ namespace Microsoft::Console::VirtualTerminal
                              const bool cursorMoved,
                              const std::optional<til::CoordType>& wrappedRow) const;
         void TraceEndPaint() const;
+        void TraceFrameSize(const size_t bytes) const;
     };
 }
@@ -42,7 +42,13 @@ namespace Microsoft::Console::Render
     public:
         // See _PaintUtf8BufferLine for explanation of this value.
         static const size_t ERASE_CHARACTER_STRING_LENGTH = 8;
+        // See _WriteTerminalUtf8Repeated for explanation of this value.
+        static const size_t REPEAT_CHARACTER_STRING_LENGTH = 5;
         static const til::point INVALID_COORDS;
+        // Bucket i of the frame size histogram counts the frames of less than 2^(i+6) bytes.
+        // The last bucket counts everything from 512 KiB upwards.
+        static constexpr size_t FRAME_SIZE_BUCKETS = 15;
+        using FrameSizeHistogram = std::array<uint32_t, FRAME_SIZE_BUCKETS>;
 
         VtEngine(_In_ wil::unique_hfile hPipe,
                  const Microsoft::Console::Types::Viewport initialViewport);
@@ -82,17 +88,28 @@ namespace Microsoft::Console::Render
         void EndResizeRequest();
         void SetResizeQuirk(const bool resizeQuirk);
         void SetPassthroughMode(const bool passthrough) noexcept;
+        void SetFrameDiffMode(const bool frameDiff) noexcept;
+        void SetRepeatCharacterMode(const bool repeatCharacter) noexcept;
+        void SuppressInvalidation(const bool suppress) noexcept;
         void SetLookingForDSRCallback(std::function<void(bool)> pfnLooking) noexcept;
         void SetTerminalCursorTextPosition(const til::point coordCursor) noexcept;
         [[nodiscard]] virtual HRESULT ManuallyClearScrollback() noexcept;
         [[nodiscard]] HRESULT RequestWin32Input() noexcept;
         [[nodiscard]] virtual HRESULT SetWindowVisibility(const bool showOrHide) noexcept = 0;
         [[nodiscard]] HRESULT SwitchScreenBuffer(const bool useAltBuffer) noexcept;
+        FrameSizeHistogram GetFrameSizeHistogram() const noexcept;
 
     protected:
         wil::unique_hfile _hFile;
         std::string _buffer;
 
+        // EndPaint() hands the output of a frame over to _frameBuffer, which Present() then
+        // writes to the pipe outside of the console lock. _pipeLock serializes that with the
+        // _Flush() calls other threads make under the console lock, and keeps the output in order.
+        std::string _frameBuffer;
+        mutable std::mutex _pipeLock;
+        FrameSizeHistogram _frameSizeHistogram{};
+
         std::string _formatBuffer;
         std::string _conversionBuffer;
 
@@ -137,9 +154,27 @@ namespace Microsoft::Console::Render
         bool _passthrough{ false };
         std::optional<TextColor> _newBottomLineBG{ std::nullopt };
 
+        // In frame-diff mode we keep a copy of what we believe the connected
+        // terminal currently displays, so that we only need to emit the cells
+        // that actually changed. Cells we aren't sure about are "unknown" and
+        // never match. The second half of a wide glyph is stored as "trailing".
+        struct ShadowCell
+        {
+            wchar_t ch;
+            TextAttribute attributes;
+        };
+        static constexpr wchar_t shadowCellTrailing = 0xFFFE;
+        static constexpr wchar_t shadowCellUnknown = 0xFFFF;
+        bool _frameDiff{ false };
+        bool _repeatCharacter{ false };
+        bool _suppressInvalidation{ false };
+        std::vector<ShadowCell> _shadow;
+        til::size _shadowSize;
+
         [[nodiscard]] HRESULT _WriteFill(const size_t n, const char c) noexcept;
         [[nodiscard]] HRESULT _Write(std::string_view const str) noexcept;
         [[nodiscard]] HRESULT _Flush() noexcept;
+        [[nodiscard]] HRESULT _WriteToPipe(std::string& buffer) noexcept;
 
         template<typename S, typename... Args>
         [[nodiscard]] HRESULT _WriteFormatted(S&& format, Args&&... args)
@@ -164,6 +199,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _InsertLine(const til::CoordType sLines) noexcept;
         [[nodiscard]] HRESULT _CursorForward(const til::CoordType chars) noexcept;
         [[nodiscard]] HRESULT _EraseCharacter(const til::CoordType chars) noexcept;
+        [[nodiscard]] HRESULT _RepeatCharacter(const til::CoordType chars) noexcept;
         [[nodiscard]] HRESULT _CursorPosition(const til::point coord) noexcept;
         [[nodiscard]] HRESULT _CursorHome() noexcept;
         [[nodiscard]] HRESULT _ClearScreen() noexcept;
@@ -215,11 +251,23 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _PaintUtf8BufferLine(const gsl::span<const Cluster> clusters,
                                                    const til::point coord,
                                                    const bool lineWrapped) noexcept;
+        [[nodiscard]] HRESULT _PaintUtf8Run(const gsl::span<const Cluster> clusters,
+                                            const til::point coord,
+                                            const bool lineWrapped) noexcept;
+        [[nodiscard]] HRESULT _PaintUtf8BufferLineDiff(const gsl::span<const Cluster> clusters,
+                                                       const til::point coord,
+                                                       const bool lineWrapped) noexcept;
+
+        bool _ShadowMatches(const size_t offset, const til::CoordType x, const Cluster& cluster) const noexcept;
+        void _UpdateShadow(const gsl::span<const Cluster> clusters, const til::point coord) noexcept;
+        void _ScrollShadow(const til::CoordType dy) noexcept;
+        void _InvalidateShadow() noexcept;
 
         [[nodiscard]] HRESULT _PaintAsciiBufferLine(const gsl::span<const Cluster> clusters,
                                                     const til::point coord) noexcept;
 
         [[nodiscard]] HRESULT _WriteTerminalUtf8(const std::wstring_view str) noexcept;
+        [[nodiscard]] HRESULT _WriteTerminalUtf8Repeated(const std::wstring_view str) noexcept;
         [[nodiscard]] HRESULT _WriteTerminalAscii(const std::wstring_view str) noexcept;
 
         [[nodiscard]] virtual HRESULT _DoUpdateTitle(const std::wstring_view newTitle) noexcept override;
@@ -118,6 +118,8 @@ WddmConEngine::~WddmConEngine()
                     {
                         _displayHeight = DisplaySize.bottom;
                         _displayWidth = DisplaySize.right;
+                        // The first frame has to fill the entire display.
+                        _dirtyArea = GetDisplaySize();
                     }
                     else
                     {
@@ -166,33 +168,53 @@ try
 }
 CATCH_RETURN()
 
-[[nodiscard]] HRESULT WddmConEngine::Invalidate(const til::rect* const /*psrRegion*/) noexcept
+// Routine Description:
+// - Marks the given cells as dirty. Only the rows they cover are repainted
+//   and sent to the display at the next frame.
+[[nodiscard]] HRESULT WddmConEngine::Invalidate(const til::rect* const psrRegion) noexcept
 {
+    RETURN_HR_IF_NULL(E_INVALIDARG, psrRegion);
+    _dirtyArea |= *psrRegion & GetDisplaySize();
     return S_OK;
 }
 
-[[nodiscard]] HRESULT WddmConEngine::InvalidateCursor(const til::rect* const /*psrRegion*/) noexcept
+[[nodiscard]] HRESULT WddmConEngine::InvalidateCursor(const til::rect* const psrRegion) noexcept
 {
-    return S_OK;
+    return Invalidate(psrRegion);
 }
 
+// Routine Description:
+// - The system region is given in pixels, and the display has nothing but
+//   the text on it, so all of it is repainted.
 [[nodiscard]] HRESULT WddmConEngine::InvalidateSystem(const til::rect* const /*prcDirtyClient*/) noexcept
 {
-    return S_OK;
+    return InvalidateAll();
 }
 
-[[nodiscard]] HRESULT WddmConEngine::InvalidateSelection(const std::vector<til::rect>& /*rectangles*/) noexcept
+[[nodiscard]] HRESULT WddmConEngine::InvalidateSelection(const std::vector<til::rect>& rectangles) noexcept
 {
+    for (const auto& rect : rectangles)
+    {
+        RETURN_IF_FAILED(Invalidate(&rect));
+    }
     return S_OK;
 }
 
-[[nodiscard]] HRESULT WddmConEngine::InvalidateScroll(const til::point* const /*pcoordDelta*/) noexcept
+// Routine Description:
+// - The display can't be scrolled, so scrolling repaints all of it.
+[[nodiscard]] HRESULT WddmConEngine::InvalidateScroll(const til::point* const pcoordDelta) noexcept
 {
+    RETURN_HR_IF_NULL(E_INVALIDARG, pcoordDelta);
+    if (*pcoordDelta != til::point{})
+    {
+        return InvalidateAll();
+    }
     return S_OK;
 }
 
 [[nodiscard]] HRESULT WddmConEngine::InvalidateAll() noexcept
 {
+    _dirtyArea = GetDisplaySize();
     return S_OK;
 }
 
@@ -202,19 +224,45 @@ CATCH_RETURN()
     return S_FALSE;
 }
 
+// Routine Description:
+// - Starts a frame, unless nothing was invalidated since the last one.
+// Return Value:
+// - S_FALSE if there's nothing to paint, otherwise the result of starting the update batch.
 [[nodiscard]] HRESULT WddmConEngine::StartPaint() noexcept
 try
 {
     RETURN_LAST_ERROR_IF(_hWddmConCtx == INVALID_HANDLE_VALUE);
+    if (_dirtyArea.empty())
+    {
+        return S_FALSE;
+    }
     return WDDMConBeginUpdateDisplayBatch(_hWddmConCtx);
 }
 CATCH_RETURN()
 
+// Routine Description:
+// - Sends each of the dirty rows to the display once, after all of their runs
+//   were painted, and then makes their new contents the old ones.
 [[nodiscard]] HRESULT WddmConEngine::EndPaint() noexcept
 try
 {
     RETURN_LAST_ERROR_IF(_hWddmConCtx == INVALID_HANDLE_VALUE);
-    return WDDMConEndUpdateDisplayBatch(_hWddmConCtx);
+
+    const auto dirtyArea = std::exchange(_dirtyArea, til::rect{});
+    auto hr = S_OK;
+    for (auto rowIndex = dirtyArea.top; rowIndex < dirtyArea.bottom; rowIndex++)
+    {
+        const auto row = _displayState[rowIndex];
+        hr = WDDMConUpdateDisplay(_hWddmConCtx, row, FALSE);
+        if (FAILED(hr))
+        {
+            break;
+        }
+        memcpy_s(row->Old, _displayWidth * sizeof(CD_IO_CHARACTER), row->New, _displayWidth * sizeof(CD_IO_CHARACTER));
+    }
+
+    const auto hrEnd = WDDMConEndUpdateDisplayBatch(_hWddmConCtx);
+    return FAILED(hr) ? hr : hrEnd;
 }
 CATCH_RETURN()
 
@@ -240,16 +288,13 @@ CATCH_RETURN()
 {
     RETURN_LAST_ERROR_IF(_hWddmConCtx == INVALID_HANDLE_VALUE);
 
-    for (LONG rowIndex = 0; rowIndex < _displayHeight; rowIndex++)
+    // The old contents are updated once the rows were sent to the display in EndPaint().
+    for (auto rowIndex = _dirtyArea.top; rowIndex < _dirtyArea.bottom; rowIndex++)
     {
-        for (LONG colIndex = 0; colIndex < _displayWidth; colIndex++)
+        for (auto colIndex = _dirtyArea.left; colIndex < _dirtyArea.right; colIndex++)
         {
-            const auto OldChar = &_displayState[rowIndex]->Old[colIndex];
             const auto NewChar = &_displayState[rowIndex]->New[colIndex];
 
-            OldChar->Character = NewChar->Character;
-            OldChar->Attribute = NewChar->Attribute;
-
             NewChar->Character = L' ';
             NewChar->Attribute = 0x0;
         }
@@ -267,19 +312,17 @@ CATCH_RETURN()
     {
         RETURN_LAST_ERROR_IF(_hWddmConCtx == INVALID_HANDLE_VALUE);
 
+        // A row usually consists of several runs with different attributes. It's
+        // only sent to the display once all of them were painted, in EndPaint().
         for (size_t i = 0; i < clusters.size() && i < gsl::narrow_cast<size_t>(_displayWidth); i++)
         {
-            const auto OldChar = &_displayState[coord.Y]->Old[coord.X + i];
             const auto NewChar = &_displayState[coord.Y]->New[coord.X + i];
 
-            OldChar->Character = NewChar->Character;
-            OldChar->Attribute = NewChar->Attribute;
-
             NewChar->Character = til::at(clusters, i).GetTextAsSingle();
             NewChar->Attribute = _currentLegacyColorAttribute;
         }
 
-        return WDDMConUpdateDisplay(_hWddmConCtx, _displayState[coord.Y], FALSE);
+        return S_OK;
     }
     CATCH_RETURN();
 }
@@ -355,9 +398,6 @@ CATCH_RETURN()
 
 [[nodiscard]] HRESULT WddmConEngine::GetDirtyArea(gsl::span<const til::rect>& area) noexcept
 {
-    _dirtyArea.bottom = std::max<LONG>(0, _displayHeight);
-    _dirtyArea.right = std::max<LONG>(0, _displayWidth);
-
     area = { &_dirtyArea,
              1 };
 
@@ -154,21 +154,24 @@
     HRESULT hr;
     std::deque<std::unique_ptr<IInputEvent>> outEvents;
     const auto eventsToRead = cRecords;
+    // The Unicode variants copy the records straight into the output buffer.
+    size_t eventsRead = 0;
     if (a->Unicode)
     {
+        const gsl::span<INPUT_RECORD> outRecords{ rgRecords, cRecords };
         if (fIsPeek)
         {
             hr = m->_pApiRoutines->PeekConsoleInputWImpl(*pInputBuffer,
-                                                         outEvents,
-                                                         eventsToRead,
+                                                         outRecords,
+                                                         eventsRead,
                                                          *pInputReadHandleData,
                                                          waiter);
         }
         else
         {
             hr = m->_pApiRoutines->ReadConsoleInputWImpl(*pInputBuffer,
-                                                         outEvents,
-                                                         eventsToRead,
+                                                         outRecords,
+                                                         eventsRead,
                                                          *pInputReadHandleData,
                                                          waiter);
         }
@@ -191,14 +194,15 @@
                                                          *pInputReadHandleData,
                                                          waiter);
         }
+        eventsRead = std::min(outEvents.size(), cRecords);
     }
 
     // We must return the number of records in the message payload (to alert the client)
     // as well as in the message headers (below in SetReplyInformation) to alert the driver.
-    LOG_IF_FAILED(SizeTToULong(outEvents.size(), &a->NumRecords));
+    LOG_IF_FAILED(SizeTToULong(eventsRead, &a->NumRecords));
 
     size_t cbWritten;
-    LOG_IF_FAILED(SizeTMult(outEvents.size(), sizeof(INPUT_RECORD), &cbWritten));
+    LOG_IF_FAILED(SizeTMult(eventsRead, sizeof(INPUT_RECORD), &cbWritten));
 
     if (nullptr != waiter.get())
     {
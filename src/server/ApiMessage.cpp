@@ -10,6 +10,52 @@
 
 constexpr size_t structPacketDataSize = sizeof(_CONSOLE_API_MSG) - offsetof(_CONSOLE_API_MSG, Descriptor);
 
+// Payload buffers larger than this are released again once they turned out
+// to be more than twice as large as needed for this many messages in a row.
+constexpr size_t messageBufferRetainSize = 16 * 1024;
+constexpr uint8_t messageBufferOversizedLimit = 32;
+
+// Routine Description:
+// - Resizes one of the payload buffers of a message. The console server reuses the
+//   same message for every request it reads, so the allocation of the buffer carries
+//   over from one request to the next. Clients that repeatedly make large calls
+//   (like WriteConsoleOutput with big CHAR_INFO grids) interleaved with small ones
+//   thus don't cause an allocation each time.
+// Arguments:
+// - buffer - The buffer to resize. Must be empty.
+// - oversizedCount - The number of consecutive times the buffer was far too large.
+// - size - The new size of the buffer in bytes.
+// - zero - Whether the contents should be zeroed or left uninitialized.
+// Return Value:
+// - <none>
+// Note:
+// - will throw on failure
+template<typename T>
+static void ResizeMessageBuffer(T& buffer, uint8_t& oversizedCount, const size_t size, const bool zero)
+{
+    if (buffer.capacity() > messageBufferRetainSize && (buffer.capacity() >> 1) > size)
+    {
+        if (++oversizedCount >= messageBufferOversizedLimit)
+        {
+            buffer.shrink_to_fit();
+            oversizedCount = 0;
+        }
+    }
+    else
+    {
+        oversizedCount = 0;
+    }
+
+    if (zero)
+    {
+        buffer.resize(size);
+    }
+    else
+    {
+        buffer.resize(size, boost::container::default_init);
+    }
+}
+
 _CONSOLE_API_MSG::_CONSOLE_API_MSG()
 {
     // A union cannot have more than one initializer,
@@ -31,6 +77,8 @@ _CONSOLE_API_MSG& _CONSOLE_API_MSG::operator=(const _CONSOLE_API_MSG& other)
     _pApiRoutines = other._pApiRoutines;
     _inputBuffer = other._inputBuffer;
     _outputBuffer = other._outputBuffer;
+    _inputBufferOversizedCount = other._inputBufferOversizedCount;
+    _outputBufferOversizedCount = other._outputBufferOversizedCount;
 
     // Since this struct uses anonymous unions and thus cannot
     // explicitly reference it, we have to a bit cheeky to copy it.
@@ -106,14 +154,8 @@ try
 
         const auto cbReadSize = Descriptor.InputSize - State.ReadOffset;
 
-        // If we were previously called with a huge buffer we have an equally large _inputBuffer.
-        // We shouldn't just keep this huge buffer around, if no one needs it anymore.
-        if (_inputBuffer.capacity() > 16 * 1024 && (_inputBuffer.capacity() >> 1) > cbReadSize)
-        {
-            _inputBuffer.shrink_to_fit();
-        }
-
-        _inputBuffer.resize(cbReadSize);
+        // The payload is read into it right away, so there's no need to zero it first.
+        ResizeMessageBuffer(_inputBuffer, _inputBufferOversizedCount, cbReadSize, false);
 
         RETURN_IF_FAILED(ReadMessageInput(0, _inputBuffer.data(), cbReadSize));
 
@@ -152,17 +194,9 @@ try
         auto cbWriteSize = Descriptor.OutputSize - State.WriteOffset;
         RETURN_IF_FAILED(ULongMult(cbWriteSize, cbFactor, &cbWriteSize));
 
-        // If we were previously called with a huge buffer we have an equally large _outputBuffer.
-        // We shouldn't just keep this huge buffer around, if no one needs it anymore.
-        if (_outputBuffer.capacity() > 16 * 1024 && (_outputBuffer.capacity() >> 1) > cbWriteSize)
-        {
-            _outputBuffer.shrink_to_fit();
-        }
-
-        _outputBuffer.resize(cbWriteSize);
-
-        // 0 it out.
-        std::fill_n(_outputBuffer.data(), _outputBuffer.size(), BYTE(0));
+        // 0 it out. The buffer is empty at this point, so resizing it does just that.
+        _outputBuffer.clear();
+        ResizeMessageBuffer(_outputBuffer, _outputBufferOversizedCount, cbWriteSize, true);
 
         State.OutputBuffer = _outputBuffer.data();
         State.OutputBufferSize = cbWriteSize;
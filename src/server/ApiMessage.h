@@ -64,6 +64,8 @@ typedef struct _CONSOLE_API_MSG
 
     boost::container::small_vector<BYTE, 128> _inputBuffer;
     boost::container::small_vector<BYTE, 128> _outputBuffer;
+    uint8_t _inputBufferOversizedCount{ 0 };
+    uint8_t _outputBufferOversizedCount{ 0 };
 
     // From here down is the actual packet data sent/received.
     CD_IO_DESCRIPTOR Descriptor;
@@ -8,6 +8,7 @@ ConDrvDeviceComm::ConDrvDeviceComm(_In_ HANDLE Server) :
     _Server(Server)
 {
     THROW_HR_IF(E_HANDLE, Server == INVALID_HANDLE_VALUE);
+    _readIoEvent.create(wil::EventOptions::ManualReset);
 }
 
 ConDrvDeviceComm::~ConDrvDeviceComm()
@@ -41,6 +42,16 @@ ConDrvDeviceComm::~ConDrvDeviceComm()
 [[nodiscard]] HRESULT ConDrvDeviceComm::ReadIo(_In_opt_ PCONSOLE_API_MSG const pReplyMsg,
                                                _Out_ CONSOLE_API_MSG* const pMessage) const
 {
+    // If TryReadIo() left a request pending, its reply has already been sent
+    // and we only need to wait for the message to arrive in the same buffer.
+    if (_readIoPending)
+    {
+        _readIoPending = false;
+        DWORD cbRead = 0;
+        RETURN_IF_WIN32_BOOL_FALSE(GetOverlappedResult(_Server.get(), &_readIoOverlapped, &cbRead, TRUE));
+        return S_OK;
+    }
+
     auto hr = _CallIoctl(IOCTL_CONDRV_READ_IO,
                          pReplyMsg == nullptr ? nullptr : &pReplyMsg->Complete,
                          pReplyMsg == nullptr ? 0 : sizeof(pReplyMsg->Complete),
@@ -56,6 +67,45 @@ ConDrvDeviceComm::~ConDrvDeviceComm()
     return hr;
 }
 
+// Routine Description:
+// - Sends the reply to the previous activity and retrieves the next message, just like ReadIo,
+//   except that it doesn't wait for a message to arrive if the driver has none queued up.
+// - In that case the request stays pending and the next call to ReadIo, which must pass no reply
+//   and the same message buffer, waits for it to complete. This allows the caller to handle
+//   messages that are queued up back to back without giving up the console lock in between,
+//   while still releasing it before waiting for the next one.
+// Arguments:
+// - pCompletion - Optional completion structure from the previous activity (can be used in lieu of calling CompleteIo separately.)
+// - pMessage - A structure to hold the message data retrieved from the driver.
+// Return Value:
+// - S_OK if a message was retrieved, S_FALSE if the request is still pending or a suitable error.
+[[nodiscard]] HRESULT ConDrvDeviceComm::TryReadIo(_In_opt_ PCONSOLE_API_MSG const pReplyMsg,
+                                                  _Out_ CONSOLE_API_MSG* const pMessage) const
+{
+    RETURN_HR_IF(E_NOT_VALID_STATE, _readIoPending);
+
+    _readIoOverlapped = {};
+    _readIoOverlapped.hEvent = _readIoEvent.get();
+
+    if (!DeviceIoControl(_Server.get(),
+                         IOCTL_CONDRV_READ_IO,
+                         pReplyMsg == nullptr ? nullptr : &pReplyMsg->Complete,
+                         pReplyMsg == nullptr ? 0 : sizeof(pReplyMsg->Complete),
+                         &pMessage->Descriptor,
+                         sizeof(CONSOLE_API_MSG) - FIELD_OFFSET(CONSOLE_API_MSG, Descriptor),
+                         nullptr,
+                         &_readIoOverlapped))
+    {
+        const auto lastError = GetLastError();
+        RETURN_HR_IF(HRESULT_FROM_WIN32(lastError), lastError != ERROR_IO_PENDING);
+
+        _readIoPending = true;
+        return S_FALSE;
+    }
+
+    return S_OK;
+}
+
 // Routine Description:
 // - Marks an action/activity as completed to the driver so control/responses can be returned to the client application.
 // Arguments:
@@ -30,6 +30,8 @@ public:
     [[nodiscard]] HRESULT SetServerInformation(_In_ CD_IO_SERVER_INFORMATION* const pServerInfo) const override;
     [[nodiscard]] HRESULT ReadIo(_In_opt_ PCONSOLE_API_MSG const pReplyMsg,
                                  _Out_ CONSOLE_API_MSG* const pMessage) const override;
+    [[nodiscard]] HRESULT TryReadIo(_In_opt_ PCONSOLE_API_MSG const pReplyMsg,
+                                    _Out_ CONSOLE_API_MSG* const pMessage) const override;
     [[nodiscard]] HRESULT CompleteIo(_In_ CD_IO_COMPLETE* const pCompletion) const override;
 
     [[nodiscard]] HRESULT ReadInput(_In_ CD_IO_OPERATION* const pIoOperation) const override;
@@ -50,4 +52,9 @@ private:
                                      _In_ DWORD cbOutBufferSize) const;
 
     wil::unique_handle _Server;
+
+    // The READ_IO request started by TryReadIo(), while it's waiting for a message to arrive.
+    wil::unique_event _readIoEvent;
+    mutable OVERLAPPED _readIoOverlapped{};
+    mutable bool _readIoPending{ false };
 };
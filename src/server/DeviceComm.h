@@ -26,6 +26,8 @@ public:
     [[nodiscard]] virtual HRESULT SetServerInformation(_In_ CD_IO_SERVER_INFORMATION* const pServerInfo) const = 0;
     [[nodiscard]] virtual HRESULT ReadIo(_In_opt_ PCONSOLE_API_MSG const pReplyMsg,
                                          _Out_ CONSOLE_API_MSG* const pMessage) const = 0;
+    [[nodiscard]] virtual HRESULT TryReadIo(_In_opt_ PCONSOLE_API_MSG const pReplyMsg,
+                                            _Out_ CONSOLE_API_MSG* const pMessage) const = 0;
     [[nodiscard]] virtual HRESULT CompleteIo(_In_ CD_IO_COMPLETE* const pCompletion) const = 0;
 
     [[nodiscard]] virtual HRESULT ReadInput(_In_ CD_IO_OPERATION* const pIoOperation) const = 0;
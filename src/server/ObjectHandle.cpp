@@ -201,6 +201,17 @@ bool ConsoleHandleData::IsWriteShared() const
     }
 }
 
+// Routine Description:
+// - Retrieves the wait queue which holds the waits for requests made on this handle.
+// Arguments:
+// - <none>
+// Return Value:
+// - Pointer to the wait queue of this handle.
+ConsoleWaitQueue* ConsoleHandleData::GetHandleWaitQueue() noexcept
+{
+    return &_handleWaitQueue;
+}
+
 // Routine Description:
 // - For input buffers only, retrieves an extra handle data structure used to save some information
 //   across multiple reads from the same handle.
@@ -233,10 +244,11 @@ INPUT_READ_HANDLE_DATA* ConsoleHandleData::GetClientInput() const
     // see if there are any reads waiting for data via this handle.  if
     // there are, wake them up.  there aren't any other outstanding i/o
     // operations via this handle because the console lock is held.
+    // Reads made on other handles to the same input buffer keep waiting.
 
     if (pReadHandleData->GetReadCount() != 0)
     {
-        pInputBuffer->WaitQueue.NotifyWaiters(true, WaitTerminationReason::HandleClosing);
+        _handleWaitQueue.NotifyWaiters(true, WaitTerminationReason::HandleClosing);
     }
 
     FAIL_FAST_IF(pReadHandleData->GetReadCount() > 0);
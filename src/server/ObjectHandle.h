@@ -47,6 +47,7 @@ public:
                                           _Outptr_ SCREEN_INFORMATION** const ppScreenInfo) const;
 
     [[nodiscard]] HRESULT GetWaitQueue(_Outptr_ ConsoleWaitQueue** const ppWaitQueue) const;
+    ConsoleWaitQueue* GetHandleWaitQueue() noexcept;
 
     INPUT_READ_HANDLE_DATA* GetClientInput() const;
 
@@ -80,6 +81,11 @@ private:
     ULONG _ulHandleType;
     PVOID _pvClientPointer; // This will be a pointer to a SCREEN_INFORMATION or INPUT_INFORMATION object.
     std::unique_ptr<INPUT_READ_HANDLE_DATA> _pClientInput;
+
+    // Holds only the waits for requests made on this particular handle, so that closing it
+    // doesn't need to wake up every other reader of the same object. This must stay the last
+    // member: any waits left over are terminated when it's destroyed and may still use the above.
+    ConsoleWaitQueue _handleWaitQueue;
 };
 
 DEFINE_ENUM_FLAG_OPERATORS(ConsoleHandleData::HandleType);
@@ -67,6 +67,16 @@ using namespace Microsoft::Console::Interactivity;
         // As such, we have to put the newest process into the head of the list.
         _processes.push_front(pProcessData);
 
+        try
+        {
+            _processesById.emplace(dwProcessId, _processes.begin());
+        }
+        catch (...)
+        {
+            _processes.pop_front();
+            throw;
+        }
+
         if (nullptr != ppProcessData)
         {
             *ppProcessData = pProcessData;
@@ -87,10 +97,12 @@ void ConsoleProcessList::FreeProcessData(_In_ ConsoleProcessHandle* const pProce
 {
     FAIL_FAST_IF(!(ServiceLocator::LocateGlobals().getConsoleInformation().IsConsoleLocked()));
 
-    // Assert that the item exists in the list. If it doesn't exist, the end/last will be returned.
-    FAIL_FAST_IF(!(_processes.cend() != std::find(_processes.cbegin(), _processes.cend(), pProcessData)));
+    // Assert that the item exists in the list.
+    const auto it = _processesById.find(pProcessData->dwProcessId);
+    FAIL_FAST_IF(it == _processesById.end() || *it->second != pProcessData);
 
-    _processes.remove(pProcessData);
+    _processes.erase(it->second);
+    _processesById.erase(it);
 
     delete pProcessData;
 }
@@ -104,31 +116,18 @@ void ConsoleProcessList::FreeProcessData(_In_ ConsoleProcessHandle* const pProce
 // - Pointer to the process handle information or nullptr if no match was found.
 ConsoleProcessHandle* ConsoleProcessList::FindProcessInList(const DWORD dwProcessId) const
 {
-    auto it = _processes.cbegin();
-
-    while (it != _processes.cend())
+    if (ROOT_PROCESS_ID != dwProcessId)
     {
-        const auto pProcessHandleRecord = *it;
-
-        if (ROOT_PROCESS_ID != dwProcessId)
-        {
-            if (pProcessHandleRecord->dwProcessId == dwProcessId)
-            {
-                return pProcessHandleRecord;
-            }
-        }
-        else
-        {
-            if (pProcessHandleRecord->fRootProcess)
-            {
-                return pProcessHandleRecord;
-            }
-        }
-
-        it = std::next(it);
+        const auto it = _processesById.find(dwProcessId);
+        return it != _processesById.end() ? *it->second : nullptr;
     }
 
-    return nullptr;
+    // The root process is usually the first one that connected and thus the oldest,
+    // which is why we search from the back of the list.
+    const auto it = std::find_if(_processes.crbegin(), _processes.crend(), [](const auto pProcessHandleRecord) {
+        return pProcessHandleRecord->fRootProcess;
+    });
+    return it != _processes.crend() ? *it : nullptr;
 }
 
 // Routine Description:
@@ -60,6 +60,9 @@ public:
 
 private:
     std::list<ConsoleProcessHandle*> _processes;
+    // Indexes _processes by process ID, so that attaching and detaching
+    // doesn't slow down as more and more processes are connected.
+    std::unordered_map<DWORD, std::list<ConsoleProcessHandle*>::iterator> _processesById;
 
     void _ModifyProcessForegroundRights(const HANDLE hProcess, const bool fForeground) const;
 };
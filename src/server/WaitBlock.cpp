@@ -20,14 +20,17 @@
 // Arguments:
 // - pProcessQueue - The queue attached to the client process ID that requested this action
 // - pObjectQueue - The queue attached to the console object that will service the action when data arrives
+// - pHandleQueue - The queue attached to the handle the client is using to access that object
 // - pWaitReplyMessage - The original API message related to the client process's service request
 // - pWaiter - The context to return to later when the wait is satisfied.
 ConsoleWaitBlock::ConsoleWaitBlock(_In_ ConsoleWaitQueue* const pProcessQueue,
                                    _In_ ConsoleWaitQueue* const pObjectQueue,
+                                   _In_ ConsoleWaitQueue* const pHandleQueue,
                                    const CONSOLE_API_MSG* const pWaitReplyMessage,
                                    _In_ IWaitRoutine* const pWaiter) :
     _pProcessQueue(THROW_HR_IF_NULL(E_INVALIDARG, pProcessQueue)),
     _pObjectQueue(THROW_HR_IF_NULL(E_INVALIDARG, pObjectQueue)),
+    _pHandleQueue(THROW_HR_IF_NULL(E_INVALIDARG, pHandleQueue)),
     _WaitReplyMessage(*pWaitReplyMessage),
     _pWaiter(THROW_HR_IF_NULL(E_INVALIDARG, pWaiter))
 {
@@ -72,6 +75,7 @@ ConsoleWaitBlock::~ConsoleWaitBlock()
 {
     _pProcessQueue->_blocks.erase(_itProcessQueue);
     _pObjectQueue->_blocks.erase(_itObjectQueue);
+    _pHandleQueue->_blocks.erase(_itHandleQueue);
     delete _pWaiter;
 }
 
@@ -98,17 +102,21 @@ ConsoleWaitBlock::~ConsoleWaitBlock()
     LOG_IF_FAILED(pHandleData->GetWaitQueue(&pObjectQueue));
     FAIL_FAST_IF_NULL(pObjectQueue);
 
+    const auto pHandleQueue = pHandleData->GetHandleWaitQueue();
+
     ConsoleWaitBlock* pWaitBlock;
     try
     {
         pWaitBlock = new ConsoleWaitBlock(pProcessQueue,
                                           pObjectQueue,
+                                          pHandleQueue,
                                           pWaitReplyMessage,
                                           pWaiter);
 
         // Set the iterators on the wait block so that it can remove itself later.
         pWaitBlock->_itProcessQueue = pProcessQueue->_blocks.insert(pProcessQueue->_blocks.end(), pWaitBlock);
         pWaitBlock->_itObjectQueue = pObjectQueue->_blocks.insert(pObjectQueue->_blocks.end(), pWaitBlock);
+        pWaitBlock->_itHandleQueue = pHandleQueue->_blocks.insert(pHandleQueue->_blocks.end(), pWaitBlock);
     }
     catch (...)
     {
@@ -38,6 +38,7 @@ public:
 private:
     ConsoleWaitBlock(_In_ ConsoleWaitQueue* const pProcessQueue,
                      _In_ ConsoleWaitQueue* const pObjectQueue,
+                     _In_ ConsoleWaitQueue* const pHandleQueue,
                      const CONSOLE_API_MSG* const pWaitReplyMessage,
                      _In_ IWaitRoutine* const pWaiter);
 
@@ -47,6 +48,9 @@ private:
     ConsoleWaitQueue* const _pObjectQueue;
     std::_List_const_iterator<std::_List_val<std::_List_simple_types<ConsoleWaitBlock*>>> _itObjectQueue;
 
+    ConsoleWaitQueue* const _pHandleQueue;
+    std::_List_const_iterator<std::_List_val<std::_List_simple_types<ConsoleWaitBlock*>>> _itHandleQueue;
+
     CONSOLE_API_MSG _WaitReplyMessage;
 
     IWaitRoutine* const _pWaiter;
@@ -38,13 +38,14 @@ ConsoleWaitQueue::~ConsoleWaitQueue()
     // Normally we'd have the Wait Queue handle the insertion of the block into the queue, but
     // the console does queues in a somewhat special way.
     //
-    // Each block belongs in two queues:
+    // Each block belongs in three queues:
     // 1. The process queue of the client that dispatched the request
     // 2. The object queue that the request will be serviced by
-    // As such, when a wait occurs, it gets added to both queues.
+    // 3. The handle queue of the handle the request was made on
+    // As such, when a wait occurs, it gets added to all three queues.
     //
-    // It will end up being serviced by one or the other queue, but when it is serviced, it must be
-    // removed from both so it is not double processed.
+    // It will end up being serviced by one of the queues, but when it is serviced, it must be
+    // removed from all of them so it is not double processed.
     //
     // Therefore, I've inverted the queue management responsibility into the WaitBlock itself
     // and made it a friend to this WaitQueue class.
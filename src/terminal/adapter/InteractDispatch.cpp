@@ -62,7 +62,9 @@ bool InteractDispatch::WriteCtrlKey(const KeyEvent& event)
 
 // Method Description:
 // - Writes a string of input to the host. The string is converted to keystrokes
-//      that will faithfully represent the input by CharToKeyEvents.
+//      that will faithfully represent the input by StringToKeyRecords.
+// - Large pastes arrive here in one piece, so the keystrokes are synthesized
+//      as plain INPUT_RECORDs and written to the input buffer at once.
 // Arguments:
 // - string : a string to write to the console.
 // Return Value:
@@ -72,18 +74,13 @@ bool InteractDispatch::WriteString(const std::wstring_view string)
     if (!string.empty())
     {
         const auto codepage = _api.GetConsoleOutputCP();
-        std::deque<std::unique_ptr<IInputEvent>> keyEvents;
+        std::vector<INPUT_RECORD> keyRecords;
+        // Most characters turn into a key down and a key up event.
+        keyRecords.reserve(string.size() * 2);
+        StringToKeyRecords(string, codepage, keyRecords);
 
-        for (const auto& wch : string)
-        {
-            auto convertedEvents = CharToKeyEvents(wch, codepage);
-
-            std::move(convertedEvents.begin(),
-                      convertedEvents.end(),
-                      std::back_inserter(keyEvents));
-        }
-
-        WriteInput(keyEvents);
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        gci.GetActiveInputBuffer()->Write(keyRecords);
     }
     return true;
 }
@@ -240,7 +237,7 @@ bool InteractDispatch::FocusChanged(const bool focused) const
 
         WI_UpdateFlag(gci.Flags, CONSOLE_HAS_FOCUS, shouldActuallyFocus);
         gci.ProcessHandleList.ModifyConsoleProcessFocus(shouldActuallyFocus);
-        gci.pInputBuffer->Write(std::make_unique<FocusEvent>(focused));
+        gci.pInputBuffer->WriteFocusEvent(focused);
     }
     // Does nothing outside of ConPTY. If there's a real HWND, then the HWND is solely in charge.
 
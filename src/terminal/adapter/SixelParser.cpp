@@ -0,0 +1,329 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "SixelParser.hpp"
+#include "../parser/stateMachine.hpp"
+#include "../../types/inc/utils.hpp"
+
+using namespace Microsoft::Console::Utils;
+using namespace Microsoft::Console::VirtualTerminal;
+
+// The default color map of a VT340, as RGB percentages. It's repeated to fill
+// all of the color registers. See DEC STD 070, § Color Map Initialization.
+static constexpr std::array<std::array<int, 3>, 16> defaultColors{ {
+    { 0, 0, 0 },
+    { 20, 20, 80 },
+    { 80, 13, 13 },
+    { 20, 80, 20 },
+    { 80, 20, 80 },
+    { 20, 80, 80 },
+    { 80, 80, 20 },
+    { 53, 53, 53 },
+    { 26, 26, 26 },
+    { 33, 33, 60 },
+    { 60, 26, 26 },
+    { 33, 60, 33 },
+    { 60, 33, 60 },
+    { 33, 60, 60 },
+    { 60, 60, 33 },
+    { 80, 80, 80 },
+} };
+
+static constexpr uint32_t toOpaquePixel(const til::color color) noexcept
+{
+    return 0xff000000u | uint32_t{ color.r } << 16 | uint32_t{ color.g } << 8 | uint32_t{ color.b };
+}
+
+// The macro parameter (P1) selects the height of a sixel's pixels relative to their width.
+static constexpr VTInt aspectRatioFromMacroParameter(const VTInt macroParameter) noexcept
+{
+    switch (macroParameter)
+    {
+    case 2:
+        return 5;
+    case 3:
+    case 4:
+        return 3;
+    case 7:
+    case 8:
+    case 9:
+        return 1;
+    default:
+        return 2;
+    }
+}
+
+SixelParser::SixelParser(const VTParameter macroParameter, const DispatchTypes::SixelBackground backgroundSelect) noexcept :
+    _state{ State::Data },
+    _parameters{},
+    _parameterCount{ 0 },
+    _colors{},
+    _currentColor{ 0 },
+    _transparentBackground{ backgroundSelect == DispatchTypes::SixelBackground::Transparent },
+    _aspectRatio{ aspectRatioFromMacroParameter(macroParameter.value_or(0)) },
+    _repeatCount{ 1 },
+    _x{ 0 },
+    _y{ 0 },
+    _declaredWidth{ 0 },
+    _declaredHeight{ 0 },
+    _usedWidth{ 0 },
+    _usedHeight{ 0 },
+    _capacity{}
+{
+    for (size_t i = 0; i < MaxColors; i++)
+    {
+        const auto& rgb = til::at(defaultColors, i % defaultColors.size());
+        til::at(_colors, i) = toOpaquePixel(ColorFromRGB100(rgb[0], rgb[1], rgb[2]));
+    }
+}
+
+// Routine Description:
+// - Processes a character of the sixel data string.
+// Arguments:
+// - ch - the character to process
+// Return Value:
+// - <none>
+void SixelParser::AddData(const wchar_t ch)
+{
+    // The parameters of the control functions are terminated by any other character.
+    if (_state != State::Data)
+    {
+        if (ch >= L'0' && ch <= L'9')
+        {
+            auto& parameter = til::at(_parameters, _parameterCount - 1);
+            parameter = std::min(parameter * 10 + (ch - L'0'), MAX_PARAMETER_VALUE);
+            return;
+        }
+        if (ch == L';')
+        {
+            if (_parameterCount < MaxParameters)
+            {
+                til::at(_parameters, _parameterCount++) = 0;
+            }
+            return;
+        }
+        _applyParameters();
+    }
+
+    const auto beginParameters = [&](const State state) noexcept {
+        _state = state;
+        _parameters = {};
+        _parameterCount = 1;
+    };
+
+    switch (ch)
+    {
+    case L'!': // DECGRI - Graphics Repeat Introducer
+        beginParameters(State::Repeat);
+        break;
+    case L'#': // DECGCI - Graphics Color Introducer
+        beginParameters(State::Color);
+        break;
+    case L'"': // DECGRA - Set Raster Attributes
+        beginParameters(State::RasterAttributes);
+        break;
+    case L'$': // DECGCR - Graphics Carriage Return
+        _x = 0;
+        break;
+    case L'-': // DECGNL - Graphics Next Line
+        _x = 0;
+        _y = std::min(_y + 6 * _aspectRatio, MaxHeight);
+        break;
+    default:
+        if (ch >= L'?' && ch <= L'~')
+        {
+            _addSixel(ch - L'?');
+        }
+        break;
+    }
+}
+
+// Routine Description:
+// - Returns the size of the image in pixels: Either the size that was declared
+//   with the raster attributes or the area that was drawn to, whichever is larger.
+til::size SixelParser::GetSize() const noexcept
+{
+    return { std::max(_declaredWidth, _usedWidth), std::max(_declaredHeight, _usedHeight) };
+}
+
+// Routine Description:
+// - Returns a pixel of the image in premultiplied BGRA. Unless the background
+//   is transparent, the pixels that weren't drawn are filled with color 0.
+uint32_t SixelParser::GetPixel(const til::CoordType x, const til::CoordType y) const
+{
+    auto pixel = uint32_t{ 0 };
+    if (x < _capacity.width && y < _capacity.height)
+    {
+        pixel = til::at(_pixels, gsl::narrow_cast<size_t>(y) * _capacity.width + x);
+    }
+    return pixel || _transparentBackground ? pixel : til::at(_colors, 0);
+}
+
+// Routine Description:
+// - Cuts the image into slices for the rows of the text buffer.
+// Arguments:
+// - column - the column the image starts at
+// - columnLimit - the width of the buffer, at which the image is cut off
+// Return Value:
+// - a slice for each row the image covers, from top to bottom
+std::vector<ImageSlice::Pointer> SixelParser::CreateSlices(const til::CoordType column, const til::CoordType columnLimit) const
+{
+    std::vector<ImageSlice::Pointer> slices;
+
+    const auto size = GetSize();
+    const auto columns = std::min((size.width + CellSize.width - 1) / CellSize.width, columnLimit - column);
+    if (columns <= 0 || size.height <= 0)
+    {
+        return slices;
+    }
+
+    const auto rows = (size.height + CellSize.height - 1) / CellSize.height;
+    const auto width = std::min(size.width, columns * CellSize.width);
+    slices.reserve(rows);
+
+    for (til::CoordType row = 0; row < rows; row++)
+    {
+        auto slice = std::make_shared<ImageSlice>(CellSize, column, column + columns);
+        for (til::CoordType sliceY = 0; sliceY < CellSize.height; sliceY++)
+        {
+            const auto y = row * CellSize.height + sliceY;
+            if (y >= size.height)
+            {
+                break;
+            }
+
+            const auto pixels = slice->MutablePixelRow(sliceY);
+            for (til::CoordType x = 0; x < width; x++)
+            {
+                pixels[x] = GetPixel(x, y);
+            }
+        }
+        slices.emplace_back(std::move(slice));
+    }
+
+    return slices;
+}
+
+void SixelParser::_applyParameters()
+{
+    switch (std::exchange(_state, State::Data))
+    {
+    case State::Repeat:
+        _repeatCount = std::max(til::at(_parameters, 0), 1);
+        break;
+    case State::Color:
+        if (_parameterCount > 1)
+        {
+            _defineColor();
+        }
+        _currentColor = til::at(_parameters, 0) % MaxColors;
+        break;
+    case State::RasterAttributes:
+    {
+        // The aspect ratio is given as a fraction, Pan/Pad, and rounded to the nearest integer.
+        const auto numerator = til::at(_parameters, 0);
+        const auto denominator = til::at(_parameters, 1);
+        if (numerator > 0 && denominator > 0)
+        {
+            _aspectRatio = std::clamp((numerator + denominator / 2) / denominator, 1, MaxHeight);
+        }
+        _declaredWidth = std::min(til::at(_parameters, 2), MaxWidth);
+        _declaredHeight = std::min(til::at(_parameters, 3), MaxHeight);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void SixelParser::_defineColor()
+{
+    // Pc;Pu;Px;Py;Pz - The color number, the color model (1 = HLS, 2 = RGB) and the components.
+    const auto colorModel = DispatchTypes::ColorModel{ til::at(_parameters, 1) };
+    const auto x = til::at(_parameters, 2);
+    const auto y = til::at(_parameters, 3);
+    const auto z = til::at(_parameters, 4);
+    auto& color = til::at(_colors, til::at(_parameters, 0) % MaxColors);
+
+    if (colorModel == DispatchTypes::ColorModel::HLS)
+    {
+        color = toOpaquePixel(ColorFromHLS(x, y, z));
+    }
+    else if (colorModel == DispatchTypes::ColorModel::RGB)
+    {
+        color = toOpaquePixel(ColorFromRGB100(x, y, z));
+    }
+}
+
+// Routine Description:
+// - Draws a sixel, a column of 6 pixels (bit 0 at the top), in the current color.
+//   Each of them is _aspectRatio pixels high and the sixel is repeated as often
+//   as the preceding repeat introducer asked for.
+void SixelParser::_addSixel(const VTInt value)
+{
+    const auto x1 = _x;
+    const auto x2 = std::min(_x + std::exchange(_repeatCount, 1), MaxWidth);
+    _x = x2;
+    _usedWidth = std::max(_usedWidth, x2);
+
+    auto highestBit = -1;
+    for (auto bit = 0; bit < 6; bit++)
+    {
+        if (WI_IsAnyFlagSet(value, 1 << bit))
+        {
+            highestBit = bit;
+        }
+    }
+
+    const auto bottom = std::min(_y + (highestBit + 1) * _aspectRatio, MaxHeight);
+    if (x1 >= x2 || bottom <= _y)
+    {
+        return;
+    }
+
+    _reserve(x2, bottom);
+    _usedHeight = std::max(_usedHeight, bottom);
+
+    const auto color = til::at(_colors, _currentColor);
+    for (auto bit = 0; bit <= highestBit; bit++)
+    {
+        if (WI_IsAnyFlagSet(value, 1 << bit))
+        {
+            const auto y1 = _y + bit * _aspectRatio;
+            const auto y2 = std::min(y1 + _aspectRatio, bottom);
+            for (auto y = y1; y < y2; y++)
+            {
+                const auto row = _pixels.begin() + gsl::narrow_cast<ptrdiff_t>(y) * _capacity.width;
+                std::fill(row + x1, row + x2, color);
+            }
+        }
+    }
+}
+
+// Routine Description:
+// - Grows the pixel buffer so that it covers at least the given size. It
+//   grows exponentially, because the size of an image is usually only known
+//   once it's been drawn, and it never exceeds MaxWidth and MaxHeight.
+void SixelParser::_reserve(const VTInt width, const VTInt height)
+{
+    if (width <= _capacity.width && height <= _capacity.height)
+    {
+        return;
+    }
+
+    const auto grow = [](const VTInt capacity, const VTInt wanted, const VTInt limit) {
+        return wanted <= capacity ? capacity : std::min(std::max(wanted, capacity * 2), limit);
+    };
+    const til::size capacity{ grow(_capacity.width, width, MaxWidth), grow(_capacity.height, height, MaxHeight) };
+
+    std::vector<uint32_t> pixels(gsl::narrow_cast<size_t>(capacity.width) * capacity.height);
+    for (til::CoordType y = 0; y < _capacity.height; y++)
+    {
+        const auto source = _pixels.begin() + gsl::narrow_cast<ptrdiff_t>(y) * _capacity.width;
+        std::copy(source, source + _capacity.width, pixels.begin() + gsl::narrow_cast<ptrdiff_t>(y) * capacity.width);
+    }
+
+    _pixels = std::move(pixels);
+    _capacity = capacity;
+}
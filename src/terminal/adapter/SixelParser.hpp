@@ -0,0 +1,76 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- SixelParser.hpp
+
+Abstract:
+- This decodes the data string of a sixel image (DCS q) into a bitmap and cuts
+  it into the ImageSlices that are attached to the rows of the text buffer.
+- The image is decoded with the pixel size of a VT340, which has cells of
+  10x20 pixels. That's what applications assume when they size their output
+  in rows and columns, and the renderers scale the slices to the actual font.
+--*/
+
+#pragma once
+
+#include "DispatchTypes.hpp"
+#include "../../buffer/out/ImageSlice.hpp"
+
+namespace Microsoft::Console::VirtualTerminal
+{
+    class SixelParser
+    {
+    public:
+        static constexpr til::size CellSize = { 10, 20 };
+        static constexpr VTInt MaxWidth = 2000;
+        static constexpr VTInt MaxHeight = 2000;
+
+        SixelParser(const VTParameter macroParameter, const DispatchTypes::SixelBackground backgroundSelect) noexcept;
+        void AddData(const wchar_t ch);
+
+        til::size GetSize() const noexcept;
+        uint32_t GetPixel(const til::CoordType x, const til::CoordType y) const;
+        std::vector<ImageSlice::Pointer> CreateSlices(const til::CoordType column, const til::CoordType columnLimit) const;
+
+    private:
+        static constexpr size_t MaxColors = 256;
+        static constexpr size_t MaxParameters = 5;
+
+        enum class State
+        {
+            Data,
+            Repeat,
+            Color,
+            RasterAttributes
+        };
+
+        void _applyParameters();
+        void _defineColor();
+        void _addSixel(const VTInt value);
+        void _reserve(const VTInt width, const VTInt height);
+
+        State _state;
+        std::array<VTInt, MaxParameters> _parameters;
+        size_t _parameterCount;
+
+        std::array<uint32_t, MaxColors> _colors;
+        size_t _currentColor;
+        bool _transparentBackground;
+
+        VTInt _aspectRatio;
+        VTInt _repeatCount;
+        VTInt _x;
+        VTInt _y;
+        VTInt _declaredWidth;
+        VTInt _declaredHeight;
+        VTInt _usedWidth;
+        VTInt _usedHeight;
+
+        // The pixels in premultiplied BGRA, _capacity.width pixels per row.
+        // Pixels that weren't drawn yet are transparent, which is a 0.
+        std::vector<uint32_t> _pixels;
+        til::size _capacity;
+    };
+}
@@ -5,6 +5,7 @@
 
 #include "adaptDispatch.hpp"
 #include "../../renderer/base/renderer.hpp"
+#include "../../types/inc/AllocationTracker.hpp"
 #include "../../types/inc/Viewport.hpp"
 #include "../../types/inc/utils.hpp"
 #include "../../inc/unicode.hpp"
@@ -22,6 +23,7 @@ AdaptDispatch::AdaptDispatch(ITerminalApi& api, Renderer& renderer, RenderSettin
     _usingAltBuffer(false),
     _isOriginModeRelative(false), // by default, the DECOM origin mode is absolute.
     _isDECCOLMAllowed(false), // by default, DECCOLM is not allowed.
+    _changeExtent(DispatchTypes::ChangeExtent::Default), // by default, DECCARA changes a stream of characters.
     _termOutput()
 {
 }
@@ -66,6 +68,7 @@ void AdaptDispatch::PrintString(const std::wstring_view string)
     }
     else
     {
+        const AllocationTracker::Scope allocations{ AllocationTracker::IsAsciiPrint(string) ? AllocationStage::AsciiPrint : AllocationStage::Print };
         _api.PrintString(string);
     }
 }
@@ -469,22 +472,10 @@ void AdaptDispatch::_ScrollRectHorizontally(TextBuffer& textBuffer, const til::r
     if (absoluteDelta < scrollRect.width())
     {
         const auto left = delta > 0 ? scrollRect.left : (scrollRect.left + absoluteDelta);
-        const auto top = scrollRect.top;
         const auto width = scrollRect.width() - absoluteDelta;
-        const auto height = scrollRect.height();
         const auto actualDelta = delta > 0 ? absoluteDelta : -absoluteDelta;
-
-        const auto source = Viewport::FromDimensions({ left, top }, width, height);
-        const auto target = Viewport::Offset(source, { actualDelta, 0 });
-        const auto walkDirection = Viewport::DetermineWalkDirection(source, target);
-        auto sourcePos = source.GetWalkOrigin(walkDirection);
-        auto targetPos = target.GetWalkOrigin(walkDirection);
-        do
-        {
-            const auto data = OutputCell(*textBuffer.GetCellDataAt(sourcePos));
-            textBuffer.Write(OutputCellIterator({ &data, 1 }), targetPos);
-            source.WalkInBounds(sourcePos, walkDirection);
-        } while (target.WalkInBounds(targetPos, walkDirection));
+        const auto source = til::rect{ left, scrollRect.top, left + width, scrollRect.bottom };
+        textBuffer.CopyRect(source, { left + actualDelta, scrollRect.top });
     }
 
     // Columns revealed by the scroll are filled with standard erase attributes.
@@ -585,6 +576,211 @@ bool AdaptDispatch::EraseCharacters(const VTInt numChars)
     return true;
 }
 
+// Routine Description:
+// - Converts the VT coordinates of a rectangular area into an exclusive rect
+//   in buffer coordinates, clamped to the page. When the origin mode is set,
+//   the rows are relative to the top margin and clamped to the margins.
+// Arguments:
+// - top, left - The first row and column of the area (1-based).
+// - bottom, right - The last row and column of the area (1-based). A value of
+//   0 means the parameter was omitted, which selects the end of the page.
+// - bufferWidth - The width of the buffer.
+// Return Value:
+// - The area of the buffer. It's empty if the top is below the bottom or the
+//   left is to the right of the right.
+til::rect AdaptDispatch::_CalculateRectArea(const VTInt top, const VTInt left, const VTInt bottom, const VTInt right, const til::CoordType bufferWidth)
+{
+    const auto viewport = _api.GetViewport();
+    const auto [topMargin, bottomMargin] = _GetVerticalMargins(viewport, false);
+    const auto rowOffset = _isOriginModeRelative ? topMargin : 0;
+    const auto rowMaximum = _isOriginModeRelative ? bottomMargin + 1 : viewport.height();
+
+    auto area = til::rect{
+        std::min(left, bufferWidth) - 1,
+        std::min(top + rowOffset, rowMaximum) - 1,
+        std::min(right ? right : bufferWidth, bufferWidth),
+        std::min(bottom ? bottom + rowOffset : rowMaximum, rowMaximum)
+    };
+    area.top += viewport.top;
+    area.bottom += viewport.top;
+    return area;
+}
+
+// Routine Description:
+// - DECCARA - Changes the attributes of a rectangular area, leaving its text
+//   as is. Like in XTerm, any SGR attribute can be changed, not just the ones
+//   the VT terminals supported. Whether the area is a rectangle, or a stream
+//   of characters that wraps from the right edge to the left edge of the page,
+//   is selected with DECSACE.
+// Arguments:
+// - top, left, bottom, right - The area to change (see _CalculateRectArea).
+// - attrs - The SGR attributes to apply.
+// Return Value:
+// - True.
+bool AdaptDispatch::ChangeAttributesRectangularArea(const VTInt top, const VTInt left, const VTInt bottom, const VTInt right, const VTParameters attrs)
+{
+    auto& textBuffer = _api.GetTextBuffer();
+    const auto bufferWidth = textBuffer.GetSize().Width();
+    const auto changeRect = _CalculateRectArea(top, left, bottom, right, bufferWidth);
+    const auto changeAttributes = [&](TextAttribute& attr) {
+        _ApplyGraphicsOptions(attrs, attr);
+    };
+
+    if (_changeExtent == DispatchTypes::ChangeExtent::Rectangle)
+    {
+        if (changeRect.left < changeRect.right && changeRect.top < changeRect.bottom)
+        {
+            textBuffer.ChangeAttributes(changeRect, changeAttributes);
+            _api.NotifyAccessibilityChange(changeRect);
+        }
+    }
+    else if (changeRect.height() == 1)
+    {
+        if (changeRect.left < changeRect.right)
+        {
+            textBuffer.ChangeAttributes(changeRect, changeAttributes);
+            _api.NotifyAccessibilityChange(changeRect);
+        }
+    }
+    else if (changeRect.height() > 1)
+    {
+        // The stream starts at the left of the first row and ends at the right of
+        // the last one, and everything in between is changed across the full width.
+        textBuffer.ChangeAttributes({ changeRect.left, changeRect.top, bufferWidth, changeRect.top + 1 }, changeAttributes);
+        textBuffer.ChangeAttributes({ 0, changeRect.top + 1, bufferWidth, changeRect.bottom - 1 }, changeAttributes);
+        textBuffer.ChangeAttributes({ 0, changeRect.bottom - 1, changeRect.right, changeRect.bottom }, changeAttributes);
+        _api.NotifyAccessibilityChange({ 0, changeRect.top, bufferWidth, changeRect.bottom });
+    }
+
+    return true;
+}
+
+// Routine Description:
+// - DECCRA - Copies a rectangular area to another position on the page. The
+//   source and the target may overlap. Since we only support a single page,
+//   the page parameters are ignored.
+// Arguments:
+// - top, left, bottom, right - The area to copy (see _CalculateRectArea).
+// - page - The page of the area to copy (ignored).
+// - dstTop, dstLeft - The top left corner of the target (1-based). The copy
+//   is clipped to the page, or the margins if the origin mode is set.
+// - dstPage - The page of the target (ignored).
+// Return Value:
+// - True.
+bool AdaptDispatch::CopyRectangularArea(const VTInt top, const VTInt left, const VTInt bottom, const VTInt right, const VTInt /*page*/, const VTInt dstTop, const VTInt dstLeft, const VTInt /*dstPage*/)
+{
+    auto& textBuffer = _api.GetTextBuffer();
+    const auto bufferWidth = textBuffer.GetSize().Width();
+    const auto srcRect = _CalculateRectArea(top, left, bottom, right, bufferWidth);
+    if (srcRect.left < srcRect.right && srcRect.top < srcRect.bottom)
+    {
+        const auto dstBottom = dstTop + srcRect.height() - 1;
+        const auto dstRight = dstLeft + srcRect.width() - 1;
+        const auto dstRect = _CalculateRectArea(dstTop, dstLeft, dstBottom, dstRight, bufferWidth);
+        if (dstRect.left < dstRect.right && dstRect.top < dstRect.bottom)
+        {
+            // The target may have been clipped, in which case so is the source.
+            const auto clippedSrcRect = til::rect{ srcRect.left, srcRect.top, srcRect.left + dstRect.width(), srcRect.top + dstRect.height() };
+            textBuffer.CopyRect(clippedSrcRect, { dstRect.left, dstRect.top });
+            _api.NotifyAccessibilityChange(dstRect);
+        }
+    }
+    return true;
+}
+
+// Routine Description:
+// - DECFRA - Fills a rectangular area with a character, using the current
+//   attributes. The character goes through the active character set, the
+//   same as if it had been printed. Control characters are ignored.
+// Arguments:
+// - ch - The code of the character to fill the area with.
+// - top, left, bottom, right - The area to fill (see _CalculateRectArea).
+// Return Value:
+// - True.
+bool AdaptDispatch::FillRectangularArea(const VTParameter ch, const VTInt top, const VTInt left, const VTInt bottom, const VTInt right)
+{
+    auto& textBuffer = _api.GetTextBuffer();
+    const auto fillRect = _CalculateRectArea(top, left, bottom, right, textBuffer.GetSize().Width());
+
+    // The standard only allows characters of the GL and GR tables, but any other
+    // printable BMP character works just as well, as long as it isn't a surrogate.
+    const auto charValue = ch.value_or(0);
+    const auto isC0orC1 = charValue < 32 || (charValue >= 127 && charValue < 160);
+    const auto isSurrogate = charValue >= 0xD800 && charValue <= 0xDFFF;
+    if (!isC0orC1 && !isSurrogate && charValue <= 0xFFFF)
+    {
+        const auto fillChar = _termOutput.TranslateKey(gsl::narrow_cast<wchar_t>(charValue));
+        _FillRect(textBuffer, fillRect, fillChar, textBuffer.GetCurrentAttributes());
+    }
+    return true;
+}
+
+// Routine Description:
+// - DECERA - Erases a rectangular area, by replacing its characters with
+//   spaces. Like ECH, the erased positions receive the current attributes
+//   with the standard erase applied.
+// Arguments:
+// - top, left, bottom, right - The area to erase (see _CalculateRectArea).
+// Return Value:
+// - True.
+bool AdaptDispatch::EraseRectangularArea(const VTInt top, const VTInt left, const VTInt bottom, const VTInt right)
+{
+    auto& textBuffer = _api.GetTextBuffer();
+    const auto eraseRect = _CalculateRectArea(top, left, bottom, right, textBuffer.GetSize().Width());
+    auto eraseAttributes = textBuffer.GetCurrentAttributes();
+    eraseAttributes.SetStandardErase();
+    _FillRect(textBuffer, eraseRect, L' ', eraseAttributes);
+    return true;
+}
+
+// Routine Description:
+// - DECSERA - Selectively erases a rectangular area. Only the characters that
+//   aren't protected are replaced by spaces, and their attributes are left as
+//   they are. We don't support protecting characters (DECSCA), so this erases
+//   every character of the area.
+// Arguments:
+// - top, left, bottom, right - The area to erase (see _CalculateRectArea).
+// Return Value:
+// - True.
+bool AdaptDispatch::SelectiveEraseRectangularArea(const VTInt top, const VTInt left, const VTInt bottom, const VTInt right)
+{
+    auto& textBuffer = _api.GetTextBuffer();
+    const auto eraseRect = _CalculateRectArea(top, left, bottom, right, textBuffer.GetSize().Width());
+    if (eraseRect.left < eraseRect.right && eraseRect.top < eraseRect.bottom)
+    {
+        // An iterator without attributes leaves the existing ones in place.
+        const auto eraseWidth = gsl::narrow_cast<size_t>(eraseRect.width());
+        const auto eraseData = OutputCellIterator{ L' ', eraseWidth };
+        for (auto row = eraseRect.top; row < eraseRect.bottom; row++)
+        {
+            textBuffer.WriteLine(eraseData, { eraseRect.left, row }, false);
+        }
+        _api.NotifyAccessibilityChange(eraseRect);
+    }
+    return true;
+}
+
+// Routine Description:
+// - DECSACE - Selects whether DECCARA changes the attributes of a rectangle,
+//   or of a stream of characters.
+// Arguments:
+// - changeExtent - Whether the extent is a stream or a rectangle.
+// Return Value:
+// - True if the extent is supported, false otherwise.
+bool AdaptDispatch::SelectAttributeChangeExtent(const DispatchTypes::ChangeExtent changeExtent) noexcept
+{
+    switch (changeExtent)
+    {
+    case DispatchTypes::ChangeExtent::Default:
+    case DispatchTypes::ChangeExtent::Stream:
+    case DispatchTypes::ChangeExtent::Rectangle:
+        _changeExtent = changeExtent;
+        return true;
+    default:
+        return false;
+    }
+}
+
 // Routine Description:
 // - ED - Erases a portion of the current viewable area (viewport) of the console.
 // Arguments:
@@ -1065,6 +1261,9 @@ bool AdaptDispatch::_ModeParamsHelper(const DispatchTypes::ModeParams param, con
     case DispatchTypes::ModeParams::XTERM_BracketedPasteMode:
         success = EnableXtermBracketedPasteMode(enable);
         break;
+    case DispatchTypes::ModeParams::SO_SynchronizedOutput:
+        success = EnableSynchronizedOutput(enable);
+        break;
     case DispatchTypes::ModeParams::W32IM_Win32InputMode:
         success = EnableWin32InputMode(enable);
         break;
@@ -1870,6 +2069,10 @@ bool AdaptDispatch::HardReset()
     // Cursor to 1,1 - the Soft Reset guarantees this is absolute
     CursorPosition(1, 1);
 
+    // Don't keep holding back the frames of an application that was reset before
+    // it got to finish its update. The RIS itself is forwarded to a ConPTY terminal.
+    _renderer.SetSynchronizedOutput(false);
+
     // Reset the mouse mode
     EnableSGRExtendedMouseMode(false);
     EnableAnyEventMouseMode(false);
@@ -1881,6 +2084,9 @@ bool AdaptDispatch::HardReset()
     _renderer.UpdateSoftFont({}, {}, false);
     _fontBuffer = nullptr;
 
+    // Reset the attribute change extent of DECCARA.
+    _changeExtent = DispatchTypes::ChangeExtent::Default;
+
     // GH#2715 - If all this succeeded, but we're in a conpty, return `false` to
     // make the state machine propagate this RIS sequence to the connected
     // terminal application. We've reset our state, but the connected terminal
@@ -1944,10 +2150,11 @@ void AdaptDispatch::_EraseScrollback()
 
     // Scroll the viewport content to the top of the buffer.
     textBuffer.ScrollRows(top, height, -top);
-    // Clear everything after the viewport.
-    _FillRect(textBuffer, { 0, height, bufferSize.X, bufferSize.Y }, L' ', {});
-    // Also reset the line rendition for all of the cleared rows.
-    textBuffer.ResetLineRenditionRange(height, bufferSize.Y);
+    // Clear everything after the viewport. Resetting the rows in bulk also
+    // resets their line rendition and is much faster than filling them with
+    // blanks, which matters when the scrollback is large.
+    textBuffer.ResetRows(height, bufferSize.Y, {});
+    _api.NotifyAccessibilityChange({ 0, height, bufferSize.X, bufferSize.Y });
     // Move the viewport
     _api.SetViewportPosition({ viewport.left, 0 });
     // Move the cursor to the same relative location.
@@ -2121,6 +2328,42 @@ bool AdaptDispatch::EnableXtermBracketedPasteMode(const bool enabled)
     return true;
 }
 
+// Method Description:
+// - Synchronized output: while enabled, the application is redrawing the screen
+//   and the renderer holds back its frames, so that it only ever paints complete
+//   ones. It paints once the mode is reset, or after a timeout.
+// Arguments:
+// - enabled - true when the application begins its update, false once it's done.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::EnableSynchronizedOutput(const bool enabled)
+{
+    const auto isPty = _api.IsConsolePty();
+
+    // In ConPTY everything that was output before the sequence has to reach the terminal
+    // before the sequence itself, which we forward below to let it hold its frames back as
+    // well. The VT engine thus paints once right before the update begins, and once more
+    // with all of the update right before it ends, which makes that one coherent frame.
+    if (enabled)
+    {
+        if (isPty)
+        {
+            _renderer.TriggerFlush(false);
+        }
+        _renderer.SetSynchronizedOutput(true);
+    }
+    else
+    {
+        _renderer.SetSynchronizedOutput(false);
+        if (isPty)
+        {
+            _renderer.TriggerFlush(false);
+        }
+    }
+
+    return !isPty;
+}
+
 //Routine Description:
 // Set Cursor Style - Changes the cursor's style to match the given Dispatch
 //      cursor style. Unix styles are a combination of the shape and the blinking state.
@@ -2641,6 +2884,71 @@ ITermDispatch::StringHandler AdaptDispatch::DownloadDRCS(const VTInt fontNumber,
     };
 }
 
+// Method Description:
+// - DECSIXEL - Defines a sixel image, which is displayed at the cursor position
+//   once the data string is complete. The image is attached to the rows of the
+//   buffer, so that it scrolls with the text, and the cursor is moved to the
+//   line below it, scrolling the buffer if the image doesn't fit otherwise.
+// Arguments:
+// - macroParameter - selects the aspect ratio of the image's pixels.
+// - backgroundSelect - whether pixels that aren't drawn are transparent.
+// Return Value:
+// - a function to receive the sixel data or nullptr if images aren't supported.
+ITermDispatch::StringHandler AdaptDispatch::DefineSixelImage(const VTParameter macroParameter,
+                                                             const DispatchTypes::SixelBackground backgroundSelect)
+{
+    // If we're a conpty, we're going to ignore the image, just like we do for
+    // soft fonts. Passing it through would leave the connected terminal's
+    // cursor and scroll position out of sync with ours, since we don't know
+    // how many rows it's going to cover.
+    if (_api.IsConsolePty())
+    {
+        return nullptr;
+    }
+
+    _sixelParser = std::make_unique<SixelParser>(macroParameter, backgroundSelect);
+
+    return [=](const auto ch) {
+        // We pass the data string straight through to the parser until we
+        // receive an ESC, indicating the end of the string. At that point
+        // the image is complete and can be displayed.
+        if (ch != AsciiChars::ESC)
+        {
+            _sixelParser->AddData(ch);
+            return true;
+        }
+
+        _DisplaySixelImage(*_sixelParser);
+        _sixelParser.reset();
+        return false;
+    };
+}
+
+// Routine Description:
+// - Attaches the slices of a sixel image to the rows starting at the cursor
+//   position, followed by a line feed for each of them.
+// Arguments:
+// - sixelParser - the parser holding the complete image.
+// Return Value:
+// - <none>
+void AdaptDispatch::_DisplaySixelImage(const SixelParser& sixelParser)
+{
+    auto& textBuffer = _api.GetTextBuffer();
+    const auto column = textBuffer.GetCursor().GetPosition().x;
+    const auto bufferWidth = textBuffer.GetSize().Width();
+
+    for (const auto& slice : sixelParser.CreateSlices(column, bufferWidth))
+    {
+        // The line feed of the previous slice might have scrolled the buffer,
+        // which is why the row is looked up with the current cursor position.
+        const auto row = textBuffer.GetCursor().GetPosition().y;
+        auto& bufferRow = textBuffer.GetRowByOffset(row);
+        bufferRow.SetImageSlice(ImageSlice::Merge(bufferRow.GetImageSlice(), slice));
+        textBuffer.TriggerRedraw(Viewport::FromExclusive({ slice->ColumnBegin(), row, slice->ColumnEnd(), row + 1 }));
+        _api.LineFeed(false);
+    }
+}
+
 // Method Description:
 // - DECRSTS - Restores the terminal state from a stream of data previously
 //   saved with a DECRQTSR query.
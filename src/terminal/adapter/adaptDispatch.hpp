@@ -17,6 +17,7 @@ Author(s):
 #include "termDispatch.hpp"
 #include "ITerminalApi.hpp"
 #include "FontBuffer.hpp"
+#include "SixelParser.hpp"
 #include "terminalOutput.hpp"
 #include "../input/terminalInput.hpp"
 #include "../../types/inc/sgrStack.hpp"
@@ -51,6 +52,12 @@ namespace Microsoft::Console::VirtualTerminal
         bool EraseInDisplay(const DispatchTypes::EraseType eraseType) override; // ED
         bool EraseInLine(const DispatchTypes::EraseType eraseType) override; // EL
         bool EraseCharacters(const VTInt numChars) override; // ECH
+        bool ChangeAttributesRectangularArea(const VTInt top, const VTInt left, const VTInt bottom, const VTInt right, const VTParameters attrs) override; // DECCARA
+        bool CopyRectangularArea(const VTInt top, const VTInt left, const VTInt bottom, const VTInt right, const VTInt page, const VTInt dstTop, const VTInt dstLeft, const VTInt dstPage) override; // DECCRA
+        bool FillRectangularArea(const VTParameter ch, const VTInt top, const VTInt left, const VTInt bottom, const VTInt right) override; // DECFRA
+        bool EraseRectangularArea(const VTInt top, const VTInt left, const VTInt bottom, const VTInt right) override; // DECERA
+        bool SelectiveEraseRectangularArea(const VTInt top, const VTInt left, const VTInt bottom, const VTInt right) override; // DECSERA
+        bool SelectAttributeChangeExtent(const DispatchTypes::ChangeExtent changeExtent) noexcept override; // DECSACE
         bool InsertCharacter(const VTInt count) override; // ICH
         bool DeleteCharacter(const VTInt count) override; // DCH
         bool SetGraphicsRendition(const VTParameters options) override; // SGR
@@ -110,6 +117,7 @@ namespace Microsoft::Console::VirtualTerminal
         bool EnableFocusEventMode(const bool enabled) override; // ?1004
         bool EnableAlternateScroll(const bool enabled) override; // ?1007
         bool EnableXtermBracketedPasteMode(const bool enabled) override; // ?2004
+        bool EnableSynchronizedOutput(const bool enabled) override; // ?2026
         bool SetCursorStyle(const DispatchTypes::CursorStyle cursorStyle) override; // DECSCUSR
         bool SetCursorColor(const COLORREF cursorColor) override;
 
@@ -134,6 +142,9 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool DoFinalTermAction(const std::wstring_view string) override;
 
+        StringHandler DefineSixelImage(const VTParameter macroParameter,
+                                       const DispatchTypes::SixelBackground backgroundSelect) override; // DECSIXEL
+
         StringHandler DownloadDRCS(const VTInt fontNumber,
                                    const VTParameter startChar,
                                    const DispatchTypes::DrcsEraseControl eraseControl,
@@ -180,6 +191,7 @@ namespace Microsoft::Console::VirtualTerminal
         bool _CursorMovePosition(const Offset rowOffset, const Offset colOffset, const bool clampInMargins);
         void _ApplyCursorMovementFlags(Cursor& cursor) noexcept;
         void _FillRect(TextBuffer& textBuffer, const til::rect& fillRect, const wchar_t fillChar, const TextAttribute fillAttrs);
+        til::rect _CalculateRectArea(const VTInt top, const VTInt left, const VTInt bottom, const VTInt right, const til::CoordType bufferWidth);
         void _EraseScrollback();
         void _EraseAll();
         void _ScrollRectVertically(TextBuffer& textBuffer, const til::rect& scrollRect, const VTInt delta);
@@ -205,6 +217,7 @@ namespace Microsoft::Console::VirtualTerminal
         void _InitTabStopsForWidth(const VTInt width);
 
         StringHandler _RestoreColorTable();
+        void _DisplaySixelImage(const SixelParser& sixelParser);
 
         void _ReportSGRSetting() const;
         void _ReportDECSTBMSetting();
@@ -220,6 +233,7 @@ namespace Microsoft::Console::VirtualTerminal
         TerminalInput& _terminalInput;
         TerminalOutput _termOutput;
         std::unique_ptr<FontBuffer> _fontBuffer;
+        std::unique_ptr<SixelParser> _sixelParser;
         std::optional<unsigned int> _initialCodePage;
 
         // We have two instances of the saved cursor state, because we need
@@ -236,8 +250,26 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool _isDECCOLMAllowed;
 
+        DispatchTypes::ChangeExtent _changeExtent;
+
         SgrStack _sgrStack;
 
+        struct SgrCacheEntry
+        {
+            // Enough for the longest common SGR, which sets an RGB color.
+            static constexpr size_t MaxOptions = 5;
+
+            TextAttribute Before = {};
+            TextAttribute After = {};
+            std::array<VTInt, MaxOptions> Options = {};
+            size_t OptionCount = 0;
+        };
+        std::array<SgrCacheEntry, 8> _sgrCache;
+        size_t _sgrCacheNext = 0;
+
+        void _ApplyGraphicsOptions(const VTParameters options, TextAttribute& attr);
+        const SgrCacheEntry* _FindSgrCacheEntry(const VTParameters options, const TextAttribute& before) const noexcept;
+        void _AddSgrCacheEntry(const VTParameters options, const TextAttribute& before, const TextAttribute& after) noexcept;
         size_t _SetRgbColorsHelper(const VTParameters options,
                                    TextAttribute& attr,
                                    const bool isForeground) noexcept;
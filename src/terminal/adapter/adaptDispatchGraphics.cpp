@@ -76,6 +76,34 @@ bool AdaptDispatch::SetGraphicsRendition(const VTParameters options)
 {
     auto attr = _api.GetTextBuffer().GetCurrentAttributes();
 
+    // Applications tend to emit the same few SGR sequences over and over again,
+    // so the result of the most recent ones is remembered for the attributes
+    // they were applied to, and reused if both of them match.
+    if (const auto entry = _FindSgrCacheEntry(options, attr))
+    {
+        attr = entry->After;
+    }
+    else
+    {
+        const auto before = attr;
+        _ApplyGraphicsOptions(options, attr);
+        _AddSgrCacheEntry(options, before, attr);
+    }
+    _api.SetTextAttributes(attr);
+
+    return true;
+}
+
+// Routine Description:
+// - Applies the given SGR options to the given attributes.
+// Arguments:
+// - options - An array of options that will be applied from 0 to N, in order,
+//   one at a time by setting or removing flags in the font style properties.
+// - attr - The attributes that will be updated.
+// Return Value:
+// - <none>
+void AdaptDispatch::_ApplyGraphicsOptions(const VTParameters options, TextAttribute& attr)
+{
     // Run through the graphics options and apply them
     for (size_t i = 0; i < options.size(); i++)
     {
@@ -254,9 +282,70 @@ bool AdaptDispatch::SetGraphicsRendition(const VTParameters options)
             break;
         }
     }
-    _api.SetTextAttributes(attr);
+}
 
-    return true;
+// Routine Description:
+// - Looks for the result of a previous SGR with the same options, that
+//   was applied to the same attributes.
+// Arguments:
+// - options - The options of the SGR.
+// - before - The attributes the SGR is going to be applied to.
+// Return Value:
+// - The matching cache entry, or nullptr if there is none.
+const AdaptDispatch::SgrCacheEntry* AdaptDispatch::_FindSgrCacheEntry(const VTParameters options, const TextAttribute& before) const noexcept
+{
+    if (options.size() > SgrCacheEntry::MaxOptions)
+    {
+        return nullptr;
+    }
+
+    // Start with the most recently added entry, since it's the most likely to match again.
+    for (size_t i = 0; i < _sgrCache.size(); i++)
+    {
+        const auto& entry = til::at(_sgrCache, (_sgrCacheNext + _sgrCache.size() - 1 - i) % _sgrCache.size());
+        if (entry.OptionCount != options.size() || entry.Before != before)
+        {
+            continue;
+        }
+
+        auto matches = true;
+        for (size_t j = 0; j < entry.OptionCount && matches; j++)
+        {
+            matches = til::at(entry.Options, j) == options.at(j).value();
+        }
+        if (matches)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+// Routine Description:
+// - Remembers the result of an SGR, replacing the oldest cache entry.
+//   SGRs with more than SgrCacheEntry::MaxOptions options aren't cached.
+// Arguments:
+// - options - The options of the SGR.
+// - before - The attributes the SGR was applied to.
+// - after - The resulting attributes.
+// Return Value:
+// - <none>
+void AdaptDispatch::_AddSgrCacheEntry(const VTParameters options, const TextAttribute& before, const TextAttribute& after) noexcept
+{
+    if (options.size() > SgrCacheEntry::MaxOptions)
+    {
+        return;
+    }
+
+    auto& entry = til::at(_sgrCache, _sgrCacheNext);
+    entry.Before = before;
+    entry.After = after;
+    entry.OptionCount = options.size();
+    for (size_t i = 0; i < entry.OptionCount; i++)
+    {
+        til::at(entry.Options, i) = options.at(i).value();
+    }
+    _sgrCacheNext = (_sgrCacheNext + 1) % _sgrCache.size();
 }
 
 // Method Description:
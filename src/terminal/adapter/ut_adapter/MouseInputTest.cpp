@@ -651,4 +651,40 @@ public:
         mouseInput->SetInputMode(TerminalInput::Mode::AlternateScroll, true);
         VERIFY_IS_FALSE(mouseInput->HandleMouse({ 0, 0 }, WM_MOUSEWHEEL, noModifierKeys, WHEEL_DELTA, {}));
     }
+
+    TEST_METHOD(AccumulatesFractionalWheelDeltas)
+    {
+        std::vector<std::wstring> sequences;
+        auto mouseInput = std::make_unique<TerminalInput>([&](std::deque<std::unique_ptr<IInputEvent>>& events) {
+            std::wstring sequence;
+            for (const auto& event : events)
+            {
+                sequence.push_back(static_cast<const KeyEvent*>(event.get())->GetCharData());
+            }
+            sequences.emplace_back(std::move(sequence));
+        });
+        mouseInput->SetInputMode(TerminalInput::Mode::DefaultMouseTracking, true);
+        mouseInput->SetInputMode(TerminalInput::Mode::SgrMouseEncoding, true);
+        const short noModifierKeys = 0;
+
+        Log::Comment(L"Fractions of a WHEEL_DELTA are accumulated until they add up to one");
+        VERIFY_IS_TRUE(mouseInput->HandleMouse({ 0, 0 }, WM_MOUSEWHEEL, noModifierKeys, 50, {}));
+        VERIFY_IS_TRUE(mouseInput->HandleMouse({ 0, 0 }, WM_MOUSEWHEEL, noModifierKeys, 50, {}));
+        VERIFY_ARE_EQUAL(size_t{ 0 }, sequences.size());
+        VERIFY_IS_TRUE(mouseInput->HandleMouse({ 0, 0 }, WM_MOUSEWHEEL, noModifierKeys, 50, {}));
+        VERIFY_ARE_EQUAL(size_t{ 1 }, sequences.size());
+
+        Log::Comment(L"The remainder is kept for the next event");
+        VERIFY_IS_TRUE(mouseInput->HandleMouse({ 0, 0 }, WM_MOUSEWHEEL, noModifierKeys, 90, {}));
+        VERIFY_ARE_EQUAL(size_t{ 2 }, sequences.size());
+
+        Log::Comment(L"Each whole WHEEL_DELTA is sent as an event of its own");
+        sequences.clear();
+        VERIFY_IS_TRUE(mouseInput->HandleMouse({ 0, 0 }, WM_MOUSEWHEEL, noModifierKeys, -3 * WHEEL_DELTA, {}));
+        VERIFY_ARE_EQUAL(size_t{ 3 }, sequences.size());
+        for (const auto& sequence : sequences)
+        {
+            VERIFY_ARE_EQUAL(std::wstring{ L"\x1b[<65;1;1M" }, sequence);
+        }
+    }
 };
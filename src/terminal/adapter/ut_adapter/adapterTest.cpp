@@ -1354,6 +1354,47 @@ public:
         VERIFY_IS_TRUE(_testGetSet->_textBuffer->GetCurrentAttributes().IsIntense());
     }
 
+    TEST_METHOD(GraphicsCacheTests)
+    {
+        Log::Comment(L"Starting test...");
+
+        _testGetSet->PrepData();
+
+        VTParameter rgOptions[16];
+        VTParameter rgRgbOptions[] = { DispatchTypes::GraphicsOptions::ForegroundExtended, DispatchTypes::GraphicsOptions::RGBColorOrFaint, 10, 20, 30 };
+
+        Log::Comment(L"Resetting graphics options");
+        rgOptions[0] = DispatchTypes::GraphicsOptions::Off;
+        _testGetSet->_expectedAttribute = {};
+        VERIFY_IS_TRUE(_pDispatch->SetGraphicsRendition({ rgOptions, 1 }));
+
+        Log::Comment(L"Testing graphics 'Foreground RGB'");
+        _testGetSet->_expectedAttribute.SetForeground(RGB(10, 20, 30));
+        VERIFY_IS_TRUE(_pDispatch->SetGraphicsRendition({ rgRgbOptions, std::size(rgRgbOptions) }));
+
+        Log::Comment(L"Enabling brightness");
+        rgOptions[0] = DispatchTypes::GraphicsOptions::Intense;
+        _testGetSet->_expectedAttribute.SetIntense(true);
+        VERIFY_IS_TRUE(_pDispatch->SetGraphicsRendition({ rgOptions, 1 }));
+
+        Log::Comment(L"Repeating 'Foreground RGB' keeps the brightness, despite the earlier result of the same options");
+        VERIFY_IS_TRUE(_pDispatch->SetGraphicsRendition({ rgRgbOptions, std::size(rgRgbOptions) }));
+        VERIFY_IS_TRUE(_testGetSet->_textBuffer->GetCurrentAttributes().IsIntense());
+
+        Log::Comment(L"Resetting graphics options again, and repeating 'Foreground RGB' once more");
+        rgOptions[0] = DispatchTypes::GraphicsOptions::Off;
+        _testGetSet->_expectedAttribute = {};
+        VERIFY_IS_TRUE(_pDispatch->SetGraphicsRendition({ rgOptions, 1 }));
+        _testGetSet->_expectedAttribute.SetForeground(RGB(10, 20, 30));
+        VERIFY_IS_TRUE(_pDispatch->SetGraphicsRendition({ rgRgbOptions, std::size(rgRgbOptions) }));
+        VERIFY_IS_FALSE(_testGetSet->_textBuffer->GetCurrentAttributes().IsIntense());
+
+        Log::Comment(L"A different RGB color with the same number of options doesn't match");
+        rgRgbOptions[4] = 40;
+        _testGetSet->_expectedAttribute.SetForeground(RGB(10, 20, 40));
+        VERIFY_IS_TRUE(_pDispatch->SetGraphicsRendition({ rgRgbOptions, std::size(rgRgbOptions) }));
+    }
+
     TEST_METHOD(DeviceStatusReportTests)
     {
         Log::Comment(L"Starting test...");
@@ -1676,6 +1717,20 @@ public:
         VERIFY_IS_FALSE(_stateMachine->GetParserMode(StateMachine::Mode::Ansi));
     }
 
+    TEST_METHOD(SynchronizedOutputModeTest)
+    {
+        Log::Comment(L"Starting test...");
+
+        Log::Comment(L"Test 1: the mode is handled outside of ConPTY");
+        VERIFY_IS_TRUE(_pDispatch->SetMode(DispatchTypes::ModeParams::SO_SynchronizedOutput));
+        VERIFY_IS_TRUE(_pDispatch->ResetMode(DispatchTypes::ModeParams::SO_SynchronizedOutput));
+
+        Log::Comment(L"Test 2: ConPTY forwards the mode to the terminal as well");
+        _testGetSet->_isPty = true;
+        VERIFY_IS_FALSE(_pDispatch->SetMode(DispatchTypes::ModeParams::SO_SynchronizedOutput));
+        VERIFY_IS_FALSE(_pDispatch->ResetMode(DispatchTypes::ModeParams::SO_SynchronizedOutput));
+    }
+
     TEST_METHOD(AllowBlinkingTest)
     {
         Log::Comment(L"Starting test...");
@@ -2225,6 +2280,55 @@ public:
         VERIFY_IS_TRUE(decdld(CellMatrix::Default, 0, FontSet::Size132x24, FontUsage::FullCell, bitmapOf6x18));
     }
 
+    TEST_METHOD(SixelImageDecoding)
+    {
+        using Background = DispatchTypes::SixelBackground;
+
+        const auto decode = [](const std::wstring_view data, const Background background) {
+            auto parser = std::make_unique<SixelParser>(VTParameter{}, background);
+            for (const auto ch : data)
+            {
+                parser->AddData(ch);
+            }
+            return parser;
+        };
+
+        Log::Comment(L"Raster attributes set a 1:1 aspect ratio and declare the size.");
+        auto parser = decode(L"\"1;1;4;6#1;2;100;0;0#1!3~", Background::Transparent);
+        VERIFY_ARE_EQUAL(4, parser->GetSize().width);
+        VERIFY_ARE_EQUAL(6, parser->GetSize().height);
+        VERIFY_ARE_EQUAL(0xffff0000u, parser->GetPixel(0, 0));
+        VERIFY_ARE_EQUAL(0xffff0000u, parser->GetPixel(2, 5));
+        VERIFY_ARE_EQUAL(0u, parser->GetPixel(3, 0));
+
+        Log::Comment(L"Without a transparent background, the pixels that weren't drawn have color 0.");
+        parser = decode(L"\"1;1;4;6#1;2;100;0;0#1!3~", Background::Default);
+        VERIFY_ARE_EQUAL(0xff000000u, parser->GetPixel(3, 0));
+
+        Log::Comment(L"By default pixels are 2:1 and each band is 6 sixels high.");
+        parser = decode(L"#2;2;0;100;0@-@", Background::Transparent);
+        VERIFY_ARE_EQUAL(1, parser->GetSize().width);
+        VERIFY_ARE_EQUAL(14, parser->GetSize().height);
+        VERIFY_ARE_EQUAL(0xff00ff00u, parser->GetPixel(0, 1));
+        VERIFY_ARE_EQUAL(0u, parser->GetPixel(0, 2));
+        VERIFY_ARE_EQUAL(0xff00ff00u, parser->GetPixel(0, 13));
+
+        Log::Comment(L"The image is cut into slices of a row each, with 10x20 pixels per cell.");
+        parser = decode(L"\"1;1;15;30#1;2;100;0;0#1!15~-!15~-!15~-!15~-!15~", Background::Transparent);
+        auto slices = parser->CreateSlices(3, 80);
+        VERIFY_ARE_EQUAL(2u, slices.size());
+        VERIFY_ARE_EQUAL(3, slices[0]->ColumnBegin());
+        VERIFY_ARE_EQUAL(5, slices[0]->ColumnEnd());
+        VERIFY_ARE_EQUAL(0xffff0000u, slices[1]->PixelRow(9)[14]);
+        VERIFY_ARE_EQUAL(0u, slices[1]->PixelRow(10)[14]);
+        VERIFY_ARE_EQUAL(0u, slices[0]->PixelRow(0)[15]);
+
+        Log::Comment(L"Slices are cut off at the right edge of the buffer.");
+        slices = parser->CreateSlices(79, 80);
+        VERIFY_ARE_EQUAL(79, slices[0]->ColumnBegin());
+        VERIFY_ARE_EQUAL(80, slices[0]->ColumnEnd());
+    }
+
     TEST_METHOD(TogglingC1ParserMode)
     {
         _stateMachine->SetParserMode(StateMachine::Mode::AcceptC1, false);
@@ -312,6 +312,8 @@ bool TerminalInput::HandleMouse(const til::point position,
         _mouseInputState.accumulatedDelta = 0;
     }
 
+    // The number of times the event is sent. Only wheel events can be sent more than once.
+    auto repeatCount = 1;
     if (_isWheelMsg(button))
     {
         _mouseInputState.accumulatedDelta += delta;
@@ -324,15 +326,20 @@ bool TerminalInput::HandleMouse(const til::point position,
             return IsTrackingMouseInput() || ShouldSendAlternateScroll(button, delta);
         }
 
-        // We're ready to send this event through, but first we need to clear the accumulated;
-        // delta. Otherwise, we'll dispatch every subsequent sub-delta event as its own event.
-        _mouseInputState.accumulatedDelta = 0;
+        // Every WHEEL_DELTA of the accumulated delta is one "line" worth of scroll and sent
+        // as an event of its own. The remainder is kept for the next event, because high
+        // resolution wheels and touchpads report fractions of a WHEEL_DELTA at a time.
+        repeatCount = std::abs(_mouseInputState.accumulatedDelta) / WHEEL_DELTA;
+        _mouseInputState.accumulatedDelta %= WHEEL_DELTA;
     }
 
     auto success = false;
     if (ShouldSendAlternateScroll(button, delta))
     {
-        success = _SendAlternateScroll(delta);
+        for (auto i = 0; i < repeatCount; ++i)
+        {
+            success = _SendAlternateScroll(delta);
+        }
     }
     else
     {
@@ -400,8 +407,10 @@ bool TerminalInput::HandleMouse(const til::point position,
 
                 if (success)
                 {
-                    _SendInputSequence(sequence);
-                    success = true;
+                    for (auto i = 0; i < repeatCount; ++i)
+                    {
+                        _SendInputSequence(sequence);
+                    }
                 }
                 if (_inputMode.any(Mode::ButtonEventMouseTracking, Mode::AnyEventMouseTracking))
                 {
@@ -11,6 +11,7 @@
 #include <wil/Common.h>
 
 #include "../../inc/unicode.hpp"
+#include "../../types/inc/AllocationTracker.hpp"
 #include "../../types/inc/Utf16Parser.hpp"
 
 using namespace Microsoft::Console::VirtualTerminal;
@@ -246,6 +247,91 @@ const wchar_t* const CTRL_QUESTIONMARK_SEQUENCE = L"\x7F";
 const wchar_t* const CTRL_ALT_SLASH_SEQUENCE = L"\x1b\x1f";
 const wchar_t* const CTRL_ALT_QUESTIONMARK_SEQUENCE = L"\x1b\x7F";
 
+// Routine Description:
+// - Maps a virtual key and the state of the Shift, Alt and Ctrl keys directly to the
+//   entry of a key mapping that the key matches. Entries without modifiers match the
+//   key no matter which modifiers are pressed, whereas entries with modifiers only match
+//   if exactly those modifiers are pressed. If several entries match, the first one wins.
+// - The tables are generated at compile time, which turns looking up a key into a single
+//   array access instead of a linear search through the mapping for every key press.
+class TermKeyLookup
+{
+public:
+    template<size_t N>
+    constexpr TermKeyLookup(const std::array<TermKeyMap, N>& mapping) noexcept :
+        _mapping{ mapping.data() },
+        _indices{}
+    {
+        static_assert(N < UINT8_MAX, "the indices are stored as uint8_t");
+
+        for (size_t i = 0; i < N; ++i)
+        {
+            const auto& map = mapping[i];
+            const auto anyModifiers = (map.modifiers & MOD_PRESSED) == 0;
+            const auto wantedModifiers = _modifierIndex((map.modifiers & SHIFT_PRESSED) != 0,
+                                                        (map.modifiers & ALT_PRESSED) != 0,
+                                                        (map.modifiers & CTRL_PRESSED) != 0);
+
+            for (size_t modifiers = 0; modifiers < ModifierCount; ++modifiers)
+            {
+                auto& index = _indices[map.vkey * ModifierCount + modifiers];
+                if (index == 0 && (anyModifiers || modifiers == wantedModifiers))
+                {
+                    index = static_cast<uint8_t>(i + 1);
+                }
+            }
+        }
+    }
+
+    // Returns the entry matching the key event or nullptr if there is none.
+    const TermKeyMap* Find(const KeyEvent& keyEvent) const noexcept
+    {
+        const size_t vkey = keyEvent.GetVirtualKeyCode();
+        if (vkey >= VirtualKeyCount)
+        {
+            return nullptr;
+        }
+
+        const auto modifiers = _modifierIndex(keyEvent.IsShiftPressed(), keyEvent.IsAltPressed(), keyEvent.IsCtrlPressed());
+        const auto index = til::at(_indices, vkey * ModifierCount + modifiers);
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+        return index ? _mapping + (index - 1) : nullptr;
+    }
+
+private:
+    // Virtual key codes are in the range [1, 254].
+    static constexpr size_t VirtualKeyCount = 256;
+    // Every combination of the Shift, Alt and Ctrl keys.
+    static constexpr size_t ModifierCount = 8;
+
+    static constexpr size_t _modifierIndex(const bool shift, const bool alt, const bool ctrl) noexcept
+    {
+        return (shift ? 1 : 0) | (alt ? 2 : 0) | (ctrl ? 4 : 0);
+    }
+
+    const TermKeyMap* _mapping;
+    std::array<uint8_t, VirtualKeyCount * ModifierCount> _indices;
+};
+
+static constexpr TermKeyLookup s_cursorKeysNormalLookup{ s_cursorKeysNormalMapping };
+static constexpr TermKeyLookup s_cursorKeysApplicationLookup{ s_cursorKeysApplicationMapping };
+static constexpr TermKeyLookup s_cursorKeysVt52Lookup{ s_cursorKeysVt52Mapping };
+static constexpr TermKeyLookup s_keypadNumericLookup{ s_keypadNumericMapping };
+static constexpr TermKeyLookup s_keypadApplicationLookup{ s_keypadApplicationMapping };
+static constexpr TermKeyLookup s_keypadVt52Lookup{ s_keypadVt52Mapping };
+static constexpr TermKeyLookup s_modifierKeyLookup{ s_modifierKeyMapping };
+static constexpr TermKeyLookup s_simpleModifiedKeyLookup{ s_simpleModifiedKeyMapping };
+
+// The modified sequences are assembled on the stack, in a buffer of this size.
+static constexpr auto s_modifierKeySequenceMaxLength = []() noexcept {
+    size_t length = 0;
+    for (const auto& map : s_modifierKeyMapping)
+    {
+        length = std::max(length, map.sequence.size());
+    }
+    return length;
+}();
+
 void TerminalInput::SetInputMode(const Mode mode, const bool enabled) noexcept
 {
     // If we're changing a tracking mode, we always clear other tracking modes first.
@@ -277,10 +363,10 @@ void TerminalInput::ForceDisableWin32InputMode(const bool win32InputMode) noexce
     _forceDisableWin32InputMode = win32InputMode;
 }
 
-static const gsl::span<const TermKeyMap> _getKeyMapping(const KeyEvent& keyEvent,
-                                                        const bool ansiMode,
-                                                        const bool cursorApplicationMode,
-                                                        const bool keypadApplicationMode) noexcept
+static const TermKeyLookup& _getKeyMapping(const KeyEvent& keyEvent,
+                                           const bool ansiMode,
+                                           const bool cursorApplicationMode,
+                                           const bool keypadApplicationMode) noexcept
 {
     if (ansiMode)
     {
@@ -288,22 +374,22 @@ static const gsl::span<const TermKeyMap> _getKeyMapping(const KeyEvent& keyEvent
         {
             if (cursorApplicationMode)
             {
-                return { s_cursorKeysApplicationMapping.data(), s_cursorKeysApplicationMapping.size() };
+                return s_cursorKeysApplicationLookup;
             }
             else
             {
-                return { s_cursorKeysNormalMapping.data(), s_cursorKeysNormalMapping.size() };
+                return s_cursorKeysNormalLookup;
             }
         }
         else
         {
             if (keypadApplicationMode)
             {
-                return { s_keypadApplicationMapping.data(), s_keypadApplicationMapping.size() };
+                return s_keypadApplicationLookup;
             }
             else
             {
-                return { s_keypadNumericMapping.data(), s_keypadNumericMapping.size() };
+                return s_keypadNumericLookup;
             }
         }
     }
@@ -311,57 +397,15 @@ static const gsl::span<const TermKeyMap> _getKeyMapping(const KeyEvent& keyEvent
     {
         if (keyEvent.IsCursorKey())
         {
-            return { s_cursorKeysVt52Mapping.data(), s_cursorKeysVt52Mapping.size() };
+            return s_cursorKeysVt52Lookup;
         }
         else
         {
-            return { s_keypadVt52Mapping.data(), s_keypadVt52Mapping.size() };
-        }
-    }
-}
-
-// Routine Description:
-// - Searches the keyMapping for a entry corresponding to this key event, and returns it.
-// Arguments:
-// - keyEvent - Key event to translate
-// - keyMapping - Array of key mappings to search
-// Return Value:
-// - Has value if there was a match to a key translation.
-static std::optional<const TermKeyMap> _searchKeyMapping(const KeyEvent& keyEvent,
-                                                         gsl::span<const TermKeyMap> keyMapping) noexcept
-{
-    for (auto& map : keyMapping)
-    {
-        if (map.vkey == keyEvent.GetVirtualKeyCode())
-        {
-            // If the mapping has no modifiers set, then it doesn't really care
-            //      what the modifiers are on the key. The caller will likely do
-            //      something with them.
-            // However, if there are modifiers set, then we only want to match
-            //      if the key's modifiers are the same as the modifiers in the
-            //      mapping.
-            auto modifiersMatch = WI_AreAllFlagsClear(map.modifiers, MOD_PRESSED);
-            if (!modifiersMatch)
-            {
-                // The modifier mapping expects certain modifier keys to be
-                //      pressed. Check those as well.
-                modifiersMatch =
-                    (WI_IsFlagSet(map.modifiers, SHIFT_PRESSED) == keyEvent.IsShiftPressed()) &&
-                    (WI_IsAnyFlagSet(map.modifiers, ALT_PRESSED) == keyEvent.IsAltPressed()) &&
-                    (WI_IsAnyFlagSet(map.modifiers, CTRL_PRESSED) == keyEvent.IsCtrlPressed());
-            }
-
-            if (modifiersMatch)
-            {
-                return map;
-            }
+            return s_keypadVt52Lookup;
         }
     }
-    return std::nullopt;
 }
 
-typedef std::function<void(const std::wstring_view)> InputSender;
-
 // Routine Description:
 // - Searches the s_modifierKeyMapping for a entry corresponding to this key event.
 //      Changes the second to last byte to correspond to the currently pressed modifier keys
@@ -371,23 +415,24 @@ typedef std::function<void(const std::wstring_view)> InputSender;
 // - sender - Function to use to dispatch translated event
 // Return Value:
 // - True if there was a match to a key translation, and we successfully modified and sent it to the input
-static bool _searchWithModifier(const KeyEvent& keyEvent, InputSender sender)
+template<typename InputSender>
+static bool _searchWithModifier(const KeyEvent& keyEvent, InputSender&& sender)
 {
     auto success = false;
 
-    const auto match = _searchKeyMapping(keyEvent,
-                                         { s_modifierKeyMapping.data(), s_modifierKeyMapping.size() });
-    if (match)
+    if (const auto match = s_modifierKeyLookup.Find(keyEvent))
     {
-        const auto& v = match.value();
-        if (!v.sequence.empty())
+        const auto& sequence = match->sequence;
+        if (!sequence.empty())
         {
-            std::wstring modified{ v.sequence }; // Make a copy so we can modify it.
+            // Make a copy so we can modify it.
+            std::array<wchar_t, s_modifierKeySequenceMaxLength> modified{};
+            std::copy(sequence.begin(), sequence.end(), modified.begin());
             const auto shift = keyEvent.IsShiftPressed();
             const auto alt = keyEvent.IsAltPressed();
             const auto ctrl = keyEvent.IsCtrlPressed();
-            modified.at(modified.size() - 2) = L'1' + (shift ? 1 : 0) + (alt ? 2 : 0) + (ctrl ? 4 : 0);
-            sender(modified);
+            til::at(modified, sequence.size() - 2) = L'1' + (shift ? 1 : 0) + (alt ? 2 : 0) + (ctrl ? 4 : 0);
+            sender({ modified.data(), sequence.size() });
             success = true;
         }
     }
@@ -396,12 +441,10 @@ static bool _searchWithModifier(const KeyEvent& keyEvent, InputSender sender)
         // We didn't find the key in the map of modified keys that need editing,
         //      maybe it's in the other map of modified keys with sequences that
         //      don't need editing before sending.
-        const auto match2 = _searchKeyMapping(keyEvent,
-                                              { s_simpleModifiedKeyMapping.data(), s_simpleModifiedKeyMapping.size() });
-        if (match2)
+        if (const auto match2 = s_simpleModifiedKeyLookup.Find(keyEvent))
         {
             // This mapping doesn't need to be changed at all.
-            sender(match2.value().sequence);
+            sender(match2->sequence);
             success = true;
         }
         else
@@ -483,23 +526,24 @@ static bool _searchWithModifier(const KeyEvent& keyEvent, InputSender sender)
 }
 
 // Routine Description:
-// - Searches the input array of mappings, and sends it to the input if a match was found.
+// - Looks up the key in the given mappings, and sends it to the input if a match was found.
 // Arguments:
 // - keyEvent - Key event to translate
-// - keyMapping - Array of key mappings to search
+// - keyMapping - The key mappings to search
 // - sender - Function to use to dispatch translated event
 // Return Value:
 // - True if there was a match to a key translation, and we successfully sent it to the input
+template<typename InputSender>
 static bool _translateDefaultMapping(const KeyEvent& keyEvent,
-                                     const gsl::span<const TermKeyMap> keyMapping,
-                                     InputSender sender)
+                                     const TermKeyLookup& keyMapping,
+                                     InputSender&& sender)
 {
-    const auto match = _searchKeyMapping(keyEvent, keyMapping);
+    const auto match = keyMapping.Find(keyEvent);
     if (match)
     {
         sender(match->sequence);
     }
-    return match.has_value();
+    return match != nullptr;
 }
 
 // Routine Description:
@@ -517,6 +561,7 @@ static bool _translateDefaultMapping(const KeyEvent& keyEvent,
 // - True if the event was handled.
 bool TerminalInput::HandleKey(const IInputEvent* const pInEvent)
 {
+    const Microsoft::Console::Types::AllocationTracker::Scope allocations{ Microsoft::Console::Types::AllocationStage::InputEvent };
     if (!pInEvent)
     {
         return false;
@@ -551,8 +596,9 @@ bool TerminalInput::HandleKey(const IInputEvent* const pInEvent)
     // Only do this if win32-input-mode support isn't manually disabled.
     if (_inputMode.test(Mode::Win32) && !_forceDisableWin32InputMode)
     {
-        const auto seq = _GenerateWin32KeySequence(keyEvent);
-        _SendInputSequence(seq);
+        fmt::basic_memory_buffer<wchar_t, 64> seq;
+        _GenerateWin32KeySequence(seq, keyEvent);
+        _SendInputSequence({ seq.data(), seq.size() });
         return true;
     }
 
@@ -795,10 +841,11 @@ void TerminalInput::_SendInputSequence(const std::wstring_view sequence) const n
 // Method Description:
 // - Synthesize a win32-input-mode sequence for the given keyevent.
 // Arguments:
+// - buffer: the buffer the formatted string representation of this key is appended to.
 // - key: the KeyEvent to serialize.
 // Return Value:
-// - the formatted string representation of this key
-std::wstring TerminalInput::_GenerateWin32KeySequence(const KeyEvent& key)
+// - <none>
+void TerminalInput::_GenerateWin32KeySequence(fmt::basic_memory_buffer<wchar_t, 64>& buffer, const KeyEvent& key)
 {
     // Sequences are formatted as follows:
     //
@@ -811,11 +858,12 @@ std::wstring TerminalInput::_GenerateWin32KeySequence(const KeyEvent& key)
     //      Kd: the value of bKeyDown - either a '0' or '1'. If omitted, defaults to '0'.
     //      Cs: the value of dwControlKeyState - any number. If omitted, defaults to '0'.
     //      Rc: the value of wRepeatCount - any number. If omitted, defaults to '1'.
-    return fmt::format(FMT_COMPILE(L"\x1b[{};{};{};{};{};{}_"),
-                       key.GetVirtualKeyCode(),
-                       key.GetVirtualScanCode(),
-                       static_cast<int>(key.GetCharData()),
-                       key.IsKeyDown() ? 1 : 0,
-                       key.GetActiveModifierKeys(),
-                       key.GetRepeatCount());
+    fmt::format_to(std::back_inserter(buffer),
+                   FMT_COMPILE(L"\x1b[{};{};{};{};{};{}_"),
+                   key.GetVirtualKeyCode(),
+                   key.GetVirtualScanCode(),
+                   static_cast<int>(key.GetCharData()),
+                   key.IsKeyDown() ? 1 : 0,
+                   key.GetActiveModifierKeys(),
+                   key.GetRepeatCount());
 }
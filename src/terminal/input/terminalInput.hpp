@@ -98,7 +98,7 @@ namespace Microsoft::Console::VirtualTerminal
         void _SendNullInputSequence(const DWORD dwControlKeyState) const;
         void _SendInputSequence(const std::wstring_view sequence) const noexcept;
         void _SendEscapedInputSequence(const wchar_t wch) const;
-        static std::wstring _GenerateWin32KeySequence(const KeyEvent& key);
+        static void _GenerateWin32KeySequence(fmt::basic_memory_buffer<wchar_t, 64>& buffer, const KeyEvent& key);
 
 #pragma region MouseInputState Management
         // These methods are defined in mouseInputState.cpp
@@ -50,6 +50,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         virtual bool ActionSs3Dispatch(const wchar_t wch, const VTParameters parameters) = 0;
 
+        virtual size_t ActionWin32InputSequences(const std::wstring_view string) = 0;
+
     protected:
         IStateMachineEngine() = default;
     };
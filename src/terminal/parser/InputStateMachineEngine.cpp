@@ -1149,3 +1149,138 @@ KeyEvent InputStateMachineEngine::_GenerateWin32Key(const VTParameters parameter
     key.SetRepeatCount(::base::saturated_cast<WORD>(parameters.at(5).value_or(1)));
     return key;
 }
+
+// Routine Description:
+// - Decodes a run of consecutive win32-input-mode sequences at the start of the
+//      given string, without going through the generic parameter accumulation
+//      of the state machine. When ConPTY forwards keys, pastes and key repeats
+//      arrive as thousands of these sequences in a row.
+// - Keys that the host might need to intercept (like Ctrl+C) are written with
+//      WriteCtrlKey just like ActionCsiDispatch does. All others are collected
+//      into a single batch of INPUT_RECORDs before they're written.
+// Arguments:
+// - string - The string starting with the ESC of a potential sequence.
+// Return Value:
+// - The number of characters consumed. This is 0 if the string doesn't start
+//      with a complete win32-input-mode sequence, in which case the state
+//      machine parses it as usual.
+size_t InputStateMachineEngine::ActionWin32InputSequences(const std::wstring_view string)
+{
+    size_t consumed = 0;
+    INPUT_RECORD record;
+
+    while (const auto length = _DecodeWin32InputSequence(string.substr(consumed), record))
+    {
+        consumed += length;
+
+        try
+        {
+            const auto& key = record.Event.KeyEvent;
+            if (key.bKeyDown && WI_IsAnyFlagSet(key.dwControlKeyState, LEFT_CTRL_PRESSED | RIGHT_CTRL_PRESSED | LEFT_ALT_PRESSED | RIGHT_ALT_PRESSED))
+            {
+                _FlushWin32InputBatch();
+                _pDispatch->WriteCtrlKey(KeyEvent{ key });
+            }
+            else
+            {
+                _win32InputBatch.emplace_back(record);
+            }
+        }
+        CATCH_LOG();
+    }
+
+    _FlushWin32InputBatch();
+    return consumed;
+}
+
+// Routine Description:
+// - Decodes a single win32-input-mode sequence of the form
+//      ^[ [ Vk ; Sc ; Uc ; Kd ; Cs ; Rc _
+//      (see _GenerateWin32Key) at the start of the given string. Sequences
+//      with more than six parameters, private parameters or intermediates are
+//      rejected, as are sequences cut off at the end of the string.
+// Arguments:
+// - string - The string starting with the ESC of a potential sequence.
+// - record - Receives the decoded key event.
+// Return Value:
+// - The length of the sequence, or 0 if the string doesn't start with one.
+size_t InputStateMachineEngine::_DecodeWin32InputSequence(const std::wstring_view string, INPUT_RECORD& record) noexcept
+{
+    if (string.size() < 3 || til::at(string, 0) != AsciiChars::ESC || til::at(string, 1) != L'[')
+    {
+        return 0;
+    }
+
+    // Vk, Sc, Uc, Kd, Cs and Rc, initialized with the defaults for omitted parameters.
+    std::array<VTInt, 6> values{ 0, 0, 0, 0, 0, 1 };
+    size_t index = 0;
+    VTInt value = 0;
+    auto hasValue = false;
+
+    for (size_t i = 2; i < string.size(); ++i)
+    {
+        const auto wch = til::at(string, i);
+        if (wch >= L'0' && wch <= L'9')
+        {
+            // Values are clamped the same way StateMachine::_AccumulateTo does.
+            value = std::min(value * 10 + (wch - L'0'), MAX_PARAMETER_VALUE);
+            hasValue = true;
+        }
+        else if (wch == L';' || wch == L'_')
+        {
+            if (hasValue)
+            {
+                til::at(values, index) = value;
+            }
+            value = 0;
+            hasValue = false;
+
+            if (wch == L'_')
+            {
+                record.EventType = KEY_EVENT;
+                record.Event.KeyEvent.wVirtualKeyCode = ::base::saturated_cast<WORD>(values[0]);
+                record.Event.KeyEvent.wVirtualScanCode = ::base::saturated_cast<WORD>(values[1]);
+                record.Event.KeyEvent.uChar.UnicodeChar = ::base::saturated_cast<wchar_t>(values[2]);
+                record.Event.KeyEvent.bKeyDown = values[3] != 0;
+                record.Event.KeyEvent.dwControlKeyState = ::base::saturated_cast<DWORD>(values[4]);
+                record.Event.KeyEvent.wRepeatCount = ::base::saturated_cast<WORD>(values[5]);
+                return i + 1;
+            }
+
+            if (++index == values.size())
+            {
+                return 0;
+            }
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+// Routine Description:
+// - Writes the key events collected by ActionWin32InputSequences to the input
+//      buffer in a single call, leaving the batch empty for the next run.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void InputStateMachineEngine::_FlushWin32InputBatch() noexcept
+{
+    if (_win32InputBatch.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        auto inputEvents = IInputEvent::Create(gsl::make_span(_win32InputBatch));
+        _pDispatch->WriteInput(inputEvents);
+    }
+    CATCH_LOG();
+
+    _win32InputBatch.clear();
+}
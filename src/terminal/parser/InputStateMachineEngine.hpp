@@ -162,6 +162,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool ActionSs3Dispatch(const wchar_t wch, const VTParameters parameters) override;
 
+        size_t ActionWin32InputSequences(const std::wstring_view string) override;
+
         void SetFlushToInputQueueCallback(std::function<bool()> pfnFlushToInputQueue);
 
     private:
@@ -173,6 +175,7 @@ namespace Microsoft::Console::VirtualTerminal
         std::optional<til::point> _lastMouseClickPos{};
         std::optional<std::chrono::steady_clock::time_point> _lastMouseClickTime{};
         std::optional<size_t> _lastMouseClickButton{};
+        std::vector<INPUT_RECORD> _win32InputBatch;
 
         DWORD _GetCursorKeysModifierState(const VTParameters parameters, const VTID id) noexcept;
         DWORD _GetGenericKeysModifierState(const VTParameters parameters) noexcept;
@@ -209,6 +212,8 @@ namespace Microsoft::Console::VirtualTerminal
                                         unsigned int& function) const noexcept;
 
         KeyEvent _GenerateWin32Key(const VTParameters parameters);
+        static size_t _DecodeWin32InputSequence(const std::wstring_view string, INPUT_RECORD& record) noexcept;
+        void _FlushWin32InputBatch() noexcept;
 
         bool _DoControlCharacter(const wchar_t wch, const bool writeAlt);
 
@@ -55,6 +55,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool ActionSs3Dispatch(const wchar_t wch, const VTParameters parameters) noexcept override;
 
+        size_t ActionWin32InputSequences(const std::wstring_view string) noexcept override;
+
         void SetTerminalConnection(Microsoft::Console::Render::VtEngine* const pTtyConnection,
                                    std::function<bool()> pfnFlushToTerminal);
 
@@ -141,13 +143,20 @@ namespace Microsoft::Console::VirtualTerminal
             XT_PopSgrAlias = VTID("#q"),
             XT_PushSgr = VTID("#{"),
             XT_PopSgr = VTID("#}"),
+            DECCARA_ChangeAttributesRectangularArea = VTID("$r"),
+            DECCRA_CopyRectangularArea = VTID("$v"),
+            DECFRA_FillRectangularArea = VTID("$x"),
+            DECERA_EraseRectangularArea = VTID("$z"),
+            DECSERA_SelectiveEraseRectangularArea = VTID("${"),
             DECSCPP_SetColumnsPerPage = VTID("$|"),
+            DECSACE_SelectAttributeChangeExtent = VTID("*x"),
             DECAC_AssignColor = VTID(",|"),
             DECPS_PlaySound = VTID(",~")
         };
 
         enum DcsActionCodes : uint64_t
         {
+            DECSIXEL_DefineImage = VTID("q"),
             DECDLD_DownloadDRCS = VTID("{"),
             DECRSTS_RestoreTerminalState = VTID("$p"),
             DECRQSS_RequestSetting = VTID("$q")
@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+/*
+Module Name:
+- ParserStatistics.hpp
+
+Abstract:
+- Counters that every StateMachine maintains about the text it processes.
+- Apart from the timings, which are only measured for a sample of the calls,
+  they're plain increments, so that they can always be enabled.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace Microsoft::Console::VirtualTerminal
+{
+    struct ParserStatistics
+    {
+        enum class Dispatch : size_t
+        {
+            Execute,
+            Escape,
+            Vt52,
+            Csi,
+            Osc,
+            Ss3,
+            Dcs,
+            // Only use this last value as a count of the number of classes.
+            Count
+        };
+
+        // Only one out of this many print runs and dispatches of each class is timed.
+        static constexpr uint64_t SampleInterval = 64;
+
+        // UTF-16 code units or UTF-8 bytes, depending on the ProcessString overload.
+        uint64_t charactersProcessed = 0;
+        uint64_t printRuns = 0;
+        uint64_t printedCharacters = 0;
+        std::array<uint64_t, static_cast<size_t>(Dispatch::Count)> dispatches{};
+
+        uint64_t sampledPrintRuns = 0;
+        uint64_t sampledPrintNanoseconds = 0;
+        uint64_t sampledDispatches = 0;
+        uint64_t sampledDispatchNanoseconds = 0;
+
+        constexpr uint64_t Dispatches(const Dispatch dispatch) const noexcept
+        {
+            return til::at(dispatches, static_cast<size_t>(dispatch));
+        }
+
+        constexpr uint64_t TotalDispatches() const noexcept
+        {
+            uint64_t total = 0;
+            for (const auto count : dispatches)
+            {
+                total += count;
+            }
+            return total;
+        }
+
+        constexpr double AveragePrintRunLength() const noexcept
+        {
+            return printRuns ? static_cast<double>(printedCharacters) / static_cast<double>(printRuns) : 0.0;
+        }
+
+        // The print runs are what ends up writing to the text buffer, so
+        // this is an estimate of the time spent doing that.
+        constexpr uint64_t EstimatedPrintNanoseconds() const noexcept
+        {
+            return _Extrapolate(sampledPrintNanoseconds, sampledPrintRuns, printRuns);
+        }
+
+        constexpr uint64_t EstimatedDispatchNanoseconds() const noexcept
+        {
+            return _Extrapolate(sampledDispatchNanoseconds, sampledDispatches, TotalDispatches());
+        }
+
+    private:
+        static constexpr uint64_t _Extrapolate(const uint64_t sampledTime, const uint64_t sampledCount, const uint64_t totalCount) noexcept
+        {
+            return sampledCount ? static_cast<uint64_t>(static_cast<double>(sampledTime) / static_cast<double>(sampledCount) * static_cast<double>(totalCount)) : 0;
+        }
+    };
+}
@@ -41,6 +41,9 @@ static std::string GenerateOscColorTableToken();
 static std::string GenerateVt52Token();
 static std::string GenerateVt52CursorAddressToken();
 static std::string GenerateOscHyperlinkToken();
+static std::string GenerateDeepParameterListToken();
+static std::string GenerateHugeOscToken();
+static std::string GenerateFullBufferToken();
 
 const fuzz::_fuzz_type_entry<BYTE> g_repeatMap[] = {
     { 4, [](BYTE) { return CFuzzChance::GetRandom<BYTE>(2, 0xF); } },
@@ -67,6 +70,13 @@ const std::function<std::string()> g_tokenGenerators[] = {
     GenerateOscHyperlinkToken
 };
 
+// The inputs that are expensive per byte, for the slow input mode of the host's fuzzer.
+const std::function<std::string()> g_slowTokenGenerators[] = {
+    GenerateDeepParameterListToken,
+    GenerateHugeOscToken,
+    GenerateFullBufferToken
+};
+
 std::string GenerateTokenLowProbability()
 {
     const _fuzz_type_entry<std::string> tokenGeneratorMap[] = {
@@ -93,6 +103,17 @@ std::string GenerateToken()
     return (std::string)ft;
 }
 
+std::string GenerateSlowToken()
+{
+    const _fuzz_type_entry<std::string> tokenGeneratorMap[] = {
+        { 60, [&](std::string) { return CFuzzChance::SelectOne(g_slowTokenGenerators, ARRAYSIZE(g_slowTokenGenerators))(); } },
+        { 40, [](std::string) { return GenerateToken(); } }
+    };
+    CFuzzType<std::string> ft(FUZZ_MAP(tokenGeneratorMap), std::string(""));
+
+    return (std::string)ft;
+}
+
 std::string GenerateWhiteSpaceToken()
 {
     const _fuzz_type_entry<DWORD> ftMap[] = {
@@ -602,11 +623,54 @@ std::string GenerateOscHyperlinkToken()
     return GenerateFuzzedOscToken(FUZZ_MAP(map), tokens, ARRAYSIZE(tokens));
 }
 
+// A CSI sequence with far more parameters than any sequence takes, some of them with sub parameters.
+std::string GenerateDeepParameterListToken()
+{
+    const LPCSTR finals[] = { "m", "H", "J", "r", "h", "l", "@", "S" };
+    std::string s(CSI);
+    const auto count = CFuzzChance::GetRandom<USHORT>(100, 4096);
+    for (USHORT i = 0; i < count; i++)
+    {
+        AppendFormat(s, "%d", CFuzzChance::GetRandom<BYTE>());
+        s.append(CFuzzChance::GetRandom<BYTE>(0, 8) == 0 ? ":" : ";");
+    }
+    s.append(CFuzzChance::SelectOne(finals, ARRAYSIZE(finals)));
+    return s;
+}
+
+// An OSC string of up to 64 KiB, which the parser has to accumulate until it's terminated.
+std::string GenerateHugeOscToken()
+{
+    const LPCSTR prefixes[] = { "0;", "2;", "8;;https://", "4;1;rgb:", "10;", "52;c;", "1337;" };
+    const LPCSTR terminators[] = { "\x7", "\x1b\\" };
+    std::string s(OSC);
+    s.append(CFuzzChance::SelectOne(prefixes, ARRAYSIZE(prefixes)));
+    s.append(CFuzzChance::GetRandom<USHORT>(4096, 0xFFFF), static_cast<char>(CFuzzChance::GetRandom<BYTE>('0', 'z')));
+    s.append(CFuzzChance::SelectOne(terminators, ARRAYSIZE(terminators)));
+    return s;
+}
+
+// Operations that touch every cell of the buffer, repeated many times: DECALN,
+// erasing the display and the scrollback, and scrolling by the whole screen.
+std::string GenerateFullBufferToken()
+{
+    const LPCSTR tokens[] = { "\x1b#8", "\x1b[2J", "\x1b[3J", "\x1b[J", "\x1b[9999S", "\x1b[9999T", "\x1b[1;9999r\x1b[9999M\x1b[r" };
+    std::string s;
+    const auto count = CFuzzChance::GetRandom<BYTE>(10, 200);
+    for (BYTE i = 0; i < count; i++)
+    {
+        s.append(CFuzzChance::SelectOne(tokens, ARRAYSIZE(tokens)));
+    }
+    return s;
+}
+
 int __cdecl wmain(int argc, WCHAR* argv[])
 {
-    if (argc != 3)
+    // With --slow, the files mostly contain input with a pathological cost per byte.
+    const auto slow = argc == 4 && std::wstring_view{ argv[3] } == L"--slow";
+    if (argc != 3 && !slow)
     {
-        wprintf(L"Usage: <file count> <output directory>");
+        wprintf(L"Usage: <file count> <output directory> [--slow]");
         return -1;
     }
 
@@ -634,7 +698,7 @@ int __cdecl wmain(int argc, WCHAR* argv[])
                 std::string text;
                 for (auto j = 0; j < CFuzzChance::GetRandom<BYTE>(); j++)
                 {
-                    text.append(GenerateToken());
+                    text.append(slow ? GenerateSlowToken() : GenerateToken());
                 }
 
                 wil::com_ptr<IStream> spStream;
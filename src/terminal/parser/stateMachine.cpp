@@ -6,9 +6,62 @@
 #include "stateMachine.hpp"
 
 #include "ascii.hpp"
+#include "../../types/inc/AllocationTracker.hpp"
 
 using namespace Microsoft::Console::VirtualTerminal;
 
+// The statistics are traced whenever this many more characters have been processed.
+static constexpr uint64_t StatisticsTraceInterval = 1024 * 1024;
+
+namespace
+{
+    // Measures the duration of every ParserStatistics::SampleInterval-th call
+    // of something, given how often it has been called, including this time.
+    class SampledTimer
+    {
+    public:
+        SampledTimer(const uint64_t calls, uint64_t& sampledCalls, uint64_t& sampledNanoseconds) noexcept :
+            _sampledCalls{ calls % ParserStatistics::SampleInterval == 0 ? &sampledCalls : nullptr },
+            _sampledNanoseconds{ &sampledNanoseconds }
+        {
+            if (_sampledCalls)
+            {
+                _start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~SampledTimer()
+        {
+            if (_sampledCalls)
+            {
+                const auto duration = std::chrono::steady_clock::now() - _start;
+                *_sampledNanoseconds += gsl::narrow_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+                ++*_sampledCalls;
+            }
+        }
+
+        SampledTimer(const SampledTimer&) = delete;
+        SampledTimer& operator=(const SampledTimer&) = delete;
+
+    private:
+        uint64_t* _sampledCalls;
+        uint64_t* _sampledNanoseconds;
+        std::chrono::steady_clock::time_point _start;
+    };
+}
+
+static SampledTimer _timeDispatch(ParserStatistics& statistics, const ParserStatistics::Dispatch dispatch) noexcept
+{
+    auto& count = til::at(statistics.dispatches, static_cast<size_t>(dispatch));
+    return { ++count, statistics.sampledDispatches, statistics.sampledDispatchNanoseconds };
+}
+
+static SampledTimer _timePrint(ParserStatistics& statistics, const size_t length) noexcept
+{
+    statistics.printedCharacters += length;
+    return { ++statistics.printRuns, statistics.sampledPrintRuns, statistics.sampledPrintNanoseconds };
+}
+
 //Takes ownership of the pEngine.
 StateMachine::StateMachine(std::unique_ptr<IStateMachineEngine> engine, const bool isEngineForInput) :
     _engine(std::move(engine)),
@@ -21,6 +74,7 @@ StateMachine::StateMachine(std::unique_ptr<IStateMachineEngine> engine, const bo
     _cachedSequence{ std::nullopt },
     _processingIndividually(false)
 {
+    _parserMode.set(Mode::TransitionTable, Feature_VtTransitionTable::IsEnabled());
     _ActionClear();
 }
 
@@ -34,6 +88,45 @@ bool StateMachine::GetParserMode(const Mode mode) const noexcept
     return _parserMode.test(mode);
 }
 
+// Routine Description:
+// - Sets the maximum number of characters of an OSC or DCS string. Sequences
+//   with longer strings are ignored, instead of buffering them without limit.
+// Arguments:
+// - limit - The maximum number of characters.
+// Return Value:
+// - <none>
+void StateMachine::SetStringLimit(const size_t limit) noexcept
+{
+    _stringLimit = limit;
+}
+
+// Routine Description:
+// - Returns the counters of the characters and sequences that this state machine processed.
+// Arguments:
+// - <none>
+// Return Value:
+// - The statistics since the state machine was created.
+const ParserStatistics& StateMachine::GetStatistics() const noexcept
+{
+    return _statistics;
+}
+
+// Routine Description:
+// - Adds to the count of processed characters, and periodically traces the statistics.
+// Arguments:
+// - count - The number of characters passed to ProcessString.
+// Return Value:
+// - <none>
+void StateMachine::_AddProcessedCharacters(const size_t count) noexcept
+{
+    _statistics.charactersProcessed += count;
+    if (_statistics.charactersProcessed - _statisticsTracedAt >= StatisticsTraceInterval)
+    {
+        _statisticsTracedAt = _statistics.charactersProcessed;
+        _trace.TraceStatistics(_statistics);
+    }
+}
+
 const IStateMachineEngine& StateMachine::Engine() const noexcept
 {
     return *_engine;
@@ -379,6 +472,380 @@ static constexpr bool _isActionableFromGround(const wchar_t wch) noexcept
 
 #pragma warning(pop)
 
+// Routine Description:
+// - Finds the next character that _isActionableFromGround, starting at the given offset.
+// - This is what allows ProcessString to hand entire runs of printable text
+//     to _ActionPrintString without inspecting each character in the loop.
+// Arguments:
+// - string - The string to search.
+// - offset - The index of the first character to check.
+// Return Value:
+// - The index of the next actionable character, or string.size() if there is none.
+static size_t _findNextActionableFromGround(const std::wstring_view string, size_t offset) noexcept
+{
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+#if _M_AMD64
+    // Check 8 characters at a time for any of the 3 actionable ranges.
+    // SSE2 lacks unsigned 16-bit comparisons, but saturating subtractions
+    // result in 0 for exactly the values that are less or equal.
+    const auto c0Limit = _mm_set1_epi16(0x1f);
+    const auto del = _mm_set1_epi16(0x7f);
+    const auto c1Offset = _mm_set1_epi16(0x80);
+    const auto c1Limit = _mm_set1_epi16(0x9f - 0x80);
+    const auto zero = _mm_setzero_si128();
+    for (; offset + 8 <= string.size(); offset += 8)
+    {
+        const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(string.data() + offset));
+        const auto isC0 = _mm_cmpeq_epi16(_mm_subs_epu16(chars, c0Limit), zero);
+        const auto isDel = _mm_cmpeq_epi16(chars, del);
+        const auto isC1 = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(chars, c1Offset), c1Limit), zero);
+        const auto mask = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(isC0, isDel), isC1));
+        if (mask != 0)
+        {
+            // Every character contributes 2 bits to the mask.
+            unsigned long index;
+            _BitScanForward(&index, static_cast<unsigned long>(mask));
+            return offset + index / 2;
+        }
+    }
+#endif
+#pragma warning(pop)
+
+    for (; offset < string.size(); ++offset)
+    {
+        if (_isActionableFromGround(til::at(string, offset)))
+        {
+            break;
+        }
+    }
+    return offset;
+}
+
+// Routine Description:
+// - The UTF-8 counterpart of the above. C0 controls and DEL are single bytes in UTF-8,
+//   and C1 controls are encoded as 0xC2 followed by 0x80-0x9F. A 0xC2 at the very end
+//   of the string is considered actionable as well, because it might be the first
+//   half of a C1 control that continues in the next string.
+// Arguments:
+// - string - The UTF-8 string to search.
+// - offset - The index of the first byte to check.
+// Return Value:
+// - The index of the next actionable byte, or string.size() if there is none.
+static size_t _findNextActionableFromGround(const std::string_view string, size_t offset) noexcept
+{
+    const auto isActionable = [&](const size_t i) noexcept {
+        const wchar_t ch = static_cast<uint8_t>(til::at(string, i));
+        if (ch == 0xc2)
+        {
+            return i + 1 >= string.size() || _isC1ControlCharacter(static_cast<uint8_t>(til::at(string, i + 1)));
+        }
+        return ch <= AsciiChars::US || _isDelete(ch);
+    };
+
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+#if _M_AMD64
+    // Unlike the UTF-16 variant, this one only finds candidates, because every
+    // 0xC2 needs to be confirmed by looking at the byte that follows it.
+    const auto c0Limit = _mm_set1_epi8(0x1f);
+    const auto del = _mm_set1_epi8(0x7f);
+    const auto c1Lead = _mm_set1_epi8(static_cast<char>(0xc2));
+    const auto zero = _mm_setzero_si128();
+    for (; offset + 16 <= string.size(); offset += 16)
+    {
+        const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(string.data() + offset));
+        const auto isC0 = _mm_cmpeq_epi8(_mm_subs_epu8(chars, c0Limit), zero);
+        const auto isDel = _mm_cmpeq_epi8(chars, del);
+        const auto isC1Lead = _mm_cmpeq_epi8(chars, c1Lead);
+        auto mask = static_cast<unsigned long>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(isC0, isDel), isC1Lead)));
+        while (mask != 0)
+        {
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            if (isActionable(offset + index))
+            {
+                return offset + index;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+#pragma warning(pop)
+
+    for (; offset < string.size(); ++offset)
+    {
+        if (isActionable(offset))
+        {
+            break;
+        }
+    }
+    return offset;
+}
+
+// Routine Description:
+// - Finds the end of the run of characters that _EventDcsPassThrough would hand
+//     to the DCS string handler, which are the ones between 0x20 and 0x7E.
+//     Everything else, including the ESC that terminates the string, needs to
+//     go through the state machine.
+// Arguments:
+// - string - The string to search.
+// - offset - The index of the first character to check.
+// Return Value:
+// - The index of the first character outside of the range, or string.size() if there is none.
+static size_t _findEndOfDcsPassThrough(const std::wstring_view string, size_t offset) noexcept
+{
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+#if _M_AMD64
+    // Characters below 0x20 wrap around when the offset is subtracted, so a
+    // single unsigned comparison (see _findNextActionableFromGround) suffices.
+    const auto rangeOffset = _mm_set1_epi16(0x20);
+    const auto rangeLimit = _mm_set1_epi16(0x7e - 0x20);
+    const auto zero = _mm_setzero_si128();
+    for (; offset + 8 <= string.size(); offset += 8)
+    {
+        const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(string.data() + offset));
+        const auto isValid = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(chars, rangeOffset), rangeLimit), zero);
+        const auto mask = ~_mm_movemask_epi8(isValid) & 0xffff;
+        if (mask != 0)
+        {
+            unsigned long index;
+            _BitScanForward(&index, static_cast<unsigned long>(mask));
+            return offset + index / 2;
+        }
+    }
+#endif
+#pragma warning(pop)
+
+    for (; offset < string.size(); ++offset)
+    {
+        if (!_isDcsPassThroughValid(til::at(string, offset)))
+        {
+            break;
+        }
+    }
+    return offset;
+}
+
+// Routine Description:
+// - The UTF-8 counterpart of the above. The valid characters are all ASCII,
+//     so every byte outside of the range ends the run, including the lead bytes
+//     of non-ASCII characters.
+// Arguments:
+// - string - The UTF-8 string to search.
+// - offset - The index of the first byte to check.
+// Return Value:
+// - The index of the first byte outside of the range, or string.size() if there is none.
+static size_t _findEndOfDcsPassThrough(const std::string_view string, size_t offset) noexcept
+{
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+#if _M_AMD64
+    const auto rangeOffset = _mm_set1_epi8(0x20);
+    const auto rangeLimit = _mm_set1_epi8(0x7e - 0x20);
+    const auto zero = _mm_setzero_si128();
+    for (; offset + 16 <= string.size(); offset += 16)
+    {
+        const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(string.data() + offset));
+        const auto isValid = _mm_cmpeq_epi8(_mm_subs_epu8(_mm_sub_epi8(chars, rangeOffset), rangeLimit), zero);
+        const auto mask = ~_mm_movemask_epi8(isValid) & 0xffff;
+        if (mask != 0)
+        {
+            unsigned long index;
+            _BitScanForward(&index, static_cast<unsigned long>(mask));
+            return offset + index;
+        }
+    }
+#endif
+#pragma warning(pop)
+
+    for (; offset < string.size(); ++offset)
+    {
+        if (!_isDcsPassThroughValid(static_cast<uint8_t>(til::at(string, offset))))
+        {
+            break;
+        }
+    }
+    return offset;
+}
+
+// Routine Description:
+// - Finds the end of the run of bytes that a series of win32-input-mode sequences
+//     (ESC [ Vk ; Sc ; Uc ; Kd ; Cs ; Rc _) could consist of. They're all ASCII,
+//     so the run can be widened to UTF-16 byte by byte.
+// Arguments:
+// - string - The UTF-8 string to search.
+// - offset - The index of the first byte to check.
+// Return Value:
+// - The index of the first byte that can't be part of such a sequence, or string.size() if there is none.
+static size_t _findEndOfWin32InputSequences(const std::string_view string, size_t offset) noexcept
+{
+    for (; offset < string.size(); ++offset)
+    {
+        const auto ch = til::at(string, offset);
+        if (ch != AsciiChars::ESC && ch != '[' && ch != ';' && ch != '_' && (ch < '0' || ch > '9'))
+        {
+            break;
+        }
+    }
+    return offset;
+}
+
+// Routine Description:
+// - Returns the length of the UTF-8 sequence that the given lead byte starts.
+//   Invalid lead bytes and stray trail bytes are treated as sequences of 1 byte,
+//   which the conversion will then turn into U+FFFD.
+// Arguments:
+// - lead - The first byte of the sequence.
+// Return Value:
+// - The expected number of bytes, between 1 and 4.
+static constexpr size_t _u8SequenceLength(const uint8_t lead) noexcept
+{
+    if ((lead & 0xe0) == 0xc0)
+    {
+        return 2;
+    }
+    if ((lead & 0xf0) == 0xe0)
+    {
+        return 3;
+    }
+    if ((lead & 0xf8) == 0xf0)
+    {
+        return 4;
+    }
+    return 1;
+}
+
+// The CSI states are by far the most frequently visited ones besides Ground,
+// because every SGR sequence passes through them. Instead of the chains of
+// conditions in the _EventCsi* functions, _EventCsiFromTable looks up
+// the transition in the constexpr tables below: every 7-bit character maps
+// to one of a handful of character classes first, and the current CSI state
+// and that class then select what to do.
+enum class CsiCharClass : uint8_t
+{
+    C0,
+    Intermediate,
+    Digit,
+    Colon,
+    Delimiter,
+    PrivateMarker,
+    Final,
+    Delete,
+};
+
+enum class CsiAction : uint8_t
+{
+    Execute,
+    Ignore,
+    Collect,
+    CollectThenEnterIntermediate,
+    CollectThenEnterParam,
+    Param,
+    ParamThenEnterParam,
+    EnterIgnore,
+    Dispatch,
+    EnterGround,
+};
+
+static constexpr CsiCharClass _classifyCsiChar(const wchar_t wch) noexcept
+{
+    // CAN, SUB and ESC are classified as C0 here as well, but they never
+    // get this far, since ProcessCharacter handles them in any state.
+    if (wch <= AsciiChars::US)
+    {
+        return CsiCharClass::C0;
+    }
+    if (_isIntermediate(wch))
+    {
+        return CsiCharClass::Intermediate;
+    }
+    if (_isNumericParamValue(wch))
+    {
+        return CsiCharClass::Digit;
+    }
+    if (_isCsiInvalid(wch))
+    {
+        return CsiCharClass::Colon;
+    }
+    if (_isParameterDelimiter(wch))
+    {
+        return CsiCharClass::Delimiter;
+    }
+    if (_isCsiPrivateMarker(wch))
+    {
+        return CsiCharClass::PrivateMarker;
+    }
+    if (_isDelete(wch))
+    {
+        return CsiCharClass::Delete;
+    }
+    return CsiCharClass::Final;
+}
+
+static constexpr auto s_csiCharClasses = []() {
+    std::array<CsiCharClass, 0x80> classes{};
+    for (wchar_t wch = 0; wch < 0x80; ++wch)
+    {
+        til::at(classes, wch) = _classifyCsiChar(wch);
+    }
+    return classes;
+}();
+
+// Indexed by [state - VTStates::CsiEntry][CsiCharClass].
+// The order of the rows follows the order of the CSI states in VTStates.
+static constexpr CsiAction s_csiTransitions[4][8]{
+    // CsiEntry
+    {
+        CsiAction::Execute, // C0
+        CsiAction::CollectThenEnterIntermediate, // Intermediate
+        CsiAction::ParamThenEnterParam, // Digit
+        CsiAction::EnterIgnore, // Colon
+        CsiAction::ParamThenEnterParam, // Delimiter
+        CsiAction::CollectThenEnterParam, // PrivateMarker
+        CsiAction::Dispatch, // Final
+        CsiAction::Ignore, // Delete
+    },
+    // CsiIntermediate
+    {
+        CsiAction::Execute, // C0
+        CsiAction::Collect, // Intermediate
+        CsiAction::EnterIgnore, // Digit
+        CsiAction::EnterIgnore, // Colon
+        CsiAction::EnterIgnore, // Delimiter
+        CsiAction::EnterIgnore, // PrivateMarker
+        CsiAction::Dispatch, // Final
+        CsiAction::Ignore, // Delete
+    },
+    // CsiIgnore
+    {
+        CsiAction::Execute, // C0
+        CsiAction::Ignore, // Intermediate
+        CsiAction::Ignore, // Digit
+        CsiAction::Ignore, // Colon
+        CsiAction::Ignore, // Delimiter
+        CsiAction::Ignore, // PrivateMarker
+        CsiAction::EnterGround, // Final
+        CsiAction::Ignore, // Delete
+    },
+    // CsiParam
+    {
+        CsiAction::Execute, // C0
+        CsiAction::CollectThenEnterIntermediate, // Intermediate
+        CsiAction::Param, // Digit
+        CsiAction::EnterIgnore, // Colon
+        CsiAction::Param, // Delimiter
+        CsiAction::EnterIgnore, // PrivateMarker
+        CsiAction::Dispatch, // Final
+        CsiAction::Ignore, // Delete
+    },
+};
+
 // Routine Description:
 // - Triggers the Execute action to indicate that the listener should immediately respond to a C0 control character.
 // Arguments:
@@ -388,6 +855,7 @@ static constexpr bool _isActionableFromGround(const wchar_t wch) noexcept
 void StateMachine::_ActionExecute(const wchar_t wch)
 {
     _trace.TraceOnExecute(wch);
+    const auto timer = _timeDispatch(_statistics, ParserStatistics::Dispatch::Execute);
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
         return _engine->ActionExecute(wch);
     }));
@@ -404,6 +872,7 @@ void StateMachine::_ActionExecute(const wchar_t wch)
 void StateMachine::_ActionExecuteFromEscape(const wchar_t wch)
 {
     _trace.TraceOnExecuteFromEscape(wch);
+    const auto timer = _timeDispatch(_statistics, ParserStatistics::Dispatch::Execute);
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
         return _engine->ActionExecuteFromEscape(wch);
     }));
@@ -418,6 +887,7 @@ void StateMachine::_ActionExecuteFromEscape(const wchar_t wch)
 void StateMachine::_ActionPrint(const wchar_t wch)
 {
     _trace.TraceOnAction(L"Print");
+    const auto timer = _timePrint(_statistics, 1);
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
         return _engine->ActionPrint(wch);
     }));
@@ -431,6 +901,7 @@ void StateMachine::_ActionPrint(const wchar_t wch)
 // - <none>
 void StateMachine::_ActionPrintString(const std::wstring_view string)
 {
+    const auto timer = _timePrint(_statistics, string.size());
     _SafeExecute([=]() {
         return _engine->ActionPrintString(string);
     });
@@ -447,6 +918,7 @@ void StateMachine::_ActionPrintString(const std::wstring_view string)
 void StateMachine::_ActionEscDispatch(const wchar_t wch)
 {
     _trace.TraceOnAction(L"EscDispatch");
+    const auto timer = _timeDispatch(_statistics, ParserStatistics::Dispatch::Escape);
     _trace.DispatchSequenceTrace(_SafeExecuteWithLog(wch, [=]() {
         return _engine->ActionEscDispatch(_identifier.Finalize(wch));
     }));
@@ -462,6 +934,7 @@ void StateMachine::_ActionEscDispatch(const wchar_t wch)
 void StateMachine::_ActionVt52EscDispatch(const wchar_t wch)
 {
     _trace.TraceOnAction(L"Vt52EscDispatch");
+    const auto timer = _timeDispatch(_statistics, ParserStatistics::Dispatch::Vt52);
     _trace.DispatchSequenceTrace(_SafeExecuteWithLog(wch, [=]() {
         return _engine->ActionVt52EscDispatch(_identifier.Finalize(wch), { _parameters.data(), _parameters.size() });
     }));
@@ -477,6 +950,7 @@ void StateMachine::_ActionVt52EscDispatch(const wchar_t wch)
 void StateMachine::_ActionCsiDispatch(const wchar_t wch)
 {
     _trace.TraceOnAction(L"CsiDispatch");
+    const auto timer = _timeDispatch(_statistics, ParserStatistics::Dispatch::Csi);
     _trace.DispatchSequenceTrace(_SafeExecuteWithLog(wch, [=]() {
         return _engine->ActionCsiDispatch(_identifier.Finalize(wch), { _parameters.data(), _parameters.size() });
     }));
@@ -563,8 +1037,10 @@ void StateMachine::_ActionClear()
 
     _oscString.clear();
     _oscParameter = 0;
+    _oscStringLimitReached = false;
 
     _dcsStringHandler = nullptr;
+    _dcsStringLength = 0;
 
     _engine->ActionClear();
 }
@@ -622,7 +1098,33 @@ void StateMachine::_ActionOscPut(const wchar_t wch)
 {
     _trace.TraceOnAction(L"OscPut");
 
-    _oscString.push_back(wch);
+    _ActionOscPutString({ &wch, 1 });
+}
+
+// Routine Description:
+// - Stores these characters as part of the OSC string.
+// - If the string grows beyond the limit set with SetStringLimit, it's
+//   discarded and the sequence will be ignored once it's terminated.
+// Arguments:
+// - string - Characters to store.
+// Return Value:
+// - <none>
+void StateMachine::_ActionOscPutString(const std::wstring_view string)
+{
+    if (_oscStringLimitReached)
+    {
+        return;
+    }
+
+    if (_oscString.size() + string.size() > _stringLimit)
+    {
+        _oscStringLimitReached = true;
+        // Release the memory right away, since the sequence may continue for a while.
+        _oscString = {};
+        return;
+    }
+
+    _oscString.append(string);
 }
 
 // Routine Description:
@@ -635,6 +1137,12 @@ void StateMachine::_ActionOscPut(const wchar_t wch)
 void StateMachine::_ActionOscDispatch(const wchar_t wch)
 {
     _trace.TraceOnAction(L"OscDispatch");
+    if (_oscStringLimitReached)
+    {
+        _trace.DispatchSequenceTrace(false);
+        return;
+    }
+    const auto timer = _timeDispatch(_statistics, ParserStatistics::Dispatch::Osc);
     _trace.DispatchSequenceTrace(_SafeExecuteWithLog(wch, [=]() {
         return _engine->ActionOscDispatch(wch, _oscParameter, _oscString);
     }));
@@ -650,11 +1158,29 @@ void StateMachine::_ActionOscDispatch(const wchar_t wch)
 void StateMachine::_ActionSs3Dispatch(const wchar_t wch)
 {
     _trace.TraceOnAction(L"Ss3Dispatch");
+    const auto timer = _timeDispatch(_statistics, ParserStatistics::Dispatch::Ss3);
     _trace.DispatchSequenceTrace(_SafeExecuteWithLog(wch, [=]() {
         return _engine->ActionSs3Dispatch(wch, { _parameters.data(), _parameters.size() });
     }));
 }
 
+// Routine Description:
+// - Lets the engine decode a run of win32-input-mode sequences directly from
+//   the string, bypassing the Escape, CsiEntry and CsiParam states.
+// Arguments:
+// - string - The remaining string, starting with an ESC character.
+// Return Value:
+// - The number of characters the engine consumed.
+size_t StateMachine::_ActionWin32InputSequences(const std::wstring_view string)
+{
+    const auto consumed = _engine->ActionWin32InputSequences(string);
+    if (consumed)
+    {
+        _trace.TraceOnAction(L"Win32InputSequences");
+    }
+    return consumed;
+}
+
 // Routine Description:
 // - Triggers the DcsDispatch action to indicate that the listener should handle a control sequence.
 //   The returned handler function will be used to process the subsequent data string characters.
@@ -666,6 +1192,7 @@ void StateMachine::_ActionDcsDispatch(const wchar_t wch)
 {
     _trace.TraceOnAction(L"DcsDispatch");
 
+    const auto timer = _timeDispatch(_statistics, ParserStatistics::Dispatch::Dcs);
     const auto success = _SafeExecuteWithLog(wch, [=]() {
         _dcsStringHandler = _engine->ActionDcsDispatch(_identifier.Finalize(wch), { _parameters.data(), _parameters.size() });
         // If the returned handler is null, the sequence is not supported.
@@ -687,6 +1214,36 @@ void StateMachine::_ActionDcsDispatch(const wchar_t wch)
     }
 }
 
+// Routine Description:
+// - Passes these characters of a DCS data string to the handler returned by ActionDcsDispatch.
+// - If the string grows beyond the limit set with SetStringLimit, or the
+//   handler fails, the remainder of the string is ignored.
+// Arguments:
+// - string - Characters to pass through.
+// Return Value:
+// - <none>
+void StateMachine::_ActionDcsPassThrough(const std::wstring_view string)
+{
+    // The handler receives the same characters no matter how the string was split up.
+    const auto remaining = _stringLimit - std::min(_dcsStringLength, _stringLimit);
+    const auto count = std::min(string.size(), remaining);
+    _dcsStringLength += count;
+
+    for (const auto wch : string.substr(0, count))
+    {
+        if (!_dcsStringHandler(wch))
+        {
+            _EnterDcsIgnore();
+            return;
+        }
+    }
+
+    if (count < string.size())
+    {
+        _EnterDcsIgnore();
+    }
+}
+
 // Routine Description:
 // - Moves the state machine into the Ground state.
 //   This state is entered:
@@ -1660,10 +2217,7 @@ void StateMachine::_EventDcsPassThrough(const wchar_t wch)
     _trace.TraceOnEvent(L"DcsPassThrough");
     if (_isC0Code(wch) || _isDcsPassThroughValid(wch))
     {
-        if (!_dcsStringHandler(wch))
-        {
-            _EnterDcsIgnore();
-        }
+        _ActionDcsPassThrough({ &wch, 1 });
     }
     else
     {
@@ -1685,6 +2239,55 @@ void StateMachine::_EventSosPmApcString(const wchar_t /*wch*/) noexcept
     _ActionIgnore();
 }
 
+// Routine Description:
+// - Processes a 7-bit character event in any of the CSI states by looking up
+//   the transition in s_csiTransitions. This is equivalent to calling the
+//   _EventCsi* function of the current state, but without their chains of
+//   conditions. It's used when Mode::TransitionTable is set.
+// Arguments:
+// - wch - Character that triggered the event. Must be less than 0x80.
+// Return Value:
+// - <none>
+void StateMachine::_EventCsiFromTable(const wchar_t wch)
+{
+    _trace.TraceOnEvent(L"CsiFromTable");
+#pragma warning(suppress : 26446) // Prefer to use gsl::at() instead of unchecked subscript operator (bounds.4).
+#pragma warning(suppress : 26482) // Only index into arrays using constant expressions (bounds.2).
+    const auto& transitions = s_csiTransitions[static_cast<size_t>(_state) - static_cast<size_t>(VTStates::CsiEntry)];
+    const auto charClass = til::at(s_csiCharClasses, wch);
+#pragma warning(suppress : 26446) // Prefer to use gsl::at() instead of unchecked subscript operator (bounds.4).
+#pragma warning(suppress : 26482) // Only index into arrays using constant expressions (bounds.2).
+    switch (transitions[static_cast<size_t>(charClass)])
+    {
+    case CsiAction::Execute:
+        return _ActionExecute(wch);
+    case CsiAction::Ignore:
+        return _ActionIgnore();
+    case CsiAction::Collect:
+        return _ActionCollect(wch);
+    case CsiAction::CollectThenEnterIntermediate:
+        _ActionCollect(wch);
+        return _EnterCsiIntermediate();
+    case CsiAction::CollectThenEnterParam:
+        _ActionCollect(wch);
+        return _EnterCsiParam();
+    case CsiAction::Param:
+        return _ActionParam(wch);
+    case CsiAction::ParamThenEnterParam:
+        _ActionParam(wch);
+        return _EnterCsiParam();
+    case CsiAction::EnterIgnore:
+        return _EnterCsiIgnore();
+    case CsiAction::Dispatch:
+        _ActionCsiDispatch(wch);
+        return _EnterGround();
+    case CsiAction::EnterGround:
+        return _EnterGround();
+    default:
+        return;
+    }
+}
+
 // Routine Description:
 // - Entry to the state machine. Takes characters one by one and processes them according to the state machine rules.
 // Arguments:
@@ -1730,6 +2333,13 @@ void StateMachine::ProcessCharacter(const wchar_t wch)
     }
     else
     {
+        // The CSI states can also be driven by a transition table, but only for 7-bit characters.
+        // The rest is rare enough to be left to the _EventCsi* functions below.
+        if (_parserMode.test(Mode::TransitionTable) && wch < 0x80 && _state >= VTStates::CsiEntry && _state <= VTStates::CsiParam)
+        {
+            return _EventCsiFromTable(wch);
+        }
+
         // Then pass to the current state as an event
         switch (_state)
         {
@@ -1829,6 +2439,10 @@ bool StateMachine::FlushToTerminal()
 // - <none>
 void StateMachine::ProcessString(const std::wstring_view string)
 {
+    const Microsoft::Console::Types::AllocationTracker::Scope allocations{ Microsoft::Console::Types::AllocationStage::ProcessString };
+    _trace.TraceProcessStringStart(string.size());
+    _AddProcessedCharacters(string.size());
+
     size_t start = 0;
     auto current = start;
 
@@ -1851,6 +2465,8 @@ void StateMachine::ProcessString(const std::wstring_view string)
             // If we're processing characters individually, send it to the state machine.
             ProcessCharacter(til::at(string, current));
             ++current;
+            // The payload of OSC and DCS strings doesn't need to go through the state machine.
+            current = _ProcessStringPayload(string, current);
             if (_state == VTStates::Ground) // Then check if we're back at ground. If we are, the next character (pwchCurr)
             { //   is the start of the next run of characters that might be printable.
                 _processingIndividually = false;
@@ -1870,13 +2486,26 @@ void StateMachine::ProcessString(const std::wstring_view string)
                     _ActionPrintString(_CurrentRun()); // ... print all the chars leading up to it as part of the run...
                 }
 
+                // ConPTY forwards keys as win32-input-mode sequences, which the input engine can
+                // decode in bulk. Anything it doesn't consume is parsed one character at a time.
+                if (_isEngineForInput && til::at(string, current) == AsciiChars::ESC)
+                {
+                    if (const auto consumed = _ActionWin32InputSequences(string.substr(current)))
+                    {
+                        current += consumed;
+                        start = current;
+                        continue;
+                    }
+                }
+
                 _processingIndividually = true; // begin processing future characters individually...
                 start = current;
                 continue;
             }
             else
             {
-                ++current; // Otherwise, add this char to the current run to be printed.
+                // Otherwise, add this char and all the printable ones following it to the current run to be printed.
+                current = _findNextActionableFromGround(string, current + 1);
             }
         }
     }
@@ -1903,84 +2532,335 @@ void StateMachine::ProcessString(const std::wstring_view string)
     }
     else if (_processingIndividually)
     {
-        // One of the "weird things" in VT input is the case of something like
-        // <kbd>alt+[</kbd>. In VT, that's encoded as `\x1b[`. However, that's
-        // also the start of a CSI, and could be the start of a longer sequence,
-        // there's no way to know for sure. For an <kbd>alt+[</kbd> keypress,
-        // the parser originally would just sit in the `CsiEntry` state after
-        // processing it, which would pollute the following keypress (e.g.
-        // <kbd>alt+[</kbd>, <kbd>A</kbd> would be processed like `\x1b[A`,
-        // which is _wrong_).
-        //
-        // Fortunately, for VT input, each keystroke comes in as an individual
-        // write operation. So, if at the end of processing a string for the
-        // InputEngine, we find that we're not in the Ground state, that implies
-        // that we've processed some input, but not dispatched it yet. This
-        // block at the end of `ProcessString` will then re-process the
-        // undispatched string, but it will ensure that it dispatches on the
-        // last character of the string. For our previous `\x1b[` scenario, that
-        // means we'll make sure to call `_ActionEscDispatch('[')`., which will
-        // properly decode the string as <kbd>alt+[</kbd>.
+        _ProcessSequenceAtEndOfString(run);
+    }
 
-        if (_isEngineForInput)
+    _trace.TraceProcessStringStop();
+}
+
+// Routine Description:
+// - If we're in the OscString or DcsPassThrough state, this hands the
+//   characters from the given offset up to the next one that could end the
+//   string (or change how it's processed) to the engine in a single run.
+// Arguments:
+// - string - The string passed to ProcessString.
+// - offset - The index of the next character to process.
+// Return Value:
+// - The index of the first character that wasn't processed.
+size_t StateMachine::_ProcessStringPayload(const std::wstring_view string, const size_t offset)
+{
+    if (_state == VTStates::OscString)
+    {
+        // _findNextActionableFromGround stops at exactly the characters that are
+        // not simply stored in the OSC string (BEL, ESC and the other C0 and C1
+        // controls), with the exception of DEL, which is rare enough not to matter.
+        const auto end = _findNextActionableFromGround(string, offset);
+        if (end != offset)
+        {
+            _trace.TraceOnAction(L"OscPut");
+            _ActionOscPutString(string.substr(offset, end - offset));
+        }
+        return end;
+    }
+
+    if (_state == VTStates::DcsPassThrough)
+    {
+        const auto end = _findEndOfDcsPassThrough(string, offset);
+        if (end != offset)
+        {
+            _trace.TraceOnEvent(L"DcsPassThrough");
+            _ActionDcsPassThrough(string.substr(offset, end - offset));
+        }
+        return end;
+    }
+
+    return offset;
+}
+
+// Routine Description:
+// - The UTF-8 counterpart of the above. The run is converted to UTF-16 at once
+//   and appended to _u16Str, which holds the characters of the current sequence.
+// Arguments:
+// - string - The UTF-8 string passed to ProcessString.
+// - offset - The index of the next byte to process.
+// Return Value:
+// - The index of the first byte that wasn't processed.
+size_t StateMachine::_ProcessStringPayload(const std::string_view string, const size_t offset)
+{
+    // The rest of a character that was split up between calls is left to ProcessString.
+    if (_u8State.have)
+    {
+        return offset;
+    }
+
+    auto end = offset;
+    if (_state == VTStates::OscString)
+    {
+        end = _findNextActionableFromGround(string, offset);
+    }
+    else if (_state == VTStates::DcsPassThrough)
+    {
+        end = _findEndOfDcsPassThrough(string, offset);
+    }
+    if (end == offset)
+    {
+        return offset;
+    }
+
+    // If we hit a conversion error, eat the run. It's bad UTF-8, we can't do anything with it.
+    if (FAILED(til::u8u16(string.substr(offset, end - offset), _u16Scratch, _u8State)))
+    {
+        _u8State.reset();
+        return end;
+    }
+
+    const auto start = _u16Str.size();
+    _u16Str.append(_u16Scratch);
+    _currentString = _u16Str;
+    _runSize = _u16Str.size();
+
+    const auto payload = std::wstring_view{ _u16Str }.substr(start);
+    if (_state == VTStates::OscString)
+    {
+        _trace.TraceOnAction(L"OscPut");
+        _ActionOscPutString(payload);
+    }
+    else
+    {
+        _trace.TraceOnEvent(L"DcsPassThrough");
+        _ActionDcsPassThrough(payload);
+    }
+    return end;
+}
+
+// Routine Description:
+// - Handles a sequence that is still unfinished at the end of a string passed to ProcessString.
+// Arguments:
+// - run - The characters of the unfinished sequence that were part of the string. Must not be empty.
+// Return Value:
+// - <none>
+void StateMachine::_ProcessSequenceAtEndOfString(const std::wstring_view run)
+{
+    // One of the "weird things" in VT input is the case of something like
+    // <kbd>alt+[</kbd>. In VT, that's encoded as `\x1b[`. However, that's
+    // also the start of a CSI, and could be the start of a longer sequence,
+    // there's no way to know for sure. For an <kbd>alt+[</kbd> keypress,
+    // the parser originally would just sit in the `CsiEntry` state after
+    // processing it, which would pollute the following keypress (e.g.
+    // <kbd>alt+[</kbd>, <kbd>A</kbd> would be processed like `\x1b[A`,
+    // which is _wrong_).
+    //
+    // Fortunately, for VT input, each keystroke comes in as an individual
+    // write operation. So, if at the end of processing a string for the
+    // InputEngine, we find that we're not in the Ground state, that implies
+    // that we've processed some input, but not dispatched it yet. This
+    // block at the end of `ProcessString` will then re-process the
+    // undispatched string, but it will ensure that it dispatches on the
+    // last character of the string. For our previous `\x1b[` scenario, that
+    // means we'll make sure to call `_ActionEscDispatch('[')`., which will
+    // properly decode the string as <kbd>alt+[</kbd>.
+
+    if (_isEngineForInput)
+    {
+        // Reset our state, and put all but the last char in again.
+        ResetState();
+        _processingLastCharacter = false;
+        // Chars to flush are [pwchSequenceStart, pwchCurr)
+        auto wchIter = run.cbegin();
+        while (wchIter < run.cend() - 1)
+        {
+            ProcessCharacter(*wchIter);
+            wchIter++;
+        }
+        // Manually execute the last char [pwchCurr]
+        _processingLastCharacter = true;
+        switch (_state)
+        {
+        case VTStates::Ground:
+            _ActionExecute(*wchIter);
+            break;
+        case VTStates::Escape:
+        case VTStates::EscapeIntermediate:
+            _ActionEscDispatch(*wchIter);
+            break;
+        case VTStates::CsiEntry:
+        case VTStates::CsiIntermediate:
+        case VTStates::CsiIgnore:
+        case VTStates::CsiParam:
+            _ActionCsiDispatch(*wchIter);
+            break;
+        case VTStates::OscParam:
+        case VTStates::OscString:
+        case VTStates::OscTermination:
+            _ActionOscDispatch(*wchIter);
+            break;
+        case VTStates::Ss3Entry:
+        case VTStates::Ss3Param:
+            _ActionSs3Dispatch(*wchIter);
+            break;
+        }
+        // microsoft/terminal#2746: Make sure to return to the ground state
+        // after dispatching the characters
+        _EnterGround();
+    }
+    else if (_state != VTStates::SosPmApcString && _state != VTStates::DcsPassThrough && _state != VTStates::DcsIgnore)
+    {
+        // If the engine doesn't require flushing at the end of the string, we
+        // want to cache the partial sequence in case we have to flush the whole
+        // thing to the terminal later. There is no need to do this if we've
+        // reached one of the string processing states, though, since that data
+        // will be dealt with as soon as it is received.
+        if (!_cachedSequence)
+        {
+            _cachedSequence.emplace(std::wstring{});
+        }
+
+        auto& cachedSequence = *_cachedSequence;
+        cachedSequence.append(run);
+    }
+}
+
+// Routine Description:
+// - Processes a UTF-8 string, without converting all of it to UTF-16 first.
+// - Control characters and escape sequences are located directly in the bytes.
+//   Only the runs of printable text that get handed to the engine are converted,
+//   as well as any non-ASCII characters that are part of a sequence.
+// - This behaves exactly as if the string had been converted to UTF-16 and passed
+//   to the other overload, including UTF-8 characters that are split up between
+//   consecutive calls.
+// Arguments:
+// - string - UTF-8 string to process
+// Return Value:
+// - <none>
+void StateMachine::ProcessString(const std::string_view string)
+{
+    const Microsoft::Console::Types::AllocationTracker::Scope allocations{ Microsoft::Console::Types::AllocationStage::ProcessString };
+    _trace.TraceProcessStringStart(string.size());
+    _AddProcessedCharacters(string.size());
+
+    size_t current = 0;
+
+    // Also clear any sequence that was left over from the previous call. It's been cached by
+    // _ProcessSequenceAtEndOfString if that was necessary, just like in the UTF-16 overload.
+    _u16Str.clear();
+    _currentString = _u16Str;
+    _runOffset = 0;
+    _runSize = 0;
+
+    while (current < string.size())
+    {
+        if (!_processingIndividually)
         {
-            // Reset our state, and put all but the last char in again.
-            ResetState();
-            _processingLastCharacter = false;
-            // Chars to flush are [pwchSequenceStart, pwchCurr)
-            auto wchIter = run.cbegin();
-            while (wchIter < run.cend() - 1)
+            const auto end = _findNextActionableFromGround(string, current);
+            if (end != current)
             {
-                ProcessCharacter(*wchIter);
-                wchIter++;
+                // If we hit a conversion error, eat the run. It's bad UTF-8, we can't do anything with it.
+                if (FAILED(til::u8u16(string.substr(current, end - current), _u16Str, _u8State)))
+                {
+                    _u16Str.clear();
+                    _u8State.reset();
+                }
+                if (!_u16Str.empty())
+                {
+                    _currentString = _u16Str;
+                    _runSize = _u16Str.size();
+                    _ActionPrintString(_u16Str);
+                }
+                current = end;
+                continue;
             }
-            // Manually execute the last char [pwchCurr]
-            _processingLastCharacter = true;
-            switch (_state)
+
+            // Just like in the UTF-16 overload, runs of win32-input-mode sequences are decoded in bulk.
+            if (_isEngineForInput && !_u8State.have && til::at(string, current) == AsciiChars::ESC)
             {
-            case VTStates::Ground:
-                _ActionExecute(*wchIter);
-                break;
-            case VTStates::Escape:
-            case VTStates::EscapeIntermediate:
-                _ActionEscDispatch(*wchIter);
-                break;
-            case VTStates::CsiEntry:
-            case VTStates::CsiIntermediate:
-            case VTStates::CsiIgnore:
-            case VTStates::CsiParam:
-                _ActionCsiDispatch(*wchIter);
-                break;
-            case VTStates::OscParam:
-            case VTStates::OscString:
-            case VTStates::OscTermination:
-                _ActionOscDispatch(*wchIter);
-                break;
-            case VTStates::Ss3Entry:
-            case VTStates::Ss3Param:
-                _ActionSs3Dispatch(*wchIter);
-                break;
+                const auto run = string.substr(current, _findEndOfWin32InputSequences(string, current) - current);
+                _u16Scratch.clear();
+                for (const auto ch : run)
+                {
+                    _u16Scratch.push_back(static_cast<wchar_t>(ch));
+                }
+                if (const auto consumed = _ActionWin32InputSequences(_u16Scratch))
+                {
+                    current += consumed;
+                    continue;
+                }
             }
-            // microsoft/terminal#2746: Make sure to return to the ground state
-            // after dispatching the characters
-            _EnterGround();
+
+            _processingIndividually = true;
+            _u16Str.clear();
         }
-        else if (_state != VTStates::SosPmApcString && _state != VTStates::DcsPassThrough && _state != VTStates::DcsIgnore)
+
+        // Characters are processed individually until we're back at ground. They're accumulated
+        // in _u16Str in the meantime, so that _CurrentRun() returns them from FlushToTerminal.
+        const auto lead = static_cast<uint8_t>(til::at(string, current));
+        wchar_t ascii = lead;
+        std::wstring_view chars{ &ascii, 1 };
+        if (lead < 0x80 && !_u8State.have)
+        {
+            current += 1;
+        }
+        else
         {
-            // If the engine doesn't require flushing at the end of the string, we
-            // want to cache the partial sequence in case we have to flush the whole
-            // thing to the terminal later. There is no need to do this if we've
-            // reached one of the string processing states, though, since that data
-            // will be dealt with as soon as it is received.
-            if (!_cachedSequence)
+            // If we're in the middle of a character that started in the previous call,
+            // u8u16 wants just its remaining bytes, and it keeps a character incomplete
+            // at the end of the string around for the next call.
+            const auto length = std::min(_u8State.have ? size_t{ _u8State.want } : _u8SequenceLength(lead), string.size() - current);
+            current += length;
+            // Just like above, bad UTF-8 is eaten. _u16Scratch is reused so that this doesn't allocate.
+            if (FAILED(til::u8u16(string.substr(current - length, length), _u16Scratch, _u8State)))
             {
-                _cachedSequence.emplace(std::wstring{});
+                _u8State.reset();
+                continue;
+            }
+            chars = _u16Scratch;
+        }
+
+        for (size_t i = 0; i < chars.size(); ++i)
+        {
+            const auto wch = til::at(chars, i);
+            if (_state == VTStates::Ground && !_isActionableFromGround(wch))
+            {
+                // This is either the rest of a character that was split up at the end of the previous
+                // call, or the low surrogate of one that just ended a sequence. Either way, it's printable.
+                _processingIndividually = false;
+                _u16Str.assign(chars.substr(i));
+                _currentString = _u16Str;
+                _runSize = _u16Str.size();
+                _ActionPrintString(_u16Str);
+                _u16Str.clear();
+                break;
             }
 
-            auto& cachedSequence = *_cachedSequence;
-            cachedSequence.append(run);
+            _u16Str.push_back(wch);
+            _currentString = _u16Str;
+            _runSize = _u16Str.size();
+            _processingLastCharacter = current >= string.size() && i + 1 >= chars.size();
+
+            ProcessCharacter(wch);
+            if (_state == VTStates::Ground)
+            {
+                _processingIndividually = false;
+                _u16Str.clear();
+                _currentString = _u16Str;
+                _runSize = 0;
+            }
+            else if (i + 1 == chars.size())
+            {
+                // The payload of OSC and DCS strings doesn't need to go through the state machine.
+                // chars may point into _u16Scratch, which this overwrites, so it must be the last one.
+                current = _ProcessStringPayload(string, current);
+            }
         }
     }
+
+    if (_processingIndividually && !_u16Str.empty())
+    {
+        _currentString = _u16Str;
+        _runSize = _u16Str.size();
+        _ProcessSequenceAtEndOfString(_u16Str);
+    }
+
+    _trace.TraceProcessStringStop();
 }
 
 // Routine Description:
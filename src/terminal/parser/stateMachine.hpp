@@ -51,13 +51,23 @@ namespace Microsoft::Console::VirtualTerminal
         {
             AcceptC1,
             Ansi,
+            // Not a VT mode: selects the table driven CSI parser (see _EventCsiFromTable).
+            TransitionTable,
         };
 
         void SetParserMode(const Mode mode, const bool enabled) noexcept;
         bool GetParserMode(const Mode mode) const noexcept;
 
+        // The default limit for the length of OSC and DCS strings. It's large
+        // enough for any reasonable OSC 52 clipboard payload or soft font.
+        static constexpr size_t DefaultStringLimit = 8 * 1024 * 1024;
+        void SetStringLimit(const size_t limit) noexcept;
+
+        const ParserStatistics& GetStatistics() const noexcept;
+
         void ProcessCharacter(const wchar_t wch);
         void ProcessString(const std::wstring_view string);
+        void ProcessString(const std::string_view string);
         bool IsProcessingLastCharacter() const noexcept;
 
         void ResetState() noexcept;
@@ -86,9 +96,12 @@ namespace Microsoft::Console::VirtualTerminal
         void _ActionCsiDispatch(const wchar_t wch);
         void _ActionOscParam(const wchar_t wch) noexcept;
         void _ActionOscPut(const wchar_t wch);
+        void _ActionOscPutString(const std::wstring_view string);
         void _ActionOscDispatch(const wchar_t wch);
         void _ActionSs3Dispatch(const wchar_t wch);
+        size_t _ActionWin32InputSequences(const std::wstring_view string);
         void _ActionDcsDispatch(const wchar_t wch);
+        void _ActionDcsPassThrough(const std::wstring_view string);
 
         void _ActionClear();
         void _ActionIgnore() noexcept;
@@ -133,6 +146,12 @@ namespace Microsoft::Console::VirtualTerminal
         void _EventDcsParam(const wchar_t wch);
         void _EventDcsPassThrough(const wchar_t wch);
         void _EventSosPmApcString(const wchar_t wch) noexcept;
+        void _EventCsiFromTable(const wchar_t wch);
+
+        void _AddProcessedCharacters(const size_t count) noexcept;
+        size_t _ProcessStringPayload(const std::wstring_view string, const size_t offset);
+        size_t _ProcessStringPayload(const std::string_view string, const size_t offset);
+        void _ProcessSequenceAtEndOfString(const std::wstring_view run);
 
         void _AccumulateTo(const wchar_t wch, VTInt& value) noexcept;
 
@@ -192,11 +211,26 @@ namespace Microsoft::Console::VirtualTerminal
 
         std::wstring _oscString;
         VTInt _oscParameter;
+        bool _oscStringLimitReached = false;
 
         IStateMachineEngine::StringHandler _dcsStringHandler;
+        size_t _dcsStringLength = 0;
+
+        size_t _stringLimit = DefaultStringLimit;
+
+        ParserStatistics _statistics;
+        uint64_t _statisticsTracedAt = 0;
 
         std::optional<std::wstring> _cachedSequence;
 
+        // The UTF-8 overload of ProcessString only converts the text it needs to
+        // hand to the engine. This holds the current printable run or sequence.
+        std::wstring _u16Str;
+        // Holds the characters that are converted outside of _u16Str: single
+        // non-ASCII characters inside sequences, and the payload of strings.
+        std::wstring _u16Scratch;
+        til::u8state _u8State;
+
         // This is tracked per state machine instance so that separate calls to Process*
         //   can start and finish a sequence.
         bool _processingIndividually;
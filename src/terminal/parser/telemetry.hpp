@@ -109,6 +109,12 @@ namespace Microsoft::Console::VirtualTerminal
             XTPOPSGR,
             DECAC,
             DECPS,
+            DECCARA,
+            DECCRA,
+            DECFRA,
+            DECERA,
+            DECSERA,
+            DECSACE,
             // Only use this last enum as a count of the number of codes.
             NUMBER_OF_CODES
         };
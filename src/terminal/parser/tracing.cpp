@@ -134,4 +134,48 @@ void ParserTracing::DispatchPrintRunTrace(const std::wstring_view& string) const
     }
 }
 
+// Unlike the other events this one is logged at the informational level, so
+// that it can be collected without the flood of verbose per-character events.
+void ParserTracing::TraceStatistics(const ParserStatistics& statistics) const noexcept
+{
+    TraceLoggingWrite(g_hConsoleVirtTermParserEventTraceProvider,
+                      "StateMachine_Statistics",
+                      TraceLoggingValue(statistics.charactersProcessed, "CharactersProcessed"),
+                      TraceLoggingValue(statistics.printRuns, "PrintRuns"),
+                      TraceLoggingValue(statistics.printedCharacters, "PrintedCharacters"),
+                      TraceLoggingValue(statistics.AveragePrintRunLength(), "AveragePrintRunLength"),
+                      TraceLoggingValue(statistics.Dispatches(ParserStatistics::Dispatch::Execute), "ExecuteDispatches"),
+                      TraceLoggingValue(statistics.Dispatches(ParserStatistics::Dispatch::Escape), "EscapeDispatches"),
+                      TraceLoggingValue(statistics.Dispatches(ParserStatistics::Dispatch::Vt52), "Vt52Dispatches"),
+                      TraceLoggingValue(statistics.Dispatches(ParserStatistics::Dispatch::Csi), "CsiDispatches"),
+                      TraceLoggingValue(statistics.Dispatches(ParserStatistics::Dispatch::Osc), "OscDispatches"),
+                      TraceLoggingValue(statistics.Dispatches(ParserStatistics::Dispatch::Ss3), "Ss3Dispatches"),
+                      TraceLoggingValue(statistics.Dispatches(ParserStatistics::Dispatch::Dcs), "DcsDispatches"),
+                      TraceLoggingValue(statistics.EstimatedPrintNanoseconds(), "EstimatedPrintNanoseconds"),
+                      TraceLoggingValue(statistics.EstimatedDispatchNanoseconds(), "EstimatedDispatchNanoseconds"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_INFO),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+}
+
+// The ProcessString events carry the activity ID of the calling thread. The terminal sets
+// it to the one of the output it's processing, which ties them to the rest of its way.
+void ParserTracing::TraceProcessStringStart(const size_t length) const noexcept
+{
+    TraceLoggingWrite(g_hConsoleVirtTermParserEventTraceProvider,
+                      "StateMachine_ProcessString",
+                      TraceLoggingOpcode(WINEVENT_OPCODE_START),
+                      TraceLoggingUInt64(length, "Length"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+}
+
+void ParserTracing::TraceProcessStringStop() const noexcept
+{
+    TraceLoggingWrite(g_hConsoleVirtTermParserEventTraceProvider,
+                      "StateMachine_ProcessString",
+                      TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+}
+
 #pragma warning(pop)
@@ -15,6 +15,7 @@ Abstract:
 #pragma once
 
 #include "telemetry.hpp"
+#include "ParserStatistics.hpp"
 
 namespace Microsoft::Console::VirtualTerminal
 {
@@ -45,6 +46,9 @@ namespace Microsoft::Console::VirtualTerminal
         void DispatchSequenceTrace(const bool fSuccess) noexcept;
         void ClearSequenceTrace() noexcept;
         void DispatchPrintRunTrace(const std::wstring_view& string) const;
+        void TraceStatistics(const ParserStatistics& statistics) const noexcept;
+        void TraceProcessStringStart(const size_t length) const noexcept;
+        void TraceProcessStringStop() const noexcept;
 
     private:
         std::wstring _sequenceTrace;
@@ -276,6 +276,9 @@ class Microsoft::Console::VirtualTerminal::InputEngineTest
 
     TEST_METHOD(TestWin32InputParsing);
     TEST_METHOD(TestWin32InputOptionals);
+    TEST_METHOD(TestWin32InputBatching);
+    TEST_METHOD(TestWin32InputBatchingUtf8);
+    TEST_METHOD(StringToKeyRecordsTest);
 
     friend class TestInteractDispatch;
 };
@@ -1615,3 +1618,117 @@ void InputEngineTest::TestWin32InputOptionals()
         }
     }
 }
+
+void InputEngineTest::TestWin32InputBatching()
+{
+    std::vector<std::vector<INPUT_RECORD>> writes;
+    auto pfn = [&](std::deque<std::unique_ptr<IInputEvent>>& inEvents) {
+        writes.emplace_back(IInputEvent::ToInputRecords(inEvents));
+    };
+    auto dispatch = std::make_unique<TestInteractDispatch>(pfn, &testState);
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(std::move(dispatch));
+    auto stateMachine = std::make_unique<StateMachine>(std::move(inputEngine));
+
+    Log::Comment(L"Consecutive sequences are written in a single batch");
+    stateMachine->ProcessString(L"\x1b[65;30;97;1;0;1_\x1b[65;30;97;0;0;1_\x1b[66;48;98;1;;_");
+    VERIFY_ARE_EQUAL(1u, writes.size());
+    VERIFY_ARE_EQUAL(3u, writes[0].size());
+    VERIFY_ARE_EQUAL(StateMachine::VTStates::Ground, stateMachine->_state);
+    {
+        const auto& key = writes[0][1].Event.KeyEvent;
+        VERIFY_ARE_EQUAL(KEY_EVENT, writes[0][1].EventType);
+        VERIFY_ARE_EQUAL(65, key.wVirtualKeyCode);
+        VERIFY_ARE_EQUAL(30, key.wVirtualScanCode);
+        VERIFY_ARE_EQUAL(L'a', key.uChar.UnicodeChar);
+        VERIFY_IS_FALSE(key.bKeyDown);
+        VERIFY_ARE_EQUAL(0u, key.dwControlKeyState);
+        VERIFY_ARE_EQUAL(1, key.wRepeatCount);
+    }
+    {
+        Log::Comment(L"Omitted parameters take their defaults");
+        const auto& key = writes[0][2].Event.KeyEvent;
+        VERIFY_ARE_EQUAL(L'b', key.uChar.UnicodeChar);
+        VERIFY_IS_TRUE(key.bKeyDown);
+        VERIFY_ARE_EQUAL(0u, key.dwControlKeyState);
+        VERIFY_ARE_EQUAL(1, key.wRepeatCount);
+    }
+
+    Log::Comment(L"Keys with Ctrl or Alt held down go through WriteCtrlKey");
+    writes.clear();
+    testState._expectSendCtrlC = true;
+    stateMachine->ProcessString(L"\x1b[65;30;97;1;0;1_\x1b[67;46;3;1;8;1_\x1b[65;30;97;0;0;1_");
+    VERIFY_ARE_EQUAL(3u, writes.size());
+    VERIFY_ARE_EQUAL(1u, writes[0].size());
+    VERIFY_ARE_EQUAL(1u, writes[1].size());
+    VERIFY_ARE_EQUAL(static_cast<DWORD>(LEFT_CTRL_PRESSED), writes[1][0].Event.KeyEvent.dwControlKeyState);
+    VERIFY_ARE_EQUAL(1u, writes[2].size());
+
+    Log::Comment(L"A sequence split across writes falls back to the state machine");
+    writes.clear();
+    stateMachine->ProcessString(L"\x1b[65;30;97;1;0;1_\x1b[65;30");
+    VERIFY_ARE_EQUAL(1u, writes.size());
+    VERIFY_ARE_EQUAL(StateMachine::VTStates::CsiParam, stateMachine->_state);
+    stateMachine->ProcessString(L";97;0;0;1_");
+    VERIFY_ARE_EQUAL(2u, writes.size());
+    VERIFY_ARE_EQUAL(65, writes[1][0].Event.KeyEvent.wVirtualKeyCode);
+    VERIFY_IS_FALSE(writes[1][0].Event.KeyEvent.bKeyDown);
+    VERIFY_ARE_EQUAL(StateMachine::VTStates::Ground, stateMachine->_state);
+    testState._expectSendCtrlC = false;
+}
+
+void InputEngineTest::StringToKeyRecordsTest()
+{
+    Log::Comment(L"Converting a string must give the same records as converting each of its characters.");
+    const std::wstring_view string{ L"Hello, World!\r\nHello \x00e4\x3042 again\r\n" };
+
+    std::vector<INPUT_RECORD> expected;
+    for (const auto wch : string)
+    {
+        Microsoft::Console::Interactivity::CharToKeyRecords(wch, CP_USA, expected);
+    }
+
+    std::vector<INPUT_RECORD> actual;
+    Microsoft::Console::Interactivity::StringToKeyRecords(string, CP_USA, actual);
+
+    VERIFY_ARE_EQUAL(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        VERIFY_ARE_EQUAL(expected[i], actual[i]);
+    }
+}
+
+void InputEngineTest::TestWin32InputBatchingUtf8()
+{
+    std::vector<std::vector<INPUT_RECORD>> writes;
+    auto pfn = [&](std::deque<std::unique_ptr<IInputEvent>>& inEvents) {
+        writes.emplace_back(IInputEvent::ToInputRecords(inEvents));
+    };
+    auto dispatch = std::make_unique<TestInteractDispatch>(pfn, &testState);
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(std::move(dispatch));
+    auto stateMachine = std::make_unique<StateMachine>(std::move(inputEngine));
+
+    Log::Comment(L"Consecutive sequences are written in a single batch");
+    stateMachine->ProcessString(std::string_view{ "\x1b[65;30;97;1;0;1_\x1b[65;30;97;0;0;1_\x1b[66;48;98;1;;_" });
+    VERIFY_ARE_EQUAL(1u, writes.size());
+    VERIFY_ARE_EQUAL(3u, writes[0].size());
+    VERIFY_ARE_EQUAL(L'b', writes[0][2].Event.KeyEvent.uChar.UnicodeChar);
+    VERIFY_ARE_EQUAL(StateMachine::VTStates::Ground, stateMachine->_state);
+
+    Log::Comment(L"Sequences following non-ASCII text are batched as well");
+    writes.clear();
+    stateMachine->ProcessString(std::string_view{ "\xc3\xa4\x1b[65;30;97;1;0;1_\x1b[65;30;97;0;0;1_" });
+    VERIFY_ARE_EQUAL(2u, writes.size());
+    VERIFY_ARE_EQUAL(2u, writes[1].size());
+    VERIFY_ARE_EQUAL(StateMachine::VTStates::Ground, stateMachine->_state);
+
+    Log::Comment(L"A sequence split across writes falls back to the state machine");
+    writes.clear();
+    stateMachine->ProcessString(std::string_view{ "\x1b[65;30;97;1;0;1_\x1b[65;30" });
+    VERIFY_ARE_EQUAL(1u, writes.size());
+    VERIFY_ARE_EQUAL(StateMachine::VTStates::CsiParam, stateMachine->_state);
+    stateMachine->ProcessString(std::string_view{ ";97;0;0;1_" });
+    VERIFY_ARE_EQUAL(2u, writes.size());
+    VERIFY_ARE_EQUAL(65, writes[1][0].Event.KeyEvent.wVirtualKeyCode);
+    VERIFY_IS_FALSE(writes[1][0].Event.KeyEvent.bKeyDown);
+    VERIFY_ARE_EQUAL(StateMachine::VTStates::Ground, stateMachine->_state);
+}
@@ -69,9 +69,12 @@ public:
     bool ActionIgnore() override { return true; };
 
     bool ActionOscDispatch(const wchar_t /* wch */,
-                           const size_t /* parameter */,
-                           const std::wstring_view /* string */) override
+                           const size_t parameter,
+                           const std::wstring_view string) override
     {
+        oscParameter = parameter;
+        oscString = string;
+        oscDispatchCount++;
         if (pfnFlushToTerminal)
         {
             pfnFlushToTerminal();
@@ -82,6 +85,8 @@ public:
 
     bool ActionSs3Dispatch(const wchar_t /* wch */, const VTParameters /* parameters */) override { return true; };
 
+    size_t ActionWin32InputSequences(const std::wstring_view /* string */) override { return 0; };
+
     // ActionCsiDispatch is the only method that's actually implemented.
     bool ActionCsiDispatch(const VTID id, const VTParameters parameters) override
     {
@@ -129,6 +134,11 @@ public:
     // Executed string.
     std::wstring executed;
 
+    // These will only be populated if ActionOscDispatch is called.
+    size_t oscParameter = 0;
+    std::wstring oscString;
+    size_t oscDispatchCount = 0;
+
     // These will only be populated if ActionDcsDispatch is called.
     uint64_t dcsId = 0;
     std::vector<size_t> dcsParams;
@@ -154,9 +164,16 @@ class Microsoft::Console::VirtualTerminal::StateMachineTest
     TEST_METHOD(PassThroughUnhandled);
     TEST_METHOD(RunStorageBeforeEscape);
     TEST_METHOD(BulkTextPrint);
+    TEST_METHOD(BulkTextPrintStopsAtControls);
+    TEST_METHOD(TransitionTableMatchesEventHandlers);
+    TEST_METHOD(Utf8MatchesUtf16);
     TEST_METHOD(PassThroughUnhandledSplitAcrossWrites);
 
     TEST_METHOD(DcsDataStringsReceivedByHandler);
+    TEST_METHOD(StringPayloadsSplitAcrossWrites);
+    TEST_METHOD(Utf8StringPayloadsMatchUtf16);
+    TEST_METHOD(StringLimitIgnoresLongerStrings);
+    TEST_METHOD(StatisticsCountRunsAndDispatches);
 };
 
 void StateMachineTest::TwoStateMachinesDoNotInterfereWithEachOther()
@@ -229,6 +246,87 @@ void StateMachineTest::BulkTextPrint()
     VERIFY_ARE_EQUAL(String(L"12345 Hello World"), String(engine.printed.c_str()));
 }
 
+void StateMachineTest::BulkTextPrintStopsAtControls()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // The runs are long enough to be scanned in chunks, and the controls fall in the middle of them.
+    // The printable characters right next to the actionable ranges must not be mistaken for them.
+    machine.ProcessString(L"0123456789\n ~\x00a0\x00ff\x0100\x20ac abcdefgh\x7fxyz");
+
+    VERIFY_ARE_EQUAL(String(L"0123456789 ~\x00a0\x00ff\x0100\x20ac abcdefghxyz"), String(engine.printed.c_str()));
+    VERIFY_ARE_EQUAL(String(L"\n\x7f"), String(engine.executed.c_str()));
+}
+
+void StateMachineTest::TransitionTableMatchesEventHandlers()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"Data:sequence", L"{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }")
+    END_TEST_METHOD_PROPERTIES()
+
+    // Valid and invalid CSI sequences, interleaved with text, controls and DEL,
+    // so that every class of character is seen in every one of the CSI states.
+    static constexpr std::wstring_view sequences[]{
+        L"\x1b[m",
+        L"\x1b[1;38;5;123;48;2;10;20;30m",
+        L"a\x1b[?1049hb",
+        L"\x1b[;;m",
+        L"\x1b[3\x7f" L"1\nm",
+        L"\x1b[ q\x1b[2 q",
+        L"\x1b[1:2m\x1b[1;2:3mx",
+        L"\x1b[1?m\x1b[ 1m\x1b[ ?m\x1b[::m",
+        L"\x1b[>4;1m\x1b[!p\x1b[=c",
+        L"\x1b[12\x00a0;5H\x1b[\rA",
+    };
+
+    size_t index;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"sequence", index));
+    const auto sequence = til::at(sequences, index);
+
+    const auto run = [&](const bool useTransitionTable) {
+        auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+        // this dance is required because StateMachine presumes to take ownership of its engine.
+        auto& engine{ *enginePtr.get() };
+        StateMachine machine{ std::move(enginePtr) };
+        machine.SetParserMode(StateMachine::Mode::TransitionTable, useTransitionTable);
+        machine.ProcessString(sequence);
+        return std::tuple{ engine.printed, engine.executed, engine.csiId, engine.csiParams };
+    };
+
+    VERIFY_IS_TRUE(run(false) == run(true));
+}
+
+void StateMachineTest::Utf8MatchesUtf16()
+{
+    // Non-ASCII characters of every length in printable runs and in sequences,
+    // as well as a C1 control (U+0085) and a character that shares its lead byte (U+00A0).
+    static constexpr std::string_view u8{ "h\xc3\xa9llo\x1b[31m\xe2\x82\xac\r\n\x1b]0;t\xc3\xafg\xf0\x9f\x98\x80\x07 \xc2\x85\xc2\xa0\x1b[\xe2\x82\xac" };
+    static constexpr std::wstring_view u16{ L"h\x00e9llo\x1b[31m\x20ac\r\n\x1b]0;t\x00efg\xd83d\xde00\x07 \x0085\x00a0\x1b[\x20ac" };
+
+    const auto run = [](const auto first, const auto second) {
+        auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+        // this dance is required because StateMachine presumes to take ownership of its engine.
+        auto& engine{ *enginePtr.get() };
+        StateMachine machine{ std::move(enginePtr) };
+        machine.ProcessString(first);
+        machine.ProcessString(second);
+        return std::tuple{ engine.printed, engine.executed, engine.csiId, engine.csiParams };
+    };
+
+    const auto expected = run(u16, std::wstring_view{});
+
+    // Splitting the string at every byte makes sure that characters which are split
+    // between 2 calls to ProcessString are handled just like the UTF-16 overload does.
+    for (size_t i = 0; i <= u8.size(); ++i)
+    {
+        Log::Comment(NoThrowString().Format(L"Splitting at %zu", i));
+        VERIFY_IS_TRUE(expected == run(u8.substr(0, i), u8.substr(i)));
+    }
+}
+
 void StateMachineTest::PassThroughUnhandledSplitAcrossWrites()
 {
     auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
@@ -337,3 +435,150 @@ void StateMachineTest::DcsDataStringsReceivedByHandler()
     // Verify the control characters were executed (if expected).
     VERIFY_ARE_EQUAL(expectedExecuted, engine.executed);
 }
+
+void StateMachineTest::StringPayloadsSplitAcrossWrites()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // A long payload like an OSC 52 clipboard write, with a few characters that
+    // can't be handled in bulk: DEL, non-ASCII and an ignored C0 control.
+    std::wstring payload;
+    for (auto i = 0; i < 10000; i++)
+    {
+        payload += L"SGVsbG8gd29ybGQ=";
+    }
+    payload.insert(100, L"\x7f");
+    payload.insert(5000, L"\u00e4");
+    payload.insert(9000, L"\x01");
+    auto expectedOsc = payload;
+    expectedOsc.erase(9000, 1);
+
+    const auto feed = [&](const std::wstring_view sequence) {
+        // Like ConptyConnection, in chunks of at most 4096 characters.
+        for (size_t offset = 0; offset < sequence.size(); offset += 4096)
+        {
+            machine.ProcessString(sequence.substr(offset, 4096));
+        }
+    };
+
+    Log::Comment(L"OSC strings terminated with BEL and with ST");
+    feed(L"\x1b]52;c;" + payload + L"\x07");
+    VERIFY_ARE_EQUAL(1u, engine.oscDispatchCount);
+    VERIFY_ARE_EQUAL(52u, engine.oscParameter);
+    VERIFY_ARE_EQUAL(L"c;" + expectedOsc, engine.oscString);
+
+    feed(L"\x1b]52;c;" + payload + L"\x1b\\printed");
+    VERIFY_ARE_EQUAL(2u, engine.oscDispatchCount);
+    VERIFY_ARE_EQUAL(L"c;" + expectedOsc, engine.oscString);
+    VERIFY_ARE_EQUAL(L"printed", engine.printed);
+
+    Log::Comment(L"DCS strings only pass C0 controls and 0x20 to 0x7E to the handler");
+    auto expectedDcs = payload;
+    expectedDcs.erase(5000, 1);
+    expectedDcs.erase(100, 1);
+    feed(L"\x1bP1|" + payload + L"\x1b\\");
+    VERIFY_ARE_EQUAL(expectedDcs + L"\x1b", engine.dcsDataString);
+}
+
+void StateMachineTest::Utf8StringPayloadsMatchUtf16()
+{
+    // OSC and DCS payloads of more than 16 bytes, so that they're handed to the engine in bulk,
+    // with DEL, an ignored C0 control and non-ASCII characters of every length in between.
+    static constexpr std::string_view u8{ "\x1b]52;c;SGVsbG8gd29ybGQ=\x7fSGVs\xc3\xa4xG8gd29y\x01xGQ=\xe2\x82\xacSGVsbG8gd29ybGQ=\xf0\x9f\x98\x80SGVsbG8=\x07"
+                                          "a\x1bP1|SGVsbG8gd29ybGQ=\x7fSGVs\xc3\xa4xG8gd29y\x01xGQ=\xe2\x82\xacSGVsbG8gd29ybGQ=\x1b\\"
+                                          "b\x1b]0;SGVsbG8gd29ybGQ=\xc2\x9c" };
+    static constexpr std::wstring_view u16{ L"\x1b]52;c;SGVsbG8gd29ybGQ=\x7fSGVs\x00e4xG8gd29y\x01xGQ=\x20acSGVsbG8gd29ybGQ=\xd83d\xde00SGVsbG8=\x07"
+                                            L"a\x1bP1|SGVsbG8gd29ybGQ=\x7fSGVs\x00e4xG8gd29y\x01xGQ=\x20acSGVsbG8gd29ybGQ=\x1b\\"
+                                            L"b\x1b]0;SGVsbG8gd29ybGQ=\x009c" };
+
+    const auto run = [](const auto first, const auto second) {
+        auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+        // this dance is required because StateMachine presumes to take ownership of its engine.
+        auto& engine{ *enginePtr.get() };
+        StateMachine machine{ std::move(enginePtr) };
+        std::vector<std::wstring> oscStrings;
+        engine.pfnFlushToTerminal = [&]() {
+            oscStrings.emplace_back(engine.oscString);
+            return true;
+        };
+        machine.ProcessString(first);
+        machine.ProcessString(second);
+        return std::tuple{ engine.printed, engine.oscDispatchCount, oscStrings, engine.dcsDataString };
+    };
+
+    const auto expected = run(u16, std::wstring_view{});
+    VERIFY_ARE_EQUAL(3u, std::get<1>(expected));
+    VERIFY_ARE_EQUAL(L"ab", std::get<0>(expected));
+
+    for (size_t i = 0; i <= u8.size(); ++i)
+    {
+        Log::Comment(NoThrowString().Format(L"Splitting at %zu", i));
+        VERIFY_IS_TRUE(expected == run(u8.substr(0, i), u8.substr(i)));
+    }
+}
+
+void StateMachineTest::StringLimitIgnoresLongerStrings()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+    machine.SetStringLimit(10);
+
+    Log::Comment(L"OSC strings up to the limit are dispatched");
+    machine.ProcessString(L"\x1b]0;12345678\x07");
+    VERIFY_ARE_EQUAL(1u, engine.oscDispatchCount);
+    VERIFY_ARE_EQUAL(L"12345678", engine.oscString);
+
+    Log::Comment(L"Longer ones are ignored, no matter how they're split up");
+    machine.ProcessString(L"\x1b]0;12345678901\x07");
+    machine.ProcessString(L"\x1b]0;1234");
+    machine.ProcessString(L"5678901\x07");
+    machine.ProcessCharacter(L'\x1b');
+    machine.ProcessCharacter(L']');
+    machine.ProcessCharacter(L'0');
+    machine.ProcessCharacter(L';');
+    for (const auto wch : std::wstring_view{ L"12345678901" })
+    {
+        machine.ProcessCharacter(wch);
+    }
+    machine.ProcessCharacter(L'\x07');
+    VERIFY_ARE_EQUAL(1u, engine.oscDispatchCount);
+
+    Log::Comment(L"The limit doesn't carry over to the next string");
+    machine.ProcessString(L"\x1b]0;abc\x07printed");
+    VERIFY_ARE_EQUAL(2u, engine.oscDispatchCount);
+    VERIFY_ARE_EQUAL(L"abc", engine.oscString);
+    VERIFY_ARE_EQUAL(L"printed", engine.printed);
+
+    Log::Comment(L"DCS handlers receive the string up to the limit");
+    machine.ProcessString(L"\x1bP1|0123");
+    machine.ProcessString(L"456789abcdef\x1b\\");
+    VERIFY_ARE_EQUAL(L"0123456789", engine.dcsDataString);
+}
+
+void StateMachineTest::StatisticsCountRunsAndDispatches()
+{
+    StateMachine machine{ std::make_unique<TestStateMachineEngine>() };
+
+    const std::wstring_view first{ L"ab\x1b[mcde\x1b]0;title\x07\r\n" };
+    const std::wstring_view second{ L"\x1b" L"7fghi\x1bP1|x\x1b\\" };
+    machine.ProcessString(first);
+    machine.ProcessString(second);
+
+    using Dispatch = ParserStatistics::Dispatch;
+    const auto& stats = machine.GetStatistics();
+    VERIFY_ARE_EQUAL(first.size() + second.size(), stats.charactersProcessed);
+    VERIFY_ARE_EQUAL(3u, stats.printRuns);
+    VERIFY_ARE_EQUAL(9u, stats.printedCharacters);
+    VERIFY_ARE_EQUAL(3.0, stats.AveragePrintRunLength());
+    VERIFY_ARE_EQUAL(2u, stats.Dispatches(Dispatch::Execute));
+    VERIFY_ARE_EQUAL(2u, stats.Dispatches(Dispatch::Escape));
+    VERIFY_ARE_EQUAL(1u, stats.Dispatches(Dispatch::Csi));
+    VERIFY_ARE_EQUAL(1u, stats.Dispatches(Dispatch::Osc));
+    VERIFY_ARE_EQUAL(1u, stats.Dispatches(Dispatch::Dcs));
+    VERIFY_ARE_EQUAL(7u, stats.TotalDispatches());
+}
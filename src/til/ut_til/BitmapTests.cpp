@@ -580,6 +580,51 @@ class BitmapTests
         }
     }
 
+    TEST_METHOD(TranslateMatchesPointwise)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"Data:fill", L"{true, false}")
+        END_TEST_METHOD_PROPERTIES()
+
+        bool fill;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"fill", fill));
+
+        // 13x7 spans two blocks of the underlying bitset
+        // and has rows that straddle the block boundary.
+        const til::size mapSize{ 13, 7 };
+        const til::rect mapRect{ mapSize };
+        til::bitmap map{ mapSize };
+        for (const auto pt : mapRect)
+        {
+            if ((pt.x * 7 + pt.y * 3) % 5 < 2)
+            {
+                map.set(pt);
+            }
+        }
+
+        for (til::CoordType dy = -8; dy <= 8; ++dy)
+        {
+            for (til::CoordType dx = -14; dx <= 14; ++dx)
+            {
+                const til::point delta{ dx, dy };
+
+                til::bitmap expected{ mapSize };
+                for (const auto pt : mapRect)
+                {
+                    const auto source = pt - delta;
+                    if (mapRect.contains(source) ? map._bits[mapRect.index_of(source)] : fill)
+                    {
+                        expected.set(pt);
+                    }
+                }
+
+                auto actual = map;
+                actual.translate(delta, fill);
+                VERIFY_ARE_EQUAL(expected, actual, NoThrowString().Format(L"delta: %d, %d", dx, dy));
+            }
+        }
+    }
+
     TEST_METHOD(SetReset)
     {
         const til::size sz{ 4, 4 };
@@ -703,6 +748,72 @@ class BitmapTests
         _checkBits(expectedFillRects, bitmap);
     }
 
+    TEST_METHOD(SizeConstructWithFillLarge)
+    {
+        Log::Comment(L"The bits of a filled bitmap must be set beyond the first block of the bitset.");
+        const til::bitmap bitmap{ til::size{ 120, 30 }, true };
+        VERIFY_IS_TRUE(bitmap.all());
+        VERIFY_ARE_EQUAL(3600u, bitmap._bits.count());
+    }
+
+    TEST_METHOD(Union)
+    {
+        const til::size mapSize{ 10, 10 };
+        til::bitmap map{ mapSize };
+        map.set(til::rect{ 1, 1, 4, 2 });
+
+        til::bitmap other{ mapSize };
+        other.set(til::rect{ 3, 1, 9, 2 });
+        other.set(til::rect{ 0, 8, 10, 10 });
+
+        Log::Comment(L"Call runs() to fill the cache, which the union must invalidate.");
+        VERIFY_ARE_EQUAL(1u, map.runs().size());
+
+        map |= other;
+
+        const std::vector<til::rect> expected{
+            til::rect{ 1, 1, 9, 2 },
+            til::rect{ 0, 8, 10, 9 },
+            til::rect{ 0, 9, 10, 10 },
+        };
+        _checkBits(expected, map);
+        VERIFY_ARE_EQUAL(expected, std::vector<til::rect>(map.runs().begin(), map.runs().end()));
+
+        Log::Comment(L"Bitmaps of different size can't be merged.");
+        til::bitmap smaller{ til::size{ 5, 5 } };
+        auto fn = [&]() {
+            map |= smaller;
+        };
+        VERIFY_THROWS_SPECIFIC(fn(), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+    }
+
+    TEST_METHOD(DirtyRows)
+    {
+        const til::size mapSize{ 100, 10 };
+        til::bitmap map{ mapSize };
+
+        Log::Comment(L"An empty map has no dirty rows.");
+        VERIFY_ARE_EQUAL(0u, map.dirty_rows().size());
+
+        map.set(til::point{ 99, 1 });
+        map.set(til::rect{ 10, 2, 20, 4 });
+        map.set(til::point{ 0, 4 });
+        map.set(til::point{ 70, 9 });
+
+        const std::vector<til::rect> expected{
+            til::rect{ 0, 1, 100, 5 },
+            til::rect{ 0, 9, 100, 10 },
+        };
+        const auto actual = map.dirty_rows();
+        VERIFY_ARE_EQUAL(expected, std::vector<til::rect>(actual.begin(), actual.end()));
+
+        Log::Comment(L"A full map is a single dirty area.");
+        map.set_all();
+        const auto all = map.dirty_rows();
+        VERIFY_ARE_EQUAL(1u, all.size());
+        VERIFY_ARE_EQUAL(til::rect{ mapSize }, all.front());
+    }
+
     TEST_METHOD(One)
     {
         Log::Comment(L"When created, it should be not be one.");
@@ -1099,4 +1210,59 @@ class BitmapTests
         }
         VERIFY_ARE_EQUAL(expected, actual);
     }
+
+    // The following measure the operations the renderers perform on their
+    // invalidation map every frame, on a viewport of a 4K screen at a small font size.
+    TEST_METHOD(TranslatePerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        static constexpr auto iterations = 10000;
+        til::bitmap map{ til::size{ 480, 135 } };
+        map.set(til::rect{ 0, 100, 480, 135 });
+
+        const auto start = std::chrono::steady_clock::now();
+        for (auto i = 0; i < iterations; ++i)
+        {
+            map.translate(til::point{ i & 1 ? 1 : -1, -1 }, true);
+        }
+        const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        Log::Comment(NoThrowString().Format(L"%d translations took %lld us. Avg %.3f us per call", iterations, delta, static_cast<double>(delta) / iterations));
+    }
+
+    TEST_METHOD(RunsPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        static constexpr auto iterations = 1000;
+        til::bitmap map{ til::size{ 480, 135 } };
+        for (til::CoordType y = 0; y < 135; y += 2)
+        {
+            map.set(til::rect{ y, y, 480, y + 1 });
+        }
+
+        size_t runs = 0;
+        size_t rows = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (auto i = 0; i < iterations; ++i)
+        {
+            runs += std::vector<til::rect>(map.begin(), map.end()).size();
+        }
+        const auto middle = std::chrono::steady_clock::now();
+        for (auto i = 0; i < iterations; ++i)
+        {
+            rows += map.dirty_rows().size();
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        const auto runsDelta = std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count();
+        const auto rowsDelta = std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count();
+        Log::Comment(NoThrowString().Format(L"runs: %zu in %lld us. Avg %.3f us per call", runs, runsDelta, static_cast<double>(runsDelta) / iterations));
+        Log::Comment(NoThrowString().Format(L"dirty_rows: %zu in %lld us. Avg %.3f us per call", rows, rowsDelta, static_cast<double>(rowsDelta) / iterations));
+    }
 };
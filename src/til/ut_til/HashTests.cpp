@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include <random>
+
+#include <til/flat_hash_map.h>
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace std::string_view_literals;
+
+class HashTests
+{
+    TEST_CLASS(HashTests);
+
+    TEST_METHOD(HashBytesMatchesReference)
+    {
+        // These are the test vectors of the wyhash reference implementation (final version 4).
+        // The seed of each vector is its index.
+        static constexpr std::pair<std::string_view, uint64_t> vectors[]{
+            { ""sv, 0x93228a4de0eec5a2 },
+            { "a"sv, 0xc5bac3db178713c4 },
+            { "abc"sv, 0xa97f2f7b1d9b3314 },
+            { "message digest"sv, 0x786d1f1df3801df4 },
+            { "abcdefghijklmnopqrstuvwxyz"sv, 0xdca5a8138ad37c87 },
+            { "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789"sv, 0xb9e734f117cfaf70 },
+            { "12345678901234567890123456789012345678901234567890123456789012345678901234567890"sv, 0x6cc5eab49a92d617 },
+        };
+
+        uint64_t seed = 0;
+        for (const auto& [input, expected] : vectors)
+        {
+            VERIFY_ARE_EQUAL(static_cast<size_t>(expected), til::hash_bytes(input.data(), input.size(), seed));
+            ++seed;
+        }
+    }
+
+    TEST_METHOD(StringsAndViewsHashIdentically)
+    {
+        const std::wstring str{ L"https://example.com/" };
+        VERIFY_ARE_EQUAL(til::hash(str), til::hash(std::wstring_view{ str }));
+        VERIFY_ARE_EQUAL(til::hash_functor{}(str), til::hash_functor{}(std::wstring_view{ str }));
+        VERIFY_ARE_NOT_EQUAL(til::hash(str), til::hash(std::wstring_view{ str }.substr(1)));
+    }
+
+    TEST_METHOD(FlatHashMapBasic)
+    {
+        til::flat_hash_map<std::wstring, uint16_t> map;
+        VERIFY_IS_TRUE(map.empty());
+        VERIFY_IS_TRUE(map.find(L"foo"sv) == map.end());
+
+        VERIFY_IS_TRUE(map.try_emplace(L"foo"sv, uint16_t{ 1 }).second);
+        VERIFY_IS_FALSE(map.try_emplace(L"foo"sv, uint16_t{ 2 }).second);
+        VERIFY_ARE_EQUAL(1u, map.at(L"foo"sv));
+
+        map.insert_or_assign(std::wstring{ L"foo" }, uint16_t{ 3 });
+        map[L"bar"sv] = 4;
+        VERIFY_ARE_EQUAL(2u, map.size());
+        VERIFY_ARE_EQUAL(3u, map.at(L"foo"sv));
+        VERIFY_ARE_EQUAL(4u, map.at(std::wstring{ L"bar" }));
+        uint16_t unused{};
+        VERIFY_THROWS(unused = map.at(L"baz"sv), std::out_of_range);
+
+        VERIFY_ARE_EQUAL(1u, map.erase(L"foo"sv));
+        VERIFY_ARE_EQUAL(0u, map.erase(L"foo"sv));
+        VERIFY_IS_FALSE(map.contains(L"foo"sv));
+        VERIFY_IS_TRUE(map.contains(L"bar"sv));
+
+        map.erase(map.find(L"bar"sv));
+        VERIFY_IS_TRUE(map.empty());
+        VERIFY_IS_TRUE(map.begin() == map.end());
+    }
+
+    TEST_METHOD(FlatHashMapMatchesUnorderedMap)
+    {
+        // The backward shift deletion is the tricky part of the map, so this mixes lots of
+        // insertions and erasures of a small key space, which produces long probe sequences.
+        til::flat_hash_map<uint32_t, uint32_t> map;
+        std::unordered_map<uint32_t, uint32_t> expected;
+        std::mt19937 rng{ 1234 };
+
+        for (uint32_t i = 0; i < 100000; ++i)
+        {
+            const auto key = rng() % 1000;
+            switch (rng() % 3)
+            {
+            case 0:
+                map.insert_or_assign(key, i);
+                expected.insert_or_assign(key, i);
+                break;
+            case 1:
+                VERIFY_ARE_EQUAL(expected.erase(key), map.erase(key));
+                break;
+            default:
+            {
+                const auto it = map.find(key);
+                const auto jt = expected.find(key);
+                VERIFY_ARE_EQUAL(jt == expected.end(), it == map.end());
+                if (jt != expected.end())
+                {
+                    VERIFY_ARE_EQUAL(jt->second, it->second);
+                }
+                break;
+            }
+            }
+            VERIFY_ARE_EQUAL(expected.size(), map.size());
+        }
+
+        size_t count = 0;
+        for (const auto& [key, value] : map)
+        {
+            VERIFY_ARE_EQUAL(expected.at(key), value);
+            ++count;
+        }
+        VERIFY_ARE_EQUAL(expected.size(), count);
+    }
+};
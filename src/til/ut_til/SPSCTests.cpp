@@ -57,6 +57,7 @@ class SPSCTests
     TEST_METHOD(DropSameRevolutionTest);
     TEST_METHOD(DropDifferentRevolutionTest);
     TEST_METHOD(IntegrationTest);
+    TEST_METHOD(BlockNeverTest);
 };
 
 void SPSCTests::SmokeTest()
@@ -80,14 +81,17 @@ void SPSCTests::SmokeTest()
     tx.push(data.begin(), data.end());
     tx.push(til::spsc::block_initially, data.begin(), data.end());
     tx.push(til::spsc::block_forever, data.begin(), data.end());
+    tx.push(til::spsc::block_never, data.begin(), data.end());
     tx.push_n(data.begin(), data.size());
     tx.push_n(til::spsc::block_initially, data.begin(), data.size());
     tx.push_n(til::spsc::block_forever, data.begin(), data.size());
+    tx.push_n(til::spsc::block_never, data.begin(), data.size());
 
     // pop
     auto x = rx.pop();
     rx.pop_n(til::spsc::block_initially, data.begin(), data.size());
     rx.pop_n(til::spsc::block_forever, data.begin(), data.size());
+    rx.pop_n(til::spsc::block_never, data.begin(), data.size());
 }
 
 void SPSCTests::DropEmptyTest()
@@ -227,3 +231,30 @@ void SPSCTests::IntegrationTest()
 
     t.join();
 }
+
+void SPSCTests::BlockNeverTest()
+{
+    auto [tx, rx] = til::spsc::channel<int>(4);
+    std::array<int, 6> data{ 1, 2, 3, 4, 5, 6 };
+
+    // Only as many items are pushed as there is capacity for.
+    auto [pushed, pushOk] = tx.push_n(til::spsc::block_never, data.begin(), data.size());
+    VERIFY_ARE_EQUAL(4u, pushed);
+    VERIFY_IS_TRUE(pushOk);
+
+    std::array<int, 6> received{};
+    auto [popped, popOk] = rx.pop_n(til::spsc::block_never, received.begin(), received.size());
+    VERIFY_ARE_EQUAL(4u, popped);
+    VERIFY_IS_TRUE(popOk);
+    VERIFY_ARE_EQUAL(4, received[3]);
+
+    // An empty queue returns nothing right away instead of waiting for the producer.
+    std::tie(popped, popOk) = rx.pop_n(til::spsc::block_never, received.begin(), received.size());
+    VERIFY_ARE_EQUAL(0u, popped);
+    VERIFY_IS_TRUE(popOk);
+
+    drop(tx);
+    std::tie(popped, popOk) = rx.pop_n(til::spsc::block_never, received.begin(), received.size());
+    VERIFY_ARE_EQUAL(0u, popped);
+    VERIFY_IS_FALSE(popOk);
+}
@@ -39,4 +39,15 @@ class ThrottledFuncTests
 
         latch.wait();
     }
+
+    TEST_METHOD(WindowLength)
+    {
+        using namespace std::chrono_literals;
+
+        // Short delays must fire on time, longer ones may be coalesced by a tenth of their delay.
+        VERIFY_ARE_EQUAL(0u, til::details::throttled_func_window_length(8ms));
+        VERIFY_ARE_EQUAL(10u, til::details::throttled_func_window_length(100ms));
+        VERIFY_ARE_EQUAL(50u, til::details::throttled_func_window_length(500ms));
+        VERIFY_ARE_EQUAL(1000u, til::details::throttled_func_window_length(60s));
+    }
 };
@@ -17,6 +17,7 @@ class Utf8Utf16ConvertTests
     TEST_METHOD(TestU8ToU16Partials);
     TEST_METHOD(TestU16ToU8Partials);
     TEST_METHOD(TestU8ToU16OneByOne);
+    TEST_METHOD(TestAsciiRunsMatchPlatform);
 };
 
 void Utf8Utf16ConvertTests::TestU8ToU16()
@@ -191,3 +192,38 @@ void Utf8Utf16ConvertTests::TestU8ToU16OneByOne()
     VERIFY_SUCCEEDED(til::u8u16(u8String1_4, u16Out1, state));
     VERIFY_ARE_EQUAL(u16StringComp1, u16Out1);
 }
+
+void Utf8Utf16ConvertTests::TestAsciiRunsMatchPlatform()
+{
+    // The ASCII fast path processes 16 characters at a time and hands
+    // everything else to the platform functions. Mix ASCII runs of every
+    // length around that with multi-byte characters, an invalid byte and
+    // a lone surrogate, and make sure the results don't differ.
+    std::string u8String{};
+    std::wstring u16String{};
+    for (size_t run = 0; run < 40; ++run)
+    {
+        u8String.append(run, 'a');
+        u8String.append("\xC3\xB6\xE2\x82\xAC\xF0\xA4\xBD\x9C");
+        u16String.append(run, L'a');
+        u16String.append(L"\x00f6\x20ac\xd853\xdf5c");
+        if (run % 7 == 0)
+        {
+            u8String.push_back('\xFF');
+            u16String.push_back(L'\xdc00');
+        }
+    }
+
+    std::wstring u16Expected(u8String.size(), L'\0');
+    u16Expected.resize(MultiByteToWideChar(CP_UTF8, 0, u8String.data(), gsl::narrow<int>(u8String.size()), u16Expected.data(), gsl::narrow<int>(u16Expected.size())));
+    std::string u8Expected(u16String.size() * 3, '\0');
+    u8Expected.resize(WideCharToMultiByte(CP_UTF8, 0, u16String.data(), gsl::narrow<int>(u16String.size()), u8Expected.data(), gsl::narrow<int>(u8Expected.size()), nullptr, nullptr));
+
+    std::wstring u16Out{};
+    VERIFY_ARE_EQUAL(S_OK, til::u8u16(u8String, u16Out));
+    VERIFY_ARE_EQUAL(u16Expected, u16Out);
+
+    std::string u8Out{};
+    VERIFY_ARE_EQUAL(S_OK, til::u16u8(u16String, u8Out));
+    VERIFY_ARE_EQUAL(u8Expected, u8Out);
+}
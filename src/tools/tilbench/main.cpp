@@ -0,0 +1,598 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// TEST TOOL tilbench
+// Microbenchmarks for the til containers and the text buffer primitives that
+// sit on the hot paths of the output pipeline.
+//
+// Usage: tilbench [--json] [--filter SUBSTRING] [--repetitions N] [--min-time MS]
+// Every benchmark first finds an iteration count that takes at least
+// --min-time (default 200 ms) and then runs that many iterations --repetitions
+// times (default 5). It reports the median time per iteration, as wall clock
+// time and as CPU time of the benchmarking thread, and the items per second
+// where a benchmark processes more than one item per iteration.
+//
+// --json prints the results as JSON instead of a table. The output is meant to
+// be compared across builds, so it's stable: the benchmarks are always listed
+// in the same order under the same names, their inputs are generated with a
+// fixed seed, and new fields are only ever appended. An example:
+// {
+//   "schema_version": 1,
+//   "context": { "executable": "tilbench.exe", "build_type": "release", "num_cpus": 16, "repetitions": 5, "min_time_ms": 200 },
+//   "benchmarks": [
+//     { "name": "bitmap/set_rects", "iterations": 8192, "real_time_ns": 1234.5, "cpu_time_ns": 1230.1, "items_per_second": 51880000.0 },
+//     ...
+//   ]
+// }
+
+#include "precomp.h"
+
+#include <chrono>
+#include <random>
+
+#include <til/ticket_lock.h>
+
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../buffer/out/UnicodeStorage.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+#include "../../types/inc/CodepointWidthDetector.hpp"
+
+namespace
+{
+    constexpr til::CoordType RowWidth = 120;
+
+    struct Options
+    {
+        bool json = false;
+        std::wstring filter;
+        int repetitions = 5;
+        std::chrono::milliseconds minTime{ 200 };
+    };
+
+    struct Result
+    {
+        std::string_view name;
+        uint64_t iterations = 0;
+        double realTimeNs = 0;
+        double cpuTimeNs = 0;
+        // 0 if the benchmark doesn't process individual items.
+        double itemsPerSecond = 0;
+    };
+
+    // Keeps the compiler from optimizing away the computation of `value`.
+    template<typename T>
+    void DoNotOptimize(const T& value) noexcept
+    {
+        static const void* volatile sink;
+        sink = &value;
+        _ReadWriteBarrier();
+    }
+
+    std::chrono::nanoseconds ThreadCpuTime() noexcept
+    {
+        FILETIME creation, exit, kernel, user;
+        if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+        {
+            return {};
+        }
+        // FILETIMEs count in 100ns units.
+        const auto ticks = (uint64_t{ kernel.dwHighDateTime } << 32 | kernel.dwLowDateTime) + (uint64_t{ user.dwHighDateTime } << 32 | user.dwLowDateTime);
+        return std::chrono::nanoseconds{ ticks * 100 };
+    }
+
+    class Runner
+    {
+    public:
+        explicit Runner(Options options) :
+            _options{ std::move(options) }
+        {
+        }
+
+        const std::vector<Result>& Results() const noexcept
+        {
+            return _results;
+        }
+
+        // Runs func(), which processes `items` items per call, as often as necessary
+        // for a stable measurement. `name` must be a string literal; it's the name
+        // of the benchmark in the output and must not change once it was added.
+        template<typename Func>
+        void Run(const std::string_view name, const uint64_t items, Func&& func)
+        {
+            if (!_options.filter.empty() && til::u8u16(name).find(_options.filter) == std::wstring::npos)
+            {
+                return;
+            }
+
+            // Calibration: grow the iteration count until a batch takes at least minTime.
+            uint64_t iterations = 1;
+            for (;;)
+            {
+                const auto [real, cpu] = _measure(iterations, func);
+                if (real >= _options.minTime || iterations >= (uint64_t{ 1 } << 40))
+                {
+                    break;
+                }
+                // Aim for 1.5x minTime, but grow by at most 10x per step,
+                // as the first few batches are too short to be accurate.
+                const auto ratio = real.count() > 0 ? 1.5 * std::chrono::duration<double>(_options.minTime) / real : 10.0;
+                iterations = std::max(iterations + 1, static_cast<uint64_t>(iterations * std::min(ratio, 10.0)));
+            }
+
+            std::vector<std::pair<double, double>> samples;
+            samples.reserve(_options.repetitions);
+            for (auto i = 0; i < _options.repetitions; ++i)
+            {
+                const auto [real, cpu] = _measure(iterations, func);
+                samples.emplace_back(std::chrono::duration<double, std::nano>(real).count() / iterations,
+                                     std::chrono::duration<double, std::nano>(cpu).count() / iterations);
+            }
+
+            // The wall clock and CPU times are sorted separately. Their medians needn't be from the same repetition.
+            const auto median = [&](auto projection) {
+                std::vector<double> values;
+                for (const auto& sample : samples)
+                {
+                    values.emplace_back(projection(sample));
+                }
+                const auto middle = values.begin() + values.size() / 2;
+                std::nth_element(values.begin(), middle, values.end());
+                return *middle;
+            };
+
+            auto& result = _results.emplace_back();
+            result.name = name;
+            result.iterations = iterations;
+            result.realTimeNs = median([](const auto& sample) { return sample.first; });
+            result.cpuTimeNs = median([](const auto& sample) { return sample.second; });
+            result.itemsPerSecond = items > 1 && result.realTimeNs > 0 ? items * 1e9 / result.realTimeNs : 0;
+        }
+
+    private:
+        template<typename Func>
+        static std::pair<std::chrono::steady_clock::duration, std::chrono::nanoseconds> _measure(const uint64_t iterations, Func& func)
+        {
+            const auto cpuStart = ThreadCpuTime();
+            const auto start = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < iterations; ++i)
+            {
+                func();
+            }
+            const auto end = std::chrono::steady_clock::now();
+            const auto cpuEnd = ThreadCpuTime();
+            return { end - start, cpuEnd - cpuStart };
+        }
+
+        Options _options;
+        std::vector<Result> _results;
+    };
+
+    // A mix of the text that's commonly written into a terminal: mostly ASCII,
+    // with some accented latin, CJK and emoji (as surrogate pairs) in between.
+    std::wstring GenerateMixedText(std::mt19937& rng, const size_t length)
+    {
+        static constexpr std::array<std::wstring_view, 8> pieces{
+            L"The quick brown fox ",
+            L"jumps over the lazy dog. ",
+            L"0123456789 ",
+            L"\u00e9t\u00e9 \u00fcber ",
+            L"\u65e5\u672c\u8a9e ",
+            L"\u4e2d\u6587 ",
+            L"\U0001F600\U0001F680 ",
+            L"{}[]()<>;:'\" ",
+        };
+        std::uniform_int_distribution<size_t> piece{ 0, pieces.size() - 1 };
+
+        std::wstring text;
+        while (text.size() < length)
+        {
+            text.append(til::at(pieces, piece(rng)));
+        }
+        return text;
+    }
+
+    void BenchmarkTil(Runner& runner, std::mt19937& rng)
+    {
+        {
+            // The dirty regions of a frame: a few hundred small rectangles in a 120x30 viewport.
+            std::uniform_int_distribution<til::CoordType> x{ 0, RowWidth - 1 };
+            std::uniform_int_distribution<til::CoordType> y{ 0, 29 };
+            std::vector<til::rect> rects;
+            for (auto i = 0; i < 256; ++i)
+            {
+                const auto left = x(rng);
+                const auto top = y(rng);
+                rects.emplace_back(left, top, std::min(RowWidth, left + 1 + x(rng) / 8), top + 1);
+            }
+
+            til::bitmap bitmap{ til::size{ RowWidth, 30 } };
+            runner.Run("bitmap/set_rects", rects.size(), [&]() {
+                bitmap.reset_all();
+                for (const auto& rc : rects)
+                {
+                    bitmap.set(rc);
+                }
+                DoNotOptimize(bitmap);
+            });
+
+            for (const auto& rc : rects)
+            {
+                bitmap.set(rc);
+            }
+            runner.Run("bitmap/runs", 1, [&]() {
+                // runs() caches its result until the bitmap is modified again.
+                bitmap.set(til::point{ 0, 0 });
+                DoNotOptimize(bitmap.runs());
+            });
+        }
+
+        {
+            // The colors of a row, as they're written by a colorful shell prompt.
+            std::uniform_int_distribution<uint16_t> start{ 0, RowWidth - 1 };
+            std::uniform_int_distribution<uint16_t> length{ 1, 16 };
+            std::uniform_int_distribution<uint16_t> value{ 0, 15 };
+            std::vector<std::tuple<uint16_t, uint16_t, uint16_t>> replacements;
+            for (auto i = 0; i < 256; ++i)
+            {
+                const auto begin = start(rng);
+                replacements.emplace_back(begin, std::min<uint16_t>(RowWidth, begin + length(rng)), value(rng));
+            }
+
+            til::rle<uint16_t, uint16_t> rle{ static_cast<uint16_t>(RowWidth), 0 };
+            runner.Run("rle/replace", replacements.size(), [&]() {
+                for (const auto& [begin, end, v] : replacements)
+                {
+                    rle.replace(begin, end, v);
+                }
+                DoNotOptimize(rle);
+            });
+
+            runner.Run("rle/at", RowWidth, [&]() {
+                uint32_t sum = 0;
+                for (uint16_t i = 0; i < RowWidth; ++i)
+                {
+                    sum += rle.at(i);
+                }
+                DoNotOptimize(sum);
+            });
+        }
+
+        {
+            static constexpr uint32_t capacity = 1024;
+            const auto channel = til::spsc::channel<uint32_t>(capacity);
+            std::array<uint32_t, capacity> items{};
+
+            runner.Run("spsc/emplace_pop_n", capacity, [&]() {
+                for (uint32_t i = 0; i < capacity; ++i)
+                {
+                    channel.first.emplace(i);
+                }
+                DoNotOptimize(channel.second.pop_n(items.begin(), items.size()));
+            });
+
+            // The producer runs on a separate thread for the duration of the benchmark,
+            // so that this measures the transfer of items and not the creation of threads.
+            static constexpr uint32_t batch = 64 * 1024;
+            auto threaded = til::spsc::channel<uint32_t>(capacity);
+            std::thread producerThread{ [p = std::move(threaded.first)]() {
+                for (uint32_t i = 0;; ++i)
+                {
+                    if (!p.emplace(i))
+                    {
+                        return;
+                    }
+                }
+            } };
+
+            runner.Run("spsc/cross_thread", batch, [&]() {
+                for (uint32_t received = 0; received < batch;)
+                {
+                    received += static_cast<uint32_t>(threaded.second.pop_n(items.begin(), std::min<size_t>(items.size(), batch - received)).first);
+                }
+                DoNotOptimize(items);
+            });
+
+            // Dropping the consumer makes emplace() fail, which ends the producer thread.
+            { [[maybe_unused]] const auto drop = std::move(threaded.second); }
+            producerThread.join();
+        }
+
+        {
+            til::ticket_lock lock;
+            runner.Run("ticket_lock/uncontended", 1, [&]() {
+                lock.lock();
+                lock.unlock();
+                DoNotOptimize(lock);
+            });
+        }
+
+        {
+            std::string ascii(64 * 1024, 'a');
+            for (size_t i = 0; i < ascii.size(); ++i)
+            {
+                ascii[i] = static_cast<char>(' ' + i % 95);
+            }
+            const auto mixed16 = GenerateMixedText(rng, 64 * 1024);
+            const auto mixed8 = til::u16u8(mixed16);
+
+            std::wstring out16;
+            std::string out8;
+            runner.Run("u8u16/ascii", ascii.size(), [&]() {
+                LOG_IF_FAILED(til::u8u16(ascii, out16));
+                DoNotOptimize(out16);
+            });
+            runner.Run("u8u16/mixed", mixed8.size(), [&]() {
+                LOG_IF_FAILED(til::u8u16(mixed8, out16));
+                DoNotOptimize(out16);
+            });
+            runner.Run("u16u8/mixed", mixed16.size(), [&]() {
+                LOG_IF_FAILED(til::u16u8(mixed16, out8));
+                DoNotOptimize(out8);
+            });
+        }
+    }
+
+    void BenchmarkBuffer(Runner& runner, std::mt19937& rng)
+    {
+        DummyRenderer renderer;
+        const TextAttribute attributes{ 0x7 };
+
+        {
+            TextBuffer buffer{ { RowWidth, 30 }, attributes, 0, false, renderer };
+            auto& row = buffer.GetRowByOffset(0);
+
+            const std::wstring ascii(RowWidth, L'x');
+            runner.Run("row/write_cells/ascii", RowWidth, [&]() {
+                DoNotOptimize(row.WriteCells(OutputCellIterator{ ascii, attributes }, 0));
+            });
+
+            const std::wstring cjk(RowWidth / 2, L'\u65e5');
+            runner.Run("row/write_cells/cjk", RowWidth / 2, [&]() {
+                DoNotOptimize(row.WriteCells(OutputCellIterator{ cjk, attributes }, 0));
+            });
+
+            const auto mixed = GenerateMixedText(rng, RowWidth);
+            runner.Run("row/write_cells/mixed", RowWidth, [&]() {
+                DoNotOptimize(row.WriteCells(OutputCellIterator{ mixed, attributes }, 0));
+            });
+
+            // A colorful prompt: short runs in 16 different colors, randomly placed.
+            std::uniform_int_distribution<til::CoordType> start{ 0, RowWidth - 1 };
+            std::uniform_int_distribution<til::CoordType> length{ 1, 16 };
+            std::uniform_int_distribution<WORD> color{ 0, 15 };
+            std::vector<std::tuple<til::CoordType, til::CoordType, TextAttribute>> replacements;
+            for (auto i = 0; i < 256; ++i)
+            {
+                const auto begin = start(rng);
+                replacements.emplace_back(begin, std::min(RowWidth, begin + length(rng)), TextAttribute{ color(rng) });
+            }
+
+            auto& attrRow = row.GetAttrRow();
+            runner.Run("attr_row/replace", replacements.size(), [&]() {
+                for (const auto& [begin, end, attr] : replacements)
+                {
+                    attrRow.Replace(begin, end, attr);
+                }
+                DoNotOptimize(attrRow);
+            });
+        }
+
+        {
+            TextBuffer buffer{ { RowWidth, 9001 }, attributes, 0, false, renderer };
+            runner.Run("text_buffer/increment_circular_buffer", 1, [&]() {
+                DoNotOptimize(buffer.IncrementCircularBuffer());
+            });
+        }
+
+        {
+            // 1000 lines of text, every third of which wraps, reflowed from 120 to 80 columns.
+            TextBuffer buffer{ { RowWidth, 1000 }, attributes, 0, false, renderer };
+            const auto text = GenerateMixedText(rng, RowWidth * 1000);
+            OutputCellIterator it{ text, attributes };
+            for (til::CoordType y = 0; y < 1000 && it; ++y)
+            {
+                auto& row = buffer.GetRowByOffset(y);
+                it = row.WriteCells(it, 0, y % 3 != 2);
+            }
+            buffer.GetCursor().SetPosition({ 0, 999 });
+
+            runner.Run("text_buffer/reflow", 1000, [&]() {
+                TextBuffer reflowed{ { 80, 1000 }, attributes, 0, false, renderer };
+                LOG_IF_FAILED(TextBuffer::Reflow(buffer, reflowed, std::nullopt, std::nullopt));
+                DoNotOptimize(reflowed);
+            });
+        }
+
+        {
+            // What a row full of emoji stores: a surrogate pair in every other column.
+            const UnicodeStorage::mapped_type glyph{ L'\xD83D', L'\xDE00' };
+            UnicodeStorage storage;
+            runner.Run("unicode_storage/store_glyph", RowWidth / 2, [&]() {
+                for (til::CoordType column = 0; column < RowWidth; column += 2)
+                {
+                    storage.StoreGlyph(column, glyph);
+                }
+                DoNotOptimize(storage);
+            });
+
+            runner.Run("unicode_storage/erase_truncate", RowWidth / 2, [&]() {
+                for (til::CoordType column = 0; column < RowWidth; column += 2)
+                {
+                    storage.StoreGlyph(column, glyph);
+                }
+                storage.Erase(RowWidth / 4, RowWidth / 2);
+                storage.Truncate(RowWidth * 3 / 4);
+                storage.Clear();
+                DoNotOptimize(storage);
+            });
+        }
+
+        {
+            const CodepointWidthDetector detector;
+            const auto measure = [&](const std::string_view name, const std::vector<std::wstring>& glyphs) {
+                runner.Run(name, glyphs.size(), [&]() {
+                    size_t wide = 0;
+                    for (const auto& glyph : glyphs)
+                    {
+                        wide += detector.GetWidth(glyph) == CodepointWidth::Wide;
+                    }
+                    DoNotOptimize(wide);
+                });
+            };
+
+            std::vector<std::wstring> ascii;
+            for (wchar_t ch = L' '; ch < L'\x7f'; ++ch)
+            {
+                ascii.emplace_back(1, ch);
+            }
+            measure("codepoint_width/ascii", ascii);
+
+            std::vector<std::wstring> cjk;
+            for (wchar_t ch = L'\u4e00'; ch < L'\u4e80'; ++ch)
+            {
+                cjk.emplace_back(1, ch);
+            }
+            measure("codepoint_width/cjk", cjk);
+
+            std::vector<std::wstring> emoji;
+            for (char32_t ch = U'\U0001F600'; ch < U'\U0001F680'; ++ch)
+            {
+                const auto offset = ch - 0x10000;
+                emoji.emplace_back(std::initializer_list<wchar_t>{ static_cast<wchar_t>(0xD800 + (offset >> 10)), static_cast<wchar_t>(0xDC00 + (offset & 0x3FF)) });
+            }
+            measure("codepoint_width/emoji", emoji);
+        }
+    }
+
+    std::wstring EscapeJson(const std::wstring_view text)
+    {
+        std::wstring escaped;
+        for (const auto ch : text)
+        {
+            if (ch == L'"' || ch == L'\\')
+            {
+                escaped.push_back(L'\\');
+                escaped.push_back(ch);
+            }
+            else if (ch < L' ')
+            {
+                fmt::format_to(std::back_inserter(escaped), L"\\u{:04x}", static_cast<unsigned int>(ch));
+            }
+            else
+            {
+                escaped.push_back(ch);
+            }
+        }
+        return escaped;
+    }
+
+    void PrintJson(const Options& options, const std::vector<Result>& results)
+    {
+        wchar_t path[MAX_PATH]{};
+        GetModuleFileNameW(nullptr, &path[0], MAX_PATH);
+        std::wstring_view executable{ &path[0] };
+        executable = executable.substr(executable.find_last_of(L'\\') + 1);
+
+        SYSTEM_INFO info{};
+        GetSystemInfo(&info);
+
+#ifdef NDEBUG
+        static constexpr auto buildType = L"release";
+#else
+        static constexpr auto buildType = L"debug";
+#endif
+
+        std::wstring json;
+        fmt::format_to(std::back_inserter(json),
+                       L"{{\n"
+                       L"  \"schema_version\": 1,\n"
+                       L"  \"context\": {{ \"executable\": \"{}\", \"build_type\": \"{}\", \"num_cpus\": {}, \"repetitions\": {}, \"min_time_ms\": {} }},\n"
+                       L"  \"benchmarks\": [",
+                       EscapeJson(executable),
+                       buildType,
+                       info.dwNumberOfProcessors,
+                       options.repetitions,
+                       options.minTime.count());
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& result = til::at(results, i);
+            fmt::format_to(std::back_inserter(json),
+                           L"{}\n    {{ \"name\": \"{}\", \"iterations\": {}, \"real_time_ns\": {:.1f}, \"cpu_time_ns\": {:.1f}, \"items_per_second\": {:.1f} }}",
+                           i ? L"," : L"",
+                           EscapeJson(til::u8u16(result.name)),
+                           result.iterations,
+                           result.realTimeNs,
+                           result.cpuTimeNs,
+                           result.itemsPerSecond);
+        }
+
+        json.append(L"\n  ]\n}\n");
+        fputws(json.c_str(), stdout);
+    }
+
+    void PrintTable(const std::vector<Result>& results)
+    {
+        fputws(fmt::format(L"{:<40} {:>14} {:>14} {:>12} {:>14}\n", L"benchmark", L"time ns", L"cpu ns", L"iterations", L"items/s").c_str(), stdout);
+        for (const auto& result : results)
+        {
+            const auto itemsPerSecond = result.itemsPerSecond > 0 ? fmt::format(L"{:.3g}", result.itemsPerSecond) : std::wstring{ L"-" };
+            fputws(fmt::format(L"{:<40} {:>14.1f} {:>14.1f} {:>12} {:>14}\n", til::u8u16(result.name), result.realTimeNs, result.cpuTimeNs, result.iterations, itemsPerSecond).c_str(), stdout);
+        }
+    }
+}
+
+int __cdecl wmain(int argc, WCHAR* argv[])
+try
+{
+    Options options;
+    for (auto i = 1; i < argc; i++)
+    {
+        const std::wstring_view arg{ til::at(argv, i) };
+        if (arg == L"--json")
+        {
+            options.json = true;
+        }
+        else if (arg == L"--filter" && i + 1 < argc)
+        {
+            options.filter = til::at(argv, ++i);
+        }
+        else if (arg == L"--repetitions" && i + 1 < argc)
+        {
+            options.repetitions = std::max(1, _wtoi(til::at(argv, ++i)));
+        }
+        else if (arg == L"--min-time" && i + 1 < argc)
+        {
+            options.minTime = std::chrono::milliseconds{ std::max(1, _wtoi(til::at(argv, ++i))) };
+        }
+        else
+        {
+            fwprintf(stderr, L"usage: tilbench [--json] [--filter SUBSTRING] [--repetitions N] [--min-time MS]\n");
+            return 1;
+        }
+    }
+
+    // Both groups of benchmarks get their own generator with the same seed, so that
+    // the inputs of one don't change when benchmarks are added to the other.
+    static constexpr uint32_t seed = 1;
+    Runner runner{ options };
+    std::mt19937 tilRng{ seed };
+    BenchmarkTil(runner, tilRng);
+    std::mt19937 bufferRng{ seed };
+    BenchmarkBuffer(runner, bufferRng);
+
+    if (options.json)
+    {
+        PrintJson(options, runner.Results());
+    }
+    else
+    {
+        PrintTable(runner.Results());
+    }
+    return 0;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return 1;
+}
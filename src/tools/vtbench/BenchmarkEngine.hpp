@@ -0,0 +1,196 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// A render engine that doesn't draw anything. It accepts all invalidations
+// like a real engine would and counts what the Renderer hands it per frame,
+// so that the work done by Renderer::_PaintFrameForEngine can be measured
+// without a window or a GPU.
+
+#pragma once
+
+#include "../../renderer/inc/RenderEngineBase.hpp"
+
+class BenchmarkEngine final : public Microsoft::Console::Render::RenderEngineBase
+{
+public:
+    struct Statistics
+    {
+        size_t frames = 0;
+        size_t lines = 0;
+        size_t clusters = 0;
+        size_t dirtyCells = 0;
+    };
+
+    explicit BenchmarkEngine(const til::size size) noexcept :
+        _size{ size }
+    {
+    }
+
+    const Statistics& GetStatistics() const noexcept
+    {
+        return _statistics;
+    }
+
+    [[nodiscard]] HRESULT StartPaint() noexcept override
+    {
+        RETURN_HR_IF(S_FALSE, !_dirty);
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT EndPaint() noexcept override
+    {
+        _statistics.frames++;
+        _statistics.dirtyCells += gsl::narrow_cast<size_t>(_dirty.width()) * gsl::narrow_cast<size_t>(_dirty.height());
+        _dirty = {};
+        return S_OK;
+    }
+
+    // The Renderer is driven by the benchmark directly, without a RenderThread.
+    void WaitUntilCanRender() noexcept override
+    {
+    }
+
+    [[nodiscard]] HRESULT Present() noexcept override
+    {
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept override
+    {
+        RETURN_HR_IF_NULL(E_INVALIDARG, pForcePaint);
+        *pForcePaint = false;
+        return S_FALSE;
+    }
+
+    [[nodiscard]] HRESULT ScrollFrame() noexcept override
+    {
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT Invalidate(const til::rect* const psrRegion) noexcept override
+    {
+        RETURN_HR_IF_NULL(E_INVALIDARG, psrRegion);
+        _dirty |= *psrRegion & til::rect{ _size };
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT InvalidateCursor(const til::rect* const psrRegion) noexcept override
+    {
+        return Invalidate(psrRegion);
+    }
+
+    [[nodiscard]] HRESULT InvalidateSystem(const til::rect* const /*prcDirtyClient*/) noexcept override
+    {
+        return InvalidateAll();
+    }
+
+    [[nodiscard]] HRESULT InvalidateSelection(const std::vector<til::rect>& rectangles) noexcept override
+    {
+        for (const auto& rect : rectangles)
+        {
+            RETURN_IF_FAILED(Invalidate(&rect));
+        }
+        return S_OK;
+    }
+
+    // Like AtlasEngine, a scroll simply repaints everything.
+    [[nodiscard]] HRESULT InvalidateScroll(const til::point* const pcoordDelta) noexcept override
+    {
+        RETURN_HR_IF_NULL(E_INVALIDARG, pcoordDelta);
+        if (*pcoordDelta != til::point{})
+        {
+            return InvalidateAll();
+        }
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT InvalidateAll() noexcept override
+    {
+        _dirty = til::rect{ _size };
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT PaintBackground() noexcept override
+    {
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT PaintBufferLine(const gsl::span<const Microsoft::Console::Render::Cluster> clusters, const til::point /*coord*/, const bool /*fTrimLeft*/, const bool /*lineWrapped*/) noexcept override
+    {
+        _statistics.lines++;
+        _statistics.clusters += clusters.size();
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT PaintBufferGridLines(const Microsoft::Console::Render::GridLineSet /*lines*/, const COLORREF /*color*/, const size_t /*cchLine*/, const til::point /*coordTarget*/) noexcept override
+    {
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT PaintSelection(const til::rect& /*rect*/) noexcept override
+    {
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT PaintCursor(const Microsoft::Console::Render::CursorOptions& /*options*/) noexcept override
+    {
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT UpdateDrawingBrushes(const TextAttribute& /*textAttributes*/, const Microsoft::Console::Render::RenderSettings& /*renderSettings*/, const gsl::not_null<Microsoft::Console::Render::IRenderData*> /*pData*/, const bool /*usingSoftFont*/, const bool /*isSettingDefaultBrushes*/) noexcept override
+    {
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& /*FontInfoDesired*/, _Out_ FontInfo& /*FontInfo*/) noexcept override
+    {
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT UpdateDpi(const int /*iDpi*/) noexcept override
+    {
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT UpdateViewport(const til::inclusive_rect& srNewViewport) noexcept override
+    {
+        _size = { srNewViewport.Right - srNewViewport.Left + 1, srNewViewport.Bottom - srNewViewport.Top + 1 };
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT GetProposedFont(const FontInfoDesired& /*FontInfoDesired*/, _Out_ FontInfo& /*FontInfo*/, const int /*iDpi*/) noexcept override
+    {
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT GetDirtyArea(gsl::span<const til::rect>& area) noexcept override
+    {
+        area = { &_dirty, 1 };
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT GetFontSize(_Out_ til::size* const pFontSize) noexcept override
+    {
+        RETURN_HR_IF_NULL(E_INVALIDARG, pFontSize);
+        *pFontSize = { 1, 1 };
+        return S_OK;
+    }
+
+    [[nodiscard]] HRESULT IsGlyphWideByFont(const std::wstring_view /*glyph*/, _Out_ bool* const pResult) noexcept override
+    {
+        RETURN_HR_IF_NULL(E_INVALIDARG, pResult);
+        *pResult = true;
+        return S_OK;
+    }
+
+protected:
+    [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring_view /*newTitle*/) noexcept override
+    {
+        return S_OK;
+    }
+
+private:
+    til::size _size;
+    til::rect _dirty;
+    Statistics _statistics;
+};
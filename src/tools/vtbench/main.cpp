@@ -0,0 +1,836 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// TEST TOOL vtbench
+// Measures the throughput of the VT output pipeline: the StateMachine with an
+// OutputStateMachineEngine, dispatching to an AdaptDispatch, which writes into
+// a TextBuffer. There's no renderer and no window, so the numbers only cover
+// the parsing and the buffer, which is what matters for regressions in them.
+//
+// Usage: vtbench [--utf16] [--iterations N] [recording...]
+//        vtbench --render [--iterations N] [recording...]
+//        vtbench --copy [--iterations N]
+// Without any recordings, a set of generated corpora is used. Recordings are
+// either raw UTF-8 terminal output, as captured by `script` or a similar tool,
+// or session recordings of the Terminal, of which only the output is used.
+// With --render the buffer is hooked up to a Renderer with a BenchmarkEngine,
+// and a frame is built after every chunk of output, like the render thread
+// would under load. It reports the time per frame, together with the lines,
+// clusters and dirty cells the Renderer produced per frame. An additional
+// "selection" workload drags a selection across the full viewport.
+// With --copy it measures copying 10k colored lines as HTML and RTF instead,
+// once through the per-character colors of GetText and once through the runs
+// of GetTextAndColorRuns.
+
+#include "precomp.h"
+
+#include <chrono>
+#include <random>
+
+#include "adaptDispatch.hpp"
+#include "../../terminal/parser/OutputStateMachineEngine.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+#include "../../inc/SessionRecording.hpp"
+#include "BenchmarkEngine.hpp"
+
+using namespace Microsoft::Console::VirtualTerminal;
+using Microsoft::Console::Render::RenderSettings;
+using Microsoft::Console::Types::Viewport;
+
+namespace
+{
+    // ConptyConnection reads the output of the client in chunks of this size.
+    constexpr size_t ChunkSize = 4096;
+    constexpr til::size ViewportSize{ 120, 30 };
+
+    // An ITerminalApi on top of a TextBuffer without any scrollback. It doesn't
+    // aim to be an exact terminal, but it does the same amount of work as one,
+    // which is all that's needed to compare the performance of two builds.
+    // It's also the IRenderData of its renderer, which only gets to see
+    // any changes if the terminal was created with render set to true.
+    class HeadlessTerminal final : public ITerminalApi, public Microsoft::Console::Render::IRenderData
+    {
+    public:
+        explicit HeadlessTerminal(const bool render = false) :
+            _renderer{ this },
+            _terminalInput{ nullptr },
+            _fontInfo{ L"Consolas", 0, FW_NORMAL, { 1, 1 }, CP_UTF8 }
+        {
+            // Unless we're rendering, the buffer isn't active, so that it doesn't try to invalidate anything in the renderer.
+            _buffer = std::make_unique<TextBuffer>(ViewportSize, TextAttribute{}, 0, render, _renderer);
+            auto dispatch = std::make_unique<AdaptDispatch>(*this, _renderer, _renderSettings, _terminalInput);
+            auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+            _stateMachine = std::make_unique<StateMachine>(std::move(engine));
+        }
+
+        Microsoft::Console::Render::Renderer& GetRenderer() noexcept
+        {
+            return _renderer;
+        }
+
+        void SetSelection(const til::point start, const til::point end)
+        {
+            _selection = { start, end };
+            _renderer.TriggerSelection();
+        }
+
+        void PrintString(const std::wstring_view string) override
+        {
+            auto& cursor = _buffer->GetCursor();
+            OutputCellIterator it{ string, _buffer->GetCurrentAttributes() };
+            while (it)
+            {
+                auto position = cursor.GetPosition();
+                if (cursor.IsDelayedEOLWrap())
+                {
+                    cursor.ResetDelayEOLWrap();
+                    position.x = 0;
+                    _MoveDown(position);
+                    position = cursor.GetPosition();
+                }
+
+                const auto end = _buffer->WriteLine(it, position, true);
+                position.x += end.GetCellDistance(it);
+                it = end;
+
+                if (it)
+                {
+                    // Whatever didn't fit goes onto the next line, including wide glyphs in the last column.
+                    position.x = 0;
+                    _MoveDown(position);
+                }
+                else if (position.x < ViewportSize.width)
+                {
+                    cursor.SetPosition(position);
+                }
+                else
+                {
+                    position.x = ViewportSize.width - 1;
+                    cursor.SetPosition(position);
+                    cursor.DelayEOLWrap(position);
+                }
+            }
+        }
+
+        void ReturnResponse(const std::wstring_view /*response*/) override
+        {
+        }
+
+        StateMachine& GetStateMachine() override
+        {
+            return *_stateMachine;
+        }
+
+        TextBuffer& GetTextBuffer() override
+        {
+            return *_buffer;
+        }
+
+        til::rect GetViewport() const override
+        {
+            return { til::point{}, ViewportSize };
+        }
+
+        void SetViewportPosition(const til::point /*position*/) override
+        {
+        }
+
+        bool IsVtInputEnabled() const override
+        {
+            return false;
+        }
+
+        void SetTextAttributes(const TextAttribute& attrs) override
+        {
+            _buffer->SetCurrentAttributes(attrs);
+        }
+
+        void SetAutoWrapMode(const bool /*wrapAtEOL*/) override
+        {
+        }
+
+        void SetScrollingRegion(const til::inclusive_rect& /*scrollMargins*/) override
+        {
+        }
+
+        void WarningBell() override
+        {
+        }
+
+        bool GetLineFeedMode() const override
+        {
+            return false;
+        }
+
+        void LineFeed(const bool withReturn) override
+        {
+            auto position = _buffer->GetCursor().GetPosition();
+            if (withReturn)
+            {
+                position.x = 0;
+            }
+            _MoveDown(position);
+        }
+
+        void SetWindowTitle(const std::wstring_view /*title*/) override
+        {
+        }
+
+        void UseAlternateScreenBuffer() override
+        {
+        }
+
+        void UseMainScreenBuffer() override
+        {
+        }
+
+        CursorType GetUserDefaultCursorStyle() const override
+        {
+            return CursorType::Legacy;
+        }
+
+        void ShowWindow(bool /*showOrHide*/) override
+        {
+        }
+
+        void SetConsoleOutputCP(const unsigned int /*codepage*/) override
+        {
+        }
+
+        unsigned int GetConsoleOutputCP() const override
+        {
+            return CP_UTF8;
+        }
+
+        void EnableXtermBracketedPasteMode(const bool /*enabled*/) override
+        {
+        }
+
+        void CopyToClipboard(const std::wstring_view /*content*/) override
+        {
+        }
+
+        void SetTaskbarProgress(const DispatchTypes::TaskbarState /*state*/, const size_t /*progress*/) override
+        {
+        }
+
+        void SetWorkingDirectory(const std::wstring_view /*uri*/) override
+        {
+        }
+
+        void PlayMidiNote(const int /*noteNumber*/, const int /*velocity*/, const std::chrono::microseconds /*duration*/) override
+        {
+        }
+
+        bool ResizeWindow(const til::CoordType /*width*/, const til::CoordType /*height*/) override
+        {
+            return false;
+        }
+
+        bool IsConsolePty() const override
+        {
+            return false;
+        }
+
+        void NotifyAccessibilityChange(const til::rect& /*changedRect*/) override
+        {
+        }
+
+        void AddMark(const DispatchTypes::ScrollMark& /*mark*/) override
+        {
+        }
+
+#pragma region IRenderData
+        Viewport GetViewport() noexcept override
+        {
+            return Viewport::FromDimensions({}, ViewportSize);
+        }
+
+        til::point GetTextBufferEndPosition() const noexcept override
+        {
+            return { ViewportSize.width - 1, ViewportSize.height - 1 };
+        }
+
+        const TextBuffer& GetTextBuffer() const noexcept override
+        {
+            return *_buffer;
+        }
+
+        const FontInfo& GetFontInfo() const noexcept override
+        {
+            return _fontInfo;
+        }
+
+        std::vector<Viewport> GetSelectionRects() noexcept override
+        try
+        {
+            std::vector<Viewport> result;
+            if (_selection)
+            {
+                for (const auto& rect : _buffer->GetTextRects(_selection->first, _selection->second, false, false))
+                {
+                    result.emplace_back(Viewport::FromInclusive(rect));
+                }
+            }
+            return result;
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION();
+            return {};
+        }
+
+        // The benchmark is single-threaded, so there's nothing to lock.
+        void LockConsole() noexcept override
+        {
+        }
+
+        void UnlockConsole() noexcept override
+        {
+        }
+
+        void LockConsoleForReading() noexcept override
+        {
+        }
+
+        void UnlockConsoleForReading() noexcept override
+        {
+        }
+
+        til::point GetCursorPosition() const noexcept override
+        {
+            return _buffer->GetCursor().GetPosition();
+        }
+
+        bool IsCursorVisible() const noexcept override
+        {
+            return _buffer->GetCursor().IsVisible();
+        }
+
+        bool IsCursorOn() const noexcept override
+        {
+            return _buffer->GetCursor().IsOn();
+        }
+
+        ULONG GetCursorHeight() const noexcept override
+        {
+            return _buffer->GetCursor().GetSize();
+        }
+
+        CursorType GetCursorStyle() const noexcept override
+        {
+            return _buffer->GetCursor().GetType();
+        }
+
+        ULONG GetCursorPixelWidth() const noexcept override
+        {
+            return 1;
+        }
+
+        bool IsCursorDoubleWidth() const override
+        {
+            return false;
+        }
+
+        const std::vector<Microsoft::Console::Render::RenderOverlay> GetOverlays() const noexcept override
+        {
+            return {};
+        }
+
+        const bool IsGridLineDrawingAllowed() noexcept override
+        {
+            return true;
+        }
+
+        const std::wstring_view GetConsoleTitle() const noexcept override
+        {
+            return {};
+        }
+
+        const std::wstring GetHyperlinkUri(uint16_t /*id*/) const noexcept override
+        {
+            return {};
+        }
+
+        const std::wstring GetHyperlinkCustomId(uint16_t /*id*/) const noexcept override
+        {
+            return {};
+        }
+
+        const std::vector<size_t> GetPatternId(const til::point /*location*/) const noexcept override
+        {
+            return {};
+        }
+#pragma endregion
+
+    private:
+        void _MoveDown(til::point position)
+        {
+            _buffer->GetRowByOffset(position.y).SetWrapForced(false);
+            position.y++;
+            if (position.y >= ViewportSize.height)
+            {
+                _buffer->IncrementCircularBuffer();
+                // The viewport stays where it is, while its contents move up.
+                _buffer->TriggerScroll({ 0, -1 });
+                position.y = ViewportSize.height - 1;
+            }
+            _buffer->GetCursor().SetPosition(position);
+        }
+
+        DummyRenderer _renderer;
+        RenderSettings _renderSettings;
+        TerminalInput _terminalInput;
+        FontInfo _fontInfo;
+        std::unique_ptr<TextBuffer> _buffer;
+        std::unique_ptr<StateMachine> _stateMachine;
+        std::optional<std::pair<til::point, til::point>> _selection;
+    };
+
+    struct Corpus
+    {
+        std::wstring name;
+        std::string text;
+    };
+
+    // The generated corpora are about 4 MB each, and always the same, even across builds.
+    constexpr size_t GeneratedSize = 4 * 1024 * 1024;
+
+    std::string GenerateAscii(std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> chars{ 0x20, 0x7e };
+        std::string text;
+        while (text.size() < GeneratedSize)
+        {
+            for (auto i = 0; i < 100; i++)
+            {
+                text.push_back(static_cast<char>(chars(rng)));
+            }
+            text.append("\r\n");
+        }
+        return text;
+    }
+
+    // Like syntax highlighted source code or `ls --color`: every word has its own 256 or RGB color.
+    std::string GenerateSgr(std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> color{ 0, 255 };
+        std::uniform_int_distribution<int> letter{ 'a', 'z' };
+        std::string text;
+        while (text.size() < GeneratedSize)
+        {
+            for (auto word = 0; word < 12; word++)
+            {
+                if (word % 2)
+                {
+                    text.append(fmt::format("\x1b[38;5;{}m", color(rng)));
+                }
+                else
+                {
+                    text.append(fmt::format("\x1b[1;38;2;{};{};{}m", color(rng), color(rng), color(rng)));
+                }
+                for (auto i = 0; i < 6; i++)
+                {
+                    text.push_back(static_cast<char>(letter(rng)));
+                }
+                text.append("\x1b[m ");
+            }
+            text.append("\r\n");
+        }
+        return text;
+    }
+
+    std::string GenerateCodepoints(std::mt19937& rng, const char32_t first, const char32_t last, const int perLine)
+    {
+        std::uniform_int_distribution<uint32_t> codepoint{ first, last };
+        std::wstring line;
+        std::string text;
+        while (text.size() < GeneratedSize)
+        {
+            line.clear();
+            for (auto i = 0; i < perLine; i++)
+            {
+                const auto cp = codepoint(rng);
+                if (cp >= 0x10000)
+                {
+                    line.push_back(static_cast<wchar_t>(0xd800 + ((cp - 0x10000) >> 10)));
+                    line.push_back(static_cast<wchar_t>(0xdc00 + ((cp - 0x10000) & 0x3ff)));
+                }
+                else
+                {
+                    line.push_back(static_cast<wchar_t>(cp));
+                }
+            }
+            line.append(L"\r\n");
+            text.append(til::u16u8(line));
+        }
+        return text;
+    }
+
+    // Like a full screen editor that redraws: position the cursor at the start
+    // of every row, write it with a few colors, and erase the rest of it.
+    std::string GenerateRedraw(std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> length{ 0, ViewportSize.width - 10 };
+        std::uniform_int_distribution<int> letter{ 'a', 'z' };
+        std::string text;
+        while (text.size() < GeneratedSize)
+        {
+            for (auto row = 1; row <= ViewportSize.height; row++)
+            {
+                text.append(fmt::format("\x1b[{};1H\x1b[33m{:4} \x1b[m", row, row));
+                const auto count = length(rng);
+                for (auto i = 0; i < count; i++)
+                {
+                    text.push_back(static_cast<char>(letter(rng)));
+                }
+                text.append("\x1b[K");
+            }
+            text.append(fmt::format("\x1b[{};{}H", ViewportSize.height, 1));
+        }
+        return text;
+    }
+
+    // Like cmatrix: lots of single characters at random positions, in one of two colors.
+    std::string GenerateMatrix(std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> row{ 1, ViewportSize.height };
+        std::uniform_int_distribution<int> column{ 1, ViewportSize.width };
+        std::uniform_int_distribution<int> letter{ '!', '~' };
+        std::bernoulli_distribution bold{ 0.2 };
+        std::string text;
+        while (text.size() < GeneratedSize)
+        {
+            text.append(fmt::format("\x1b[{};{}H\x1b[{}32m", row(rng), column(rng), bold(rng) ? "1;" : ""));
+            text.push_back(static_cast<char>(letter(rng)));
+        }
+        return text;
+    }
+
+    std::vector<Corpus> GenerateCorpora()
+    {
+        std::mt19937 rng{ 1234 };
+        std::vector<Corpus> corpora;
+        corpora.push_back({ L"ascii", GenerateAscii(rng) });
+        corpora.push_back({ L"sgr", GenerateSgr(rng) });
+        corpora.push_back({ L"cjk", GenerateCodepoints(rng, 0x4e00, 0x9fff, 50) });
+        corpora.push_back({ L"emoji", GenerateCodepoints(rng, 0x1f600, 0x1f64f, 50) });
+        corpora.push_back({ L"redraw", GenerateRedraw(rng) });
+        corpora.push_back({ L"matrix", GenerateMatrix(rng) });
+        return corpora;
+    }
+
+    Corpus ReadRecording(const std::filesystem::path& path)
+    {
+        std::ifstream file{ path, std::ios::binary };
+        THROW_HR_IF(E_INVALIDARG, !file);
+        std::string text{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+
+        namespace SessionRecording = Microsoft::Console::SessionRecording;
+        if (text.size() >= sizeof(SessionRecording::Magic) && memcmp(text.data(), &SessionRecording::Magic, sizeof(SessionRecording::Magic)) == 0)
+        {
+            text.clear();
+            SessionRecording::Reader reader{ path };
+            while (const auto record = reader.Next())
+            {
+                if (record->type == SessionRecording::RecordType::Output)
+                {
+                    text.append(til::u16u8(record->text));
+                }
+            }
+        }
+
+        return { path.filename().wstring(), std::move(text) };
+    }
+
+    // Returns the duration of one call to func in seconds, the best out of the given number of iterations.
+    template<typename Func>
+    double MeasureBest(const int iterations, Func&& func)
+    {
+        auto best = std::numeric_limits<double>::max();
+        for (auto i = 0; i < iterations; i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            func();
+            const auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(end - start).count());
+        }
+        return best;
+    }
+
+    // Fills a buffer of CopyRows rows with lines like those of GenerateSgr:
+    // 12 words per line, each in its own color, and selects all of it.
+    constexpr til::CoordType CopyRows = 10000;
+
+    int MeasureCopy(const int iterations)
+    {
+        std::mt19937 rng{ 1234 };
+        std::uniform_int_distribution<int> color{ 0, 255 };
+        std::uniform_int_distribution<int> letter{ 'a', 'z' };
+
+        DummyRenderer renderer;
+        RenderSettings renderSettings;
+        TextBuffer buffer{ { ViewportSize.width, CopyRows }, TextAttribute{}, 0, false, renderer };
+
+        std::wstring word(7, L' ');
+        for (til::CoordType row = 0; row < CopyRows; row++)
+        {
+            til::CoordType column = 0;
+            for (auto i = 0; i < 12; i++)
+            {
+                for (auto j = 0; j < 6; j++)
+                {
+                    til::at(word, j) = static_cast<wchar_t>(letter(rng));
+                }
+
+                TextAttribute attr;
+                attr.SetIndexedForeground256(gsl::narrow_cast<BYTE>(color(rng)));
+                OutputCellIterator it{ word, attr };
+                column += buffer.WriteLine(it, { column, row }, false).GetCellDistance(it);
+            }
+        }
+
+        const auto selectionRects = buffer.GetTextRects({ 0, 0 }, { ViewportSize.width - 1, CopyRows - 1 }, false, false);
+        const auto GetAttributeColors = [&](const auto& attr) {
+            return renderSettings.GetAttributeColors(attr);
+        };
+
+        size_t bytes = 0;
+        const auto cells = MeasureBest(iterations, [&]() {
+            const auto data = buffer.GetText(true, true, selectionRects, GetAttributeColors);
+            bytes = TextBuffer::GenHTML(data, 12, L"Cascadia Mono", 0).size();
+            bytes += TextBuffer::GenRTF(data, 12, L"Cascadia Mono", 0).size();
+        });
+        const auto runs = MeasureBest(iterations, [&]() {
+            const auto data = buffer.GetTextAndColorRuns(true, true, selectionRects, GetAttributeColors);
+            bytes = TextBuffer::GenHTML(data, 12, L"Cascadia Mono", 0).size();
+            bytes += TextBuffer::GenRTF(data, 12, L"Cascadia Mono", 0).size();
+        });
+
+        const auto megabytes = bytes / (1024.0 * 1024.0);
+        fputws(fmt::format(L"{:<20} {:>10} {:>10}\n", L"copy (HTML + RTF)", L"MB", L"ms").c_str(), stdout);
+        fputws(fmt::format(L"{:<20} {:>10.2f} {:>10.1f}\n", L"per character", megabytes, cells * 1e3).c_str(), stdout);
+        fputws(fmt::format(L"{:<20} {:>10.2f} {:>10.1f}\n", L"runs", megabytes, runs * 1e3).c_str(), stdout);
+        return 0;
+    }
+
+    // Returns the duration of one pass over the corpus in seconds, the best out of the given number of iterations.
+    double Measure(const Corpus& corpus, const bool utf16, const int iterations)
+    {
+        const auto wide = utf16 ? til::u8u16(corpus.text) : std::wstring{};
+        auto best = std::numeric_limits<double>::max();
+
+        for (auto i = 0; i < iterations; i++)
+        {
+            HeadlessTerminal terminal;
+            auto& stateMachine = terminal.GetStateMachine();
+
+            const auto start = std::chrono::steady_clock::now();
+            if (utf16)
+            {
+                for (size_t offset = 0; offset < wide.size(); offset += ChunkSize)
+                {
+                    stateMachine.ProcessString(std::wstring_view{ wide }.substr(offset, ChunkSize));
+                }
+            }
+            else
+            {
+                for (size_t offset = 0; offset < corpus.text.size(); offset += ChunkSize)
+                {
+                    stateMachine.ProcessString(std::string_view{ corpus.text }.substr(offset, ChunkSize));
+                }
+            }
+            const auto end = std::chrono::steady_clock::now();
+
+            best = std::min(best, std::chrono::duration<double>(end - start).count());
+        }
+
+        return best;
+    }
+}
+
+    struct RenderResult
+    {
+        std::vector<double> frameTimes;
+        BenchmarkEngine::Statistics statistics;
+    };
+
+    // Runs a workload against a HeadlessTerminal with a BenchmarkEngine attached. The workload gets
+    // the terminal and a function it should call whenever a frame would be due, which builds it.
+    template<typename Func>
+    RenderResult MeasureRenderOnce(Func&& workload)
+    {
+        HeadlessTerminal terminal{ true };
+        BenchmarkEngine engine{ ViewportSize };
+        auto& renderer = terminal.GetRenderer();
+        renderer.AddRenderEngine(&engine);
+
+        RenderResult result;
+        const auto paintFrame = [&]() {
+            const auto start = std::chrono::steady_clock::now();
+            LOG_IF_FAILED(renderer.PaintFrame());
+            const auto end = std::chrono::steady_clock::now();
+            result.frameTimes.emplace_back(std::chrono::duration<double>(end - start).count());
+        };
+
+        workload(terminal, paintFrame);
+
+        result.statistics = engine.GetStatistics();
+        return result;
+    }
+
+    // Returns the run whose frames took the least time in total, out of the given number of iterations.
+    template<typename Func>
+    RenderResult MeasureRender(const int iterations, Func&& workload)
+    {
+        RenderResult best;
+        auto bestTotal = std::numeric_limits<double>::max();
+        for (auto i = 0; i < iterations; i++)
+        {
+            auto result = MeasureRenderOnce(workload);
+            const auto total = std::accumulate(result.frameTimes.begin(), result.frameTimes.end(), 0.0);
+            if (total < bestTotal)
+            {
+                bestTotal = total;
+                best = std::move(result);
+            }
+        }
+        return best;
+    }
+
+    void PrintRenderResult(const std::wstring_view name, RenderResult& result)
+    {
+        const auto& stats = result.statistics;
+        if (result.frameTimes.empty() || stats.frames == 0)
+        {
+            fputws(fmt::format(L"{:<20} {:>8}\n", name, 0).c_str(), stdout);
+            return;
+        }
+
+        // Frames that had nothing to paint are included in the timings, but not in the counts.
+        std::sort(result.frameTimes.begin(), result.frameTimes.end());
+        const auto percentile = [&](const size_t p) {
+            return result.frameTimes[(result.frameTimes.size() - 1) * p / 100] * 1e6;
+        };
+        const auto frames = static_cast<double>(stats.frames);
+        fputws(fmt::format(L"{:<20} {:>8} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>12.0f}\n",
+                           name,
+                           stats.frames,
+                           percentile(50),
+                           percentile(99),
+                           stats.lines / frames,
+                           stats.clusters / frames,
+                           stats.dirtyCells / frames)
+                   .c_str(),
+               stdout);
+    }
+
+    int MeasureRendering(const std::vector<Corpus>& corpora, const int iterations)
+    {
+        fputws(fmt::format(L"{:<20} {:>8} {:>10} {:>10} {:>10} {:>10} {:>12}\n", L"workload", L"frames", L"p50 us", L"p99 us", L"lines", L"clusters", L"dirty cells").c_str(), stdout);
+
+        for (const auto& corpus : corpora)
+        {
+            auto result = MeasureRender(iterations, [&](HeadlessTerminal& terminal, auto&& paintFrame) {
+                auto& stateMachine = terminal.GetStateMachine();
+                for (size_t offset = 0; offset < corpus.text.size(); offset += ChunkSize)
+                {
+                    stateMachine.ProcessString(std::string_view{ corpus.text }.substr(offset, ChunkSize));
+                    paintFrame();
+                }
+            });
+            PrintRenderResult(corpus.name, result);
+        }
+
+        // Like a mouse drag from the top left to the bottom right corner, over a screen full of colored
+        // text, with one frame per cell the mouse moves over. Most frames only need to repaint one row.
+        std::mt19937 rng{ 1234 };
+        const auto screen = GenerateSgr(rng);
+        auto result = MeasureRender(iterations, [&](HeadlessTerminal& terminal, auto&& paintFrame) {
+            terminal.GetStateMachine().ProcessString(std::string_view{ screen }.substr(0, 64 * 1024));
+            paintFrame();
+
+            for (til::CoordType y = 0; y < ViewportSize.height; y++)
+            {
+                for (til::CoordType x = 0; x < ViewportSize.width; x++)
+                {
+                    terminal.SetSelection({}, { x, y });
+                    paintFrame();
+                }
+            }
+        });
+        PrintRenderResult(L"selection", result);
+
+        return 0;
+    }
+}
+
+int __cdecl wmain(int argc, WCHAR* argv[])
+try
+{
+    auto utf16 = false;
+    auto copy = false;
+    auto render = false;
+    auto iterations = 5;
+    std::vector<Corpus> corpora;
+
+    for (auto i = 1; i < argc; i++)
+    {
+        const std::wstring_view arg{ til::at(argv, i) };
+        if (arg == L"--utf16")
+        {
+            utf16 = true;
+        }
+        else if (arg == L"--copy")
+        {
+            copy = true;
+        }
+        else if (arg == L"--render")
+        {
+            render = true;
+        }
+        else if (arg == L"--iterations" && i + 1 < argc)
+        {
+            iterations = std::max(1, _wtoi(til::at(argv, ++i)));
+        }
+        else
+        {
+            corpora.push_back(ReadRecording(arg));
+        }
+    }
+
+    if (copy)
+    {
+        return MeasureCopy(iterations);
+    }
+
+    if (corpora.empty())
+    {
+        corpora = GenerateCorpora();
+    }
+
+    if (render)
+    {
+        return MeasureRendering(corpora, iterations);
+    }
+
+    fputws(fmt::format(L"{:<20} {:>10} {:>10} {:>14}\n", L"corpus", L"MB", L"MB/s", L"ns/sequence").c_str(), stdout);
+    for (const auto& corpus : corpora)
+    {
+        // Every sequence starts with an ESC (or a C1 control, which recordings rarely contain).
+        const auto sequences = std::count(corpus.text.begin(), corpus.text.end(), '\x1b');
+        const auto megabytes = corpus.text.size() / (1024.0 * 1024.0);
+        const auto seconds = Measure(corpus, utf16, iterations);
+
+        const auto nsPerSequence = sequences ? fmt::format(L"{:.1f}", seconds * 1e9 / sequences) : std::wstring{ L"-" };
+        fputws(fmt::format(L"{:<20} {:>10.2f} {:>10.1f} {:>14}\n", corpus.name, megabytes, megabytes / seconds, nsPerSequence).c_str(), stdout);
+    }
+
+    return 0;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    fputws(L"failed to run the benchmark\n", stderr);
+    return 1;
+}
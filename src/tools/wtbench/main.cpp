@@ -0,0 +1,503 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// TEST TOOL wtbench
+// Measures the whole output path of the Terminal: a generator process writes
+// into a ConPTY, a ConptyConnection reads its output and a ControlCore writes
+// it into its buffer and renders it, like a tab does, just without the XAML.
+//
+// Usage: wtbench [--megabytes N] [payload...]
+// The payloads are "ascii", "sgr", "cjk", "emoji" and "tui" (full screen,
+// cursor-addressed frames). Without any, all of them are run. For every
+// payload, wtbench reports the throughput in MB of generator output per
+// second, the number of frames that were presented, how many of them were
+// late (they took longer to paint than a refresh at 60 Hz), and the CPU time
+// of every stage:
+// * gen:    the generator process.
+// * conpty: the console host, OpenConsole.exe or conhost.exe.
+// * conn:   the ConptyConnection thread that reads the output of the host.
+// * output: the ControlCore thread that writes the output into the buffer.
+// * render: the render thread.
+// * ui:     the UI thread, which applies the scroll bar and title updates.
+// A run starts with the first output and ends once the generator's final
+// title change reached the UI thread and the frame after it was presented.
+//
+// To analyze a run in WPA, record it with the ConsolePerfProfile of
+// src/ConsolePerf.wprp. The "Terminal" regions in src/ConsolePerf.regions.xml
+// then contain every workload, output batch and frame.
+//
+// wtbench runs itself as the generator, with --generate.
+
+#include "pch.h"
+
+#include <random>
+
+#include "../../cascadia/TerminalControl/EventArgs.h"
+#include "../../cascadia/TerminalControl/ControlCore.h"
+#include "../../cascadia/UnitTests_Control/MockControlSettings.h"
+
+using namespace winrt::Microsoft::Terminal;
+using namespace std::chrono_literals;
+
+TRACELOGGING_DECLARE_PROVIDER(g_hTerminalControlProvider);
+
+TRACELOGGING_DEFINE_PROVIDER(g_hBenchmarkProvider,
+                             "Microsoft.Windows.Terminal.Benchmark",
+                             // {4e429049-f71b-5a34-07e0-0b0ec41c8d4c}
+                             (0x4e429049, 0xf71b, 0x5a34, 0x07, 0xe0, 0x0b, 0x0e, 0xc4, 0x1c, 0x8d, 0x4c));
+
+namespace
+{
+    // The generator writes this as its title once all of its output is written.
+    constexpr std::wstring_view DoneTitle{ L"wtbench: done" };
+    constexpr std::array<std::wstring_view, 5> Payloads{ L"ascii", L"sgr", L"cjk", L"emoji", L"tui" };
+    // Every payload is a block of at least this size, which is written over and over.
+    constexpr size_t BlockSize = 1024 * 1024;
+    // The ControlCore is sized to 120x30 cells of Consolas at 96 DPI, 9x21 pixels each.
+    constexpr til::size ViewportSize{ 120, 30 };
+    constexpr til::size ViewportPixels{ ViewportSize.width * 9, ViewportSize.height * 21 };
+
+    std::chrono::nanoseconds FromFiletimes(const FILETIME& kernel, const FILETIME& user) noexcept
+    {
+        // FILETIMEs count in 100ns units.
+        const auto ticks = (uint64_t{ kernel.dwHighDateTime } << 32 | kernel.dwLowDateTime) + (uint64_t{ user.dwHighDateTime } << 32 | user.dwLowDateTime);
+        return std::chrono::nanoseconds{ ticks * 100 };
+    }
+
+    std::chrono::nanoseconds ThreadCpuTime(const HANDLE thread) noexcept
+    {
+        FILETIME creation, exit, kernel, user;
+        return GetThreadTimes(thread, &creation, &exit, &kernel, &user) ? FromFiletimes(kernel, user) : std::chrono::nanoseconds{};
+    }
+
+    std::chrono::nanoseconds ProcessCpuTime(const HANDLE process) noexcept
+    {
+        FILETIME creation, exit, kernel, user;
+        return GetProcessTimes(process, &creation, &exit, &kernel, &user) ? FromFiletimes(kernel, user) : std::chrono::nanoseconds{};
+    }
+
+    std::string GenerateAscii(std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> chars{ 0x20, 0x7e };
+        std::string text;
+        while (text.size() < BlockSize)
+        {
+            for (auto i = 0; i < 100; i++)
+            {
+                text.push_back(static_cast<char>(chars(rng)));
+            }
+            text.append("\r\n");
+        }
+        return text;
+    }
+
+    // Like syntax highlighted source code or `ls --color`: every word has its own 256 or RGB color.
+    std::string GenerateSgr(std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> color{ 0, 255 };
+        std::uniform_int_distribution<int> letter{ 'a', 'z' };
+        std::string text;
+        while (text.size() < BlockSize)
+        {
+            for (auto word = 0; word < 12; word++)
+            {
+                if (word % 2)
+                {
+                    text.append(fmt::format("\x1b[38;5;{}m", color(rng)));
+                }
+                else
+                {
+                    text.append(fmt::format("\x1b[1;38;2;{};{};{}m", color(rng), color(rng), color(rng)));
+                }
+                for (auto i = 0; i < 6; i++)
+                {
+                    text.push_back(static_cast<char>(letter(rng)));
+                }
+                text.append("\x1b[m ");
+            }
+            text.append("\r\n");
+        }
+        return text;
+    }
+
+    std::string GenerateCodepoints(std::mt19937& rng, const char32_t first, const char32_t last, const int perLine)
+    {
+        std::uniform_int_distribution<uint32_t> codepoint{ first, last };
+        std::wstring line;
+        std::string text;
+        while (text.size() < BlockSize)
+        {
+            line.clear();
+            for (auto i = 0; i < perLine; i++)
+            {
+                const auto cp = codepoint(rng);
+                if (cp >= 0x10000)
+                {
+                    line.push_back(static_cast<wchar_t>(0xd800 + ((cp - 0x10000) >> 10)));
+                    line.push_back(static_cast<wchar_t>(0xdc00 + ((cp - 0x10000) & 0x3ff)));
+                }
+                else
+                {
+                    line.push_back(static_cast<wchar_t>(cp));
+                }
+            }
+            line.append(L"\r\n");
+            text.append(til::u16u8(line));
+        }
+        return text;
+    }
+
+    // Like a TUI that redraws its whole screen on every update: every row is
+    // positioned explicitly, the frame has a colored header and status line,
+    // and the cursor is hidden while the frame is drawn.
+    std::string GenerateTui(std::mt19937& rng, const til::size size)
+    {
+        std::uniform_int_distribution<int> length{ 0, std::max(0, size.width - 10) };
+        std::uniform_int_distribution<int> letter{ 'a', 'z' };
+        std::string text;
+        for (auto frame = 0; text.size() < BlockSize; frame++)
+        {
+            text.append("\x1b[?25l\x1b[H\x1b[7m");
+            text.append(fmt::format("{:<{}}", fmt::format(" frame {}", frame), size.width));
+            text.append("\x1b[m");
+            for (auto row = 2; row < size.height; row++)
+            {
+                text.append(fmt::format("\x1b[{};1H\x1b[33m{:4} \x1b[m", row, row));
+                const auto count = length(rng);
+                for (auto i = 0; i < count; i++)
+                {
+                    text.push_back(static_cast<char>(letter(rng)));
+                }
+                text.append("\x1b[K");
+            }
+            text.append(fmt::format("\x1b[{};1H\x1b[44;97m{:<{}}\x1b[m\x1b[?25h", size.height, " NORMAL", size.width));
+        }
+        return text;
+    }
+
+    std::string GeneratePayload(const std::wstring_view payload, const til::size size)
+    {
+        std::mt19937 rng{ 1234 };
+        if (payload == L"ascii")
+        {
+            return GenerateAscii(rng);
+        }
+        if (payload == L"sgr")
+        {
+            return GenerateSgr(rng);
+        }
+        if (payload == L"cjk")
+        {
+            return GenerateCodepoints(rng, 0x4e00, 0x9fff, 50);
+        }
+        if (payload == L"emoji")
+        {
+            return GenerateCodepoints(rng, 0x1f600, 0x1f64f, 50);
+        }
+        if (payload == L"tui")
+        {
+            return GenerateTui(rng, size);
+        }
+        THROW_HR(E_INVALIDARG);
+    }
+
+    // Function Description:
+    // - The generator. It runs inside the ConPTY, writes the payload to it
+    //   until the given amount of output is reached, and sets DoneTitle once
+    //   it's done. The number of bytes it wrote and the CPU time it spent
+    //   writing them are stored in the report file for the harness.
+    int Generate(const std::wstring_view payload, const int megabytes, const wchar_t* reportPath)
+    {
+        const auto output = GetStdHandle(STD_OUTPUT_HANDLE);
+        SetConsoleOutputCP(CP_UTF8);
+        DWORD mode = 0;
+        if (GetConsoleMode(output, &mode))
+        {
+            SetConsoleMode(output, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING | DISABLE_NEWLINE_AUTO_RETURN);
+        }
+
+        auto size = ViewportSize;
+        CONSOLE_SCREEN_BUFFER_INFO info{};
+        if (GetConsoleScreenBufferInfo(output, &info))
+        {
+            size = { info.srWindow.Right - info.srWindow.Left + 1, info.srWindow.Bottom - info.srWindow.Top + 1 };
+        }
+
+        const auto block = GeneratePayload(payload, size);
+        const auto cpuStart = ProcessCpuTime(GetCurrentProcess());
+
+        uint64_t written = 0;
+        for (auto i = 0; i < megabytes; i++)
+        {
+            // Written in pieces, like most programs do, instead of all at once.
+            for (size_t offset = 0; offset < block.size(); offset += 64 * 1024)
+            {
+                const auto piece = std::string_view{ block }.substr(offset, 64 * 1024);
+                DWORD pieceWritten = 0;
+                THROW_IF_WIN32_BOOL_FALSE(WriteFile(output, piece.data(), gsl::narrow_cast<DWORD>(piece.size()), &pieceWritten, nullptr));
+                written += pieceWritten;
+            }
+        }
+
+        const auto done = fmt::format("\x1b[m\x1b]0;{}\x07", til::u16u8(DoneTitle));
+        THROW_IF_WIN32_BOOL_FALSE(WriteFile(output, done.data(), gsl::narrow_cast<DWORD>(done.size()), nullptr, nullptr));
+
+        const auto cpuTime = ProcessCpuTime(GetCurrentProcess()) - cpuStart;
+        std::ofstream report{ reportPath };
+        report << written << ' ' << cpuTime.count();
+        return 0;
+    }
+
+    struct Result
+    {
+        uint64_t bytes = 0;
+        std::chrono::steady_clock::duration duration{};
+        ::Microsoft::Console::Render::FrameStatistics frames;
+        std::chrono::nanoseconds generatorCpuTime{};
+        std::chrono::nanoseconds conptyCpuTime{};
+        std::chrono::nanoseconds connectionCpuTime{};
+        std::chrono::nanoseconds outputCpuTime{};
+        std::chrono::nanoseconds uiCpuTime{};
+    };
+
+    // Function Description:
+    // - Returns the console host that was most recently started by us,
+    //   skipping all the ones in `known`, which is updated accordingly.
+    wil::unique_handle OpenConsoleHost(std::vector<DWORD>& known)
+    {
+        wil::unique_handle snapshot{ CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0) };
+        THROW_LAST_ERROR_IF(snapshot.get() == INVALID_HANDLE_VALUE);
+        const auto self = GetCurrentProcessId();
+
+        PROCESSENTRY32W entry{};
+        entry.dwSize = sizeof(entry);
+        for (auto ok = Process32FirstW(snapshot.get(), &entry); ok; ok = Process32NextW(snapshot.get(), &entry))
+        {
+            const std::wstring_view name{ &entry.szExeFile[0] };
+            const auto isHost = til::equals_insensitive_ascii(name, L"OpenConsole.exe") || til::equals_insensitive_ascii(name, L"conhost.exe");
+            if (entry.th32ParentProcessID == self && isHost && std::find(known.begin(), known.end(), entry.th32ProcessID) == known.end())
+            {
+                known.emplace_back(entry.th32ProcessID);
+                return wil::unique_handle{ OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, entry.th32ProcessID) };
+            }
+        }
+        return {};
+    }
+
+    Result Run(const std::wstring_view payload, const int megabytes, std::vector<DWORD>& knownHosts)
+    {
+        const auto exePath = wil::GetModuleFileNameW<std::wstring>(nullptr);
+        std::wstring reportPath(MAX_PATH, L'\0');
+        reportPath.resize(GetTempPathW(MAX_PATH, reportPath.data()));
+        reportPath.append(fmt::format(L"wtbench-{}-{}.txt", GetCurrentProcessId(), payload));
+        const auto commandline = fmt::format(LR"("{}" --generate {} {} "{}")", exePath, payload, megabytes, reportPath);
+
+        auto settings = winrt::make_self<ControlUnitTests::MockControlSettings>();
+        TerminalConnection::ConptyConnection connection;
+        connection.Initialize(TerminalConnection::ConptyConnection::CreateSettings(winrt::hstring{ commandline },
+                                                                                   L"",
+                                                                                   L"",
+                                                                                   nullptr,
+                                                                                   ViewportSize.height,
+                                                                                   ViewportSize.width,
+                                                                                   winrt::guid{}));
+
+        // This handler runs on the connection's thread, right before or after the one of the
+        // ControlCore. The thread is only written before the first output is set, and only read
+        // on the UI thread after DoneTitle arrived, which is after all the output was handled.
+        std::atomic<int64_t> firstOutput{ 0 };
+        wil::unique_handle connectionThread;
+        const auto outputToken = connection.TerminalOutput([&](const winrt::hstring&) {
+            if (firstOutput.load(std::memory_order_relaxed) == 0)
+            {
+                connectionThread.reset(OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, GetCurrentThreadId()));
+                firstOutput.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_release);
+            }
+        });
+
+        const auto dispatcher = winrt::Windows::System::DispatcherQueue::GetForCurrentThread();
+        auto failed = false;
+        const auto stateToken = connection.StateChanged([&, dispatcher](auto&&, auto&&) {
+            if (connection.State() == TerminalConnection::ConnectionState::Failed)
+            {
+                dispatcher.TryEnqueue([&]() {
+                    failed = true;
+                    PostQuitMessage(0);
+                });
+            }
+        });
+
+        auto core = winrt::make_self<Control::implementation::ControlCore>(*settings, *settings, connection);
+        std::chrono::steady_clock::time_point done;
+        const auto titleToken = core->TitleChanged([&](auto&&, const Control::TitleChangedEventArgs& args) {
+            if (args.Title() == DoneTitle)
+            {
+                done = std::chrono::steady_clock::now();
+                PostQuitMessage(0);
+            }
+        });
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+        TraceLoggingWrite(g_hBenchmarkProvider,
+                          "Workload",
+                          TraceLoggingWideString(payload.data(), "Payload"),
+                          TraceLoggingOpcode(WINEVENT_OPCODE_START),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+
+        const auto uiStart = ThreadCpuTime(GetCurrentThread());
+        THROW_HR_IF(E_UNEXPECTED, !core->Initialize(ViewportPixels.width, ViewportPixels.height, 1.0));
+        core->EnablePainting();
+        const auto host = OpenConsoleHost(knownHosts);
+
+        MSG msg;
+        while (GetMessageW(&msg, nullptr, 0, 0))
+        {
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+        THROW_HR_IF_MSG(E_FAIL, failed, "the generator failed");
+
+        // The last frame is either presented already, or it's about to be.
+        auto end = done;
+        auto presented = core->GetPerformanceStatistics().frames.presented;
+        for (auto idleSince = std::chrono::steady_clock::now(); std::chrono::steady_clock::now() - idleSince < 50ms;)
+        {
+            Sleep(1);
+            if (const auto current = core->GetPerformanceStatistics().frames.presented; current != presented)
+            {
+                presented = current;
+                idleSince = end = std::chrono::steady_clock::now();
+            }
+        }
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+        TraceLoggingWrite(g_hBenchmarkProvider,
+                          "Workload",
+                          TraceLoggingWideString(payload.data(), "Payload"),
+                          TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+
+        Result result;
+        const auto statistics = core->GetPerformanceStatistics();
+        result.duration = end - std::chrono::steady_clock::time_point{ std::chrono::steady_clock::duration{ firstOutput.load(std::memory_order_acquire) } };
+        result.frames = statistics.frames;
+        result.outputCpuTime = statistics.outputCpuTime;
+        result.uiCpuTime = ThreadCpuTime(GetCurrentThread()) - uiStart;
+        result.connectionCpuTime = connectionThread ? ThreadCpuTime(connectionThread.get()) : std::chrono::nanoseconds{};
+
+        core->TitleChanged(titleToken);
+        connection.StateChanged(stateToken);
+        connection.TerminalOutput(outputToken);
+        core->Close();
+        connection.Close();
+
+        // Only now that the host exited, its CPU time is final.
+        result.conptyCpuTime = host ? ProcessCpuTime(host.get()) : std::chrono::nanoseconds{};
+
+        std::ifstream report{ reportPath };
+        int64_t generatorCpuTime = 0;
+        report >> result.bytes >> generatorCpuTime;
+        result.generatorCpuTime = std::chrono::nanoseconds{ generatorCpuTime };
+        report.close();
+        std::filesystem::remove(reportPath);
+        return result;
+    }
+
+    double Milliseconds(const std::chrono::nanoseconds duration) noexcept
+    {
+        return std::chrono::duration<double, std::milli>{ duration }.count();
+    }
+}
+
+int __cdecl wmain(int argc, WCHAR* argv[])
+try
+{
+    if (argc == 5 && std::wstring_view{ til::at(argv, 1) } == L"--generate")
+    {
+        return Generate(til::at(argv, 2), std::max(1, _wtoi(til::at(argv, 3))), til::at(argv, 4));
+    }
+
+    auto megabytes = 64;
+    std::vector<std::wstring_view> payloads;
+    for (auto i = 1; i < argc; i++)
+    {
+        const std::wstring_view arg{ til::at(argv, i) };
+        if (arg == L"--megabytes" && i + 1 < argc)
+        {
+            megabytes = std::max(1, _wtoi(til::at(argv, ++i)));
+        }
+        else if (std::find(Payloads.begin(), Payloads.end(), arg) != Payloads.end())
+        {
+            payloads.emplace_back(arg);
+        }
+        else
+        {
+            fputws(fmt::format(L"unknown argument: {}\n", arg).c_str(), stderr);
+            return 1;
+        }
+    }
+    if (payloads.empty())
+    {
+        payloads.assign(Payloads.begin(), Payloads.end());
+    }
+
+    winrt::init_apartment(winrt::apartment_type::single_threaded);
+    TraceLoggingRegister(g_hBenchmarkProvider);
+    // The ControlCore is linked in statically, so its DllMain doesn't register its provider.
+    TraceLoggingRegister(g_hTerminalControlProvider);
+    auto unregister = wil::scope_exit([]() {
+        TraceLoggingUnregister(g_hTerminalControlProvider);
+        TraceLoggingUnregister(g_hBenchmarkProvider);
+    });
+
+    // ControlCore posts its UI updates to the dispatcher of the thread it's created on.
+    const DispatcherQueueOptions options{ sizeof(DispatcherQueueOptions), DQTYPE_THREAD_CURRENT, DQTAT_COM_NONE };
+    winrt::Windows::System::DispatcherQueueController controller{ nullptr };
+    THROW_IF_FAILED(CreateDispatcherQueueController(options, reinterpret_cast<ABI::Windows::System::IDispatcherQueueController**>(winrt::put_abi(controller))));
+
+    fputws(fmt::format(L"{:<8} {:>8} {:>8} {:>8} {:>6} {:>9} {:>9} {:>9} {:>9} {:>9} {:>9}\n",
+                       L"payload",
+                       L"MB",
+                       L"MB/s",
+                       L"frames",
+                       L"late",
+                       L"gen ms",
+                       L"conpty ms",
+                       L"conn ms",
+                       L"output ms",
+                       L"render ms",
+                       L"ui ms")
+               .c_str(),
+           stdout);
+
+    std::vector<DWORD> knownHosts;
+    for (const auto payload : payloads)
+    {
+        const auto result = Run(payload, megabytes, knownHosts);
+        const auto mb = result.bytes / (1024.0 * 1024.0);
+        const auto seconds = std::chrono::duration<double>{ result.duration }.count();
+        fputws(fmt::format(L"{:<8} {:>8.1f} {:>8.1f} {:>8} {:>6} {:>9.0f} {:>9.0f} {:>9.0f} {:>9.0f} {:>9.0f} {:>9.0f}\n",
+                           payload,
+                           mb,
+                           mb / seconds,
+                           result.frames.presented,
+                           result.frames.late,
+                           Milliseconds(result.generatorCpuTime),
+                           Milliseconds(result.conptyCpuTime),
+                           Milliseconds(result.connectionCpuTime),
+                           Milliseconds(result.outputCpuTime),
+                           Milliseconds(result.frames.cpuTime),
+                           Milliseconds(result.uiCpuTime))
+                   .c_str(),
+               stdout);
+    }
+
+    controller.ShutdownQueueAsync();
+    return 0;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    fputws(L"failed to run the benchmark\n", stderr);
+    return 1;
+}
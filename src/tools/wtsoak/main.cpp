@@ -0,0 +1,593 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// TEST TOOL wtsoak
+// Leaks and slowdowns of long-running sessions only show up after hours, so
+// this drives the same headless setup as wtbench for as long as it's told to:
+// a generator process writes into a ConPTY, a ConptyConnection reads it and a
+// ControlCore writes it into its buffer and renders it.
+//
+// Usage: wtsoak [--minutes N] [--sample-seconds N] [--warmup-minutes N]
+//               [--max-memory-growth MB] [--max-handle-growth N]
+//               [--max-allocation-growth N] [--max-frame-time-growth F]
+//               [scenario...]
+// The scenarios are the patterns that grow state in real sessions:
+// * tail:       a steady trickle of log lines, like `tail -f`.
+// * altscreen:  TUIs that enter and leave the alternate buffer.
+// * hyperlinks: OSC 8 links that all have their own id, which have to be
+//               pruned once their rows were scrolled out of the history.
+// * marks:      shell integration prompts, each of which adds a scroll mark.
+// Without any, the generator goes through all of them over and over.
+//
+// Every sample prints the private bytes and the handle counts of wtsoak and of
+// the console host, the memory that the ControlCore accounts for, the allocations
+// made since the previous sample and the ones still alive, and the frames that were
+// presented with their 95th percentile frame time. Once the run is over, the last
+// sample is compared to the first one after the warmup, and wtsoak fails with
+// exit code 2 if any of them grew by more than the given thresholds.
+//
+// The allocation counts come from wtsoak's own operator new, so they cover the
+// ControlCore, which is linked in statically, but not the ConptyConnection DLL.
+//
+// wtsoak runs itself as the generator, with --generate.
+
+#include "pch.h"
+
+#include "../../cascadia/TerminalControl/EventArgs.h"
+#include "../../cascadia/TerminalControl/ControlCore.h"
+#include "../../cascadia/UnitTests_Control/MockControlSettings.h"
+
+using namespace winrt::Microsoft::Terminal;
+using namespace std::chrono_literals;
+
+TRACELOGGING_DECLARE_PROVIDER(g_hTerminalControlProvider);
+
+namespace
+{
+    constexpr std::array<std::wstring_view, 4> Scenarios{ L"tail", L"altscreen", L"hyperlinks", L"marks" };
+    // The same size as wtbench's: 120x30 cells of Consolas at 96 DPI, 9x21 pixels each.
+    constexpr til::size ViewportSize{ 120, 30 };
+    constexpr til::size ViewportPixels{ ViewportSize.width * 9, ViewportSize.height * 21 };
+
+    std::atomic<uint64_t> g_allocations{ 0 };
+    std::atomic<uint64_t> g_deallocations{ 0 };
+}
+
+#pragma region Allocation counting
+// The nothrow and array forms of the CRT forward to these.
+void* __cdecl operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    for (;;)
+    {
+        if (const auto p = malloc(size ? size : 1))
+        {
+            return p;
+        }
+        const auto handler = std::get_new_handler();
+        if (!handler)
+        {
+            throw std::bad_alloc{};
+        }
+        handler();
+    }
+}
+
+void __cdecl operator delete(void* p) noexcept
+{
+    if (p)
+    {
+        g_deallocations.fetch_add(1, std::memory_order_relaxed);
+        free(p);
+    }
+}
+
+void __cdecl operator delete(void* p, size_t) noexcept
+{
+    operator delete(p);
+}
+#pragma endregion
+
+namespace
+{
+    // Function Description:
+    // - Writes all of text to the console, in a single call.
+    // Return Value:
+    // - false once the ConPTY went away, which is how the generator learns that the run is over.
+    bool Write(const HANDLE output, const std::string_view text) noexcept
+    {
+        DWORD written = 0;
+        return WriteFile(output, text.data(), gsl::narrow_cast<DWORD>(text.size()), &written, nullptr) && written == text.size();
+    }
+
+    std::string Timestamp()
+    {
+        SYSTEMTIME time;
+        GetLocalTime(&time);
+        return fmt::format("{:02}:{:02}:{:02}.{:03}", time.wHour, time.wMinute, time.wSecond, time.wMilliseconds);
+    }
+
+    // Each of these writes one round of its scenario. `counter` keeps growing
+    // over the whole run, so that no two links, prompts or lines are the same.
+    std::string GenerateTail(uint64_t& counter)
+    {
+        std::string text;
+        const auto timestamp = Timestamp();
+        for (auto i = 0; i < 20; i++, counter++)
+        {
+            fmt::format_to(std::back_inserter(text),
+                           "{} \x1b[3{}m{:<5}\x1b[m GET /api/items/{} served in {} ms\r\n",
+                           timestamp,
+                           counter % 3 ? 2 : 3,
+                           counter % 3 ? "INFO" : "WARN",
+                           counter,
+                           counter % 97);
+        }
+        return text;
+    }
+
+    std::string GenerateAltScreen(uint64_t& counter, const til::size size)
+    {
+        std::string text;
+        for (auto flip = 0; flip < 5; flip++, counter++)
+        {
+            text.append("\x1b[?1049h\x1b[?25l\x1b[H\x1b[2J");
+            for (auto row = 1; row <= size.height; row++)
+            {
+                fmt::format_to(std::back_inserter(text), "\x1b[{};1H\x1b[38;5;{}m{:<{}}", row, (counter + row) % 256, fmt::format("screen {} row {}", counter, row), size.width);
+            }
+            text.append("\x1b[m\x1b[?25h\x1b[?1049l");
+        }
+        return text;
+    }
+
+    std::string GenerateHyperlinks(uint64_t& counter)
+    {
+        std::string text;
+        for (auto i = 0; i < 50; i++, counter++)
+        {
+            fmt::format_to(std::back_inserter(text), "see \x1b]8;id=soak{0};https://example.com/soak/{0}\x1b\\link {0}\x1b]8;;\x1b\\ for details\r\n", counter);
+        }
+        return text;
+    }
+
+    std::string GenerateMarks(uint64_t& counter)
+    {
+        std::string text;
+        for (auto i = 0; i < 20; i++, counter++)
+        {
+            // The "e" of "echo" mustn't follow the \x07 directly, or it would be part of the escape.
+            fmt::format_to(std::back_inserter(text),
+                           "\x1b]133;A\x07PS C:\\soak> \x1b]133;B\x07"
+                           "echo {0}\r\n\x1b]133;C\x07{0}\r\n\x1b]133;D;0\x07",
+                           counter);
+        }
+        return text;
+    }
+
+    // Function Description:
+    // - The generator. It runs inside the ConPTY and writes rounds of the
+    //   given scenarios, one after the other, until the ConPTY is closed.
+    int Generate(const std::vector<std::wstring_view>& scenarios)
+    {
+        const auto output = GetStdHandle(STD_OUTPUT_HANDLE);
+        SetConsoleOutputCP(CP_UTF8);
+        DWORD mode = 0;
+        if (GetConsoleMode(output, &mode))
+        {
+            SetConsoleMode(output, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING | DISABLE_NEWLINE_AUTO_RETURN);
+        }
+
+        auto size = ViewportSize;
+        CONSOLE_SCREEN_BUFFER_INFO info{};
+        if (GetConsoleScreenBufferInfo(output, &info))
+        {
+            size = { info.srWindow.Right - info.srWindow.Left + 1, info.srWindow.Bottom - info.srWindow.Top + 1 };
+        }
+
+        uint64_t counter = 0;
+        for (;;)
+        {
+            for (const auto scenario : scenarios)
+            {
+                std::string text;
+                if (scenario == L"tail")
+                {
+                    text = GenerateTail(counter);
+                }
+                else if (scenario == L"altscreen")
+                {
+                    text = GenerateAltScreen(counter, size);
+                }
+                else if (scenario == L"hyperlinks")
+                {
+                    text = GenerateHyperlinks(counter);
+                }
+                else
+                {
+                    text = GenerateMarks(counter);
+                }
+
+                if (!Write(output, text))
+                {
+                    return 0;
+                }
+                // Real sessions have pauses, during which the renderer catches up.
+                Sleep(scenario == L"tail" ? 50 : 10);
+            }
+        }
+    }
+
+    struct Sample
+    {
+        std::chrono::steady_clock::duration elapsed{};
+        uint64_t privateBytes = 0;
+        uint32_t handles = 0;
+        uint32_t gdiObjects = 0;
+        uint32_t userObjects = 0;
+        uint64_t hostPrivateBytes = 0;
+        uint32_t hostHandles = 0;
+        // The memory that ControlCore::MemoryUsage() accounts for, without the GPU.
+        uint64_t terminalBytes = 0;
+        uint64_t allocations = 0;
+        uint64_t liveAllocations = 0;
+        ::Microsoft::Console::Render::FrameStatistics frames;
+    };
+
+    struct Thresholds
+    {
+        uint64_t memoryGrowth = 64 * 1024 * 1024;
+        uint32_t handleGrowth = 100;
+        uint64_t allocationGrowth = 100000;
+        double frameTimeGrowth = 2.0;
+    };
+
+    uint64_t PrivateBytes(const HANDLE process) noexcept
+    {
+        PROCESS_MEMORY_COUNTERS_EX counters{};
+        counters.cb = sizeof(counters);
+        return K32GetProcessMemoryInfo(process, reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters)) ? counters.PrivateUsage : 0;
+    }
+
+    uint32_t HandleCount(const HANDLE process) noexcept
+    {
+        DWORD count = 0;
+        return GetProcessHandleCount(process, &count) ? count : 0;
+    }
+
+    // Function Description:
+    // - Returns the console host that was started by us.
+    wil::unique_handle OpenConsoleHost()
+    {
+        wil::unique_handle snapshot{ CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0) };
+        THROW_LAST_ERROR_IF(snapshot.get() == INVALID_HANDLE_VALUE);
+        const auto self = GetCurrentProcessId();
+
+        PROCESSENTRY32W entry{};
+        entry.dwSize = sizeof(entry);
+        for (auto ok = Process32FirstW(snapshot.get(), &entry); ok; ok = Process32NextW(snapshot.get(), &entry))
+        {
+            const std::wstring_view name{ &entry.szExeFile[0] };
+            const auto isHost = til::equals_insensitive_ascii(name, L"OpenConsole.exe") || til::equals_insensitive_ascii(name, L"conhost.exe");
+            if (entry.th32ParentProcessID == self && isHost)
+            {
+                return wil::unique_handle{ OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | PROCESS_VM_READ, FALSE, entry.th32ProcessID) };
+            }
+        }
+        return {};
+    }
+
+    // Function Description:
+    // - Returns the given percentile of the time it took to paint the frames
+    //   presented between two samples, as the upper end of the histogram step
+    //   it falls into. See ControlCore::PerformanceStatisticsText().
+    double FrameTimePercentile(const Sample& from, const Sample& to, const uint64_t permille) noexcept
+    {
+        using ::Microsoft::Console::Render::FrameStatistics;
+
+        uint64_t frames = 0;
+        for (size_t i = 0; i < to.frames.frameTimes.size(); ++i)
+        {
+            frames += til::at(to.frames.frameTimes, i) - til::at(from.frames.frameTimes, i);
+        }
+        const auto rank = (frames * permille + 999) / 1000;
+
+        uint64_t count = 0;
+        for (size_t i = 0; i < to.frames.frameTimes.size(); ++i)
+        {
+            count += til::at(to.frames.frameTimes, i) - til::at(from.frames.frameTimes, i);
+            if (count >= rank && count != 0)
+            {
+                return std::chrono::duration<double, std::milli>(FrameStatistics::FrameTimeStep * (i + 1)).count();
+            }
+        }
+        return 0.0;
+    }
+
+    double Mebibytes(const uint64_t bytes) noexcept
+    {
+        return bytes / (1024.0 * 1024.0);
+    }
+
+    // Function Description:
+    // - Compares the last sample with the first one after the warmup.
+    // Return Value:
+    // - A description of every threshold that was exceeded.
+    std::vector<std::wstring> Evaluate(const std::vector<Sample>& samples, const std::chrono::steady_clock::duration warmup, const Thresholds& thresholds)
+    {
+        // The frame times are compared between the first and the last interval after the warmup.
+        const auto baseline = std::find_if(samples.begin(), samples.end(), [&](const Sample& sample) { return sample.elapsed >= warmup; });
+        if (std::distance(baseline, samples.end()) < 3)
+        {
+            return {};
+        }
+
+        const auto& first = *baseline;
+        const auto& last = samples.back();
+        const auto growth = [](const uint64_t from, const uint64_t to) noexcept {
+            return to > from ? to - from : 0;
+        };
+
+        std::vector<std::wstring> failures;
+        if (const auto grown = growth(first.privateBytes, last.privateBytes); grown > thresholds.memoryGrowth)
+        {
+            failures.emplace_back(fmt::format(L"the private bytes grew by {:.1f} MiB", Mebibytes(grown)));
+        }
+        if (const auto grown = growth(first.hostPrivateBytes, last.hostPrivateBytes); grown > thresholds.memoryGrowth)
+        {
+            failures.emplace_back(fmt::format(L"the private bytes of the console host grew by {:.1f} MiB", Mebibytes(grown)));
+        }
+        if (const auto grown = growth(first.handles, last.handles); grown > thresholds.handleGrowth)
+        {
+            failures.emplace_back(fmt::format(L"the handle count grew by {}", grown));
+        }
+        if (const auto grown = growth(first.hostHandles, last.hostHandles); grown > thresholds.handleGrowth)
+        {
+            failures.emplace_back(fmt::format(L"the handle count of the console host grew by {}", grown));
+        }
+        if (const auto grown = growth(first.gdiObjects + first.userObjects, last.gdiObjects + last.userObjects); grown > thresholds.handleGrowth)
+        {
+            failures.emplace_back(fmt::format(L"the GDI and USER objects grew by {}", grown));
+        }
+        if (const auto grown = growth(first.liveAllocations, last.liveAllocations); grown > thresholds.allocationGrowth)
+        {
+            failures.emplace_back(fmt::format(L"the live allocations grew by {}", grown));
+        }
+
+        // Frame times below a millisecond are too noisy to compare.
+        const auto firstFrameTime = FrameTimePercentile(first, *(baseline + 1), 950);
+        const auto lastFrameTime = FrameTimePercentile(*(samples.end() - 2), last, 950);
+        if (lastFrameTime > std::max(1.0, firstFrameTime) * thresholds.frameTimeGrowth)
+        {
+            failures.emplace_back(fmt::format(L"the 95th percentile frame time grew from {:.2f} ms to {:.2f} ms", firstFrameTime, lastFrameTime));
+        }
+        return failures;
+    }
+
+    int Soak(const std::vector<std::wstring_view>& scenarios, const std::chrono::minutes duration, const std::chrono::seconds interval, const std::chrono::minutes warmup, const Thresholds& thresholds)
+    {
+        const auto exePath = wil::GetModuleFileNameW<std::wstring>(nullptr);
+        auto commandline = fmt::format(LR"("{}" --generate)", exePath);
+        for (const auto scenario : scenarios)
+        {
+            fmt::format_to(std::back_inserter(commandline), L" {}", scenario);
+        }
+
+        auto settings = winrt::make_self<ControlUnitTests::MockControlSettings>();
+        TerminalConnection::ConptyConnection connection;
+        connection.Initialize(TerminalConnection::ConptyConnection::CreateSettings(winrt::hstring{ commandline },
+                                                                                   L"",
+                                                                                   L"",
+                                                                                   nullptr,
+                                                                                   ViewportSize.height,
+                                                                                   ViewportSize.width,
+                                                                                   winrt::guid{}));
+
+        const auto dispatcher = winrt::Windows::System::DispatcherQueue::GetForCurrentThread();
+        auto failed = false;
+        const auto stateToken = connection.StateChanged([&, dispatcher](auto&&, auto&&) {
+            const auto state = connection.State();
+            if (state == TerminalConnection::ConnectionState::Failed || state == TerminalConnection::ConnectionState::Closed)
+            {
+                dispatcher.TryEnqueue([&]() {
+                    failed = true;
+                    PostQuitMessage(0);
+                });
+            }
+        });
+
+        auto core = winrt::make_self<Control::implementation::ControlCore>(*settings, *settings, connection);
+        THROW_HR_IF(E_UNEXPECTED, !core->Initialize(ViewportPixels.width, ViewportPixels.height, 1.0));
+        core->EnablePainting();
+
+        // The host only exists once the connection started it.
+        wil::unique_handle host;
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<Sample> samples;
+        const auto sample = [&]() {
+            if (!host)
+            {
+                host = OpenConsoleHost();
+            }
+
+            Sample s;
+            s.elapsed = std::chrono::steady_clock::now() - start;
+            s.privateBytes = PrivateBytes(GetCurrentProcess());
+            s.handles = HandleCount(GetCurrentProcess());
+            s.gdiObjects = GetGuiResources(GetCurrentProcess(), GR_GDIOBJECTS);
+            s.userObjects = GetGuiResources(GetCurrentProcess(), GR_USEROBJECTS);
+            if (host)
+            {
+                s.hostPrivateBytes = PrivateBytes(host.get());
+                s.hostHandles = HandleCount(host.get());
+            }
+            const auto memory = core->MemoryUsage();
+            s.terminalBytes = memory.TextBuffer + memory.Attributes + memory.UnicodeStorage + memory.Hyperlinks + memory.ScrollMarks + memory.RendererCaches;
+            s.allocations = g_allocations.load(std::memory_order_relaxed);
+            s.liveAllocations = s.allocations - g_deallocations.load(std::memory_order_relaxed);
+            s.frames = core->GetPerformanceStatistics().frames;
+
+            const auto& previous = samples.empty() ? s : samples.back();
+            fputws(fmt::format(L"{:>8.1f} {:>9.1f} {:>7} {:>5} {:>9.1f} {:>7} {:>9.1f} {:>9} {:>9} {:>8} {:>8.2f}\n",
+                               std::chrono::duration<double, std::ratio<60>>{ s.elapsed }.count(),
+                               Mebibytes(s.privateBytes),
+                               s.handles,
+                               s.gdiObjects + s.userObjects,
+                               Mebibytes(s.hostPrivateBytes),
+                               s.hostHandles,
+                               Mebibytes(s.terminalBytes),
+                               s.allocations - previous.allocations,
+                               s.liveAllocations,
+                               s.frames.presented - previous.frames.presented,
+                               FrameTimePercentile(previous, s, 950))
+                       .c_str(),
+                   stdout);
+            fflush(stdout);
+            samples.emplace_back(std::move(s));
+        };
+
+        fputws(fmt::format(L"{:>8} {:>9} {:>7} {:>5} {:>9} {:>7} {:>9} {:>9} {:>9} {:>8} {:>8}\n",
+                           L"minutes",
+                           L"MiB",
+                           L"handles",
+                           L"gui",
+                           L"host MiB",
+                           L"host h",
+                           L"term MiB",
+                           L"allocs",
+                           L"live",
+                           L"frames",
+                           L"p95 ms")
+                   .c_str(),
+               stdout);
+
+        const auto timer = SetTimer(nullptr, 0, gsl::narrow_cast<UINT>(std::chrono::milliseconds{ interval }.count()), nullptr);
+        THROW_LAST_ERROR_IF(timer == 0);
+
+        MSG msg;
+        while (GetMessageW(&msg, nullptr, 0, 0))
+        {
+            if (msg.message == WM_TIMER && msg.hwnd == nullptr && msg.wParam == timer)
+            {
+                sample();
+                if (samples.back().elapsed >= duration)
+                {
+                    PostQuitMessage(0);
+                }
+                continue;
+            }
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+        KillTimer(nullptr, timer);
+
+        connection.StateChanged(stateToken);
+        core->Close();
+        connection.Close();
+
+        if (failed)
+        {
+            fputws(L"the connection closed before the end of the run\n", stderr);
+            return 1;
+        }
+
+        const auto failures = Evaluate(samples, warmup, thresholds);
+        for (const auto& failure : failures)
+        {
+            fputws(fmt::format(L"FAILED: {}\n", failure).c_str(), stderr);
+        }
+        return failures.empty() ? 0 : 2;
+    }
+
+    int ParsePositive(const wchar_t* arg) noexcept
+    {
+        return std::max(1, _wtoi(arg));
+    }
+}
+
+int __cdecl wmain(int argc, WCHAR* argv[])
+try
+{
+    std::vector<std::wstring_view> scenarios;
+    if (argc >= 2 && std::wstring_view{ til::at(argv, 1) } == L"--generate")
+    {
+        for (auto i = 2; i < argc; i++)
+        {
+            scenarios.emplace_back(til::at(argv, i));
+        }
+        return Generate(scenarios);
+    }
+
+    std::chrono::minutes duration{ 240 };
+    std::chrono::seconds interval{ 60 };
+    std::chrono::minutes warmup{ 10 };
+    Thresholds thresholds;
+    for (auto i = 1; i < argc; i++)
+    {
+        const std::wstring_view arg{ til::at(argv, i) };
+        const auto hasValue = i + 1 < argc;
+        if (arg == L"--minutes" && hasValue)
+        {
+            duration = std::chrono::minutes{ ParsePositive(til::at(argv, ++i)) };
+        }
+        else if (arg == L"--sample-seconds" && hasValue)
+        {
+            interval = std::chrono::seconds{ ParsePositive(til::at(argv, ++i)) };
+        }
+        else if (arg == L"--warmup-minutes" && hasValue)
+        {
+            warmup = std::chrono::minutes{ std::max(0, _wtoi(til::at(argv, ++i))) };
+        }
+        else if (arg == L"--max-memory-growth" && hasValue)
+        {
+            thresholds.memoryGrowth = gsl::narrow_cast<uint64_t>(ParsePositive(til::at(argv, ++i))) * 1024 * 1024;
+        }
+        else if (arg == L"--max-handle-growth" && hasValue)
+        {
+            thresholds.handleGrowth = gsl::narrow_cast<uint32_t>(ParsePositive(til::at(argv, ++i)));
+        }
+        else if (arg == L"--max-allocation-growth" && hasValue)
+        {
+            thresholds.allocationGrowth = gsl::narrow_cast<uint64_t>(ParsePositive(til::at(argv, ++i)));
+        }
+        else if (arg == L"--max-frame-time-growth" && hasValue)
+        {
+            thresholds.frameTimeGrowth = std::max(1.0, _wtof(til::at(argv, ++i)));
+        }
+        else if (std::find(Scenarios.begin(), Scenarios.end(), arg) != Scenarios.end())
+        {
+            scenarios.emplace_back(arg);
+        }
+        else
+        {
+            fputws(fmt::format(L"unknown argument: {}\n", arg).c_str(), stderr);
+            return 1;
+        }
+    }
+    if (scenarios.empty())
+    {
+        scenarios.assign(Scenarios.begin(), Scenarios.end());
+    }
+
+    winrt::init_apartment(winrt::apartment_type::single_threaded);
+    // The ControlCore is linked in statically, so its DllMain doesn't register its provider.
+    TraceLoggingRegister(g_hTerminalControlProvider);
+    auto unregister = wil::scope_exit([]() {
+        TraceLoggingUnregister(g_hTerminalControlProvider);
+    });
+
+    // ControlCore posts its UI updates to the dispatcher of the thread it's created on.
+    const DispatcherQueueOptions options{ sizeof(DispatcherQueueOptions), DQTYPE_THREAD_CURRENT, DQTAT_COM_NONE };
+    winrt::Windows::System::DispatcherQueueController controller{ nullptr };
+    THROW_IF_FAILED(CreateDispatcherQueueController(options, reinterpret_cast<ABI::Windows::System::IDispatcherQueueController**>(winrt::put_abi(controller))));
+
+    const auto result = Soak(scenarios, duration, interval, warmup, thresholds);
+    controller.ShutdownQueueAsync();
+    return result;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    fputws(L"failed to run the soak test\n", stderr);
+    return 1;
+}
@@ -0,0 +1,166 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/AllocationTracker.hpp"
+
+#include <crtdbg.h>
+
+using namespace Microsoft::Console::Types;
+
+namespace
+{
+    struct StageCounters
+    {
+        std::atomic<uint64_t> scopes{ 0 };
+        std::atomic<uint64_t> allocations{ 0 };
+        std::atomic<uint64_t> maxPerScope{ 0 };
+        std::atomic<uint64_t> overBudget{ 0 };
+    };
+
+    // Printing ASCII into the buffer and painting a frame that doesn't show anything
+    // new are expected to reuse the memory that the previous call allocated.
+    constexpr std::array<size_t, AllocationStageCount> defaultBudgets{
+        AllocationTracker::Unlimited, // ProcessString
+        AllocationTracker::Unlimited, // Print
+        0, // AsciiPrint
+        AllocationTracker::Unlimited, // Frame
+        0, // SteadyFrame
+        AllocationTracker::Unlimited, // InputEvent
+    };
+}
+
+static std::array<std::atomic<size_t>, AllocationStageCount> s_budgets{
+    defaultBudgets[0],
+    defaultBudgets[1],
+    defaultBudgets[2],
+    defaultBudgets[3],
+    defaultBudgets[4],
+    defaultBudgets[5],
+};
+static std::array<StageCounters, AllocationStageCount> s_counters;
+static std::atomic<bool> s_assertOnOverBudget{ false };
+
+#if CON_TRACK_ALLOCATIONS
+
+// Incremented by the allocation hook for every allocation the thread makes.
+// A Scope subtracts the value it started with from the one it ends with.
+static thread_local uint64_t t_allocations = 0;
+static _CRT_ALLOC_HOOK s_previousHook = nullptr;
+
+static int __CRTDECL allocHook(int allocType, void* userData, size_t size, int blockType, long requestNumber, const unsigned char* filename, int lineNumber)
+{
+    // The CRT's own bookkeeping isn't something our code can avoid.
+    if ((allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC) && _BLOCK_TYPE(blockType) != _CRT_BLOCK)
+    {
+        ++t_allocations;
+    }
+    return s_previousHook ? s_previousHook(allocType, userData, size, blockType, requestNumber, filename, lineNumber) : TRUE;
+}
+
+// The hook is installed as soon as anything that uses a Scope is loaded.
+static const struct HookRegistration
+{
+    HookRegistration() noexcept
+    {
+        s_previousHook = _CrtSetAllocHook(allocHook);
+    }
+} s_registration;
+
+AllocationTracker::Scope::Scope(const AllocationStage stage) noexcept :
+    _stage{ stage },
+    _start{ t_allocations }
+{
+}
+
+AllocationTracker::Scope::~Scope()
+{
+    // Read the count before anything below gets a chance to allocate.
+    const auto allocations = t_allocations - _start;
+    auto& counters = til::at(s_counters, static_cast<size_t>(_stage));
+
+    counters.scopes.fetch_add(1, std::memory_order_relaxed);
+    counters.allocations.fetch_add(allocations, std::memory_order_relaxed);
+
+    auto max = counters.maxPerScope.load(std::memory_order_relaxed);
+    while (allocations > max && !counters.maxPerScope.compare_exchange_weak(max, allocations, std::memory_order_relaxed))
+    {
+    }
+
+    const auto budget = til::at(s_budgets, static_cast<size_t>(_stage)).load(std::memory_order_relaxed);
+    if (allocations > budget)
+    {
+        const auto overruns = counters.overBudget.fetch_add(1, std::memory_order_relaxed);
+        _RPTW3(_CRT_WARN, L"AllocationTracker: %s made %llu allocations with a budget of %zu\n", StageName(_stage), allocations, budget);
+        // Asserting on every overrun would make the application unusable until the
+        // cause is fixed. One per stage is enough to get someone to look at it.
+        if (overruns == 0 && s_assertOnOverBudget.load(std::memory_order_relaxed))
+        {
+            _ASSERT_EXPR(false, L"A stage exceeded its allocation budget. See the debug output for details.");
+        }
+    }
+}
+
+#endif
+
+void AllocationTracker::SetBudget(const AllocationStage stage, const size_t allocations) noexcept
+{
+    til::at(s_budgets, static_cast<size_t>(stage)).store(allocations, std::memory_order_relaxed);
+}
+
+size_t AllocationTracker::GetBudget(const AllocationStage stage) noexcept
+{
+    return til::at(s_budgets, static_cast<size_t>(stage)).load(std::memory_order_relaxed);
+}
+
+void AllocationTracker::AssertOnOverBudget(const bool enable) noexcept
+{
+    s_assertOnOverBudget.store(enable, std::memory_order_relaxed);
+}
+
+const wchar_t* AllocationTracker::StageName(const AllocationStage stage) noexcept
+{
+    switch (stage)
+    {
+    case AllocationStage::ProcessString:
+        return L"ProcessString";
+    case AllocationStage::Print:
+        return L"Print";
+    case AllocationStage::AsciiPrint:
+        return L"AsciiPrint";
+    case AllocationStage::Frame:
+        return L"Frame";
+    case AllocationStage::SteadyFrame:
+        return L"SteadyFrame";
+    case AllocationStage::InputEvent:
+        return L"InputEvent";
+    default:
+        return L"Unknown";
+    }
+}
+
+AllocationTracker::Statistics AllocationTracker::GetStatistics() noexcept
+{
+    Statistics statistics;
+    for (size_t i = 0; i < AllocationStageCount; ++i)
+    {
+        const auto& counters = til::at(s_counters, i);
+        auto& stage = til::at(statistics, i);
+        stage.scopes = counters.scopes.load(std::memory_order_relaxed);
+        stage.allocations = counters.allocations.load(std::memory_order_relaxed);
+        stage.maxPerScope = counters.maxPerScope.load(std::memory_order_relaxed);
+        stage.overBudget = counters.overBudget.load(std::memory_order_relaxed);
+    }
+    return statistics;
+}
+
+void AllocationTracker::ResetStatistics() noexcept
+{
+    for (auto& counters : s_counters)
+    {
+        counters.scopes.store(0, std::memory_order_relaxed);
+        counters.allocations.store(0, std::memory_order_relaxed);
+        counters.maxPerScope.store(0, std::memory_order_relaxed);
+        counters.overBudget.store(0, std::memory_order_relaxed);
+    }
+}
@@ -25,6 +25,14 @@ bool IsGlyphFullWidth(const wchar_t wch) noexcept
     return widthDetector.IsWide(wch);
 }
 
+// Function Description:
+// - determines how many columns the given text occupies.
+//      See CodepointWidthDetector::GetColumnCount
+size_t GetGlyphColumnCount(const std::wstring_view text)
+{
+    return widthDetector.GetColumnCount(text);
+}
+
 // Function Description:
 // - Sets a function that should be used by the global CodepointWidthDetector
 //      as the fallback mechanism for determining a particular glyph's width,
@@ -43,6 +43,11 @@ namespace Microsoft::Console::Types
 
         virtual void LockConsole() noexcept = 0;
         virtual void UnlockConsole() noexcept = 0;
+
+        // Like LockConsole, but the caller promises to only read. Implementations
+        // may let multiple readers in at once, or simply take the exclusive lock.
+        virtual void LockConsoleForReading() noexcept = 0;
+        virtual void UnlockConsoleForReading() noexcept = 0;
     };
 
     // See docs/virtual-dtors.md for an explanation of why this is weird.
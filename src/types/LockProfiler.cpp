@@ -0,0 +1,358 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/LockProfiler.hpp"
+
+#include <intrin.h>
+#include <winmeta.h>
+#include <TraceLoggingProvider.h>
+
+#pragma warning(push)
+#pragma warning(disable : 26446 26447 26477 26482 26485 26494 26496)
+TRACELOGGING_DEFINE_PROVIDER(g_hLockProfilerProvider,
+                             "Microsoft.Windows.Console.Locks",
+                             // tl:{865ac348-8eb5-5e5f-17bb-cdb40fda5aff}
+                             (0x865ac348, 0x8eb5, 0x5e5f, 0x17, 0xbb, 0xcd, 0xb4, 0x0f, 0xda, 0x5a, 0xff));
+#pragma warning(pop)
+
+using namespace Microsoft::Console::Types;
+
+// An uncontended acquisition of a SRWLOCK takes a few dozen nanoseconds.
+// Anything that takes longer than this had to wait for another thread.
+static constexpr int64_t contendedWaitNs = 1'000;
+// Waits and holds at least this long are logged as events.
+static constexpr int64_t longWaitNs = 500'000;
+static constexpr int64_t longHoldNs = 1'000'000;
+
+static std::atomic<int> s_profilingUsers{ 0 };
+static thread_local LockAcquirer t_acquirer = LockAcquirer::Other;
+
+// A thread may hold several shared locks at once, but only the hold time of
+// the outermost one is tracked. That's the one that blocks the writers anyway.
+static thread_local struct
+{
+    const LockProfiler* owner = nullptr;
+    uint32_t depth = 0;
+    int64_t since = 0;
+    const void* site = nullptr;
+    LockAcquirer acquirer = LockAcquirer::Other;
+} t_shared;
+
+static const struct ProviderRegistration
+{
+    ProviderRegistration() noexcept
+    {
+        TraceLoggingRegister(g_hLockProfilerProvider);
+    }
+    ~ProviderRegistration()
+    {
+        TraceLoggingUnregister(g_hLockProfilerProvider);
+    }
+} s_registration;
+
+static int64_t now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+LockProfiler::ScopedAcquirer::ScopedAcquirer(const LockAcquirer acquirer) noexcept :
+    _previous{ std::exchange(t_acquirer, acquirer) }
+{
+}
+
+LockProfiler::ScopedAcquirer::~ScopedAcquirer()
+{
+    t_acquirer = _previous;
+}
+
+LockProfiler::LockProfiler(const char* name) noexcept :
+    _name{ name }
+{
+}
+
+void LockProfiler::SetThreadAcquirer(const LockAcquirer acquirer) noexcept
+{
+    t_acquirer = acquirer;
+}
+
+LockAcquirer LockProfiler::GetThreadAcquirer() noexcept
+{
+    return t_acquirer;
+}
+
+void LockProfiler::EnableProfiling(const bool enable) noexcept
+{
+    s_profilingUsers.fetch_add(enable ? 1 : -1, std::memory_order_relaxed);
+}
+
+bool LockProfiler::IsProfiling() noexcept
+{
+    return s_profilingUsers.load(std::memory_order_relaxed) > 0 || TraceLoggingProviderEnabled(g_hLockProfilerProvider, WINEVENT_LEVEL_VERBOSE, 0);
+}
+
+const wchar_t* LockProfiler::AcquirerName(const LockAcquirer acquirer) noexcept
+{
+    switch (acquirer)
+    {
+    case LockAcquirer::Render:
+        return L"Render";
+    case LockAcquirer::Output:
+        return L"Output";
+    case LockAcquirer::Ui:
+        return L"UI";
+    case LockAcquirer::Uia:
+        return L"UIA";
+    case LockAcquirer::Patterns:
+        return L"Patterns";
+    default:
+        return L"Other";
+    }
+}
+
+// Routine Description:
+// - Turns a return address into "module+offset", which can be resolved
+//   with the symbols of the module, even on machines without a debugger.
+std::wstring LockProfiler::FormatSite(const void* site)
+{
+    if (!site)
+    {
+        return {};
+    }
+
+    HMODULE module = nullptr;
+    wchar_t path[MAX_PATH];
+    if (GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, static_cast<LPCWSTR>(site), &module) &&
+        GetModuleFileNameW(module, &path[0], MAX_PATH))
+    {
+        std::wstring_view name{ &path[0] };
+        name = name.substr(name.find_last_of(L'\\') + 1);
+        const auto offset = reinterpret_cast<uintptr_t>(site) - reinterpret_cast<uintptr_t>(module);
+        return fmt::format(L"{}+{:#x}", name, offset);
+    }
+    return fmt::format(L"{}", site);
+}
+
+int64_t LockProfiler::BeginWait() const noexcept
+{
+    return IsProfiling() ? now() : 0;
+}
+
+void LockProfiler::AcquiredExclusive(const int64_t waitStart, const void* site, const LockAcquirer fallback) noexcept
+{
+    if (!waitStart)
+    {
+        _exclusiveSince = 0;
+        return;
+    }
+
+    const auto acquirer = _resolve(fallback);
+    const auto acquired = now();
+    _acquired(acquirer, waitStart, acquired);
+    _exclusiveSince = acquired;
+    _exclusiveSite = site;
+    _exclusiveAcquirer = acquirer;
+}
+
+void LockProfiler::ReleasingExclusive() noexcept
+{
+    if (const auto since = std::exchange(_exclusiveSince, 0))
+    {
+        _released(_exclusiveAcquirer, since, _exclusiveSite);
+    }
+}
+
+void LockProfiler::AcquiredShared(const int64_t waitStart, const void* site, const LockAcquirer fallback) noexcept
+{
+    if (t_shared.depth)
+    {
+        t_shared.depth += t_shared.owner == this;
+        return;
+    }
+    if (!waitStart)
+    {
+        return;
+    }
+
+    const auto acquirer = _resolve(fallback);
+    const auto acquired = now();
+    _acquired(acquirer, waitStart, acquired);
+    t_shared.owner = this;
+    t_shared.depth = 1;
+    t_shared.since = acquired;
+    t_shared.site = site;
+    t_shared.acquirer = acquirer;
+}
+
+void LockProfiler::ReleasingShared() noexcept
+{
+    if (t_shared.owner == this && --t_shared.depth == 0)
+    {
+        t_shared.owner = nullptr;
+        _released(t_shared.acquirer, t_shared.since, t_shared.site);
+    }
+}
+
+// Method Description:
+// - Returns the counters collected so far. They're read one by one, so
+//   while the lock is in use they may not be exactly consistent.
+LockProfiler::Statistics LockProfiler::GetStatistics() const noexcept
+{
+    Statistics statistics;
+    for (size_t i = 0; i < LockAcquirerCount; ++i)
+    {
+        const auto& counters = til::at(_counters, i);
+        auto& s = til::at(statistics, i);
+        s.acquisitions = counters.acquisitions.load(std::memory_order_relaxed);
+        s.contended = counters.contended.load(std::memory_order_relaxed);
+        s.wait = std::chrono::nanoseconds{ counters.waitNs.load(std::memory_order_relaxed) };
+        s.hold = std::chrono::nanoseconds{ counters.holdNs.load(std::memory_order_relaxed) };
+        s.longestHold = std::chrono::nanoseconds{ counters.longestHoldNs.load(std::memory_order_relaxed) };
+        s.longestHoldSite = counters.longestHoldSite.load(std::memory_order_relaxed);
+    }
+    return statistics;
+}
+
+LockAcquirer LockProfiler::_resolve(const LockAcquirer fallback) noexcept
+{
+    return t_acquirer == LockAcquirer::Other ? fallback : t_acquirer;
+}
+
+void LockProfiler::_acquired(const LockAcquirer acquirer, const int64_t waitStart, const int64_t acquired) noexcept
+{
+    auto& counters = til::at(_counters, static_cast<size_t>(acquirer));
+    const auto wait = acquired - waitStart;
+
+    counters.acquisitions.fetch_add(1, std::memory_order_relaxed);
+    counters.waitNs.fetch_add(wait, std::memory_order_relaxed);
+
+    if (wait > contendedWaitNs)
+    {
+        counters.contended.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (wait >= longWaitNs)
+    {
+        const auto holderSite = _lastSite.load(std::memory_order_relaxed);
+        const auto holderAcquirer = _lastAcquirer.load(std::memory_order_relaxed);
+#pragma warning(suppress : 26477 26485 26494 26482 26446 26447) // We don't control TraceLoggingWrite
+        TraceLoggingWrite(g_hLockProfilerProvider,
+                          "LockWait",
+                          TraceLoggingDescription("A thread waited a long time for a lock"),
+                          TraceLoggingString(_name, "Lock"),
+                          TraceLoggingWideString(AcquirerName(acquirer), "Acquirer"),
+                          TraceLoggingInt64(wait / 1000, "WaitUs"),
+                          TraceLoggingWideString(AcquirerName(holderAcquirer), "PreviousAcquirer", "Most likely, the thread that held the lock"),
+                          TraceLoggingPointer(holderSite, "PreviousSite"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+    }
+}
+
+void LockProfiler::_released(const LockAcquirer acquirer, const int64_t since, const void* site) noexcept
+{
+    auto& counters = til::at(_counters, static_cast<size_t>(acquirer));
+    const auto hold = now() - since;
+
+    counters.holdNs.fetch_add(hold, std::memory_order_relaxed);
+
+    // The site is stored separately and may thus belong to a slightly different hold
+    // when two threads of the same kind race here. That's fine for diagnostics.
+    auto longest = counters.longestHoldNs.load(std::memory_order_relaxed);
+    while (hold > longest)
+    {
+        if (counters.longestHoldNs.compare_exchange_weak(longest, hold, std::memory_order_relaxed))
+        {
+            counters.longestHoldSite.store(site, std::memory_order_relaxed);
+            break;
+        }
+    }
+
+    _lastSite.store(site, std::memory_order_relaxed);
+    _lastAcquirer.store(acquirer, std::memory_order_relaxed);
+
+    if (hold >= longHoldNs)
+    {
+#pragma warning(suppress : 26477 26485 26494 26482 26446 26447) // We don't control TraceLoggingWrite
+        TraceLoggingWrite(g_hLockProfilerProvider,
+                          "LockHold",
+                          TraceLoggingDescription("A thread held a lock for a long time"),
+                          TraceLoggingString(_name, "Lock"),
+                          TraceLoggingWideString(AcquirerName(acquirer), "Acquirer"),
+                          TraceLoggingInt64(hold / 1000, "HoldUs"),
+                          TraceLoggingPointer(site, "Site"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+    }
+}
+
+ProfiledSharedMutex::ProfiledSharedMutex(const char* name) noexcept :
+    _profiler{ name }
+{
+}
+
+#pragma warning(push)
+#pragma warning(disable : 26110 26135) // Caller failing to hold lock. The lock is handed to the caller here.
+
+__declspec(noinline) void ProfiledSharedMutex::lock() noexcept
+{
+    lock(_ReturnAddress(), LockAcquirer::Other);
+}
+
+void ProfiledSharedMutex::lock(const void* site, const LockAcquirer fallback) noexcept
+{
+    const auto waitStart = _profiler.BeginWait();
+    _mutex.lock();
+    _profiler.AcquiredExclusive(waitStart, site, fallback);
+}
+
+__declspec(noinline) bool ProfiledSharedMutex::try_lock() noexcept
+{
+    const auto waitStart = _profiler.BeginWait();
+    if (!_mutex.try_lock())
+    {
+        return false;
+    }
+    _profiler.AcquiredExclusive(waitStart, _ReturnAddress());
+    return true;
+}
+
+void ProfiledSharedMutex::unlock() noexcept
+{
+    _profiler.ReleasingExclusive();
+    _mutex.unlock();
+}
+
+__declspec(noinline) void ProfiledSharedMutex::lock_shared() noexcept
+{
+    lock_shared(_ReturnAddress(), LockAcquirer::Other);
+}
+
+void ProfiledSharedMutex::lock_shared(const void* site, const LockAcquirer fallback) noexcept
+{
+    const auto waitStart = _profiler.BeginWait();
+    _mutex.lock_shared();
+    _profiler.AcquiredShared(waitStart, site, fallback);
+}
+
+__declspec(noinline) bool ProfiledSharedMutex::try_lock_shared() noexcept
+{
+    const auto waitStart = _profiler.BeginWait();
+    if (!_mutex.try_lock_shared())
+    {
+        return false;
+    }
+    _profiler.AcquiredShared(waitStart, _ReturnAddress());
+    return true;
+}
+
+void ProfiledSharedMutex::unlock_shared() noexcept
+{
+    _profiler.ReleasingShared();
+    _mutex.unlock_shared();
+}
+
+#pragma warning(pop)
+
+LockProfiler::Statistics ProfiledSharedMutex::GetStatistics() const noexcept
+{
+    return _profiler.GetStatistics();
+}
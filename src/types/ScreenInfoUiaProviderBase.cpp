@@ -223,9 +223,9 @@ IFACEMETHODIMP ScreenInfoUiaProviderBase::GetSelection(_Outptr_result_maybenull_
     RETURN_HR_IF_NULL(E_INVALIDARG, ppRetVal);
     *ppRetVal = nullptr;
 
-    _LockConsole();
+    _LockConsoleForReading();
     auto Unlock = wil::scope_exit([&]() noexcept {
-        _UnlockConsole();
+        _UnlockConsoleForReading();
     });
     RETURN_HR_IF(E_FAIL, !_pData->IsUiaDataInitialized());
 
@@ -273,9 +273,9 @@ IFACEMETHODIMP ScreenInfoUiaProviderBase::GetVisibleRanges(_Outptr_result_mayben
     RETURN_HR_IF_NULL(E_INVALIDARG, ppRetVal);
     *ppRetVal = nullptr;
 
-    _LockConsole();
+    _LockConsoleForReading();
     auto Unlock = wil::scope_exit([&]() noexcept {
-        _UnlockConsole();
+        _UnlockConsoleForReading();
     });
     RETURN_HR_IF(E_FAIL, !_pData->IsUiaDataInitialized());
 
@@ -380,14 +380,15 @@ Viewport ScreenInfoUiaProviderBase::_getViewport() const noexcept
     return _pData->GetViewport();
 }
 
-void ScreenInfoUiaProviderBase::_LockConsole() noexcept
+void ScreenInfoUiaProviderBase::_LockConsoleForReading() noexcept
 {
     // TODO GitHub #2141: Lock and Unlock in conhost should decouple Ctrl+C dispatch and use smarter handling
-    _pData->LockConsole();
+    // GetSelection and GetVisibleRanges only read, so they don't need to block the renderer.
+    _pData->LockConsoleForReading();
 }
 
-void ScreenInfoUiaProviderBase::_UnlockConsole() noexcept
+void ScreenInfoUiaProviderBase::_UnlockConsoleForReading() noexcept
 {
     // TODO GitHub #2141: Lock and Unlock in conhost should decouple Ctrl+C dispatch and use smarter handling
-    _pData->UnlockConsole();
+    _pData->UnlockConsoleForReading();
 }
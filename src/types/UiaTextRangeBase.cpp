@@ -202,9 +202,9 @@ bool UiaTextRangeBase::IsDegenerate() const noexcept
 
 IFACEMETHODIMP UiaTextRangeBase::Compare(_In_opt_ ITextRangeProvider* pRange, _Out_ BOOL* pRetVal) noexcept
 {
-    _pData->LockConsole();
+    _pData->LockConsoleForReading();
     auto Unlock = wil::scope_exit([&]() noexcept {
-        _pData->UnlockConsole();
+        _pData->UnlockConsoleForReading();
     });
 
     RETURN_HR_IF(E_INVALIDARG, pRetVal == nullptr);
@@ -229,9 +229,9 @@ try
     RETURN_HR_IF_NULL(E_INVALIDARG, pRetVal);
     *pRetVal = 0;
 
-    _pData->LockConsole();
+    _pData->LockConsoleForReading();
     auto Unlock = wil::scope_exit([&]() noexcept {
-        _pData->UnlockConsole();
+        _pData->UnlockConsoleForReading();
     });
     RETURN_HR_IF(E_FAIL, !_pData->IsUiaDataInitialized());
 
@@ -451,9 +451,9 @@ try
     RETURN_HR_IF(E_INVALIDARG, ppRetVal == nullptr);
     *ppRetVal = nullptr;
 
-    _pData->LockConsole();
+    _pData->LockConsoleForReading();
     auto Unlock = wil::scope_exit([&]() noexcept {
-        _pData->UnlockConsole();
+        _pData->UnlockConsoleForReading();
     });
     RETURN_HR_IF(E_FAIL, !_pData->IsUiaDataInitialized());
 
@@ -564,27 +564,36 @@ try
         const auto height{ std::abs(inclusiveEnd.Y - _start.Y + 1) };
         viewportRange = Viewport::FromDimensions({ originX, originY }, width, height);
     }
-    auto iter{ buffer.GetCellDataAt(searchStart, viewportRange) };
-    const auto iterStep{ searchBackwards ? -1 : 1 };
-    for (; iter && iter.Pos() != searchEndExclusive; iter += iterStep)
+    if (!_blockRange)
     {
-        if (!attemptUpdateAnchors(iter) && resultFirstAnchor.has_value() && resultSecondAnchor.has_value())
+        // Ranges that aren't blocks span entire rows (except for the first and last one),
+        // so we can check each run of identical attributes once, instead of every cell.
+        _findAttributeInRuns(attributeId, val, searchBackwards, searchStart, searchEndInclusive, resultFirstAnchor, resultSecondAnchor);
+    }
+    else
+    {
+        auto iter{ buffer.GetCellDataAt(searchStart, viewportRange) };
+        const auto iterStep{ searchBackwards ? -1 : 1 };
+        for (; iter && iter.Pos() != searchEndExclusive; iter += iterStep)
         {
-            // Exit the loop early if...
-            // - the cell we're looking at doesn't have the attr we're looking for
-            // - the anchors have been populated
-            // This means that we've found a contiguous range where the text attribute was found.
-            // No point in searching through the rest of the search space.
-            // TLDR: keep updating the second anchor and make the range wider until the attribute changes.
-            break;
+            if (!attemptUpdateAnchors(iter) && resultFirstAnchor.has_value() && resultSecondAnchor.has_value())
+            {
+                // Exit the loop early if...
+                // - the cell we're looking at doesn't have the attr we're looking for
+                // - the anchors have been populated
+                // This means that we've found a contiguous range where the text attribute was found.
+                // No point in searching through the rest of the search space.
+                // TLDR: keep updating the second anchor and make the range wider until the attribute changes.
+                break;
+            }
         }
-    }
 
-    // Corner case: we couldn't actually move the searchEnd to make it exclusive
-    // (i.e. DecrementInBounds on Origin doesn't move it)
-    if (searchEndInclusive == searchEndExclusive)
-    {
-        attemptUpdateAnchors(iter);
+        // Corner case: we couldn't actually move the searchEnd to make it exclusive
+        // (i.e. DecrementInBounds on Origin doesn't move it)
+        if (searchEndInclusive == searchEndExclusive)
+        {
+            attemptUpdateAnchors(iter);
+        }
     }
 
     // If a result was found, populate ppRetVal with the UiaTextRange
@@ -610,6 +619,109 @@ try
 }
 CATCH_RETURN();
 
+// Method Description:
+// - Helper method for FindAttribute() for ranges that aren't blocks. Finds the first
+//   contiguous run of cells between searchStart and searchEnd (both inclusive) that
+//   have the given attribute, in the direction of the search.
+// - Instead of visiting each cell, this checks each run of identical attributes
+//   in the ATTR_ROW of each row once.
+// Arguments:
+// - attributeId - the UIA text attribute identifier we're looking for
+// - val - the attributeId's sub-type we're looking for
+// - searchBackwards - if true, the search goes from searchStart back to searchEnd
+// - searchStart - the first cell to look at
+// - searchEnd - the last cell to look at
+// - firstAnchor - receives the first cell with the attribute we came across
+// - secondAnchor - receives the last cell with the attribute we came across
+// Return Value:
+// - <none>
+void UiaTextRangeBase::_findAttributeInRuns(TEXTATTRIBUTEID attributeId,
+                                            VARIANT val,
+                                            const bool searchBackwards,
+                                            const til::point searchStart,
+                                            const til::point searchEnd,
+                                            std::optional<til::point>& firstAnchor,
+                                            std::optional<til::point>& secondAnchor) const
+{
+    // Degenerate ranges don't contain any cells.
+    if (searchBackwards ? searchEnd > searchStart : searchStart > searchEnd)
+    {
+        return;
+    }
+
+    const auto& buffer{ _pData->GetTextBuffer() };
+    const auto rowStep{ searchBackwards ? -1 : 1 };
+
+    // Returns false once the found range has ended and the search is over.
+    const auto visitRun = [&](const til::CoordType y, const til::CoordType begin, const til::CoordType end, const TextAttribute& attr) {
+        if (_verifyAttr(attributeId, val, attr).value())
+        {
+            const til::point nearPos{ searchBackwards ? end : begin, y };
+            const til::point farPos{ searchBackwards ? begin : end, y };
+            if (!firstAnchor.has_value())
+            {
+                firstAnchor = nearPos;
+            }
+            secondAnchor = farPos;
+            return true;
+        }
+        return !firstAnchor.has_value();
+    };
+
+    for (auto y = searchStart.Y;; y += rowStep)
+    {
+        // The columns [left, right] of this row are part of the search.
+        const auto& row = buffer.GetRowByOffset(y);
+        const auto width = row.size();
+        const auto isStartRow = y == searchStart.Y;
+        const auto isEndRow = y == searchEnd.Y;
+        const auto left = searchBackwards ? (isEndRow ? searchEnd.X : 0) : (isStartRow ? searchStart.X : 0);
+        const auto right = searchBackwards ? (isStartRow ? searchStart.X : width - 1) : (isEndRow ? searchEnd.X : width - 1);
+
+        const auto& attrRow = row.GetAttrRow();
+        const auto& runs = attrRow.GetRuns();
+
+        // Clip each run to [left, right] and skip the ones outside of it.
+        const auto clipRun = [&](const til::CoordType runBegin, const til::CoordType runEnd, const auto& run) {
+            const auto begin = std::max(runBegin, left);
+            const auto end = std::min(runEnd - 1, right);
+            return begin > end || visitRun(y, begin, end, attrRow.GetAttrById(run.value));
+        };
+
+        if (searchBackwards)
+        {
+            auto runEnd = width;
+            for (auto it = runs.rbegin(); it != runs.rend() && runEnd > left; ++it)
+            {
+                const auto runBegin = runEnd - gsl::narrow_cast<til::CoordType>(it->length);
+                if (!clipRun(runBegin, runEnd, *it))
+                {
+                    return;
+                }
+                runEnd = runBegin;
+            }
+        }
+        else
+        {
+            til::CoordType runBegin = 0;
+            for (auto it = runs.begin(); it != runs.end() && runBegin <= right; ++it)
+            {
+                const auto runEnd = runBegin + gsl::narrow_cast<til::CoordType>(it->length);
+                if (!clipRun(runBegin, runEnd, *it))
+                {
+                    return;
+                }
+                runBegin = runEnd;
+            }
+        }
+
+        if (isEndRow)
+        {
+            return;
+        }
+    }
+}
+
 IFACEMETHODIMP UiaTextRangeBase::FindText(_In_ BSTR text,
                                           _In_ BOOL searchBackward,
                                           _In_ BOOL ignoreCase,
@@ -619,9 +731,9 @@ try
     RETURN_HR_IF(E_INVALIDARG, ppRetVal == nullptr);
     *ppRetVal = nullptr;
 
-    _pData->LockConsole();
+    _pData->LockConsoleForReading();
     auto Unlock = wil::scope_exit([&]() noexcept {
-        _pData->UnlockConsole();
+        _pData->UnlockConsoleForReading();
     });
     RETURN_HR_IF(E_FAIL, !_pData->IsUiaDataInitialized());
 
@@ -750,9 +862,9 @@ try
     RETURN_HR_IF(E_INVALIDARG, pRetVal == nullptr);
     VariantInit(pRetVal);
 
-    _pData->LockConsole();
+    _pData->LockConsoleForReading();
     auto Unlock = wil::scope_exit([&]() noexcept {
-        _pData->UnlockConsole();
+        _pData->UnlockConsoleForReading();
     });
     RETURN_HR_IF(E_FAIL, !_pData->IsUiaDataInitialized());
 
@@ -847,9 +959,9 @@ IFACEMETHODIMP UiaTextRangeBase::GetBoundingRectangles(_Outptr_result_maybenull_
     RETURN_HR_IF(E_INVALIDARG, ppRetVal == nullptr);
     *ppRetVal = nullptr;
 
-    _pData->LockConsole();
+    _pData->LockConsoleForReading();
     auto Unlock = wil::scope_exit([&]() noexcept {
-        _pData->UnlockConsole();
+        _pData->UnlockConsoleForReading();
     });
     RETURN_HR_IF(E_FAIL, !_pData->IsUiaDataInitialized());
 
@@ -958,15 +1070,18 @@ try
     RETURN_HR_IF(E_INVALIDARG, maxLength < -1);
     *pRetVal = nullptr;
 
-    _pData->LockConsole();
+    _pData->LockConsoleForReading();
     auto Unlock = wil::scope_exit([&]() noexcept {
-        _pData->UnlockConsole();
+        _pData->UnlockConsoleForReading();
     });
     RETURN_HR_IF(E_FAIL, !_pData->IsUiaDataInitialized());
 
-    const auto text = _getTextValue(maxLength);
+    // The lock is only needed to copy the rows. Their text is assembled without it.
+    const auto snapshot = _snapshotTextValue();
     Unlock.reset();
 
+    const auto text = _getTextValue(snapshot, maxLength);
+
     *pRetVal = SysAllocString(text.c_str());
     RETURN_HR_IF_NULL(E_OUTOFMEMORY, *pRetVal);
 
@@ -981,11 +1096,21 @@ CATCH_RETURN();
 // - maxLength - the maximum size of the retrieved text. nullopt means we don't care about the size.
 // Return Value:
 // - the text that the UiaTextRange encompasses
+std::wstring UiaTextRangeBase::_getTextValue(til::CoordType maxLength) const
+{
+    return _getTextValue(_snapshotTextValue(), maxLength);
+}
+
+// Method Description:
+// - Helper method for GetText(). Takes a snapshot of the rows that the UiaTextRange
+//   encompasses. The console lock must be held, but only while this runs.
+// Return Value:
+// - the rows and the columns of each of them that the UiaTextRange encompasses
 #pragma warning(push)
 #pragma warning(disable : 26447) // compiler isn't filtering throws inside the try/catch
-std::wstring UiaTextRangeBase::_getTextValue(til::CoordType maxLength) const
+UiaTextRangeBase::TextSnapshot UiaTextRangeBase::_snapshotTextValue() const
 {
-    std::wstring textData{};
+    TextSnapshot snapshot;
     if (!IsDegenerate())
     {
         const auto& buffer = _pData->GetTextBuffer();
@@ -1003,16 +1128,47 @@ std::wstring UiaTextRangeBase::_getTextValue(til::CoordType maxLength) const
         auto inclusiveEnd = _end;
         bufferSize.DecrementInBounds(inclusiveEnd, true);
 
-        const auto textRects = buffer.GetTextRects(_start, inclusiveEnd, _blockRange, true);
-        const auto bufferData = buffer.GetText(true,
-                                               false,
-                                               textRects);
+        // UIA clients tend to ask for the same rows over and over again, which is
+        // why GetRowSnapshot keeps the snapshots around until their row changes.
+        snapshot.rects = buffer.GetTextRects(_start, inclusiveEnd, _blockRange, true);
+        snapshot.rows.reserve(snapshot.rects.size());
+        for (const auto& rect : snapshot.rects)
+        {
+            snapshot.rows.emplace_back(buffer.GetRowSnapshot(rect.Top));
+        }
+    }
+    return snapshot;
+}
+#pragma warning(pop)
 
-        const size_t textDataSize = bufferData.text.size() * bufferSize.Width();
-        textData.reserve(textDataSize);
-        for (const auto& text : bufferData.text)
+// Method Description:
+// - Helper method for GetText(). Assembles the text of a snapshot taken by _snapshotTextValue().
+//   This produces the same text as TextBuffer::GetText(true, false, textRects), but doesn't
+//   access the buffer and can thus be called without holding the console lock.
+// Arguments:
+// - snapshot - the rows that the UiaTextRange encompasses
+// - maxLength - the maximum size of the retrieved text. nullopt means we don't care about the size.
+// Return Value:
+// - the text that the UiaTextRange encompasses
+std::wstring UiaTextRangeBase::_getTextValue(const TextSnapshot& snapshot, til::CoordType maxLength)
+{
+    std::wstring textData{};
+    const auto& textRects = snapshot.rects;
+    for (size_t i = 0; i < textRects.size(); ++i)
+    {
+        const auto& rect = til::at(textRects, i);
+        const auto& row = *til::at(snapshot.rows, i);
+        if (i == 0)
         {
-            textData += text;
+            textData.reserve(textRects.size() * (gsl::narrow_cast<size_t>(row.size()) + 2));
+        }
+        textData += row.GetText(rect.Left, rect.Right + 1);
+
+        // Rows that were wrapped by the terminal continue on the next line.
+        if (i + 1 < textRects.size() && !row.WasWrapForced())
+        {
+            textData.push_back(UNICODE_CARRIAGERETURN);
+            textData.push_back(UNICODE_LINEFEED);
         }
     }
 
@@ -1023,7 +1179,6 @@ std::wstring UiaTextRangeBase::_getTextValue(til::CoordType maxLength) const
 
     return textData;
 }
-#pragma warning(pop)
 
 IFACEMETHODIMP UiaTextRangeBase::Move(_In_ TextUnit unit,
                                       _In_ int count,
@@ -144,6 +144,17 @@ namespace Microsoft::Console::Types
         // GetText() cannot be used as it's not const
         std::wstring _getTextValue(til::CoordType maxLength = -1) const;
 
+        // The rows that the UiaTextRange encompasses and the columns of each of them,
+        // so that GetText() can assemble the text without holding the console lock.
+        struct TextSnapshot
+        {
+            std::vector<til::inclusive_rect> rects;
+            // The row of each of the rects.
+            std::vector<std::shared_ptr<const RowSnapshot>> rows;
+        };
+        TextSnapshot _snapshotTextValue() const;
+        static std::wstring _getTextValue(const TextSnapshot& snapshot, til::CoordType maxLength);
+
         til::rect _getTerminalRect() const;
 
         virtual til::size _getScreenFontSize() const noexcept;
@@ -181,6 +192,13 @@ namespace Microsoft::Console::Types
                                     _In_ const bool preventBoundary = false) noexcept;
 
         std::optional<bool> _verifyAttr(TEXTATTRIBUTEID attributeId, VARIANT val, const TextAttribute& attr) const;
+        void _findAttributeInRuns(TEXTATTRIBUTEID attributeId,
+                                  VARIANT val,
+                                  const bool searchBackwards,
+                                  const til::point searchStart,
+                                  const til::point searchEnd,
+                                  std::optional<til::point>& firstAnchor,
+                                  std::optional<til::point>& secondAnchor) const;
         bool _initializeAttrQuery(TEXTATTRIBUTEID attributeId, VARIANT* pRetVal, const TextAttribute& attr) const;
         bool _tryMoveToWordStart(const TextBuffer& buffer, const til::point documentEnd, til::point& resultingPos) const;
 
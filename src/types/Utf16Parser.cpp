@@ -65,27 +65,9 @@ std::wstring_view Utf16Parser::ParseNext(std::wstring_view wstr) noexcept
 std::vector<std::vector<wchar_t>> Utf16Parser::Parse(std::wstring_view wstr)
 {
     std::vector<std::vector<wchar_t>> result;
-    std::vector<wchar_t> sequence;
-    for (const auto wch : wstr)
+    for (const auto glyph : Glyphs{ wstr })
     {
-        if (IsLeadingSurrogate(wch))
-        {
-            sequence.clear();
-            sequence.push_back(wch);
-        }
-        else if (IsTrailingSurrogate(wch))
-        {
-            if (!sequence.empty())
-            {
-                sequence.push_back(wch);
-                result.push_back(sequence);
-                sequence.clear();
-            }
-        }
-        else
-        {
-            result.push_back({ wch });
-        }
+        result.emplace_back(glyph.begin(), glyph.end());
     }
     return result;
 }
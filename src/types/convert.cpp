@@ -164,6 +164,55 @@ CodepointWidth GetQuickCharWidth(const wchar_t wch) noexcept
     return CodepointWidth::Invalid;
 }
 
+// Routine Description:
+// - Counts the leading printable ASCII characters (U+0020 to U+007E) in the given text.
+// - These are exactly the characters GetQuickCharWidth() considers narrow.
+// Arguments:
+// - text - The text to scan
+// Return Value:
+// - The number of characters before the first one that isn't printable ASCII.
+size_t CountPrintableAscii(const std::wstring_view text) noexcept
+{
+    size_t count = 0;
+
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+#if _M_AMD64
+    // Check 8 characters at a time whether (wch - 0x20) <= 0x5e, which is the
+    // same as 0x20 <= wch <= 0x7e. SSE2 lacks unsigned 16-bit comparisons,
+    // but a saturating subtraction of 0x5e results in 0 for exactly those.
+    const auto offset = _mm_set1_epi16(0x20);
+    const auto limit = _mm_set1_epi16(0x5e);
+    const auto zero = _mm_setzero_si128();
+    for (; count + 8 <= text.size(); count += 8)
+    {
+        const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + count));
+        const auto outOfRange = _mm_subs_epu16(_mm_sub_epi16(chars, offset), limit);
+        const auto mask = _mm_movemask_epi8(_mm_cmpeq_epi16(outOfRange, zero));
+        if (mask != 0xffff)
+        {
+            // Every character contributes 2 bits to the mask.
+            unsigned long index;
+            _BitScanForward(&index, static_cast<unsigned long>(~mask));
+            return count + index / 2;
+        }
+    }
+#endif
+#pragma warning(pop)
+
+    for (; count < text.size(); ++count)
+    {
+        const auto wch = til::at(text, count);
+        if (wch < 0x20 || wch > 0x7e)
+        {
+            break;
+        }
+    }
+
+    return count;
+}
+
 wchar_t Utf16ToUcs2(const std::wstring_view charData)
 {
     THROW_HR_IF(E_INVALIDARG, charData.empty());
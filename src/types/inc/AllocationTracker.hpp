@@ -0,0 +1,133 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- AllocationTracker.hpp
+
+Abstract:
+- AllocationTracker counts the heap allocations that happen within the hot
+  stages of the console: parsing a string of output, printing it into the
+  buffer, painting a frame and translating an input event. Each stage has a
+  budget of allocations per scope and an overrun is reported to the debugger,
+  so that a change that makes the ASCII print path or a steady-state frame
+  allocate is noticed the moment it's run rather than in a profile months later.
+- Counting uses the allocation hook of the debug CRT, which is why tracking is
+  only compiled into debug builds (see CON_TRACK_ALLOCATIONS). In release builds
+  a Scope is an empty object and the tracker costs nothing. Allocations that
+  bypass the CRT, like HeapAlloc or the ones made by other modules with their
+  own CRT, aren't counted.
+--*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <string_view>
+
+#ifndef CON_TRACK_ALLOCATIONS
+#ifdef _DEBUG
+#define CON_TRACK_ALLOCATIONS 1
+#else
+#define CON_TRACK_ALLOCATIONS 0
+#endif
+#endif
+
+namespace Microsoft::Console::Types
+{
+    enum class AllocationStage : uint8_t
+    {
+        // StateMachine::ProcessString, including everything it dispatches.
+        ProcessString,
+        // Printing text that needs more than the ASCII fast path.
+        Print,
+        // Printing text that only consists of printable ASCII.
+        AsciiPrint,
+        // A frame that painted content which changed since the engine's last frame.
+        Frame,
+        // A frame without such changes, like the ones that blink the cursor.
+        SteadyFrame,
+        // TerminalInput translating a key event into a sequence.
+        InputEvent,
+    };
+    inline constexpr size_t AllocationStageCount = 6;
+
+    class AllocationTracker
+    {
+    public:
+        static constexpr size_t Unlimited = SIZE_MAX;
+
+        struct StageStatistics
+        {
+            uint64_t scopes = 0;
+            uint64_t allocations = 0;
+            uint64_t maxPerScope = 0;
+            // The scopes that made more allocations than the budget allowed.
+            uint64_t overBudget = 0;
+        };
+        using Statistics = std::array<StageStatistics, AllocationStageCount>;
+
+#if CON_TRACK_ALLOCATIONS
+        // Counts the allocations the calling thread makes during its lifetime
+        // against the budget of the stage. Scopes may be nested.
+        class Scope
+        {
+        public:
+            explicit Scope(const AllocationStage stage) noexcept;
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            AllocationStage _stage;
+            uint64_t _start;
+        };
+#else
+        class Scope
+        {
+        public:
+            explicit constexpr Scope(const AllocationStage) noexcept {}
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+        };
+#endif
+
+        static constexpr bool IsEnabled() noexcept
+        {
+            return CON_TRACK_ALLOCATIONS != 0;
+        }
+
+        // Returns true if the string consists of printable ASCII only, which is what
+        // the AsciiPrint stage covers. Always false if tracking is compiled out, so
+        // that release builds don't scan the string just to pick a stage.
+        static constexpr bool IsAsciiPrint(const std::wstring_view string) noexcept
+        {
+#if CON_TRACK_ALLOCATIONS
+            for (const auto ch : string)
+            {
+                if (ch < L' ' || ch > L'~')
+                {
+                    return false;
+                }
+            }
+            return !string.empty();
+#else
+            (void)string;
+            return false;
+#endif
+        }
+
+        static void SetBudget(const AllocationStage stage, const size_t allocations) noexcept;
+        static size_t GetBudget(const AllocationStage stage) noexcept;
+        // Overruns are always reported as debug output. Once enabled, the first
+        // overrun of each stage additionally raises an assertion. The applications
+        // enable this, while tests that exercise the slow paths don't.
+        static void AssertOnOverBudget(const bool enable) noexcept;
+        static const wchar_t* StageName(const AllocationStage stage) noexcept;
+
+        static Statistics GetStatistics() noexcept;
+        static void ResetStatistics() noexcept;
+    };
+}
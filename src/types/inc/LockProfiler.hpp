@@ -0,0 +1,146 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- LockProfiler.hpp
+
+Abstract:
+- LockProfiler records how long the acquirers of a lock waited for it and how
+  long they held it, for each kind of thread that takes it, as well as the
+  call site of the longest hold. Lock convoys between the output, the renderer,
+  UIA and the UI thread are otherwise only visible in a kernel trace.
+- Profiling costs two timestamps per acquisition and is thus only done while
+  someone is interested: the performance overlay (see EnableProfiling) or a
+  trace session of the Microsoft.Windows.Console.Locks provider, which gets
+  an event for every long wait and every long hold.
+- ProfiledSharedMutex is a std::shared_mutex with a LockProfiler.
+--*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <shared_mutex>
+// For _ReturnAddress(), which callers use as the site of an acquisition.
+#include <intrin.h>
+
+namespace Microsoft::Console::Types
+{
+    enum class LockAcquirer : uint8_t
+    {
+        // Threads that didn't declare what they are, like the API threads of conhost.
+        Other,
+        Render,
+        // The thread that writes the output of the connection into the buffer.
+        Output,
+        Ui,
+        Uia,
+        // The search for patterns like URLs in the visible part of the buffer.
+        Patterns,
+    };
+    inline constexpr size_t LockAcquirerCount = 6;
+
+    class LockProfiler
+    {
+    public:
+        struct AcquirerStatistics
+        {
+            uint64_t acquisitions = 0;
+            // The acquisitions that had to wait for another thread.
+            uint64_t contended = 0;
+            std::chrono::nanoseconds wait{};
+            std::chrono::nanoseconds hold{};
+            std::chrono::nanoseconds longestHold{};
+            // The return address of the call that acquired the lock for longestHold.
+            const void* longestHoldSite = nullptr;
+        };
+        using Statistics = std::array<AcquirerStatistics, LockAcquirerCount>;
+
+        // Temporarily changes what the calling thread counts as, for
+        // work that runs on threads that are shared with other work.
+        class ScopedAcquirer
+        {
+        public:
+            explicit ScopedAcquirer(const LockAcquirer acquirer) noexcept;
+            ~ScopedAcquirer();
+
+            ScopedAcquirer(const ScopedAcquirer&) = delete;
+            ScopedAcquirer& operator=(const ScopedAcquirer&) = delete;
+
+        private:
+            LockAcquirer _previous;
+        };
+
+        explicit LockProfiler(const char* name) noexcept;
+
+        static void SetThreadAcquirer(const LockAcquirer acquirer) noexcept;
+        static LockAcquirer GetThreadAcquirer() noexcept;
+        // Calls must be balanced. Profiling stays on as long as anyone enabled it.
+        static void EnableProfiling(const bool enable) noexcept;
+        static bool IsProfiling() noexcept;
+        static const wchar_t* AcquirerName(const LockAcquirer acquirer) noexcept;
+        static std::wstring FormatSite(const void* site);
+
+        // To be called right before and after acquiring the lock. BeginWait() returns 0 if
+        // profiling is disabled, which the Acquired functions then ignore. `fallback` is
+        // what threads count as that didn't declare what they are.
+        int64_t BeginWait() const noexcept;
+        void AcquiredExclusive(const int64_t waitStart, const void* site, const LockAcquirer fallback = LockAcquirer::Other) noexcept;
+        void ReleasingExclusive() noexcept;
+        void AcquiredShared(const int64_t waitStart, const void* site, const LockAcquirer fallback = LockAcquirer::Other) noexcept;
+        void ReleasingShared() noexcept;
+
+        Statistics GetStatistics() const noexcept;
+
+    private:
+        struct Counters
+        {
+            std::atomic<uint64_t> acquisitions{ 0 };
+            std::atomic<uint64_t> contended{ 0 };
+            std::atomic<int64_t> waitNs{ 0 };
+            std::atomic<int64_t> holdNs{ 0 };
+            std::atomic<int64_t> longestHoldNs{ 0 };
+            std::atomic<const void*> longestHoldSite{ nullptr };
+        };
+
+        static LockAcquirer _resolve(const LockAcquirer fallback) noexcept;
+        void _acquired(const LockAcquirer acquirer, const int64_t waitStart, const int64_t now) noexcept;
+        void _released(const LockAcquirer acquirer, const int64_t since, const void* site) noexcept;
+
+        const char* _name;
+        std::array<Counters, LockAcquirerCount> _counters;
+
+        // The current exclusive holder. Only the holder accesses these.
+        int64_t _exclusiveSince = 0;
+        const void* _exclusiveSite = nullptr;
+        LockAcquirer _exclusiveAcquirer = LockAcquirer::Other;
+
+        // The most recent acquirer, which a contended acquisition was most likely waiting for.
+        std::atomic<const void*> _lastSite{ nullptr };
+        std::atomic<LockAcquirer> _lastAcquirer{ LockAcquirer::Other };
+    };
+
+    class ProfiledSharedMutex
+    {
+    public:
+        explicit ProfiledSharedMutex(const char* name) noexcept;
+
+        // The overloads without a site use the return address instead.
+        void lock() noexcept;
+        void lock(const void* site, const LockAcquirer fallback) noexcept;
+        bool try_lock() noexcept;
+        void unlock() noexcept;
+        void lock_shared() noexcept;
+        void lock_shared(const void* site, const LockAcquirer fallback) noexcept;
+        bool try_lock_shared() noexcept;
+        void unlock_shared() noexcept;
+
+        LockProfiler::Statistics GetStatistics() const noexcept;
+
+    private:
+        std::shared_mutex _mutex;
+        LockProfiler _profiler;
+    };
+}
@@ -14,11 +14,14 @@ Author(s):
 
 #pragma once
 
+#include <iterator>
 #include <vector>
 
 class Utf16Parser final
 {
 public:
+    class Glyphs;
+
     static std::vector<std::vector<wchar_t>> Parse(std::wstring_view wstr);
     static std::wstring_view ParseNext(std::wstring_view wstr) noexcept;
 
@@ -44,3 +47,107 @@ public:
         return wch >= 0xDC00 && wch <= 0xDFFF;
     }
 };
+
+// A range over the codepoints of a utf16 encoded string, each of which is
+// returned as a view into the string. Just like Parse(), surrogate pairs are
+// grouped together and badly formatted leading/trailing chars are dropped,
+// but no memory is allocated. Use it like this:
+//   for (const auto glyph : Utf16Parser::Glyphs{ text }) { ... }
+class Utf16Parser::Glyphs final
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::wstring_view;
+        using difference_type = ptrdiff_t;
+        using pointer = const std::wstring_view*;
+        using reference = const std::wstring_view&;
+
+        constexpr iterator() noexcept = default;
+
+        constexpr explicit iterator(const std::wstring_view remaining) noexcept :
+            _remaining{ remaining }
+        {
+            _seek();
+        }
+
+        constexpr reference operator*() const noexcept
+        {
+            return _glyph;
+        }
+
+        constexpr pointer operator->() const noexcept
+        {
+            return &_glyph;
+        }
+
+        constexpr iterator& operator++() noexcept
+        {
+            _remaining.remove_prefix(_glyph.size());
+            _seek();
+            return *this;
+        }
+
+        constexpr iterator operator++(int) noexcept
+        {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        constexpr bool operator==(const iterator& rhs) const noexcept
+        {
+            return _remaining.data() == rhs._remaining.data() && _remaining.size() == rhs._remaining.size();
+        }
+
+        constexpr bool operator!=(const iterator& rhs) const noexcept
+        {
+            return !(*this == rhs);
+        }
+
+    private:
+        // Skips over unpaired surrogates and points _glyph at the next codepoint.
+        constexpr void _seek() noexcept
+        {
+            while (!_remaining.empty())
+            {
+                const auto wch = _remaining.front();
+                if (!IsLeadingSurrogate(wch) && !IsTrailingSurrogate(wch))
+                {
+                    _glyph = _remaining.substr(0, 1);
+                    return;
+                }
+                if (IsLeadingSurrogate(wch) && _remaining.size() > 1 && IsTrailingSurrogate(_remaining[1]))
+                {
+                    _glyph = _remaining.substr(0, 2);
+                    return;
+                }
+                _remaining.remove_prefix(1);
+            }
+            _glyph = {};
+        }
+
+        std::wstring_view _remaining;
+        std::wstring_view _glyph;
+    };
+
+    constexpr explicit Glyphs(const std::wstring_view text) noexcept :
+        _text{ text }
+    {
+    }
+
+    constexpr iterator begin() const noexcept
+    {
+        return iterator{ _text };
+    }
+
+    constexpr iterator end() const noexcept
+    {
+        return iterator{ _text.substr(_text.size()) };
+    }
+
+private:
+    std::wstring_view _text;
+};
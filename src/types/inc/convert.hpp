@@ -35,5 +35,6 @@ enum class CodepointWidth : BYTE
                                      const std::wstring_view source);
 
 CodepointWidth GetQuickCharWidth(const wchar_t wch) noexcept;
+size_t CountPrintableAscii(const std::wstring_view text) noexcept;
 
 wchar_t Utf16ToUcs2(const std::wstring_view charData);
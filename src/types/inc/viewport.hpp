@@ -40,14 +40,48 @@ namespace Microsoft::Console::Types
 
         static Viewport FromCoord(const til::point origin) noexcept;
 
-        til::CoordType Left() const noexcept;
-        til::CoordType RightInclusive() const noexcept;
-        til::CoordType RightExclusive() const noexcept;
-        til::CoordType Top() const noexcept;
-        til::CoordType BottomInclusive() const noexcept;
-        til::CoordType BottomExclusive() const noexcept;
-        til::CoordType Height() const noexcept;
-        til::CoordType Width() const noexcept;
+        // These are called for every cell by the search, selection and UIA code,
+        // so they're defined here where they can be inlined.
+        constexpr til::CoordType Left() const noexcept
+        {
+            return _sr.Left;
+        }
+
+        constexpr til::CoordType RightInclusive() const noexcept
+        {
+            return _sr.Right;
+        }
+
+        constexpr til::CoordType RightExclusive() const noexcept
+        {
+            return _sr.Right + 1;
+        }
+
+        constexpr til::CoordType Top() const noexcept
+        {
+            return _sr.Top;
+        }
+
+        constexpr til::CoordType BottomInclusive() const noexcept
+        {
+            return _sr.Bottom;
+        }
+
+        constexpr til::CoordType BottomExclusive() const noexcept
+        {
+            return _sr.Bottom + 1;
+        }
+
+        constexpr til::CoordType Height() const noexcept
+        {
+            return BottomExclusive() - Top();
+        }
+
+        constexpr til::CoordType Width() const noexcept
+        {
+            return RightExclusive() - Left();
+        }
+
         til::point Origin() const noexcept;
         til::point BottomRightInclusive() const noexcept;
         til::point BottomRightExclusive() const noexcept;
@@ -55,7 +89,25 @@ namespace Microsoft::Console::Types
         til::size Dimensions() const noexcept;
 
         bool IsInBounds(const Viewport& other) const noexcept;
-        bool IsInBounds(const til::point pos, bool allowEndExclusive = false) const noexcept;
+        // Method Description:
+        // - Determines if the given coordinate position lies within this viewport.
+        // Arguments:
+        // - pos - Coordinate position
+        // - allowEndExclusive - if true, allow the EndExclusive til::point as a valid position.
+        //                        Used in accessibility to signify that the exclusive end
+        //                        includes the last til::point in a given viewport.
+        // Return Value:
+        // - True if it lies inside the viewport. False otherwise.
+        constexpr bool IsInBounds(const til::point pos, bool allowEndExclusive = false) const noexcept
+        {
+            if (allowEndExclusive && pos.X == Left() && pos.Y == BottomExclusive())
+            {
+                return true;
+            }
+
+            return pos.X >= Left() && pos.X < RightExclusive() &&
+                   pos.Y >= Top() && pos.Y < BottomExclusive();
+        }
 
         void Clamp(til::point& pos) const;
         Viewport Clamp(const Viewport& other) const noexcept;
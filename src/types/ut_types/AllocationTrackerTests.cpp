@@ -0,0 +1,82 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../inc/AllocationTracker.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Console::Types;
+
+class AllocationTrackerTests
+{
+    TEST_CLASS(AllocationTrackerTests);
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        AllocationTracker::SetBudget(AllocationStage::InputEvent, AllocationTracker::Unlimited);
+        AllocationTracker::ResetStatistics();
+        return true;
+    }
+
+    TEST_METHOD(HotPathsHaveNoBudget)
+    {
+        VERIFY_ARE_EQUAL(size_t{ 0 }, AllocationTracker::GetBudget(AllocationStage::AsciiPrint));
+        VERIFY_ARE_EQUAL(size_t{ 0 }, AllocationTracker::GetBudget(AllocationStage::SteadyFrame));
+        VERIFY_ARE_EQUAL(AllocationTracker::Unlimited, AllocationTracker::GetBudget(AllocationStage::Frame));
+    }
+
+    TEST_METHOD(CountsAllocationsInScope)
+    {
+        AllocationTracker::ResetStatistics();
+        AllocationTracker::SetBudget(AllocationStage::InputEvent, 1);
+
+        {
+            const AllocationTracker::Scope scope{ AllocationStage::InputEvent };
+            const auto value = std::make_unique<int>(42);
+            VERIFY_ARE_EQUAL(42, *value);
+        }
+        {
+            const AllocationTracker::Scope scope{ AllocationStage::InputEvent };
+            const auto first = std::make_unique<int>(1);
+            const auto second = std::make_unique<int>(2);
+            VERIFY_ARE_EQUAL(3, *first + *second);
+        }
+        // Allocations outside of a scope don't count.
+        const auto outside = std::make_unique<int>(3);
+
+        const auto stage = AllocationTracker::GetStatistics()[static_cast<size_t>(AllocationStage::InputEvent)];
+        if constexpr (AllocationTracker::IsEnabled())
+        {
+            VERIFY_ARE_EQUAL(2ull, stage.scopes);
+            VERIFY_ARE_EQUAL(3ull, stage.allocations);
+            VERIFY_ARE_EQUAL(2ull, stage.maxPerScope);
+            VERIFY_ARE_EQUAL(1ull, stage.overBudget);
+        }
+        else
+        {
+            VERIFY_ARE_EQUAL(0ull, stage.scopes);
+            VERIFY_ARE_EQUAL(0ull, stage.allocations);
+        }
+    }
+
+    TEST_METHOD(RecognizesAsciiPrint)
+    {
+        if constexpr (AllocationTracker::IsEnabled())
+        {
+            VERIFY_IS_TRUE(AllocationTracker::IsAsciiPrint(L"Hello, World!"));
+            VERIFY_IS_FALSE(AllocationTracker::IsAsciiPrint(L"Hello\r\n"));
+            VERIFY_IS_FALSE(AllocationTracker::IsAsciiPrint(L"Gr\u00fc\u00dfe"));
+            VERIFY_IS_FALSE(AllocationTracker::IsAsciiPrint(L""));
+        }
+        else
+        {
+            VERIFY_IS_FALSE(AllocationTracker::IsAsciiPrint(L"Hello, World!"));
+        }
+    }
+};
@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../inc/LockProfiler.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Console::Types;
+
+class LockProfilerTests
+{
+    TEST_CLASS(LockProfilerTests);
+
+    TEST_METHOD(CountsNothingWhileDisabled)
+    {
+        ProfiledSharedMutex mutex{ "Test" };
+        mutex.lock();
+        mutex.unlock();
+        mutex.lock_shared();
+        mutex.unlock_shared();
+
+        // A trace session of the provider would enable the profiler as well.
+        if (!LockProfiler::IsProfiling())
+        {
+            for (const auto& acquirer : mutex.GetStatistics())
+            {
+                VERIFY_ARE_EQUAL(0ull, acquirer.acquisitions);
+            }
+        }
+    }
+
+    TEST_METHOD(CountsByThreadAcquirer)
+    {
+        LockProfiler::EnableProfiling(true);
+        const auto disable = wil::scope_exit([]() noexcept { LockProfiler::EnableProfiling(false); });
+
+        ProfiledSharedMutex mutex{ "Test" };
+
+        mutex.lock(nullptr, LockAcquirer::Uia);
+        mutex.unlock();
+
+        {
+            const LockProfiler::ScopedAcquirer acquirer{ LockAcquirer::Render };
+            mutex.lock_shared();
+            // Nested shared acquisitions count as one.
+            mutex.lock_shared();
+            mutex.unlock_shared();
+            mutex.unlock_shared();
+        }
+        VERIFY_IS_TRUE(LockProfiler::GetThreadAcquirer() == LockAcquirer::Other);
+
+        mutex.lock();
+        mutex.unlock();
+
+        const auto statistics = mutex.GetStatistics();
+        VERIFY_ARE_EQUAL(1ull, statistics[static_cast<size_t>(LockAcquirer::Uia)].acquisitions);
+        VERIFY_ARE_EQUAL(1ull, statistics[static_cast<size_t>(LockAcquirer::Render)].acquisitions);
+        VERIFY_ARE_EQUAL(1ull, statistics[static_cast<size_t>(LockAcquirer::Other)].acquisitions);
+        VERIFY_ARE_EQUAL(0ull, statistics[static_cast<size_t>(LockAcquirer::Output)].acquisitions);
+        VERIFY_IS_NOT_NULL(statistics[static_cast<size_t>(LockAcquirer::Other)].longestHoldSite);
+    }
+};
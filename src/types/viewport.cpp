@@ -88,46 +88,6 @@ Viewport Viewport::FromCoord(const til::point origin) noexcept
     return FromInclusive(til::inclusive_rect{ origin.X, origin.Y, origin.X, origin.Y });
 }
 
-til::CoordType Viewport::Left() const noexcept
-{
-    return _sr.Left;
-}
-
-til::CoordType Viewport::RightInclusive() const noexcept
-{
-    return _sr.Right;
-}
-
-til::CoordType Viewport::RightExclusive() const noexcept
-{
-    return _sr.Right + 1;
-}
-
-til::CoordType Viewport::Top() const noexcept
-{
-    return _sr.Top;
-}
-
-til::CoordType Viewport::BottomInclusive() const noexcept
-{
-    return _sr.Bottom;
-}
-
-til::CoordType Viewport::BottomExclusive() const noexcept
-{
-    return _sr.Bottom + 1;
-}
-
-til::CoordType Viewport::Height() const noexcept
-{
-    return BottomExclusive() - Top();
-}
-
-til::CoordType Viewport::Width() const noexcept
-{
-    return RightExclusive() - Left();
-}
-
 // Method Description:
 // - Get a coord representing the origin of this viewport.
 // Arguments:
@@ -199,26 +159,6 @@ bool Viewport::IsInBounds(const Viewport& other) const noexcept
            other.BottomInclusive() >= Top() && other.BottomInclusive() <= BottomInclusive();
 }
 
-// Method Description:
-// - Determines if the given coordinate position lies within this viewport.
-// Arguments:
-// - pos - Coordinate position
-// - allowEndExclusive - if true, allow the EndExclusive til::point as a valid position.
-//                        Used in accessibility to signify that the exclusive end
-//                        includes the last til::point in a given viewport.
-// Return Value:
-// - True if it lies inside the viewport. False otherwise.
-bool Viewport::IsInBounds(const til::point pos, bool allowEndExclusive) const noexcept
-{
-    if (allowEndExclusive && pos == EndExclusive())
-    {
-        return true;
-    }
-
-    return pos.X >= Left() && pos.X < RightExclusive() &&
-           pos.Y >= Top() && pos.Y < BottomExclusive();
-}
-
 // Method Description:
 // - Clamps a coordinate position into the inside of this viewport.
 // Arguments:
@@ -262,38 +202,29 @@ Viewport Viewport::Clamp(const Viewport& other) const noexcept
 // - If False, we will restore the original position to the given coordinate.
 bool Viewport::MoveInBounds(const til::CoordType move, til::point& pos) const noexcept
 {
-    const auto backup = pos;
-    auto success = true; // If nothing happens, we're still successful (e.g. add = 0)
-
-    for (til::CoordType i = 0; i < move; i++)
+    // If nothing happens, we're still successful (e.g. add = 0)
+    if (move == 0)
     {
-        success = IncrementInBounds(pos);
-
-        // If an operation fails, break.
-        if (!success)
-        {
-            break;
-        }
-    }
-
-    for (til::CoordType i = 0; i > move; i--)
-    {
-        success = DecrementInBounds(pos);
-
-        // If an operation fails, break.
-        if (!success)
-        {
-            break;
-        }
+        return true;
     }
 
-    // If any operation failed, revert to backed up state.
-    if (!success)
+    // Assert that the position given fits inside this viewport.
+    assert(IsInBounds(pos));
+
+    // Moving by repeatedly incrementing or decrementing the position is equivalent to moving
+    // its linear offset within this viewport, which we can do in one step. The offset is
+    // computed in 64 bits, so that a move towards the ends of a huge buffer can't overflow.
+    const auto width = static_cast<int64_t>(Width());
+    const auto offset = (static_cast<int64_t>(pos.Y) - Top()) * width + (static_cast<int64_t>(pos.X) - Left()) + move;
+    if (offset < 0 || offset >= width * Height())
     {
-        pos = backup;
+        // The position remains unchanged if we'd have to stop early.
+        return false;
     }
 
-    return success;
+    pos.X = Left() + gsl::narrow_cast<til::CoordType>(offset % width);
+    pos.Y = Top() + gsl::narrow_cast<til::CoordType>(offset / width);
+    return true;
 }
 
 // Method Description:
@@ -125,13 +125,15 @@ HRESULT _CreatePseudoConsole(const HANDLE hToken,
     RETURN_IF_WIN32_BOOL_FALSE(SetHandleInformation(signalPipeConhostSide.get(), HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT));
 
     // GH4061: Ensure that the path to executable in the format is escaped so C:\Program.exe cannot collide with C:\Program Files
-    auto pwszFormat = L"\"%s\" --headless %s%s%s%s--width %hu --height %hu --signal 0x%x --server 0x%x";
+    auto pwszFormat = L"\"%s\" --headless %s%s%s%s%s%s--width %hu --height %hu --signal 0x%x --server 0x%x";
     // This is plenty of space to hold the formatted string
     wchar_t cmd[MAX_PATH]{};
     const BOOL bInheritCursor = (dwFlags & PSEUDOCONSOLE_INHERIT_CURSOR) == PSEUDOCONSOLE_INHERIT_CURSOR;
     const BOOL bResizeQuirk = (dwFlags & PSEUDOCONSOLE_RESIZE_QUIRK) == PSEUDOCONSOLE_RESIZE_QUIRK;
     const BOOL bWin32InputMode = (dwFlags & PSEUDOCONSOLE_WIN32_INPUT_MODE) == PSEUDOCONSOLE_WIN32_INPUT_MODE;
     const BOOL bPassthroughMode = (dwFlags & PSEUDOCONSOLE_PASSTHROUGH_MODE) == PSEUDOCONSOLE_PASSTHROUGH_MODE;
+    const BOOL bFrameDiffMode = (dwFlags & PSEUDOCONSOLE_FRAME_DIFF_MODE) == PSEUDOCONSOLE_FRAME_DIFF_MODE;
+    const BOOL bRepeatCharacterMode = (dwFlags & PSEUDOCONSOLE_REPEAT_CHARACTER_MODE) == PSEUDOCONSOLE_REPEAT_CHARACTER_MODE;
     swprintf_s(cmd,
                MAX_PATH,
                pwszFormat,
@@ -140,6 +142,8 @@ HRESULT _CreatePseudoConsole(const HANDLE hToken,
                bWin32InputMode ? L"--win32input " : L"",
                bResizeQuirk ? L"--resizeQuirk " : L"",
                bPassthroughMode ? L"--passthrough " : L"",
+               bFrameDiffMode ? L"--framediff " : L"",
+               bRepeatCharacterMode ? L"--repeatchar " : L"",
                size.X,
                size.Y,
                signalPipeConhostSide.get(),
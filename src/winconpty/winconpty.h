@@ -28,6 +28,8 @@ typedef struct _PseudoConsole
 #define PSEUDOCONSOLE_RESIZE_QUIRK (0x2)
 #define PSEUDOCONSOLE_WIN32_INPUT_MODE (0x4)
 #define PSEUDOCONSOLE_PASSTHROUGH_MODE (0x8)
+#define PSEUDOCONSOLE_FRAME_DIFF_MODE (0x10)
+#define PSEUDOCONSOLE_REPEAT_CHARACTER_MODE (0x20)
 
 // Implementations of the various PseudoConsole functions.
 HRESULT _CreatePseudoConsole(const HANDLE hToken,
@@ -23,6 +23,9 @@
 # Invoke as ./Generate-xxx ucd.nounihan.flat.xml -Pack | Out-File -Encoding
 #           UTF-8 Temporary.cpp
 #
+# CodepointWidthDetector.cpp uses the output of -Pack -Trie, which turns the
+# ranges into a three-stage lookup table instead of a sorted array.
+#
 # [1]: https://www.unicode.org/Public/UCD/latest/ucdxml/
 # [2]: https://www.unicode.org/reports/tr42/
 
@@ -44,7 +47,8 @@ Param(
 
     [switch]$Pack, # Pack tightly based on width
     [switch]$NoOverrides, # Do not include overrides
-    [switch]$Full = $False # Include Narrow codepoints
+    [switch]$Full = $False, # Include Narrow codepoints
+    [switch]$Trie # Emit a three-stage lookup table instead of ranges
 )
 
 Enum CodepointWidth {
@@ -260,6 +264,65 @@ If (-not $NoOverrides) {
     }
 }
 
+Function Out-ByteArray([string]$Name, [System.Collections.Generic.List[byte]]$Values) {
+    "    static constexpr std::array<uint8_t, {0}> {1}{{" -f $Values.Count, $Name
+    For ($i = 0; $i -lt $Values.Count; $i += 16) {
+        $line = For ($j = $i; $j -lt [Math]::Min($i + 16, $Values.Count); $j++) { "0x{0:x2}," -f $Values[$j] }
+        "        " + ($line -join " ")
+    }
+    "    };"
+}
+
+If ($Trie) {
+    # Stage 3 stores blocks of 64 codepoints, 2 bits each. Stage 2 stores blocks of
+    # 32 stage 3 indices and stage 1 maps bits 11-20 of a codepoint to a stage 2 block.
+    # Identical blocks are only stored once.
+    $widths = [byte[]]::new(0x110000)
+    ForEach($_ in $ranges) {
+        For ($cp = $_.Start; $cp -le $_.End; $cp++) {
+            $widths[$cp] = [byte]$_.Width
+        }
+    }
+
+    $stage3 = [System.Collections.Generic.List[byte]]::New()
+    $stage3Blocks = @{}
+    $stage3Indices = [System.Collections.Generic.List[byte]]::New()
+    For ($block = 0; $block -lt 0x110000; $block += 64) {
+        $packed = For ($i = $block; $i -lt $block + 64; $i += 4) {
+            [byte]($widths[$i] -bor ($widths[$i + 1] -shl 2) -bor ($widths[$i + 2] -shl 4) -bor ($widths[$i + 3] -shl 6))
+        }
+        $key = $packed -join ","
+        If (-not $stage3Blocks.ContainsKey($key)) {
+            $stage3Blocks[$key] = $stage3Blocks.Count
+            $stage3.AddRange([byte[]]$packed)
+        }
+        $stage3Indices.Add([byte]$stage3Blocks[$key])
+    }
+
+    $stage2 = [System.Collections.Generic.List[byte]]::New()
+    $stage2Blocks = @{}
+    $stage1 = [System.Collections.Generic.List[byte]]::New()
+    For ($block = 0; $block -lt $stage3Indices.Count; $block += 32) {
+        $indices = $stage3Indices.GetRange($block, 32)
+        $key = $indices -join ","
+        If (-not $stage2Blocks.ContainsKey($key)) {
+            $stage2Blocks[$key] = $stage2Blocks.Count
+            $stage2.AddRange($indices)
+        }
+        $stage1.Add([byte]$stage2Blocks[$key])
+    }
+
+    "    // Generated by {0} -Pack:{1} -Full:{2} -NoOverrides:{3} -Trie:{4}" -f $MyInvocation.MyCommand.Name, $Pack, $Full, $NoOverrides, $Trie
+    "    // on {0} (UTC) from {1}." -f (Get-Date -AsUTC), $InputObject.ucd.description
+    If (-not $NoOverrides) {
+    "    // Override path: {0}" -f $OverridePath
+    }
+    Out-ByteArray "s_widthStage1" $stage1
+    Out-ByteArray "s_widthStage2" $stage2
+    Out-ByteArray "s_widthStage3" $stage3
+    Return
+}
+
 # Emit Code
 "    // Generated by {0} -Pack:{1} -Full:{2} -NoOverrides:{3}" -f $MyInvocation.MyCommand.Name, $Pack, $Full, $NoOverrides
 "    // on {0} (UTC) from {1}." -f (Get-Date -AsUTC), $InputObject.ucd.description
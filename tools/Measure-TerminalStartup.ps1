@@ -0,0 +1,148 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+################################
+# This script measures the cold start of Windows Terminal.
+#
+# It launches wt.exe a number of times, each time under its own ETW session
+# that listens to the Terminal's TraceLogging providers. For every startup
+# phase (AppHost creation, Xaml island initialization, settings load,
+# TerminalPage creation, the first ConPTY spawn and the first frame) it then
+# reports percentiles of both the duration of the phase and the time since
+# the process started at which the phase was complete.
+#
+# Each launched window is closed again once -SettleTime has passed. Windows
+# that were already open before the script started aren't touched.
+#
+# Example:
+#   .\tools\Measure-TerminalStartup.ps1 -Iterations 20
+
+[CmdletBinding()]
+Param(
+    [int]$Iterations = 10,
+    [string]$Executable = "wt.exe",
+    [string[]]$ArgumentList = @(),
+    [int]$SettleTime = 5,
+    [string]$OutputDirectory = (Join-Path ([System.IO.Path]::GetTempPath()) "TerminalStartup")
+)
+
+$SessionName = "TerminalStartupTrace"
+
+# The providers defined by the Terminal's binaries.
+$Providers = @(
+    "{56c06166-2e2e-5f4d-7ff3-74f4b78c87d6}", # Microsoft.Windows.Terminal.Win32Host
+    "{24a1622f-7da7-5c77-3303-d850bd1ab2ed}", # Microsoft.Windows.Terminal.App
+    "{e912fe7b-eeb6-52a5-c628-abe388e5f792}", # Microsoft.Windows.Terminal.Connection
+    "{28c82e50-57af-5a86-c25b-e39cd990032b}"  # Microsoft.Windows.Terminal.Control
+)
+
+# Every phase is delimited by a pair of events. ExecutableStarted is emitted
+# first thing in wWinMain and serves as the origin of each run.
+$Phases = @(
+    @{ Name = "AppHost creation";      Start = "AppHostCreateStarted";      Stop = "AppHostCreateComplete" },
+    @{ Name = "Xaml island init";      Start = "XamlIslandInitStarted";     Stop = "XamlIslandInitComplete" },
+    @{ Name = "Settings load";         Start = "SettingsLoadStarted";       Stop = "SettingsLoadComplete" },
+    @{ Name = "AppHost initialize";    Start = "AppHostInitializeStarted";  Stop = "AppHostInitializeComplete" },
+    @{ Name = "TerminalPage creation"; Start = "TerminalPageCreateStarted"; Stop = "TerminalPageCreateComplete" },
+    @{ Name = "First ConPTY spawn";    Start = "ConPtySpawnStarted";        Stop = "ConPtySpawnComplete" },
+    @{ Name = "First frame";           Start = "ExecutableStarted";         Stop = "TermControlFirstFrame" }
+)
+
+Function Start-StartupTrace([string]$Path) {
+    & logman stop $SessionName -ets 2>&1 | Out-Null
+    & logman create trace $SessionName -o $Path -ets -nb 16 256 -bs 1024 | Out-Null
+    If ($LASTEXITCODE -Ne 0) {
+        Throw "Failed to start the ETW session (are you running elevated?)"
+    }
+    ForEach ($Provider in $Providers) {
+        & logman update trace $SessionName -p $Provider 0xffffffffffffffff 0xff -ets | Out-Null
+    }
+}
+
+Function Stop-StartupTrace() {
+    & logman stop $SessionName -ets | Out-Null
+}
+
+# Returns a table from event name to the timestamp of its first occurrence.
+# Later occurrences (e.g. of a second tab's ConPTY spawn) are ignored, since
+# we only care about the path to the first frame.
+Function Get-StartupEvents([string]$Path) {
+    $Xml = [System.IO.Path]::ChangeExtension($Path, ".xml")
+    & tracerpt $Path -o $Xml -of XML -y | Out-Null
+
+    $Events = @{}
+    ForEach ($Record in ([xml](Get-Content $Xml -Raw)).Events.Event) {
+        # tracerpt stores the name of TraceLogging events as the task name.
+        $Name = $Record.RenderingInfo.Task
+        If ($Name -And -Not $Events.ContainsKey($Name)) {
+            $Events[$Name] = [DateTime]::Parse($Record.System.TimeCreated.SystemTime)
+        }
+    }
+    $Events
+}
+
+Function Get-Percentile([double[]]$Values, [double]$Percentile) {
+    $Sorted = $Values | Sort-Object
+    $Index = [Math]::Ceiling($Percentile / 100 * $Sorted.Count) - 1
+    $Sorted[[Math]::Max(0, $Index)]
+}
+
+New-Item -ItemType Directory -Force -Path $OutputDirectory | Out-Null
+
+$Runs = @()
+For ($i = 0; $i -Lt $Iterations; $i++) {
+    Write-Progress -Activity "Measuring startup" -Status "Run $($i + 1) of $Iterations" -PercentComplete ($i * 100 / $Iterations)
+
+    $Path = Join-Path $OutputDirectory "startup-$i.etl"
+    $Before = @(Get-Process WindowsTerminal -ErrorAction SilentlyContinue | ForEach-Object Id)
+
+    Start-StartupTrace $Path
+    Try {
+        If ($ArgumentList.Count -Gt 0) {
+            Start-Process $Executable -ArgumentList $ArgumentList
+        } Else {
+            Start-Process $Executable
+        }
+        Start-Sleep -Seconds $SettleTime
+    } Finally {
+        Stop-StartupTrace
+        Get-Process WindowsTerminal -ErrorAction SilentlyContinue |
+            Where-Object { $Before -NotContains $_.Id } |
+            Stop-Process -Force
+    }
+
+    $Runs += ,(Get-StartupEvents $Path)
+
+    # Give the system a moment to tear the previous instance down, so that
+    # the runs don't interfere with each other.
+    Start-Sleep -Seconds 1
+}
+Write-Progress -Activity "Measuring startup" -Completed
+
+$Results = ForEach ($Phase in $Phases) {
+    $Durations = @()
+    $Offsets = @()
+    ForEach ($Events in $Runs) {
+        If ($Events.ContainsKey($Phase.Start) -And $Events.ContainsKey($Phase.Stop) -And $Events.ContainsKey("ExecutableStarted")) {
+            $Durations += ($Events[$Phase.Stop] - $Events[$Phase.Start]).TotalMilliseconds
+            $Offsets += ($Events[$Phase.Stop] - $Events["ExecutableStarted"]).TotalMilliseconds
+        }
+    }
+
+    If ($Durations.Count -Eq 0) {
+        Write-Warning "No events were recorded for phase '$($Phase.Name)'"
+        Continue
+    }
+
+    [PSCustomObject]@{
+        Phase        = $Phase.Name
+        Runs         = $Durations.Count
+        "P50 (ms)"   = [Math]::Round((Get-Percentile $Durations 50), 2)
+        "P90 (ms)"   = [Math]::Round((Get-Percentile $Durations 90), 2)
+        "P99 (ms)"   = [Math]::Round((Get-Percentile $Durations 99), 2)
+        "Done at P50 (ms)" = [Math]::Round((Get-Percentile $Offsets 50), 2)
+        "Done at P90 (ms)" = [Math]::Round((Get-Percentile $Offsets 90), 2)
+    }
+}
+
+$Results | Format-Table -AutoSize